@@ -33,25 +33,74 @@ endmacro()
 define_overridable_option(ANJ_TESTING BOOL OFF "Enable code unit tests")
 define_overridable_option(ANJ_IWYU_PATH STRING "" "IWYU executable path")
 define_overridable_option(ANJ_WITH_EXTRA_WARNINGS BOOL ON "Enable extra compilation warnings")
+define_overridable_option(ANJ_INTERNAL_COAP_WITH_TCP BOOL OFF "Build the CoAP over TCP codec, not used by the library yet")
 
 # input/output buffer sizes
 define_overridable_option(ANJ_IN_MSG_BUFFER_SIZE STRING 1200 "Input message buffer size")
 define_overridable_option(ANJ_OUT_MSG_BUFFER_SIZE STRING 1200 "Output message buffer size")
 define_overridable_option(ANJ_OUT_PAYLOAD_BUFFER_SIZE STRING 1024 "Payload buffer size")
+define_overridable_option(ANJ_WITH_MSG_BUFFER_ARENA BOOL OFF "Carve message buffers from a single user-provided memory region")
+define_overridable_option(ANJ_WITH_MSG_BUFFER_POOL BOOL OFF "Borrow message buffers from a pool shared between anj_t instances")
+define_overridable_option(ANJ_WITH_SCRATCH_ARENA BOOL OFF "Keep large temporaries of message processing in anj_t instead of the stack")
+define_overridable_option(ANJ_WITH_TRANSIENT_ALLOC BOOL OFF "Allocate buffers of rarely used operations with user-provided hooks")
+define_overridable_option(ANJ_WITH_STEP_TIME_CACHE BOOL OFF "Read the monotonic clock once per anj_core_step() call")
+define_overridable_option(ANJ_WITH_NEXT_STEP_TIME_CACHE BOOL OFF "Reuse the time of the next notification between anj_core_step() calls in queue mode")
+define_overridable_option(ANJ_WITH_SERVER_DATA_CACHE BOOL OFF "Keep the Server and Security Object parameters read by the core until a change is reported")
+define_overridable_option(ANJ_TIME_INTEGER_ONLY BOOL OFF "Use only integer time arithmetic and compile out floating-point time API")
+define_overridable_option(ANJ_WITH_BUDGETED_STEP BOOL OFF "Enable the step function doing a limited amount of work per call")
+define_overridable_option(ANJ_WITH_SCHEDULER BOOL OFF "Enable the helper computing the next wake-up time of core, NTP and CoAP downloader")
+define_overridable_option(ANJ_WITH_CLIENT_GROUP BOOL OFF "Enable stepping several anj_t instances, one per LwM2M Server, with shared Objects")
 
 # data model configuration
 define_overridable_option(ANJ_DM_MAX_OBJECTS_NUMBER STRING 10 "Max LwM2M Objects defined in data model")
 define_overridable_option(ANJ_WITH_COMPOSITE_OPERATIONS BOOL ON "Enable composite operations support")
 define_overridable_option(ANJ_DM_MAX_COMP_READ_ENTRIES STRING 5 "Max entries (paths) in a composite read operation")
+define_overridable_option(ANJ_DM_WITH_COMP_READ_PATH_STREAMING BOOL OFF "Read paths of single-message Read-Composite requests directly from the request payload")
+define_overridable_option(ANJ_DM_WITH_BATCHED_WRITE_COMP BOOL OFF "Begin transactions of all Objects targeted by single-message Write-Composite requests before writing")
+define_overridable_option(ANJ_DM_WITH_DENSE_ID_LOOKUP BOOL OFF "Enable direct indexing of Instances and Resources with contiguous IDs")
+define_overridable_option(ANJ_DM_WITH_RID_INDEX BOOL OFF "Enable optional tables mapping Resource IDs to Resource indexes in Object Instances")
+define_overridable_option(ANJ_DM_WITH_PATH_HANDLES BOOL OFF "Enable resolved path handles and cache of resolved paths")
+define_overridable_option(ANJ_DM_PATH_HANDLE_CACHE_SIZE STRING 8 "Number of resolved paths cached by the data model")
+define_overridable_option(ANJ_DM_WITH_READABLE_RES_COUNT_CACHE BOOL OFF "Enable caching of the number of readable Resources in each Object")
+define_overridable_option(ANJ_DM_WITH_LINK_SET_HASH BOOL OFF "Send the Object list in Update only if the registered Objects and Instances changed")
+define_overridable_option(ANJ_DM_WITH_REGISTER_PAYLOAD_CACHE BOOL OFF "Enable caching of the rendered Object list sent in Register and Update")
+define_overridable_option(ANJ_DM_REGISTER_PAYLOAD_CACHE_SIZE STRING 256 "Size of the buffer for the cached Object list, in bytes")
+define_overridable_option(ANJ_DM_WITH_RES_READ_BATCH BOOL OFF "Enable res_read_batch handler preparing multiple Resources of an Instance")
+define_overridable_option(ANJ_DM_WITH_READ_CACHE BOOL OFF "Enable caching of values of Resources with a declared maximum age")
+define_overridable_option(ANJ_DM_READ_CACHE_SIZE STRING 8 "Number of Resource values cached by the data model")
+define_overridable_option(ANJ_DM_WITH_CHANGE_QUEUE BOOL OFF "Enable lock-free queue of data model changes signalled from other threads")
+define_overridable_option(ANJ_DM_CHANGE_QUEUE_SIZE STRING 16 "Number of entries in the queue of data model changes, power of 2")
+define_overridable_option(ANJ_DM_WITH_WRITE_BLOCK_COMMIT BOOL OFF "Enable transaction_block_commit handler called after each block of a block-wise transactional request")
+define_overridable_option(ANJ_DM_WITH_EXECUTE_JOB BOOL OFF "Enable tracking of background jobs started by Execute handlers")
+define_overridable_option(ANJ_DM_WITH_INST_ARRAY BOOL OFF "Enable helpers keeping Object Instance arrays of dynamic Objects sorted")
+define_overridable_option(ANJ_DM_WITH_SHARED_RES_DEFS BOOL OFF "Enable per-instance Resource Instance arrays so that Resource definitions can be shared among Object Instances")
+define_overridable_option(ANJ_DM_WITH_RES_INST_BITMAP BOOL OFF "Enable bitmaps of Resource Instance IDs of multi-instance Resources")
+define_overridable_option(ANJ_DM_WITH_LAZY_INSTS BOOL OFF "Enable Objects enumerating their Instances with handlers instead of an array")
+define_overridable_option(ANJ_DM_WITH_SHARED_OBJ_DEFS BOOL OFF "Enable Objects sharing their definition between anj_t instances")
 
 # device object configuration
 define_overridable_option(ANJ_WITH_DEFAULT_DEVICE_OBJ BOOL ON "Enable default implementation of Device Object")
+define_overridable_option(ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME BOOL OFF "Enable Current Time Resource of the default Device Object")
+define_overridable_option(ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ BOOL OFF "Reuse the encoded unchanging Resources of the default Device Object in Reads of /3/0")
+define_overridable_option(ANJ_DM_DEVICE_OBJ_PREENCODED_READ_SIZE STRING 192 "Size of the buffer for the encoded Resources of the Device Object, per content format")
+define_overridable_option(ANJ_DM_DEVICE_OBJ_PREENCODED_READ_FORMATS STRING 2 "Number of content formats in which the Resources of the Device Object are kept encoded")
+
+# metrics object configuration
+define_overridable_option(ANJ_WITH_DEFAULT_METRICS_OBJ BOOL OFF "Enable default implementation of vendor-specific Metrics Object")
+define_overridable_option(ANJ_METRICS_OBJ_OID STRING 26241 "Object ID of the Metrics Object")
+
+# gateway object configuration
+define_overridable_option(ANJ_WITH_LWM2M_GATEWAY BOOL OFF "Enable LwM2M Gateway Object and data models of End IoT Devices")
+define_overridable_option(ANJ_GATEWAY_MAX_DEVICES STRING 4 "Maximum number of End IoT Devices connected to the LwM2M Gateway")
+define_overridable_option(ANJ_GATEWAY_MAX_DEVICE_OBJECTS STRING 4 "Maximum number of Objects in the data model of a single End IoT Device")
+define_overridable_option(ANJ_GATEWAY_IOT_DEVICE_OBJECTS_BUFFER_SIZE STRING 128 "Size of the buffer for the IoT Device Objects Resource of the LwM2M Gateway Object")
 
 # security object configuration
 define_overridable_option(ANJ_WITH_DEFAULT_SECURITY_OBJ BOOL ON "Enable default implementation of Security Object")
 define_overridable_option(ANJ_SEC_OBJ_MAX_PUBLIC_KEY_OR_IDENTITY_SIZE STRING 255 "Max Public Key or Identity Resource size")
 define_overridable_option(ANJ_SEC_OBJ_MAX_SERVER_PUBLIC_KEY_SIZE STRING 255 "Max Server Public Key Resource size")
 define_overridable_option(ANJ_SEC_OBJ_MAX_SECRET_KEY_SIZE STRING 255 "Max Secret Key Resource size")
+define_overridable_option(ANJ_SEC_OBJ_WITH_EXTERNAL_KEYS_ONLY BOOL OFF "Keep only crypto storage records in Security Object instances")
 
 # server object configuration
 define_overridable_option(ANJ_WITH_DEFAULT_SERVER_OBJ BOOL ON "Enable default implementation of Server Object")
@@ -66,27 +115,71 @@ define_overridable_option(ANJ_FOTA_WITH_HTTP BOOL OFF "Enable HTTP support in FW
 define_overridable_option(ANJ_FOTA_WITH_HTTPS BOOL OFF "Enable HTTPS support in FW Update Object")
 define_overridable_option(ANJ_FOTA_WITH_COAP_TCP BOOL OFF "Enable TCP support in FW Update Object")
 define_overridable_option(ANJ_FOTA_WITH_COAPS_TCP BOOL OFF "Enable TLS support in FW Update Object")
+define_overridable_option(ANJ_FOTA_WITH_PACKAGE_DIGEST BOOL OFF "Enable incremental digest verification of the firmware package in FW Update Object")
+define_overridable_option(ANJ_FOTA_DIGEST_MAX_SIZE STRING 32 "Max size of the firmware package digest in FW Update Object")
+define_overridable_option(ANJ_FOTA_WITH_ASYNC_PUSH_WRITE BOOL OFF "Enable asynchronous, double-buffered package writes in FW Update Object PUSH method")
+define_overridable_option(ANJ_FOTA_PUSH_STAGING_BUFFER_SIZE STRING 1024 "Size of each of the two FW Update Object PUSH method staging buffers")
+define_overridable_option(ANJ_FOTA_WITH_DELTA_UPDATE BOOL OFF "Enable streaming application of delta firmware patches in FW Update Object")
+define_overridable_option(ANJ_FOTA_DELTA_WINDOW_SIZE STRING 256 "Size of the new image window of the FW Update Object delta patch applier")
+define_overridable_option(ANJ_FOTA_WITH_DECOMPRESSION BOOL OFF "Enable streaming decompression of compressed firmware packages in FW Update Object")
+define_overridable_option(ANJ_FOTA_DECOMPRESSION_WINDOW_BITS STRING 8 "Base-2 logarithm of the FW Update Object decompression window size")
+define_overridable_option(ANJ_FOTA_WITH_PAGE_ALIGNED_WRITES BOOL OFF "Coalesce firmware package writes into flash-page-aligned pieces in FW Update Object")
+define_overridable_option(ANJ_FOTA_WRITE_PAGE_MAX_SIZE STRING 4096 "Largest flash page size supported by FW Update Object page-aligned writes")
 
 # CoAP downloader configuration
 define_overridable_option(ANJ_WITH_COAP_DOWNLOADER BOOL OFF "Enable CoAP Downloader support")
 define_overridable_option(ANJ_COAP_DOWNLOADER_MAX_PATHS_NUMBER STRING 3 "Max CoAP Paths number in CoAP Downloader")
 define_overridable_option(ANJ_COAP_DOWNLOADER_MAX_MSG_SIZE STRING 1200 "Max CoAP message size used in CoAP Downloader")
+define_overridable_option(ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION BOOL OFF "Allow CoAP Downloader to reuse the LwM2M Server connection")
+define_overridable_option(ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW BOOL OFF "Allow CoAP Downloader to keep multiple Block2 requests outstanding")
+define_overridable_option(ANJ_COAP_DOWNLOADER_BLOCK_WINDOW_SIZE STRING 4 "Max number of outstanding Block2 requests in CoAP Downloader")
+define_overridable_option(ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2 BOOL OFF "Allow CoAP Downloader to request blocks with the Q-Block2 option (RFC 9177)")
+define_overridable_option(ANJ_COAP_DOWNLOADER_WITH_RESUME BOOL OFF "Allow CoAP Downloader to persist progress and resume interrupted downloads")
+define_overridable_option(ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING BOOL OFF "Allow several CoAP Downloader transfers to share one connection")
+
+# HTTP downloader configuration
+define_overridable_option(ANJ_WITH_HTTP_DOWNLOADER BOOL OFF "Enable HTTP Downloader support")
+define_overridable_option(ANJ_HTTP_DOWNLOADER_BUFFER_SIZE STRING 1024 "Size of the request and response buffer of HTTP Downloader")
 
 # NTP module configuration
 define_overridable_option(ANJ_WITH_NTP BOOL OFF "Enable NTP module and NTP Object support")
 define_overridable_option(ANJ_NTP_SERVER_ADDR_MAX_LEN STRING 25 "Max NTP server address length")
+define_overridable_option(ANJ_NTP_WITH_DRIFT_COMPENSATION BOOL OFF "Enable NTP multi-sample filtering and clock drift compensation")
+define_overridable_option(ANJ_NTP_WITH_EXTERNAL_SAMPLES BOOL OFF "Enable feeding the NTP module with time samples obtained from other exchanges")
 
 # observe configuration
 define_overridable_option(ANJ_WITH_OBSERVE BOOL ON "Enable Observe-Notify mechanism")
 define_overridable_option(ANJ_WITH_OBSERVE_COMPOSITE BOOL OFF "Enable Observe-Composite support")
 define_overridable_option(ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER STRING 10 "Max number of enabled observations")
 define_overridable_option(ANJ_OBSERVE_MAX_WRITE_ATTRIBUTES_NUMBER STRING 10 "Max number of Attributes set with Write-Attributes")
+define_overridable_option(ANJ_OBSERVE_WITH_USER_STORAGE BOOL OFF "Allow tables of Observations and Write-Attributes to be provided at runtime")
 define_overridable_option(ANJ_OBSERVE_OBSERVATION_CANCEL_ON_TIMEOUT BOOL FALSE "Enable Observation cancellation on notification timeout")
 define_overridable_option(ANJ_WITH_RST_AS_CANCEL_OBSERVE BOOL ON "Enable support for cancelling Observations with CoAP RST")
+define_overridable_option(ANJ_OBSERVE_WITH_DEADLINE_INDEX BOOL OFF "Enable deadline-ordered index of Observations")
+define_overridable_option(ANJ_OBSERVE_WITH_PATH_INDEX BOOL OFF "Enable path-ordered index of Observations")
+define_overridable_option(ANJ_OBSERVE_WITH_STATE_ARRAYS BOOL OFF "Keep SSIDs and state flags of Observations in compact arrays")
+define_overridable_option(ANJ_OBSERVE_WITH_TOKEN_INDEX BOOL OFF "Enable hash index of Observations by token and message ID")
+define_overridable_option(ANJ_OBSERVE_WITH_NOTIFICATION_COALESCING BOOL OFF "Enable coalescing of notifications due within a time window")
+define_overridable_option(ANJ_OBSERVE_NOTIFICATION_COALESCING_WINDOW_S STRING 5 "Notification coalescing window in seconds")
+define_overridable_option(ANJ_OBSERVE_NOTIFICATION_ALIGNMENT_TICK_S STRING 0 "Notification alignment tick in seconds, 0 to disable")
+define_overridable_option(ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER BOOL OFF "Enable recording of notifications while the server is offline")
+define_overridable_option(ANJ_OBSERVE_WITH_VALUE_CACHE BOOL OFF "Enable reuse of Resource values read while checking notification attributes")
+define_overridable_option(ANJ_OBSERVE_WITH_COMPOSITE_DELTA_NOTIFICATIONS BOOL OFF "Send only changed Resources in Observe-Composite notifications")
+define_overridable_option(ANJ_OBSERVE_WITH_INTEGER_THRESHOLDS BOOL OFF "Check value change attributes of integer Resources without floating-point arithmetic")
+define_overridable_option(ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX BOOL OFF "Enable path-ordered index of attributes set by Write-Attributes")
+define_overridable_option(ANJ_OBSERVE_WITH_CON_POLICY BOOL OFF "Enable periodic Confirmable notifications among Non-confirmable ones")
+define_overridable_option(ANJ_OBSERVE_CON_POLICY_EVERY_N STRING 0 "Every N-th notification is Confirmable, 0 to disable")
+define_overridable_option(ANJ_OBSERVE_CON_POLICY_MAX_INTERVAL_S STRING 86400 "Maximum time between Confirmable notifications in seconds")
+define_overridable_option(ANJ_OBSERVE_WITH_EVALUATION_SCHEDULER BOOL OFF "Sample observed Resources with value change attributes at the epmax period")
+define_overridable_option(ANJ_OBSERVE_WITH_HISTORICAL_QUEUE BOOL OFF "Enable queue of timestamped values of Observations with the hqmax attribute")
+define_overridable_option(ANJ_OBSERVE_HISTORICAL_QUEUE_BUFFER_SIZE STRING 256 "Size in bytes of the historical queue of each Observation")
+define_overridable_option(ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS BOOL OFF "Send 2.03 Valid notifications without payload if the notified value has not changed")
 
 # bootstrap configuration
 define_overridable_option(ANJ_WITH_BOOTSTRAP BOOL ON "Enable Bootstrap Interface")
 define_overridable_option(ANJ_WITH_BOOTSTRAP_DISCOVER BOOL ON "Enable Bootstrap-Discover support")
+define_overridable_option(ANJ_WITH_BOOTSTRAP_WRITE_BATCHING BOOL OFF "Enable committing consecutive Bootstrap-Writes in a single transaction")
+define_overridable_option(ANJ_WITH_BOOTSTRAP_PACK BOOL OFF "Enable Bootstrap-Pack-Request support")
 
 # discover configuration
 define_overridable_option(ANJ_WITH_DISCOVER BOOL ON "Enable Discover support")
@@ -95,6 +188,20 @@ define_overridable_option(ANJ_WITH_DISCOVER_ATTR BOOL ON "Enable Discover to rea
 # LwM2M Send
 define_overridable_option(ANJ_WITH_LWM2M_SEND BOOL ON "Enable LwM2M SEND operation support")
 define_overridable_option(ANJ_LWM2M_SEND_QUEUE_SIZE STRING 1 "Max LwM2M SEND messages queued number")
+define_overridable_option(ANJ_LWM2M_SEND_WITH_BATCHING BOOL OFF "Enable merging of queued LwM2M SEND requests into a single message")
+define_overridable_option(ANJ_LWM2M_SEND_BATCHING_HOLD_DOWN_MS STRING 1000 "Time for which a queued LwM2M SEND request waits for other requests to be merged with")
+define_overridable_option(ANJ_LWM2M_SEND_WITH_RECORD_PRODUCER BOOL OFF "Enable LwM2M SEND requests with records produced on demand by a callback")
+define_overridable_option(ANJ_LWM2M_SEND_WITH_PRIORITIES BOOL OFF "Enable priority ordering of queued LwM2M SEND requests")
+define_overridable_option(ANJ_LWM2M_SEND_WITH_NON_CONFIRMABLE BOOL OFF "Enable Non-confirmable LwM2M SEND requests")
+define_overridable_option(ANJ_LWM2M_SEND_CON_EVERY_N STRING 0 "Every N-th Non-confirmable LwM2M SEND request is sent as Confirmable, 0 to disable")
+define_overridable_option(ANJ_LWM2M_SEND_WITH_NO_RESPONSE BOOL OFF "Enable the CoAP No-Response option (RFC 7967) in LwM2M SEND requests")
+define_overridable_option(ANJ_LWM2M_SEND_WITH_FILTER BOOL OFF "Enable report-by-exception filtering of LwM2M SEND records")
+define_overridable_option(ANJ_LWM2M_SEND_FILTER_SIZE STRING 8 "Max number of paths with LwM2M SEND filters")
+define_overridable_option(ANJ_LWM2M_SEND_WITH_SORTED_RECORDS BOOL OFF "Enable encoding LwM2M SEND records in path order")
+define_overridable_option(ANJ_LWM2M_SEND_SORTED_RECORDS_MAX STRING 16 "Max number of records of a LwM2M SEND request that are sorted")
+define_overridable_option(ANJ_LWM2M_SEND_WITH_TEMPLATES BOOL OFF "Enable LwM2M SEND requests encoded from pre-encoded payload templates")
+define_overridable_option(ANJ_LWM2M_SEND_TEMPLATE_MAX_RECORDS STRING 8 "Max number of records of a LwM2M SEND payload template")
+define_overridable_option(ANJ_LWM2M_SEND_TEMPLATE_MAX_SIZE STRING 256 "Max size of the payload of a LwM2M SEND payload template")
 
 # compat layer configuration
 define_overridable_option(ANJ_WITH_TIME_POSIX_COMPAT BOOL ON "Enable POSIX-compliant integration of time API")
@@ -104,6 +211,22 @@ define_overridable_option(ANJ_NET_WITH_IPV4 BOOL ON "Enable communication over I
 define_overridable_option(ANJ_NET_WITH_IPV6 BOOL OFF "Enable communication over IPv6")
 define_overridable_option(ANJ_NET_WITH_UDP BOOL ON "Enable communication over UDP")
 define_overridable_option(ANJ_NET_WITH_DTLS BOOL OFF "Enable communication over DTLS")
+define_overridable_option(ANJ_NET_WITH_SEND_VEC BOOL OFF "Send CoAP header and payload with scatter-gather network API")
+define_overridable_option(ANJ_NET_WITH_POLL_HANDLE BOOL OFF "Enable event-driven wakeup API based on pollable network handles")
+define_overridable_option(ANJ_NET_WITH_RELEASE_ASSISTANCE BOOL OFF "Tell the network layer when no more traffic is expected, e.g. to signal 3GPP RAI")
+define_overridable_option(ANJ_NET_WITH_BATCH_IO BOOL OFF "Enable network API for receiving and sending multiple datagrams per call")
+define_overridable_option(ANJ_NET_WITH_ASYNC_RESOLVE BOOL OFF "Resolve host names in a background thread instead of blocking in connect")
+define_overridable_option(ANJ_NET_WITH_RESOLVE_CACHE BOOL OFF "Cache resolved host addresses for reconnections")
+define_overridable_option(ANJ_NET_RESOLVE_CACHE_ENTRIES STRING 2 "Number of cached resolved host addresses")
+define_overridable_option(ANJ_NET_RESOLVE_CACHE_TTL_S STRING 300 "Time in seconds for which a resolved host address is cached")
+define_overridable_option(ANJ_NET_WITH_HAPPY_EYEBALLS BOOL OFF "Try addresses of both IP families when connecting and remember the one that worked")
+define_overridable_option(ANJ_NET_HAPPY_EYEBALLS_CACHE_ENTRIES STRING 2 "Number of hosts for which the address family that worked is remembered")
+define_overridable_option(ANJ_NET_WITH_IO_THREAD BOOL OFF "Run UDP and DTLS network I/O in a dedicated thread")
+define_overridable_option(ANJ_NET_IO_THREAD_QUEUE_SIZE STRING 4 "Number of datagrams queued for the I/O thread per direction and connection")
+define_overridable_option(ANJ_NET_IO_THREAD_DATAGRAM_SIZE STRING 1500 "Max size of a datagram passed through the I/O thread queues")
+define_overridable_option(ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE BOOL OFF "Enable persistence of the DTLS connection state together with the registration session")
+define_overridable_option(ANJ_NET_WITH_TCP BOOL OFF "Enable communication over TCP")
+define_overridable_option(ANJ_NET_WITH_TLS BOOL OFF "Enable communication over TLS")
 define_overridable_option(ANJ_WITH_CRYPTO_STORAGE_DEFAULT BOOL OFF "Enable default implementation of crypto storage API")
 define_overridable_option(ANJ_WITH_MBEDTLS BOOL OFF "Enable MbedTLS support")
 define_overridable_option(ANJ_MBEDTLS_PSK_IDENTITY_MAX_LEN STRING 128 "Max PSK Identity length")
@@ -111,13 +234,23 @@ define_overridable_option(ANJ_MBEDTLS_TLS_VERSION STRING "MBEDTLS_SSL_VERSION_TL
                                                                                        MBEDTLS_SSL_VERSION_TLS1_2 and MBEDTLS_SSL_VERSION_TLS1_3")
 define_overridable_option(ANJ_MBEDTLS_ALLOWED_CIPHERSUITES STRING "MBEDTLS_TLS_PSK_WITH_AES_128_CCM_8,MBEDTLS_TLS_PSK_WITH_AES_256_CCM_8"
                                                                                      "List of allowed ciphersuites for MbedTLS")
+define_overridable_option(ANJ_MBEDTLS_RPK_ALLOWED_CIPHERSUITES STRING "MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_CCM_8"
+                                                                                     "List of allowed ciphersuites for MbedTLS in Raw Public Key mode")
+define_overridable_option(ANJ_MBEDTLS_RPK_MAX_LEN STRING 512 "Max length of each Raw Public Key mode credential")
 define_overridable_option(ANJ_MBEDTLS_HS_INITIAL_TIMEOUT_VALUE_MS STRING 1000 "Initial handshake timeout value in milliseconds")
 define_overridable_option(ANJ_MBEDTLS_HS_MAXIMUM_TIMEOUT_VALUE_MS STRING 60000 "Maximum handshake timeout value in milliseconds")
+define_overridable_option(ANJ_MBEDTLS_WITH_MAX_FRAGMENT_LENGTH BOOL OFF "Negotiate DTLS record size matching the message buffers")
+define_overridable_option(ANJ_MBEDTLS_WITH_STATIC_POOL BOOL OFF "Allocate MbedTLS memory from a user-supplied static pool and track its peak usage")
+define_overridable_option(ANJ_MBEDTLS_HS_MTU STRING 0 "Largest datagram of DTLS handshake flights, 0 to use the MTU reported by the network layer")
+define_overridable_option(ANJ_MBEDTLS_WITH_HANDSHAKE_METRICS BOOL OFF "Enable duration, datagram and retransmission counters of the DTLS handshake")
 
 # security configuration
 define_overridable_option(ANJ_WITH_SECURITY BOOL OFF "Enable security support")
 define_overridable_option(ANJ_WITH_CERTIFICATES BOOL OFF "Enable certificates support")
+define_overridable_option(ANJ_WITH_RAW_PUBLIC_KEY BOOL OFF "Enable Raw Public Key security mode")
 define_overridable_option(ANJ_WITH_EXTERNAL_CRYPTO_STORAGE BOOL OFF "Enable external crypto storage API")
+define_overridable_option(ANJ_WITH_ASYNC_CRYPTO_STORAGE BOOL OFF "Allow external crypto storage to resolve security information asynchronously")
+define_overridable_option(ANJ_WITH_OSCORE BOOL OFF "Enable OSCORE (RFC 8613) protection of the LwM2M Server connection")
 
 # data formats configuration
 define_overridable_option(ANJ_WITH_CBOR BOOL ON "Enable CBOR format support")
@@ -125,12 +258,22 @@ define_overridable_option(ANJ_WITH_CBOR_DECODE_DECIMAL_FRACTIONS BOOL ON "Enable
 define_overridable_option(ANJ_WITH_CBOR_DECODE_HALF_FLOAT BOOL ON "Enable 16bit half floats support in CBOR")
 define_overridable_option(ANJ_WITH_CBOR_DECODE_INDEFINITE_BYTES BOOL ON "Enable Indefinite bytes strings and arrays support in CBOR")
 define_overridable_option(ANJ_WITH_CBOR_DECODE_STRING_TIME BOOL ON "Enable string representations of timestamp support in CBOR")
+define_overridable_option(ANJ_WITH_CBOR_ENCODE_SHORTEST_FLOAT BOOL OFF "Encode SenML CBOR and LwM2M CBOR floating-point values in the shortest lossless form")
 define_overridable_option(ANJ_WITH_LWM2M_CBOR BOOL ON "Enable LwM2M CBOR format support")
 define_overridable_option(ANJ_WITH_SENML_CBOR BOOL ON "Enable SenML CBOR format support")
+define_overridable_option(ANJ_WITH_SENML_CBOR_DYNAMIC_BASE_NAME BOOL OFF "Emit a new SenML Base Name for every Object Instance")
+define_overridable_option(ANJ_WITH_SENML_CBOR_RELATIVE_TIME BOOL OFF "Encode SenML timestamps as offsets from a single Base Time")
+define_overridable_option(ANJ_WITH_SENML_CBOR_STRINGREF BOOL OFF "Enable a vendor SenML CBOR Content-Format that refers to repeated names")
+define_overridable_option(ANJ_SENML_CBOR_STRINGREF_FORMAT STRING 65112 "Content-Format number of SenML CBOR with references to repeated names")
+define_overridable_option(ANJ_SENML_CBOR_STRINGREF_NAMES STRING 8 "Number of SenML names per message that can be referred to")
 define_overridable_option(ANJ_WITH_PLAINTEXT BOOL ON "Enable Plaintext format support")
+define_overridable_option(ANJ_WITH_BASE64_FAST_PATH BOOL OFF "Enable block-wise base64 encoding and table-driven decoding")
 define_overridable_option(ANJ_WITH_OPAQUE BOOL ON "Enable Opaque format support")
 define_overridable_option(ANJ_WITH_TLV BOOL ON "Enable TLV format support (decoder only)")
+define_overridable_option(ANJ_WITH_TLV_ENCODER BOOL OFF "Enable TLV format encoder for Read and Observe operations")
 define_overridable_option(ANJ_WITH_EXTERNAL_DATA BOOL OFF "Enable External Data Type support")
+define_overridable_option(ANJ_WITH_SMALLEST_FORMAT BOOL OFF "Choose the most compact Content Format for payloads without a requested one")
+define_overridable_option(ANJ_WITH_DIRECT_PAYLOAD_ENCODING BOOL OFF "Encode CBOR records directly in the payload buffer when there is enough space")
 
 # CoAP related configuration
 define_overridable_option(ANJ_COAP_MAX_OPTIONS_NUMBER STRING 15 "Max number of CoAP options in CoAP header")
@@ -139,10 +282,31 @@ define_overridable_option(ANJ_COAP_MAX_LOCATION_PATHS_NUMBER STRING 2 "Max CoAP
 define_overridable_option(ANJ_COAP_MAX_LOCATION_PATH_SIZE STRING 40 "Max size of a single CoAP Location-Path in Registration Interface")
 define_overridable_option(ANJ_WITH_CACHE BOOL ON "Enable responses caching")
 define_overridable_option(ANJ_CACHE_ENTRIES_NUMBER STRING 10 "Non-recent cache entries number")
+define_overridable_option(ANJ_CACHE_WITH_FULL_ENTRIES BOOL OFF "Enable caching of multiple responses with payload and indexed Message ID lookup")
+define_overridable_option(ANJ_CACHE_FULL_ENTRIES_NUMBER STRING 4 "Number of cached responses kept with payload, including the most recent one")
+define_overridable_option(ANJ_CACHE_PAYLOAD_ARENA_SIZE STRING 1024 "Size of the buffer for payloads of older cached responses")
+define_overridable_option(ANJ_WITH_ENCODED_RETRANSMISSIONS BOOL OFF "Retransmit encoded datagrams of cached responses and Confirmable messages without encoding them again")
+define_overridable_option(ANJ_COAP_WITH_MSG_TEMPLATES BOOL OFF "Enable reuse of serialized CoAP options of repeated outgoing messages")
+define_overridable_option(ANJ_WITH_ADAPTIVE_BLOCK_SIZE BOOL OFF "Enable adjusting the block size of Block-Wise transfers to the observed packet loss")
+define_overridable_option(ANJ_ADAPTIVE_BLOCK_SIZE_GROWTH_THRESHOLD STRING 8 "Number of exchanges finished without a timeout after which the block size is doubled")
+define_overridable_option(ANJ_WITH_PMTU_PROBING BOOL OFF "Enable discovering the Path MTU to the LwM2M Server from the delivered and lost requests")
+define_overridable_option(ANJ_WITH_PIPELINED_NOTIFICATIONS BOOL OFF "Enable sending notifications while a client request waits for the response")
+define_overridable_option(ANJ_PIPELINED_NOTIFICATIONS_NSTART STRING 2 "Maximum number of outstanding Confirmable client requests with pipelined notifications")
+define_overridable_option(ANJ_WITH_INTERLEAVED_NOTIFICATIONS BOOL OFF "Enable sending notifications between the blocks of a Block-Wise Read")
+define_overridable_option(ANJ_WITH_BLOCK2_PREFETCH BOOL OFF "Enable preparing the next block of a Block-Wise response before it is requested")
+define_overridable_option(ANJ_WITH_SEPARATE_RESPONSE BOOL OFF "Enable deferring responses to Read and Execute requests of slow data model handlers")
+define_overridable_option(ANJ_WITH_ADAPTIVE_RTO BOOL OFF "Enable estimating the retransmission timeout from measured round-trip times")
+define_overridable_option(ANJ_ADAPTIVE_RTO_MIN_MS STRING 250 "Lower bound of the estimated retransmission timeout in milliseconds")
+define_overridable_option(ANJ_WITH_COUNTER_TOKENS BOOL OFF "Enable deriving tokens of client requests from a keyed counter instead of the RNG")
+define_overridable_option(ANJ_COAP_TOKEN_SIZE STRING 8 "Size of tokens of client requests, in bytes")
+define_overridable_option(ANJ_WITH_ETAG BOOL OFF "Enable ETag option in responses and notifications, and 2.03 Valid responses to requests with a matching ETag")
+define_overridable_option(ANJ_COAP_WITH_HEADER_COMPRESSION BOOL OFF "Enable static rule-based compression of CoAP headers for the Non-IP binding")
 
 # logger configuration
 define_overridable_option(ANJ_LOG_FULL BOOL ON "Enable full logger: includes module, level, file, and line info")
 define_overridable_option(ANJ_LOG_MICRO BOOL OFF "Enable micro logger: includes level, source file id, and line info")
+define_overridable_option(ANJ_LOG_MICRO_DEFERRED BOOL OFF "Buffer micro logs in binary form instead of formatting them")
+define_overridable_option(ANJ_LOG_DEFERRED_BUFFER_SIZE STRING 1024 "Size of the ring buffer for deferred micro logs")
 define_overridable_option(ANJ_LOG_ALT_IMPL_HEADER STRING "" "Path to custom logger implementation header")
 define_overridable_option(ANJ_LOG_FORMATTER_PRINTF BOOL ON "Use vsnprintf() for log message formatting")
 define_overridable_option(ANJ_LOG_FORMATTER_BUF_SIZE STRING 512 "Log formatting buffer size")
@@ -151,13 +315,39 @@ define_overridable_option(ANJ_LOG_HANDLER_OUTPUT_ALT BOOL OFF "Use user-defined
 define_overridable_option(ANJ_LOG_STRIP_CONSTANTS BOOL OFF "Replace disposable logs (ANJ_LOG_DISPOSABLE) with a space string")
 define_overridable_option(ANJ_LOG_LEVEL_DEFAULT STRING L_INFO "Default log level threshold")
 define_overridable_option(ANJ_LOG_FILTERING_CONFIG_HEADER STRING "" "Path to header with per-module log level overrides")
+define_overridable_option(ANJ_LOG_RUNTIME_FILTERING BOOL OFF "Enable changing log levels of modules at runtime")
+define_overridable_option(ANJ_LOG_RUNTIME_FILTERING_MAX_MODULES STRING 4 "Max number of modules with log level set at runtime")
+define_overridable_option(ANJ_LOG_RATE_LIMIT BOOL OFF "Enable rate limiting of log statements per call site")
+define_overridable_option(ANJ_LOG_RATE_LIMIT_SITES STRING 16 "Number of log call sites tracked by the rate limiter")
+define_overridable_option(ANJ_LOG_RATE_LIMIT_BURST STRING 10 "Number of messages a log call site can emit in a burst")
+define_overridable_option(ANJ_LOG_RATE_LIMIT_INTERVAL_MS STRING 1000 "Interval in which a rate limited log call site regains one message")
 
 # persistence configuration
 define_overridable_option(ANJ_WITH_PERSISTENCE BOOL OFF "Enable Persistence support")
+define_overridable_option(ANJ_WITH_SESSION_PERSISTENCE BOOL OFF "Enable persistence of the registration session state")
+define_overridable_option(ANJ_PERSISTENCE_WITH_BUFFERED_STORE BOOL OFF "Enable page-buffered and size-only persistence store contexts")
+define_overridable_option(ANJ_PERSISTENCE_WITH_DIRTY_TRACKING BOOL OFF "Enable storing only the objects changed since the last store")
+define_overridable_option(ANJ_PERSISTENCE_WITH_INTEGRITY_CHECK BOOL OFF "Enable CRC-32 protected persistence contexts")
+define_overridable_option(ANJ_PERSISTENCE_WITH_MEMORY_MAPPED_RESTORE BOOL OFF "Enable restoring persistence data in place from memory-mapped storage")
 
 # other configuration
 define_overridable_option(ANJ_WITH_LWM2M12 BOOL ON "Enable LwM2M protocol version 1.2 support")
+define_overridable_option(ANJ_WITH_SCHEDULING_JITTER BOOL OFF "Enable per-endpoint jitter of Register, Update and retry scheduling")
+define_overridable_option(ANJ_WITH_QUEUE_MODE_WAKE_WINDOW BOOL OFF "Enable grouping of client requests into a single Queue Mode wake window")
+define_overridable_option(ANJ_WITH_UPDATE_HOLD_DOWN BOOL OFF "Enable merging Registration Update triggers within a hold-down window into a single Update")
+define_overridable_option(ANJ_WITH_SMS_TRIGGER BOOL OFF "Enable Registration Update Triggers reported by the modem, e.g. received over SMS")
+define_overridable_option(ANJ_WITH_NAT_REBINDING_RECOVERY BOOL OFF "Enable recovering a lost connection with a fresh socket and an Update instead of a Register")
+define_overridable_option(ANJ_WITH_NAT_KEEPALIVE_PROBING BOOL OFF "Enable learning the NAT binding timeout and sending keep-alive Updates only as often as it requires")
+define_overridable_option(ANJ_WITH_WARM_RESTART BOOL OFF "Enable restarting the client without Deregister, Register and a new connection")
+define_overridable_option(ANJ_WITH_METRICS BOOL OFF "Enable counters of retransmissions, cache hits, transferred bytes and exchange durations")
+define_overridable_option(ANJ_WITH_RESOURCE_USAGE BOOL OFF "Enable high-water marks of message buffers, observation slots, Send queue and exchange cache")
+define_overridable_option(ANJ_METRICS_WITH_HISTOGRAMS BOOL OFF "Enable log2 latency histograms of server requests, notifications, Send and ACK round-trip times")
+define_overridable_option(ANJ_WITH_TRACE BOOL OFF "Enable ring buffer of timestamped state transition events")
+define_overridable_option(ANJ_TRACE_BUFFER_SIZE STRING 64 "Number of events held in the trace ring buffer")
+define_overridable_option(ANJ_WITH_TRACE_POSIX_EXPORTER BOOL ON "Enable export of trace events as JSON to a POSIX file descriptor")
 define_overridable_option(ANJ_WITH_CUSTOM_CONVERSION_FUNCTIONS BOOL ON "Enable custom string<->number conversion function")
+define_overridable_option(ANJ_WITH_FAST_NUMBER_FORMATTING BOOL OFF "Enable digit-pair integer and shortest round-trip double formatting")
+define_overridable_option(ANJ_WITH_FAST_NUMBER_PARSING BOOL OFF "Enable correctly rounded, locale-independent string to double parsing")
 define_overridable_option(ANJ_PLATFORM_BIG_ENDIAN BOOL OFF "Define platform endianess as big endian")
 
 define_overridable_option(MBEDTLS_VERSION STRING "" "MbedTLS version to use when MBEDTLS_ROOT_DIR is not set, default is 3.6.4")
@@ -192,9 +382,17 @@ target_include_directories(
 if(ANJ_TESTING)
   target_include_directories(anj PRIVATE "${repo_root}/tests/anj")
 endif()
+if(ANJ_INTERNAL_COAP_WITH_TCP)
+  target_compile_definitions(anj PUBLIC _ANJ_COAP_WITH_TCP)
+endif()
 
 target_link_libraries(anj PUBLIC ${MATH_LIBRARY})
 
+if(ANJ_NET_WITH_ASYNC_RESOLVE OR ANJ_NET_WITH_IO_THREAD)
+  find_package(Threads REQUIRED)
+  target_link_libraries(anj PUBLIC Threads::Threads)
+endif()
+
 set_target_properties(anj PROPERTIES
   C_STANDARD 99
   C_STANDARD_REQUIRED TRUE
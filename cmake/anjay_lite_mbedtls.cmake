@@ -14,6 +14,19 @@ if(MBEDTLS_VERSION STREQUAL "")
 endif()
 
 if(NOT MBEDTLS_ROOT_DIR)
+    if(ANJ_MBEDTLS_WITH_STATIC_POOL AND NOT MBEDTLS_USER_CONFIG_FILE)
+        # MbedTLS provided by MBEDTLS_ROOT_DIR has to be built with these
+        # options by the integrator
+        set(_MBEDTLS_STATIC_POOL_CONFIG
+            "${CMAKE_CURRENT_BINARY_DIR}/anjay_lite_mbedtls_static_pool_config.h")
+        file(WRITE "${_MBEDTLS_STATIC_POOL_CONFIG}"
+             "#define MBEDTLS_PLATFORM_C\n"
+             "#define MBEDTLS_PLATFORM_MEMORY\n"
+             "#define MBEDTLS_MEMORY_BUFFER_ALLOC_C\n"
+             "#define MBEDTLS_MEMORY_DEBUG\n")
+        set(MBEDTLS_USER_CONFIG_FILE "${_MBEDTLS_STATIC_POOL_CONFIG}"
+            CACHE FILEPATH "Mbed TLS user config file" FORCE)
+    endif()
     include(FetchContent)
     message(STATUS "No MBEDTLS_ROOT_DIR provided. Fetching MbedTLS ${MBEDTLS_VERSION} ...")
     FetchContent_Declare(
@@ -0,0 +1,732 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <anj/compat/net/anj_net_api.h>
+#include <anj/compat/time.h>
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/dm/device_object.h>
+#include <anj/dm/security_object.h>
+#include <anj/dm/server_object.h>
+#include <anj/log.h>
+#include <anj/lwm2m_send.h>
+#include <anj/metrics.h>
+#include <anj/time.h>
+#include <anj/utils.h>
+
+#include "sensor_obj.h"
+#include "worker_pool.h"
+
+#define log(...) anj_log(load_generator, __VA_ARGS__)
+
+#define ENDPOINT_NAME_MAX_SIZE 64
+#define MAX_EPOLL_EVENTS 256
+
+// Scheduling state of a virtual device. The fields of an idle device are
+// accessed only by the main thread; once queued, only by the worker that
+// runs it, until it's idle again. A device that becomes ready while it's
+// being run is rescheduled and run again by the same worker.
+enum {
+    DEVICE_IDLE,
+    DEVICE_QUEUED,
+    DEVICE_RESCHEDULED
+};
+
+typedef struct {
+    // must remain the first field, handlers receive a pointer to it
+    anj_t anj;
+    anj_dm_device_obj_t device_obj;
+    anj_dm_server_obj_t server_obj;
+    anj_dm_security_obj_t security_obj;
+    char endpoint_name[ENDPOINT_NAME_MAX_SIZE];
+    sensor_obj_state_t sensor;
+    // referenced by the library until the Send is finished
+    anj_send_request_t send_request;
+    anj_io_out_entry_t send_records[SENSOR_MAX_INSTANCES];
+    bool registered;
+    bool send_in_progress;
+    // ANJ_TIME_MONOTONIC_INVALID if only a network event wakes the device up
+    anj_time_monotonic_t next_step;
+    anj_time_monotonic_t next_notify;
+    anj_time_monotonic_t next_send;
+    size_t index;
+    uint32_t state;
+} virtual_device_t;
+
+typedef struct {
+    const char *server_uri;
+    const char *endpoint_prefix;
+    size_t device_count;
+    size_t thread_count;
+    uint16_t instance_count;
+    uint32_t lifetime;
+    anj_time_duration_t ramp_up;
+    anj_time_duration_t notify_period;
+    anj_time_duration_t send_period;
+    anj_time_duration_t report_period;
+    anj_time_duration_t duration;
+} options_t;
+
+typedef struct {
+    size_t registered;
+    uint32_t notify_changes;
+    uint32_t sends_succeeded;
+    uint32_t sends_failed;
+    uint32_t sends_skipped;
+} counters_t;
+
+// updated by the workers, read and reset by the main thread while they're
+// idle
+static counters_t g_counters;
+
+// Wake-up deadline of the main thread, in microseconds of the monotonic
+// clock. A worker that leaves a device with an earlier deadline wakes the
+// main thread up through the eventfd.
+#define WAIT_SCANNING INT64_MIN
+#define WAIT_FOREVER INT64_MAX
+
+static struct {
+    const options_t *opts;
+    int epoll_fd;
+    int event_fd;
+    bool threaded;
+    int64_t wait_deadline_us;
+} g_loop;
+
+static void count(uint32_t *counter, uint32_t value) {
+    __atomic_add_fetch(counter, value, __ATOMIC_RELAXED);
+}
+
+static sensor_obj_state_t *get_sensor_state(anj_t *anj) {
+    return &ANJ_CONTAINER_OF(anj, virtual_device_t, anj)->sensor;
+}
+
+static void
+conn_status_changed(void *arg, anj_t *anj, anj_conn_status_t conn_status) {
+    (void) arg;
+    virtual_device_t *dev = ANJ_CONTAINER_OF(anj, virtual_device_t, anj);
+    bool registered = conn_status == ANJ_CONN_STATUS_REGISTERED
+                      || conn_status == ANJ_CONN_STATUS_QUEUE_MODE;
+    if (registered != dev->registered) {
+        dev->registered = registered;
+        if (registered) {
+            __atomic_add_fetch(&g_counters.registered, 1, __ATOMIC_RELAXED);
+        } else {
+            __atomic_sub_fetch(&g_counters.registered, 1, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static int install_objects(virtual_device_t *dev,
+                           const options_t *opts,
+                           const anj_dm_obj_t *sensor_obj) {
+    anj_dm_device_object_init_t device_obj_conf = {
+        .firmware_version = "0.1",
+        .serial_number = dev->endpoint_name
+    };
+    anj_dm_server_instance_init_t server_inst = {
+        .ssid = 1,
+        .lifetime = opts->lifetime,
+        .binding = "U",
+        .bootstrap_on_registration_failure = &(bool) { false },
+    };
+    anj_dm_security_instance_init_t security_inst = {
+        .ssid = 1,
+        .server_uri = opts->server_uri,
+        .security_mode = ANJ_DM_SECURITY_NOSEC
+    };
+    anj_dm_server_obj_init(&dev->server_obj);
+    anj_dm_security_obj_init(&dev->security_obj);
+    if (anj_dm_device_obj_install(&dev->anj, &dev->device_obj,
+                                  &device_obj_conf)
+            || anj_dm_server_obj_add_instance(&dev->server_obj, &server_inst)
+            || anj_dm_server_obj_install(&dev->anj, &dev->server_obj)
+            || anj_dm_security_obj_add_instance(&dev->security_obj,
+                                                &security_inst)
+            || anj_dm_security_obj_install(&dev->anj, &dev->security_obj)
+            || anj_dm_add_obj(&dev->anj, sensor_obj)) {
+        return -1;
+    }
+    return 0;
+}
+
+// Spreads the given events of the devices evenly over one period, so that the
+// LwM2M Server is not hit by all of them at once
+static anj_time_monotonic_t staggered(anj_time_monotonic_t start,
+                                      anj_time_duration_t period,
+                                      size_t index,
+                                      size_t count) {
+    double fraction = (double) index / (double) count;
+    return anj_time_monotonic_add(start,
+                                  anj_time_duration_fmul(period, fraction));
+}
+
+static int device_init(virtual_device_t *dev,
+                       size_t index,
+                       const options_t *opts,
+                       const anj_dm_obj_t *sensor_obj,
+                       anj_time_monotonic_t start) {
+    snprintf(dev->endpoint_name, sizeof(dev->endpoint_name), "%s-%zu",
+             opts->endpoint_prefix, index);
+    anj_configuration_t config = {
+        .endpoint_name = dev->endpoint_name,
+        .connection_status_cb = conn_status_changed
+    };
+    if (anj_core_init(&dev->anj, &config)
+            || install_objects(dev, opts, sensor_obj)) {
+        log(L_ERROR, "Failed to initialize %s", dev->endpoint_name);
+        return -1;
+    }
+    for (uint16_t i = 0; i < opts->instance_count; i++) {
+        dev->sensor.values[i] = 20.0;
+    }
+    dev->sensor.seed = (unsigned int) rand();
+    dev->index = index;
+    dev->next_step = staggered(start, opts->ramp_up, index, opts->device_count);
+    dev->next_notify =
+            anj_time_duration_is_valid(opts->notify_period)
+                    ? staggered(dev->next_step, opts->notify_period, index,
+                                opts->device_count)
+                    : ANJ_TIME_MONOTONIC_INVALID;
+    dev->next_send = anj_time_duration_is_valid(opts->send_period)
+                             ? staggered(dev->next_step, opts->send_period,
+                                         index, opts->device_count)
+                             : ANJ_TIME_MONOTONIC_INVALID;
+    return 0;
+}
+
+static bool is_due(anj_time_monotonic_t deadline, anj_time_monotonic_t now) {
+    return anj_time_monotonic_is_valid(deadline)
+           && !anj_time_monotonic_gt(deadline, now);
+}
+
+static void earliest(anj_time_monotonic_t *inout_deadline,
+                     anj_time_monotonic_t candidate) {
+    if (anj_time_monotonic_is_valid(candidate)
+            && (!anj_time_monotonic_is_valid(*inout_deadline)
+                || anj_time_monotonic_lt(candidate, *inout_deadline))) {
+        *inout_deadline = candidate;
+    }
+}
+
+static void step_device(virtual_device_t *dev) {
+    anj_core_step(&dev->anj);
+
+    anj_time_duration_t timeout;
+    anj_net_poll_handle_t handle;
+    anj_core_wakeup_t wakeup =
+            anj_core_next_wakeup(&dev->anj, &timeout, &handle);
+    anj_time_monotonic_t now = anj_time_monotonic_now();
+    if (wakeup == ANJ_CORE_WAKEUP_NOW) {
+        dev->next_step = now;
+        return;
+    }
+    dev->next_step = anj_time_duration_is_valid(timeout)
+                             ? anj_time_monotonic_add(now, timeout)
+                             : ANJ_TIME_MONOTONIC_INVALID;
+    if (wakeup == ANJ_CORE_WAKEUP_NET_OR_TIMER) {
+        // The descriptor may have been closed and reused by another device in
+        // the meantime, so it's always (re)assigned to the current owner.
+        // Closed descriptors are removed from the epoll set by the kernel.
+        // A one-shot event isn't reported again while the device waits for
+        // a worker, until it's re-armed here.
+        struct epoll_event event = {
+            .events = EPOLLIN | EPOLLONESHOT,
+            .data.ptr = dev
+        };
+        if (epoll_ctl(g_loop.epoll_fd, EPOLL_CTL_MOD, handle.fd, &event)
+                && (errno != ENOENT
+                    || epoll_ctl(g_loop.epoll_fd, EPOLL_CTL_ADD, handle.fd,
+                                 &event))) {
+            log(L_WARNING, "Could not poll socket of %s, falling back to timer",
+                dev->endpoint_name);
+            if (!anj_time_monotonic_is_valid(dev->next_step)) {
+                dev->next_step = anj_time_monotonic_add(
+                        now, anj_time_duration_new(1, ANJ_TIME_UNIT_S));
+            }
+        }
+    }
+}
+
+static void
+send_finished(anj_t *anj, uint16_t send_id, int result, void *data) {
+    (void) anj;
+    (void) send_id;
+    virtual_device_t *dev = (virtual_device_t *) data;
+    dev->send_in_progress = false;
+    if (result == ANJ_SEND_SUCCESS) {
+        count(&g_counters.sends_succeeded, 1);
+    } else {
+        count(&g_counters.sends_failed, 1);
+    }
+}
+
+static void generate_notify_traffic(virtual_device_t *dev,
+                                    const options_t *opts) {
+    sensor_obj_state_update(&dev->sensor, opts->instance_count);
+    for (uint16_t i = 0; i < opts->instance_count; i++) {
+        anj_core_data_model_changed(
+                &dev->anj,
+                &ANJ_MAKE_RESOURCE_PATH(SENSOR_OID, i, SENSOR_RID_VALUE),
+                ANJ_CORE_CHANGE_TYPE_VALUE_CHANGED);
+    }
+    count(&g_counters.notify_changes, opts->instance_count);
+}
+
+static void generate_send_traffic(virtual_device_t *dev,
+                                  const options_t *opts) {
+    // the previous Send is still in progress, or the device is not registered
+    if (dev->send_in_progress || !dev->registered) {
+        count(&g_counters.sends_skipped, 1);
+        return;
+    }
+    double timestamp =
+            anj_time_real_to_fscalar(anj_time_real_now(), ANJ_TIME_UNIT_S);
+    for (uint16_t i = 0; i < opts->instance_count; i++) {
+        dev->send_records[i] = (anj_io_out_entry_t) {
+            .path = ANJ_MAKE_RESOURCE_PATH(SENSOR_OID, i, SENSOR_RID_VALUE),
+            .type = ANJ_DATA_TYPE_DOUBLE,
+            .value.double_value = dev->sensor.values[i],
+            .timestamp = timestamp
+        };
+    }
+    dev->send_request = (anj_send_request_t) {
+        .finished_handler = send_finished,
+        .data = dev,
+        .content_format = ANJ_SEND_CONTENT_FORMAT_SENML_CBOR,
+        .records_cnt = opts->instance_count,
+        .records = dev->send_records
+    };
+    uint16_t send_id;
+    if (anj_send_new_request(&dev->anj, &dev->send_request, &send_id)) {
+        count(&g_counters.sends_skipped, 1);
+        return;
+    }
+    dev->send_in_progress = true;
+}
+
+static int64_t deadline_us(anj_time_monotonic_t deadline) {
+    return anj_time_monotonic_is_valid(deadline)
+                   ? anj_time_monotonic_to_scalar(deadline, ANJ_TIME_UNIT_US)
+                   : WAIT_FOREVER;
+}
+
+static anj_time_monotonic_t device_deadline(const virtual_device_t *dev) {
+    anj_time_monotonic_t deadline = dev->next_step;
+    earliest(&deadline, dev->next_notify);
+    earliest(&deadline, dev->next_send);
+    return deadline;
+}
+
+// Runs by a worker (or the main thread, if there are no workers) everything
+// the device is ready for
+static void device_run(void *item) {
+    virtual_device_t *dev = (virtual_device_t *) item;
+    const options_t *opts = g_loop.opts;
+    int64_t deadline;
+    uint32_t state;
+    do {
+        anj_time_monotonic_t now = anj_time_monotonic_now();
+        if (is_due(dev->next_notify, now)) {
+            dev->next_notify = anj_time_monotonic_add(now, opts->notify_period);
+            generate_notify_traffic(dev, opts);
+        }
+        if (is_due(dev->next_send, now)) {
+            dev->next_send = anj_time_monotonic_add(now, opts->send_period);
+            generate_send_traffic(dev, opts);
+        }
+        step_device(dev);
+        // the fields can't be read anymore once the device is idle
+        deadline = deadline_us(device_deadline(dev));
+        state = DEVICE_QUEUED;
+        if (__atomic_compare_exchange_n(&dev->state, &state, DEVICE_IDLE,
+                                        false, __ATOMIC_SEQ_CST,
+                                        __ATOMIC_SEQ_CST)) {
+            break;
+        }
+        __atomic_store_n(&dev->state, DEVICE_QUEUED, __ATOMIC_RELAXED);
+    } while (true);
+
+    // Either the main thread has seen the device idle while scanning, or the
+    // deadline it waits for is read here.
+    int64_t wait_deadline =
+            __atomic_load_n(&g_loop.wait_deadline_us, __ATOMIC_SEQ_CST);
+    if (g_loop.threaded && deadline != WAIT_FOREVER
+            && (wait_deadline == WAIT_SCANNING || deadline < wait_deadline)) {
+        uint64_t one = 1;
+        (void) !write(g_loop.event_fd, &one, sizeof(one));
+    }
+}
+
+// Queues the device for a worker, unless it's already queued; then the worker
+// runs it again afterwards
+static void device_schedule(worker_pool_t *pool, virtual_device_t *dev) {
+    uint32_t state = __atomic_load_n(&dev->state, __ATOMIC_SEQ_CST);
+    while (state != DEVICE_RESCHEDULED) {
+        uint32_t desired =
+                state == DEVICE_IDLE ? DEVICE_QUEUED : DEVICE_RESCHEDULED;
+        if (__atomic_compare_exchange_n(&dev->state, &state, desired, false,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+            if (desired == DEVICE_QUEUED) {
+                worker_pool_push(pool, dev, dev->index);
+            }
+            return;
+        }
+    }
+}
+
+static bool device_is_idle(const virtual_device_t *dev) {
+    return __atomic_load_n(&dev->state, __ATOMIC_SEQ_CST) == DEVICE_IDLE;
+}
+
+// Adds the latencies of one device to the totals
+static void histogram_merge(anj_metrics_histogram_t *total,
+                            const anj_metrics_histogram_t *histogram) {
+    for (size_t i = 0; i < ANJ_METRICS_HISTOGRAM_BUCKETS; i++) {
+        total->buckets[i] += histogram->buckets[i];
+    }
+}
+
+static void print_percentiles(const char *name,
+                              const anj_metrics_histogram_t *histogram) {
+    printf("  %-16s", name);
+    static const uint8_t percents[] = { 50, 90, 99 };
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(percents); i++) {
+        anj_time_duration_t bound =
+                anj_metrics_histogram_percentile(histogram, percents[i]);
+        if (anj_time_duration_is_valid(bound)) {
+            printf(" p%u <= %" PRId64 " ms", (unsigned) percents[i],
+                   anj_time_duration_to_scalar(bound, ANJ_TIME_UNIT_MS));
+        } else {
+            printf(" p%u n/a", (unsigned) percents[i]);
+        }
+    }
+    printf("\n");
+}
+
+static void report(virtual_device_t *devices,
+                   const options_t *opts,
+                   anj_time_duration_t elapsed,
+                   anj_time_duration_t interval) {
+    anj_metrics_t total = { 0 };
+    for (size_t i = 0; i < opts->device_count; i++) {
+        anj_metrics_t metrics;
+        anj_core_metrics_get(&devices[i].anj, &metrics);
+        anj_core_metrics_reset(&devices[i].anj);
+        total.exchanges += metrics.exchanges;
+        total.retransmissions += metrics.retransmissions;
+        total.notifications_sent += metrics.notifications_sent;
+        total.bytes_sent += metrics.bytes_sent;
+        total.bytes_received += metrics.bytes_received;
+        for (size_t h = 0; h < ANJ_METRICS_HISTOGRAM_COUNT; h++) {
+            histogram_merge(&total.histograms[h], &metrics.histograms[h]);
+        }
+    }
+    double seconds = anj_time_duration_to_fscalar(interval, ANJ_TIME_UNIT_S);
+    printf("[%" PRId64 " s] registered %zu/%zu\n",
+           anj_time_duration_to_scalar(elapsed, ANJ_TIME_UNIT_S),
+           g_counters.registered, opts->device_count);
+    printf("  exchanges %.1f/s, notifications %.1f/s, retransmissions "
+           "%.1f/s\n",
+           total.exchanges / seconds, total.notifications_sent / seconds,
+           total.retransmissions / seconds);
+    printf("  sent %.1f kB/s, received %.1f kB/s\n",
+           (double) total.bytes_sent / seconds / 1000.0,
+           (double) total.bytes_received / seconds / 1000.0);
+    printf("  value changes %" PRIu32 ", Send succeeded %" PRIu32
+           ", failed %" PRIu32 ", skipped %" PRIu32 "\n",
+           g_counters.notify_changes, g_counters.sends_succeeded,
+           g_counters.sends_failed, g_counters.sends_skipped);
+    print_percentiles(
+            "server request",
+            &total.histograms[ANJ_METRICS_HISTOGRAM_SERVER_REQUEST]);
+    print_percentiles(
+            "notify build",
+            &total.histograms[ANJ_METRICS_HISTOGRAM_NOTIFICATION_BUILD]);
+    print_percentiles("send", &total.histograms[ANJ_METRICS_HISTOGRAM_SEND]);
+    print_percentiles("ack rtt",
+                      &total.histograms[ANJ_METRICS_HISTOGRAM_ACK_RTT]);
+    fflush(stdout);
+    g_counters.notify_changes = 0;
+    g_counters.sends_succeeded = 0;
+    g_counters.sends_failed = 0;
+    g_counters.sends_skipped = 0;
+}
+
+// Each device needs its own socket
+static void raise_fd_limit(size_t device_count) {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit)) {
+        return;
+    }
+    rlim_t needed = (rlim_t) device_count + 16;
+    if (limit.rlim_cur < needed) {
+        limit.rlim_cur =
+                limit.rlim_max < needed ? limit.rlim_max : needed;
+        (void) setrlimit(RLIMIT_NOFILE, &limit);
+        if (limit.rlim_cur < needed) {
+            log(L_WARNING, "File descriptor limit too low for %zu devices",
+                device_count);
+        }
+    }
+}
+
+static int epoll_timeout_ms(anj_time_monotonic_t deadline,
+                            anj_time_monotonic_t now) {
+    if (!anj_time_monotonic_is_valid(deadline)) {
+        return -1;
+    }
+    int64_t us = anj_time_duration_to_scalar(
+            anj_time_monotonic_diff(deadline, now), ANJ_TIME_UNIT_US);
+    if (us <= 0) {
+        return 0;
+    }
+    // rounded up, so that the deadline has passed after the wait
+    int64_t ms = (us + 999) / 1000;
+    return ms > INT_MAX ? INT_MAX : (int) ms;
+}
+
+static void print_usage(const char *name) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -s URI     LwM2M Server URI (default: coap://127.0.0.1:5683)\n"
+            "  -e PREFIX  endpoint name prefix, suffixed with the device "
+            "index\n"
+            "             (default: anjay-lite-load)\n"
+            "  -n COUNT   number of virtual devices (default: 100)\n"
+            "  -t COUNT   worker threads stepping the devices, 0 to step them "
+            "from\n"
+            "             the main thread (default: number of CPUs)\n"
+            "  -i COUNT   Sensor Object Instances per device, 1-%d "
+            "(default: 1)\n"
+            "  -l SEC     lifetime (default: 300)\n"
+            "  -w SEC     ramp-up time over which devices start (default: "
+            "10)\n"
+            "  -N MS      period of value changes, 0 to disable "
+            "(default: 0)\n"
+            "  -S MS      period of Send requests, 0 to disable "
+            "(default: 0)\n"
+            "  -r SEC     report period (default: 5)\n"
+            "  -d SEC     run time, 0 to run forever (default: 0)\n",
+            name, SENSOR_MAX_INSTANCES);
+}
+
+static anj_time_duration_t period_arg(const char *arg, anj_time_unit_t unit) {
+    long value = strtol(arg, NULL, 10);
+    return value > 0 ? anj_time_duration_new(value, unit)
+                     : ANJ_TIME_DURATION_INVALID;
+}
+
+static size_t online_cpus(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (size_t) cpus : 1;
+}
+
+static int parse_options(int argc, char *argv[], options_t *opts) {
+    *opts = (options_t) {
+        .server_uri = "coap://127.0.0.1:5683",
+        .endpoint_prefix = "anjay-lite-load",
+        .device_count = 100,
+        .thread_count = online_cpus(),
+        .instance_count = 1,
+        .lifetime = 300,
+        .ramp_up = anj_time_duration_new(10, ANJ_TIME_UNIT_S),
+        .notify_period = ANJ_TIME_DURATION_INVALID,
+        .send_period = ANJ_TIME_DURATION_INVALID,
+        .report_period = anj_time_duration_new(5, ANJ_TIME_UNIT_S),
+        .duration = ANJ_TIME_DURATION_INVALID
+    };
+    int opt;
+    while ((opt = getopt(argc, argv, "s:e:n:t:i:l:w:N:S:r:d:")) != -1) {
+        switch (opt) {
+        case 's':
+            opts->server_uri = optarg;
+            break;
+        case 'e':
+            opts->endpoint_prefix = optarg;
+            break;
+        case 'n':
+            opts->device_count = (size_t) strtoul(optarg, NULL, 10);
+            break;
+        case 't':
+            opts->thread_count = (size_t) strtoul(optarg, NULL, 10);
+            break;
+        case 'i':
+            opts->instance_count = (uint16_t) strtoul(optarg, NULL, 10);
+            break;
+        case 'l':
+            opts->lifetime = (uint32_t) strtoul(optarg, NULL, 10);
+            break;
+        case 'w':
+            opts->ramp_up = period_arg(optarg, ANJ_TIME_UNIT_S);
+            if (!anj_time_duration_is_valid(opts->ramp_up)) {
+                opts->ramp_up = ANJ_TIME_DURATION_ZERO;
+            }
+            break;
+        case 'N':
+            opts->notify_period = period_arg(optarg, ANJ_TIME_UNIT_MS);
+            break;
+        case 'S':
+            opts->send_period = period_arg(optarg, ANJ_TIME_UNIT_MS);
+            break;
+        case 'r':
+            opts->report_period = period_arg(optarg, ANJ_TIME_UNIT_S);
+            break;
+        case 'd':
+            opts->duration = period_arg(optarg, ANJ_TIME_UNIT_S);
+            break;
+        default:
+            return -1;
+        }
+    }
+    if (!opts->device_count || !opts->instance_count
+            || opts->instance_count > SENSOR_MAX_INSTANCES || !opts->lifetime
+            || !anj_time_duration_is_valid(opts->report_period)) {
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    options_t opts;
+    if (parse_options(argc, argv, &opts)) {
+        print_usage(argv[0]);
+        return -1;
+    }
+    srand((unsigned int) time(NULL));
+    raise_fd_limit(opts.device_count);
+
+    virtual_device_t *devices =
+            (virtual_device_t *) calloc(opts.device_count, sizeof(*devices));
+    g_loop.opts = &opts;
+    g_loop.threaded = opts.thread_count > 0;
+    g_loop.epoll_fd = epoll_create1(0);
+    g_loop.event_fd = eventfd(0, EFD_NONBLOCK);
+    // the eventfd is told apart from the devices by a NULL pointer
+    struct epoll_event wakeup_event = {
+        .events = EPOLLIN,
+        .data.ptr = NULL
+    };
+    if (!devices || g_loop.epoll_fd < 0 || g_loop.event_fd < 0
+            || epoll_ctl(g_loop.epoll_fd, EPOLL_CTL_ADD, g_loop.event_fd,
+                         &wakeup_event)) {
+        log(L_ERROR, "Failed to allocate %zu devices", opts.device_count);
+        return -1;
+    }
+    worker_pool_t *pool =
+            worker_pool_new(opts.thread_count, opts.device_count, device_run);
+    if (!pool) {
+        log(L_ERROR, "Failed to start %zu worker threads", opts.thread_count);
+        return -1;
+    }
+    const anj_dm_obj_t *sensor_obj =
+            sensor_obj_template_init(opts.instance_count, get_sensor_state);
+    anj_time_monotonic_t start = anj_time_monotonic_now();
+    for (size_t i = 0; i < opts.device_count; i++) {
+        if (device_init(&devices[i], i, &opts, sensor_obj, start)) {
+            return -1;
+        }
+    }
+    printf("%zu devices (%zu bytes each) connecting to %s, %zu worker "
+           "threads\n",
+           opts.device_count, sizeof(virtual_device_t), opts.server_uri,
+           opts.thread_count);
+
+    anj_time_monotonic_t last_report = start;
+    anj_time_monotonic_t end =
+            anj_time_duration_is_valid(opts.duration)
+                    ? anj_time_monotonic_add(start, opts.duration)
+                    : ANJ_TIME_MONOTONIC_INVALID;
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+    while (true) {
+        anj_time_monotonic_t now = anj_time_monotonic_now();
+        // Workers leaving a device during the scan wake the main thread up
+        // unconditionally, as it may have already skipped the device.
+        __atomic_store_n(&g_loop.wait_deadline_us, WAIT_SCANNING,
+                         __ATOMIC_SEQ_CST);
+        // A linear scan over thousands of devices is cheap compared to the
+        // network I/O; a timer heap is worth it only for much larger fleets.
+        anj_time_monotonic_t deadline =
+                anj_time_monotonic_add(last_report, opts.report_period);
+        earliest(&deadline, end);
+        for (size_t i = 0; i < opts.device_count; i++) {
+            virtual_device_t *dev = &devices[i];
+            if (!device_is_idle(dev)) {
+                continue;
+            }
+            anj_time_monotonic_t dev_deadline = device_deadline(dev);
+            if (is_due(dev_deadline, now)) {
+                device_schedule(pool, dev);
+                // without workers it has already been run
+                if (!device_is_idle(dev)) {
+                    continue;
+                }
+                dev_deadline = device_deadline(dev);
+            }
+            earliest(&deadline, dev_deadline);
+        }
+        worker_pool_wake(pool);
+        __atomic_store_n(&g_loop.wait_deadline_us, deadline_us(deadline),
+                         __ATOMIC_SEQ_CST);
+
+        int count = epoll_wait(g_loop.epoll_fd, events, MAX_EPOLL_EVENTS,
+                               epoll_timeout_ms(deadline, now));
+        for (int i = 0; i < count; i++) {
+            if (events[i].data.ptr) {
+                device_schedule(pool, (virtual_device_t *) events[i].data.ptr);
+            } else {
+                uint64_t value;
+                (void) !read(g_loop.event_fd, &value, sizeof(value));
+            }
+        }
+        worker_pool_wake(pool);
+
+        now = anj_time_monotonic_now();
+        bool report_due =
+                is_due(anj_time_monotonic_add(last_report, opts.report_period),
+                       now);
+        if (report_due || is_due(end, now)) {
+            // metrics are read from idle devices only
+            worker_pool_drain(pool);
+        }
+        if (report_due) {
+            report(devices, &opts, anj_time_monotonic_diff(now, start),
+                   anj_time_monotonic_diff(now, last_report));
+            last_report = now;
+        }
+        if (is_due(end, now)) {
+            break;
+        }
+    }
+
+    worker_pool_delete(pool);
+    for (size_t i = 0; i < opts.device_count; i++) {
+        anj_core_shutdown(&devices[i].anj);
+    }
+    close(g_loop.event_fd);
+    close(g_loop.epoll_fd);
+    free(devices);
+    return 0;
+}
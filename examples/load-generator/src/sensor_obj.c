@@ -0,0 +1,109 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/dm/core.h>
+#include <anj/utils.h>
+
+#include "sensor_obj.h"
+
+#define RID_SENSOR_UNIT 5701
+
+#define MIN_VALUE -10.0
+#define MAX_VALUE 40.0
+
+static const anj_dm_res_t RES[] = {
+    {
+        .rid = SENSOR_RID_VALUE,
+        .type = ANJ_DATA_TYPE_DOUBLE,
+        .kind = ANJ_DM_RES_R
+    },
+    {
+        .rid = RID_SENSOR_UNIT,
+        .type = ANJ_DATA_TYPE_STRING,
+        .kind = ANJ_DM_RES_R
+    }
+};
+
+static sensor_obj_state_getter_t *g_get_state;
+
+static int res_read(anj_t *anj,
+                    const anj_dm_obj_t *obj,
+                    anj_iid_t iid,
+                    anj_rid_t rid,
+                    anj_riid_t riid,
+                    anj_res_value_t *out_value) {
+    (void) obj;
+    (void) riid;
+
+    switch (rid) {
+    case SENSOR_RID_VALUE:
+        out_value->double_value = g_get_state(anj)->values[iid];
+        return 0;
+    case RID_SENSOR_UNIT:
+        out_value->bytes_or_string.data = "C";
+        return 0;
+    default:
+        return ANJ_DM_ERR_NOT_FOUND;
+    }
+}
+
+static const anj_dm_handlers_t HANDLERS = {
+    .res_read = res_read
+};
+
+// Instances and the Object itself are identical for every virtual device,
+// only the values differ
+static anj_dm_obj_inst_t g_insts[SENSOR_MAX_INSTANCES];
+static anj_dm_obj_t g_obj;
+
+const anj_dm_obj_t *
+sensor_obj_template_init(uint16_t instance_count,
+                         sensor_obj_state_getter_t *get_state) {
+    assert(instance_count > 0 && instance_count <= SENSOR_MAX_INSTANCES);
+    assert(get_state);
+    g_get_state = get_state;
+    for (uint16_t i = 0; i < instance_count; i++) {
+        g_insts[i] = (anj_dm_obj_inst_t) {
+            .iid = i,
+            .res_count = ANJ_ARRAY_SIZE(RES),
+            .resources = RES
+        };
+    }
+    g_obj = (anj_dm_obj_t) {
+        .oid = SENSOR_OID,
+        .version = "1.1",
+        .insts = g_insts,
+        .handlers = &HANDLERS,
+        .max_inst_count = instance_count
+    };
+    return &g_obj;
+}
+
+void sensor_obj_state_update(sensor_obj_state_t *state,
+                             uint16_t instance_count) {
+    for (uint16_t i = 0; i < instance_count; i++) {
+        // random walk in [-0.5, 0.5] steps
+        double value = state->values[i]
+                       + (double) rand_r(&state->seed) / RAND_MAX - 0.5;
+        if (value < MIN_VALUE) {
+            value = MIN_VALUE;
+        } else if (value > MAX_VALUE) {
+            value = MAX_VALUE;
+        }
+        state->values[i] = value;
+    }
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef SENSOR_OBJ_H
+#define SENSOR_OBJ_H
+
+#include <stdint.h>
+
+#include <anj/core.h>
+#include <anj/dm/core.h>
+
+#define SENSOR_OID 3303
+#define SENSOR_RID_VALUE 5700
+#define SENSOR_MAX_INSTANCES 16
+
+// Values of the Sensor Object Instances of a single virtual device.
+typedef struct {
+    double values[SENSOR_MAX_INSTANCES];
+    // devices may be updated from different threads, so each has its own
+    // random number generator state
+    unsigned int seed;
+} sensor_obj_state_t;
+
+// Returns the state of the virtual device the anj object belongs to.
+typedef sensor_obj_state_t *sensor_obj_state_getter_t(anj_t *anj);
+
+// Prepares the Object definition shared by all virtual devices, with
+// instance_count Instances (at most SENSOR_MAX_INSTANCES). Handlers look up
+// the values of the device they are called for with get_state.
+const anj_dm_obj_t *
+sensor_obj_template_init(uint16_t instance_count,
+                         sensor_obj_state_getter_t *get_state);
+
+// Simulates a new readout of all Instances.
+void sensor_obj_state_update(sensor_obj_state_t *state,
+                             uint16_t instance_count);
+
+#endif // SENSOR_OBJ_H
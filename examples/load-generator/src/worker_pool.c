@@ -0,0 +1,251 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "worker_pool.h"
+
+// Tasks of the load generator are short and fairly even, so a deque guarded
+// by a mutex contends rarely enough; a lock-free one isn't worth the
+// complexity.
+typedef struct {
+    pthread_mutex_t mutex;
+    void **items;
+    size_t head;
+    size_t count;
+} deque_t;
+
+typedef struct {
+    worker_pool_t *pool;
+    deque_t deque;
+    pthread_t thread;
+    // state of the generator picking the first victim to steal from
+    uint32_t random;
+} worker_t;
+
+struct worker_pool_struct {
+    worker_pool_task_t *run;
+    size_t capacity;
+    size_t worker_count;
+    worker_t *workers;
+
+    // items in the deques, and items pushed but not finished yet
+    size_t queued;
+    size_t pending;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t work_cond;
+    pthread_cond_t drained_cond;
+    size_t sleeping;
+    bool stop;
+};
+
+static void deque_push_back(deque_t *deque, size_t capacity, void *item) {
+    pthread_mutex_lock(&deque->mutex);
+    assert(deque->count < capacity);
+    deque->items[(deque->head + deque->count++) % capacity] = item;
+    pthread_mutex_unlock(&deque->mutex);
+}
+
+static void *deque_pop_back(deque_t *deque, size_t capacity) {
+    void *item = NULL;
+    pthread_mutex_lock(&deque->mutex);
+    if (deque->count) {
+        item = deque->items[(deque->head + --deque->count) % capacity];
+    }
+    pthread_mutex_unlock(&deque->mutex);
+    return item;
+}
+
+static void *deque_pop_front(deque_t *deque, size_t capacity) {
+    void *item = NULL;
+    pthread_mutex_lock(&deque->mutex);
+    if (deque->count) {
+        item = deque->items[deque->head];
+        deque->head = (deque->head + 1) % capacity;
+        deque->count--;
+    }
+    pthread_mutex_unlock(&deque->mutex);
+    return item;
+}
+
+static uint32_t xorshift(uint32_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static void *steal(worker_t *self) {
+    worker_pool_t *pool = self->pool;
+    size_t first = xorshift(&self->random) % pool->worker_count;
+    for (size_t i = 0; i < pool->worker_count; i++) {
+        worker_t *victim = &pool->workers[(first + i) % pool->worker_count];
+        if (victim == self) {
+            continue;
+        }
+        void *item = deque_pop_front(&victim->deque, pool->capacity);
+        if (item) {
+            return item;
+        }
+    }
+    return NULL;
+}
+
+static void finish(worker_pool_t *pool) {
+    if (!__atomic_sub_fetch(&pool->pending, 1, __ATOMIC_ACQ_REL)) {
+        pthread_mutex_lock(&pool->mutex);
+        pthread_cond_broadcast(&pool->drained_cond);
+        pthread_mutex_unlock(&pool->mutex);
+    }
+}
+
+static void *worker_run(void *arg) {
+    worker_t *self = (worker_t *) arg;
+    worker_pool_t *pool = self->pool;
+    while (true) {
+        void *item = deque_pop_back(&self->deque, pool->capacity);
+        if (!item) {
+            item = steal(self);
+        }
+        if (item) {
+            __atomic_sub_fetch(&pool->queued, 1, __ATOMIC_RELAXED);
+            pool->run(item);
+            finish(pool);
+            continue;
+        }
+        // an item counted in queued, but not pushed yet, is retried at once
+        pthread_mutex_lock(&pool->mutex);
+        while (!pool->stop
+               && !__atomic_load_n(&pool->queued, __ATOMIC_RELAXED)) {
+            pool->sleeping++;
+            pthread_cond_wait(&pool->work_cond, &pool->mutex);
+            pool->sleeping--;
+        }
+        bool stop = pool->stop;
+        pthread_mutex_unlock(&pool->mutex);
+        if (stop) {
+            return NULL;
+        }
+    }
+}
+
+static void stop_workers(worker_pool_t *pool, size_t started) {
+    pthread_mutex_lock(&pool->mutex);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->mutex);
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+}
+
+static void free_pool(worker_pool_t *pool) {
+    for (size_t i = 0; i < pool->worker_count; i++) {
+        pthread_mutex_destroy(&pool->workers[i].deque.mutex);
+        free(pool->workers[i].deque.items);
+    }
+    pthread_cond_destroy(&pool->drained_cond);
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_mutex_destroy(&pool->mutex);
+    free(pool->workers);
+    free(pool);
+}
+
+worker_pool_t *worker_pool_new(size_t worker_count,
+                               size_t capacity,
+                               worker_pool_task_t *run) {
+    assert(capacity && run);
+    worker_pool_t *pool = (worker_pool_t *) calloc(1, sizeof(*pool));
+    if (!pool) {
+        return NULL;
+    }
+    pool->run = run;
+    pool->capacity = capacity;
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->work_cond, NULL);
+    pthread_cond_init(&pool->drained_cond, NULL);
+    if (!worker_count) {
+        return pool;
+    }
+    pool->workers = (worker_t *) calloc(worker_count, sizeof(worker_t));
+    if (!pool->workers) {
+        free_pool(pool);
+        return NULL;
+    }
+    pool->worker_count = worker_count;
+    for (size_t i = 0; i < worker_count; i++) {
+        worker_t *worker = &pool->workers[i];
+        worker->pool = pool;
+        worker->random = (uint32_t) i * 2654435761u + 1;
+        pthread_mutex_init(&worker->deque.mutex, NULL);
+    }
+    for (size_t i = 0; i < worker_count; i++) {
+        pool->workers[i].deque.items =
+                (void **) malloc(capacity * sizeof(void *));
+        if (!pool->workers[i].deque.items) {
+            free_pool(pool);
+            return NULL;
+        }
+    }
+    for (size_t i = 0; i < worker_count; i++) {
+        if (pthread_create(&pool->workers[i].thread, NULL, worker_run,
+                           &pool->workers[i])) {
+            stop_workers(pool, i);
+            free_pool(pool);
+            return NULL;
+        }
+    }
+    return pool;
+}
+
+void worker_pool_push(worker_pool_t *pool, void *item, size_t hint) {
+    assert(item);
+    __atomic_add_fetch(&pool->pending, 1, __ATOMIC_RELAXED);
+    if (!pool->worker_count) {
+        pool->run(item);
+        finish(pool);
+        return;
+    }
+    __atomic_add_fetch(&pool->queued, 1, __ATOMIC_RELAXED);
+    deque_push_back(&pool->workers[hint % pool->worker_count].deque,
+                    pool->capacity, item);
+}
+
+void worker_pool_wake(worker_pool_t *pool) {
+    pthread_mutex_lock(&pool->mutex);
+    if (pool->sleeping && __atomic_load_n(&pool->queued, __ATOMIC_RELAXED)) {
+        pthread_cond_broadcast(&pool->work_cond);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+void worker_pool_drain(worker_pool_t *pool) {
+    pthread_mutex_lock(&pool->mutex);
+    while (__atomic_load_n(&pool->pending, __ATOMIC_ACQUIRE)) {
+        pthread_cond_wait(&pool->drained_cond, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+void worker_pool_delete(worker_pool_t *pool) {
+    if (!pool) {
+        return;
+    }
+    worker_pool_drain(pool);
+    stop_workers(pool, pool->worker_count);
+    free_pool(pool);
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <stddef.h>
+
+// Runs a single task; called from one of the worker threads.
+typedef void worker_pool_task_t(void *item);
+
+typedef struct worker_pool_struct worker_pool_t;
+
+// Starts worker_count threads, each with its own deque of at most capacity
+// items. Workers take items from the back of their own deque and, once it is
+// empty, steal from the front of the deques of the others. With worker_count
+// equal to 0, items are run in the calling thread when pushed.
+worker_pool_t *worker_pool_new(size_t worker_count,
+                               size_t capacity,
+                               worker_pool_task_t *run);
+
+// Queues an item on the deque of the worker selected by hint, so that the
+// same item tends to be run by the same worker. The caller must ensure that
+// an item is queued at most once at a time, and that at most capacity items
+// are queued in total.
+void worker_pool_push(worker_pool_t *pool, void *item, size_t hint);
+
+// Wakes up idle workers after a batch of worker_pool_push() calls.
+void worker_pool_wake(worker_pool_t *pool);
+
+// Waits until all pushed items have been run.
+void worker_pool_drain(worker_pool_t *pool);
+
+// Drains the pool and stops the workers.
+void worker_pool_delete(worker_pool_t *pool);
+
+#endif // WORKER_POOL_H
@@ -0,0 +1,389 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/dm/core.h>
+#include <anj/log.h>
+#include <anj/utils.h>
+
+// benchmarks call internal functions of the library directly, to measure them
+// without the network
+#include "../../../src/anj/coap/coap.h"
+#include "../../../src/anj/dm/dm_io.h"
+#include "../../../src/anj/exchange.h"
+#include "../../../src/anj/io/io.h"
+#include "../../../src/anj/observe/observe.h"
+
+#include "platform.h"
+
+#define log(...) anj_log(bench, __VA_ARGS__)
+
+// Timed runs of each benchmark, preceded by BENCH_WARMUP_RUNS untimed ones
+// that fill the caches and branch predictors, where the core has them
+#define BENCH_RUNS 101
+#define BENCH_WARMUP_RUNS 10
+
+// Stack below the benchmark runner filled with a pattern before each
+// benchmark, the deepest overwritten byte gives the stack high-water mark
+#ifndef BENCH_STACK_PAINT_SIZE
+#    define BENCH_STACK_PAINT_SIZE 4096
+#endif // BENCH_STACK_PAINT_SIZE
+#define BENCH_STACK_PATTERN 0xA5
+
+#define TEMPERATURE_OID 3303
+#define TEMPERATURE_INSTANCES 8
+#define SENSOR_VALUE_RID 5700
+#define MIN_MEASURED_VALUE_RID 5601
+#define MAX_MEASURED_VALUE_RID 5602
+#define RESET_MIN_MAX_RID 5605
+#define SENSOR_UNITS_RID 5701
+
+#if ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER < 2 * TEMPERATURE_INSTANCES
+#    error "ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER too low for the benchmarks"
+#endif
+
+typedef struct {
+    const char *name;
+    // performs one operation, returns 0 on success
+    int (*run)(void);
+} benchmark_t;
+
+static anj_t g_anj;
+static _anj_exchange_ctx_t g_exchange;
+static const _anj_observe_server_state_t g_server_state = {
+    .is_server_online = true,
+    .ssid = 1,
+    .default_max_period = 60
+};
+static uint8_t g_payload[256];
+static uint8_t g_msg[300];
+static uint32_t g_times[BENCH_RUNS];
+static uintptr_t g_stack_painted;
+
+static int res_read(anj_t *anj,
+                    const anj_dm_obj_t *obj,
+                    anj_iid_t iid,
+                    anj_rid_t rid,
+                    anj_riid_t riid,
+                    anj_res_value_t *out_value) {
+    (void) anj;
+    (void) obj;
+    (void) riid;
+    if (rid == SENSOR_UNITS_RID) {
+        out_value->bytes_or_string.data = "Cel";
+    } else {
+        out_value->double_value = 20.0 + (double) iid;
+    }
+    return 0;
+}
+
+static int res_execute(anj_t *anj,
+                       const anj_dm_obj_t *obj,
+                       anj_iid_t iid,
+                       anj_rid_t rid,
+                       const char *execute_arg,
+                       size_t execute_arg_len) {
+    (void) anj;
+    (void) obj;
+    (void) iid;
+    (void) rid;
+    (void) execute_arg;
+    (void) execute_arg_len;
+    return 0;
+}
+
+static const anj_dm_handlers_t g_handlers = {
+    .res_read = res_read,
+    .res_execute = res_execute
+};
+
+static const anj_dm_res_t g_resources[] = {
+    {
+        .rid = MIN_MEASURED_VALUE_RID,
+        .type = ANJ_DATA_TYPE_DOUBLE,
+        .kind = ANJ_DM_RES_R
+    },
+    {
+        .rid = MAX_MEASURED_VALUE_RID,
+        .type = ANJ_DATA_TYPE_DOUBLE,
+        .kind = ANJ_DM_RES_R
+    },
+    {
+        .rid = RESET_MIN_MAX_RID,
+        .kind = ANJ_DM_RES_E
+    },
+    {
+        .rid = SENSOR_VALUE_RID,
+        .type = ANJ_DATA_TYPE_DOUBLE,
+        .kind = ANJ_DM_RES_R
+    },
+    {
+        .rid = SENSOR_UNITS_RID,
+        .type = ANJ_DATA_TYPE_STRING,
+        .kind = ANJ_DM_RES_R
+    }
+};
+
+static anj_dm_obj_inst_t g_insts[TEMPERATURE_INSTANCES];
+static anj_io_out_entry_t g_entries[4];
+
+static const anj_dm_obj_t g_obj = {
+    .oid = TEMPERATURE_OID,
+    .insts = g_insts,
+    .max_inst_count = TEMPERATURE_INSTANCES,
+    .handlers = &g_handlers
+};
+
+// Establishes an Observation as if the LwM2M Server requested it
+static int observe(const anj_uri_path_t *path, uint8_t token) {
+    _anj_coap_msg_t msg = {
+        .operation = ANJ_OP_INF_OBSERVE,
+        .uri = *path,
+        .accept = _ANJ_COAP_FORMAT_NOT_DEFINED
+    };
+    msg.token.size = 1;
+    msg.token.bytes[0] = (char) token;
+    _anj_exchange_handlers_t handlers;
+    uint8_t response_code;
+    if (_anj_observe_new_request(&g_anj, &handlers, &g_server_state, &msg,
+                                 &response_code)
+            || _anj_exchange_new_server_request(&g_exchange, response_code,
+                                                &msg, &handlers, g_payload,
+                                                sizeof(g_payload))
+                           != ANJ_EXCHANGE_STATE_MSG_TO_SEND
+            || _anj_exchange_process(&g_exchange,
+                                     ANJ_EXCHANGE_EVENT_SEND_CONFIRMATION,
+                                     &msg)
+                           != ANJ_EXCHANGE_STATE_FINISHED) {
+        return -1;
+    }
+    return 0;
+}
+
+static int setup(void) {
+    for (uint16_t i = 0; i < TEMPERATURE_INSTANCES; i++) {
+        g_insts[i].iid = i;
+        g_insts[i].resources = g_resources;
+        g_insts[i].res_count = ANJ_ARRAY_SIZE(g_resources);
+    }
+    g_entries[0] = (anj_io_out_entry_t) {
+        .path = ANJ_MAKE_RESOURCE_PATH(TEMPERATURE_OID, 0,
+                                       MIN_MEASURED_VALUE_RID),
+        .type = ANJ_DATA_TYPE_DOUBLE,
+        .value.double_value = 18.5
+    };
+    g_entries[1] = (anj_io_out_entry_t) {
+        .path = ANJ_MAKE_RESOURCE_PATH(TEMPERATURE_OID, 0,
+                                       MAX_MEASURED_VALUE_RID),
+        .type = ANJ_DATA_TYPE_DOUBLE,
+        .value.double_value = 24.25
+    };
+    g_entries[2] = (anj_io_out_entry_t) {
+        .path = ANJ_MAKE_RESOURCE_PATH(TEMPERATURE_OID, 0, SENSOR_VALUE_RID),
+        .type = ANJ_DATA_TYPE_DOUBLE,
+        .value.double_value = 21.75
+    };
+    g_entries[3] = (anj_io_out_entry_t) {
+        .path = ANJ_MAKE_RESOURCE_PATH(TEMPERATURE_OID, 0, SENSOR_UNITS_RID),
+        .type = ANJ_DATA_TYPE_STRING,
+        .value.bytes_or_string.data = "Cel"
+    };
+    _anj_exchange_init(&g_exchange);
+    _anj_dm_initialize(&g_anj);
+    _anj_observe_init(&g_anj);
+    if (anj_dm_add_obj(&g_anj, &g_obj)) {
+        return -1;
+    }
+    for (uint16_t i = 0; i < TEMPERATURE_INSTANCES; i++) {
+        if (observe(&ANJ_MAKE_RESOURCE_PATH(TEMPERATURE_OID, i,
+                                            SENSOR_VALUE_RID),
+                    (uint8_t) (2 * i))
+                || observe(&ANJ_MAKE_RESOURCE_PATH(TEMPERATURE_OID, i,
+                                                   MIN_MEASURED_VALUE_RID),
+                           (uint8_t) (2 * i + 1))) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Read response with the values of an Object Instance
+static int bench_senml_cbor_encode(void) {
+    _anj_io_out_ctx_t ctx;
+    anj_uri_path_t base_path = ANJ_MAKE_INSTANCE_PATH(TEMPERATURE_OID, 0);
+    if (_anj_io_out_ctx_init(&ctx, ANJ_OP_DM_READ, &base_path,
+                             ANJ_ARRAY_SIZE(g_entries),
+                             _ANJ_COAP_FORMAT_SENML_CBOR)) {
+        return -1;
+    }
+    size_t offset = 0;
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(g_entries); i++) {
+        size_t copied;
+        if (_anj_io_out_ctx_new_entry(&ctx, &g_entries[i])
+                || _anj_io_out_ctx_get_payload(&ctx, &g_payload[offset],
+                                               sizeof(g_payload) - offset,
+                                               &copied)) {
+            return -1;
+        }
+        offset += copied;
+    }
+    return 0;
+}
+
+// Read request of a Resource, with the Accept option
+static int bench_coap_decode(void) {
+    static uint8_t MSG[] = "\x48"         // Confirmable, tkl 8
+                           "\x01\x21\x37" // GET, msg id 0x2137
+                           "\x12\x34\x56\x78\x9A\xBC\xDE\xF0" // token
+                           "\xB4\x33\x33\x30\x33" // uri-path /3303
+                           "\x01\x37"             // uri-path /7
+                           "\x04\x35\x37\x30\x30" // uri-path /5700
+                           "\x62\x01\x70"; // accept SENML_CBOR 112
+    _anj_coap_msg_t msg;
+    memset(&msg, 0, sizeof(msg));
+    if (_anj_coap_decode_udp(MSG, sizeof(MSG) - 1, &msg)
+            || msg.operation != ANJ_OP_DM_READ) {
+        return -1;
+    }
+    return 0;
+}
+
+// Notification with a SenML CBOR payload
+static int bench_coap_encode(void) {
+    _anj_coap_msg_t msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.operation = ANJ_OP_INF_NON_CON_NOTIFY;
+    msg.msg_code = ANJ_COAP_CODE_CONTENT;
+    msg.content_format = _ANJ_COAP_FORMAT_SENML_CBOR;
+    msg.observe_number = 0x1234;
+    msg.coap_binding_data.message_id = 0x2137;
+    msg.token.size = 8;
+    msg.payload = g_payload;
+    msg.payload_size = 48;
+    size_t msg_size;
+    return _anj_coap_encode_udp(&msg, g_msg, sizeof(g_msg), &msg_size);
+}
+
+// Lookup of a Resource of the last Instance of the Object
+static int bench_dm_res_read(void) {
+    anj_res_value_t value;
+    return anj_dm_res_read(&g_anj,
+                           &ANJ_MAKE_RESOURCE_PATH(TEMPERATURE_OID,
+                                                   TEMPERATURE_INSTANCES - 1,
+                                                   SENSOR_VALUE_RID),
+                           &value);
+}
+
+// Scan of all Observations for the ones affected by a change of a value
+static int bench_observe_value_changed(void) {
+    return anj_observe_data_model_changed(
+            &g_anj,
+            &ANJ_MAKE_RESOURCE_PATH(TEMPERATURE_OID, TEMPERATURE_INSTANCES - 1,
+                                    SENSOR_VALUE_RID),
+            ANJ_OBSERVE_CHANGE_TYPE_VALUE_CHANGED, 0);
+}
+
+// Scan of all Observations for the next one to notify
+static int bench_observe_time_to_next(void) {
+    anj_time_duration_t time_to_next;
+    return anj_observe_time_to_next_notification(&g_anj, &g_server_state,
+                                                 &time_to_next);
+}
+
+static const benchmark_t BENCHMARKS[] = {
+    { "senml_cbor_encode", bench_senml_cbor_encode },
+    { "coap_decode", bench_coap_decode },
+    { "coap_encode", bench_coap_encode },
+    { "dm_res_read", bench_dm_res_read },
+    { "observe_value_changed", bench_observe_value_changed },
+    { "observe_time_to_next", bench_observe_time_to_next }
+};
+
+static __attribute__((noinline)) void stack_paint(void) {
+    volatile uint8_t area[BENCH_STACK_PAINT_SIZE];
+    for (size_t i = 0; i < sizeof(area); i++) {
+        area[i] = BENCH_STACK_PATTERN;
+    }
+    g_stack_painted = (uintptr_t) area;
+}
+
+// The stack grows down, so the painted area is scanned from its bottom up to
+// the first overwritten byte
+static __attribute__((noinline)) size_t stack_high_water(void) {
+    const volatile uint8_t *area = (const volatile uint8_t *) g_stack_painted;
+    size_t untouched = 0;
+    while (untouched < BENCH_STACK_PAINT_SIZE
+           && area[untouched] == BENCH_STACK_PATTERN) {
+        untouched++;
+    }
+    return BENCH_STACK_PAINT_SIZE - untouched;
+}
+
+static void sort(uint32_t *values, size_t count) {
+    for (size_t i = 1; i < count; i++) {
+        uint32_t value = values[i];
+        size_t j = i;
+        for (; j > 0 && values[j - 1] > value; j--) {
+            values[j] = values[j - 1];
+        }
+        values[j] = value;
+    }
+}
+
+static __attribute__((noinline)) int run_benchmark(const benchmark_t *bench) {
+    for (size_t i = 0; i < BENCH_WARMUP_RUNS; i++) {
+        if (bench->run()) {
+            return -1;
+        }
+    }
+    for (size_t i = 0; i < BENCH_RUNS; i++) {
+        uint32_t start = bench_counter();
+        int result = bench->run();
+        g_times[i] = bench_counter() - start;
+        if (result) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int main(void) {
+    bench_platform_init();
+    if (setup()) {
+        log(L_ERROR, "Benchmark setup failed");
+        return -1;
+    }
+
+    int result = 0;
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(BENCHMARKS); i++) {
+        stack_paint();
+        if (run_benchmark(&BENCHMARKS[i])) {
+            log(L_ERROR, "%s: failed", BENCHMARKS[i].name);
+            result = -1;
+            continue;
+        }
+        unsigned long stack = (unsigned long) stack_high_water();
+        if (stack == BENCH_STACK_PAINT_SIZE) {
+            log(L_WARNING, "%s: stack usage exceeds BENCH_STACK_PAINT_SIZE",
+                BENCHMARKS[i].name);
+        }
+        sort(g_times, BENCH_RUNS);
+        log(L_INFO, "%s: %lu %s/op (min %lu, max %lu), stack %lu B",
+            BENCHMARKS[i].name, (unsigned long) g_times[BENCH_RUNS / 2],
+            bench_counter_unit(), (unsigned long) g_times[0],
+            (unsigned long) g_times[BENCH_RUNS - 1], stack);
+    }
+    return result;
+}
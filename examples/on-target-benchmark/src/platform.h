@@ -0,0 +1,25 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef BENCH_PLATFORM_H
+#define BENCH_PLATFORM_H
+
+#include <stdint.h>
+
+// Enables the counter read by bench_counter(), called once at startup.
+void bench_platform_init(void);
+
+// Free-running counter used to time the benchmarks. Wraps around, so only
+// differences of values read less than one period apart are meaningful.
+uint32_t bench_counter(void);
+
+// Unit of bench_counter(), e.g. "cycles".
+const char *bench_counter_unit(void);
+
+#endif // BENCH_PLATFORM_H
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <anj/compat/log_impl_decls.h>
+#include <anj/compat/rng.h>
+#include <anj/compat/time.h>
+#include <anj/time.h>
+
+#include "platform.h"
+
+// Registers of the ARMv7-M and ARMv8-M debug components, at the same addresses
+// on all cores that have them (Cortex-M3 and newer)
+#define REG(Addr) (*(volatile uint32_t *) (Addr))
+#define DEMCR REG(0xE000EDFCu)
+#define DEMCR_TRCENA (1u << 24)
+#define DWT_CTRL REG(0xE0001000u)
+#define DWT_CTRL_CYCCNTENA (1u << 0)
+#define DWT_CYCCNT REG(0xE0001004u)
+// Lock Access Register, locked after reset on Cortex-M7
+#define DWT_LAR REG(0xE0001FB0u)
+#define DWT_LAR_UNLOCK 0xC5ACCE55u
+#define ITM_STIM0 REG(0xE0000000u)
+#define ITM_TER REG(0xE0000E00u)
+#define ITM_TCR REG(0xE0000E80u)
+#define ITM_TCR_ITMENA (1u << 0)
+
+void bench_platform_init(void) {
+    DEMCR |= DEMCR_TRCENA;
+    DWT_LAR = DWT_LAR_UNLOCK;
+    DWT_CYCCNT = 0;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+}
+
+uint32_t bench_counter(void) {
+    return DWT_CYCCNT;
+}
+
+const char *bench_counter_unit(void) {
+    return "cycles";
+}
+
+// The cycle counter wraps around every few tens of seconds, it is extended to
+// 64 bits here. Benchmarks read the time often enough not to miss a wrap.
+anj_time_monotonic_t anj_time_monotonic_now(void) {
+    static uint64_t cycles;
+    static uint32_t last_cyccnt;
+    uint32_t cyccnt = DWT_CYCCNT;
+    cycles += (uint32_t) (cyccnt - last_cyccnt);
+    last_cyccnt = cyccnt;
+    return anj_time_monotonic_new((int64_t) (cycles / (BENCH_CPU_HZ / 1000000)),
+                                  ANJ_TIME_UNIT_US);
+}
+
+anj_time_real_t anj_time_real_now(void) {
+    return anj_time_real_new(anj_time_monotonic_now().since_monotonic_epoch.us,
+                             ANJ_TIME_UNIT_US);
+}
+
+// Not cryptographically secure, there are no secure connections here
+int anj_rng_generate(uint8_t *buffer, size_t size) {
+    static uint32_t state = 0x2545F491u;
+    for (size_t i = 0; i < size; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        buffer[i] = (uint8_t) state;
+    }
+    return 0;
+}
+
+static void itm_putc(char c) {
+    while (!(ITM_STIM0 & 1u)) {
+    }
+    *(volatile uint8_t *) &ITM_STIM0 = (uint8_t) c;
+}
+
+// Logs are sent over SWO, through the stimulus port 0 of the ITM, if the
+// debugger enabled it. Boards without SWO may define this function on their own
+// to print to a UART or RTT instead.
+__attribute__((weak)) void anj_log_handler_output(const char *output,
+                                                  size_t len) {
+    if (!(ITM_TCR & ITM_TCR_ITMENA) || !(ITM_TER & 1u)) {
+        return;
+    }
+    for (size_t i = 0; i < len; i++) {
+        itm_putc(output[i]);
+    }
+    itm_putc('\n');
+}
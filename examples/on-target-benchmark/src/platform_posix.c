@@ -0,0 +1,28 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <stdint.h>
+#include <time.h>
+
+#include "platform.h"
+
+void bench_platform_init(void) {}
+
+uint32_t bench_counter(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t) ((uint64_t) ts.tv_sec * 1000000000
+                       + (uint64_t) ts.tv_nsec);
+}
+
+const char *bench_counter_unit(void) {
+    return "ns";
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+/**
+ * @file
+ * @brief Drives several @ref anj_t instances, one per LwM2M Server, from a
+ *        single main loop.
+ *
+ * Each @ref anj_t keeps the state of one LwM2M Server connection. A device
+ * that talks to more than one LwM2M Server runs one instance per Server and
+ * installs the same Objects in all of them, so that the Object state (and the
+ * application callbacks) is kept only once. The client group steps the
+ * instances in turns and forwards data model changes to all of them.
+ */
+
+#ifndef ANJ_CLIENT_GROUP_H
+#    define ANJ_CLIENT_GROUP_H
+
+#    include <stddef.h>
+
+#    include <anj/core.h>
+#    include <anj/defs.h>
+#    include <anj/dm/defs.h>
+#    include <anj/time.h>
+
+#    ifdef __cplusplus
+extern "C" {
+#    endif
+
+#    ifdef ANJ_WITH_CLIENT_GROUP
+
+/**
+ * Group of @ref anj_t instances, initialized with
+ * @ref anj_client_group_init. All fields are private.
+ */
+typedef struct {
+    anj_t *const *clients;
+    size_t clients_count;
+    /** Index of the instance stepped first by the next
+     * @ref anj_client_group_step call. */
+    size_t next_client;
+} anj_client_group_t;
+
+/**
+ * Initializes the group of instances.
+ *
+ * Every instance has to be initialized with @ref anj_core_init and must have
+ * its own Security and Server Objects installed, with the instance of the
+ * LwM2M Server it connects to. The @p clients array is not copied, it must
+ * remain valid for the lifetime of the group.
+ *
+ * @param group         Group to initialize.
+ * @param clients       Array of instances.
+ * @param clients_count Number of elements in @p clients, at least 1.
+ */
+void anj_client_group_init(anj_client_group_t *group,
+                           anj_t *const *clients,
+                           size_t clients_count);
+
+/**
+ * Installs the same Object in all instances of the group, see
+ * @ref anj_dm_add_obj. Handlers of the Object receive the instance which
+ * called them in their @c anj argument.
+ *
+ * @note Write, Create and Delete requests of any LwM2M Server modify the
+ *       shared Object. The other instances learn about such changes only if
+ *       the application reports them with
+ *       @ref anj_client_group_data_model_changed.
+ *
+ * @param group Group of instances.
+ * @param obj   Object to install.
+ *
+ * @return 0 on success, a non-zero value if the Object could not be added to
+ *         one of the instances; it is then removed from the others.
+ */
+int anj_client_group_add_obj(anj_client_group_t *group,
+                             const anj_dm_obj_t *obj);
+
+/**
+ * Calls @ref anj_core_step for all instances of the group.
+ *
+ * The instance stepped first changes on every call, so that when several
+ * instances compete for a shared resource, e.g. the message buffers of
+ * @ref ANJ_WITH_MSG_BUFFER_POOL, none of them is always served last.
+ *
+ * @param group Group of instances.
+ */
+void anj_client_group_step(anj_client_group_t *group);
+
+/**
+ * Informs all instances of the group that the application has modified the
+ * data model, see @ref anj_core_data_model_changed.
+ *
+ * @param group       Group of instances.
+ * @param path        Pointer to the path of the changed Resource or affected
+ *                    Instance.
+ * @param change_type Type of change; see @ref anj_core_change_type_t.
+ */
+void anj_client_group_data_model_changed(anj_client_group_t *group,
+                                         const anj_uri_path_t *path,
+                                         anj_core_change_type_t change_type);
+
+/**
+ * Returns the time until the next call to @ref anj_client_group_step is
+ * required, i.e. the shortest of the times returned by
+ * @ref anj_core_next_step_time for the instances of the group.
+ *
+ * @param group Group of instances.
+ *
+ * @return @ref anj_time_duration_t until the next @ref anj_client_group_step
+ *         is required.
+ */
+anj_time_duration_t
+anj_client_group_next_step_time(const anj_client_group_t *group);
+
+#    endif // ANJ_WITH_CLIENT_GROUP
+
+#    ifdef __cplusplus
+}
+#    endif
+
+#endif // ANJ_CLIENT_GROUP_H
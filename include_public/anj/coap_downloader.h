@@ -26,6 +26,10 @@
 
 #    include <anj/defs.h>
 
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_RESUME
+#        include <anj/persistence.h>
+#    endif // ANJ_COAP_DOWNLOADER_WITH_RESUME
+
 /** @cond */
 #    define ANJ_INTERNAL_INCLUDE_EXCHANGE
 #    include <anj_internal/exchange.h>
@@ -208,6 +212,66 @@ typedef struct anj_coap_downloader_configuration_struct {
      * default values will be used.
      */
     const anj_exchange_udp_tx_params_t *udp_tx_params;
+
+#        ifdef ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+    /**
+     * Anjay Lite object whose LwM2M Server connection may be reused. If the
+     * download URI points to the same host, port and binding as the
+     * registered LwM2M Server, no new socket is opened and the download is
+     * performed over the existing (possibly DTLS) session. In that case
+     * @ref anj_core_step must be called alongside
+     * @ref anj_coap_downloader_step, as it receives the responses.
+     *
+     * If @c NULL, a separate connection is always used.
+     */
+    anj_t *anj;
+#        endif // ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+
+#        ifdef ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW
+    /**
+     * Number of Block2 requests kept outstanding during the download. Values
+     * greater than @ref ANJ_COAP_DOWNLOADER_BLOCK_WINDOW_SIZE are limited to
+     * it. If 0 or 1, blocks are requested one at a time.
+     *
+     * The first block is always requested alone, to learn the block size used
+     * by the server. Data is passed to @ref event_cb in order.
+     */
+    uint8_t block_window;
+#        endif // ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW
+
+#        ifdef ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+    /**
+     * If set, blocks are requested with the Q-Block2 option (RFC 9177): all
+     * blocks that fit in @ref block_window are requested with a single
+     * message, and blocks that were lost are requested again individually.
+     * Has no effect if @ref block_window is 0 or 1.
+     *
+     * If the server responds to the first request with 4.02 Bad Option, or
+     * with the Block2 option, the download continues with Block2 requests.
+     */
+    bool q_block2;
+#        endif // ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+
+#        ifdef ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
+    /**
+     * Another CoAP downloader whose connection may be reused. If the download
+     * URI points to the same host, port and binding as the download that
+     * downloader is performing, no new connection is opened and the transfer
+     * is multiplexed over the existing one, with its own tokens. If that
+     * downloader is still connecting, the start of the transfer is delayed
+     * until the connection is ready.
+     *
+     * Attached transfers are stepped in round-robin order by
+     * @ref anj_coap_downloader_step of the downloader owning the connection,
+     * so stepping them separately is optional. The owner reports
+     * @ref ANJ_COAP_DOWNLOADER_STATUS_FINISHING and keeps the connection open
+     * until all attached transfers have finished.
+     *
+     * If @c NULL, or the downloader uses the connection shared with the LwM2M
+     * Server, a separate connection is used.
+     */
+    anj_coap_downloader_t *multiplex_with;
+#        endif // ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
 } anj_coap_downloader_configuration_t;
 
 /**
@@ -238,6 +302,28 @@ int anj_coap_downloader_init(anj_coap_downloader_t *coap_downloader,
  */
 void anj_coap_downloader_step(anj_coap_downloader_t *coap_downloader);
 
+/**
+ * Returns the time until the next call to @ref anj_coap_downloader_step is
+ * required.
+ *
+ * While a download is being started, performed or finished,
+ * @ref ANJ_TIME_DURATION_ZERO is returned, as the responses are received by
+ * polling the socket in @ref anj_coap_downloader_step. The same value is
+ * returned if the status change has not been reported to the event callback
+ * yet. Otherwise the downloader is idle and @ref ANJ_TIME_DURATION_INVALID is
+ * returned.
+ *
+ * @note Returned value becomes outdated if @ref anj_coap_downloader_start or
+ *       @ref anj_coap_downloader_terminate is called.
+ *
+ * @param coap_downloader CoAP downloader state.
+ *
+ * @return @ref anj_time_duration_t until the next
+ *         @ref anj_coap_downloader_step is required.
+ */
+anj_time_duration_t
+anj_coap_downloader_next_step_time(anj_coap_downloader_t *coap_downloader);
+
 /**
  * Starts a new download operation.
  *
@@ -245,6 +331,15 @@ void anj_coap_downloader_step(anj_coap_downloader_t *coap_downloader);
  *          so the pointer must remain valid throughout the entire download
  *          process.
  *
+ * If @ref ANJ_COAP_DOWNLOADER_WITH_RESUME is enabled and progress of a
+ * download of the same @p uri was restored with
+ * @ref anj_coap_downloader_progress_restore, the download continues from the
+ * stored block. Call @ref anj_coap_downloader_get_resume_offset to learn
+ * where the data passed to the event callback begins. If the resource has
+ * changed in the meantime, the download fails with
+ * @ref ANJ_COAP_DOWNLOADER_ERR_ETAG_MISMATCH and the stored progress is
+ * discarded, so the next attempt starts from the beginning.
+ *
  * @param coap_downloader CoAP downloader state.
  * @param uri             URI of the resource to download.
  *                        The string must be null-terminated.
@@ -304,6 +399,56 @@ void anj_coap_downloader_terminate(anj_coap_downloader_t *coap_downloader);
  */
 int anj_coap_downloader_get_error(anj_coap_downloader_t *coap_downloader);
 
+#        ifdef ANJ_COAP_DOWNLOADER_WITH_RESUME
+/**
+ * Serializes the progress of the current or last interrupted download into
+ * the persistence stream: URI, ETag, number of the next block to download and
+ * block size.
+ *
+ * May be called from the event callback; the progress then includes the data
+ * chunk passed to that callback. Progress is discarded once the download
+ * finishes successfully or the resource changes on the server.
+ *
+ * @param coap_downloader CoAP downloader state.
+ * @param ctx             Persistence context; must have @ref
+ *                        anj_persistence_context_t::direction set to
+ *                        ANJ_PERSISTENCE_STORE.
+ *
+ * @return 0 on success, negative value on error.
+ */
+int anj_coap_downloader_progress_store(anj_coap_downloader_t *coap_downloader,
+                                       const anj_persistence_context_t *ctx);
+
+/**
+ * Deserializes the download progress stored by
+ * @ref anj_coap_downloader_progress_store. Should be called after
+ * @ref anj_coap_downloader_init and before @ref anj_coap_downloader_start.
+ *
+ * @param coap_downloader CoAP downloader state.
+ * @param ctx             Persistence context; must have @ref
+ *                        anj_persistence_context_t::direction set to
+ *                        ANJ_PERSISTENCE_RESTORE.
+ *
+ * @return 0 on success,
+ *         @ref ANJ_COAP_DOWNLOADER_ERR_IN_PROGRESS if a download is in
+ *         progress, other negative value on error.
+ */
+int anj_coap_downloader_progress_restore(anj_coap_downloader_t *coap_downloader,
+                                         const anj_persistence_context_t *ctx);
+
+/**
+ * Returns the offset in the resource at which the data passed to the event
+ * callback begins, i.e. the number of bytes skipped thanks to the restored
+ * progress. Valid after @ref anj_coap_downloader_start returned 0.
+ *
+ * @param coap_downloader CoAP downloader state.
+ *
+ * @return Offset in bytes, 0 if the download starts from the beginning.
+ */
+size_t
+anj_coap_downloader_get_resume_offset(anj_coap_downloader_t *coap_downloader);
+#        endif // ANJ_COAP_DOWNLOADER_WITH_RESUME
+
 /** @cond */
 #        define ANJ_INTERNAL_INCLUDE_COAP_DOWNLOADER
 #        include <anj_internal/coap_downloader.h>
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+/**
+ * @file
+ * @brief Platform hooks for AES-CCM authenticated encryption.
+ *
+ * This header declares the API used by @ref ANJ_WITH_OSCORE to protect
+ * messages. Default implementations based on MbedTLS are provided if
+ * @ref ANJ_WITH_MBEDTLS is enabled; otherwise they may wrap a hardware AES
+ * accelerator or a secure element, which often support CCM natively.
+ */
+
+#ifndef ANJ_CRYPTO_AES_CCM_H
+#    define ANJ_CRYPTO_AES_CCM_H
+
+#    include <stddef.h>
+#    include <stdint.h>
+
+#    ifdef __cplusplus
+extern "C" {
+#    endif
+
+#    ifdef ANJ_WITH_OSCORE
+
+/**
+ * Encrypts @p data in place with AES-CCM and computes the authentication tag.
+ *
+ * @param      key       AES key.
+ * @param      key_len   Length of @p key in bytes, 16 for OSCORE.
+ * @param      nonce     Nonce.
+ * @param      nonce_len Length of @p nonce in bytes, 13 for OSCORE.
+ * @param      aad       Additional authenticated data.
+ * @param      aad_len   Length of @p aad in bytes.
+ * @param[in,out] data   Plaintext, replaced with the ciphertext.
+ * @param      data_len  Length of @p data in bytes.
+ * @param[out] tag       Buffer for the authentication tag.
+ * @param      tag_len   Length of the tag in bytes, 8 for OSCORE.
+ *
+ * @return 0 on success, non-zero value on failure.
+ */
+int anj_crypto_aes_ccm_encrypt(const uint8_t *key,
+                               size_t key_len,
+                               const uint8_t *nonce,
+                               size_t nonce_len,
+                               const uint8_t *aad,
+                               size_t aad_len,
+                               uint8_t *data,
+                               size_t data_len,
+                               uint8_t *tag,
+                               size_t tag_len);
+
+/**
+ * Decrypts @p data in place with AES-CCM and verifies the authentication tag.
+ *
+ * If the verification fails, the content of @p data is unspecified.
+ *
+ * @param      key       AES key.
+ * @param      key_len   Length of @p key in bytes, 16 for OSCORE.
+ * @param      nonce     Nonce.
+ * @param      nonce_len Length of @p nonce in bytes, 13 for OSCORE.
+ * @param      aad       Additional authenticated data.
+ * @param      aad_len   Length of @p aad in bytes.
+ * @param[in,out] data   Ciphertext, replaced with the plaintext.
+ * @param      data_len  Length of @p data in bytes.
+ * @param      tag       Authentication tag.
+ * @param      tag_len   Length of @p tag in bytes, 8 for OSCORE.
+ *
+ * @return 0 on success, non-zero value if the message is not authentic or on
+ *         any other failure.
+ */
+int anj_crypto_aes_ccm_decrypt(const uint8_t *key,
+                               size_t key_len,
+                               const uint8_t *nonce,
+                               size_t nonce_len,
+                               const uint8_t *aad,
+                               size_t aad_len,
+                               uint8_t *data,
+                               size_t data_len,
+                               const uint8_t *tag,
+                               size_t tag_len);
+
+#    endif // ANJ_WITH_OSCORE
+
+#    ifdef __cplusplus
+}
+#    endif
+
+#endif // ANJ_CRYPTO_AES_CCM_H
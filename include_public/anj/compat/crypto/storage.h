@@ -47,6 +47,14 @@ extern "C" {
 #            define ANJ_CRYPTO_STORAGE_PERSISTENCE_INFO_MAX_SIZE 64
 #        endif // ANJ_WITH_PERSISTENCE
 
+#        ifdef ANJ_WITH_ASYNC_CRYPTO_STORAGE
+/**
+ * Value that may be returned by @ref anj_crypto_storage_resolve_security_info
+ * if the requested data is not available yet.
+ */
+#            define ANJ_CRYPTO_STORAGE_IN_PROGRESS 1
+#        endif // ANJ_WITH_ASYNC_CRYPTO_STORAGE
+
 /**
  * Called once in @ref anj_core_init to initialize the Cryptographic storage
  * module.
@@ -136,13 +144,21 @@ int anj_crypto_storage_delete_record(void *crypto_ctx,
  * buffer is specified by @p out_buffer_size, and the actual size of the loaded
  * data should be returned in @p out_record_size.
  *
+ * If @ref ANJ_WITH_ASYNC_CRYPTO_STORAGE is enabled, the implementation may
+ * start the operation and return @ref ANJ_CRYPTO_STORAGE_IN_PROGRESS instead of
+ * waiting for the result. The function is then called again with the same
+ * @p info until it returns any other value. The operation may also be
+ * abandoned, e.g. if the connection is closed in the meantime, so the next
+ * call may refer to a different record.
+ *
  * @param      crypto_ctx      Cryptographic context.
  * @param      info            Security record identifier.
  * @param[out] out_buffer      Buffer to store the loaded data.
  * @param      out_buffer_size Size of the output buffer.
  * @param[out] out_record_size Size of the loaded data.
  *
- * @return 0 on success, negative value on failure.
+ * @return 0 on success, @ref ANJ_CRYPTO_STORAGE_IN_PROGRESS if the operation
+ *         is not finished yet, negative value on failure.
  */
 int anj_crypto_storage_resolve_security_info(
         void *crypto_ctx,
@@ -17,6 +17,7 @@
  * or override to control how Anjay Lite logs are processed:
  * - @ref anj_log_handler_impl_full - full log handler with metadata
  * - @ref anj_log_handler_output - sink for formatted log strings
+ * - @ref anj_log_deferred_read - source of deferred micro log records
  *
  * The implementation may route logs to console, syslog, RTT, UART, or any
  * other platform-specific output. Which functions are active depends on
@@ -95,6 +96,30 @@ void anj_log_handler_impl_micro(anj_log_level_t level,
                                 const char *format,
                                 ...);
 
+/**
+ * Copies the log records buffered in deferred micro mode, enabled if
+ * @ref ANJ_LOG_MICRO_DEFERRED is defined.
+ *
+ * Log statements only store the level, source file id, line number and raw
+ * argument values of the message in a ring buffer, so that they do not wait
+ * for a slow output. This function is meant to be called periodically, e.g.
+ * from a low priority task, to pass the buffered data to the output. The
+ * data is a binary stream that may be split at any byte and is decoded with
+ * the @c tools/micro_logs_decode.py script using the @c --binary option.
+ *
+ * @note The ring buffer has a single producer and a single consumer. This
+ *       function may be called from a different context than the one running
+ *       Anjay Lite, as long as both of them run on the same CPU core and only
+ *       one context calls this function.
+ *
+ * @param[out] out_data      Buffer for the log data.
+ * @param      out_data_size Size of @p out_data.
+ *
+ * @return Number of bytes copied into @p out_data, 0 if there is nothing to
+ *         read.
+ */
+size_t anj_log_deferred_read(uint8_t *out_data, size_t out_data_size);
+
 /**
  * Function used to output the formatted log strings, if one of builtin handler
  * implementations is enabled.
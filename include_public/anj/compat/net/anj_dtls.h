@@ -41,7 +41,94 @@ anj_net_cleanup_ctx_t anj_dtls_cleanup_ctx;
 
 anj_net_get_inner_mtu_t anj_dtls_get_inner_mtu;
 anj_net_get_state_t anj_dtls_get_state;
+#        ifdef ANJ_NET_WITH_POLL_HANDLE
+anj_net_get_poll_handle_t anj_dtls_get_poll_handle;
+#        endif // ANJ_NET_WITH_POLL_HANDLE
 anj_net_queue_mode_rx_off_t anj_dtls_queue_mode_rx_off;
+#        ifdef ANJ_NET_WITH_RELEASE_ASSISTANCE
+anj_net_release_assistance_t anj_dtls_release_assistance;
+#        endif // ANJ_NET_WITH_RELEASE_ASSISTANCE
+#        ifdef ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
+anj_net_session_store_t anj_dtls_session_store;
+anj_net_session_restore_t anj_dtls_session_restore;
+#        endif // ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
+
+#        ifdef ANJ_MBEDTLS_WITH_STATIC_POOL
+#            include <stddef.h>
+#            include <stdint.h>
+
+/**
+ * Peak usage of the MbedTLS memory pool, see
+ * @ref ANJ_MBEDTLS_WITH_STATIC_POOL. All values are in bytes and don't include
+ * the per-block overhead of the allocator.
+ */
+typedef struct {
+    /** Highest usage from the start of the connection to the end of the
+     * handshake, 0 if the handshake is not completed yet. */
+    size_t handshake_peak;
+    /** Highest usage since the end of the handshake. */
+    size_t steady_state_peak;
+    /** Current usage. */
+    size_t current;
+} anj_dtls_memory_usage_t;
+
+/**
+ * Makes MbedTLS allocate all its memory from @p pool. Must be called before
+ * any MbedTLS function, including @ref anj_dtls_create_ctx, and @p pool must
+ * remain valid for as long as MbedTLS is used.
+ *
+ * @param pool Memory to allocate from.
+ * @param size Size of @p pool in bytes.
+ */
+void anj_dtls_memory_pool_init(uint8_t *pool, size_t size);
+
+/**
+ * Reads the peak usage of the pool passed to @ref anj_dtls_memory_pool_init,
+ * as seen by the connection @p ctx.
+ *
+ * @param      ctx       DTLS connection context.
+ * @param[out] out_usage Usage of the pool.
+ *
+ * @returns @ref ANJ_NET_OK.
+ */
+int anj_dtls_get_memory_usage(anj_net_ctx_t *ctx,
+                              anj_dtls_memory_usage_t *out_usage);
+#        endif // ANJ_MBEDTLS_WITH_STATIC_POOL
+
+#        ifdef ANJ_MBEDTLS_WITH_HANDSHAKE_METRICS
+#            include <stddef.h>
+#            include <stdint.h>
+
+/**
+ * Statistics of the last DTLS handshake of a connection, see
+ * @ref ANJ_MBEDTLS_WITH_HANDSHAKE_METRICS. Datagrams and bytes include
+ * retransmissions.
+ */
+typedef struct {
+    /** Time from the start of the handshake to its end, in milliseconds, 0 if
+     * the handshake is not completed yet. */
+    uint32_t duration_ms;
+    /** Number of datagrams sent. */
+    uint32_t datagrams_sent;
+    /** Number of bytes sent. */
+    size_t bytes_sent;
+    /** Number of flights retransmitted because no response came in time. */
+    uint32_t retransmissions;
+} anj_dtls_handshake_metrics_t;
+
+/**
+ * Reads the statistics of the last DTLS handshake of the connection @p ctx.
+ * They are reset when a new handshake starts; a connection resumed without a
+ * handshake reports zeros.
+ *
+ * @param      ctx         DTLS connection context.
+ * @param[out] out_metrics Statistics of the handshake.
+ *
+ * @returns @ref ANJ_NET_OK.
+ */
+int anj_dtls_get_handshake_metrics(anj_net_ctx_t *ctx,
+                                   anj_dtls_handshake_metrics_t *out_metrics);
+#        endif // ANJ_MBEDTLS_WITH_HANDSHAKE_METRICS
 
 #    endif // ANJ_NET_WITH_DTLS
 
@@ -42,6 +42,10 @@
 extern "C" {
 #    endif
 
+#    ifdef ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
+#        include <anj/persistence.h>
+#    endif // ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
+
 #    ifdef ANJ_WITH_SECURITY
 #        include <anj/compat/rng.h>
 #        include <anj/crypto.h>
@@ -89,7 +93,14 @@ extern "C" {
 typedef enum {
     ANJ_NET_BINDING_UDP = 0,
     ANJ_NET_BINDING_DTLS,
-    ANJ_NET_BINDING_NON_IP
+    ANJ_NET_BINDING_NON_IP,
+    /**
+     * Stream binding: @ref anj_net_recv_t returns whatever part of the stream
+     * is available, which is not aligned to CoAP message boundaries.
+     */
+    ANJ_NET_BINDING_TCP,
+    /** Stream binding secured with TLS, see @ref ANJ_NET_BINDING_TCP. */
+    ANJ_NET_BINDING_TLS
 } anj_net_binding_type_t;
 
 typedef enum {
@@ -157,6 +168,9 @@ typedef struct {
 typedef enum {
     ANJ_NET_SECURITY_PSK,
     ANJ_NET_SECURITY_CERTIFICATE,
+#        ifdef ANJ_WITH_RAW_PUBLIC_KEY
+    ANJ_NET_SECURITY_RPK,
+#        endif // ANJ_WITH_RAW_PUBLIC_KEY
 } anj_net_security_mode_t;
 
 typedef struct {
@@ -168,11 +182,35 @@ typedef struct {
     void *empty;
 } anj_net_certificate_info_t;
 
+#        ifdef ANJ_WITH_RAW_PUBLIC_KEY
+/**
+ * Raw Public Key mode credentials, all in DER format.
+ */
+typedef struct {
+    /**
+     * SubjectPublicKeyInfo of the client, must match @ref private_key. MbedTLS
+     * integration sends it in a self-signed certificate, see
+     * @ref ANJ_WITH_RAW_PUBLIC_KEY.
+     */
+    anj_crypto_security_info_t public_key;
+    /** Client's private key. */
+    anj_crypto_security_info_t private_key;
+    /**
+     * SubjectPublicKeyInfo of the Server, the connection is accepted only if
+     * the Server presents exactly this key.
+     */
+    anj_crypto_security_info_t server_public_key;
+} anj_net_rpk_info_t;
+#        endif // ANJ_WITH_RAW_PUBLIC_KEY
+
 typedef struct {
     anj_net_security_mode_t mode;
     union {
         anj_net_psk_info_t psk;
         anj_net_certificate_info_t cert;
+#        ifdef ANJ_WITH_RAW_PUBLIC_KEY
+        anj_net_rpk_info_t rpk;
+#        endif // ANJ_WITH_RAW_PUBLIC_KEY
     } data;
 } anj_net_security_info_t;
 
@@ -349,6 +387,48 @@ typedef int anj_net_send_t(anj_net_ctx_t *ctx,
                            const uint8_t *buf,
                            size_t length);
 
+#    ifdef ANJ_NET_WITH_SEND_VEC
+/**
+ * Single, contiguous part of the data passed to @ref anj_net_send_vec_t.
+ */
+typedef struct {
+    /** Pointer to the data. */
+    const uint8_t *buf;
+    /** Length of the data pointed to by @ref buf. */
+    size_t length;
+} anj_net_iovec_t;
+
+/**
+ * This function sends the concatenation of the provided buffers as a single
+ * message through the given connection context, e.g. using @c sendmsg(). It
+ * lets the library send the CoAP header and the payload directly from the
+ * buffers in which they were prepared, without assembling the message in a
+ * separate buffer first.
+ *
+ * Semantics of the return value and @p bytes_sent are the same as for
+ * @ref anj_net_send_t, with @p bytes_sent counted over all buffers.
+ *
+ * Used only if @ref ANJ_NET_WITH_SEND_VEC is enabled, for all bindings except
+ * DTLS.
+ *
+ * @note This function does not block.
+ *
+ * @param      ctx         Pointer to a socket context.
+ * @param[out] bytes_sent  Number of bytes sent.
+ * @param      iov         Array of buffers to send, in order.
+ * @param      iov_count   Number of elements of @p iov.
+ *
+ * @return @ref ANJ_NET_OK if all data was sent or partial data was sent
+ *         successfully.
+ *         @ref ANJ_NET_EINPROGRESS
+ *         Other non-zero value in case of an error.
+ */
+typedef int anj_net_send_vec_t(anj_net_ctx_t *ctx,
+                               size_t *bytes_sent,
+                               const anj_net_iovec_t *iov,
+                               size_t iov_count);
+#    endif // ANJ_NET_WITH_SEND_VEC
+
 /**
  * This function receives data from the specified connection context. If data is
  * available, it is stored in the provided buffer, and @p bytes_received
@@ -373,6 +453,84 @@ typedef int anj_net_recv_t(anj_net_ctx_t *ctx,
                            uint8_t *buf,
                            size_t length);
 
+#    ifdef ANJ_NET_WITH_BATCH_IO
+/**
+ * Single datagram passed to @ref anj_net_recv_batch_t or
+ * @ref anj_net_send_batch_t.
+ */
+typedef struct {
+    /**
+     * Buffer for the received datagram, or data of the datagram to send (not
+     * modified by @ref anj_net_send_batch_t).
+     */
+    uint8_t *buf;
+    /** Size of @ref buf, or length of the datagram to send. */
+    size_t length;
+    /** Number of bytes received or sent, set by the function. */
+    size_t bytes;
+    /**
+     * Set by @ref anj_net_recv_batch_t if the datagram did not fit in
+     * @ref buf and was truncated to @ref length bytes.
+     */
+    bool truncated;
+} anj_net_datagram_t;
+
+/**
+ * This function receives up to @p count datagrams from the specified
+ * connection context, e.g. using @c recvmmsg(), storing each of them in the
+ * buffer of the subsequent element of @p datagrams.
+ *
+ * The implementation may receive fewer datagrams than requested even if more
+ * are available; the caller should call it again until
+ * @ref ANJ_NET_EAGAIN is returned.
+ *
+ * Used only if @ref ANJ_NET_WITH_BATCH_IO is enabled.
+ *
+ * @note This function does not block.
+ *
+ * @param         ctx            Pointer to a socket context.
+ * @param[in,out] datagrams      Array of datagram descriptors.
+ * @param         count          Number of elements of @p datagrams.
+ * @param[out]    out_count      Number of datagrams received.
+ *
+ * @return @ref ANJ_NET_OK          if at least one datagram was received.
+ *         @ref ANJ_NET_EAGAIN      if no datagram is available.
+ *         @ref ANJ_NET_EINPROGRESS
+ *         Other non-zero value in case of other errors.
+ */
+typedef int anj_net_recv_batch_t(anj_net_ctx_t *ctx,
+                                 anj_net_datagram_t *datagrams,
+                                 size_t count,
+                                 size_t *out_count);
+
+/**
+ * This function sends up to @p count datagrams through the given connection
+ * context, e.g. using @c sendmmsg(), each of them as a separate message.
+ *
+ * If no datagram has been sent, the function returns
+ * @ref ANJ_NET_EINPROGRESS. Otherwise @p out_count indicates the number of
+ * datagrams sent in full, and the caller should retry the operation with the
+ * remaining ones.
+ *
+ * Used only if @ref ANJ_NET_WITH_BATCH_IO is enabled.
+ *
+ * @note This function does not block.
+ *
+ * @param         ctx            Pointer to a socket context.
+ * @param[in,out] datagrams      Array of datagrams to send, in order.
+ * @param         count          Number of elements of @p datagrams.
+ * @param[out]    out_count      Number of datagrams sent.
+ *
+ * @return @ref ANJ_NET_OK          if at least one datagram was sent.
+ *         @ref ANJ_NET_EINPROGRESS
+ *         Other non-zero value in case of an error.
+ */
+typedef int anj_net_send_batch_t(anj_net_ctx_t *ctx,
+                                 anj_net_datagram_t *datagrams,
+                                 size_t count,
+                                 size_t *out_count);
+#    endif // ANJ_NET_WITH_BATCH_IO
+
 /**
  * Shuts down the connection associated with @p ctx. No further communication is
  * allowed using this context. Discards any buffered but not yet processed data.
@@ -417,6 +575,48 @@ typedef int anj_net_get_state_t(anj_net_ctx_t *ctx,
  */
 typedef int anj_net_get_inner_mtu_t(anj_net_ctx_t *ctx, int32_t *out_value);
 
+#    ifdef ANJ_NET_WITH_POLL_HANDLE
+/**
+ * Handle that the application can wait on until data can be received from the
+ * socket context, e.g. using @c poll() or @c epoll_wait(). Which member is
+ * used depends on the net compat implementation.
+ */
+typedef union {
+    /** File descriptor, used by POSIX-like implementations. */
+    int fd;
+    /** Platform-specific object, e.g. an RTOS event group or semaphore. */
+    void *ptr;
+} anj_net_poll_handle_t;
+
+/**
+ * Returns the handle that becomes ready (readable) when a subsequent
+ * @ref anj_net_recv_t call may return data. The handle must remain valid until
+ * the socket context is closed or cleaned up.
+ *
+ * If the implementation buffers data internally (e.g. decrypted DTLS records
+ * left after the previous @ref anj_net_recv_t call), readiness of the handle
+ * doesn't reflect it, so @p out_data_pending must be set to @c true in that
+ * case.
+ *
+ * Used only if @ref ANJ_NET_WITH_POLL_HANDLE is enabled, see
+ * @ref anj_core_next_wakeup.
+ *
+ * @note This function does not block.
+ *
+ * @param      ctx              Pointer to a socket context.
+ * @param[out] out_handle       Handle to wait on.
+ * @param[out] out_data_pending Set to @c true if data can be received
+ *                              without waiting for @p out_handle.
+ *
+ * @return @ref ANJ_NET_OK on success.
+ *         @ref ANJ_NET_ENOTSUP if the context can't provide such a handle.
+ *         Other non-zero value in case of other errors.
+ */
+typedef int anj_net_get_poll_handle_t(anj_net_ctx_t *ctx,
+                                      anj_net_poll_handle_t *out_handle,
+                                      bool *out_data_pending);
+#    endif // ANJ_NET_WITH_POLL_HANDLE
+
 /**
  * Hints the transport that the client is entering LwM2M Queue Mode and
  * **will not need to receive** application data until it initiates the next
@@ -450,6 +650,102 @@ typedef int anj_net_get_inner_mtu_t(anj_net_ctx_t *ctx, int32_t *out_value);
  */
 typedef int anj_net_queue_mode_rx_off_t(anj_net_ctx_t *ctx);
 
+#    ifdef ANJ_NET_WITH_RELEASE_ASSISTANCE
+/**
+ * Traffic expected on the connection, passed to
+ * @ref anj_net_release_assistance_t.
+ */
+typedef enum {
+    /**
+     * The next datagram sent is the last one, and a single datagram is
+     * expected in response to it, e.g. for the Deregister request.
+     */
+    ANJ_NET_RELEASE_HINT_LAST_UPLINK,
+    /**
+     * No more data is expected in either direction, e.g. the client has just
+     * entered LwM2M Queue Mode.
+     */
+    ANJ_NET_RELEASE_HINT_NO_MORE_DATA
+} anj_net_release_hint_t;
+
+/**
+ * Tells the transport how much more traffic is expected, so that a cellular
+ * modem can signal Release Assistance Indication (3GPP RAI) to the network and
+ * release the radio connection right away, instead of keeping it for the
+ * network inactivity timer.
+ *
+ * @ref ANJ_NET_RELEASE_HINT_LAST_UPLINK refers to the next
+ * @ref anj_net_send_t call only. Implementations must not drop inbound or
+ * outbound traffic because of the hint: if there turns out to be more data,
+ * e.g. a retransmission or a request from the server, the connection is set up
+ * again as usual.
+ *
+ * Used only if @ref ANJ_NET_WITH_RELEASE_ASSISTANCE is enabled. Errors are
+ * logged and otherwise ignored.
+ *
+ * @note This function does not block.
+ *
+ * @param ctx  Pointer to a socket context.
+ * @param hint Traffic expected on the connection.
+ *
+ * @return @ref ANJ_NET_OK on success, or if the hint is not applicable
+ *         (no-op).
+ *         @ref ANJ_NET_ENOTSUP if the context can't pass the hint on.
+ *         Other non-zero value in case of other errors.
+ */
+typedef int anj_net_release_assistance_t(anj_net_ctx_t *ctx,
+                                         anj_net_release_hint_t hint);
+#    endif // ANJ_NET_WITH_RELEASE_ASSISTANCE
+
+#    ifdef ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
+/**
+ * Stores the state of an established secure connection, so that it can be
+ * resumed by another socket context, possibly after a restart of the device,
+ * see @ref anj_net_session_restore_t.
+ *
+ * Called by @ref anj_core_session_store. The connection may be unusable after
+ * this call (e.g. MbedTLS resets the context after serializing it), so the
+ * implementation should also make sure that @ref anj_net_cleanup_ctx_t doesn't
+ * notify the peer about closing the connection, which would make the stored
+ * state useless.
+ *
+ * Used only if @ref ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE is enabled.
+ *
+ * @param ctx         Pointer to a socket context.
+ * @param persistence Persistence context to write to.
+ *
+ * @return @ref ANJ_NET_OK on success.
+ *         @ref ANJ_NET_ENOTSUP if the connection can't be stored.
+ *         Other non-zero value in case of other errors.
+ */
+typedef int
+anj_net_session_store_t(anj_net_ctx_t *ctx,
+                        const anj_persistence_context_t *persistence);
+
+/**
+ * Restores the state stored with @ref anj_net_session_store_t into a newly
+ * created socket context. The next @ref anj_net_connect_t call resumes the
+ * stored connection instead of setting up a new one, if possible. If the
+ * stored state can't be used, the implementation should fall back to
+ * a regular connection.
+ *
+ * Called by @ref anj_core_session_restore, before the first
+ * @ref anj_net_connect_t call on @p ctx.
+ *
+ * Used only if @ref ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE is enabled.
+ *
+ * @param ctx         Pointer to a socket context.
+ * @param persistence Persistence context to read from.
+ *
+ * @return @ref ANJ_NET_OK on success.
+ *         Other non-zero value in case of errors, e.g. if the data is
+ *         malformed.
+ */
+typedef int
+anj_net_session_restore_t(anj_net_ctx_t *ctx,
+                          const anj_persistence_context_t *persistence);
+#    endif // ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
+
 #    ifdef __cplusplus
 }
 #    endif
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+/**
+ * @file
+ * @brief Offload of UDP and DTLS network I/O to a dedicated POSIX thread.
+ *
+ * If @ref ANJ_NET_WITH_IO_THREAD is enabled, @ref anj_net_wrapper.h routes all
+ * calls for UDP and DTLS bindings to the functions declared here instead of
+ * calling the binding directly. Each connection context then wraps a context
+ * of the actual binding (e.g. @c anj_udp_create_ctx or
+ * @c anj_dtls_create_ctx), which is used only by the I/O thread: connecting
+ * (including DNS resolution and the DTLS handshake), sending, receiving and
+ * decrypting records, and closing.
+ *
+ * Datagrams are exchanged with the I/O thread through two single-producer,
+ * single-consumer queues per connection, of
+ * @ref ANJ_NET_IO_THREAD_QUEUE_SIZE datagrams each. As a result:
+ * - @ref anj_net_send_t copies the datagram to the queue and returns
+ *   immediately; errors of the actual send are reported by the next call,
+ * - @ref anj_net_recv_t copies a datagram already received (and decrypted) by
+ *   the I/O thread, or returns @ref ANJ_NET_EAGAIN,
+ * - @ref anj_net_connect_t, @ref anj_net_close_t and
+ *   @ref anj_net_cleanup_ctx_t return @ref ANJ_NET_EINPROGRESS until the I/O
+ *   thread completes them; datagrams queued for sending are sent before the
+ *   connection is closed,
+ * - @ref anj_net_get_poll_handle_t returns a pipe that becomes readable when a
+ *   datagram is queued for receiving.
+ *
+ * The I/O thread is started when the first context is created. Functions of
+ * a single context must be called from one thread, but different contexts may
+ * be used from different threads.
+ *
+ * @note The actual bindings must implement @ref anj_net_get_poll_handle_t,
+ *       which is used by the I/O thread to wait for incoming data.
+ *
+ * @note DTLS session persistence (@ref anj_net_session_store and
+ *       @ref anj_net_session_restore) is not supported for offloaded
+ *       contexts.
+ */
+
+#ifndef ANJ_NET_IO_THREAD_H
+#    define ANJ_NET_IO_THREAD_H
+
+#    include <stdbool.h>
+
+#    include <anj/compat/net/anj_net_api.h>
+
+#    ifdef __cplusplus
+extern "C" {
+#    endif
+
+#    ifdef ANJ_NET_WITH_IO_THREAD
+
+/**
+ * Returns @c true if calls for the binding are handled by the I/O thread.
+ */
+static inline bool anj_net_io_thread_offloaded(anj_net_binding_type_t type) {
+    return type == ANJ_NET_BINDING_UDP || type == ANJ_NET_BINDING_DTLS;
+}
+
+/**
+ * Creates a context of the @p type binding, handled by the I/O thread. Starts
+ * the I/O thread if it is not running.
+ *
+ * @see anj_net_create_ctx_t
+ */
+int anj_net_io_thread_create_ctx(anj_net_binding_type_t type,
+                                 anj_net_ctx_t **ctx,
+                                 const anj_net_config_t *config);
+
+anj_net_connect_t anj_net_io_thread_connect;
+anj_net_send_t anj_net_io_thread_send;
+#        ifdef ANJ_NET_WITH_SEND_VEC
+anj_net_send_vec_t anj_net_io_thread_send_vec;
+#        endif // ANJ_NET_WITH_SEND_VEC
+anj_net_recv_t anj_net_io_thread_recv;
+#        ifdef ANJ_NET_WITH_BATCH_IO
+anj_net_recv_batch_t anj_net_io_thread_recv_batch;
+anj_net_send_batch_t anj_net_io_thread_send_batch;
+#        endif // ANJ_NET_WITH_BATCH_IO
+anj_net_close_t anj_net_io_thread_close;
+anj_net_cleanup_ctx_t anj_net_io_thread_cleanup_ctx;
+anj_net_get_inner_mtu_t anj_net_io_thread_get_inner_mtu;
+anj_net_get_state_t anj_net_io_thread_get_state;
+anj_net_get_poll_handle_t anj_net_io_thread_get_poll_handle;
+anj_net_queue_mode_rx_off_t anj_net_io_thread_queue_mode_rx_off;
+
+/**
+ * Stops the I/O thread and waits for it to finish. It is started again when
+ * the next context is created.
+ *
+ * @return 0 on success, -1 if there are contexts not cleaned up yet.
+ */
+int anj_net_io_thread_stop(void);
+
+#    endif // ANJ_NET_WITH_IO_THREAD
+
+#    ifdef __cplusplus
+}
+#    endif
+
+#endif // ANJ_NET_IO_THREAD_H
@@ -18,6 +18,8 @@
  * to the selected transport backend:
  * - UDP
  * - DTLS
+ * - TCP
+ * - TLS
  * - Non-IP bindings
  *
  * Which backends are compiled in is controlled via
@@ -27,6 +29,9 @@
  *
  * This lets the core code call a uniform API, while integrators
  * can enable/disable specific transports at build time.
+ *
+ * If @ref ANJ_NET_WITH_IO_THREAD is enabled, UDP and DTLS calls are routed to
+ * @ref anj_net_io_thread.h instead.
  */
 
 #ifndef ANJ_NET_WRAPPER_H
@@ -39,9 +44,27 @@
 #    ifdef ANJ_NET_WITH_DTLS
 #        include <anj/compat/net/anj_dtls.h>
 #    endif // ANJ_NET_WITH_DTLS
+#    ifdef ANJ_NET_WITH_TCP
+#        include <anj/compat/net/anj_tcp.h>
+#    endif // ANJ_NET_WITH_TCP
+#    ifdef ANJ_NET_WITH_TLS
+#        include <anj/compat/net/anj_tls.h>
+#    endif // ANJ_NET_WITH_TLS
 #    ifdef ANJ_NET_WITH_NON_IP_BINDING
 #        include <anj/compat/net/anj_non_ip.h>
 #    endif // ANJ_NET_WITH_NON_IP_BINDING
+#    ifdef ANJ_NET_WITH_IO_THREAD
+#        include <anj/compat/net/anj_net_io_thread.h>
+// Bindings built on top of another binding (e.g. DTLS over UDP) define
+// ANJ_NET_WRAPPER_WITHOUT_IO_THREAD before including this header, as they are
+// themselves called from the I/O thread.
+#        ifdef ANJ_NET_WRAPPER_WITHOUT_IO_THREAD
+#            define _ANJ_NET_WRAPPER_OFFLOADED(Type) false
+#        else  // ANJ_NET_WRAPPER_WITHOUT_IO_THREAD
+#            define _ANJ_NET_WRAPPER_OFFLOADED(Type) \
+                anj_net_io_thread_offloaded(Type)
+#        endif // ANJ_NET_WRAPPER_WITHOUT_IO_THREAD
+#    endif     // ANJ_NET_WITH_IO_THREAD
 
 #    ifdef __cplusplus
 extern "C" {
@@ -51,6 +74,11 @@ extern "C" {
 static inline int anj_net_create_ctx(anj_net_binding_type_t type,
                                      anj_net_ctx_t **ctx,
                                      const anj_net_config_t *config) {
+#    ifdef ANJ_NET_WITH_IO_THREAD
+    if (_ANJ_NET_WRAPPER_OFFLOADED(type)) {
+        return anj_net_io_thread_create_ctx(type, ctx, config);
+    }
+#    endif // ANJ_NET_WITH_IO_THREAD
     switch (type) {
 #    if defined(ANJ_NET_WITH_UDP)
     case ANJ_NET_BINDING_UDP:
@@ -60,6 +88,14 @@ static inline int anj_net_create_ctx(anj_net_binding_type_t type,
     case ANJ_NET_BINDING_DTLS:
         return anj_dtls_create_ctx(ctx, config);
 #    endif // defined(ANJ_NET_WITH_DTLS)
+#    if defined(ANJ_NET_WITH_TCP)
+    case ANJ_NET_BINDING_TCP:
+        return anj_tcp_create_ctx(ctx, config);
+#    endif // defined(ANJ_NET_WITH_TCP)
+#    if defined(ANJ_NET_WITH_TLS)
+    case ANJ_NET_BINDING_TLS:
+        return anj_tls_create_ctx(ctx, config);
+#    endif // defined(ANJ_NET_WITH_TLS)
 #    if defined(ANJ_NET_WITH_NON_IP_BINDING)
     case ANJ_NET_BINDING_NON_IP:
         return anj_non_ip_create_ctx(ctx, config);
@@ -74,6 +110,11 @@ static inline int anj_net_connect(anj_net_binding_type_t type,
                                   anj_net_ctx_t *ctx,
                                   const char *hostname,
                                   const char *port) {
+#    ifdef ANJ_NET_WITH_IO_THREAD
+    if (_ANJ_NET_WRAPPER_OFFLOADED(type)) {
+        return anj_net_io_thread_connect(ctx, hostname, port);
+    }
+#    endif // ANJ_NET_WITH_IO_THREAD
     switch (type) {
 #    if defined(ANJ_NET_WITH_UDP)
     case ANJ_NET_BINDING_UDP:
@@ -83,6 +124,14 @@ static inline int anj_net_connect(anj_net_binding_type_t type,
     case ANJ_NET_BINDING_DTLS:
         return anj_dtls_connect(ctx, hostname, port);
 #    endif // defined(ANJ_NET_WITH_DTLS)
+#    if defined(ANJ_NET_WITH_TCP)
+    case ANJ_NET_BINDING_TCP:
+        return anj_tcp_connect(ctx, hostname, port);
+#    endif // defined(ANJ_NET_WITH_TCP)
+#    if defined(ANJ_NET_WITH_TLS)
+    case ANJ_NET_BINDING_TLS:
+        return anj_tls_connect(ctx, hostname, port);
+#    endif // defined(ANJ_NET_WITH_TLS)
 #    if defined(ANJ_NET_WITH_NON_IP_BINDING)
     case ANJ_NET_BINDING_NON_IP:
         return anj_non_ip_connect(ctx, hostname, port);
@@ -98,6 +147,11 @@ static inline int anj_net_send(anj_net_binding_type_t type,
                                size_t *bytes_sent,
                                const uint8_t *buf,
                                size_t length) {
+#    ifdef ANJ_NET_WITH_IO_THREAD
+    if (_ANJ_NET_WRAPPER_OFFLOADED(type)) {
+        return anj_net_io_thread_send(ctx, bytes_sent, buf, length);
+    }
+#    endif // ANJ_NET_WITH_IO_THREAD
     switch (type) {
 #    if defined(ANJ_NET_WITH_UDP)
     case ANJ_NET_BINDING_UDP:
@@ -107,6 +161,14 @@ static inline int anj_net_send(anj_net_binding_type_t type,
     case ANJ_NET_BINDING_DTLS:
         return anj_dtls_send(ctx, bytes_sent, buf, length);
 #    endif // defined(ANJ_NET_WITH_DTLS)
+#    if defined(ANJ_NET_WITH_TCP)
+    case ANJ_NET_BINDING_TCP:
+        return anj_tcp_send(ctx, bytes_sent, buf, length);
+#    endif // defined(ANJ_NET_WITH_TCP)
+#    if defined(ANJ_NET_WITH_TLS)
+    case ANJ_NET_BINDING_TLS:
+        return anj_tls_send(ctx, bytes_sent, buf, length);
+#    endif // defined(ANJ_NET_WITH_TLS)
 #    if defined(ANJ_NET_WITH_NON_IP_BINDING)
     case ANJ_NET_BINDING_NON_IP:
         return anj_non_ip_send(ctx, bytes_sent, buf, length);
@@ -116,12 +178,48 @@ static inline int anj_net_send(anj_net_binding_type_t type,
     }
 }
 
+#    ifdef ANJ_NET_WITH_SEND_VEC
+/** @see anj_net_send_vec_t */
+static inline int anj_net_send_vec(anj_net_binding_type_t type,
+                                   anj_net_ctx_t *ctx,
+                                   size_t *bytes_sent,
+                                   const anj_net_iovec_t *iov,
+                                   size_t iov_count) {
+#        ifdef ANJ_NET_WITH_IO_THREAD
+    if (_ANJ_NET_WRAPPER_OFFLOADED(type)) {
+        return anj_net_io_thread_send_vec(ctx, bytes_sent, iov, iov_count);
+    }
+#        endif // ANJ_NET_WITH_IO_THREAD
+    switch (type) {
+#        if defined(ANJ_NET_WITH_UDP)
+    case ANJ_NET_BINDING_UDP:
+        return anj_udp_send_vec(ctx, bytes_sent, iov, iov_count);
+#        endif // defined(ANJ_NET_WITH_UDP)
+#        if defined(ANJ_NET_WITH_TCP)
+    case ANJ_NET_BINDING_TCP:
+        return anj_tcp_send_vec(ctx, bytes_sent, iov, iov_count);
+#        endif // defined(ANJ_NET_WITH_TCP)
+#        if defined(ANJ_NET_WITH_NON_IP_BINDING)
+    case ANJ_NET_BINDING_NON_IP:
+        return anj_non_ip_send_vec(ctx, bytes_sent, iov, iov_count);
+#        endif // defined(ANJ_NET_WITH_NON_IP_BINDING)
+    default:
+        return ANJ_NET_ENOTSUP;
+    }
+}
+#    endif // ANJ_NET_WITH_SEND_VEC
+
 /** @see anj_net_recv_t */
 static inline int anj_net_recv(anj_net_binding_type_t type,
                                anj_net_ctx_t *ctx,
                                size_t *bytes_received,
                                uint8_t *buf,
                                size_t length) {
+#    ifdef ANJ_NET_WITH_IO_THREAD
+    if (_ANJ_NET_WRAPPER_OFFLOADED(type)) {
+        return anj_net_io_thread_recv(ctx, bytes_received, buf, length);
+    }
+#    endif // ANJ_NET_WITH_IO_THREAD
     switch (type) {
 #    if defined(ANJ_NET_WITH_UDP)
     case ANJ_NET_BINDING_UDP:
@@ -131,6 +229,14 @@ static inline int anj_net_recv(anj_net_binding_type_t type,
     case ANJ_NET_BINDING_DTLS:
         return anj_dtls_recv(ctx, bytes_received, buf, length);
 #    endif // defined(ANJ_NET_WITH_DTLS)
+#    if defined(ANJ_NET_WITH_TCP)
+    case ANJ_NET_BINDING_TCP:
+        return anj_tcp_recv(ctx, bytes_received, buf, length);
+#    endif // defined(ANJ_NET_WITH_TCP)
+#    if defined(ANJ_NET_WITH_TLS)
+    case ANJ_NET_BINDING_TLS:
+        return anj_tls_recv(ctx, bytes_received, buf, length);
+#    endif // defined(ANJ_NET_WITH_TLS)
 #    if defined(ANJ_NET_WITH_NON_IP_BINDING)
     case ANJ_NET_BINDING_NON_IP:
         return anj_non_ip_recv(ctx, bytes_received, buf, length);
@@ -140,9 +246,54 @@ static inline int anj_net_recv(anj_net_binding_type_t type,
     }
 }
 
+#    ifdef ANJ_NET_WITH_BATCH_IO
+/** @see anj_net_recv_batch_t */
+static inline int anj_net_recv_batch(anj_net_binding_type_t type,
+                                     anj_net_ctx_t *ctx,
+                                     anj_net_datagram_t *datagrams,
+                                     size_t count,
+                                     size_t *out_count) {
+#        ifdef ANJ_NET_WITH_IO_THREAD
+    if (_ANJ_NET_WRAPPER_OFFLOADED(type)) {
+        return anj_net_io_thread_recv_batch(ctx, datagrams, count, out_count);
+    }
+#        endif // ANJ_NET_WITH_IO_THREAD
+    switch (type) {
+    case ANJ_NET_BINDING_UDP:
+        return anj_udp_recv_batch(ctx, datagrams, count, out_count);
+    default:
+        return ANJ_NET_ENOTSUP;
+    }
+}
+
+/** @see anj_net_send_batch_t */
+static inline int anj_net_send_batch(anj_net_binding_type_t type,
+                                     anj_net_ctx_t *ctx,
+                                     anj_net_datagram_t *datagrams,
+                                     size_t count,
+                                     size_t *out_count) {
+#        ifdef ANJ_NET_WITH_IO_THREAD
+    if (_ANJ_NET_WRAPPER_OFFLOADED(type)) {
+        return anj_net_io_thread_send_batch(ctx, datagrams, count, out_count);
+    }
+#        endif // ANJ_NET_WITH_IO_THREAD
+    switch (type) {
+    case ANJ_NET_BINDING_UDP:
+        return anj_udp_send_batch(ctx, datagrams, count, out_count);
+    default:
+        return ANJ_NET_ENOTSUP;
+    }
+}
+#    endif // ANJ_NET_WITH_BATCH_IO
+
 /** @see anj_net_close_t */
 static inline int anj_net_close(anj_net_binding_type_t type,
                                 anj_net_ctx_t *ctx) {
+#    ifdef ANJ_NET_WITH_IO_THREAD
+    if (_ANJ_NET_WRAPPER_OFFLOADED(type)) {
+        return anj_net_io_thread_close(ctx);
+    }
+#    endif // ANJ_NET_WITH_IO_THREAD
     switch (type) {
 #    if defined(ANJ_NET_WITH_UDP)
     case ANJ_NET_BINDING_UDP:
@@ -152,6 +303,14 @@ static inline int anj_net_close(anj_net_binding_type_t type,
     case ANJ_NET_BINDING_DTLS:
         return anj_dtls_close(ctx);
 #    endif // defined(ANJ_NET_WITH_DTLS)
+#    if defined(ANJ_NET_WITH_TCP)
+    case ANJ_NET_BINDING_TCP:
+        return anj_tcp_close(ctx);
+#    endif // defined(ANJ_NET_WITH_TCP)
+#    if defined(ANJ_NET_WITH_TLS)
+    case ANJ_NET_BINDING_TLS:
+        return anj_tls_close(ctx);
+#    endif // defined(ANJ_NET_WITH_TLS)
 #    if defined(ANJ_NET_WITH_NON_IP_BINDING)
     case ANJ_NET_BINDING_NON_IP:
         return anj_non_ip_close(ctx);
@@ -164,6 +323,11 @@ static inline int anj_net_close(anj_net_binding_type_t type,
 /** @see anj_net_cleanup_ctx_t */
 static inline int anj_net_cleanup_ctx(anj_net_binding_type_t type,
                                       anj_net_ctx_t **ctx) {
+#    ifdef ANJ_NET_WITH_IO_THREAD
+    if (_ANJ_NET_WRAPPER_OFFLOADED(type)) {
+        return anj_net_io_thread_cleanup_ctx(ctx);
+    }
+#    endif // ANJ_NET_WITH_IO_THREAD
     switch (type) {
 #    if defined(ANJ_NET_WITH_UDP)
     case ANJ_NET_BINDING_UDP:
@@ -173,6 +337,14 @@ static inline int anj_net_cleanup_ctx(anj_net_binding_type_t type,
     case ANJ_NET_BINDING_DTLS:
         return anj_dtls_cleanup_ctx(ctx);
 #    endif // defined(ANJ_NET_WITH_DTLS)
+#    if defined(ANJ_NET_WITH_TCP)
+    case ANJ_NET_BINDING_TCP:
+        return anj_tcp_cleanup_ctx(ctx);
+#    endif // defined(ANJ_NET_WITH_TCP)
+#    if defined(ANJ_NET_WITH_TLS)
+    case ANJ_NET_BINDING_TLS:
+        return anj_tls_cleanup_ctx(ctx);
+#    endif // defined(ANJ_NET_WITH_TLS)
 #    if defined(ANJ_NET_WITH_NON_IP_BINDING)
     case ANJ_NET_BINDING_NON_IP:
         return anj_non_ip_cleanup_ctx(ctx);
@@ -186,6 +358,11 @@ static inline int anj_net_cleanup_ctx(anj_net_binding_type_t type,
 static inline int anj_net_get_inner_mtu(anj_net_binding_type_t type,
                                         anj_net_ctx_t *ctx,
                                         int32_t *out_value) {
+#    ifdef ANJ_NET_WITH_IO_THREAD
+    if (_ANJ_NET_WRAPPER_OFFLOADED(type)) {
+        return anj_net_io_thread_get_inner_mtu(ctx, out_value);
+    }
+#    endif // ANJ_NET_WITH_IO_THREAD
     switch (type) {
 #    if defined(ANJ_NET_WITH_UDP)
     case ANJ_NET_BINDING_UDP:
@@ -195,6 +372,14 @@ static inline int anj_net_get_inner_mtu(anj_net_binding_type_t type,
     case ANJ_NET_BINDING_DTLS:
         return anj_dtls_get_inner_mtu(ctx, out_value);
 #    endif // defined(ANJ_NET_WITH_DTLS)
+#    if defined(ANJ_NET_WITH_TCP)
+    case ANJ_NET_BINDING_TCP:
+        return anj_tcp_get_inner_mtu(ctx, out_value);
+#    endif // defined(ANJ_NET_WITH_TCP)
+#    if defined(ANJ_NET_WITH_TLS)
+    case ANJ_NET_BINDING_TLS:
+        return anj_tls_get_inner_mtu(ctx, out_value);
+#    endif // defined(ANJ_NET_WITH_TLS)
 #    if defined(ANJ_NET_WITH_NON_IP_BINDING)
     case ANJ_NET_BINDING_NON_IP:
         return anj_non_ip_get_inner_mtu(ctx, out_value);
@@ -208,6 +393,11 @@ static inline int anj_net_get_inner_mtu(anj_net_binding_type_t type,
 static inline int anj_net_get_state(anj_net_binding_type_t type,
                                     anj_net_ctx_t *ctx,
                                     anj_net_socket_state_t *out_value) {
+#    ifdef ANJ_NET_WITH_IO_THREAD
+    if (_ANJ_NET_WRAPPER_OFFLOADED(type)) {
+        return anj_net_io_thread_get_state(ctx, out_value);
+    }
+#    endif // ANJ_NET_WITH_IO_THREAD
     switch (type) {
 #    if defined(ANJ_NET_WITH_UDP)
     case ANJ_NET_BINDING_UDP:
@@ -217,6 +407,14 @@ static inline int anj_net_get_state(anj_net_binding_type_t type,
     case ANJ_NET_BINDING_DTLS:
         return anj_dtls_get_state(ctx, out_value);
 #    endif // defined(ANJ_NET_WITH_DTLS)
+#    if defined(ANJ_NET_WITH_TCP)
+    case ANJ_NET_BINDING_TCP:
+        return anj_tcp_get_state(ctx, out_value);
+#    endif // defined(ANJ_NET_WITH_TCP)
+#    if defined(ANJ_NET_WITH_TLS)
+    case ANJ_NET_BINDING_TLS:
+        return anj_tls_get_state(ctx, out_value);
+#    endif // defined(ANJ_NET_WITH_TLS)
 #    if defined(ANJ_NET_WITH_NON_IP_BINDING)
     case ANJ_NET_BINDING_NON_IP:
         return anj_non_ip_get_state(ctx, out_value);
@@ -229,6 +427,11 @@ static inline int anj_net_get_state(anj_net_binding_type_t type,
 /** @see anj_net_queue_mode_rx_off_t */
 static inline int anj_net_queue_mode_rx_off(anj_net_binding_type_t type,
                                             anj_net_ctx_t *ctx) {
+#    ifdef ANJ_NET_WITH_IO_THREAD
+    if (_ANJ_NET_WRAPPER_OFFLOADED(type)) {
+        return anj_net_io_thread_queue_mode_rx_off(ctx);
+    }
+#    endif // ANJ_NET_WITH_IO_THREAD
     switch (type) {
 #    if defined(ANJ_NET_WITH_UDP)
     case ANJ_NET_BINDING_UDP:
@@ -238,6 +441,14 @@ static inline int anj_net_queue_mode_rx_off(anj_net_binding_type_t type,
     case ANJ_NET_BINDING_DTLS:
         return anj_dtls_queue_mode_rx_off(ctx);
 #    endif // defined(ANJ_NET_WITH_DTLS)
+#    if defined(ANJ_NET_WITH_TCP)
+    case ANJ_NET_BINDING_TCP:
+        return anj_tcp_queue_mode_rx_off(ctx);
+#    endif // defined(ANJ_NET_WITH_TCP)
+#    if defined(ANJ_NET_WITH_TLS)
+    case ANJ_NET_BINDING_TLS:
+        return anj_tls_queue_mode_rx_off(ctx);
+#    endif // defined(ANJ_NET_WITH_TLS)
 #    if defined(ANJ_NET_WITH_NON_IP_BINDING)
     case ANJ_NET_BINDING_NON_IP:
         return anj_non_ip_queue_mode_rx_off(ctx);
@@ -247,6 +458,121 @@ static inline int anj_net_queue_mode_rx_off(anj_net_binding_type_t type,
     }
 }
 
+#    ifdef ANJ_NET_WITH_POLL_HANDLE
+/** @see anj_net_get_poll_handle_t */
+static inline int anj_net_get_poll_handle(anj_net_binding_type_t type,
+                                          anj_net_ctx_t *ctx,
+                                          anj_net_poll_handle_t *out_handle,
+                                          bool *out_data_pending) {
+#        ifdef ANJ_NET_WITH_IO_THREAD
+    if (_ANJ_NET_WRAPPER_OFFLOADED(type)) {
+        return anj_net_io_thread_get_poll_handle(ctx, out_handle,
+                                                 out_data_pending);
+    }
+#        endif // ANJ_NET_WITH_IO_THREAD
+    switch (type) {
+#        if defined(ANJ_NET_WITH_UDP)
+    case ANJ_NET_BINDING_UDP:
+        return anj_udp_get_poll_handle(ctx, out_handle, out_data_pending);
+#        endif // defined(ANJ_NET_WITH_UDP)
+#        if defined(ANJ_NET_WITH_DTLS)
+    case ANJ_NET_BINDING_DTLS:
+        return anj_dtls_get_poll_handle(ctx, out_handle, out_data_pending);
+#        endif // defined(ANJ_NET_WITH_DTLS)
+#        if defined(ANJ_NET_WITH_TCP)
+    case ANJ_NET_BINDING_TCP:
+        return anj_tcp_get_poll_handle(ctx, out_handle, out_data_pending);
+#        endif // defined(ANJ_NET_WITH_TCP)
+#        if defined(ANJ_NET_WITH_TLS)
+    case ANJ_NET_BINDING_TLS:
+        return anj_tls_get_poll_handle(ctx, out_handle, out_data_pending);
+#        endif // defined(ANJ_NET_WITH_TLS)
+#        if defined(ANJ_NET_WITH_NON_IP_BINDING)
+    case ANJ_NET_BINDING_NON_IP:
+        return anj_non_ip_get_poll_handle(ctx, out_handle, out_data_pending);
+#        endif // defined(ANJ_NET_WITH_NON_IP_BINDING)
+    default:
+        return ANJ_NET_ENOTSUP;
+    }
+}
+#    endif // ANJ_NET_WITH_POLL_HANDLE
+
+#    ifdef ANJ_NET_WITH_RELEASE_ASSISTANCE
+/** @see anj_net_release_assistance_t */
+static inline int anj_net_release_assistance(anj_net_binding_type_t type,
+                                             anj_net_ctx_t *ctx,
+                                             anj_net_release_hint_t hint) {
+#        ifdef ANJ_NET_WITH_IO_THREAD
+    // datagrams are sent asynchronously, the hint wouldn't match them
+    if (_ANJ_NET_WRAPPER_OFFLOADED(type)) {
+        return ANJ_NET_ENOTSUP;
+    }
+#        endif // ANJ_NET_WITH_IO_THREAD
+    switch (type) {
+#        if defined(ANJ_NET_WITH_UDP)
+    case ANJ_NET_BINDING_UDP:
+        return anj_udp_release_assistance(ctx, hint);
+#        endif // defined(ANJ_NET_WITH_UDP)
+#        if defined(ANJ_NET_WITH_DTLS)
+    case ANJ_NET_BINDING_DTLS:
+        return anj_dtls_release_assistance(ctx, hint);
+#        endif // defined(ANJ_NET_WITH_DTLS)
+#        if defined(ANJ_NET_WITH_TCP)
+    case ANJ_NET_BINDING_TCP:
+        return anj_tcp_release_assistance(ctx, hint);
+#        endif // defined(ANJ_NET_WITH_TCP)
+#        if defined(ANJ_NET_WITH_TLS)
+    case ANJ_NET_BINDING_TLS:
+        return anj_tls_release_assistance(ctx, hint);
+#        endif // defined(ANJ_NET_WITH_TLS)
+#        if defined(ANJ_NET_WITH_NON_IP_BINDING)
+    case ANJ_NET_BINDING_NON_IP:
+        return anj_non_ip_release_assistance(ctx, hint);
+#        endif // defined(ANJ_NET_WITH_NON_IP_BINDING)
+    default:
+        return ANJ_NET_ENOTSUP;
+    }
+}
+#    endif // ANJ_NET_WITH_RELEASE_ASSISTANCE
+
+#    ifdef ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
+/** @see anj_net_session_store_t */
+static inline int
+anj_net_session_store(anj_net_binding_type_t type,
+                      anj_net_ctx_t *ctx,
+                      const anj_persistence_context_t *persistence) {
+#        ifdef ANJ_NET_WITH_IO_THREAD
+    if (_ANJ_NET_WRAPPER_OFFLOADED(type)) {
+        return ANJ_NET_ENOTSUP;
+    }
+#        endif // ANJ_NET_WITH_IO_THREAD
+    switch (type) {
+    case ANJ_NET_BINDING_DTLS:
+        return anj_dtls_session_store(ctx, persistence);
+    default:
+        return ANJ_NET_ENOTSUP;
+    }
+}
+
+/** @see anj_net_session_restore_t */
+static inline int
+anj_net_session_restore(anj_net_binding_type_t type,
+                        anj_net_ctx_t *ctx,
+                        const anj_persistence_context_t *persistence) {
+#        ifdef ANJ_NET_WITH_IO_THREAD
+    if (_ANJ_NET_WRAPPER_OFFLOADED(type)) {
+        return ANJ_NET_ENOTSUP;
+    }
+#        endif // ANJ_NET_WITH_IO_THREAD
+    switch (type) {
+    case ANJ_NET_BINDING_DTLS:
+        return anj_dtls_session_restore(ctx, persistence);
+    default:
+        return ANJ_NET_ENOTSUP;
+    }
+}
+#    endif // ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
+
 #    ifdef __cplusplus
 }
 #    endif
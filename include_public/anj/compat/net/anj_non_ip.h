@@ -35,6 +35,9 @@ anj_net_close_t anj_non_ip_close;
 anj_net_connect_t anj_non_ip_connect;
 anj_net_create_ctx_t anj_non_ip_create_ctx;
 anj_net_send_t anj_non_ip_send;
+#        ifdef ANJ_NET_WITH_SEND_VEC
+anj_net_send_vec_t anj_non_ip_send_vec;
+#        endif // ANJ_NET_WITH_SEND_VEC
 anj_net_recv_t anj_non_ip_recv;
 anj_net_cleanup_ctx_t anj_non_ip_cleanup_ctx;
 
@@ -42,6 +45,12 @@ anj_net_get_bytes_received_t anj_non_ip_get_bytes_received;
 anj_net_get_bytes_sent_t anj_non_ip_get_bytes_sent;
 anj_net_get_inner_mtu_t anj_non_ip_get_inner_mtu;
 anj_net_get_state_t anj_non_ip_get_state;
+#        ifdef ANJ_NET_WITH_POLL_HANDLE
+anj_net_get_poll_handle_t anj_non_ip_get_poll_handle;
+#        endif // ANJ_NET_WITH_POLL_HANDLE
+#        ifdef ANJ_NET_WITH_RELEASE_ASSISTANCE
+anj_net_release_assistance_t anj_non_ip_release_assistance;
+#        endif // ANJ_NET_WITH_RELEASE_ASSISTANCE
 
 #    endif // ANJ_NET_WITH_NON_IP_BINDING
 
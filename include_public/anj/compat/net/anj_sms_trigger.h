@@ -0,0 +1,66 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+/**
+ * @file
+ * @brief Platform hook reporting wakeup triggers received over SMS.
+ *
+ * A client in Queue Mode handles requests of the LwM2M Server only after it
+ * sends an Update, which may take hours. The LwM2M Server may instead send an
+ * SMS (or any other out-of-band wakeup signal supported by the modem) asking
+ * the device to update its registration. The modem driver recognizes such a
+ * trigger, and this hook passes it to the library.
+ *
+ * These symbols are declared only if @c ANJ_WITH_SMS_TRIGGER is enabled.
+ */
+
+#ifndef ANJ_SMS_TRIGGER_H
+#    define ANJ_SMS_TRIGGER_H
+
+#    include <stdbool.h>
+#    include <stdint.h>
+
+#    ifdef __cplusplus
+extern "C" {
+#    endif
+
+#    ifdef ANJ_WITH_SMS_TRIGGER
+
+/**
+ * Checks whether a Registration Update Trigger from the LwM2M Server with
+ * Short Server ID @p ssid has been received since the last call.
+ *
+ * Implementation has to be provided by the application, usually by the modem
+ * driver. It is called in every @ref anj_core_step while the client is
+ * registered, including Queue Mode, so it must not block. If it returns
+ * @c true, a Registration Update is started right away, which makes the client
+ * go online and handle requests of the LwM2M Server.
+ *
+ * The application should call @ref anj_core_step as soon as the modem reports
+ * a trigger; @ref anj_core_next_step_time does not account for triggers that
+ * haven't been received yet.
+ *
+ * @note The client does not handle CoAP messages received over SMS, so the
+ *       binding reported to the LwM2M Server does not change.
+ *
+ * @param ssid Short Server ID of the LwM2M Server the client is registered to.
+ *
+ * @return @c true if a trigger has been received, @c false otherwise.
+ */
+bool anj_sms_trigger_received(uint16_t ssid);
+
+#    endif // ANJ_WITH_SMS_TRIGGER
+
+#    ifdef __cplusplus
+}
+#    endif
+
+#endif // ANJ_SMS_TRIGGER_H
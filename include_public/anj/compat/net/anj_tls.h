@@ -0,0 +1,58 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+/**
+ * @file
+ * @brief Network backend interface for TLS transport.
+ *
+ * Declares the TLS variant of the generic @ref anj_net_api.h
+ * functions (create, connect, send, recv, etc.).
+ *
+ * These symbols are defined only if @ref ANJ_NET_WITH_TLS is
+ * enabled. They provide the TLS binding used by
+ * @ref anj_net_wrapper.h for dispatch.
+ */
+
+#ifndef ANJ_TLS_H
+#    define ANJ_TLS_H
+
+#    ifdef __cplusplus
+extern "C" {
+#    endif
+
+#    ifdef ANJ_NET_WITH_TLS
+
+#        include <anj/compat/net/anj_net_api.h>
+
+anj_net_close_t anj_tls_close;
+anj_net_connect_t anj_tls_connect;
+anj_net_create_ctx_t anj_tls_create_ctx;
+anj_net_send_t anj_tls_send;
+anj_net_recv_t anj_tls_recv;
+anj_net_cleanup_ctx_t anj_tls_cleanup_ctx;
+
+anj_net_get_inner_mtu_t anj_tls_get_inner_mtu;
+anj_net_get_state_t anj_tls_get_state;
+#        ifdef ANJ_NET_WITH_POLL_HANDLE
+anj_net_get_poll_handle_t anj_tls_get_poll_handle;
+#        endif // ANJ_NET_WITH_POLL_HANDLE
+anj_net_queue_mode_rx_off_t anj_tls_queue_mode_rx_off;
+#        ifdef ANJ_NET_WITH_RELEASE_ASSISTANCE
+anj_net_release_assistance_t anj_tls_release_assistance;
+#        endif // ANJ_NET_WITH_RELEASE_ASSISTANCE
+
+#    endif // ANJ_NET_WITH_TLS
+
+#    ifdef __cplusplus
+}
+#    endif
+
+#endif // ANJ_TLS_H
@@ -36,12 +36,25 @@ anj_net_close_t anj_udp_close;
 anj_net_connect_t anj_udp_connect;
 anj_net_create_ctx_t anj_udp_create_ctx;
 anj_net_send_t anj_udp_send;
+#        ifdef ANJ_NET_WITH_SEND_VEC
+anj_net_send_vec_t anj_udp_send_vec;
+#        endif // ANJ_NET_WITH_SEND_VEC
 anj_net_recv_t anj_udp_recv;
+#        ifdef ANJ_NET_WITH_BATCH_IO
+anj_net_recv_batch_t anj_udp_recv_batch;
+anj_net_send_batch_t anj_udp_send_batch;
+#        endif // ANJ_NET_WITH_BATCH_IO
 anj_net_cleanup_ctx_t anj_udp_cleanup_ctx;
 
 anj_net_get_inner_mtu_t anj_udp_get_inner_mtu;
 anj_net_get_state_t anj_udp_get_state;
+#        ifdef ANJ_NET_WITH_POLL_HANDLE
+anj_net_get_poll_handle_t anj_udp_get_poll_handle;
+#        endif // ANJ_NET_WITH_POLL_HANDLE
 anj_net_queue_mode_rx_off_t anj_udp_queue_mode_rx_off;
+#        ifdef ANJ_NET_WITH_RELEASE_ASSISTANCE
+anj_net_release_assistance_t anj_udp_release_assistance;
+#        endif // ANJ_NET_WITH_RELEASE_ASSISTANCE
 
 #    endif // ANJ_NET_WITH_UDP
 
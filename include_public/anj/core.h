@@ -42,12 +42,279 @@
 #        include <anj/lwm2m_send.h>
 #    endif // ANJ_WITH_LWM2M_SEND
 
+/** @cond */
+#    ifdef ANJ_OBSERVE_WITH_USER_STORAGE
+#        define ANJ_INTERNAL_INCLUDE_OBSERVE
+#        include <anj_internal/observe.h> // IWYU pragma: export
+#        undef ANJ_INTERNAL_INCLUDE_OBSERVE
+#    endif // ANJ_OBSERVE_WITH_USER_STORAGE
+/** @endcond */
+
+#    if defined(ANJ_WITH_SESSION_PERSISTENCE)         \
+            || (defined(ANJ_WITH_NAT_KEEPALIVE_PROBING) \
+                && defined(ANJ_WITH_PERSISTENCE))
+#        include <anj/persistence.h>
+#    endif // defined(ANJ_WITH_SESSION_PERSISTENCE) ||
+           // (defined(ANJ_WITH_NAT_KEEPALIVE_PROBING) &&
+           // defined(ANJ_WITH_PERSISTENCE))
+
+#    ifdef ANJ_WITH_METRICS
+#        include <anj/metrics.h>
+#    endif // ANJ_WITH_METRICS
+
+#    ifdef ANJ_WITH_TRACE
+#        include <anj/trace.h>
+#    endif // ANJ_WITH_TRACE
+
+#    ifdef ANJ_WITH_OSCORE
+#        include <anj/oscore.h>
+#    endif // ANJ_WITH_OSCORE
+
 #    ifdef __cplusplus
 extern "C" {
 #    endif
 
 #    define ANJ_SUPPORTED_BINDING_MODES "U"
 
+#    ifdef ANJ_WITH_MSG_BUFFER_ARENA
+/**
+ * Worst-case size of the region passed as
+ * @ref anj_configuration_t::msg_buffer_arena for the current configuration:
+ * - input and output message buffers share the same memory, so the larger of
+ *   @ref ANJ_IN_MSG_BUFFER_SIZE and @ref ANJ_OUT_MSG_BUFFER_SIZE is reserved,
+ * - followed by @ref ANJ_OUT_PAYLOAD_BUFFER_SIZE for the payload buffer,
+ * - followed by another @ref ANJ_OUT_PAYLOAD_BUFFER_SIZE for the payload of
+ *   the cached response, if @ref ANJ_WITH_CACHE is enabled.
+ *
+ * If @ref ANJ_WITH_MSG_BUFFER_POOL is enabled, the first two are borrowed from
+ * @ref anj_configuration_t::msg_buffer_pool instead, and only the last one is
+ * reserved.
+ */
+#        ifdef ANJ_WITH_MSG_BUFFER_POOL
+#            define ANJ_MSG_BUFFER_ARENA_SIZE _ANJ_MSG_BUFFER_ARENA_CACHE_SIZE
+#        else // ANJ_WITH_MSG_BUFFER_POOL
+#            define ANJ_MSG_BUFFER_ARENA_SIZE                          \
+                (_ANJ_MSG_BUFFER_ARENA_IN_OUT_SIZE                     \
+                 + ANJ_OUT_PAYLOAD_BUFFER_SIZE                         \
+                 + _ANJ_MSG_BUFFER_ARENA_CACHE_SIZE)
+#        endif // ANJ_WITH_MSG_BUFFER_POOL
+
+#        define _ANJ_MSG_BUFFER_ARENA_IN_OUT_SIZE            \
+            (ANJ_IN_MSG_BUFFER_SIZE > ANJ_OUT_MSG_BUFFER_SIZE \
+                     ? ANJ_IN_MSG_BUFFER_SIZE                 \
+                     : ANJ_OUT_MSG_BUFFER_SIZE)
+#        ifdef ANJ_WITH_CACHE
+#            define _ANJ_MSG_BUFFER_ARENA_CACHE_SIZE ANJ_OUT_PAYLOAD_BUFFER_SIZE
+#        else // ANJ_WITH_CACHE
+#            define _ANJ_MSG_BUFFER_ARENA_CACHE_SIZE 0
+#        endif // ANJ_WITH_CACHE
+#    endif // ANJ_WITH_MSG_BUFFER_ARENA
+
+#    ifdef ANJ_WITH_MSG_BUFFER_POOL
+/**
+ * Size of the memory region passed to @ref anj_msg_buffer_pool_init for
+ * @p Scratch_count input/output buffers and @p Payload_count payload buffers.
+ *
+ * An @ref anj_t instance holds an input/output buffer only during
+ * @ref anj_core_step (or longer, while a message cannot be sent at once), and
+ * a payload buffer for the whole duration of an exchange. For a single thread
+ * stepping all instances, one input/output buffer is usually enough, and the
+ * number of payload buffers limits the number of concurrent exchanges.
+ */
+#        define ANJ_MSG_BUFFER_POOL_SIZE(Scratch_count, Payload_count) \
+            ((Scratch_count) * _ANJ_MSG_BUFFER_ARENA_IN_OUT_SIZE       \
+             + (Payload_count) * ANJ_OUT_PAYLOAD_BUFFER_SIZE)
+
+/**
+ * Pool of message buffers shared by multiple @ref anj_t instances. Must be
+ * initialized with @ref anj_msg_buffer_pool_init.
+ *
+ * @warning The pool is not thread-safe, all instances that share it must be
+ *          stepped from the same thread.
+ */
+typedef struct {
+    /** @cond */
+    // free buffers form singly linked lists, the link is stored at the
+    // beginning of the buffer itself
+    uint8_t *free_scratch;
+    uint8_t *free_payload;
+    /** @endcond */
+} anj_msg_buffer_pool_t;
+
+/**
+ * Initializes a pool of message buffers, carving @p scratch_count input/output
+ * buffers and @p payload_count payload buffers from @p memory.
+ *
+ * @warning The region is not copied internally. The user must ensure that it
+ *          remains valid for the entire lifetime of the pool and of all
+ *          @ref anj_t objects using it.
+ *
+ * @param pool          Pool to initialize.
+ * @param memory        Memory region from which the buffers are carved.
+ * @param memory_size   Size of @p memory in bytes, at least
+ *                      @ref ANJ_MSG_BUFFER_POOL_SIZE(@p scratch_count,
+ *                      @p payload_count).
+ * @param scratch_count Number of input/output buffers, at least 1.
+ * @param payload_count Number of payload buffers, at least 1.
+ *
+ * @return 0 on success, a non-zero value if @p memory is too small or any of
+ *         the counts is 0.
+ */
+int anj_msg_buffer_pool_init(anj_msg_buffer_pool_t *pool,
+                             uint8_t *memory,
+                             size_t memory_size,
+                             size_t scratch_count,
+                             size_t payload_count);
+#    endif // ANJ_WITH_MSG_BUFFER_POOL
+
+#    ifdef ANJ_WITH_TRANSIENT_ALLOC
+/**
+ * Allocates a buffer needed only while a rarely used operation is processed,
+ * see @ref anj_configuration_t::transient_alloc.
+ *
+ * @param arg  Opaque argument, @ref anj_configuration_t::transient_alloc_arg.
+ * @param size Size of the buffer in bytes, at most
+ *             @ref ANJ_TRANSIENT_ALLOC_MAX_SIZE.
+ *
+ * @return Buffer suitably aligned for any object, or @c NULL if there is no
+ *         memory available at the moment.
+ */
+typedef void *anj_transient_alloc_t(void *arg, size_t size);
+
+/**
+ * Releases a buffer returned by @ref anj_transient_alloc_t.
+ *
+ * @param arg Opaque argument, @ref anj_configuration_t::transient_alloc_arg.
+ * @param ptr Buffer to release.
+ */
+typedef void anj_transient_free_t(void *arg, void *ptr);
+
+/**
+ * Size of the largest buffer requested from
+ * @ref anj_configuration_t::transient_alloc in the current configuration, 0 if
+ * no buffers are requested at all.
+ */
+#        ifdef ANJ_DM_WITH_COMP_READ_PATH_STREAMING
+#            define ANJ_TRANSIENT_ALLOC_MAX_SIZE sizeof(_anj_io_in_ctx_t)
+#        else // ANJ_DM_WITH_COMP_READ_PATH_STREAMING
+#            define ANJ_TRANSIENT_ALLOC_MAX_SIZE 0
+#        endif // ANJ_DM_WITH_COMP_READ_PATH_STREAMING
+
+/**
+ * Size of a block of @ref anj_block_pool_t holding at least @p Size bytes,
+ * rounded up to keep all blocks aligned.
+ */
+#        define ANJ_BLOCK_POOL_BLOCK_SIZE(Size)                     \
+            ((((Size) > 0 ? (Size) : 1) + _ANJ_BLOCK_POOL_ALIGN - 1) \
+             / _ANJ_BLOCK_POOL_ALIGN * _ANJ_BLOCK_POOL_ALIGN)
+
+/**
+ * Size of the memory region passed to @ref anj_block_pool_init for
+ * @p Block_count blocks of @p Block_size bytes.
+ */
+#        define ANJ_BLOCK_POOL_SIZE(Block_size, Block_count) \
+            ((Block_count) * ANJ_BLOCK_POOL_BLOCK_SIZE(Block_size))
+
+/** @cond */
+typedef union {
+    long long ll;
+    long double ld;
+    void *ptr;
+    void (*fn)(void);
+} _anj_block_pool_align_t;
+
+#        define _ANJ_BLOCK_POOL_ALIGN sizeof(_anj_block_pool_align_t)
+/** @endcond */
+
+/**
+ * Defines an array @p Name, aligned for any object, of
+ * @ref ANJ_BLOCK_POOL_SIZE(@p Block_size, @p Block_count) bytes, to be passed
+ * to @ref anj_block_pool_init, e.g.
+ * <c>static ANJ_BLOCK_POOL_MEMORY(memory, ANJ_TRANSIENT_ALLOC_MAX_SIZE, 1);</c>
+ */
+#        define ANJ_BLOCK_POOL_MEMORY(Name, Block_size, Block_count) \
+            _anj_block_pool_align_t Name[ANJ_BLOCK_POOL_SIZE(        \
+                    Block_size, Block_count)                         \
+                                         / _ANJ_BLOCK_POOL_ALIGN]
+
+/**
+ * Pool of fixed-size blocks, whose @ref anj_block_pool_alloc and
+ * @ref anj_block_pool_free functions may be used as
+ * @ref anj_configuration_t::transient_alloc and
+ * @ref anj_configuration_t::transient_free, with the pool as their argument.
+ * Must be initialized with @ref anj_block_pool_init.
+ *
+ * @warning The pool is not thread-safe, all its users must run in the same
+ *          thread.
+ */
+typedef struct {
+    /** @cond */
+    // free blocks form a singly linked list, the link is stored at the
+    // beginning of the block itself
+    void *free_blocks;
+    size_t block_size;
+    /** @endcond */
+} anj_block_pool_t;
+
+/**
+ * Initializes a pool of blocks of @p block_size bytes, carving as many of them
+ * as fit from @p memory.
+ *
+ * @warning The region is not copied internally. The user must ensure that it
+ *          remains valid for the entire lifetime of the pool and of all its
+ *          users.
+ *
+ * @param pool        Pool to initialize.
+ * @param memory      Memory region from which the blocks are carved, suitably
+ *                    aligned for any object, e.g. defined with
+ *                    @ref ANJ_BLOCK_POOL_MEMORY or returned by @c malloc().
+ * @param memory_size Size of @p memory in bytes, at least
+ *                    @ref ANJ_BLOCK_POOL_SIZE(@p block_size, 1).
+ * @param block_size  Size of a single block in bytes, for use with
+ *                    @ref anj_t at least @ref ANJ_TRANSIENT_ALLOC_MAX_SIZE.
+ *
+ * @return 0 on success, a non-zero value if @p memory is misaligned or too
+ *         small.
+ */
+int anj_block_pool_init(anj_block_pool_t *pool,
+                        void *memory,
+                        size_t memory_size,
+                        size_t block_size);
+
+/**
+ * Takes a block from the pool, implements @ref anj_transient_alloc_t.
+ *
+ * @param pool Pool initialized with @ref anj_block_pool_init.
+ * @param size Number of bytes needed.
+ *
+ * @return Free block, or @c NULL if @p size exceeds the block size or all
+ *         blocks are taken.
+ */
+void *anj_block_pool_alloc(void *pool, size_t size);
+
+/**
+ * Returns a block to the pool, implements @ref anj_transient_free_t.
+ *
+ * @param pool Pool the block was taken from.
+ * @param ptr  Block returned by @ref anj_block_pool_alloc, or @c NULL.
+ */
+void anj_block_pool_free(void *pool, void *ptr);
+#    endif // ANJ_WITH_TRANSIENT_ALLOC
+
+#    ifdef ANJ_OBSERVE_WITH_USER_STORAGE
+/**
+ * Entry of a table of Observations provided in
+ * @ref anj_configuration_t::observations. Its contents are internal.
+ */
+typedef _anj_observe_observation_t anj_observation_entry_t;
+
+/**
+ * Entry of a table of attributes set with Write-Attributes provided in
+ * @ref anj_configuration_t::write_attributes. Its contents are internal.
+ */
+typedef _anj_observe_attr_storage_t anj_write_attributes_entry_t;
+#    endif // ANJ_OBSERVE_WITH_USER_STORAGE
+
 /**
  * This enum represents the possible states of a server connection.
  */
@@ -214,6 +481,49 @@ typedef struct anj_configuration_struct {
      */
     anj_time_duration_t queue_mode_timeout;
 
+#    ifdef ANJ_WITH_QUEUE_MODE_WAKE_WINDOW
+    /**
+     * Requests planned within this time are grouped into a single period in
+     * which the client is online in Queue Mode:
+     *  - when the client goes online to send a Send message or a
+     *    Notification, the Update due within this time is sent right away as
+     *    the first message,
+     *  - the client does not go offline if an Update, a Send message or a
+     *    Notification is planned within this time after
+     *    @ref queue_mode_timeout expires.
+     *
+     * If not set, requests are not grouped.
+     */
+    anj_time_duration_t queue_mode_wake_window;
+#    endif // ANJ_WITH_QUEUE_MODE_WAKE_WINDOW
+#    ifdef ANJ_WITH_UPDATE_HOLD_DOWN
+
+    /**
+     * Time for which a triggered Registration Update is held back, counted
+     * from the first trigger. Triggers and Object list changes within this
+     * time are merged into a single Update, sent when it ends. If the periodic
+     * Update becomes due in the meantime, the Update is sent right away.
+     *
+     * If not set, an Update is sent as soon as it is triggered.
+     */
+    anj_time_duration_t update_hold_down;
+#    endif // ANJ_WITH_UPDATE_HOLD_DOWN
+#    ifdef ANJ_WITH_NAT_KEEPALIVE_PROBING
+
+    /**
+     * Idle time after which the NAT binding is assumed to still exist; the
+     * search for its timeout starts from it. If not set, 30 seconds is used.
+     */
+    anj_time_duration_t nat_keepalive_min;
+
+    /**
+     * Longest idle time the search for the NAT binding timeout may end with,
+     * so that the client never stays idle for longer than that while online.
+     * If not set, the search is disabled and no keep-alive Updates are sent.
+     */
+    anj_time_duration_t nat_keepalive_max;
+#    endif // ANJ_WITH_NAT_KEEPALIVE_PROBING
+
     /**
      * Network socket configuration.
      */
@@ -230,6 +540,34 @@ typedef struct anj_configuration_struct {
      * the default value of @ref ANJ_EXCHANGE_SERVER_REQUEST_TIMEOUT is used.
      */
     anj_time_duration_t exchange_request_timeout;
+#    ifdef ANJ_WITH_SCHEDULING_JITTER
+
+    /**
+     * Maximum delay of the Register message after the registration starts
+     * (e.g. after boot), and of the Bootstrap Request on top of the Client Hold
+     * Off Time. The actual delay is derived from @ref endpoint_name, so it is
+     * the same on every start of a given device, but spread uniformly over the
+     * whole range across devices.
+     *
+     * If not set, the Register is sent immediately.
+     */
+    anj_time_duration_t register_spread;
+
+    /**
+     * Part of the Update interval, in percent (0-100), by which the Update is
+     * sent earlier, derived from @ref endpoint_name. The Update is never
+     * delayed, so that the registration never expires.
+     */
+    uint8_t update_spread_percent;
+
+    /**
+     * Maximum extension of every communication retry delay (Communication
+     * Retry Timer, Communication Sequence Delay Timer and
+     * @ref bootstrap_retry_timeout), in percent of that delay. The actual
+     * value is derived from @ref endpoint_name and the attempt number.
+     */
+    uint8_t retry_spread_percent;
+#    endif // ANJ_WITH_SCHEDULING_JITTER
 #    ifdef ANJ_WITH_BOOTSTRAP
 
     /**
@@ -259,6 +597,95 @@ typedef struct anj_configuration_struct {
      */
     anj_time_duration_t bootstrap_timeout;
 #    endif // ANJ_WITH_BOOTSTRAP
+#    ifdef ANJ_WITH_MSG_BUFFER_ARENA
+
+    /**
+     * Memory region from which the input, output and payload buffers (and the
+     * response cache buffer, if @ref ANJ_WITH_CACHE is enabled) are carved.
+     * Must be non-NULL, unless @ref ANJ_MSG_BUFFER_ARENA_SIZE is 0.
+     *
+     * @warning The region is not copied internally. The user must ensure that
+     *          it remains valid and is not used for anything else for the
+     *          entire lifetime of @ref anj_t object.
+     */
+    uint8_t *msg_buffer_arena;
+
+    /**
+     * Size of @ref msg_buffer_arena in bytes. Must be at least
+     * @ref ANJ_MSG_BUFFER_ARENA_SIZE.
+     */
+    size_t msg_buffer_arena_size;
+#        ifdef ANJ_WITH_MSG_BUFFER_POOL
+
+    /**
+     * Pool from which the input, output and payload buffers are borrowed. It
+     * may be shared by any number of @ref anj_t objects. Must be non-NULL and
+     * initialized with @ref anj_msg_buffer_pool_init.
+     *
+     * @note If the pool is exhausted, @ref anj_core_step returns without doing
+     *       anything and has to be called again later.
+     */
+    anj_msg_buffer_pool_t *msg_buffer_pool;
+#        endif // ANJ_WITH_MSG_BUFFER_POOL
+#    endif // ANJ_WITH_MSG_BUFFER_ARENA
+#    ifdef ANJ_WITH_TRANSIENT_ALLOC
+
+    /**
+     * Allocator of the buffers needed only while a rarely used operation is
+     * processed, see @ref ANJ_WITH_TRANSIENT_ALLOC. Each buffer is released
+     * with @ref transient_free before @ref anj_core_step returns, so a small
+     * pool can be shared by many users, e.g. @ref anj_block_pool_alloc.
+     *
+     * If @c NULL, or if it returns @c NULL, the operation is rejected with
+     * 5.03 Service Unavailable response.
+     */
+    anj_transient_alloc_t *transient_alloc;
+
+    /**
+     * Releases the buffers returned by @ref transient_alloc. Must be non-NULL
+     * if @ref transient_alloc is set.
+     */
+    anj_transient_free_t *transient_free;
+
+    /** Argument passed to @ref transient_alloc and @ref transient_free. */
+    void *transient_alloc_arg;
+#    endif // ANJ_WITH_TRANSIENT_ALLOC
+#    ifdef ANJ_OBSERVE_WITH_USER_STORAGE
+
+    /**
+     * Table of Observations. If @c NULL, a table of
+     * @ref ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER entries embedded in
+     * @ref anj_t is used.
+     *
+     * @warning The table is not copied internally. The user must ensure that
+     *          it remains valid and is not used for anything else for the
+     *          entire lifetime of @ref anj_t object.
+     */
+    anj_observation_entry_t *observations;
+
+    /**
+     * Number of entries of @ref observations, between 1 and
+     * <c>UINT16_MAX - 1</c>. Ignored if @ref observations is @c NULL.
+     */
+    uint16_t observations_number;
+
+    /**
+     * Table of attributes set with Write-Attributes. If @c NULL, a table of
+     * @ref ANJ_OBSERVE_MAX_WRITE_ATTRIBUTES_NUMBER entries embedded in
+     * @ref anj_t is used.
+     *
+     * @warning The table is not copied internally. The user must ensure that
+     *          it remains valid and is not used for anything else for the
+     *          entire lifetime of @ref anj_t object.
+     */
+    anj_write_attributes_entry_t *write_attributes;
+
+    /**
+     * Number of entries of @ref write_attributes, between 1 and
+     * <c>UINT16_MAX - 1</c>. Ignored if @ref write_attributes is @c NULL.
+     */
+    uint16_t write_attributes_number;
+#    endif // ANJ_OBSERVE_WITH_USER_STORAGE
 } anj_configuration_t;
 
 /**
@@ -327,6 +754,148 @@ void anj_core_step(anj_t *anj);
  */
 anj_time_duration_t anj_core_next_step_time(anj_t *anj);
 
+#    ifdef ANJ_NET_WITH_POLL_HANDLE
+/**
+ * Describes what the next call to @ref anj_core_step waits for, see
+ * @ref anj_core_next_wakeup.
+ */
+typedef enum {
+    /** @ref anj_core_step should be called immediately. */
+    ANJ_CORE_WAKEUP_NOW = 0,
+
+    /**
+     * @ref anj_core_step should be called when the returned timeout expires.
+     * Network events are not relevant until then.
+     */
+    ANJ_CORE_WAKEUP_TIMER = 1,
+
+    /**
+     * @ref anj_core_step should be called when the returned poll handle becomes
+     * readable or the returned timeout expires, whichever happens first.
+     */
+    ANJ_CORE_WAKEUP_NET_OR_TIMER = 2
+} anj_core_wakeup_t;
+
+/**
+ * Event-driven alternative to @ref anj_core_next_step_time. Tells the
+ * application whether @ref anj_core_step has to be called right away, after a
+ * timeout, or as soon as a message arrives on the server connection.
+ *
+ * @ref ANJ_CORE_WAKEUP_NET_OR_TIMER is returned if the client is Registered and
+ * the only things it waits for are incoming messages (new LwM2M Server requests
+ * or the response to the ongoing request) and timers: retransmission, Update,
+ * Notifications and entering Queue Mode. The application can then wait on
+ * @p out_handle, e.g. by adding the file descriptor to an @c epoll set, instead
+ * of calling @ref anj_core_step in a loop. In other states the result is
+ * derived from @ref anj_core_next_step_time.
+ *
+ * @note Like in case of @ref anj_core_next_step_time, the returned values
+ *       become outdated if the data model is changed, a LwM2M Send request is
+ *       queued or any other API function is called. This function should be
+ *       called again after each @ref anj_core_step call, since @p out_handle
+ *       may change if the connection is set up again.
+ *
+ * @note Requires @c anj_udp_get_poll_handle (and the DTLS and Non-IP
+ *       equivalents if these bindings are used) to be implemented. If it
+ *       fails, @ref ANJ_CORE_WAKEUP_NOW is returned.
+ *
+ * @param      anj         Anjay object to operate on.
+ * @param[out] out_timeout Time until the next @ref anj_core_step call is
+ *                         required. Set to @ref ANJ_TIME_DURATION_INVALID if
+ *                         @ref ANJ_CORE_WAKEUP_NET_OR_TIMER is returned and
+ *                         there is no time limit.
+ * @param[out] out_handle  Set only if @ref ANJ_CORE_WAKEUP_NET_OR_TIMER is
+ *                         returned, handle of the server connection to wait
+ *                         on.
+ *
+ * @return What the next @ref anj_core_step call waits for.
+ */
+anj_core_wakeup_t anj_core_next_wakeup(anj_t *anj,
+                                       anj_time_duration_t *out_timeout,
+                                       anj_net_poll_handle_t *out_handle);
+
+#        ifdef ANJ_WITH_BUDGETED_STEP
+/**
+ * Limits of the work done by a single @ref anj_core_step_budgeted call.
+ */
+typedef struct {
+    /**
+     * Maximum number of actions, 0 for no limit. An action is a single
+     * transition of the internal state machine, e.g. sending or receiving a
+     * message, or preparing a response.
+     */
+    uint16_t max_actions;
+
+    /**
+     * Maximum time spent in the call, @ref ANJ_TIME_DURATION_INVALID for no
+     * limit. It is checked between actions, so the call may take longer by the
+     * duration of a single action.
+     */
+    anj_time_duration_t max_time;
+} anj_core_step_budget_t;
+
+/**
+ * Describes what the client waits for after @ref anj_core_step_budgeted.
+ */
+typedef enum {
+    /**
+     * There is more work to do, either because the budget was exhausted or
+     * because an operation is in progress (e.g. connecting). The step function
+     * should be called again after other tasks had a chance to run.
+     */
+    ANJ_CORE_STEP_YIELDED = 0,
+
+    /** The step function should be called when the timeout expires. */
+    ANJ_CORE_STEP_WAITS_FOR_TIMER = 1,
+
+    /**
+     * The step function should be called when the poll handle becomes readable
+     * or the timeout expires, whichever happens first.
+     */
+    ANJ_CORE_STEP_WAITS_FOR_NET = 2,
+
+    /**
+     * The client does nothing until the application calls one of the API
+     * functions, e.g. @ref anj_core_restart after a failure
+     * (@ref ANJ_CONN_STATUS_FAILURE).
+     */
+    ANJ_CORE_STEP_WAITS_FOR_APP = 3
+} anj_core_step_result_t;
+
+/**
+ * Variant of @ref anj_core_step for cooperative schedulers. Performs the same
+ * work, but returns once @p budget is exhausted, so that the time for which
+ * the calling task is held is bounded. The next call continues where the
+ * previous one stopped.
+ *
+ * After return, @p out_timeout and @p out_handle are set as by
+ * @ref anj_core_next_wakeup, so the caller does not need to call it.
+ *
+ * @note The budget is checked between actions. A single action is not
+ *       interrupted, so it still runs to completion, e.g. when the data model
+ *       handlers are called to build a message.
+ *
+ * @param      anj         Anjay object to operate on.
+ * @param      budget      Limits of the work done by this call.
+ * @param[out] out_timeout Time until the next call is required, set to
+ *                         @ref ANJ_TIME_DURATION_ZERO if
+ *                         @ref ANJ_CORE_STEP_YIELDED is returned and to
+ *                         @ref ANJ_TIME_DURATION_INVALID if there is no time
+ *                         limit.
+ * @param[out] out_handle  Set only if @ref ANJ_CORE_STEP_WAITS_FOR_NET is
+ *                         returned, handle of the server connection to wait
+ *                         on.
+ *
+ * @return What the client waits for.
+ */
+anj_core_step_result_t
+anj_core_step_budgeted(anj_t *anj,
+                       const anj_core_step_budget_t *budget,
+                       anj_time_duration_t *out_timeout,
+                       anj_net_poll_handle_t *out_handle);
+#        endif // ANJ_WITH_BUDGETED_STEP
+#    endif // ANJ_NET_WITH_POLL_HANDLE
+
 /**
  * Should be called when the Disable Resource of the Server Object (/1/x/4)
  * is executed.
@@ -397,6 +966,12 @@ void anj_core_server_obj_bootstrap_request_trigger_executed(anj_t *anj);
  *          Server operations (e.g., after a Write or Create request). Such
  *          cases are handled internally by the library.
  *
+ * @note If @ref ANJ_WITH_SERVER_DATA_CACHE is enabled, the Server and Security
+ *       Object parameters are not read again until this function reports a
+ *       change of one of these Objects, so every such change made by the
+ *       application has to be reported, including the ones that wouldn't
+ *       trigger anything else.
+ *
  * @param anj         Anjay object.
  * @param path        Pointer to the path of the changed Resource or affected
  *                    Instance.
@@ -406,6 +981,88 @@ void anj_core_data_model_changed(anj_t *anj,
                                  const anj_uri_path_t *path,
                                  anj_core_change_type_t change_type);
 
+/**
+ * Informs the library that the application has modified multiple elements of
+ * the data model in the same way.
+ *
+ * Equivalent to calling @ref anj_core_data_model_changed for each of
+ * @p paths, in order. Useful for applications that sample many Resources at
+ * once.
+ *
+ * @param anj         Anjay object.
+ * @param paths       Array of paths of the changed Resources or affected
+ *                    Instances.
+ * @param paths_count Number of elements in @p paths.
+ * @param change_type Type of change, applied to all @p paths; see
+ *                    @ref anj_core_change_type_t.
+ */
+void anj_core_data_model_changed_batch(anj_t *anj,
+                                       const anj_uri_path_t *paths,
+                                       size_t paths_count,
+                                       anj_core_change_type_t change_type);
+
+#    ifdef ANJ_DM_WITH_CHANGE_QUEUE
+/**
+ * Informs the library that the data model has been modified, like
+ * @ref anj_core_data_model_changed, but may be called from any thread or
+ * interrupt handler, concurrently with @ref anj_core_step and with other calls
+ * to this function.
+ *
+ * The change is put in a lock-free queue and handled at the beginning of the
+ * next @ref anj_core_step call, in the order of calls. This function never
+ * blocks. Until the queue is drained, @ref anj_core_next_step_time returns 0;
+ * if the thread calling @ref anj_core_step sleeps, waking it up is up to the
+ * application.
+ *
+ * @note Only signalling is thread-safe. Reading the value of the changed
+ *       Resource in the data model handlers, and adding or removing Instances,
+ *       still has to be synchronized by the application.
+ *
+ * @param anj         Anjay object.
+ * @param path        Pointer to the path of the changed Resource or affected
+ *                    Instance. It is copied, so it does not have to remain
+ *                    valid after the call.
+ * @param change_type Type of change; see @ref anj_core_change_type_t.
+ *
+ * @return 0 on success, -1 if @ref ANJ_DM_CHANGE_QUEUE_SIZE changes are
+ *         already waiting in the queue.
+ */
+int anj_core_data_model_changed_async(anj_t *anj,
+                                      const anj_uri_path_t *path,
+                                      anj_core_change_type_t change_type);
+#    endif // ANJ_DM_WITH_CHANGE_QUEUE
+
+#    ifdef ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER
+/**
+ * Sets the buffer in which notifications are recorded while the LwM2M Server
+ * is offline, i.e. while the client is in @ref ANJ_CONN_STATUS_QUEUE_MODE.
+ *
+ * If the Notification Storing When Disabled or Offline Resource (/1/x/6) is
+ * set to true, then instead of leaving queue mode to send a notification of a
+ * single Resource, its current value is recorded in @p buffer together with a
+ * timestamp. When the client leaves queue mode, all recorded values are sent
+ * at once in a single LwM2M Send message encoded as SenML CBOR. If the buffer
+ * is full, the oldest value is overwritten.
+ *
+ * Only values of numeric, boolean, time and objlnk data types are recorded;
+ * other notifications are sent as usual. Composite observations are not
+ * recorded either.
+ *
+ * @note Recorded values are sent using LwM2M Send, so they are not delivered
+ *       if the Mute Send Resource is set to true - in that case they are kept
+ *       in the buffer.
+ *
+ * @param anj         Anjay object.
+ * @param buffer      Array that will be used as a ring buffer. It must remain
+ *                    valid until this function is called again or Anjay is
+ *                    shut down. May be NULL to disable recording.
+ * @param buffer_size Number of elements in @p buffer.
+ */
+void anj_core_set_notify_store_buffer(anj_t *anj,
+                                      anj_io_out_entry_t *buffer,
+                                      size_t buffer_size);
+#    endif // ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER
+
 /**
  * Checks if there is an ongoing operation on Data Model.
  * If this function returns true, user must not modify Data Model, i.e.:
@@ -482,6 +1139,35 @@ void anj_core_request_bootstrap(anj_t *anj);
  */
 void anj_core_restart(anj_t *anj);
 
+#    ifdef ANJ_WITH_WARM_RESTART
+/**
+ * Restarts the Anjay Lite client, keeping the registration and the connection
+ * to the LwM2M Server if possible.
+ *
+ * Unlike @ref anj_core_restart, no De-Register and Register messages are sent
+ * and the connection, including the DTLS session, is not closed. Instead, the
+ * Security and Server Objects are read again in the next @ref anj_core_step
+ * call, observations of paths that are no longer present in the data model
+ * are removed and, if the lifetime or the list of Objects and Object Instances
+ * has changed, a Registration Update is sent. Ongoing exchanges are not
+ * interrupted.
+ *
+ * If the LwM2M Server or the way of connecting to it has changed, i.e. the
+ * Short Server ID, the Security Object Instance, or the host, port or scheme of
+ * the Server URI, the restart falls back to @ref anj_core_restart.
+ *
+ * @note Credentials are not compared; if they have changed, use
+ *       @ref anj_core_restart instead, otherwise the current DTLS session
+ *       continues to be used until it is lost.
+ *
+ * @note If the client is not registered, this function behaves like
+ *       @ref anj_core_restart.
+ *
+ * @param anj Anjay object.
+ */
+void anj_core_restart_warm(anj_t *anj);
+#    endif // ANJ_WITH_WARM_RESTART
+
 /**
  * Forces to start a Registration Update sequence.
  *
@@ -546,6 +1232,166 @@ void anj_core_request_update(anj_t *anj);
  */
 int anj_core_shutdown(anj_t *anj);
 
+#    ifdef ANJ_WITH_SESSION_PERSISTENCE
+/**
+ * Serializes the state of the current registration session into the
+ * persistence stream, so that it can be resumed with
+ * @ref anj_core_session_restore after a restart of the device.
+ *
+ * The following data is stored:
+ * - registration location path and time of the next Registration Update,
+ * - observations (with their tokens, Observe numbers, attributes and last sent
+ *   values) and attributes set with Write-Attributes,
+ * - Send request ID counter.
+ *
+ * Queued Send requests are not stored. Points in time are stored relative to
+ * @ref anj_time_real_now, so the real time clock has to keep running while the
+ * device is asleep.
+ *
+ * If @ref ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE is enabled and the client is
+ * connected over DTLS, the state of the DTLS connection is stored as well, see
+ * @ref anj_net_session_store_t. The connection may be unusable afterwards, so
+ * in that case this should be the last call before @ref anj_core_shutdown.
+ *
+ * The function should be called when there is no ongoing exchange, e.g. after
+ * the client has entered queue mode.
+ *
+ * @param anj Anjay object to operate on.
+ * @param ctx Persistence context; must have
+ *            @ref anj_persistence_context_t::direction set to
+ *            ANJ_PERSISTENCE_STORE.
+ *
+ * @return 0 on success, negative value if the client is not registered, there
+ *         is an ongoing exchange or a write error occurred.
+ */
+int anj_core_session_store(anj_t *anj, const anj_persistence_context_t *ctx);
+
+/**
+ * Deserializes the registration session state stored with
+ * @ref anj_core_session_store.
+ *
+ * Must be called after @ref anj_core_init and after the Security and Server
+ * Objects are installed, but before the first call to @ref anj_core_step. If
+ * the restore succeeds, the client connects to the LwM2M Server and proceeds
+ * directly to @ref ANJ_CONN_STATUS_REGISTERED without sending a Register
+ * message. Registration Update is sent at the stored time, or right away if
+ * that time has already passed or the lifetime has changed. If connecting to
+ * the server fails, or the client has to bootstrap, the restored session is
+ * dropped and a regular registration is performed.
+ *
+ * If the DTLS connection state was stored, the socket context is created and
+ * the state is handed over to it (see @ref anj_net_session_restore_t), so the
+ * first message can be sent without a DTLS handshake.
+ *
+ * @param anj Anjay object to operate on.
+ * @param ctx Persistence context; must have
+ *            @ref anj_persistence_context_t::direction set to
+ *            ANJ_PERSISTENCE_RESTORE.
+ *
+ * @return 0 on success, negative value if the stored data is invalid, doesn't
+ *         match the endpoint name or the Server Object instance, or a read
+ *         error occurred. In case of an error the client starts with a regular
+ *         registration.
+ */
+int anj_core_session_restore(anj_t *anj, const anj_persistence_context_t *ctx);
+#    endif // ANJ_WITH_SESSION_PERSISTENCE
+
+#    if defined(ANJ_WITH_NAT_KEEPALIVE_PROBING) \
+            && defined(ANJ_WITH_PERSISTENCE)
+/**
+ * Serializes the NAT binding timeout learned so far, see
+ * @ref ANJ_WITH_NAT_KEEPALIVE_PROBING, so that the search doesn't have to
+ * start from scratch after a restart of the device. The values are a property
+ * of the network, so they should be stored only if the device reconnects
+ * through the same one.
+ *
+ * @param anj Anjay object to operate on.
+ * @param ctx Persistence context; must have
+ *            @ref anj_persistence_context_t::direction set to
+ *            ANJ_PERSISTENCE_STORE.
+ *
+ * @return 0 on success, negative value if a write error occurred.
+ */
+int anj_core_nat_keepalive_store(anj_t *anj,
+                                 const anj_persistence_context_t *ctx);
+
+/**
+ * Deserializes the values stored with @ref anj_core_nat_keepalive_store. They
+ * are limited to @ref anj_configuration_t::nat_keepalive_min and
+ * @ref anj_configuration_t::nat_keepalive_max passed to @ref anj_core_init.
+ * Should be called before the client registers.
+ *
+ * @param anj Anjay object to operate on.
+ * @param ctx Persistence context; must have
+ *            @ref anj_persistence_context_t::direction set to
+ *            ANJ_PERSISTENCE_RESTORE.
+ *
+ * @return 0 on success, negative value if the stored data is invalid or a read
+ *         error occurred. In case of an error the search starts from scratch.
+ */
+int anj_core_nat_keepalive_restore(anj_t *anj,
+                                   const anj_persistence_context_t *ctx);
+#    endif // defined(ANJ_WITH_NAT_KEEPALIVE_PROBING) &&
+           // defined(ANJ_WITH_PERSISTENCE)
+
+#    ifdef ANJ_WITH_RESOURCE_USAGE
+/**
+ * Highest usage of statically sized resources, recorded since
+ * @ref anj_core_init or the last call to @ref anj_core_resource_usage_reset.
+ * Compare them with the configured sizes to see how much headroom is left.
+ */
+typedef struct {
+    /** Longest message received, out of @ref ANJ_IN_MSG_BUFFER_SIZE bytes. */
+    size_t in_buffer_max;
+    /**
+     * Longest message encoded, out of @ref ANJ_OUT_MSG_BUFFER_SIZE bytes. If
+     * the payload is sent separately, only the header is counted.
+     */
+    size_t out_buffer_max;
+    /**
+     * Longest payload of an outgoing message, out of
+     * @ref ANJ_OUT_PAYLOAD_BUFFER_SIZE bytes.
+     */
+    size_t payload_buffer_max;
+#        ifdef ANJ_WITH_OBSERVE
+    /**
+     * Highest number of observations at a time, out of
+     * @ref ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER.
+     */
+    size_t observations_max;
+#        endif // ANJ_WITH_OBSERVE
+#        ifdef ANJ_WITH_LWM2M_SEND
+    /**
+     * Highest number of queued Send requests, out of
+     * @ref ANJ_LWM2M_SEND_QUEUE_SIZE.
+     */
+    size_t send_queue_max;
+#        endif // ANJ_WITH_LWM2M_SEND
+#        ifdef ANJ_WITH_CACHE
+    /**
+     * Highest number of responses held in the exchange cache at a time, out of
+     * @ref ANJ_CACHE_ENTRIES_NUMBER.
+     */
+    size_t exchange_cache_max;
+#        endif // ANJ_WITH_CACHE
+} anj_resource_usage_t;
+
+/**
+ * Copies the highest usage of resources recorded so far.
+ *
+ * @param      anj       Anjay object to operate on.
+ * @param[out] out_usage Structure to fill.
+ */
+void anj_core_get_resource_usage(anj_t *anj, anj_resource_usage_t *out_usage);
+
+/**
+ * Sets all the recorded values of @ref anj_resource_usage_t to zero.
+ *
+ * @param anj Anjay object to operate on.
+ */
+void anj_core_resource_usage_reset(anj_t *anj);
+#    endif // ANJ_WITH_RESOURCE_USAGE
+
 /** @cond */
 #    define ANJ_INTERNAL_INCLUDE_CORE
 #    include <anj_internal/core.h> // IWYU pragma: export
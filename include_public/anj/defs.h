@@ -97,6 +97,7 @@ extern "C" {
 #    define ANJ_OBJ_ID_DEVICE 3U
 #    define ANJ_OBJ_ID_FIRMWARE_UPDATE 5U
 #    define ANJ_OBJ_ID_OSCORE 21U
+#    define ANJ_OBJ_ID_LWM2M_GATEWAY 25U
 
 /** The values below do not include the terminating null character */
 #    define ANJ_I64_STR_MAX_LEN (sizeof("-9223372036854775808") - 1)
@@ -132,6 +133,10 @@ typedef struct anj_struct anj_t;
 typedef struct _anj_coap_downloader_struct anj_coap_downloader_t;
 #    endif // ANJ_WITH_COAP_DOWNLOADER
 
+#    ifdef ANJ_WITH_HTTP_DOWNLOADER
+typedef struct _anj_http_downloader_struct anj_http_downloader_t;
+#    endif // ANJ_WITH_HTTP_DOWNLOADER
+
 #    ifdef ANJ_WITH_NTP
 typedef struct _anj_ntp_struct anj_ntp_t;
 #    endif // ANJ_WITH_NTP
@@ -168,13 +173,39 @@ typedef struct _anj_ntp_struct anj_ntp_t;
 #    define ANJ_EXCHANGE_SERVER_REQUEST_TIMEOUT \
         anj_time_duration_new(50, ANJ_TIME_UNIT_S)
 
+#    ifdef ANJ_TIME_INTEGER_ONLY
+/** Fixed-point value of @ref anj_exchange_udp_tx_params_t::ack_random_factor
+ * that equals 1. */
+#        define ANJ_ACK_RANDOM_FACTOR_ONE 1000
+
+/**
+ * Type of @ref anj_exchange_udp_tx_params_t::ack_random_factor, a fixed-point
+ * number in units of 1/@ref ANJ_ACK_RANDOM_FACTOR_ONE.
+ */
+typedef uint32_t anj_ack_random_factor_t;
+
+/**
+ * Converts a constant @p Value (e.g. @c 1.5) to
+ * @ref anj_ack_random_factor_t, at compile time if @p Value is a literal.
+ */
+#        define ANJ_ACK_RANDOM_FACTOR(Value)                                \
+            ((anj_ack_random_factor_t) ((Value) * ANJ_ACK_RANDOM_FACTOR_ONE \
+                                        + 0.5))
+#    else  // ANJ_TIME_INTEGER_ONLY
+/** Type of @ref anj_exchange_udp_tx_params_t::ack_random_factor. */
+typedef double anj_ack_random_factor_t;
+
+/** Converts @p Value to @ref anj_ack_random_factor_t. */
+#        define ANJ_ACK_RANDOM_FACTOR(Value) ((anj_ack_random_factor_t) (Value))
+#    endif // ANJ_TIME_INTEGER_ONLY
+
 /**
  * Default CoAP transmission parameters as specified in RFC 7252.
  */
 #    define ANJ_EXCHANGE_UDP_TX_PARAMS_DEFAULT                        \
         (anj_exchange_udp_tx_params_t) {                              \
             .ack_timeout = anj_time_duration_new(2, ANJ_TIME_UNIT_S), \
-            .ack_random_factor = 1.5,                                 \
+            .ack_random_factor = ANJ_ACK_RANDOM_FACTOR(1.5),          \
             .max_retransmit = 4                                       \
         }
 
@@ -213,8 +244,12 @@ typedef struct {
     /** Initial ACK_TIMEOUT value. */
     anj_time_duration_t ack_timeout;
 
-    /** ACK_RANDOM_FACTOR multiplier applied to randomize the timeout. */
-    double ack_random_factor;
+    /**
+     * ACK_RANDOM_FACTOR multiplier applied to randomize the timeout. Use
+     * @ref ANJ_ACK_RANDOM_FACTOR to set it, so that the code works regardless
+     * of @ref ANJ_TIME_INTEGER_ONLY.
+     */
+    anj_ack_random_factor_t ack_random_factor;
 
     /** Maximum number of retransmissions before giving up. */
     uint16_t max_retransmit;
@@ -478,6 +513,11 @@ typedef struct {
      * Pointer to the data buffer.
      *
      * - In output contexts, this points to the data to be sent to the server.
+     *   The data is not copied before encoding: encoders copy it from this
+     *   pointer directly into the message payload, possibly in multiple
+     *   chunks, so it must remain valid and unchanged until the whole value is
+     *   encoded. In case of a block-wise transfer, this lasts until the last
+     *   block is sent or the exchange is terminated.
      * - In input contexts, this points to the data received from the server.
      */
     const void *data;
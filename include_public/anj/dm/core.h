@@ -76,6 +76,19 @@ extern "C" {
 
 /**@}*/
 
+#    ifdef ANJ_WITH_SEPARATE_RESPONSE
+/**
+ * Value that may be returned from @ref anj_dm_res_read_t and
+ * @ref anj_dm_res_execute_t handlers if the result of a Read or Execute
+ * operation is not available yet.
+ *
+ * The request is then acknowledged with an Empty ACK, and the response is sent
+ * in a separate Confirmable message after @ref anj_dm_complete_pending is
+ * called.
+ */
+#        define ANJ_DM_PENDING 1
+#    endif // ANJ_WITH_SEPARATE_RESPONSE
+
 /**
  * Adds an Object to the data model and validates its structure.
  *
@@ -120,6 +133,223 @@ int anj_dm_res_read(anj_t *anj,
                     const anj_uri_path_t *path,
                     anj_res_value_t *out_value);
 
+#    ifdef ANJ_WITH_SEPARATE_RESPONSE
+/**
+ * Completes a Read or Execute operation, for which a data model handler
+ * returned @ref ANJ_DM_PENDING.
+ *
+ * The response is sent during the next @ref anj_core_step call. In case of
+ * Read, @ref anj_dm_res_read_t handlers are called again for all Resources
+ * being read, so the value has to be available by then. If the operation is
+ * not completed within @ref ANJ_EXCHANGE_SERVER_REQUEST_TIMEOUT, it is
+ * cancelled.
+ *
+ * @param anj    Anjay object.
+ * @param result 0 if the operation succeeded, one of the
+ *               @ref anj_dm_errors "ANJ_DM_ERR_* constants" otherwise, which
+ *               determines the CoAP code of the response.
+ *
+ * @return 0 on success, a non-zero value if there is no pending operation.
+ */
+int anj_dm_complete_pending(anj_t *anj, int result);
+#    endif // ANJ_WITH_SEPARATE_RESPONSE
+
+#    ifdef ANJ_DM_WITH_PATH_HANDLES
+/**
+ * Path resolved into the data model entities it refers to. Contents of this
+ * structure are opaque and must not be accessed directly.
+ */
+typedef struct anj_dm_path_handle_struct anj_dm_path_handle_t;
+
+/**
+ * Resolves the path into a handle, that can be later used to access the
+ * entity without looking it up in the data model again.
+ *
+ * The handle stays valid across changes of the data model: if any Object or
+ * Instance was added or removed (see @ref anj_dm_add_obj, @ref
+ * anj_dm_remove_obj and @ref anj_core_data_model_changed) since the handle was
+ * resolved, the path is transparently resolved again on the next use.
+ *
+ * @param      anj        Anjay object.
+ * @param      path       Object, Object Instance, Resource or Resource
+ *                        Instance path.
+ * @param[out] out_handle Handle to initialize.
+ *
+ * @return 0 on success, a non-zero value in case of an error, e.g. if the
+ *         path does not exist in the data model.
+ */
+int anj_dm_path_handle_resolve(anj_t *anj,
+                               const anj_uri_path_t *path,
+                               anj_dm_path_handle_t *out_handle);
+
+/**
+ * Reads the value of the Resource or Resource Instance, equivalent to @ref
+ * anj_dm_res_read called with the path the @p handle was resolved from.
+ *
+ * @param      anj       Anjay object.
+ * @param      handle    Handle initialized with @ref
+ *                       anj_dm_path_handle_resolve.
+ * @param[out] out_value Resource value.
+ *
+ * @return 0 on success, a non-zero value in case of an error.
+ */
+int anj_dm_res_read_by_handle(anj_t *anj,
+                              anj_dm_path_handle_t *handle,
+                              anj_res_value_t *out_value);
+#    endif // ANJ_DM_WITH_PATH_HANDLES
+
+#    ifdef ANJ_DM_WITH_INST_ARRAY
+/**
+ * Returns the lowest IID not used in the @p insts array of an Object, e.g. to
+ * let the application create an Instance on its own.
+ *
+ * Like everywhere in the data model, @p insts must be sorted by IID, with
+ * unused slots at the end having IID set to @ref ANJ_ID_INVALID. The lookup
+ * takes O(log n) time.
+ *
+ * @param insts          Array of Object Instances.
+ * @param max_inst_count Number of elements in @p insts.
+ *
+ * @return Free IID, or @ref ANJ_ID_INVALID if all slots are used.
+ */
+anj_iid_t anj_dm_inst_array_find_free_iid(const anj_dm_obj_inst_t *insts,
+                                          uint16_t max_inst_count);
+
+/**
+ * Inserts a copy of @p inst in the @p insts array of an Object, keeping the
+ * array sorted by IID. Intended to be called from the
+ * @ref anj_dm_inst_create_t handler of Objects with many Instances.
+ *
+ * Instances with higher IIDs are moved by one slot, so pointers to elements
+ * of @p insts are invalidated.
+ *
+ * @param insts          Sorted array of Object Instances, see
+ *                       @ref anj_dm_inst_array_find_free_iid.
+ * @param max_inst_count Number of elements in @p insts.
+ * @param inst           Instance to insert.
+ *
+ * @return 0 on success, @ref ANJ_DM_ERR_BAD_REQUEST if an Instance with the
+ *         same IID already exists, or @ref ANJ_DM_ERR_METHOD_NOT_ALLOWED if all
+ *         slots are used.
+ */
+int anj_dm_inst_array_insert(anj_dm_obj_inst_t *insts,
+                             uint16_t max_inst_count,
+                             const anj_dm_obj_inst_t *inst);
+
+/**
+ * Removes the Instance with the given IID from the @p insts array of an
+ * Object, keeping the array sorted by IID. Intended to be called from the
+ * @ref anj_dm_inst_delete_t handler.
+ *
+ * Instances with higher IIDs are moved by one slot, so pointers to elements
+ * of @p insts are invalidated.
+ *
+ * @param insts          Sorted array of Object Instances, see
+ *                       @ref anj_dm_inst_array_find_free_iid.
+ * @param max_inst_count Number of elements in @p insts.
+ * @param iid            IID of the Instance to remove.
+ *
+ * @return 0 on success, @ref ANJ_DM_ERR_NOT_FOUND if there is no Instance
+ *         with such IID.
+ */
+int anj_dm_inst_array_remove(anj_dm_obj_inst_t *insts,
+                             uint16_t max_inst_count,
+                             anj_iid_t iid);
+#    endif // ANJ_DM_WITH_INST_ARRAY
+
+#    ifdef ANJ_DM_WITH_SHARED_OBJ_DEFS
+/**
+ * Object of a single @ref anj_t instance, whose definition is shared with the
+ * same Object of other instances, e.g. when a host simulates many devices.
+ *
+ * Only the Object itself and the IIDs of its Instances are kept per
+ * @ref anj_t instance. The handlers, the Resource definitions and the rest of
+ * the Instance definition are kept once, preferably in read-only memory, and
+ * referenced by all of them. Instances are materialized on demand, see
+ * @ref anj_dm_inst_lookup_t, so the Object takes <c>sizeof(anj_iid_t)</c>
+ * bytes per Instance instead of <c>sizeof(anj_dm_obj_inst_t)</c>.
+ *
+ * Handlers receive @ref obj, and may use @ref ANJ_CONTAINER_OF on it to get to
+ * this structure, or to a structure of the application it is embedded in, to
+ * find the per-instance state of the Object.
+ */
+typedef struct {
+    /**
+     * Object passed to @ref anj_dm_add_obj. Its @ref anj_dm_obj_t::insts must
+     * be @c NULL, and the handlers, usually shared as well, must set
+     * @ref anj_dm_handlers_t::inst_lookup, @ref anj_dm_handlers_t::inst_first
+     * and @ref anj_dm_handlers_t::inst_next to
+     * @ref anj_dm_shared_obj_inst_lookup, @ref anj_dm_shared_obj_inst_first
+     * and @ref anj_dm_shared_obj_inst_next.
+     */
+    anj_dm_obj_t obj;
+
+    /**
+     * Definition of every Instance of the Object, its
+     * @ref anj_dm_obj_inst_t::iid is ignored. Resource Instances of
+     * multi-instance Resources are therefore the same in all Instances.
+     */
+    const anj_dm_obj_inst_t *inst_def;
+
+    /**
+     * Array of IIDs of the Instances, with @ref anj_dm_obj_t::max_inst_count
+     * elements, sorted in ascending order, with unused slots at the end set to
+     * @ref ANJ_ID_INVALID. May be modified with @ref anj_dm_shared_obj_inst_add
+     * and @ref anj_dm_shared_obj_inst_remove.
+     */
+    anj_iid_t *iids;
+
+    /** Buffer the Instances are materialized in, private. */
+    anj_dm_obj_inst_t inst;
+} anj_dm_shared_obj_t;
+
+/**
+ * Implementation of @ref anj_dm_inst_lookup_t for Objects embedded in
+ * @ref anj_dm_shared_obj_t.
+ */
+const anj_dm_obj_inst_t *anj_dm_shared_obj_inst_lookup(const anj_dm_obj_t *obj,
+                                                       anj_iid_t iid);
+
+/**
+ * Implementation of @ref anj_dm_inst_first_t for Objects embedded in
+ * @ref anj_dm_shared_obj_t.
+ */
+const anj_dm_obj_inst_t *anj_dm_shared_obj_inst_first(const anj_dm_obj_t *obj);
+
+/**
+ * Implementation of @ref anj_dm_inst_next_t for Objects embedded in
+ * @ref anj_dm_shared_obj_t.
+ */
+const anj_dm_obj_inst_t *anj_dm_shared_obj_inst_next(const anj_dm_obj_t *obj,
+                                                     anj_iid_t iid);
+
+/**
+ * Adds @p iid to @ref anj_dm_shared_obj_t::iids, keeping the array sorted.
+ * Intended to be called from the @ref anj_dm_inst_create_t handler.
+ *
+ * @param shared_obj Object to add the Instance to.
+ * @param iid        IID of the new Instance.
+ *
+ * @return 0 on success, @ref ANJ_DM_ERR_BAD_REQUEST if an Instance with the
+ *         same IID already exists, or @ref ANJ_DM_ERR_METHOD_NOT_ALLOWED if all
+ *         slots are used.
+ */
+int anj_dm_shared_obj_inst_add(anj_dm_shared_obj_t *shared_obj, anj_iid_t iid);
+
+/**
+ * Removes @p iid from @ref anj_dm_shared_obj_t::iids, keeping the array
+ * sorted. Intended to be called from the @ref anj_dm_inst_delete_t handler.
+ *
+ * @param shared_obj Object to remove the Instance from.
+ * @param iid        IID of the Instance to remove.
+ *
+ * @return 0 on success, @ref ANJ_DM_ERR_NOT_FOUND if there is no Instance
+ *         with such IID.
+ */
+int anj_dm_shared_obj_inst_remove(anj_dm_shared_obj_t *shared_obj,
+                                  anj_iid_t iid);
+#    endif // ANJ_DM_WITH_SHARED_OBJ_DEFS
+
 /**
  * Handles writing of a opaque data in the @ref anj_dm_res_write_t handler.
  *
@@ -116,10 +116,55 @@ typedef struct anj_dm_res_struct {
     /**
      * Maximum number of instances allowed for this Resource.
      * Ignored for Single-Instance Resources.
+     *
+     * If @ref insts_bitmap is used, it is the number of bits in the bitmap, so
+     * only Resource Instance IDs lower than this value are allowed.
      */
     uint16_t max_inst_count;
+
+#    ifdef ANJ_DM_WITH_RES_INST_BITMAP
+    /**
+     * Optional bitmap of Resource Instance IDs, used instead of @ref insts
+     * (and @ref anj_dm_obj_inst_t::res_insts, if enabled). Bit
+     * <c>riid % 32</c> of the element at index <c>riid / 32</c> is set if the
+     * Resource Instance with that ID exists.
+     *
+     * The array must have as many elements as @ref ANJ_DM_RES_INST_BITMAP_SIZE
+     * yields for @ref max_inst_count, and bits related to IDs not lower than @ref max_inst_count
+     * must be cleared. It takes one bit per allowed ID instead of
+     * <c>sizeof(anj_riid_t)</c> bytes per allowed instance, and the Resource
+     * Instances are counted and found without scanning the IDs one by one,
+     * which suits Resources with many, possibly sparse, Resource Instances.
+     * Handlers such as @ref anj_dm_res_inst_create_t are responsible for
+     * updating the bitmap, like they would for @ref insts.
+     *
+     * If set to @c NULL, @ref insts is used.
+     */
+    const uint32_t *insts_bitmap;
+#    endif // ANJ_DM_WITH_RES_INST_BITMAP
+
+#    ifdef ANJ_DM_WITH_READ_CACHE
+    /**
+     * Time in milliseconds for which a value returned by
+     * @ref anj_dm_res_read_t for this Resource (or any of its Instances) is
+     * cached and returned by the library without calling the handler again.
+     * Only numeric, boolean, Time and Objlnk values are cached.
+     *
+     * If set to 0, the Resource is always read with the handler.
+     */
+    uint32_t read_cache_max_age_ms;
+#    endif // ANJ_DM_WITH_READ_CACHE
 } anj_dm_res_t;
 
+#    ifdef ANJ_DM_WITH_RES_INST_BITMAP
+/**
+ * Number of elements of @ref anj_dm_res_t::insts_bitmap needed for a Resource
+ * with @p Max_Inst_Count allowed Resource Instance IDs.
+ */
+#        define ANJ_DM_RES_INST_BITMAP_SIZE(Max_Inst_Count) \
+            (((Max_Inst_Count) + 31) / 32)
+#    endif // ANJ_DM_WITH_RES_INST_BITMAP
+
 /** Struct defining an Object Instance. */
 typedef struct anj_dm_obj_inst_struct {
     /**
@@ -149,6 +194,41 @@ typedef struct anj_dm_obj_inst_struct {
      * Number of Resources defined for this Object Instance.
      */
     uint16_t res_count;
+
+#    ifdef ANJ_DM_WITH_RID_INDEX
+    /**
+     * Optional table mapping Resource IDs to indexes in @ref resources, used
+     * instead of searching that array. The element at index
+     * <c>rid - rid_index_first</c> holds the index of the Resource with that
+     * ID increased by one, or 0 if there is no such Resource. Resources with
+     * IDs outside of the range covered by the table are not defined either.
+     *
+     * If set to @c NULL, Resources are searched as usual. Generated with the
+     * <c>--dispatch-tables</c> option of <c>tools/anjay_codegen.py</c>. If
+     * set, @ref res_count must not be greater than @c UINT8_MAX.
+     */
+    const uint8_t *rid_index;
+
+    /** Resource ID related to the first element of @ref rid_index. */
+    anj_rid_t rid_index_first;
+
+    /** Number of elements in @ref rid_index. */
+    uint16_t rid_index_size;
+#    endif // ANJ_DM_WITH_RID_INDEX
+
+#    ifdef ANJ_DM_WITH_SHARED_RES_DEFS
+    /**
+     * Optional array of Resource Instance ID arrays, indexed like
+     * @ref resources. If set, the element related to a multi-instance
+     * Resource is used instead of its @ref anj_dm_res_t::insts, so a single
+     * constant @ref resources array can be shared by all Object Instances,
+     * while each of them keeps its own Resource Instances. Elements related to
+     * single-instance Resources are ignored.
+     *
+     * If set to @c NULL, @ref anj_dm_res_t::insts is used.
+     */
+    const anj_riid_t *const *res_insts;
+#    endif // ANJ_DM_WITH_SHARED_RES_DEFS
 } anj_dm_obj_inst_t;
 
 typedef struct anj_dm_handlers_struct anj_dm_handlers_t;
@@ -191,7 +271,9 @@ typedef struct anj_dm_obj_struct {
      * defined, the user is responsible for updating the contents of the @p
      * insts array accordingly.
      *
-     * If @ref max_inst_count is not equal to 0, this field must not be NULL.
+     * If @ref max_inst_count is not equal to 0, this field must not be NULL,
+     * unless Instances are enumerated by the handlers, see
+     * @ref anj_dm_inst_lookup_t.
      */
     const anj_dm_obj_inst_t *insts;
 
@@ -214,6 +296,10 @@ typedef struct anj_dm_obj_struct {
  * For values of type @ref ANJ_DATA_TYPE_STRING, do not modify any additional
  * fields in @p out_value — only the data pointer should be provided.
  *
+ * For both of these types the data is not copied by this library, it is read
+ * directly from the provided pointer while the message payload is created, see
+ * @ref anj_bytes_or_string_value_t::data for the required lifetime.
+ *
  * For values of type @ref ANJ_DATA_TYPE_EXTERNAL_BYTES and @ref
  * ANJ_DATA_TYPE_EXTERNAL_STRING, you must set @ref
  * anj_res_value_t::get_external_data callback.
@@ -238,6 +324,10 @@ typedef struct anj_dm_obj_struct {
  *   @ref anj_dm_errors "ANJ_DM_ERR_* constants", an appropriate CoAP error code
  *   will be used in the response. Otherwise, the device will respond with @ref
  *   ANJ_COAP_CODE_INTERNAL_SERVER_ERROR.
+ * - @ref ANJ_DM_PENDING if @ref ANJ_WITH_SEPARATE_RESPONSE is enabled and the
+ *   value is not available yet. This is supported only while handling a Read
+ *   request, the handler is called again after @ref anj_dm_complete_pending.
+ *   In other contexts it is treated as an error.
  */
 typedef int anj_dm_res_read_t(anj_t *anj,
                               const anj_dm_obj_t *obj,
@@ -246,6 +336,46 @@ typedef int anj_dm_res_read_t(anj_t *anj,
                               anj_riid_t riid,
                               anj_res_value_t *out_value);
 
+#    ifdef ANJ_DM_WITH_RES_READ_BATCH
+/**
+ * A handler that prepares values of multiple Resources of an Object Instance
+ * to be read, e.g. fetches all of them from a peripheral in a single
+ * transaction.
+ *
+ * This handler is called once per Object Instance during Read and
+ * Read-Composite operations, notifications and other messages built from the
+ * data model, before the first @ref anj_dm_res_read_t call for Resources of
+ * that Instance. The values are then read with @ref anj_dm_res_read_t calls as
+ * usual, so this handler is expected to store them somewhere where the
+ * @ref anj_dm_res_read_t handler can access them.
+ *
+ * @note @ref anj_dm_res_read_t may still be called without a preceding call to
+ *       this handler, e.g. by @ref anj_dm_res_read or while checking the
+ *       attributes of Observations, so it must be able to provide the value
+ *       on its own.
+ *
+ * @param anj        Anjay object.
+ * @param obj        Object definition pointer.
+ * @param iid        Object Instance ID.
+ * @param rids       Array of IDs of the Resources that will be read, or
+ *                   @c NULL if all readable Resources of the Instance will be
+ *                   read.
+ * @param rids_count Number of elements in the @p rids array.
+ *
+ * @return This handler should return:
+ * - 0 on success,
+ * - a negative value on error. If the error matches one of the
+ *   @ref anj_dm_errors "ANJ_DM_ERR_* constants", an appropriate CoAP error code
+ *   will be used in the response. Otherwise, the device will respond with @ref
+ *   ANJ_COAP_CODE_INTERNAL_SERVER_ERROR.
+ */
+typedef int anj_dm_res_read_batch_t(anj_t *anj,
+                                    const anj_dm_obj_t *obj,
+                                    anj_iid_t iid,
+                                    const anj_rid_t *rids,
+                                    size_t rids_count);
+#    endif // ANJ_DM_WITH_RES_READ_BATCH
+
 /**
  * A handler that writes the value of a Resource or Resource Instance.
  *
@@ -312,6 +442,9 @@ typedef int anj_dm_res_write_t(anj_t *anj,
  *   @ref anj_dm_errors "ANJ_DM_ERR_* constants", an appropriate CoAP error code
  *   will be used in the response. Otherwise, the device will respond with @ref
  *   ANJ_COAP_CODE_INTERNAL_SERVER_ERROR.
+ * - @ref ANJ_DM_PENDING if @ref ANJ_WITH_SEPARATE_RESPONSE is enabled and the
+ *   Execute operation is still in progress. The response is sent after
+ *   @ref anj_dm_complete_pending is called.
  */
 typedef int anj_dm_res_execute_t(anj_t *anj,
                                  const anj_dm_obj_t *obj,
@@ -465,6 +598,60 @@ anj_dm_inst_delete_t(anj_t *anj, const anj_dm_obj_t *obj, anj_iid_t iid);
 typedef int
 anj_dm_inst_reset_t(anj_t *anj, const anj_dm_obj_t *obj, anj_iid_t iid);
 
+#    ifdef ANJ_DM_WITH_LAZY_INSTS
+/**
+ * A handler that looks up an Object Instance, used instead of the
+ * @ref anj_dm_obj_t::insts array together with @ref anj_dm_inst_first_t and
+ * @ref anj_dm_inst_next_t.
+ *
+ * If all three handlers are defined, @ref anj_dm_obj_t::insts must be @c NULL
+ * and the library never accesses Instances other than through these handlers,
+ * so Instance definitions may be materialized on demand, e.g. from an event log
+ * kept in external storage. @ref anj_dm_obj_t::max_inst_count still limits the
+ * number of Instances that can be created by the LwM2M Server. Not supported
+ * for the Security, Server and OSCORE Objects.
+ *
+ * The returned definition must stay valid and unchanged until the next call to
+ * any of these handlers for the same Object, so a single buffer can be reused
+ * for all Instances. Resource definitions and Resource Instance IDs it refers
+ * to must stay valid for the same time.
+ *
+ * Unlike other handlers, these don't take the Anjay object, since Instances
+ * are also looked up when no operation is in progress. @ref ANJ_CONTAINER_OF
+ * may be used on @p obj to get to the state of the Object.
+ *
+ * @param obj Object definition pointer.
+ * @param iid Object Instance ID to look up.
+ *
+ * @return Definition of the Instance, or @c NULL if it doesn't exist.
+ */
+typedef const anj_dm_obj_inst_t *anj_dm_inst_lookup_t(const anj_dm_obj_t *obj,
+                                                      anj_iid_t iid);
+
+/**
+ * A handler that returns the Object Instance with the lowest ID, see
+ * @ref anj_dm_inst_lookup_t for details.
+ *
+ * @param obj Object definition pointer.
+ *
+ * @return Definition of the Instance, or @c NULL if there are no Instances.
+ */
+typedef const anj_dm_obj_inst_t *anj_dm_inst_first_t(const anj_dm_obj_t *obj);
+
+/**
+ * A handler that returns the Object Instance with the lowest ID greater than
+ * @p iid, see @ref anj_dm_inst_lookup_t for details. An Instance with ID
+ * @p iid doesn't have to exist, e.g. if it has just been deleted.
+ *
+ * @param obj Object definition pointer.
+ * @param iid Object Instance ID after which the search starts.
+ *
+ * @return Definition of the Instance, or @c NULL if there is no such Instance.
+ */
+typedef const anj_dm_obj_inst_t *anj_dm_inst_next_t(const anj_dm_obj_t *obj,
+                                                    anj_iid_t iid);
+#    endif // ANJ_DM_WITH_LAZY_INSTS
+
 /**
  * A handler called at the beginning of a transactional operation that may
  * modify the Object.
@@ -516,6 +703,42 @@ typedef int anj_dm_transaction_begin_t(anj_t *anj, const anj_dm_obj_t *obj);
  */
 typedef int anj_dm_transaction_validate_t(anj_t *anj, const anj_dm_obj_t *obj);
 
+#    ifdef ANJ_DM_WITH_WRITE_BLOCK_COMMIT
+/**
+ * A handler called after each non-final block of a block-wise transactional
+ * operation has been written.
+ *
+ * This function is invoked for every Object whose transaction has been started
+ * (see @ref anj_dm_transaction_begin_t) once all records contained in a Block1
+ * request of a Create, Write or Write-Composite operation have been passed to
+ * @ref anj_dm_res_write_t, and before the next block is requested from the
+ * LwM2M Server. It may be used to persist the data written so far, e.g. to
+ * store the next chunk of a large opaque Resource in flash, so that it does
+ * not have to be buffered until the end of the transaction.
+ *
+ * The next block is requested only after this function returns, so the pace
+ * of the transfer is determined by how fast the written data is committed.
+ * Data committed here is not final yet: if the operation fails later,
+ * @ref anj_dm_transaction_end_t is called with
+ * @ref ANJ_DM_TRANSACTION_FAILURE and the user is responsible for rolling
+ * back all the blocks committed so far. The last block is not followed by a
+ * call to this function, @ref anj_dm_transaction_validate_t and
+ * @ref anj_dm_transaction_end_t are called instead.
+ *
+ * @param anj Anjay object.
+ * @param obj Object definition pointer.
+ *
+ * @return This handler should return:
+ * - 0 on success,
+ * - a negative value on error, the operation is then aborted. If the error
+ *   matches one of the @ref anj_dm_errors "ANJ_DM_ERR_* constants", an
+ *   appropriate CoAP error code will be used in the response. Otherwise, the
+ *   device will respond with @ref ANJ_COAP_CODE_INTERNAL_SERVER_ERROR.
+ */
+typedef int anj_dm_transaction_block_commit_t(anj_t *anj,
+                                              const anj_dm_obj_t *obj);
+#    endif // ANJ_DM_WITH_WRITE_BLOCK_COMMIT
+
 /**
  * A handler called at the end of a transactional operation.
  *
@@ -572,6 +795,16 @@ struct anj_dm_handlers_struct {
      */
     anj_dm_transaction_validate_t *transaction_validate;
 
+#    ifdef ANJ_DM_WITH_WRITE_BLOCK_COMMIT
+    /**
+     * Called after each non-final block of a block-wise transactional
+     * operation that modifies this Object.
+     *
+     * Optional, allows committing the written data incrementally.
+     */
+    anj_dm_transaction_block_commit_t *transaction_block_commit;
+#    endif // ANJ_DM_WITH_WRITE_BLOCK_COMMIT
+
     /**
      * Called after any transactional operation is completed.
      *
@@ -586,6 +819,15 @@ struct anj_dm_handlers_struct {
      */
     anj_dm_res_read_t *res_read;
 
+#    ifdef ANJ_DM_WITH_RES_READ_BATCH
+    /**
+     * Prepares values of multiple Resources of an Object Instance to be read.
+     *
+     * Optional, called before @ref res_read calls for Resources of an Instance.
+     */
+    anj_dm_res_read_batch_t *res_read_batch;
+#    endif // ANJ_DM_WITH_RES_READ_BATCH
+
     /**
      * Writes a Resource value.
      *
@@ -616,6 +858,22 @@ struct anj_dm_handlers_struct {
      * - LwM2M Write Replace operations that remove all instances.
      */
     anj_dm_res_inst_delete_t *res_inst_delete;
+
+#    ifdef ANJ_DM_WITH_LAZY_INSTS
+    /**
+     * Looks up an Object Instance.
+     *
+     * Optional, if defined together with @ref inst_first and @ref inst_next,
+     * it's used instead of the @ref anj_dm_obj_t::insts array.
+     */
+    anj_dm_inst_lookup_t *inst_lookup;
+
+    /** Returns the first Object Instance, see @ref inst_lookup. */
+    anj_dm_inst_first_t *inst_first;
+
+    /** Returns the next Object Instance, see @ref inst_lookup. */
+    anj_dm_inst_next_t *inst_next;
+#    endif // ANJ_DM_WITH_LAZY_INSTS
 };
 
 #    ifdef __cplusplus
@@ -45,6 +45,27 @@ extern "C" {
  */
 typedef void anj_dm_reboot_callback_t(void *arg, anj_t *anj);
 
+#        ifdef ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
+/**
+ * Callback function type for handling a write to the Current Time Resource
+ * (/3/0/13). It is invoked after the Write operation completes successfully.
+ *
+ * @param arg         Opaque argument passed to the callback, as provided in
+ *                    @ref anj_dm_device_object_init_t::current_time_cb_arg.
+ * @param anj         Anjay object.
+ * @param server_time Value written by the LwM2M Server, i.e. its time when
+ *                    the request was sent, with a resolution of 1 second.
+ * @param round_trip  Smoothed round-trip time of the exchanges with the LwM2M
+ *                    Server, about half of which the request spent in transit.
+ *                    Measured only if @ref ANJ_WITH_ADAPTIVE_RTO is enabled,
+ *                    @ref ANJ_TIME_DURATION_ZERO otherwise.
+ */
+typedef void anj_dm_current_time_callback_t(void *arg,
+                                            anj_t *anj,
+                                            anj_time_real_t server_time,
+                                            anj_time_duration_t round_trip);
+#        endif // ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
+
 /**
  * Device Object initialization structure. Should be filled before passing to
  * @ref anj_dm_device_obj_install.
@@ -83,6 +104,19 @@ typedef struct {
      * Argument passed to @ref reboot_cb when it is invoked.
      */
     void *reboot_cb_arg;
+
+#        ifdef ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
+    /** Current Time Resource (/3/0/13) write callback.
+     *
+     * @note If not set, Write operation on this resource will fail.
+     */
+    anj_dm_current_time_callback_t *current_time_cb;
+
+    /**
+     * Argument passed to @ref current_time_cb when it is invoked.
+     */
+    void *current_time_cb_arg;
+#        endif // ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
 } anj_dm_device_object_init_t;
 
 /**
@@ -105,6 +139,11 @@ typedef struct {
     const char *firmware_version;
     const char *binding_modes;
     const char *software_version;
+#        ifdef ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
+    anj_dm_current_time_callback_t *current_time_cb;
+    void *current_time_cb_arg;
+    anj_time_real_t written_time;
+#        endif // ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
 } anj_dm_device_obj_t;
 
 /**
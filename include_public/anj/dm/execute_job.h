@@ -0,0 +1,161 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+/**
+ * @file
+ * @brief Tracking of background jobs started by Execute handlers.
+ *
+ * An @ref anj_dm_res_execute_t handler is called from @ref anj_core_step and
+ * its return value is sent in the response right away, so it must not block
+ * for the whole duration of a long action like a factory reset. Instead, the
+ * handler may start the action in the background with
+ * @ref anj_dm_execute_job_start and return. When the action is done, the
+ * application calls @ref anj_dm_execute_job_finish, which informs the library
+ * that the status Resource of the job has changed, so that the LwM2M Server
+ * observing it receives a notification.
+ *
+ * Example use:
+ * @code
+ * static anj_dm_execute_job_t diag_job;
+ *
+ * static int res_execute(anj_t *anj, const anj_dm_obj_t *obj, anj_iid_t iid,
+ *                        anj_rid_t rid, const char *execute_arg,
+ *                        size_t execute_arg_len) {
+ *     // 5.03 Service Unavailable is sent if the job is already running
+ *     int result = anj_dm_execute_job_start(&diag_job);
+ *     if (!result) {
+ *         start_diagnostics();
+ *     }
+ *     return result;
+ * }
+ *
+ * static int res_read(anj_t *anj, const anj_dm_obj_t *obj, anj_iid_t iid,
+ *                     anj_rid_t rid, anj_riid_t riid,
+ *                     anj_res_value_t *out_value) {
+ *     // status Resource, e.g. /3333/0/1
+ *     out_value->int_value = anj_dm_execute_job_get_state(&diag_job);
+ *     return 0;
+ * }
+ *
+ * // in the main loop, once the diagnostics are done
+ * anj_dm_execute_job_finish(&anj, &diag_job, diagnostics_result());
+ * @endcode
+ */
+
+#ifndef ANJ_DM_EXECUTE_JOB_H
+#    define ANJ_DM_EXECUTE_JOB_H
+
+#    include <anj/core.h>
+#    include <anj/defs.h>
+
+#    ifdef __cplusplus
+extern "C" {
+#    endif
+
+#    ifdef ANJ_DM_WITH_EXECUTE_JOB
+
+/**
+ * State of a background job, see @ref anj_dm_execute_job_get_state.
+ */
+typedef enum {
+    /** The job has never been started. */
+    ANJ_DM_EXECUTE_JOB_STATE_IDLE = 0,
+
+    /** The job has been started and is not finished yet. */
+    ANJ_DM_EXECUTE_JOB_STATE_RUNNING = 1,
+
+    /** The last run of the job finished successfully. */
+    ANJ_DM_EXECUTE_JOB_STATE_SUCCEEDED = 2,
+
+    /** The last run of the job failed. */
+    ANJ_DM_EXECUTE_JOB_STATE_FAILED = 3
+} anj_dm_execute_job_state_t;
+
+/**
+ * Background job started by an Execute handler.
+ *
+ * @anj_internal_fields_do_not_use
+ */
+typedef struct {
+    anj_uri_path_t status_path;
+    anj_dm_execute_job_state_t state;
+    int result;
+} anj_dm_execute_job_t;
+
+/**
+ * Initializes the job in @ref ANJ_DM_EXECUTE_JOB_STATE_IDLE state.
+ *
+ * @param job         Job to initialize.
+ * @param status_path Path of the Resource that reports the state of the job,
+ *                    reported as changed by @ref anj_dm_execute_job_finish.
+ *                    It is copied. May be @c NULL if there is no such
+ *                    Resource.
+ */
+void anj_dm_execute_job_init(anj_dm_execute_job_t *job,
+                             const anj_uri_path_t *status_path);
+
+/**
+ * Marks the job as running. Intended to be called from an
+ * @ref anj_dm_res_execute_t handler, whose return value may be passed
+ * directly as the handler's result.
+ *
+ * @note The status Resource is not reported as changed here, as the data
+ *       model must not be read while the Execute operation is in progress; the
+ *       response to the Execute request already informs the LwM2M Server that
+ *       the job has started.
+ *
+ * @param job Job to start.
+ *
+ * @return 0 on success, @ref ANJ_DM_ERR_SERVICE_UNAVAILABLE if the job is
+ *         already running.
+ */
+int anj_dm_execute_job_start(anj_dm_execute_job_t *job);
+
+/**
+ * Marks the job as finished and calls @ref anj_core_data_model_changed for
+ * its status Resource.
+ *
+ * Must be called from the same thread as @ref anj_core_step, but not from
+ * within the data model handlers.
+ *
+ * @param anj    Anjay object.
+ * @param job    Job to finish.
+ * @param result 0 if the job succeeded, a negative value otherwise.
+ *
+ * @return 0 on success, -1 if the job is not running.
+ */
+int anj_dm_execute_job_finish(anj_t *anj,
+                              anj_dm_execute_job_t *job,
+                              int result);
+
+/**
+ * Returns the current state of the job.
+ *
+ * @param job Job to check.
+ */
+anj_dm_execute_job_state_t
+anj_dm_execute_job_get_state(const anj_dm_execute_job_t *job);
+
+/**
+ * Returns the result passed to the last @ref anj_dm_execute_job_finish call,
+ * or 0 if the job has not finished yet.
+ *
+ * @param job Job to check.
+ */
+int anj_dm_execute_job_get_result(const anj_dm_execute_job_t *job);
+
+#    endif // ANJ_DM_WITH_EXECUTE_JOB
+
+#    ifdef __cplusplus
+}
+#    endif
+
+#endif // ANJ_DM_EXECUTE_JOB_H
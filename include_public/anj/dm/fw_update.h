@@ -146,6 +146,59 @@ typedef anj_dm_fw_update_result_t anj_dm_fw_update_package_write_t(
 typedef anj_dm_fw_update_result_t
 anj_dm_fw_update_package_write_finish_t(void *user_ptr);
 
+#        ifdef ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
+/**
+ * Starts writing a part of firmware package to the storage without waiting
+ * for the write to finish. If set, it is used instead of @ref
+ * anj_dm_fw_update_package_write_t.
+ *
+ * @p data points to one of the two internal staging buffers and stays valid
+ * until the write is reported as finished with @ref
+ * anj_dm_fw_update_object_package_write_completed. The library acknowledges
+ * the Write request as soon as this callback returns, so the next chunk may be
+ * passed while the previous one is still being written. Writes must be
+ * completed in the order they were started.
+ *
+ * @ref anj_dm_fw_update_package_write_finish_t is called only after all
+ * started writes have been completed.
+ *
+ * @param user_ptr  Opaque pointer to user data, as passed to @ref
+ *                  anj_dm_fw_update_object_install.
+ * @param data      Pointer to the data chunk.
+ * @param data_size Size of the data chunk.
+ *
+ * @return The callback should return:
+ *         - @ref ANJ_DM_FW_UPDATE_RESULT_SUCCESS if the write has been
+ *           started,
+ *         - other @ref anj_dm_fw_update_result_t value, accordingly to the
+ *           reason of failure.
+ */
+typedef anj_dm_fw_update_result_t anj_dm_fw_update_package_write_async_t(
+        void *user_ptr, const void *data, size_t data_size);
+
+/**
+ * Waits until the oldest write started with @ref
+ * anj_dm_fw_update_package_write_async_t is finished. Called when a new chunk
+ * arrives while both staging buffers are still in use.
+ *
+ * If this handler is not implemented, the Write is rejected with @ref
+ * ANJ_DM_ERR_SERVICE_UNAVAILABLE instead, and the LwM2M Server may retry it
+ * after some delay.
+ *
+ * @warning The write reported by this handler must not be reported again with
+ *          @ref anj_dm_fw_update_object_package_write_completed.
+ *
+ * @param user_ptr Opaque pointer to user data, as passed to @ref
+ *                 anj_dm_fw_update_object_install.
+ *
+ * @return Result of the finished write, @ref ANJ_DM_FW_UPDATE_RESULT_SUCCESS
+ *         or other @ref anj_dm_fw_update_result_t value, accordingly to the
+ *         reason of failure.
+ */
+typedef anj_dm_fw_update_result_t
+anj_dm_fw_update_package_write_wait_t(void *user_ptr);
+#        endif // ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
+
 /**
  * Initiates the Pull-mode download of a firmware package by providing the URI
  * written by a LwM2M Server to the Package URI Resource.
@@ -272,6 +325,155 @@ typedef const char *anj_dm_fw_update_get_version_t(void *user_ptr);
  */
 typedef void anj_dm_fw_update_reset_t(void *user_ptr);
 
+#        ifdef ANJ_FOTA_WITH_PACKAGE_DIGEST
+/**
+ * Initializes the digest (hash) context for a new firmware package. Called
+ * when a Push-mode download starts, or after a successful
+ * @ref anj_dm_fw_update_uri_write_t call in Pull mode.
+ *
+ * @param user_ptr Opaque pointer to user data, as passed to @ref
+ *                 anj_dm_fw_update_object_install.
+ *
+ * @return 0 on success, a non-zero value in case of an error.
+ */
+typedef int anj_dm_fw_update_digest_init_t(void *user_ptr);
+
+/**
+ * Feeds the next chunk of the firmware package to the digest context. Chunks
+ * are passed in order, the same ones that are written to the storage.
+ *
+ * @param user_ptr  Opaque pointer to user data, as passed to @ref
+ *                  anj_dm_fw_update_object_install.
+ * @param data      Pointer to the data chunk.
+ * @param data_size Size of the data chunk.
+ *
+ * @return 0 on success, a non-zero value in case of an error.
+ */
+typedef int anj_dm_fw_update_digest_update_t(void *user_ptr,
+                                             const void *data,
+                                             size_t data_size);
+
+/**
+ * Finalizes the digest of the whole firmware package.
+ *
+ * @param user_ptr        Opaque pointer to user data, as passed to @ref
+ *                        anj_dm_fw_update_object_install.
+ * @param out_digest      Buffer of @ref ANJ_FOTA_DIGEST_MAX_SIZE bytes for
+ *                        the computed digest.
+ * @param out_digest_size Size of the computed digest.
+ *
+ * @return 0 on success, a non-zero value in case of an error.
+ */
+typedef int anj_dm_fw_update_digest_finish_t(void *user_ptr,
+                                             uint8_t *out_digest,
+                                             size_t *out_digest_size);
+#        endif // ANJ_FOTA_WITH_PACKAGE_DIGEST
+
+#        ifdef ANJ_FOTA_WITH_DELTA_UPDATE
+/**
+ * Reads a part of the currently running (old) firmware image, which a delta
+ * patch is applied to.
+ *
+ * @param user_ptr Opaque pointer to user data, as passed to @ref
+ *                 anj_dm_fw_update_object_install or @ref
+ *                 anj_dm_fw_update_delta_init.
+ * @param offset   Offset in the old image.
+ * @param buff     Buffer for the read data.
+ * @param size     Number of bytes to read, at most
+ *                 @ref ANJ_FOTA_DELTA_WINDOW_SIZE.
+ *
+ * @return 0 on success, a non-zero value in case of an error, e.g. if the
+ *         requested range is outside of the old image.
+ */
+typedef int anj_dm_fw_update_old_image_read_t(void *user_ptr,
+                                              size_t offset,
+                                              void *buff,
+                                              size_t size);
+
+/**
+ * State of the streaming delta patch applier.
+ *
+ * The patch starts with the <c>"ANJD"</c> magic and the size of the new image,
+ * followed by commands that build the new image from the old one. Each command
+ * consists of a single opcode byte and an argument:
+ * - <c>0x00</c> DIFF <c>len</c>: <c>len</c> bytes follow, each added
+ *   (modulo 256) to the next byte of the old image,
+ * - <c>0x01</c> EXTRA <c>len</c>: <c>len</c> bytes follow, copied literally,
+ * - <c>0x02</c> COPY <c>len</c>: the next <c>len</c> bytes of the old image are
+ *   copied,
+ * - <c>0x03</c> SEEK <c>delta</c>: moves the position in the old image by the
+ *   signed <c>delta</c>.
+ *
+ * All numbers are encoded as unsigned LEB128, <c>delta</c> is zigzag-encoded
+ * first. DIFF, COPY and EXTRA commands are what bsdiff-like tools produce; only
+ * @ref ANJ_FOTA_DELTA_WINDOW_SIZE bytes of the new image are buffered at once.
+ *
+ * @anj_internal_fields_do_not_use
+ */
+typedef struct {
+    anj_dm_fw_update_old_image_read_t *old_image_read;
+    anj_dm_fw_update_package_write_t *new_image_write;
+    void *user_ptr;
+    uint8_t state;
+    uint8_t opcode;
+    uint8_t arg_shift;
+    uint64_t arg;
+    size_t remaining;
+    size_t old_offset;
+    size_t new_size;
+    size_t new_offset;
+    size_t window_len;
+    uint8_t window[ANJ_FOTA_DELTA_WINDOW_SIZE];
+} anj_dm_fw_update_delta_ctx_t;
+#        endif // ANJ_FOTA_WITH_DELTA_UPDATE
+
+#        ifdef ANJ_FOTA_WITH_DECOMPRESSION
+/**
+ * State of the streaming package decompressor.
+ *
+ * A compressed package starts with the <c>"ANJZ"</c> header and a parameters
+ * byte holding the base-2 logarithms of the window size (upper nibble,
+ * at most @ref ANJ_FOTA_DECOMPRESSION_WINDOW_BITS) and of the lookahead size
+ * (lower nibble), followed by a heatshrink LZSS stream produced with the same
+ * parameters, e.g. by <c>heatshrink -e -w 8 -l 4</c>. Data that doesn't start
+ * with the header is passed through unchanged.
+ *
+ * @anj_internal_fields_do_not_use
+ */
+typedef struct {
+    anj_dm_fw_update_package_write_t *output;
+    void *user_ptr;
+    uint8_t state;
+    uint8_t header_len;
+    uint8_t window_bits;
+    uint8_t lookahead_bits;
+    uint8_t bits_left;
+    uint16_t value;
+    uint16_t index;
+    size_t head;
+    size_t flushed;
+    uint8_t window[1 << ANJ_FOTA_DECOMPRESSION_WINDOW_BITS];
+} anj_dm_fw_update_decompress_ctx_t;
+#        endif // ANJ_FOTA_WITH_DECOMPRESSION
+
+#        ifdef ANJ_FOTA_WITH_PAGE_ALIGNED_WRITES
+/**
+ * State of the page writer, which collects the firmware package into pieces
+ * aligned to the flash page boundaries.
+ *
+ * @anj_internal_fields_do_not_use
+ */
+typedef struct {
+    anj_dm_fw_update_package_write_t *output;
+    void *user_ptr;
+    size_t page_size;
+    // offset of page[0] in the package
+    size_t offset;
+    size_t page_len;
+    uint8_t page[ANJ_FOTA_WRITE_PAGE_MAX_SIZE];
+} anj_dm_fw_update_page_writer_ctx_t;
+#        endif // ANJ_FOTA_WITH_PAGE_ALIGNED_WRITES
+
 /**
  * Collection of user‑provided callbacks used by the Firmware Update Object.
  *
@@ -289,6 +491,17 @@ typedef struct {
     /** Finalizes the Push‑mode download operation. */
     anj_dm_fw_update_package_write_finish_t *package_write_finish_handler;
 
+#        ifdef ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
+    /**
+     * Starts an asynchronous write of a chunk of the firmware package. If set,
+     * @ref package_write_handler may be @c NULL.
+     */
+    anj_dm_fw_update_package_write_async_t *package_write_async_handler;
+
+    /** Waits for the oldest asynchronous write to finish. Optional. */
+    anj_dm_fw_update_package_write_wait_t *package_write_wait_handler;
+#        endif // ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
+
     /** Handles Write to Package URI (starts Pull‑mode download). */
     anj_dm_fw_update_uri_write_t *uri_write_handler;
 
@@ -303,6 +516,40 @@ typedef struct {
 
     /** Aborts firmware download process and cleans up temporary resources. */
     anj_dm_fw_update_reset_t *reset_handler;
+
+#        ifdef ANJ_FOTA_WITH_PACKAGE_DIGEST
+    /**
+     * Initializes the package digest. If the digest handlers are set to
+     * @c NULL, the package is not verified by the library.
+     */
+    anj_dm_fw_update_digest_init_t *digest_init;
+
+    /** Feeds a chunk of the firmware package to the digest. */
+    anj_dm_fw_update_digest_update_t *digest_update;
+
+    /** Finalizes the package digest. */
+    anj_dm_fw_update_digest_finish_t *digest_finish;
+#        endif // ANJ_FOTA_WITH_PACKAGE_DIGEST
+
+#        ifdef ANJ_FOTA_WITH_DELTA_UPDATE
+    /**
+     * Reads the old firmware image. If set, packages written in Push mode are
+     * treated as delta patches: they are applied on the fly and only the
+     * resulting new image is passed to @ref package_write_handler, which is
+     * then required. Can't be combined with @ref package_write_async_handler.
+     */
+    anj_dm_fw_update_old_image_read_t *old_image_read;
+#        endif // ANJ_FOTA_WITH_DELTA_UPDATE
+
+#        ifdef ANJ_FOTA_WITH_PAGE_ALIGNED_WRITES
+    /**
+     * Flash page size, at most @ref ANJ_FOTA_WRITE_PAGE_MAX_SIZE. If set,
+     * @ref package_write_handler is called with whole pages only, except for
+     * the last call before @ref package_write_finish_handler. 0 disables
+     * coalescing.
+     */
+    size_t write_page_size;
+#        endif // ANJ_FOTA_WITH_PAGE_ALIGNED_WRITES
 } anj_dm_fw_update_handlers_t;
 
 /**
@@ -328,6 +575,26 @@ typedef struct {
 #        if defined(ANJ_FOTA_WITH_PUSH_METHOD)
         bool write_start_called;
 #        endif // defined (ANJ_FOTA_WITH_PUSH_METHOD)
+#        ifdef ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
+        uint8_t staging[2][ANJ_FOTA_PUSH_STAGING_BUFFER_SIZE];
+        uint8_t staging_next;
+        uint8_t staging_pending;
+        bool finish_pending;
+#        endif // ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
+#        ifdef ANJ_FOTA_WITH_DELTA_UPDATE
+        anj_dm_fw_update_delta_ctx_t delta;
+#        endif // ANJ_FOTA_WITH_DELTA_UPDATE
+#        ifdef ANJ_FOTA_WITH_DECOMPRESSION
+        anj_dm_fw_update_decompress_ctx_t decompress;
+#        endif // ANJ_FOTA_WITH_DECOMPRESSION
+#        ifdef ANJ_FOTA_WITH_PAGE_ALIGNED_WRITES
+        anj_dm_fw_update_page_writer_ctx_t page_writer;
+#        endif // ANJ_FOTA_WITH_PAGE_ALIGNED_WRITES
+#        ifdef ANJ_FOTA_WITH_PACKAGE_DIGEST
+        bool digest_in_progress;
+        uint8_t expected_digest[ANJ_FOTA_DIGEST_MAX_SIZE];
+        size_t expected_digest_size;
+#        endif // ANJ_FOTA_WITH_PACKAGE_DIGEST
     } repr;
 } anj_dm_fw_update_entity_ctx_t;
 
@@ -391,6 +658,235 @@ int anj_dm_fw_update_object_set_download_result(
         anj_dm_fw_update_entity_ctx_t *entity_ctx,
         anj_dm_fw_update_result_t result);
 
+#        ifdef ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
+/**
+ * Reports that the oldest write started with @ref
+ * anj_dm_fw_update_package_write_async_t is finished, releasing its staging
+ * buffer.
+ *
+ * If @p result is other than @ref ANJ_DM_FW_UPDATE_RESULT_SUCCESS, the
+ * download is aborted with @ref anj_dm_fw_update_reset_t and the Update Result
+ * Resource is set to @p result; next chunks of the same package are rejected.
+ * After the last write of a complete package is reported, @ref
+ * anj_dm_fw_update_package_write_finish_t is called and the State Resource is
+ * set to \em Downloaded.
+ *
+ * @param anj        Anjay object.
+ * @param entity_ctx Firmware Update Object state.
+ * @param result     Result of the write.
+ *
+ * @return 0 on success, a non-zero value if there is no write in progress.
+ */
+int anj_dm_fw_update_object_package_write_completed(
+        anj_t *anj,
+        anj_dm_fw_update_entity_ctx_t *entity_ctx,
+        anj_dm_fw_update_result_t result);
+#        endif // ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
+
+#        ifdef ANJ_FOTA_WITH_PACKAGE_DIGEST
+/**
+ * Sets the digest the firmware package is expected to have, e.g. supplied by
+ * the LwM2M Server or read from the package header.
+ *
+ * Must be called for every package, before the last chunk is written in Push
+ * mode or before @ref anj_dm_fw_update_object_set_download_result is called
+ * in Pull mode. If the digest handlers are set and no expected digest was
+ * provided, the download fails with
+ * @ref ANJ_DM_FW_UPDATE_RESULT_INTEGRITY_FAILURE.
+ *
+ * @param entity_ctx  Firmware Update Object state.
+ * @param digest      Expected digest.
+ * @param digest_size Size of @p digest, at most
+ *                    @ref ANJ_FOTA_DIGEST_MAX_SIZE.
+ *
+ * @return 0 on success, a non-zero value in case of an error.
+ */
+int anj_dm_fw_update_object_set_expected_digest(
+        anj_dm_fw_update_entity_ctx_t *entity_ctx,
+        const uint8_t *digest,
+        size_t digest_size);
+
+#            ifdef ANJ_FOTA_WITH_PULL_METHOD
+/**
+ * Feeds a chunk of the firmware package downloaded in Pull mode to the
+ * digest. Should be called for each chunk, in order, e.g. from the
+ * @ref anj_coap_downloader_event_callback_t.
+ *
+ * @warning Calling this function in states other than @ref
+ *          ANJ_DM_FW_UPDATE_STATE_DOWNLOADING is an error.
+ *
+ * @param entity_ctx Firmware Update Object state.
+ * @param data       Pointer to the data chunk.
+ * @param data_size  Size of the data chunk.
+ *
+ * @return 0 on success, a non-zero value in case of an error. After an error
+ *         the download should be finished with @ref
+ *         anj_dm_fw_update_object_set_download_result.
+ */
+int anj_dm_fw_update_object_digest_update(
+        anj_dm_fw_update_entity_ctx_t *entity_ctx,
+        const void *data,
+        size_t data_size);
+#            endif // ANJ_FOTA_WITH_PULL_METHOD
+#        endif     // ANJ_FOTA_WITH_PACKAGE_DIGEST
+
+#        ifdef ANJ_FOTA_WITH_DELTA_UPDATE
+/**
+ * Initializes the delta patch applier for a new patch. In Push mode this is
+ * done by the library if @ref anj_dm_fw_update_handlers_t.old_image_read is
+ * set; in Pull mode the downloaded chunks may be passed through the applier
+ * by user code, e.g. from the @ref anj_coap_downloader_event_callback_t.
+ *
+ * @param ctx             Applier state.
+ * @param old_image_read  Reads the old firmware image.
+ * @param new_image_write Receives the new firmware image, in order.
+ * @param user_ptr        Opaque pointer passed to both callbacks.
+ */
+void anj_dm_fw_update_delta_init(
+        anj_dm_fw_update_delta_ctx_t *ctx,
+        anj_dm_fw_update_old_image_read_t *old_image_read,
+        anj_dm_fw_update_package_write_t *new_image_write,
+        void *user_ptr);
+
+/**
+ * Applies the next chunk of the delta patch. Whenever the window fills up, the
+ * new image data is passed to the <c>new_image_write</c> callback.
+ *
+ * @param ctx       Applier state.
+ * @param data      Pointer to the patch chunk.
+ * @param data_size Size of the patch chunk.
+ *
+ * @return
+ * - @ref ANJ_DM_FW_UPDATE_RESULT_SUCCESS on success,
+ * - @ref ANJ_DM_FW_UPDATE_RESULT_INTEGRITY_FAILURE if the patch is malformed,
+ * - @ref ANJ_DM_FW_UPDATE_RESULT_FAILED if the old image could not be read,
+ * - the value returned by the <c>new_image_write</c> callback if it failed.
+ *
+ * After a failure, all following calls fail as well.
+ */
+anj_dm_fw_update_result_t
+anj_dm_fw_update_delta_feed(anj_dm_fw_update_delta_ctx_t *ctx,
+                            const void *data,
+                            size_t data_size);
+
+/**
+ * Checks that the whole patch has been applied and writes the rest of the new
+ * image.
+ *
+ * @param ctx Applier state.
+ *
+ * @return Same values as @ref anj_dm_fw_update_delta_feed;
+ *         @ref ANJ_DM_FW_UPDATE_RESULT_INTEGRITY_FAILURE also if the patch is
+ *         incomplete.
+ */
+anj_dm_fw_update_result_t
+anj_dm_fw_update_delta_finish(anj_dm_fw_update_delta_ctx_t *ctx);
+#        endif // ANJ_FOTA_WITH_DELTA_UPDATE
+
+#        ifdef ANJ_FOTA_WITH_DECOMPRESSION
+/**
+ * Initializes the package decompressor for a new package. In Push mode this is
+ * done by the library; in Pull mode the downloaded chunks may be passed through
+ * the decompressor by user code, e.g. from the
+ * @ref anj_coap_downloader_event_callback_t.
+ *
+ * @param ctx      Decompressor state.
+ * @param output   Receives the decompressed data, in order.
+ * @param user_ptr Opaque pointer passed to @p output.
+ */
+void anj_dm_fw_update_decompress_init(anj_dm_fw_update_decompress_ctx_t *ctx,
+                                      anj_dm_fw_update_package_write_t *output,
+                                      void *user_ptr);
+
+/**
+ * Decompresses the next chunk of the package. Compressed data is passed to
+ * @p output whenever the window fills up; uncompressed packages are passed
+ * as they come.
+ *
+ * @param ctx       Decompressor state.
+ * @param data      Pointer to the package chunk.
+ * @param data_size Size of the package chunk.
+ *
+ * @return
+ * - @ref ANJ_DM_FW_UPDATE_RESULT_SUCCESS on success,
+ * - @ref ANJ_DM_FW_UPDATE_RESULT_UNSUPPORTED_PACKAGE_TYPE if the package was
+ *   compressed with unsupported parameters,
+ * - the value returned by the <c>output</c> callback if it failed.
+ *
+ * After a failure, all following calls fail as well.
+ */
+anj_dm_fw_update_result_t
+anj_dm_fw_update_decompress_feed(anj_dm_fw_update_decompress_ctx_t *ctx,
+                                 const void *data,
+                                 size_t data_size);
+
+/**
+ * Passes the rest of the decompressed data to the <c>output</c> callback.
+ *
+ * @param ctx Decompressor state.
+ *
+ * @return Same values as @ref anj_dm_fw_update_decompress_feed.
+ */
+anj_dm_fw_update_result_t
+anj_dm_fw_update_decompress_finish(anj_dm_fw_update_decompress_ctx_t *ctx);
+#        endif // ANJ_FOTA_WITH_DECOMPRESSION
+
+#        ifdef ANJ_FOTA_WITH_PAGE_ALIGNED_WRITES
+/**
+ * Initializes the page writer for a new package. In Push mode this is done by
+ * the library; in Pull mode the downloaded chunks may be passed through the
+ * page writer by user code, e.g. from the
+ * @ref anj_coap_downloader_event_callback_t.
+ *
+ * @param ctx          Page writer state.
+ * @param output       Receives the package in pieces that start at a multiple
+ *                     of @p page_size and, except for the first and the last
+ *                     one, are exactly one page long.
+ * @param user_ptr     Opaque pointer passed to @p output.
+ * @param page_size    Flash page size, in range 1..@ref
+ *                     ANJ_FOTA_WRITE_PAGE_MAX_SIZE.
+ * @param start_offset Offset in the package of the first byte that will be
+ *                     fed, e.g. the value returned by
+ *                     @ref anj_coap_downloader_get_resume_offset. If it's not
+ *                     page-aligned, the first piece ends at the next page
+ *                     boundary.
+ */
+void anj_dm_fw_update_page_writer_init(
+        anj_dm_fw_update_page_writer_ctx_t *ctx,
+        anj_dm_fw_update_package_write_t *output,
+        void *user_ptr,
+        size_t page_size,
+        size_t start_offset);
+
+/**
+ * Passes the next chunk of the package to the page writer. Every page that
+ * gets completed is passed to the <c>output</c> callback; whole pages are
+ * passed directly from @p data, without copying.
+ *
+ * @param ctx       Page writer state.
+ * @param data      Pointer to the package chunk.
+ * @param data_size Size of the package chunk.
+ *
+ * @return
+ * - @ref ANJ_DM_FW_UPDATE_RESULT_SUCCESS on success,
+ * - the value returned by the <c>output</c> callback if it failed.
+ */
+anj_dm_fw_update_result_t
+anj_dm_fw_update_page_writer_feed(anj_dm_fw_update_page_writer_ctx_t *ctx,
+                                  const void *data,
+                                  size_t data_size);
+
+/**
+ * Passes the incomplete last page, if any, to the <c>output</c> callback.
+ *
+ * @param ctx Page writer state.
+ *
+ * @return Same values as @ref anj_dm_fw_update_page_writer_feed.
+ */
+anj_dm_fw_update_result_t
+anj_dm_fw_update_page_writer_finish(anj_dm_fw_update_page_writer_ctx_t *ctx);
+#        endif // ANJ_FOTA_WITH_PAGE_ALIGNED_WRITES
+
 #    endif // ANJ_WITH_DEFAULT_FOTA_OBJ
 
 #    ifdef __cplusplus
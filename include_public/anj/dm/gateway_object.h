@@ -0,0 +1,197 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+/**
+ * @file
+ * @brief Default implementation of the LwM2M Gateway Object (/25).
+ *
+ * Allows a single LwM2M Client, i.e. a single registration, connection and
+ * exchange pipeline, to expose End IoT Devices connected to it, e.g. with BLE
+ * or Modbus. Each End IoT Device is represented by an Instance of the Object
+ * with the following Resources:
+ *
+ * | RID | Name               | Operations | Type    |
+ * |-----|--------------------|------------|---------|
+ * | 0   | Device ID          | R          | String  |
+ * | 1   | Prefix             | R          | String  |
+ * | 3   | IoT Device Objects | R          | Corelnk |
+ *
+ * Every End IoT Device has its own data model, independent of the data model
+ * of the Gateway. The LwM2M Server addresses it with paths starting with the
+ * Prefix of the device, e.g. Read of <c>/dev1/3303/0/5700</c> is handled by
+ * the Temperature Object added with @ref anj_dm_gateway_add_obj to the device
+ * with Prefix <c>dev1</c>. Only the Gateway Object is listed in the Register
+ * payload, the Objects of End IoT Devices are discovered by reading the IoT
+ * Device Objects Resource.
+ *
+ * Read, Discover, Write, Execute, Create and Delete operations are supported
+ * for End IoT Devices. Observations, Write-Attributes, composite and Bootstrap
+ * operations with prefixed paths are rejected.
+ *
+ * @note Handlers of Objects of End IoT Devices are called with the data model
+ *       of the device in place of the data model of the Gateway. Calling
+ *       @ref anj_core_data_model_changed from them has no effect, since the
+ *       Gateway doesn't track changes of End IoT Devices.
+ */
+
+#ifndef ANJ_DM_GATEWAY_OBJECT_H
+#    define ANJ_DM_GATEWAY_OBJECT_H
+
+#    include <stdint.h>
+
+#    include <anj/core.h>
+#    include <anj/defs.h>
+#    include <anj/dm/core.h>
+
+#    ifdef __cplusplus
+extern "C" {
+#    endif
+
+#    ifdef ANJ_WITH_LWM2M_GATEWAY
+
+/**
+ * Internal state of a single End IoT Device.
+ *
+ * @anj_internal_fields_do_not_use
+ */
+typedef struct {
+    const char *device_id;
+    const char *prefix;
+    const anj_dm_obj_t *objs[ANJ_GATEWAY_MAX_DEVICE_OBJECTS];
+    uint16_t objs_count;
+} anj_dm_gateway_device_t;
+
+/**
+ * Internal state of LwM2M Gateway Object.
+ *
+ * @warning The user must ensure that this structure remains valid for the
+ *          entire lifetime of @ref anj_t object.
+ *
+ * @anj_internal_fields_do_not_use
+ */
+typedef struct anj_dm_gateway_obj_struct {
+    anj_dm_obj_t obj;
+    anj_dm_obj_inst_t insts[ANJ_GATEWAY_MAX_DEVICES];
+    // indexed like insts
+    anj_dm_gateway_device_t devices[ANJ_GATEWAY_MAX_DEVICES];
+    char iot_device_objects[ANJ_GATEWAY_IOT_DEVICE_OBJECTS_BUFFER_SIZE];
+    // device whose data model is in use; the Objects of the Gateway are
+    // kept aside in the meantime
+    anj_dm_gateway_device_t *selected;
+    const anj_dm_obj_t *gateway_objs[ANJ_DM_MAX_OBJECTS_NUMBER];
+    uint16_t gateway_objs_count;
+} anj_dm_gateway_obj_t;
+
+/**
+ * Installs LwM2M Gateway Object (/25) in data model. The Object has no
+ * Instances until End IoT Devices are added with
+ * @ref anj_dm_gateway_add_device.
+ *
+ * Example usage:
+ * @code
+ * static anj_dm_gateway_obj_t gateway_obj;
+ * anj_dm_gateway_obj_install(&anj, &gateway_obj);
+ * anj_dm_gateway_add_device(&anj, &gateway_obj, 0, "sensor-0001", "dev1");
+ * anj_dm_gateway_add_obj(&anj, &gateway_obj, 0, &temperature_obj);
+ * @endcode
+ *
+ * @param anj         Anjay object.
+ * @param gateway_obj Pointer to a variable that will hold the state of the
+ *                    Object.
+ *
+ * @return 0 on success, a non-zero value in case of an error.
+ */
+int anj_dm_gateway_obj_install(anj_t *anj, anj_dm_gateway_obj_t *gateway_obj);
+
+/**
+ * Adds an End IoT Device, i.e. an Instance of the LwM2M Gateway Object. The
+ * device has an empty data model until Objects are added with
+ * @ref anj_dm_gateway_add_obj.
+ *
+ * @warning @p device_id and @p prefix are not copied, the user must ensure
+ *          that they remain valid until the device is removed.
+ *
+ * @param anj         Anjay object.
+ * @param gateway_obj LwM2M Gateway Object.
+ * @param iid         Instance ID assigned to the device.
+ * @param device_id   Device ID Resource (/25/x/0) value.
+ * @param prefix      Prefix Resource (/25/x/1) value, used by the LwM2M
+ *                    Server in paths of the data model of the device. Must
+ *                    be unique, must not start with a digit, contain
+ *                    <c>/</c> or be equal to <c>bs</c>.
+ *
+ * @return 0 on success, a non-zero value if there is no space for another
+ *         device, the Instance ID or Prefix is already used, the Prefix is
+ *         invalid or a data model operation is in progress.
+ */
+int anj_dm_gateway_add_device(anj_t *anj,
+                              anj_dm_gateway_obj_t *gateway_obj,
+                              anj_iid_t iid,
+                              const char *device_id,
+                              const char *prefix);
+
+/**
+ * Removes an End IoT Device added with @ref anj_dm_gateway_add_device,
+ * together with its data model.
+ *
+ * @param anj         Anjay object.
+ * @param gateway_obj LwM2M Gateway Object.
+ * @param iid         Instance ID of the device.
+ *
+ * @return 0 on success, a non-zero value if there is no such device or a data
+ *         model operation is in progress.
+ */
+int anj_dm_gateway_remove_device(anj_t *anj,
+                                 anj_dm_gateway_obj_t *gateway_obj,
+                                 anj_iid_t iid);
+
+/**
+ * Adds an Object to the data model of an End IoT Device. The same rules as for
+ * @ref anj_dm_add_obj apply, all the Objects of the device are listed in its
+ * IoT Device Objects Resource (/25/x/3).
+ *
+ * @param anj         Anjay object.
+ * @param gateway_obj LwM2M Gateway Object.
+ * @param iid         Instance ID of the device.
+ * @param obj         Object to add.
+ *
+ * @return 0 on success, a non-zero value if there is no such device, no space
+ *         for another Object, the Object already exists in the data model of
+ *         the device or a data model operation is in progress.
+ */
+int anj_dm_gateway_add_obj(anj_t *anj,
+                           anj_dm_gateway_obj_t *gateway_obj,
+                           anj_iid_t iid,
+                           const anj_dm_obj_t *obj);
+
+/**
+ * Removes an Object from the data model of an End IoT Device.
+ *
+ * @param anj         Anjay object.
+ * @param gateway_obj LwM2M Gateway Object.
+ * @param iid         Instance ID of the device.
+ * @param oid         ID of the Object to remove.
+ *
+ * @return 0 on success, a non-zero value if there is no such device or Object
+ *         or a data model operation is in progress.
+ */
+int anj_dm_gateway_remove_obj(anj_t *anj,
+                              anj_dm_gateway_obj_t *gateway_obj,
+                              anj_iid_t iid,
+                              anj_oid_t oid);
+
+#    endif // ANJ_WITH_LWM2M_GATEWAY
+
+#    ifdef __cplusplus
+}
+#    endif
+
+#endif // ANJ_DM_GATEWAY_OBJECT_H
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+/**
+ * @file
+ * @brief Vendor-specific Object exposing communication metrics.
+ *
+ * Makes the values returned by @ref anj_core_metrics_get readable by the LwM2M
+ * Server. The Object has a single Instance with the following Resources:
+ *
+ * | RID | Name                  | Operations | Type    |
+ * |-----|-----------------------|------------|---------|
+ * | 0   | Retransmissions       | R          | Integer |
+ * | 1   | Cache Hits            | R          | Integer |
+ * | 2   | Blocks Transferred    | R          | Integer |
+ * | 3   | Notifications Sent    | R          | Integer |
+ * | 4   | DTLS Handshakes       | R          | Integer |
+ * | 5   | Bytes Sent            | R          | Integer |
+ * | 6   | Bytes Received        | R          | Integer |
+ * | 7   | Exchanges             | R          | Integer |
+ * | 8   | Min Exchange Time     | R          | Integer |
+ * | 9   | Max Exchange Time     | R          | Integer |
+ * | 10  | Average Exchange Time | R          | Integer |
+ * | 11  | Reset                 | E          |         |
+ *
+ * Exchange times are expressed in milliseconds. Executing the Reset Resource
+ * calls @ref anj_core_metrics_reset.
+ */
+
+#ifndef ANJ_DM_METRICS_OBJECT_H
+#    define ANJ_DM_METRICS_OBJECT_H
+
+#    include <anj/core.h>
+#    include <anj/dm/core.h>
+
+#    ifdef __cplusplus
+extern "C" {
+#    endif
+
+#    ifdef ANJ_WITH_DEFAULT_METRICS_OBJ
+
+/**
+ * Internal state of Metrics Object.
+ *
+ * @warning The user must ensure that this structure remains valid for the
+ *          entire lifetime of @ref anj_t object or until the Object is removed
+ *          using @ref anj_dm_remove_obj.
+ *
+ * @anj_internal_fields_do_not_use
+ */
+typedef struct {
+    anj_dm_obj_t obj;
+    anj_dm_obj_inst_t inst;
+} anj_dm_metrics_obj_t;
+
+/**
+ * Installs Metrics Object with Object ID @ref ANJ_METRICS_OBJ_OID in data
+ * model.
+ *
+ * @param anj         Anjay object.
+ * @param metrics_obj Pointer to a variable that will hold the state of the
+ *                    Object.
+ *
+ * @return 0 on success, a non-zero value in case of an error.
+ */
+int anj_dm_metrics_obj_install(anj_t *anj, anj_dm_metrics_obj_t *metrics_obj);
+
+#    endif // ANJ_WITH_DEFAULT_METRICS_OBJ
+
+#    ifdef __cplusplus
+}
+#    endif
+
+#endif // ANJ_DM_METRICS_OBJECT_H
@@ -0,0 +1,295 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+/**
+ * @file
+ * @brief Compile-time builders of constant Data Model definitions, for C++17.
+ *
+ * Resource definitions passed to @ref anj::dm::make_resources are sorted by
+ * their IDs and checked while compiling, like @ref anj_dm_add_obj checks them
+ * at runtime in debug builds, so an incorrectly defined Resource fails the
+ * build instead. When the results are declared as @c constexpr at namespace
+ * scope, they are constant-initialized and may be placed in read-only memory,
+ * together with the table of @ref anj_dm_obj_inst_t::rid_index built for them.
+ *
+ * Example:
+ * @code
+ * static constexpr anj_dm_res_t DEFS[] = {
+ *     anj::dm::res(1, ANJ_DATA_TYPE_INT, ANJ_DM_RES_RW),
+ *     anj::dm::res(0, ANJ_DATA_TYPE_STRING, ANJ_DM_RES_R),
+ * };
+ * static constexpr auto RESOURCES = anj::dm::make_resources(DEFS);
+ * static constexpr anj_dm_obj_inst_t INSTS[] = {
+ *     anj::dm::make_inst<RESOURCES>(0),
+ * };
+ * static constexpr anj_dm_obj_t OBJ =
+ *         anj::dm::make_obj(OID, "1.0", &HANDLERS, INSTS);
+ *
+ * // in the handlers, index of the Resource in RESOURCES.defs
+ * switch (anj::dm::rid_dispatch<RESOURCES>::index_of(rid)) { ... }
+ * @endcode
+ *
+ * Resource Instances are runtime state, so they are still checked only by
+ * @ref anj_dm_add_obj.
+ */
+
+#ifndef ANJ_DM_MODEL_HPP
+#    define ANJ_DM_MODEL_HPP
+
+#    if !defined(__cplusplus) || __cplusplus < 201703L
+#        error "anj/dm/model.hpp requires C++17"
+#    endif
+
+#    include <cstddef>
+#    include <cstdint>
+
+#    include <anj/defs.h>
+#    include <anj/dm/defs.h>
+#    include <anj/utils.h>
+
+namespace anj {
+namespace dm {
+
+namespace detail {
+
+// Intentionally not defined. Reaching it makes the constant evaluation of an
+// invalid definition fail, or the link fail if it's evaluated at runtime.
+void invalid_definition(const char *reason);
+
+constexpr bool is_readable(anj_dm_res_kind_t kind) {
+    return kind == ANJ_DM_RES_R || kind == ANJ_DM_RES_RW
+           || kind == ANJ_DM_RES_RM || kind == ANJ_DM_RES_RWM;
+}
+
+constexpr bool is_writable(anj_dm_res_kind_t kind) {
+    return kind == ANJ_DM_RES_W || kind == ANJ_DM_RES_RW
+           || kind == ANJ_DM_RES_WM || kind == ANJ_DM_RES_RWM;
+}
+
+constexpr bool is_valid_type(anj_data_type_t type) {
+    return type == ANJ_DATA_TYPE_BYTES || type == ANJ_DATA_TYPE_STRING
+           || type == ANJ_DATA_TYPE_INT || type == ANJ_DATA_TYPE_DOUBLE
+           || type == ANJ_DATA_TYPE_BOOL || type == ANJ_DATA_TYPE_OBJLNK
+           || type == ANJ_DATA_TYPE_UINT || type == ANJ_DATA_TYPE_TIME
+#    ifdef ANJ_WITH_EXTERNAL_DATA
+           || type == ANJ_DATA_TYPE_EXTERNAL_BYTES
+           || type == ANJ_DATA_TYPE_EXTERNAL_STRING
+#    endif // ANJ_WITH_EXTERNAL_DATA
+            ;
+}
+
+template <std::size_t Size>
+struct rid_index_table {
+    uint8_t idx[Size];
+};
+
+} // namespace detail
+
+/**
+ * Returns the definition of a Single-Instance or an Executable Resource.
+ *
+ * @param rid  Resource ID.
+ * @param type Resource data type, ignored for @ref ANJ_DM_RES_E.
+ * @param kind Resource kind.
+ */
+constexpr anj_dm_res_t
+res(anj_rid_t rid, anj_data_type_t type, anj_dm_res_kind_t kind) {
+    anj_dm_res_t def{};
+    def.rid = rid;
+    def.type = type;
+    def.kind = kind;
+    return def;
+}
+
+/**
+ * Returns the definition of a Multiple-Instance Resource.
+ *
+ * @param rid            Resource ID.
+ * @param type           Resource data type.
+ * @param kind           Resource kind.
+ * @param insts          Array of Resource Instance IDs, see
+ *                       @ref anj_dm_res_t::insts.
+ * @param max_inst_count Size of @p insts.
+ */
+constexpr anj_dm_res_t res(anj_rid_t rid,
+                           anj_data_type_t type,
+                           anj_dm_res_kind_t kind,
+                           const anj_riid_t *insts,
+                           uint16_t max_inst_count) {
+    anj_dm_res_t def = res(rid, type, kind);
+    def.insts = insts;
+    def.max_inst_count = max_inst_count;
+    return def;
+}
+
+/**
+ * Resource definitions of an Object Instance, sorted by their IDs. Built with
+ * @ref make_resources.
+ */
+template <std::size_t Count>
+struct resources {
+    /** Definitions, to be used as @ref anj_dm_obj_inst_t::resources. */
+    anj_dm_res_t defs[Count];
+
+    /** Number of definitions. */
+    static constexpr uint16_t count = Count;
+};
+
+/**
+ * Sorts Resource definitions by their IDs and checks them.
+ *
+ * Evaluated in a constant expression, fails the build if any Resource has an
+ * invalid or duplicated ID, or an invalid data type.
+ *
+ * @param defs Resource definitions, in any order.
+ */
+template <std::size_t Count>
+constexpr resources<Count> make_resources(const anj_dm_res_t (&defs)[Count]) {
+    static_assert(Count > 0 && Count < UINT16_MAX,
+                  "unsupported number of Resources");
+    resources<Count> out{};
+    for (std::size_t i = 0; i < Count; i++) {
+        anj_dm_res_t def = defs[i];
+        std::size_t pos = i;
+        for (; pos > 0 && out.defs[pos - 1].rid > def.rid; pos--) {
+            out.defs[pos] = out.defs[pos - 1];
+        }
+        out.defs[pos] = def;
+    }
+    for (std::size_t i = 0; i < Count; i++) {
+        const anj_dm_res_t &def = out.defs[i];
+        if (def.rid == ANJ_ID_INVALID) {
+            detail::invalid_definition("invalid Resource ID");
+        }
+        if (i > 0 && out.defs[i - 1].rid == def.rid) {
+            detail::invalid_definition("duplicated Resource ID");
+        }
+        if (def.kind != ANJ_DM_RES_E && !detail::is_valid_type(def.type)) {
+            detail::invalid_definition("invalid Resource data type");
+        }
+    }
+    return out;
+}
+
+/**
+ * Table mapping Resource IDs to indexes of @p Resources, see
+ * @ref anj_dm_obj_inst_t::rid_index. Also finds Resources in the handlers in
+ * constant time.
+ */
+template <const auto &Resources>
+struct rid_dispatch {
+    static_assert(Resources.count <= UINT8_MAX,
+                  "too many Resources for a Resource ID index");
+
+    /** Resource ID related to the first element of @ref table. */
+    static constexpr anj_rid_t first = Resources.defs[0].rid;
+
+    /** Number of elements of @ref table. */
+    static constexpr uint16_t size = static_cast<uint16_t>(
+            Resources.defs[Resources.count - 1].rid - first + 1);
+
+    /**
+     * Index of the Resource with ID <c>first + offset</c> increased by one
+     * at index @c offset, 0 in gaps.
+     */
+    static constexpr detail::rid_index_table<size> table = [] {
+        detail::rid_index_table<size> out{};
+        for (uint16_t i = 0; i < Resources.count; i++) {
+            out.idx[Resources.defs[i].rid - first] =
+                    static_cast<uint8_t>(i + 1);
+        }
+        return out;
+    }();
+
+    /**
+     * Returns the index of the Resource with ID @p rid in
+     * <c>Resources.defs</c>, or -1 if there is no such Resource.
+     */
+    static constexpr int index_of(anj_rid_t rid) {
+        return (rid >= first && rid - first < size)
+                       ? static_cast<int>(table.idx[rid - first]) - 1
+                       : -1;
+    }
+};
+
+/**
+ * Returns the definition of an Object Instance with the Resources built with
+ * @ref make_resources. If @ref ANJ_DM_WITH_RID_INDEX is enabled, the table of
+ * @ref rid_dispatch is used as its @ref anj_dm_obj_inst_t::rid_index.
+ *
+ * @param iid Object Instance ID.
+ */
+template <const auto &Resources>
+constexpr anj_dm_obj_inst_t make_inst(anj_iid_t iid) {
+    anj_dm_obj_inst_t inst{};
+    inst.iid = iid;
+    inst.resources = Resources.defs;
+    inst.res_count = Resources.count;
+#    ifdef ANJ_DM_WITH_RID_INDEX
+    inst.rid_index = rid_dispatch<Resources>::table.idx;
+    inst.rid_index_first = rid_dispatch<Resources>::first;
+    inst.rid_index_size = rid_dispatch<Resources>::size;
+#    endif // ANJ_DM_WITH_RID_INDEX
+    return inst;
+}
+
+/**
+ * Returns the definition of an Object and checks it.
+ *
+ * Evaluated in a constant expression, fails the build if the Object Instances
+ * aren't sorted by their IDs, with unused ones (@ref ANJ_ID_INVALID) at the
+ * end, or if a handler required by any of their Resources is missing.
+ *
+ * @param oid      Object ID.
+ * @param version  Object version, see @ref anj_dm_obj_t::version.
+ * @param handlers Object handlers, must be a constant expression as well.
+ * @param insts    Object Instances.
+ */
+template <std::size_t Count>
+constexpr anj_dm_obj_t make_obj(anj_oid_t oid,
+                                const char *version,
+                                const anj_dm_handlers_t *handlers,
+                                const anj_dm_obj_inst_t (&insts)[Count]) {
+    static_assert(Count < UINT16_MAX, "too many Object Instances");
+    if (!handlers) {
+        detail::invalid_definition("no Object handlers");
+    }
+    for (std::size_t i = 0; i < Count; i++) {
+        const anj_dm_obj_inst_t &inst = insts[i];
+        if (i > 0
+                && (insts[i - 1].iid == ANJ_ID_INVALID
+                        ? inst.iid != ANJ_ID_INVALID
+                        : insts[i - 1].iid >= inst.iid)) {
+            detail::invalid_definition("Object Instances not sorted");
+        }
+        for (uint16_t j = 0; j < inst.res_count; j++) {
+            const anj_dm_res_t &def = inst.resources[j];
+            if ((def.kind == ANJ_DM_RES_E && !handlers->res_execute)
+                    || (detail::is_readable(def.kind) && !handlers->res_read)
+                    || (detail::is_writable(def.kind)
+                        && !handlers->res_write)) {
+                detail::invalid_definition("missing Resource handler");
+            }
+        }
+    }
+    anj_dm_obj_t obj{};
+    obj.oid = oid;
+    obj.version = version;
+    obj.handlers = handlers;
+    obj.insts = insts;
+    obj.max_inst_count = static_cast<uint16_t>(Count);
+    return obj;
+}
+
+} // namespace dm
+} // namespace anj
+
+#endif // ANJ_DM_MODEL_HPP
@@ -35,6 +35,10 @@
 #        include <anj/crypto.h>
 #    endif // ANJ_WITH_SECURITY
 
+#    ifdef ANJ_WITH_RAW_PUBLIC_KEY
+#        include <anj/compat/net/anj_net_api.h>
+#    endif // ANJ_WITH_RAW_PUBLIC_KEY
+
 #    ifdef __cplusplus
 extern "C" {
 #    endif
@@ -77,10 +81,12 @@ typedef struct {
     bool bootstrap_server;
     anj_dm_security_mode_t security_mode;
 #        ifdef ANJ_WITH_SECURITY
+#            ifndef ANJ_SEC_OBJ_WITH_EXTERNAL_KEYS_ONLY
     uint8_t public_key_or_identity_buff
             [ANJ_SEC_OBJ_MAX_PUBLIC_KEY_OR_IDENTITY_SIZE];
     uint8_t server_public_key_buff[ANJ_SEC_OBJ_MAX_SERVER_PUBLIC_KEY_SIZE];
     uint8_t secret_key_buff[ANJ_SEC_OBJ_MAX_SECRET_KEY_SIZE];
+#            endif // ANJ_SEC_OBJ_WITH_EXTERNAL_KEYS_ONLY
     anj_crypto_security_info_t public_key_or_identity;
     anj_crypto_security_info_t server_public_key;
     anj_crypto_security_info_t secret_key;
@@ -155,6 +161,9 @@ typedef struct {
             cache_security_instances[ANJ_DM_SECURITY_OBJ_INSTANCES];
     bool installed;
     anj_iid_t new_instance_iid;
+#        ifdef ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
+    bool dirty;
+#        endif // ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
 } anj_dm_security_obj_t;
 
 /**
@@ -222,6 +231,26 @@ int anj_dm_security_obj_get_psk(const anj_t *anj,
                                 bool bootstrap_credentials,
                                 anj_crypto_security_info_t *out_psk_identity,
                                 anj_crypto_security_info_t *out_psk_key);
+
+#            ifdef ANJ_WITH_RAW_PUBLIC_KEY
+/**
+ * Retrieves the Raw Public Key mode credentials for the specified connection:
+ * Public Key (/0/x/3), Secret Key (/0/x/5) and Server Public Key (/0/x/4).
+ *
+ * @param      anj                   Anjay object to take the Security Object
+ *                                   from.
+ * @param      bootstrap_credentials If true, retrieves credentials for the
+ *                                   Bootstrap Server, otherwise for the regular
+ *                                   LwM2M Server.
+ * @param[out] out_rpk               Output parameter for the credentials.
+ *
+ * @return 0 in case of success, @ref ANJ_DM_ERR_NOT_FOUND if instance not
+ *         found.
+ */
+int anj_dm_security_obj_get_rpk(const anj_t *anj,
+                                bool bootstrap_credentials,
+                                anj_net_rpk_info_t *out_rpk);
+#            endif // ANJ_WITH_RAW_PUBLIC_KEY
 #        endif // ANJ_WITH_SECURITY
 
 #        ifdef ANJ_WITH_PERSISTENCE
@@ -142,6 +142,9 @@ typedef struct {
     anj_dm_server_instance_t server_instance;
     anj_dm_server_instance_t cache_server_instance;
     bool installed;
+#        ifdef ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
+    bool dirty;
+#        endif // ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
 } anj_dm_server_obj_t;
 
 /**
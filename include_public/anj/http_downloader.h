@@ -0,0 +1,351 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+/**
+ * @file
+ * @brief API for downloading resources over HTTP/HTTPS.
+ *
+ * Provides a non-blocking HTTP/1.1 client with the same step/event API as
+ * the CoAP downloader, meant for pulling firmware packages (see
+ * @ref ANJ_FOTA_WITH_HTTP and @ref ANJ_FOTA_WITH_HTTPS). Supports Range
+ * requests, chunked transfer coding and persistent connections. The
+ * transport is provided by the TCP and TLS bindings of the network API.
+ */
+
+#ifndef ANJ_HTTP_DOWNLOADER_H
+#    define ANJ_HTTP_DOWNLOADER_H
+
+#    include <stdbool.h>
+#    include <stddef.h>
+#    include <stdint.h>
+
+#    include <anj/compat/net/anj_net_api.h>
+
+#    include <anj/defs.h>
+#    include <anj/time.h>
+
+#    ifdef __cplusplus
+extern "C" {
+#    endif
+
+#    ifdef ANJ_WITH_HTTP_DOWNLOADER
+
+/** @defgroup anj_http_downloader_errors HTTP downloader error codes.
+ * Error values that may be returned from various callbacks and API of HTTP
+ * downloader module.
+ * @{
+ **/
+
+/**
+ * Error code returned by @ref anj_http_downloader_start when the provided URI
+ * is invalid, or its scheme is not supported by the enabled network bindings.
+ */
+#        define ANJ_HTTP_DOWNLOADER_ERR_INVALID_URI -1
+
+/**
+ * Error code returned by @ref anj_http_downloader_start and
+ * @ref anj_http_downloader_disconnect when a download operation is in
+ * progress.
+ */
+#        define ANJ_HTTP_DOWNLOADER_ERR_IN_PROGRESS -2
+
+/**
+ * Error code returned by @ref anj_http_downloader_init when the provided
+ * configuration is invalid or by @ref anj_http_downloader_start when the URI
+ * indicates HTTPS, and no @c net_config is provided.
+ */
+#        define ANJ_HTTP_DOWNLOADER_ERR_INVALID_CONFIGURATION -3
+
+/**
+ * Error code returned by @ref anj_http_downloader_get_error when the download
+ * process was explicitly terminated by the user.
+ */
+#        define ANJ_HTTP_DOWNLOADER_ERR_TERMINATED -4
+
+/**
+ * Error code returned by @ref anj_http_downloader_get_error when a
+ * network-related issue occurred during the download process, and the
+ * download could not be resumed.
+ */
+#        define ANJ_HTTP_DOWNLOADER_ERR_NETWORK -5
+
+/**
+ * Error code returned by @ref anj_http_downloader_get_error when the server
+ * response was malformed, did not fit in
+ * @ref ANJ_HTTP_DOWNLOADER_BUFFER_SIZE, or its status code was other than
+ * 200 (OK) or 206 (Partial Content). The status code can be retrieved with
+ * @ref anj_http_downloader_get_http_status.
+ */
+#        define ANJ_HTTP_DOWNLOADER_ERR_INVALID_RESPONSE -6
+
+/**
+ * Error code returned by @ref anj_http_downloader_get_error when no data was
+ * received from the server for
+ * @ref anj_http_downloader_configuration_t::timeout.
+ */
+#        define ANJ_HTTP_DOWNLOADER_ERR_TIMEOUT -7
+
+/**
+ * Error code returned by @ref anj_http_downloader_get_error when the resource
+ * changed on the server while the download was being resumed, so the data
+ * already passed to the event callback is no longer valid.
+ */
+#        define ANJ_HTTP_DOWNLOADER_ERR_ETAG_MISMATCH -8
+
+/**@}*/
+
+/**
+ * This enum represents the possible states of a HTTP Downloader module.
+ */
+typedef enum {
+    /**
+     * Initial state of the module after startup.
+     *
+     * Start new download by calling @ref anj_http_downloader_start.
+     */
+    ANJ_HTTP_DOWNLOADER_STATUS_INITIAL,
+
+    /**
+     * A connection to the server is being established, or an idle one is
+     * being reused. The request is sent once the connection is ready.
+     */
+    ANJ_HTTP_DOWNLOADER_STATUS_STARTING,
+
+    /**
+     * A new chunk of data is being downloaded. This status will be reported via
+     * callback for each chunk of the response body.
+     */
+    ANJ_HTTP_DOWNLOADER_STATUS_DOWNLOADING,
+
+    /**
+     * The whole response has been received or error occurred. Connection is
+     * being closed, unless it is kept alive.
+     */
+    ANJ_HTTP_DOWNLOADER_STATUS_FINISHING,
+
+    /**
+     * The download process has finished successfully.
+     */
+    ANJ_HTTP_DOWNLOADER_STATUS_FINISHED,
+
+    /**
+     * The download process has finished due to an error. Call
+     * @ref anj_http_downloader_get_error to retrieve error details.
+     */
+    ANJ_HTTP_DOWNLOADER_STATUS_FAILED,
+} anj_http_downloader_status_t;
+
+/**
+ * Callback type for HTTP downloader events.
+ *
+ * When the status is @ref ANJ_HTTP_DOWNLOADER_STATUS_DOWNLOADING,
+ * the callback will also provide the received data chunk. Chunks are passed
+ * in order and without the transfer coding. For all other statuses, @p data
+ * will be @c NULL and @p data_len will be 0.
+ *
+ * @param arg             Opaque user argument passed to the callback.
+ * @param http_downloader HTTP downloader object reporting the status change.
+ * @param conn_status     Current connection status value; see @ref
+ *                        anj_http_downloader_status_t.
+ * @param data            Pointer to the received data, if applicable.
+ * @param data_len        Length of the received data, if applicable.
+ */
+typedef void
+anj_http_downloader_event_callback_t(void *arg,
+                                     anj_http_downloader_t *http_downloader,
+                                     anj_http_downloader_status_t conn_status,
+                                     const uint8_t *data,
+                                     size_t data_len);
+
+/**
+ * HTTP downloader configuration structure. Should be filled before passing to
+ * @ref anj_http_downloader_init.
+ */
+typedef struct anj_http_downloader_configuration_struct {
+    /**
+     * Mandatory callback for monitoring HTTP downloader status changes.
+     *
+     * This callback will be invoked for each status change of the HTTP
+     * downloader, and for each received chunk of data.
+     */
+    anj_http_downloader_event_callback_t *event_cb;
+
+    /**
+     * Opaque argument that will be passed to the function configured in the
+     * @ref event_cb field.
+     */
+    void *event_cb_arg;
+
+    /**
+     * Maximum time without any data received from the server, after which
+     * the download fails with @ref ANJ_HTTP_DOWNLOADER_ERR_TIMEOUT. If not
+     * valid or zero, 30 seconds is used.
+     */
+    anj_time_duration_t timeout;
+
+    /**
+     * Number of times the download is resumed with a Range request after the
+     * connection breaks. The download is resumed only if the server reported
+     * an ETag, so that it can verify the resource is still the same.
+     */
+    uint8_t max_resume_attempts;
+
+    /**
+     * If @c true, the connection is left open after a successful download,
+     * unless the server asked to close it, and reused by the next download
+     * from the same host. It is closed by @ref anj_http_downloader_disconnect
+     * or when a download from another host is started.
+     */
+    bool keep_alive;
+} anj_http_downloader_configuration_t;
+
+/**
+ * Initializes HTTP downloader internal state variable.
+ *
+ * @param http_downloader Pointer to a variable that will hold the state of
+ *                        HTTP downloader.
+ * @param config          Configuration structure for the HTTP downloader.
+ *                        It is copied internally.
+ *
+ * @return 0 on success, a non-zero value in case of an error.
+ */
+int anj_http_downloader_init(anj_http_downloader_t *http_downloader,
+                             const anj_http_downloader_configuration_t *config);
+
+/**
+ * Main step function of the Anjay Lite HTTP downloader module.
+ *
+ * This function should be called regularly in the main application loop. It
+ * drives the internal state machine, and reads all the data available on the
+ * socket.
+ *
+ * This function is non-blocking, unless a custom network implementation
+ * introduces blocking behavior.
+ *
+ * @param http_downloader HTTP downloader state.
+ */
+void anj_http_downloader_step(anj_http_downloader_t *http_downloader);
+
+/**
+ * Returns the time until the next call to @ref anj_http_downloader_step is
+ * required.
+ *
+ * While a download is being started, performed or finished,
+ * @ref ANJ_TIME_DURATION_ZERO is returned, as the data is received by polling
+ * the socket in @ref anj_http_downloader_step. The same value is returned if
+ * the status change has not been reported to the event callback yet.
+ * Otherwise @ref ANJ_TIME_DURATION_INVALID is returned.
+ *
+ * @param http_downloader HTTP downloader state.
+ *
+ * @return @ref anj_time_duration_t until the next
+ *         @ref anj_http_downloader_step is required.
+ */
+anj_time_duration_t
+anj_http_downloader_next_step_time(anj_http_downloader_t *http_downloader);
+
+/**
+ * Starts a new download operation.
+ *
+ * If @p offset is not 0, a Range request is sent and the data passed to the
+ * event callback begins at @p offset, e.g. to continue a download interrupted
+ * by a reboot. If the server does not support Range requests, the data
+ * before @p offset is received, but not passed to the callback.
+ *
+ * @warning The URI is not copied or stored internally by the HTTP downloader,
+ *          so the pointer must remain valid throughout the entire download
+ *          process.
+ *
+ * @param http_downloader HTTP downloader state.
+ * @param uri             @c http:// or @c https:// URI of the resource to
+ *                        download. The string must be null-terminated.
+ * @param offset          Offset in the resource to start the download from.
+ * @param net_config      Optional network configuration to use for the
+ *                        connection. Can be @c NULL for plain HTTP. It is
+ *                        copied internally.
+ *
+ * @return 0 on success,
+ *         @ref ANJ_HTTP_DOWNLOADER_ERR_INVALID_URI if the provided URI is
+ *         invalid or unsupported.
+ *         @ref ANJ_HTTP_DOWNLOADER_ERR_IN_PROGRESS if a download is already
+ *         in progress.
+ *         @ref ANJ_HTTP_DOWNLOADER_ERR_INVALID_CONFIGURATION if provided
+ *         @p net_config is @c NULL while @p uri indicates HTTPS.
+ */
+int anj_http_downloader_start(anj_http_downloader_t *http_downloader,
+                              const char *uri,
+                              size_t offset,
+                              const anj_net_config_t *net_config);
+
+/**
+ * Terminates the current download operation.
+ *
+ * It has effect only when the downloader is in the
+ * @ref ANJ_HTTP_DOWNLOADER_STATUS_STARTING or
+ * @ref ANJ_HTTP_DOWNLOADER_STATUS_DOWNLOADING state. The connection is
+ * closed in subsequent calls to @ref anj_http_downloader_step, and the final
+ * status is @ref ANJ_HTTP_DOWNLOADER_STATUS_FAILED with
+ * @ref ANJ_HTTP_DOWNLOADER_ERR_TERMINATED error.
+ *
+ * @param http_downloader HTTP downloader state.
+ */
+void anj_http_downloader_terminate(anj_http_downloader_t *http_downloader);
+
+/**
+ * Closes the connection kept alive after the last download, see
+ * @ref anj_http_downloader_configuration_t::keep_alive.
+ *
+ * @param http_downloader HTTP downloader state.
+ *
+ * @return 0 on success or if there is no connection to close,
+ *         @ref ANJ_HTTP_DOWNLOADER_ERR_IN_PROGRESS if a download is in
+ *         progress, @ref ANJ_NET_EINPROGRESS if the function has to be called
+ *         again to complete the operation, other non-zero value in case of a
+ *         network error.
+ */
+int anj_http_downloader_disconnect(anj_http_downloader_t *http_downloader);
+
+/**
+ * Retrieves the error code from the last failed download operation.
+ *
+ * This function must be called only when the downloader's status is
+ * @ref ANJ_HTTP_DOWNLOADER_STATUS_FAILED.
+ *
+ * @param http_downloader HTTP downloader state.
+ *
+ * @return Error code indicating the reason for the failure. For possible return
+ *         values, see @ref anj_http_downloader_errors
+ */
+int anj_http_downloader_get_error(anj_http_downloader_t *http_downloader);
+
+/**
+ * Returns the status code of the last response received from the server.
+ *
+ * @param http_downloader HTTP downloader state.
+ *
+ * @return HTTP status code, or 0 if no response has been received.
+ */
+uint16_t
+anj_http_downloader_get_http_status(anj_http_downloader_t *http_downloader);
+
+/** @cond */
+#        define ANJ_INTERNAL_INCLUDE_HTTP_DOWNLOADER
+#        include <anj_internal/http_downloader.h>
+#        undef ANJ_INTERNAL_INCLUDE_HTTP_DOWNLOADER
+/** @endcond */
+
+#    endif // ANJ_WITH_HTTP_DOWNLOADER
+
+#    ifdef __cplusplus
+}
+#    endif
+
+#endif // ANJ_HTTP_DOWNLOADER_H
@@ -37,14 +37,299 @@ extern "C" {
 #endif // !defined(ANJ_NET_WITH_UDP) && !defined(ANJ_NET_WITH_DTLS) &&
        // !defined(ANJ_NET_WITH_NON_IP_BINDING)
 
+#if defined(ANJ_NET_WITH_SEND_VEC) && !defined(ANJ_NET_WITH_UDP) \
+        && !defined(ANJ_NET_WITH_NON_IP_BINDING)
+#    error "ANJ_NET_WITH_SEND_VEC requires ANJ_NET_WITH_UDP or ANJ_NET_WITH_NON_IP_BINDING"
+#endif // defined(ANJ_NET_WITH_SEND_VEC) && !defined(ANJ_NET_WITH_UDP) &&
+       // !defined(ANJ_NET_WITH_NON_IP_BINDING)
+
+#if (defined(ANJ_NET_WITH_TCP) || defined(ANJ_NET_WITH_TLS)) \
+        && !defined(ANJ_WITH_HTTP_DOWNLOADER)
+#    error "ANJ_NET_WITH_TCP and ANJ_NET_WITH_TLS require ANJ_WITH_HTTP_DOWNLOADER"
+#endif // (defined(ANJ_NET_WITH_TCP) || defined(ANJ_NET_WITH_TLS)) &&
+       // !defined(ANJ_WITH_HTTP_DOWNLOADER)
+
+#if defined(ANJ_NET_WITH_BATCH_IO) && !defined(ANJ_NET_WITH_UDP)
+#    error "ANJ_NET_WITH_BATCH_IO requires ANJ_NET_WITH_UDP"
+#endif // defined(ANJ_NET_WITH_BATCH_IO) && !defined(ANJ_NET_WITH_UDP)
+
+#if (defined(ANJ_NET_WITH_ASYNC_RESOLVE)     \
+     || defined(ANJ_NET_WITH_RESOLVE_CACHE)) \
+        && !defined(ANJ_WITH_SOCKET_POSIX_COMPAT)
+#    error "ANJ_NET_WITH_ASYNC_RESOLVE and ANJ_NET_WITH_RESOLVE_CACHE require ANJ_WITH_SOCKET_POSIX_COMPAT"
+#endif // (defined(ANJ_NET_WITH_ASYNC_RESOLVE) ||
+       // defined(ANJ_NET_WITH_RESOLVE_CACHE)) &&
+       // !defined(ANJ_WITH_SOCKET_POSIX_COMPAT)
+
+#if defined(ANJ_NET_WITH_RESOLVE_CACHE)       \
+        && (ANJ_NET_RESOLVE_CACHE_ENTRIES <= 0 \
+            || ANJ_NET_RESOLVE_CACHE_TTL_S <= 0)
+#    error "if resolve cache is enabled, ANJ_NET_RESOLVE_CACHE_ENTRIES and ANJ_NET_RESOLVE_CACHE_TTL_S have to be greater than 0"
+#endif // defined(ANJ_NET_WITH_RESOLVE_CACHE) &&
+       // (ANJ_NET_RESOLVE_CACHE_ENTRIES <= 0 ||
+       // ANJ_NET_RESOLVE_CACHE_TTL_S <= 0)
+
+#if defined(ANJ_NET_WITH_HAPPY_EYEBALLS)             \
+        && (!defined(ANJ_WITH_SOCKET_POSIX_COMPAT) \
+            || !defined(ANJ_NET_WITH_IPV4) || !defined(ANJ_NET_WITH_IPV6))
+#    error "ANJ_NET_WITH_HAPPY_EYEBALLS requires ANJ_WITH_SOCKET_POSIX_COMPAT, ANJ_NET_WITH_IPV4 and ANJ_NET_WITH_IPV6"
+#endif // defined(ANJ_NET_WITH_HAPPY_EYEBALLS) &&
+       // (!defined(ANJ_WITH_SOCKET_POSIX_COMPAT) ||
+       // !defined(ANJ_NET_WITH_IPV4) || !defined(ANJ_NET_WITH_IPV6))
+
+#if defined(ANJ_NET_WITH_HAPPY_EYEBALLS) \
+        && ANJ_NET_HAPPY_EYEBALLS_CACHE_ENTRIES <= 0
+#    error "if happy eyeballs are enabled, ANJ_NET_HAPPY_EYEBALLS_CACHE_ENTRIES has to be greater than 0"
+#endif // defined(ANJ_NET_WITH_HAPPY_EYEBALLS) &&
+       // ANJ_NET_HAPPY_EYEBALLS_CACHE_ENTRIES <= 0
+
+#if defined(ANJ_WITH_BUDGETED_STEP) && !defined(ANJ_NET_WITH_POLL_HANDLE)
+#    error "ANJ_WITH_BUDGETED_STEP requires ANJ_NET_WITH_POLL_HANDLE"
+#endif // defined(ANJ_WITH_BUDGETED_STEP) && !defined(ANJ_NET_WITH_POLL_HANDLE)
+
+#if defined(ANJ_NET_WITH_IO_THREAD)               \
+        && (!defined(ANJ_WITH_SOCKET_POSIX_COMPAT) \
+            || !defined(ANJ_NET_WITH_POLL_HANDLE))
+#    error "ANJ_NET_WITH_IO_THREAD requires ANJ_WITH_SOCKET_POSIX_COMPAT and ANJ_NET_WITH_POLL_HANDLE"
+#endif // defined(ANJ_NET_WITH_IO_THREAD) &&
+       // (!defined(ANJ_WITH_SOCKET_POSIX_COMPAT) ||
+       // !defined(ANJ_NET_WITH_POLL_HANDLE))
+
+#if defined(ANJ_NET_WITH_IO_THREAD)            \
+        && (ANJ_NET_IO_THREAD_QUEUE_SIZE <= 0 \
+            || ANJ_NET_IO_THREAD_DATAGRAM_SIZE <= 0)
+#    error "if I/O thread is enabled, ANJ_NET_IO_THREAD_QUEUE_SIZE and ANJ_NET_IO_THREAD_DATAGRAM_SIZE have to be greater than 0"
+#endif // defined(ANJ_NET_WITH_IO_THREAD) &&
+       // (ANJ_NET_IO_THREAD_QUEUE_SIZE <= 0 ||
+       // ANJ_NET_IO_THREAD_DATAGRAM_SIZE <= 0)
+
+#if defined(ANJ_WITH_MSG_BUFFER_POOL) && !defined(ANJ_WITH_MSG_BUFFER_ARENA)
+#    error "ANJ_WITH_MSG_BUFFER_POOL requires ANJ_WITH_MSG_BUFFER_ARENA"
+#endif // defined(ANJ_WITH_MSG_BUFFER_POOL) &&
+       // !defined(ANJ_WITH_MSG_BUFFER_ARENA)
+
 #if defined(ANJ_WITH_CACHE) && ANJ_CACHE_ENTRIES_NUMBER <= 0
 #    error "if response caching is enabled, number of cached entries has to be greater than 0"
 #endif // defined(ANJ_WITH_CACHE) && ANJ_CACHE_ENTRIES_NUMBER <= 0
 
+#ifdef ANJ_CACHE_WITH_FULL_ENTRIES
+#    if !defined(ANJ_WITH_CACHE) || ANJ_CACHE_ENTRIES_NUMBER <= 1
+#        error "caching of multiple responses requires ANJ_WITH_CACHE and ANJ_CACHE_ENTRIES_NUMBER greater than 1"
+#    endif // !defined(ANJ_WITH_CACHE) || ANJ_CACHE_ENTRIES_NUMBER <= 1
+#    if !defined(ANJ_CACHE_FULL_ENTRIES_NUMBER) \
+            || ANJ_CACHE_FULL_ENTRIES_NUMBER < 2 \
+            || ANJ_CACHE_FULL_ENTRIES_NUMBER > ANJ_CACHE_ENTRIES_NUMBER
+#        error "ANJ_CACHE_FULL_ENTRIES_NUMBER has to be between 2 and ANJ_CACHE_ENTRIES_NUMBER"
+#    endif // !defined(ANJ_CACHE_FULL_ENTRIES_NUMBER) ||
+           // ANJ_CACHE_FULL_ENTRIES_NUMBER < 2 ||
+           // ANJ_CACHE_FULL_ENTRIES_NUMBER > ANJ_CACHE_ENTRIES_NUMBER
+#    if !defined(ANJ_CACHE_PAYLOAD_ARENA_SIZE) \
+            || ANJ_CACHE_PAYLOAD_ARENA_SIZE <= 0
+#        error "if caching of multiple responses is enabled, ANJ_CACHE_PAYLOAD_ARENA_SIZE has to be greater than 0"
+#    endif // !defined(ANJ_CACHE_PAYLOAD_ARENA_SIZE) ||
+           // ANJ_CACHE_PAYLOAD_ARENA_SIZE <= 0
+#endif // ANJ_CACHE_WITH_FULL_ENTRIES
+
+#if defined(ANJ_WITH_ENCODED_RETRANSMISSIONS)  \
+        && (defined(ANJ_CACHE_WITH_FULL_ENTRIES) \
+            || defined(ANJ_WITH_MSG_BUFFER_ARENA))
+#    error "ANJ_WITH_ENCODED_RETRANSMISSIONS can't be used with ANJ_CACHE_WITH_FULL_ENTRIES or ANJ_WITH_MSG_BUFFER_ARENA"
+#endif // defined(ANJ_WITH_ENCODED_RETRANSMISSIONS) &&
+       // (defined(ANJ_CACHE_WITH_FULL_ENTRIES) ||
+       // defined(ANJ_WITH_MSG_BUFFER_ARENA))
+
+#if defined(ANJ_WITH_ADAPTIVE_BLOCK_SIZE)                  \
+        && (!defined(ANJ_ADAPTIVE_BLOCK_SIZE_GROWTH_THRESHOLD) \
+            || ANJ_ADAPTIVE_BLOCK_SIZE_GROWTH_THRESHOLD <= 0   \
+            || ANJ_ADAPTIVE_BLOCK_SIZE_GROWTH_THRESHOLD > 255)
+#    error "ANJ_ADAPTIVE_BLOCK_SIZE_GROWTH_THRESHOLD has to be between 1 and 255"
+#endif // defined(ANJ_WITH_ADAPTIVE_BLOCK_SIZE) &&
+       // (!defined(ANJ_ADAPTIVE_BLOCK_SIZE_GROWTH_THRESHOLD) ||
+       // ANJ_ADAPTIVE_BLOCK_SIZE_GROWTH_THRESHOLD <= 0 ||
+       // ANJ_ADAPTIVE_BLOCK_SIZE_GROWTH_THRESHOLD > 255)
+
+#if defined(ANJ_WITH_ADAPTIVE_RTO) \
+        && (!defined(ANJ_ADAPTIVE_RTO_MIN_MS) || ANJ_ADAPTIVE_RTO_MIN_MS <= 0)
+#    error "ANJ_ADAPTIVE_RTO_MIN_MS has to be greater than 0"
+#endif // defined(ANJ_WITH_ADAPTIVE_RTO) && (!defined(ANJ_ADAPTIVE_RTO_MIN_MS)
+       // || ANJ_ADAPTIVE_RTO_MIN_MS <= 0)
+
+#if !defined(ANJ_COAP_TOKEN_SIZE) || ANJ_COAP_TOKEN_SIZE < 0 \
+        || ANJ_COAP_TOKEN_SIZE > 8
+#    error "ANJ_COAP_TOKEN_SIZE has to be between 0 and 8"
+#endif // !defined(ANJ_COAP_TOKEN_SIZE) || ANJ_COAP_TOKEN_SIZE < 0 ||
+       // ANJ_COAP_TOKEN_SIZE > 8
+
+#ifdef ANJ_DM_WITH_CHANGE_QUEUE
+#    if !defined(__GNUC__)
+#        error "ANJ_DM_WITH_CHANGE_QUEUE requires a compiler with GCC __atomic builtins"
+#    endif // !defined(__GNUC__)
+#    if !defined(ANJ_DM_CHANGE_QUEUE_SIZE) || ANJ_DM_CHANGE_QUEUE_SIZE <= 0 \
+            || (ANJ_DM_CHANGE_QUEUE_SIZE & (ANJ_DM_CHANGE_QUEUE_SIZE - 1)) != 0
+#        error "ANJ_DM_CHANGE_QUEUE_SIZE has to be a power of 2"
+#    endif // !defined(ANJ_DM_CHANGE_QUEUE_SIZE) ||
+           // ANJ_DM_CHANGE_QUEUE_SIZE <= 0 ||
+           // (ANJ_DM_CHANGE_QUEUE_SIZE & (ANJ_DM_CHANGE_QUEUE_SIZE - 1)) != 0
+#endif // ANJ_DM_WITH_CHANGE_QUEUE
+
+#if defined(ANJ_WITH_BOOTSTRAP_WRITE_BATCHING) && !defined(ANJ_WITH_BOOTSTRAP)
+#    error "ANJ_WITH_BOOTSTRAP_WRITE_BATCHING requires ANJ_WITH_BOOTSTRAP"
+#endif // defined(ANJ_WITH_BOOTSTRAP_WRITE_BATCHING) &&
+       // !defined(ANJ_WITH_BOOTSTRAP)
+
+#if defined(ANJ_WITH_BOOTSTRAP_PACK)                                  \
+        && (!defined(ANJ_WITH_BOOTSTRAP) || !defined(ANJ_WITH_LWM2M12) \
+            || !defined(ANJ_WITH_SENML_CBOR))
+#    error "ANJ_WITH_BOOTSTRAP_PACK requires ANJ_WITH_BOOTSTRAP, ANJ_WITH_LWM2M12 and ANJ_WITH_SENML_CBOR"
+#endif // defined(ANJ_WITH_BOOTSTRAP_PACK) && (!defined(ANJ_WITH_BOOTSTRAP) ||
+       // !defined(ANJ_WITH_LWM2M12) || !defined(ANJ_WITH_SENML_CBOR))
+
+#if defined(ANJ_WITH_PIPELINED_NOTIFICATIONS) && !defined(ANJ_WITH_OBSERVE)
+#    error "ANJ_WITH_PIPELINED_NOTIFICATIONS requires ANJ_WITH_OBSERVE"
+#endif // defined(ANJ_WITH_PIPELINED_NOTIFICATIONS) && !defined(ANJ_WITH_OBSERVE)
+
+#ifdef ANJ_WITH_PIPELINED_NOTIFICATIONS
+#    if !defined(ANJ_PIPELINED_NOTIFICATIONS_NSTART) \
+            || ANJ_PIPELINED_NOTIFICATIONS_NSTART < 2
+#        error "ANJ_PIPELINED_NOTIFICATIONS_NSTART has to be at least 2"
+#    endif // !defined(ANJ_PIPELINED_NOTIFICATIONS_NSTART) ||
+           // ANJ_PIPELINED_NOTIFICATIONS_NSTART < 2
+#endif // ANJ_WITH_PIPELINED_NOTIFICATIONS
+
+#if defined(ANJ_WITH_INTERLEAVED_NOTIFICATIONS) \
+        && !defined(ANJ_WITH_PIPELINED_NOTIFICATIONS)
+#    error "ANJ_WITH_INTERLEAVED_NOTIFICATIONS requires ANJ_WITH_PIPELINED_NOTIFICATIONS"
+#endif // defined(ANJ_WITH_INTERLEAVED_NOTIFICATIONS) &&
+       // !defined(ANJ_WITH_PIPELINED_NOTIFICATIONS)
+
 #if defined(ANJ_WITH_RST_AS_CANCEL_OBSERVE) && !defined(ANJ_WITH_OBSERVE)
 #    error "RST as Cancel Observe only makes sense when Observations are supported"
 #endif // defined(ANJ_WITH_RST_AS_CANCEL_OBSERVE) && !defined(ANJ_WITH_OBSERVE)
 
+#if defined(ANJ_OBSERVE_WITH_DEADLINE_INDEX) && !defined(ANJ_WITH_OBSERVE)
+#    error "Observation deadline index only makes sense when Observations are supported"
+#endif // defined(ANJ_OBSERVE_WITH_DEADLINE_INDEX) && !defined(ANJ_WITH_OBSERVE)
+
+#if defined(ANJ_WITH_NEXT_STEP_TIME_CACHE) && !defined(ANJ_WITH_OBSERVE)
+#    error "Next step time cache only makes sense when Observations are supported"
+#endif // defined(ANJ_WITH_NEXT_STEP_TIME_CACHE) && !defined(ANJ_WITH_OBSERVE)
+
+#if defined(ANJ_OBSERVE_WITH_PATH_INDEX) && !defined(ANJ_WITH_OBSERVE)
+#    error "Observation path index only makes sense when Observations are supported"
+#endif // defined(ANJ_OBSERVE_WITH_PATH_INDEX) && !defined(ANJ_WITH_OBSERVE)
+
+#if defined(ANJ_OBSERVE_WITH_STATE_ARRAYS) && !defined(ANJ_WITH_OBSERVE)
+#    error "Observation state arrays only make sense when Observations are supported"
+#endif // defined(ANJ_OBSERVE_WITH_STATE_ARRAYS) && !defined(ANJ_WITH_OBSERVE)
+
+#if defined(ANJ_OBSERVE_WITH_TOKEN_INDEX) && !defined(ANJ_WITH_OBSERVE)
+#    error "Observation token index only makes sense when Observations are supported"
+#endif // defined(ANJ_OBSERVE_WITH_TOKEN_INDEX) && !defined(ANJ_WITH_OBSERVE)
+
+#ifdef ANJ_OBSERVE_WITH_NOTIFICATION_COALESCING
+#    ifndef ANJ_WITH_OBSERVE
+#        error "Notification coalescing only makes sense when Observations are supported"
+#    endif // ANJ_WITH_OBSERVE
+#    ifndef ANJ_OBSERVE_NOTIFICATION_COALESCING_WINDOW_S
+#        error "if notification coalescing is enabled, its window has to be defined"
+#    endif // ANJ_OBSERVE_NOTIFICATION_COALESCING_WINDOW_S
+#endif // ANJ_OBSERVE_WITH_NOTIFICATION_COALESCING
+
+#if defined(ANJ_OBSERVE_NOTIFICATION_ALIGNMENT_TICK_S) \
+        && !defined(ANJ_WITH_OBSERVE)
+#    error "Notification alignment only makes sense when Observations are supported"
+#endif // defined(ANJ_OBSERVE_NOTIFICATION_ALIGNMENT_TICK_S) &&
+       // !defined(ANJ_WITH_OBSERVE)
+
+#ifdef ANJ_OBSERVE_WITH_CON_POLICY
+#    ifndef ANJ_WITH_OBSERVE
+#        error "Confirmable notification policy only makes sense when Observations are supported"
+#    endif // ANJ_WITH_OBSERVE
+#    if !defined(ANJ_OBSERVE_CON_POLICY_EVERY_N) \
+            || ANJ_OBSERVE_CON_POLICY_EVERY_N < 0 \
+            || ANJ_OBSERVE_CON_POLICY_EVERY_N > 65535
+#        error "ANJ_OBSERVE_CON_POLICY_EVERY_N has to be between 0 and 65535"
+#    endif // !defined(ANJ_OBSERVE_CON_POLICY_EVERY_N) ||
+           // ANJ_OBSERVE_CON_POLICY_EVERY_N < 0 ||
+           // ANJ_OBSERVE_CON_POLICY_EVERY_N > 65535
+#    if !defined(ANJ_OBSERVE_CON_POLICY_MAX_INTERVAL_S) \
+            || ANJ_OBSERVE_CON_POLICY_MAX_INTERVAL_S <= 0
+#        error "ANJ_OBSERVE_CON_POLICY_MAX_INTERVAL_S has to be greater than 0"
+#    endif // !defined(ANJ_OBSERVE_CON_POLICY_MAX_INTERVAL_S) ||
+           // ANJ_OBSERVE_CON_POLICY_MAX_INTERVAL_S <= 0
+#endif // ANJ_OBSERVE_WITH_CON_POLICY
+
+#if defined(ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER)                   \
+        && (!defined(ANJ_WITH_OBSERVE) || !defined(ANJ_WITH_LWM2M_SEND) \
+            || !defined(ANJ_WITH_SENML_CBOR))
+#    error "Notify store buffer requires Observations, LwM2M Send and SenML CBOR to be enabled"
+#endif // defined(ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER) &&
+       // (!defined(ANJ_WITH_OBSERVE) || !defined(ANJ_WITH_LWM2M_SEND) ||
+       // !defined(ANJ_WITH_SENML_CBOR))
+
+#if defined(ANJ_OBSERVE_WITH_VALUE_CACHE) && !defined(ANJ_WITH_OBSERVE)
+#    error "Observation value cache only makes sense when Observations are supported"
+#endif // defined(ANJ_OBSERVE_WITH_VALUE_CACHE) && !defined(ANJ_WITH_OBSERVE)
+
+#if defined(ANJ_OBSERVE_WITH_COMPOSITE_DELTA_NOTIFICATIONS) \
+        && !defined(ANJ_WITH_OBSERVE_COMPOSITE)
+#    error "Delta notifications only make sense when Observe-Composite is supported"
+#endif // defined(ANJ_OBSERVE_WITH_COMPOSITE_DELTA_NOTIFICATIONS) &&
+       // !defined(ANJ_WITH_OBSERVE_COMPOSITE)
+
+#if defined(ANJ_OBSERVE_WITH_INTEGER_THRESHOLDS) && !defined(ANJ_WITH_OBSERVE)
+#    error "Integer thresholds only make sense when Observations are supported"
+#endif // defined(ANJ_OBSERVE_WITH_INTEGER_THRESHOLDS) &&
+       // !defined(ANJ_WITH_OBSERVE)
+
+#if defined(ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX) && !defined(ANJ_WITH_OBSERVE)
+#    error "Attribute storage index only makes sense when Observations are supported"
+#endif // defined(ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX) &&
+       // !defined(ANJ_WITH_OBSERVE)
+
+#ifdef ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+#    if !defined(ANJ_WITH_OBSERVE) || !defined(ANJ_WITH_LWM2M12) \
+            || !defined(ANJ_WITH_SENML_CBOR)
+#        error "Historical queue requires Observations, LwM2M 1.2 and SenML CBOR to be enabled"
+#    endif // !defined(ANJ_WITH_OBSERVE) || !defined(ANJ_WITH_LWM2M12) ||
+           // !defined(ANJ_WITH_SENML_CBOR)
+#    if !defined(ANJ_OBSERVE_HISTORICAL_QUEUE_BUFFER_SIZE)  \
+            || ANJ_OBSERVE_HISTORICAL_QUEUE_BUFFER_SIZE < 1 \
+            || ANJ_OBSERVE_HISTORICAL_QUEUE_BUFFER_SIZE > 65535
+#        error "if historical queue is enabled, its buffer size has to be between 1 and 65535"
+#    endif // !defined(ANJ_OBSERVE_HISTORICAL_QUEUE_BUFFER_SIZE) ||
+           // ANJ_OBSERVE_HISTORICAL_QUEUE_BUFFER_SIZE < 1 ||
+           // ANJ_OBSERVE_HISTORICAL_QUEUE_BUFFER_SIZE > 65535
+#endif // ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+
+#if defined(ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS) \
+        && (!defined(ANJ_WITH_OBSERVE) || !defined(ANJ_WITH_ETAG))
+#    error "Valid notifications require Observations and ETag to be enabled"
+#endif // defined(ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS) &&
+       // (!defined(ANJ_WITH_OBSERVE) || !defined(ANJ_WITH_ETAG))
+
+#ifdef ANJ_DM_WITH_PATH_HANDLES
+#    if !defined(ANJ_DM_PATH_HANDLE_CACHE_SIZE) \
+            || ANJ_DM_PATH_HANDLE_CACHE_SIZE < 1
+#        error "if path handles are enabled, the cache size has to be at least 1"
+#    endif // !defined(ANJ_DM_PATH_HANDLE_CACHE_SIZE) ||
+           // ANJ_DM_PATH_HANDLE_CACHE_SIZE < 1
+#endif // ANJ_DM_WITH_PATH_HANDLES
+
+#ifdef ANJ_DM_WITH_REGISTER_PAYLOAD_CACHE
+#    if !defined(ANJ_DM_REGISTER_PAYLOAD_CACHE_SIZE) \
+            || ANJ_DM_REGISTER_PAYLOAD_CACHE_SIZE < 1
+#        error "if Register payload cache is enabled, its size has to be at least 1"
+#    endif // !defined(ANJ_DM_REGISTER_PAYLOAD_CACHE_SIZE) ||
+           // ANJ_DM_REGISTER_PAYLOAD_CACHE_SIZE < 1
+#endif // ANJ_DM_WITH_REGISTER_PAYLOAD_CACHE
+
+#ifdef ANJ_DM_WITH_READ_CACHE
+#    if !defined(ANJ_DM_READ_CACHE_SIZE) || ANJ_DM_READ_CACHE_SIZE < 1
+#        error "if read cache is enabled, its size has to be at least 1"
+#    endif // !defined(ANJ_DM_READ_CACHE_SIZE) || ANJ_DM_READ_CACHE_SIZE < 1
+#endif // ANJ_DM_WITH_READ_CACHE
+
 #if defined(ANJ_WITH_LWM2M_CBOR) && !defined(ANJ_WITH_LWM2M12)
 #    error "ANJ_WITH_LWM2M_CBOR requires ANJ_WITH_LWM2M12 enabled"
 #endif // defined(ANJ_WITH_LWM2M_CBOR) && !defined(ANJ_WITH_LWM2M12)
@@ -53,6 +338,46 @@ extern "C" {
 #    error "At least one of ANJ_WITH_SENML_CBOR or ANJ_WITH_LWM2M_CBOR must be enabled."
 #endif // !defined(ANJ_WITH_SENML_CBOR) && !defined(ANJ_WITH_LWM2M_CBOR)
 
+#if defined(ANJ_WITH_BASE64_FAST_PATH) && !defined(ANJ_WITH_PLAINTEXT)
+#    error "ANJ_WITH_BASE64_FAST_PATH requires ANJ_WITH_PLAINTEXT enabled"
+#endif // defined(ANJ_WITH_BASE64_FAST_PATH) && !defined(ANJ_WITH_PLAINTEXT)
+
+#if defined(ANJ_WITH_SENML_CBOR_DYNAMIC_BASE_NAME) \
+        && !defined(ANJ_WITH_SENML_CBOR)
+#    error "ANJ_WITH_SENML_CBOR_DYNAMIC_BASE_NAME requires ANJ_WITH_SENML_CBOR enabled"
+#endif // defined(ANJ_WITH_SENML_CBOR_DYNAMIC_BASE_NAME) &&
+       // !defined(ANJ_WITH_SENML_CBOR)
+
+#if defined(ANJ_WITH_SENML_CBOR_RELATIVE_TIME) && !defined(ANJ_WITH_SENML_CBOR)
+#    error "ANJ_WITH_SENML_CBOR_RELATIVE_TIME requires ANJ_WITH_SENML_CBOR enabled"
+#endif // defined(ANJ_WITH_SENML_CBOR_RELATIVE_TIME) &&
+       // !defined(ANJ_WITH_SENML_CBOR)
+
+#if defined(ANJ_WITH_SENML_CBOR_STRINGREF) && !defined(ANJ_WITH_SENML_CBOR)
+#    error "ANJ_WITH_SENML_CBOR_STRINGREF requires ANJ_WITH_SENML_CBOR enabled"
+#endif // defined(ANJ_WITH_SENML_CBOR_STRINGREF) &&
+       // !defined(ANJ_WITH_SENML_CBOR)
+
+#if defined(ANJ_WITH_SENML_CBOR_STRINGREF)         \
+        && (ANJ_SENML_CBOR_STRINGREF_NAMES <= 0     \
+            || ANJ_SENML_CBOR_STRINGREF_FORMAT <= 0 \
+            || ANJ_SENML_CBOR_STRINGREF_FORMAT >= 65535)
+#    error "if SenML CBOR stringref is enabled, ANJ_SENML_CBOR_STRINGREF_NAMES has to be greater than 0 and ANJ_SENML_CBOR_STRINGREF_FORMAT has to be a valid Content-Format"
+#endif // defined(ANJ_WITH_SENML_CBOR_STRINGREF) &&
+       // (ANJ_SENML_CBOR_STRINGREF_NAMES <= 0 ||
+       // ANJ_SENML_CBOR_STRINGREF_FORMAT <= 0 ||
+       // ANJ_SENML_CBOR_STRINGREF_FORMAT >= 65535)
+
+#if defined(ANJ_WITH_CBOR_ENCODE_SHORTEST_FLOAT) \
+        && !defined(ANJ_WITH_SENML_CBOR) && !defined(ANJ_WITH_LWM2M_CBOR)
+#    error "ANJ_WITH_CBOR_ENCODE_SHORTEST_FLOAT requires ANJ_WITH_SENML_CBOR or ANJ_WITH_LWM2M_CBOR enabled"
+#endif // defined(ANJ_WITH_CBOR_ENCODE_SHORTEST_FLOAT) &&
+       // !defined(ANJ_WITH_SENML_CBOR) && !defined(ANJ_WITH_LWM2M_CBOR)
+
+#if defined(ANJ_WITH_TLV_ENCODER) && !defined(ANJ_WITH_TLV)
+#    error "ANJ_WITH_TLV_ENCODER requires ANJ_WITH_TLV enabled"
+#endif // defined(ANJ_WITH_TLV_ENCODER) && !defined(ANJ_WITH_TLV)
+
 #if defined(ANJ_WITH_DISCOVER_ATTR) && !defined(ANJ_WITH_OBSERVE)
 #    error "if discover attributes are enabled, observe module needs to be enabled"
 #endif // defined(ANJ_WITH_DISCOVER_ATTR) && !defined(ANJ_WITH_OBSERVE)
@@ -63,6 +388,23 @@ extern "C" {
 #endif // defined(ANJ_WITH_COMPOSITE_OPERATIONS) &&
        // !defined(ANJ_DM_MAX_COMP_READ_ENTRIES)
 
+#if defined(ANJ_DM_WITH_COMP_READ_PATH_STREAMING) \
+        && !defined(ANJ_WITH_COMPOSITE_OPERATIONS)
+#    error "ANJ_DM_WITH_COMP_READ_PATH_STREAMING requires ANJ_WITH_COMPOSITE_OPERATIONS enabled"
+#endif // defined(ANJ_DM_WITH_COMP_READ_PATH_STREAMING) &&
+       // !defined(ANJ_WITH_COMPOSITE_OPERATIONS)
+
+#if defined(ANJ_DM_WITH_BATCHED_WRITE_COMP) \
+        && !defined(ANJ_WITH_COMPOSITE_OPERATIONS)
+#    error "ANJ_DM_WITH_BATCHED_WRITE_COMP requires ANJ_WITH_COMPOSITE_OPERATIONS enabled"
+#endif // defined(ANJ_DM_WITH_BATCHED_WRITE_COMP) &&
+       // !defined(ANJ_WITH_COMPOSITE_OPERATIONS)
+
+#if defined(ANJ_DM_WITH_SHARED_OBJ_DEFS) && !defined(ANJ_DM_WITH_LAZY_INSTS)
+#    error "ANJ_DM_WITH_SHARED_OBJ_DEFS requires ANJ_DM_WITH_LAZY_INSTS enabled"
+#endif // defined(ANJ_DM_WITH_SHARED_OBJ_DEFS) &&
+       // !defined(ANJ_DM_WITH_LAZY_INSTS)
+
 #ifdef ANJ_WITH_OBSERVE
 #    if !defined(ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER) \
             || !defined(ANJ_OBSERVE_MAX_WRITE_ATTRIBUTES_NUMBER)
@@ -71,6 +413,25 @@ extern "C" {
            // !defined(ANJ_OBSERVE_MAX_WRITE_ATTRIBUTES_NUMBER)
 #endif     // ANJ_WITH_OBSERVE
 
+#ifdef ANJ_OBSERVE_WITH_USER_STORAGE
+#    ifndef ANJ_WITH_OBSERVE
+#        error "ANJ_OBSERVE_WITH_USER_STORAGE requires ANJ_WITH_OBSERVE"
+#    endif // ANJ_WITH_OBSERVE
+#    if defined(ANJ_OBSERVE_WITH_DEADLINE_INDEX)            \
+            || defined(ANJ_OBSERVE_WITH_PATH_INDEX)         \
+            || defined(ANJ_OBSERVE_WITH_STATE_ARRAYS)       \
+            || defined(ANJ_OBSERVE_WITH_TOKEN_INDEX)        \
+            || defined(ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX) \
+            || defined(ANJ_WITH_OSCORE)
+#        error "ANJ_OBSERVE_WITH_USER_STORAGE can't be used with indexes of Observations or attributes, or with OSCORE"
+#    endif // defined(ANJ_OBSERVE_WITH_DEADLINE_INDEX) ||
+           // defined(ANJ_OBSERVE_WITH_PATH_INDEX) ||
+           // defined(ANJ_OBSERVE_WITH_STATE_ARRAYS) ||
+           // defined(ANJ_OBSERVE_WITH_TOKEN_INDEX) ||
+           // defined(ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX) ||
+           // defined(ANJ_WITH_OSCORE)
+#endif     // ANJ_OBSERVE_WITH_USER_STORAGE
+
 #if defined(ANJ_WITH_OBSERVE_COMPOSITE) \
         && (!defined(ANJ_WITH_OBSERVE)  \
             || !defined(ANJ_WITH_COMPOSITE_OPERATIONS))
@@ -84,6 +445,185 @@ extern "C" {
 #    endif // !defined(ANJ_LWM2M_SEND_QUEUE_SIZE)
 #endif     // ANJ_WITH_LWM2M_SEND
 
+#if defined(ANJ_WITH_DEFAULT_METRICS_OBJ) && !defined(ANJ_WITH_METRICS)
+#    error "if Metrics Object is enabled, metrics have to be enabled"
+#endif // defined(ANJ_WITH_DEFAULT_METRICS_OBJ) && !defined(ANJ_WITH_METRICS)
+
+#ifdef ANJ_WITH_LWM2M_GATEWAY
+#    ifndef ANJ_WITH_LWM2M12
+#        error "ANJ_WITH_LWM2M_GATEWAY requires ANJ_WITH_LWM2M12 enabled"
+#    endif // ANJ_WITH_LWM2M12
+#    if !defined(ANJ_GATEWAY_MAX_DEVICES)               \
+            || !defined(ANJ_GATEWAY_MAX_DEVICE_OBJECTS) \
+            || !defined(ANJ_GATEWAY_IOT_DEVICE_OBJECTS_BUFFER_SIZE)
+#        error "if LwM2M Gateway Object is enabled, its parameters has to be defined"
+#    endif // !defined(ANJ_GATEWAY_MAX_DEVICES) ||
+           // !defined(ANJ_GATEWAY_MAX_DEVICE_OBJECTS) ||
+           // !defined(ANJ_GATEWAY_IOT_DEVICE_OBJECTS_BUFFER_SIZE)
+#    if ANJ_GATEWAY_MAX_DEVICE_OBJECTS > ANJ_DM_MAX_OBJECTS_NUMBER
+#        error "ANJ_GATEWAY_MAX_DEVICE_OBJECTS must not be greater than ANJ_DM_MAX_OBJECTS_NUMBER"
+#    endif // ANJ_GATEWAY_MAX_DEVICE_OBJECTS > ANJ_DM_MAX_OBJECTS_NUMBER
+#endif     // ANJ_WITH_LWM2M_GATEWAY
+
+#if defined(ANJ_METRICS_WITH_HISTOGRAMS) && !defined(ANJ_WITH_METRICS)
+#    error "if latency histograms are enabled, metrics have to be enabled"
+#endif // defined(ANJ_METRICS_WITH_HISTOGRAMS) && !defined(ANJ_WITH_METRICS)
+
+#ifdef ANJ_WITH_TRACE
+#    if !defined(ANJ_TRACE_BUFFER_SIZE) || ANJ_TRACE_BUFFER_SIZE < 1
+#        error "if trace is enabled, ANJ_TRACE_BUFFER_SIZE has to be positive"
+#    endif // !defined(ANJ_TRACE_BUFFER_SIZE) || ANJ_TRACE_BUFFER_SIZE < 1
+#endif     // ANJ_WITH_TRACE
+
+#if defined(ANJ_WITH_SESSION_PERSISTENCE) && !defined(ANJ_WITH_PERSISTENCE)
+#    error "if session persistence is enabled, persistence has to be enabled"
+#endif // defined(ANJ_WITH_SESSION_PERSISTENCE) &&
+       // !defined(ANJ_WITH_PERSISTENCE)
+
+#if defined(ANJ_PERSISTENCE_WITH_BUFFERED_STORE) \
+        && !defined(ANJ_WITH_PERSISTENCE)
+#    error "ANJ_PERSISTENCE_WITH_BUFFERED_STORE requires ANJ_WITH_PERSISTENCE"
+#endif // defined(ANJ_PERSISTENCE_WITH_BUFFERED_STORE) &&
+       // !defined(ANJ_WITH_PERSISTENCE)
+
+#if defined(ANJ_NTP_WITH_EXTERNAL_SAMPLES) \
+        && !defined(ANJ_NTP_WITH_DRIFT_COMPENSATION)
+#    error "ANJ_NTP_WITH_EXTERNAL_SAMPLES requires ANJ_NTP_WITH_DRIFT_COMPENSATION"
+#endif // defined(ANJ_NTP_WITH_EXTERNAL_SAMPLES) &&
+       // !defined(ANJ_NTP_WITH_DRIFT_COMPENSATION)
+
+#if defined(ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME) \
+        && !defined(ANJ_WITH_DEFAULT_DEVICE_OBJ)
+#    error "ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME requires ANJ_WITH_DEFAULT_DEVICE_OBJ"
+#endif // defined(ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME) &&
+       // !defined(ANJ_WITH_DEFAULT_DEVICE_OBJ)
+
+#ifdef ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+#    ifndef ANJ_WITH_DEFAULT_DEVICE_OBJ
+#        error "ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ requires ANJ_WITH_DEFAULT_DEVICE_OBJ"
+#    endif // ANJ_WITH_DEFAULT_DEVICE_OBJ
+#    if !defined(ANJ_DM_DEVICE_OBJ_PREENCODED_READ_SIZE) \
+            || ANJ_DM_DEVICE_OBJ_PREENCODED_READ_SIZE < 1
+#        error "if Device Object Reads are pre-encoded, the buffer size has to be at least 1"
+#    endif // !defined(ANJ_DM_DEVICE_OBJ_PREENCODED_READ_SIZE) ||
+           // ANJ_DM_DEVICE_OBJ_PREENCODED_READ_SIZE < 1
+#    if !defined(ANJ_DM_DEVICE_OBJ_PREENCODED_READ_FORMATS) \
+            || ANJ_DM_DEVICE_OBJ_PREENCODED_READ_FORMATS < 1   \
+            || ANJ_DM_DEVICE_OBJ_PREENCODED_READ_FORMATS > 255
+#        error "ANJ_DM_DEVICE_OBJ_PREENCODED_READ_FORMATS has to be between 1 and 255"
+#    endif // !defined(ANJ_DM_DEVICE_OBJ_PREENCODED_READ_FORMATS) ||
+           // ANJ_DM_DEVICE_OBJ_PREENCODED_READ_FORMATS < 1 ||
+           // ANJ_DM_DEVICE_OBJ_PREENCODED_READ_FORMATS > 255
+#endif // ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+
+#if defined(ANJ_NTP_WITH_DRIFT_COMPENSATION) && !defined(ANJ_WITH_NTP)
+#    error "ANJ_NTP_WITH_DRIFT_COMPENSATION requires ANJ_WITH_NTP"
+#endif // defined(ANJ_NTP_WITH_DRIFT_COMPENSATION) && !defined(ANJ_WITH_NTP)
+
+#if defined(ANJ_PERSISTENCE_WITH_DIRTY_TRACKING) \
+        && !defined(ANJ_WITH_PERSISTENCE)
+#    error "ANJ_PERSISTENCE_WITH_DIRTY_TRACKING requires ANJ_WITH_PERSISTENCE"
+#endif // defined(ANJ_PERSISTENCE_WITH_DIRTY_TRACKING) &&
+       // !defined(ANJ_WITH_PERSISTENCE)
+
+#if defined(ANJ_PERSISTENCE_WITH_INTEGRITY_CHECK) \
+        && !defined(ANJ_WITH_PERSISTENCE)
+#    error "ANJ_PERSISTENCE_WITH_INTEGRITY_CHECK requires ANJ_WITH_PERSISTENCE"
+#endif // defined(ANJ_PERSISTENCE_WITH_INTEGRITY_CHECK) &&
+       // !defined(ANJ_WITH_PERSISTENCE)
+
+#if defined(ANJ_PERSISTENCE_WITH_MEMORY_MAPPED_RESTORE) \
+        && !defined(ANJ_WITH_PERSISTENCE)
+#    error "ANJ_PERSISTENCE_WITH_MEMORY_MAPPED_RESTORE requires ANJ_WITH_PERSISTENCE"
+#endif // defined(ANJ_PERSISTENCE_WITH_MEMORY_MAPPED_RESTORE) &&
+       // !defined(ANJ_WITH_PERSISTENCE)
+
+#if defined(ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE) \
+        && (!defined(ANJ_NET_WITH_DTLS)            \
+            || !defined(ANJ_WITH_SESSION_PERSISTENCE))
+#    error "if DTLS session persistence is enabled, DTLS and session persistence have to be enabled"
+#endif // defined(ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE) &&
+       // (!defined(ANJ_NET_WITH_DTLS) ||
+       // !defined(ANJ_WITH_SESSION_PERSISTENCE))
+
+#ifdef ANJ_LWM2M_SEND_WITH_BATCHING
+#    if !defined(ANJ_WITH_LWM2M_SEND) || !defined(ANJ_WITH_SENML_CBOR)
+#        error "if Send batching is enabled, LwM2M Send and SenML CBOR have to be enabled"
+#    endif // !defined(ANJ_WITH_LWM2M_SEND) || !defined(ANJ_WITH_SENML_CBOR)
+#    if !defined(ANJ_LWM2M_SEND_BATCHING_HOLD_DOWN_MS) \
+            || ANJ_LWM2M_SEND_QUEUE_SIZE < 2
+#        error "if Send batching is enabled, hold-down time has to be defined and Send queue has to hold at least 2 requests"
+#    endif // !defined(ANJ_LWM2M_SEND_BATCHING_HOLD_DOWN_MS) ||
+           // ANJ_LWM2M_SEND_QUEUE_SIZE < 2
+#endif     // ANJ_LWM2M_SEND_WITH_BATCHING
+
+#if defined(ANJ_LWM2M_SEND_WITH_RECORD_PRODUCER) \
+        && !defined(ANJ_WITH_LWM2M_SEND)
+#    error "if Send record producer is enabled, LwM2M Send has to be enabled"
+#endif // defined(ANJ_LWM2M_SEND_WITH_RECORD_PRODUCER) &&
+       // !defined(ANJ_WITH_LWM2M_SEND)
+
+#if defined(ANJ_LWM2M_SEND_WITH_PRIORITIES) && !defined(ANJ_WITH_LWM2M_SEND)
+#    error "if Send priorities are enabled, LwM2M Send has to be enabled"
+#endif // defined(ANJ_LWM2M_SEND_WITH_PRIORITIES) &&
+       // !defined(ANJ_WITH_LWM2M_SEND)
+
+#ifdef ANJ_LWM2M_SEND_WITH_NON_CONFIRMABLE
+#    ifndef ANJ_WITH_LWM2M_SEND
+#        error "if Non-confirmable Send is enabled, LwM2M Send has to be enabled"
+#    endif // ANJ_WITH_LWM2M_SEND
+#    if !defined(ANJ_LWM2M_SEND_CON_EVERY_N) || ANJ_LWM2M_SEND_CON_EVERY_N < 0 \
+            || ANJ_LWM2M_SEND_CON_EVERY_N > 65535
+#        error "ANJ_LWM2M_SEND_CON_EVERY_N has to be between 0 and 65535"
+#    endif // !defined(ANJ_LWM2M_SEND_CON_EVERY_N) ||
+           // ANJ_LWM2M_SEND_CON_EVERY_N < 0 ||
+           // ANJ_LWM2M_SEND_CON_EVERY_N > 65535
+#endif // ANJ_LWM2M_SEND_WITH_NON_CONFIRMABLE
+
+#if defined(ANJ_LWM2M_SEND_WITH_NO_RESPONSE) && !defined(ANJ_WITH_LWM2M_SEND)
+#    error "if Send No-Response option is enabled, LwM2M Send has to be enabled"
+#endif // defined(ANJ_LWM2M_SEND_WITH_NO_RESPONSE) &&
+       // !defined(ANJ_WITH_LWM2M_SEND)
+
+#ifdef ANJ_LWM2M_SEND_WITH_FILTER
+#    ifndef ANJ_WITH_LWM2M_SEND
+#        error "if Send filters are enabled, LwM2M Send has to be enabled"
+#    endif // ANJ_WITH_LWM2M_SEND
+#    if !defined(ANJ_LWM2M_SEND_FILTER_SIZE) || ANJ_LWM2M_SEND_FILTER_SIZE < 1
+#        error "ANJ_LWM2M_SEND_FILTER_SIZE has to be greater than 0"
+#    endif // !defined(ANJ_LWM2M_SEND_FILTER_SIZE) ||
+           // ANJ_LWM2M_SEND_FILTER_SIZE < 1
+#endif // ANJ_LWM2M_SEND_WITH_FILTER
+
+#ifdef ANJ_LWM2M_SEND_WITH_SORTED_RECORDS
+#    ifndef ANJ_WITH_LWM2M_SEND
+#        error "if Send records are sorted, LwM2M Send has to be enabled"
+#    endif // ANJ_WITH_LWM2M_SEND
+#    if !defined(ANJ_LWM2M_SEND_SORTED_RECORDS_MAX)  \
+            || ANJ_LWM2M_SEND_SORTED_RECORDS_MAX < 2 \
+            || ANJ_LWM2M_SEND_SORTED_RECORDS_MAX > 65535
+#        error "ANJ_LWM2M_SEND_SORTED_RECORDS_MAX has to be between 2 and 65535"
+#    endif // !defined(ANJ_LWM2M_SEND_SORTED_RECORDS_MAX) ||
+           // ANJ_LWM2M_SEND_SORTED_RECORDS_MAX < 2 ||
+           // ANJ_LWM2M_SEND_SORTED_RECORDS_MAX > 65535
+#endif // ANJ_LWM2M_SEND_WITH_SORTED_RECORDS
+
+#ifdef ANJ_LWM2M_SEND_WITH_TEMPLATES
+#    if !defined(ANJ_WITH_LWM2M_SEND) || !defined(ANJ_WITH_SENML_CBOR)
+#        error "if Send templates are enabled, LwM2M Send and SenML CBOR have to be enabled"
+#    endif // !defined(ANJ_WITH_LWM2M_SEND) || !defined(ANJ_WITH_SENML_CBOR)
+#    if !defined(ANJ_LWM2M_SEND_TEMPLATE_MAX_RECORDS) \
+            || ANJ_LWM2M_SEND_TEMPLATE_MAX_RECORDS < 1
+#        error "ANJ_LWM2M_SEND_TEMPLATE_MAX_RECORDS has to be at least 1"
+#    endif // !defined(ANJ_LWM2M_SEND_TEMPLATE_MAX_RECORDS) ||
+           // ANJ_LWM2M_SEND_TEMPLATE_MAX_RECORDS < 1
+#    if !defined(ANJ_LWM2M_SEND_TEMPLATE_MAX_SIZE) \
+            || ANJ_LWM2M_SEND_TEMPLATE_MAX_SIZE < 16
+#        error "ANJ_LWM2M_SEND_TEMPLATE_MAX_SIZE has to be at least 16"
+#    endif // !defined(ANJ_LWM2M_SEND_TEMPLATE_MAX_SIZE) ||
+           // ANJ_LWM2M_SEND_TEMPLATE_MAX_SIZE < 16
+#endif // ANJ_LWM2M_SEND_WITH_TEMPLATES
+
 #ifdef ANJ_WITH_DEFAULT_FOTA_OBJ
 #    if !defined(ANJ_FOTA_WITH_PULL_METHOD) \
             && !defined(ANJ_FOTA_WITH_PUSH_METHOD)
@@ -104,6 +644,49 @@ extern "C" {
            // !defined(ANJ_FOTA_WITH_COAPS_TCP)
 #endif     // ANJ_WITH_DEFAULT_FOTA_OBJ
 
+#if defined(ANJ_FOTA_WITH_PACKAGE_DIGEST) \
+        && !defined(ANJ_WITH_DEFAULT_FOTA_OBJ)
+#    error "ANJ_FOTA_WITH_PACKAGE_DIGEST requires ANJ_WITH_DEFAULT_FOTA_OBJ"
+#endif // defined(ANJ_FOTA_WITH_PACKAGE_DIGEST) &&
+       // !defined(ANJ_WITH_DEFAULT_FOTA_OBJ)
+
+#if defined(ANJ_FOTA_WITH_ASYNC_PUSH_WRITE)     \
+        && (!defined(ANJ_WITH_DEFAULT_FOTA_OBJ) \
+            || !defined(ANJ_FOTA_WITH_PUSH_METHOD))
+#    error "ANJ_FOTA_WITH_ASYNC_PUSH_WRITE requires ANJ_FOTA_WITH_PUSH_METHOD"
+#endif // defined(ANJ_FOTA_WITH_ASYNC_PUSH_WRITE) &&
+       // (!defined(ANJ_WITH_DEFAULT_FOTA_OBJ) ||
+       // !defined(ANJ_FOTA_WITH_PUSH_METHOD))
+
+#if defined(ANJ_FOTA_WITH_DELTA_UPDATE) && !defined(ANJ_WITH_DEFAULT_FOTA_OBJ)
+#    error "ANJ_FOTA_WITH_DELTA_UPDATE requires ANJ_WITH_DEFAULT_FOTA_OBJ"
+#endif // defined(ANJ_FOTA_WITH_DELTA_UPDATE) &&
+       // !defined(ANJ_WITH_DEFAULT_FOTA_OBJ)
+
+#ifdef ANJ_FOTA_WITH_DECOMPRESSION
+#    ifndef ANJ_WITH_DEFAULT_FOTA_OBJ
+#        error "ANJ_FOTA_WITH_DECOMPRESSION requires ANJ_WITH_DEFAULT_FOTA_OBJ"
+#    endif // ANJ_WITH_DEFAULT_FOTA_OBJ
+#    if !defined(ANJ_FOTA_DECOMPRESSION_WINDOW_BITS) \
+            || ANJ_FOTA_DECOMPRESSION_WINDOW_BITS < 4 \
+            || ANJ_FOTA_DECOMPRESSION_WINDOW_BITS > 15
+#        error "ANJ_FOTA_DECOMPRESSION_WINDOW_BITS must be in range 4..15"
+#    endif // !defined(ANJ_FOTA_DECOMPRESSION_WINDOW_BITS) ||
+           // ANJ_FOTA_DECOMPRESSION_WINDOW_BITS < 4 ||
+           // ANJ_FOTA_DECOMPRESSION_WINDOW_BITS > 15
+#endif     // ANJ_FOTA_WITH_DECOMPRESSION
+
+#ifdef ANJ_FOTA_WITH_PAGE_ALIGNED_WRITES
+#    ifndef ANJ_WITH_DEFAULT_FOTA_OBJ
+#        error "ANJ_FOTA_WITH_PAGE_ALIGNED_WRITES requires ANJ_WITH_DEFAULT_FOTA_OBJ"
+#    endif // ANJ_WITH_DEFAULT_FOTA_OBJ
+#    if !defined(ANJ_FOTA_WRITE_PAGE_MAX_SIZE) \
+            || ANJ_FOTA_WRITE_PAGE_MAX_SIZE < 1
+#        error "ANJ_FOTA_WRITE_PAGE_MAX_SIZE must be a positive number"
+#    endif // !defined(ANJ_FOTA_WRITE_PAGE_MAX_SIZE) ||
+           // ANJ_FOTA_WRITE_PAGE_MAX_SIZE < 1
+#endif     // ANJ_FOTA_WITH_PAGE_ALIGNED_WRITES
+
 #ifdef ANJ_WITH_DEFAULT_SECURITY_OBJ
 #    if !defined(ANJ_SEC_OBJ_MAX_PUBLIC_KEY_OR_IDENTITY_SIZE)   \
             || !defined(ANJ_SEC_OBJ_MAX_SERVER_PUBLIC_KEY_SIZE) \
@@ -114,6 +697,18 @@ extern "C" {
            // !defined(ANJ_SEC_OBJ_MAX_SECRET_KEY_SIZE)
 #endif     // ANJ_WITH_DEFAULT_SECURITY_OBJ
 
+#if defined(ANJ_SEC_OBJ_WITH_EXTERNAL_KEYS_ONLY) \
+        && !defined(ANJ_WITH_EXTERNAL_CRYPTO_STORAGE)
+#    error "ANJ_SEC_OBJ_WITH_EXTERNAL_KEYS_ONLY requires ANJ_WITH_EXTERNAL_CRYPTO_STORAGE"
+#endif // defined(ANJ_SEC_OBJ_WITH_EXTERNAL_KEYS_ONLY) &&
+       // !defined(ANJ_WITH_EXTERNAL_CRYPTO_STORAGE)
+
+#if defined(ANJ_WITH_ASYNC_CRYPTO_STORAGE) \
+        && !defined(ANJ_WITH_EXTERNAL_CRYPTO_STORAGE)
+#    error "ANJ_WITH_ASYNC_CRYPTO_STORAGE requires ANJ_WITH_EXTERNAL_CRYPTO_STORAGE"
+#endif // defined(ANJ_WITH_ASYNC_CRYPTO_STORAGE) &&
+       // !defined(ANJ_WITH_EXTERNAL_CRYPTO_STORAGE)
+
 #ifdef ANJ_WITH_COAP_DOWNLOADER
 #    if !defined(ANJ_COAP_DOWNLOADER_MAX_MSG_SIZE) \
             || !defined(ANJ_COAP_DOWNLOADER_MAX_PATHS_NUMBER)
@@ -121,6 +716,54 @@ extern "C" {
 #    endif
 #endif // ANJ_WITH_COAP_DOWNLOADER
 
+#if defined(ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION) \
+        && !defined(ANJ_WITH_COAP_DOWNLOADER)
+#    error "ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION requires ANJ_WITH_COAP_DOWNLOADER"
+#endif // defined(ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION) &&
+       // !defined(ANJ_WITH_COAP_DOWNLOADER)
+
+#if defined(ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW) \
+        && !defined(ANJ_WITH_COAP_DOWNLOADER)
+#    error "ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW requires ANJ_WITH_COAP_DOWNLOADER"
+#endif // defined(ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW) &&
+       // !defined(ANJ_WITH_COAP_DOWNLOADER)
+
+#if defined(ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW) \
+        && (ANJ_COAP_DOWNLOADER_BLOCK_WINDOW_SIZE < 2)
+#    error "ANJ_COAP_DOWNLOADER_BLOCK_WINDOW_SIZE has to be greater than 1"
+#endif // defined(ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW) &&
+       // (ANJ_COAP_DOWNLOADER_BLOCK_WINDOW_SIZE < 2)
+
+#if defined(ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2) \
+        && !defined(ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW)
+#    error "ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2 requires ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW"
+#endif // defined(ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2) &&
+       // !defined(ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW)
+
+#if defined(ANJ_COAP_DOWNLOADER_WITH_RESUME)    \
+        && (!defined(ANJ_WITH_COAP_DOWNLOADER) \
+            || !defined(ANJ_WITH_PERSISTENCE))
+#    error "ANJ_COAP_DOWNLOADER_WITH_RESUME requires ANJ_WITH_COAP_DOWNLOADER and ANJ_WITH_PERSISTENCE"
+#endif // defined(ANJ_COAP_DOWNLOADER_WITH_RESUME) &&
+       // (!defined(ANJ_WITH_COAP_DOWNLOADER) || !defined(ANJ_WITH_PERSISTENCE))
+
+#if defined(ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING) \
+        && !defined(ANJ_WITH_COAP_DOWNLOADER)
+#    error "ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING requires ANJ_WITH_COAP_DOWNLOADER"
+#endif // defined(ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING) &&
+       // !defined(ANJ_WITH_COAP_DOWNLOADER)
+
+#ifdef ANJ_WITH_HTTP_DOWNLOADER
+#    if !defined(ANJ_NET_WITH_TCP) && !defined(ANJ_NET_WITH_TLS)
+#        error "ANJ_WITH_HTTP_DOWNLOADER requires ANJ_NET_WITH_TCP or ANJ_NET_WITH_TLS"
+#    endif // !defined(ANJ_NET_WITH_TCP) && !defined(ANJ_NET_WITH_TLS)
+#    if !defined(ANJ_HTTP_DOWNLOADER_BUFFER_SIZE) \
+            || ANJ_HTTP_DOWNLOADER_BUFFER_SIZE < 256
+#        error "ANJ_HTTP_DOWNLOADER_BUFFER_SIZE must be at least 256"
+#    endif // !defined(ANJ_HTTP_DOWNLOADER_BUFFER_SIZE) ||
+           // ANJ_HTTP_DOWNLOADER_BUFFER_SIZE < 256
+#endif // ANJ_WITH_HTTP_DOWNLOADER
+
 #ifdef ANJ_LOG_FULL
 #    define _ANJ_LOG_FULL_ENABLED 1
 #else // ANJ_LOG_FULL
@@ -171,6 +814,42 @@ extern "C" {
 #    define _ANJ_LOG_ENABLED
 #endif // _ANJ_LOG_TYPES_ENABLED == 1
 
+#ifdef ANJ_LOG_RUNTIME_FILTERING
+#    if !defined(ANJ_LOG_RUNTIME_FILTERING_MAX_MODULES) \
+            || ANJ_LOG_RUNTIME_FILTERING_MAX_MODULES <= 0
+#        error "ANJ_LOG_RUNTIME_FILTERING_MAX_MODULES must be greater than 0 when ANJ_LOG_RUNTIME_FILTERING is enabled"
+#    endif // !defined(ANJ_LOG_RUNTIME_FILTERING_MAX_MODULES) ||
+           // ANJ_LOG_RUNTIME_FILTERING_MAX_MODULES <= 0
+#endif // ANJ_LOG_RUNTIME_FILTERING
+
+#ifdef ANJ_LOG_RATE_LIMIT
+#    if !defined(ANJ_LOG_RATE_LIMIT_SITES) || ANJ_LOG_RATE_LIMIT_SITES <= 0
+#        error "ANJ_LOG_RATE_LIMIT_SITES must be greater than 0 when ANJ_LOG_RATE_LIMIT is enabled"
+#    endif // !defined(ANJ_LOG_RATE_LIMIT_SITES) || ANJ_LOG_RATE_LIMIT_SITES <= 0
+#    if !defined(ANJ_LOG_RATE_LIMIT_BURST) || ANJ_LOG_RATE_LIMIT_BURST <= 0
+#        error "ANJ_LOG_RATE_LIMIT_BURST must be greater than 0 when ANJ_LOG_RATE_LIMIT is enabled"
+#    endif // !defined(ANJ_LOG_RATE_LIMIT_BURST) || ANJ_LOG_RATE_LIMIT_BURST <= 0
+#    if !defined(ANJ_LOG_RATE_LIMIT_INTERVAL_MS) \
+            || ANJ_LOG_RATE_LIMIT_INTERVAL_MS <= 0
+#        error "ANJ_LOG_RATE_LIMIT_INTERVAL_MS must be greater than 0 when ANJ_LOG_RATE_LIMIT is enabled"
+#    endif // !defined(ANJ_LOG_RATE_LIMIT_INTERVAL_MS) ||
+           // ANJ_LOG_RATE_LIMIT_INTERVAL_MS <= 0
+#endif // ANJ_LOG_RATE_LIMIT
+
+#ifdef ANJ_LOG_MICRO_DEFERRED
+#    ifndef ANJ_LOG_MICRO
+#        error "ANJ_LOG_MICRO_DEFERRED requires ANJ_LOG_MICRO"
+#    endif // ANJ_LOG_MICRO
+#    if !defined(__GNUC__)
+#        error "ANJ_LOG_MICRO_DEFERRED requires a compiler with GCC __atomic builtins"
+#    endif // !defined(__GNUC__)
+#    if !defined(ANJ_LOG_DEFERRED_BUFFER_SIZE) \
+            || ANJ_LOG_DEFERRED_BUFFER_SIZE < 2
+#        error "ANJ_LOG_DEFERRED_BUFFER_SIZE must be at least 2 when ANJ_LOG_MICRO_DEFERRED is enabled"
+#    endif // !defined(ANJ_LOG_DEFERRED_BUFFER_SIZE) ||
+           // ANJ_LOG_DEFERRED_BUFFER_SIZE < 2
+#endif // ANJ_LOG_MICRO_DEFERRED
+
 #if defined(_ANJ_LOG_ENABLED) && !defined(ANJ_LOG_ALT_IMPL_HEADER)
 #    define _ANJ_LOG_USES_BUILTIN_HANDLER_IMPL
 
@@ -191,6 +870,9 @@ extern "C" {
 #    ifdef ANJ_WITH_EXTERNAL_CRYPTO_STORAGE
 #        error "ANJ_WITH_EXTERNAL_CRYPTO_STORAGE requires secure network transport to be enabled"
 #    endif // ANJ_WITH_EXTERNAL_CRYPTO_STORAGE
+#    ifdef ANJ_WITH_RAW_PUBLIC_KEY
+#        error "ANJ_WITH_RAW_PUBLIC_KEY requires secure network transport to be enabled"
+#    endif // ANJ_WITH_RAW_PUBLIC_KEY
 #endif     // !defined(ANJ_WITH_SECURITY)
 
 #ifdef ANJ_WITH_MBEDTLS
@@ -201,6 +883,10 @@ extern "C" {
 #        error "Wrong max length for psk identity"
 #    endif
 
+#    if defined(ANJ_WITH_RAW_PUBLIC_KEY) && ANJ_MBEDTLS_RPK_MAX_LEN <= 0
+#        error "Wrong max length for Raw Public Key mode credentials"
+#    endif
+
 #    if ANJ_MBEDTLS_HS_INITIAL_TIMEOUT_VALUE_MS < 0                     \
             || ANJ_MBEDTLS_HS_INITIAL_TIMEOUT_VALUE_MS > ANJ_UINT32_MAX \
             || ANJ_MBEDTLS_HS_MAXIMUM_TIMEOUT_VALUE_MS < 0              \
@@ -210,6 +896,24 @@ extern "C" {
 
 #    undef ANJ_UINT32_MAX
 
+#    if defined(ANJ_MBEDTLS_WITH_STATIC_POOL) && !defined(ANJ_NET_WITH_DTLS)
+#        error "ANJ_MBEDTLS_WITH_STATIC_POOL requires ANJ_NET_WITH_DTLS to be enabled"
+#    endif
+
+#    if defined(ANJ_MBEDTLS_HS_MTU) \
+            && (ANJ_MBEDTLS_HS_MTU < 0 || ANJ_MBEDTLS_HS_MTU > 65535)
+#        error "ANJ_MBEDTLS_HS_MTU has to be between 0 and 65535"
+#    endif
+
+#    if defined(ANJ_MBEDTLS_WITH_HANDSHAKE_METRICS) \
+            && !defined(ANJ_NET_WITH_DTLS)
+#        error "ANJ_MBEDTLS_WITH_HANDSHAKE_METRICS requires ANJ_NET_WITH_DTLS to be enabled"
+#    endif
+
+#elif defined(ANJ_MBEDTLS_WITH_STATIC_POOL)
+#    error "ANJ_MBEDTLS_WITH_STATIC_POOL requires ANJ_WITH_MBEDTLS to be enabled"
+#elif defined(ANJ_MBEDTLS_WITH_HANDSHAKE_METRICS)
+#    error "ANJ_MBEDTLS_WITH_HANDSHAKE_METRICS requires ANJ_WITH_MBEDTLS to be enabled"
 #endif // ANJ_WITH_MBEDTLS
 
 #ifdef __cplusplus
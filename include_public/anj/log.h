@@ -20,6 +20,7 @@
 #ifndef ANJ_LOG_LOG_H
 #    define ANJ_LOG_LOG_H
 
+#    include <stdbool.h>
 #    include <stdio.h>
 
 #    ifdef __cplusplus
@@ -95,8 +96,53 @@ extern "C" {
 #            define ANJ_LOG_LEVEL_DEFAULT L_INFO
 #        endif // ANJ_LOG_LEVEL_DEFAULT
 
-#        define ANJ_LOG_IF_ALLOWED_LOOKUP_ANJ_LOG_YES(Module, LogLevel, ...) \
-            ANJ_LOG_HANDLER_IMPL_MACRO(Module, LogLevel, __VA_ARGS__)
+#        ifdef ANJ_LOG_RATE_LIMIT
+bool _anj_log_rate_limit_allow(const char *file, int line);
+
+/**
+ * Call sites are identified by the source file and the line. The stringified
+ * file ID is used by the micro logger, so that file paths are not kept in the
+ * binary.
+ */
+#            ifdef ANJ_LOG_MICRO
+#                define _ANJ_LOG_SITE_FILE \
+                    ANJ_QUOTE_MACRO(ANJ_LOG_SOURCE_FILE_ID)
+#            else // ANJ_LOG_MICRO
+#                define _ANJ_LOG_SITE_FILE __FILE__
+#            endif // ANJ_LOG_MICRO
+
+#            define _ANJ_LOG_RATE_LIMITED(Module, LogLevel, ...)               \
+                (_anj_log_rate_limit_allow(_ANJ_LOG_SITE_FILE, __LINE__)       \
+                         ? (void) ANJ_LOG_HANDLER_IMPL_MACRO(Module, LogLevel, \
+                                                             __VA_ARGS__)      \
+                         : (void) 0)
+#        else // ANJ_LOG_RATE_LIMIT
+#            define _ANJ_LOG_RATE_LIMITED(Module, LogLevel, ...) \
+                ANJ_LOG_HANDLER_IMPL_MACRO(Module, LogLevel, __VA_ARGS__)
+#        endif // ANJ_LOG_RATE_LIMIT
+
+#        ifdef ANJ_LOG_RUNTIME_FILTERING
+extern anj_log_level_t _anj_log_runtime_min_level;
+
+bool _anj_log_runtime_level_check(const char *module, anj_log_level_t level);
+
+/**
+ * Statements that passed the compile-time filtering are checked against the
+ * lowest level set at runtime first, so that a disabled statement costs only
+ * a single comparison. The module is looked up only if the statement may be
+ * emitted.
+ */
+#            define ANJ_LOG_IF_ALLOWED_LOOKUP_ANJ_LOG_YES(Module, LogLevel, ...) \
+                ((ANJ_LOG_LEVEL_##LogLevel >= _anj_log_runtime_min_level      \
+                  && _anj_log_runtime_level_check(ANJ_QUOTE_MACRO(Module),    \
+                                                  ANJ_LOG_LEVEL_##LogLevel))  \
+                         ? (void) _ANJ_LOG_RATE_LIMITED(Module, LogLevel,      \
+                                                        __VA_ARGS__)           \
+                         : (void) 0)
+#        else // ANJ_LOG_RUNTIME_FILTERING
+#            define ANJ_LOG_IF_ALLOWED_LOOKUP_ANJ_LOG_YES(Module, LogLevel, ...) \
+                _ANJ_LOG_RATE_LIMITED(Module, LogLevel, __VA_ARGS__)
+#        endif // ANJ_LOG_RUNTIME_FILTERING
 #        define ANJ_LOG_IF_ALLOWED_LOOKUP_ANJ_LOG_NO(Module, LogLevel, ...) \
             ((void) 0)
 
@@ -132,6 +178,75 @@ extern "C" {
         ((void) (ANJ_LOG_IF_ALLOWED(Module, LogLevel, __VA_ARGS__), \
                  ANJ_LOG_COMPILE_TIME_CHECK(__VA_ARGS__)))
 
+#    if defined(_ANJ_LOG_ENABLED) && defined(ANJ_LOG_RUNTIME_FILTERING)
+/**
+ * Maximum length of a module name that can be passed to
+ * @ref anj_log_runtime_level_set.
+ */
+#        define ANJ_LOG_RUNTIME_MODULE_NAME_MAX_LEN 31
+
+/**
+ * Sets the level of log statements emitted at runtime, if
+ * @ref ANJ_LOG_RUNTIME_FILTERING is enabled.
+ *
+ * Runtime filtering is done on top of the compile-time one: only statements
+ * that are compiled in (see @ref ANJ_LOG_LEVEL_DEFAULT and
+ * @ref ANJ_LOG_FILTERING_CONFIG_HEADER) can be enabled. Initially all of them
+ * are emitted.
+ *
+ * @param module Name of the module, in the same form as in @ref anj_log()
+ *               calls, or NULL to set the level of modules without their own
+ *               level set.
+ * @param level  Lowest level of emitted statements, @c ANJ_LOG_LEVEL_L_MUTED
+ *               disables all of them.
+ *
+ * @return 0 on success, negative value if @p module is too long or
+ *         @ref ANJ_LOG_RUNTIME_FILTERING_MAX_MODULES modules have their level
+ *         set already.
+ */
+int anj_log_runtime_level_set(const char *module, anj_log_level_t level);
+
+/**
+ * Sets the level of log statements emitted at runtime, similarly to
+ * @ref anj_log_runtime_level_set, based on a textual setting.
+ *
+ * The setting is either <c>"module=LEVEL"</c> or <c>"LEVEL"</c> to set the
+ * level of modules without their own level set, where @c LEVEL is one of
+ * @c TRACE, @c DEBUG, @c INFO, @c WARNING, @c ERROR or @c MUTED, optionally
+ * prefixed with @c L_. <c>"module="</c> removes the level set for the module.
+ *
+ * This is meant to be called directly from the write handler of a vendor
+ * specific String Resource, to change the verbosity of a device remotely.
+ *
+ * @param setting Null-terminated setting.
+ *
+ * @return 0 on success, negative value if @p setting is invalid or the level
+ *         can't be set.
+ */
+int anj_log_runtime_level_set_from_string(const char *setting);
+
+/**
+ * Returns the level of log statements emitted at runtime for @p module.
+ *
+ * @param module Name of the module, or NULL to get the level of modules without
+ *               their own level set.
+ *
+ * @return Level set for @p module, or for modules without their own level if
+ *         none is set.
+ */
+anj_log_level_t anj_log_runtime_level_get(const char *module);
+
+/**
+ * Removes the level set for @p module with @ref anj_log_runtime_level_set.
+ * Statements of this module are then filtered with the level of modules
+ * without their own level set.
+ *
+ * @param module Name of the module, or NULL to remove levels of all modules
+ *               and make all compiled in statements emitted again.
+ */
+void anj_log_runtime_level_reset(const char *module);
+#    endif // defined(_ANJ_LOG_ENABLED) && defined(ANJ_LOG_RUNTIME_FILTERING)
+
 /** @cond */
 #    ifdef ANJ_LOG_STRIP_CONSTANTS
 #        define ANJ_LOG_DISPOSABLE_IMPL(Arg) " "
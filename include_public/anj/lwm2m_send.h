@@ -125,6 +125,14 @@ extern "C" {
  * - **SenML CBOR** supports timestamps (useful for time series).
  * - **LwM2M CBOR** is typically more compact; **paths must be unique** within
  *   one payload (duplicate paths are invalid even if timestamps differ).
+ * - **Smallest** (requires @ref ANJ_WITH_SMALLEST_FORMAT) uses LwM2M CBOR,
+ *   unless some record has a timestamp or the same path appears more than
+ *   once, in which case SenML CBOR is used. Such requests are never batched.
+ * - **SenML CBOR with stringref** (requires
+ *   @ref ANJ_WITH_SENML_CBOR_STRINGREF) is SenML CBOR in which repeated names
+ *   are replaced by references, sent with the vendor Content-Format
+ *   @ref ANJ_SENML_CBOR_STRINGREF_FORMAT. The LwM2M Server must support it.
+ *   Such requests are never batched.
  */
 typedef enum {
 #        ifdef ANJ_WITH_SENML_CBOR
@@ -133,6 +141,14 @@ typedef enum {
 #        ifdef ANJ_WITH_LWM2M_CBOR
     ANJ_SEND_CONTENT_FORMAT_LWM2M_CBOR,
 #        endif // ANJ_WITH_LWM2M_CBOR
+#        if defined(ANJ_WITH_SMALLEST_FORMAT) && defined(ANJ_WITH_SENML_CBOR) \
+                && defined(ANJ_WITH_LWM2M_CBOR)
+    ANJ_SEND_CONTENT_FORMAT_SMALLEST,
+#        endif // defined(ANJ_WITH_SMALLEST_FORMAT) &&
+               // defined(ANJ_WITH_SENML_CBOR) && defined(ANJ_WITH_LWM2M_CBOR)
+#        ifdef ANJ_WITH_SENML_CBOR_STRINGREF
+    ANJ_SEND_CONTENT_FORMAT_SENML_CBOR_STRINGREF,
+#        endif // ANJ_WITH_SENML_CBOR_STRINGREF
 } anj_send_content_format_t;
 
 /**
@@ -148,16 +164,84 @@ typedef void anj_send_finished_handler_t(anj_t *anjay,
                                          int result,
                                          void *data);
 
+#        ifdef ANJ_LWM2M_SEND_WITH_RECORD_PRODUCER
+/**
+ * Provides a record of a Send request, see
+ * @ref anj_send_request_t::record_producer.
+ *
+ * Records are requested in order, from 0 to
+ * @ref anj_send_request_t::records_cnt - 1, each of them once. Memory
+ * referenced by the record (e.g. string values) must remain valid until the
+ * producer is called again or the request is finished.
+ *
+ * @param      anj        Anjay object.
+ * @param      index      Index of the requested record.
+ * @param[out] out_record Record to fill.
+ * @param      data       User pointer from @ref anj_send_request_t::data.
+ *
+ * @return 0 on success; any other value terminates the request with
+ *         @ref ANJ_SEND_ERR_INTERNAL.
+ */
+typedef int anj_send_record_producer_t(anj_t *anj,
+                                       size_t index,
+                                       anj_io_out_entry_t *out_record,
+                                       void *data);
+#        endif // ANJ_LWM2M_SEND_WITH_RECORD_PRODUCER
+
+#        ifdef ANJ_LWM2M_SEND_WITH_TEMPLATES
+/**
+ * Pre-encoded payload of Send requests with a fixed set of records, see
+ * @ref anj_send_template_init. Its fields are private.
+ */
+typedef struct anj_send_template_struct anj_send_template_t;
+#        endif // ANJ_LWM2M_SEND_WITH_TEMPLATES
+
 /**
  * LwM2M Send message to be queued.
  */
 typedef struct {
-    /** Array of records (entries) to include in the payload. */
+    /**
+     * Array of records (entries) to include in the payload.
+     *
+     * If @ref ANJ_LWM2M_SEND_WITH_SORTED_RECORDS is enabled, records sent in
+     * LwM2M CBOR, or in SenML CBOR with a dynamic Base Name, may be encoded in
+     * the order of their paths instead; the array is not modified.
+     */
     const anj_io_out_entry_t *records;
 
     /** Number of elements in @ref records. */
     size_t records_cnt;
 
+#        ifdef ANJ_LWM2M_SEND_WITH_RECORD_PRODUCER
+    /**
+     * If set, @ref records is not used and may be NULL; @ref records_cnt
+     * records are obtained from this callback while the payload is encoded.
+     *
+     * Such records are not validated when the request is queued; a record
+     * without a Resource path terminates the request. The paths must still be
+     * unique if LwM2M CBOR is used, @ref ANJ_SEND_CONTENT_FORMAT_SMALLEST
+     * always results in SenML CBOR, and such requests are never merged with
+     * others.
+     */
+    anj_send_record_producer_t *record_producer;
+#        endif // ANJ_LWM2M_SEND_WITH_RECORD_PRODUCER
+
+#        ifdef ANJ_LWM2M_SEND_WITH_TEMPLATES
+    /**
+     * If set, the payload is copied from this template instead of being
+     * encoded, and only the values of @ref records, and their timestamps if
+     * the template has them, are written into it; paths of @ref records are
+     * not used. @ref records must match the records the template was
+     * initialized with in number, order and types, and @ref content_format
+     * must be @ref ANJ_SEND_CONTENT_FORMAT_SENML_CBOR.
+     *
+     * Such requests are never merged with others, nor filtered, and
+     * @ref record_producer must not be set. The template must remain valid
+     * and unchanged until the request is finished.
+     */
+    const anj_send_template_t *send_template;
+#        endif // ANJ_LWM2M_SEND_WITH_TEMPLATES
+
     /**
      * Handler invoked on success, or after the final delivery attempt.
      */
@@ -168,6 +252,47 @@ typedef struct {
 
     /** Content format used to encode the payload. */
     anj_send_content_format_t content_format;
+
+#        ifdef ANJ_LWM2M_SEND_WITH_PRIORITIES
+    /**
+     * Priority of the request. Queued requests with higher priority are sent
+     * first; requests of the same priority are sent in the order in which
+     * they were queued. The request that is already being sent is not
+     * affected.
+     */
+    uint8_t priority;
+#        endif // ANJ_LWM2M_SEND_WITH_PRIORITIES
+
+#        ifdef ANJ_LWM2M_SEND_WITH_NON_CONFIRMABLE
+    /**
+     * If set, the request is sent as a Non-confirmable message and
+     * @ref finished_handler is called with @ref ANJ_SEND_SUCCESS once it is
+     * sent; delivery is not guaranteed. See
+     * @ref ANJ_LWM2M_SEND_WITH_NON_CONFIRMABLE for the exceptions.
+     */
+    bool non_confirmable;
+#        endif // ANJ_LWM2M_SEND_WITH_NON_CONFIRMABLE
+
+#        ifdef ANJ_LWM2M_SEND_WITH_NO_RESPONSE
+    /**
+     * If set, the request carries the No-Response option (RFC 7967) telling
+     * the LwM2M Server not to send 2.xx responses. A Confirmable request is
+     * then completed as soon as it is acknowledged, and a Non-confirmable one
+     * causes no downlink traffic unless it fails. Error responses are still
+     * reported. Ignored if the request has to be sent with a block-wise
+     * transfer.
+     */
+    bool no_response;
+#        endif // ANJ_LWM2M_SEND_WITH_NO_RESPONSE
+
+#        ifdef ANJ_LWM2M_SEND_WITH_FILTER
+    /**
+     * If set, filters configured with @ref anj_send_filter_set are not applied
+     * to this request, e.g. to report all values periodically. Values sent
+     * are still remembered by the filters.
+     */
+    bool filter_disabled;
+#        endif // ANJ_LWM2M_SEND_WITH_FILTER
 } anj_send_request_t;
 
 /**
@@ -178,8 +303,12 @@ typedef struct {
  * - a registration session is active, and
  * - no higher-priority CoAP exchange is in progress.
  *
- * When multiple requests are queued, they are processed FIFO; only one Send
- * request is processed at a time.
+ * When multiple requests are queued, they are processed FIFO (ordered by
+ * @ref anj_send_request_t::priority first, if
+ * @ref ANJ_LWM2M_SEND_WITH_PRIORITIES is enabled); only one Send request is
+ * processed at a time. If @ref ANJ_LWM2M_SEND_WITH_BATCHING is
+ * enabled, consecutive SenML CBOR requests may be merged into a single Send
+ * message; each of them still gets its own ID and finish handler call.
  *
  * @note **Timestamps:** Only SenML CBOR supports timestamps. In non-SenML
  *       formats, @ref anj_io_out_entry_t::timestamp is ignored.
@@ -191,7 +320,9 @@ typedef struct {
  * @note The @p send_request object is **not copied**. All referenced memory
  *       (including the @ref anj_send_request_t::records array) must remain
  *       valid and unchanged until the operation completes and the finish
- *       handler returns.
+ *       handler returns. With @ref ANJ_LWM2M_SEND_WITH_RECORD_PRODUCER,
+ *       records may instead be provided one by one by
+ *       @ref anj_send_request_t::record_producer.
  *
  * @param      anj          Anjay object.
  * @param      send_request Description of the message to send (must remain
@@ -215,6 +346,9 @@ int anj_send_new_request(anj_t *anj,
  * - If the request is in progress, the exchange is cancelled.
  *
  * In both cases, @ref ANJ_SEND_ERR_ABORT is reported to the completion handler.
+ * If the request was merged with others into a single message (see
+ * @ref ANJ_LWM2M_SEND_WITH_BATCHING), the whole exchange is cancelled and all
+ * merged requests are aborted.
  *
  * @param anj     Anjay object.
  * @param send_id ID of the Send request to abort. Use @ref ANJ_SEND_ID_ALL to
@@ -226,6 +360,89 @@ int anj_send_new_request(anj_t *anj,
  */
 int anj_send_abort(anj_t *anj, uint16_t send_id);
 
+#        ifdef ANJ_LWM2M_SEND_WITH_FILTER
+/**
+ * Sets up a report-by-exception filter of Send records with the given path.
+ *
+ * A record of a queued request is dropped before encoding if its value
+ * differs by at most @p deadband from the value of the last record with the
+ * same path that was sent successfully. If all records of a request are
+ * dropped, nothing is sent and the finished handler is called with
+ * @ref ANJ_SEND_SUCCESS.
+ *
+ * Numeric values (@ref ANJ_DATA_TYPE_INT, @ref ANJ_DATA_TYPE_UINT,
+ * @ref ANJ_DATA_TYPE_DOUBLE, @ref ANJ_DATA_TYPE_TIME) are compared with
+ * @p deadband; @ref ANJ_DATA_TYPE_BOOL and @ref ANJ_DATA_TYPE_OBJLNK values
+ * are dropped only if they are equal to the last one. Records of other types,
+ * records of requests with @ref anj_send_request_t::record_producer and of
+ * requests with @ref anj_send_request_t::filter_disabled set are always sent.
+ *
+ * Setting the filter for a path again changes its deadband and forgets the
+ * last value sent.
+ *
+ * @param anj      Anjay object.
+ * @param path     Resource or Resource Instance path.
+ * @param deadband Maximum difference of values considered unchanged, 0 to
+ *                 drop only duplicated values.
+ *
+ * @return 0 on success, otherwise one of @ref anj_send_errors :
+ *         - @ref ANJ_SEND_ERR_NO_SPACE if there are already
+ *           @ref ANJ_LWM2M_SEND_FILTER_SIZE filters,
+ *         - @ref ANJ_SEND_ERR_DATA_NOT_VALID if @p path or @p deadband is
+ *           invalid,
+ *         - @ref ANJ_SEND_ERR_NOT_ALLOWED if a request the filters were
+ *           applied to is being sent.
+ */
+int anj_send_filter_set(anj_t *anj,
+                        const anj_uri_path_t *path,
+                        double deadband);
+
+/**
+ * Removes the filter set up with @ref anj_send_filter_set.
+ *
+ * @param anj  Anjay object.
+ * @param path Path the filter was set up for.
+ *
+ * @return 0 on success, otherwise one of @ref anj_send_errors :
+ *         - @ref ANJ_SEND_ERR_NO_REQUEST_FOUND if there is no filter for
+ *           @p path,
+ *         - @ref ANJ_SEND_ERR_NOT_ALLOWED if a request the filters were
+ *           applied to is being sent.
+ */
+int anj_send_filter_remove(anj_t *anj, const anj_uri_path_t *path);
+#        endif // ANJ_LWM2M_SEND_WITH_FILTER
+
+#        ifdef ANJ_LWM2M_SEND_WITH_TEMPLATES
+/**
+ * Encodes the SenML CBOR payload of Send requests with the given records, to
+ * be used as @ref anj_send_request_t::send_template.
+ *
+ * Paths, types and the presence of timestamps (a timestamp that is not NaN) of
+ * the records are fixed in the template; numbers are encoded on a fixed number
+ * of bytes, so that the values can be written in place. The values of
+ * @p records are encoded as well, but they are overwritten by the values of
+ * each request.
+ *
+ * Supported types are @ref ANJ_DATA_TYPE_INT, @ref ANJ_DATA_TYPE_UINT,
+ * @ref ANJ_DATA_TYPE_DOUBLE, @ref ANJ_DATA_TYPE_BOOL and
+ * @ref ANJ_DATA_TYPE_TIME.
+ *
+ * @param[out] send_template Template to initialize.
+ * @param      records       Records of the template.
+ * @param      records_cnt   Number of elements in @p records, at most
+ *                           @ref ANJ_LWM2M_SEND_TEMPLATE_MAX_RECORDS.
+ *
+ * @return 0 on success, otherwise one of @ref anj_send_errors :
+ *         - @ref ANJ_SEND_ERR_DATA_NOT_VALID if a record has an unsupported
+ *           type or no Resource path, or there are too many records,
+ *         - @ref ANJ_SEND_ERR_NO_SPACE if the payload doesn't fit in
+ *           @ref ANJ_LWM2M_SEND_TEMPLATE_MAX_SIZE bytes.
+ */
+int anj_send_template_init(anj_send_template_t *send_template,
+                           const anj_io_out_entry_t *records,
+                           size_t records_cnt);
+#        endif // ANJ_LWM2M_SEND_WITH_TEMPLATES
+
 /** @cond */
 #        define ANJ_INTERNAL_INCLUDE_SEND
 #        include <anj_internal/lwm2m_send.h>
@@ -0,0 +1,158 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+/**
+ * @file
+ * @brief Counters of the LwM2M client communication.
+ *
+ * Allows to check how often the client retransmits, uses cached responses,
+ * sends notifications or performs DTLS handshakes, how much data it exchanges
+ * with the LwM2M Server and how long the exchanges take. If
+ * @ref ANJ_METRICS_WITH_HISTOGRAMS is enabled, the distribution of the
+ * latencies of selected operations is collected as well.
+ */
+
+#ifndef ANJ_METRICS_H
+#    define ANJ_METRICS_H
+
+#    include <stdint.h>
+
+#    include <anj/defs.h>
+#    include <anj/time.h>
+
+#    ifdef __cplusplus
+extern "C" {
+#    endif
+
+#    ifdef ANJ_WITH_METRICS
+
+#        ifdef ANJ_METRICS_WITH_HISTOGRAMS
+/**
+ * Number of buckets of each histogram. Bucket 0 counts latencies shorter than
+ * 1 ms, bucket @c i counts latencies from 2^(i-1) ms up to 2^i ms, and the
+ * last bucket counts everything from 2^14 ms up.
+ */
+#            define ANJ_METRICS_HISTOGRAM_BUCKETS 16
+
+/** Latencies collected as histograms. */
+typedef enum {
+    /**
+     * Handling of a server request, from its reception until the last
+     * response is sent. Block-Wise transfers are counted as a whole.
+     */
+    ANJ_METRICS_HISTOGRAM_SERVER_REQUEST,
+    /** Reading of the payload of the first message of a notification. */
+    ANJ_METRICS_HISTOGRAM_NOTIFICATION_BUILD,
+    /**
+     * Send operation, from the creation of the request until the response
+     * (or, for non-confirmable messages, send confirmation).
+     */
+    ANJ_METRICS_HISTOGRAM_SEND,
+    /**
+     * Round-trip time of client requests, from the transmission until the
+     * response or ACK. Requests answered after a retransmission are not
+     * counted, as it's unknown which transmission the response belongs to.
+     */
+    ANJ_METRICS_HISTOGRAM_ACK_RTT,
+    ANJ_METRICS_HISTOGRAM_COUNT
+} anj_metrics_histogram_id_t;
+
+/** Logarithmic latency histogram. */
+typedef struct {
+    /** Number of samples per bucket, see @ref ANJ_METRICS_HISTOGRAM_BUCKETS. */
+    uint32_t buckets[ANJ_METRICS_HISTOGRAM_BUCKETS];
+} anj_metrics_histogram_t;
+#        endif // ANJ_METRICS_WITH_HISTOGRAMS
+
+/**
+ * Values of the metrics collected since @ref anj_core_init or the last call to
+ * @ref anj_core_metrics_reset.
+ *
+ * Only the communication with the LwM2M Server (or LwM2M Bootstrap-Server) is
+ * taken into account, CoAP downloader and NTP traffic is not counted.
+ */
+typedef struct {
+    /** Number of client requests retransmitted because of a missing
+     * response. */
+    uint32_t retransmissions;
+    /** Number of retransmitted server requests answered or ignored thanks to
+     * the exchange cache. */
+    uint32_t cache_hits;
+    /** Number of blocks following the first one in Block-Wise transfers. */
+    uint32_t blocks_transferred;
+    /** Number of notifications delivered to the LwM2M Server. */
+    uint32_t notifications_sent;
+    /** Number of DTLS connections established. */
+    uint32_t dtls_handshakes;
+    /** Number of bytes of CoAP messages sent. */
+    uint64_t bytes_sent;
+    /** Number of bytes of CoAP messages received. */
+    uint64_t bytes_received;
+    /** Number of exchanges finished successfully. */
+    uint32_t exchanges;
+    /**
+     * Shortest duration of a successful exchange, from the creation of the
+     * request (or reception of the server request) until its completion.
+     * Zero if @ref exchanges is 0.
+     */
+    anj_time_duration_t exchange_time_min;
+    /** Longest duration of a successful exchange. */
+    anj_time_duration_t exchange_time_max;
+    /**
+     * Sum of the durations of all successful exchanges. The average duration
+     * is @ref exchange_time_total divided by @ref exchanges.
+     */
+    anj_time_duration_t exchange_time_total;
+#        ifdef ANJ_METRICS_WITH_HISTOGRAMS
+    /** Histograms, indexed with @ref anj_metrics_histogram_id_t. */
+    anj_metrics_histogram_t histograms[ANJ_METRICS_HISTOGRAM_COUNT];
+#        endif // ANJ_METRICS_WITH_HISTOGRAMS
+} anj_metrics_t;
+
+/**
+ * Copies the current values of the metrics.
+ *
+ * @param      anj         Anjay object to operate on.
+ * @param[out] out_metrics Structure to fill.
+ */
+void anj_core_metrics_get(anj_t *anj, anj_metrics_t *out_metrics);
+
+/**
+ * Sets all the metrics to zero.
+ *
+ * @param anj Anjay object to operate on.
+ */
+void anj_core_metrics_reset(anj_t *anj);
+
+#        ifdef ANJ_METRICS_WITH_HISTOGRAMS
+/**
+ * Estimates a percentile of the latencies counted by a histogram.
+ *
+ * @param histogram Histogram to examine.
+ * @param percent   Percentile to estimate, from 0 to 100, e.g. 99 for p99.
+ *
+ * @return Upper bound of the bucket holding the percentile, i.e. a value the
+ *         given percentage of latencies does not exceed.
+ *         @ref ANJ_TIME_DURATION_INVALID if the histogram is empty, or if the
+ *         percentile falls into the last (open-ended) bucket.
+ */
+anj_time_duration_t
+anj_metrics_histogram_percentile(const anj_metrics_histogram_t *histogram,
+                                 uint8_t percent);
+#        endif // ANJ_METRICS_WITH_HISTOGRAMS
+
+#    endif // ANJ_WITH_METRICS
+
+#    ifdef __cplusplus
+}
+#    endif
+
+#endif // ANJ_METRICS_H
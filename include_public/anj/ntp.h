@@ -230,6 +230,28 @@ typedef struct anj_ntp_configuration_struct {
      * this function returns, as it is copied internally.
      */
     const anj_net_socket_configuration_t *net_socket_cfg;
+
+#        ifdef ANJ_NTP_WITH_DRIFT_COMPENSATION
+    /**
+     * Number of requests sent to the server during a single synchronization.
+     * The response with the shortest round trip, i.e. the least affected by
+     * network queuing, is used. If not set, single request is sent.
+     *
+     * All requests share one connection, so a burst costs a single wake-up of
+     * the radio.
+     */
+    uint8_t samples;
+
+    /**
+     * Maximum acceptable error of the time returned by @ref anj_ntp_time_now.
+     *
+     * If set, once the clock drift is known the synchronization period is
+     * extended to the time after which the uncertainty of the drift estimate
+     * would accumulate to this error, up to 8 times the `NTP period`
+     * Resource value. If not set, the `NTP period` is used as is.
+     */
+    anj_time_duration_t max_time_error;
+#        endif // ANJ_NTP_WITH_DRIFT_COMPENSATION
 } anj_ntp_configuration_t;
 
 /**
@@ -268,6 +290,25 @@ int anj_ntp_init(anj_t *anj,
  */
 void anj_ntp_step(anj_ntp_t *ntp);
 
+/**
+ * Returns the time until the next call to @ref anj_ntp_step is required.
+ *
+ * While a synchronization is in progress, @ref ANJ_TIME_DURATION_ZERO is
+ * returned, as the response is received by polling the socket in
+ * @ref anj_ntp_step. Otherwise, the value is the time remaining until the next
+ * periodic synchronization, or @ref ANJ_TIME_DURATION_INVALID if it is
+ * disabled (NTP Object Period Resource set to 0).
+ *
+ * @note Returned value becomes outdated if @ref anj_ntp_start is called or the
+ *       NTP Object is written by the LwM2M Server.
+ *
+ * @param ntp       NTP module state.
+ *
+ * @return @ref anj_time_duration_t until the next @ref anj_ntp_step is
+ *         required.
+ */
+anj_time_duration_t anj_ntp_next_step_time(anj_ntp_t *ntp);
+
 /**
  * Starts a new NTP time synchronization operation.
  *
@@ -297,6 +338,43 @@ int anj_ntp_start(anj_ntp_t *ntp);
  */
 void anj_ntp_terminate(anj_ntp_t *ntp);
 
+#        ifdef ANJ_NTP_WITH_DRIFT_COMPENSATION
+/**
+ * Returns the current real time, extrapolated from the last successful
+ * synchronization and corrected by the estimated drift of the local clock.
+ *
+ * @param ntp NTP module state.
+ * @return Current real time, or @ref ANJ_TIME_REAL_INVALID if no
+ *         synchronization succeeded yet.
+ */
+anj_time_real_t anj_ntp_time_now(anj_ntp_t *ntp);
+#        endif // ANJ_NTP_WITH_DRIFT_COMPENSATION
+
+#        ifdef ANJ_NTP_WITH_EXTERNAL_SAMPLES
+/**
+ * Feeds the NTP module with the time obtained from another source, e.g. the
+ * LwM2M Server writing the Current Time Resource, see
+ * @ref anj_dm_current_time_callback_t.
+ *
+ * The sample is processed as a completed synchronization:
+ * @ref ANJ_NTP_STATUS_FINISHED_SUCCESSFULLY is reported with the resulting
+ * time, the drift estimate is updated, and the next periodic synchronization
+ * is postponed by the `NTP period`.
+ *
+ * @param ntp         NTP module state.
+ * @param server_time Time of the source when the sample was sent.
+ * @param round_trip  Round-trip time to the source, half of which is assumed
+ *                    to be the transit time of the sample. May be
+ *                    @ref ANJ_TIME_DURATION_ZERO if unknown.
+ * @return 0 on success,
+ *         @ref ANJ_NTP_ERR_IN_PROGRESS if an NTP synchronization is in
+ *         progress; the sample is ignored then.
+ */
+int anj_ntp_add_sample(anj_ntp_t *ntp,
+                       anj_time_real_t server_time,
+                       anj_time_duration_t round_trip);
+#        endif // ANJ_NTP_WITH_EXTERNAL_SAMPLES
+
 #        ifdef ANJ_WITH_PERSISTENCE
 /**
  * Serializes the current LwM2M NTP Object into the persistence stream.
@@ -304,7 +382,10 @@ void anj_ntp_terminate(anj_ntp_t *ntp);
  * state changes (@ref ANJ_NTP_STATUS_OBJECT_UPDATED event).
  *
  * Writes NTP Object instance and its resources to the underlying medium via
- * @p ctx->write.
+ * @p ctx->write. If @ref ANJ_NTP_WITH_DRIFT_COMPENSATION is enabled, the
+ * estimated clock drift is stored as well; store it again after
+ * @ref ANJ_NTP_STATUS_FINISHED_SUCCESSFULLY to keep the estimate across
+ * reboots.
  *
  * @param ntp  NTP Object context to serialize.
  * @param ctx  Persistence context; must have @ref
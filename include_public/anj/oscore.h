@@ -0,0 +1,159 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+/**
+ * @file
+ * @brief OSCORE (RFC 8613) protection of the LwM2M Server connection.
+ *
+ * When a Security Context is set with @ref anj_oscore_set_security_context,
+ * all messages exchanged with the LwM2M Server are protected at the message
+ * layer: the code, the options and the payload of every request and response
+ * are encrypted with AES-CCM-16-64-128 (COSE algorithm 10) and carried in an
+ * outer CoAP message with the OSCORE option. There is no handshake, so a device
+ * that wakes up with a changed address can send the next message right away.
+ *
+ * The encryption itself is done by @ref anj_crypto_aes_ccm_encrypt and
+ * @ref anj_crypto_aes_ccm_decrypt, which are provided by the library if
+ * @ref ANJ_WITH_MBEDTLS is enabled.
+ */
+
+#ifndef ANJ_OSCORE_H
+#    define ANJ_OSCORE_H
+
+#    include <stddef.h>
+#    include <stdint.h>
+
+#    include <anj/defs.h>
+
+#    ifdef ANJ_WITH_PERSISTENCE
+#        include <anj/persistence.h>
+#    endif // ANJ_WITH_PERSISTENCE
+
+#    ifdef __cplusplus
+extern "C" {
+#    endif
+
+#    ifdef ANJ_WITH_OSCORE
+
+/** Length of the Sender and Recipient Keys, in bytes. */
+#        define ANJ_OSCORE_KEY_LEN 16
+
+/** Length of the AEAD nonce and of the Common IV, in bytes. */
+#        define ANJ_OSCORE_NONCE_LEN 13
+
+/** Length of the authentication tag appended to each message, in bytes. */
+#        define ANJ_OSCORE_TAG_LEN 8
+
+/** Maximum length of the Sender and Recipient IDs, in bytes. */
+#        define ANJ_OSCORE_MAX_ID_LEN (ANJ_OSCORE_NONCE_LEN - 6)
+
+/**
+ * OSCORE Security Context shared with the LwM2M Server, see RFC 8613,
+ * section 3.
+ *
+ * Keys and the Common IV are derived from the Master Secret and Master Salt
+ * of the OSCORE Object Instance with HKDF-SHA-256, as described in RFC 8613,
+ * section 3.2.1. The library expects the derived values, so that the key
+ * derivation may be done by the same code, or the same secure element, that
+ * stores the Master Secret.
+ */
+typedef struct {
+    /** Sender ID of the client, used as the kid of its requests. */
+    uint8_t sender_id[ANJ_OSCORE_MAX_ID_LEN];
+    /** Length of @ref sender_id. */
+    size_t sender_id_len;
+    /** Recipient ID, i.e. the Sender ID of the LwM2M Server. */
+    uint8_t recipient_id[ANJ_OSCORE_MAX_ID_LEN];
+    /** Length of @ref recipient_id. */
+    size_t recipient_id_len;
+    /** Key used to protect messages sent by the client. */
+    uint8_t sender_key[ANJ_OSCORE_KEY_LEN];
+    /** Key used to verify messages sent by the LwM2M Server. */
+    uint8_t recipient_key[ANJ_OSCORE_KEY_LEN];
+    /** Common IV. */
+    uint8_t common_iv[ANJ_OSCORE_NONCE_LEN];
+} anj_oscore_security_context_t;
+
+/**
+ * Enables OSCORE protection of the LwM2M Server connection with the given
+ * Security Context, or disables it if @p security is @c NULL.
+ *
+ * The context is copied. The Sender Sequence Number starts from 0 and the
+ * Replay Window is empty; to continue a context used before a restart of the
+ * device, call @ref anj_oscore_restore afterwards.
+ *
+ * The outgoing message gets larger by up to 27 bytes, which is accounted for
+ * when the size of the block-wise transfer is chosen. The payload is then
+ * never sent separately from the header, even if
+ * @ref ANJ_NET_WITH_SEND_VEC is enabled.
+ *
+ * @note Messages without the OSCORE option are dropped while the context is
+ *       set, with the exception of empty messages (ACK, RST and CoAP ping).
+ *       Outer options other than OSCORE and Observe, e.g. Uri-Host or
+ *       Proxy-Uri, are not passed to the library.
+ *
+ * @param anj      Anjay object.
+ * @param security Security Context, or @c NULL.
+ *
+ * @return 0 on success, -1 if the Sender or Recipient ID is too long or both
+ *         IDs are equal.
+ */
+int anj_oscore_set_security_context(
+        anj_t *anj, const anj_oscore_security_context_t *security);
+
+#        ifdef ANJ_WITH_PERSISTENCE
+/**
+ * Serializes the mutable state of the OSCORE Security Context: the Sender
+ * Sequence Number and the Replay Window. Keys are not stored.
+ *
+ * A Sequence Number must never be reused with the same keys, so the state has
+ * to be stored after the last message sent before the device restarts or
+ * powers down, e.g. when entering @ref ANJ_CONN_STATUS_QUEUE_MODE.
+ *
+ * @param anj Anjay object, with the Security Context set.
+ * @param ctx Persistence context; must have @ref
+ *            anj_persistence_context_t::direction set to
+ *            ANJ_PERSISTENCE_STORE.
+ *
+ * @return 0 on success, negative value on error.
+ */
+int anj_oscore_store(anj_t *anj, const anj_persistence_context_t *ctx);
+
+/**
+ * Deserializes the state stored with @ref anj_oscore_store into the Security
+ * Context set with @ref anj_oscore_set_security_context.
+ *
+ * The state is rejected if it was stored for a context with different Sender
+ * or Recipient ID.
+ *
+ * @param anj Anjay object, with the Security Context set.
+ * @param ctx Persistence context; must have @ref
+ *            anj_persistence_context_t::direction set to
+ *            ANJ_PERSISTENCE_RESTORE.
+ *
+ * @return 0 on success, negative value on error.
+ */
+int anj_oscore_restore(anj_t *anj, const anj_persistence_context_t *ctx);
+#        endif // ANJ_WITH_PERSISTENCE
+
+/** @cond */
+#        define ANJ_INTERNAL_INCLUDE_OSCORE
+#        include <anj_internal/oscore.h>
+#        undef ANJ_INTERNAL_INCLUDE_OSCORE
+/** @endcond */
+
+#    endif // ANJ_WITH_OSCORE
+
+#    ifdef __cplusplus
+}
+#    endif
+
+#endif // ANJ_OSCORE_H
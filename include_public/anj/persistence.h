@@ -124,6 +124,213 @@ anj_persistence_context_t
 anj_persistence_restore_context_create(anj_persistence_read_cb_t *read_cb,
                                        void *ctx);
 
+#        ifdef ANJ_PERSISTENCE_WITH_BUFFERED_STORE
+/**
+ * State of a buffered store context, see
+ * @ref anj_persistence_buffered_store_context_create.
+ *
+ * @anj_internal_fields_do_not_use
+ */
+typedef struct {
+    anj_persistence_write_cb_t *write;
+    void *ctx;
+    uint8_t *buffer;
+    size_t buffer_size;
+    size_t buffered;
+} anj_persistence_buffer_t;
+
+/**
+ * Creates a persistence context for storing data, which passes it to
+ * @p write_cb in chunks of exactly @p buffer_size bytes.
+ *
+ * Data is collected in @p buffer and written only when the buffer is full, so
+ * with a buffer of the flash page size every write covers a whole page. The
+ * last, partially filled chunk is written by @ref anj_persistence_buffer_flush,
+ * which must be called after all data is stored.
+ *
+ * @param[out] buffer_ctx  State of the context, must remain valid as long as
+ *                         the returned context is used.
+ * @param      buffer      Buffer for the collected data.
+ * @param      buffer_size Size of @p buffer, greater than 0.
+ * @param      write_cb    Callback to use for writing data.
+ * @param      ctx         User context passed to the write callback.
+ *
+ * @return Persistence context.
+ */
+anj_persistence_context_t anj_persistence_buffered_store_context_create(
+        anj_persistence_buffer_t *buffer_ctx,
+        void *buffer,
+        size_t buffer_size,
+        anj_persistence_write_cb_t *write_cb,
+        void *ctx);
+
+/**
+ * Writes the data collected by a buffered store context, if any.
+ *
+ * @param buffer_ctx State of the context, as passed to
+ *                   @ref anj_persistence_buffered_store_context_create.
+ *
+ * @return 0 on success, value returned by the write callback on error.
+ */
+int anj_persistence_buffer_flush(anj_persistence_buffer_t *buffer_ctx);
+
+/**
+ * Creates a persistence context for storing data, which writes nothing and
+ * only adds the size of each stored item to @p inout_size.
+ *
+ * Storing the same data with this context first gives the exact size of the
+ * blob, e.g. to erase the right number of flash sectors before the actual
+ * store.
+ *
+ * @param[inout] inout_size Incremented by the size of each stored item; should
+ *                          be set to 0 before the first use.
+ *
+ * @return Persistence context.
+ */
+anj_persistence_context_t
+anj_persistence_size_context_create(size_t *inout_size);
+#        endif // ANJ_PERSISTENCE_WITH_BUFFERED_STORE
+
+#        ifdef ANJ_PERSISTENCE_WITH_INTEGRITY_CHECK
+/**
+ * Size of the CRC appended by @ref anj_persistence_crc_finish.
+ */
+#            define ANJ_PERSISTENCE_CRC_SIZE 4
+
+/**
+ * State of a CRC-32 computing context, see
+ * @ref anj_persistence_crc_store_context_create and
+ * @ref anj_persistence_crc_restore_context_create.
+ * @anj_internal_fields_do_not_use
+ */
+typedef struct {
+    anj_persistence_direction_t direction;
+    anj_persistence_read_cb_t *read;
+    anj_persistence_write_cb_t *write;
+    void *ctx;
+    uint32_t crc;
+} anj_persistence_crc_t;
+
+/**
+ * Creates a persistence context for storing data, which passes it to
+ * @p write_cb unchanged and computes a CRC-32 of it on the fly. After all data
+ * is stored, @ref anj_persistence_crc_finish must be called to append the CRC.
+ * @param[out] crc_ctx  State of the context, must remain valid as long as the
+ *                      returned context is used.
+ * @param      write_cb Callback to use for writing data.
+ * @param      ctx      User context passed to the write callback.
+ * @return Persistence context.
+ */
+anj_persistence_context_t
+anj_persistence_crc_store_context_create(anj_persistence_crc_t *crc_ctx,
+                                         anj_persistence_write_cb_t *write_cb,
+                                         void *ctx);
+
+/**
+ * Creates a persistence context for restoring data stored with
+ * @ref anj_persistence_crc_store_context_create. After all data is restored,
+ * @ref anj_persistence_crc_finish checks the CRC.
+ * @note Restored items are applied as they are read, so this alone detects
+ *       corruption only after the fact. Call
+ *       @ref anj_persistence_crc_verify on the blob first to reject it before
+ *       any state is modified.
+ * @param[out] crc_ctx State of the context, must remain valid as long as the
+ *                     returned context is used.
+ * @param      read_cb Callback to use for reading data.
+ * @param      ctx     User context passed to the read callback.
+ * @return Persistence context.
+ */
+anj_persistence_context_t
+anj_persistence_crc_restore_context_create(anj_persistence_crc_t *crc_ctx,
+                                           anj_persistence_read_cb_t *read_cb,
+                                           void *ctx);
+
+/**
+ * Finishes a blob: appends the CRC in STORE direction; reads the CRC and
+ * compares it with the one computed over restored data in RESTORE direction.
+ * @param crc_ctx State of the context.
+ * @return 0 on success, negative value on error or CRC mismatch.
+ */
+int anj_persistence_crc_finish(anj_persistence_crc_t *crc_ctx);
+
+/**
+ * Reads a whole blob stored with @ref anj_persistence_crc_store_context_create
+ * and checks its CRC, without interpreting the content. The medium has to be
+ * rewound before the actual restore.
+ * @param read_cb   Callback to use for reading data.
+ * @param ctx       User context passed to the read callback.
+ * @param blob_size Size of the blob, including
+ *                  @ref ANJ_PERSISTENCE_CRC_SIZE bytes of the CRC.
+ * @return 0 if the CRC matches, negative value otherwise.
+ */
+int anj_persistence_crc_verify(anj_persistence_read_cb_t *read_cb,
+                               void *ctx,
+                               size_t blob_size);
+#        endif // ANJ_PERSISTENCE_WITH_INTEGRITY_CHECK
+
+#        ifdef ANJ_PERSISTENCE_WITH_MEMORY_MAPPED_RESTORE
+/**
+ * State of a memory-mapped restore context, see
+ * @ref anj_persistence_memory_restore_context_create.
+ *
+ * @anj_internal_fields_do_not_use
+ */
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    size_t offset;
+} anj_persistence_memory_t;
+
+/**
+ * Creates a persistence context for restoring data from a blob that is
+ * directly addressable, e.g. stored in memory-mapped (XIP) flash.
+ *
+ * Items are copied straight from the blob, and @ref anj_persistence_bytes_ref
+ * references them in place. Reading past the end of the blob fails.
+ *
+ * @param[out] memory_ctx State of the context, must remain valid as long as
+ *                        the returned context is used.
+ * @param      data       Start of the blob.
+ * @param      size       Size of the blob.
+ *
+ * @return Persistence context.
+ */
+anj_persistence_context_t anj_persistence_memory_restore_context_create(
+        anj_persistence_memory_t *memory_ctx,
+        const void *data,
+        size_t size);
+
+/**
+ * Checks whether the persistence context was created with
+ * @ref anj_persistence_memory_restore_context_create, i.e. whether
+ * @ref anj_persistence_bytes_ref may be used to restore data.
+ *
+ * @param ctx Persistence context.
+ *
+ * @return true for a memory-mapped restore context, false otherwise.
+ */
+bool anj_persistence_memory_mapped(const anj_persistence_context_t *ctx);
+
+/**
+ * Stores or references a fixed-size byte buffer.
+ *
+ * - In STORE mode: writes exactly @p size bytes from @p *inout_data, like
+ *   @ref anj_persistence_bytes.
+ * - In RESTORE mode: sets @p *inout_data to the next @p size bytes of the blob,
+ *   without copying them. Only memory-mapped restore contexts are supported,
+ *   see @ref anj_persistence_memory_mapped.
+ *
+ * @param        ctx        Persistence context.
+ * @param[inout] inout_data Data to write, or the restored data location.
+ * @param        size       Number of bytes.
+ *
+ * @return 0 on success, negative value on error.
+ */
+int anj_persistence_bytes_ref(const anj_persistence_context_t *ctx,
+                              const void **inout_data,
+                              size_t size);
+#        endif // ANJ_PERSISTENCE_WITH_MEMORY_MAPPED_RESTORE
+
 /**
  * Returns the direction of the persistence context.
  */
@@ -188,6 +395,28 @@ int anj_persistence_magic(const anj_persistence_context_t *ctx,
                           const void *magic,
                           size_t magic_size);
 
+/**
+ * Writes or verifies a “magic” tag followed by a format version.
+ * - In STORE mode: writes @p magic and @p version.
+ * - In RESTORE mode: verifies @p magic and reads the version, which must be
+ *   between 1 and @p version, so that blobs stored by older versions of the
+ *   code are still accepted.
+ * @param      ctx         Persistence context.
+ * @param      magic       Pointer to expected/actual magic bytes.
+ * @param      magic_size  Number of bytes
+ *                         (<= @ref ANJ_PERSISTENCE_MAGIC_MAX_SIZE).
+ * @param      version     Current version of the format.
+ * @param[out] out_version Version of the blob, equal to @p version in STORE
+ *                         mode. May be NULL.
+ * @return 0 on success, negative value on error, mismatch or unsupported
+ *         version (RESTORE).
+ */
+int anj_persistence_version(const anj_persistence_context_t *ctx,
+                            const void *magic,
+                            size_t magic_size,
+                            uint8_t version,
+                            uint8_t *out_version);
+
 /** Stores/restores a boolean value. */
 static inline int anj_persistence_bool(const anj_persistence_context_t *ctx,
                                        bool *inout_value) {
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+/**
+ * @file
+ * @brief Incremental persistence of the default Security, Server and NTP
+ *        Objects.
+ *
+ * Each Object is stored as a separate record, only if it changed since it was
+ * last stored or restored. A record consists of a header (format version,
+ * slot, sequence number and payload size), the payload produced by the
+ * Object's store function and a CRC-32 of all preceding bytes.
+ *
+ * Where a record is written is decided by the integration. Writing each record
+ * to the older of two areas reserved for its slot keeps the previous copy
+ * intact until the new one is complete, and spreads erase cycles over both
+ * areas. On startup the newest record with a valid CRC is restored.
+ */
+
+#ifndef ANJ_PERSISTENCE_SLOTS_H
+#    define ANJ_PERSISTENCE_SLOTS_H
+
+#    include <stddef.h>
+#    include <stdint.h>
+
+#    include <anj/core.h>
+#    include <anj/persistence.h>
+
+#    ifdef ANJ_WITH_DEFAULT_SECURITY_OBJ
+#        include <anj/dm/security_object.h>
+#    endif // ANJ_WITH_DEFAULT_SECURITY_OBJ
+
+#    ifdef ANJ_WITH_DEFAULT_SERVER_OBJ
+#        include <anj/dm/server_object.h>
+#    endif // ANJ_WITH_DEFAULT_SERVER_OBJ
+
+#    ifdef ANJ_WITH_NTP
+#        include <anj/ntp.h>
+#    endif // ANJ_WITH_NTP
+
+#    ifdef __cplusplus
+extern "C" {
+#    endif
+
+#    ifdef ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
+
+/**
+ * Size of the record header and the CRC, in addition to the payload.
+ */
+#        define ANJ_PERSISTENCE_RECORD_OVERHEAD 17
+
+/** Record slots, one per Object. */
+typedef enum {
+    ANJ_PERSISTENCE_SLOT_SECURITY_OBJ,
+    ANJ_PERSISTENCE_SLOT_SERVER_OBJ,
+    ANJ_PERSISTENCE_SLOT_NTP_OBJ,
+    ANJ_PERSISTENCE_SLOT_COUNT
+} anj_persistence_slot_t;
+
+/**
+ * Objects handled by @ref anj_persistence_store_dirty and
+ * @ref anj_persistence_record_restore. Objects set to @c NULL are skipped.
+ */
+typedef struct {
+#        ifdef ANJ_WITH_DEFAULT_SECURITY_OBJ
+    anj_dm_security_obj_t *security_obj;
+#        endif // ANJ_WITH_DEFAULT_SECURITY_OBJ
+#        ifdef ANJ_WITH_DEFAULT_SERVER_OBJ
+    anj_dm_server_obj_t *server_obj;
+#        endif // ANJ_WITH_DEFAULT_SERVER_OBJ
+#        ifdef ANJ_WITH_NTP
+    anj_ntp_t *ntp;
+#        endif // ANJ_WITH_NTP
+} anj_persistence_objects_t;
+
+/**
+ * Called before a record is written.
+ *
+ * @param ctx         User context.
+ * @param slot        Slot of the record.
+ * @param record_size Exact size of the whole record, e.g. to erase the area.
+ *
+ * @return 0 on success, negative value on error.
+ */
+typedef int anj_persistence_slot_begin_cb_t(void *ctx,
+                                            anj_persistence_slot_t slot,
+                                            size_t record_size);
+
+/**
+ * Called after the whole record is written, e.g. to mark the area as the
+ * current one.
+ *
+ * @return 0 on success, negative value on error.
+ */
+typedef int anj_persistence_slot_end_cb_t(void *ctx,
+                                          anj_persistence_slot_t slot);
+
+/** Callbacks used to write the records. */
+typedef struct {
+    anj_persistence_slot_begin_cb_t *begin;
+    /** Writes next bytes of the record started by @ref begin. */
+    anj_persistence_write_cb_t *write;
+    anj_persistence_slot_end_cb_t *end;
+    void *ctx;
+} anj_persistence_slots_t;
+
+/**
+ * Stores every Object from @p objects that changed since it was last stored
+ * or restored, each as a separate record. Objects are marked as changed when
+ * initialized and after each successful LwM2M transaction on them.
+ *
+ * @param anj            Anjay object.
+ * @param objects        Objects to store.
+ * @param slots          Callbacks used to write the records.
+ * @param inout_sequence Sequence number written to the next record, it is
+ *                       incremented for each record stored. Should be set to
+ *                       the highest sequence number found on startup plus one.
+ *
+ * @return 0 on success, negative value if any of the records failed. Objects
+ *         whose records failed remain marked as changed.
+ */
+int anj_persistence_store_dirty(anj_t *anj,
+                                const anj_persistence_objects_t *objects,
+                                const anj_persistence_slots_t *slots,
+                                uint32_t *inout_sequence);
+
+/**
+ * Checks the format and the CRC of a record.
+ *
+ * @param      record       Record, as written by
+ *                          @ref anj_persistence_store_dirty. May be followed
+ *                          by any data, e.g. erased flash.
+ * @param      size         Number of bytes available at @p record.
+ * @param[out] out_slot     Slot of the record.
+ * @param[out] out_sequence Sequence number of the record.
+ *
+ * @return 0 if the record is valid, negative value otherwise.
+ */
+int anj_persistence_record_verify(const void *record,
+                                  size_t size,
+                                  anj_persistence_slot_t *out_slot,
+                                  uint32_t *out_sequence);
+
+/**
+ * Verifies a record and restores the Object it belongs to. Must be called
+ * before the Object is installed, as its restore function.
+ *
+ * @param anj     Anjay object.
+ * @param objects Objects to restore; the one for the slot of the record must
+ *                be set.
+ * @param record  Record, as written by @ref anj_persistence_store_dirty.
+ * @param size    Number of bytes available at @p record.
+ *
+ * @return 0 on success, negative value on error.
+ */
+int anj_persistence_record_restore(anj_t *anj,
+                                   const anj_persistence_objects_t *objects,
+                                   const void *record,
+                                   size_t size);
+
+#    endif // ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
+
+#    ifdef __cplusplus
+}
+#    endif
+
+#endif // ANJ_PERSISTENCE_SLOTS_H
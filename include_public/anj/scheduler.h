@@ -0,0 +1,161 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+/**
+ * @file
+ * @brief Computes when the main loop has to wake up next.
+ *
+ * Aggregates the timing of @ref anj_core_step, @ref anj_ntp_step and
+ * @ref anj_coap_downloader_step, so that an application running on a tickless
+ * system can sleep until the next required action instead of calling all step
+ * functions at a fixed rate.
+ */
+
+#ifndef ANJ_SCHEDULER_H
+#    define ANJ_SCHEDULER_H
+
+#    include <stdbool.h>
+
+#    include <anj/core.h>
+#    include <anj/defs.h>
+#    include <anj/time.h>
+
+#    ifdef ANJ_WITH_COAP_DOWNLOADER
+#        include <anj/coap_downloader.h>
+#    endif // ANJ_WITH_COAP_DOWNLOADER
+
+#    ifdef ANJ_WITH_NTP
+#        include <anj/ntp.h>
+#    endif // ANJ_WITH_NTP
+
+#    ifdef ANJ_NET_WITH_POLL_HANDLE
+#        include <anj/compat/net/anj_net_api.h>
+#    endif // ANJ_NET_WITH_POLL_HANDLE
+
+#    ifdef __cplusplus
+extern "C" {
+#    endif
+
+#    ifdef ANJ_WITH_SCHEDULER
+
+/**
+ * Module whose step function determines the wake-up time, see
+ * @ref anj_scheduler_wakeup_t.
+ */
+typedef enum {
+    /** None of the modules has anything scheduled. */
+    ANJ_SCHEDULER_REASON_NONE = 0,
+
+    /** @ref anj_core_step is due. */
+    ANJ_SCHEDULER_REASON_CORE = 1,
+
+    /** @ref anj_ntp_step is due. */
+    ANJ_SCHEDULER_REASON_NTP = 2,
+
+    /** @ref anj_coap_downloader_step is due. */
+    ANJ_SCHEDULER_REASON_COAP_DOWNLOADER = 3
+} anj_scheduler_reason_t;
+
+/**
+ * Modules taken into account by @ref anj_scheduler_next_wakeup. Any of the
+ * pointers may be @c NULL, the module is then ignored.
+ */
+typedef struct {
+    /** Anjay object, its timing is taken from @ref anj_core_next_step_time or,
+     * if @ref ANJ_NET_WITH_POLL_HANDLE is enabled, from
+     * @ref anj_core_next_wakeup. */
+    anj_t *anj;
+#        ifdef ANJ_WITH_NTP
+    /** NTP module state, see @ref anj_ntp_next_step_time. */
+    anj_ntp_t *ntp;
+#        endif // ANJ_WITH_NTP
+#        ifdef ANJ_WITH_COAP_DOWNLOADER
+    /** CoAP downloader state, see @ref anj_coap_downloader_next_step_time. */
+    anj_coap_downloader_t *coap_downloader;
+#        endif // ANJ_WITH_COAP_DOWNLOADER
+} anj_scheduler_sources_t;
+
+/**
+ * Result of @ref anj_scheduler_next_wakeup.
+ */
+typedef struct {
+    /**
+     * Time until the earliest step call is required. Set to
+     * @ref ANJ_TIME_DURATION_INVALID if there is no time limit, i.e. the
+     * application may sleep until an external event (or, if @ref wait_for_net
+     * is set, until @ref net_handle becomes readable).
+     */
+    anj_time_duration_t timeout;
+
+    /** Module whose step function is due when @ref timeout expires. */
+    anj_scheduler_reason_t reason;
+
+#        ifdef ANJ_NET_WITH_POLL_HANDLE
+    /**
+     * Set if @ref anj_core_step should also be called as soon as
+     * @ref net_handle becomes readable, see @ref ANJ_CORE_WAKEUP_NET_OR_TIMER.
+     */
+    bool wait_for_net;
+
+    /** Handle of the LwM2M Server connection, valid if @ref wait_for_net is
+     * set. */
+    anj_net_poll_handle_t net_handle;
+#        endif // ANJ_NET_WITH_POLL_HANDLE
+} anj_scheduler_wakeup_t;
+
+/**
+ * Computes how long the main loop may sleep before calling the step functions
+ * of the given modules again.
+ *
+ * The earliest of the deadlines reported by the modules is returned in
+ * @p out_wakeup, together with the module it comes from. If several modules
+ * are due at the same time, the first one in the order of
+ * @ref anj_scheduler_sources_t fields is reported. After waking up, the
+ * application may call the step functions of all the modules, they do nothing
+ * if there is nothing to do.
+ *
+ * Example use in a main loop:
+ * @code
+ * anj_scheduler_sources_t sources = {
+ *     .anj = &anj,
+ *     .ntp = &ntp
+ * };
+ * while (true) {
+ *     anj_core_step(&anj);
+ *     anj_ntp_step(&ntp);
+ *     anj_scheduler_wakeup_t wakeup;
+ *     anj_scheduler_next_wakeup(&sources, &wakeup);
+ *     // sleep for wakeup.timeout (forever if invalid), or until
+ *     // wakeup.net_handle becomes readable if wakeup.wait_for_net is set
+ * }
+ * @endcode
+ *
+ * @note The CoAP downloader and the NTP module receive responses by polling
+ *       their sockets in their step functions, so while they wait for a
+ *       response @ref ANJ_TIME_DURATION_ZERO is returned.
+ *
+ * @note Like in case of @ref anj_core_next_step_time, the result becomes
+ *       outdated if any other API function is called, e.g. the data model is
+ *       changed or a download is started.
+ *
+ * @param      sources    Modules to take into account.
+ * @param[out] out_wakeup Computed wake-up time and its reason.
+ */
+void anj_scheduler_next_wakeup(const anj_scheduler_sources_t *sources,
+                               anj_scheduler_wakeup_t *out_wakeup);
+
+#    endif // ANJ_WITH_SCHEDULER
+
+#    ifdef __cplusplus
+}
+#    endif
+
+#endif // ANJ_SCHEDULER_H
@@ -36,7 +36,9 @@
 #    define ANJ_TIME_H
 
 #    include <inttypes.h>
-#    include <math.h>
+#    ifndef ANJ_TIME_INTEGER_ONLY
+#        include <math.h>
+#    endif // ANJ_TIME_INTEGER_ONLY
 #    include <stdbool.h>
 #    include <stddef.h>
 #    include <stdint.h>
@@ -159,6 +161,7 @@ extern const anj_time_monotonic_t ANJ_TIME_MONOTONIC_INVALID;
  */
 anj_time_duration_t anj_time_duration_new(int64_t scalar, anj_time_unit_t unit);
 
+#    ifndef ANJ_TIME_INTEGER_ONLY
 /**
  * @brief Creates a duration from a floating-point scalar in the given @p unit.
  *
@@ -172,6 +175,7 @@ anj_time_duration_t anj_time_duration_new(int64_t scalar, anj_time_unit_t unit);
  *          conversion to integer microseconds.
  */
 anj_time_duration_t anj_time_duration_fnew(double scalar, anj_time_unit_t unit);
+#    endif // ANJ_TIME_INTEGER_ONLY
 
 /**
  * @brief Converts a duration to an integer scalar in the given @p unit.
@@ -185,6 +189,7 @@ anj_time_duration_t anj_time_duration_fnew(double scalar, anj_time_unit_t unit);
 int64_t anj_time_duration_to_scalar(anj_time_duration_t duration,
                                     anj_time_unit_t unit);
 
+#    ifndef ANJ_TIME_INTEGER_ONLY
 /**
  * @brief Converts a duration to a floating-point scalar in the given @p unit.
  *
@@ -194,6 +199,7 @@ int64_t anj_time_duration_to_scalar(anj_time_duration_t duration,
  */
 double anj_time_duration_to_fscalar(anj_time_duration_t duration,
                                     anj_time_unit_t unit);
+#    endif // ANJ_TIME_INTEGER_ONLY
 
 /**
  * @brief Checks whether a duration value is valid.
@@ -271,6 +277,7 @@ anj_time_duration_mul(const anj_time_duration_t duration,
     return result;
 }
 
+#    ifndef ANJ_TIME_INTEGER_ONLY
 /**
  * @brief Multiplies a duration by a floating-point factor.
  *
@@ -296,6 +303,7 @@ anj_time_duration_fmul(const anj_time_duration_t duration,
                                                     * factor) };
     return result;
 }
+#    endif // ANJ_TIME_INTEGER_ONLY
 
 /**
  * @brief Divides a duration by an integer divisor.
@@ -451,6 +459,7 @@ anj_time_monotonic_new(const int64_t scalar, const anj_time_unit_t unit) {
             anj_time_duration_new(scalar, unit));
 }
 
+#    ifndef ANJ_TIME_INTEGER_ONLY
 /**
  * @brief Creates a monotonic timestamp from a floating-point scalar and unit.
  *
@@ -463,6 +472,7 @@ anj_time_monotonic_fnew(const double scalar, const anj_time_unit_t unit) {
     return anj_time_monotonic_from_duration(
             anj_time_duration_fnew(scalar, unit));
 }
+#    endif // ANJ_TIME_INTEGER_ONLY
 
 /**
  * @brief Checks whether a monotonic timestamp is valid.
@@ -489,6 +499,7 @@ anj_time_monotonic_to_scalar(const anj_time_monotonic_t time,
                                        unit);
 }
 
+#    ifndef ANJ_TIME_INTEGER_ONLY
 /**
  * @brief Converts a monotonic timestamp to a floating-point scalar.
  *
@@ -502,6 +513,7 @@ anj_time_monotonic_to_fscalar(const anj_time_monotonic_t time,
     return anj_time_duration_to_fscalar(anj_time_monotonic_to_duration(time),
                                         unit);
 }
+#    endif // ANJ_TIME_INTEGER_ONLY
 
 /**
  * @brief Adds a relative duration to a monotonic timestamp.
@@ -628,6 +640,7 @@ static inline anj_time_real_t anj_time_real_new(const int64_t scalar,
     return anj_time_real_from_duration(anj_time_duration_new(scalar, unit));
 }
 
+#    ifndef ANJ_TIME_INTEGER_ONLY
 /**
  * @brief Creates a real timestamp from a floating-point scalar and unit.
  *
@@ -639,6 +652,7 @@ static inline anj_time_real_t anj_time_real_fnew(const double scalar,
                                                  const anj_time_unit_t unit) {
     return anj_time_real_from_duration(anj_time_duration_fnew(scalar, unit));
 }
+#    endif // ANJ_TIME_INTEGER_ONLY
 
 /**
  * @brief Converts a real timestamp to an integer scalar in the given unit.
@@ -652,6 +666,7 @@ static inline int64_t anj_time_real_to_scalar(const anj_time_real_t time,
     return anj_time_duration_to_scalar(anj_time_real_to_duration(time), unit);
 }
 
+#    ifndef ANJ_TIME_INTEGER_ONLY
 /**
  * @brief Converts a real timestamp to a floating-point scalar.
  *
@@ -663,6 +678,7 @@ static inline double anj_time_real_to_fscalar(const anj_time_real_t time,
                                               const anj_time_unit_t unit) {
     return anj_time_duration_to_fscalar(anj_time_real_to_duration(time), unit);
 }
+#    endif // ANJ_TIME_INTEGER_ONLY
 
 /**
  * @brief Checks whether a real timestamp is valid.
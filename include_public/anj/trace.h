@@ -0,0 +1,147 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+/**
+ * @file
+ * @brief Recorder of the LwM2M client state transitions.
+ *
+ * Timestamped events are written to a ring buffer whenever the connection
+ * status changes, an exchange with the LwM2M Server starts, changes its state
+ * or finishes, a data model operation is performed, the observations are
+ * scanned and a message is sent or received. Once the buffer is full, the
+ * oldest events are overwritten.
+ *
+ * The events can be read with @ref anj_core_trace_read, or exported in the
+ * Trace Event Format understood by Perfetto and chrome://tracing with
+ * @ref anj_core_trace_export_json, which shows where the time of each step
+ * goes.
+ */
+
+#ifndef ANJ_TRACE_H
+#    define ANJ_TRACE_H
+
+#    include <stddef.h>
+#    include <stdint.h>
+
+#    include <anj/defs.h>
+#    include <anj/time.h>
+
+#    ifdef __cplusplus
+extern "C" {
+#    endif
+
+#    ifdef ANJ_WITH_TRACE
+
+/** Source of a trace event. */
+typedef enum {
+    /** Connection status; value is the @ref anj_conn_status_t. */
+    ANJ_TRACE_EVENT_CONN_STATUS,
+    /**
+     * Exchange with the LwM2M Server. Value of the begin event is the
+     * operation, value of the end event is the result of the exchange (0 on
+     * success) and value of the instant events is the new exchange state.
+     */
+    ANJ_TRACE_EVENT_EXCHANGE,
+    /**
+     * Data model operation. Value of the begin event is the operation, value
+     * of the end event is the @ref anj_dm_transaction_result_t.
+     */
+    ANJ_TRACE_EVENT_DM_OPERATION,
+    /**
+     * Scan of the observations for notifications to send. Value of the end
+     * event is the operation of the notification, if there is one to send.
+     */
+    ANJ_TRACE_EVENT_OBSERVE_SCAN,
+    /**
+     * Message sent. Value of the end event is the size of the message on
+     * success, or the negative result of the network API call.
+     */
+    ANJ_TRACE_EVENT_NET_SEND,
+    /** Message received; value is the number of bytes received. */
+    ANJ_TRACE_EVENT_NET_RECV
+} anj_trace_event_type_t;
+
+/** Phase of a trace event. */
+typedef enum {
+    ANJ_TRACE_PHASE_BEGIN,
+    ANJ_TRACE_PHASE_END,
+    ANJ_TRACE_PHASE_INSTANT
+} anj_trace_phase_t;
+
+/** Single event, as stored in the ring buffer. */
+typedef struct {
+    anj_time_monotonic_t timestamp;
+    int32_t value;
+    /** @ref anj_trace_event_type_t */
+    uint8_t type;
+    /** @ref anj_trace_phase_t */
+    uint8_t phase;
+} anj_trace_event_t;
+
+/** @anj_internal_api_do_not_use */
+typedef struct {
+    anj_trace_event_t events[ANJ_TRACE_BUFFER_SIZE];
+    size_t head;
+    size_t count;
+    uint32_t dropped;
+} _anj_trace_t;
+
+/**
+ * Moves the oldest recorded events out of the ring buffer.
+ *
+ * @param      anj        Anjay object to operate on.
+ * @param[out] out_events Array to fill, in chronological order.
+ * @param      max_count  Size of @p out_events.
+ *
+ * @return Number of events written to @p out_events.
+ */
+size_t anj_core_trace_read(anj_t *anj,
+                           anj_trace_event_t *out_events,
+                           size_t max_count);
+
+/**
+ * Returns the number of events overwritten before they were read, since
+ * @ref anj_core_init or the last call to this function.
+ *
+ * @param anj Anjay object to operate on.
+ */
+uint32_t anj_core_trace_dropped(anj_t *anj);
+
+/**
+ * Returns the name of the event source, as used by
+ * @ref anj_core_trace_export_json.
+ */
+const char *anj_trace_event_name(anj_trace_event_type_t type);
+
+#        ifdef ANJ_WITH_TRACE_POSIX_EXPORTER
+/**
+ * Moves all recorded events out of the ring buffer and writes them to
+ * @p fd as a JSON Object Format trace, e.g. to be loaded into
+ * https://ui.perfetto.dev. Each event source is shown as a separate track.
+ *
+ * Phases of events overwritten before the export are not matched, so the
+ * first spans of the trace may be incomplete.
+ *
+ * @param anj Anjay object to operate on.
+ * @param fd  File descriptor to write to.
+ *
+ * @return 0 on success, -1 if writing failed.
+ */
+int anj_core_trace_export_json(anj_t *anj, int fd);
+#        endif // ANJ_WITH_TRACE_POSIX_EXPORTER
+
+#    endif // ANJ_WITH_TRACE
+
+#    ifdef __cplusplus
+}
+#    endif
+
+#endif // ANJ_TRACE_H
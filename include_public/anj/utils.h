@@ -257,7 +257,9 @@ size_t anj_int64_to_string_value(char *out_buff, int64_t value);
  * infinities are emitted as <tt>"nan"</tt> and <tt>"inf"</tt>.
  *
  * If @ref ANJ_WITH_CUSTOM_CONVERSION_FUNCTIONS is enabled, a lightweight
- * formatter is used (may incur rounding error at extreme magnitudes).
+ * formatter is used (may incur rounding error at extreme magnitudes). If
+ * @ref ANJ_WITH_FAST_NUMBER_FORMATTING is enabled, the shortest string that
+ * converts back to the same value is produced.
  *
  * The buffer must be at least @ref ANJ_DOUBLE_STR_MAX_LEN bytes long.
  *
@@ -344,6 +346,11 @@ int anj_string_to_objlnk_value(anj_objlnk_value_t *out, const char *objlnk);
  *       The caller must explicitly provide the length in @p buff_len
  *       (e.g., using @c strlen() if the content is null-terminated).
  *
+ * If @ref ANJ_WITH_FAST_NUMBER_PARSING is enabled, the result is independent of
+ * the C library and correctly rounded for up to 19 significant digits, values
+ * out of the @c double range are rejected and values below the smallest
+ * subnormal number are parsed as zero.
+ *
  * @return 0 on success, -1 on error (empty input, invalid characters, etc.).
  */
 int anj_string_to_double_value(double *out_val,
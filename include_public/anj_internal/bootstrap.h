@@ -63,6 +63,9 @@ typedef struct {
     anj_time_monotonic_t bootstrap_finish_timeout;
     int error_code;
     const char *endpoint;
+#    ifdef ANJ_WITH_BOOTSTRAP_PACK
+    bool pack_rejected;
+#    endif // ANJ_WITH_BOOTSTRAP_PACK
 } _anj_bootstrap_ctx_t;
 
 #endif // ANJ_WITH_BOOTSTRAP
@@ -34,8 +34,14 @@ typedef enum {
     // option is always encoded with number=0 and more_flag=1, BLOCK1 option is
     // always encoded with more_flag=0. Both options size is set to the same
     // value.
-    ANJ_OPTION_BLOCK_BOTH
+    ANJ_OPTION_BLOCK_BOTH,
 #endif // ANJ_WITH_COMPOSITE_OPERATIONS
+#ifdef ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+    // Q-Block2 option (RFC 9177), decoded only in responses. In requests
+    // @ref _anj_block_t.count consecutive options are encoded, starting with
+    // the given number, to request these blocks with a single message.
+    ANJ_OPTION_Q_BLOCK_2
+#endif // ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
 } _anj_block_option_t;
 
 /** @anj_internal_api_do_not_use */
@@ -78,6 +84,10 @@ typedef enum {
     ANJ_OP_COAP_RESET,
     ANJ_OP_COAP_PING_UDP,
     ANJ_OP_COAP_EMPTY_MSG,
+#ifdef _ANJ_COAP_WITH_TCP
+    // CoAP over TCP signaling message, see RFC 8323, section 5
+    ANJ_OP_COAP_TCP_SIGNALING,
+#endif // _ANJ_COAP_WITH_TCP
 } _anj_op_t;
 
 /**
@@ -89,6 +99,9 @@ typedef struct {
     bool more_flag;
     uint32_t number;
     uint16_t size;
+#ifdef ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+    uint8_t count;
+#endif // ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
 } _anj_block_t;
 
 /**
@@ -312,6 +325,16 @@ typedef struct {
      */
     anj_uri_path_t uri;
 
+#ifdef ANJ_WITH_LWM2M_GATEWAY
+    /**
+     * Prefix of the End IoT Device addressed by a LwM2M request, i.e. the
+     * first Uri-Path option if it's not a number, which is not included in
+     * @ref uri. Points into the message buffer, NULL if not present.
+     */
+    const char *gateway_prefix;
+    size_t gateway_prefix_len;
+#endif // ANJ_WITH_LWM2M_GATEWAY
+
     /**
      * Stores the value of Block option. If block type is defined
      * @ref anj_coap_encode_udp will add block
@@ -351,12 +374,89 @@ typedef struct {
      */
     _anj_coap_binding_data_udp_t coap_binding_data;
 
+#ifdef ANJ_WITH_SEPARATE_RESPONSE
+    /**
+     * If set, message with @ref ANJ_OP_RESPONSE operation is encoded as a
+     * Confirmable separate response instead of a piggybacked one.
+     */
+    bool separate_response;
+#endif // ANJ_WITH_SEPARATE_RESPONSE
+
+#ifdef ANJ_LWM2M_SEND_WITH_NO_RESPONSE
+    /**
+     * If set, the No-Response option (RFC 7967) suppressing 2.xx responses is
+     * added to the LwM2M Send request.
+     */
+    bool no_response;
+#endif // ANJ_LWM2M_SEND_WITH_NO_RESPONSE
+
     /**
      * Token used in CoAP message. Unique for every exchange.
      */
     _anj_coap_token_t token;
+
+#ifdef ANJ_WITH_ETAG
+    /**
+     * Stores the value of ETag option. In @ref anj_coap_decode_udp set to the
+     * first ETag option of a LwM2M request, @ref anj_coap_encode_udp adds the
+     * option if @p size is not 0.
+     */
+    _anj_etag_t etag;
+#endif // ANJ_WITH_ETAG
 } _anj_coap_msg_t;
 
+/**
+ * @anj_internal_api_do_not_use
+ * Single CoAP option of a message being encoded or decoded, pointing into the
+ * message buffer.
+ */
+typedef struct anj_coap_option {
+    const uint8_t *payload;
+    size_t payload_len;
+    uint16_t option_number;
+} anj_coap_option_t;
+
+/**
+ * @anj_internal_api_do_not_use
+ * Size of the buffer for serialized options of @ref _anj_coap_msg_template_t:
+ * every Location-Path (or a fixed Uri-Path) with up to 3 bytes of option
+ * header, and Content-Format option of at most 3 bytes. One more byte is needed
+ * because options are never allowed to fill the buffer completely.
+ */
+#define _ANJ_COAP_MSG_TEMPLATE_BUFF_SIZE                                       \
+    (ANJ_COAP_MAX_LOCATION_PATHS_NUMBER * (3 + ANJ_COAP_MAX_LOCATION_PATH_SIZE) \
+     + 3 + 1)
+
+/**
+ * @anj_internal_api_do_not_use
+ * Uri-Path and Content-Format options of the last message of a given kind,
+ * serialized with option deltas relative to option number 0.
+ */
+typedef struct {
+    /** Set if the fields below describe a valid template. */
+    bool valid;
+    /** Value of Content-Format option, or _ANJ_COAP_FORMAT_NOT_DEFINED if the
+     * message had no payload. */
+    uint16_t content_format;
+    /** Location-Paths of UPDATE message, pointing into @ref buff. */
+    uint16_t location_offset[ANJ_COAP_MAX_LOCATION_PATHS_NUMBER];
+    uint16_t location_len[ANJ_COAP_MAX_LOCATION_PATHS_NUMBER];
+    uint16_t location_count;
+    uint16_t size;
+    uint8_t buff[_ANJ_COAP_MSG_TEMPLATE_BUFF_SIZE];
+} _anj_coap_msg_template_t;
+
+/**
+ * @anj_internal_api_do_not_use
+ * Templates of outgoing messages, see @ref ANJ_COAP_WITH_MSG_TEMPLATES. Must be
+ * zeroed before first use.
+ */
+typedef struct {
+    _anj_coap_msg_template_t update;
+    _anj_coap_msg_template_t notify;
+    _anj_coap_msg_template_t send;
+} _anj_coap_msg_templates_t;
+
 #ifdef __cplusplus
 }
 #endif
@@ -24,6 +24,64 @@ extern "C" {
 
 #ifdef ANJ_WITH_COAP_DOWNLOADER
 
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW
+/**
+ * @anj_internal_api_do_not_use
+ * Single outstanding Block2 request of the CoAP downloader. With Q-Block2,
+ * slots of blocks requested with a single message share the token and
+ * message ID.
+ */
+typedef struct {
+    _anj_coap_token_t token;
+    uint16_t msg_id;
+    uint32_t block_number;
+    uint16_t retry_count;
+    anj_time_duration_t timeout;
+    anj_time_monotonic_t timeout_timestamp;
+    bool in_use;
+    bool received;
+    size_t payload_len;
+    uint8_t payload[ANJ_COAP_DOWNLOADER_MAX_MSG_SIZE];
+} _anj_coap_downloader_block_slot_t;
+
+/**
+ * @anj_internal_api_do_not_use
+ * State of the download with multiple outstanding Block2 requests.
+ */
+typedef struct {
+    _anj_coap_downloader_block_slot_t
+            slots[ANJ_COAP_DOWNLOADER_BLOCK_WINDOW_SIZE];
+    uint8_t size;
+    uint16_t block_size;
+    bool block_size_confirmed;
+    uint32_t next_block_to_request;
+    uint32_t next_block_to_deliver;
+    uint32_t last_block;
+    int error_code;
+    uint32_t error_block;
+    bool send_pending;
+#        ifdef ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+    // requested in the configuration, and still used for the download
+    bool q_block2_enabled;
+    bool q_block2;
+#        endif // ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+} _anj_coap_downloader_block_window_t;
+#    endif // ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW
+
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_RESUME
+/**
+ * @anj_internal_api_do_not_use
+ * Progress of the download that can be persisted and resumed. Empty @p uri
+ * means there is nothing to resume.
+ */
+typedef struct {
+    char uri[ANJ_SERVER_URI_MAX_SIZE];
+    _anj_etag_t etag;
+    uint32_t next_block;
+    uint16_t block_size;
+} _anj_coap_downloader_progress_t;
+#    endif // ANJ_COAP_DOWNLOADER_WITH_RESUME
+
 /**
  * @anj_internal_api_do_not_use
  * CoAP downloader context structure.
@@ -50,6 +108,31 @@ typedef struct _anj_coap_downloader_struct {
     uint8_t port_len;
     anj_net_binding_type_t binding;
     _anj_etag_t etag;
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+    anj_t *anj;
+    bool shared_connection;
+#    endif // ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW
+    _anj_coap_downloader_block_window_t window;
+#    endif // ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_RESUME
+    _anj_coap_downloader_progress_t progress;
+    uint32_t first_block;
+    uint16_t first_block_size;
+    bool resume_pending;
+    uint16_t response_block_size;
+#    endif // ANJ_COAP_DOWNLOADER_WITH_RESUME
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
+    anj_coap_downloader_t *multiplex_with;
+    // downloader owning the connection, set while the transfer is attached
+    anj_coap_downloader_t *mux_owner;
+    // list of the transfers attached to the owner, linked by mux_next
+    anj_coap_downloader_t *mux_transfers;
+    anj_coap_downloader_t *mux_next;
+    // datagrams of the whole group are received here, msg_buffer of any
+    // transfer may hold a request that is not sent yet
+    uint8_t mux_in_buffer[ANJ_COAP_DOWNLOADER_MAX_MSG_SIZE];
+#    endif // ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
 } _anj_coap_downloader_t;
 
 #endif // ANJ_WITH_COAP_DOWNLOADER
@@ -51,14 +51,169 @@ extern "C" {
 #    define _ANJ_LWM2M_VERSION_STR "1.1"
 #endif // ANJ_WITH_LWM2M12
 
+#ifdef ANJ_DM_WITH_CHANGE_QUEUE
+/**
+ * @anj_internal_api_do_not_use
+ * Entry of the queue of data model changes. @p seq is accessed atomically and
+ * tells whether the entry is free or filled for the given queue position.
+ */
+typedef struct {
+    uint32_t seq;
+    anj_uri_path_t path;
+    anj_core_change_type_t change_type;
+} _anj_dm_change_queue_entry_t;
+
+/**
+ * @anj_internal_api_do_not_use
+ * Bounded multi-producer single-consumer queue of data model changes.
+ * @p enqueue_pos is shared by producers and accessed atomically,
+ * @p dequeue_pos is used only by @ref anj_core_step.
+ */
+typedef struct {
+    _anj_dm_change_queue_entry_t entries[ANJ_DM_CHANGE_QUEUE_SIZE];
+    uint32_t enqueue_pos;
+    uint32_t dequeue_pos;
+} _anj_dm_change_queue_t;
+#endif // ANJ_DM_WITH_CHANGE_QUEUE
+
+#ifdef ANJ_WITH_PIPELINED_NOTIFICATIONS
+/**
+ * @anj_internal_api_do_not_use
+ * Number of exchange contexts for notifications, next to the main one.
+ */
+#    define _ANJ_PIPELINED_EXCHANGES_NUMBER \
+        (ANJ_PIPELINED_NOTIFICATIONS_NSTART - 1)
+
+/**
+ * @anj_internal_api_do_not_use
+ * Exchange context of a notification sent while the main exchange context is
+ * in use, or is to be used for other requests.
+ */
+typedef struct {
+    _anj_exchange_ctx_t exchange_ctx;
+    uint8_t payload_buffer[ANJ_OUT_PAYLOAD_BUFFER_SIZE];
+    // set once the notification is detached from the Observe module, see
+    // _anj_observe_detach_notification()
+    _anj_observe_detached_notification_t notification;
+    anj_t *anj;
+} _anj_pipelined_exchange_t;
+#endif // ANJ_WITH_PIPELINED_NOTIFICATIONS
+
+#ifdef ANJ_WITH_BUDGETED_STEP
+/**
+ * @anj_internal_api_do_not_use
+ * Limits of the ongoing @ref anj_core_step_budgeted call.
+ */
+typedef struct {
+    // set only during anj_core_step_budgeted()
+    bool active;
+    bool exhausted;
+    // 0 if the number of actions is not limited
+    uint16_t actions_left;
+    // ANJ_TIME_MONOTONIC_INVALID if the time is not limited
+    anj_time_monotonic_t deadline;
+} _anj_step_budget_t;
+#endif // ANJ_WITH_BUDGETED_STEP
+
+#ifdef ANJ_WITH_NEXT_STEP_TIME_CACHE
+/**
+ * @anj_internal_api_do_not_use
+ * Time of the next notification calculated in queue mode, see
+ * @ref ANJ_WITH_NEXT_STEP_TIME_CACHE.
+ */
+typedef struct {
+    // cleared on any change of the Observations or the Data Model, and when
+    // the client is not in queue mode
+    bool valid;
+    // used to detect that the clock went back
+    anj_time_monotonic_t calculated_at;
+    // ANJ_TIME_MONOTONIC_INVALID if no notification is planned
+    anj_time_monotonic_t notification_time;
+} _anj_next_notification_cache_t;
+#endif // ANJ_WITH_NEXT_STEP_TIME_CACHE
+
+#ifdef ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+/**
+ * @anj_internal_api_do_not_use
+ * Beginning of the payload of a Read of /3/0 of the default Device Object in a
+ * single content format, see @ref ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ.
+ */
+typedef struct {
+    // _ANJ_COAP_FORMAT_NOT_DEFINED if the slot is not used
+    uint16_t format;
+    // set once recording is finished, payload_len is final then
+    bool complete;
+    uint8_t payload[ANJ_DM_DEVICE_OBJ_PREENCODED_READ_SIZE];
+    size_t payload_len;
+    // state of the Read after the last Resource that fit in the payload
+    size_t prefix_len;
+    _anj_io_out_ctx_t out_ctx;
+    _anj_dm_read_ctx_t read_ctx;
+    _anj_dm_entity_ptrs_t entity_ptrs;
+    size_t op_count;
+} _anj_dm_preencoded_read_t;
+
+/**
+ * @anj_internal_api_do_not_use
+ * Stored Reads of the default Device Object.
+ */
+typedef struct {
+    // set by anj_dm_device_obj_install()
+    const anj_dm_obj_t *obj;
+    // Resource with a value that may change, ANJ_ID_INVALID if none
+    anj_rid_t first_mutable_rid;
+    // slot replaced when a new content format is used
+    uint8_t next_slot;
+    _anj_dm_preencoded_read_t slots[ANJ_DM_DEVICE_OBJ_PREENCODED_READ_FORMATS];
+} _anj_dm_device_read_cache_t;
+#endif // ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+
+#ifdef ANJ_WITH_SCRATCH_ARENA
+/**
+ * @anj_internal_api_do_not_use
+ * Temporaries of message processing kept outside of the stack, see
+ * @ref ANJ_WITH_SCRATCH_ARENA. Functions using the same member never nest.
+ */
+typedef struct {
+    /** CoAP options of the message being encoded or decoded. */
+    anj_coap_option_t coap_options[ANJ_COAP_MAX_OPTIONS_NUMBER];
+    /** Request received in the Bootstrap or registration session. */
+    _anj_coap_msg_t in_msg;
+    /** Client request prepared by Bootstrap, Register or registration
+     * session. */
+    _anj_coap_msg_t out_msg;
+    /** Message of the exchange driven by _anj_srv_conn_handle_request(). */
+    _anj_coap_msg_t conn_msg;
+} _anj_scratch_t;
+#endif // ANJ_WITH_SCRATCH_ARENA
+
 /**
  * @anj_internal_api_do_not_use
  * Anjay object containing all information required for LwM2M communication.
  */
 typedef struct anj_struct {
     _anj_dm_data_model_t dm;
-    _anj_register_ctx_t register_ctx;
+    /**
+     * Contexts of modules that are never used at the same time. The active
+     * one is initialized by core on each transition of the connection status:
+     * @ref _anj_bootstrap_ctx_t when Bootstrap starts, and
+     * @ref _anj_register_ctx_t on init and when Bootstrap ends.
+     */
+    union {
+        /** Used in all states except @ref ANJ_CONN_STATUS_BOOTSTRAPPING. */
+        _anj_register_ctx_t register_ctx;
+#ifdef ANJ_WITH_BOOTSTRAP
+        /** Used in @ref ANJ_CONN_STATUS_BOOTSTRAPPING only. */
+        _anj_bootstrap_ctx_t bootstrap_ctx;
+#endif // ANJ_WITH_BOOTSTRAP
+    } state_ctx;
     _anj_server_connection_ctx_t connection_ctx;
+#ifdef ANJ_WITH_PMTU_PROBING
+    _anj_srv_conn_pmtu_t pmtu;
+#endif // ANJ_WITH_PMTU_PROBING
+#ifdef ANJ_WITH_NAT_KEEPALIVE_PROBING
+    _anj_srv_conn_nat_t nat;
+#endif // ANJ_WITH_NAT_KEEPALIVE_PROBING
 #ifdef ANJ_WITH_SECURITY
     void *crypto_ctx;
 #endif // ANJ_WITH_SECURITY
@@ -67,11 +222,25 @@ typedef struct anj_struct {
     const char *endpoint_name;
     bool queue_mode_enabled;
     anj_time_duration_t queue_mode_timeout;
+#ifdef ANJ_WITH_QUEUE_MODE_WAKE_WINDOW
+    anj_time_duration_t queue_mode_wake_window;
+#endif // ANJ_WITH_QUEUE_MODE_WAKE_WINDOW
+#ifdef ANJ_WITH_UPDATE_HOLD_DOWN
+    anj_time_duration_t update_hold_down;
+#endif // ANJ_WITH_UPDATE_HOLD_DOWN
     anj_connection_status_callback_t *conn_status_cb;
     void *conn_status_cb_arg;
+#ifdef ANJ_WITH_SCHEDULING_JITTER
+    // hash of endpoint_name, source of all jitter values
+    uint32_t jitter_seed;
+    anj_time_duration_t register_spread;
+    uint8_t update_spread_percent;
+    uint8_t retry_spread_percent;
+#endif // ANJ_WITH_SCHEDULING_JITTER
 
 #ifdef ANJ_WITH_BOOTSTRAP
-    _anj_bootstrap_ctx_t bootstrap_ctx;
+    // lifetime of a Bootstrap session, passed to state_ctx.bootstrap_ctx
+    anj_time_duration_t bootstrap_timeout;
     uint16_t bootstrap_retry_count;
     anj_time_duration_t bootstrap_retry_timeout;
 #endif // ANJ_WITH_BOOTSTRAP
@@ -80,10 +249,68 @@ typedef struct anj_struct {
     _anj_observe_ctx_t observe_ctx;
 #endif // ANJ_WITH_OBSERVE
 
+#ifdef ANJ_WITH_NEXT_STEP_TIME_CACHE
+    _anj_next_notification_cache_t next_notification_cache;
+#endif // ANJ_WITH_NEXT_STEP_TIME_CACHE
+
 #ifdef ANJ_WITH_LWM2M_SEND
     _anj_send_ctx_t send_ctx;
 #endif // ANJ_WITH_LWM2M_SEND
 
+#ifdef ANJ_DM_WITH_CHANGE_QUEUE
+    _anj_dm_change_queue_t dm_change_queue;
+#endif // ANJ_DM_WITH_CHANGE_QUEUE
+
+#ifdef ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+    // CoAP downloader currently using connection_ctx, responses to its
+    // requests are passed to it instead of being handled here
+    anj_coap_downloader_t *shared_downloader;
+#endif // ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+
+#ifdef ANJ_WITH_SESSION_PERSISTENCE
+    // set by anj_core_session_restore(), registration is skipped if the
+    // connection to the server succeeds
+    struct {
+        bool pending;
+        anj_time_monotonic_t next_update_time;
+        anj_time_duration_t lifetime;
+        bool update_with_payload;
+    } session_resume;
+#endif // ANJ_WITH_SESSION_PERSISTENCE
+
+#ifdef ANJ_WITH_METRICS
+    anj_metrics_t metrics;
+#endif // ANJ_WITH_METRICS
+
+#ifdef ANJ_WITH_RESOURCE_USAGE
+    // exchange_cache_max is kept in exchange_cache.used_entries_max
+    anj_resource_usage_t resource_usage;
+#endif // ANJ_WITH_RESOURCE_USAGE
+
+#ifdef ANJ_WITH_TRACE
+    _anj_trace_t trace;
+#endif // ANJ_WITH_TRACE
+
+#ifdef ANJ_WITH_OSCORE
+    _anj_oscore_ctx_t oscore_ctx;
+#endif // ANJ_WITH_OSCORE
+
+#ifdef ANJ_WITH_SCRATCH_ARENA
+    _anj_scratch_t scratch;
+#endif // ANJ_WITH_SCRATCH_ARENA
+
+#ifdef ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+    _anj_dm_device_read_cache_t device_read_cache;
+#endif // ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+
+#ifdef ANJ_WITH_STEP_TIME_CACHE
+    _anj_step_time_t step_time;
+#endif // ANJ_WITH_STEP_TIME_CACHE
+
+#ifdef ANJ_WITH_BUDGETED_STEP
+    _anj_step_budget_t step_budget;
+#endif // ANJ_WITH_BUDGETED_STEP
+
     union {
         /** Used to prepare outgoing message payload. */
         _anj_io_out_ctx_t out_ctx;
@@ -110,6 +337,24 @@ typedef struct anj_struct {
 #endif // ANJ_WITH_BOOTSTRAP_DISCOVER
     } anj_io;
 
+#if defined(ANJ_DM_WITH_COMP_READ_PATH_STREAMING) \
+        && !defined(ANJ_WITH_TRANSIENT_ALLOC)
+    /**
+     * Used to decode paths of a Read-Composite request while
+     * @ref anj_io is used to prepare the response. Allocated with
+     * @ref anj_configuration_t::transient_alloc if
+     * @ref ANJ_WITH_TRANSIENT_ALLOC is enabled.
+     */
+    _anj_io_in_ctx_t comp_read_in_ctx;
+#endif // defined(ANJ_DM_WITH_COMP_READ_PATH_STREAMING) &&
+       // !defined(ANJ_WITH_TRANSIENT_ALLOC)
+
+#ifdef ANJ_WITH_TRANSIENT_ALLOC
+    anj_transient_alloc_t *transient_alloc;
+    anj_transient_free_t *transient_free;
+    void *transient_alloc_arg;
+#endif // ANJ_WITH_TRANSIENT_ALLOC
+
     struct {
         bool disable_triggered;
         anj_time_monotonic_t enable_time;
@@ -117,6 +362,9 @@ typedef struct anj_struct {
         bool registration_update_triggered;
         bool bootstrap_request_triggered;
         bool restart_triggered;
+#ifdef ANJ_WITH_WARM_RESTART
+        bool warm_restart_triggered;
+#endif // ANJ_WITH_WARM_RESTART
         anj_conn_status_t conn_status;
         union {
 #ifdef ANJ_WITH_BOOTSTRAP
@@ -139,6 +387,15 @@ typedef struct anj_struct {
                 bool update_with_payload;
                 uint8_t internal_state;
                 bool transition_forced;
+#ifdef ANJ_WITH_UPDATE_HOLD_DOWN
+                // end of the window opened by the first pending trigger
+                anj_time_monotonic_t update_hold_down_end;
+#endif // ANJ_WITH_UPDATE_HOLD_DOWN
+#ifdef ANJ_WITH_NAT_REBINDING_RECOVERY
+                // connection was set up again after it had been lost, the
+                // next loss leads to reregistration
+                bool rebinding;
+#endif // ANJ_WITH_NAT_REBINDING_RECOVERY
             } registered;
         } details;
     } server_state;
@@ -156,6 +413,16 @@ typedef struct anj_struct {
 #ifdef ANJ_WITH_OBSERVE
         _anj_observe_server_state_t observe_state;
 #endif // ANJ_WITH_OBSERVE
+#ifdef ANJ_WITH_SERVER_DATA_CACHE
+        // fields above, security_instance and the security information in
+        // net_socket_cfg are up to date with the Data Model; cleared on any
+        // reported change of the Security or Server Object, changes made by
+        // the application have to be reported with
+        // anj_core_data_model_changed()
+        bool dm_data_cached;
+        // the same, for the resources read on every Update
+        bool reg_resources_cached;
+#endif // ANJ_WITH_SERVER_DATA_CACHE
     } server_instance;
 
     struct {
@@ -168,14 +435,61 @@ typedef struct anj_struct {
 #endif // ANJ_WITH_BOOTSTRAP
     } security_instance;
 
+#ifdef ANJ_WITH_MSG_BUFFER_ARENA
+    // carved from anj_configuration_t::msg_buffer_arena, in_buffer and
+    // out_buffer point to the same memory
+    uint8_t *in_buffer;
+    uint8_t *out_buffer;
+    uint8_t *payload_buffer;
+#    ifdef ANJ_WITH_MSG_BUFFER_POOL
+    // buffers above are borrowed from here for the duration of the step and
+    // are NULL when not needed
+    anj_msg_buffer_pool_t *msg_buffer_pool;
+#    endif // ANJ_WITH_MSG_BUFFER_POOL
+#else  // ANJ_WITH_MSG_BUFFER_ARENA
     uint8_t in_buffer[ANJ_IN_MSG_BUFFER_SIZE];
     uint8_t out_buffer[ANJ_OUT_MSG_BUFFER_SIZE];
     uint8_t payload_buffer[ANJ_OUT_PAYLOAD_BUFFER_SIZE];
+#endif // ANJ_WITH_MSG_BUFFER_ARENA
     _anj_exchange_ctx_t exchange_ctx;
+#ifdef ANJ_WITH_BLOCK2_PREFETCH
+    // next block of a Block-Wise response is prepared here in advance
+    uint8_t prefetch_payload_buffer[ANJ_OUT_PAYLOAD_BUFFER_SIZE];
+#endif // ANJ_WITH_BLOCK2_PREFETCH
+#ifdef ANJ_WITH_PIPELINED_NOTIFICATIONS
+    // notifications sent next to the exchange above, at most one of them is
+    // deferred until it's finished
+    _anj_pipelined_exchange_t pipelined[_ANJ_PIPELINED_EXCHANGES_NUMBER];
+#endif // ANJ_WITH_PIPELINED_NOTIFICATIONS
+#ifdef ANJ_WITH_INTERLEAVED_NOTIFICATIONS
+    // data model operation of a notification prepared between the blocks of
+    // a Block-Wise Read, or of the Read itself while the notification is
+    // processed; notification_aside is set while the former is kept here
+    struct {
+        _anj_dm_op_state_t dm_op;
+        _anj_io_out_ctx_t out_ctx;
+        bool notification_aside;
+        _anj_exchange_completion_t *completion;
+        void *completion_arg;
+    } interleaved;
+#endif // ANJ_WITH_INTERLEAVED_NOTIFICATIONS
 #ifdef ANJ_WITH_CACHE
     _anj_exchange_cache_t exchange_cache;
 #endif // ANJ_WITH_CACHE
+#ifdef ANJ_COAP_WITH_MSG_TEMPLATES
+    _anj_coap_msg_templates_t coap_msg_templates;
+#endif // ANJ_COAP_WITH_MSG_TEMPLATES
     size_t out_msg_len;
+#ifdef ANJ_NET_WITH_SEND_VEC
+    const uint8_t *out_payload;
+    size_t out_payload_len;
+#endif // ANJ_NET_WITH_SEND_VEC
+#ifdef ANJ_WITH_ENCODED_RETRANSMISSIONS
+    // Message ID of the Confirmable message in out_buffer, valid if
+    // out_msg_con_encoded is set
+    uint16_t out_msg_mid;
+    bool out_msg_con_encoded;
+#endif // ANJ_WITH_ENCODED_RETRANSMISSIONS
 } _anj_t;
 
 #ifdef __cplusplus
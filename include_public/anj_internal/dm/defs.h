@@ -27,15 +27,20 @@ extern "C" {
 /** @anj_internal_api_do_not_use */
 typedef struct {
     uint16_t obj_idx;
-    uint16_t inst_idx;
+    // IID of the Instance to be reported next on ANJ_ID_IID level
+    anj_iid_t iid;
     anj_id_type_t level;
+#ifdef ANJ_DM_WITH_REGISTER_PAYLOAD_CACHE
+    // offset of the next byte of cached payload, if it is used
+    size_t cache_offset;
+    bool from_cache;
+#endif // ANJ_DM_WITH_REGISTER_PAYLOAD_CACHE
 } _anj_dm_reg_ctx_t;
 
 /** @anj_internal_api_do_not_use */
 typedef struct {
     uint16_t ssid;
     uint16_t obj_idx;
-    uint16_t inst_idx;
     uint16_t res_idx;
     uint16_t res_inst_idx;
     anj_id_type_t level;
@@ -51,12 +56,29 @@ typedef struct {
 
 /** @anj_internal_api_do_not_use */
 typedef struct {
-    uint16_t inst_idx;
+    // set if the next Instance has to be taken on ANJ_ID_OID level
+    bool next_inst;
     uint16_t res_idx;
     uint16_t res_inst_idx;
     size_t total_op_count;
     anj_id_type_t base_level;
+#ifdef ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+    // one of _ANJ_DM_PREENCODED_READ_* values, and the slot of
+    // anj_t::device_read_cache being recorded or copied
+    uint8_t preencoded;
+    uint8_t preencoded_slot;
+    size_t preencoded_offset;
+#endif // ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
 } _anj_dm_read_ctx_t;
+
+#ifdef ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+/** @anj_internal_api_do_not_use */
+enum {
+    _ANJ_DM_PREENCODED_READ_NONE,
+    _ANJ_DM_PREENCODED_READ_RECORDING,
+    _ANJ_DM_PREENCODED_READ_COPYING
+};
+#endif // ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
 /**
  * @anj_internal_api_do_not_use
  * Set of pointers related with operation.
@@ -68,6 +90,33 @@ typedef struct {
     anj_riid_t riid;
 } _anj_dm_entity_ptrs_t;
 
+#ifdef ANJ_DM_WITH_PATH_HANDLES
+/**
+ * @anj_internal_api_do_not_use
+ * Path resolved into pointers of the related data model entities. Pointers are
+ * valid as long as @ref generation is equal to the generation of the data
+ * model, otherwise the path has to be resolved again.
+ */
+struct anj_dm_path_handle_struct {
+    anj_uri_path_t path;
+    _anj_dm_entity_ptrs_t ptrs;
+    uint32_t generation;
+};
+#endif // ANJ_DM_WITH_PATH_HANDLES
+
+#ifdef ANJ_DM_WITH_READ_CACHE
+/**
+ * @anj_internal_api_do_not_use
+ * Value of a Resource or Resource Instance, valid until @ref expires. The
+ * entry is unused if @ref path is the root path.
+ */
+typedef struct {
+    anj_uri_path_t path;
+    anj_res_value_t value;
+    anj_time_monotonic_t expires;
+} _anj_dm_read_cache_entry_t;
+#endif // ANJ_DM_WITH_READ_CACHE
+
 /**
  * @anj_internal_api_do_not_use
  * Data model context, do not modify this structure directly, its fields are
@@ -89,6 +138,12 @@ typedef struct {
     _anj_dm_entity_ptrs_t entity_ptrs;
     bool bootstrap_operation;
     bool is_transactional;
+#ifdef ANJ_WITH_BOOTSTRAP_WRITE_BATCHING
+    // transactions of Objects written by Bootstrap-Writes are kept open
+    // until the batch is committed
+    bool bootstrap_batch_pending;
+    bool bootstrap_batch_failed;
+#endif // ANJ_WITH_BOOTSTRAP_WRITE_BATCHING
     size_t op_count;
     bool op_in_progress;
     _anj_op_t operation;
@@ -99,6 +154,53 @@ typedef struct {
     uint16_t ssid;
     // used for Create operation to indicate if iid was provided by the Server
     bool iid_provided;
+#ifdef ANJ_OBSERVE_WITH_VALUE_CACHE
+    // if set, returned by the next Read of a Resource value instead of calling
+    // res_read handler, and cleared
+    const anj_res_value_t *cached_read_value;
+#endif // ANJ_OBSERVE_WITH_VALUE_CACHE
+#ifdef ANJ_DM_WITH_PATH_HANDLES
+    // incremented whenever Objects or Instances may have been added or removed
+    uint32_t generation;
+    struct anj_dm_path_handle_struct path_cache[ANJ_DM_PATH_HANDLE_CACHE_SIZE];
+#endif // ANJ_DM_WITH_PATH_HANDLES
+#ifdef ANJ_DM_WITH_LINK_SET_HASH
+    // hash of Objects and Instances listed in Register, calculated on first
+    // use after a change of the data model structure
+    uint32_t link_set_hash;
+    bool link_set_hash_valid;
+#endif // ANJ_DM_WITH_LINK_SET_HASH
+#ifdef ANJ_DM_WITH_REGISTER_PAYLOAD_CACHE
+    // Register payload rendered on first use after a change of the data
+    // model structure; overflow is set if it didn't fit in the buffer
+    uint8_t reg_payload_cache[ANJ_DM_REGISTER_PAYLOAD_CACHE_SIZE];
+    size_t reg_payload_cache_len;
+    bool reg_payload_cache_valid;
+    bool reg_payload_cache_overflow;
+#endif // ANJ_DM_WITH_REGISTER_PAYLOAD_CACHE
+#ifdef ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+    // cleared on changes of the data model structure and of /3, the stored
+    // Reads of the Device Object are dropped on next use then
+    bool device_read_cache_valid;
+#endif // ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+#ifdef ANJ_DM_WITH_READABLE_RES_COUNT_CACHE
+    // number of readable Resources (Instances) in each Object, calculated on
+    // first use after a change of the data model structure
+    size_t readable_res_count[ANJ_DM_MAX_OBJECTS_NUMBER];
+    bool readable_res_count_valid[ANJ_DM_MAX_OBJECTS_NUMBER];
+#endif // ANJ_DM_WITH_READABLE_RES_COUNT_CACHE
+#ifdef ANJ_DM_WITH_RES_READ_BATCH
+    // Instance or Resource most recently prepared by res_read_batch handler in
+    // the ongoing operation; read_batch_res is NULL if the whole Instance was
+    // prepared in one batch
+    const anj_dm_obj_t *read_batch_obj;
+    anj_iid_t read_batch_iid;
+    const anj_dm_res_t *read_batch_res;
+#endif // ANJ_DM_WITH_RES_READ_BATCH
+#ifdef ANJ_DM_WITH_READ_CACHE
+    // values of Resources with anj_dm_res_t::read_cache_max_age_ms set
+    _anj_dm_read_cache_entry_t read_cache[ANJ_DM_READ_CACHE_SIZE];
+#endif // ANJ_DM_WITH_READ_CACHE
 #ifdef ANJ_WITH_COMPOSITE_OPERATIONS
     anj_uri_path_t comp_read_paths[ANJ_DM_MAX_COMP_READ_ENTRIES];
     size_t comp_read_path_count;
@@ -106,9 +208,98 @@ typedef struct {
     uint16_t comp_read_format;
     // used only when processing root path
     size_t comp_read_current_object;
+#    ifdef ANJ_DM_WITH_COMP_READ_PATH_STREAMING
+    // set if paths are read directly from the payload of a single-message
+    // request, which is valid only until the first block of the response is
+    // prepared; comp_read_paths is used for the following blocks
+    bool comp_read_streaming;
+    bool comp_read_payload_received;
+    uint8_t *comp_read_payload;
+    size_t comp_read_payload_len;
+    uint16_t comp_read_content_format;
+    size_t comp_read_res_count;
+#    endif // ANJ_DM_WITH_COMP_READ_PATH_STREAMING
+#    ifdef ANJ_DM_WITH_BATCHED_WRITE_COMP
+    // set once the first payload of a Write-Composite request is processed
+    bool write_comp_payload_received;
+#    endif // ANJ_DM_WITH_BATCHED_WRITE_COMP
 #endif // ANJ_WITH_COMPOSITE_OPERATIONS
+#ifdef ANJ_WITH_LWM2M_GATEWAY
+    // set when LwM2M Gateway Object is installed
+    struct anj_dm_gateway_obj_struct *gateway;
+#endif // ANJ_WITH_LWM2M_GATEWAY
+#ifdef ANJ_WITH_SEPARATE_RESPONSE
+    // set if a handler may still return ANJ_DM_PENDING, i.e. until the first
+    // block of the response is prepared
+    bool pending_allowed;
+    // set if a handler returned ANJ_DM_PENDING, until the response is prepared
+    bool pending;
+    bool pending_completed;
+    int pending_result;
+    // Read request parameters, needed to start reading again
+    anj_uri_path_t pending_read_path;
+    uint16_t pending_read_format;
+#endif // ANJ_WITH_SEPARATE_RESPONSE
 } _anj_dm_data_model_t;
 
+#ifdef ANJ_WITH_INTERLEAVED_NOTIFICATIONS
+/**
+ * @anj_internal_api_do_not_use
+ * Fields of @ref _anj_dm_data_model_t which describe the ongoing operation.
+ * Used to keep one operation aside while another one is processed, see
+ * @ref _anj_dm_swap_operation.
+ */
+typedef struct {
+    union {
+        _anj_dm_reg_ctx_t reg_ctx;
+        _anj_dm_disc_ctx_t disc_ctx;
+        _anj_dm_write_ctx_t write_ctx;
+        _anj_dm_read_ctx_t read_ctx;
+    } op_ctx;
+    _anj_dm_entity_ptrs_t entity_ptrs;
+    bool bootstrap_operation;
+    bool is_transactional;
+    size_t op_count;
+    bool op_in_progress;
+    _anj_op_t operation;
+    bool data_to_copy;
+    anj_io_out_entry_t out_record;
+    uint16_t ssid;
+    bool iid_provided;
+#    ifdef ANJ_DM_WITH_RES_READ_BATCH
+    const anj_dm_obj_t *read_batch_obj;
+    anj_iid_t read_batch_iid;
+    const anj_dm_res_t *read_batch_res;
+#    endif // ANJ_DM_WITH_RES_READ_BATCH
+#    ifdef ANJ_WITH_COMPOSITE_OPERATIONS
+    anj_uri_path_t comp_read_paths[ANJ_DM_MAX_COMP_READ_ENTRIES];
+    size_t comp_read_path_count;
+    size_t comp_read_already_processed;
+    uint16_t comp_read_format;
+    size_t comp_read_current_object;
+#        ifdef ANJ_DM_WITH_COMP_READ_PATH_STREAMING
+    bool comp_read_streaming;
+    bool comp_read_payload_received;
+    uint8_t *comp_read_payload;
+    size_t comp_read_payload_len;
+    uint16_t comp_read_content_format;
+    size_t comp_read_res_count;
+#        endif // ANJ_DM_WITH_COMP_READ_PATH_STREAMING
+#        ifdef ANJ_DM_WITH_BATCHED_WRITE_COMP
+    bool write_comp_payload_received;
+#        endif // ANJ_DM_WITH_BATCHED_WRITE_COMP
+#    endif     // ANJ_WITH_COMPOSITE_OPERATIONS
+#    ifdef ANJ_WITH_SEPARATE_RESPONSE
+    bool pending_allowed;
+    bool pending;
+    bool pending_completed;
+    int pending_result;
+    anj_uri_path_t pending_read_path;
+    uint16_t pending_read_format;
+#    endif // ANJ_WITH_SEPARATE_RESPONSE
+} _anj_dm_op_state_t;
+#endif // ANJ_WITH_INTERLEAVED_NOTIFICATIONS
+
 #ifdef __cplusplus
 }
 #endif
@@ -16,6 +16,14 @@
 
 #include <anj/time.h>
 
+#ifdef ANJ_WITH_METRICS
+#    include <anj/metrics.h>
+#endif // ANJ_WITH_METRICS
+
+#ifdef ANJ_WITH_TRACE
+#    include <anj/trace.h>
+#endif // ANJ_WITH_TRACE
+
 #define ANJ_INTERNAL_INCLUDE_UTILS
 #include <anj_internal/utils.h> // IWYU pragma: export
 #undef ANJ_INTERNAL_INCLUDE_UTILS
@@ -33,6 +41,17 @@ extern "C" {
  */
 #define _ANJ_EXCHANGE_BLOCK_TRANSFER_NEEDED 1
 
+#ifdef ANJ_WITH_SEPARATE_RESPONSE
+/**
+ * Returned from @ref _anj_exchange_read_payload_t handler of a LwM2M Server
+ * request if the response is not ready yet. The request is acknowledged with
+ * an Empty ACK and the handler is called again on each
+ * @ref _anj_exchange_process call, until it returns a different value, which is
+ * then sent in a Confirmable separate response.
+ */
+#    define _ANJ_EXCHANGE_SEPARATE_RESPONSE 2
+#endif // ANJ_WITH_SEPARATE_RESPONSE
+
 /**
  * Completion code in @ref _anj_exchange_completion_t when the exchange
  * finished successfully.
@@ -163,6 +182,8 @@ typedef uint8_t _anj_exchange_write_payload_t(void *arg_ptr,
  *  - 0 on success,
  *  - @ref _ANJ_EXCHANGE_BLOCK_TRANSFER_NEEDED if @p buff is too small to fit
  *    the whole payload,
+ *  - @ref _ANJ_EXCHANGE_SEPARATE_RESPONSE if the response to the LwM2M Server
+ *    request is not ready yet (allowed only for the first response block),
  *  - a ANJ_COAP_CODE_* code in case of error.
  */
 typedef uint8_t
@@ -191,6 +212,19 @@ typedef void _anj_exchange_completion_t(void *arg_ptr,
                                         const _anj_coap_msg_t *response,
                                         int result);
 
+/**
+ * @anj_internal_api_do_not_use
+ * Checks if @p token is used by another module, so that it can't be used for a
+ * new request.
+ *
+ * @param arg_ptr Additional user data passed when the function is called.
+ * @param token   Token of the new request.
+ *
+ * @returns true if @p token is already in use.
+ */
+typedef bool _anj_exchange_token_in_use_t(void *arg_ptr,
+                                          const _anj_coap_token_t *token);
+
 /**
  * @anj_internal_api_do_not_use
  * Exchange handlers. If handler is not set, the exchange module will use
@@ -211,16 +245,59 @@ typedef struct {
 typedef struct {
     anj_time_monotonic_t expiration_time;
     uint16_t mid;
+#    ifdef ANJ_CACHE_WITH_FULL_ENTRIES
+    // next entry in the same bucket of the Message ID index
+    uint8_t next_id;
+    // entry of full_entries with the response, if it is still kept
+    uint8_t full_entry_id;
+#    endif // ANJ_CACHE_WITH_FULL_ENTRIES
 } _anj_exchange_cache_msg_non_recent_t;
 
+#    ifdef ANJ_CACHE_WITH_FULL_ENTRIES
+/**
+ * @anj_internal_api_do_not_use
+ * Response of one of the non-recent cache entries, with its payload stored in
+ * the payload arena of the cache
+ */
+typedef struct {
+    _anj_coap_msg_t response;
+    size_t payload_offset;
+    // entry of cache_non_recent this response belongs to
+    uint8_t non_recent_id;
+} _anj_exchange_cache_msg_full_t;
+#    endif // ANJ_CACHE_WITH_FULL_ENTRIES
+
+#    ifdef ANJ_WITH_ENCODED_RETRANSMISSIONS
+#        ifdef ANJ_NET_WITH_SEND_VEC
+// payload may be sent separately, and not fit in the output buffer
+#            define _ANJ_EXCHANGE_CACHE_DATAGRAM_SIZE \
+                (ANJ_OUT_MSG_BUFFER_SIZE + ANJ_OUT_PAYLOAD_BUFFER_SIZE)
+#        else // ANJ_NET_WITH_SEND_VEC
+#            define _ANJ_EXCHANGE_CACHE_DATAGRAM_SIZE ANJ_OUT_MSG_BUFFER_SIZE
+#        endif // ANJ_NET_WITH_SEND_VEC
+#    endif     // ANJ_WITH_ENCODED_RETRANSMISSIONS
+
 /**
  * @anj_internal_api_do_not_use
  * Single cache entry for the latest message
  */
 typedef struct {
     anj_time_monotonic_t expiration_time;
+#    ifdef ANJ_WITH_ENCODED_RETRANSMISSIONS
+    uint16_t mid;
+    // set by _anj_exchange_cache_set_datagram, 0 if the response couldn't be
+    // encoded
+    size_t datagram_len;
+    uint8_t datagram[_ANJ_EXCHANGE_CACHE_DATAGRAM_SIZE];
+#    else // ANJ_WITH_ENCODED_RETRANSMISSIONS
     _anj_coap_msg_t response;
+#        ifdef ANJ_WITH_MSG_BUFFER_ARENA
+    // ANJ_OUT_PAYLOAD_BUFFER_SIZE bytes carved from the message buffer arena
+    uint8_t *payload;
+#        else  // ANJ_WITH_MSG_BUFFER_ARENA
     uint8_t payload[ANJ_OUT_PAYLOAD_BUFFER_SIZE];
+#        endif // ANJ_WITH_MSG_BUFFER_ARENA
+#    endif     // ANJ_WITH_ENCODED_RETRANSMISSIONS
 } _anj_exchange_cache_msg_recent_t;
 
 /** @anj_internal_api_do_not_use */
@@ -232,10 +309,59 @@ typedef struct {
     _anj_exchange_cache_msg_non_recent_t
             cache_non_recent[ANJ_CACHE_ENTRIES_NUMBER - 1];
 #    endif // ANJ_CACHE_ENTRIES_NUMBER > 1
+#    ifdef ANJ_CACHE_WITH_FULL_ENTRIES
+    // first entry of cache_non_recent in each bucket of the Message ID index
+    uint8_t mid_index[ANJ_CACHE_ENTRIES_NUMBER - 1];
+    // ANJ_CACHE_FULL_ENTRIES_NUMBER - 1 responses older than cache_recent
+    _anj_exchange_cache_msg_full_t
+            full_entries[ANJ_CACHE_FULL_ENTRIES_NUMBER - 1];
+    uint8_t payload_arena[ANJ_CACHE_PAYLOAD_ARENA_SIZE];
+    // where the next payload is stored in payload_arena
+    size_t payload_arena_offset;
+    // entry of full_entries to be retransmitted, if it is not cache_recent
+    uint8_t retransmitted_full_id;
+#    endif // ANJ_CACHE_WITH_FULL_ENTRIES
     bool handling_retransmission;
+#    ifdef ANJ_WITH_ENCODED_RETRANSMISSIONS
+    // cache_recent is added before the response is encoded
+    bool datagram_pending;
+#    endif // ANJ_WITH_ENCODED_RETRANSMISSIONS
+#    ifdef ANJ_WITH_STEP_TIME_CACHE
+    // set by _anj_exchange_setup_step_time, NULL if the clock is always read
+    const _anj_step_time_t *step_time;
+#    endif // ANJ_WITH_STEP_TIME_CACHE
+#    ifdef ANJ_WITH_RESOURCE_USAGE
+    // highest number of valid entries, see anj_resource_usage_t
+    size_t used_entries_max;
+#    endif // ANJ_WITH_RESOURCE_USAGE
 } _anj_exchange_cache_t;
 #endif // ANJ_WITH_CACHE
 
+#ifdef ANJ_WITH_ADAPTIVE_RTO
+/**
+ * @anj_internal_api_do_not_use
+ * Round-trip time estimator as defined in RFC 6298
+ */
+typedef struct {
+    bool valid;
+    anj_time_duration_t srtt;
+    anj_time_duration_t rttvar;
+} _anj_exchange_rtt_estimator_t;
+
+/**
+ * @anj_internal_api_do_not_use
+ * Retransmission timeout learned from the previous exchanges, as in CoCoA
+ */
+typedef struct {
+    // fed by requests answered without a retransmission
+    _anj_exchange_rtt_estimator_t strong;
+    // fed by requests answered after one or two retransmissions
+    _anj_exchange_rtt_estimator_t weak;
+    // used instead of ACK_TIMEOUT, invalid until the first measurement
+    anj_time_duration_t overall;
+} _anj_exchange_rto_t;
+#endif // ANJ_WITH_ADAPTIVE_RTO
+
 /** @anj_internal_api_do_not_use */
 typedef struct {
     _anj_exchange_state_t state;
@@ -249,6 +375,12 @@ typedef struct {
     uint16_t block_size;
     // used in separate response mode
     bool request_prepared;
+#ifdef ANJ_WITH_SEPARATE_RESPONSE
+    // the response to the LwM2M Server request is not ready yet
+    bool response_deferred;
+    // Confirmable separate response is sent, waiting for the ACK
+    bool separate_response_sent;
+#endif // ANJ_WITH_SEPARATE_RESPONSE
     uint32_t block_number;
 
     anj_time_duration_t server_exchange_timeout;
@@ -259,6 +391,15 @@ typedef struct {
     anj_time_duration_t timeout;
 
     uint16_t msg_id;
+#ifdef ANJ_WITH_COUNTER_TOKENS
+    // tokens are derived from them, the key is reseeded when the counter is a
+    // multiple of 65536
+    uint64_t token_key;
+    uint32_t token_counter;
+#endif // ANJ_WITH_COUNTER_TOKENS
+    // set by _anj_exchange_setup_token_check, NULL if there is nothing to check
+    _anj_exchange_token_in_use_t *token_in_use;
+    void *token_in_use_arg;
 
     uint8_t msg_code;
     _anj_coap_msg_t base_msg;
@@ -268,6 +409,60 @@ typedef struct {
     _anj_exchange_cache_t *cache;
 #endif // ANJ_WITH_CACHE
 
+#ifdef ANJ_WITH_ADAPTIVE_BLOCK_SIZE
+    // upper bound for block_size of new exchanges, 0 if there is none
+    uint16_t block_size_limit;
+    // exchanges finished without a timeout since block_size_limit was set
+    uint8_t block_size_successes;
+    // indicate if a timeout occurred in the current exchange
+    bool block_size_timeout;
+#endif // ANJ_WITH_ADAPTIVE_BLOCK_SIZE
+
+#ifdef ANJ_WITH_ADAPTIVE_RTO
+    _anj_exchange_rto_t rto;
+#endif // ANJ_WITH_ADAPTIVE_RTO
+
+#ifdef ANJ_WITH_PMTU_PROBING
+    // result of the last finished exchange
+    int last_result;
+#endif // ANJ_WITH_PMTU_PROBING
+
+#if defined(ANJ_WITH_ADAPTIVE_RTO) || defined(ANJ_METRICS_WITH_HISTOGRAMS)
+    // first transmission of the request waiting for the response, invalid if
+    // there is no round-trip time to measure
+    anj_time_monotonic_t rtt_start_timestamp;
+#endif // defined(ANJ_WITH_ADAPTIVE_RTO) ||
+       // defined(ANJ_METRICS_WITH_HISTOGRAMS)
+
+#ifdef ANJ_WITH_METRICS
+    // must be set by _anj_exchange_setup_metrics, NULL if not counted
+    anj_metrics_t *metrics;
+    anj_time_monotonic_t start_timestamp;
+#endif // ANJ_WITH_METRICS
+
+#ifdef ANJ_WITH_TRACE
+    // set by _anj_exchange_setup_trace, NULL if not recorded
+    _anj_trace_t *trace;
+#endif // ANJ_WITH_TRACE
+
+#ifdef ANJ_WITH_STEP_TIME_CACHE
+    // set by _anj_exchange_setup_step_time, NULL if the clock is always read
+    const _anj_step_time_t *step_time;
+#endif // ANJ_WITH_STEP_TIME_CACHE
+
+#ifdef ANJ_WITH_BLOCK2_PREFETCH
+    // set by _anj_exchange_setup_prefetch_buffer, NULL if not used; swapped
+    // with payload_buff when the prefetched block is sent
+    uint8_t *prefetch_buff;
+    size_t prefetch_buff_len;
+    bool prefetch_swapped;
+    // the server is expected to request the next block of the response
+    bool block2_pending;
+    bool prefetched;
+    uint8_t prefetch_result;
+    _anj_exchange_read_result_t prefetch_read_result;
+#endif // ANJ_WITH_BLOCK2_PREFETCH
+
     _anj_op_t op;
 } _anj_exchange_ctx_t;
 
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJ_INTERNAL_HTTP_DOWNLOADER_H
+#define ANJ_INTERNAL_HTTP_DOWNLOADER_H
+
+#ifndef ANJ_INTERNAL_INCLUDE_HTTP_DOWNLOADER
+#    error "Internal header must not be included directly"
+#endif // ANJ_INTERNAL_INCLUDE_HTTP_DOWNLOADER
+
+#define ANJ_INTERNAL_INCLUDE_SERVER
+#include <anj_internal/srv_conn.h>
+#undef ANJ_INTERNAL_INCLUDE_SERVER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef ANJ_WITH_HTTP_DOWNLOADER
+
+/**
+ * @anj_internal_api_do_not_use
+ * Maximum length of an ETag stored to resume the download; longer ones are
+ * ignored.
+ */
+#    define _ANJ_HTTP_DOWNLOADER_ETAG_MAX_LEN 64
+
+/**
+ * @anj_internal_api_do_not_use
+ * Part of the response expected next by the parser.
+ */
+typedef enum {
+    _ANJ_HTTP_DOWNLOADER_PARSE_STATUS_LINE,
+    _ANJ_HTTP_DOWNLOADER_PARSE_HEADERS,
+    _ANJ_HTTP_DOWNLOADER_PARSE_BODY,
+    _ANJ_HTTP_DOWNLOADER_PARSE_CHUNK_SIZE,
+    _ANJ_HTTP_DOWNLOADER_PARSE_CHUNK_DATA,
+    _ANJ_HTTP_DOWNLOADER_PARSE_CHUNK_END,
+    _ANJ_HTTP_DOWNLOADER_PARSE_TRAILERS,
+    _ANJ_HTTP_DOWNLOADER_PARSE_DONE
+} _anj_http_downloader_parse_state_t;
+
+/**
+ * @anj_internal_api_do_not_use
+ * HTTP downloader context structure.
+ */
+typedef struct _anj_http_downloader_struct {
+    _anj_server_connection_ctx_t connection_ctx;
+    anj_net_config_t net_socket_cfg;
+    anj_http_downloader_event_callback_t *event_cb;
+    void *event_cb_arg;
+    anj_time_duration_t timeout;
+    uint8_t max_resume_attempts;
+    bool keep_alive;
+
+    int error_code;
+    anj_http_downloader_status_t status;
+    anj_http_downloader_status_t last_reported_status;
+
+    const char *host;
+    size_t host_len;
+    const char *port;
+    size_t port_len;
+    const char *path;
+    anj_net_binding_type_t binding;
+
+    // peer of the open connection, empty host if there is none
+    char conn_host[ANJ_SERVER_URI_MAX_SIZE];
+    char conn_port[ANJ_U16_STR_MAX_LEN + 1];
+    anj_net_binding_type_t conn_binding;
+
+    // request is sent from the buffer, then it holds unparsed response data
+    uint8_t buffer[ANJ_HTTP_DOWNLOADER_BUFFER_SIZE];
+    size_t buffer_len;
+    bool request_pending;
+    // connection has to be set up again to resume the download
+    bool reconnect;
+    _anj_http_downloader_parse_state_t parse_state;
+    anj_time_monotonic_t recv_deadline;
+
+    uint16_t http_status;
+    bool chunked;
+    bool has_content_length;
+    bool connection_close;
+    bool range_mismatch;
+    // bytes left in the body with Content-Length, or in the current chunk
+    uint64_t remaining;
+    // offset of the next byte passed to the event callback
+    uint64_t offset;
+    uint64_t start_offset;
+    // bytes of the response to discard if the server ignored the Range
+    uint64_t skip;
+    char etag[_ANJ_HTTP_DOWNLOADER_ETAG_MAX_LEN + 1];
+    uint8_t resume_attempts;
+} _anj_http_downloader_t;
+
+#endif // ANJ_WITH_HTTP_DOWNLOADER
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ANJ_INTERNAL_HTTP_DOWNLOADER_H
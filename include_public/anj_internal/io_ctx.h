@@ -38,6 +38,17 @@ extern "C" {
     (_ANJ_IO_CBOR_MAX_OBJLNK_STRING_SIZE + 1)
 /**
  * @anj_internal_api_do_not_use
+ * Stringref namespace tag (D9 0100) preceding the SenML CBOR array.
+ */
+#ifdef ANJ_WITH_SENML_CBOR_STRINGREF
+#    define _ANJ_IO_SENML_CBOR_NAMESPACE_TAG_LENGTH 3
+#else // ANJ_WITH_SENML_CBOR_STRINGREF
+#    define _ANJ_IO_SENML_CBOR_NAMESPACE_TAG_LENGTH 0
+#endif // ANJ_WITH_SENML_CBOR_STRINGREF
+
+/**
+ * @anj_internal_api_do_not_use
+ * max 3 bytes for stringref namespace tag, if enabled
  * max 3 bytes for array UINT16_MAX elements
  * 1 byte for map
  * 14 bytes for basename 21 65 2F36353533352F3635353334 as /65534/65534
@@ -48,8 +59,9 @@ extern "C" {
  * resource with objlink is biggest possible value that can be directly written
  * into the internal_buff
  */
-#define _ANJ_IO_SENML_CBOR_SIMPLE_RECORD_MAX_LENGTH \
-    (3 + 1 + 14 + 14 + 10 + 4 + 1 + _ANJ_IO_CBOR_MAX_OBJLNK_STRING_SIZE)
+#define _ANJ_IO_SENML_CBOR_SIMPLE_RECORD_MAX_LENGTH  \
+    (_ANJ_IO_SENML_CBOR_NAMESPACE_TAG_LENGTH + 3 + 1 + 14 + 14 + 10 + 4 + 1 \
+     + _ANJ_IO_CBOR_MAX_OBJLNK_STRING_SIZE)
 
 /**
  * @anj_internal_api_do_not_use
@@ -87,6 +99,13 @@ extern "C" {
 /** @anj_internal_api_do_not_use */
 #define _ANJ_IO_PLAINTEXT_SIMPLE_RECORD_MAX_LENGTH ANJ_DOUBLE_STR_MAX_LEN
 
+/**
+ * @anj_internal_api_do_not_use
+ * Multiple Resource TLV header (type, 16-bit ID, 24-bit length) followed by
+ * Resource Instance TLV with 8-byte value
+ */
+#define _ANJ_IO_TLV_SIMPLE_RECORD_MAX_LENGTH (6 + 12)
+
 /** @anj_internal_api_do_not_use */
 #define _ANJ_IO_CTX_BUFFER_LENGTH _ANJ_IO_SENML_CBOR_SIMPLE_RECORD_MAX_LENGTH
 
@@ -105,9 +124,23 @@ ANJ_STATIC_ASSERT(
                 && _ANJ_IO_CTX_BUFFER_LENGTH >= _ANJ_IO_ATTRIBUTE_RECORD_MAX_LEN
                 && _ANJ_IO_CTX_BUFFER_LENGTH >= _ANJ_IO_DISCOVER_RECORD_MAX_LEN
                 && _ANJ_IO_CTX_BUFFER_LENGTH
-                           >= _ANJ_IO_PLAINTEXT_SIMPLE_RECORD_MAX_LENGTH,
+                           >= _ANJ_IO_PLAINTEXT_SIMPLE_RECORD_MAX_LENGTH
+                && _ANJ_IO_CTX_BUFFER_LENGTH
+                           >= _ANJ_IO_TLV_SIMPLE_RECORD_MAX_LENGTH,
         internal_buff_badly_defined);
 
+#ifdef ANJ_WITH_TLV_ENCODER
+/** @anj_internal_api_do_not_use */
+typedef struct {
+    anj_uri_path_t base_path;
+    /** number of instances of the Multiple Resource that is opened next */
+    uint16_t res_insts_count;
+    /** number of instances left in the currently opened Multiple Resource */
+    uint16_t res_insts_left;
+    anj_rid_t multi_res_rid;
+} _anj_tlv_encoder_t;
+#endif // ANJ_WITH_TLV_ENCODER
+
 #if defined(ANJ_WITH_SENML_CBOR) || defined(ANJ_WITH_LWM2M_CBOR) \
         || defined(ANJ_WITH_CBOR)
 
@@ -189,6 +222,14 @@ typedef struct {
     uint8_t internal_buff[_ANJ_IO_CTX_BUFFER_LENGTH];
     _anj_text_encoder_b64_cache_t b64_cache;
 
+#ifdef ANJ_WITH_DIRECT_PAYLOAD_ENCODING
+    // If set, the current record is encoded directly into this buffer instead
+    // of internal_buff; it points to the out_buff passed to the following
+    // _anj_io_out_ctx_get_payload() call, see
+    // _anj_io_out_ctx_new_entry_direct()
+    uint8_t *direct_buff;
+#endif // ANJ_WITH_DIRECT_PAYLOAD_ENCODING
+
 #ifdef ANJ_WITH_EXTERNAL_DATA
     // Used only for external string, in CBOR Indefinite-length strings single
     // UTF-8 character must be encoded in one chunk, so in worst case scenario
@@ -221,13 +262,41 @@ typedef struct {
 #endif // ANJ_WITH_CBOR
 
 #ifdef ANJ_WITH_SENML_CBOR
+#    ifdef ANJ_WITH_SENML_CBOR_STRINGREF
+/**
+ * @anj_internal_api_do_not_use
+ * Name emitted earlier in the message: IDs of the path it consists of, and
+ * its index in the stringref namespace.
+ */
+typedef struct {
+    uint16_t ids[ANJ_URI_PATH_MAX_LENGTH];
+    uint8_t ids_count;
+    uint32_t index;
+} _anj_senml_cbor_stringref_t;
+#    endif // ANJ_WITH_SENML_CBOR_STRINGREF
+
 /** @anj_internal_api_do_not_use */
 typedef struct {
     bool encode_time;
+    /* Base Time emitted last, 0.0 if none. */
     double last_timestamp;
     size_t items_count;
     anj_uri_path_t base_path;
     size_t base_path_len;
+#    ifdef ANJ_WITH_SENML_CBOR_DYNAMIC_BASE_NAME
+    /* Path of the record that last emitted the Base Name. */
+    anj_uri_path_t base_name;
+#    endif // ANJ_WITH_SENML_CBOR_DYNAMIC_BASE_NAME
+#    ifdef ANJ_WITH_SENML_CBOR_STRINGREF
+    bool stringref;
+    /* Set once a string not numbered predictably has been emitted, no
+     * references are made after it. */
+    bool stringref_stopped;
+    /* Strings numbered in the namespace so far. */
+    uint32_t stringref_count;
+    size_t stringref_names_count;
+    _anj_senml_cbor_stringref_t stringref_names[ANJ_SENML_CBOR_STRINGREF_NAMES];
+#    endif // ANJ_WITH_SENML_CBOR_STRINGREF
     bool first_entry_added;
 } _anj_senml_cbor_encoder_t;
 #endif // ANJ_WITH_SENML_CBOR
@@ -330,6 +399,9 @@ struct _anj_cbor_ll_decoder_struct {
     bool input_last;
 
     uint8_t prebuffer[9];
+    /* Bytes of the payload that are being parsed: either the prebuffer, or,
+     * once the whole remaining payload is available, the input itself. */
+    const uint8_t *window;
     uint8_t prebuffer_size;
     uint8_t prebuffer_offset;
 
@@ -403,6 +475,22 @@ typedef struct {
 #endif // ANJ_WITH_LWM2M_CBOR
 
 #ifdef ANJ_WITH_SENML_CBOR
+/**
+ * @anj_internal_api_do_not_use
+ * State of parsing of a SenML name, concatenated with the base name, directly
+ * into the path, as it is received.
+ */
+typedef struct {
+    anj_uri_path_t path;
+    /* ID being parsed, after the last '/' */
+    uint32_t id;
+    /* Number of characters parsed, including the base name */
+    uint8_t length;
+    bool after_slash : 1;
+    bool id_has_digits : 1;
+    bool error : 1;
+} _anj_senml_path_parser_t;
+
 /** @anj_internal_api_do_not_use */
 typedef struct {
     bool map_entered : 1;
@@ -419,10 +507,14 @@ typedef struct {
 
     _anj_cbor_ll_decoder_bytes_ctx_t *bytes_ctx;
     size_t bytes_consumed;
+
+    /* Base name followed by the name parsed so far */
+    _anj_senml_path_parser_t path_parser;
 } _anj_senml_entry_parse_state_t;
 
 /** @anj_internal_api_do_not_use */
 typedef struct {
+    /* Raw name, parsed again only if the base name follows it in the entry */
     char path[_ANJ_IO_MAX_PATH_STRING_SIZE];
     anj_data_type_t type;
     union {
@@ -449,8 +541,9 @@ typedef struct {
     /* Currently processed entry - shared between entire context chain. */
     _anj_senml_entry_parse_state_t entry_parse;
     anj_senml_cached_entry_t entry;
-    /* Current basename set in the payload. */
-    char basename[_ANJ_IO_MAX_PATH_STRING_SIZE];
+    /* Current basename set in the payload, already parsed, so that only the
+     * names have to be parsed in the entries using it. */
+    _anj_senml_path_parser_t basename;
     /* A path which must be a prefix of the currently processed `path`. */
     anj_uri_path_t base;
 
@@ -512,6 +605,9 @@ typedef struct {
     uint8_t type_field;
     size_t id_length_buff_bytes_need;
     uint8_t id_length_buff[5];
+    /* ID and Length fields of the current header: either id_length_buff, or
+     * the input buffer itself if the whole header was available there. */
+    const uint8_t *id_length;
     size_t id_length_buff_read_offset;
     size_t id_length_buff_write_offset;
 
@@ -649,6 +745,9 @@ typedef struct {
 #ifdef ANJ_WITH_LWM2M_CBOR
         _anj_lwm2m_cbor_encoder_t lwm2m;
 #endif // ANJ_WITH_LWM2M_CBOR
+#ifdef ANJ_WITH_TLV_ENCODER
+        _anj_tlv_encoder_t tlv;
+#endif // ANJ_WITH_TLV_ENCODER
     } encoder;
 } _anj_io_out_ctx_t;
 
@@ -20,6 +20,40 @@ extern "C" {
 
 #ifdef ANJ_WITH_LWM2M_SEND
 
+#    ifdef ANJ_LWM2M_SEND_WITH_FILTER
+/** @anj_internal_api_do_not_use */
+typedef struct {
+    // root path means that the entry is free
+    anj_uri_path_t path;
+    double deadband;
+    // value of the last record with this path that was sent successfully
+    bool has_last_value;
+    anj_data_type_t last_type;
+    anj_res_value_t last_value;
+    // set while the entry is being updated after a successful Send
+    bool updated;
+} _anj_send_filter_entry_t;
+#    endif // ANJ_LWM2M_SEND_WITH_FILTER
+
+#    ifdef ANJ_LWM2M_SEND_WITH_TEMPLATES
+/** @anj_internal_api_do_not_use */
+typedef struct {
+    anj_data_type_t type;
+    // offsets of the encoded value and timestamp in the payload, time_offset
+    // is 0 if the record has no timestamp
+    size_t value_offset;
+    size_t time_offset;
+} _anj_send_template_record_t;
+
+/** @anj_internal_api_do_not_use */
+struct anj_send_template_struct {
+    uint8_t payload[ANJ_LWM2M_SEND_TEMPLATE_MAX_SIZE];
+    size_t payload_size;
+    _anj_send_template_record_t records[ANJ_LWM2M_SEND_TEMPLATE_MAX_RECORDS];
+    size_t records_cnt;
+};
+#    endif // ANJ_LWM2M_SEND_WITH_TEMPLATES
+
 /** @anj_internal_api_do_not_use */
 typedef struct _anj_send_ctx_struct {
     const anj_send_request_t *requests_queue[ANJ_LWM2M_SEND_QUEUE_SIZE];
@@ -30,9 +64,42 @@ typedef struct _anj_send_ctx_struct {
     // set when aborting all requests
     bool abort_in_progress;
     uint16_t send_id_counter;
+#    ifdef ANJ_LWM2M_SEND_WITH_NON_CONFIRMABLE
+    // Non-confirmable requests sent since the last Confirmable one
+    uint16_t non_con_count;
+#    endif // ANJ_LWM2M_SEND_WITH_NON_CONFIRMABLE
     // variables used to process the message payload
     bool data_to_copy;
     size_t op_count;
+#    ifdef ANJ_LWM2M_SEND_WITH_RECORD_PRODUCER
+    // last record returned by the record producer of the current request
+    anj_io_out_entry_t produced_record;
+#    endif // ANJ_LWM2M_SEND_WITH_RECORD_PRODUCER
+#    ifdef ANJ_LWM2M_SEND_WITH_BATCHING
+    // time at which each request was queued, used for the hold-down
+    anj_time_monotonic_t queued_time[ANJ_LWM2M_SEND_QUEUE_SIZE];
+    // number of requests, starting with ids[0], merged into the active
+    // exchange; op_count indexes records of requests_queue[batch_request]
+    size_t batch_size;
+    size_t batch_request;
+#    endif // ANJ_LWM2M_SEND_WITH_BATCHING
+#    ifdef ANJ_LWM2M_SEND_WITH_FILTER
+    _anj_send_filter_entry_t filters[ANJ_LWM2M_SEND_FILTER_SIZE];
+    // set if some records of the active exchange are dropped, records_end is
+    // then the index following the last record that is sent
+    bool filter_active;
+    size_t records_end;
+#    endif // ANJ_LWM2M_SEND_WITH_FILTER
+#    ifdef ANJ_LWM2M_SEND_WITH_SORTED_RECORDS
+    // set if records of the active exchange are encoded in the order of
+    // record_order, which holds their indexes sorted by path
+    bool records_sorted;
+    uint16_t record_order[ANJ_LWM2M_SEND_SORTED_RECORDS_MAX];
+#    endif // ANJ_LWM2M_SEND_WITH_SORTED_RECORDS
+#    ifdef ANJ_LWM2M_SEND_WITH_TEMPLATES
+    // part of the template payload already copied in the active exchange
+    size_t template_offset;
+#    endif // ANJ_LWM2M_SEND_WITH_TEMPLATES
 } _anj_send_ctx_t;
 
 #endif // ANJ_WITH_LWM2M_SEND
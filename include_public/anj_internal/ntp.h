@@ -56,6 +56,9 @@ typedef struct _anj_ntp_struct {
     uint32_t cache_period_hours;
     char cache_server_address[ANJ_NTP_SERVER_ADDR_MAX_LEN];
     char cache_backup_server_address[ANJ_NTP_SERVER_ADDR_MAX_LEN];
+#    ifdef ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
+    bool dirty;
+#    endif // ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
     // internal state
     uint8_t internal_state;
     uint16_t attempts;
@@ -64,6 +67,22 @@ typedef struct _anj_ntp_struct {
     anj_time_monotonic_t recv_wait_start_time;
     bool using_backup_server;
     bool synchronized;
+#    ifdef ANJ_NTP_WITH_DRIFT_COMPENSATION
+    uint8_t samples;
+    anj_time_duration_t max_time_error;
+    uint8_t samples_collected;
+    anj_time_duration_t best_delay;
+    // real time minus monotonic time, measured by the best sample so far
+    anj_time_duration_t best_offset;
+    // the same, at the time of the last successful synchronization
+    anj_time_duration_t sync_offset;
+    bool sync_offset_known;
+    // drift of the local clock, in parts per billion
+    int32_t drift_ppb;
+    // change of the estimate at the last synchronization
+    uint32_t drift_uncertainty_ppb;
+    bool drift_known;
+#    endif // ANJ_NTP_WITH_DRIFT_COMPENSATION
     // NTP message buffer - can't be on stack because send reguest may be
     // repeated
     uint8_t ntp_msg[_ANJ_NTP_BUFF_SIZE];
@@ -38,6 +38,58 @@ typedef union {
     bool bool_value;
 } _anj_observation_res_val_t;
 
+#    ifdef ANJ_OBSERVE_WITH_INTEGER_THRESHOLDS
+/**
+ * @anj_internal_api_do_not_use
+ * gt, lt and st attributes of an Observation, rounded to integers and
+ * saturated to the int64_t range. A value crosses a threshold if it moves
+ * between the ranges `<= floor` and `> floor`, or `>= ceil` and `< ceil`.
+ */
+typedef struct {
+    int64_t greater_than_floor;
+    int64_t greater_than_ceil;
+    int64_t less_than_floor;
+    int64_t less_than_ceil;
+    uint64_t step_ceil;
+} _anj_observe_int_attr_t;
+#    endif // ANJ_OBSERVE_WITH_INTEGER_THRESHOLDS
+
+#    ifdef ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+/**
+ * @anj_internal_api_do_not_use
+ * Values of a Resource sampled between notifications of an Observation with
+ * the hqmax attribute. The oldest sample is stored as is, each of the others
+ * as a pair of varints in @ref buff: time elapsed since the previous sample
+ * and difference to its value (zigzag-encoded for integers, XOR with trailing
+ * zero bits shifted out for doubles).
+ */
+typedef struct {
+    anj_data_type_t type;
+    uint16_t count;
+    /* Number of the oldest samples included in the notification being sent,
+     * they are removed once it is delivered */
+    uint16_t sent_count;
+    uint16_t size;
+    /* Real time of the oldest and the newest sample, in seconds */
+    int64_t first_timestamp_s;
+    int64_t last_timestamp_s;
+    _anj_observation_res_val_t first_value;
+    _anj_observation_res_val_t last_value;
+    uint8_t buff[ANJ_OBSERVE_HISTORICAL_QUEUE_BUFFER_SIZE];
+} _anj_observe_historical_queue_t;
+
+/**
+ * @anj_internal_api_do_not_use
+ * Position of a sample while reading the historical queue.
+ */
+typedef struct {
+    uint16_t index;
+    uint16_t offset;
+    int64_t timestamp_s;
+    _anj_observation_res_val_t value;
+} _anj_observe_historical_queue_iter_t;
+#    endif // ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+
 /** @anj_internal_api_do_not_use */
 typedef struct _anj_observe_observation_struct _anj_observe_observation_t;
 struct _anj_observe_observation_struct {
@@ -55,17 +107,36 @@ struct _anj_observe_observation_struct {
     // options match.
     uint16_t accept_opt;
     uint16_t content_format_opt;
+#        ifdef ANJ_OBSERVE_WITH_COMPOSITE_DELTA_NOTIFICATIONS
+    // Time when the path was last included in a notification or response;
+    // maximum period of the path is counted from this moment.
+    anj_time_monotonic_t last_included_timestamp;
+    // Set if the path is not included in the notification being created.
+    bool excluded_from_notification;
+#        endif // ANJ_OBSERVE_WITH_COMPOSITE_DELTA_NOTIFICATIONS
 #    endif // ANJ_WITH_OBSERVE_COMPOSITE
 
 #    ifdef ANJ_WITH_LWM2M12
     _anj_attr_notification_t observation_attr;
 #    endif // ANJ_WITH_LWM2M12
     _anj_attr_notification_t effective_attr;
+#    ifdef ANJ_OBSERVE_WITH_INTEGER_THRESHOLDS
+    // set together with effective_attr by @ref
+    // _anj_observe_verify_effective_attributes
+    _anj_observe_int_attr_t int_attr;
+#    endif // ANJ_OBSERVE_WITH_INTEGER_THRESHOLDS
     // if effective_attr are not valid, the observation is not active
     bool observe_active;
 
     anj_time_monotonic_t last_notify_timestamp;
     anj_time_monotonic_t next_conf_notify_timestamp;
+#    ifdef ANJ_OBSERVE_WITH_CON_POLICY
+    // number of notifications created since the last Confirmable one
+    uint16_t non_con_count;
+    // set if the value crossed the gt or lt attribute since the last
+    // notification
+    bool threshold_crossed;
+#    endif // ANJ_OBSERVE_WITH_CON_POLICY
 
     /* This field is used for the purpose of the "Change Value Conditions"
      * attributes handling. This value is written from data model when:
@@ -80,6 +151,34 @@ struct _anj_observe_observation_struct {
      */
     _anj_observation_res_val_t last_sent_value;
 
+#    ifdef ANJ_OBSERVE_WITH_VALUE_CACHE
+    /* Value read while checking the "Change Value Conditions" attributes,
+     * reused when the notification is created. Set only for Observation of
+     * the changed Resource itself. Valid only if has_cached_value
+     * is set, which is cleared when another change of the Resource is reported
+     * or the notification is sent. */
+    _anj_observation_res_val_t cached_value;
+    anj_data_type_t cached_value_type;
+    bool has_cached_value;
+#    endif // ANJ_OBSERVE_WITH_VALUE_CACHE
+
+#    ifdef ANJ_OBSERVE_WITH_EVALUATION_SCHEDULER
+    /* Time of the last check of the "Change Value Conditions" attributes,
+     * next one is scheduled "epmax" after it or after the last notification,
+     * whichever is later. */
+    anj_time_monotonic_t last_eval_timestamp;
+#    endif // ANJ_OBSERVE_WITH_EVALUATION_SCHEDULER
+
+#    ifdef ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+    _anj_observe_historical_queue_t historical_queue;
+#    endif // ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+
+#    ifdef ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS
+    /* ETag of the last notification sent successfully, notification with the
+     * same one is sent with the 2.03 Valid code and no payload */
+    _anj_etag_t last_etag;
+#    endif // ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS
+
 #    ifdef ANJ_WITH_OBSERVE_COMPOSITE
     _anj_observe_observation_t *prev;
 #    endif // ANJ_WITH_OBSERVE_COMPOSITE
@@ -133,12 +232,183 @@ typedef struct anj_observe_server_state_struct {
 #    endif // ANJ_WITH_LWM2M12
 } _anj_observe_server_state_t;
 
+#    ifdef ANJ_OBSERVE_WITH_DEADLINE_INDEX
+/**
+ * @anj_internal_api_do_not_use
+ * Binary min-heap of Observations ordered by the time at which they have to be
+ * checked again (last notification + pmin if a notification is pending, last
+ * notification + pmax otherwise). Deadlines depend on default pmin/pmax of the
+ * server, so a copy of the server state used to calculate them is stored too.
+ */
+typedef struct {
+    bool valid;
+    _anj_observe_server_state_t server_state;
+    /* Latest last_notify_timestamp of indexed Observations, used to detect
+     * that the clock went back */
+    anj_time_monotonic_t latest_notify_timestamp;
+    uint16_t heap_size;
+    /* Observation indexes */
+    uint16_t heap[ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER];
+    /* Position in heap of each Observation, UINT16_MAX if not indexed */
+    uint16_t heap_pos[ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER];
+    anj_time_monotonic_t deadlines[ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER];
+} _anj_observe_deadline_index_t;
+#    endif // ANJ_OBSERVE_WITH_DEADLINE_INDEX
+
+#    ifdef ANJ_OBSERVE_WITH_PATH_INDEX
+/**
+ * @anj_internal_api_do_not_use
+ * Indexes of existing Observations sorted by their paths, so that Observations
+ * affected by a data model change can be found with a binary search.
+ */
+typedef struct {
+    bool valid;
+    uint16_t size;
+    uint16_t entries[ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER];
+} _anj_observe_path_index_t;
+#    endif // ANJ_OBSERVE_WITH_PATH_INDEX
+
+#    ifdef ANJ_OBSERVE_WITH_STATE_ARRAYS
+/** @anj_internal_api_do_not_use */
+#        define _ANJ_OBSERVE_STATE_ACTIVE 0x01
+/** @anj_internal_api_do_not_use */
+#        define _ANJ_OBSERVE_STATE_NOTIFICATION_TO_SEND 0x02
+
+/**
+ * @anj_internal_api_do_not_use
+ * Copies of ssid, observe_active, notification_to_send and path of each
+ * Observation, kept apart from the rest of the Observation data, so that
+ * scanning all Observations reads only these compact arrays. Paths are packed
+ * into 64-bit keys (see @c _anj_uri_path_key_t), so that comparing them is
+ * a single mask-and-compare. The Observations remain the source of truth; the
+ * arrays are rebuilt from them if not valid.
+ */
+typedef struct {
+    bool valid;
+    uint64_t path_key[ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER];
+    uint16_t ssid[ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER];
+    uint8_t flags[ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER];
+} _anj_observe_state_arrays_t;
+#    endif // ANJ_OBSERVE_WITH_STATE_ARRAYS
+
+#    ifdef ANJ_OBSERVE_WITH_TOKEN_INDEX
+/** @anj_internal_api_do_not_use */
+#        define _ANJ_OBSERVE_TOKEN_INDEX_SIZE \
+            (2 * ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER)
+
+/**
+ * @anj_internal_api_do_not_use
+ * Open-addressing hash tables of existing Observations, keyed by SSID and token
+ * and by the message ID of the last notification sent. Collisions are resolved
+ * with linear probing and removed entries are filled by shifting the following
+ * ones back, so a lookup ends at the first empty slot. Observations of the same
+ * Observe-Composite share the token and all of them are indexed.
+ */
+typedef struct {
+    bool valid;
+    /* Observation indexes, UINT16_MAX for empty slots */
+    uint16_t by_token[_ANJ_OBSERVE_TOKEN_INDEX_SIZE];
+#        ifdef ANJ_WITH_RST_AS_CANCEL_OBSERVE
+    uint16_t by_mid[_ANJ_OBSERVE_TOKEN_INDEX_SIZE];
+#        endif // ANJ_WITH_RST_AS_CANCEL_OBSERVE
+} _anj_observe_token_index_t;
+#    endif // ANJ_OBSERVE_WITH_TOKEN_INDEX
+
+#    ifdef ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
+/**
+ * @anj_internal_api_do_not_use
+ * Indexes of used attributes storage records sorted by their paths and SSIDs,
+ * so that attributes of a given path can be found with a binary search.
+ */
+typedef struct {
+    bool valid;
+    uint16_t size;
+    uint16_t entries[ANJ_OBSERVE_MAX_WRITE_ATTRIBUTES_NUMBER];
+#        ifdef ANJ_WITH_DISCOVER_ATTR
+    /* Position in entries at which the last Discover lookup ended */
+    uint16_t discover_pos;
+#        endif // ANJ_WITH_DISCOVER_ATTR
+} _anj_observe_attr_storage_index_t;
+#    endif // ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
+
+#    ifdef ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER
+/**
+ * @anj_internal_api_do_not_use
+ * Ring buffer, provided by the user, of values recorded while the LwM2M Server
+ * is offline. Recorded values are flushed with a single LwM2M Send message once
+ * the Server is back online.
+ */
+typedef struct {
+    anj_io_out_entry_t *records;
+    size_t capacity;
+    size_t first;
+    size_t count;
+    /* Number of records passed to the Send request, 0 if no flush is in
+     * progress. New records are not accepted during a flush. */
+    size_t flushed_count;
+    anj_send_request_t send_request;
+} _anj_observe_notify_store_t;
+#    endif // ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER
+
 /** @anj_internal_api_do_not_use */
 typedef struct {
+#    ifdef ANJ_OBSERVE_WITH_USER_STORAGE
+    /* Point to the tables provided in anj_configuration_t, or to the default
+     * ones below */
+    _anj_observe_observation_t *observations;
+    uint16_t observations_number;
+    _anj_observe_attr_storage_t *attributes_storage;
+    uint16_t attributes_storage_number;
+    _anj_observe_observation_t
+            default_observations[ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER];
+    _anj_observe_attr_storage_t
+            default_attributes_storage[ANJ_OBSERVE_MAX_WRITE_ATTRIBUTES_NUMBER];
+#    else  // ANJ_OBSERVE_WITH_USER_STORAGE
     _anj_observe_observation_t
             observations[ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER];
     _anj_observe_attr_storage_t
             attributes_storage[ANJ_OBSERVE_MAX_WRITE_ATTRIBUTES_NUMBER];
+#    endif // ANJ_OBSERVE_WITH_USER_STORAGE
+#    ifdef ANJ_OBSERVE_WITH_DEADLINE_INDEX
+    _anj_observe_deadline_index_t deadline_index;
+#    endif // ANJ_OBSERVE_WITH_DEADLINE_INDEX
+#    ifdef ANJ_OBSERVE_WITH_PATH_INDEX
+    _anj_observe_path_index_t path_index;
+#    endif // ANJ_OBSERVE_WITH_PATH_INDEX
+#    ifdef ANJ_OBSERVE_WITH_STATE_ARRAYS
+    _anj_observe_state_arrays_t state_arrays;
+#    endif // ANJ_OBSERVE_WITH_STATE_ARRAYS
+#    ifdef ANJ_OBSERVE_WITH_TOKEN_INDEX
+    _anj_observe_token_index_t token_index;
+#    endif // ANJ_OBSERVE_WITH_TOKEN_INDEX
+#    ifdef ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
+    _anj_observe_attr_storage_index_t attr_storage_index;
+#    endif // ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
+#    ifdef ANJ_OBSERVE_WITH_NOTIFICATION_COALESCING
+    /* Time of the notification that opened the coalescing window, invalid if
+     * no coalescing is in progress */
+    anj_time_monotonic_t coalescing_start;
+#    endif // ANJ_OBSERVE_WITH_NOTIFICATION_COALESCING
+#    ifdef ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER
+    _anj_observe_notify_store_t notify_store;
+#    endif // ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER
+#    ifdef ANJ_WITH_STEP_TIME_CACHE
+    /* Time cached by anj_core_step(), set by _anj_observe_init() */
+    const _anj_step_time_t *step_time;
+#    endif // ANJ_WITH_STEP_TIME_CACHE
+
+#    ifdef ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+    /* Next record of the notification with historical values being built */
+    _anj_observe_historical_queue_iter_t historical_iter;
+    bool historical_notification;
+    bool historical_data_to_copy;
+#    endif // ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+
+#    ifdef ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS
+    /* ETag of the notification being sent, becomes the last_etag of the
+     * Observation once the notification is sent */
+    _anj_etag_t notification_etag;
+#    endif // ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS
 
     /* Fields related to currently process operation */
     int in_progress_type;
@@ -160,6 +430,23 @@ typedef struct {
 #    endif // ANJ_WITH_OBSERVE_COMPOSITE
 } _anj_observe_ctx_t;
 
+#    ifdef ANJ_WITH_PIPELINED_NOTIFICATIONS
+/**
+ * @anj_internal_api_do_not_use
+ * Notification sent in a single message that waits for the response, while
+ * other notifications are processed. The Observation is checked against @p ssid
+ * and @p token, since it may be removed in the meantime.
+ */
+typedef struct {
+    _anj_observe_observation_t *observation;
+    uint16_t ssid;
+    _anj_coap_token_t token;
+#        ifdef ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS
+    _anj_etag_t etag;
+#        endif // ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS
+} _anj_observe_detached_notification_t;
+#    endif // ANJ_WITH_PIPELINED_NOTIFICATIONS
+
 #endif // ANJ_WITH_OBSERVE
 
 #ifdef __cplusplus
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJ_INTERNAL_OSCORE_H
+#define ANJ_INTERNAL_OSCORE_H
+
+#ifndef ANJ_INTERNAL_INCLUDE_OSCORE
+#    error "Internal header must not be included directly"
+#endif // ANJ_INTERNAL_INCLUDE_OSCORE
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef ANJ_WITH_OSCORE
+
+/** @anj_internal_api_do_not_use */
+#    define _ANJ_OSCORE_MAX_PIV_LEN 5
+
+/** @anj_internal_api_do_not_use */
+#    define _ANJ_OSCORE_MAX_TOKEN_LEN 8
+
+/** @anj_internal_api_do_not_use */
+#    define _ANJ_OSCORE_REQUESTS_NUMBER 2
+
+/**
+ * @anj_internal_api_do_not_use
+ * Request a response (or a notification) is bound to: its Token and the kid
+ * and Partial IV it was protected with. They are part of the AAD of the
+ * response, and of its nonce if the response carries no Partial IV.
+ */
+typedef struct {
+    bool valid;
+    // set after the first response is protected, any further response to the
+    // same request gets its own Partial IV so that the nonce is not reused
+    bool responded;
+    // only used for requests sent by the client, to detect retransmissions
+    uint16_t msg_id;
+    uint8_t token[_ANJ_OSCORE_MAX_TOKEN_LEN];
+    uint8_t token_len;
+    uint8_t kid[ANJ_OSCORE_MAX_ID_LEN];
+    uint8_t kid_len;
+    uint8_t piv[_ANJ_OSCORE_MAX_PIV_LEN];
+    uint8_t piv_len;
+} _anj_oscore_request_t;
+
+/** @anj_internal_api_do_not_use */
+typedef struct {
+    anj_oscore_security_context_t security;
+    bool active;
+    uint64_t sender_seq_num;
+    // RFC 8613, section 7.4: highest Sequence Number received from the Server
+    // and bitmask of the 32 numbers below it, bit 0 is the highest one
+    bool replay_window_valid;
+    uint64_t replay_window_top;
+    uint32_t replay_window;
+    // requests sent by the client, a pipelined request may be pending next to
+    // the one of the main exchange
+    _anj_oscore_request_t client_requests[_ANJ_OSCORE_REQUESTS_NUMBER];
+    uint16_t next_client_request;
+    // requests received from the Server, a new one may arrive while the
+    // response to the previous one is still being prepared
+    _anj_oscore_request_t server_requests[_ANJ_OSCORE_REQUESTS_NUMBER];
+    uint16_t next_server_request;
+#    ifdef ANJ_WITH_OBSERVE
+    // notifications are bound to the Observe request, not to the last one
+    _anj_oscore_request_t observations[ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER];
+    uint16_t next_observation;
+#    endif // ANJ_WITH_OBSERVE
+} _anj_oscore_ctx_t;
+
+#endif // ANJ_WITH_OSCORE
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ANJ_INTERNAL_OSCORE_H
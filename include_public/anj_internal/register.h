@@ -26,6 +26,15 @@ typedef struct _anj_register_ctx_struct {
     size_t location_path_len[ANJ_COAP_MAX_LOCATION_PATHS_NUMBER];
     _anj_exchange_handlers_t dm_handlers;
     bool with_payload;
+#ifdef ANJ_WITH_NAT_REBINDING_RECOVERY
+    // indicate if the last operation failed without a response
+    bool no_response;
+#endif // ANJ_WITH_NAT_REBINDING_RECOVERY
+#ifdef ANJ_DM_WITH_LINK_SET_HASH
+    uint32_t sent_link_set_hash;
+    uint32_t acked_link_set_hash;
+    bool acked_link_set_hash_valid;
+#endif // ANJ_DM_WITH_LINK_SET_HASH
 } _anj_register_ctx_t;
 
 #ifdef __cplusplus
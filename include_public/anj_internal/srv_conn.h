@@ -27,6 +27,39 @@ typedef struct anj_server_connection_ctx_struct {
     bool send_in_progress;
 } _anj_server_connection_ctx_t;
 
+#ifdef ANJ_WITH_PMTU_PROBING
+/** @anj_internal_api_do_not_use */
+typedef struct {
+    // Security Object Instance of the server the values were learned for
+    anj_iid_t security_iid;
+    // inner MTU reported by the network layer, upper bound of the search
+    int32_t reported;
+    // largest datagram the server is known to have received
+    int32_t confirmed;
+    // smallest datagram known to be lost, reported + 1 if there is none
+    int32_t lost;
+    // largest datagram of the ongoing Confirmable client request
+    int32_t sent_max;
+} _anj_srv_conn_pmtu_t;
+#endif // ANJ_WITH_PMTU_PROBING
+
+#ifdef ANJ_WITH_NAT_KEEPALIVE_PROBING
+/** @anj_internal_api_do_not_use */
+typedef struct {
+    // bounds of the search, from anj_configuration_t
+    anj_time_duration_t min;
+    anj_time_duration_t max;
+    // longest idle time after which a request of the server still came in
+    anj_time_duration_t confirmed;
+    // shortest idle time after which the connection was lost, max if none
+    anj_time_duration_t lost;
+    // end of the last exchange with the server
+    anj_time_monotonic_t last_traffic;
+    // idle time before the ongoing client request, zero if unknown
+    anj_time_duration_t request_idle;
+} _anj_srv_conn_nat_t;
+#endif // ANJ_WITH_NAT_KEEPALIVE_PROBING
+
 #ifdef __cplusplus
 }
 #endif
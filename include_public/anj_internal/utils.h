@@ -14,6 +14,12 @@
 #    error "Internal header must not be included directly"
 #endif // ANJ_INTERNAL_INCLUDE_UTILS
 
+#ifdef ANJ_WITH_STEP_TIME_CACHE
+#    include <stdbool.h>
+
+#    include <anj/time.h>
+#endif // ANJ_WITH_STEP_TIME_CACHE
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -70,6 +76,18 @@ extern "C" {
 #define _ANJ_MAKE_URI_PATH(...) \
     ((anj_uri_path_t) _ANJ_URI_PATH_INITIALIZER(__VA_ARGS__))
 
+#ifdef ANJ_WITH_STEP_TIME_CACHE
+/**
+ * @anj_internal_api_do_not_use
+ * Monotonic time read at the beginning of @ref anj_core_step.
+ */
+typedef struct {
+    // set only during anj_core_step()
+    bool valid;
+    anj_time_monotonic_t now;
+} _anj_step_time_t;
+#endif // ANJ_WITH_STEP_TIME_CACHE
+
 #ifdef __cplusplus
 }
 #endif
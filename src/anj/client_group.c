@@ -0,0 +1,81 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#include <assert.h>
+#include <stddef.h>
+
+#include <anj/client_group.h>
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/dm/core.h>
+#include <anj/time.h>
+
+#ifdef ANJ_WITH_CLIENT_GROUP
+
+void anj_client_group_init(anj_client_group_t *group,
+                           anj_t *const *clients,
+                           size_t clients_count) {
+    assert(group && clients && clients_count);
+    group->clients = clients;
+    group->clients_count = clients_count;
+    group->next_client = 0;
+}
+
+int anj_client_group_add_obj(anj_client_group_t *group,
+                             const anj_dm_obj_t *obj) {
+    assert(group && obj);
+    for (size_t i = 0; i < group->clients_count; i++) {
+        int res = anj_dm_add_obj(group->clients[i], obj);
+        if (res) {
+            while (i--) {
+                (void) anj_dm_remove_obj(group->clients[i], obj->oid);
+            }
+            return res;
+        }
+    }
+    return 0;
+}
+
+void anj_client_group_step(anj_client_group_t *group) {
+    assert(group);
+    size_t idx = group->next_client;
+    for (size_t i = 0; i < group->clients_count; i++) {
+        anj_core_step(group->clients[idx]);
+        idx = (idx + 1) % group->clients_count;
+    }
+    group->next_client = (group->next_client + 1) % group->clients_count;
+}
+
+void anj_client_group_data_model_changed(anj_client_group_t *group,
+                                         const anj_uri_path_t *path,
+                                         anj_core_change_type_t change_type) {
+    assert(group && path);
+    for (size_t i = 0; i < group->clients_count; i++) {
+        anj_core_data_model_changed(group->clients[i], path, change_type);
+    }
+}
+
+anj_time_duration_t
+anj_client_group_next_step_time(const anj_client_group_t *group) {
+    assert(group);
+    anj_time_duration_t result = ANJ_TIME_DURATION_INVALID;
+    for (size_t i = 0; i < group->clients_count; i++) {
+        anj_time_duration_t timeout =
+                anj_core_next_step_time(group->clients[i]);
+        if (!anj_time_duration_is_valid(result)
+                || anj_time_duration_lt(timeout, result)) {
+            result = timeout;
+        }
+    }
+    return result;
+}
+
+#endif // ANJ_WITH_CLIENT_GROUP
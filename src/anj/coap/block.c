@@ -33,34 +33,21 @@
 #define _ANJ_BLOCK_2_BYTE_NUM_MAX_VALUE 4095
 #define _ANJ_BLOCK_NUM_MAX_VALUE 0x000FFFFF
 
-int _anj_block_decode(anj_coap_options_t *opts, _anj_block_t *block) {
-    bool check_block2_opt = false;
+static int decode_block_option(anj_coap_options_t *opts,
+                               uint16_t opt_number,
+                               _anj_block_t *block) {
     uint8_t block_buff[_ANJ_BLOCK_OPTION_MAX_SIZE];
     size_t block_option_size = 0;
 
-    memset(block, 0, sizeof(_anj_block_t));
-
-    int res = _anj_coap_options_get_data_iterate(opts, _ANJ_COAP_OPTION_BLOCK1,
-                                                 NULL, &block_option_size,
-                                                 block_buff,
+    int res = _anj_coap_options_get_data_iterate(opts, opt_number, NULL,
+                                                 &block_option_size, block_buff,
                                                  _ANJ_BLOCK_OPTION_MAX_SIZE);
-    if (res == _ANJ_COAP_OPTION_MISSING) {
-        res = _anj_coap_options_get_data_iterate(opts, _ANJ_COAP_OPTION_BLOCK2,
-                                                 NULL, &block_option_size,
-                                                 block_buff,
-                                                 _ANJ_BLOCK_OPTION_MAX_SIZE);
-        check_block2_opt = true;
-    }
-    if (res == _ANJ_COAP_OPTION_MISSING) {
-        return 0;
-    } else if (res) {
+    if (res) {
         return res;
     } else if (!block_option_size) {
         // dont't allow empty block option
         return _ANJ_ERR_MALFORMED_MESSAGE;
-    } else if (!res && block_option_size <= _ANJ_BLOCK_OPTION_MAX_SIZE) {
-        block->block_type =
-                check_block2_opt ? ANJ_OPTION_BLOCK_2 : ANJ_OPTION_BLOCK_1;
+    } else if (block_option_size <= _ANJ_BLOCK_OPTION_MAX_SIZE) {
         block->more_flag = !!(block_buff[block_option_size - 1]
                               & _ANJ_BLOCK_OPTION_M_MASK);
 
@@ -97,6 +84,37 @@ int _anj_block_decode(anj_coap_options_t *opts, _anj_block_t *block) {
     }
 }
 
+int _anj_block_decode(anj_coap_options_t *opts, _anj_block_t *block) {
+    memset(block, 0, sizeof(_anj_block_t));
+
+    int res = decode_block_option(opts, _ANJ_COAP_OPTION_BLOCK1, block);
+    if (!res) {
+        block->block_type = ANJ_OPTION_BLOCK_1;
+        return 0;
+    }
+    if (res == _ANJ_COAP_OPTION_MISSING) {
+        res = decode_block_option(opts, _ANJ_COAP_OPTION_BLOCK2, block);
+        if (!res) {
+            block->block_type = ANJ_OPTION_BLOCK_2;
+            return 0;
+        }
+    }
+    return res == _ANJ_COAP_OPTION_MISSING ? 0 : res;
+}
+
+#ifdef ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+int _anj_block_decode_q_block2(anj_coap_options_t *opts, _anj_block_t *block) {
+    memset(block, 0, sizeof(_anj_block_t));
+
+    int res = decode_block_option(opts, _ANJ_COAP_OPTION_Q_BLOCK2, block);
+    if (!res) {
+        block->block_type = ANJ_OPTION_Q_BLOCK_2;
+        return 0;
+    }
+    return res == _ANJ_COAP_OPTION_MISSING ? 0 : res;
+}
+#endif // ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+
 int _anj_block_prepare(anj_coap_options_t *opts, const _anj_block_t *block) {
     uint16_t opt_number;
 
@@ -104,7 +122,13 @@ int _anj_block_prepare(anj_coap_options_t *opts, const _anj_block_t *block) {
         opt_number = _ANJ_COAP_OPTION_BLOCK1;
     } else if (block->block_type == ANJ_OPTION_BLOCK_2) {
         opt_number = _ANJ_COAP_OPTION_BLOCK2;
-    } else {
+    }
+#ifdef ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+    else if (block->block_type == ANJ_OPTION_Q_BLOCK_2) {
+        opt_number = _ANJ_COAP_OPTION_Q_BLOCK2;
+    }
+#endif // ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+    else {
         return _ANJ_ERR_INPUT_ARG;
     }
 
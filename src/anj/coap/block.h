@@ -17,6 +17,11 @@
 
 int _anj_block_decode(anj_coap_options_t *opts, _anj_block_t *block);
 
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+// decodes Q-Block2 option (RFC 9177) of the response to the downloader request
+int _anj_block_decode_q_block2(anj_coap_options_t *opts, _anj_block_t *block);
+#    endif // ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+
 int _anj_block_prepare(anj_coap_options_t *opts, const _anj_block_t *block);
 
 #endif // SRC_ANJ_COAP_BLOCK_H
@@ -18,6 +18,10 @@
 
 #    include <anj/defs.h>
 
+#    ifdef ANJ_WITH_OSCORE
+#        include <anj/oscore.h>
+#    endif // ANJ_WITH_OSCORE
+
 #    define ANJ_INTERNAL_INCLUDE_COAP
 #    include <anj_internal/coap.h>
 #    undef ANJ_INTERNAL_INCLUDE_COAP
@@ -41,6 +45,10 @@
 #    define _ANJ_COAP_FORMAT_OMA_LWM2M_TLV 11542
 #    define _ANJ_COAP_FORMAT_OMA_LWM2M_JSON 11543
 #    define _ANJ_COAP_FORMAT_OMA_LWM2M_CBOR 11544
+#    ifdef ANJ_WITH_SENML_CBOR_STRINGREF
+#        define _ANJ_COAP_FORMAT_SENML_CBOR_STRINGREF \
+            ANJ_SENML_CBOR_STRINGREF_FORMAT
+#    endif // ANJ_WITH_SENML_CBOR_STRINGREF
 
 /**
  * Determines whether the given CoAP code represents an error response.
@@ -74,6 +82,8 @@
 #    define _ANJ_ERR_COAP_BAD_MSG (-7)
 /** Location paths number oversizes @ref ANJ_COAP_MAX_LOCATION_PATHS_NUMBER */
 #    define _ANJ_ERR_LOCATION_PATHS_NUMBER (-8)
+/** OSCORE protection or verification of the message failed. */
+#    define _ANJ_ERR_OSCORE (-9)
 
 /**
  * Maximum possible size of CoAP ACK message without payload.
@@ -131,6 +141,67 @@ int _anj_coap_encode_udp(_anj_coap_msg_t *msg,
                          size_t out_buff_size,
                          size_t *out_msg_size);
 
+#    ifdef ANJ_NET_WITH_SEND_VEC
+/**
+ * Works like @ref _anj_coap_encode_udp, but stops after the payload marker:
+ * the payload itself is not copied into @p out_buff and is expected to be sent
+ * right after the header, directly from @p msg.payload.
+ *
+ * @p msg.payload_size might be zeroed for message types that don't carry
+ * payload, so it must be read after this call.
+ *
+ * @param      msg             Structured LwM2M message.
+ * @param[out] out_buff        Buffer for serialized message header.
+ * @param      out_buff_size   Buffer size.
+ * @param[out] out_header_size Size of the prepared header, including the
+ *                             payload marker if there is any payload.
+ *
+ * @return 0 on success, or an one of the error codes defined at the top of this
+ * file.
+ */
+int _anj_coap_encode_udp_header(_anj_coap_msg_t *msg,
+                                uint8_t *out_buff,
+                                size_t out_buff_size,
+                                size_t *out_header_size);
+#    endif // ANJ_NET_WITH_SEND_VEC
+
+#    ifdef ANJ_COAP_WITH_MSG_TEMPLATES
+/**
+ * Works like @ref _anj_coap_encode_udp, but the Uri-Path and Content-Format
+ * options of Update, Notify and Send messages are copied from @p templates
+ * instead of being encoded one by one. The template of a given message kind is
+ * prepared again whenever the Location-Path or Content-Format changes.
+ *
+ * @param      templates     Templates of previous messages, zeroed before the
+ *                           first call.
+ * @param      msg           Structured LwM2M message.
+ * @param[out] out_buff      Buffer for serialized LwM2M message.
+ * @param      out_buff_size Buffer size.
+ * @param[out] out_msg_size  Size of the prepared message.
+ *
+ * @return 0 on success, or an one of the error codes defined at the top of this
+ * file.
+ */
+int _anj_coap_encode_udp_with_templates(_anj_coap_msg_templates_t *templates,
+                                        _anj_coap_msg_t *msg,
+                                        uint8_t *out_buff,
+                                        size_t out_buff_size,
+                                        size_t *out_msg_size);
+
+#        ifdef ANJ_NET_WITH_SEND_VEC
+/**
+ * Combination of @ref _anj_coap_encode_udp_header and
+ * @ref _anj_coap_encode_udp_with_templates.
+ */
+int _anj_coap_encode_udp_header_with_templates(
+        _anj_coap_msg_templates_t *templates,
+        _anj_coap_msg_t *msg,
+        uint8_t *out_buff,
+        size_t out_buff_size,
+        size_t *out_header_size);
+#        endif // ANJ_NET_WITH_SEND_VEC
+#    endif     // ANJ_COAP_WITH_MSG_TEMPLATES
+
 /**
  * Returns the maximum possible size of the CoAP message without payload. This
  * value is used to calculate the maximum size of single chunk of payload.
@@ -146,4 +217,229 @@ int _anj_coap_encode_udp(_anj_coap_msg_t *msg,
  */
 size_t _anj_coap_calculate_msg_header_max_size(const _anj_coap_msg_t *msg);
 
+#    ifdef ANJ_WITH_SCRATCH_ARENA
+/**
+ * Works like @ref _anj_coap_decode_udp, but the CoAP options are collected in
+ * @p options instead of an array on the stack.
+ *
+ * @param      options       Array of @ref ANJ_COAP_MAX_OPTIONS_NUMBER elements,
+ *                           not used after the function returns.
+ * @param      msg           Message to decode.
+ * @param      msg_size      Size of the message.
+ * @param[out] out_data      Empty LwM2M data instance.
+ */
+int _anj_coap_decode_udp_with_scratch(anj_coap_option_t *options,
+                                      uint8_t *msg,
+                                      size_t msg_size,
+                                      _anj_coap_msg_t *out_data);
+
+/**
+ * Common implementation of all encoding functions above, with the CoAP options
+ * collected in @p options instead of an array on the stack.
+ *
+ * @param      options       Array of @ref ANJ_COAP_MAX_OPTIONS_NUMBER elements,
+ *                           not used after the function returns.
+ * @param      templates     Templates of previous messages, or NULL to encode
+ *                           all options one by one. Must be NULL if
+ *                           @ref ANJ_COAP_WITH_MSG_TEMPLATES is disabled.
+ * @param      msg           Structured LwM2M message.
+ * @param[out] out_buff      Buffer for serialized LwM2M message.
+ * @param      out_buff_size Buffer size.
+ * @param      with_payload  If false, encoding stops after the payload
+ *                           marker, like in @ref _anj_coap_encode_udp_header.
+ *                           Must be true if @ref ANJ_NET_WITH_SEND_VEC is
+ *                           disabled.
+ * @param[out] out_msg_size  Size of the prepared message or header.
+ */
+int _anj_coap_encode_udp_with_scratch(anj_coap_option_t *options,
+                                      _anj_coap_msg_templates_t *templates,
+                                      _anj_coap_msg_t *msg,
+                                      uint8_t *out_buff,
+                                      size_t out_buff_size,
+                                      bool with_payload,
+                                      size_t *out_msg_size);
+#    endif // ANJ_WITH_SCRATCH_ARENA
+
+#    ifdef _ANJ_COAP_WITH_TCP
+/**
+ * CoAP over TCP signaling codes, as defined in RFC 8323, section 5.
+ */
+#        define _ANJ_COAP_CODE_CSM ANJ_COAP_CODE(7, 1)
+#        define _ANJ_COAP_CODE_PING ANJ_COAP_CODE(7, 2)
+#        define _ANJ_COAP_CODE_PONG ANJ_COAP_CODE(7, 3)
+#        define _ANJ_COAP_CODE_RELEASE ANJ_COAP_CODE(7, 4)
+#        define _ANJ_COAP_CODE_ABORT ANJ_COAP_CODE(7, 5)
+
+/**
+ * Maximum size of CoAP over TCP header (without the token): Len/TKL byte,
+ * 4 bytes of extended length and the code.
+ */
+#        define _ANJ_COAP_TCP_HEADER_MAX_LENGTH 6
+
+/**
+ * Determines the size of the CoAP over TCP message that starts at @p buff.
+ * Intended for splitting the received byte stream into messages.
+ *
+ * @param buff     Beginning of the message.
+ * @param buff_len Number of bytes of the message received so far.
+ *
+ * @return Size of the whole message, including the header, or 0 if
+ *         @p buff_len is too small to contain the header.
+ */
+size_t _anj_coap_tcp_frame_size(const uint8_t *buff, size_t buff_len);
+
+/**
+ * Works like @ref _anj_coap_decode_udp, but @p frame is a single CoAP over TCP
+ * message (RFC 8323). There is no Message ID and the message type, which does
+ * not exist in CoAP over TCP, is set to @ref ANJ_COAP_UDP_TYPE_CONFIRMABLE for
+ * requests and to @ref ANJ_COAP_UDP_TYPE_ACKNOWLEDGEMENT for other messages.
+ * Signaling messages are decoded with @ref ANJ_OP_COAP_TCP_SIGNALING operation
+ * and their code in <c>msg_code</c>.
+ *
+ * @param      frame      CoAP over TCP message.
+ * @param      frame_size Size of the message, see
+ *                        @ref _anj_coap_tcp_frame_size.
+ * @param[out] out_data   Decoded message.
+ *
+ * @return 0 on success, negative value in case of error.
+ */
+int _anj_coap_decode_tcp(uint8_t *frame,
+                         size_t frame_size,
+                         _anj_coap_msg_t *out_data);
+
+/**
+ * Works like @ref _anj_coap_encode_udp, but prepares CoAP over TCP message
+ * (RFC 8323). Message ID and message type are not used. For
+ * @ref ANJ_OP_COAP_TCP_SIGNALING operation, <c>msg_code</c> must be set to one
+ * of the signaling codes; signaling messages are encoded without options and
+ * payload.
+ *
+ * @param      msg           Structured LwM2M message.
+ * @param[out] out_buff      Buffer for serialized message.
+ * @param      out_buff_size Buffer size.
+ * @param[out] out_msg_size  Size of the prepared message.
+ *
+ * @return 0 on success, or an one of the error codes defined at the top of this
+ * file.
+ */
+int _anj_coap_encode_tcp(_anj_coap_msg_t *msg,
+                         uint8_t *out_buff,
+                         size_t out_buff_size,
+                         size_t *out_msg_size);
+#    endif // _ANJ_COAP_WITH_TCP
+
+#    ifdef ANJ_COAP_WITH_HEADER_COMPRESSION
+/**
+ * Compresses the CoAP over UDP message in @p msg in place, following the
+ * static rule set described at @ref ANJ_COAP_WITH_HEADER_COMPRESSION. The
+ * Rule ID is carried in the CoAP Version field, so a message to which no rule
+ * applies is left unchanged.
+ *
+ * @p msg may be just the header of the message, as prepared by
+ * @ref _anj_coap_encode_udp_header; only the Uri-Path options are affected.
+ *
+ * @param         msg           Encoded CoAP message.
+ * @param[in,out] inout_size    Size of the message, updated after compression.
+ * @param         location_path Location path of the current registration,
+ *                              may be empty.
+ *
+ * @return 0 on success, negative value if @p msg is malformed.
+ */
+int _anj_coap_compress(uint8_t *msg,
+                       size_t *inout_size,
+                       const _anj_location_path_t *location_path);
+
+/**
+ * Reverts @ref _anj_coap_compress in place. Messages with CoAP Version 1 are
+ * left unchanged.
+ *
+ * @param         msg           Received message.
+ * @param[in,out] inout_size    Size of the message, updated after
+ *                              decompression.
+ * @param         buff_size     Size of the buffer that holds @p msg.
+ * @param         location_path Location path of the current registration,
+ *                              may be empty.
+ *
+ * @return
+ * - 0 on success,
+ * - @ref _ANJ_ERR_BUFF if the decompressed message does not fit in the buffer,
+ * - @ref _ANJ_ERR_MALFORMED_MESSAGE if the message is malformed or refers to
+ *   an unknown rule.
+ */
+int _anj_coap_decompress(uint8_t *msg,
+                         size_t *inout_size,
+                         size_t buff_size,
+                         const _anj_location_path_t *location_path);
+#    endif // ANJ_COAP_WITH_HEADER_COMPRESSION
+
+#    ifdef ANJ_WITH_OSCORE
+/**
+ * Maximum number of bytes by which @ref _anj_oscore_protect makes a message
+ * larger: the OSCORE option with the flags byte, Partial IV and kid, the
+ * payload marker, the encrypted code and the authentication tag, plus 2 bytes
+ * for option deltas that may grow when the outer options are taken out.
+ */
+#        define _ANJ_OSCORE_MAX_OVERHEAD                                     \
+            (2 + 1 + _ANJ_OSCORE_MAX_PIV_LEN + ANJ_OSCORE_MAX_ID_LEN + 1 + 1 \
+             + ANJ_OSCORE_TAG_LEN + 2)
+
+/**
+ * Protects the CoAP over UDP message in @p msg in place, as described in
+ * RFC 8613, section 8.1 (requests) and 8.3 (responses). The code, the options
+ * other than Uri-Host, Uri-Port, Proxy-Uri and Proxy-Scheme and the payload
+ * are encrypted into the payload of the outer message, which is a POST or
+ * FETCH request, or a 2.04 Changed or 2.05 Content response. Empty messages
+ * are left unchanged.
+ *
+ * A request that has the same Token and Message ID as the previous one sent
+ * is a retransmission and is protected with the same Partial IV. A response is
+ * bound to the request received from the Server with the same Token, or to the
+ * Observe request if the response carries the Observe option.
+ *
+ * The content of @p msg is unspecified if an error is returned.
+ *
+ * @param         ctx        OSCORE context.
+ * @param         msg        Encoded CoAP message, with the payload.
+ * @param[in,out] inout_size Size of the message, updated after protection.
+ * @param         buff_size  Size of the buffer that holds @p msg.
+ *
+ * @return
+ * - 0 on success,
+ * - @ref _ANJ_ERR_BUFF if the protected message does not fit in the buffer,
+ * - @ref _ANJ_ERR_MALFORMED_MESSAGE if @p msg is malformed or already
+ *   carries the OSCORE option,
+ * - @ref _ANJ_ERR_OSCORE if there is no request the response could be bound
+ *   to, the Sender Sequence Number is exhausted or the encryption failed.
+ */
+int _anj_oscore_protect(_anj_oscore_ctx_t *ctx,
+                        uint8_t *msg,
+                        size_t *inout_size,
+                        size_t buff_size);
+
+/**
+ * Verifies and decrypts the message protected with OSCORE in place. The
+ * decrypted code, options and payload replace the outer ones; outer options
+ * of the message, e.g. Observe, are not retained. Empty messages are left
+ * unchanged.
+ *
+ * A request is rejected if its Partial IV was already received, unless it is
+ * a duplicate of one of the last requests, with the same Partial IV and
+ * Token. A response must have the Token of a request sent earlier.
+ *
+ * @param         ctx        OSCORE context.
+ * @param         msg        Received message.
+ * @param[in,out] inout_size Size of the message, updated after verification.
+ *
+ * @return
+ * - 0 on success,
+ * - @ref _ANJ_ERR_MALFORMED_MESSAGE if the message or its decrypted content
+ *   is malformed,
+ * - @ref _ANJ_ERR_OSCORE if the message is not protected, is a replay, is
+ *   protected with an unknown context or its authentication failed.
+ */
+int _anj_oscore_unprotect(_anj_oscore_ctx_t *ctx,
+                          uint8_t *msg,
+                          size_t *inout_size);
+#    endif // ANJ_WITH_OSCORE
+
 #endif // ANJ_H
@@ -0,0 +1,276 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/defs.h>
+
+#include "coap.h"
+#include "common.h"
+#include "options.h"
+#include "udp_header.h"
+
+#ifdef ANJ_COAP_WITH_HEADER_COMPRESSION
+
+/*
+ * Rule IDs, carried in the 2-bit CoAP Version field. Version 1 is a regular,
+ * uncompressed message.
+ */
+#    define RULE_LOCATION_PATH 0
+#    define RULE_NONE 1
+#    define RULE_REGISTER 2
+#    define RULE_SEND 3
+
+#    define OPTION_HEADER_MAX_LEN 5
+
+typedef struct {
+    const char *const *segments;
+    const size_t *segments_len;
+    size_t segments_count;
+} uri_path_rule_t;
+
+static const char *const REGISTER_SEGMENTS[] = { "rd" };
+static const char *const SEND_SEGMENTS[] = { "dp" };
+static const size_t FIXED_SEGMENTS_LEN[] = { 2 };
+
+static int get_rule(uint8_t rule_id,
+                    const _anj_location_path_t *location_path,
+                    uri_path_rule_t *out_rule) {
+    switch (rule_id) {
+    case RULE_LOCATION_PATH:
+        if (!location_path || !location_path->location_count) {
+            return -1;
+        }
+        out_rule->segments = location_path->location;
+        out_rule->segments_len = location_path->location_len;
+        out_rule->segments_count = location_path->location_count;
+        return 0;
+    case RULE_REGISTER:
+        out_rule->segments = REGISTER_SEGMENTS;
+        out_rule->segments_len = FIXED_SEGMENTS_LEN;
+        out_rule->segments_count = 1;
+        return 0;
+    case RULE_SEND:
+        out_rule->segments = SEND_SEGMENTS;
+        out_rule->segments_len = FIXED_SEGMENTS_LEN;
+        out_rule->segments_count = 1;
+        return 0;
+    default:
+        return -1;
+    }
+}
+
+static bool rule_matches(const uri_path_rule_t *rule,
+                         const anj_coap_option_t *uri_path,
+                         size_t uri_path_count) {
+    if (rule->segments_count != uri_path_count) {
+        return false;
+    }
+    for (size_t i = 0; i < uri_path_count; i++) {
+        if (rule->segments_len[i] != uri_path[i].payload_len
+                || memcmp(rule->segments[i], uri_path[i].payload,
+                          uri_path[i].payload_len)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint8_t find_rule(const _anj_location_path_t *location_path,
+                         const anj_coap_option_t *uri_path,
+                         size_t uri_path_count) {
+    static const uint8_t RULES[] = { RULE_LOCATION_PATH, RULE_REGISTER,
+                                     RULE_SEND };
+    for (size_t i = 0; i < sizeof(RULES); i++) {
+        uri_path_rule_t rule;
+        if (!get_rule(RULES[i], location_path, &rule)
+                && rule_matches(&rule, uri_path, uri_path_count)) {
+            return RULES[i];
+        }
+    }
+    return RULE_NONE;
+}
+
+static int decode_options(uint8_t *msg,
+                          size_t msg_size,
+                          anj_coap_options_t *opts,
+                          uint8_t **out_options_begin) {
+    if (msg_size < _ANJ_COAP_UDP_HEADER_LENGTH) {
+        return _ANJ_ERR_MALFORMED_MESSAGE;
+    }
+    size_t header_size = _ANJ_COAP_UDP_HEADER_LENGTH
+                         + _anj_coap_udp_header_get_token_length(msg[0]);
+    if (msg_size < header_size) {
+        return _ANJ_ERR_MALFORMED_MESSAGE;
+    }
+    size_t bytes_read;
+    *out_options_begin = msg + header_size;
+    return _anj_coap_options_decode(opts, msg + header_size,
+                                    msg_size - header_size, &bytes_read);
+}
+
+// Beginning of the header of the option at @p idx
+static uint8_t *option_begin(const anj_coap_options_t *opts,
+                             uint8_t *options_begin,
+                             size_t idx) {
+    if (!idx) {
+        return options_begin;
+    }
+    const anj_coap_option_t *prev = &opts->options[idx - 1];
+    return (uint8_t *) (intptr_t) (prev->payload + prev->payload_len);
+}
+
+static uint16_t previous_number(const anj_coap_options_t *opts, size_t idx) {
+    return idx ? opts->options[idx - 1].option_number : 0;
+}
+
+int _anj_coap_compress(uint8_t *msg,
+                       size_t *inout_size,
+                       const _anj_location_path_t *location_path) {
+    assert(msg && inout_size);
+    if (*inout_size >= 1 && _anj_coap_udp_header_get_version(msg[0]) != 1) {
+        return _ANJ_ERR_MALFORMED_MESSAGE;
+    }
+    anj_coap_option_t options[ANJ_COAP_MAX_OPTIONS_NUMBER];
+    anj_coap_options_t opts = {
+        .options_size = ANJ_COAP_MAX_OPTIONS_NUMBER,
+        .options = options
+    };
+    uint8_t *options_begin;
+    int res = decode_options(msg, *inout_size, &opts, &options_begin);
+    _RET_IF_ERROR(res);
+
+    size_t first = 0;
+    while (first < opts.options_number
+           && options[first].option_number != _ANJ_COAP_OPTION_URI_PATH) {
+        first++;
+    }
+    size_t count = 0;
+    while (first + count < opts.options_number
+           && options[first + count].option_number
+                      == _ANJ_COAP_OPTION_URI_PATH) {
+        count++;
+    }
+    if (!count) {
+        return 0;
+    }
+    uint8_t rule_id = find_rule(location_path, &options[first], count);
+    if (rule_id == RULE_NONE) {
+        return 0;
+    }
+
+    uint8_t *msg_end = msg + *inout_size;
+    uint8_t *dst = option_begin(&opts, options_begin, first);
+    const uint8_t *tail = option_begin(&opts, options_begin, first + count);
+    if (first + count < opts.options_number) {
+        // delta of the option that follows Uri-Path changes
+        const anj_coap_option_t *next = &options[first + count];
+        uint8_t header[OPTION_HEADER_MAX_LEN];
+        size_t header_size = _anj_coap_options_prepare_header(
+                header, previous_number(&opts, first), next->option_number,
+                next->payload_len);
+        // removed Uri-Path options take more space than the header may grow
+        assert(dst + header_size <= next->payload);
+        memcpy(dst, header, header_size);
+        dst += header_size;
+        tail = next->payload;
+    }
+    memmove(dst, tail, (size_t) (msg_end - tail));
+    *inout_size = (size_t) (dst - msg) + (size_t) (msg_end - tail);
+    _anj_coap_udp_header_set_version(&msg[0], rule_id);
+    return 0;
+}
+
+int _anj_coap_decompress(uint8_t *msg,
+                         size_t *inout_size,
+                         size_t buff_size,
+                         const _anj_location_path_t *location_path) {
+    assert(msg && inout_size && *inout_size <= buff_size);
+    if (*inout_size < 1) {
+        return _ANJ_ERR_MALFORMED_MESSAGE;
+    }
+    uint8_t rule_id = _anj_coap_udp_header_get_version(msg[0]);
+    if (rule_id == RULE_NONE) {
+        return 0;
+    }
+    uri_path_rule_t rule;
+    if (get_rule(rule_id, location_path, &rule)) {
+        return _ANJ_ERR_MALFORMED_MESSAGE;
+    }
+    anj_coap_option_t options[ANJ_COAP_MAX_OPTIONS_NUMBER];
+    anj_coap_options_t opts = {
+        .options_size = ANJ_COAP_MAX_OPTIONS_NUMBER,
+        .options = options
+    };
+    uint8_t *options_begin;
+    int res = decode_options(msg, *inout_size, &opts, &options_begin);
+    _RET_IF_ERROR(res);
+
+    size_t next = 0;
+    while (next < opts.options_number
+           && options[next].option_number <= _ANJ_COAP_OPTION_URI_PATH) {
+        if (options[next].option_number == _ANJ_COAP_OPTION_URI_PATH) {
+            // Uri-Path is never sent in compressed messages
+            return _ANJ_ERR_MALFORMED_MESSAGE;
+        }
+        next++;
+    }
+
+    uint8_t uri_path_headers[ANJ_COAP_MAX_LOCATION_PATHS_NUMBER]
+                            [OPTION_HEADER_MAX_LEN];
+    size_t uri_path_headers_size[ANJ_COAP_MAX_LOCATION_PATHS_NUMBER];
+    size_t inserted_size = 0;
+    uint16_t prev_number = previous_number(&opts, next);
+    assert(rule.segments_count <= ANJ_COAP_MAX_LOCATION_PATHS_NUMBER);
+    for (size_t i = 0; i < rule.segments_count; i++) {
+        uri_path_headers_size[i] = _anj_coap_options_prepare_header(
+                uri_path_headers[i], prev_number, _ANJ_COAP_OPTION_URI_PATH,
+                rule.segments_len[i]);
+        inserted_size += uri_path_headers_size[i] + rule.segments_len[i];
+        prev_number = _ANJ_COAP_OPTION_URI_PATH;
+    }
+
+    uint8_t *msg_end = msg + *inout_size;
+    uint8_t *insert_at = option_begin(&opts, options_begin, next);
+    const uint8_t *tail = insert_at;
+    uint8_t next_header[OPTION_HEADER_MAX_LEN];
+    size_t next_header_size = 0;
+    if (next < opts.options_number) {
+        next_header_size = _anj_coap_options_prepare_header(
+                next_header, _ANJ_COAP_OPTION_URI_PATH,
+                options[next].option_number, options[next].payload_len);
+        tail = options[next].payload;
+    }
+    size_t tail_size = (size_t) (msg_end - tail);
+    size_t new_size = (size_t) (insert_at - msg) + inserted_size
+                      + next_header_size + tail_size;
+    if (new_size > buff_size) {
+        return _ANJ_ERR_BUFF;
+    }
+
+    memmove(insert_at + inserted_size + next_header_size, tail, tail_size);
+    for (size_t i = 0; i < rule.segments_count; i++) {
+        memcpy(insert_at, uri_path_headers[i], uri_path_headers_size[i]);
+        insert_at += uri_path_headers_size[i];
+        memcpy(insert_at, rule.segments[i], rule.segments_len[i]);
+        insert_at += rule.segments_len[i];
+    }
+    memcpy(insert_at, next_header, next_header_size);
+    *inout_size = new_size;
+    _anj_coap_udp_header_set_version(&msg[0], 1);
+    return 0;
+}
+
+#endif // ANJ_COAP_WITH_HEADER_COMPRESSION
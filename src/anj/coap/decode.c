@@ -27,14 +27,41 @@
 #include "common.h"
 
 #include "options.h"
+#include "tcp_header.h"
 #include "udp_header.h"
 
 #define _URI_PATH_MAX_LEN_STR sizeof("65534")
 
+#ifdef ANJ_WITH_LWM2M_GATEWAY
+static void get_gateway_prefix(anj_coap_options_t *options,
+                               _anj_coap_msg_t *inout_data) {
+    inout_data->gateway_prefix = NULL;
+    inout_data->gateway_prefix_len = 0;
+
+    for (size_t i = 0; i < options->options_number; i++) {
+        const anj_coap_option_t *opt = &options->options[i];
+        if (opt->option_number != _ANJ_COAP_OPTION_URI_PATH) {
+            continue;
+        }
+        // first segment that is not a number nor `bs` is the Prefix of
+        // an End IoT Device
+        const char *segment = (const char *) opt->payload;
+        if (opt->payload_len && (segment[0] < '0' || segment[0] > '9')
+                && !(opt->payload_len == 2 && segment[0] == 'b'
+                     && segment[1] == 's')) {
+            inout_data->gateway_prefix = segment;
+            inout_data->gateway_prefix_len = opt->payload_len;
+        }
+        return;
+    }
+}
+#endif // ANJ_WITH_LWM2M_GATEWAY
+
 static int get_uri_path(anj_coap_options_t *options,
+                        size_t first_segment,
                         anj_uri_path_t *uri,
                         bool *is_bs_uri) {
-    size_t it = 0;
+    size_t it = first_segment;
     size_t out_option_size;
     char buff[_URI_PATH_MAX_LEN_STR];
     int res;
@@ -57,8 +84,8 @@ static int get_uri_path(anj_coap_options_t *options,
             return _ANJ_ERR_MALFORMED_MESSAGE; // uri path too long
         }
         // if `bs` in first record -> BootstrapFinish operation
-        if (!uri->uri_len && out_option_size == 2 && buff[0] == 'b'
-                && buff[1] == 's') {
+        if (!first_segment && !uri->uri_len && out_option_size == 2
+                && buff[0] == 'b' && buff[1] == 's') {
             *is_bs_uri = true;
             return 0;
         }
@@ -83,7 +110,7 @@ static int get_uri_path(anj_coap_options_t *options,
     return 0;
 }
 
-#ifdef ANJ_WITH_COAP_DOWNLOADER
+#if defined(ANJ_WITH_COAP_DOWNLOADER) || defined(ANJ_WITH_ETAG)
 static int etag_decode(anj_coap_options_t *opts, _anj_etag_t *etag) {
     size_t etag_size = 0;
     int res = _anj_coap_options_get_data_iterate(opts, _ANJ_COAP_OPTION_ETAG,
@@ -95,6 +122,9 @@ static int etag_decode(anj_coap_options_t *opts, _anj_etag_t *etag) {
     etag->size = (uint8_t) etag_size;
     return res;
 }
+#endif // defined(ANJ_WITH_COAP_DOWNLOADER) || defined(ANJ_WITH_ETAG)
+
+#ifdef ANJ_WITH_COAP_DOWNLOADER
 
 static int
 get_downloader_response_options(anj_coap_options_t *options,
@@ -337,8 +367,17 @@ static int handle_lwm2m_request(_anj_coap_msg_t *inout_data,
                                       &inout_data->accept);
 
     // get uri path if present
+    size_t first_segment = 0;
+#ifdef ANJ_WITH_LWM2M_GATEWAY
+    get_gateway_prefix(out_coap_msg->options, inout_data);
+    if (inout_data->gateway_prefix) {
+        // the Prefix is not a part of the data model path
+        first_segment = 1;
+    }
+#endif // ANJ_WITH_LWM2M_GATEWAY
     bool is_bs_uri;
-    int res = get_uri_path(out_coap_msg->options, &inout_data->uri, &is_bs_uri);
+    int res = get_uri_path(out_coap_msg->options, first_segment,
+                           &inout_data->uri, &is_bs_uri);
     // _ANJ_COAP_OPTION_MISSING is not an error
     if (res < 0) {
         return res;
@@ -355,6 +394,13 @@ static int handle_lwm2m_request(_anj_coap_msg_t *inout_data,
         return res;
     }
 
+#ifdef ANJ_WITH_ETAG
+    // ETag longer than the ones of the client never matches, so is ignored
+    if (etag_decode(out_coap_msg->options, &inout_data->etag)) {
+        inout_data->etag.size = 0;
+    }
+#endif // ANJ_WITH_ETAG
+
     return decode_attributes(inout_data, out_coap_msg);
 }
 
@@ -431,7 +477,15 @@ static int recognize_operation_and_options_udp(anj_coap_message_t *out_coap_msg,
     _RET_IF_ERROR(res);
 
     // Block option can be present in lwm2m request and the response
-    return _anj_block_decode(out_coap_msg->options, &inout_data->block);
+    res = _anj_block_decode(out_coap_msg->options, &inout_data->block);
+#ifdef ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+    if (!res && inout_data->operation == ANJ_OP_RESPONSE
+            && inout_data->block.block_type == ANJ_OPTION_BLOCK_NOT_DEFINED) {
+        res = _anj_block_decode_q_block2(out_coap_msg->options,
+                                         &inout_data->block);
+    }
+#endif // ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+    return res;
 }
 
 static void copy_struct_fields_udp(anj_coap_message_t *out_coap_msg,
@@ -527,10 +581,17 @@ static int decode_header_udp(anj_coap_message_t *out_coap_msg,
     return 0;
 }
 
-static int _anj_coap_udp_frame_decode(void *datagram,
+static int _anj_coap_udp_frame_decode(anj_coap_option_t *options,
+                                      void *datagram,
                                       size_t datagram_size,
                                       _anj_coap_msg_t *out_data) {
-    _ANJ_COAP_OPTIONS_INIT_EMPTY(opts, ANJ_COAP_MAX_OPTIONS_NUMBER);
+    anj_coap_options_t opts = {
+        .options_size = ANJ_COAP_MAX_OPTIONS_NUMBER,
+        .options_number = 0,
+        .options = options,
+        .buff_size = 0,
+        .buff_begin = NULL
+    };
     anj_coap_message_t out_coap_msg = {
         .options = &opts
     };
@@ -558,13 +619,113 @@ static int _anj_coap_udp_frame_decode(void *datagram,
     return recognize_operation_and_options_udp(&out_coap_msg, out_data);
 }
 
+static int decode_udp(anj_coap_option_t *options,
+                      uint8_t *datagram,
+                      size_t datagram_size,
+                      _anj_coap_msg_t *out_data) {
+    assert(datagram);
+    assert(out_data);
+
+    if (datagram_size == 0) {
+        return _ANJ_ERR_MALFORMED_MESSAGE;
+    }
+
+    memset(out_data, 0, sizeof(_anj_coap_msg_t));
+    out_data->accept = _ANJ_COAP_FORMAT_NOT_DEFINED;
+    out_data->content_format = _ANJ_COAP_FORMAT_NOT_DEFINED;
+
+    return _anj_coap_udp_frame_decode(options, datagram, datagram_size,
+                                      out_data);
+}
+
 int _anj_coap_decode_udp(uint8_t *datagram,
                          size_t datagram_size,
                          _anj_coap_msg_t *out_data) {
-    assert(datagram);
+    anj_coap_option_t options[ANJ_COAP_MAX_OPTIONS_NUMBER];
+    return decode_udp(options, datagram, datagram_size, out_data);
+}
+
+#ifdef ANJ_WITH_SCRATCH_ARENA
+int _anj_coap_decode_udp_with_scratch(anj_coap_option_t *options,
+                                      uint8_t *datagram,
+                                      size_t datagram_size,
+                                      _anj_coap_msg_t *out_data) {
+    assert(options);
+    return decode_udp(options, datagram, datagram_size, out_data);
+}
+#endif // ANJ_WITH_SCRATCH_ARENA
+
+#ifdef _ANJ_COAP_WITH_TCP
+size_t _anj_coap_tcp_frame_size(const uint8_t *buff, size_t buff_len) {
+    assert(buff || !buff_len);
+    if (buff_len == 0) {
+        return 0;
+    }
+    uint8_t len = _anj_coap_tcp_header_get_len(buff[0]);
+    size_t ext_len_size = _anj_coap_tcp_header_ext_len_size(len);
+    // Len/TKL byte, extended length and code
+    if (buff_len < 2 + ext_len_size) {
+        return 0;
+    }
+    size_t body_len = 0;
+    for (size_t i = 0; i < ext_len_size; i++) {
+        body_len = (body_len << 8) | buff[1 + i];
+    }
+    switch (len) {
+    case _ANJ_COAP_TCP_LEN_8BIT:
+        body_len += _ANJ_COAP_TCP_LEN_8BIT_OFFSET;
+        break;
+    case _ANJ_COAP_TCP_LEN_16BIT:
+        body_len += _ANJ_COAP_TCP_LEN_16BIT_OFFSET;
+        break;
+    case _ANJ_COAP_TCP_LEN_32BIT:
+        body_len += _ANJ_COAP_TCP_LEN_32BIT_OFFSET;
+        break;
+    default:
+        body_len = len;
+        break;
+    }
+    return 2 + ext_len_size + _anj_coap_tcp_header_get_token_length(buff[0])
+           + body_len;
+}
+
+static int decode_header_tcp(anj_coap_message_t *out_coap_msg,
+                             anj_bytes_dispenser_t *dispenser) {
+    uint8_t len_token_length;
+    if (_anj_bytes_extract(dispenser, &len_token_length,
+                           sizeof(len_token_length))) {
+        return _ANJ_ERR_MALFORMED_MESSAGE;
+    }
+    out_coap_msg->header.token_length =
+            _anj_coap_tcp_header_get_token_length(len_token_length);
+    if (out_coap_msg->header.token_length > _ANJ_COAP_MAX_TOKEN_LENGTH) {
+        return _ANJ_ERR_MALFORMED_MESSAGE;
+    }
+    // frame size is already known, the length only has to be skipped
+    size_t ext_len_size = _anj_coap_tcp_header_ext_len_size(
+            _anj_coap_tcp_header_get_len(len_token_length));
+    if (dispenser->bytes_left < ext_len_size) {
+        return _ANJ_ERR_MALFORMED_MESSAGE;
+    }
+    dispenser->read_ptr += ext_len_size;
+    dispenser->bytes_left -= ext_len_size;
+
+    if (_anj_bytes_extract(dispenser, &out_coap_msg->header.code,
+                           sizeof(out_coap_msg->header.code))) {
+        return _ANJ_ERR_MALFORMED_MESSAGE;
+    }
+    return 0;
+}
+
+static int decode_tcp(anj_coap_option_t *options,
+                      uint8_t *frame,
+                      size_t frame_size,
+                      _anj_coap_msg_t *out_data) {
+    assert(frame);
     assert(out_data);
 
-    if (datagram_size == 0) {
+    if (frame_size == 0
+            || _anj_coap_tcp_frame_size(frame, frame_size) != frame_size) {
         return _ANJ_ERR_MALFORMED_MESSAGE;
     }
 
@@ -572,5 +733,54 @@ int _anj_coap_decode_udp(uint8_t *datagram,
     out_data->accept = _ANJ_COAP_FORMAT_NOT_DEFINED;
     out_data->content_format = _ANJ_COAP_FORMAT_NOT_DEFINED;
 
-    return _anj_coap_udp_frame_decode(datagram, datagram_size, out_data);
+    anj_coap_options_t opts = {
+        .options_size = ANJ_COAP_MAX_OPTIONS_NUMBER,
+        .options_number = 0,
+        .options = options,
+        .buff_size = 0,
+        .buff_begin = NULL
+    };
+    anj_coap_message_t out_coap_msg = {
+        .options = &opts
+    };
+
+    anj_bytes_dispenser_t dispenser =
+            _anj_make_bytes_dispenser(frame, frame_size);
+
+    int res;
+    res = decode_header_tcp(&out_coap_msg, &dispenser);
+    _RET_IF_ERROR(res)
+
+    if (out_coap_msg.header.token_length > 0) {
+        res = decode_token(&out_coap_msg, &dispenser);
+        _RET_IF_ERROR(res)
+    }
+
+    res = decode_options(&out_coap_msg, &dispenser);
+    _RET_IF_ERROR(res)
+
+    res = decode_payload(&out_coap_msg, &dispenser);
+    _RET_IF_ERROR(res)
+
+    copy_struct_fields_udp(&out_coap_msg, out_data);
+
+    if (_anj_code_get_class(out_data->msg_code) == 7) {
+        out_data->operation = ANJ_OP_COAP_TCP_SIGNALING;
+        return 0;
+    }
+    // there are no message types in CoAP over TCP, every request is handled
+    // like a Confirmable one, responses are always piggybacked
+    out_data->coap_binding_data.type =
+            _anj_coap_code_is_request(out_data->msg_code)
+                    ? ANJ_COAP_UDP_TYPE_CONFIRMABLE
+                    : ANJ_COAP_UDP_TYPE_ACKNOWLEDGEMENT;
+    return recognize_operation_and_options_udp(&out_coap_msg, out_data);
+}
+
+int _anj_coap_decode_tcp(uint8_t *frame,
+                         size_t frame_size,
+                         _anj_coap_msg_t *out_data) {
+    anj_coap_option_t options[ANJ_COAP_MAX_OPTIONS_NUMBER];
+    return decode_tcp(options, frame, frame_size, out_data);
 }
+#endif // _ANJ_COAP_WITH_TCP
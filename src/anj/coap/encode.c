@@ -27,6 +27,7 @@
 #include "common.h"
 
 #include "options.h"
+#include "tcp_header.h"
 #include "udp_header.h"
 
 static int add_uri_path(anj_coap_options_t *opts, const _anj_coap_msg_t *msg) {
@@ -88,42 +89,148 @@ static int anj_attr_downloader_prepare(anj_coap_options_t *opts,
 }
 #endif // ANJ_WITH_COAP_DOWNLOADER
 
-static int coap_standard_msg_options_add(anj_coap_options_t *opts,
-                                         const _anj_coap_msg_t *msg) {
-    int res;
+#ifdef ANJ_WITH_ETAG
+static int add_etag(anj_coap_options_t *opts, const _anj_coap_msg_t *msg) {
+    if (!msg->etag.size) {
+        return 0;
+    }
+    return _anj_coap_options_add_data(opts, _ANJ_COAP_OPTION_ETAG,
+                                      msg->etag.bytes, msg->etag.size);
+}
+#endif // ANJ_WITH_ETAG
 
-    // content-format
-    if (msg->payload_size) {
-        if (msg->content_format != _ANJ_COAP_FORMAT_NOT_DEFINED) {
-            res = _anj_coap_options_add_u16(
-                    opts, _ANJ_COAP_OPTION_CONTENT_FORMAT, msg->content_format);
-            _RET_IF_ERROR(res);
-        } else {
-            return _ANJ_ERR_INPUT_ARG;
+static int add_observe(anj_coap_options_t *opts, const _anj_coap_msg_t *msg) {
+    // observe option: only for Notify
+    if ((msg->operation == ANJ_OP_INF_CON_NOTIFY
+         || msg->operation == ANJ_OP_INF_INITIAL_NOTIFY
+         || msg->operation == ANJ_OP_INF_NON_CON_NOTIFY)
+            && (msg->msg_code == ANJ_COAP_CODE_CONTENT
+#ifdef ANJ_WITH_ETAG
+                || msg->msg_code == ANJ_COAP_CODE_VALID
+#endif // ANJ_WITH_ETAG
+                )) {
+        return _anj_coap_options_add_u32(opts, _ANJ_COAP_OPTION_OBSERVE,
+                                         msg->observe_number);
+    }
+    return 0;
+}
+
+#ifdef ANJ_COAP_WITH_MSG_TEMPLATES
+static _anj_coap_msg_template_t *
+template_for_msg(_anj_coap_msg_templates_t *templates,
+                 const _anj_coap_msg_t *msg) {
+    switch (msg->operation) {
+    case ANJ_OP_UPDATE:
+        return &templates->update;
+    case ANJ_OP_INF_CON_NOTIFY:
+    case ANJ_OP_INF_NON_CON_NOTIFY:
+    case ANJ_OP_INF_INITIAL_NOTIFY:
+        return &templates->notify;
+    case ANJ_OP_INF_CON_SEND:
+    case ANJ_OP_INF_NON_CON_SEND:
+        return &templates->send;
+    default:
+        return NULL;
+    }
+}
+
+static bool template_matches(const _anj_coap_msg_template_t *tmpl,
+                             const _anj_coap_msg_t *msg,
+                             uint16_t content_format) {
+    if (!tmpl->valid || tmpl->content_format != content_format) {
+        return false;
+    }
+    if (msg->operation != ANJ_OP_UPDATE) {
+        return true;
+    }
+    if (tmpl->location_count != msg->location_path.location_count) {
+        return false;
+    }
+    for (size_t i = 0; i < tmpl->location_count; i++) {
+        if (tmpl->location_len[i] != msg->location_path.location_len[i]
+                || memcmp(&tmpl->buff[tmpl->location_offset[i]],
+                          msg->location_path.location[i],
+                          tmpl->location_len[i])) {
+            return false;
         }
     }
+    return true;
+}
 
-    // accept option: only for BootstrapPack-Request
-    if (msg->accept != _ANJ_COAP_FORMAT_NOT_DEFINED
-            && msg->operation == ANJ_OP_BOOTSTRAP_PACK_REQ) {
-        res = _anj_coap_options_add_u16(opts, _ANJ_COAP_OPTION_ACCEPT,
-                                        msg->accept);
+static int template_build(_anj_coap_msg_template_t *tmpl,
+                          const _anj_coap_msg_t *msg,
+                          uint16_t content_format) {
+    tmpl->valid = false;
+    // one Uri-Path for each Location-Path, and Content-Format
+    _ANJ_COAP_OPTIONS_INIT_EMPTY(opts, ANJ_COAP_MAX_LOCATION_PATHS_NUMBER + 1);
+    opts.buff_begin = tmpl->buff;
+    opts.buff_size = sizeof(tmpl->buff);
+
+    int res = 0;
+    if (content_format != _ANJ_COAP_FORMAT_NOT_DEFINED) {
+        res = _anj_coap_options_add_u16(&opts, _ANJ_COAP_OPTION_CONTENT_FORMAT,
+                                        content_format);
         _RET_IF_ERROR(res);
     }
-
-    // uri-path
-    res = add_uri_path(opts, msg);
+    res = add_uri_path(&opts, msg);
     _RET_IF_ERROR(res);
 
-    // observe option: only for Notify
-    if ((msg->operation == ANJ_OP_INF_CON_NOTIFY
-         || msg->operation == ANJ_OP_INF_INITIAL_NOTIFY
-         || msg->operation == ANJ_OP_INF_NON_CON_NOTIFY)
-            && msg->msg_code == ANJ_COAP_CODE_CONTENT) {
-        res = _anj_coap_options_add_u32(opts, _ANJ_COAP_OPTION_OBSERVE,
-                                        msg->observe_number);
-        _RET_IF_ERROR(res);
+    tmpl->location_count = 0;
+    for (size_t i = 0; i < opts.options_number; i++) {
+        if (msg->operation == ANJ_OP_UPDATE
+                && opts.options[i].option_number == _ANJ_COAP_OPTION_URI_PATH) {
+            tmpl->location_offset[tmpl->location_count] =
+                    (uint16_t) (opts.options[i].payload - tmpl->buff);
+            tmpl->location_len[tmpl->location_count] =
+                    (uint16_t) opts.options[i].payload_len;
+            tmpl->location_count++;
+        }
+    }
+    tmpl->size = 0;
+    if (opts.options_number) {
+        anj_coap_option_t last_option = opts.options[opts.options_number - 1];
+        tmpl->size = (uint16_t) ((last_option.payload + last_option.payload_len)
+                                 - tmpl->buff);
+    }
+    tmpl->content_format = content_format;
+    tmpl->valid = true;
+    return 0;
+}
+
+/**
+ * Returns the template of Uri-Path and Content-Format options of @p msg,
+ * preparing it first if the last message of the same kind was different.
+ * Returns NULL if @p msg must be encoded without a template.
+ */
+static const _anj_coap_msg_template_t *
+get_template(_anj_coap_msg_templates_t *templates,
+             const _anj_coap_msg_t *msg) {
+    if (!templates) {
+        return NULL;
+    }
+    _anj_coap_msg_template_t *tmpl = template_for_msg(templates, msg);
+    if (!tmpl) {
+        return NULL;
+    }
+    uint16_t content_format = _ANJ_COAP_FORMAT_NOT_DEFINED;
+    if (msg->payload_size) {
+        if (msg->content_format == _ANJ_COAP_FORMAT_NOT_DEFINED) {
+            // error is reported by coap_standard_msg_options_add()
+            return NULL;
+        }
+        content_format = msg->content_format;
+    }
+    if (!template_matches(tmpl, msg, content_format)
+            && template_build(tmpl, msg, content_format)) {
+        return NULL;
     }
+    return tmpl;
+}
+#endif // ANJ_COAP_WITH_MSG_TEMPLATES
+
+static int add_block_and_attributes(anj_coap_options_t *opts,
+                                    const _anj_coap_msg_t *msg) {
+    int res = 0;
 
     // block option
     if (msg->block.block_type == ANJ_OPTION_BLOCK_1
@@ -149,6 +256,18 @@ static int coap_standard_msg_options_add(anj_coap_options_t *opts,
         _RET_IF_ERROR(res);
     }
 #endif // ANJ_WITH_COMPOSITE_OPERATIONS
+#ifdef ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+    else if (msg->block.block_type == ANJ_OPTION_Q_BLOCK_2) {
+        // single request for a range of blocks, RFC 9177
+        _anj_block_t block = msg->block;
+        block.more_flag = false;
+        for (uint8_t i = 0; i < ANJ_MAX(msg->block.count, 1); i++) {
+            res = _anj_block_prepare(opts, &block);
+            _RET_IF_ERROR(res);
+            block.number++;
+        }
+    }
+#endif // ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
 
     // attributes: uri-query
     if (msg->operation == ANJ_OP_REGISTER || msg->operation == ANJ_OP_UPDATE) {
@@ -167,13 +286,83 @@ static int coap_standard_msg_options_add(anj_coap_options_t *opts,
         res = anj_attr_downloader_prepare(opts, &msg->attr.downloader_attr);
     }
 #endif // ANJ_WITH_COAP_DOWNLOADER
+#ifdef ANJ_LWM2M_SEND_WITH_NO_RESPONSE
+    _RET_IF_ERROR(res);
+
+    // no-response: has the highest number, so it's always added last
+    if (msg->no_response
+            && (msg->operation == ANJ_OP_INF_CON_SEND
+                || msg->operation == ANJ_OP_INF_NON_CON_SEND)) {
+        res = _anj_coap_options_add_u16(opts, _ANJ_COAP_OPTION_NO_RESPONSE,
+                                        _ANJ_COAP_NO_RESPONSE_SUPPRESS_2XX);
+    }
+#endif // ANJ_LWM2M_SEND_WITH_NO_RESPONSE
 
     return res;
 }
 
+static int coap_standard_msg_options_add(anj_coap_options_t *opts,
+                                         const _anj_coap_msg_t *msg) {
+    int res;
+
+#ifdef ANJ_WITH_ETAG
+    res = add_etag(opts, msg);
+    _RET_IF_ERROR(res);
+#endif // ANJ_WITH_ETAG
+
+    // content-format
+    if (msg->payload_size) {
+        if (msg->content_format != _ANJ_COAP_FORMAT_NOT_DEFINED) {
+            res = _anj_coap_options_add_u16(
+                    opts, _ANJ_COAP_OPTION_CONTENT_FORMAT, msg->content_format);
+            _RET_IF_ERROR(res);
+        } else {
+            return _ANJ_ERR_INPUT_ARG;
+        }
+    }
+
+    // accept option: only for BootstrapPack-Request
+    if (msg->accept != _ANJ_COAP_FORMAT_NOT_DEFINED
+            && msg->operation == ANJ_OP_BOOTSTRAP_PACK_REQ) {
+        res = _anj_coap_options_add_u16(opts, _ANJ_COAP_OPTION_ACCEPT,
+                                        msg->accept);
+        _RET_IF_ERROR(res);
+    }
+
+    // uri-path
+    res = add_uri_path(opts, msg);
+    _RET_IF_ERROR(res);
+
+    res = add_observe(opts, msg);
+    _RET_IF_ERROR(res);
+
+    return add_block_and_attributes(opts, msg);
+}
+
+#ifdef ANJ_COAP_WITH_MSG_TEMPLATES
+static int coap_template_msg_options_add(anj_coap_options_t *opts,
+                                         const _anj_coap_msg_t *msg,
+                                         const _anj_coap_msg_template_t *tmpl) {
+    // options are added in order, so that none of them has to be moved
+    int res;
+#    ifdef ANJ_WITH_ETAG
+    res = add_etag(opts, msg);
+    _RET_IF_ERROR(res);
+#    endif // ANJ_WITH_ETAG
+    res = add_observe(opts, msg);
+    _RET_IF_ERROR(res);
+
+    res = _anj_coap_options_add_serialized(opts, tmpl->buff, tmpl->size);
+    _RET_IF_ERROR(res);
+
+    return add_block_and_attributes(opts, msg);
+}
+#endif // ANJ_COAP_WITH_MSG_TEMPLATES
+
 static int _anj_coap_payload_serialize(anj_coap_message_t *msg,
                                        uint8_t *buf,
                                        size_t buf_size,
+                                       bool with_payload,
                                        size_t *out_bytes_written) {
     assert(msg);
     assert(buf);
@@ -195,8 +384,9 @@ static int _anj_coap_payload_serialize(anj_coap_message_t *msg,
     if (msg->payload && msg->payload_size > 0) {
         if (_anj_bytes_append(&appender, &_ANJ_COAP_PAYLOAD_MARKER,
                               sizeof(_ANJ_COAP_PAYLOAD_MARKER))
-                || _anj_bytes_append(&appender, msg->payload,
-                                     msg->payload_size)) {
+                || (with_payload
+                    && _anj_bytes_append(&appender, msg->payload,
+                                         msg->payload_size))) {
             return _ANJ_ERR_BUFF;
         }
     }
@@ -225,6 +415,12 @@ static int recognize_msg_code(_anj_coap_msg_t *msg) {
         break;
     case ANJ_OP_INF_CON_NOTIFY:
     case ANJ_OP_INF_NON_CON_NOTIFY:
+#ifdef ANJ_WITH_ETAG
+        // notification of an unchanged value
+        if (msg->msg_code == ANJ_COAP_CODE_VALID) {
+            break;
+        }
+#endif // ANJ_WITH_ETAG
         msg->msg_code = ANJ_COAP_CODE_CONTENT;
         break;
     case ANJ_OP_INF_CON_SEND:
@@ -243,6 +439,14 @@ static int recognize_msg_code(_anj_coap_msg_t *msg) {
     case ANJ_OP_COAP_DOWNLOADER_GET:
         msg->msg_code = ANJ_COAP_CODE_GET;
         break;
+#ifdef _ANJ_COAP_WITH_TCP
+    case ANJ_OP_COAP_TCP_SIGNALING:
+        // msg code must be defined
+        if (_anj_code_get_class(msg->msg_code) != 7) {
+            return _ANJ_ERR_COAP_BAD_MSG;
+        }
+        break;
+#endif // _ANJ_COAP_WITH_TCP
     default:
         return _ANJ_ERR_COAP_BAD_MSG;
     }
@@ -295,10 +499,13 @@ static int _anj_coap_udp_header_serialize(anj_coap_message_t *msg,
     return 0;
 }
 
-int _anj_coap_encode_udp(_anj_coap_msg_t *msg,
-                         uint8_t *out_buff,
-                         size_t out_buff_size,
-                         size_t *out_msg_size) {
+static int encode_udp(anj_coap_option_t *options,
+                      _anj_coap_msg_t *msg,
+                      _anj_coap_msg_templates_t *templates,
+                      uint8_t *out_buff,
+                      size_t out_buff_size,
+                      bool with_payload,
+                      size_t *out_msg_size) {
     assert(msg);
     assert(out_buff);
     assert(out_msg_size);
@@ -314,6 +521,11 @@ int _anj_coap_encode_udp(_anj_coap_msg_t *msg,
                || msg->operation == ANJ_OP_INF_INITIAL_NOTIFY) {
         assert(msg->token.size != 0);
         msg->coap_binding_data.type = ANJ_COAP_UDP_TYPE_ACKNOWLEDGEMENT;
+#ifdef ANJ_WITH_SEPARATE_RESPONSE
+        if (msg->separate_response) {
+            msg->coap_binding_data.type = ANJ_COAP_UDP_TYPE_CONFIRMABLE;
+        }
+#endif // ANJ_WITH_SEPARATE_RESPONSE
     } else if (msg->operation == ANJ_OP_COAP_RESET) {
         msg->coap_binding_data.type = ANJ_COAP_UDP_TYPE_RESET;
         msg->payload_size = 0;
@@ -338,7 +550,13 @@ int _anj_coap_encode_udp(_anj_coap_msg_t *msg,
     res = recognize_msg_code(msg);
     _RET_IF_ERROR(res);
 
-    _ANJ_COAP_OPTIONS_INIT_EMPTY(opts, ANJ_COAP_MAX_OPTIONS_NUMBER);
+    anj_coap_options_t opts = {
+        .options_size = ANJ_COAP_MAX_OPTIONS_NUMBER,
+        .options_number = 0,
+        .options = options,
+        .buff_size = 0,
+        .buff_begin = NULL
+    };
     anj_coap_message_t coap_msg = {
         .header = _anj_coap_udp_header_init(msg->coap_binding_data.type,
                                             msg->token.size,
@@ -356,12 +574,126 @@ int _anj_coap_encode_udp(_anj_coap_msg_t *msg,
     res = _anj_coap_udp_header_serialize(&coap_msg, out_buff, out_buff_size);
     _RET_IF_ERROR(res);
 
+#ifdef ANJ_COAP_WITH_MSG_TEMPLATES
+    const _anj_coap_msg_template_t *tmpl = get_template(templates, msg);
+    res = tmpl ? coap_template_msg_options_add(&opts, msg, tmpl)
+               : coap_standard_msg_options_add(&opts, msg);
+#else  // ANJ_COAP_WITH_MSG_TEMPLATES
+    (void) templates;
     res = coap_standard_msg_options_add(&opts, msg);
+#endif // ANJ_COAP_WITH_MSG_TEMPLATES
     _RET_IF_ERROR(res);
 
     return _anj_coap_payload_serialize(&coap_msg, out_buff, out_buff_size,
-                                       out_msg_size);
+                                       with_payload, out_msg_size);
+}
+
+int _anj_coap_encode_udp(_anj_coap_msg_t *msg,
+                         uint8_t *out_buff,
+                         size_t out_buff_size,
+                         size_t *out_msg_size) {
+    anj_coap_option_t options[ANJ_COAP_MAX_OPTIONS_NUMBER];
+    return encode_udp(options, msg, NULL, out_buff, out_buff_size, true,
+                      out_msg_size);
+}
+
+#ifdef ANJ_NET_WITH_SEND_VEC
+int _anj_coap_encode_udp_header(_anj_coap_msg_t *msg,
+                                uint8_t *out_buff,
+                                size_t out_buff_size,
+                                size_t *out_header_size) {
+    anj_coap_option_t options[ANJ_COAP_MAX_OPTIONS_NUMBER];
+    return encode_udp(options, msg, NULL, out_buff, out_buff_size, false,
+                      out_header_size);
+}
+#endif // ANJ_NET_WITH_SEND_VEC
+
+#ifdef ANJ_COAP_WITH_MSG_TEMPLATES
+int _anj_coap_encode_udp_with_templates(_anj_coap_msg_templates_t *templates,
+                                        _anj_coap_msg_t *msg,
+                                        uint8_t *out_buff,
+                                        size_t out_buff_size,
+                                        size_t *out_msg_size) {
+    assert(templates);
+    anj_coap_option_t options[ANJ_COAP_MAX_OPTIONS_NUMBER];
+    return encode_udp(options, msg, templates, out_buff, out_buff_size, true,
+                      out_msg_size);
+}
+
+#    ifdef ANJ_NET_WITH_SEND_VEC
+int _anj_coap_encode_udp_header_with_templates(
+        _anj_coap_msg_templates_t *templates,
+        _anj_coap_msg_t *msg,
+        uint8_t *out_buff,
+        size_t out_buff_size,
+        size_t *out_header_size) {
+    assert(templates);
+    anj_coap_option_t options[ANJ_COAP_MAX_OPTIONS_NUMBER];
+    return encode_udp(options, msg, templates, out_buff, out_buff_size, false,
+                      out_header_size);
+}
+#    endif // ANJ_NET_WITH_SEND_VEC
+#endif     // ANJ_COAP_WITH_MSG_TEMPLATES
+
+#ifdef ANJ_WITH_SCRATCH_ARENA
+int _anj_coap_encode_udp_with_scratch(anj_coap_option_t *options,
+                                      _anj_coap_msg_templates_t *templates,
+                                      _anj_coap_msg_t *msg,
+                                      uint8_t *out_buff,
+                                      size_t out_buff_size,
+                                      bool with_payload,
+                                      size_t *out_msg_size) {
+    assert(options);
+#    ifndef ANJ_COAP_WITH_MSG_TEMPLATES
+    assert(!templates);
+#    endif // ANJ_COAP_WITH_MSG_TEMPLATES
+#    ifndef ANJ_NET_WITH_SEND_VEC
+    assert(with_payload);
+#    endif // ANJ_NET_WITH_SEND_VEC
+    return encode_udp(options, msg, templates, out_buff, out_buff_size,
+                      with_payload, out_msg_size);
+}
+#endif // ANJ_WITH_SCRATCH_ARENA
+
+#ifdef _ANJ_COAP_WITH_TCP
+int _anj_coap_encode_tcp(_anj_coap_msg_t *msg,
+                         uint8_t *out_buff,
+                         size_t out_buff_size,
+                         size_t *out_msg_size) {
+    assert(msg);
+    assert(out_buff);
+    assert(out_msg_size);
+
+    // The message is encoded as CoAP over UDP one, with its 4-byte header
+    // placed right before the end of the longest possible CoAP over TCP
+    // header. Then the UDP header is replaced with the TCP one and the whole
+    // message is moved to the beginning of the buffer.
+    const size_t offset = _ANJ_COAP_TCP_HEADER_MAX_LENGTH
+                          - _ANJ_COAP_UDP_HEADER_LENGTH;
+    if (out_buff_size <= _ANJ_COAP_TCP_HEADER_MAX_LENGTH) {
+        return _ANJ_ERR_BUFF;
+    }
+    if (msg->operation == ANJ_OP_COAP_TCP_SIGNALING) {
+        msg->payload_size = 0;
+    }
+    anj_coap_option_t options[ANJ_COAP_MAX_OPTIONS_NUMBER];
+    size_t udp_msg_size;
+    int res = encode_udp(options, msg, NULL, out_buff + offset,
+                         out_buff_size - offset, true, &udp_msg_size);
+    _RET_IF_ERROR(res);
+
+    uint8_t *token = out_buff + _ANJ_COAP_TCP_HEADER_MAX_LENGTH;
+    size_t body_len =
+            udp_msg_size - _ANJ_COAP_UDP_HEADER_LENGTH - msg->token.size;
+    size_t header_len = _anj_coap_tcp_header_serialize(
+            token, body_len, msg->token.size, msg->msg_code);
+    uint8_t *header = token - header_len;
+    size_t msg_size = header_len + msg->token.size + body_len;
+    memmove(out_buff, header, msg_size);
+    *out_msg_size = msg_size;
+    return 0;
 }
+#endif // _ANJ_COAP_WITH_TCP
 
 #define _ANJ_COAP_PAYLOAD_MARKER_SIZE 1
 // How accept option size is calculated:
@@ -377,6 +709,7 @@ int _anj_coap_encode_udp(_anj_coap_msg_t *msg,
 #define _ANJ_COAP_RD_PATH_SIZE 3
 #define _ANJ_COAP_BS_PATH_SIZE 3
 #define _ANJ_COAP_BSPACK_PATH_SIZE 7
+#define _ANJ_COAP_NO_RESPONSE_OPTION_MAX_SIZE 3
 // URI QUERY and URI PATH size are calculated slightly differently:
 // 1 byte for option delta and length
 // 1 byte for option delta in case of URI QUERY (extended)
@@ -469,6 +802,9 @@ size_t _anj_coap_calculate_msg_header_max_size(const _anj_coap_msg_t *msg) {
         max_size += _ANJ_COAP_DP_PATH_SIZE
                     + _ANJ_COAP_CONTENT_FORMAT_OPTION_MAX_SIZE
                     + _ANJ_COAP_BLOCK_OPTION_MAX_SIZE;
+#ifdef ANJ_LWM2M_SEND_WITH_NO_RESPONSE
+        max_size += _ANJ_COAP_NO_RESPONSE_OPTION_MAX_SIZE;
+#endif // ANJ_LWM2M_SEND_WITH_NO_RESPONSE
     } else if (msg->operation == ANJ_OP_REGISTER) {
         max_size +=
                 _ANJ_COAP_RD_PATH_SIZE
@@ -39,6 +39,101 @@
 #define _ANJ_COAP_EXT_U8_BASE ((int) 13)
 #define _ANJ_COAP_EXT_U16_BASE ((int) 269)
 
+#if ANJ_COAP_MAX_OPTIONS_NUMBER > UINT8_MAX
+#    error "ANJ_COAP_MAX_OPTIONS_NUMBER must fit in the option index"
+#endif // ANJ_COAP_MAX_OPTIONS_NUMBER > UINT8_MAX
+
+#define OPTION_NOT_INDEXED (-1)
+
+static int index_slot(uint16_t option_number) {
+    switch (option_number) {
+    case _ANJ_COAP_OPTION_IF_MATCH:
+        return 0;
+    case _ANJ_COAP_OPTION_URI_HOST:
+        return 1;
+    case _ANJ_COAP_OPTION_ETAG:
+        return 2;
+    case _ANJ_COAP_OPTION_IF_NONE_MATCH:
+        return 3;
+    case _ANJ_COAP_OPTION_OBSERVE:
+        return 4;
+    case _ANJ_COAP_OPTION_URI_PORT:
+        return 5;
+    case _ANJ_COAP_OPTION_LOCATION_PATH:
+        return 6;
+    case _ANJ_COAP_OPTION_OSCORE:
+        return 7;
+    case _ANJ_COAP_OPTION_URI_PATH:
+        return 8;
+    case _ANJ_COAP_OPTION_CONTENT_FORMAT:
+        return 9;
+    case _ANJ_COAP_OPTION_MAX_AGE:
+        return 10;
+    case _ANJ_COAP_OPTION_URI_QUERY:
+        return 11;
+    case _ANJ_COAP_OPTION_ACCEPT:
+        return 12;
+    case _ANJ_COAP_OPTION_LOCATION_QUERY:
+        return 13;
+    case _ANJ_COAP_OPTION_BLOCK2:
+        return 14;
+    case _ANJ_COAP_OPTION_BLOCK1:
+        return 15;
+    case _ANJ_COAP_OPTION_PROXY_URI:
+        return 16;
+    case _ANJ_COAP_OPTION_PROXY_SCHEME:
+        return 17;
+    case _ANJ_COAP_OPTION_SIZE1:
+        return 18;
+    case _ANJ_COAP_OPTION_SIZE2:
+        return 19;
+    default:
+        return OPTION_NOT_INDEXED;
+    }
+}
+
+static void index_option(anj_coap_options_t *opts, size_t position) {
+    assert(position < UINT8_MAX);
+    int slot = index_slot(opts->options[position].option_number);
+    if (slot != OPTION_NOT_INDEXED && !opts->index_count[slot]++) {
+        opts->index_first[slot] = (uint8_t) position;
+    }
+}
+
+static void rebuild_index(anj_coap_options_t *opts) {
+    memset(opts->index_count, 0, sizeof(opts->index_count));
+    for (size_t i = 0; i < opts->options_number; i++) {
+        index_option(opts, i);
+    }
+}
+
+static const anj_coap_option_t *find_option(const anj_coap_options_t *opts,
+                                            uint16_t option_number,
+                                            size_t occurrence) {
+    // options are sorted, so all occurrences of an option are adjacent
+    int slot = index_slot(option_number);
+    if (slot != OPTION_NOT_INDEXED) {
+        if (occurrence >= opts->index_count[slot]) {
+            return NULL;
+        }
+        return &opts->options[opts->index_first[slot] + occurrence];
+    }
+    for (size_t i = 0; i < opts->options_number; i++) {
+        if (opts->options[i].option_number > option_number) {
+            break;
+        }
+        if (opts->options[i].option_number == option_number) {
+            if (i + occurrence < opts->options_number
+                    && opts->options[i + occurrence].option_number
+                                   == option_number) {
+                return &opts->options[i + occurrence];
+            }
+            break;
+        }
+    }
+    return NULL;
+}
+
 static int update_extended_option(uint16_t *value,
                                   const uint8_t **buff_pointer,
                                   const uint8_t *buff_end) {
@@ -147,6 +242,18 @@ static size_t prepare_option_header(uint8_t *opt_header,
     return header_size;
 }
 
+#if defined(ANJ_COAP_WITH_HEADER_COMPRESSION) || defined(ANJ_WITH_OSCORE)
+size_t _anj_coap_options_prepare_header(uint8_t *opt_header,
+                                        uint16_t previous_opt_number,
+                                        uint16_t opt_number,
+                                        size_t payload_size) {
+    assert(opt_number >= previous_opt_number);
+    return prepare_option_header(opt_header, previous_opt_number, opt_number,
+                                 payload_size);
+}
+#endif // defined(ANJ_COAP_WITH_HEADER_COMPRESSION) ||
+       // defined(ANJ_WITH_OSCORE)
+
 int _anj_coap_options_add_data(anj_coap_options_t *opts,
                                uint16_t opt_number,
                                const void *data,
@@ -276,6 +383,7 @@ int _anj_coap_options_add_data(anj_coap_options_t *opts,
             memory_to_move_start_point + opt_header_len;
 
     opts->options_number++;
+    rebuild_index(opts);
 
     return 0;
 }
@@ -319,6 +427,75 @@ int _anj_coap_options_add_u64(anj_coap_options_t *opts,
     return add_uint(opts, opt_number, &portable, sizeof(portable));
 }
 
+#ifdef ANJ_COAP_WITH_MSG_TEMPLATES
+int _anj_coap_options_add_serialized(anj_coap_options_t *opts,
+                                     const uint8_t *data,
+                                     size_t data_size) {
+    assert(opts->buff_begin);
+    assert(opts->options);
+    assert(data || !data_size);
+
+    if (!data_size) {
+        return 0;
+    }
+
+    const uint8_t *data_end = data + data_size;
+    const uint8_t *data_pointer = data;
+    anj_coap_option_t first_opt;
+    int res = get_option_from_buff(&data_pointer, data_end, &first_opt, 0);
+    if (res) {
+        return res;
+    }
+
+    uint16_t previous_opt_number = 0;
+    uint8_t *opts_end = opts->buff_begin;
+    if (opts->options_number) {
+        anj_coap_option_t last_opt = opts->options[opts->options_number - 1];
+        previous_opt_number = last_opt.option_number;
+        opts_end = opts->buff_begin
+                   + ((last_opt.payload + last_opt.payload_len)
+                      - opts->buff_begin);
+    }
+    if (first_opt.option_number < previous_opt_number) {
+        return _ANJ_ERR_INPUT_ARG;
+    }
+
+    // the first option delta changes, everything after its header stays
+    uint8_t opt_header[_ANJ_COAP_OPTION_HEADER_MAX_LEN];
+    size_t opt_header_len =
+            prepare_option_header(opt_header, previous_opt_number,
+                                  first_opt.option_number,
+                                  first_opt.payload_len);
+    size_t rest_size = (size_t) (data_end - first_opt.payload);
+    if (opts_end + opt_header_len + rest_size
+            >= opts->buff_begin + opts->buff_size) {
+        return _ANJ_ERR_BUFF;
+    }
+    memcpy(opts_end, opt_header, opt_header_len);
+    memcpy(opts_end + opt_header_len, first_opt.payload, rest_size);
+
+    const uint8_t *buff_pointer = opts_end;
+    const uint8_t *buff_end = opts_end + opt_header_len + rest_size;
+    while (buff_pointer < buff_end) {
+        if (opts->options_number == opts->options_size) {
+            return _ANJ_ERR_OPTIONS_ARRAY;
+        }
+        res = get_option_from_buff(&buff_pointer, buff_end,
+                                   &opts->options[opts->options_number],
+                                   previous_opt_number);
+        if (res) {
+            return res;
+        }
+        previous_opt_number =
+                opts->options[opts->options_number].option_number;
+        index_option(opts, opts->options_number);
+        opts->options_number++;
+    }
+
+    return 0;
+}
+#endif // ANJ_COAP_WITH_MSG_TEMPLATES
+
 int _anj_coap_options_get_data_iterate(const anj_coap_options_t *opts,
                                        uint16_t option_number,
                                        size_t *iterator,
@@ -326,7 +503,6 @@ int _anj_coap_options_get_data_iterate(const anj_coap_options_t *opts,
                                        void *out_buffer,
                                        size_t out_buffer_size) {
 
-    size_t opt_occurance = 0;
     size_t requested_opt = 0;
     if (iterator) {
         requested_opt = *iterator;
@@ -337,30 +513,25 @@ int _anj_coap_options_get_data_iterate(const anj_coap_options_t *opts,
         return _ANJ_ERR_INPUT_ARG;
     }
 
-    for (size_t i = 0; i < opts->options_number; i++) {
-        if (opts->options[i].option_number == option_number) {
-            if (opt_occurance == requested_opt) {
-                if (out_buffer_size < opts->options[i].payload_len) {
-                    return _ANJ_ERR_MALFORMED_MESSAGE;
-                }
-
-                if (out_buffer_size > 0) {
-                    memcpy(out_buffer, opts->options[i].payload,
-                           opts->options[i].payload_len);
-                    if (out_option_size) {
-                        *out_option_size = opts->options[i].payload_len;
-                    }
-                } else {
-                    *((bool *) out_buffer) = true;
-                }
-
-                return 0;
-            } else {
-                opt_occurance++;
-            }
+    const anj_coap_option_t *option =
+            find_option(opts, option_number, requested_opt);
+    if (!option) {
+        return _ANJ_COAP_OPTION_MISSING;
+    }
+    if (out_buffer_size < option->payload_len) {
+        return _ANJ_ERR_MALFORMED_MESSAGE;
+    }
+
+    if (out_buffer_size > 0) {
+        memcpy(out_buffer, option->payload, option->payload_len);
+        if (out_option_size) {
+            *out_option_size = option->payload_len;
         }
+    } else {
+        *((bool *) out_buffer) = true;
     }
-    return _ANJ_COAP_OPTION_MISSING;
+
+    return 0;
 }
 
 int _anj_coap_options_get_empty_iterate(const anj_coap_options_t *opts,
@@ -449,6 +620,7 @@ int _anj_coap_options_decode(anj_coap_options_t *opts,
 
     // clear counter
     opts->options_number = 0;
+    memset(opts->index_count, 0, sizeof(opts->index_count));
 
     while (buff_pointer < buff_end) {
         // end of the options field
@@ -470,6 +642,7 @@ int _anj_coap_options_decode(anj_coap_options_t *opts,
             return res;
         }
         last_opt_number = opts->options[opts->options_number].option_number;
+        index_option(opts, opts->options_number);
         opts->options_number++;
     }
 
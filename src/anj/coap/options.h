@@ -17,6 +17,8 @@
 #    include <stdint.h>
 #    include <string.h>
 
+#    include "coap.h"
+
 /**
  * CoAP option numbers, as defined in RFC7252/RFC7641/RFC7959/RFC8613.
  * @{
@@ -38,13 +40,21 @@
 #define _ANJ_COAP_OPTION_LOCATION_QUERY    20
 #define _ANJ_COAP_OPTION_BLOCK2            23
 #define _ANJ_COAP_OPTION_BLOCK1            27
+#define _ANJ_COAP_OPTION_Q_BLOCK2          31
 #define _ANJ_COAP_OPTION_PROXY_URI         35
 #define _ANJ_COAP_OPTION_PROXY_SCHEME      39
 #define _ANJ_COAP_OPTION_SIZE1             60
 #define _ANJ_COAP_OPTION_SIZE2             28
+#define _ANJ_COAP_OPTION_NO_RESPONSE       258
 
 // clang-format on
 
+/**
+ * Value of the No-Response option (RFC 7967) declaring that the client is not
+ * interested in 2.xx responses.
+ */
+#    define _ANJ_COAP_NO_RESPONSE_SUPPRESS_2XX 0x02
+
 /**
  * Constant returned from some of option-retrieving functions, indicating
  * the absence of requested option.
@@ -73,11 +83,11 @@
             .buff_begin = (void *) _OptionMsgBuffer##Name    \
         }
 
-typedef struct anj_coap_option {
-    const uint8_t *payload;
-    size_t payload_len;
-    uint16_t option_number;
-} anj_coap_option_t;
+/**
+ * Number of option numbers defined above; each of them has a slot in the
+ * option index of @ref anj_coap_options_t.
+ */
+#    define _ANJ_COAP_OPTIONS_INDEX_SIZE 20
 
 /**size_t *iterator
  * Note: this struct MUST be initialized with
@@ -91,6 +101,12 @@ typedef struct anj_coap_options {
 
     uint8_t *buff_begin;
     size_t buff_size;
+
+    /* Position of the first occurrence and the number of occurrences of every
+     * known option in @ref options, which is always sorted by option number.
+     * Updated whenever options are decoded or added. */
+    uint8_t index_first[_ANJ_COAP_OPTIONS_INDEX_SIZE];
+    uint8_t index_count[_ANJ_COAP_OPTIONS_INDEX_SIZE];
 } anj_coap_options_t;
 
 int _anj_coap_options_decode(anj_coap_options_t *opts,
@@ -157,4 +173,31 @@ int _anj_coap_options_add_u64(anj_coap_options_t *opts,
                               uint16_t opt_number,
                               uint64_t value);
 
+#    ifdef ANJ_COAP_WITH_MSG_TEMPLATES
+/**
+ * Appends options serialized earlier with the functions above, e.g. into
+ * a different buffer. Option deltas in @p data must be relative to option
+ * number 0, and the first option in @p data must not precede the last option
+ * already in @p opts - only the header of the first option is encoded again,
+ * the rest of @p data is copied as is.
+ */
+int _anj_coap_options_add_serialized(anj_coap_options_t *opts,
+                                     const uint8_t *data,
+                                     size_t data_size);
+#    endif // ANJ_COAP_WITH_MSG_TEMPLATES
+
+#    if defined(ANJ_COAP_WITH_HEADER_COMPRESSION) || defined(ANJ_WITH_OSCORE)
+/**
+ * Serializes the header of an option with @p opt_number and @p payload_size
+ * bytes of value, following an option with @p previous_opt_number, into
+ * @p opt_header, which must fit at least 5 bytes. Returns the size of the
+ * header.
+ */
+size_t _anj_coap_options_prepare_header(uint8_t *opt_header,
+                                        uint16_t previous_opt_number,
+                                        uint16_t opt_number,
+                                        size_t payload_size);
+#    endif // defined(ANJ_COAP_WITH_HEADER_COMPRESSION) ||
+           // defined(ANJ_WITH_OSCORE)
+
 #endif // SRC_ANJ_COAP_OPTIONS_H
@@ -0,0 +1,680 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/defs.h>
+
+#include "coap.h"
+#include "common.h"
+#include "options.h"
+#include "udp_header.h"
+
+#ifdef ANJ_WITH_OSCORE
+
+#    include <anj/compat/crypto/aes_ccm.h>
+#    include <anj/oscore.h>
+
+#    define OPTION_HEADER_MAX_LEN 5
+
+/* Flags byte of the OSCORE option value, RFC 8613, section 6.1 */
+#    define FLAG_PIV_LEN_MASK 0x07
+#    define FLAG_KID 0x08
+#    define FLAG_KID_CONTEXT 0x10
+#    define FLAGS_RESERVED 0xE0
+
+#    define OPTION_VALUE_MAX_LEN \
+        (1 + _ANJ_OSCORE_MAX_PIV_LEN + ANJ_OSCORE_MAX_ID_LEN)
+
+#    define MAX_SEQ_NUM ((UINT64_C(1) << (8 * _ANJ_OSCORE_MAX_PIV_LEN)) - 1)
+
+#    define REPLAY_WINDOW_SIZE 32
+
+/* COSE algorithm AES-CCM-16-64-128 */
+#    define COSE_ALG_AES_CCM_16_64_128 10
+
+/*
+ * Enc_structure = [ "Encrypt0", h'', external_aad ], where external_aad is
+ * [ 1, [ alg ], request_kid, request_piv, h'' ] wrapped in a byte string. Both
+ * are shorter than 24 bytes, so all CBOR headers take a single byte.
+ */
+#    define EXTERNAL_AAD_MAX_LEN \
+        (4 + 1 + ANJ_OSCORE_MAX_ID_LEN + 1 + _ANJ_OSCORE_MAX_PIV_LEN + 1)
+#    define AAD_MAX_LEN (1 + 1 + 8 + 1 + 1 + EXTERNAL_AAD_MAX_LEN)
+
+#    define CBOR_ARRAY(Len) ((uint8_t) (0x80 | (Len)))
+#    define CBOR_BSTR(Len) ((uint8_t) (0x40 | (Len)))
+#    define CBOR_TSTR(Len) ((uint8_t) (0x60 | (Len)))
+
+typedef struct {
+    anj_coap_option_t options[ANJ_COAP_MAX_OPTIONS_NUMBER];
+    anj_coap_options_t opts;
+    size_t header_size;
+    const uint8_t *payload;
+    size_t payload_len;
+} parsed_msg_t;
+
+static int parse_msg(const uint8_t *msg, size_t msg_size, parsed_msg_t *out) {
+    if (msg_size < _ANJ_COAP_UDP_HEADER_LENGTH) {
+        return _ANJ_ERR_MALFORMED_MESSAGE;
+    }
+    size_t token_len = _anj_coap_udp_header_get_token_length(msg[0]);
+    out->header_size = _ANJ_COAP_UDP_HEADER_LENGTH + token_len;
+    if (token_len > _ANJ_OSCORE_MAX_TOKEN_LEN || msg_size < out->header_size) {
+        return _ANJ_ERR_MALFORMED_MESSAGE;
+    }
+    out->opts = (anj_coap_options_t) {
+        .options_size = ANJ_COAP_MAX_OPTIONS_NUMBER,
+        .options = out->options
+    };
+    size_t bytes_read;
+    int res = _anj_coap_options_decode(&out->opts, msg + out->header_size,
+                                       msg_size - out->header_size,
+                                       &bytes_read);
+    _RET_IF_ERROR(res);
+    size_t payload_offset = out->header_size + bytes_read;
+    out->payload = msg + msg_size;
+    out->payload_len = 0;
+    if (payload_offset < msg_size) {
+        // options decoding stops at the payload marker
+        out->payload = msg + payload_offset + 1;
+        out->payload_len = msg_size - payload_offset - 1;
+        if (!out->payload_len) {
+            return _ANJ_ERR_MALFORMED_MESSAGE;
+        }
+    }
+    return 0;
+}
+
+static const uint8_t *get_token(const uint8_t *msg) {
+    return msg + _ANJ_COAP_UDP_HEADER_LENGTH;
+}
+
+static uint8_t get_token_len(const uint8_t *msg) {
+    return _anj_coap_udp_header_get_token_length(msg[0]);
+}
+
+static uint16_t get_msg_id(const uint8_t *msg) {
+    return (uint16_t) (((uint16_t) msg[2] << 8) | msg[3]);
+}
+
+// RFC 8613, section 4.1: Class U options, not encrypted
+static bool is_outer_only(uint16_t option_number) {
+    return option_number == _ANJ_COAP_OPTION_URI_HOST
+           || option_number == _ANJ_COAP_OPTION_URI_PORT
+           || option_number == _ANJ_COAP_OPTION_PROXY_URI
+           || option_number == _ANJ_COAP_OPTION_PROXY_SCHEME;
+}
+
+// RFC 8613, section 4.1.3.5.2: Observe of a request is both Inner and Outer,
+// the one of a notification only Outer, so that its order is not encrypted
+static bool is_inner(uint16_t option_number, bool request) {
+    if (option_number == _ANJ_COAP_OPTION_OBSERVE) {
+        return request;
+    }
+    return !is_outer_only(option_number);
+}
+
+static bool is_outer(uint16_t option_number) {
+    return is_outer_only(option_number)
+           || option_number == _ANJ_COAP_OPTION_OBSERVE;
+}
+
+static size_t write_option(uint8_t *out,
+                           uint16_t previous_number,
+                           uint16_t number,
+                           const uint8_t *value,
+                           size_t value_len) {
+    uint8_t header[OPTION_HEADER_MAX_LEN];
+    size_t header_size = _anj_coap_options_prepare_header(
+            header, previous_number, number, value_len);
+    if (out) {
+        memcpy(out, header, header_size);
+        // value may overlap with the output if the message is rebuilt in
+        // place, but it is never behind it
+        memmove(out + header_size, value, value_len);
+    }
+    return header_size + value_len;
+}
+
+// Writes outer options, with the OSCORE option in its place, or only returns
+// their size if @p out is NULL
+static size_t write_outer_options(const anj_coap_options_t *opts,
+                                  const uint8_t *oscore_value,
+                                  size_t oscore_value_len,
+                                  uint8_t *out) {
+    size_t size = 0;
+    uint16_t previous_number = 0;
+    bool oscore_written = false;
+    for (size_t i = 0; i < opts->options_number; i++) {
+        const anj_coap_option_t *opt = &opts->options[i];
+        if (!is_outer(opt->option_number)) {
+            continue;
+        }
+        if (!oscore_written && opt->option_number > _ANJ_COAP_OPTION_OSCORE) {
+            size += write_option(out ? out + size : NULL, previous_number,
+                                 _ANJ_COAP_OPTION_OSCORE, oscore_value,
+                                 oscore_value_len);
+            previous_number = _ANJ_COAP_OPTION_OSCORE;
+            oscore_written = true;
+        }
+        size += write_option(out ? out + size : NULL, previous_number,
+                             opt->option_number, opt->payload,
+                             opt->payload_len);
+        previous_number = opt->option_number;
+    }
+    if (!oscore_written) {
+        size += write_option(out ? out + size : NULL, previous_number,
+                             _ANJ_COAP_OPTION_OSCORE, oscore_value,
+                             oscore_value_len);
+    }
+    return size;
+}
+
+static size_t write_inner_options(const anj_coap_options_t *opts,
+                                  bool request,
+                                  uint8_t *out) {
+    size_t size = 0;
+    uint16_t previous_number = 0;
+    for (size_t i = 0; i < opts->options_number; i++) {
+        const anj_coap_option_t *opt = &opts->options[i];
+        if (!is_inner(opt->option_number, request)) {
+            continue;
+        }
+        size += write_option(out ? out + size : NULL, previous_number,
+                             opt->option_number, opt->payload,
+                             opt->payload_len);
+        previous_number = opt->option_number;
+    }
+    return size;
+}
+
+static const anj_coap_option_t *find_option(const anj_coap_options_t *opts,
+                                            uint16_t option_number) {
+    for (size_t i = 0; i < opts->options_number; i++) {
+        if (opts->options[i].option_number == option_number) {
+            return &opts->options[i];
+        }
+    }
+    return NULL;
+}
+
+static uint8_t encode_piv(uint64_t seq_num, uint8_t *out_piv) {
+    uint8_t len = 1;
+    while (len < _ANJ_OSCORE_MAX_PIV_LEN && (seq_num >> (8 * len))) {
+        len++;
+    }
+    for (uint8_t i = 0; i < len; i++) {
+        out_piv[i] = (uint8_t) (seq_num >> (8 * (len - 1 - i)));
+    }
+    return len;
+}
+
+static uint64_t decode_piv(const uint8_t *piv, size_t piv_len) {
+    uint64_t seq_num = 0;
+    for (size_t i = 0; i < piv_len; i++) {
+        seq_num = (seq_num << 8) | piv[i];
+    }
+    return seq_num;
+}
+
+// RFC 8613, section 5.2
+static void compute_nonce(const anj_oscore_security_context_t *security,
+                          const uint8_t *id,
+                          size_t id_len,
+                          const uint8_t *piv,
+                          size_t piv_len,
+                          uint8_t *out_nonce) {
+    memset(out_nonce, 0, ANJ_OSCORE_NONCE_LEN);
+    out_nonce[0] = (uint8_t) id_len;
+    memcpy(out_nonce + 1 + ANJ_OSCORE_MAX_ID_LEN - id_len, id, id_len);
+    memcpy(out_nonce + ANJ_OSCORE_NONCE_LEN - piv_len, piv, piv_len);
+    for (size_t i = 0; i < ANJ_OSCORE_NONCE_LEN; i++) {
+        out_nonce[i] ^= security->common_iv[i];
+    }
+}
+
+// RFC 8613, section 5.4
+static size_t compute_aad(const _anj_oscore_request_t *request,
+                          uint8_t *out_aad) {
+    static const char ENCRYPT0[] = "Encrypt0";
+    size_t len = 0;
+    out_aad[len++] = CBOR_ARRAY(3);
+    out_aad[len++] = CBOR_TSTR(sizeof(ENCRYPT0) - 1);
+    memcpy(out_aad + len, ENCRYPT0, sizeof(ENCRYPT0) - 1);
+    len += sizeof(ENCRYPT0) - 1;
+    out_aad[len++] = CBOR_BSTR(0);
+    out_aad[len++] = CBOR_BSTR(4 + 1 + request->kid_len + 1 + request->piv_len
+                               + 1);
+    out_aad[len++] = CBOR_ARRAY(5);
+    out_aad[len++] = 0x01; // oscore_version
+    out_aad[len++] = CBOR_ARRAY(1);
+    out_aad[len++] = COSE_ALG_AES_CCM_16_64_128;
+    out_aad[len++] = CBOR_BSTR(request->kid_len);
+    memcpy(out_aad + len, request->kid, request->kid_len);
+    len += request->kid_len;
+    out_aad[len++] = CBOR_BSTR(request->piv_len);
+    memcpy(out_aad + len, request->piv, request->piv_len);
+    len += request->piv_len;
+    out_aad[len++] = CBOR_BSTR(0); // Class I options
+    assert(len <= AAD_MAX_LEN);
+    return len;
+}
+
+static _anj_oscore_request_t *find_request(_anj_oscore_request_t *requests,
+                                           size_t requests_number,
+                                           const uint8_t *token,
+                                           uint8_t token_len) {
+    for (size_t i = 0; i < requests_number; i++) {
+        if (requests[i].valid && requests[i].token_len == token_len
+                && !memcmp(requests[i].token, token, token_len)) {
+            return &requests[i];
+        }
+    }
+    return NULL;
+}
+
+// Replaces the request with the same Token, or the oldest one
+static void store_request(_anj_oscore_request_t *requests,
+                          size_t requests_number,
+                          uint16_t *inout_next,
+                          const _anj_oscore_request_t *request) {
+    _anj_oscore_request_t *slot = find_request(requests, requests_number,
+                                               request->token,
+                                               request->token_len);
+    if (!slot) {
+        slot = &requests[*inout_next];
+        *inout_next = (uint16_t) ((*inout_next + 1) % requests_number);
+    }
+    *slot = *request;
+}
+
+static void fill_request(_anj_oscore_request_t *out_request,
+                         const uint8_t *msg,
+                         const uint8_t *kid,
+                         size_t kid_len,
+                         const uint8_t *piv,
+                         size_t piv_len) {
+    memset(out_request, 0, sizeof(*out_request));
+    out_request->valid = true;
+    out_request->msg_id = get_msg_id(msg);
+    out_request->token_len = get_token_len(msg);
+    memcpy(out_request->token, get_token(msg), out_request->token_len);
+    out_request->kid_len = (uint8_t) kid_len;
+    memcpy(out_request->kid, kid, kid_len);
+    out_request->piv_len = (uint8_t) piv_len;
+    memcpy(out_request->piv, piv, piv_len);
+}
+
+static bool replay_window_accepts(const _anj_oscore_ctx_t *ctx,
+                                  uint64_t seq_num) {
+    if (!ctx->replay_window_valid || seq_num > ctx->replay_window_top) {
+        return true;
+    }
+    uint64_t diff = ctx->replay_window_top - seq_num;
+    return diff < REPLAY_WINDOW_SIZE
+           && !(ctx->replay_window & (UINT32_C(1) << diff));
+}
+
+static void replay_window_update(_anj_oscore_ctx_t *ctx, uint64_t seq_num) {
+    if (!ctx->replay_window_valid) {
+        ctx->replay_window_valid = true;
+        ctx->replay_window_top = seq_num;
+        ctx->replay_window = 1;
+    } else if (seq_num > ctx->replay_window_top) {
+        uint64_t shift = seq_num - ctx->replay_window_top;
+        ctx->replay_window = shift < REPLAY_WINDOW_SIZE
+                                     ? (ctx->replay_window << shift) | 1
+                                     : 1;
+        ctx->replay_window_top = seq_num;
+    } else {
+        ctx->replay_window |= UINT32_C(1)
+                              << (ctx->replay_window_top - seq_num);
+    }
+}
+
+int _anj_oscore_protect(_anj_oscore_ctx_t *ctx,
+                        uint8_t *msg,
+                        size_t *inout_size,
+                        size_t buff_size) {
+    assert(ctx && ctx->active && msg && inout_size
+           && *inout_size <= buff_size);
+    parsed_msg_t parsed;
+    int res = parse_msg(msg, *inout_size, &parsed);
+    _RET_IF_ERROR(res);
+    uint8_t code = msg[1];
+    if (code == ANJ_COAP_CODE_EMPTY) {
+        return 0;
+    }
+    bool request = _anj_code_get_class(code) == 0;
+    const anj_oscore_security_context_t *security = &ctx->security;
+
+    bool has_observe = false;
+    size_t outer_only_count = 0;
+    for (size_t i = 0; i < parsed.opts.options_number; i++) {
+        uint16_t number = parsed.options[i].option_number;
+        if (number == _ANJ_COAP_OPTION_OSCORE) {
+            return _ANJ_ERR_MALFORMED_MESSAGE;
+        }
+        has_observe |= number == _ANJ_COAP_OPTION_OBSERVE;
+        outer_only_count += !is_inner(number, request);
+    }
+
+    // request the AAD refers to, for a request - itself
+    _anj_oscore_request_t binding;
+    _anj_oscore_request_t *existing_binding = NULL;
+    uint8_t piv[_ANJ_OSCORE_MAX_PIV_LEN];
+    uint8_t piv_len = 0;
+    bool new_piv = false;
+    if (request) {
+        existing_binding = find_request(ctx->client_requests,
+                                        _ANJ_OSCORE_REQUESTS_NUMBER,
+                                        get_token(msg), get_token_len(msg));
+        if (existing_binding && existing_binding->msg_id == get_msg_id(msg)) {
+            // retransmission
+            binding = *existing_binding;
+            piv_len = binding.piv_len;
+            memcpy(piv, binding.piv, piv_len);
+        } else {
+            new_piv = true;
+        }
+    } else {
+#    ifdef ANJ_WITH_OBSERVE
+        if (has_observe) {
+            existing_binding = find_request(ctx->observations,
+                                            ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER,
+                                            get_token(msg), get_token_len(msg));
+        }
+#    endif // ANJ_WITH_OBSERVE
+        if (!existing_binding) {
+            existing_binding = find_request(ctx->server_requests,
+                                            _ANJ_OSCORE_REQUESTS_NUMBER,
+                                            get_token(msg), get_token_len(msg));
+        }
+        if (!existing_binding) {
+            return _ANJ_ERR_OSCORE;
+        }
+        binding = *existing_binding;
+        new_piv = has_observe || binding.responded;
+    }
+    if (new_piv) {
+        if (ctx->sender_seq_num > MAX_SEQ_NUM) {
+            return _ANJ_ERR_OSCORE;
+        }
+        piv_len = encode_piv(ctx->sender_seq_num, piv);
+        if (request) {
+            fill_request(&binding, msg, security->sender_id,
+                         security->sender_id_len, piv, piv_len);
+        }
+    }
+
+    uint8_t oscore_value[OPTION_VALUE_MAX_LEN];
+    size_t oscore_value_len = 0;
+    if (piv_len || request) {
+        oscore_value[oscore_value_len++] =
+                (uint8_t) (piv_len | (request ? FLAG_KID : 0));
+        memcpy(oscore_value + oscore_value_len, piv, piv_len);
+        oscore_value_len += piv_len;
+        if (request) {
+            memcpy(oscore_value + oscore_value_len, security->sender_id,
+                   security->sender_id_len);
+            oscore_value_len += security->sender_id_len;
+        }
+    }
+
+    size_t outer_size = write_outer_options(&parsed.opts, oscore_value,
+                                            oscore_value_len, NULL);
+    size_t plaintext_size =
+            1 + write_inner_options(&parsed.opts, request, NULL)
+            + (parsed.payload_len ? 1 + parsed.payload_len : 0);
+    uint8_t *plaintext = msg + parsed.header_size + outer_size + 1;
+    size_t protected_size =
+            (size_t) (plaintext - msg) + plaintext_size + ANJ_OSCORE_TAG_LEN;
+    // the original options and payload are moved to the end of the buffer
+    // and the message is rebuilt in front of them; the inner options may
+    // grow by 2 bytes for every option taken out of them
+    size_t src_size = *inout_size - parsed.header_size;
+    if (protected_size > buff_size
+            || (size_t) (plaintext - msg) + 1 + 2 * outer_only_count + src_size
+                           > buff_size) {
+        return _ANJ_ERR_BUFF;
+    }
+
+    uint8_t *src = msg + buff_size - src_size;
+    size_t src_offset = (size_t) (src - (msg + parsed.header_size));
+    memmove(src, msg + parsed.header_size, src_size);
+    for (size_t i = 0; i < parsed.opts.options_number; i++) {
+        parsed.options[i].payload += src_offset;
+    }
+    parsed.payload += src_offset;
+
+    uint8_t *out = msg + parsed.header_size;
+    out += write_outer_options(&parsed.opts, oscore_value, oscore_value_len,
+                               out);
+    *out++ = _ANJ_COAP_PAYLOAD_MARKER;
+    assert(out == plaintext);
+    *out++ = code;
+    out += write_inner_options(&parsed.opts, request, out);
+    if (parsed.payload_len) {
+        *out++ = _ANJ_COAP_PAYLOAD_MARKER;
+        memmove(out, parsed.payload, parsed.payload_len);
+        out += parsed.payload_len;
+    }
+    assert((size_t) (out - plaintext) == plaintext_size);
+
+    uint8_t nonce[ANJ_OSCORE_NONCE_LEN];
+    if (new_piv || request) {
+        compute_nonce(security, security->sender_id, security->sender_id_len,
+                      piv, piv_len, nonce);
+    } else {
+        compute_nonce(security, binding.kid, binding.kid_len, binding.piv,
+                      binding.piv_len, nonce);
+    }
+    uint8_t aad[AAD_MAX_LEN];
+    size_t aad_len = compute_aad(&binding, aad);
+    if (anj_crypto_aes_ccm_encrypt(security->sender_key, ANJ_OSCORE_KEY_LEN,
+                                   nonce, sizeof(nonce), aad, aad_len,
+                                   plaintext, plaintext_size, out,
+                                   ANJ_OSCORE_TAG_LEN)) {
+        return _ANJ_ERR_OSCORE;
+    }
+
+    if (request) {
+        msg[1] = has_observe ? ANJ_COAP_CODE_FETCH : ANJ_COAP_CODE_POST;
+        if (new_piv) {
+            store_request(ctx->client_requests, _ANJ_OSCORE_REQUESTS_NUMBER,
+                          &ctx->next_client_request, &binding);
+        }
+    } else {
+        msg[1] = has_observe ? ANJ_COAP_CODE_CONTENT : ANJ_COAP_CODE_CHANGED;
+        existing_binding->responded = true;
+    }
+    if (new_piv) {
+        ctx->sender_seq_num++;
+    }
+    *inout_size = protected_size;
+    return 0;
+}
+
+static int parse_oscore_option(const anj_coap_option_t *opt,
+                               const uint8_t **out_piv,
+                               size_t *out_piv_len,
+                               const uint8_t **out_kid,
+                               size_t *out_kid_len,
+                               bool *out_has_kid) {
+    *out_piv_len = 0;
+    *out_kid_len = 0;
+    *out_has_kid = false;
+    if (!opt->payload_len) {
+        return 0;
+    }
+    uint8_t flags = opt->payload[0];
+    size_t piv_len = flags & FLAG_PIV_LEN_MASK;
+    // kid context is not supported, lengths of 6 and 7 are reserved
+    if ((flags & (FLAGS_RESERVED | FLAG_KID_CONTEXT))
+            || piv_len > _ANJ_OSCORE_MAX_PIV_LEN
+            || 1 + piv_len > opt->payload_len) {
+        return _ANJ_ERR_MALFORMED_MESSAGE;
+    }
+    *out_piv = opt->payload + 1;
+    *out_piv_len = piv_len;
+    size_t kid_len = opt->payload_len - 1 - piv_len;
+    if (flags & FLAG_KID) {
+        if (kid_len > ANJ_OSCORE_MAX_ID_LEN) {
+            return _ANJ_ERR_OSCORE;
+        }
+        *out_has_kid = true;
+        *out_kid = opt->payload + 1 + piv_len;
+        *out_kid_len = kid_len;
+    } else if (kid_len) {
+        return _ANJ_ERR_MALFORMED_MESSAGE;
+    }
+    return 0;
+}
+
+#    ifdef ANJ_WITH_OBSERVE
+static void update_observations(_anj_oscore_ctx_t *ctx,
+                                const anj_coap_options_t *inner_opts,
+                                const _anj_oscore_request_t *request) {
+    const anj_coap_option_t *observe =
+            find_option(inner_opts, _ANJ_COAP_OPTION_OBSERVE);
+    if (!observe) {
+        return;
+    }
+    uint32_t value = (uint32_t) decode_piv(observe->payload,
+                                           observe->payload_len);
+    if (value == 0) {
+        store_request(ctx->observations, ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER,
+                      &ctx->next_observation, request);
+    } else if (value == 1) {
+        _anj_oscore_request_t *observation =
+                find_request(ctx->observations,
+                             ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER,
+                             request->token, request->token_len);
+        if (observation) {
+            observation->valid = false;
+        }
+    }
+}
+#    endif // ANJ_WITH_OBSERVE
+
+int _anj_oscore_unprotect(_anj_oscore_ctx_t *ctx,
+                          uint8_t *msg,
+                          size_t *inout_size) {
+    assert(ctx && ctx->active && msg && inout_size);
+    parsed_msg_t parsed;
+    int res = parse_msg(msg, *inout_size, &parsed);
+    _RET_IF_ERROR(res);
+    if (msg[1] == ANJ_COAP_CODE_EMPTY) {
+        return 0;
+    }
+    bool request = _anj_code_get_class(msg[1]) == 0;
+    const anj_oscore_security_context_t *security = &ctx->security;
+
+    const anj_coap_option_t *oscore_opt =
+            find_option(&parsed.opts, _ANJ_COAP_OPTION_OSCORE);
+    if (!oscore_opt) {
+        return _ANJ_ERR_OSCORE;
+    }
+    const uint8_t *piv = NULL;
+    size_t piv_len;
+    const uint8_t *kid = NULL;
+    size_t kid_len;
+    bool has_kid;
+    res = parse_oscore_option(oscore_opt, &piv, &piv_len, &kid, &kid_len,
+                              &has_kid);
+    _RET_IF_ERROR(res);
+    if (parsed.payload_len < 1 + ANJ_OSCORE_TAG_LEN) {
+        return _ANJ_ERR_MALFORMED_MESSAGE;
+    }
+
+    _anj_oscore_request_t binding;
+    uint8_t nonce[ANJ_OSCORE_NONCE_LEN];
+    uint64_t seq_num = 0;
+    bool duplicate = false;
+    if (request) {
+        if (!has_kid || !piv_len || kid_len != security->recipient_id_len
+                || memcmp(kid, security->recipient_id, kid_len)) {
+            return _ANJ_ERR_OSCORE;
+        }
+        fill_request(&binding, msg, kid, kid_len, piv, piv_len);
+        const _anj_oscore_request_t *previous =
+                find_request(ctx->server_requests, _ANJ_OSCORE_REQUESTS_NUMBER,
+                             binding.token, binding.token_len);
+        // only a CoAP retransmission, with the same Message ID, bypasses the
+        // replay window; the outer Message ID is not protected, so a copy
+        // sent with another one would otherwise be handled again
+        duplicate = previous && previous->msg_id == binding.msg_id
+                    && previous->piv_len == piv_len
+                    && !memcmp(previous->piv, piv, piv_len);
+        seq_num = decode_piv(piv, piv_len);
+        if (!duplicate && !replay_window_accepts(ctx, seq_num)) {
+            return _ANJ_ERR_OSCORE;
+        }
+        compute_nonce(security, kid, kid_len, piv, piv_len, nonce);
+    } else {
+        const _anj_oscore_request_t *client_request =
+                find_request(ctx->client_requests, _ANJ_OSCORE_REQUESTS_NUMBER,
+                             get_token(msg), get_token_len(msg));
+        if (!client_request) {
+            return _ANJ_ERR_OSCORE;
+        }
+        binding = *client_request;
+        if (piv_len) {
+            compute_nonce(security, security->recipient_id,
+                          security->recipient_id_len, piv, piv_len, nonce);
+        } else {
+            compute_nonce(security, binding.kid, binding.kid_len, binding.piv,
+                          binding.piv_len, nonce);
+        }
+    }
+
+    uint8_t aad[AAD_MAX_LEN];
+    size_t aad_len = compute_aad(&binding, aad);
+    uint8_t *plaintext = (uint8_t *) (intptr_t) parsed.payload;
+    size_t plaintext_size = parsed.payload_len - ANJ_OSCORE_TAG_LEN;
+    if (anj_crypto_aes_ccm_decrypt(security->recipient_key, ANJ_OSCORE_KEY_LEN,
+                                   nonce, sizeof(nonce), aad, aad_len,
+                                   plaintext, plaintext_size,
+                                   plaintext + plaintext_size,
+                                   ANJ_OSCORE_TAG_LEN)) {
+        return _ANJ_ERR_OSCORE;
+    }
+    uint8_t inner_code = plaintext[0];
+    if (request ? (_anj_code_get_class(inner_code) != 0
+                   || inner_code == ANJ_COAP_CODE_EMPTY)
+                : _anj_code_get_class(inner_code) < 2) {
+        return _ANJ_ERR_MALFORMED_MESSAGE;
+    }
+
+    msg[1] = inner_code;
+    memmove(msg + parsed.header_size, plaintext + 1, plaintext_size - 1);
+    *inout_size = parsed.header_size + plaintext_size - 1;
+
+    if (request && !duplicate) {
+#    ifdef ANJ_WITH_OBSERVE
+        parsed_msg_t inner;
+        res = parse_msg(msg, *inout_size, &inner);
+        _RET_IF_ERROR(res);
+        update_observations(ctx, &inner.opts, &binding);
+#    endif // ANJ_WITH_OBSERVE
+        replay_window_update(ctx, seq_num);
+        store_request(ctx->server_requests, _ANJ_OSCORE_REQUESTS_NUMBER,
+                      &ctx->next_server_request, &binding);
+    }
+    return 0;
+}
+
+#endif // ANJ_WITH_OSCORE
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#ifndef SRC_ANJ_COAP_TCP_H
+#    define SRC_ANJ_COAP_TCP_H
+
+#    include <assert.h>
+#    include <stddef.h>
+#    include <stdint.h>
+
+#    include "common.h"
+
+#    ifdef _ANJ_COAP_WITH_TCP
+
+/*
+ * RFC 8323, section 3.2: the first byte of the message consists of 4-bit Len
+ * and TKL fields. Len values 13, 14 and 15 mean that the length of the message
+ * (without the header and the token) is stored in the following 1, 2 or 4
+ * bytes, reduced by 13, 269 and 65805 respectively.
+ */
+#        define _ANJ_COAP_TCP_HEADER_LEN_MASK 0xF0
+#        define _ANJ_COAP_TCP_HEADER_LEN_SHIFT 4
+#        define _ANJ_COAP_TCP_HEADER_TOKEN_LENGTH_MASK 0x0F
+#        define _ANJ_COAP_TCP_HEADER_TOKEN_LENGTH_SHIFT 0
+
+#        define _ANJ_COAP_TCP_LEN_8BIT 13
+#        define _ANJ_COAP_TCP_LEN_16BIT 14
+#        define _ANJ_COAP_TCP_LEN_32BIT 15
+
+#        define _ANJ_COAP_TCP_LEN_8BIT_OFFSET 13U
+#        define _ANJ_COAP_TCP_LEN_16BIT_OFFSET 269U
+#        define _ANJ_COAP_TCP_LEN_32BIT_OFFSET 65805U
+
+static inline uint8_t _anj_coap_tcp_header_get_len(uint8_t len_token_length) {
+    return _ANJ_FIELD_GET(len_token_length, _ANJ_COAP_TCP_HEADER_LEN_MASK,
+                          _ANJ_COAP_TCP_HEADER_LEN_SHIFT);
+}
+
+static inline uint8_t
+_anj_coap_tcp_header_get_token_length(uint8_t len_token_length) {
+    return _ANJ_FIELD_GET(len_token_length,
+                          _ANJ_COAP_TCP_HEADER_TOKEN_LENGTH_MASK,
+                          _ANJ_COAP_TCP_HEADER_TOKEN_LENGTH_SHIFT);
+}
+
+/* Number of extended length bytes that follow the first byte of the header */
+static inline size_t _anj_coap_tcp_header_ext_len_size(uint8_t len) {
+    switch (len) {
+    case _ANJ_COAP_TCP_LEN_8BIT:
+        return 1;
+    case _ANJ_COAP_TCP_LEN_16BIT:
+        return 2;
+    case _ANJ_COAP_TCP_LEN_32BIT:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+/*
+ * Writes the header of the message with @p body_len bytes of options and
+ * payload, placing it so that it ends right before @p buf_end. Returns the
+ * number of bytes written.
+ */
+static inline size_t _anj_coap_tcp_header_serialize(uint8_t *buf_end,
+                                                    size_t body_len,
+                                                    uint8_t token_length,
+                                                    uint8_t code) {
+    assert(token_length <= _ANJ_COAP_TCP_HEADER_TOKEN_LENGTH_MASK);
+    uint8_t len;
+    size_t ext_len_size;
+    uint32_t ext_len;
+    if (body_len < _ANJ_COAP_TCP_LEN_8BIT_OFFSET) {
+        len = (uint8_t) body_len;
+        ext_len_size = 0;
+        ext_len = 0;
+    } else if (body_len < _ANJ_COAP_TCP_LEN_16BIT_OFFSET) {
+        len = _ANJ_COAP_TCP_LEN_8BIT;
+        ext_len_size = 1;
+        ext_len = (uint32_t) (body_len - _ANJ_COAP_TCP_LEN_8BIT_OFFSET);
+    } else if (body_len < _ANJ_COAP_TCP_LEN_32BIT_OFFSET) {
+        len = _ANJ_COAP_TCP_LEN_16BIT;
+        ext_len_size = 2;
+        ext_len = (uint32_t) (body_len - _ANJ_COAP_TCP_LEN_16BIT_OFFSET);
+    } else {
+        len = _ANJ_COAP_TCP_LEN_32BIT;
+        ext_len_size = 4;
+        ext_len = (uint32_t) (body_len - _ANJ_COAP_TCP_LEN_32BIT_OFFSET);
+    }
+
+    uint8_t *ptr = buf_end - 2 - ext_len_size;
+    ptr[0] = 0;
+    _ANJ_FIELD_SET(ptr[0], _ANJ_COAP_TCP_HEADER_LEN_MASK,
+                   _ANJ_COAP_TCP_HEADER_LEN_SHIFT, len);
+    _ANJ_FIELD_SET(ptr[0], _ANJ_COAP_TCP_HEADER_TOKEN_LENGTH_MASK,
+                   _ANJ_COAP_TCP_HEADER_TOKEN_LENGTH_SHIFT, token_length);
+    for (size_t i = 0; i < ext_len_size; i++) {
+        ptr[1 + i] = (uint8_t) (ext_len >> (8 * (ext_len_size - 1 - i)));
+    }
+    ptr[1 + ext_len_size] = code;
+    return 2 + ext_len_size;
+}
+
+#    endif // _ANJ_COAP_WITH_TCP
+
+#endif // SRC_ANJ_COAP_TCP_H
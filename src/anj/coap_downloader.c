@@ -18,13 +18,19 @@
 
 #include <anj/coap_downloader.h>
 #include <anj/compat/net/anj_net_api.h>
+#include <anj/compat/rng.h>
+#include <anj/compat/time.h>
 #include <anj/defs.h>
 #include <anj/log.h>
+#include <anj/time.h>
 
 #include "coap/coap.h"
+#include "coap_downloader_shared.h"
 #include "core/core_utils.h"
+#include "core/reg_session.h"
 #include "core/srv_conn.h"
 #include "exchange.h"
+#include "utils.h"
 
 #ifdef ANJ_WITH_COAP_DOWNLOADER
 
@@ -42,14 +48,244 @@ static int connect_with_server(anj_coap_downloader_t *ctx) {
                                  port);
 }
 
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+static bool shared_connection_usable(anj_t *anj) {
+    uint8_t internal_state =
+            anj->server_state.details.registered.internal_state;
+    return anj->server_state.conn_status == ANJ_CONN_STATUS_REGISTERED
+           && (internal_state == _ANJ_SRV_MAN_STATE_IDLE_IN_PROGRESS
+               || internal_state == _ANJ_SRV_MAN_STATE_EXCHANGE_IN_PROGRESS)
+           && anj->connection_ctx.net_ctx;
+}
+
+static bool shared_connection_matches(anj_coap_downloader_t *ctx) {
+    anj_t *anj = ctx->anj;
+    return anj && !anj->shared_downloader && shared_connection_usable(anj)
+           && ctx->binding == anj->security_instance.type
+           && strlen(anj->security_instance.server_uri) == ctx->host_len
+           && !memcmp(anj->security_instance.server_uri, ctx->host,
+                      ctx->host_len)
+           && strlen(anj->security_instance.port) == ctx->port_len
+           && !memcmp(anj->security_instance.port, ctx->port, ctx->port_len);
+}
+
+// connection_ctx is a copy of the LwM2M Server connection, only bytes_sent
+// and send_in_progress belong to the downloader
+static void shared_connection_sync(anj_coap_downloader_t *ctx) {
+    ctx->connection_ctx.net_ctx = ctx->anj->connection_ctx.net_ctx;
+    ctx->connection_ctx.type = ctx->anj->connection_ctx.type;
+    ctx->connection_ctx.mtu = ctx->anj->connection_ctx.mtu;
+}
+
+static void shared_connection_detach(anj_coap_downloader_t *ctx) {
+    if (ctx->anj->shared_downloader == ctx) {
+        ctx->anj->shared_downloader = NULL;
+    }
+    ctx->shared_connection = false;
+    memset(&ctx->connection_ctx, 0, sizeof(ctx->connection_ctx));
+}
+#    endif // ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
+static bool mux_enabled(anj_coap_downloader_t *ctx) {
+    return ctx->mux_owner || ctx->mux_transfers;
+}
+
+static anj_coap_downloader_t *mux_root(anj_coap_downloader_t *ctx) {
+    return ctx->mux_owner ? ctx->mux_owner : ctx;
+}
+
+static bool mux_same_endpoint(anj_coap_downloader_t *ctx,
+                              anj_coap_downloader_t *owner) {
+    return ctx->binding == owner->binding && ctx->host_len == owner->host_len
+           && !memcmp(ctx->host, owner->host, ctx->host_len)
+           && ctx->port_len == owner->port_len
+           && !memcmp(ctx->port, owner->port, ctx->port_len);
+}
+
+// the transfer is attached as soon as it's started, so that the owner steps
+// it while the connection is still being set up
+static void mux_attach(anj_coap_downloader_t *ctx) {
+    if (!ctx->multiplex_with) {
+        return;
+    }
+    anj_coap_downloader_t *owner = mux_root(ctx->multiplex_with);
+    if (owner == ctx
+            || (owner->status != ANJ_COAP_DOWNLOADER_STATUS_STARTING
+                && owner->status != ANJ_COAP_DOWNLOADER_STATUS_DOWNLOADING)
+            || !mux_same_endpoint(ctx, owner)) {
+        return;
+    }
+    ctx->mux_owner = owner;
+    ctx->mux_next = owner->mux_transfers;
+    owner->mux_transfers = ctx;
+}
+
+static void mux_detach(anj_coap_downloader_t *ctx) {
+    anj_coap_downloader_t **it = &ctx->mux_owner->mux_transfers;
+    while (*it != ctx) {
+        it = &(*it)->mux_next;
+    }
+    *it = ctx->mux_next;
+    ctx->mux_next = NULL;
+    ctx->mux_owner = NULL;
+    memset(&ctx->connection_ctx, 0, sizeof(ctx->connection_ctx));
+}
+
+// returns true while the owner is connecting; if its connection can't be
+// used, the transfer is detached and opens its own
+static bool mux_owner_connecting(anj_coap_downloader_t *ctx) {
+    anj_coap_downloader_t *owner = ctx->mux_owner;
+    if (owner->status == ANJ_COAP_DOWNLOADER_STATUS_STARTING) {
+        return true;
+    }
+    if ((owner->status != ANJ_COAP_DOWNLOADER_STATUS_DOWNLOADING
+         && owner->status != ANJ_COAP_DOWNLOADER_STATUS_FINISHING)
+            || !owner->connection_ctx.net_ctx
+#        ifdef ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+            || owner->shared_connection
+#        endif // ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+    ) {
+        downloader_log(L_DEBUG, "Connection can't be multiplexed");
+        mux_detach(ctx);
+    }
+    return false;
+}
+
+// connection_ctx of an attached transfer is a copy of the owner's one, only
+// bytes_sent and send_in_progress belong to the transfer
+static void mux_sync(anj_coap_downloader_t *ctx) {
+    ctx->connection_ctx.net_ctx = ctx->mux_owner->connection_ctx.net_ctx;
+    ctx->connection_ctx.type = ctx->mux_owner->connection_ctx.type;
+    ctx->connection_ctx.mtu = ctx->mux_owner->connection_ctx.mtu;
+}
+
+static bool mux_sending(anj_coap_downloader_t *owner,
+                        anj_coap_downloader_t *except) {
+    if (owner != except && owner->connection_ctx.send_in_progress) {
+        return true;
+    }
+    for (anj_coap_downloader_t *it = owner->mux_transfers; it;
+         it = it->mux_next) {
+        if (it != except && it->connection_ctx.send_in_progress) {
+            return true;
+        }
+    }
+    return false;
+}
+#    endif // ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
+
+// Message IDs of both modules must not collide on a shared connection, so the
+// counter of the LwM2M Server exchange is used for the downloader requests.
+// Tokens don't need such treatment, they are random for every request.
+static void msg_id_acquire(anj_coap_downloader_t *ctx) {
+    (void) ctx;
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+    if (ctx->shared_connection) {
+        ctx->exchange_ctx.msg_id = ctx->anj->exchange_ctx.msg_id;
+    }
+#    endif // ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
+    if (ctx->mux_owner) {
+        ctx->exchange_ctx.msg_id = ctx->mux_owner->exchange_ctx.msg_id;
+    }
+#    endif // ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
+}
+
+static void msg_id_release(anj_coap_downloader_t *ctx) {
+    (void) ctx;
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+    if (ctx->shared_connection) {
+        ctx->anj->exchange_ctx.msg_id = ctx->exchange_ctx.msg_id;
+    }
+#    endif // ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
+    if (ctx->mux_owner) {
+        ctx->mux_owner->exchange_ctx.msg_id = ctx->exchange_ctx.msg_id;
+    }
+#    endif // ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
+}
+
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_RESUME
+static void progress_reset(anj_coap_downloader_t *ctx) {
+    memset(&ctx->progress, 0, sizeof(ctx->progress));
+}
+
+// called for every block before it's passed to the application, so that
+// progress stored from the event callback already includes it
+static void progress_update(anj_coap_downloader_t *ctx,
+                            uint32_t next_block,
+                            uint16_t block_size) {
+    ctx->progress.next_block = next_block;
+    ctx->progress.block_size = block_size;
+    ctx->progress.etag = ctx->etag;
+}
+
+static void progress_prepare(anj_coap_downloader_t *ctx, const char *uri) {
+    ctx->first_block = 0;
+    ctx->first_block_size = 0;
+    ctx->resume_pending = false;
+    // without ETag there is no way to tell if the resource has changed
+    if (ctx->progress.next_block > 0 && ctx->progress.block_size > 0
+            && ctx->progress.etag.size > 0
+            && !strcmp(ctx->progress.uri, uri)) {
+        ctx->first_block = ctx->progress.next_block;
+        ctx->first_block_size = ctx->progress.block_size;
+        ctx->resume_pending = true;
+        ctx->etag = ctx->progress.etag;
+        downloader_log(L_INFO, "Resuming download from block %" PRIu32,
+                       ctx->first_block);
+        return;
+    }
+    progress_reset(ctx);
+    size_t uri_len = strlen(uri);
+    if (uri_len >= sizeof(ctx->progress.uri)) {
+        downloader_log(L_WARNING, "URI too long, download can't be resumed");
+        return;
+    }
+    memcpy(ctx->progress.uri, uri, uri_len + 1);
+}
+
+// server has to continue with the same block size, otherwise the offset of
+// the received data wouldn't match the stored progress
+static int progress_check_first_response(anj_coap_downloader_t *ctx,
+                                         const _anj_coap_msg_t *msg) {
+    if (!ctx->resume_pending || msg->operation != ANJ_OP_RESPONSE
+            || msg->msg_code >= ANJ_COAP_CODE_BAD_REQUEST) {
+        return 0;
+    }
+    ctx->resume_pending = false;
+    if (msg->block.block_type != ANJ_OPTION_BLOCK_2
+            || msg->block.number != ctx->first_block
+            || msg->block.size != ctx->first_block_size) {
+        downloader_log(L_ERROR, "Server didn't resume the download");
+        progress_reset(ctx);
+        return ANJ_COAP_DOWNLOADER_ERR_INVALID_RESPONSE;
+    }
+    return 0;
+}
+#    endif // ANJ_COAP_DOWNLOADER_WITH_RESUME
+
+static _anj_exchange_state_t
+downloader_exchange_process(anj_coap_downloader_t *ctx,
+                            _anj_exchange_event_t event,
+                            _anj_coap_msg_t *msg) {
+    msg_id_acquire(ctx);
+    _anj_exchange_state_t state =
+            _anj_exchange_process(&ctx->exchange_ctx, event, msg);
+    msg_id_release(ctx);
+    return state;
+}
+
 static void exchange_completion(void *arg_ptr,
                                 const _anj_coap_msg_t *response,
                                 int result) {
     (void) response;
     anj_coap_downloader_t *ctx = (anj_coap_downloader_t *) arg_ptr;
 
+    // ctx->status is updated by anj_coap_downloader_step, completion may be
+    // also called from _anj_coap_downloader_shared_handle_msg
     if (result == _ANJ_EXCHANGE_RESULT_SUCCESS) {
-        ctx->status = ANJ_COAP_DOWNLOADER_STATUS_FINISHED;
         downloader_log(L_DEBUG, "Download finished successfully");
         return;
     }
@@ -77,6 +313,10 @@ static uint8_t exchange_write_payload(void *arg_ptr,
                                       bool last_block) {
     (void) last_block;
     anj_coap_downloader_t *ctx = (anj_coap_downloader_t *) arg_ptr;
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_RESUME
+    progress_update(ctx, ctx->exchange_ctx.block_number + 1,
+                    ctx->response_block_size);
+#    endif // ANJ_COAP_DOWNLOADER_WITH_RESUME
     ctx->event_cb(ctx->event_cb_arg, ctx,
                   ANJ_COAP_DOWNLOADER_STATUS_DOWNLOADING, payload, payload_len);
     return 0;
@@ -146,12 +386,24 @@ static int start_new_exchange(anj_coap_downloader_t *ctx) {
     if (res) {
         return res;
     }
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_RESUME
+    if (ctx->first_block > 0) {
+        request.block = (_anj_block_t) {
+            .block_type = ANJ_OPTION_BLOCK_2,
+            .number = ctx->first_block,
+            .size = ctx->first_block_size,
+            .more_flag = false
+        };
+    }
+#    endif // ANJ_COAP_DOWNLOADER_WITH_RESUME
 
+    msg_id_acquire(ctx);
     // start new exchange, this function can't return error if no payload is get
     // payload pointer can be set to ctx->msg_buffer because it is not used
     _anj_exchange_new_client_request(&ctx->exchange_ctx, &request, &handlers,
                                      ctx->msg_buffer,
                                      ANJ_COAP_DOWNLOADER_MAX_MSG_SIZE);
+    msg_id_release(ctx);
 
     res = _anj_coap_encode_udp(&request, ctx->msg_buffer,
                                ANJ_COAP_DOWNLOADER_MAX_MSG_SIZE,
@@ -183,8 +435,807 @@ static int check_etag_mismatch(_anj_etag_t *etag,
     return 0;
 }
 
+static int encode_msg(anj_coap_downloader_t *ctx, _anj_coap_msg_t *msg) {
+    int result = _anj_coap_encode_udp(msg, ctx->msg_buffer,
+                                      ANJ_COAP_DOWNLOADER_MAX_MSG_SIZE,
+                                      &ctx->out_msg_len);
+    if (result) {
+        downloader_log(L_ERROR, "Failed to encode CoAP message: %d", result);
+        return ANJ_COAP_DOWNLOADER_ERR_INTERNAL;
+    }
+    return 0;
+}
+
+static int send_msg(anj_coap_downloader_t *ctx) {
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+    if (ctx->shared_connection) {
+        if (ctx->anj->connection_ctx.send_in_progress) {
+            // LwM2M message is being sent over the same socket
+            return ANJ_NET_EINPROGRESS;
+        }
+        shared_connection_sync(ctx);
+    }
+#    endif // ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
+    if (mux_enabled(ctx)) {
+        if (mux_sending(mux_root(ctx), ctx)) {
+            // request of another transfer is being sent
+            return ANJ_NET_EINPROGRESS;
+        }
+        if (ctx->mux_owner) {
+            mux_sync(ctx);
+        }
+    }
+#    endif // ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
+    return _anj_srv_conn_send(&ctx->connection_ctx, ctx->msg_buffer,
+                              ctx->out_msg_len);
+}
+
+// messages are received by anj_core_step() on the shared connection, and by
+// mux_receive() if multiplexed, then passed to routed_msg_handle()
+static bool msgs_routed(anj_coap_downloader_t *ctx) {
+    (void) ctx;
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+    if (ctx->shared_connection) {
+        return true;
+    }
+#    endif // ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
+    if (mux_enabled(ctx)) {
+        return true;
+    }
+#    endif // ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
+    return false;
+}
+
+static int process_new_msg(anj_coap_downloader_t *ctx,
+                           _anj_coap_msg_t *msg,
+                           _anj_exchange_state_t *out_exchange_state) {
+    if (msg->attr.downloader_attr.total_size != 0) {
+        downloader_log(L_INFO, "Total resource size: %" PRIu32 " bytes",
+                       msg->attr.downloader_attr.total_size);
+    }
+    // check ETag mismatch only for responses that are not error responses or
+    // reset messages
+    if (msg->operation == ANJ_OP_RESPONSE
+            && msg->msg_code < ANJ_COAP_CODE_BAD_REQUEST
+            && check_etag_mismatch(&ctx->etag,
+                                   &msg->attr.downloader_attr.etag)) {
+        downloader_log(L_ERROR, "ETag mismatch");
+        return ANJ_COAP_DOWNLOADER_ERR_ETAG_MISMATCH;
+    }
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_RESUME
+    int result = progress_check_first_response(ctx, msg);
+    if (result) {
+        return result;
+    }
+    ctx->response_block_size = msg->block.block_type == ANJ_OPTION_BLOCK_2
+                                       ? msg->block.size
+                                       : 0;
+#    endif // ANJ_COAP_DOWNLOADER_WITH_RESUME
+    *out_exchange_state =
+            downloader_exchange_process(ctx, ANJ_EXCHANGE_EVENT_NEW_MSG, msg);
+    return 0;
+}
+
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW
+#        define BLOCK_NUMBER_UNKNOWN UINT32_MAX
+
+static bool window_enabled(anj_coap_downloader_t *ctx) {
+    return ctx->window.size > 1;
+}
+
+static void window_start(anj_coap_downloader_t *ctx) {
+    uint8_t size = ctx->window.size;
+#        ifdef ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+    bool q_block2 = ctx->window.q_block2_enabled;
+#        endif // ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+    memset(&ctx->window, 0, sizeof(ctx->window));
+    ctx->window.size = size;
+#        ifdef ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+    ctx->window.q_block2_enabled = q_block2;
+    ctx->window.q_block2 = q_block2;
+#        endif // ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+    // size requested for the first block, server may choose a smaller one
+    ctx->window.block_size =
+            _anj_determine_block_buffer_size(ANJ_COAP_DOWNLOADER_MAX_MSG_SIZE);
+    ctx->window.last_block = BLOCK_NUMBER_UNKNOWN;
+#        ifdef ANJ_COAP_DOWNLOADER_WITH_RESUME
+    if (ctx->first_block > 0) {
+        ctx->window.block_size = ctx->first_block_size;
+        ctx->window.next_block_to_request = ctx->first_block;
+        ctx->window.next_block_to_deliver = ctx->first_block;
+    }
+#        endif // ANJ_COAP_DOWNLOADER_WITH_RESUME
+}
+
+static _anj_coap_downloader_block_slot_t *
+window_find_slot(anj_coap_downloader_t *ctx,
+                 const _anj_coap_token_t *token,
+                 const uint16_t *msg_id) {
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(ctx->window.slots); i++) {
+        _anj_coap_downloader_block_slot_t *slot = &ctx->window.slots[i];
+        if (!slot->in_use || slot->received) {
+            continue;
+        }
+        if ((token && _anj_tokens_equal(token, &slot->token))
+                || (msg_id && *msg_id == slot->msg_id)) {
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+#        ifdef ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+static _anj_coap_downloader_block_slot_t *
+window_find_q_block2_slot(anj_coap_downloader_t *ctx,
+                          const _anj_coap_token_t *token,
+                          uint32_t block_number) {
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(ctx->window.slots); i++) {
+        _anj_coap_downloader_block_slot_t *slot = &ctx->window.slots[i];
+        if (slot->in_use && !slot->received
+                && slot->block_number == block_number
+                && _anj_tokens_equal(token, &slot->token)) {
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+// number of blocks still awaited from the request the slot belongs to
+static uint8_t window_request_block_count(anj_coap_downloader_t *ctx,
+                                          const _anj_coap_token_t *token) {
+    uint8_t count = 0;
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(ctx->window.slots); i++) {
+        _anj_coap_downloader_block_slot_t *slot = &ctx->window.slots[i];
+        if (slot->in_use && !slot->received
+                && _anj_tokens_equal(token, &slot->token)) {
+            count++;
+        }
+    }
+    return count;
+}
+#        endif // ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+
+static void window_set_error(anj_coap_downloader_t *ctx,
+                             uint32_t block_number,
+                             int error_code) {
+    if (!ctx->window.error_code || block_number < ctx->window.error_block) {
+        ctx->window.error_code = error_code;
+        ctx->window.error_block = block_number;
+    }
+}
+
+// blocks past the end of the resource are never delivered, and errors
+// reported for them (e.g. 4.02 Bad Option) don't affect the download
+static void window_drop_past_last_block(anj_coap_downloader_t *ctx) {
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(ctx->window.slots); i++) {
+        if (ctx->window.slots[i].block_number > ctx->window.last_block) {
+            ctx->window.slots[i].in_use = false;
+        }
+    }
+    if (ctx->window.error_code
+            && ctx->window.error_block > ctx->window.last_block) {
+        ctx->window.error_code = 0;
+    }
+}
+
+static int window_flush(anj_coap_downloader_t *ctx) {
+    int result = send_msg(ctx);
+    ctx->window.send_pending = anj_net_is_inprogress(result);
+    if (result && !ctx->window.send_pending) {
+        return ANJ_COAP_DOWNLOADER_ERR_NETWORK;
+    }
+    return result;
+}
+
+static int window_send_request(anj_coap_downloader_t *ctx,
+                               _anj_coap_downloader_block_slot_t *slot) {
+    _anj_coap_msg_t request;
+    memset(&request, 0, sizeof(request));
+    request.operation = ANJ_OP_COAP_DOWNLOADER_GET;
+    int result = get_paths_from_uri(ctx->uri, &request.attr.downloader_attr);
+    if (result) {
+        return result;
+    }
+    request.token = slot->token;
+    request.coap_binding_data.message_id = slot->msg_id;
+    request.block = (_anj_block_t) {
+        .block_type = ANJ_OPTION_BLOCK_2,
+        .number = slot->block_number,
+        .size = ctx->window.block_size,
+        .more_flag = false
+    };
+#        ifdef ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+    if (ctx->window.q_block2) {
+        // slot holds the lowest of the consecutive blocks of the request
+        request.block.block_type = ANJ_OPTION_Q_BLOCK_2;
+        request.block.count = window_request_block_count(ctx, &slot->token);
+    }
+#        endif // ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+    result = encode_msg(ctx, &request);
+    if (result) {
+        return result;
+    }
+    return window_flush(ctx);
+}
+
+static int window_new_request_id(anj_coap_downloader_t *ctx,
+                                 _anj_coap_downloader_block_slot_t *slot) {
+    if (anj_rng_generate((uint8_t *) slot->token.bytes,
+                         _ANJ_COAP_MAX_TOKEN_LENGTH)) {
+        downloader_log(L_ERROR, "Could not generate random number");
+        return ANJ_COAP_DOWNLOADER_ERR_INTERNAL;
+    }
+    slot->token.size = _ANJ_COAP_MAX_TOKEN_LENGTH;
+    msg_id_acquire(ctx);
+    slot->msg_id = ++ctx->exchange_ctx.msg_id;
+    msg_id_release(ctx);
+    return 0;
+}
+
+static int window_prepare_request(anj_coap_downloader_t *ctx,
+                                  _anj_coap_downloader_block_slot_t *slot) {
+    uint32_t random;
+    int result = window_new_request_id(ctx, slot);
+    if (result) {
+        return result;
+    }
+    if (anj_rng_generate((uint8_t *) &random, sizeof(random))) {
+        downloader_log(L_ERROR, "Could not generate random number");
+        return ANJ_COAP_DOWNLOADER_ERR_INTERNAL;
+    }
+    slot->block_number = ctx->window.next_block_to_request++;
+    slot->in_use = true;
+    slot->received = false;
+    slot->retry_count = 0;
+    // RFC 7252 "The initial timeout is set to a random number between
+    // ACK_TIMEOUT and (ACK_TIMEOUT * ACK_RANDOM_FACTOR)"
+    const anj_exchange_udp_tx_params_t *tx_params =
+            &ctx->exchange_ctx.tx_params;
+    slot->timeout = _anj_exchange_initial_timeout(
+            tx_params, tx_params->ack_timeout, random);
+    slot->timeout_timestamp =
+            anj_time_monotonic_add(anj_time_monotonic_now(), slot->timeout);
+    return 0;
+}
+
+static int window_new_request(anj_coap_downloader_t *ctx,
+                              _anj_coap_downloader_block_slot_t *slot) {
+    int result = window_prepare_request(ctx, slot);
+    if (result) {
+        return result;
+    }
+    return window_send_request(ctx, slot);
+}
+
+static bool window_can_request(anj_coap_downloader_t *ctx) {
+    // block size used by the server is known only after the first response
+    if (ctx->window.next_block_to_request > ctx->window.next_block_to_deliver
+            && !ctx->window.block_size_confirmed) {
+        return false;
+    }
+    return ctx->window.next_block_to_request <= ctx->window.last_block
+           && ctx->window.next_block_to_request
+                      < ctx->window.next_block_to_deliver + ctx->window.size;
+}
+
+#        ifdef ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+// all blocks that fit in the window are requested with a single message
+static int window_request_blocks_q_block2(anj_coap_downloader_t *ctx) {
+    _anj_coap_downloader_block_slot_t *first = NULL;
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(ctx->window.slots); i++) {
+        if (!window_can_request(ctx)) {
+            break;
+        }
+        _anj_coap_downloader_block_slot_t *slot = &ctx->window.slots[i];
+        if (slot->in_use) {
+            continue;
+        }
+        if (!first) {
+            int result = window_prepare_request(ctx, slot);
+            if (result) {
+                return result;
+            }
+            first = slot;
+            continue;
+        }
+        slot->token = first->token;
+        slot->msg_id = first->msg_id;
+        slot->block_number = ctx->window.next_block_to_request++;
+        slot->in_use = true;
+        slot->received = false;
+        slot->retry_count = 0;
+        slot->timeout = first->timeout;
+        slot->timeout_timestamp = first->timeout_timestamp;
+    }
+    return first ? window_send_request(ctx, first) : 0;
+}
+
+// blocks of the request are requested again one by one, by
+// window_check_timeouts()
+static void window_split_request(anj_coap_downloader_t *ctx,
+                                 const _anj_coap_token_t *token) {
+    anj_time_monotonic_t now = anj_time_monotonic_now();
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(ctx->window.slots); i++) {
+        _anj_coap_downloader_block_slot_t *slot = &ctx->window.slots[i];
+        if (slot->in_use && !slot->received
+                && _anj_tokens_equal(token, &slot->token)) {
+            slot->timeout_timestamp = now;
+        }
+    }
+}
+#        endif // ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+
+static int window_request_blocks(anj_coap_downloader_t *ctx) {
+#        ifdef ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+    if (ctx->window.q_block2) {
+        return window_request_blocks_q_block2(ctx);
+    }
+#        endif // ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(ctx->window.slots); i++) {
+        if (!window_can_request(ctx)) {
+            break;
+        }
+        if (ctx->window.slots[i].in_use) {
+            continue;
+        }
+        int result = window_new_request(ctx, &ctx->window.slots[i]);
+        if (result) {
+            return result;
+        }
+    }
+    return 0;
+}
+
+static int window_check_timeouts(anj_coap_downloader_t *ctx) {
+    anj_time_monotonic_t now = anj_time_monotonic_now();
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(ctx->window.slots); i++) {
+        _anj_coap_downloader_block_slot_t *slot = &ctx->window.slots[i];
+        if (!slot->in_use || slot->received
+                || !anj_time_monotonic_geq(now, slot->timeout_timestamp)) {
+            continue;
+        }
+        if (slot->retry_count >= ctx->exchange_ctx.tx_params.max_retransmit) {
+            downloader_log(L_ERROR, "Block %" PRIu32 " request timeout",
+                           slot->block_number);
+            return ANJ_COAP_DOWNLOADER_ERR_TIMEOUT;
+        }
+        slot->retry_count++;
+        slot->timeout_timestamp = anj_time_monotonic_add(
+                now, anj_time_duration_mul(slot->timeout,
+                                           1 << slot->retry_count));
+        downloader_log(L_WARNING, "Block %" PRIu32 " timeout, retrying",
+                       slot->block_number);
+#        ifdef ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+        // request for several blocks is never retransmitted as a whole, only
+        // the blocks that are still missing are requested again, one by one
+        if (ctx->window.q_block2) {
+            int result = window_new_request_id(ctx, slot);
+            if (result) {
+                return result;
+            }
+        }
+#        endif // ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+        int result = window_send_request(ctx, slot);
+        if (result) {
+            return result;
+        }
+    }
+    return 0;
+}
+
+static int window_deliver(anj_coap_downloader_t *ctx) {
+    size_t i = 0;
+    while (i < ANJ_ARRAY_SIZE(ctx->window.slots)) {
+        if (ctx->window.error_code
+                && ctx->window.error_block
+                               == ctx->window.next_block_to_deliver) {
+            return ctx->window.error_code;
+        }
+        _anj_coap_downloader_block_slot_t *slot = &ctx->window.slots[i];
+        if (!slot->in_use || !slot->received
+                || slot->block_number != ctx->window.next_block_to_deliver) {
+            i++;
+            continue;
+        }
+        slot->in_use = false;
+        ctx->window.next_block_to_deliver++;
+#        ifdef ANJ_COAP_DOWNLOADER_WITH_RESUME
+        progress_update(ctx, ctx->window.next_block_to_deliver,
+                        ctx->window.block_size_confirmed
+                                ? ctx->window.block_size
+                                : 0);
+#        endif // ANJ_COAP_DOWNLOADER_WITH_RESUME
+        ctx->event_cb(ctx->event_cb_arg, ctx,
+                      ANJ_COAP_DOWNLOADER_STATUS_DOWNLOADING, slot->payload,
+                      slot->payload_len);
+        // the next block may be stored in any slot
+        i = 0;
+    }
+    return 0;
+}
+
+static bool window_is_block_response(const _anj_coap_msg_t *msg) {
+#        ifdef ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+    if (msg->block.block_type == ANJ_OPTION_Q_BLOCK_2) {
+        return true;
+    }
+#        endif // ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+    return msg->block.block_type == ANJ_OPTION_BLOCK_2;
+}
+
+static int window_handle_response(anj_coap_downloader_t *ctx,
+                                  const _anj_coap_msg_t *msg) {
+    _anj_coap_downloader_block_slot_t *slot =
+            window_find_slot(ctx, &msg->token, NULL);
+#        ifdef ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+    if (slot && msg->block.block_type == ANJ_OPTION_Q_BLOCK_2) {
+        // single request may be answered with several responses
+        slot = window_find_q_block2_slot(ctx, &msg->token, msg->block.number);
+    }
+#        endif // ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+    if (!slot) {
+        downloader_log(L_DEBUG, "Unexpected response, ignoring");
+        return 0;
+    }
+#        ifdef ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+    if (msg->msg_code >= ANJ_COAP_CODE_BAD_REQUEST && ctx->window.q_block2) {
+        if (window_request_block_count(ctx, &slot->token) > 1) {
+            // error can't be assigned to any of the blocks
+            downloader_log(L_WARNING, "Q-Block2 request failed, requesting "
+                                      "blocks one by one");
+            window_split_request(ctx, &slot->token);
+            return 0;
+        }
+        if (msg->msg_code == ANJ_COAP_CODE_BAD_OPTION
+                && !ctx->window.block_size_confirmed) {
+            downloader_log(L_WARNING, "Q-Block2 not supported by the server");
+            ctx->window.q_block2 = false;
+            int result = window_new_request_id(ctx, slot);
+            if (result) {
+                return result;
+            }
+            // sent by window_check_timeouts()
+            slot->timeout_timestamp = anj_time_monotonic_now();
+            return 0;
+        }
+    }
+#        endif // ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+    if (msg->msg_code >= ANJ_COAP_CODE_BAD_REQUEST) {
+        downloader_log(L_WARNING, "Block %" PRIu32 " request failed",
+                       slot->block_number);
+        slot->in_use = false;
+        window_set_error(ctx, slot->block_number,
+                         ANJ_COAP_DOWNLOADER_ERR_INVALID_RESPONSE);
+        window_drop_past_last_block(ctx);
+        return 0;
+    }
+    if (check_etag_mismatch(&ctx->etag, &msg->attr.downloader_attr.etag)) {
+        downloader_log(L_ERROR, "ETag mismatch");
+        return ANJ_COAP_DOWNLOADER_ERR_ETAG_MISMATCH;
+    }
+#        ifdef ANJ_COAP_DOWNLOADER_WITH_RESUME
+    int result = progress_check_first_response(ctx, msg);
+    if (result) {
+        return result;
+    }
+#        endif // ANJ_COAP_DOWNLOADER_WITH_RESUME
+
+#        ifdef ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+    if (ctx->window.q_block2 && msg->block.block_type == ANJ_OPTION_BLOCK_2) {
+        // server ignored the Q-Block2 option, it's possible only in the
+        // response to the first request, sent for a single block
+        downloader_log(L_WARNING, "Q-Block2 not supported by the server");
+        ctx->window.q_block2 = false;
+    }
+#        endif // ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+    if (!window_is_block_response(msg)) {
+        // whole resource fits in a single response
+        if (slot->block_number != 0) {
+            return ANJ_COAP_DOWNLOADER_ERR_INVALID_RESPONSE;
+        }
+        ctx->window.last_block = 0;
+    } else {
+        if (msg->block.number != slot->block_number
+                || (ctx->window.block_size_confirmed
+                    && msg->block.size != ctx->window.block_size)
+                || msg->block.size > ctx->window.block_size) {
+            downloader_log(L_ERROR, "Invalid Block2 option in response");
+            return ANJ_COAP_DOWNLOADER_ERR_INVALID_RESPONSE;
+        }
+        if (!ctx->window.block_size_confirmed) {
+            ctx->window.block_size = msg->block.size;
+            ctx->window.block_size_confirmed = true;
+            uint32_t total_size = msg->attr.downloader_attr.total_size;
+            if (total_size != 0) {
+                downloader_log(L_INFO, "Total resource size: %" PRIu32 " bytes",
+                               total_size);
+                ctx->window.last_block =
+                        (total_size - 1) / ctx->window.block_size;
+            }
+        }
+        if (!msg->block.more_flag) {
+            ctx->window.last_block =
+                    ANJ_MIN(ctx->window.last_block, msg->block.number);
+        }
+    }
+
+    assert(msg->payload_size <= sizeof(slot->payload));
+    if (msg->payload_size) {
+        memcpy(slot->payload, msg->payload, msg->payload_size);
+    }
+    slot->payload_len = msg->payload_size;
+    slot->received = true;
+    window_drop_past_last_block(ctx);
+    return 0;
+}
+
+static int window_handle_msg(anj_coap_downloader_t *ctx,
+                             const _anj_coap_msg_t *msg) {
+    if (msg->operation == ANJ_OP_COAP_EMPTY_MSG
+            || msg->operation == ANJ_OP_COAP_RESET) {
+        _anj_coap_downloader_block_slot_t *slot =
+                window_find_slot(ctx, NULL, &msg->coap_binding_data.message_id);
+        if (!slot) {
+            return 0;
+        }
+        if (msg->operation == ANJ_OP_COAP_RESET) {
+            downloader_log(L_ERROR, "Block %" PRIu32 " request rejected",
+                           slot->block_number);
+            return ANJ_COAP_DOWNLOADER_ERR_INVALID_RESPONSE;
+        }
+        // separate response will follow, stop retransmissions for now; with
+        // Q-Block2 the request may cover several slots
+        anj_time_monotonic_t now = anj_time_monotonic_now();
+        for (size_t i = 0; i < ANJ_ARRAY_SIZE(ctx->window.slots); i++) {
+            slot = &ctx->window.slots[i];
+            if (slot->in_use && !slot->received
+                    && slot->msg_id == msg->coap_binding_data.message_id) {
+                slot->retry_count = 0;
+                slot->timeout_timestamp =
+                        anj_time_monotonic_add(now, slot->timeout);
+            }
+        }
+        return 0;
+    }
+    if (msg->operation != ANJ_OP_RESPONSE) {
+        return 0;
+    }
+    int result = window_handle_response(ctx, msg);
+    // separate response has to be acknowledged; payload is already copied so
+    // msg_buffer can be reused, if it holds unsent message the server will
+    // retransmit the response
+    if (!result
+            && msg->coap_binding_data.type == ANJ_COAP_UDP_TYPE_CONFIRMABLE
+            && !ctx->window.send_pending) {
+        _anj_coap_msg_t ack;
+        memset(&ack, 0, sizeof(ack));
+        ack.operation = ANJ_OP_COAP_EMPTY_MSG;
+        ack.coap_binding_data.message_id = msg->coap_binding_data.message_id;
+        result = encode_msg(ctx, &ack);
+        ctx->window.send_pending = !result;
+    }
+    return result;
+}
+
+static int window_receive(anj_coap_downloader_t *ctx) {
+    while (!ctx->window.send_pending) {
+        size_t msg_size;
+        int result = _anj_srv_conn_receive(&ctx->connection_ctx,
+                                           ctx->msg_buffer, &msg_size,
+                                           ANJ_COAP_DOWNLOADER_MAX_MSG_SIZE);
+        if (anj_net_is_again(result)) {
+            return 0;
+        }
+        if (anj_net_is_inprogress(result)) {
+            return result;
+        }
+        if (result) {
+            return ANJ_COAP_DOWNLOADER_ERR_NETWORK;
+        }
+        _anj_coap_msg_t msg;
+        result = _anj_coap_decode_udp(ctx->msg_buffer, msg_size, &msg);
+        if (result) {
+            downloader_log(L_ERROR, "Failed to decode CoAP message: %d",
+                           result);
+            return ANJ_COAP_DOWNLOADER_ERR_INTERNAL;
+        }
+        result = window_handle_msg(ctx, &msg);
+        if (result) {
+            return result;
+        }
+    }
+    return 0;
+}
+
+static int window_process(anj_coap_downloader_t *ctx) {
+    int result = 0;
+    if (!msgs_routed(ctx)) {
+        result = window_receive(ctx);
+        if (result) {
+            return result;
+        }
+    }
+    if (ctx->window.send_pending) {
+        result = window_flush(ctx);
+        if (result) {
+            return result;
+        }
+    }
+    result = window_deliver(ctx);
+    if (result) {
+        return result;
+    }
+    if (ctx->window.next_block_to_deliver > ctx->window.last_block) {
+        return 0;
+    }
+    result = window_check_timeouts(ctx);
+    if (result) {
+        return result;
+    }
+    result = window_request_blocks(ctx);
+    if (result) {
+        return result;
+    }
+    return ANJ_NET_EAGAIN;
+}
+#    endif // ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW
+
+#    if defined(ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION) \
+            || defined(ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING)
+static bool routed_msg_matches(anj_coap_downloader_t *ctx,
+                               const _anj_coap_msg_t *msg) {
+    const _anj_coap_msg_t *request = &ctx->exchange_ctx.base_msg;
+    if (msg->operation == ANJ_OP_RESPONSE) {
+        return _anj_tokens_equal(&msg->token, &request->token);
+    }
+    // Empty ACK of the separate response or Reset carry no token
+    return (msg->operation == ANJ_OP_COAP_EMPTY_MSG
+            || msg->operation == ANJ_OP_COAP_RESET)
+           && msg->coap_binding_data.message_id
+                      == request->coap_binding_data.message_id;
+}
+
+// returns false if the message received by another module isn't addressed
+// to this transfer
+static bool routed_msg_handle(anj_coap_downloader_t *ctx,
+                              _anj_coap_msg_t *msg) {
+#        ifdef ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW
+    if (window_enabled(ctx)) {
+        if (!window_find_slot(ctx, &msg->token, NULL)
+                && !window_find_slot(ctx, NULL,
+                                     &msg->coap_binding_data.message_id)) {
+            return false;
+        }
+        // error is reported in the next anj_coap_downloader_step() call
+        int result = window_handle_msg(ctx, msg);
+        if (result) {
+            window_set_error(ctx, ctx->window.next_block_to_deliver, result);
+        }
+        return true;
+    }
+#        endif // ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW
+    if (!routed_msg_matches(ctx, msg)) {
+        return false;
+    }
+    if (_anj_exchange_get_state(&ctx->exchange_ctx)
+            != ANJ_EXCHANGE_STATE_WAITING_MSG) {
+        downloader_log(L_DEBUG, "Unexpected response, ignoring");
+        return true;
+    }
+    _anj_exchange_state_t exchange_state;
+    int result = process_new_msg(ctx, msg, &exchange_state);
+    if (!result && exchange_state == ANJ_EXCHANGE_STATE_MSG_TO_SEND) {
+        // message is sent in the next anj_coap_downloader_step() call
+        result = encode_msg(ctx, msg);
+    }
+    if (result) {
+        ctx->error_code = result;
+        downloader_log(L_ERROR, "Download failed with error: %d", result);
+        _anj_exchange_terminate(&ctx->exchange_ctx,
+                                _ANJ_EXCHANGE_ERROR_PROTOCOL);
+    }
+    return true;
+}
+#    endif // defined(ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION) ||
+           // defined(ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING)
+
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
+static bool mux_dispatch(anj_coap_downloader_t *owner, _anj_coap_msg_t *msg) {
+    if (owner->status == ANJ_COAP_DOWNLOADER_STATUS_DOWNLOADING
+            && routed_msg_handle(owner, msg)) {
+        return true;
+    }
+    for (anj_coap_downloader_t *it = owner->mux_transfers; it;
+         it = it->mux_next) {
+        if (it->status == ANJ_COAP_DOWNLOADER_STATUS_DOWNLOADING
+                && routed_msg_handle(it, msg)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// receives the datagrams of all transfers of the group, whichever of them is
+// being stepped, and passes them on by token or message ID
+static int mux_receive(anj_coap_downloader_t *ctx) {
+    anj_coap_downloader_t *owner = mux_root(ctx);
+    // socket can't be read until the datagram is sent entirely
+    while (!mux_sending(owner, NULL)) {
+        size_t msg_size;
+        int result = _anj_srv_conn_receive(&owner->connection_ctx,
+                                           owner->mux_in_buffer, &msg_size,
+                                           ANJ_COAP_DOWNLOADER_MAX_MSG_SIZE);
+        if (anj_net_is_again(result)) {
+            return 0;
+        }
+        if (anj_net_is_inprogress(result)) {
+            return result;
+        }
+        if (result) {
+            return ANJ_COAP_DOWNLOADER_ERR_NETWORK;
+        }
+        _anj_coap_msg_t msg;
+        result = _anj_coap_decode_udp(owner->mux_in_buffer, msg_size, &msg);
+        if (result) {
+            // may be addressed to any of the transfers, drop it
+            downloader_log(L_WARNING, "Failed to decode CoAP message: %d",
+                           result);
+            continue;
+        }
+        if (!mux_dispatch(owner, &msg)) {
+            downloader_log(L_DEBUG, "Unexpected message, ignoring");
+        }
+    }
+    return 0;
+}
+
+// attached transfers are stepped starting from a different one every time,
+// so that none of them is favoured when the connection is busy
+static void mux_step_transfers(anj_coap_downloader_t *ctx) {
+    anj_coap_downloader_t *it = ctx->mux_transfers;
+    while (it) {
+        // finished transfer detaches itself
+        anj_coap_downloader_t *next = it->mux_next;
+        anj_coap_downloader_step(it);
+        it = next;
+    }
+    anj_coap_downloader_t *first = ctx->mux_transfers;
+    if (!first || !first->mux_next) {
+        return;
+    }
+    anj_coap_downloader_t *last = first->mux_next;
+    while (last->mux_next) {
+        last = last->mux_next;
+    }
+    ctx->mux_transfers = first->mux_next;
+    first->mux_next = NULL;
+    last->mux_next = first;
+}
+#    endif // ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
+
 static int handle_request(anj_coap_downloader_t *ctx) {
     int result = 0;
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+    if (ctx->shared_connection && !shared_connection_usable(ctx->anj)) {
+        downloader_log(L_ERROR, "LwM2M Server connection is no longer usable");
+        return ANJ_COAP_DOWNLOADER_ERR_NETWORK;
+    }
+#    endif // ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
+    if (mux_enabled(ctx)) {
+        result = mux_receive(ctx);
+        if (result) {
+            return result;
+        }
+    }
+#    endif // ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW
+    if (window_enabled(ctx)) {
+        return window_process(ctx);
+    }
+#    endif // ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW
     _anj_exchange_state_t exchange_state =
             _anj_exchange_get_state(&ctx->exchange_ctx);
     _anj_coap_msg_t msg;
@@ -195,22 +1246,18 @@ static int handle_request(anj_coap_downloader_t *ctx) {
             // For both cases we need to send a message but for new message we
             // also need to build CoAP message first.
             if (exchange_state == ANJ_EXCHANGE_STATE_MSG_TO_SEND) {
-                result = _anj_coap_encode_udp(&msg, ctx->msg_buffer,
-                                              ANJ_COAP_DOWNLOADER_MAX_MSG_SIZE,
-                                              &ctx->out_msg_len);
+                result = encode_msg(ctx, &msg);
                 if (result) {
-                    downloader_log(L_ERROR, "Failed to encode CoAP message: %d",
-                                   result);
-                    return ANJ_COAP_DOWNLOADER_ERR_INTERNAL;
+                    return result;
                 }
             }
-            result = _anj_srv_conn_send(&ctx->connection_ctx, ctx->msg_buffer,
-                                        ctx->out_msg_len);
+            result = send_msg(ctx);
             if (anj_net_is_inprogress(result)) {
                 // check for send ACK timeout, error suggests network issue
                 exchange_state =
-                        _anj_exchange_process(&ctx->exchange_ctx,
-                                              ANJ_EXCHANGE_EVENT_NONE, &msg);
+                        downloader_exchange_process(ctx,
+                                                    ANJ_EXCHANGE_EVENT_NONE,
+                                                    &msg);
                 if (exchange_state == ANJ_EXCHANGE_STATE_FINISHED) {
                     return ANJ_COAP_DOWNLOADER_ERR_NETWORK;
                 }
@@ -218,13 +1265,23 @@ static int handle_request(anj_coap_downloader_t *ctx) {
             } else if (result) {
                 return ANJ_COAP_DOWNLOADER_ERR_NETWORK;
             }
-            exchange_state =
-                    _anj_exchange_process(&ctx->exchange_ctx,
-                                          ANJ_EXCHANGE_EVENT_SEND_CONFIRMATION,
-                                          &msg);
+            exchange_state = downloader_exchange_process(
+                    ctx, ANJ_EXCHANGE_EVENT_SEND_CONFIRMATION, &msg);
         }
 
         if (exchange_state == ANJ_EXCHANGE_STATE_WAITING_MSG) {
+            if (msgs_routed(ctx)) {
+                // messages are passed to routed_msg_handle(), only timeouts
+                // are checked here
+                exchange_state =
+                        downloader_exchange_process(ctx,
+                                                    ANJ_EXCHANGE_EVENT_NONE,
+                                                    &msg);
+                if (exchange_state == ANJ_EXCHANGE_STATE_WAITING_MSG) {
+                    return ANJ_NET_EAGAIN;
+                }
+                continue;
+            }
             size_t msg_size;
             result = _anj_srv_conn_receive(&ctx->connection_ctx,
                                            ctx->msg_buffer, &msg_size,
@@ -236,8 +1293,9 @@ static int handle_request(anj_coap_downloader_t *ctx) {
                 // check for receive timeout, if occurred, it will be set in
                 // completion callback
                 exchange_state =
-                        _anj_exchange_process(&ctx->exchange_ctx,
-                                              ANJ_EXCHANGE_EVENT_NONE, &msg);
+                        downloader_exchange_process(ctx,
+                                                    ANJ_EXCHANGE_EVENT_NONE,
+                                                    &msg);
                 if (exchange_state == ANJ_EXCHANGE_STATE_WAITING_MSG) {
                     // we're still waiting for a message
                     return result;
@@ -250,26 +1308,10 @@ static int handle_request(anj_coap_downloader_t *ctx) {
                     downloader_log(L_ERROR, "Failed to decode CoAP message: %d",
                                    result);
                     return ANJ_COAP_DOWNLOADER_ERR_INTERNAL;
-                } else {
-                    if (msg.attr.downloader_attr.total_size != 0) {
-                        downloader_log(L_INFO,
-                                       "Total resource size: %" PRIu32 " bytes",
-                                       msg.attr.downloader_attr.total_size);
-                    }
-                    // check ETag mismatch only for responses that are not
-                    // error responses or reset messages
-                    if (msg.operation == ANJ_OP_RESPONSE
-                            && msg.msg_code < ANJ_COAP_CODE_BAD_REQUEST
-                            && check_etag_mismatch(
-                                       &ctx->etag,
-                                       &msg.attr.downloader_attr.etag)) {
-                        downloader_log(L_ERROR, "ETag mismatch");
-                        return ANJ_COAP_DOWNLOADER_ERR_ETAG_MISMATCH;
-                    }
-                    exchange_state =
-                            _anj_exchange_process(&ctx->exchange_ctx,
-                                                  ANJ_EXCHANGE_EVENT_NEW_MSG,
-                                                  &msg);
+                }
+                result = process_new_msg(ctx, &msg, &exchange_state);
+                if (result) {
+                    return result;
                 }
             }
         }
@@ -295,18 +1337,47 @@ void anj_coap_downloader_step(anj_coap_downloader_t *ctx) {
     switch (ctx->status) {
     case ANJ_COAP_DOWNLOADER_STATUS_STARTING: {
         handle_event_cb(ctx, ANJ_COAP_DOWNLOADER_STATUS_STARTING);
-        int result = connect_with_server(ctx);
-        if (anj_net_is_inprogress(result)) {
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
+        if (ctx->mux_owner && mux_owner_connecting(ctx)) {
             break;
         }
-        if (!anj_net_is_ok(result)) {
-            ctx->status = ANJ_COAP_DOWNLOADER_STATUS_FINISHING;
-            ctx->error_code = ANJ_COAP_DOWNLOADER_ERR_NETWORK;
-            downloader_log(L_ERROR, "Failed to connect to server: %d", result);
+        if (ctx->mux_owner) {
+            mux_sync(ctx);
+            downloader_log(L_DEBUG, "Multiplexing over existing connection");
+        } else
+#    endif // ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+        // don't switch to the shared connection if own one is being set up
+        if (!ctx->connection_ctx.net_ctx && shared_connection_matches(ctx)) {
+            ctx->shared_connection = true;
+            ctx->anj->shared_downloader = ctx;
+            shared_connection_sync(ctx);
+            downloader_log(L_DEBUG, "Using LwM2M Server connection");
+        } else
+#    endif // ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+        {
+            int result = connect_with_server(ctx);
+            if (anj_net_is_inprogress(result)) {
+                break;
+            }
+            if (!anj_net_is_ok(result)) {
+                ctx->status = ANJ_COAP_DOWNLOADER_STATUS_FINISHING;
+                ctx->error_code = ANJ_COAP_DOWNLOADER_ERR_NETWORK;
+                downloader_log(L_ERROR, "Failed to connect to server: %d",
+                               result);
+                break;
+            }
+            downloader_log(L_DEBUG, "Connected to server");
+        }
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW
+        if (window_enabled(ctx)) {
+            // requests are sent by window_process()
+            window_start(ctx);
+            ctx->status = ANJ_COAP_DOWNLOADER_STATUS_DOWNLOADING;
             break;
         }
-        downloader_log(L_DEBUG, "Connected to server");
-        result = start_new_exchange(ctx);
+#    endif // ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW
+        int result = start_new_exchange(ctx);
         if (result) {
             ctx->status = ANJ_COAP_DOWNLOADER_STATUS_FINISHING;
             ctx->error_code = result;
@@ -333,7 +1404,26 @@ void anj_coap_downloader_step(anj_coap_downloader_t *ctx) {
     }
     case ANJ_COAP_DOWNLOADER_STATUS_FINISHING: {
         handle_event_cb(ctx, ANJ_COAP_DOWNLOADER_STATUS_FINISHING);
-        int result = _anj_srv_conn_close(&ctx->connection_ctx, true);
+        int result = 0;
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
+        if (ctx->mux_transfers) {
+            // connection is still used by the attached transfers
+            break;
+        }
+        if (ctx->mux_owner) {
+            // the socket is owned by another downloader
+            mux_detach(ctx);
+        } else
+#    endif // ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+        if (ctx->shared_connection) {
+            // the socket is owned by the LwM2M Server connection
+            shared_connection_detach(ctx);
+        } else
+#    endif // ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+        {
+            result = _anj_srv_conn_close(&ctx->connection_ctx, true);
+        }
         if (anj_net_is_inprogress(result)) {
             break;
         }
@@ -342,6 +1432,13 @@ void anj_coap_downloader_step(anj_coap_downloader_t *ctx) {
             ctx->error_code = ANJ_COAP_DOWNLOADER_ERR_NETWORK;
             downloader_log(L_ERROR, "Socket closed with error: %d", result);
         }
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_RESUME
+        // nothing left to resume, or stored ETag is no longer valid
+        if (!ctx->error_code
+                || ctx->error_code == ANJ_COAP_DOWNLOADER_ERR_ETAG_MISMATCH) {
+            progress_reset(ctx);
+        }
+#    endif // ANJ_COAP_DOWNLOADER_WITH_RESUME
         if (ctx->error_code) {
             ctx->status = ANJ_COAP_DOWNLOADER_STATUS_FAILED;
         } else {
@@ -354,6 +1451,25 @@ void anj_coap_downloader_step(anj_coap_downloader_t *ctx) {
         handle_event_cb(ctx, ctx->status);
         break;
     }
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
+    mux_step_transfers(ctx);
+#    endif // ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
+}
+
+anj_time_duration_t
+anj_coap_downloader_next_step_time(anj_coap_downloader_t *ctx) {
+    assert(ctx);
+    switch (ctx->status) {
+    case ANJ_COAP_DOWNLOADER_STATUS_STARTING:
+    case ANJ_COAP_DOWNLOADER_STATUS_DOWNLOADING:
+    case ANJ_COAP_DOWNLOADER_STATUS_FINISHING:
+        return ANJ_TIME_DURATION_ZERO;
+    default:
+        // final status is reported to the event callback in the next step
+        return ctx->last_reported_status != ctx->status
+                       ? ANJ_TIME_DURATION_ZERO
+                       : ANJ_TIME_DURATION_INVALID;
+    }
 }
 
 int anj_coap_downloader_init(
@@ -372,6 +1488,19 @@ int anj_coap_downloader_init(
     }
     ctx->event_cb = config->event_cb;
     ctx->event_cb_arg = config->event_cb_arg;
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+    ctx->anj = config->anj;
+#    endif // ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
+    ctx->multiplex_with = config->multiplex_with;
+#    endif // ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW
+    ctx->window.size = (uint8_t) ANJ_MIN(config->block_window,
+                                         ANJ_COAP_DOWNLOADER_BLOCK_WINDOW_SIZE);
+#        ifdef ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+    ctx->window.q_block2_enabled = config->q_block2;
+#        endif // ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+#    endif // ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW
 
     if (_anj_exchange_init(&ctx->exchange_ctx)) {
         return ANJ_COAP_DOWNLOADER_ERR_INTERNAL;
@@ -429,6 +1558,12 @@ int anj_coap_downloader_start(anj_coap_downloader_t *ctx,
     ctx->error_code = 0;
     ctx->status = ANJ_COAP_DOWNLOADER_STATUS_STARTING;
     ctx->etag.size = 0;
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_RESUME
+    progress_prepare(ctx, uri);
+#    endif // ANJ_COAP_DOWNLOADER_WITH_RESUME
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
+    mux_attach(ctx);
+#    endif // ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
     return 0;
 }
 
@@ -446,4 +1581,79 @@ void anj_coap_downloader_terminate(anj_coap_downloader_t *ctx) {
     _anj_exchange_terminate(&ctx->exchange_ctx, _ANJ_EXCHANGE_ERROR_TERMINATED);
 }
 
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_RESUME
+static const uint8_t g_persistence_header[] = { 'C', 'D', 'L',
+                                                0x01 }; // version
+
+static int progress_persistence(anj_coap_downloader_t *ctx,
+                                const anj_persistence_context_t *persistence) {
+    _anj_coap_downloader_progress_t *progress = &ctx->progress;
+    if (anj_persistence_magic(persistence, g_persistence_header,
+                              sizeof(g_persistence_header))
+            || anj_persistence_string(persistence, progress->uri,
+                                      sizeof(progress->uri))
+            || anj_persistence_u8(persistence, &progress->etag.size)
+            || progress->etag.size > sizeof(progress->etag.bytes)
+            || anj_persistence_bytes(persistence, progress->etag.bytes,
+                                     progress->etag.size)
+            || anj_persistence_u32(persistence, &progress->next_block)
+            || anj_persistence_u16(persistence, &progress->block_size)) {
+        return -1;
+    }
+    return 0;
+}
+
+int anj_coap_downloader_progress_store(
+        anj_coap_downloader_t *ctx,
+        const anj_persistence_context_t *persistence_ctx) {
+    assert(ctx && persistence_ctx);
+    assert(anj_persistence_direction(persistence_ctx)
+           == ANJ_PERSISTENCE_STORE);
+
+    if (progress_persistence(ctx, persistence_ctx)) {
+        downloader_log(L_ERROR, "Failed to store download progress");
+        return -1;
+    }
+    return 0;
+}
+
+int anj_coap_downloader_progress_restore(
+        anj_coap_downloader_t *ctx,
+        const anj_persistence_context_t *persistence_ctx) {
+    assert(ctx && persistence_ctx);
+    assert(anj_persistence_direction(persistence_ctx)
+           == ANJ_PERSISTENCE_RESTORE);
+
+    if (ctx->status == ANJ_COAP_DOWNLOADER_STATUS_STARTING
+            || ctx->status == ANJ_COAP_DOWNLOADER_STATUS_DOWNLOADING
+            || ctx->status == ANJ_COAP_DOWNLOADER_STATUS_FINISHING) {
+        downloader_log(L_ERROR, "Download in progress");
+        return ANJ_COAP_DOWNLOADER_ERR_IN_PROGRESS;
+    }
+    if (progress_persistence(ctx, persistence_ctx)) {
+        progress_reset(ctx);
+        downloader_log(L_ERROR, "Failed to restore download progress");
+        return -1;
+    }
+    downloader_log(L_INFO, "Download progress restored");
+    return 0;
+}
+
+size_t anj_coap_downloader_get_resume_offset(anj_coap_downloader_t *ctx) {
+    assert(ctx);
+    return (size_t) ctx->first_block * ctx->first_block_size;
+}
+#    endif // ANJ_COAP_DOWNLOADER_WITH_RESUME
+
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+bool _anj_coap_downloader_shared_handle_msg(anj_t *anj, _anj_coap_msg_t *msg) {
+    assert(anj && msg);
+    anj_coap_downloader_t *ctx = anj->shared_downloader;
+    if (!ctx) {
+        return false;
+    }
+    return routed_msg_handle(ctx, msg);
+}
+#    endif // ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+
 #endif // ANJ_WITH_COAP_DOWNLOADER
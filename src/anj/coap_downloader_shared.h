@@ -0,0 +1,38 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#ifndef ANJ_SRC_COAP_DOWNLOADER_SHARED_H
+#    define ANJ_SRC_COAP_DOWNLOADER_SHARED_H
+
+#    include <stdbool.h>
+
+#    include <anj/defs.h>
+
+#    include "coap/coap.h"
+
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+
+/**
+ * Passes a message received on the LwM2M Server connection to the CoAP
+ * downloader that shares this connection. Must be called for every decoded
+ * message before it is processed by the core.
+ *
+ * @param anj Anjay object the message was received by.
+ * @param msg Decoded message.
+ *
+ * @returns true if the message is a response to the downloader request and was
+ *          consumed by it, false if it should be handled by the core.
+ */
+bool _anj_coap_downloader_shared_handle_msg(anj_t *anj, _anj_coap_msg_t *msg);
+
+#    endif // ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+
+#endif // ANJ_SRC_COAP_DOWNLOADER_SHARED_H
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#define ANJ_LOG_SOURCE_FILE_ID 72
+
+#include <stddef.h> // IWYU pragma: keep
+#include <stdint.h> // IWYU pragma: keep
+
+#if defined(ANJ_WITH_MBEDTLS) && defined(ANJ_WITH_OSCORE)
+
+#    include <anj/compat/crypto/aes_ccm.h>
+#    include <anj/log.h>
+
+#    include <mbedtls/ccm.h>
+
+#    define mbedtls_log(level, ...) anj_log(mbedtls, level, __VA_ARGS__)
+
+static int setup_ccm(mbedtls_ccm_context *ccm,
+                     const uint8_t *key,
+                     size_t key_len) {
+    mbedtls_ccm_init(ccm);
+    int res = mbedtls_ccm_setkey(ccm, MBEDTLS_CIPHER_ID_AES, key,
+                                 (unsigned int) (key_len * 8));
+    if (res) {
+        mbedtls_log(L_ERROR, "mbedtls_ccm_setkey() failed: %d", res);
+        mbedtls_ccm_free(ccm);
+    }
+    return res;
+}
+
+int anj_crypto_aes_ccm_encrypt(const uint8_t *key,
+                               size_t key_len,
+                               const uint8_t *nonce,
+                               size_t nonce_len,
+                               const uint8_t *aad,
+                               size_t aad_len,
+                               uint8_t *data,
+                               size_t data_len,
+                               uint8_t *tag,
+                               size_t tag_len) {
+    mbedtls_ccm_context ccm;
+    int res = setup_ccm(&ccm, key, key_len);
+    if (res) {
+        return res;
+    }
+    res = mbedtls_ccm_encrypt_and_tag(&ccm, data_len, nonce, nonce_len, aad,
+                                      aad_len, data, data, tag, tag_len);
+    if (res) {
+        mbedtls_log(L_ERROR, "mbedtls_ccm_encrypt_and_tag() failed: %d", res);
+    }
+    mbedtls_ccm_free(&ccm);
+    return res;
+}
+
+int anj_crypto_aes_ccm_decrypt(const uint8_t *key,
+                               size_t key_len,
+                               const uint8_t *nonce,
+                               size_t nonce_len,
+                               const uint8_t *aad,
+                               size_t aad_len,
+                               uint8_t *data,
+                               size_t data_len,
+                               const uint8_t *tag,
+                               size_t tag_len) {
+    mbedtls_ccm_context ccm;
+    int res = setup_ccm(&ccm, key, key_len);
+    if (res) {
+        return res;
+    }
+    res = mbedtls_ccm_auth_decrypt(&ccm, data_len, nonce, nonce_len, aad,
+                                   aad_len, data, data, tag, tag_len);
+    if (res) {
+        mbedtls_log(L_DEBUG, "mbedtls_ccm_auth_decrypt() failed: %d", res);
+    }
+    mbedtls_ccm_free(&ccm);
+    return res;
+}
+
+#endif // ANJ_WITH_MBEDTLS && ANJ_WITH_OSCORE
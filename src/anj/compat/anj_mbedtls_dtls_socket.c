@@ -24,25 +24,87 @@
 
 #    include <anj/compat/net/anj_dtls.h>
 #    include <anj/compat/net/anj_net_api.h>
+// the underlying UDP socket is used directly, also from the I/O thread
+#    define ANJ_NET_WRAPPER_WITHOUT_IO_THREAD
 #    include <anj/compat/net/anj_net_wrapper.h>
 #    include <anj/compat/rng.h>
 #    include <anj/crypto.h>
 #    include <anj/log.h>
+#    include <anj/utils.h>
+
+#    ifdef ANJ_MBEDTLS_WITH_HANDSHAKE_METRICS
+#        include <inttypes.h>
+
+#        include <anj/compat/time.h>
+#        include <anj/time.h>
+#    endif // ANJ_MBEDTLS_WITH_HANDSHAKE_METRICS
 
 #    include <mbedtls/entropy.h>
 #    include <mbedtls/error.h>
 #    include <mbedtls/net_sockets.h>
+#    include <mbedtls/platform_util.h>
 #    include <mbedtls/ssl.h>
 #    include <mbedtls/timing.h>
 
+#    ifdef ANJ_WITH_RAW_PUBLIC_KEY
+#        include <mbedtls/md.h>
+#        include <mbedtls/pk.h>
+#        include <mbedtls/x509_crt.h>
+#        if !defined(MBEDTLS_X509_CRT_WRITE_C) || !defined(MBEDTLS_PK_WRITE_C)
+#            error "ANJ_WITH_RAW_PUBLIC_KEY requires MBEDTLS_X509_CRT_WRITE_C and MBEDTLS_PK_WRITE_C"
+#        endif // !MBEDTLS_X509_CRT_WRITE_C || !MBEDTLS_PK_WRITE_C
+#    endif     // ANJ_WITH_RAW_PUBLIC_KEY
+
+#    ifdef ANJ_MBEDTLS_WITH_STATIC_POOL
+#        include <mbedtls/memory_buffer_alloc.h>
+#        if !defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C) \
+                || !defined(MBEDTLS_MEMORY_DEBUG)
+#            error "ANJ_MBEDTLS_WITH_STATIC_POOL requires MBEDTLS_MEMORY_BUFFER_ALLOC_C and MBEDTLS_MEMORY_DEBUG"
+#        endif // !MBEDTLS_MEMORY_BUFFER_ALLOC_C || !MBEDTLS_MEMORY_DEBUG
+#    endif     // ANJ_MBEDTLS_WITH_STATIC_POOL
+
 #    define mbedtls_log(level, ...) anj_log(mbedtls, level, __VA_ARGS__)
 
 typedef enum {
     SOCKET_STATE_INITIAL,
+#    ifdef ANJ_WITH_ASYNC_CRYPTO_STORAGE
+    SOCKET_STATE_RESOLVING_CREDENTIALS,
+#    endif // ANJ_WITH_ASYNC_CRYPTO_STORAGE
     SOCKET_STATE_HANDSHAKE_IN_PROGRESS,
     SOCKET_STATE_HANDSHAKE_DONE,
 } state_machine_t;
 
+typedef struct {
+    char key[MBEDTLS_PSK_MAX_LEN];
+    size_t key_len;
+    char identity[ANJ_MBEDTLS_PSK_IDENTITY_MAX_LEN];
+    size_t identity_len;
+#    ifdef ANJ_WITH_ASYNC_CRYPTO_STORAGE
+    bool key_resolved;
+    bool identity_resolved;
+#    endif // ANJ_WITH_ASYNC_CRYPTO_STORAGE
+} psk_t;
+
+#    ifdef ANJ_WITH_RAW_PUBLIC_KEY
+typedef struct {
+    char public_key[ANJ_MBEDTLS_RPK_MAX_LEN];
+    size_t public_key_len;
+    char private_key[ANJ_MBEDTLS_RPK_MAX_LEN];
+    size_t private_key_len;
+#        ifdef ANJ_WITH_ASYNC_CRYPTO_STORAGE
+    // bit mask of the parts already resolved, in resolve_rpk() order
+    uint8_t resolved;
+#        endif // ANJ_WITH_ASYNC_CRYPTO_STORAGE
+} rpk_t;
+#    endif // ANJ_WITH_RAW_PUBLIC_KEY
+
+typedef union {
+    psk_t psk;
+#    ifdef ANJ_WITH_RAW_PUBLIC_KEY
+    rpk_t rpk;
+#    endif // ANJ_WITH_RAW_PUBLIC_KEY
+} credentials_t;
+
 typedef struct {
     mbedtls_ssl_context ssl_ctx;
     mbedtls_ssl_config ssl_conf;
@@ -56,8 +118,48 @@ typedef struct {
     int last_recv_err;
     int last_send_err;
     bool close_notify_sent;
+#    ifdef ANJ_WITH_ASYNC_CRYPTO_STORAGE
+    // credentials resolved so far, kept only until the SSL config is set up
+    credentials_t credentials;
+#    endif // ANJ_WITH_ASYNC_CRYPTO_STORAGE
+#    ifdef ANJ_WITH_RAW_PUBLIC_KEY
+    // MbedTLS refers to them for the whole connection
+    mbedtls_x509_crt own_cert;
+    mbedtls_pk_context own_key;
+    // compared with the key presented by the Server, see verify_server_key()
+    char server_public_key[ANJ_MBEDTLS_RPK_MAX_LEN];
+    size_t server_public_key_len;
+#    endif // ANJ_WITH_RAW_PUBLIC_KEY
+#    ifdef ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
+    // set by anj_dtls_session_restore(), used and freed in the next connect
+    uint8_t *saved_state;
+    uint32_t saved_state_size;
+    uint8_t saved_state_type;
+#    endif // ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
+#    ifdef ANJ_MBEDTLS_WITH_STATIC_POOL
+    // steady_state_peak is only updated when read, the peak of the pool
+    // counted since the end of the handshake is added then
+    anj_dtls_memory_usage_t memory_usage;
+#    endif // ANJ_MBEDTLS_WITH_STATIC_POOL
+#    ifdef ANJ_MBEDTLS_WITH_HANDSHAKE_METRICS
+    anj_dtls_handshake_metrics_t handshake_metrics;
+    anj_time_monotonic_t handshake_start;
+    // set when the final delay of the retransmission timer expires, so that
+    // a flight is counted as retransmitted only once
+    bool handshake_timer_expired;
+#    endif // ANJ_MBEDTLS_WITH_HANDSHAKE_METRICS
 } ssl_socket_t;
 
+#    ifdef ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
+// whole connection serialized with mbedtls_ssl_context_save()
+#        define SAVED_STATE_CONTEXT 1
+// only the session, serialized with mbedtls_ssl_session_save()
+#        define SAVED_STATE_SESSION 2
+
+static const uint8_t g_persistence_header[] = { 'D', 'T', 'L',
+                                                0x01 }; // version
+#    endif // ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
+
 static int
 _anj_mbedtls_rng(void *p_rng, unsigned char *output, size_t out_len) {
     (void) p_rng;
@@ -92,6 +194,12 @@ _anj_mbedtls_bio_send(void *ctx, const unsigned char *buf, size_t len) {
     } else if (ret != ANJ_NET_OK) {
         return MBEDTLS_ERR_NET_SEND_FAILED;
     }
+#    ifdef ANJ_MBEDTLS_WITH_HANDSHAKE_METRICS
+    if (s->sm_state == SOCKET_STATE_HANDSHAKE_IN_PROGRESS) {
+        s->handshake_metrics.datagrams_sent++;
+        s->handshake_metrics.bytes_sent += sent;
+    }
+#    endif // ANJ_MBEDTLS_WITH_HANDSHAKE_METRICS
     return (int) sent;
 }
 
@@ -110,19 +218,46 @@ static int _anj_mbedtls_bio_recv(void *ctx, unsigned char *buf, size_t len) {
     return (int) got;
 }
 
-static int load_psk(mbedtls_ssl_config *ssl_conf,
-                    anj_net_ssl_configuration_t *config) {
-    char psk_key_buff[MBEDTLS_PSK_MAX_LEN];
-    size_t psk_key_len;
-    char psk_identity_buff[ANJ_MBEDTLS_PSK_IDENTITY_MAX_LEN];
-    size_t psk_identity_len;
+static int resolve_part(anj_net_ssl_configuration_t *config,
+                        anj_crypto_security_info_t *info,
+                        const char *name,
+                        char *out_buff,
+                        size_t out_buff_size,
+                        size_t *out_len) {
+    if (info->source == ANJ_CRYPTO_DATA_SOURCE_BUFFER) {
+        if (info->info.buffer.data_size > out_buff_size) {
+            mbedtls_log(L_ERROR, "%s size exceeds maximum allowed size", name);
+            return -1;
+        }
+        memcpy(out_buff, info->info.buffer.data, info->info.buffer.data_size);
+        *out_len = info->info.buffer.data_size;
+        return 0;
+    }
+#    ifdef ANJ_WITH_EXTERNAL_CRYPTO_STORAGE
+    int res = anj_crypto_storage_resolve_security_info(
+            config->crypto_ctx, &info->info.external, out_buff, out_buff_size,
+            out_len);
+#        ifdef ANJ_WITH_ASYNC_CRYPTO_STORAGE
+    if (res == ANJ_CRYPTO_STORAGE_IN_PROGRESS) {
+        return res;
+    }
+#        endif // ANJ_WITH_ASYNC_CRYPTO_STORAGE
+    if (res) {
+        mbedtls_log(L_ERROR, "Failed to resolve %s: %d", name, res);
+        return -1;
+    }
+    return 0;
+#    else  // ANJ_WITH_EXTERNAL_CRYPTO_STORAGE
+    (void) config;
+    mbedtls_log(L_ERROR, "Such %s source is not supported", name);
+    return -1;
+#    endif // ANJ_WITH_EXTERNAL_CRYPTO_STORAGE
+}
 
+static int resolve_psk(anj_net_ssl_configuration_t *config, psk_t *psk) {
     anj_net_security_info_t *security = &config->security;
     anj_crypto_security_info_t *psk_key = &security->data.psk.key;
     anj_crypto_security_info_t *psk_identity = &security->data.psk.identity;
-#    ifdef ANJ_WITH_EXTERNAL_CRYPTO_STORAGE
-    void *crypto_ctx = config->crypto_ctx;
-#    endif // ANJ_WITH_EXTERNAL_CRYPTO_STORAGE
 
     if (psk_key->source == ANJ_CRYPTO_DATA_SOURCE_EMPTY
             || psk_identity->source == ANJ_CRYPTO_DATA_SOURCE_EMPTY) {
@@ -130,74 +265,436 @@ static int load_psk(mbedtls_ssl_config *ssl_conf,
         return -1;
     }
 
-    // get psk key
-    if (psk_key->source == ANJ_CRYPTO_DATA_SOURCE_BUFFER) {
-        if (psk_key->info.buffer.data_size > MBEDTLS_PSK_MAX_LEN) {
-            mbedtls_log(L_ERROR, "PSK key size exceeds maximum allowed size");
-            return -1;
+    int res;
+#    ifdef ANJ_WITH_ASYNC_CRYPTO_STORAGE
+    // a part resolved in one of the previous calls is not requested again
+    if (!psk->key_resolved) {
+        if ((res = resolve_part(config, psk_key, "PSK key", psk->key,
+                                sizeof(psk->key), &psk->key_len))) {
+            return res;
         }
-        memcpy(psk_key_buff, psk_key->info.buffer.data,
-               psk_key->info.buffer.data_size);
-        psk_key_len = psk_key->info.buffer.data_size;
-    } else {
-#    ifdef ANJ_WITH_EXTERNAL_CRYPTO_STORAGE
-        if (anj_crypto_storage_resolve_security_info(
-                    crypto_ctx, &psk_key->info.external, psk_key_buff,
-                    MBEDTLS_PSK_MAX_LEN, &psk_key_len)) {
-            return -1;
+        psk->key_resolved = true;
+    }
+    if (!psk->identity_resolved) {
+        if ((res = resolve_part(config, psk_identity, "PSK identity",
+                                psk->identity, sizeof(psk->identity),
+                                &psk->identity_len))) {
+            return res;
         }
-#    else  // ANJ_WITH_EXTERNAL_CRYPTO_STORAGE
-        mbedtls_log(L_ERROR, "Such PSK source is not supported");
+        psk->identity_resolved = true;
+    }
+#    else  // ANJ_WITH_ASYNC_CRYPTO_STORAGE
+    if ((res = resolve_part(config, psk_key, "PSK key", psk->key,
+                            sizeof(psk->key), &psk->key_len))
+            || (res = resolve_part(config, psk_identity, "PSK identity",
+                                   psk->identity, sizeof(psk->identity),
+                                   &psk->identity_len))) {
+        return res;
+    }
+#    endif // ANJ_WITH_ASYNC_CRYPTO_STORAGE
+    return 0;
+}
+
+static int load_psk(mbedtls_ssl_config *ssl_conf, const psk_t *psk) {
+    int res = mbedtls_ssl_conf_psk(ssl_conf, (const unsigned char *) psk->key,
+                                   psk->key_len,
+                                   (const unsigned char *) psk->identity,
+                                   psk->identity_len);
+    if (res) {
+        mbedtls_log(L_ERROR, "Failed to set psk identity with %d", res);
         return -1;
-#    endif // ANJ_WITH_EXTERNAL_CRYPTO_STORAGE
     }
 
-    if (psk_identity->source == ANJ_CRYPTO_DATA_SOURCE_BUFFER) {
-        if (psk_identity->info.buffer.data_size > MBEDTLS_PSK_MAX_LEN) {
-            mbedtls_log(L_ERROR,
-                        "PSK identity size exceeds maximum allowed size");
+    static const int psk_suites[] = { ANJ_MBEDTLS_ALLOWED_CIPHERSUITES, 0 };
+    mbedtls_ssl_conf_ciphersuites(ssl_conf, psk_suites);
+    return 0;
+}
+
+#    ifdef ANJ_WITH_RAW_PUBLIC_KEY
+static bool rpk_mode(const ssl_socket_t *secure_socket) {
+    return secure_socket->secure_config.security.mode == ANJ_NET_SECURITY_RPK;
+}
+
+static int resolve_rpk(ssl_socket_t *secure_socket, rpk_t *rpk) {
+    anj_net_rpk_info_t *info = &secure_socket->secure_config.security.data.rpk;
+    struct {
+        anj_crypto_security_info_t *info;
+        const char *name;
+        char *buff;
+        size_t *len;
+    } parts[] = {
+        { &info->public_key, "Public Key", rpk->public_key,
+          &rpk->public_key_len },
+        { &info->private_key, "Secret Key", rpk->private_key,
+          &rpk->private_key_len },
+        { &info->server_public_key, "Server Public Key",
+          secure_socket->server_public_key,
+          &secure_socket->server_public_key_len }
+    };
+
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(parts); i++) {
+        if (parts[i].info->source == ANJ_CRYPTO_DATA_SOURCE_EMPTY) {
+            mbedtls_log(L_ERROR, "%s is not set", parts[i].name);
             return -1;
         }
-        memcpy(psk_identity_buff, psk_identity->info.buffer.data,
-               psk_identity->info.buffer.data_size);
-        psk_identity_len = psk_identity->info.buffer.data_size;
-    } else {
-#    ifdef ANJ_WITH_EXTERNAL_CRYPTO_STORAGE
-        if (anj_crypto_storage_resolve_security_info(
-                    crypto_ctx, &psk_identity->info.external, psk_identity_buff,
-                    MBEDTLS_PSK_MAX_LEN, &psk_identity_len)) {
-            return -1;
+    }
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(parts); i++) {
+#        ifdef ANJ_WITH_ASYNC_CRYPTO_STORAGE
+        // a part resolved in one of the previous calls is not requested again
+        if (rpk->resolved & (1U << i)) {
+            continue;
         }
-#    else  // ANJ_WITH_EXTERNAL_CRYPTO_STORAGE
-        mbedtls_log(L_ERROR, "Such PSK source is not supported");
-        return -1;
-#    endif // ANJ_WITH_EXTERNAL_CRYPTO_STORAGE
+#        endif // ANJ_WITH_ASYNC_CRYPTO_STORAGE
+        int res = resolve_part(&secure_socket->secure_config, parts[i].info,
+                               parts[i].name, parts[i].buff,
+                               ANJ_MBEDTLS_RPK_MAX_LEN, parts[i].len);
+        if (res) {
+            return res;
+        }
+#        ifdef ANJ_WITH_ASYNC_CRYPTO_STORAGE
+        rpk->resolved |= (uint8_t) (1U << i);
+#        endif // ANJ_WITH_ASYNC_CRYPTO_STORAGE
+    }
+    return 0;
+}
+
+// No CA is configured, so instead of building and validating a chain, MbedTLS
+// only reports each received certificate here. The Server is trusted if every
+// certificate it presents carries exactly the SubjectPublicKeyInfo from the
+// Server Public Key Resource; validity period, names etc. are ignored.
+static int verify_server_key(void *ctx,
+                             mbedtls_x509_crt *crt,
+                             int depth,
+                             uint32_t *flags) {
+    ssl_socket_t *secure_socket = (ssl_socket_t *) ctx;
+    if (crt->pk_raw.len == secure_socket->server_public_key_len
+            && !memcmp(crt->pk_raw.p, secure_socket->server_public_key,
+                       crt->pk_raw.len)) {
+        *flags = 0;
+    } else {
+        mbedtls_log(L_ERROR, "Server public key does not match at depth %d",
+                    depth);
+        *flags = MBEDTLS_X509_BADCERT_NOT_TRUSTED;
     }
+    return 0;
+}
+
+// MbedTLS does not implement RFC 7250, so the client's key is sent in a
+// minimal self-signed certificate; the Server only looks at its key. The DER
+// form is written to der, MbedTLS keeps its own parsed copy.
+static int wrap_own_key(ssl_socket_t *secure_socket,
+                        unsigned char *der,
+                        size_t der_size) {
+    static const char name[] = "CN=Anjay Lite";
+    unsigned char serial[] = { 1 };
+    mbedtls_x509write_cert writer;
+    mbedtls_x509write_crt_init(&writer);
+    mbedtls_x509write_crt_set_version(&writer, MBEDTLS_X509_CRT_VERSION_3);
+    mbedtls_x509write_crt_set_md_alg(&writer, MBEDTLS_MD_SHA256);
+    mbedtls_x509write_crt_set_subject_key(&writer, &secure_socket->own_key);
+    mbedtls_x509write_crt_set_issuer_key(&writer, &secure_socket->own_key);
+
+    int res = -1;
+    if (mbedtls_x509write_crt_set_serial_raw(&writer, serial,
+                                                    sizeof(serial))
+            || mbedtls_x509write_crt_set_validity(&writer, "20000101000000",
+                                                  "99991231235959")
+            || mbedtls_x509write_crt_set_subject_name(&writer, name)
+            || mbedtls_x509write_crt_set_issuer_name(&writer, name)) {
+        goto finish;
+    }
+    // the certificate is written at the end of the buffer
+    res = mbedtls_x509write_crt_der(&writer, der, der_size, _anj_mbedtls_rng,
+                                    NULL);
+    if (res > 0) {
+        res = mbedtls_x509_crt_parse_der(&secure_socket->own_cert,
+                                         der + der_size - (size_t) res,
+                                         (size_t) res);
+    } else if (!res) {
+        res = -1;
+    }
+finish:
+    mbedtls_x509write_crt_free(&writer);
+    return res;
+}
 
-    int res = mbedtls_ssl_conf_psk(ssl_conf,
-                                   (const unsigned char *) psk_key_buff,
-                                   psk_key_len,
-                                   (const unsigned char *) psk_identity_buff,
-                                   psk_identity_len);
+static int load_rpk(ssl_socket_t *secure_socket, rpk_t *rpk) {
+    mbedtls_pk_context public_key;
+    mbedtls_pk_init(&public_key);
+    int res = mbedtls_pk_parse_public_key(
+            &public_key, (const unsigned char *) rpk->public_key,
+            rpk->public_key_len);
     if (res) {
-        mbedtls_log(L_ERROR, "Failed to set psk identity with %d", res);
+        mbedtls_pk_free(&public_key);
+        mbedtls_log(L_ERROR, "Failed to parse Public Key with %d", res);
+        return -1;
+    }
+    res = mbedtls_pk_parse_key(&secure_socket->own_key,
+                               (const unsigned char *) rpk->private_key,
+                               rpk->private_key_len, NULL, 0, _anj_mbedtls_rng,
+                               NULL);
+    if (res) {
+        mbedtls_pk_free(&public_key);
+        mbedtls_log(L_ERROR, "Failed to parse Secret Key with %d", res);
+        return -1;
+    }
+    res = mbedtls_pk_check_pair(&public_key, &secure_socket->own_key,
+                                _anj_mbedtls_rng, NULL);
+    mbedtls_pk_free(&public_key);
+    if (res) {
+        mbedtls_log(L_ERROR, "Public Key does not match Secret Key");
+        return -1;
+    }
+    // checked here, so that a malformed Resource is reported before the
+    // handshake instead of as a key mismatch
+    mbedtls_pk_context server_key;
+    mbedtls_pk_init(&server_key);
+    res = mbedtls_pk_parse_public_key(
+            &server_key,
+            (const unsigned char *) secure_socket->server_public_key,
+            secure_socket->server_public_key_len);
+    mbedtls_pk_free(&server_key);
+    if (res) {
+        mbedtls_log(L_ERROR, "Failed to parse Server Public Key with %d", res);
         return -1;
     }
+    // both keys are parsed already, the certificate is a bit larger than the
+    // key and its signature, so it fits in the space of the two
+    if ((res = wrap_own_key(secure_socket, (unsigned char *) rpk,
+                            sizeof(*rpk)))) {
+        mbedtls_log(L_ERROR, "Failed to wrap Public Key with %d", res);
+        return -1;
+    }
+    res = mbedtls_ssl_conf_own_cert(&secure_socket->ssl_conf,
+                                    &secure_socket->own_cert,
+                                    &secure_socket->own_key);
+    if (res) {
+        mbedtls_log(L_ERROR, "Failed to set own key with %d", res);
+        return -1;
+    }
+    // with REQUIRED, MbedTLS fails right away if no CA is configured; the
+    // verification result is checked after the handshake instead
+    mbedtls_ssl_conf_authmode(&secure_socket->ssl_conf,
+                              MBEDTLS_SSL_VERIFY_OPTIONAL);
+    mbedtls_ssl_conf_verify(&secure_socket->ssl_conf, verify_server_key,
+                            secure_socket);
 
-    static const int psk_suites[] = { ANJ_MBEDTLS_ALLOWED_CIPHERSUITES, 0 };
-    mbedtls_ssl_conf_ciphersuites(ssl_conf, psk_suites);
+    static const int rpk_suites[] = { ANJ_MBEDTLS_RPK_ALLOWED_CIPHERSUITES, 0 };
+    mbedtls_ssl_conf_ciphersuites(&secure_socket->ssl_conf, rpk_suites);
     return 0;
 }
+#    endif // ANJ_WITH_RAW_PUBLIC_KEY
+
+static int resolve_credentials(ssl_socket_t *secure_socket,
+                               credentials_t *credentials) {
+#    ifdef ANJ_WITH_RAW_PUBLIC_KEY
+    if (rpk_mode(secure_socket)) {
+        return resolve_rpk(secure_socket, &credentials->rpk);
+    }
+#    endif // ANJ_WITH_RAW_PUBLIC_KEY
+    return resolve_psk(&secure_socket->secure_config, &credentials->psk);
+}
+
+// credentials are overwritten, they are cleared after this call anyway
+static int load_credentials(ssl_socket_t *secure_socket,
+                            credentials_t *credentials) {
+#    ifdef ANJ_WITH_RAW_PUBLIC_KEY
+    if (rpk_mode(secure_socket)) {
+        return load_rpk(secure_socket, &credentials->rpk);
+    }
+#    endif // ANJ_WITH_RAW_PUBLIC_KEY
+    return load_psk(&secure_socket->ssl_conf, &credentials->psk);
+}
+
+#    if defined(ANJ_MBEDTLS_WITH_MAX_FRAGMENT_LENGTH) \
+            && defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+#        define MSG_BUFFER_MAX_SIZE                          \
+            (ANJ_IN_MSG_BUFFER_SIZE > ANJ_OUT_MSG_BUFFER_SIZE \
+                     ? ANJ_IN_MSG_BUFFER_SIZE                 \
+                     : ANJ_OUT_MSG_BUFFER_SIZE)
+// smallest record size that fits any message, MbedTLS I/O buffers don't need
+// to be larger than that
+#        if MSG_BUFFER_MAX_SIZE <= 512
+#            define MAX_FRAG_LEN_CODE MBEDTLS_SSL_MAX_FRAG_LEN_512
+#        elif MSG_BUFFER_MAX_SIZE <= 1024
+#            define MAX_FRAG_LEN_CODE MBEDTLS_SSL_MAX_FRAG_LEN_1024
+#        elif MSG_BUFFER_MAX_SIZE <= 2048
+#            define MAX_FRAG_LEN_CODE MBEDTLS_SSL_MAX_FRAG_LEN_2048
+#        elif MSG_BUFFER_MAX_SIZE <= 4096
+#            define MAX_FRAG_LEN_CODE MBEDTLS_SSL_MAX_FRAG_LEN_4096
+#        endif
+#    endif // defined(ANJ_MBEDTLS_WITH_MAX_FRAGMENT_LENGTH) &&
+           // defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
 
 static void internal_init(ssl_socket_t *secure_socket) {
     mbedtls_ssl_init(&secure_socket->ssl_ctx);
     mbedtls_ssl_config_init(&secure_socket->ssl_conf);
     secure_socket->sm_state = SOCKET_STATE_INITIAL;
+#    ifdef ANJ_WITH_ASYNC_CRYPTO_STORAGE
+    mbedtls_platform_zeroize(&secure_socket->credentials,
+                             sizeof(secure_socket->credentials));
+#    endif // ANJ_WITH_ASYNC_CRYPTO_STORAGE
+#    ifdef ANJ_WITH_RAW_PUBLIC_KEY
+    mbedtls_x509_crt_init(&secure_socket->own_cert);
+    mbedtls_pk_init(&secure_socket->own_key);
+    secure_socket->server_public_key_len = 0;
+#    endif // ANJ_WITH_RAW_PUBLIC_KEY
+#    ifdef ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
+    secure_socket->saved_state = NULL;
+    secure_socket->saved_state_size = 0;
+#    endif // ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
+}
+
+#    ifdef ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
+static void saved_state_free(ssl_socket_t *secure_socket) {
+    free(secure_socket->saved_state);
+    secure_socket->saved_state = NULL;
+    secure_socket->saved_state_size = 0;
 }
 
+// Applies the state restored with anj_dtls_session_restore(), must be called
+// right after mbedtls_ssl_setup(). Returns true if the whole connection was
+// restored and the handshake can be skipped. Any error is not fatal, in the
+// worst case a full handshake is performed.
+static bool saved_state_apply(ssl_socket_t *secure_socket) {
+    if (!secure_socket->saved_state) {
+        return false;
+    }
+    bool connection_restored = false;
+    int res;
+    if (secure_socket->saved_state_type == SAVED_STATE_CONTEXT) {
+#        ifdef MBEDTLS_SSL_CONTEXT_SERIALIZATION
+        res = mbedtls_ssl_context_load(&secure_socket->ssl_ctx,
+                                       secure_socket->saved_state,
+                                       secure_socket->saved_state_size);
+        if (!res) {
+            connection_restored = true;
+        } else {
+            mbedtls_log(L_WARNING, "Could not load DTLS context: %d", res);
+            // context is in an undefined state after a failed load
+            mbedtls_ssl_session_reset(&secure_socket->ssl_ctx);
+        }
+#        else  // MBEDTLS_SSL_CONTEXT_SERIALIZATION
+        mbedtls_log(L_WARNING, "DTLS context serialization not supported");
+#        endif // MBEDTLS_SSL_CONTEXT_SERIALIZATION
+    } else {
+        mbedtls_ssl_session session;
+        mbedtls_ssl_session_init(&session);
+        if ((res = mbedtls_ssl_session_load(&session,
+                                            secure_socket->saved_state,
+                                            secure_socket->saved_state_size))
+                || (res = mbedtls_ssl_set_session(&secure_socket->ssl_ctx,
+                                                  &session))) {
+            mbedtls_log(L_WARNING, "Could not load DTLS session: %d", res);
+        }
+        mbedtls_ssl_session_free(&session);
+    }
+    saved_state_free(secure_socket);
+    return connection_restored;
+}
+#    endif // ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
+
 static void internal_free(ssl_socket_t *secure_socket) {
     mbedtls_ssl_free(&secure_socket->ssl_ctx);
     mbedtls_ssl_config_free(&secure_socket->ssl_conf);
+#    ifdef ANJ_WITH_ASYNC_CRYPTO_STORAGE
+    mbedtls_platform_zeroize(&secure_socket->credentials,
+                             sizeof(secure_socket->credentials));
+#    endif // ANJ_WITH_ASYNC_CRYPTO_STORAGE
+#    ifdef ANJ_WITH_RAW_PUBLIC_KEY
+    mbedtls_x509_crt_free(&secure_socket->own_cert);
+    mbedtls_pk_free(&secure_socket->own_key);
+#    endif // ANJ_WITH_RAW_PUBLIC_KEY
+#    ifdef ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
+    saved_state_free(secure_socket);
+#    endif // ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
+}
+
+#    ifdef ANJ_MBEDTLS_WITH_STATIC_POOL
+static size_t pool_peak(void) {
+    size_t bytes;
+    size_t blocks;
+    mbedtls_memory_buffer_alloc_max_get(&bytes, &blocks);
+    return bytes;
+}
+
+static void pool_peak_handshake_start(ssl_socket_t *secure_socket) {
+    mbedtls_memory_buffer_alloc_max_reset();
+    secure_socket->memory_usage.handshake_peak = 0;
+    secure_socket->memory_usage.steady_state_peak = 0;
+}
+
+static void pool_peak_handshake_done(ssl_socket_t *secure_socket) {
+    secure_socket->memory_usage.handshake_peak = pool_peak();
+    mbedtls_memory_buffer_alloc_max_reset();
+    mbedtls_log(L_DEBUG, "Memory pool peak during handshake: %zu bytes",
+                secure_socket->memory_usage.handshake_peak);
+}
+#    endif // ANJ_MBEDTLS_WITH_STATIC_POOL
+
+#    ifdef ANJ_MBEDTLS_WITH_HANDSHAKE_METRICS
+static void handshake_metrics_start(ssl_socket_t *secure_socket) {
+    secure_socket->handshake_metrics = (anj_dtls_handshake_metrics_t) { 0 };
+    secure_socket->handshake_start = anj_time_monotonic_now();
+    secure_socket->handshake_timer_expired = false;
+}
+
+static void handshake_metrics_done(ssl_socket_t *secure_socket) {
+    anj_dtls_handshake_metrics_t *metrics = &secure_socket->handshake_metrics;
+    int64_t duration_ms = anj_time_duration_to_scalar(
+            anj_time_monotonic_diff(anj_time_monotonic_now(),
+                                    secure_socket->handshake_start),
+            ANJ_TIME_UNIT_MS);
+    metrics->duration_ms =
+            (uint32_t) ANJ_MIN(ANJ_MAX(duration_ms, 0), (int64_t) UINT32_MAX);
+    mbedtls_log(L_DEBUG,
+                "Handshake took %" PRIu32 " ms, %" PRIu32
+                " datagrams sent, %" PRIu32 " flights retransmitted",
+                metrics->duration_ms, metrics->datagrams_sent,
+                metrics->retransmissions);
+}
+
+// wrappers of the retransmission timer, which count the flights that
+// MbedTLS retransmits once the final delay expires
+static void handshake_timer_set_delay(void *data,
+                                      uint32_t int_ms,
+                                      uint32_t fin_ms) {
+    ssl_socket_t *secure_socket = (ssl_socket_t *) data;
+    secure_socket->handshake_timer_expired = false;
+    mbedtls_timing_set_delay(&secure_socket->timer, int_ms, fin_ms);
+}
+
+static int handshake_timer_get_delay(void *data) {
+    ssl_socket_t *secure_socket = (ssl_socket_t *) data;
+    int result = mbedtls_timing_get_delay(&secure_socket->timer);
+    if (result == 2 && !secure_socket->handshake_timer_expired
+            && secure_socket->sm_state == SOCKET_STATE_HANDSHAKE_IN_PROGRESS) {
+        secure_socket->handshake_timer_expired = true;
+        secure_socket->handshake_metrics.retransmissions++;
+    }
+    return result;
+}
+#    endif // ANJ_MBEDTLS_WITH_HANDSHAKE_METRICS
+
+// MbedTLS splits handshake messages into records that fit the MTU
+static void set_mtu(ssl_socket_t *secure_socket, bool handshake) {
+    int32_t mtu = 0;
+    if (!anj_net_is_ok(anj_net_get_inner_mtu(ANJ_NET_BINDING_UDP,
+                                             secure_socket->net, &mtu))
+            || mtu > UINT16_MAX) {
+        mtu = 0;
+    }
+#    ifdef ANJ_MBEDTLS_HS_MTU
+    // a lost IP fragment means a retransmission of the whole flight
+    if (handshake && (mtu <= 0 || mtu > ANJ_MBEDTLS_HS_MTU)) {
+        mtu = ANJ_MBEDTLS_HS_MTU;
+    }
+#    else  // ANJ_MBEDTLS_HS_MTU
+    (void) handshake;
+#    endif // ANJ_MBEDTLS_HS_MTU
+    // 0 means no limit
+    mbedtls_ssl_set_mtu(&secure_socket->ssl_ctx,
+                        (uint16_t) (mtu > 0 ? mtu : 0));
 }
 
 int anj_dtls_connect(anj_net_ctx_t *ctx_,
@@ -215,11 +712,42 @@ int anj_dtls_connect(anj_net_ctx_t *ctx_,
         } else if (!anj_net_is_ok(ret)) {
             return -1;
         }
+#    ifdef ANJ_MBEDTLS_WITH_STATIC_POOL
+        pool_peak_handshake_start(secure_socket);
+#    endif // ANJ_MBEDTLS_WITH_STATIC_POOL
+#    ifdef ANJ_MBEDTLS_WITH_HANDSHAKE_METRICS
+        handshake_metrics_start(secure_socket);
+#    endif // ANJ_MBEDTLS_WITH_HANDSHAKE_METRICS
+#    ifdef ANJ_WITH_ASYNC_CRYPTO_STORAGE
+        secure_socket->sm_state = SOCKET_STATE_RESOLVING_CREDENTIALS;
+#    endif // ANJ_WITH_ASYNC_CRYPTO_STORAGE
+    }
+        // fallthrough
+#    ifdef ANJ_WITH_ASYNC_CRYPTO_STORAGE
+    case SOCKET_STATE_RESOLVING_CREDENTIALS:
+#    endif // ANJ_WITH_ASYNC_CRYPTO_STORAGE
+    {
+#    ifdef ANJ_WITH_ASYNC_CRYPTO_STORAGE
+        credentials_t *credentials = &secure_socket->credentials;
+#    else  // ANJ_WITH_ASYNC_CRYPTO_STORAGE
+        credentials_t credentials_buff;
+        credentials_t *credentials = &credentials_buff;
+#    endif // ANJ_WITH_ASYNC_CRYPTO_STORAGE
+        int res = resolve_credentials(secure_socket, credentials);
+#    ifdef ANJ_WITH_ASYNC_CRYPTO_STORAGE
+        if (res == ANJ_CRYPTO_STORAGE_IN_PROGRESS) {
+            mbedtls_log(L_TRACE, "Credentials resolving in progress");
+            return ANJ_NET_EINPROGRESS;
+        }
+#    endif // ANJ_WITH_ASYNC_CRYPTO_STORAGE
+        if (res) {
+            goto reset_config_and_ctx;
+        }
 
-        int res = mbedtls_ssl_config_defaults(&secure_socket->ssl_conf,
-                                              MBEDTLS_SSL_IS_CLIENT,
-                                              MBEDTLS_SSL_TRANSPORT_DATAGRAM,
-                                              MBEDTLS_SSL_PRESET_DEFAULT);
+        res = mbedtls_ssl_config_defaults(&secure_socket->ssl_conf,
+                                          MBEDTLS_SSL_IS_CLIENT,
+                                          MBEDTLS_SSL_TRANSPORT_DATAGRAM,
+                                          MBEDTLS_SSL_PRESET_DEFAULT);
         if (res) {
             mbedtls_log(L_ERROR, "Failed to set SSL config defaults with %d",
                         res);
@@ -231,7 +759,10 @@ int anj_dtls_connect(anj_net_ctx_t *ctx_,
                                          ANJ_MBEDTLS_TLS_VERSION);
         mbedtls_ssl_conf_max_tls_version(&secure_socket->ssl_conf,
                                          ANJ_MBEDTLS_TLS_VERSION);
-        if (load_psk(&secure_socket->ssl_conf, &secure_socket->secure_config)) {
+        // MbedTLS keeps its own copy of the credentials
+        res = load_credentials(secure_socket, credentials);
+        mbedtls_platform_zeroize(credentials, sizeof(*credentials));
+        if (res) {
             goto reset_config_and_ctx;
         }
         mbedtls_ssl_conf_rng(&secure_socket->ssl_conf, _anj_mbedtls_rng, NULL);
@@ -240,6 +771,14 @@ int anj_dtls_connect(anj_net_ctx_t *ctx_,
                 &secure_socket->ssl_conf,
                 ANJ_MBEDTLS_HS_INITIAL_TIMEOUT_VALUE_MS,
                 ANJ_MBEDTLS_HS_MAXIMUM_TIMEOUT_VALUE_MS);
+#    ifdef MAX_FRAG_LEN_CODE
+        if ((res = mbedtls_ssl_conf_max_frag_len(&secure_socket->ssl_conf,
+                                                 MAX_FRAG_LEN_CODE))) {
+            mbedtls_log(L_ERROR, "mbedtls conf max frag len failed with %d",
+                        res);
+            goto reset_config_and_ctx;
+        }
+#    endif // MAX_FRAG_LEN_CODE
 #    if defined(MBEDTLS_SSL_DTLS_CONNECTION_ID)
         if ((res = mbedtls_ssl_conf_cid(&secure_socket->ssl_conf, 0,
                                         MBEDTLS_SSL_UNEXPECTED_CID_IGNORE))) {
@@ -253,6 +792,16 @@ int anj_dtls_connect(anj_net_ctx_t *ctx_,
             mbedtls_log(L_ERROR, "Failed to setup SSL context with %d", res);
             goto reset_config_and_ctx;
         }
+#    ifdef ANJ_WITH_RAW_PUBLIC_KEY
+        // the Server is identified by its key, not by the name in its
+        // certificate, this explicitly disables the name check
+        if (rpk_mode(secure_socket)
+                && (res = mbedtls_ssl_set_hostname(&secure_socket->ssl_ctx,
+                                                   NULL))) {
+            mbedtls_log(L_ERROR, "mbedtls set hostname failed with %d", res);
+            goto reset_config_and_ctx;
+        }
+#    endif // ANJ_WITH_RAW_PUBLIC_KEY
 #    if defined(MBEDTLS_SSL_DTLS_CONNECTION_ID)
         if ((res = mbedtls_ssl_set_cid(&secure_socket->ssl_ctx,
                                        MBEDTLS_SSL_CID_ENABLED, NULL, 0))) {
@@ -262,24 +811,47 @@ int anj_dtls_connect(anj_net_ctx_t *ctx_,
 #    endif // MBEDTLS_SSL_DTLS_CONNECTION_ID
         // integration may provide a custom implementation of
         // mbedtls_timing_set/get_delay
+#    ifdef ANJ_MBEDTLS_WITH_HANDSHAKE_METRICS
+        mbedtls_ssl_set_timer_cb(&secure_socket->ssl_ctx, secure_socket,
+                                 handshake_timer_set_delay,
+                                 handshake_timer_get_delay);
+#    else  // ANJ_MBEDTLS_WITH_HANDSHAKE_METRICS
         mbedtls_ssl_set_timer_cb(&secure_socket->ssl_ctx, &secure_socket->timer,
                                  mbedtls_timing_set_delay,
                                  mbedtls_timing_get_delay);
+#    endif // ANJ_MBEDTLS_WITH_HANDSHAKE_METRICS
         mbedtls_ssl_set_bio(&secure_socket->ssl_ctx, secure_socket,
                             _anj_mbedtls_bio_send, _anj_mbedtls_bio_recv, NULL);
         secure_socket->sm_state = SOCKET_STATE_HANDSHAKE_IN_PROGRESS;
 
-        int32_t mtu = 0;
-        if (anj_net_is_ok(anj_net_get_inner_mtu(ANJ_NET_BINDING_UDP,
-                                                secure_socket->net, &mtu))
-                && mtu > 0 && mtu <= UINT16_MAX) {
-            mbedtls_ssl_set_mtu(&secure_socket->ssl_ctx, (uint16_t) mtu);
+        set_mtu(secure_socket, true);
+        // small records of a flight, e.g. ClientKeyExchange,
+        // ChangeCipherSpec and Finished, share datagrams up to the MTU
+        mbedtls_ssl_set_datagram_packing(&secure_socket->ssl_ctx, 1);
+#    ifdef ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
+        if (saved_state_apply(secure_socket)) {
+            // keys, epoch, record sequence numbers and CID are restored, the
+            // server accepts records without a new handshake
+            mbedtls_log(L_INFO, "DTLS connection resumed without handshake");
+#        ifdef ANJ_MBEDTLS_HS_MTU
+            set_mtu(secure_socket, false);
+#        endif // ANJ_MBEDTLS_HS_MTU
+#        ifdef ANJ_MBEDTLS_WITH_STATIC_POOL
+            pool_peak_handshake_done(secure_socket);
+#        endif // ANJ_MBEDTLS_WITH_STATIC_POOL
+            secure_socket->state = ANJ_NET_SOCKET_STATE_CONNECTED;
+            secure_socket->sm_state = SOCKET_STATE_HANDSHAKE_DONE;
+            return ANJ_NET_OK;
         }
+#    endif // ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
     }
         // fallthrough
     case SOCKET_STATE_HANDSHAKE_IN_PROGRESS: {
         int result = mbedtls_ssl_handshake(&secure_socket->ssl_ctx);
-        if (is_retry_result(result)) {
+        // CRYPTO_IN_PROGRESS is reported by restartable ECC operations, e.g.
+        // when mbedtls_ecp_set_max_ops() limits the work done in one call
+        if (is_retry_result(result)
+                || result == MBEDTLS_ERR_SSL_CRYPTO_IN_PROGRESS) {
             mbedtls_log(L_TRACE, "Handshake in progress");
             return ANJ_NET_EINPROGRESS;
         }
@@ -292,6 +864,16 @@ int anj_dtls_connect(anj_net_ctx_t *ctx_,
 #    endif // MBEDTLS_ERROR_C
             goto reset_config_and_ctx;
         }
+#    ifdef ANJ_WITH_RAW_PUBLIC_KEY
+        if (rpk_mode(secure_socket)
+                && mbedtls_ssl_get_verify_result(&secure_socket->ssl_ctx)) {
+            mbedtls_log(L_ERROR, "Server not authenticated with its key");
+            mbedtls_ssl_send_alert_message(&secure_socket->ssl_ctx,
+                                           MBEDTLS_SSL_ALERT_LEVEL_FATAL,
+                                           MBEDTLS_SSL_ALERT_MSG_BAD_CERT);
+            goto reset_config_and_ctx;
+        }
+#    endif // ANJ_WITH_RAW_PUBLIC_KEY
         mbedtls_log(L_INFO, "DTLS handshake completed successfully");
         mbedtls_log(L_DEBUG, "Negotiated DTLS ciphersuite: %s",
                     mbedtls_ssl_get_ciphersuite(&secure_socket->ssl_ctx));
@@ -310,6 +892,16 @@ int anj_dtls_connect(anj_net_ctx_t *ctx_,
             mbedtls_log(L_INFO, "negotiated CID = %s", peer_cid_hex);
         }
 #    endif // MBEDTLS_SSL_DTLS_CONNECTION_ID
+#    ifdef ANJ_MBEDTLS_WITH_STATIC_POOL
+        pool_peak_handshake_done(secure_socket);
+#    endif // ANJ_MBEDTLS_WITH_STATIC_POOL
+#    ifdef ANJ_MBEDTLS_WITH_HANDSHAKE_METRICS
+        handshake_metrics_done(secure_socket);
+#    endif // ANJ_MBEDTLS_WITH_HANDSHAKE_METRICS
+#    ifdef ANJ_MBEDTLS_HS_MTU
+        // messages are sized to the reported MTU, see anj_dtls_get_inner_mtu()
+        set_mtu(secure_socket, false);
+#    endif // ANJ_MBEDTLS_HS_MTU
         secure_socket->state = ANJ_NET_SOCKET_STATE_CONNECTED;
         secure_socket->sm_state = SOCKET_STATE_HANDSHAKE_DONE;
         return ANJ_NET_OK;
@@ -363,6 +955,12 @@ int anj_dtls_create_ctx(anj_net_ctx_t **ctx_, const anj_net_config_t *config) {
 
     internal_init(secure_socket);
     secure_socket->state = ANJ_NET_SOCKET_STATE_CLOSED;
+#    ifdef ANJ_MBEDTLS_WITH_STATIC_POOL
+    secure_socket->memory_usage = (anj_dtls_memory_usage_t) { 0 };
+#    endif // ANJ_MBEDTLS_WITH_STATIC_POOL
+#    ifdef ANJ_MBEDTLS_WITH_HANDSHAKE_METRICS
+    secure_socket->handshake_metrics = (anj_dtls_handshake_metrics_t) { 0 };
+#    endif // ANJ_MBEDTLS_WITH_HANDSHAKE_METRICS
 
     *ctx_ = (anj_net_ctx_t *) secure_socket;
     return ANJ_NET_OK;
@@ -495,10 +1093,204 @@ int anj_dtls_get_state(anj_net_ctx_t *ctx_, anj_net_socket_state_t *out_value) {
     return ANJ_NET_OK;
 }
 
+#    ifdef ANJ_MBEDTLS_WITH_STATIC_POOL
+void anj_dtls_memory_pool_init(uint8_t *pool, size_t size) {
+    assert(pool && size);
+    mbedtls_memory_buffer_alloc_init(pool, size);
+}
+
+int anj_dtls_get_memory_usage(anj_net_ctx_t *ctx_,
+                              anj_dtls_memory_usage_t *out_usage) {
+    assert(ctx_ && out_usage);
+    ssl_socket_t *secure_socket = (ssl_socket_t *) ctx_;
+    if (secure_socket->sm_state == SOCKET_STATE_HANDSHAKE_DONE) {
+        secure_socket->memory_usage.steady_state_peak =
+                ANJ_MAX(secure_socket->memory_usage.steady_state_peak,
+                        pool_peak());
+    }
+    size_t blocks;
+    mbedtls_memory_buffer_alloc_cur_get(&secure_socket->memory_usage.current,
+                                        &blocks);
+    *out_usage = secure_socket->memory_usage;
+    return ANJ_NET_OK;
+}
+#    endif // ANJ_MBEDTLS_WITH_STATIC_POOL
+
+#    ifdef ANJ_MBEDTLS_WITH_HANDSHAKE_METRICS
+int anj_dtls_get_handshake_metrics(anj_net_ctx_t *ctx_,
+                                   anj_dtls_handshake_metrics_t *out_metrics) {
+    assert(ctx_ && out_metrics);
+    ssl_socket_t *secure_socket = (ssl_socket_t *) ctx_;
+    *out_metrics = secure_socket->handshake_metrics;
+    return ANJ_NET_OK;
+}
+#    endif // ANJ_MBEDTLS_WITH_HANDSHAKE_METRICS
+
 int anj_dtls_queue_mode_rx_off(anj_net_ctx_t *ctx_) {
     assert(ctx_);
     ssl_socket_t *secure_socket = (ssl_socket_t *) ctx_;
     return anj_net_queue_mode_rx_off(ANJ_NET_BINDING_UDP, secure_socket->net);
 }
 
+#    ifdef ANJ_NET_WITH_RELEASE_ASSISTANCE
+int anj_dtls_release_assistance(anj_net_ctx_t *ctx_,
+                                anj_net_release_hint_t hint) {
+    assert(ctx_);
+    ssl_socket_t *secure_socket = (ssl_socket_t *) ctx_;
+    // each record is sent in a separate datagram, so the hint holds
+    return anj_net_release_assistance(ANJ_NET_BINDING_UDP, secure_socket->net,
+                                      hint);
+}
+#    endif // ANJ_NET_WITH_RELEASE_ASSISTANCE
+
+#    ifdef ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
+static int saved_state_persistence(ssl_socket_t *secure_socket,
+                                   const anj_persistence_context_t *ctx) {
+    if (anj_persistence_magic(ctx, g_persistence_header,
+                              sizeof(g_persistence_header))
+            || anj_persistence_u8(ctx, &secure_socket->saved_state_type)
+            || anj_persistence_u32(ctx, &secure_socket->saved_state_size)) {
+        return -1;
+    }
+    if (anj_persistence_direction(ctx) == ANJ_PERSISTENCE_RESTORE) {
+        if ((secure_socket->saved_state_type != SAVED_STATE_CONTEXT
+             && secure_socket->saved_state_type != SAVED_STATE_SESSION)
+                || secure_socket->saved_state_size == 0
+                || secure_socket->saved_state_size > UINT16_MAX
+                || !(secure_socket->saved_state = (uint8_t *) malloc(
+                             secure_socket->saved_state_size))) {
+            return -1;
+        }
+    }
+    return anj_persistence_bytes(ctx, secure_socket->saved_state,
+                                 secure_socket->saved_state_size);
+}
+
+// mbedtls_ssl_context_save() and mbedtls_ssl_session_save() report the
+// required buffer size if called with an empty buffer
+static int serialize_context(ssl_socket_t *secure_socket) {
+#        ifdef MBEDTLS_SSL_CONTEXT_SERIALIZATION
+    size_t size = 0;
+    int res = mbedtls_ssl_context_save(&secure_socket->ssl_ctx, NULL, 0, &size);
+    if (res != MBEDTLS_ERR_SSL_BUFFER_TOO_SMALL || size > UINT16_MAX
+            || !(secure_socket->saved_state = (uint8_t *) malloc(size))) {
+        return -1;
+    }
+    if ((res = mbedtls_ssl_context_save(&secure_socket->ssl_ctx,
+                                        secure_socket->saved_state, size,
+                                        &size))) {
+        mbedtls_log(L_ERROR, "Could not save DTLS context: %d", res);
+        saved_state_free(secure_socket);
+        return -1;
+    }
+    secure_socket->saved_state_type = SAVED_STATE_CONTEXT;
+    secure_socket->saved_state_size = (uint32_t) size;
+    return 0;
+#        else  // MBEDTLS_SSL_CONTEXT_SERIALIZATION
+    (void) secure_socket;
+    return -1;
+#        endif // MBEDTLS_SSL_CONTEXT_SERIALIZATION
+}
+
+static int serialize_session(ssl_socket_t *secure_socket) {
+    mbedtls_ssl_session session;
+    mbedtls_ssl_session_init(&session);
+    size_t size = 0;
+    int res = mbedtls_ssl_get_session(&secure_socket->ssl_ctx, &session);
+    if (!res) {
+        res = mbedtls_ssl_session_save(&session, NULL, 0, &size);
+        if (res == MBEDTLS_ERR_SSL_BUFFER_TOO_SMALL && size <= UINT16_MAX
+                && (secure_socket->saved_state = (uint8_t *) malloc(size))) {
+            res = mbedtls_ssl_session_save(&session, secure_socket->saved_state,
+                                           size, &size);
+        } else {
+            res = -1;
+        }
+    }
+    mbedtls_ssl_session_free(&session);
+    if (res) {
+        mbedtls_log(L_ERROR, "Could not save DTLS session: %d", res);
+        saved_state_free(secure_socket);
+        return -1;
+    }
+    secure_socket->saved_state_type = SAVED_STATE_SESSION;
+    secure_socket->saved_state_size = (uint32_t) size;
+    return 0;
+}
+
+int anj_dtls_session_store(anj_net_ctx_t *ctx_,
+                           const anj_persistence_context_t *persistence) {
+    assert(ctx_ && persistence);
+    assert(anj_persistence_direction(persistence) == ANJ_PERSISTENCE_STORE);
+    ssl_socket_t *secure_socket = (ssl_socket_t *) ctx_;
+    if (secure_socket->sm_state != SOCKET_STATE_HANDSHAKE_DONE) {
+        return ANJ_NET_ENOTSUP;
+    }
+    // serializing the context fails e.g. for (D)TLS 1.3 or if the record
+    // layer is busy, storing the session allows at least for an abbreviated
+    // handshake
+    if (serialize_context(secure_socket) && serialize_session(secure_socket)) {
+        return -1;
+    }
+    int res = saved_state_persistence(secure_socket, persistence);
+    if (secure_socket->saved_state_type == SAVED_STATE_CONTEXT) {
+        // mbedtls_ssl_context_save() resets the context, so the connection
+        // can't be used anymore. The context is set up from scratch, so that
+        // the socket can be connected again and no close_notify, which would
+        // make the peer drop the stored connection, can be sent.
+        if (!anj_net_is_ok(anj_net_close(ANJ_NET_BINDING_UDP,
+                                         secure_socket->net))) {
+            mbedtls_log(L_WARNING, "Failed to close UDP socket");
+        }
+        internal_free(secure_socket);
+        internal_init(secure_socket);
+        secure_socket->state = ANJ_NET_SOCKET_STATE_CLOSED;
+    } else {
+        saved_state_free(secure_socket);
+    }
+    if (res) {
+        mbedtls_log(L_ERROR, "Failed to store DTLS connection state");
+        return -1;
+    }
+    mbedtls_log(L_INFO, "DTLS connection state stored");
+    return ANJ_NET_OK;
+}
+
+int anj_dtls_session_restore(anj_net_ctx_t *ctx_,
+                             const anj_persistence_context_t *persistence) {
+    assert(ctx_ && persistence);
+    assert(anj_persistence_direction(persistence) == ANJ_PERSISTENCE_RESTORE);
+    ssl_socket_t *secure_socket = (ssl_socket_t *) ctx_;
+    if (secure_socket->sm_state != SOCKET_STATE_INITIAL
+            || secure_socket->saved_state) {
+        return -1;
+    }
+    if (saved_state_persistence(secure_socket, persistence)) {
+        mbedtls_log(L_ERROR, "Failed to restore DTLS connection state");
+        saved_state_free(secure_socket);
+        return -1;
+    }
+    return ANJ_NET_OK;
+}
+#    endif // ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
+
+#    ifdef ANJ_NET_WITH_POLL_HANDLE
+int anj_dtls_get_poll_handle(anj_net_ctx_t *ctx_,
+                             anj_net_poll_handle_t *out_handle,
+                             bool *out_data_pending) {
+    assert(ctx_ && out_handle && out_data_pending);
+    ssl_socket_t *secure_socket = (ssl_socket_t *) ctx_;
+    int ret = anj_net_get_poll_handle(ANJ_NET_BINDING_UDP, secure_socket->net,
+                                      out_handle, out_data_pending);
+    if (!anj_net_is_ok(ret)) {
+        return ret;
+    }
+    // single datagram may carry more than one DTLS record
+    if (mbedtls_ssl_check_pending(&secure_socket->ssl_ctx)) {
+        *out_data_pending = true;
+    }
+    return ANJ_NET_OK;
+}
+#    endif // ANJ_NET_WITH_POLL_HANDLE
+
 #endif // ANJ_WITH_MBEDTLS && ANJ_NET_WITH_DTLS
@@ -0,0 +1,971 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#define ANJ_LOG_SOURCE_FILE_ID 77
+
+#ifdef ANJ_NET_WITH_IO_THREAD
+#    if !defined(_POSIX_C_SOURCE) && !defined(__APPLE__)
+#        define _POSIX_C_SOURCE 200809L
+#    endif
+
+#    include <assert.h>
+#    include <errno.h>
+#    include <fcntl.h>
+#    include <poll.h>
+#    include <pthread.h>
+#    include <stdbool.h>
+#    include <stddef.h>
+#    include <stdint.h>
+#    include <stdlib.h>
+#    include <string.h>
+#    include <unistd.h>
+
+#    include <anj/compat/net/anj_net_api.h>
+#    include <anj/compat/net/anj_net_io_thread.h>
+#    ifdef ANJ_NET_WITH_UDP
+#        include <anj/compat/net/anj_udp.h>
+#    endif // ANJ_NET_WITH_UDP
+#    ifdef ANJ_NET_WITH_DTLS
+#        include <anj/compat/net/anj_dtls.h>
+#    endif // ANJ_NET_WITH_DTLS
+#    include <anj/log.h>
+#    include <anj/utils.h>
+
+#    define io_log(...) anj_log(net_io, __VA_ARGS__)
+
+#    define ANJ_NET_FAILED (-1)
+#    define ANJ_NET_EINVAL (-2)
+#    define ANJ_NET_ENOTCONN (-4)
+#    define ANJ_NET_EBADFD (-5)
+#    define ANJ_NET_ENOMEM (-6)
+
+// Interval of retrying operations the actual binding reported as being in
+// progress, which don't have a file descriptor to wait for (e.g. DNS
+// resolution or sending to a full socket buffer)
+#    define IO_THREAD_RETRY_MS 5
+
+#    define HOSTNAME_MAX_SIZE 256
+#    define PORT_MAX_SIZE 16
+
+/** Functions of the actual binding, called only from the I/O thread. */
+typedef struct {
+    anj_net_create_ctx_t *create_ctx;
+    anj_net_connect_t *connect;
+    anj_net_send_t *send;
+    anj_net_recv_t *recv;
+    anj_net_close_t *close;
+    anj_net_cleanup_ctx_t *cleanup_ctx;
+    anj_net_get_inner_mtu_t *get_inner_mtu;
+    anj_net_get_state_t *get_state;
+    anj_net_get_poll_handle_t *get_poll_handle;
+    anj_net_queue_mode_rx_off_t *queue_mode_rx_off;
+} binding_t;
+
+#    ifdef ANJ_NET_WITH_UDP
+static const binding_t UDP_BINDING = {
+    .create_ctx = anj_udp_create_ctx,
+    .connect = anj_udp_connect,
+    .send = anj_udp_send,
+    .recv = anj_udp_recv,
+    .close = anj_udp_close,
+    .cleanup_ctx = anj_udp_cleanup_ctx,
+    .get_inner_mtu = anj_udp_get_inner_mtu,
+    .get_state = anj_udp_get_state,
+    .get_poll_handle = anj_udp_get_poll_handle,
+    .queue_mode_rx_off = anj_udp_queue_mode_rx_off
+};
+#    endif // ANJ_NET_WITH_UDP
+
+#    ifdef ANJ_NET_WITH_DTLS
+static const binding_t DTLS_BINDING = {
+    .create_ctx = anj_dtls_create_ctx,
+    .connect = anj_dtls_connect,
+    .send = anj_dtls_send,
+    .recv = anj_dtls_recv,
+    .close = anj_dtls_close,
+    .cleanup_ctx = anj_dtls_cleanup_ctx,
+    .get_inner_mtu = anj_dtls_get_inner_mtu,
+    .get_state = anj_dtls_get_state,
+    .get_poll_handle = anj_dtls_get_poll_handle,
+    .queue_mode_rx_off = anj_dtls_queue_mode_rx_off
+};
+#    endif // ANJ_NET_WITH_DTLS
+
+typedef enum {
+    CMD_NONE,
+    CMD_CONNECT,
+    CMD_RX_OFF,
+    CMD_CLOSE,
+    CMD_CLEANUP
+} cmd_t;
+
+typedef struct {
+    size_t length;
+    bool truncated;
+    uint8_t data[ANJ_NET_IO_THREAD_DATAGRAM_SIZE];
+} slot_t;
+
+/**
+ * Single-producer, single-consumer ring. Indices grow freely and are accessed
+ * only with the context mutex held. The slot between them is written by the
+ * producer and read by the consumer without the lock, as the other side never
+ * touches it at that time.
+ */
+typedef struct {
+    size_t head;
+    size_t tail;
+    slot_t slots[ANJ_NET_IO_THREAD_QUEUE_SIZE];
+} queue_t;
+
+typedef struct io_ctx_struct {
+    // guarded by g_io.mutex, modified only by the I/O thread after the context
+    // is added to the list
+    struct io_ctx_struct *next;
+
+    const binding_t *binding;
+    // used only by the I/O thread after the context is created
+    anj_net_ctx_t *inner;
+    bool inner_readable;
+
+    pthread_mutex_t mutex;
+    // fields below are guarded by mutex
+    cmd_t cmd;
+    // incremented for every command, so that the I/O thread can tell whether
+    // the command it has just performed was superseded in the meantime
+    uint32_t cmd_seq;
+    bool cmd_done;
+    int cmd_result;
+    char hostname[HOSTNAME_MAX_SIZE];
+    char port[PORT_MAX_SIZE];
+    anj_net_socket_state_t state;
+    int mtu_result;
+    int32_t mtu;
+    // first error of a queued send, or of a receive, reported by the next call
+    int tx_error;
+    int rx_error;
+    queue_t tx;
+    queue_t rx;
+
+    // readable if there is anything in rx, returned as the poll handle
+    int notify_pipe[2];
+} io_ctx_t;
+
+static struct {
+    pthread_mutex_t mutex;
+    // fields below are guarded by mutex
+    bool running;
+    bool stop;
+    // written to wake the I/O thread up from poll()
+    int wake_pipe[2];
+    io_ctx_t *ctxs;
+    size_t ctx_count;
+    pthread_t thread;
+} g_io = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .wake_pipe = { -1, -1 }
+};
+
+static size_t queue_count(const queue_t *queue) {
+    return queue->tail - queue->head;
+}
+
+static bool queue_full(const queue_t *queue) {
+    return queue_count(queue) == ANJ_NET_IO_THREAD_QUEUE_SIZE;
+}
+
+static slot_t *queue_front(queue_t *queue) {
+    return &queue->slots[queue->head % ANJ_NET_IO_THREAD_QUEUE_SIZE];
+}
+
+static slot_t *queue_back(queue_t *queue) {
+    return &queue->slots[queue->tail % ANJ_NET_IO_THREAD_QUEUE_SIZE];
+}
+
+static void pipe_write_byte(int fd) {
+    char byte = 0;
+    // the pipe being full means the reader is already going to wake up
+    (void) !write(fd, &byte, 1);
+}
+
+static void pipe_drain(int fd) {
+    char buf[64];
+    while (read(fd, buf, sizeof(buf)) > 0) {
+    }
+}
+
+static int pipe_open(int fds[2]) {
+    if (pipe(fds)) {
+        return -1;
+    }
+    for (int i = 0; i < 2; i++) {
+        int flags = fcntl(fds[i], F_GETFL);
+        if (flags < 0 || fcntl(fds[i], F_SETFL, flags | O_NONBLOCK)
+                || fcntl(fds[i], F_SETFD, FD_CLOEXEC)) {
+            close(fds[0]);
+            close(fds[1]);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void pipe_close(int fds[2]) {
+    for (int i = 0; i < 2; i++) {
+        if (fds[i] >= 0) {
+            close(fds[i]);
+            fds[i] = -1;
+        }
+    }
+}
+
+static void wake_io_thread(void) {
+    pthread_mutex_lock(&g_io.mutex);
+    if (g_io.running) {
+        pipe_write_byte(g_io.wake_pipe[1]);
+    }
+    pthread_mutex_unlock(&g_io.mutex);
+}
+
+// Called with ctx->mutex held
+static void update_state(io_ctx_t *ctx) {
+    anj_net_socket_state_t state;
+    if (anj_net_is_ok(ctx->binding->get_state(ctx->inner, &state))) {
+        ctx->state = state;
+    }
+    if (ctx->state == ANJ_NET_SOCKET_STATE_CONNECTED) {
+        ctx->mtu_result = ctx->binding->get_inner_mtu(ctx->inner, &ctx->mtu);
+    } else {
+        ctx->mtu_result = ANJ_NET_ENOTCONN;
+    }
+}
+
+static void unlink_ctx(io_ctx_t *ctx) {
+    pthread_mutex_lock(&g_io.mutex);
+    io_ctx_t **it = &g_io.ctxs;
+    while (*it != ctx) {
+        assert(*it);
+        it = &(*it)->next;
+    }
+    *it = ctx->next;
+    g_io.ctx_count--;
+    pthread_mutex_unlock(&g_io.mutex);
+}
+
+// Sends queued datagrams. Returns true if some of them have to be retried.
+static bool flush_tx(io_ctx_t *ctx) {
+    while (true) {
+        pthread_mutex_lock(&ctx->mutex);
+        bool empty = !queue_count(&ctx->tx);
+        pthread_mutex_unlock(&ctx->mutex);
+        if (empty) {
+            return false;
+        }
+
+        slot_t *slot = queue_front(&ctx->tx);
+        size_t bytes_sent = 0;
+        int result = ctx->binding->send(ctx->inner, &bytes_sent, slot->data,
+                                        slot->length);
+        if (anj_net_is_inprogress(result) || anj_net_is_again(result)) {
+            return true;
+        }
+        if (anj_net_is_ok(result) && bytes_sent != slot->length) {
+            // datagrams are never split
+            result = ANJ_NET_FAILED;
+        }
+
+        pthread_mutex_lock(&ctx->mutex);
+        if (!anj_net_is_ok(result)) {
+            io_log(L_WARNING, "Queued datagram not sent: %d", result);
+            if (anj_net_is_ok(ctx->tx_error)) {
+                ctx->tx_error = result;
+            }
+            update_state(ctx);
+        }
+        ctx->tx.head++;
+        pthread_mutex_unlock(&ctx->mutex);
+    }
+}
+
+static int perform_cmd(io_ctx_t *ctx,
+                       cmd_t cmd,
+                       const char *hostname,
+                       const char *port) {
+    switch (cmd) {
+    case CMD_CONNECT:
+        return ctx->binding->connect(ctx->inner, hostname, port);
+    case CMD_RX_OFF:
+        return ctx->binding->queue_mode_rx_off(ctx->inner);
+    case CMD_CLOSE:
+        return ctx->binding->close(ctx->inner);
+    case CMD_CLEANUP:
+        return ctx->binding->cleanup_ctx(&ctx->inner);
+    default:
+        ANJ_UNREACHABLE("invalid command");
+        return ANJ_NET_FAILED;
+    }
+}
+
+// Performs the pending command. Returns true if it is still in progress.
+// *out_removed is set if the context was cleaned up and must not be touched
+// anymore.
+static bool run_cmd(io_ctx_t *ctx, bool tx_pending, bool *out_removed) {
+    char hostname[HOSTNAME_MAX_SIZE];
+    char port[PORT_MAX_SIZE];
+
+    pthread_mutex_lock(&ctx->mutex);
+    cmd_t cmd = ctx->cmd_done ? CMD_NONE : ctx->cmd;
+    uint32_t seq = ctx->cmd_seq;
+    if (cmd == CMD_CONNECT) {
+        // copied, as the context may be reconnected while the lock is released
+        memcpy(hostname, ctx->hostname, sizeof(hostname));
+        memcpy(port, ctx->port, sizeof(port));
+    }
+    pthread_mutex_unlock(&ctx->mutex);
+
+    if (cmd == CMD_NONE) {
+        return false;
+    }
+    if (cmd != CMD_CONNECT && tx_pending) {
+        // datagrams queued before closing the connection are sent first
+        return true;
+    }
+
+    int result = perform_cmd(ctx, cmd, hostname, port);
+    if (anj_net_is_inprogress(result)) {
+        return true;
+    }
+
+    if (cmd == CMD_CLEANUP) {
+        unlink_ctx(ctx);
+        *out_removed = true;
+    }
+    pthread_mutex_lock(&ctx->mutex);
+    if (cmd != CMD_CLEANUP) {
+        update_state(ctx);
+        ctx->inner_readable = true;
+    }
+    if (ctx->cmd_seq == seq) {
+        // a superseded command is not reported, the new one is performed
+        // in the next iteration instead
+        ctx->cmd_done = true;
+        ctx->cmd_result = result;
+    }
+    pthread_mutex_unlock(&ctx->mutex);
+    // once cleanup is marked as done, the context may be freed at any time
+    return false;
+}
+
+// Moves received datagrams to the rx queue. Returns true if some of them may
+// still be waiting in the actual binding.
+static bool fill_rx(io_ctx_t *ctx) {
+    while (ctx->inner_readable) {
+        pthread_mutex_lock(&ctx->mutex);
+        bool full = queue_full(&ctx->rx);
+        bool connected = ctx->state == ANJ_NET_SOCKET_STATE_CONNECTED;
+        pthread_mutex_unlock(&ctx->mutex);
+        if (full) {
+            return true;
+        }
+        if (!connected) {
+            ctx->inner_readable = false;
+            break;
+        }
+
+        slot_t *slot = queue_back(&ctx->rx);
+        size_t bytes_received = 0;
+        int result =
+                ctx->binding->recv(ctx->inner, &bytes_received, slot->data,
+                                   sizeof(slot->data));
+        if (anj_net_is_again(result) || anj_net_is_inprogress(result)) {
+            ctx->inner_readable = false;
+            break;
+        }
+
+        pthread_mutex_lock(&ctx->mutex);
+        if (anj_net_is_ok(result) || result == ANJ_NET_EMSGSIZE) {
+            slot->length = bytes_received;
+            slot->truncated = (result == ANJ_NET_EMSGSIZE);
+            ctx->rx.tail++;
+        } else {
+            io_log(L_WARNING, "Receive failed: %d", result);
+            ctx->rx_error = result;
+            ctx->inner_readable = false;
+            update_state(ctx);
+        }
+        pipe_write_byte(ctx->notify_pipe[1]);
+        pthread_mutex_unlock(&ctx->mutex);
+    }
+    return false;
+}
+
+static int get_inner_fd(io_ctx_t *ctx) {
+    anj_net_poll_handle_t handle;
+    bool data_pending = false;
+    if (!anj_net_is_ok(ctx->binding->get_poll_handle(ctx->inner, &handle,
+                                                     &data_pending))) {
+        return -1;
+    }
+    if (data_pending) {
+        // e.g. further DTLS records already read from the socket
+        ctx->inner_readable = true;
+    }
+    return handle.fd;
+}
+
+// Services the context. Returns true if it has to be serviced again without
+// waiting for its socket. *out_fd is set to the socket to wait for, if any.
+static bool service_ctx(io_ctx_t *ctx, int *out_fd, bool *out_removed) {
+    *out_fd = -1;
+    bool busy = flush_tx(ctx);
+    if (run_cmd(ctx, busy, out_removed)) {
+        busy = true;
+    }
+    if (*out_removed) {
+        return false;
+    }
+    if (fill_rx(ctx)) {
+        // the queue is full, the context is polled again once the core
+        // makes some room in it
+        return busy;
+    }
+    *out_fd = get_inner_fd(ctx);
+    return busy || ctx->inner_readable;
+}
+
+typedef struct {
+    struct pollfd *fds;
+    io_ctx_t **ctxs;
+    size_t capacity;
+} poll_set_t;
+
+static int poll_set_reserve(poll_set_t *set, size_t count) {
+    if (count <= set->capacity) {
+        return 0;
+    }
+    struct pollfd *fds =
+            (struct pollfd *) realloc(set->fds, count * sizeof(*fds));
+    if (fds) {
+        set->fds = fds;
+    }
+    io_ctx_t **ctxs = (io_ctx_t **) realloc(set->ctxs, count * sizeof(*ctxs));
+    if (ctxs) {
+        set->ctxs = ctxs;
+    }
+    if (!fds || !ctxs) {
+        return -1;
+    }
+    set->capacity = count;
+    return 0;
+}
+
+static void *io_thread(void *arg) {
+    (void) arg;
+    poll_set_t set = { 0 };
+
+    while (true) {
+        pthread_mutex_lock(&g_io.mutex);
+        bool stop = g_io.stop;
+        io_ctx_t *ctx = g_io.ctxs;
+        size_t ctx_count = g_io.ctx_count;
+        int wake_fd = g_io.wake_pipe[0];
+        pthread_mutex_unlock(&g_io.mutex);
+        if (stop) {
+            break;
+        }
+
+        // if there is no memory for the poll set, sockets are polled by
+        // retrying in short intervals instead
+        bool poll_sockets = !poll_set_reserve(&set, ctx_count + 1);
+        bool busy = !poll_sockets;
+        size_t nfds = 0;
+        if (set.capacity) {
+            set.fds[nfds++] = (struct pollfd) {
+                .fd = wake_fd,
+                .events = POLLIN
+            };
+        }
+        while (ctx) {
+            // read before servicing, ctx may be cleaned up in the meantime
+            pthread_mutex_lock(&g_io.mutex);
+            io_ctx_t *next = ctx->next;
+            pthread_mutex_unlock(&g_io.mutex);
+
+            int fd;
+            bool removed = false;
+            if (service_ctx(ctx, &fd, &removed)) {
+                busy = true;
+            }
+            if (!removed && fd >= 0 && poll_sockets && nfds < set.capacity) {
+                set.ctxs[nfds] = ctx;
+                set.fds[nfds++] = (struct pollfd) {
+                    .fd = fd,
+                    .events = POLLIN
+                };
+            }
+            ctx = next;
+        }
+
+        if (!nfds) {
+            struct pollfd wake = {
+                .fd = wake_fd,
+                .events = POLLIN
+            };
+            (void) poll(&wake, 1, IO_THREAD_RETRY_MS);
+            pipe_drain(wake_fd);
+            continue;
+        }
+        if (poll(set.fds, (nfds_t) nfds, busy ? IO_THREAD_RETRY_MS : -1) < 0
+                && errno != EINTR) {
+            io_log(L_ERROR, "poll() failed: %d", errno);
+        }
+        if (set.fds[0].revents) {
+            pipe_drain(wake_fd);
+        }
+        for (size_t i = 1; i < nfds; i++) {
+            if (set.fds[i].revents) {
+                set.ctxs[i]->inner_readable = true;
+            }
+        }
+    }
+
+    free(set.fds);
+    free(set.ctxs);
+    return NULL;
+}
+
+// Called with g_io.mutex held
+static int start_io_thread(void) {
+    if (g_io.running) {
+        // anj_net_io_thread_stop() may be waiting for the thread to finish
+        return g_io.stop ? -1 : 0;
+    }
+    if (pipe_open(g_io.wake_pipe)) {
+        io_log(L_ERROR, "Could not create wake-up pipe");
+        return -1;
+    }
+    g_io.stop = false;
+    if (pthread_create(&g_io.thread, NULL, io_thread, NULL)) {
+        io_log(L_ERROR, "Could not start I/O thread");
+        pipe_close(g_io.wake_pipe);
+        return -1;
+    }
+    g_io.running = true;
+    io_log(L_DEBUG, "I/O thread started");
+    return 0;
+}
+
+static const binding_t *get_binding(anj_net_binding_type_t type) {
+    switch (type) {
+#    ifdef ANJ_NET_WITH_UDP
+    case ANJ_NET_BINDING_UDP:
+        return &UDP_BINDING;
+#    endif // ANJ_NET_WITH_UDP
+#    ifdef ANJ_NET_WITH_DTLS
+    case ANJ_NET_BINDING_DTLS:
+        return &DTLS_BINDING;
+#    endif // ANJ_NET_WITH_DTLS
+    default:
+        return NULL;
+    }
+}
+
+static void free_ctx(io_ctx_t *ctx) {
+    pipe_close(ctx->notify_pipe);
+    pthread_mutex_destroy(&ctx->mutex);
+    free(ctx);
+}
+
+int anj_net_io_thread_create_ctx(anj_net_binding_type_t type,
+                                 anj_net_ctx_t **ctx_,
+                                 const anj_net_config_t *config) {
+    if (!ctx_) {
+        return ANJ_NET_EINVAL;
+    }
+    const binding_t *binding = get_binding(type);
+    if (!binding) {
+        return ANJ_NET_ENOTSUP;
+    }
+
+    io_ctx_t *ctx = (io_ctx_t *) calloc(1, sizeof(*ctx));
+    if (!ctx) {
+        io_log(L_ERROR, "Out of memory");
+        return ANJ_NET_ENOMEM;
+    }
+    ctx->binding = binding;
+    ctx->notify_pipe[0] = -1;
+    ctx->notify_pipe[1] = -1;
+    if (pthread_mutex_init(&ctx->mutex, NULL)) {
+        free(ctx);
+        return ANJ_NET_FAILED;
+    }
+    if (pipe_open(ctx->notify_pipe)) {
+        io_log(L_ERROR, "Could not create notification pipe");
+        free_ctx(ctx);
+        return ANJ_NET_FAILED;
+    }
+    int result = binding->create_ctx(&ctx->inner, config);
+    if (!anj_net_is_ok(result)) {
+        free_ctx(ctx);
+        return result;
+    }
+    ctx->state = ANJ_NET_SOCKET_STATE_CLOSED;
+    update_state(ctx);
+
+    pthread_mutex_lock(&g_io.mutex);
+    if (start_io_thread()) {
+        pthread_mutex_unlock(&g_io.mutex);
+        binding->cleanup_ctx(&ctx->inner);
+        free_ctx(ctx);
+        return ANJ_NET_FAILED;
+    }
+    ctx->next = g_io.ctxs;
+    g_io.ctxs = ctx;
+    g_io.ctx_count++;
+    pipe_write_byte(g_io.wake_pipe[1]);
+    pthread_mutex_unlock(&g_io.mutex);
+
+    *ctx_ = (anj_net_ctx_t *) ctx;
+    return ANJ_NET_OK;
+}
+
+// Requests the command, or collects its result if the I/O thread has already
+// performed it
+static int request_cmd(io_ctx_t *ctx,
+                       cmd_t cmd,
+                       const char *hostname,
+                       const char *port) {
+    int result = ANJ_NET_EINPROGRESS;
+    bool wake = false;
+
+    pthread_mutex_lock(&ctx->mutex);
+    if (ctx->cmd == cmd && ctx->cmd_done) {
+        result = ctx->cmd_result;
+        ctx->cmd = CMD_NONE;
+    } else if (ctx->cmd != cmd) {
+        if (cmd == CMD_CONNECT) {
+            strcpy(ctx->hostname, hostname);
+            strcpy(ctx->port, port);
+        }
+        ctx->cmd = cmd;
+        ctx->cmd_seq++;
+        ctx->cmd_done = false;
+        wake = true;
+    }
+    pthread_mutex_unlock(&ctx->mutex);
+
+    if (wake) {
+        wake_io_thread();
+    }
+    return result;
+}
+
+int anj_net_io_thread_connect(anj_net_ctx_t *ctx_,
+                              const char *hostname,
+                              const char *port) {
+    if (!ctx_) {
+        return ANJ_NET_EBADFD;
+    }
+    if (!hostname || !port || strlen(hostname) >= HOSTNAME_MAX_SIZE
+            || strlen(port) >= PORT_MAX_SIZE) {
+        return ANJ_NET_EINVAL;
+    }
+    return request_cmd((io_ctx_t *) ctx_, CMD_CONNECT, hostname, port);
+}
+
+#    ifdef ANJ_NET_WITH_SEND_VEC
+typedef anj_net_iovec_t fragment_t;
+#    else  // ANJ_NET_WITH_SEND_VEC
+typedef struct {
+    const uint8_t *buf;
+    size_t length;
+} fragment_t;
+#    endif // ANJ_NET_WITH_SEND_VEC
+
+// Queues a single datagram gathered from the fragments
+static int send_gathered(io_ctx_t *ctx,
+                         size_t *bytes_sent,
+                         const fragment_t *fragments,
+                         size_t count) {
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        total += fragments[i].length;
+    }
+    if (total > ANJ_NET_IO_THREAD_DATAGRAM_SIZE) {
+        return ANJ_NET_EMSGSIZE;
+    }
+
+    pthread_mutex_lock(&ctx->mutex);
+    int result = ctx->tx_error;
+    ctx->tx_error = ANJ_NET_OK;
+    bool full = queue_full(&ctx->tx);
+    pthread_mutex_unlock(&ctx->mutex);
+    if (!anj_net_is_ok(result)) {
+        return result;
+    }
+    if (full) {
+        return ANJ_NET_EINPROGRESS;
+    }
+
+    slot_t *slot = queue_back(&ctx->tx);
+    slot->length = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (fragments[i].length) {
+            memcpy(&slot->data[slot->length], fragments[i].buf,
+                   fragments[i].length);
+            slot->length += fragments[i].length;
+        }
+    }
+
+    pthread_mutex_lock(&ctx->mutex);
+    ctx->tx.tail++;
+    pthread_mutex_unlock(&ctx->mutex);
+    wake_io_thread();
+    *bytes_sent = total;
+    return ANJ_NET_OK;
+}
+
+int anj_net_io_thread_send(anj_net_ctx_t *ctx,
+                           size_t *bytes_sent,
+                           const uint8_t *buf,
+                           size_t length) {
+    if (!ctx) {
+        return ANJ_NET_EBADFD;
+    }
+    if (!bytes_sent || (!buf && length)) {
+        return ANJ_NET_EINVAL;
+    }
+    const fragment_t fragment = {
+        .buf = buf,
+        .length = length
+    };
+    return send_gathered((io_ctx_t *) ctx, bytes_sent, &fragment, 1);
+}
+
+#    ifdef ANJ_NET_WITH_SEND_VEC
+int anj_net_io_thread_send_vec(anj_net_ctx_t *ctx,
+                               size_t *bytes_sent,
+                               const anj_net_iovec_t *iov,
+                               size_t iov_count) {
+    if (!ctx) {
+        return ANJ_NET_EBADFD;
+    }
+    if (!bytes_sent || (!iov && iov_count)) {
+        return ANJ_NET_EINVAL;
+    }
+    return send_gathered((io_ctx_t *) ctx, bytes_sent, iov, iov_count);
+}
+#    endif // ANJ_NET_WITH_SEND_VEC
+
+int anj_net_io_thread_recv(anj_net_ctx_t *ctx_,
+                           size_t *bytes_received,
+                           uint8_t *buf,
+                           size_t length) {
+    if (!ctx_) {
+        return ANJ_NET_EBADFD;
+    }
+    if (!bytes_received || !buf) {
+        return ANJ_NET_EINVAL;
+    }
+    io_ctx_t *ctx = (io_ctx_t *) ctx_;
+
+    pthread_mutex_lock(&ctx->mutex);
+    bool empty = !queue_count(&ctx->rx);
+    int result = ANJ_NET_EAGAIN;
+    if (empty) {
+        if (!anj_net_is_ok(ctx->rx_error)) {
+            result = ctx->rx_error;
+            ctx->rx_error = ANJ_NET_OK;
+        }
+        pipe_drain(ctx->notify_pipe[0]);
+    }
+    pthread_mutex_unlock(&ctx->mutex);
+    if (empty) {
+        return result;
+    }
+
+    slot_t *slot = queue_front(&ctx->rx);
+    size_t copied = ANJ_MIN(slot->length, length);
+    memcpy(buf, slot->data, copied);
+    *bytes_received = copied;
+    // same as anj_udp_recv(), a datagram that fills the whole buffer is
+    // considered truncated
+    result = (slot->truncated || slot->length >= length) ? ANJ_NET_EMSGSIZE
+                                                         : ANJ_NET_OK;
+
+    pthread_mutex_lock(&ctx->mutex);
+    bool was_full = queue_full(&ctx->rx);
+    ctx->rx.head++;
+    if (!queue_count(&ctx->rx) && anj_net_is_ok(ctx->rx_error)) {
+        // the I/O thread writes to the pipe with the lock held, so no
+        // notification about a new datagram can be lost here
+        pipe_drain(ctx->notify_pipe[0]);
+    }
+    pthread_mutex_unlock(&ctx->mutex);
+    if (was_full) {
+        // the I/O thread stopped receiving for this context
+        wake_io_thread();
+    }
+    return result;
+}
+
+#    ifdef ANJ_NET_WITH_BATCH_IO
+int anj_net_io_thread_recv_batch(anj_net_ctx_t *ctx,
+                                 anj_net_datagram_t *datagrams,
+                                 size_t count,
+                                 size_t *out_count) {
+    if (!out_count || (!datagrams && count)) {
+        return ANJ_NET_EINVAL;
+    }
+    *out_count = 0;
+    for (size_t i = 0; i < count; i++) {
+        datagrams[i].bytes = 0;
+        int result = anj_net_io_thread_recv(ctx, &datagrams[i].bytes,
+                                            datagrams[i].buf,
+                                            datagrams[i].length);
+        datagrams[i].truncated = (result == ANJ_NET_EMSGSIZE);
+        if (result && result != ANJ_NET_EMSGSIZE) {
+            // errors other than EAGAIN are reported by the next call
+            return i ? ANJ_NET_OK : result;
+        }
+        (*out_count)++;
+    }
+    return count ? ANJ_NET_OK : ANJ_NET_EAGAIN;
+}
+
+int anj_net_io_thread_send_batch(anj_net_ctx_t *ctx,
+                                 anj_net_datagram_t *datagrams,
+                                 size_t count,
+                                 size_t *out_count) {
+    if (!out_count || (!datagrams && count)) {
+        return ANJ_NET_EINVAL;
+    }
+    *out_count = 0;
+    for (size_t i = 0; i < count; i++) {
+        datagrams[i].bytes = 0;
+        int result = anj_net_io_thread_send(ctx, &datagrams[i].bytes,
+                                            datagrams[i].buf,
+                                            datagrams[i].length);
+        if (result) {
+            return (i && result == ANJ_NET_EINPROGRESS) ? ANJ_NET_OK : result;
+        }
+        (*out_count)++;
+    }
+    return ANJ_NET_OK;
+}
+#    endif // ANJ_NET_WITH_BATCH_IO
+
+int anj_net_io_thread_close(anj_net_ctx_t *ctx) {
+    if (!ctx) {
+        return ANJ_NET_EBADFD;
+    }
+    return request_cmd((io_ctx_t *) ctx, CMD_CLOSE, NULL, NULL);
+}
+
+int anj_net_io_thread_cleanup_ctx(anj_net_ctx_t **ctx_) {
+    if (!ctx_ || !*ctx_) {
+        return ANJ_NET_EBADFD;
+    }
+    io_ctx_t *ctx = (io_ctx_t *) *ctx_;
+    int result = request_cmd(ctx, CMD_CLEANUP, NULL, NULL);
+    if (anj_net_is_inprogress(result)) {
+        return result;
+    }
+    // the I/O thread has already removed the context from its list
+    free_ctx(ctx);
+    *ctx_ = NULL;
+    return result;
+}
+
+int anj_net_io_thread_get_inner_mtu(anj_net_ctx_t *ctx_, int32_t *out_value) {
+    if (!ctx_) {
+        return ANJ_NET_EBADFD;
+    }
+    if (!out_value) {
+        return ANJ_NET_EINVAL;
+    }
+    io_ctx_t *ctx = (io_ctx_t *) ctx_;
+    pthread_mutex_lock(&ctx->mutex);
+    int result = ctx->mtu_result;
+    *out_value = ctx->mtu;
+    pthread_mutex_unlock(&ctx->mutex);
+    return result;
+}
+
+int anj_net_io_thread_get_state(anj_net_ctx_t *ctx_,
+                                anj_net_socket_state_t *out_value) {
+    if (!ctx_) {
+        return ANJ_NET_EBADFD;
+    }
+    if (!out_value) {
+        return ANJ_NET_EINVAL;
+    }
+    io_ctx_t *ctx = (io_ctx_t *) ctx_;
+    pthread_mutex_lock(&ctx->mutex);
+    *out_value = ctx->state;
+    pthread_mutex_unlock(&ctx->mutex);
+    return ANJ_NET_OK;
+}
+
+int anj_net_io_thread_get_poll_handle(anj_net_ctx_t *ctx_,
+                                      anj_net_poll_handle_t *out_handle,
+                                      bool *out_data_pending) {
+    if (!ctx_) {
+        return ANJ_NET_EBADFD;
+    }
+    if (!out_handle || !out_data_pending) {
+        return ANJ_NET_EINVAL;
+    }
+    io_ctx_t *ctx = (io_ctx_t *) ctx_;
+    out_handle->fd = ctx->notify_pipe[0];
+    pthread_mutex_lock(&ctx->mutex);
+    *out_data_pending =
+            queue_count(&ctx->rx) > 0 || !anj_net_is_ok(ctx->rx_error);
+    pthread_mutex_unlock(&ctx->mutex);
+    return ANJ_NET_OK;
+}
+
+int anj_net_io_thread_queue_mode_rx_off(anj_net_ctx_t *ctx) {
+    if (!ctx) {
+        return ANJ_NET_EBADFD;
+    }
+    return request_cmd((io_ctx_t *) ctx, CMD_RX_OFF, NULL, NULL);
+}
+
+int anj_net_io_thread_stop(void) {
+    pthread_mutex_lock(&g_io.mutex);
+    if (!g_io.running) {
+        pthread_mutex_unlock(&g_io.mutex);
+        return 0;
+    }
+    if (g_io.ctxs) {
+        pthread_mutex_unlock(&g_io.mutex);
+        io_log(L_ERROR, "Contexts still in use, I/O thread not stopped");
+        return -1;
+    }
+    g_io.stop = true;
+    pipe_write_byte(g_io.wake_pipe[1]);
+    pthread_t thread = g_io.thread;
+    pthread_mutex_unlock(&g_io.mutex);
+
+    pthread_join(thread, NULL);
+
+    pthread_mutex_lock(&g_io.mutex);
+    pipe_close(g_io.wake_pipe);
+    g_io.running = false;
+    pthread_mutex_unlock(&g_io.mutex);
+    io_log(L_DEBUG, "I/O thread stopped");
+    return 0;
+}
+
+#else  // ANJ_NET_WITH_IO_THREAD
+// HACK: This typedef suppress empty translation unit warning.
+typedef int _translation_unit_not_empty;
+#endif // ANJ_NET_WITH_IO_THREAD
@@ -42,4 +42,7 @@ int anj_rng_generate(uint8_t *buffer, size_t size) {
     return 0;
 }
 
+#else  // ANJ_WITH_RNG_POSIX_COMPAT
+// HACK: This typedef suppress empty translation unit warning.
+typedef int _translation_unit_not_empty;
 #endif // ANJ_WITH_RNG_POSIX_COMPAT
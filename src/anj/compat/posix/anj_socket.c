@@ -20,6 +20,13 @@
 #    if !defined(_POSIX_C_SOURCE) && !defined(__APPLE__)
 #        define _POSIX_C_SOURCE 200809L
 #    endif
+#    if defined(ANJ_NET_WITH_BATCH_IO) && defined(__linux__)
+// recvmmsg() and sendmmsg() are Linux extensions
+#        ifndef _GNU_SOURCE
+#            define _GNU_SOURCE
+#        endif // _GNU_SOURCE
+#        define NET_WITH_MMSG
+#    endif // defined(ANJ_NET_WITH_BATCH_IO) && defined(__linux__)
 
 #    include <stdint.h>
 #    include <string.h>
@@ -30,6 +37,10 @@
 #    endif // ANJ_NET_WITH_UDP
 #    include <anj/log.h>
 #    include <anj/utils.h>
+#    ifdef ANJ_NET_WITH_RESOLVE_CACHE
+#        include <anj/compat/time.h>
+#        include <anj/time.h>
+#    endif // ANJ_NET_WITH_RESOLVE_CACHE
 
 #    include <arpa/inet.h>
 #    include <errno.h>
@@ -43,6 +54,12 @@
 #    include <sys/socket.h>
 #    include <sys/types.h>
 #    include <unistd.h>
+#    ifdef ANJ_NET_WITH_ASYNC_RESOLVE
+#        include <pthread.h>
+#    endif // ANJ_NET_WITH_ASYNC_RESOLVE
+#    if defined(ANJ_NET_WITH_SEND_VEC) || defined(NET_WITH_MMSG)
+#        include <sys/uio.h>
+#    endif // defined(ANJ_NET_WITH_SEND_VEC) || defined(NET_WITH_MMSG)
 
 /**
  * The operation failed.
@@ -81,11 +98,34 @@
 #    define INVALID_SOCKET -1
 typedef int sockfd_t;
 
+#    ifdef ANJ_NET_WITH_ASYNC_RESOLVE
+/**
+ * Host name resolution running in a background thread. Owned by the socket
+ * context until the context abandons it; after that, it's freed by whichever
+ * of the two finishes last.
+ */
+typedef struct {
+    pthread_mutex_t mutex;
+    /** Set by the resolver thread, protected by @ref mutex. */
+    bool done;
+    /** Set by the socket context, protected by @ref mutex. */
+    bool abandoned;
+    /** Result of getaddrinfo(), valid if @ref done is set. */
+    int gai_result;
+    struct addrinfo *result;
+    anj_net_address_family_setting_t af_setting;
+    char hostname[];
+} resolve_job_t;
+#    endif // ANJ_NET_WITH_ASYNC_RESOLVE
+
 typedef struct anj_net_ctx_posix_impl {
     sockfd_t sockfd;
     anj_net_socket_state_t state;
 
     anj_net_socket_configuration_t config;
+#    ifdef ANJ_NET_WITH_ASYNC_RESOLVE
+    resolve_job_t *resolve_job;
+#    endif // ANJ_NET_WITH_ASYNC_RESOLVE
 } anj_net_ctx_posix_impl_t;
 
 typedef enum {
@@ -210,7 +250,14 @@ static void cleanup_ctx_internal(anj_net_ctx_posix_impl_t *ctx) {
     ctx->state = ANJ_NET_SOCKET_STATE_CLOSED;
 }
 
+#    ifdef ANJ_NET_WITH_ASYNC_RESOLVE
+static void resolve_job_abandon(anj_net_ctx_posix_impl_t *ctx);
+#    endif // ANJ_NET_WITH_ASYNC_RESOLVE
+
 static int net_close_internal(anj_net_ctx_posix_impl_t *ctx) {
+#    ifdef ANJ_NET_WITH_ASYNC_RESOLVE
+    resolve_job_abandon(ctx);
+#    endif // ANJ_NET_WITH_ASYNC_RESOLVE
     if (ctx->sockfd != INVALID_SOCKET) {
         errno = 0;
         if (close(ctx->sockfd) < 0) {
@@ -244,6 +291,9 @@ static int create_net_ctx(anj_net_ctx_t **ctx_,
 
     cleanup_ctx_internal(ctx);
     copy_config(ctx, config ? &config->raw_socket_config : NULL);
+#    ifdef ANJ_NET_WITH_ASYNC_RESOLVE
+    ctx->resolve_job = NULL;
+#    endif // ANJ_NET_WITH_ASYNC_RESOLVE
 
     if (ctx->config.af_setting < ANJ_NET_AF_SETTING_UNSPEC
             || ctx->config.af_setting > ANJ_NET_AF_SETTING_PREFERRED_INET6) {
@@ -282,19 +332,19 @@ static int cleanup_ctx(anj_net_ctx_t **ctx_) {
     return result;
 }
 
-static void update_ports(struct addrinfo *head,
-                         const uint16_t port_in_net_order) {
-    switch (head->ai_family) {
+static void update_port(struct sockaddr *addr,
+                        const uint16_t port_in_net_order) {
+    switch (addr->sa_family) {
 #    ifdef ANJ_NET_WITH_IPV4
     case AF_INET: {
-        struct sockaddr_in *addr_in = (struct sockaddr_in *) head->ai_addr;
+        struct sockaddr_in *addr_in = (struct sockaddr_in *) addr;
         addr_in->sin_port = port_in_net_order;
         break;
     }
 #    endif // ANJ_NET_WITH_IPV4
 #    ifdef ANJ_NET_WITH_IPV6
     case AF_INET6: {
-        struct sockaddr_in6 *addr_in = (struct sockaddr_in6 *) head->ai_addr;
+        struct sockaddr_in6 *addr_in = (struct sockaddr_in6 *) addr;
         addr_in->sin6_port = port_in_net_order;
         break;
     }
@@ -365,24 +415,309 @@ static int set_ai_family(int *ai_family,
     return 0;
 }
 
-static int net_addrinfo_resolve(anj_net_ctx_posix_impl_t *ctx,
-                                const char *hostname,
-                                const uint16_t port_in_net_order,
-                                struct addrinfo **servinfo,
-                                int ai_family) {
-    if (!ctx || !servinfo || !hostname) {
-        net_log(L_ERROR, "Invalid arguments for address resolution");
-        return ANJ_NET_EINVAL;
-    }
-
+static int getaddrinfo_with_family(const char *hostname,
+                                   int ai_family,
+                                   int ai_flags,
+                                   struct addrinfo **servinfo) {
     // Configuration hints for address resolution
     struct addrinfo hints;
     memset(&hints, 0, sizeof(hints));
     hints.ai_family = ai_family;
     hints.ai_socktype = SOCK_DGRAM;
-    hints.ai_flags = 0; // Adjust flags as needed
+    hints.ai_flags = ai_flags;
 
+    *servinfo = NULL;
     const int ret = getaddrinfo(hostname, NULL, &hints, servinfo);
+    if (ret != 0) {
+        *servinfo = NULL;
+    }
+    return ret;
+}
+
+/**
+ * Calls getaddrinfo() for the preferred address family and, if that fails and
+ * the setting allows it, for the other one. Returns the getaddrinfo() result.
+ */
+static int resolve_addrinfo(const char *hostname,
+                            anj_net_address_family_setting_t af_setting,
+                            int ai_flags,
+                            struct addrinfo **servinfo) {
+#    ifdef ANJ_NET_WITH_HAPPY_EYEBALLS
+    // addresses of both families are tried by net_connect_candidates()
+    if (is_af_setting_weak(af_setting)) {
+        return getaddrinfo_with_family(hostname, AF_UNSPEC, ai_flags,
+                                       servinfo);
+    }
+#    endif // ANJ_NET_WITH_HAPPY_EYEBALLS
+    int ai_family;
+    if (set_ai_family(&ai_family, af_setting, true)) {
+        return EAI_FAMILY;
+    }
+    int ret = getaddrinfo_with_family(hostname, ai_family, ai_flags, servinfo);
+    if (ret != 0 && !set_ai_family(&ai_family, af_setting, false)) {
+        ret = getaddrinfo_with_family(hostname, ai_family, ai_flags, servinfo);
+    }
+    return ret;
+}
+
+#    ifdef ANJ_NET_WITH_ASYNC_RESOLVE
+static void resolve_job_free(resolve_job_t *job) {
+    if (job->result) {
+        freeaddrinfo(job->result);
+    }
+    pthread_mutex_destroy(&job->mutex);
+    free(job);
+}
+
+static void *resolve_job_run(void *job_) {
+    resolve_job_t *job = (resolve_job_t *) job_;
+    struct addrinfo *result = NULL;
+    int gai_result = resolve_addrinfo(job->hostname, job->af_setting, 0,
+                                      &result);
+
+    pthread_mutex_lock(&job->mutex);
+    bool abandoned = job->abandoned;
+    job->gai_result = gai_result;
+    job->result = result;
+    job->done = true;
+    pthread_mutex_unlock(&job->mutex);
+
+    // the socket context won't look at the job any more
+    if (abandoned) {
+        resolve_job_free(job);
+    }
+    return NULL;
+}
+
+static int resolve_job_start(anj_net_ctx_posix_impl_t *ctx,
+                             const char *hostname) {
+    size_t hostname_size = strlen(hostname) + 1;
+    resolve_job_t *job = (resolve_job_t *) malloc(sizeof(*job) + hostname_size);
+    if (!job) {
+        return ANJ_NET_ENOMEM;
+    }
+    memset(job, 0, sizeof(*job));
+    memcpy(job->hostname, hostname, hostname_size);
+    job->af_setting = ctx->config.af_setting;
+    if (pthread_mutex_init(&job->mutex, NULL)) {
+        free(job);
+        return ANJ_NET_FAILED;
+    }
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, resolve_job_run, job)) {
+        net_log(L_ERROR, "Could not start resolver thread");
+        resolve_job_free(job);
+        return ANJ_NET_FAILED;
+    }
+    pthread_detach(thread);
+
+    net_log(L_DEBUG, "Resolving %s in background", hostname);
+    ctx->resolve_job = job;
+    return ANJ_NET_EINPROGRESS;
+}
+
+static void resolve_job_abandon(anj_net_ctx_posix_impl_t *ctx) {
+    resolve_job_t *job = ctx->resolve_job;
+    if (!job) {
+        return;
+    }
+    ctx->resolve_job = NULL;
+
+    pthread_mutex_lock(&job->mutex);
+    bool done = job->done;
+    job->abandoned = true;
+    pthread_mutex_unlock(&job->mutex);
+
+    // otherwise the resolver thread frees the job when it finishes
+    if (done) {
+        resolve_job_free(job);
+    }
+}
+
+/**
+ * Starts the background resolution of @p hostname, or collects its result if
+ * it has finished. Returns ANJ_NET_EINPROGRESS until the result is available.
+ */
+static int resolve_job_poll(anj_net_ctx_posix_impl_t *ctx,
+                            const char *hostname,
+                            int *out_gai_result,
+                            struct addrinfo **servinfo) {
+    if (ctx->resolve_job && strcmp(ctx->resolve_job->hostname, hostname)) {
+        resolve_job_abandon(ctx);
+    }
+    resolve_job_t *job = ctx->resolve_job;
+    if (!job) {
+        return resolve_job_start(ctx, hostname);
+    }
+
+    pthread_mutex_lock(&job->mutex);
+    bool done = job->done;
+    pthread_mutex_unlock(&job->mutex);
+    if (!done) {
+        return ANJ_NET_EINPROGRESS;
+    }
+
+    ctx->resolve_job = NULL;
+    *out_gai_result = job->gai_result;
+    *servinfo = job->result;
+    job->result = NULL;
+    resolve_job_free(job);
+    return ANJ_NET_OK;
+}
+#    endif // ANJ_NET_WITH_ASYNC_RESOLVE
+
+#    if defined(ANJ_NET_WITH_RESOLVE_CACHE) \
+            || defined(ANJ_NET_WITH_HAPPY_EYEBALLS)
+/**
+ * Size of the longest cached host name, including the terminating nullbyte.
+ * Longer names are never cached; DNS names can't be longer anyway.
+ */
+#        define CACHED_HOSTNAME_MAX_SIZE 254
+#    endif // defined(ANJ_NET_WITH_RESOLVE_CACHE) ||
+           // defined(ANJ_NET_WITH_HAPPY_EYEBALLS)
+
+#    ifdef ANJ_NET_WITH_RESOLVE_CACHE
+typedef struct {
+    char hostname[CACHED_HOSTNAME_MAX_SIZE];
+    anj_net_address_family_setting_t af_setting;
+    struct sockaddr_storage addr;
+    socklen_t addr_len;
+    anj_time_monotonic_t expires;
+} resolve_cache_entry_t;
+
+static resolve_cache_entry_t g_resolve_cache[ANJ_NET_RESOLVE_CACHE_ENTRIES];
+
+static bool resolve_cache_entry_matches(const resolve_cache_entry_t *entry,
+                                        const char *hostname,
+                                        anj_net_address_family_setting_t
+                                                af_setting) {
+    return entry->addr_len > 0 && entry->af_setting == af_setting
+           && !strcmp(entry->hostname, hostname);
+}
+
+static int resolve_cache_get(const char *hostname,
+                             anj_net_address_family_setting_t af_setting,
+                             struct sockaddr_storage *out_addr,
+                             socklen_t *out_addr_len) {
+    anj_time_monotonic_t now = anj_time_monotonic_now();
+    for (size_t i = 0; i < ANJ_NET_RESOLVE_CACHE_ENTRIES; i++) {
+        const resolve_cache_entry_t *entry = &g_resolve_cache[i];
+        if (resolve_cache_entry_matches(entry, hostname, af_setting)
+                && anj_time_monotonic_lt(now, entry->expires)) {
+            memcpy(out_addr, &entry->addr, sizeof(*out_addr));
+            *out_addr_len = entry->addr_len;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static void resolve_cache_put(const char *hostname,
+                              anj_net_address_family_setting_t af_setting,
+                              const struct sockaddr *addr,
+                              socklen_t addr_len) {
+    size_t hostname_size = strlen(hostname) + 1;
+    if (hostname_size > CACHED_HOSTNAME_MAX_SIZE
+            || addr_len > sizeof(struct sockaddr_storage)) {
+        return;
+    }
+
+    // replace the entry for the same host, or the one that expires first
+    resolve_cache_entry_t *slot = &g_resolve_cache[0];
+    for (size_t i = 0; i < ANJ_NET_RESOLVE_CACHE_ENTRIES; i++) {
+        resolve_cache_entry_t *entry = &g_resolve_cache[i];
+        if (resolve_cache_entry_matches(entry, hostname, af_setting)) {
+            slot = entry;
+            break;
+        }
+        if (anj_time_monotonic_lt(entry->expires, slot->expires)) {
+            slot = entry;
+        }
+    }
+
+    memcpy(slot->hostname, hostname, hostname_size);
+    slot->af_setting = af_setting;
+    memset(&slot->addr, 0, sizeof(slot->addr));
+    memcpy(&slot->addr, addr, addr_len);
+    slot->addr_len = addr_len;
+    slot->expires = anj_time_monotonic_add(
+            anj_time_monotonic_now(),
+            anj_time_duration_new(ANJ_NET_RESOLVE_CACHE_TTL_S,
+                                  ANJ_TIME_UNIT_S));
+}
+#    endif // ANJ_NET_WITH_RESOLVE_CACHE
+
+#    ifdef ANJ_NET_WITH_HAPPY_EYEBALLS
+typedef struct {
+    char hostname[CACHED_HOSTNAME_MAX_SIZE];
+    // AF_UNSPEC if the entry is unused
+    sa_family_t family;
+    uint32_t last_used;
+} family_cache_entry_t;
+
+static family_cache_entry_t
+        g_family_cache[ANJ_NET_HAPPY_EYEBALLS_CACHE_ENTRIES];
+static uint32_t g_family_cache_clock;
+
+static family_cache_entry_t *family_cache_find(const char *hostname) {
+    for (size_t i = 0; i < ANJ_NET_HAPPY_EYEBALLS_CACHE_ENTRIES; i++) {
+        family_cache_entry_t *entry = &g_family_cache[i];
+        if (entry->family != AF_UNSPEC && !strcmp(entry->hostname, hostname)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static sa_family_t family_cache_get(const char *hostname) {
+    family_cache_entry_t *entry = family_cache_find(hostname);
+    if (!entry) {
+        return AF_UNSPEC;
+    }
+    entry->last_used = ++g_family_cache_clock;
+    return entry->family;
+}
+
+static void family_cache_put(const char *hostname, sa_family_t family) {
+    size_t hostname_size = strlen(hostname) + 1;
+    if (hostname_size > CACHED_HOSTNAME_MAX_SIZE) {
+        return;
+    }
+
+    // replace the entry for the same host, or the one used least recently
+    family_cache_entry_t *slot = family_cache_find(hostname);
+    if (!slot) {
+        slot = &g_family_cache[0];
+        for (size_t i = 1; i < ANJ_NET_HAPPY_EYEBALLS_CACHE_ENTRIES; i++) {
+            if (g_family_cache[i].last_used < slot->last_used) {
+                slot = &g_family_cache[i];
+            }
+        }
+        memcpy(slot->hostname, hostname, hostname_size);
+    }
+    slot->family = family;
+    slot->last_used = ++g_family_cache_clock;
+}
+#    endif // ANJ_NET_WITH_HAPPY_EYEBALLS
+
+static int net_addrinfo_resolve(anj_net_ctx_posix_impl_t *ctx,
+                                const char *hostname,
+                                const uint16_t port_in_net_order,
+                                struct addrinfo **servinfo) {
+#    ifdef ANJ_NET_WITH_ASYNC_RESOLVE
+    // numeric addresses don't need DNS, so there's no point in waiting
+    int ret = resolve_addrinfo(hostname, ctx->config.af_setting,
+                               AI_NUMERICHOST, servinfo);
+    if (ret != 0) {
+        int poll_result = resolve_job_poll(ctx, hostname, &ret, servinfo);
+        if (poll_result != ANJ_NET_OK) {
+            return poll_result;
+        }
+    }
+#    else  // ANJ_NET_WITH_ASYNC_RESOLVE
+    int ret = resolve_addrinfo(hostname, ctx->config.af_setting, 0, servinfo);
+#    endif // ANJ_NET_WITH_ASYNC_RESOLVE
     if (ret != 0) {
         net_log(L_ERROR, "Address resolution failed for %s:%u: %s", hostname,
                 ntohs(port_in_net_order), gai_strerror(ret));
@@ -395,7 +730,9 @@ static int net_addrinfo_resolve(anj_net_ctx_posix_impl_t *ctx,
         return ANJ_NET_FAILED;
     }
 
-    update_ports(*servinfo, port_in_net_order);
+    for (struct addrinfo *addr = *servinfo; addr; addr = addr->ai_next) {
+        update_port(addr->ai_addr, port_in_net_order);
+    }
 
     net_log(L_DEBUG, "Address resolved successfully for %s:%u", hostname,
             ntohs(port_in_net_order));
@@ -403,6 +740,87 @@ static int net_addrinfo_resolve(anj_net_ctx_posix_impl_t *ctx,
     return ANJ_NET_OK;
 }
 
+static int net_connect_addr(anj_net_ctx_posix_impl_t *ctx,
+                            const struct sockaddr *addr,
+                            socklen_t addr_len) {
+    if (ctx->sockfd == INVALID_SOCKET) {
+        int ret = create_net_socket(ctx, addr->sa_family);
+        if (ret != ANJ_NET_OK) {
+            return ret;
+        }
+    }
+
+    errno = 0;
+    if (connect(ctx->sockfd, addr, addr_len) < 0) {
+        return failure_from_errno();
+    }
+
+    int ret = set_socket_non_blocking(ctx->sockfd);
+    if (ret) {
+        net_log(L_ERROR, "Failed to set socket to non-blocking mode");
+        return ret;
+    }
+
+    return ANJ_NET_OK;
+}
+
+#    ifdef ANJ_NET_WITH_HAPPY_EYEBALLS
+static const struct addrinfo *find_addr_of_family(const struct addrinfo *addr,
+                                                  int family) {
+    while (addr && addr->ai_family != family) {
+        addr = addr->ai_next;
+    }
+    return addr;
+}
+
+/**
+ * Tries the addresses on the @p servinfo list alternately for both families,
+ * as in RFC 8305 section 4, until one of them can be connected to. The family
+ * that worked for @p hostname last time goes first, the preferred one
+ * otherwise.
+ */
+static int net_connect_candidates(anj_net_ctx_posix_impl_t *ctx,
+                                  const char *hostname,
+                                  const struct addrinfo *servinfo,
+                                  const struct addrinfo **out_addr) {
+    int first_family = family_cache_get(hostname);
+    if (first_family == AF_UNSPEC) {
+        first_family = get_preferred_family(ctx->config.af_setting);
+    }
+    const struct addrinfo *next[2] = {
+        find_addr_of_family(servinfo, first_family),
+        find_addr_of_family(servinfo,
+                            first_family == AF_INET ? AF_INET6 : AF_INET)
+    };
+
+    int ret = ANJ_NET_FAILED;
+    size_t turn = 0;
+    while (next[0] || next[1]) {
+        if (!next[turn]) {
+            turn ^= 1;
+        }
+        const struct addrinfo *addr = next[turn];
+        next[turn] = find_addr_of_family(addr->ai_next, addr->ai_family);
+        turn ^= 1;
+
+        ret = net_connect_addr(ctx, addr->ai_addr, addr->ai_addrlen);
+        if (ret == ANJ_NET_OK) {
+            family_cache_put(hostname, (sa_family_t) addr->ai_family);
+            *out_addr = addr;
+            return ANJ_NET_OK;
+        }
+        net_log(L_DEBUG, "Could not connect to %s over IPv%d: %d", hostname,
+                addr->ai_family == AF_INET ? 4 : 6, ret);
+        // the next address may be of the other family
+        if (ctx->sockfd != INVALID_SOCKET) {
+            close(ctx->sockfd);
+            ctx->sockfd = INVALID_SOCKET;
+        }
+    }
+    return ret;
+}
+#    endif // ANJ_NET_WITH_HAPPY_EYEBALLS
+
 static int net_connect_internal(anj_net_ctx_posix_impl_t *ctx,
                                 struct addrinfo **serverinfo,
                                 const char *hostname,
@@ -417,51 +835,55 @@ static int net_connect_internal(anj_net_ctx_posix_impl_t *ctx,
         return ANJ_NET_EINVAL;
     }
 
-    int ai_family;
-    if (set_ai_family(&ai_family, ctx->config.af_setting, true)) {
-        return ANJ_NET_FAILED;
+    if (!hostname) {
+        net_log(L_ERROR, "Invalid arguments for address resolution");
+        return ANJ_NET_EINVAL;
     }
+    const uint16_t port_in_net_order = (uint16_t) htons((uint16_t) port);
+
+#    ifdef ANJ_NET_WITH_RESOLVE_CACHE
+    struct sockaddr_storage cached_addr;
+    socklen_t cached_addr_len;
+    if (!resolve_cache_get(hostname, ctx->config.af_setting, &cached_addr,
+                           &cached_addr_len)) {
+        net_log(L_DEBUG, "Connecting to %s:%s (cached address)", hostname,
+                port_str);
+        update_port((struct sockaddr *) &cached_addr, port_in_net_order);
+        return net_connect_addr(ctx, (const struct sockaddr *) &cached_addr,
+                                cached_addr_len);
+    }
+#    endif // ANJ_NET_WITH_RESOLVE_CACHE
 
-    int ret = net_addrinfo_resolve(ctx, hostname,
-                                   (uint16_t) htons((uint16_t) port),
-                                   serverinfo, ai_family);
+    int ret = net_addrinfo_resolve(ctx, hostname, port_in_net_order,
+                                   serverinfo);
     if (ret != ANJ_NET_OK) {
-        if (!set_ai_family(&ai_family, ctx->config.af_setting, false)) {
-            ret = net_addrinfo_resolve(ctx, hostname,
-                                       (uint16_t) htons((uint16_t) port),
-                                       serverinfo, ai_family);
-        }
-        if (ret != ANJ_NET_OK) {
-            return ret;
-        }
+        return ret;
     }
 
     net_log(L_DEBUG, "Connecting to %s:%s", hostname, port_str);
 
-    struct addrinfo *addr = *serverinfo;
+    const struct addrinfo *addr = *serverinfo;
     if (!addr) {
         return ANJ_NET_FAILED;
     }
 
-    if (ctx->sockfd == INVALID_SOCKET) {
-        ret = create_net_socket(ctx, (sa_family_t) addr->ai_family);
-        if (ret != ANJ_NET_OK) {
-            return ret;
-        }
-    }
-
-    errno = 0;
-    if (connect(ctx->sockfd, addr->ai_addr, addr->ai_addrlen) < 0) {
-        return failure_from_errno();
+#    ifdef ANJ_NET_WITH_HAPPY_EYEBALLS
+    if (is_af_setting_weak(ctx->config.af_setting)) {
+        ret = net_connect_candidates(ctx, hostname, addr, &addr);
+    } else
+#    endif // ANJ_NET_WITH_HAPPY_EYEBALLS
+    {
+        ret = net_connect_addr(ctx, addr->ai_addr, addr->ai_addrlen);
     }
 
-    ret = set_socket_non_blocking(ctx->sockfd);
-    if (ret) {
-        net_log(L_ERROR, "Failed to set socket to non-blocking mode");
-        return ret;
+#    ifdef ANJ_NET_WITH_RESOLVE_CACHE
+    if (ret == ANJ_NET_OK) {
+        resolve_cache_put(hostname, ctx->config.af_setting, addr->ai_addr,
+                          addr->ai_addrlen);
     }
+#    endif // ANJ_NET_WITH_RESOLVE_CACHE
 
-    return ANJ_NET_OK;
+    return ret;
 }
 
 static int
@@ -528,6 +950,59 @@ static int net_send(anj_net_ctx_t *ctx_,
     return net_send_internal(ctx, bytes_sent, buf, length);
 }
 
+#    ifdef ANJ_NET_WITH_SEND_VEC
+/**
+ * Maximum number of buffers passed to a single net_send_vec() call.
+ */
+#        define NET_SEND_VEC_MAX_IOV_COUNT 4
+
+static int net_send_vec(anj_net_ctx_t *ctx_,
+                        size_t *bytes_sent,
+                        const anj_net_iovec_t *iov,
+                        size_t iov_count) {
+    if (!ctx_) {
+        return ANJ_NET_EBADFD;
+    }
+
+    if (!bytes_sent || !iov || iov_count > NET_SEND_VEC_MAX_IOV_COUNT) {
+        return ANJ_NET_EINVAL;
+    }
+    *bytes_sent = 0;
+
+    anj_net_ctx_posix_impl_t *ctx = (anj_net_ctx_posix_impl_t *) ctx_;
+    if (ctx->sockfd < 0) {
+        return ANJ_NET_EBADFD;
+    }
+
+    struct iovec vec[NET_SEND_VEC_MAX_IOV_COUNT];
+    size_t data_size = 0;
+    for (size_t i = 0; i < iov_count; i++) {
+        vec[i].iov_base = (void *) (intptr_t) iov[i].buf;
+        vec[i].iov_len = iov[i].length;
+        data_size += iov[i].length;
+    }
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = vec;
+    msg.msg_iovlen = iov_count;
+
+    errno = 0;
+    ssize_t result = sendmsg(ctx->sockfd, &msg, 0);
+    if (result < 0) {
+        return failure_from_errno();
+    }
+
+    *bytes_sent = (size_t) result;
+
+    /* we did send something but it might be less then we wanted */
+    if ((size_t) result < data_size) {
+        return ANJ_NET_FAILED;
+    }
+    /* all data send */
+    return ANJ_NET_OK;
+}
+#    endif // ANJ_NET_WITH_SEND_VEC
+
 static int net_recv_internal(anj_net_ctx_posix_impl_t *ctx,
                              size_t *bytes_received,
                              uint8_t *data,
@@ -580,6 +1055,148 @@ static int net_recv(anj_net_ctx_t *ctx_,
     return net_recv_internal(ctx, bytes_received, buf, length);
 }
 
+#    ifdef ANJ_NET_WITH_BATCH_IO
+/**
+ * Maximum number of datagrams handled by a single net_recv_batch() or
+ * net_send_batch() call.
+ */
+#        define NET_BATCH_MAX_COUNT 16
+
+#        ifdef NET_WITH_MMSG
+static void prepare_mmsg(struct mmsghdr *msgs,
+                         struct iovec *vec,
+                         const anj_net_datagram_t *datagrams,
+                         size_t count) {
+    memset(msgs, 0, count * sizeof(*msgs));
+    for (size_t i = 0; i < count; i++) {
+        vec[i].iov_base = datagrams[i].buf;
+        vec[i].iov_len = datagrams[i].length;
+        msgs[i].msg_hdr.msg_iov = &vec[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+}
+
+static int net_recv_batch_internal(anj_net_ctx_posix_impl_t *ctx,
+                                   anj_net_datagram_t *datagrams,
+                                   size_t count,
+                                   size_t *out_count) {
+    struct mmsghdr msgs[NET_BATCH_MAX_COUNT];
+    struct iovec vec[NET_BATCH_MAX_COUNT];
+    prepare_mmsg(msgs, vec, datagrams, count);
+
+    errno = 0;
+    int result = recvmmsg(ctx->sockfd, msgs, (unsigned int) count, 0, NULL);
+    if (result < 0) {
+        if (errno == EAGAIN) {
+            return ANJ_NET_EAGAIN;
+        }
+        return failure_from_errno();
+    }
+    if (result == 0) {
+        return ANJ_NET_EAGAIN;
+    }
+
+    for (int i = 0; i < result; i++) {
+        datagrams[i].bytes = msgs[i].msg_len;
+        datagrams[i].truncated = !!(msgs[i].msg_hdr.msg_flags & MSG_TRUNC);
+    }
+    *out_count = (size_t) result;
+    return ANJ_NET_OK;
+}
+
+static int net_send_batch_internal(anj_net_ctx_posix_impl_t *ctx,
+                                   anj_net_datagram_t *datagrams,
+                                   size_t count,
+                                   size_t *out_count) {
+    struct mmsghdr msgs[NET_BATCH_MAX_COUNT];
+    struct iovec vec[NET_BATCH_MAX_COUNT];
+    prepare_mmsg(msgs, vec, datagrams, count);
+
+    errno = 0;
+    int result = sendmmsg(ctx->sockfd, msgs, (unsigned int) count, 0);
+    if (result < 0) {
+        return failure_from_errno();
+    }
+
+    for (int i = 0; i < result; i++) {
+        datagrams[i].bytes = msgs[i].msg_len;
+        /* we did send something but it might be less then we wanted */
+        if (msgs[i].msg_len < datagrams[i].length) {
+            return ANJ_NET_FAILED;
+        }
+        (*out_count)++;
+    }
+    return result > 0 ? ANJ_NET_OK : ANJ_NET_EINPROGRESS;
+}
+#        else  // NET_WITH_MMSG
+static int net_recv_batch_internal(anj_net_ctx_posix_impl_t *ctx,
+                                   anj_net_datagram_t *datagrams,
+                                   size_t count,
+                                   size_t *out_count) {
+    for (size_t i = 0; i < count; i++) {
+        int result = net_recv_internal(ctx, &datagrams[i].bytes,
+                                       datagrams[i].buf, datagrams[i].length);
+        datagrams[i].truncated = (result == ANJ_NET_EMSGSIZE);
+        if (result && result != ANJ_NET_EMSGSIZE) {
+            // errors other than EAGAIN are reported by the next call
+            return i ? ANJ_NET_OK : result;
+        }
+        (*out_count)++;
+    }
+    return ANJ_NET_OK;
+}
+
+static int net_send_batch_internal(anj_net_ctx_posix_impl_t *ctx,
+                                   anj_net_datagram_t *datagrams,
+                                   size_t count,
+                                   size_t *out_count) {
+    for (size_t i = 0; i < count; i++) {
+        int result = net_send_internal(ctx, &datagrams[i].bytes,
+                                       datagrams[i].buf, datagrams[i].length);
+        if (result) {
+            return (i && result == ANJ_NET_EINPROGRESS) ? ANJ_NET_OK : result;
+        }
+        (*out_count)++;
+    }
+    return ANJ_NET_OK;
+}
+#        endif // NET_WITH_MMSG
+
+static int net_batch(anj_net_ctx_t *ctx_,
+                     anj_net_datagram_t *datagrams,
+                     size_t count,
+                     size_t *out_count,
+                     bool recv) {
+    if (!ctx_) {
+        return ANJ_NET_EBADFD;
+    }
+
+    if (!out_count || (!datagrams && count)) {
+        return ANJ_NET_EINVAL;
+    }
+    *out_count = 0;
+
+    anj_net_ctx_posix_impl_t *ctx = (anj_net_ctx_posix_impl_t *) ctx_;
+    if (ctx->sockfd < 0) {
+        return ANJ_NET_EBADFD;
+    }
+
+    if (!count) {
+        return recv ? ANJ_NET_EAGAIN : ANJ_NET_OK;
+    }
+    if (count > NET_BATCH_MAX_COUNT) {
+        count = NET_BATCH_MAX_COUNT;
+    }
+    for (size_t i = 0; i < count; i++) {
+        datagrams[i].bytes = 0;
+        datagrams[i].truncated = false;
+    }
+
+    return recv ? net_recv_batch_internal(ctx, datagrams, count, out_count)
+                : net_send_batch_internal(ctx, datagrams, count, out_count);
+}
+#    endif // ANJ_NET_WITH_BATCH_IO
+
 static int get_mtu(anj_net_ctx_posix_impl_t *ctx, int32_t *out_mtu) {
     if (ctx->sockfd == INVALID_SOCKET) {
         net_log(L_ERROR, "Cannot get MTU for closed socket");
@@ -704,6 +1321,38 @@ static int net_queue_mode_rx_off(anj_net_ctx_t *ctx_) {
     return ANJ_NET_OK;
 }
 
+#    ifdef ANJ_NET_WITH_RELEASE_ASSISTANCE
+static int net_release_assistance(anj_net_ctx_t *ctx_,
+                                  anj_net_release_hint_t hint) {
+    // POSIX sockets have no means of passing the hint to the modem
+    (void) ctx_;
+    (void) hint;
+    return ANJ_NET_OK;
+}
+#    endif // ANJ_NET_WITH_RELEASE_ASSISTANCE
+
+#    ifdef ANJ_NET_WITH_POLL_HANDLE
+static int net_get_poll_handle(anj_net_ctx_t *ctx_,
+                               anj_net_poll_handle_t *out_handle,
+                               bool *out_data_pending) {
+    if (!ctx_) {
+        return ANJ_NET_EBADFD;
+    }
+    if (!out_handle || !out_data_pending) {
+        return ANJ_NET_EINVAL;
+    }
+
+    anj_net_ctx_posix_impl_t *ctx = (anj_net_ctx_posix_impl_t *) ctx_;
+    if (ctx->sockfd < 0) {
+        return ANJ_NET_EBADFD;
+    }
+    out_handle->fd = ctx->sockfd;
+    // datagrams are never buffered outside of the kernel
+    *out_data_pending = false;
+    return ANJ_NET_OK;
+}
+#    endif // ANJ_NET_WITH_POLL_HANDLE
+
 #    ifdef ANJ_NET_WITH_UDP
 
 int anj_udp_create_ctx(anj_net_ctx_t **ctx, const anj_net_config_t *config) {
@@ -727,6 +1376,15 @@ int anj_udp_send(anj_net_ctx_t *ctx,
     return net_send(ctx, bytes_sent, buf, length);
 }
 
+#        ifdef ANJ_NET_WITH_SEND_VEC
+int anj_udp_send_vec(anj_net_ctx_t *ctx,
+                     size_t *bytes_sent,
+                     const anj_net_iovec_t *iov,
+                     size_t iov_count) {
+    return net_send_vec(ctx, bytes_sent, iov, iov_count);
+}
+#        endif // ANJ_NET_WITH_SEND_VEC
+
 int anj_udp_recv(anj_net_ctx_t *ctx,
                  size_t *bytes_received,
                  uint8_t *buf,
@@ -734,6 +1392,22 @@ int anj_udp_recv(anj_net_ctx_t *ctx,
     return net_recv(ctx, bytes_received, buf, length);
 }
 
+#        ifdef ANJ_NET_WITH_BATCH_IO
+int anj_udp_recv_batch(anj_net_ctx_t *ctx,
+                       anj_net_datagram_t *datagrams,
+                       size_t count,
+                       size_t *out_count) {
+    return net_batch(ctx, datagrams, count, out_count, true);
+}
+
+int anj_udp_send_batch(anj_net_ctx_t *ctx,
+                       anj_net_datagram_t *datagrams,
+                       size_t count,
+                       size_t *out_count) {
+    return net_batch(ctx, datagrams, count, out_count, false);
+}
+#        endif // ANJ_NET_WITH_BATCH_IO
+
 int anj_udp_close(anj_net_ctx_t *ctx) {
     return net_close(ctx);
 }
@@ -749,6 +1423,21 @@ int anj_udp_get_inner_mtu(anj_net_ctx_t *ctx, int32_t *out_value) {
 int anj_udp_queue_mode_rx_off(anj_net_ctx_t *ctx) {
     return net_queue_mode_rx_off(ctx);
 }
+
+#        ifdef ANJ_NET_WITH_RELEASE_ASSISTANCE
+int anj_udp_release_assistance(anj_net_ctx_t *ctx,
+                               anj_net_release_hint_t hint) {
+    return net_release_assistance(ctx, hint);
+}
+#        endif // ANJ_NET_WITH_RELEASE_ASSISTANCE
+
+#        ifdef ANJ_NET_WITH_POLL_HANDLE
+int anj_udp_get_poll_handle(anj_net_ctx_t *ctx,
+                            anj_net_poll_handle_t *out_handle,
+                            bool *out_data_pending) {
+    return net_get_poll_handle(ctx, out_handle, out_data_pending);
+}
+#        endif // ANJ_NET_WITH_POLL_HANDLE
 #    endif // ANJ_NET_WITH_UDP
 #else      // ANJ_WITH_SOCKET_POSIX_COMPAT
 // HACK: This typedef suppress empty translation unit warning.
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#define ANJ_LOG_SOURCE_FILE_ID 76
+
+#if !defined(_POSIX_C_SOURCE) && !defined(__APPLE__)
+#    define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <anj/core.h>
+#include <anj/trace.h>
+
+#if defined(ANJ_WITH_TRACE) && defined(ANJ_WITH_TRACE_POSIX_EXPORTER)
+
+#    include <assert.h>
+#    include <errno.h>
+#    include <inttypes.h>
+#    include <stdbool.h>
+#    include <stdio.h>
+#    include <string.h>
+
+#    include <unistd.h>
+
+#    include <anj/log.h>
+#    include <anj/time.h>
+
+#    define trace_log(...) anj_log(trace, __VA_ARGS__)
+
+static int write_all(int fd, const char *data, size_t size) {
+    while (size) {
+        ssize_t written = write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            trace_log(L_ERROR, "Failed to write trace: %s", strerror(errno));
+            return -1;
+        }
+        data += written;
+        size -= (size_t) written;
+    }
+    return 0;
+}
+
+static const char *phase_str(uint8_t phase) {
+    switch (phase) {
+    case ANJ_TRACE_PHASE_BEGIN:
+        return "\"ph\":\"B\"";
+    case ANJ_TRACE_PHASE_END:
+        return "\"ph\":\"E\"";
+    default:
+        return "\"ph\":\"i\",\"s\":\"t\"";
+    }
+}
+
+int anj_core_trace_export_json(anj_t *anj, int fd) {
+    assert(anj);
+    static const char header[] = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    static const char footer[] = "\n]}\n";
+    if (write_all(fd, header, sizeof(header) - 1)) {
+        return -1;
+    }
+    bool first = true;
+    anj_trace_event_t event;
+    while (anj_core_trace_read(anj, &event, 1)) {
+        char line[160];
+        // one track per event source, named after it
+        int len = snprintf(
+                line, sizeof(line),
+                "%s\n{\"name\":\"%s\",%s,\"ts\":%" PRId64
+                ",\"pid\":1,\"tid\":%u,\"args\":{\"value\":%" PRId32 "}}",
+                first ? "" : ",",
+                anj_trace_event_name((anj_trace_event_type_t) event.type),
+                phase_str(event.phase),
+                anj_time_monotonic_to_scalar(event.timestamp, ANJ_TIME_UNIT_US),
+                (unsigned) event.type + 1, event.value);
+        assert(len > 0 && (size_t) len < sizeof(line));
+        if (write_all(fd, line, (size_t) len)) {
+            return -1;
+        }
+        first = false;
+    }
+    return write_all(fd, footer, sizeof(footer) - 1);
+}
+
+#endif // defined(ANJ_WITH_TRACE) && defined(ANJ_WITH_TRACE_POSIX_EXPORTER)
@@ -23,6 +23,7 @@
 
 #include "../coap/coap.h"
 #include "../dm/dm_integration.h"
+#include "../utils.h"
 #include "bootstrap.h"
 
 #ifdef ANJ_WITH_BOOTSTRAP
@@ -74,26 +75,104 @@ static void prepare_bootstrap_request(_anj_coap_msg_t *msg,
     msg->attr.bootstrap_attr.endpoint = endpoint;
 }
 
+static int apply_bootstrap_configuration(anj_t *anj) {
+    _anj_bootstrap_ctx_t *ctx = &anj->state_ctx.bootstrap_ctx;
+    int res = 0;
+#    ifdef ANJ_WITH_BOOTSTRAP_WRITE_BATCHING
+    res = _anj_dm_bootstrap_batch_commit(anj);
+#    endif // ANJ_WITH_BOOTSTRAP_WRITE_BATCHING
+    if (!ctx->error_code && !res) {
+        res = _anj_dm_bootstrap_validation(anj);
+    }
+    if (res) {
+        bootstrap_log(L_ERROR,
+                      "No correct instance of /0 or /1 Object, error: %d",
+                      res);
+        ctx->error_code = _ANJ_BOOTSTRAP_ERR_DATA_MODEL_VALIDATION;
+    }
+    return res;
+}
+
+#    ifdef ANJ_WITH_BOOTSTRAP_PACK
+static uint8_t bootstrap_pack_write_payload(void *arg_ptr,
+                                            uint8_t *payload,
+                                            size_t payload_len,
+                                            bool last_block) {
+    anj_t *anj = (anj_t *) arg_ptr;
+    _anj_bootstrap_timeout_reset(anj);
+    return _anj_dm_bootstrap_pack_write(anj, payload, payload_len, last_block);
+}
+
+static void bootstrap_pack_completion_callback(
+        void *arg_ptr, const _anj_coap_msg_t *response, int result) {
+    (void) response;
+    anj_t *anj = (anj_t *) arg_ptr;
+    _anj_bootstrap_ctx_t *ctx = &anj->state_ctx.bootstrap_ctx;
+    _anj_dm_bootstrap_pack_end(anj);
+
+    if (result == _ANJ_EXCHANGE_ERROR_SERVER_RESPONSE) {
+        // the LwM2M Bootstrap-Server may not support it, then the
+        // configuration is pushed with separate Bootstrap operations
+        bootstrap_log(L_WARNING, "Bootstrap-Pack-Request rejected, sending "
+                                 "Bootstrap-Request");
+        ctx->pack_rejected = true;
+        return;
+    }
+    if (result == _ANJ_EXCHANGE_ERROR_REQUEST) {
+        bootstrap_log(L_ERROR, "Applying Bootstrap-Pack failed");
+        ctx->error_code = _ANJ_BOOTSTRAP_ERR_DATA_MODEL_VALIDATION;
+    } else if (result != _ANJ_EXCHANGE_RESULT_SUCCESS) {
+        bootstrap_log(L_ERROR, "Bootstrap-Pack-Request failed with result %d",
+                      result);
+        ctx->error_code = _ANJ_BOOTSTRAP_ERR_EXCHANGE_ERROR;
+    } else if (!apply_bootstrap_configuration(anj)) {
+        bootstrap_log(L_INFO, "Bootstrap-Pack applied");
+    }
+    // Bootstrap-Pack takes the place of Bootstrap-Finish
+    ctx->bootstrap_finish_handled = true;
+}
+
+static void prepare_bootstrap_pack_request(_anj_coap_msg_t *msg,
+                                           const char *endpoint) {
+    msg->operation = ANJ_OP_BOOTSTRAP_PACK_REQ;
+    msg->accept = _ANJ_COAP_FORMAT_SENML_CBOR;
+    msg->attr.bootstrap_attr.has_endpoint = true;
+    msg->attr.bootstrap_attr.endpoint = endpoint;
+}
+#    endif // ANJ_WITH_BOOTSTRAP_PACK
+
 int _anj_bootstrap_process(anj_t *anj,
                            _anj_coap_msg_t *out_msg,
                            _anj_exchange_handlers_t *out_handlers) {
     assert(anj && out_msg && out_handlers);
-    _anj_bootstrap_ctx_t *ctx = &anj->bootstrap_ctx;
+    _anj_bootstrap_ctx_t *ctx = &anj->state_ctx.bootstrap_ctx;
 
     if (!ctx->in_progress) {
         ctx->in_progress = true;
         ctx->bootstrap_finish_handled = false;
         ctx->error_code = _ANJ_BOOTSTRAP_IN_PROGRESS;
         ctx->bootstrap_finish_timeout =
-                anj_time_monotonic_add(anj_time_monotonic_now(),
+                anj_time_monotonic_add(_ANJ_STEP_TIME_NOW(&anj->step_time),
                                        ctx->bootstrap_lifetime);
 
+        bootstrap_log(L_INFO, "Bootstrap sequence started");
+#    ifdef ANJ_WITH_BOOTSTRAP_PACK
+        ctx->pack_rejected = false;
+        if (!_anj_dm_bootstrap_pack_begin(anj)) {
+            *out_handlers = (_anj_exchange_handlers_t) {
+                .write_payload = bootstrap_pack_write_payload,
+                .completion = bootstrap_pack_completion_callback,
+                .arg = anj
+            };
+            prepare_bootstrap_pack_request(out_msg, ctx->endpoint);
+            return _ANJ_BOOTSTRAP_NEW_REQUEST_TO_SEND;
+        }
+#    endif // ANJ_WITH_BOOTSTRAP_PACK
         *out_handlers = (_anj_exchange_handlers_t) {
             .completion = bootstrap_request_completion_callback,
             .arg = ctx
         };
         prepare_bootstrap_request(out_msg, ctx->endpoint);
-        bootstrap_log(L_INFO, "Bootstrap sequence started");
         return _ANJ_BOOTSTRAP_NEW_REQUEST_TO_SEND;
     } // return validation error after bootstrap-finish handling
     else if ((ctx->bootstrap_finish_handled
@@ -101,14 +180,32 @@ int _anj_bootstrap_process(anj_t *anj,
              || ctx->error_code == _ANJ_BOOTSTRAP_ERR_EXCHANGE_ERROR
              || ctx->error_code == _ANJ_BOOTSTRAP_ERR_NETWORK) {
         ctx->in_progress = false;
+#    ifdef ANJ_WITH_BOOTSTRAP_WRITE_BATCHING
+        _anj_dm_bootstrap_batch_commit(anj);
+#    endif // ANJ_WITH_BOOTSTRAP_WRITE_BATCHING
         return ctx->error_code;
     } else if (ctx->bootstrap_finish_handled) {
         ctx->in_progress = false;
         bootstrap_log(L_INFO, "Bootstrap finished successfully");
         return _ANJ_BOOTSTRAP_FINISHED;
-    } else if (anj_time_monotonic_gt(anj_time_monotonic_now(),
+    }
+#    ifdef ANJ_WITH_BOOTSTRAP_PACK
+    else if (ctx->pack_rejected) {
+        ctx->pack_rejected = false;
+        *out_handlers = (_anj_exchange_handlers_t) {
+            .completion = bootstrap_request_completion_callback,
+            .arg = ctx
+        };
+        prepare_bootstrap_request(out_msg, ctx->endpoint);
+        return _ANJ_BOOTSTRAP_NEW_REQUEST_TO_SEND;
+    }
+#    endif // ANJ_WITH_BOOTSTRAP_PACK
+    else if (anj_time_monotonic_gt(_ANJ_STEP_TIME_NOW(&anj->step_time),
                                      ctx->bootstrap_finish_timeout)) {
         ctx->in_progress = false;
+#    ifdef ANJ_WITH_BOOTSTRAP_WRITE_BATCHING
+        _anj_dm_bootstrap_batch_commit(anj);
+#    endif // ANJ_WITH_BOOTSTRAP_WRITE_BATCHING
         ctx->error_code = _ANJ_BOOTSTRAP_ERR_BOOTSTRAP_TIMEOUT;
         bootstrap_log(L_ERROR, "Bootstrap timeout");
         return ctx->error_code;
@@ -120,7 +217,7 @@ void _anj_bootstrap_finish_request(anj_t *anj,
                                    uint8_t *out_response_code,
                                    _anj_exchange_handlers_t *out_handlers) {
     assert(anj && out_response_code && out_handlers);
-    _anj_bootstrap_ctx_t *ctx = &anj->bootstrap_ctx;
+    _anj_bootstrap_ctx_t *ctx = &anj->state_ctx.bootstrap_ctx;
     bootstrap_log(L_INFO, "Bootstrap-Finish received");
     if (!ctx->in_progress) {
         *out_response_code = ANJ_COAP_CODE_NOT_ACCEPTABLE;
@@ -128,15 +225,7 @@ void _anj_bootstrap_finish_request(anj_t *anj,
         return;
     }
 
-    int res = 0;
-    if (!ctx->error_code) {
-        res = _anj_dm_bootstrap_validation(anj);
-    }
-    if (res) {
-        bootstrap_log(L_ERROR,
-                      "No correct instance of /0 or /1 Object, error: %d",
-                      res);
-        ctx->error_code = _ANJ_BOOTSTRAP_ERR_DATA_MODEL_VALIDATION;
+    if (apply_bootstrap_configuration(anj)) {
         *out_response_code = ANJ_COAP_CODE_NOT_ACCEPTABLE;
     } else {
         *out_response_code = ANJ_COAP_CODE_CHANGED;
@@ -149,16 +238,16 @@ void _anj_bootstrap_finish_request(anj_t *anj,
 
 void _anj_bootstrap_connection_lost(anj_t *anj) {
     assert(anj);
-    anj->bootstrap_ctx.error_code = _ANJ_BOOTSTRAP_ERR_NETWORK;
+    anj->state_ctx.bootstrap_ctx.error_code = _ANJ_BOOTSTRAP_ERR_NETWORK;
     bootstrap_log(L_ERROR, "Connection lost");
 }
 
 void _anj_bootstrap_timeout_reset(anj_t *anj) {
     assert(anj);
-    _anj_bootstrap_ctx_t *ctx = &anj->bootstrap_ctx;
+    _anj_bootstrap_ctx_t *ctx = &anj->state_ctx.bootstrap_ctx;
     assert(ctx->in_progress);
     ctx->bootstrap_finish_timeout =
-            anj_time_monotonic_add(anj_time_monotonic_now(),
+            anj_time_monotonic_add(_ANJ_STEP_TIME_NOW(&anj->step_time),
                                    ctx->bootstrap_lifetime);
 }
 
@@ -166,7 +255,7 @@ void _anj_bootstrap_ctx_init(anj_t *anj,
                              const char *endpoint,
                              const anj_time_duration_t lifetime) {
     assert(anj && endpoint);
-    _anj_bootstrap_ctx_t *ctx = &anj->bootstrap_ctx;
+    _anj_bootstrap_ctx_t *ctx = &anj->state_ctx.bootstrap_ctx;
     memset(ctx, 0, sizeof(*ctx));
     ctx->in_progress = false;
     ctx->endpoint = endpoint;
@@ -175,7 +264,7 @@ void _anj_bootstrap_ctx_init(anj_t *anj,
 
 void _anj_bootstrap_reset(anj_t *anj) {
     assert(anj);
-    _anj_bootstrap_ctx_t *ctx = &anj->bootstrap_ctx;
+    _anj_bootstrap_ctx_t *ctx = &anj->state_ctx.bootstrap_ctx;
     ctx->in_progress = false;
 }
 
@@ -17,6 +17,9 @@
 #include <string.h>
 
 #include <anj/compat/net/anj_net_api.h>
+#ifdef ANJ_WITH_SMS_TRIGGER
+#    include <anj/compat/net/anj_sms_trigger.h>
+#endif // ANJ_WITH_SMS_TRIGGER
 #include <anj/compat/time.h>
 #include <anj/core.h>
 #include <anj/defs.h>
@@ -26,6 +29,8 @@
 
 #ifdef ANJ_WITH_LWM2M_SEND
 #    include <anj/lwm2m_send.h>
+
+#    include "lwm2m_send.h"
 #endif // ANJ_WITH_LWM2M_SEND
 
 #ifdef ANJ_WITH_BOOTSTRAP
@@ -40,13 +45,21 @@
 #    include <anj/compat/crypto/storage.h>
 #endif // ANJ_WITH_EXTERNAL_CRYPTO_STORAGE
 
+#ifdef ANJ_WITH_LWM2M_GATEWAY
+#    include "../dm/dm_integration.h"
+#endif // ANJ_WITH_LWM2M_GATEWAY
+
 #include "../dm/dm_io.h"
 #include "../exchange.h"
+#include "../trace.h"
 #include "core.h"
 #include "core_utils.h"
+#include "dm_change_queue.h"
+#include "msg_buffer_pool.h"
 #include "reg_session.h"
 #include "register.h"
 #include "server_register.h"
+#include "session_persistence.h"
 #include "srv_conn.h"
 
 #ifdef ANJ_WITH_BOOTSTRAP
@@ -66,6 +79,41 @@ void _anj_core_state_transition_clear(anj_t *anj) {
     anj->server_state.disable_triggered = false;
 }
 
+#ifdef ANJ_WITH_MSG_BUFFER_ARENA
+static int setup_msg_buffer_arena(anj_t *anj,
+                                  const anj_configuration_t *config) {
+#    if !defined(ANJ_WITH_MSG_BUFFER_POOL) || defined(ANJ_WITH_CACHE)
+    if (!config->msg_buffer_arena
+            || config->msg_buffer_arena_size < ANJ_MSG_BUFFER_ARENA_SIZE) {
+        log(L_ERROR, "Message buffer arena not provided or too small");
+        return -1;
+    }
+    uint8_t *arena = config->msg_buffer_arena;
+#    endif // !defined(ANJ_WITH_MSG_BUFFER_POOL) || defined(ANJ_WITH_CACHE)
+#    ifdef ANJ_WITH_MSG_BUFFER_POOL
+    // buffers are borrowed in anj_core_step()
+    if (!config->msg_buffer_pool) {
+        log(L_ERROR, "Message buffer pool not provided");
+        return -1;
+    }
+    anj->msg_buffer_pool = config->msg_buffer_pool;
+#    else  // ANJ_WITH_MSG_BUFFER_POOL
+    // Incoming message is fully processed before the outgoing one is encoded
+    // and the outgoing message is fully sent before the next one is received.
+    // Retransmissions are encoded again from the payload buffer.
+    anj->in_buffer = arena;
+    anj->out_buffer = arena;
+    arena += _ANJ_MSG_BUFFER_ARENA_IN_OUT_SIZE;
+    anj->payload_buffer = arena;
+    arena += ANJ_OUT_PAYLOAD_BUFFER_SIZE;
+#    endif // ANJ_WITH_MSG_BUFFER_POOL
+#    ifdef ANJ_WITH_CACHE
+    anj->exchange_cache.cache_recent.payload = arena;
+#    endif // ANJ_WITH_CACHE
+    return 0;
+}
+#endif // ANJ_WITH_MSG_BUFFER_ARENA
+
 int anj_core_init(anj_t *anj, const anj_configuration_t *config) {
     assert(anj && config);
 
@@ -75,6 +123,20 @@ int anj_core_init(anj_t *anj, const anj_configuration_t *config) {
         log(L_ERROR, "Endpoint name not provided");
         return -1;
     }
+#ifdef ANJ_WITH_MSG_BUFFER_ARENA
+    if (setup_msg_buffer_arena(anj, config)) {
+        return -1;
+    }
+#endif // ANJ_WITH_MSG_BUFFER_ARENA
+#ifdef ANJ_WITH_TRANSIENT_ALLOC
+    if (config->transient_alloc && !config->transient_free) {
+        log(L_ERROR, "Transient buffer allocator without free function");
+        return -1;
+    }
+    anj->transient_alloc = config->transient_alloc;
+    anj->transient_free = config->transient_free;
+    anj->transient_alloc_arg = config->transient_alloc_arg;
+#endif // ANJ_WITH_TRANSIENT_ALLOC
 #ifdef ANJ_WITH_EXTERNAL_CRYPTO_STORAGE
     int result = anj_crypto_storage_init(&anj->crypto_ctx);
     if (result) {
@@ -92,16 +154,59 @@ int anj_core_init(anj_t *anj, const anj_configuration_t *config) {
 
     anj->endpoint_name = config->endpoint_name;
     anj->queue_mode_enabled = config->queue_mode_enabled;
+#ifdef ANJ_WITH_SCHEDULING_JITTER
+    if (config->update_spread_percent > 100
+            || config->retry_spread_percent > 100) {
+        log(L_ERROR, "Invalid scheduling jitter configuration");
+        return -1;
+    }
+    anj->jitter_seed = _anj_core_utils_jitter_seed(config->endpoint_name);
+    anj->register_spread = config->register_spread;
+    anj->update_spread_percent = config->update_spread_percent;
+    anj->retry_spread_percent = config->retry_spread_percent;
+#endif // ANJ_WITH_SCHEDULING_JITTER
 
     _anj_dm_initialize(anj);
+#ifdef ANJ_DM_WITH_CHANGE_QUEUE
+    _anj_dm_change_queue_init(&anj->dm_change_queue);
+#endif // ANJ_DM_WITH_CHANGE_QUEUE
 
     if (_anj_exchange_init(&anj->exchange_ctx)) {
         log(L_ERROR, "Exchange module initialization failed");
         return -1;
     }
+#ifdef ANJ_WITH_PIPELINED_NOTIFICATIONS
+    // tx params and cache are copied when a pipelined request is created
+    for (size_t i = 0; i < _ANJ_PIPELINED_EXCHANGES_NUMBER; i++) {
+        if (_anj_exchange_init(&anj->pipelined[i].exchange_ctx)) {
+            log(L_ERROR, "Exchange module initialization failed");
+            return -1;
+        }
+        anj->pipelined[i].anj = anj;
+    }
+#endif // ANJ_WITH_PIPELINED_NOTIFICATIONS
 #ifdef ANJ_WITH_CACHE
     _anj_exchange_setup_cache(&anj->exchange_ctx, &anj->exchange_cache);
 #endif // ANJ_WITH_CACHE
+#ifdef ANJ_WITH_METRICS
+    _anj_exchange_setup_metrics(&anj->exchange_ctx, &anj->metrics);
+#endif // ANJ_WITH_METRICS
+#ifdef ANJ_WITH_TRACE
+    _anj_exchange_setup_trace(&anj->exchange_ctx, &anj->trace);
+#endif // ANJ_WITH_TRACE
+#ifdef ANJ_WITH_STEP_TIME_CACHE
+    _anj_exchange_setup_step_time(&anj->exchange_ctx, &anj->step_time);
+#endif // ANJ_WITH_STEP_TIME_CACHE
+#ifdef ANJ_WITH_BLOCK2_PREFETCH
+    _anj_exchange_setup_prefetch_buffer(&anj->exchange_ctx,
+                                        anj->prefetch_payload_buffer,
+                                        sizeof(anj->prefetch_payload_buffer));
+#endif // ANJ_WITH_BLOCK2_PREFETCH
+#ifdef ANJ_WITH_OBSERVE
+    _anj_exchange_setup_token_check(&anj->exchange_ctx,
+                                    _anj_observe_token_in_use,
+                                    &anj->observe_ctx);
+#endif // ANJ_WITH_OBSERVE
     if (config->udp_tx_params) {
         _anj_exchange_set_udp_tx_params(&anj->exchange_ctx,
                                         config->udp_tx_params);
@@ -119,28 +224,42 @@ int anj_core_init(anj_t *anj, const anj_configuration_t *config) {
                         ? _anj_srv_conn_calculate_max_transmit_wait(
                                   &anj->exchange_ctx.tx_params)
                         : config->queue_mode_timeout;
+#ifdef ANJ_WITH_QUEUE_MODE_WAKE_WINDOW
+        anj->queue_mode_wake_window = config->queue_mode_wake_window;
+#endif // ANJ_WITH_QUEUE_MODE_WAKE_WINDOW
     }
+#ifdef ANJ_WITH_UPDATE_HOLD_DOWN
+    anj->update_hold_down = config->update_hold_down;
+#endif // ANJ_WITH_UPDATE_HOLD_DOWN
+#ifdef ANJ_WITH_NAT_KEEPALIVE_PROBING
+    _anj_srv_conn_nat_init(&anj->nat, config->nat_keepalive_min,
+                           config->nat_keepalive_max);
+#endif // ANJ_WITH_NAT_KEEPALIVE_PROBING
 
     _anj_register_ctx_init(anj);
 #ifdef ANJ_WITH_BOOTSTRAP
-    anj_time_duration_t bootstrap_process_lifetime;
     if (anj_time_duration_eq(config->bootstrap_timeout,
                              ANJ_TIME_DURATION_ZERO)) {
-        bootstrap_process_lifetime =
+        anj->bootstrap_timeout =
                 anj_time_duration_new(_ANJ_CORE_BOOTSTRAP_DEFAULT_TIMEOUT,
                                       ANJ_TIME_UNIT_S);
     } else {
-        bootstrap_process_lifetime = config->bootstrap_timeout;
+        anj->bootstrap_timeout = config->bootstrap_timeout;
     }
-
-    _anj_bootstrap_ctx_init(anj, anj->endpoint_name,
-                            bootstrap_process_lifetime);
     anj->bootstrap_retry_count = config->bootstrap_retry_count;
     anj->bootstrap_retry_timeout = config->bootstrap_retry_timeout;
 
 #endif // ANJ_WITH_BOOTSTRAP
 #ifdef ANJ_WITH_OBSERVE
     _anj_observe_init(anj);
+#    ifdef ANJ_OBSERVE_WITH_USER_STORAGE
+    if (_anj_observe_set_storage(anj, config->observations,
+                                 config->observations_number,
+                                 config->write_attributes,
+                                 config->write_attributes_number)) {
+        return -1;
+    }
+#    endif // ANJ_OBSERVE_WITH_USER_STORAGE
 #endif // ANJ_WITH_OBSERVE
 
     if (config->connection_status_cb) {
@@ -149,6 +268,7 @@ int anj_core_init(anj_t *anj, const anj_configuration_t *config) {
     }
 
     anj->server_state.conn_status = ANJ_CONN_STATUS_INITIAL;
+    _ANJ_TRACE(&anj->trace, CONN_STATUS, BEGIN, anj->server_state.conn_status);
     log(L_INFO, "Anjay Lite initialized");
     return 0;
 }
@@ -162,7 +282,7 @@ void anj_core_server_obj_disable_executed(anj_t *anj, uint32_t timeout) {
     log(L_INFO, "Disable resource executed");
     anj->server_state.disable_triggered = true;
     anj->server_state.enable_time = anj_time_monotonic_add(
-            anj_time_monotonic_now(),
+            _ANJ_CORE_NOW(anj),
             anj_time_duration_new(timeout, ANJ_TIME_UNIT_S));
 }
 
@@ -206,8 +326,35 @@ void _anj_core_data_model_changed_with_ssid(anj_t *anj,
                                             const anj_uri_path_t *path,
                                             anj_core_change_type_t change_type,
                                             uint16_t ssid) {
+#ifdef ANJ_DM_WITH_READ_CACHE
+    _anj_dm_read_cache_invalidate(&anj->dm, path);
+#endif // ANJ_DM_WITH_READ_CACHE
+#ifdef ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+    if (!anj_uri_path_has(path, ANJ_ID_OID)
+            || path->ids[ANJ_ID_OID] == ANJ_OBJ_ID_DEVICE) {
+        anj->dm.device_read_cache_valid = false;
+    }
+#endif // ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+#ifdef ANJ_WITH_LWM2M_GATEWAY
+    if (_anj_dm_gateway_device_selected(anj)) {
+        // changes of End IoT Devices are reported as changes of /25/x/3
+        return;
+    }
+#endif // ANJ_WITH_LWM2M_GATEWAY
+    if (change_type != ANJ_CORE_CHANGE_TYPE_VALUE_CHANGED) {
+        _anj_dm_structure_changed(&anj->dm);
+    }
+#ifdef ANJ_WITH_SERVER_DATA_CACHE
+    if (!anj_uri_path_has(path, ANJ_ID_OID)
+            || path->ids[ANJ_ID_OID] == ANJ_OBJ_ID_SECURITY
+            || path->ids[ANJ_ID_OID] == ANJ_OBJ_ID_SERVER) {
+        anj->server_instance.dm_data_cached = false;
+        anj->server_instance.reg_resources_cached = false;
+    }
+#endif // ANJ_WITH_SERVER_DATA_CACHE
     // we don't to check the return value of this function
 #ifdef ANJ_WITH_OBSERVE
+    _ANJ_CORE_NEXT_NOTIFICATION_CHANGED(anj);
     anj_observe_data_model_changed(
             anj, path, (anj_observe_change_type_t) change_type, ssid);
 #endif // ANJ_WITH_OBSERVE
@@ -238,6 +385,26 @@ void anj_core_data_model_changed(anj_t *anj,
     _anj_core_data_model_changed_with_ssid(anj, path, change_type, 0);
 }
 
+#ifdef ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER
+void anj_core_set_notify_store_buffer(anj_t *anj,
+                                      anj_io_out_entry_t *buffer,
+                                      size_t buffer_size) {
+    assert(anj);
+    _ANJ_CORE_NEXT_NOTIFICATION_CHANGED(anj);
+    _anj_observe_notify_store_set_buffer(anj, buffer, buffer_size);
+}
+#endif // ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER
+
+void anj_core_data_model_changed_batch(anj_t *anj,
+                                       const anj_uri_path_t *paths,
+                                       size_t paths_count,
+                                       anj_core_change_type_t change_type) {
+    assert(anj && (paths || !paths_count));
+    for (size_t i = 0; i < paths_count; i++) {
+        _anj_core_data_model_changed_with_ssid(anj, &paths[i], change_type, 0);
+    }
+}
+
 static _anj_core_next_action_t anj_core_step_internal(anj_t *anj) {
     switch (anj->server_state.conn_status) {
     case ANJ_CONN_STATUS_INITIAL: {
@@ -297,9 +464,24 @@ bool anj_core_ongoing_operation(anj_t *anj) {
 
 static void init_new_conn_status(anj_t *anj,
                                  anj_conn_status_t last_conn_status) {
+#ifdef ANJ_WITH_SESSION_PERSISTENCE
+    if (anj->server_state.conn_status != ANJ_CONN_STATUS_REGISTERING
+            && anj->server_state.conn_status != ANJ_CONN_STATUS_REGISTERED) {
+        _anj_core_session_resume_drop(anj);
+    }
+#endif // ANJ_WITH_SESSION_PERSISTENCE
+#ifdef ANJ_WITH_BOOTSTRAP
+    // state_ctx is shared by Bootstrap and Register, the latter must start
+    // from scratch once the former has used it
+    if (last_conn_status == ANJ_CONN_STATUS_BOOTSTRAPPING) {
+        _anj_register_ctx_init(anj);
+    }
+#endif // ANJ_WITH_BOOTSTRAP
     switch (anj->server_state.conn_status) {
 #ifdef ANJ_WITH_BOOTSTRAP
     case ANJ_CONN_STATUS_BOOTSTRAPPING:
+        _anj_bootstrap_ctx_init(anj, anj->endpoint_name,
+                                anj->bootstrap_timeout);
         if (_anj_server_bootstrap_start_bootstrap_operation(anj)) {
             anj->server_state.conn_status = ANJ_CONN_STATUS_INVALID;
         }
@@ -322,9 +504,25 @@ static void init_new_conn_status(anj_t *anj,
     }
 }
 
-void anj_core_step(anj_t *anj) {
-    assert(anj);
+#ifdef ANJ_WITH_BUDGETED_STEP
+// Called after each action which is going to be followed by another one
+static bool step_budget_exhausted(anj_t *anj) {
+    _anj_step_budget_t *budget = &anj->step_budget;
+    if (!budget->active) {
+        return false;
+    }
+    if (budget->actions_left && !--budget->actions_left) {
+        budget->exhausted = true;
+    } else if (anj_time_monotonic_is_valid(budget->deadline)
+               && !anj_time_monotonic_lt(anj_time_monotonic_now(),
+                                         budget->deadline)) {
+        budget->exhausted = true;
+    }
+    return budget->exhausted;
+}
+#endif // ANJ_WITH_BUDGETED_STEP
 
+static void core_step(anj_t *anj) {
     _anj_core_next_action_t next_action = _ANJ_CORE_NEXT_ACTION_CONTINUE;
     while (next_action == _ANJ_CORE_NEXT_ACTION_CONTINUE) {
         anj_conn_status_t last_conn_status = anj->server_state.conn_status;
@@ -360,6 +558,9 @@ void anj_core_step(anj_t *anj) {
         }
 
         if (anj->server_state.conn_status != last_conn_status) {
+            _ANJ_TRACE(&anj->trace, CONN_STATUS, END, last_conn_status);
+            _ANJ_TRACE(&anj->trace, CONN_STATUS, BEGIN,
+                       anj->server_state.conn_status);
             if (anj->conn_status_cb) {
                 anj->conn_status_cb(anj->conn_status_cb_arg, anj,
                                     anj->server_state.conn_status);
@@ -368,12 +569,103 @@ void anj_core_step(anj_t *anj) {
             log(L_TRACE, "Connection status changed from %d to %d",
                 (int) last_conn_status, (int) anj->server_state.conn_status);
         }
+        // outside of queue mode, requests of the server and exchanges may
+        // change Observations at any time
+        if (last_conn_status != ANJ_CONN_STATUS_QUEUE_MODE
+                || anj->server_state.conn_status
+                               != ANJ_CONN_STATUS_QUEUE_MODE) {
+            _ANJ_CORE_NEXT_NOTIFICATION_CHANGED(anj);
+        }
+#ifdef ANJ_WITH_BUDGETED_STEP
+        if (next_action == _ANJ_CORE_NEXT_ACTION_CONTINUE
+                && step_budget_exhausted(anj)) {
+            return;
+        }
+#endif // ANJ_WITH_BUDGETED_STEP
+    }
+}
+
+#ifdef ANJ_WITH_SMS_TRIGGER
+static void poll_sms_trigger(anj_t *anj) {
+    if (_anj_core_client_registered(anj)
+            && anj_sms_trigger_received(anj->server_instance.ssid)) {
+        log(L_INFO, "Registration Update Trigger received over SMS");
+        anj->server_state.registration_update_triggered = true;
+    }
+}
+#endif // ANJ_WITH_SMS_TRIGGER
+
+void anj_core_step(anj_t *anj) {
+    assert(anj);
+#ifdef ANJ_WITH_STEP_TIME_CACHE
+    anj->step_time.now = anj_time_monotonic_now();
+    anj->step_time.valid = true;
+#endif // ANJ_WITH_STEP_TIME_CACHE
+#ifdef ANJ_DM_WITH_CHANGE_QUEUE
+    _anj_dm_change_queue_drain(anj);
+#endif // ANJ_DM_WITH_CHANGE_QUEUE
+#ifdef ANJ_WITH_SMS_TRIGGER
+    poll_sms_trigger(anj);
+#endif // ANJ_WITH_SMS_TRIGGER
+#ifdef ANJ_WITH_MSG_BUFFER_POOL
+    if (!_anj_msg_buffer_pool_acquire(anj)) {
+        core_step(anj);
+    }
+    _anj_msg_buffer_pool_release(anj, false);
+#else  // ANJ_WITH_MSG_BUFFER_POOL
+    core_step(anj);
+#endif // ANJ_WITH_MSG_BUFFER_POOL
+#ifdef ANJ_WITH_STEP_TIME_CACHE
+    anj->step_time.valid = false;
+#endif // ANJ_WITH_STEP_TIME_CACHE
+}
+
+#ifdef ANJ_WITH_BUDGETED_STEP
+anj_core_step_result_t
+anj_core_step_budgeted(anj_t *anj,
+                       const anj_core_step_budget_t *budget,
+                       anj_time_duration_t *out_timeout,
+                       anj_net_poll_handle_t *out_handle) {
+    assert(anj && budget && out_timeout && out_handle);
+    anj->step_budget = (_anj_step_budget_t) {
+        .active = true,
+        .actions_left = budget->max_actions,
+        .deadline = anj_time_duration_is_valid(budget->max_time)
+                            ? anj_time_monotonic_add(anj_time_monotonic_now(),
+                                                     budget->max_time)
+                            : ANJ_TIME_MONOTONIC_INVALID
+    };
+    anj_core_step(anj);
+    anj->step_budget.active = false;
+
+    if (anj->step_budget.exhausted) {
+        *out_timeout = ANJ_TIME_DURATION_ZERO;
+        return ANJ_CORE_STEP_YIELDED;
+    }
+    if (anj->server_state.conn_status == ANJ_CONN_STATUS_FAILURE
+            && !_anj_core_state_transition_forced(anj)) {
+        *out_timeout = ANJ_TIME_DURATION_INVALID;
+        return ANJ_CORE_STEP_WAITS_FOR_APP;
+    }
+    switch (anj_core_next_wakeup(anj, out_timeout, out_handle)) {
+    case ANJ_CORE_WAKEUP_TIMER:
+        return ANJ_CORE_STEP_WAITS_FOR_TIMER;
+    case ANJ_CORE_WAKEUP_NET_OR_TIMER:
+        return ANJ_CORE_STEP_WAITS_FOR_NET;
+    default:
+        return ANJ_CORE_STEP_YIELDED;
     }
 }
+#endif // ANJ_WITH_BUDGETED_STEP
 
 anj_time_duration_t anj_core_next_step_time(anj_t *anj) {
     assert(anj);
-    anj_time_monotonic_t current_time = anj_time_monotonic_now();
+#ifdef ANJ_DM_WITH_CHANGE_QUEUE
+    if (_anj_dm_change_queue_pending(&anj->dm_change_queue)) {
+        return ANJ_TIME_DURATION_ZERO;
+    }
+#endif // ANJ_DM_WITH_CHANGE_QUEUE
+    anj_time_monotonic_t current_time = _ANJ_CORE_NOW(anj);
     if (anj->server_state.conn_status == ANJ_CONN_STATUS_SUSPENDED) {
         anj_time_monotonic_t enable_time;
         if (anj_time_monotonic_gt(anj->server_state.enable_time_user_triggered,
@@ -390,6 +682,23 @@ anj_time_duration_t anj_core_next_step_time(anj_t *anj) {
         anj_time_monotonic_t next_update_time =
                 anj->server_state.details.registered.next_update_time;
         assert(anj_time_monotonic_is_valid(next_update_time));
+#ifdef ANJ_WITH_LWM2M_SEND
+        // queued Send request makes the client leave queue mode
+        anj_time_monotonic_t send_time = _anj_lwm2m_send_ready_time(anj);
+        if (anj_time_monotonic_is_valid(send_time)
+                && anj_time_monotonic_lt(send_time, next_update_time)) {
+            next_update_time = send_time;
+        }
+#endif // ANJ_WITH_LWM2M_SEND
+#ifdef ANJ_WITH_UPDATE_HOLD_DOWN
+        // held back Update makes the client leave queue mode too
+        anj_time_monotonic_t hold_down_end =
+                anj->server_state.details.registered.update_hold_down_end;
+        if (anj_time_monotonic_is_valid(hold_down_end)
+                && anj_time_monotonic_lt(hold_down_end, next_update_time)) {
+            next_update_time = hold_down_end;
+        }
+#endif // ANJ_WITH_UPDATE_HOLD_DOWN
         anj_time_duration_t time_to_next_update;
         if (!anj_time_monotonic_lt(next_update_time, current_time)) {
             time_to_next_update =
@@ -400,9 +709,8 @@ anj_time_duration_t anj_core_next_step_time(anj_t *anj) {
 #ifdef ANJ_WITH_OBSERVE
         anj_time_duration_t time_to_next_notification = ANJ_TIME_DURATION_ZERO;
 
-        if (!anj_observe_time_to_next_notification(
-                    anj, &anj->server_instance.observe_state,
-                    &time_to_next_notification)) {
+        if (!_anj_core_utils_time_to_next_notification(
+                    anj, &time_to_next_notification)) {
             if (!anj_time_duration_is_valid(time_to_next_notification)) {
                 return time_to_next_update;
             } else {
@@ -418,6 +726,51 @@ anj_time_duration_t anj_core_next_step_time(anj_t *anj) {
     return ANJ_TIME_DURATION_ZERO;
 }
 
+#ifdef ANJ_NET_WITH_POLL_HANDLE
+anj_core_wakeup_t anj_core_next_wakeup(anj_t *anj,
+                                       anj_time_duration_t *out_timeout,
+                                       anj_net_poll_handle_t *out_handle) {
+    assert(anj && out_timeout && out_handle);
+#    ifdef ANJ_DM_WITH_CHANGE_QUEUE
+    if (_anj_dm_change_queue_pending(&anj->dm_change_queue)) {
+        *out_timeout = ANJ_TIME_DURATION_ZERO;
+        return ANJ_CORE_WAKEUP_NOW;
+    }
+#    endif // ANJ_DM_WITH_CHANGE_QUEUE
+    anj_time_monotonic_t deadline;
+    if (!_anj_reg_session_waits_for_msg(anj, &deadline)) {
+        *out_timeout = anj_core_next_step_time(anj);
+        return anj_time_duration_gt(*out_timeout, ANJ_TIME_DURATION_ZERO)
+                       ? ANJ_CORE_WAKEUP_TIMER
+                       : ANJ_CORE_WAKEUP_NOW;
+    }
+
+    *out_timeout = ANJ_TIME_DURATION_ZERO;
+    anj_time_monotonic_t current_time = _ANJ_CORE_NOW(anj);
+    if (anj_time_monotonic_is_valid(deadline)
+            && !anj_time_monotonic_gt(deadline, current_time)) {
+        return ANJ_CORE_WAKEUP_NOW;
+    }
+    bool data_pending;
+    if (_anj_srv_conn_get_poll_handle(&anj->connection_ctx, out_handle,
+                                      &data_pending)
+            || data_pending) {
+        return ANJ_CORE_WAKEUP_NOW;
+    }
+    *out_timeout = anj_time_monotonic_is_valid(deadline)
+                           ? anj_time_monotonic_diff(deadline, current_time)
+                           : ANJ_TIME_DURATION_INVALID;
+    return ANJ_CORE_WAKEUP_NET_OR_TIMER;
+}
+#endif // ANJ_NET_WITH_POLL_HANDLE
+
+static void terminate_exchanges(anj_t *anj) {
+    _anj_exchange_terminate(&anj->exchange_ctx, _ANJ_EXCHANGE_ERROR_TERMINATED);
+#ifdef ANJ_WITH_PIPELINED_NOTIFICATIONS
+    _anj_srv_conn_terminate_pipelined_requests(anj);
+#endif // ANJ_WITH_PIPELINED_NOTIFICATIONS
+}
+
 void anj_core_disable_server(anj_t *anj, anj_time_duration_t timeout) {
     assert(anj);
     log(L_INFO, "Disable called");
@@ -426,7 +779,7 @@ void anj_core_disable_server(anj_t *anj, anj_time_duration_t timeout) {
                 ANJ_TIME_MONOTONIC_INVALID;
     } else {
         anj->server_state.enable_time_user_triggered =
-                anj_time_monotonic_add(anj_time_monotonic_now(), timeout);
+                anj_time_monotonic_add(_ANJ_CORE_NOW(anj), timeout);
     }
 
     if (anj->server_state.conn_status == ANJ_CONN_STATUS_SUSPENDED
@@ -434,7 +787,7 @@ void anj_core_disable_server(anj_t *anj, anj_time_duration_t timeout) {
         log(L_DEBUG, "Already in progress");
         return;
     }
-    _anj_exchange_terminate(&anj->exchange_ctx, _ANJ_EXCHANGE_ERROR_TERMINATED);
+    terminate_exchanges(anj);
     anj->server_state.disable_triggered = true;
 }
 
@@ -447,7 +800,7 @@ void anj_core_request_bootstrap(anj_t *anj) {
         log(L_DEBUG, "Already in progress");
         return;
     }
-    _anj_exchange_terminate(&anj->exchange_ctx, _ANJ_EXCHANGE_ERROR_TERMINATED);
+    terminate_exchanges(anj);
     anj->server_state.bootstrap_request_triggered = true;
 }
 
@@ -458,16 +811,30 @@ void anj_core_restart(anj_t *anj) {
         log(L_DEBUG, "Already in progress");
         return;
     }
-    _anj_exchange_terminate(&anj->exchange_ctx, _ANJ_EXCHANGE_ERROR_TERMINATED);
+    terminate_exchanges(anj);
     anj->server_state.restart_triggered = true;
 }
 
+#ifdef ANJ_WITH_WARM_RESTART
+void anj_core_restart_warm(anj_t *anj) {
+    assert(anj);
+    if (!_anj_core_client_registered(anj)) {
+        anj_core_restart(anj);
+        return;
+    }
+    log(L_INFO, "Warm restart triggered");
+    // the Data Model is read again in the registration session, not here, as
+    // this function may be called from a Data Model handler
+    anj->server_state.warm_restart_triggered = true;
+}
+#endif // ANJ_WITH_WARM_RESTART
+
 int anj_core_shutdown(anj_t *anj) {
     // Functions called until _anj_srv_conn_close() have no side effects when
     // called again, so we do not track if the shutdown process was already
     // initiated.
     assert(anj);
-    _anj_exchange_terminate(&anj->exchange_ctx, _ANJ_EXCHANGE_ERROR_TERMINATED);
+    terminate_exchanges(anj);
 #ifdef ANJ_WITH_LWM2M_SEND
     // abort all queued send request to call finish callbacks
     anj_send_abort(anj, ANJ_SEND_ID_ALL);
@@ -481,6 +848,12 @@ int anj_core_shutdown(anj_t *anj) {
 #ifdef ANJ_WITH_EXTERNAL_CRYPTO_STORAGE
     anj_crypto_storage_deinit(anj->crypto_ctx);
 #endif // ANJ_WITH_EXTERNAL_CRYPTO_STORAGE
+#ifdef ANJ_WITH_MSG_BUFFER_POOL
+    // might be NULL if anj_core_init() failed
+    if (anj->msg_buffer_pool) {
+        _anj_msg_buffer_pool_release(anj, true);
+    }
+#endif // ANJ_WITH_MSG_BUFFER_POOL
 
     // clear anjay, not necessarily needed, but let's prevent accidental misuse
     memset(anj, 0, sizeof(*anj));
@@ -489,3 +862,21 @@ int anj_core_shutdown(anj_t *anj) {
     log(L_INFO, "Anjay Lite instance shutdown with result %d", res);
     return res;
 }
+
+#ifdef ANJ_WITH_RESOURCE_USAGE
+void anj_core_get_resource_usage(anj_t *anj, anj_resource_usage_t *out_usage) {
+    assert(anj && out_usage);
+    *out_usage = anj->resource_usage;
+#    ifdef ANJ_WITH_CACHE
+    out_usage->exchange_cache_max = anj->exchange_cache.used_entries_max;
+#    endif // ANJ_WITH_CACHE
+}
+
+void anj_core_resource_usage_reset(anj_t *anj) {
+    assert(anj);
+    memset(&anj->resource_usage, 0, sizeof(anj->resource_usage));
+#    ifdef ANJ_WITH_CACHE
+    anj->exchange_cache.used_entries_max = 0;
+#    endif // ANJ_WITH_CACHE
+}
+#endif // ANJ_WITH_RESOURCE_USAGE
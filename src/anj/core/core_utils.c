@@ -21,10 +21,17 @@
 #include <anj/dm/core.h>
 #include <anj/dm/security_object.h>
 #include <anj/log.h>
+#include <anj/time.h>
 #include <anj/utils.h>
 
+#include "../coap/coap.h"
 #include "../dm/dm_io.h"
 #include "core_utils.h"
+#include "register.h"
+
+#ifdef ANJ_WITH_OBSERVE
+#    include "../observe/observe.h"
+#endif // ANJ_WITH_OBSERVE
 
 #define COAP_DEFAULT_PORT_STR "5683"
 #define COAPS_DEFAULT_PORT_STR "5684"
@@ -133,10 +140,23 @@ int _anj_core_utils_get_security_info(
         anj_t *anj,
         bool bootstrap_credentials,
         anj_net_security_info_t *out_security_info) {
-    // TODO: only PSK is supported for now
+    // TODO: only PSK and RPK are supported for now
 #    ifdef ANJ_WITH_CERTIFICATES
 #        error "Certificates support is not implemented yet"
 #    else  // ANJ_WITH_CERTIFICATES
+#        ifdef ANJ_WITH_RAW_PUBLIC_KEY
+    anj_res_value_t res_val;
+    const anj_uri_path_t path =
+            ANJ_MAKE_RESOURCE_PATH(ANJ_OBJ_ID_SECURITY,
+                                   anj->security_instance.iid,
+                                   SECURITY_OBJ_SERVER_SECURITY_MODE_RID);
+    if (!anj_dm_res_read(anj, &path, &res_val)
+            && res_val.int_value == ANJ_DM_SECURITY_RPK) {
+        out_security_info->mode = ANJ_NET_SECURITY_RPK;
+        return anj_dm_security_obj_get_rpk(anj, bootstrap_credentials,
+                                           &out_security_info->data.rpk);
+    }
+#        endif // ANJ_WITH_RAW_PUBLIC_KEY
     out_security_info->mode = ANJ_NET_SECURITY_PSK;
     return anj_dm_security_obj_get_psk(anj,
                                        bootstrap_credentials,
@@ -213,3 +233,125 @@ int _anj_core_utils_validate_security_resource_types(anj_t *anj) {
     return 0;
 }
 #endif // NDEBUG
+
+#ifdef ANJ_WITH_SCHEDULING_JITTER
+uint32_t _anj_core_utils_jitter_seed(const char *endpoint_name) {
+    // FNV-1a
+    uint32_t hash = 2166136261U;
+    for (const char *c = endpoint_name; *c; c++) {
+        hash ^= (uint8_t) *c;
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+anj_time_duration_t _anj_core_utils_jitter(anj_t *anj,
+                                           uint16_t purpose,
+                                           uint16_t attempt,
+                                           anj_time_duration_t max_jitter) {
+    int64_t max_ms = anj_time_duration_to_scalar(max_jitter, ANJ_TIME_UNIT_MS);
+    if (max_ms <= 0) {
+        return ANJ_TIME_DURATION_ZERO;
+    }
+    // integer hash finalizer, so that similar endpoint names and consecutive
+    // attempts give unrelated values
+    uint32_t x = anj->jitter_seed
+                 ^ ((((uint32_t) purpose << 16) | attempt) * 0x9E3779B9U);
+    x ^= x >> 16;
+    x *= 0x7FEB352DU;
+    x ^= x >> 15;
+    x *= 0x846CA68BU;
+    x ^= x >> 16;
+    // 16-bit fraction of max_ms, no overflow for any sensible duration
+    return anj_time_duration_new(
+            (int64_t) (((uint64_t) max_ms * (x >> 16)) >> 16),
+            ANJ_TIME_UNIT_MS);
+}
+
+anj_time_duration_t _anj_core_utils_jitter_percent(anj_t *anj,
+                                                   uint16_t purpose,
+                                                   uint16_t attempt,
+                                                   anj_time_duration_t base,
+                                                   uint8_t percent) {
+    return _anj_core_utils_jitter(
+            anj, purpose, attempt,
+            anj_time_duration_div(anj_time_duration_mul(base, percent), 100));
+}
+#endif // ANJ_WITH_SCHEDULING_JITTER
+
+#if defined(ANJ_COAP_WITH_HEADER_COMPRESSION) || defined(ANJ_WITH_OSCORE)
+int _anj_core_utils_decode_in_msg(anj_t *anj,
+                                  size_t msg_size,
+                                  _anj_coap_msg_t *out_msg) {
+#    ifdef ANJ_COAP_WITH_HEADER_COMPRESSION
+    if (anj->connection_ctx.type == ANJ_NET_BINDING_NON_IP) {
+        _anj_location_path_t location_path;
+        _anj_register_get_location_path(anj, &location_path);
+        int res = _anj_coap_decompress(anj->in_buffer, &msg_size,
+                                       ANJ_IN_MSG_BUFFER_SIZE, &location_path);
+        if (res) {
+            return res;
+        }
+    }
+#    endif // ANJ_COAP_WITH_HEADER_COMPRESSION
+#    ifdef ANJ_WITH_OSCORE
+    if (anj->oscore_ctx.active) {
+        int res = _anj_oscore_unprotect(&anj->oscore_ctx, anj->in_buffer,
+                                        &msg_size);
+        if (res) {
+            return res;
+        }
+    }
+#    endif // ANJ_WITH_OSCORE
+#    ifdef ANJ_WITH_SCRATCH_ARENA
+    return _anj_coap_decode_udp_with_scratch(anj->scratch.coap_options,
+                                             anj->in_buffer, msg_size, out_msg);
+#    else  // ANJ_WITH_SCRATCH_ARENA
+    return _anj_coap_decode_udp(anj->in_buffer, msg_size, out_msg);
+#    endif // ANJ_WITH_SCRATCH_ARENA
+}
+#endif // defined(ANJ_COAP_WITH_HEADER_COMPRESSION) ||
+       // defined(ANJ_WITH_OSCORE)
+
+#ifdef ANJ_WITH_OBSERVE
+int _anj_core_utils_time_to_next_notification(
+        anj_t *anj, anj_time_duration_t *out_time_to_next_notification) {
+#    ifdef ANJ_WITH_NEXT_STEP_TIME_CACHE
+    _anj_next_notification_cache_t *cache = &anj->next_notification_cache;
+    anj_time_monotonic_t now = _ANJ_CORE_NOW(anj);
+    // nothing but the functions calling _ANJ_CORE_NEXT_NOTIFICATION_CHANGED()
+    // affects Observations in queue mode, so the stored time holds until then
+    bool queue_mode =
+            anj->server_state.conn_status == ANJ_CONN_STATUS_QUEUE_MODE;
+    if (!queue_mode) {
+        cache->valid = false;
+    } else if (cache->valid
+               && !anj_time_monotonic_lt(now, cache->calculated_at)) {
+        if (!anj_time_monotonic_is_valid(cache->notification_time)) {
+            *out_time_to_next_notification = ANJ_TIME_DURATION_INVALID;
+            return 0;
+        }
+        if (anj_time_monotonic_gt(cache->notification_time, now)) {
+            *out_time_to_next_notification =
+                    anj_time_monotonic_diff(cache->notification_time, now);
+            return 0;
+        }
+    }
+#    endif // ANJ_WITH_NEXT_STEP_TIME_CACHE
+    int res = anj_observe_time_to_next_notification(
+            anj, &anj->server_instance.observe_state,
+            out_time_to_next_notification);
+#    ifdef ANJ_WITH_NEXT_STEP_TIME_CACHE
+    if (queue_mode && !res) {
+        cache->valid = true;
+        cache->calculated_at = now;
+        cache->notification_time =
+                anj_time_duration_is_valid(*out_time_to_next_notification)
+                        ? anj_time_monotonic_add(
+                                  now, *out_time_to_next_notification)
+                        : ANJ_TIME_MONOTONIC_INVALID;
+    }
+#    endif // ANJ_WITH_NEXT_STEP_TIME_CACHE
+    return res;
+}
+#endif // ANJ_WITH_OBSERVE
@@ -18,6 +18,9 @@
 #    include <anj/compat/net/anj_net_api.h>
 #    include <anj/defs.h>
 #    include <anj/log.h>
+#    include <anj/time.h>
+
+#    include "../utils.h"
 
 #    define SERVER_OBJ_LIFETIME_RID 1
 #    define SERVER_OBJ_DEFAULT_PMIN_RID 2
@@ -45,6 +48,71 @@
             "CoAP decoding/encoding error: %d, check coap.h for details", \
             Error)
 
+/**
+ * Current monotonic time, read once per @ref anj_core_step call if
+ * @ref ANJ_WITH_STEP_TIME_CACHE is enabled.
+ */
+#    define _ANJ_CORE_NOW(Anj) _ANJ_STEP_TIME_NOW(&(Anj)->step_time)
+
+/**
+ * Drops the time of the next notification kept in @p Anj, to be called on any
+ * change that may bring it closer. Does nothing if
+ * @ref ANJ_WITH_NEXT_STEP_TIME_CACHE is disabled.
+ */
+#    ifdef ANJ_WITH_NEXT_STEP_TIME_CACHE
+#        define _ANJ_CORE_NEXT_NOTIFICATION_CHANGED(Anj) \
+            ((Anj)->next_notification_cache.valid = false)
+#    else  // ANJ_WITH_NEXT_STEP_TIME_CACHE
+#        define _ANJ_CORE_NEXT_NOTIFICATION_CHANGED(Anj) ((void) 0)
+#    endif // ANJ_WITH_NEXT_STEP_TIME_CACHE
+
+/**
+ * Raises the @p Field member of @ref anj_resource_usage_t to @p Value if it is
+ * lower. Does nothing if @ref ANJ_WITH_RESOURCE_USAGE is disabled.
+ */
+#    ifdef ANJ_WITH_RESOURCE_USAGE
+#        define _ANJ_CORE_USAGE_UPDATE(Anj, Field, Value)             \
+            do {                                                      \
+                if ((Anj)->resource_usage.Field < (size_t) (Value)) { \
+                    (Anj)->resource_usage.Field = (size_t) (Value);   \
+                }                                                     \
+            } while (0)
+#    else // ANJ_WITH_RESOURCE_USAGE
+#        define _ANJ_CORE_USAGE_UPDATE(Anj, Field, Value) ((void) 0)
+#    endif // ANJ_WITH_RESOURCE_USAGE
+
+/**
+ * Declares @p Name as a pointer to a CoAP message that is either the @p Slot
+ * member of @ref _anj_scratch_t, or a local variable if
+ * @ref ANJ_WITH_SCRATCH_ARENA is disabled. The message is not initialized.
+ */
+#    ifdef ANJ_WITH_SCRATCH_ARENA
+#        define _ANJ_CORE_SCRATCH_MSG(Anj, Name, Slot) \
+            _anj_coap_msg_t *Name = &(Anj)->scratch.Slot
+#    else  // ANJ_WITH_SCRATCH_ARENA
+#        define _ANJ_CORE_SCRATCH_MSG(Anj, Name, Slot) \
+            _anj_coap_msg_t Name##_on_stack;           \
+            _anj_coap_msg_t *Name = &Name##_on_stack
+#    endif // ANJ_WITH_SCRATCH_ARENA
+
+/**
+ * Decodes @p MsgSize bytes of the input buffer of @p Anj into @p OutMsg, with
+ * CoAP options collected in @ref _anj_scratch_t if
+ * @ref ANJ_WITH_SCRATCH_ARENA is enabled.
+ */
+#    if defined(ANJ_COAP_WITH_HEADER_COMPRESSION) || defined(ANJ_WITH_OSCORE)
+#        define _ANJ_CORE_DECODE_IN_MSG(Anj, MsgSize, OutMsg) \
+            _anj_core_utils_decode_in_msg((Anj), (MsgSize), (OutMsg))
+#    elif defined(ANJ_WITH_SCRATCH_ARENA)
+#        define _ANJ_CORE_DECODE_IN_MSG(Anj, MsgSize, OutMsg)          \
+            _anj_coap_decode_udp_with_scratch((Anj)->scratch.coap_options, \
+                                              (Anj)->in_buffer, (MsgSize), \
+                                              (OutMsg))
+#    else  // ANJ_WITH_SCRATCH_ARENA
+#        define _ANJ_CORE_DECODE_IN_MSG(Anj, MsgSize, OutMsg) \
+            _anj_coap_decode_udp((Anj)->in_buffer, (MsgSize), (OutMsg))
+#    endif // ANJ_WITH_SCRATCH_ARENA
+
 typedef struct {
     anj_net_binding_type_t binding_type;
     const char *host;
@@ -79,6 +147,62 @@ int _anj_core_utils_get_security_info(
         bool bootstrap_credentials,
         anj_net_security_info_t *out_security_info);
 #    endif // ANJ_WITH_SECURITY
+#    ifdef ANJ_WITH_SCHEDULING_JITTER
+/** Values mixed with the attempt number to get independent jitter values. */
+enum {
+    _ANJ_CORE_JITTER_REGISTER = 1,
+    _ANJ_CORE_JITTER_BOOTSTRAP,
+    _ANJ_CORE_JITTER_UPDATE,
+    _ANJ_CORE_JITTER_REGISTER_RETRY,
+    _ANJ_CORE_JITTER_REGISTER_SEQ_RETRY,
+    _ANJ_CORE_JITTER_BOOTSTRAP_RETRY
+};
+
+uint32_t _anj_core_utils_jitter_seed(const char *endpoint_name);
+
+/**
+ * Returns a deterministic value in range [0, @p max_jitter), uniformly
+ * distributed across endpoints, for a given @p purpose (one of
+ * _ANJ_CORE_JITTER_* values) and @p attempt.
+ */
+anj_time_duration_t _anj_core_utils_jitter(anj_t *anj,
+                                           uint16_t purpose,
+                                           uint16_t attempt,
+                                           anj_time_duration_t max_jitter);
+
+/** Same as @ref _anj_core_utils_jitter, limited to @p percent of @p base. */
+anj_time_duration_t _anj_core_utils_jitter_percent(anj_t *anj,
+                                                   uint16_t purpose,
+                                                   uint16_t attempt,
+                                                   anj_time_duration_t base,
+                                                   uint8_t percent);
+#    endif // ANJ_WITH_SCHEDULING_JITTER
+
+#    if defined(ANJ_COAP_WITH_HEADER_COMPRESSION) || defined(ANJ_WITH_OSCORE)
+/**
+ * Decodes @p msg_size bytes of the input buffer of @p anj into @p out_msg.
+ * Messages received over @ref ANJ_NET_BINDING_NON_IP are decompressed in place
+ * first, see @ref ANJ_COAP_WITH_HEADER_COMPRESSION, and messages protected
+ * with OSCORE are then verified and decrypted in place, see
+ * @ref anj_oscore_set_security_context.
+ */
+int _anj_core_utils_decode_in_msg(anj_t *anj,
+                                  size_t msg_size,
+                                  _anj_coap_msg_t *out_msg);
+#    endif // defined(ANJ_COAP_WITH_HEADER_COMPRESSION) ||
+           // defined(ANJ_WITH_OSCORE)
+
+#    ifdef ANJ_WITH_OBSERVE
+/**
+ * Calls @ref anj_observe_time_to_next_notification for the current server.
+ * If @ref ANJ_WITH_NEXT_STEP_TIME_CACHE is enabled and the client is in queue
+ * mode, the result is kept and reused until the notification time passes or
+ * @ref _ANJ_CORE_NEXT_NOTIFICATION_CHANGED is called.
+ */
+int _anj_core_utils_time_to_next_notification(
+        anj_t *anj, anj_time_duration_t *out_time_to_next_notification);
+#    endif // ANJ_WITH_OBSERVE
+
 #    ifndef NDEBUG
 int _anj_core_utils_validate_server_resource_types(anj_t *anj);
 int _anj_core_utils_validate_security_resource_types(anj_t *anj);
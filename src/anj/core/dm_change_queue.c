@@ -0,0 +1,111 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#define ANJ_LOG_SOURCE_FILE_ID 65
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <anj/core.h>
+#include <anj/defs.h>
+
+#include "core.h"
+#include "dm_change_queue.h"
+
+#ifdef ANJ_DM_WITH_CHANGE_QUEUE
+
+/* Bounded queue with a sequence number in each entry (D. Vyukov's algorithm).
+ * An entry at position pos is free if its seq equals pos and filled if it
+ * equals pos + 1. Producers claim a position with CAS on enqueue_pos and
+ * publish the entry with a release store of seq, so a producer preempted
+ * in between (e.g. by an interrupt handler that also signals a change) only
+ * delays draining of the entries after it and never blocks anyone. */
+
+#    define QUEUE_MASK ((uint32_t) ANJ_DM_CHANGE_QUEUE_SIZE - 1)
+
+void _anj_dm_change_queue_init(_anj_dm_change_queue_t *queue) {
+    assert(queue);
+    for (uint32_t i = 0; i < ANJ_DM_CHANGE_QUEUE_SIZE; i++) {
+        queue->entries[i].seq = i;
+    }
+    queue->dequeue_pos = 0;
+    __atomic_store_n(&queue->enqueue_pos, 0, __ATOMIC_RELEASE);
+}
+
+int anj_core_data_model_changed_async(anj_t *anj,
+                                      const anj_uri_path_t *path,
+                                      anj_core_change_type_t change_type) {
+    assert(anj && path);
+    _anj_dm_change_queue_t *queue = &anj->dm_change_queue;
+    uint32_t pos = __atomic_load_n(&queue->enqueue_pos, __ATOMIC_RELAXED);
+    _anj_dm_change_queue_entry_t *entry;
+    while (1) {
+        entry = &queue->entries[pos & QUEUE_MASK];
+        uint32_t seq = __atomic_load_n(&entry->seq, __ATOMIC_ACQUIRE);
+        int32_t diff = (int32_t) (seq - pos);
+        if (diff == 0) {
+            // on failure, pos is updated to the current enqueue_pos
+            if (__atomic_compare_exchange_n(&queue->enqueue_pos, &pos, pos + 1,
+                                            true, __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // entry from the previous lap is not drained yet
+            return -1;
+        } else {
+            pos = __atomic_load_n(&queue->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+    entry->path = *path;
+    entry->change_type = change_type;
+    __atomic_store_n(&entry->seq, pos + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+static _anj_dm_change_queue_entry_t *
+filled_entry(_anj_dm_change_queue_t *queue) {
+    _anj_dm_change_queue_entry_t *entry =
+            &queue->entries[queue->dequeue_pos & QUEUE_MASK];
+    if (__atomic_load_n(&entry->seq, __ATOMIC_ACQUIRE)
+            != queue->dequeue_pos + 1) {
+        return NULL;
+    }
+    return entry;
+}
+
+bool _anj_dm_change_queue_pending(_anj_dm_change_queue_t *queue) {
+    assert(queue);
+    return filled_entry(queue) != NULL;
+}
+
+void _anj_dm_change_queue_drain(anj_t *anj) {
+    assert(anj);
+    _anj_dm_change_queue_t *queue = &anj->dm_change_queue;
+    // limited to avoid starving the step if producers keep up with draining
+    for (uint32_t i = 0; i < ANJ_DM_CHANGE_QUEUE_SIZE; i++) {
+        _anj_dm_change_queue_entry_t *entry = filled_entry(queue);
+        if (!entry) {
+            return;
+        }
+        anj_uri_path_t path = entry->path;
+        anj_core_change_type_t change_type = entry->change_type;
+        // entry becomes free for the next lap
+        __atomic_store_n(&entry->seq,
+                         queue->dequeue_pos + ANJ_DM_CHANGE_QUEUE_SIZE,
+                         __ATOMIC_RELEASE);
+        queue->dequeue_pos++;
+        _anj_core_data_model_changed_with_ssid(anj, &path, change_type, 0);
+    }
+}
+
+#endif // ANJ_DM_WITH_CHANGE_QUEUE
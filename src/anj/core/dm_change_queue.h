@@ -0,0 +1,48 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#ifndef ANJ_SRC_CORE_DM_CHANGE_QUEUE_H
+#    define ANJ_SRC_CORE_DM_CHANGE_QUEUE_H
+
+#    include <stdbool.h>
+
+#    include <anj/core.h>
+
+#    ifdef ANJ_DM_WITH_CHANGE_QUEUE
+
+/**
+ * Initializes the queue of data model changes, must be called before any
+ * producer uses it.
+ *
+ * @param queue Queue to initialize.
+ */
+void _anj_dm_change_queue_init(_anj_dm_change_queue_t *queue);
+
+/**
+ * Checks whether any change is waiting to be handled. May be called only from
+ * the thread calling @ref anj_core_step.
+ *
+ * @param queue Queue to check.
+ */
+bool _anj_dm_change_queue_pending(_anj_dm_change_queue_t *queue);
+
+/**
+ * Handles changes put in the queue so far, in order, as if
+ * @ref anj_core_data_model_changed was called for each of them. Changes put
+ * in the queue while it is drained are handled in the next call at the latest.
+ *
+ * @param anj Anjay object to operate on.
+ */
+void _anj_dm_change_queue_drain(anj_t *anj);
+
+#    endif // ANJ_DM_WITH_CHANGE_QUEUE
+
+#endif // ANJ_SRC_CORE_DM_CHANGE_QUEUE_H
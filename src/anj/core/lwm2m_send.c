@@ -13,9 +13,11 @@
 
 #include <assert.h>
 #include <inttypes.h>
+#include <math.h>
 #include <stdbool.h>
 #include <string.h>
 
+#include <anj/compat/time.h>
 #include <anj/core.h>
 #include <anj/defs.h>
 #include <anj/log.h>
@@ -24,6 +26,8 @@
 
 #include "../coap/coap.h"
 #include "../exchange.h"
+#include "../io/cbor_encoder_ll.h"
+#include "../io/internal.h"
 #include "../io/io.h"
 #include "../utils.h"
 #include "core.h"
@@ -32,21 +36,398 @@
 
 #ifdef ANJ_WITH_LWM2M_SEND
 
-int anj_send_new_request(anj_t *anj,
-                         const anj_send_request_t *send_request,
-                         uint16_t *out_send_id) {
-    assert(anj && send_request);
+#    ifdef ANJ_LWM2M_SEND_WITH_BATCHING
+#        define BATCH_SIZE(Ctx) ((Ctx)->batch_size)
+#        define CURRENT_REQUEST(Ctx) \
+            ((Ctx)->requests_queue[(Ctx)->batch_request])
+#        define IS_LAST_IN_BATCH(Ctx) \
+            ((Ctx)->batch_request + 1 == (Ctx)->batch_size)
+#    else // ANJ_LWM2M_SEND_WITH_BATCHING
+#        define BATCH_SIZE(Ctx) ((size_t) 1)
+#        define CURRENT_REQUEST(Ctx) ((Ctx)->requests_queue[0])
+#        define IS_LAST_IN_BATCH(Ctx) true
+#    endif // ANJ_LWM2M_SEND_WITH_BATCHING
 
-    if (!send_request->finished_handler || !send_request->records
-            || send_request->records_cnt == 0) {
-        log(L_ERROR, "Invalid Send request");
+#    ifdef ANJ_LWM2M_SEND_WITH_RECORD_PRODUCER
+#        define HAS_RECORD_PRODUCER(Request) \
+            ((Request)->record_producer != NULL)
+#    else // ANJ_LWM2M_SEND_WITH_RECORD_PRODUCER
+#        define HAS_RECORD_PRODUCER(Request) false
+#    endif // ANJ_LWM2M_SEND_WITH_RECORD_PRODUCER
+
+#    ifdef ANJ_LWM2M_SEND_WITH_TEMPLATES
+#        define HAS_TEMPLATE(Request) ((Request)->send_template != NULL)
+#    else // ANJ_LWM2M_SEND_WITH_TEMPLATES
+#        define HAS_TEMPLATE(Request) false
+#    endif // ANJ_LWM2M_SEND_WITH_TEMPLATES
+
+// Index-th record of the request, in the order in which records are encoded
+#    ifdef ANJ_LWM2M_SEND_WITH_SORTED_RECORDS
+#        define RECORD_AT(Ctx, Request, Index)                           \
+            (&(Request)->records[(Ctx)->records_sorted                   \
+                                         ? (Ctx)->record_order[(Index)] \
+                                         : (Index)])
+#    else // ANJ_LWM2M_SEND_WITH_SORTED_RECORDS
+#        define RECORD_AT(Ctx, Request, Index) (&(Request)->records[(Index)])
+#    endif // ANJ_LWM2M_SEND_WITH_SORTED_RECORDS
+
+static void remove_from_queue(_anj_send_ctx_t *ctx, size_t idx, size_t count) {
+    for (size_t i = idx + count; i < ANJ_LWM2M_SEND_QUEUE_SIZE; i++) {
+        ctx->requests_queue[i - count] = ctx->requests_queue[i];
+        ctx->ids[i - count] = ctx->ids[i];
+#    ifdef ANJ_LWM2M_SEND_WITH_BATCHING
+        ctx->queued_time[i - count] = ctx->queued_time[i];
+#    endif // ANJ_LWM2M_SEND_WITH_BATCHING
+    }
+    for (size_t i = ANJ_LWM2M_SEND_QUEUE_SIZE - count;
+         i < ANJ_LWM2M_SEND_QUEUE_SIZE;
+         i++) {
+        ctx->ids[i] = 0;
+    }
+}
+
+#    ifdef ANJ_LWM2M_SEND_WITH_NON_CONFIRMABLE
+#        define IS_NON_CONFIRMABLE(Request) ((Request)->non_confirmable)
+#    else // ANJ_LWM2M_SEND_WITH_NON_CONFIRMABLE
+#        define IS_NON_CONFIRMABLE(Request) false
+#    endif // ANJ_LWM2M_SEND_WITH_NON_CONFIRMABLE
+
+#    ifdef ANJ_LWM2M_SEND_WITH_NO_RESPONSE
+#        define IS_NO_RESPONSE(Request) ((Request)->no_response)
+#    else // ANJ_LWM2M_SEND_WITH_NO_RESPONSE
+#        define IS_NO_RESPONSE(Request) false
+#    endif // ANJ_LWM2M_SEND_WITH_NO_RESPONSE
+
+#    ifdef ANJ_LWM2M_SEND_WITH_PRIORITIES
+// Moves the request queued in the free slot at free_idx to keep the queue
+// sorted by priority, after all requests of the same or higher priority. The
+// requests of the active exchange stay at the head of the queue.
+static void sort_new_request(_anj_send_ctx_t *ctx, size_t free_idx) {
+    const anj_send_request_t *send_request = ctx->requests_queue[free_idx];
+    uint16_t id = ctx->ids[free_idx];
+#        ifdef ANJ_LWM2M_SEND_WITH_BATCHING
+    anj_time_monotonic_t queued_time = ctx->queued_time[free_idx];
+#        endif // ANJ_LWM2M_SEND_WITH_BATCHING
+    size_t idx = ctx->active_exchange ? BATCH_SIZE(ctx) : 0;
+    while (idx < free_idx
+           && ctx->requests_queue[idx]->priority >= send_request->priority) {
+        idx++;
+    }
+    for (size_t i = free_idx; i > idx; i--) {
+        ctx->requests_queue[i] = ctx->requests_queue[i - 1];
+        ctx->ids[i] = ctx->ids[i - 1];
+#        ifdef ANJ_LWM2M_SEND_WITH_BATCHING
+        ctx->queued_time[i] = ctx->queued_time[i - 1];
+#        endif // ANJ_LWM2M_SEND_WITH_BATCHING
+    }
+    ctx->requests_queue[idx] = send_request;
+    ctx->ids[idx] = id;
+#        ifdef ANJ_LWM2M_SEND_WITH_BATCHING
+    ctx->queued_time[idx] = queued_time;
+#        endif // ANJ_LWM2M_SEND_WITH_BATCHING
+}
+#    endif // ANJ_LWM2M_SEND_WITH_PRIORITIES
+
+#    if defined(ANJ_WITH_SMALLEST_FORMAT) && defined(ANJ_WITH_SENML_CBOR) \
+            && defined(ANJ_WITH_LWM2M_CBOR)
+// LwM2M CBOR shares path prefixes between the records, but it can't carry
+// timestamps nor the same path twice
+static uint16_t choose_smallest_format(const anj_send_request_t *send_request) {
+    if (HAS_RECORD_PRODUCER(send_request)) {
+        // records are not known in advance
+        return _ANJ_COAP_FORMAT_SENML_CBOR;
+    }
+    for (size_t i = 0; i < send_request->records_cnt; i++) {
+        double timestamp = send_request->records[i].timestamp;
+        if (!isnan(timestamp) && timestamp != 0.0) {
+            return _ANJ_COAP_FORMAT_SENML_CBOR;
+        }
+        for (size_t j = i + 1; j < send_request->records_cnt; j++) {
+            if (anj_uri_path_equal(&send_request->records[i].path,
+                                   &send_request->records[j].path)) {
+                return _ANJ_COAP_FORMAT_SENML_CBOR;
+            }
+        }
+    }
+    return _ANJ_COAP_FORMAT_OMA_LWM2M_CBOR;
+}
+#    endif // defined(ANJ_WITH_SMALLEST_FORMAT) && defined(ANJ_WITH_SENML_CBOR)
+           // && defined(ANJ_WITH_LWM2M_CBOR)
+
+#    ifdef ANJ_LWM2M_SEND_WITH_FILTER
+#        define RECORDS_END(Ctx)                        \
+            ((Ctx)->filter_active ? (Ctx)->records_end \
+                                  : CURRENT_REQUEST(Ctx)->records_cnt)
+
+static _anj_send_filter_entry_t *find_filter(_anj_send_ctx_t *ctx,
+                                             const anj_uri_path_t *path) {
+    for (size_t i = 0; i < ANJ_LWM2M_SEND_FILTER_SIZE; i++) {
+        if (ctx->filters[i].path.uri_len
+                && anj_uri_path_equal(&ctx->filters[i].path, path)) {
+            return &ctx->filters[i];
+        }
+    }
+    return NULL;
+}
+
+static bool any_filter(const _anj_send_ctx_t *ctx) {
+    for (size_t i = 0; i < ANJ_LWM2M_SEND_FILTER_SIZE; i++) {
+        if (ctx->filters[i].path.uri_len) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// filters are evaluated once to count the records and then again while they
+// are encoded, so they can't be changed in the meantime
+static bool filters_in_use(const _anj_send_ctx_t *ctx) {
+    return ctx->active_exchange && ctx->filter_active;
+}
+
+int anj_send_filter_set(anj_t *anj,
+                        const anj_uri_path_t *path,
+                        double deadband) {
+    assert(anj && path);
+    _anj_send_ctx_t *ctx = &anj->send_ctx;
+    if (!anj_uri_path_has(path, ANJ_ID_RID) || !(deadband >= 0.0)) {
+        log(L_ERROR, "Invalid Send filter");
         return ANJ_SEND_ERR_DATA_NOT_VALID;
     }
+    if (filters_in_use(ctx)) {
+        log(L_ERROR, "Send filters are in use");
+        return ANJ_SEND_ERR_NOT_ALLOWED;
+    }
+    _anj_send_filter_entry_t *entry = find_filter(ctx, path);
+    for (size_t i = 0; !entry && i < ANJ_LWM2M_SEND_FILTER_SIZE; i++) {
+        if (!ctx->filters[i].path.uri_len) {
+            entry = &ctx->filters[i];
+        }
+    }
+    if (!entry) {
+        log(L_ERROR, "No space for a new Send filter");
+        return ANJ_SEND_ERR_NO_SPACE;
+    }
+    memset(entry, 0, sizeof(*entry));
+    entry->path = *path;
+    entry->deadband = deadband;
+    return 0;
+}
+
+int anj_send_filter_remove(anj_t *anj, const anj_uri_path_t *path) {
+    assert(anj && path);
+    _anj_send_ctx_t *ctx = &anj->send_ctx;
+    if (filters_in_use(ctx)) {
+        log(L_ERROR, "Send filters are in use");
+        return ANJ_SEND_ERR_NOT_ALLOWED;
+    }
+    _anj_send_filter_entry_t *entry = find_filter(ctx, path);
+    if (!entry) {
+        return ANJ_SEND_ERR_NO_REQUEST_FOUND;
+    }
+    memset(entry, 0, sizeof(*entry));
+    return 0;
+}
+
+static bool abs_diff_within(uint64_t greater, uint64_t less, double deadband) {
+    return (double) (greater - less) <= deadband;
+}
+
+static bool int_diff_within(int64_t a, int64_t b, double deadband) {
+    return a > b ? abs_diff_within((uint64_t) a, (uint64_t) b, deadband)
+                 : abs_diff_within((uint64_t) b, (uint64_t) a, deadband);
+}
+
+static bool value_unchanged(const _anj_send_filter_entry_t *entry,
+                            const anj_io_out_entry_t *record) {
+    if (!entry->has_last_value || entry->last_type != record->type) {
+        return false;
+    }
+    const anj_res_value_t *last = &entry->last_value;
+    const anj_res_value_t *value = &record->value;
+    switch (record->type) {
+    case ANJ_DATA_TYPE_INT:
+        return int_diff_within(last->int_value, value->int_value,
+                               entry->deadband);
+    case ANJ_DATA_TYPE_TIME:
+        return int_diff_within(last->time_value, value->time_value,
+                               entry->deadband);
+    case ANJ_DATA_TYPE_UINT:
+        return last->uint_value > value->uint_value
+                       ? abs_diff_within(last->uint_value, value->uint_value,
+                                         entry->deadband)
+                       : abs_diff_within(value->uint_value, last->uint_value,
+                                         entry->deadband);
+    case ANJ_DATA_TYPE_DOUBLE:
+        return fabs(last->double_value - value->double_value)
+               <= entry->deadband;
+    case ANJ_DATA_TYPE_BOOL:
+        return last->bool_value == value->bool_value;
+    case ANJ_DATA_TYPE_OBJLNK:
+        return last->objlnk.oid == value->objlnk.oid
+               && last->objlnk.iid == value->objlnk.iid;
+    default:
+        return false;
+    }
+}
+
+static bool record_dropped(_anj_send_ctx_t *ctx,
+                           const anj_io_out_entry_t *record) {
+    const _anj_send_filter_entry_t *entry = find_filter(ctx, &record->path);
+    return entry && value_unchanged(entry, record);
+}
+
+static bool request_filtered(const _anj_send_ctx_t *ctx,
+                             const anj_send_request_t *send_request) {
+    return !HAS_RECORD_PRODUCER(send_request) && !HAS_TEMPLATE(send_request)
+           && !send_request->filter_disabled && any_filter(ctx);
+}
+
+// remembers the values of records sent successfully; if a path occurs more
+// than once, the last value that was sent is kept
+static void update_filters(_anj_send_ctx_t *ctx,
+                           const anj_send_request_t *send_request) {
+    for (size_t i = 0; i < ANJ_LWM2M_SEND_FILTER_SIZE; i++) {
+        ctx->filters[i].updated = false;
+    }
+    for (size_t i = send_request->records_cnt; i-- > 0;) {
+        const anj_io_out_entry_t *record = &send_request->records[i];
+        _anj_send_filter_entry_t *entry = find_filter(ctx, &record->path);
+        if (!entry || entry->updated
+                || (!send_request->filter_disabled
+                    && value_unchanged(entry, record))) {
+            continue;
+        }
+        entry->updated = true;
+        entry->has_last_value = true;
+        entry->last_type = record->type;
+        entry->last_value = record->value;
+    }
+}
+#    else // ANJ_LWM2M_SEND_WITH_FILTER
+#        define RECORDS_END(Ctx) (CURRENT_REQUEST(Ctx)->records_cnt)
+#    endif // ANJ_LWM2M_SEND_WITH_FILTER
+
+#    ifdef ANJ_LWM2M_SEND_WITH_TEMPLATES
+// Numbers in templates are always encoded with an 8-byte argument, so that
+// the values can be written in place
+#        define TEMPLATE_NUMBER_LEN 9
+
+#        define TEMPLATE_UINT_INITIAL_BYTE 0x1B
+#        define TEMPLATE_NEGATIVE_INT_INITIAL_BYTE 0x3B
+#        define TEMPLATE_DOUBLE_INITIAL_BYTE 0xFB
+
+static void encode_fixed_number(uint8_t *out,
+                                uint8_t initial_byte,
+                                uint64_t argument) {
+    out[0] = initial_byte;
+    argument = _anj_convert_be64(argument);
+    memcpy(&out[1], &argument, sizeof(argument));
+}
+
+static void encode_fixed_int(uint8_t *out, int64_t value) {
+    if (value < 0) {
+        encode_fixed_number(out, TEMPLATE_NEGATIVE_INT_INITIAL_BYTE,
+                            (uint64_t) -(value + 1));
+    } else {
+        encode_fixed_number(out, TEMPLATE_UINT_INITIAL_BYTE, (uint64_t) value);
+    }
+}
+
+static void encode_fixed_double(uint8_t *out, double value) {
+    uint64_t portable = _anj_htond(value);
+    out[0] = TEMPLATE_DOUBLE_INITIAL_BYTE;
+    memcpy(&out[1], &portable, sizeof(portable));
+}
+
+// encodes the value of the record the way it's laid out in the template
+static size_t encode_template_value(uint8_t *out,
+                                    const anj_io_out_entry_t *record) {
+    switch (record->type) {
+    case ANJ_DATA_TYPE_BOOL:
+        return anj_cbor_ll_encode_bool(out, record->value.bool_value);
+    case ANJ_DATA_TYPE_INT:
+        encode_fixed_int(out, record->value.int_value);
+        break;
+    case ANJ_DATA_TYPE_TIME:
+        encode_fixed_int(out, record->value.time_value);
+        break;
+    case ANJ_DATA_TYPE_UINT:
+        encode_fixed_number(out, TEMPLATE_UINT_INITIAL_BYTE,
+                            record->value.uint_value);
+        break;
+    default:
+        assert(record->type == ANJ_DATA_TYPE_DOUBLE);
+        encode_fixed_double(out, record->value.double_value);
+        break;
+    }
+    return TEMPLATE_NUMBER_LEN;
+}
+
+// copies the part of the field at field_offset of the payload that falls into
+// the chunk at chunk_offset
+static void patch_chunk(uint8_t *chunk,
+                        size_t chunk_offset,
+                        size_t chunk_len,
+                        size_t field_offset,
+                        const uint8_t *field,
+                        size_t field_len) {
+    size_t start = ANJ_MAX(chunk_offset, field_offset);
+    size_t end = ANJ_MIN(chunk_offset + chunk_len, field_offset + field_len);
+    if (start < end) {
+        memcpy(&chunk[start - chunk_offset], &field[start - field_offset],
+               end - start);
+    }
+}
+
+static void copy_template_chunk(const anj_send_template_t *send_template,
+                                const anj_io_out_entry_t *records,
+                                uint8_t *chunk,
+                                size_t chunk_offset,
+                                size_t chunk_len) {
+    memcpy(chunk, &send_template->payload[chunk_offset], chunk_len);
+    for (size_t i = 0; i < send_template->records_cnt; i++) {
+        const _anj_send_template_record_t *slot = &send_template->records[i];
+        uint8_t field[TEMPLATE_NUMBER_LEN];
+        size_t field_len = encode_template_value(field, &records[i]);
+        patch_chunk(chunk, chunk_offset, chunk_len, slot->value_offset, field,
+                    field_len);
+        if (slot->time_offset) {
+            encode_fixed_double(field, records[i].timestamp);
+            patch_chunk(chunk, chunk_offset, chunk_len, slot->time_offset,
+                        field, TEMPLATE_NUMBER_LEN);
+        }
+    }
+}
+
+static bool template_records_valid(const anj_send_request_t *send_request) {
+    const anj_send_template_t *send_template = send_request->send_template;
+    if (send_request->content_format != ANJ_SEND_CONTENT_FORMAT_SENML_CBOR
+            || send_request->records_cnt != send_template->records_cnt) {
+        return false;
+    }
+    for (size_t i = 0; i < send_request->records_cnt; i++) {
+        const anj_io_out_entry_t *record = &send_request->records[i];
+        if (record->type != send_template->records[i].type
+                || (send_template->records[i].time_offset
+                    && isnan(record->timestamp))) {
+            return false;
+        }
+    }
+    return true;
+}
+#    endif // ANJ_LWM2M_SEND_WITH_TEMPLATES
+
+static bool records_valid(const anj_send_request_t *send_request) {
+#    ifdef ANJ_LWM2M_SEND_WITH_TEMPLATES
+    if (send_request->send_template) {
+        return template_records_valid(send_request);
+    }
+#    endif // ANJ_LWM2M_SEND_WITH_TEMPLATES
     for (size_t i = 0; i < send_request->records_cnt; i++) {
         if (!anj_uri_path_has(&send_request->records[i].path, ANJ_ID_RID)) {
             // invalid path
-            log(L_ERROR, "Invalid Send request");
-            return ANJ_SEND_ERR_DATA_NOT_VALID;
+            return false;
         }
 #    ifdef ANJ_WITH_LWM2M_CBOR
         if (send_request->content_format
@@ -55,13 +436,28 @@ int anj_send_new_request(anj_t *anj,
                 if (anj_uri_path_equal(&send_request->records[i].path,
                                        &send_request->records[j].path)) {
                     // duplicate path
-                    log(L_ERROR, "Invalid Send request");
-                    return ANJ_SEND_ERR_DATA_NOT_VALID;
+                    return false;
                 }
             }
         }
 #    endif // ANJ_WITH_LWM2M_CBOR
     }
+    return true;
+}
+
+int anj_send_new_request(anj_t *anj,
+                         const anj_send_request_t *send_request,
+                         uint16_t *out_send_id) {
+    assert(anj && send_request);
+
+    // records provided by a producer are checked as they are encoded
+    if (!send_request->finished_handler || send_request->records_cnt == 0
+            || (HAS_RECORD_PRODUCER(send_request) && HAS_TEMPLATE(send_request))
+            || (!HAS_RECORD_PRODUCER(send_request)
+                && (!send_request->records || !records_valid(send_request)))) {
+        log(L_ERROR, "Invalid Send request");
+        return ANJ_SEND_ERR_DATA_NOT_VALID;
+    }
     if (!_anj_core_client_registered(anj)) {
         log(L_ERROR, "Client not registered");
         return ANJ_SEND_ERR_NOT_ALLOWED;
@@ -96,7 +492,15 @@ int anj_send_new_request(anj_t *anj,
         *out_send_id = ctx->ids[idx];
     }
     ctx->requests_queue[idx] = send_request;
+    // free slots are always at the end of the queue
+    _ANJ_CORE_USAGE_UPDATE(anj, send_queue_max, idx + 1);
+#    ifdef ANJ_LWM2M_SEND_WITH_BATCHING
+    ctx->queued_time[idx] = _ANJ_CORE_NOW(anj);
+#    endif // ANJ_LWM2M_SEND_WITH_BATCHING
     log(L_INFO, "New Send request registered with ID: %" PRIu16, ctx->ids[idx]);
+#    ifdef ANJ_LWM2M_SEND_WITH_PRIORITIES
+    sort_new_request(ctx, idx);
+#    endif // ANJ_LWM2M_SEND_WITH_PRIORITIES
     return 0;
 }
 
@@ -117,11 +521,17 @@ int anj_send_abort(anj_t *anj, uint16_t send_id) {
         // nothing to do
         return 0;
     }
+    bool in_active_exchange = false;
+    for (size_t i = 0; ctx->active_exchange && i < BATCH_SIZE(ctx); i++) {
+        if (send_id == ANJ_SEND_ID_ALL || send_id == ctx->ids[i]) {
+            in_active_exchange = true;
+        }
+    }
     // If the active send ID is the one we want to abort, terminate ongoing
     // exchange, if all requests are to be aborted, terminate the active
-    // exchange only if it is Send request (active_exchange is set)
-    if (ctx->active_exchange
-            && (send_id == ANJ_SEND_ID_ALL || send_id == ctx->ids[0])) {
+    // exchange only if it is Send request (active_exchange is set); in case of
+    // merged requests all of them are aborted together
+    if (in_active_exchange) {
         // active exchange will be cleared in send_completion_callback
         _anj_exchange_terminate(&anj->exchange_ctx,
                                 _ANJ_EXCHANGE_ERROR_TERMINATED);
@@ -149,31 +559,78 @@ int anj_send_abort(anj_t *anj, uint16_t send_id) {
     }
 
     // find the request with given ID
-    void *user_data;
-    anj_send_finished_handler_t *finished_handler = NULL;
-    bool found = false;
-    for (size_t i = 0; i < ANJ_LWM2M_SEND_QUEUE_SIZE; i++) {
-        if (ctx->ids[i] == send_id) {
-            user_data = ctx->requests_queue[i]->data;
-            finished_handler = ctx->requests_queue[i]->finished_handler;
-            found = true;
-            ctx->ids[i] = 0;
-        } else if (found) {
-            ctx->requests_queue[i - 1] = ctx->requests_queue[i];
-            ctx->ids[i - 1] = ctx->ids[i];
+    size_t idx;
+    for (idx = 0; idx < ANJ_LWM2M_SEND_QUEUE_SIZE; idx++) {
+        if (ctx->ids[idx] == send_id) {
+            break;
         }
     }
-    if (!found) {
+    if (idx == ANJ_LWM2M_SEND_QUEUE_SIZE) {
         log(L_ERROR, "No request with ID %" PRIu16 " found", send_id);
         return ANJ_SEND_ERR_NO_REQUEST_FOUND;
     }
-    // clear the last one
-    ctx->ids[ANJ_LWM2M_SEND_QUEUE_SIZE - 1] = 0;
+    void *user_data = ctx->requests_queue[idx]->data;
+    anj_send_finished_handler_t *finished_handler =
+            ctx->requests_queue[idx]->finished_handler;
+    remove_from_queue(ctx, idx, 1);
     // call the finished handler
     finished_handler(anj, send_id, ANJ_SEND_ERR_ABORT, user_data);
     return 0;
 }
 
+// returns the next record of the current request, NULL if it can't be obtained
+static const anj_io_out_entry_t *next_record(anj_t *anj) {
+    _anj_send_ctx_t *ctx = &anj->send_ctx;
+    const anj_send_request_t *send_request = CURRENT_REQUEST(ctx);
+    size_t index = ctx->op_count++;
+#    ifdef ANJ_LWM2M_SEND_WITH_RECORD_PRODUCER
+    if (send_request->record_producer) {
+        memset(&ctx->produced_record, 0, sizeof(ctx->produced_record));
+        if (send_request->record_producer(anj, index, &ctx->produced_record,
+                                          send_request->data)) {
+            log(L_ERROR, "Record producer failed");
+            return NULL;
+        }
+        if (!anj_uri_path_has(&ctx->produced_record.path, ANJ_ID_RID)) {
+            log(L_ERROR, "Invalid record produced");
+            return NULL;
+        }
+        return &ctx->produced_record;
+    }
+#    endif // ANJ_LWM2M_SEND_WITH_RECORD_PRODUCER
+#    ifdef ANJ_LWM2M_SEND_WITH_FILTER
+    // there is a record to send before records_end
+    while (ctx->filter_active
+           && record_dropped(ctx, RECORD_AT(ctx, send_request, index))) {
+        index = ctx->op_count++;
+    }
+#    endif // ANJ_LWM2M_SEND_WITH_FILTER
+    return RECORD_AT(ctx, send_request, index);
+}
+
+#    ifdef ANJ_LWM2M_SEND_WITH_TEMPLATES
+static uint8_t template_read_payload(_anj_send_ctx_t *ctx,
+                                     uint8_t *buff,
+                                     size_t buff_len,
+                                     _anj_exchange_read_result_t *out_params) {
+    const anj_send_request_t *send_request = CURRENT_REQUEST(ctx);
+    const anj_send_template_t *send_template = send_request->send_template;
+    size_t chunk_len =
+            ANJ_MIN(buff_len - out_params->payload_len,
+                    send_template->payload_size - ctx->template_offset);
+    copy_template_chunk(send_template, send_request->records,
+                        &buff[out_params->payload_len], ctx->template_offset,
+                        chunk_len);
+    out_params->format = _ANJ_COAP_FORMAT_SENML_CBOR;
+    out_params->payload_len += chunk_len;
+    ctx->template_offset += chunk_len;
+    if (ctx->template_offset < send_template->payload_size) {
+        return _ANJ_EXCHANGE_BLOCK_TRANSFER_NEEDED;
+    }
+    return 0;
+}
+#    endif // ANJ_LWM2M_SEND_WITH_TEMPLATES
+
 static uint8_t send_read_payload(void *arg_ptr,
                                  uint8_t *buff,
                                  size_t buff_len,
@@ -181,6 +638,11 @@ static uint8_t send_read_payload(void *arg_ptr,
     anj_t *anj = (anj_t *) arg_ptr;
     _anj_send_ctx_t *ctx = &anj->send_ctx;
     assert(ctx->active_exchange);
+#    ifdef ANJ_LWM2M_SEND_WITH_TEMPLATES
+    if (CURRENT_REQUEST(ctx)->send_template) {
+        return template_read_payload(ctx, buff, buff_len, out_params);
+    }
+#    endif // ANJ_LWM2M_SEND_WITH_TEMPLATES
     int res;
     size_t copied_bytes;
 
@@ -188,9 +650,24 @@ static uint8_t send_read_payload(void *arg_ptr,
 
     while (true) {
         if (!ctx->data_to_copy) {
-            res = _anj_io_out_ctx_new_entry(
-                    &anj->anj_io.out_ctx,
-                    &ctx->requests_queue[0]->records[ctx->op_count++]);
+#    ifdef ANJ_LWM2M_SEND_WITH_BATCHING
+            if (ctx->op_count == RECORDS_END(ctx)) {
+                ctx->batch_request++;
+                ctx->op_count = 0;
+            }
+#    endif // ANJ_LWM2M_SEND_WITH_BATCHING
+            const anj_io_out_entry_t *record = next_record(anj);
+            if (!record) {
+                return ANJ_COAP_CODE_INTERNAL_SERVER_ERROR;
+            }
+#ifdef ANJ_WITH_DIRECT_PAYLOAD_ENCODING
+            res = _anj_io_out_ctx_new_entry_direct(
+                    &anj->anj_io.out_ctx, record,
+                    &buff[out_params->payload_len],
+                    buff_len - out_params->payload_len);
+#else  // ANJ_WITH_DIRECT_PAYLOAD_ENCODING
+            res = _anj_io_out_ctx_new_entry(&anj->anj_io.out_ctx, record);
+#endif // ANJ_WITH_DIRECT_PAYLOAD_ENCODING
             if (res) {
                 log(L_ERROR, "anj_io out ctx error %d", res);
                 return ANJ_COAP_CODE_INTERNAL_SERVER_ERROR;
@@ -202,7 +679,8 @@ static uint8_t send_read_payload(void *arg_ptr,
                                           &copied_bytes);
         out_params->payload_len += copied_bytes;
         // last record copied
-        if (res == 0 && ctx->op_count == ctx->requests_queue[0]->records_cnt) {
+        if (res == 0 && ctx->op_count == RECORDS_END(ctx)
+                && IS_LAST_IN_BATCH(ctx)) {
             return 0;
         }
         if (res == ANJ_IO_NEED_NEXT_CALL) {
@@ -260,8 +738,16 @@ static void send_completion_callback(void *arg_ptr,
 
 #    ifdef ANJ_WITH_EXTERNAL_DATA
     if (ctx->op_count != 0) {
+#        ifdef ANJ_LWM2M_SEND_WITH_RECORD_PRODUCER
         const anj_io_out_entry_t *record =
-                &ctx->requests_queue[0]->records[ctx->op_count - 1];
+                CURRENT_REQUEST(ctx)->record_producer
+                        ? &ctx->produced_record
+                        : RECORD_AT(ctx, CURRENT_REQUEST(ctx),
+                                    ctx->op_count - 1);
+#        else  // ANJ_LWM2M_SEND_WITH_RECORD_PRODUCER
+        const anj_io_out_entry_t *record =
+                RECORD_AT(ctx, CURRENT_REQUEST(ctx), ctx->op_count - 1);
+#        endif // ANJ_LWM2M_SEND_WITH_RECORD_PRODUCER
         if (result != 0 && (record->type & ANJ_DATA_TYPE_FLAG_EXTERNAL)
                 && ctx->data_to_copy) {
             _anj_io_out_ctx_close_external_data_cb(record);
@@ -269,84 +755,544 @@ static void send_completion_callback(void *arg_ptr,
     }
 #    endif // ANJ_WITH_EXTERNAL_DATA
 
-    void *user_data = ctx->requests_queue[0]->data;
-    uint16_t send_id = ctx->ids[0];
-    anj_send_finished_handler_t *finished_handler =
-            ctx->requests_queue[0]->finished_handler;
-    // first move all index and free the last one..
-    for (size_t i = 1; i < ANJ_LWM2M_SEND_QUEUE_SIZE; i++) {
-        ctx->requests_queue[i - 1] = ctx->requests_queue[i];
-        ctx->ids[i - 1] = ctx->ids[i];
+    const size_t batch_size = BATCH_SIZE(ctx);
+    const anj_send_request_t *requests[ANJ_LWM2M_SEND_QUEUE_SIZE];
+    uint16_t send_ids[ANJ_LWM2M_SEND_QUEUE_SIZE];
+    for (size_t i = 0; i < batch_size; i++) {
+        requests[i] = ctx->requests_queue[i];
+        send_ids[i] = ctx->ids[i];
     }
-    ctx->ids[ANJ_LWM2M_SEND_QUEUE_SIZE - 1] = 0;
+    // first remove finished requests from the queue..
+    remove_from_queue(ctx, 0, batch_size);
 
     ctx->active_exchange = false;
     ctx->data_to_copy = false;
     ctx->op_count = 0;
+#    ifdef ANJ_LWM2M_SEND_WITH_BATCHING
+    ctx->batch_size = 0;
+    ctx->batch_request = 0;
+#    endif // ANJ_LWM2M_SEND_WITH_BATCHING
+#    ifdef ANJ_LWM2M_SEND_WITH_FILTER
+    ctx->filter_active = false;
+    for (size_t i = 0; send_result == ANJ_SEND_SUCCESS && i < batch_size; i++) {
+        if (!HAS_RECORD_PRODUCER(requests[i]) && !HAS_TEMPLATE(requests[i])) {
+            update_filters(ctx, requests[i]);
+        }
+    }
+#    endif // ANJ_LWM2M_SEND_WITH_FILTER
 
-    // ..then call the finished handler
-    finished_handler(anj, send_id, send_result, user_data);
+    // ..then call the finished handlers
+    for (size_t i = 0; i < batch_size; i++) {
+        requests[i]->finished_handler(anj, send_ids[i], send_result,
+                                      requests[i]->data);
+    }
 }
 
-static anj_uri_path_t find_common_path(const anj_io_out_entry_t *records,
-                                       size_t records_cnt) {
-    assert(records && records_cnt > 0);
-
-    anj_uri_path_t base_path = records[0].path;
-    for (size_t i = 1; i < records_cnt; i++) {
-        size_t min_len = ANJ_MIN(base_path.uri_len, records[i].path.uri_len);
+static void update_common_path(anj_uri_path_t *base_path,
+                               const anj_io_out_entry_t *records,
+                               size_t records_cnt) {
+    for (size_t i = 0; i < records_cnt; i++) {
+        size_t min_len = ANJ_MIN(base_path->uri_len, records[i].path.uri_len);
         size_t j = 0;
         for (; j < min_len; j++) {
-            if (base_path.ids[j] != records[i].path.ids[j]) {
+            if (base_path->ids[j] != records[i].path.ids[j]) {
                 break;
             }
         }
-        base_path.uri_len = j;
+        base_path->uri_len = j;
+    }
+}
+
+// finds common path of all records of the first batch_size queued requests
+static anj_uri_path_t find_common_path(const _anj_send_ctx_t *ctx,
+                                       size_t batch_size,
+                                       size_t *out_records_cnt) {
+    assert(batch_size > 0 && ctx->requests_queue[0]->records_cnt > 0);
+
+    if (HAS_RECORD_PRODUCER(ctx->requests_queue[0])) {
+        // records are not known in advance; such requests are never batched
+        assert(batch_size == 1);
+        *out_records_cnt = ctx->requests_queue[0]->records_cnt;
+        return ANJ_MAKE_ROOT_PATH();
+    }
+    anj_uri_path_t base_path = ctx->requests_queue[0]->records[0].path;
+    *out_records_cnt = 0;
+    for (size_t i = 0; i < batch_size; i++) {
+        update_common_path(&base_path, ctx->requests_queue[i]->records,
+                           ctx->requests_queue[i]->records_cnt);
+        *out_records_cnt += ctx->requests_queue[i]->records_cnt;
     }
     return base_path;
 }
 
-void _anj_lwm2m_send_process(anj_t *anj,
-                             _anj_exchange_handlers_t *out_handlers,
-                             _anj_coap_msg_t *out_msg) {
-    assert(anj && out_handlers && out_msg);
+#    ifdef ANJ_LWM2M_SEND_WITH_TEMPLATES
+#        define TEMPLATE_PATH_MAX_LEN (sizeof("/65534/65534/65534/65534") - 1)
+// map header, Base Name and Name with their labels and 2-byte string headers,
+// Base Time with its label, and the value with its label and tag
+#        define TEMPLATE_RECORD_MAX_LEN                                    \
+            (1 + 2 * (3 + TEMPLATE_PATH_MAX_LEN) + 1 + TEMPLATE_NUMBER_LEN \
+             + 2 + TEMPLATE_NUMBER_LEN)
+
+static size_t encode_template_name(uint8_t *out,
+                                   int8_t label,
+                                   const anj_uri_path_t *path,
+                                   size_t start_index,
+                                   size_t end_index) {
+    char name[TEMPLATE_PATH_MAX_LEN];
+    size_t name_len = 0;
+    for (size_t i = start_index; i < end_index; i++) {
+        name[name_len++] = '/';
+        name_len += anj_uint16_to_string_value(&name[name_len], path->ids[i]);
+    }
+    size_t len = anj_cbor_ll_encode_small_int(out, label);
+    len += anj_cbor_ll_string_begin(&out[len], name_len);
+    memcpy(&out[len], name, name_len);
+    return len + name_len;
+}
+
+static bool template_type_supported(anj_data_type_t type) {
+    return type == ANJ_DATA_TYPE_INT || type == ANJ_DATA_TYPE_UINT
+           || type == ANJ_DATA_TYPE_DOUBLE || type == ANJ_DATA_TYPE_BOOL
+           || type == ANJ_DATA_TYPE_TIME;
+}
+
+int anj_send_template_init(anj_send_template_t *send_template,
+                           const anj_io_out_entry_t *records,
+                           size_t records_cnt) {
+    assert(send_template && (records || !records_cnt));
+    if (!records_cnt || records_cnt > ANJ_LWM2M_SEND_TEMPLATE_MAX_RECORDS) {
+        log(L_ERROR, "Invalid number of Send template records");
+        return ANJ_SEND_ERR_DATA_NOT_VALID;
+    }
+    for (size_t i = 0; i < records_cnt; i++) {
+        if (!anj_uri_path_has(&records[i].path, ANJ_ID_RID)
+                || !template_type_supported(records[i].type)) {
+            log(L_ERROR, "Invalid Send template record");
+            return ANJ_SEND_ERR_DATA_NOT_VALID;
+        }
+    }
+    // laid out like the regular SenML CBOR encoder does it, with the common
+    // path of all records as the Base Name of the first one
+    anj_uri_path_t base_path = records[0].path;
+    update_common_path(&base_path, records, records_cnt);
+    size_t base_name_len = anj_uri_path_length(&base_path);
+
+    uint8_t *payload = send_template->payload;
+    size_t pos = anj_cbor_ll_definite_array_begin(payload, records_cnt);
+    for (size_t i = 0; i < records_cnt; i++) {
+        const anj_io_out_entry_t *record = &records[i];
+        _anj_send_template_record_t *slot = &send_template->records[i];
+        size_t path_len = anj_uri_path_length(&record->path);
+        bool with_base_name = (i == 0 && base_name_len);
+        bool with_name = (path_len != base_name_len);
+        bool with_time = !isnan(record->timestamp);
+
+        uint8_t record_buff[TEMPLATE_RECORD_MAX_LEN];
+        size_t len = anj_cbor_ll_small_definite_map_begin(
+                record_buff,
+                (uint8_t) (with_base_name + with_name + with_time + 1));
+        if (with_base_name) {
+            len += encode_template_name(&record_buff[len],
+                                        SENML_LABEL_BASE_NAME, &record->path,
+                                        0, base_name_len);
+        }
+        if (with_name) {
+            len += encode_template_name(&record_buff[len], SENML_LABEL_NAME,
+                                        &record->path, base_name_len,
+                                        path_len);
+        }
+        slot->time_offset = 0;
+        if (with_time) {
+            len += anj_cbor_ll_encode_small_int(&record_buff[len],
+                                                SENML_LABEL_BASE_TIME);
+            slot->time_offset = pos + len;
+            encode_fixed_double(&record_buff[len], record->timestamp);
+            len += TEMPLATE_NUMBER_LEN;
+        }
+        len += anj_cbor_ll_encode_small_uint(
+                &record_buff[len], record->type == ANJ_DATA_TYPE_BOOL
+                                           ? SENML_LABEL_VALUE_BOOL
+                                           : SENML_LABEL_VALUE);
+        if (record->type == ANJ_DATA_TYPE_TIME) {
+            len += anj_cbor_ll_encode_tag(&record_buff[len],
+                                          CBOR_TAG_INTEGER_DATE_TIME);
+        }
+        slot->type = record->type;
+        slot->value_offset = pos + len;
+        len += encode_template_value(&record_buff[len], record);
+        assert(len <= TEMPLATE_RECORD_MAX_LEN);
+
+        if (len > ANJ_LWM2M_SEND_TEMPLATE_MAX_SIZE - pos) {
+            log(L_ERROR, "Send template doesn't fit in the buffer");
+            return ANJ_SEND_ERR_NO_SPACE;
+        }
+        memcpy(&payload[pos], record_buff, len);
+        pos += len;
+    }
+    send_template->payload_size = pos;
+    send_template->records_cnt = records_cnt;
+    return 0;
+}
+#    endif // ANJ_LWM2M_SEND_WITH_TEMPLATES
 
+#    ifdef ANJ_LWM2M_SEND_WITH_FILTER
+// Sets filter_active if some records of the first queued request are dropped,
+// returns the number of records left
+static size_t apply_filters(_anj_send_ctx_t *ctx,
+                            anj_uri_path_t *out_common_path) {
+    const anj_send_request_t *send_request = ctx->requests_queue[0];
+    size_t records_cnt = 0;
+    ctx->filter_active = false;
+    ctx->records_end = 0;
+    for (size_t i = 0; i < send_request->records_cnt; i++) {
+        const anj_io_out_entry_t *record = RECORD_AT(ctx, send_request, i);
+        if (record_dropped(ctx, record)) {
+            ctx->filter_active = true;
+            continue;
+        }
+        if (!records_cnt) {
+            *out_common_path = record->path;
+        }
+        update_common_path(out_common_path, record, 1);
+        ctx->records_end = i + 1;
+        records_cnt++;
+    }
+    return records_cnt;
+}
+
+// all records of the first queued request are dropped, so nothing is sent
+static void drop_unchanged_request(anj_t *anj) {
     _anj_send_ctx_t *ctx = &anj->send_ctx;
-    assert(!ctx->active_exchange);
+    const anj_send_request_t *send_request = ctx->requests_queue[0];
+    uint16_t send_id = ctx->ids[0];
+    log(L_INFO, "Values not changed, Send request %" PRIu16 " dropped",
+        send_id);
+    ctx->filter_active = false;
+    remove_from_queue(ctx, 0, 1);
+    send_request->finished_handler(anj, send_id, ANJ_SEND_SUCCESS,
+                                   send_request->data);
+}
+#    endif // ANJ_LWM2M_SEND_WITH_FILTER
 
-    out_msg->operation = ANJ_OP_NONE;
-    // there is no Send request to be sent
-    if (ctx->ids[0] == 0) {
-        return;
+#    ifdef ANJ_LWM2M_SEND_WITH_SORTED_RECORDS
+// Only these formats share a part of the path between consecutive records
+static bool format_benefits_from_sorting(uint16_t format) {
+#        ifdef ANJ_WITH_LWM2M_CBOR
+    if (format == _ANJ_COAP_FORMAT_OMA_LWM2M_CBOR) {
+        return true;
     }
+#        endif // ANJ_WITH_LWM2M_CBOR
+#        ifdef ANJ_WITH_SENML_CBOR_DYNAMIC_BASE_NAME
+    if (format == _ANJ_COAP_FORMAT_SENML_CBOR) {
+        return true;
+    }
+#        endif // ANJ_WITH_SENML_CBOR_DYNAMIC_BASE_NAME
+    (void) format;
+    return false;
+}
 
-    // if there are any other requests in the queue, and Mute Send resource
-    // changed to true - abort all requests
-    if (anj->server_instance.mute_send) {
-        anj_send_abort(anj, ANJ_SEND_ID_ALL);
+// Sets records_sorted if the records of the only request of the exchange are
+// not in the order of their paths, record_order holds their sorted indexes
+// then. Insertion sort is stable, so records with the same path keep their
+// order, and it's cheap for short and mostly sorted arrays.
+static void sort_records(_anj_send_ctx_t *ctx, uint16_t format) {
+    const anj_send_request_t *send_request = ctx->requests_queue[0];
+    ctx->records_sorted = false;
+    if (!format_benefits_from_sorting(format) || BATCH_SIZE(ctx) != 1
+            || HAS_RECORD_PRODUCER(send_request)
+            || send_request->records_cnt > ANJ_LWM2M_SEND_SORTED_RECORDS_MAX) {
         return;
     }
+    const anj_io_out_entry_t *records = send_request->records;
+    for (size_t i = 0; i < send_request->records_cnt; i++) {
+        size_t j = i;
+        while (j > 0
+               && _anj_uri_path_compare(&records[ctx->record_order[j - 1]].path,
+                                        &records[i].path)
+                          > 0) {
+            ctx->record_order[j] = ctx->record_order[j - 1];
+            j--;
+        }
+        ctx->record_order[j] = (uint16_t) i;
+        if (j != i) {
+            ctx->records_sorted = true;
+        }
+    }
+}
+#    endif // ANJ_LWM2M_SEND_WITH_SORTED_RECORDS
+
+#    ifdef ANJ_LWM2M_SEND_WITH_BATCHING
+static bool can_be_batched(const _anj_send_ctx_t *ctx,
+                           const anj_send_request_t *send_request) {
+    if (HAS_RECORD_PRODUCER(send_request) || HAS_TEMPLATE(send_request)) {
+        return false;
+    }
+#        ifdef ANJ_LWM2M_SEND_WITH_FILTER
+    // records to drop are found when the request is about to be sent
+    if (request_filtered(ctx, send_request)) {
+        return false;
+    }
+#        else  // ANJ_LWM2M_SEND_WITH_FILTER
+    (void) ctx;
+#        endif // ANJ_LWM2M_SEND_WITH_FILTER
+#        if defined(ANJ_WITH_LWM2M_CBOR) \
+                || defined(ANJ_WITH_SENML_CBOR_STRINGREF)
+    // LwM2M CBOR requires unique paths, which can't be guaranteed when
+    // merging independent requests; merged messages are always encoded as
+    // plain SenML CBOR
+    if (send_request->content_format != ANJ_SEND_CONTENT_FORMAT_SENML_CBOR) {
+        return false;
+    }
+#        endif // defined(ANJ_WITH_LWM2M_CBOR) ||
+               // defined(ANJ_WITH_SENML_CBOR_STRINGREF)
+#        ifdef ANJ_WITH_EXTERNAL_DATA
+    for (size_t i = 0; i < send_request->records_cnt; i++) {
+        if (send_request->records[i].type & ANJ_DATA_TYPE_FLAG_EXTERNAL) {
+            return false;
+        }
+    }
+#        else  // ANJ_WITH_EXTERNAL_DATA
+    (void) send_request;
+#        endif // ANJ_WITH_EXTERNAL_DATA
+    return true;
+}
+
+// Size of the CBOR definite array header for the given number of records
+static size_t records_array_header_len(size_t records_cnt) {
+    if (records_cnt < 24) {
+        return 1;
+    } else if (records_cnt <= UINT8_MAX) {
+        return 2;
+    } else if (records_cnt <= UINT16_MAX) {
+        return 3;
+    }
+    return 5;
+}
+
+// Appends records of the queued requests from begin to end to the payload
+// buffer, which is not used before the exchange is started.
+static bool append_to_payload(anj_t *anj,
+                              size_t begin,
+                              size_t end,
+                              size_t *inout_payload_len) {
+    _anj_send_ctx_t *ctx = &anj->send_ctx;
+    for (size_t i = begin; i < end; i++) {
+        const anj_send_request_t *send_request = ctx->requests_queue[i];
+        for (size_t j = 0; j < send_request->records_cnt; j++) {
+            size_t copied_bytes;
+            if (_anj_io_out_ctx_new_entry(&anj->anj_io.out_ctx,
+                                          &send_request->records[j])
+                    || _anj_io_out_ctx_get_payload(
+                               &anj->anj_io.out_ctx,
+                               &anj->payload_buffer[*inout_payload_len],
+                               ANJ_OUT_PAYLOAD_BUFFER_SIZE - *inout_payload_len,
+                               &copied_bytes)) {
+                return false;
+            }
+            *inout_payload_len += copied_bytes;
+        }
+    }
+    return true;
+}
+
+// Merges queued requests as long as the message can be sent without
+// a block-wise transfer. Records of each candidate are appended to the batch
+// encoded so far; the whole batch is encoded again only if the Base Name or
+// the size of the array header changes, which may happen just a few times.
+static size_t collect_batch(anj_t *anj) {
+    _anj_send_ctx_t *ctx = &anj->send_ctx;
+    size_t batch_size = 1;
+    if (!can_be_batched(ctx, ctx->requests_queue[0])) {
+        return batch_size;
+    }
+    anj_uri_path_t common_path = ctx->requests_queue[0]->records[0].path;
+    update_common_path(&common_path, ctx->requests_queue[0]->records,
+                       ctx->requests_queue[0]->records_cnt);
+    size_t records_cnt = ctx->requests_queue[0]->records_cnt;
+    bool encoded = false;
+    size_t payload_len = 0;
+    while (batch_size < ANJ_LWM2M_SEND_QUEUE_SIZE && ctx->ids[batch_size]
+           && can_be_batched(ctx, ctx->requests_queue[batch_size])
+           && IS_NON_CONFIRMABLE(ctx->requests_queue[batch_size])
+                      == IS_NON_CONFIRMABLE(ctx->requests_queue[0])
+           && IS_NO_RESPONSE(ctx->requests_queue[batch_size])
+                      == IS_NO_RESPONSE(ctx->requests_queue[0])) {
+        const anj_send_request_t *candidate = ctx->requests_queue[batch_size];
+        anj_uri_path_t candidate_path = common_path;
+        update_common_path(&candidate_path, candidate->records,
+                           candidate->records_cnt);
+        size_t candidate_records_cnt = records_cnt + candidate->records_cnt;
+        size_t begin = batch_size;
+        if (!encoded || !anj_uri_path_equal(&candidate_path, &common_path)
+                || records_array_header_len(candidate_records_cnt)
+                               != records_array_header_len(records_cnt)) {
+            if (_anj_io_out_ctx_init(&anj->anj_io.out_ctx, ANJ_OP_INF_CON_SEND,
+                                     &candidate_path, candidate_records_cnt,
+                                     _ANJ_COAP_FORMAT_SENML_CBOR)) {
+                break;
+            }
+            encoded = true;
+            begin = 0;
+            payload_len = 0;
+        }
+        if (!append_to_payload(anj, begin, batch_size + 1, &payload_len)) {
+            break;
+        }
+        common_path = candidate_path;
+        records_cnt = candidate_records_cnt;
+        batch_size++;
+    }
+    if (batch_size > 1) {
+        log(L_DEBUG, "Merging %u Send requests, first ID: %" PRIu16,
+            (unsigned) batch_size, ctx->ids[0]);
+    }
+    return batch_size;
+}
+#    endif // ANJ_LWM2M_SEND_WITH_BATCHING
+
+static _anj_op_t choose_operation(_anj_send_ctx_t *ctx) {
+#    ifdef ANJ_LWM2M_SEND_WITH_NON_CONFIRMABLE
+    if (!ctx->requests_queue[0]->non_confirmable) {
+        ctx->non_con_count = 0;
+        return ANJ_OP_INF_CON_SEND;
+    }
+#        if ANJ_LWM2M_SEND_CON_EVERY_N > 0
+    // Confirmable message once in a while to check the connection
+    if (++ctx->non_con_count >= ANJ_LWM2M_SEND_CON_EVERY_N) {
+        ctx->non_con_count = 0;
+        return ANJ_OP_INF_CON_SEND;
+    }
+#        endif // ANJ_LWM2M_SEND_CON_EVERY_N > 0
+    return ANJ_OP_INF_NON_CON_SEND;
+#    else  // ANJ_LWM2M_SEND_WITH_NON_CONFIRMABLE
+    (void) ctx;
+    return ANJ_OP_INF_CON_SEND;
+#    endif // ANJ_LWM2M_SEND_WITH_NON_CONFIRMABLE
+}
+
+anj_time_monotonic_t _anj_lwm2m_send_ready_time(anj_t *anj) {
+    assert(anj);
+    const _anj_send_ctx_t *ctx = &anj->send_ctx;
+    if (ctx->ids[0] == 0 || ctx->active_exchange) {
+        return ANJ_TIME_MONOTONIC_INVALID;
+    }
+#    ifdef ANJ_LWM2M_SEND_WITH_BATCHING
+    // waiting makes sense only if more requests can still join the batch
+    bool batch_closed = ctx->ids[ANJ_LWM2M_SEND_QUEUE_SIZE - 1] != 0;
+    for (size_t i = 0; i < ANJ_LWM2M_SEND_QUEUE_SIZE && ctx->ids[i]; i++) {
+        if (!can_be_batched(ctx, ctx->requests_queue[i])) {
+            batch_closed = true;
+        }
+    }
+    if (!batch_closed) {
+        return anj_time_monotonic_add(
+                ctx->queued_time[0],
+                anj_time_duration_new(ANJ_LWM2M_SEND_BATCHING_HOLD_DOWN_MS,
+                                      ANJ_TIME_UNIT_MS));
+    }
+    return ctx->queued_time[0];
+#    else  // ANJ_LWM2M_SEND_WITH_BATCHING
+    return _ANJ_CORE_NOW(anj);
+#    endif // ANJ_LWM2M_SEND_WITH_BATCHING
+}
+
+// Initializes the encoder for the records of the requests to send, returns
+// false if there is nothing to send
+static bool prepare_out_ctx(anj_t *anj, _anj_op_t *out_operation) {
+    _anj_send_ctx_t *ctx = &anj->send_ctx;
 
-    anj_send_request_t const *send_request = ctx->requests_queue[0];
 #    if defined(ANJ_WITH_SENML_CBOR) && defined(ANJ_WITH_LWM2M_CBOR)
+    anj_send_request_t const *send_request = ctx->requests_queue[0];
     uint16_t format =
             (send_request->content_format == ANJ_SEND_CONTENT_FORMAT_SENML_CBOR)
                     ? _ANJ_COAP_FORMAT_SENML_CBOR
                     : _ANJ_COAP_FORMAT_OMA_LWM2M_CBOR;
+#        ifdef ANJ_WITH_SMALLEST_FORMAT
+    if (send_request->content_format == ANJ_SEND_CONTENT_FORMAT_SMALLEST) {
+        format = choose_smallest_format(send_request);
+    }
+#        endif // ANJ_WITH_SMALLEST_FORMAT
 #    elif defined(ANJ_WITH_SENML_CBOR)
     uint16_t format = _ANJ_COAP_FORMAT_SENML_CBOR;
 #    elif defined(ANJ_WITH_LWM2M_CBOR)
     uint16_t format = _ANJ_COAP_FORMAT_OMA_LWM2M_CBOR;
 #    endif
+#    ifdef ANJ_WITH_SENML_CBOR_STRINGREF
+    if (ctx->requests_queue[0]->content_format
+            == ANJ_SEND_CONTENT_FORMAT_SENML_CBOR_STRINGREF) {
+        format = _ANJ_COAP_FORMAT_SENML_CBOR_STRINGREF;
+    }
+#    endif // ANJ_WITH_SENML_CBOR_STRINGREF
 
+#    ifdef ANJ_LWM2M_SEND_WITH_SORTED_RECORDS
+    sort_records(ctx, format);
+#    endif // ANJ_LWM2M_SEND_WITH_SORTED_RECORDS
+    size_t records_cnt;
     anj_uri_path_t common_path =
-            find_common_path(send_request->records, send_request->records_cnt);
-    int res = _anj_io_out_ctx_init(&anj->anj_io.out_ctx, ANJ_OP_INF_CON_SEND,
-                                   &common_path, send_request->records_cnt,
-                                   format);
+            find_common_path(ctx, BATCH_SIZE(ctx), &records_cnt);
+#    ifdef ANJ_LWM2M_SEND_WITH_FILTER
+    ctx->filter_active = false;
+    if (request_filtered(ctx, ctx->requests_queue[0])) {
+        assert(BATCH_SIZE(ctx) == 1);
+        anj_uri_path_t filtered_common_path;
+        size_t filtered_records_cnt = apply_filters(ctx, &filtered_common_path);
+        if (!filtered_records_cnt) {
+            drop_unchanged_request(anj);
+            return false;
+        }
+        if (ctx->filter_active) {
+            records_cnt = filtered_records_cnt;
+            common_path = filtered_common_path;
+        }
+    }
+#    endif // ANJ_LWM2M_SEND_WITH_FILTER
+    *out_operation = choose_operation(ctx);
+    int res = _anj_io_out_ctx_init(&anj->anj_io.out_ctx, *out_operation,
+                                   &common_path, records_cnt, format);
     if (res) {
         log(L_ERROR, "anj_io out ctx error %d", res);
         anj_send_abort(anj, ctx->ids[0]);
+        return false;
+    }
+    return true;
+}
+
+void _anj_lwm2m_send_process(anj_t *anj,
+                             _anj_exchange_handlers_t *out_handlers,
+                             _anj_coap_msg_t *out_msg) {
+    assert(anj && out_handlers && out_msg);
+
+    _anj_send_ctx_t *ctx = &anj->send_ctx;
+    assert(!ctx->active_exchange);
+
+    out_msg->operation = ANJ_OP_NONE;
+    // there is no Send request to be sent
+    if (ctx->ids[0] == 0) {
+        return;
+    }
+
+    // if there are any other requests in the queue, and Mute Send resource
+    // changed to true - abort all requests
+    if (anj->server_instance.mute_send) {
+        anj_send_abort(anj, ANJ_SEND_ID_ALL);
+        return;
+    }
+
+#    ifdef ANJ_LWM2M_SEND_WITH_BATCHING
+    if (anj_time_monotonic_gt(_anj_lwm2m_send_ready_time(anj),
+                              _ANJ_CORE_NOW(anj))) {
+        // hold-down, wait for more requests to be merged
+        return;
+    }
+    ctx->batch_size = collect_batch(anj);
+    ctx->batch_request = 0;
+#    endif // ANJ_LWM2M_SEND_WITH_BATCHING
+
+    _anj_op_t operation;
+    if (HAS_TEMPLATE(ctx->requests_queue[0])) {
+        // the payload is copied from the template, the encoder is not used
+        operation = choose_operation(ctx);
+    } else if (!prepare_out_ctx(anj, &operation)) {
         return;
     }
     *out_handlers = (_anj_exchange_handlers_t) {
@@ -354,10 +1300,16 @@ void _anj_lwm2m_send_process(anj_t *anj,
         .read_payload = send_read_payload,
         .arg = anj
     };
-    out_msg->operation = ANJ_OP_INF_CON_SEND;
+    out_msg->operation = operation;
+#    ifdef ANJ_LWM2M_SEND_WITH_NO_RESPONSE
+    out_msg->no_response = ctx->requests_queue[0]->no_response;
+#    endif // ANJ_LWM2M_SEND_WITH_NO_RESPONSE
     ctx->active_exchange = true;
     ctx->data_to_copy = false;
     ctx->op_count = 0;
+#    ifdef ANJ_LWM2M_SEND_WITH_TEMPLATES
+    ctx->template_offset = 0;
+#    endif // ANJ_LWM2M_SEND_WITH_TEMPLATES
 }
 
 #endif // ANJ_WITH_LWM2M_SEND
@@ -33,6 +33,19 @@ void _anj_lwm2m_send_process(anj_t *anj,
                              _anj_exchange_handlers_t *out_handlers,
                              _anj_coap_msg_t *out_msg);
 
+/**
+ * Returns the point in time at which the first queued Send request is ready to
+ * be sent. With @ref ANJ_LWM2M_SEND_WITH_BATCHING enabled, it may be delayed by
+ * the hold-down time to allow other requests to be merged with it.
+ *
+ * @param anj Anjay object to operate on.
+ *
+ * @return Point in time which is not later than the current time if the request
+ *         can be sent right away, @ref ANJ_TIME_MONOTONIC_INVALID if there is
+ *         no Send request queued.
+ */
+anj_time_monotonic_t _anj_lwm2m_send_ready_time(anj_t *anj);
+
 #    endif // ANJ_WITH_LWM2M_SEND
 
 #endif // ANJ_SRC_LWM2M_SEND_H
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#define ANJ_LOG_SOURCE_FILE_ID 64
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/core.h>
+#include <anj/log.h>
+
+#include "../exchange.h"
+#include "core_utils.h"
+#include "msg_buffer_pool.h"
+
+#ifdef ANJ_WITH_MSG_BUFFER_POOL
+
+// buffers have no alignment, so links are accessed with memcpy()
+static void push_buffer(uint8_t **list, uint8_t *buffer) {
+    memcpy(buffer, list, sizeof(*list));
+    *list = buffer;
+}
+
+static uint8_t *pop_buffer(uint8_t **list) {
+    uint8_t *buffer = *list;
+    if (buffer) {
+        memcpy(list, buffer, sizeof(*list));
+    }
+    return buffer;
+}
+
+int anj_msg_buffer_pool_init(anj_msg_buffer_pool_t *pool,
+                             uint8_t *memory,
+                             size_t memory_size,
+                             size_t scratch_count,
+                             size_t payload_count) {
+    assert(pool && memory);
+    if (!scratch_count || !payload_count
+            || memory_size
+                           < ANJ_MSG_BUFFER_POOL_SIZE(scratch_count,
+                                                      payload_count)
+            || _ANJ_MSG_BUFFER_ARENA_IN_OUT_SIZE < sizeof(uint8_t *)
+            || ANJ_OUT_PAYLOAD_BUFFER_SIZE < sizeof(uint8_t *)) {
+        log(L_ERROR, "Invalid message buffer pool parameters");
+        return -1;
+    }
+    memset(pool, 0, sizeof(*pool));
+    for (size_t i = 0; i < scratch_count; i++) {
+        push_buffer(&pool->free_scratch, memory);
+        memory += _ANJ_MSG_BUFFER_ARENA_IN_OUT_SIZE;
+    }
+    for (size_t i = 0; i < payload_count; i++) {
+        push_buffer(&pool->free_payload, memory);
+        memory += ANJ_OUT_PAYLOAD_BUFFER_SIZE;
+    }
+    return 0;
+}
+
+int _anj_msg_buffer_pool_acquire(anj_t *anj) {
+    assert(anj && anj->msg_buffer_pool);
+    // input and output messages share the same memory, see
+    // setup_msg_buffer_arena() in core.c
+    if (!anj->in_buffer) {
+        anj->in_buffer = pop_buffer(&anj->msg_buffer_pool->free_scratch);
+        anj->out_buffer = anj->in_buffer;
+    }
+    if (!anj->payload_buffer) {
+        anj->payload_buffer = pop_buffer(&anj->msg_buffer_pool->free_payload);
+    }
+    if (!anj->in_buffer || !anj->payload_buffer) {
+        log(L_DEBUG, "Message buffer pool exhausted");
+        return -1;
+    }
+    return 0;
+}
+
+static bool scratch_in_use(anj_t *anj) {
+    // message may be already encoded, but not sent yet, see
+    // _anj_srv_conn_handle_request()
+    if (anj->connection_ctx.send_in_progress
+            || _anj_exchange_get_state(&anj->exchange_ctx)
+                           == ANJ_EXCHANGE_STATE_WAITING_SEND_CONFIRMATION) {
+        return true;
+    }
+#    ifdef ANJ_WITH_PIPELINED_NOTIFICATIONS
+    for (size_t i = 0; i < _ANJ_PIPELINED_EXCHANGES_NUMBER; i++) {
+        if (_anj_exchange_get_state(&anj->pipelined[i].exchange_ctx)
+                == ANJ_EXCHANGE_STATE_WAITING_SEND_CONFIRMATION) {
+            return true;
+        }
+    }
+#    endif // ANJ_WITH_PIPELINED_NOTIFICATIONS
+    return false;
+}
+
+static bool payload_in_use(anj_t *anj) {
+    // retransmissions and subsequent blocks are encoded from the payload
+    // buffer, pipelined requests use a separate one
+    return anj->connection_ctx.send_in_progress
+           || _anj_exchange_ongoing_exchange(&anj->exchange_ctx);
+}
+
+void _anj_msg_buffer_pool_release(anj_t *anj, bool force) {
+    assert(anj && anj->msg_buffer_pool);
+    if (anj->in_buffer && (force || !scratch_in_use(anj))) {
+        push_buffer(&anj->msg_buffer_pool->free_scratch, anj->in_buffer);
+        anj->in_buffer = NULL;
+        anj->out_buffer = NULL;
+    }
+    if (anj->payload_buffer && (force || !payload_in_use(anj))) {
+        push_buffer(&anj->msg_buffer_pool->free_payload, anj->payload_buffer);
+        anj->payload_buffer = NULL;
+    }
+}
+
+#endif // ANJ_WITH_MSG_BUFFER_POOL
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#ifndef ANJ_SRC_CORE_MSG_BUFFER_POOL_H
+#    define ANJ_SRC_CORE_MSG_BUFFER_POOL_H
+
+#    include <anj/core.h>
+
+#    ifdef ANJ_WITH_MSG_BUFFER_POOL
+
+/**
+ * Borrows the input/output and payload buffers of @p anj from its pool, unless
+ * they are already held. Must be called at the beginning of
+ * @ref anj_core_step.
+ *
+ * @param anj Anjay object.
+ *
+ * @return 0 if @p anj holds all buffers, -1 if the pool is exhausted. In the
+ *         latter case @ref _anj_msg_buffer_pool_release must still be called.
+ */
+int _anj_msg_buffer_pool_acquire(anj_t *anj);
+
+/**
+ * Returns the buffers of @p anj that are no longer needed to the pool: the
+ * input/output buffer if no message is being sent, and the payload buffer if
+ * no exchange is ongoing. Must be called at the end of @ref anj_core_step.
+ *
+ * @param anj   Anjay object.
+ * @param force If true, all buffers are returned regardless of the state of
+ *              @p anj, used on shutdown.
+ */
+void _anj_msg_buffer_pool_release(anj_t *anj, bool force);
+
+#    endif // ANJ_WITH_MSG_BUFFER_POOL
+
+#endif // ANJ_SRC_CORE_MSG_BUFFER_POOL_H
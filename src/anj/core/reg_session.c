@@ -30,13 +30,18 @@
 #endif // ANJ_WITH_OBSERVE
 
 #include "../coap/coap.h"
+#include "../coap_downloader_shared.h"
 #include "../dm/dm_integration.h"
 #include "../exchange.h"
 #include "../exchange_cache.h"
+#include "../metrics.h"
+#include "../trace.h"
 #include "core.h"
 #include "core_utils.h"
 #include "reg_session.h"
 #include "register.h"
+#include "server_register.h"
+#include "session_persistence.h"
 #include "srv_conn.h"
 
 #ifdef ANJ_WITH_LWM2M_SEND
@@ -66,15 +71,31 @@ static anj_time_monotonic_t calculate_next_update(anj_t *anj) {
     } else {
         timeout = half_lifetime;
     }
+#ifdef ANJ_WITH_SCHEDULING_JITTER
+    // only earlier, so that the registration does not expire
+    timeout = anj_time_duration_sub(
+            timeout,
+            _anj_core_utils_jitter_percent(anj, _ANJ_CORE_JITTER_UPDATE, 0,
+                                           timeout,
+                                           anj->update_spread_percent));
+#endif // ANJ_WITH_SCHEDULING_JITTER
 
-    return anj_time_monotonic_add(anj_time_monotonic_now(), timeout);
+    return anj_time_monotonic_add(_ANJ_CORE_NOW(anj), timeout);
 }
 
 static void refresh_queue_mode_timeout(anj_t *anj) {
+    anj_time_duration_t timeout = anj->queue_mode_timeout;
+#ifdef ANJ_WITH_NAT_KEEPALIVE_PROBING
+    // requests of the server can't get through once the NAT binding expires
+    anj_time_duration_t nat_interval = _anj_srv_conn_nat_interval(&anj->nat);
+    if (anj_time_duration_is_valid(nat_interval)
+            && anj_time_duration_lt(nat_interval, timeout)) {
+        timeout = nat_interval;
+    }
+#endif // ANJ_WITH_NAT_KEEPALIVE_PROBING
     anj->server_state.details.registered.queue_start_time =
             anj->queue_mode_enabled
-                    ? anj_time_monotonic_add(anj_time_monotonic_now(),
-                                             anj->queue_mode_timeout)
+                    ? anj_time_monotonic_add(_ANJ_CORE_NOW(anj), timeout)
                     : ANJ_TIME_MONOTONIC_INVALID;
 }
 
@@ -82,21 +103,43 @@ void _anj_reg_session_init(anj_t *anj) {
     anj->server_state.details.registered.internal_state =
             _ANJ_SRV_MAN_STATE_IDLE_IN_PROGRESS;
     anj->server_state.registration_update_triggered = false;
+#ifdef ANJ_WITH_WARM_RESTART
+    // Data Model has just been read for the Register
+    anj->server_state.warm_restart_triggered = false;
+#endif // ANJ_WITH_WARM_RESTART
     _anj_reg_session_refresh_registration_related_resources(anj);
+#ifdef ANJ_WITH_OBSERVE
+    anj->server_instance.observe_state.is_server_online = true;
+#endif // ANJ_WITH_OBSERVE
     anj->server_state.details.registered.next_update_time =
             calculate_next_update(anj);
     anj->server_state.details.registered.update_with_lifetime = false;
     anj->server_state.details.registered.update_with_payload = false;
+#ifdef ANJ_WITH_UPDATE_HOLD_DOWN
+    anj->server_state.details.registered.update_hold_down_end =
+            ANJ_TIME_MONOTONIC_INVALID;
+#endif // ANJ_WITH_UPDATE_HOLD_DOWN
     _anj_core_state_transition_clear(anj);
     anj->server_state.enable_time = ANJ_TIME_MONOTONIC_ZERO;
     anj->server_state.enable_time_user_triggered = ANJ_TIME_MONOTONIC_ZERO;
+#ifdef ANJ_WITH_NAT_KEEPALIVE_PROBING
+    _anj_srv_conn_nat_traffic(&anj->nat, _ANJ_CORE_NOW(anj));
+#endif // ANJ_WITH_NAT_KEEPALIVE_PROBING
     refresh_queue_mode_timeout(anj);
+#ifdef ANJ_WITH_NAT_REBINDING_RECOVERY
+    anj->server_state.details.registered.rebinding = false;
+#endif // ANJ_WITH_NAT_REBINDING_RECOVERY
+#ifdef ANJ_WITH_SESSION_PERSISTENCE
+    _anj_core_session_resume_finish(anj);
+#endif // ANJ_WITH_SESSION_PERSISTENCE
 }
 
 #ifdef ANJ_WITH_OBSERVE
 static void update_observe_parameters(anj_t *anj) {
     anj->server_instance.observe_state = (_anj_observe_server_state_t) {
-        .is_server_online = true,
+        // resources of the Server Object don't affect connection state
+        .is_server_online =
+                anj->server_instance.observe_state.is_server_online,
         .ssid = anj->server_instance.ssid,
         .default_min_period = 0,
         .default_max_period = 0,
@@ -181,6 +224,12 @@ static void get_mute_send(anj_t *anj) {
 
 void _anj_reg_session_refresh_registration_related_resources(anj_t *anj) {
     assert(_anj_core_client_registered(anj));
+#ifdef ANJ_WITH_SERVER_DATA_CACHE
+    if (anj->server_instance.reg_resources_cached) {
+        return;
+    }
+    anj->server_instance.reg_resources_cached = true;
+#endif // ANJ_WITH_SERVER_DATA_CACHE
     get_lifetime(anj);
 #ifdef ANJ_WITH_LWM2M_SEND
     get_mute_send(anj);
@@ -191,13 +240,30 @@ void _anj_reg_session_refresh_registration_related_resources(anj_t *anj) {
 }
 
 static int handle_incoming_message(anj_t *anj, size_t msg_size) {
-    _anj_coap_msg_t msg;
-    int res = _anj_coap_decode_udp(anj->in_buffer, msg_size, &msg);
+    _ANJ_METRICS_ADD(&anj->metrics, bytes_received, msg_size);
+    _ANJ_CORE_USAGE_UPDATE(anj, in_buffer_max, msg_size);
+    _ANJ_TRACE(&anj->trace, NET_RECV, INSTANT, msg_size);
+    _ANJ_CORE_SCRATCH_MSG(anj, msg, in_msg);
+    int res = _ANJ_CORE_DECODE_IN_MSG(anj, msg_size, msg);
     if (res) {
         ANJ_CORE_LOG_COAP_ERROR(res);
         // ignore invalid messages
         return 0;
     }
+#ifdef ANJ_WITH_NAT_KEEPALIVE_PROBING
+    _anj_srv_conn_nat_received(&anj->nat, _ANJ_CORE_NOW(anj));
+#endif // ANJ_WITH_NAT_KEEPALIVE_PROBING
+
+#ifdef ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+    if (_anj_coap_downloader_shared_handle_msg(anj, msg)) {
+        return 0;
+    }
+#endif // ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+#ifdef ANJ_WITH_PIPELINED_NOTIFICATIONS
+    if (_anj_srv_conn_handle_pipelined_response(anj, msg)) {
+        return 0;
+    }
+#endif // ANJ_WITH_PIPELINED_NOTIFICATIONS
 
     _anj_exchange_handlers_t exchange_handlers = { 0 };
     uint8_t response_code = 0;
@@ -205,7 +271,10 @@ static int handle_incoming_message(anj_t *anj, size_t msg_size) {
 #ifdef ANJ_WITH_CACHE
     // check if it's a retransmission
     int cache_try = _anj_exchange_cache_check(&anj->exchange_cache,
-                                              msg.coap_binding_data.message_id);
+                                              msg->coap_binding_data.message_id);
+    if (cache_try != _ANJ_EXCHANGE_CACHE_MISS) {
+        _ANJ_METRICS_INC(&anj->metrics, cache_hits);
+    }
     if (cache_try == _ANJ_EXCHANGE_CACHE_HIT_RECENT) {
         return _ANJ_REG_SESSION_NEW_EXCHANGE;
     } else if (cache_try == _ANJ_EXCHANGE_CACHE_HIT_NON_RECENT) {
@@ -215,7 +284,7 @@ static int handle_incoming_message(anj_t *anj, size_t msg_size) {
 #endif // ANJ_WITH_CACHE
 
     // find the right module to handle the message
-    switch (msg.operation) {
+    switch (msg->operation) {
     case ANJ_OP_DM_READ:
     case ANJ_OP_DM_DISCOVER:
     case ANJ_OP_DM_WRITE_REPLACE:
@@ -227,7 +296,7 @@ static int handle_incoming_message(anj_t *anj, size_t msg_size) {
     case ANJ_OP_DM_READ_COMP:
     case ANJ_OP_DM_WRITE_COMP:
 #endif // ANJ_WITH_COMPOSITE_OPERATIONS
-        _anj_dm_process_request(anj, &msg, anj->server_instance.ssid,
+        _anj_dm_process_request(anj, msg, anj->server_instance.ssid,
                                 &response_code, &exchange_handlers);
         break;
 #ifndef ANJ_WITH_COMPOSITE_OPERATIONS
@@ -244,10 +313,17 @@ static int handle_incoming_message(anj_t *anj, size_t msg_size) {
     case ANJ_OP_INF_CANCEL_OBSERVE_COMP:
 #ifdef ANJ_WITH_OBSERVE
     {
+#    ifdef ANJ_WITH_LWM2M_GATEWAY
+        if (msg->gateway_prefix) {
+            log(L_WARNING, "Observations of End IoT Devices not supported");
+            response_code = ANJ_COAP_CODE_NOT_IMPLEMENTED;
+            break;
+        }
+#    endif // ANJ_WITH_LWM2M_GATEWAY
         _anj_observe_new_request(anj,
                                  &exchange_handlers,
                                  &anj->server_instance.observe_state,
-                                 &msg,
+                                 msg,
                                  &response_code);
         break;
     }
@@ -262,37 +338,101 @@ static int handle_incoming_message(anj_t *anj, size_t msg_size) {
     case ANJ_OP_COAP_RESET: {
         // non-confirmable notifications cancel by RST is handled here
         _anj_observe_cancel_observation_by_mid(
-                anj, msg.coap_binding_data.message_id);
+                anj, msg->coap_binding_data.message_id);
         return 0;
     }
 #endif // ANJ_WITH_RST_AS_CANCEL_OBSERVE
     case ANJ_OP_COAP_PING_UDP:
         break; // PING is handled by the exchange module
     default: {
-        log(L_WARNING, "Invalid operation: %d", (int) msg.operation);
+        log(L_WARNING, "Invalid operation: %d", (int) msg->operation);
         return 0;
     }
     }
 
-    if (_anj_srv_conn_prepare_server_request(anj, &msg, response_code,
+    if (_anj_srv_conn_prepare_server_request(anj, msg, response_code,
                                              &exchange_handlers)) {
         return -1;
     }
     return _ANJ_REG_SESSION_NEW_EXCHANGE;
 }
 
+#ifdef ANJ_WITH_UPDATE_HOLD_DOWN
+// Called when an Update is pending. The first trigger opens the hold-down
+// window, the ones that come before it ends are sent in the same Update. The
+// periodic Update is not delayed, it carries the pending changes as well.
+static bool update_held_down(anj_t *anj) {
+    anj_time_monotonic_t now = _ANJ_CORE_NOW(anj);
+    if (anj_time_duration_eq(anj->update_hold_down, ANJ_TIME_DURATION_ZERO)
+            || anj_time_monotonic_gt(
+                       now,
+                       anj->server_state.details.registered.next_update_time)) {
+        return false;
+    }
+    anj_time_monotonic_t *end =
+            &anj->server_state.details.registered.update_hold_down_end;
+    if (!anj_time_monotonic_is_valid(*end)) {
+        *end = anj_time_monotonic_add(now, anj->update_hold_down);
+        log(L_DEBUG, "Update held back");
+    }
+    return anj_time_monotonic_lt(now, *end);
+}
+#endif // ANJ_WITH_UPDATE_HOLD_DOWN
+
+#ifdef ANJ_WITH_NAT_KEEPALIVE_PROBING
+// Update sent to refresh the NAT binding, so that requests of the server still
+// get through. In Queue Mode the client goes offline before it's needed.
+static bool nat_keepalive_due(anj_t *anj) {
+    const _anj_srv_conn_nat_t *nat = &anj->nat;
+    anj_time_duration_t interval = _anj_srv_conn_nat_interval(nat);
+    return !anj->queue_mode_enabled
+           && (anj->connection_ctx.type == ANJ_NET_BINDING_UDP
+               || anj->connection_ctx.type == ANJ_NET_BINDING_DTLS)
+           && anj_time_duration_is_valid(interval)
+           && anj_time_monotonic_is_valid(nat->last_traffic)
+           && anj_time_monotonic_gt(
+                   _ANJ_CORE_NOW(anj),
+                   anj_time_monotonic_add(nat->last_traffic, interval));
+}
+#endif // ANJ_WITH_NAT_KEEPALIVE_PROBING
+
 static int handle_registration_update(anj_t *anj) {
     // "When any of the parameters listed in Table: 6.2.2.-1 Update Parameters
     // changes, the LwM2M Client MUST send an "Update" operation to the LwM2M
     // Server"
+#ifdef ANJ_DM_WITH_LINK_SET_HASH
+    if (anj->server_state.details.registered.update_with_payload
+            && !_anj_register_link_set_changed(anj)) {
+        // e.g. an Instance has been added and removed again
+        anj->server_state.details.registered.update_with_payload = false;
+    }
+#endif // ANJ_DM_WITH_LINK_SET_HASH
+#ifdef ANJ_WITH_NAT_KEEPALIVE_PROBING
+    bool keepalive = nat_keepalive_due(anj);
+#else  // ANJ_WITH_NAT_KEEPALIVE_PROBING
+    bool keepalive = false;
+#endif // ANJ_WITH_NAT_KEEPALIVE_PROBING
     if (!anj_time_monotonic_gt(
-                anj_time_monotonic_now(),
+                _ANJ_CORE_NOW(anj),
                 anj->server_state.details.registered.next_update_time)
+            && !keepalive
             && !anj->server_state.details.registered.update_with_lifetime
             && !anj->server_state.details.registered.update_with_payload
             && !anj->server_state.registration_update_triggered) {
+#ifdef ANJ_WITH_UPDATE_HOLD_DOWN
+        // e.g. the Object list is the same as before the window was opened
+        anj->server_state.details.registered.update_hold_down_end =
+                ANJ_TIME_MONOTONIC_INVALID;
+#endif // ANJ_WITH_UPDATE_HOLD_DOWN
         return 0;
     }
+#ifdef ANJ_WITH_UPDATE_HOLD_DOWN
+    if (!keepalive && update_held_down(anj)) {
+        return 0;
+    }
+    anj->server_state.details.registered.update_hold_down_end =
+            ANJ_TIME_MONOTONIC_INVALID;
+#endif // ANJ_WITH_UPDATE_HOLD_DOWN
     _anj_reg_session_refresh_registration_related_resources(anj);
     anj->server_state.details.registered.next_update_time =
             calculate_next_update(anj);
@@ -304,31 +444,93 @@ static int handle_registration_update(anj_t *anj) {
                     ? &update_msg_lifetime
                     : NULL;
     anj->server_state.details.registered.update_with_lifetime = false;
-    _anj_coap_msg_t msg;
-    memset(&msg, 0, sizeof(msg));
+    _ANJ_CORE_SCRATCH_MSG(anj, msg, out_msg);
+    memset(msg, 0, sizeof(*msg));
     _anj_exchange_handlers_t exchange_handlers = { 0 };
     bool with_payload =
             anj->server_state.details.registered.update_with_payload;
     anj->server_state.details.registered.update_with_payload = false;
 
-    _anj_register_update(anj, lifetime, with_payload, &msg, &exchange_handlers);
-    if (_anj_srv_conn_prepare_client_request(anj, &msg, &exchange_handlers)) {
+    _anj_register_update(anj, lifetime, with_payload, msg, &exchange_handlers);
+    if (_anj_srv_conn_prepare_client_request(anj, msg, &exchange_handlers)) {
         return -1;
     }
     return _ANJ_REG_SESSION_NEW_EXCHANGE;
 }
 
+#ifdef ANJ_WITH_WARM_RESTART
+// Checks whether the Data Model still points to the server the client is
+// connected to. Server URI is compared before it's stored in
+// security_instance, so that it's still possible to fall back to a full
+// restart with a proper Deregister.
+static bool server_unchanged(anj_t *anj) {
+    uint16_t ssid;
+    anj_iid_t server_iid;
+    anj_iid_t security_iid;
+    if (_anj_dm_get_server_obj_instance_data(anj, &ssid, &server_iid)
+            || ssid != anj->server_instance.ssid
+            || _anj_dm_get_security_obj_instance_iid(anj, ssid, &security_iid)
+            || security_iid != anj->security_instance.iid) {
+        return false;
+    }
+    anj_res_value_t res_val;
+    _anj_core_utils_uri_components_t uri;
+    if (anj_dm_res_read(anj,
+                        &ANJ_MAKE_RESOURCE_PATH(ANJ_OBJ_ID_SECURITY,
+                                                security_iid,
+                                                SECURITY_OBJ_SERVER_URI_RID),
+                        &res_val)
+            || _anj_core_utils_parse_uri_components(
+                       (const char *) res_val.bytes_or_string.data, false,
+                       &uri)) {
+        return false;
+    }
+    return uri.binding_type == anj->security_instance.type
+           && uri.host_len == strlen(anj->security_instance.server_uri)
+           && !memcmp(uri.host, anj->security_instance.server_uri,
+                      uri.host_len)
+           && uri.port_len == strlen(anj->security_instance.port)
+           && !memcmp(uri.port, anj->security_instance.port, uri.port_len);
+}
+
+static void handle_warm_restart(anj_t *anj) {
+    anj->server_state.warm_restart_triggered = false;
+    anj_time_duration_t last_lifetime = anj->server_instance.lifetime;
+#    ifdef ANJ_WITH_SERVER_DATA_CACHE
+    anj->server_instance.dm_data_cached = false;
+    anj->server_instance.reg_resources_cached = false;
+#    endif // ANJ_WITH_SERVER_DATA_CACHE
+    if (!server_unchanged(anj) || _anj_server_register_read_data_model(anj)) {
+        log(L_INFO, "Server configuration changed, restarting");
+        anj->server_state.restart_triggered = true;
+        return;
+    }
+    _anj_reg_session_refresh_registration_related_resources(anj);
+    if (!anj_time_duration_eq(last_lifetime, anj->server_instance.lifetime)) {
+        anj->server_state.details.registered.update_with_lifetime = true;
+    }
+#    ifdef ANJ_WITH_OBSERVE
+    _anj_observe_remove_observations_of_missing_paths(
+            anj, anj->server_instance.ssid);
+#    endif // ANJ_WITH_OBSERVE
+    // with ANJ_DM_WITH_LINK_SET_HASH, it's sent only if the list has changed
+    anj->server_state.details.registered.update_with_payload = true;
+    log(L_INFO, "Warm restart finished, registration kept");
+}
+#endif // ANJ_WITH_WARM_RESTART
+
 #ifdef ANJ_WITH_LWM2M_SEND
 static int handle_send(anj_t *anj) {
-    _anj_coap_msg_t msg;
-    memset(&msg, 0, sizeof(msg));
+    _ANJ_CORE_SCRATCH_MSG(anj, msg, out_msg);
+    memset(msg, 0, sizeof(*msg));
     _anj_exchange_handlers_t exchange_handlers = { 0 };
-    _anj_lwm2m_send_process(anj, &exchange_handlers, &msg);
-    if (msg.operation != ANJ_OP_INF_CON_SEND) {
+    _anj_lwm2m_send_process(anj, &exchange_handlers, msg);
+    if (msg->operation != ANJ_OP_INF_CON_SEND
+            && msg->operation != ANJ_OP_INF_NON_CON_SEND) {
         return 0;
     }
     log(L_DEBUG, "Sending LwM2M Send");
-    if (_anj_srv_conn_prepare_client_request(anj, &msg, &exchange_handlers)) {
+    if (_anj_srv_conn_prepare_client_request(anj, msg, &exchange_handlers)) {
         return -1;
     }
     return _ANJ_REG_SESSION_NEW_EXCHANGE;
@@ -336,41 +538,351 @@ static int handle_send(anj_t *anj) {
 #endif // ANJ_WITH_LWM2M_SEND
 
 #ifdef ANJ_WITH_OBSERVE
+#    ifdef ANJ_WITH_PIPELINED_NOTIFICATIONS
+static void pipelined_notification_completion(void *arg_ptr,
+                                              const _anj_coap_msg_t *response,
+                                              int result) {
+    (void) response;
+    _anj_pipelined_exchange_t *pipelined =
+            (_anj_pipelined_exchange_t *) arg_ptr;
+    anj_t *anj = pipelined->anj;
+    _anj_observe_detached_notification_completion(
+            anj, &pipelined->notification, result);
+    if (result == _ANJ_EXCHANGE_RESULT_SUCCESS) {
+#        ifdef ANJ_WITH_NAT_KEEPALIVE_PROBING
+        _anj_srv_conn_nat_traffic(&anj->nat, _ANJ_CORE_NOW(anj));
+#        endif // ANJ_WITH_NAT_KEEPALIVE_PROBING
+        refresh_queue_mode_timeout(anj);
+    }
+}
+
+// Notification prepared in a single message is detached from the Observe
+// module, so that the next one can be prepared before the response arrives.
+// It has to be sent with _anj_srv_conn_handle_pipelined_requests() then.
+static int prepare_pipelined_notification(anj_t *anj,
+                                          _anj_pipelined_exchange_t *pipelined,
+                                          _anj_coap_msg_t *msg,
+                                          _anj_exchange_handlers_t *handlers) {
+    int res = _anj_srv_conn_prepare_pipelined_request(anj, pipelined, msg,
+                                                      handlers);
+    if (res) {
+        return res;
+    }
+#        ifdef ANJ_WITH_RST_AS_CANCEL_OBSERVE
+    _anj_observe_update_last_mid(anj, msg->coap_binding_data.message_id);
+#        endif // ANJ_WITH_RST_AS_CANCEL_OBSERVE
+#        ifdef ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS
+    _anj_observe_update_last_etag(anj, &msg->etag);
+#        endif // ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS
+    if (!_anj_exchange_pipelined_request_deferred(&pipelined->exchange_ctx)) {
+        _anj_observe_detach_notification(anj, &pipelined->notification);
+        _anj_exchange_set_completion(&pipelined->exchange_ctx,
+                                     pipelined_notification_completion,
+                                     pipelined);
+    }
+    return 0;
+}
+#    endif // ANJ_WITH_PIPELINED_NOTIFICATIONS
+
 static int handle_observe(anj_t *anj) {
-    _anj_coap_msg_t msg;
-    memset(&msg, 0, sizeof(msg));
+    _ANJ_CORE_SCRATCH_MSG(anj, msg, out_msg);
+    memset(msg, 0, sizeof(*msg));
     _anj_exchange_handlers_t exchange_handlers = { 0 };
+#    ifdef ANJ_WITH_NEXT_STEP_TIME_CACHE
+    // in queue mode, the stored notification time lets the scan be skipped
+    anj_time_duration_t time_to_next_notification;
+    if (anj->server_state.conn_status == ANJ_CONN_STATUS_QUEUE_MODE
+            && !_anj_core_utils_time_to_next_notification(
+                    anj, &time_to_next_notification)
+            && (!anj_time_duration_is_valid(time_to_next_notification)
+                || anj_time_duration_gt(time_to_next_notification,
+                                        ANJ_TIME_DURATION_ZERO))) {
+        return 0;
+    }
+#    endif // ANJ_WITH_NEXT_STEP_TIME_CACHE
+    _ANJ_TRACE(&anj->trace, OBSERVE_SCAN, BEGIN, 0);
     _anj_observe_process(anj, &exchange_handlers,
-                         &anj->server_instance.observe_state, &msg);
-    if (msg.operation != ANJ_OP_INF_CON_NOTIFY
-            && msg.operation != ANJ_OP_INF_NON_CON_NOTIFY) {
+                         &anj->server_instance.observe_state, msg);
+    _ANJ_CORE_NEXT_NOTIFICATION_CHANGED(anj);
+    _ANJ_TRACE(&anj->trace, OBSERVE_SCAN, END, msg->operation);
+    if (msg->operation != ANJ_OP_INF_CON_NOTIFY
+            && msg->operation != ANJ_OP_INF_NON_CON_NOTIFY) {
         return 0;
     }
     log(L_DEBUG, "Sending notification");
-    if (_anj_srv_conn_prepare_client_request(anj, &msg, &exchange_handlers)) {
+#    ifdef ANJ_WITH_PIPELINED_NOTIFICATIONS
+    // Confirmable notification doesn't hold back other requests until it's
+    // acknowledged, as long as NSTART allows
+    _anj_pipelined_exchange_t *pipelined = NULL;
+    if (msg->operation == ANJ_OP_INF_CON_NOTIFY
+            && anj->server_state.details.registered.internal_state
+                       == _ANJ_SRV_MAN_STATE_IDLE_IN_PROGRESS) {
+        pipelined = _anj_srv_conn_free_pipelined_exchange(anj);
+    }
+    if (pipelined) {
+        if (prepare_pipelined_notification(anj, pipelined, msg,
+                                           &exchange_handlers)) {
+            return -1;
+        }
+        if (_anj_srv_conn_pipelined_request_deferred(anj)) {
+            // Block-Wise notification needs the main exchange context
+            return _anj_srv_conn_take_over_pipelined_request(anj)
+                           ? -1
+                           : _ANJ_REG_SESSION_NEW_EXCHANGE;
+        }
+        _anj_srv_conn_handle_pipelined_requests(anj);
+        return 0;
+    }
+#    endif // ANJ_WITH_PIPELINED_NOTIFICATIONS
+    if (_anj_srv_conn_prepare_client_request(anj, msg, &exchange_handlers)) {
         return -1;
     }
 // The message was prepared successfully, so we update last sent Notify
 // Message ID for the processed observation. This way if we receive CoAP
 // Reset in response, we can math it to the observation and cancel it.
 #    ifdef ANJ_WITH_RST_AS_CANCEL_OBSERVE
-    _anj_observe_update_last_mid(anj, msg.coap_binding_data.message_id);
+    _anj_observe_update_last_mid(anj, msg->coap_binding_data.message_id);
 #    endif // ANJ_WITH_RST_AS_CANCEL_OBSERVE
+#    ifdef ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS
+    _anj_observe_update_last_etag(anj, &msg->etag);
+#    endif // ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS
     return _ANJ_REG_SESSION_NEW_EXCHANGE;
 }
+
+#    ifdef ANJ_WITH_PIPELINED_NOTIFICATIONS
+#        ifdef ANJ_WITH_INTERLEAVED_NOTIFICATIONS
+static void swap_interleaved_operation(anj_t *anj) {
+    _anj_dm_swap_operation(anj, &anj->interleaved.dm_op,
+                           &anj->interleaved.out_ctx);
+}
+
+// The data model operation of a notification kept aside is brought back for
+// the completion handler, which finalizes it.
+static void interleaved_notification_completion(void *arg_ptr,
+                                                const _anj_coap_msg_t *response,
+                                                int result) {
+    anj_t *anj = (anj_t *) arg_ptr;
+    bool aside = anj->interleaved.notification_aside;
+    if (aside) {
+        swap_interleaved_operation(anj);
+        anj->interleaved.notification_aside = false;
+    }
+    anj->interleaved.completion(anj->interleaved.completion_arg, response,
+                                result);
+    if (aside) {
+        swap_interleaved_operation(anj);
+    }
+}
+
+// Called before the deferred notification is taken over, the Read operation
+// kept in the data model is already finished.
+static void resume_interleaved_notification(anj_t *anj) {
+    if (anj->interleaved.notification_aside) {
+        swap_interleaved_operation(anj);
+        anj->interleaved.notification_aside = false;
+    }
+}
+#        endif // ANJ_WITH_INTERLEAVED_NOTIFICATIONS
+
+// Called while the client request in the main exchange context waits for the
+// response, or the server request waits for the request for the next block.
+// Notification sent in a single message is sent immediately if a pipelined
+// exchange context is free, Block-Wise one is deferred until the main exchange
+// is finished.
+static void handle_pipelined_observe(anj_t *anj) {
+    if (!_anj_exchange_pipelining_allowed(&anj->exchange_ctx)
+            || _anj_srv_conn_pipelined_request_deferred(anj)
+            || anj->connection_ctx.send_in_progress) {
+        return;
+    }
+    _anj_pipelined_exchange_t *pipelined =
+            _anj_srv_conn_free_pipelined_exchange(anj);
+    if (!pipelined) {
+        // NSTART reached
+        return;
+    }
+#        ifdef ANJ_WITH_LWM2M_GATEWAY
+    if (_anj_dm_gateway_device_selected(anj)) {
+        // the data model of the Gateway is not in place
+        return;
+    }
+#        endif // ANJ_WITH_LWM2M_GATEWAY
+#        ifdef ANJ_WITH_INTERLEAVED_NOTIFICATIONS
+    // data model handles one operation at a time, the ongoing Read is kept
+    // aside until the notification is prepared
+    bool interleaved = anj->dm.op_in_progress;
+    if (interleaved) {
+        swap_interleaved_operation(anj);
+    }
+#        endif // ANJ_WITH_INTERLEAVED_NOTIFICATIONS
+    _ANJ_CORE_SCRATCH_MSG(anj, msg, out_msg);
+    memset(msg, 0, sizeof(*msg));
+    _anj_exchange_handlers_t exchange_handlers = { 0 };
+    _ANJ_TRACE(&anj->trace, OBSERVE_SCAN, BEGIN, 0);
+    _anj_observe_process(anj, &exchange_handlers,
+                         &anj->server_instance.observe_state, msg);
+    _ANJ_TRACE(&anj->trace, OBSERVE_SCAN, END, msg->operation);
+    if (msg->operation != ANJ_OP_INF_CON_NOTIFY
+            && msg->operation != ANJ_OP_INF_NON_CON_NOTIFY) {
+        goto finish;
+    }
+#        ifdef ANJ_WITH_INTERLEAVED_NOTIFICATIONS
+    if (interleaved) {
+        anj->interleaved.completion = exchange_handlers.completion;
+        anj->interleaved.completion_arg = exchange_handlers.arg;
+        exchange_handlers.completion = interleaved_notification_completion;
+        exchange_handlers.arg = anj;
+    }
+#        endif // ANJ_WITH_INTERLEAVED_NOTIFICATIONS
+    log(L_DEBUG, "Sending pipelined notification");
+    if (prepare_pipelined_notification(anj, pipelined, msg,
+                                       &exchange_handlers)) {
+        // the main exchange is not affected
+        log(L_WARNING, "Could not prepare pipelined notification");
+        goto finish;
+    }
+    // network errors are reported by the main exchange
+    _anj_srv_conn_handle_pipelined_requests(anj);
+finish:
+#        ifdef ANJ_WITH_INTERLEAVED_NOTIFICATIONS
+    if (interleaved) {
+        swap_interleaved_operation(anj);
+        // notification sent in a single message is finished in the data model
+        anj->interleaved.notification_aside =
+                _anj_srv_conn_pipelined_request_deferred(anj);
+    }
+#        endif // ANJ_WITH_INTERLEAVED_NOTIFICATIONS
+    return;
+}
+#    endif // ANJ_WITH_PIPELINED_NOTIFICATIONS
 #endif // ANJ_WITH_OBSERVE
 
+#ifdef ANJ_WITH_QUEUE_MODE_WAKE_WINDOW
+// Returns the earliest point in time at which a Send request or a notification
+// is expected to be ready, ANJ_TIME_MONOTONIC_INVALID if there is none.
+static anj_time_monotonic_t next_client_request_time(anj_t *anj) {
+    anj_time_monotonic_t next = ANJ_TIME_MONOTONIC_INVALID;
+#    ifdef ANJ_WITH_LWM2M_SEND
+    next = _anj_lwm2m_send_ready_time(anj);
+#    endif // ANJ_WITH_LWM2M_SEND
+#    ifdef ANJ_WITH_OBSERVE
+    anj_time_duration_t time_to_next_notification;
+    if (!_anj_core_utils_time_to_next_notification(anj,
+                                                   &time_to_next_notification)
+            && anj_time_duration_is_valid(time_to_next_notification)) {
+        anj_time_monotonic_t notification_time =
+                anj_time_monotonic_add(_ANJ_CORE_NOW(anj),
+                                       time_to_next_notification);
+        if (!anj_time_monotonic_is_valid(next)
+                || anj_time_monotonic_lt(notification_time, next)) {
+            next = notification_time;
+        }
+    }
+#    endif // ANJ_WITH_OBSERVE
+    return next;
+}
+
+// Called in queue mode, before any request is sent. If the client is about to
+// go online for a Send request or a notification, the Update due within the
+// wake window is sent first, so that it also informs the server that the
+// client is online and doesn't wake the radio up again shortly after.
+static void plan_wake_window(anj_t *anj) {
+    if (anj_time_duration_eq(anj->queue_mode_wake_window,
+                             ANJ_TIME_DURATION_ZERO)) {
+        return;
+    }
+    anj_time_monotonic_t now = _ANJ_CORE_NOW(anj);
+    anj_time_monotonic_t next_request = next_client_request_time(anj);
+    if (!anj_time_monotonic_is_valid(next_request)
+            || anj_time_monotonic_gt(next_request, now)) {
+        return;
+    }
+    anj_time_monotonic_t window_end =
+            anj_time_monotonic_add(now, anj->queue_mode_wake_window);
+    if (!anj_time_monotonic_gt(
+                anj->server_state.details.registered.next_update_time,
+                window_end)) {
+        log(L_DEBUG, "Update sent earlier, in the same wake window");
+        anj->server_state.registration_update_triggered = true;
+    }
+}
+
+// Called when the client is about to enter queue mode. If an Update, a Send
+// request or a notification is planned within the wake window, the client
+// stays online until then.
+static bool wake_window_open(anj_t *anj) {
+    if (anj_time_duration_eq(anj->queue_mode_wake_window,
+                             ANJ_TIME_DURATION_ZERO)) {
+        return false;
+    }
+    anj_time_monotonic_t now = _ANJ_CORE_NOW(anj);
+    anj_time_monotonic_t next = next_client_request_time(anj);
+    if (!anj_time_monotonic_is_valid(next)
+            || anj_time_monotonic_gt(
+                    next,
+                    anj->server_state.details.registered.next_update_time)) {
+        next = anj->server_state.details.registered.next_update_time;
+    }
+    if (!anj_time_monotonic_gt(next, now)
+            || anj_time_monotonic_gt(next,
+                                     anj_time_monotonic_add(
+                                             now,
+                                             anj->queue_mode_wake_window))) {
+        return false;
+    }
+    // timeout is refreshed after the planned request anyway, this only makes
+    // sure that the check isn't repeated until then
+    anj->server_state.details.registered.queue_start_time = next;
+    return true;
+}
+#endif // ANJ_WITH_QUEUE_MODE_WAKE_WINDOW
+
 static int try_send_deregistrer(anj_t *anj) {
-    _anj_coap_msg_t msg;
-    memset(&msg, 0, sizeof(msg));
+    _ANJ_CORE_SCRATCH_MSG(anj, msg, out_msg);
+    memset(msg, 0, sizeof(*msg));
     _anj_exchange_handlers_t out_handlers = { 0 };
-    _anj_register_deregister(anj, &msg, &out_handlers);
-    if (_anj_srv_conn_prepare_client_request(anj, &msg, &out_handlers)) {
+    _anj_register_deregister(anj, msg, &out_handlers);
+    if (_anj_srv_conn_prepare_client_request(anj, msg, &out_handlers)) {
         return -1;
     }
+#ifdef ANJ_NET_WITH_RELEASE_ASSISTANCE
+    // the connection is closed after the response
+    _anj_srv_conn_release_assistance(&anj->connection_ctx,
+                                     ANJ_NET_RELEASE_HINT_LAST_UPLINK);
+#endif // ANJ_NET_WITH_RELEASE_ASSISTANCE
     return _ANJ_REG_SESSION_NEW_EXCHANGE;
 }
 
+// Called when the connection is lost, e.g. because the NAT binding expired
+// during queue mode and the source port of the client has changed.
+static uint8_t get_state_for_connection_lost(anj_t *anj) {
+#ifdef ANJ_WITH_NAT_KEEPALIVE_PROBING
+    _anj_srv_conn_nat_lost(&anj->nat);
+#endif // ANJ_WITH_NAT_KEEPALIVE_PROBING
+#ifdef ANJ_WITH_NAT_REBINDING_RECOVERY
+    // DTLS session is kept by _anj_srv_conn_close() and the server recognizes
+    // it by the Connection ID, otherwise the Update tells the server the new
+    // address of the client
+    if (!anj->server_state.details.registered.rebinding
+            && (anj->connection_ctx.type == ANJ_NET_BINDING_UDP
+                || anj->connection_ctx.type == ANJ_NET_BINDING_DTLS)) {
+        return _ANJ_SRV_MAN_STATE_REBINDING_IN_PROGRESS;
+    }
+#endif // ANJ_WITH_NAT_REBINDING_RECOVERY
+    (void) anj;
+    return _ANJ_SRV_MAN_STATE_DISCONNECT_IN_PROGRESS;
+}
+
+static bool register_operation_unanswered(anj_t *anj) {
+#ifdef ANJ_WITH_NAT_REBINDING_RECOVERY
+    return _anj_register_operation_status(anj) == _ANJ_REGISTER_OPERATION_ERROR
+           && _anj_register_no_response(anj);
+#else  // ANJ_WITH_NAT_REBINDING_RECOVERY
+    (void) anj;
+    return false;
+#endif // ANJ_WITH_NAT_REBINDING_RECOVERY
+}
+
 static uint8_t get_new_state_for_new_exchange(uint8_t current_state,
                                               int result) {
     if (result != _ANJ_REG_SESSION_NEW_EXCHANGE) {
@@ -404,6 +916,29 @@ _anj_reg_session_process_registered(anj_t *anj, anj_conn_status_t *out_status) {
             anj->server_state.details.registered.transition_forced = false;
         }
 
+#ifdef ANJ_WITH_PIPELINED_NOTIFICATIONS
+        // notifications sent next to the main exchange context, the message
+        // being sent occupies the output buffer
+        if (anj_net_is_inprogress(
+                    _anj_srv_conn_handle_pipelined_requests(anj))) {
+            return _ANJ_CORE_NEXT_ACTION_LEAVE;
+        }
+        // notification postponed during the previous exchange goes first
+        if (_anj_srv_conn_pipelined_request_deferred(anj)) {
+#    ifdef ANJ_WITH_INTERLEAVED_NOTIFICATIONS
+            resume_interleaved_notification(anj);
+#    endif // ANJ_WITH_INTERLEAVED_NOTIFICATIONS
+            res = _anj_srv_conn_take_over_pipelined_request(anj)
+                          ? -1
+                          : _ANJ_REG_SESSION_NEW_EXCHANGE;
+            anj->server_state.details.registered.internal_state =
+                    get_new_state_for_new_exchange(
+                            anj->server_state.details.registered.internal_state,
+                            res);
+            return _ANJ_CORE_NEXT_ACTION_CONTINUE;
+        }
+#endif // ANJ_WITH_PIPELINED_NOTIFICATIONS
+
         // check for new requests
         size_t msg_size;
         res = _anj_srv_conn_receive(&anj->connection_ctx, anj->in_buffer,
@@ -424,7 +959,7 @@ _anj_reg_session_process_registered(anj_t *anj, anj_conn_status_t *out_status) {
         } else if (!anj_net_is_again(res)) {
             log(L_ERROR, "Error while receiving message: %d", res);
             anj->server_state.details.registered.internal_state =
-                    _ANJ_SRV_MAN_STATE_DISCONNECT_IN_PROGRESS;
+                    get_state_for_connection_lost(anj);
             return _ANJ_CORE_NEXT_ACTION_CONTINUE;
         }
     }
@@ -439,6 +974,22 @@ _anj_reg_session_process_registered(anj_t *anj, anj_conn_status_t *out_status) {
             return _ANJ_CORE_NEXT_ACTION_CONTINUE;
         }
 
+#ifdef ANJ_WITH_QUEUE_MODE_WAKE_WINDOW
+        if (anj->server_state.details.registered.internal_state
+                == _ANJ_SRV_MAN_STATE_QUEUE_MODE_IN_PROGRESS) {
+            plan_wake_window(anj);
+        }
+#endif // ANJ_WITH_QUEUE_MODE_WAKE_WINDOW
+
+#ifdef ANJ_WITH_WARM_RESTART
+        if (anj->server_state.warm_restart_triggered) {
+            handle_warm_restart(anj);
+            if (_anj_core_state_transition_forced(anj)) {
+                return _ANJ_CORE_NEXT_ACTION_CONTINUE;
+            }
+        }
+#endif // ANJ_WITH_WARM_RESTART
+
         // state is not changed so there is no ongoing exchange, check if
         // registration update is needed
         int res = handle_registration_update(anj);
@@ -476,11 +1027,24 @@ _anj_reg_session_process_registered(anj_t *anj, anj_conn_status_t *out_status) {
 
         // check if we should enter queue mode, if we are not already in it
         if (anj->queue_mode_enabled
+#ifdef ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+                // socket can't be closed while CoAP downloader is using it
+                && !anj->shared_downloader
+#endif // ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+#ifdef ANJ_WITH_PIPELINED_NOTIFICATIONS
+                // notifications wait for the acknowledgement
+                && !_anj_srv_conn_pipelined_requests_ongoing(anj)
+#endif // ANJ_WITH_PIPELINED_NOTIFICATIONS
                 && anj->server_state.details.registered.internal_state
                                != _ANJ_SRV_MAN_STATE_QUEUE_MODE_IN_PROGRESS
-                && anj_time_monotonic_gt(anj_time_monotonic_now(),
+                && anj_time_monotonic_gt(_ANJ_CORE_NOW(anj),
                                          anj->server_state.details.registered
                                                  .queue_start_time)) {
+#ifdef ANJ_WITH_QUEUE_MODE_WAKE_WINDOW
+            if (wake_window_open(anj)) {
+                return _ANJ_CORE_NEXT_ACTION_LEAVE;
+            }
+#endif // ANJ_WITH_QUEUE_MODE_WAKE_WINDOW
             anj->server_state.details.registered.internal_state =
                     _ANJ_SRV_MAN_STATE_ENTERING_QUEUE_MODE_IN_PROGRESS;
             *out_status = ANJ_CONN_STATUS_ENTERING_QUEUE_MODE;
@@ -501,31 +1065,64 @@ _anj_reg_session_process_registered(anj_t *anj, anj_conn_status_t *out_status) {
                         ? _ANJ_SRV_MAN_STATE_IDLE_IN_PROGRESS
                         : _ANJ_SRV_MAN_STATE_EXCHANGE_IN_PROGRESS;
         *out_status = ANJ_CONN_STATUS_REGISTERED;
+#ifdef ANJ_WITH_OBSERVE
+        anj->server_instance.observe_state.is_server_online = true;
+#    ifdef ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER
+        // Send request is queued and handled after the ongoing exchange
+        _anj_observe_notify_store_flush(anj);
+#    endif // ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER
+#endif // ANJ_WITH_OBSERVE
         return _ANJ_CORE_NEXT_ACTION_CONTINUE;
     }
 
     case _ANJ_SRV_MAN_STATE_EXCHANGE_IN_PROGRESS: {
+#ifdef ANJ_WITH_PIPELINED_NOTIFICATIONS
+        // pipelined notification occupies the output buffer until it's sent,
+        // errors are not relevant for the main exchange
+        int res = _anj_srv_conn_handle_pipelined_requests(anj);
+        if (anj_net_is_inprogress(res)) {
+            return _ANJ_CORE_NEXT_ACTION_LEAVE;
+        }
+        res = _anj_srv_conn_handle_request(anj);
+        if (anj_net_is_again(res) || anj_net_is_inprogress(res)) {
+            handle_pipelined_observe(anj);
+            return _ANJ_CORE_NEXT_ACTION_LEAVE;
+        }
+#else  // ANJ_WITH_PIPELINED_NOTIFICATIONS
         int res = _anj_srv_conn_handle_request(anj);
         if (anj_net_is_again(res) || anj_net_is_inprogress(res)) {
             return _ANJ_CORE_NEXT_ACTION_LEAVE;
         }
+#endif // ANJ_WITH_PIPELINED_NOTIFICATIONS
         // _anj_register_operation_status() matters only for Update and
         // Deregister. For other operations it always returns
         // _ANJ_REGISTER_OPERATION_FINISHED. We can't check
         // _anj_core_state_transition_forced() here, because if an Execute
         // triggered a forced transition, we still need to go through the IDLE
         // state to properly send the Deregister request.
-        if (res
-                || _anj_register_operation_status(anj)
-                               != _ANJ_REGISTER_OPERATION_FINISHED
-                || anj->server_state.details.registered.transition_forced) {
+        if (anj->server_state.details.registered.transition_forced) {
+            anj->server_state.details.registered.internal_state =
+                    _ANJ_SRV_MAN_STATE_DISCONNECT_IN_PROGRESS;
+        } else if (res || register_operation_unanswered(anj)) {
+            anj->server_state.details.registered.internal_state =
+                    get_state_for_connection_lost(anj);
+        } else if (_anj_register_operation_status(anj)
+                   != _ANJ_REGISTER_OPERATION_FINISHED) {
+            // error response to Update, e.g. 4.04 Not Found, means that the
+            // registration is gone
             anj->server_state.details.registered.internal_state =
                     _ANJ_SRV_MAN_STATE_DISCONNECT_IN_PROGRESS;
         } else {
             anj->server_state.details.registered.internal_state =
                     _ANJ_SRV_MAN_STATE_IDLE_IN_PROGRESS;
+#ifdef ANJ_WITH_NAT_KEEPALIVE_PROBING
+            _anj_srv_conn_nat_traffic(&anj->nat, _ANJ_CORE_NOW(anj));
+#endif // ANJ_WITH_NAT_KEEPALIVE_PROBING
             // exchange finished successfully update queue mode timeout
             refresh_queue_mode_timeout(anj);
+#ifdef ANJ_WITH_NAT_REBINDING_RECOVERY
+            anj->server_state.details.registered.rebinding = false;
+#endif // ANJ_WITH_NAT_REBINDING_RECOVERY
         }
         return _ANJ_CORE_NEXT_ACTION_CONTINUE;
     }
@@ -541,18 +1138,67 @@ _anj_reg_session_process_registered(anj_t *anj, anj_conn_status_t *out_status) {
             log(L_ERROR, "Error while turning RX off: %d", res);
             return _ANJ_CORE_NEXT_ACTION_CONTINUE;
         }
+#ifdef ANJ_NET_WITH_RELEASE_ASSISTANCE
+        _anj_srv_conn_release_assistance(&anj->connection_ctx,
+                                         ANJ_NET_RELEASE_HINT_NO_MORE_DATA);
+#endif // ANJ_NET_WITH_RELEASE_ASSISTANCE
         anj->server_state.details.registered.internal_state =
                 _ANJ_SRV_MAN_STATE_QUEUE_MODE_IN_PROGRESS;
         *out_status = ANJ_CONN_STATUS_QUEUE_MODE;
+#ifdef ANJ_WITH_OBSERVE
+        anj->server_instance.observe_state.is_server_online = false;
+#endif // ANJ_WITH_OBSERVE
         log(L_DEBUG, "Queue mode started");
         return _ANJ_CORE_NEXT_ACTION_CONTINUE;
     }
 
+#ifdef ANJ_WITH_NAT_REBINDING_RECOVERY
+    case _ANJ_SRV_MAN_STATE_REBINDING_IN_PROGRESS: {
+#    ifdef ANJ_WITH_PIPELINED_NOTIFICATIONS
+        _anj_srv_conn_terminate_pipelined_requests(anj);
+#    endif // ANJ_WITH_PIPELINED_NOTIFICATIONS
+        // fresh socket, and so a new source port, over the same DTLS session
+        if (!anj->server_state.details.registered.rebinding) {
+            int res = _anj_srv_conn_close(&anj->connection_ctx, false);
+            if (anj_net_is_inprogress(res)) {
+                return _ANJ_CORE_NEXT_ACTION_LEAVE;
+            }
+            anj->server_state.details.registered.rebinding = true;
+        }
+        int res = _anj_srv_conn_connect(&anj->connection_ctx,
+                                        anj->security_instance.type,
+                                        &anj->net_socket_cfg,
+                                        anj->security_instance.server_uri,
+                                        anj->security_instance.port);
+        if (anj_net_is_inprogress(res)) {
+            return _ANJ_CORE_NEXT_ACTION_LEAVE;
+        }
+        if (!anj_net_is_ok(res)) {
+            log(L_ERROR, "Could not set up the connection again: %d", res);
+            anj->server_state.details.registered.internal_state =
+                    _ANJ_SRV_MAN_STATE_DISCONNECT_IN_PROGRESS;
+            return _ANJ_CORE_NEXT_ACTION_CONTINUE;
+        }
+#    ifdef ANJ_WITH_PMTU_PROBING
+        _anj_srv_conn_pmtu_connected(&anj->pmtu, &anj->connection_ctx,
+                                     anj->security_instance.iid);
+#    endif // ANJ_WITH_PMTU_PROBING
+        log(L_INFO, "Connection set up again, sending Update");
+        anj->server_state.registration_update_triggered = true;
+        anj->server_state.details.registered.internal_state =
+                _ANJ_SRV_MAN_STATE_IDLE_IN_PROGRESS;
+        return _ANJ_CORE_NEXT_ACTION_CONTINUE;
+    }
+#endif // ANJ_WITH_NAT_REBINDING_RECOVERY
+
     case _ANJ_SRV_MAN_STATE_DISCONNECT_IN_PROGRESS: {
         // in case of forced state transition we want to terminate the
         // exchange if any is in progress
         _anj_exchange_terminate(&anj->exchange_ctx,
                                 _ANJ_EXCHANGE_ERROR_TERMINATED);
+#ifdef ANJ_WITH_PIPELINED_NOTIFICATIONS
+        _anj_srv_conn_terminate_pipelined_requests(anj);
+#endif // ANJ_WITH_PIPELINED_NOTIFICATIONS
         // bootstrap or restart request is the only case when we want to clean
         // up the connection
         bool with_cleanup = anj->server_state.bootstrap_request_triggered
@@ -593,7 +1239,7 @@ _anj_reg_session_process_suspended(anj_t *anj, anj_conn_status_t *out_status) {
         enable_time = anj->server_state.enable_time;
     }
 
-    if (anj_time_monotonic_leq(enable_time, anj_time_monotonic_now())) {
+    if (anj_time_monotonic_leq(enable_time, _ANJ_CORE_NOW(anj))) {
         anj->server_state.enable_time = ANJ_TIME_MONOTONIC_ZERO;
         anj->server_state.enable_time_user_triggered = ANJ_TIME_MONOTONIC_ZERO;
         *out_status = ANJ_CONN_STATUS_INITIAL;
@@ -603,3 +1249,129 @@ _anj_reg_session_process_suspended(anj_t *anj, anj_conn_status_t *out_status) {
     // stay in ANJ_CONN_STATUS_SUSPENDED
     return _ANJ_CORE_NEXT_ACTION_LEAVE;
 }
+
+#ifdef ANJ_NET_WITH_POLL_HANDLE
+static void update_deadline(anj_time_monotonic_t *deadline,
+                            anj_time_monotonic_t time) {
+    if (anj_time_monotonic_is_valid(time)
+            && (!anj_time_monotonic_is_valid(*deadline)
+                || anj_time_monotonic_lt(time, *deadline))) {
+        *deadline = time;
+    }
+}
+
+#    ifdef ANJ_WITH_OBSERVE
+static bool update_notification_deadline(anj_t *anj,
+                                         anj_time_monotonic_t *deadline) {
+    anj_time_duration_t time_to_next_notification;
+    if (_anj_core_utils_time_to_next_notification(anj,
+                                                  &time_to_next_notification)) {
+        return false;
+    }
+    if (!anj_time_duration_is_valid(time_to_next_notification)) {
+        return true;
+    }
+    if (!anj_time_duration_gt(time_to_next_notification,
+                              ANJ_TIME_DURATION_ZERO)) {
+        // notification is ready to be sent
+        return false;
+    }
+    update_deadline(deadline,
+                    anj_time_monotonic_add(_ANJ_CORE_NOW(anj),
+                                           time_to_next_notification));
+    return true;
+}
+#    endif // ANJ_WITH_OBSERVE
+
+// Mirrors the checks made by _anj_reg_session_process_registered(), any
+// condition which would make it do something other than waiting for a message
+// means that anj_core_step() has to be called right away.
+bool _anj_reg_session_waits_for_msg(anj_t *anj,
+                                    anj_time_monotonic_t *out_deadline) {
+    assert(anj && out_deadline);
+    *out_deadline = ANJ_TIME_MONOTONIC_INVALID;
+    if (anj->server_state.conn_status != ANJ_CONN_STATUS_REGISTERED
+            || _anj_core_state_transition_forced(anj)
+            || anj->connection_ctx.send_in_progress) {
+        return false;
+    }
+
+    switch (anj->server_state.details.registered.internal_state) {
+    case _ANJ_SRV_MAN_STATE_IDLE_IN_PROGRESS: {
+        if (anj->server_state.details.registered.update_with_lifetime
+                || anj->server_state.details.registered.update_with_payload
+                || anj->server_state.registration_update_triggered) {
+#    ifdef ANJ_WITH_UPDATE_HOLD_DOWN
+            // the window is opened in the next step, if not opened yet
+            anj_time_monotonic_t hold_down_end =
+                    anj->server_state.details.registered.update_hold_down_end;
+            if (!anj_time_monotonic_is_valid(hold_down_end)
+                    || !anj_time_monotonic_gt(hold_down_end,
+                                              _ANJ_CORE_NOW(anj))) {
+                return false;
+            }
+            update_deadline(out_deadline, hold_down_end);
+#    else  // ANJ_WITH_UPDATE_HOLD_DOWN
+            return false;
+#    endif // ANJ_WITH_UPDATE_HOLD_DOWN
+        }
+#    ifdef ANJ_WITH_PIPELINED_NOTIFICATIONS
+        if (_anj_srv_conn_pipelined_request_deferred(anj)) {
+            return false;
+        }
+        update_deadline(out_deadline,
+                        _anj_srv_conn_pipelined_requests_timeout(anj));
+#    endif // ANJ_WITH_PIPELINED_NOTIFICATIONS
+#    ifdef ANJ_WITH_LWM2M_SEND
+        anj_time_monotonic_t send_time = _anj_lwm2m_send_ready_time(anj);
+        if (anj_time_monotonic_is_valid(send_time)
+                && !anj_time_monotonic_gt(send_time,
+                                          _ANJ_CORE_NOW(anj))) {
+            return false;
+        }
+        update_deadline(out_deadline, send_time);
+#    endif // ANJ_WITH_LWM2M_SEND
+#    ifdef ANJ_WITH_OBSERVE
+        if (!update_notification_deadline(anj, out_deadline)) {
+            return false;
+        }
+#    endif // ANJ_WITH_OBSERVE
+        update_deadline(out_deadline,
+                        anj->server_state.details.registered.next_update_time);
+        if (anj->queue_mode_enabled) {
+            update_deadline(
+                    out_deadline,
+                    anj->server_state.details.registered.queue_start_time);
+        }
+        return true;
+    }
+
+    case _ANJ_SRV_MAN_STATE_EXCHANGE_IN_PROGRESS: {
+        anj_time_monotonic_t timeout =
+                _anj_exchange_next_timeout(&anj->exchange_ctx);
+        if (!anj_time_monotonic_is_valid(timeout)) {
+            return false;
+        }
+        update_deadline(out_deadline, timeout);
+#    ifdef ANJ_WITH_PIPELINED_NOTIFICATIONS
+        update_deadline(out_deadline,
+                        _anj_srv_conn_pipelined_requests_timeout(anj));
+        if (_anj_srv_conn_pipelined_request_deferred(anj)) {
+            // deferred request waits for the main exchange to finish
+            return true;
+        }
+#        ifdef ANJ_WITH_OBSERVE
+        if (_anj_exchange_pipelining_allowed(&anj->exchange_ctx)
+                && _anj_srv_conn_free_pipelined_exchange(anj)) {
+            return update_notification_deadline(anj, out_deadline);
+        }
+#        endif // ANJ_WITH_OBSERVE
+#    endif // ANJ_WITH_PIPELINED_NOTIFICATIONS
+        return true;
+    }
+
+    default:
+        return false;
+    }
+}
+#endif // ANJ_NET_WITH_POLL_HANDLE
@@ -23,6 +23,7 @@
 #    define _ANJ_SRV_MAN_STATE_DISCONNECT_IN_PROGRESS 4
 #    define _ANJ_SRV_MAN_STATE_ENTERING_QUEUE_MODE_IN_PROGRESS 5
 #    define _ANJ_SRV_MAN_STATE_EXITING_QUEUE_MODE_IN_PROGRESS 6
+#    define _ANJ_SRV_MAN_STATE_REBINDING_IN_PROGRESS 7
 
 /**
  * Should be called after successful registration. Initializes the server
@@ -66,4 +67,22 @@ _anj_reg_session_process_suspended(anj_t *anj, anj_conn_status_t *out_status);
  */
 void _anj_reg_session_refresh_registration_related_resources(anj_t *anj);
 
+#    ifdef ANJ_NET_WITH_POLL_HANDLE
+/**
+ * Checks if the registration session only waits for an incoming message or
+ * for a timer to expire, so that the next @ref anj_core_step call can be
+ * delayed until one of these happens.
+ *
+ * @param      anj          Anjay object to operate on.
+ * @param[out] out_deadline Time at which @ref anj_core_step has to be called
+ *                          even if no message is received, or
+ *                          @ref ANJ_TIME_MONOTONIC_INVALID if there is none.
+ *
+ * @returns True if the session waits for an incoming message, false if
+ *          @ref anj_core_step should not be delayed on that basis.
+ */
+bool _anj_reg_session_waits_for_msg(anj_t *anj,
+                                    anj_time_monotonic_t *out_deadline);
+#    endif // ANJ_NET_WITH_POLL_HANDLE
+
 #endif // ANJ_SRC_CORE_SERVER_MANAGEMENT_H
@@ -22,6 +22,7 @@
 #include <anj/time.h>
 
 #include "../dm/dm_integration.h"
+#include "../dm/dm_io.h"
 #include "register.h"
 
 #define register_log(...) anj_log(register, __VA_ARGS__)
@@ -47,6 +48,10 @@ static void request_completion_callback(void *arg_ptr,
                                         const _anj_coap_msg_t *response,
                                         int result) {
     _anj_register_ctx_t *ctx = (_anj_register_ctx_t *) arg_ptr;
+#ifdef ANJ_WITH_NAT_REBINDING_RECOVERY
+    ctx->no_response = result == _ANJ_EXCHANGE_ERROR_TIMEOUT
+                       || result == _ANJ_EXCHANGE_ERROR_NETWORK;
+#endif // ANJ_WITH_NAT_REBINDING_RECOVERY
     if (result != _ANJ_EXCHANGE_RESULT_SUCCESS) {
         register_log(L_ERROR, "Operation failed with result %d", result);
         ctx->internal_state = REGISTER_INTERNAL_STATE_ERROR;
@@ -75,6 +80,12 @@ static void request_completion_callback(void *arg_ptr,
                    == REGISTER_INTERNAL_STATE_DEREGISTERING) {
             register_log(L_INFO, "De-registered successfully");
         }
+#ifdef ANJ_DM_WITH_LINK_SET_HASH
+        if (ctx->with_payload) {
+            ctx->acked_link_set_hash = ctx->sent_link_set_hash;
+            ctx->acked_link_set_hash_valid = true;
+        }
+#endif // ANJ_DM_WITH_LINK_SET_HASH
         ctx->internal_state = REGISTER_INTERNAL_STATE_FINISHED;
     }
     if (ctx->with_payload) {
@@ -99,7 +110,7 @@ static void write_location_paths(const _anj_register_ctx_t *ctx,
 
 void _anj_register_ctx_init(anj_t *anj) {
     assert(anj);
-    _anj_register_ctx_t *ctx = &anj->register_ctx;
+    _anj_register_ctx_t *ctx = &anj->state_ctx.register_ctx;
     memset(ctx, 0, sizeof(*ctx));
     ctx->internal_state = REGISTER_INTERNAL_STATE_INIT;
 }
@@ -109,7 +120,7 @@ void _anj_register_register(anj_t *anj,
                             _anj_coap_msg_t *out_msg,
                             _anj_exchange_handlers_t *out_handlers) {
     assert(anj && attr && out_msg && out_handlers);
-    _anj_register_ctx_t *ctx = &anj->register_ctx;
+    _anj_register_ctx_t *ctx = &anj->state_ctx.register_ctx;
 
     register_log(L_DEBUG, "Preparing Register request");
     memset(ctx->location_path_len, 0, sizeof(ctx->location_path_len));
@@ -121,6 +132,9 @@ void _anj_register_register(anj_t *anj,
         .arg = ctx
     };
     ctx->with_payload = true;
+#ifdef ANJ_DM_WITH_LINK_SET_HASH
+    ctx->sent_link_set_hash = _anj_dm_link_set_hash(anj);
+#endif // ANJ_DM_WITH_LINK_SET_HASH
 
     out_msg->attr.register_attr = *attr;
     out_msg->operation = ANJ_OP_REGISTER;
@@ -133,7 +147,7 @@ void _anj_register_update(anj_t *anj,
                           _anj_coap_msg_t *out_msg,
                           _anj_exchange_handlers_t *out_handlers) {
     assert(anj && out_msg && out_handlers);
-    _anj_register_ctx_t *ctx = &anj->register_ctx;
+    _anj_register_ctx_t *ctx = &anj->state_ctx.register_ctx;
 
     register_log(L_DEBUG, "Preparing Update request");
     if (lifetime) {
@@ -147,6 +161,9 @@ void _anj_register_update(anj_t *anj,
             .read_payload = register_read_payload,
             .arg = ctx
         };
+#ifdef ANJ_DM_WITH_LINK_SET_HASH
+        ctx->sent_link_set_hash = _anj_dm_link_set_hash(anj);
+#endif // ANJ_DM_WITH_LINK_SET_HASH
     } else {
         *out_handlers = (_anj_exchange_handlers_t) {
             .completion = request_completion_callback,
@@ -163,7 +180,7 @@ void _anj_register_deregister(anj_t *anj,
                               _anj_coap_msg_t *out_msg,
                               _anj_exchange_handlers_t *out_handlers) {
     assert(anj && out_msg && out_handlers);
-    _anj_register_ctx_t *ctx = &anj->register_ctx;
+    _anj_register_ctx_t *ctx = &anj->state_ctx.register_ctx;
 
     register_log(L_DEBUG, "Preparing De-register request");
     out_msg->operation = ANJ_OP_DEREGISTER;
@@ -176,9 +193,16 @@ void _anj_register_deregister(anj_t *anj,
     ctx->internal_state = REGISTER_INTERNAL_STATE_DEREGISTERING;
 }
 
+#ifdef ANJ_WITH_NAT_REBINDING_RECOVERY
+bool _anj_register_no_response(anj_t *anj) {
+    assert(anj);
+    return anj->state_ctx.register_ctx.no_response;
+}
+#endif // ANJ_WITH_NAT_REBINDING_RECOVERY
+
 int _anj_register_operation_status(anj_t *anj) {
     assert(anj);
-    _anj_register_ctx_t *ctx = &anj->register_ctx;
+    _anj_register_ctx_t *ctx = &anj->state_ctx.register_ctx;
     switch (ctx->internal_state) {
     case REGISTER_INTERNAL_STATE_INIT:
     case REGISTER_INTERNAL_STATE_ERROR:
@@ -191,3 +215,27 @@ int _anj_register_operation_status(anj_t *anj) {
         return _ANJ_REGISTER_OPERATION_FINISHED;
     }
 }
+
+#ifdef ANJ_DM_WITH_LINK_SET_HASH
+bool _anj_register_link_set_changed(anj_t *anj) {
+    assert(anj);
+    const _anj_register_ctx_t *ctx = &anj->state_ctx.register_ctx;
+    return !ctx->acked_link_set_hash_valid
+           || ctx->acked_link_set_hash != _anj_dm_link_set_hash(anj);
+}
+#endif // ANJ_DM_WITH_LINK_SET_HASH
+
+#ifdef ANJ_COAP_WITH_HEADER_COMPRESSION
+void _anj_register_get_location_path(anj_t *anj,
+                                     _anj_location_path_t *out_path) {
+    assert(anj && out_path);
+#    ifdef ANJ_WITH_BOOTSTRAP
+    // register_ctx is overlaid by bootstrap_ctx
+    if (anj->server_state.conn_status == ANJ_CONN_STATUS_BOOTSTRAPPING) {
+        out_path->location_count = 0;
+        return;
+    }
+#    endif // ANJ_WITH_BOOTSTRAP
+    write_location_paths(&anj->state_ctx.register_ctx, out_path);
+}
+#endif // ANJ_COAP_WITH_HEADER_COMPRESSION
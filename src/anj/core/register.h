@@ -124,4 +124,43 @@ void _anj_register_deregister(anj_t *anj,
  */
 int _anj_register_operation_status(anj_t *anj);
 
+#ifdef ANJ_DM_WITH_LINK_SET_HASH
+/**
+ * Checks whether the Objects and Object Instances in the data model differ
+ * from the ones sent in the last Register or Update acknowledged by the
+ * LwM2M Server.
+ *
+ * @param anj Anjay object to operate on.
+ *
+ * @returns false if the Object list in Update payload would be redundant.
+ */
+bool _anj_register_link_set_changed(anj_t *anj);
+#endif // ANJ_DM_WITH_LINK_SET_HASH
+
+#ifdef ANJ_COAP_WITH_HEADER_COMPRESSION
+/**
+ * Fills @p out_path with the Location-Path received in response to the last
+ * successful Register; it is empty if the client is not registered, also
+ * during Bootstrap, when the registration context is not in use.
+ *
+ * @param      anj      Anjay object to operate on.
+ * @param[out] out_path Location-Path of the current registration.
+ */
+void _anj_register_get_location_path(anj_t *anj,
+                                     _anj_location_path_t *out_path);
+#endif // ANJ_COAP_WITH_HEADER_COMPRESSION
+
+#ifdef ANJ_WITH_NAT_REBINDING_RECOVERY
+/**
+ * Checks if the last operation failed because no response was received, i.e.
+ * because of a timeout or a network error, as opposed to an error response of
+ * the LwM2M Server.
+ *
+ * @param anj Anjay object to operate on.
+ *
+ * @returns true if the last operation failed without a response.
+ */
+bool _anj_register_no_response(anj_t *anj);
+#endif // ANJ_WITH_NAT_REBINDING_RECOVERY
+
 #endif // ANJ_REGISTER_H
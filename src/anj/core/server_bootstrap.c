@@ -29,6 +29,8 @@
 #include "../dm/dm_integration.h"
 #include "../exchange.h"
 #include "../exchange_cache.h"
+#include "../metrics.h"
+#include "../trace.h"
 #include "bootstrap.h"
 #include "core.h"
 #include "core_utils.h"
@@ -38,6 +40,10 @@
 #ifdef ANJ_WITH_BOOTSTRAP
 
 static int bootstrap_op_read_data_model(anj_t *anj) {
+#    ifdef ANJ_WITH_SERVER_DATA_CACHE
+    // security_instance of the LwM2M Server is overwritten below
+    anj->server_instance.dm_data_cached = false;
+#    endif // ANJ_WITH_SERVER_DATA_CACHE
     if (_anj_dm_get_security_obj_instance_iid(anj, _ANJ_SSID_BOOTSTRAP,
                                               &anj->security_instance.iid)) {
         log(L_ERROR, "No Bootstrap Account");
@@ -95,12 +101,15 @@ int _anj_server_bootstrap_start_bootstrap_operation(anj_t *anj) {
     }
     // if last bootstrap session was aborted, we need to reset the state
     _anj_bootstrap_reset(anj);
-    if (anj_time_duration_gt(anj->security_instance.client_hold_off_time,
-                             ANJ_TIME_DURATION_ZERO)) {
+    anj_time_duration_t hold_off = anj->security_instance.client_hold_off_time;
+#ifdef ANJ_WITH_SCHEDULING_JITTER
+    hold_off = anj_time_duration_add(
+            hold_off, _anj_core_utils_jitter(anj, _ANJ_CORE_JITTER_BOOTSTRAP,
+                                             0, anj->register_spread));
+#endif // ANJ_WITH_SCHEDULING_JITTER
+    if (anj_time_duration_gt(hold_off, ANJ_TIME_DURATION_ZERO)) {
         anj->server_state.details.bootstrap.bootstrap_timeout =
-                anj_time_monotonic_add(
-                        anj_time_monotonic_now(),
-                        anj->security_instance.client_hold_off_time);
+                anj_time_monotonic_add(_ANJ_CORE_NOW(anj), hold_off);
         anj->server_state.details.bootstrap.bootstrap_state =
                 _ANJ_SRV_BOOTSTRAP_STATE_WAITING;
         return 0;
@@ -112,8 +121,11 @@ int _anj_server_bootstrap_start_bootstrap_operation(anj_t *anj) {
 }
 
 static int handle_incoming_message(anj_t *anj, size_t msg_size) {
-    _anj_coap_msg_t msg;
-    int res = _anj_coap_decode_udp(anj->in_buffer, msg_size, &msg);
+    _ANJ_METRICS_ADD(&anj->metrics, bytes_received, msg_size);
+    _ANJ_CORE_USAGE_UPDATE(anj, in_buffer_max, msg_size);
+    _ANJ_TRACE(&anj->trace, NET_RECV, INSTANT, msg_size);
+    _ANJ_CORE_SCRATCH_MSG(anj, msg, in_msg);
+    int res = _ANJ_CORE_DECODE_IN_MSG(anj, msg_size, msg);
     if (res) {
         ANJ_CORE_LOG_COAP_ERROR(res);
         // ignore invalid messages
@@ -126,19 +138,20 @@ static int handle_incoming_message(anj_t *anj, size_t msg_size) {
 #    ifdef ANJ_WITH_CACHE
     // check if it's a retransmission
     if (_anj_exchange_cache_check(&anj->exchange_cache,
-                                  msg.coap_binding_data.message_id)
+                                  msg->coap_binding_data.message_id)
             != _ANJ_EXCHANGE_CACHE_MISS) {
+        _ANJ_METRICS_INC(&anj->metrics, cache_hits);
         return 0;
     }
 #    endif // ANJ_WITH_CACHE
 
     // find the right module to handle the message
-    switch (msg.operation) {
+    switch (msg->operation) {
     case ANJ_OP_DM_READ:
     case ANJ_OP_DM_DISCOVER:
     case ANJ_OP_DM_WRITE_REPLACE:
     case ANJ_OP_DM_DELETE:
-        _anj_dm_process_request(anj, &msg, _ANJ_SSID_BOOTSTRAP, &response_code,
+        _anj_dm_process_request(anj, msg, _ANJ_SSID_BOOTSTRAP, &response_code,
                                 &exchange_handlers);
         if (!_ANJ_COAP_CODE_IS_ERROR(response_code)) {
             _anj_bootstrap_timeout_reset(anj);
@@ -161,12 +174,12 @@ static int handle_incoming_message(anj_t *anj, size_t msg_size) {
     case ANJ_OP_INF_CANCEL_OBSERVE_COMP:
     default: {
         log(L_WARNING, "Invalid operation %d during Bootstrap",
-            (int) msg.operation);
+            (int) msg->operation);
         return 0;
     }
     }
 
-    if (_anj_srv_conn_prepare_server_request(anj, &msg, response_code,
+    if (_anj_srv_conn_prepare_server_request(anj, msg, response_code,
                                              &exchange_handlers)) {
         return -1;
     }
@@ -175,9 +188,9 @@ static int handle_incoming_message(anj_t *anj, size_t msg_size) {
 
 static _anj_core_next_action_t handle_bootstrap_process(anj_t *anj) {
     _anj_exchange_handlers_t exchange_handlers = { 0 };
-    _anj_coap_msg_t msg;
-    memset(&msg, 0, sizeof(msg));
-    int result = _anj_bootstrap_process(anj, &msg, &exchange_handlers);
+    _ANJ_CORE_SCRATCH_MSG(anj, msg, out_msg);
+    memset(msg, 0, sizeof(*msg));
+    int result = _anj_bootstrap_process(anj, msg, &exchange_handlers);
     switch (result) {
     case _ANJ_BOOTSTRAP_IN_PROGRESS: {
         // check for new requests
@@ -206,7 +219,7 @@ static _anj_core_next_action_t handle_bootstrap_process(anj_t *anj) {
         return _ANJ_CORE_NEXT_ACTION_LEAVE;
     }
     case _ANJ_BOOTSTRAP_NEW_REQUEST_TO_SEND:
-        if (_anj_srv_conn_prepare_client_request(anj, &msg,
+        if (_anj_srv_conn_prepare_client_request(anj, msg,
                                                  &exchange_handlers)) {
             anj->server_state.details.bootstrap.bootstrap_state =
                     _ANJ_SRV_BOOTSTRAP_STATE_FINISH_DISCONNECT_AND_RETRY;
@@ -232,8 +245,16 @@ static void calculate_communication_retry_timeout(anj_t *anj) {
             anj->bootstrap_retry_timeout,
             1 << (anj->server_state.details.bootstrap.bootstrap_retry_attempt
                   - 1));
+#ifdef ANJ_WITH_SCHEDULING_JITTER
+    delay = anj_time_duration_add(
+            delay,
+            _anj_core_utils_jitter_percent(
+                    anj, _ANJ_CORE_JITTER_BOOTSTRAP_RETRY,
+                    anj->server_state.details.bootstrap.bootstrap_retry_attempt,
+                    delay, anj->retry_spread_percent));
+#endif // ANJ_WITH_SCHEDULING_JITTER
     anj->server_state.details.bootstrap.bootstrap_timeout =
-            anj_time_monotonic_add(anj_time_monotonic_now(), delay);
+            anj_time_monotonic_add(_ANJ_CORE_NOW(anj), delay);
 
     log(L_INFO,
         "Bootstrap retry no. %" PRIu16 " will start with %s"
@@ -260,14 +281,30 @@ _anj_core_next_action_t _anj_server_bootstrap_process_bootstrap_operation(
             log(L_ERROR, "Setting connection for Bootstrap failed");
             return _ANJ_CORE_NEXT_ACTION_CONTINUE;
         }
+        if (anj->security_instance.type == ANJ_NET_BINDING_DTLS) {
+            _ANJ_METRICS_INC(&anj->metrics, dtls_handshakes);
+        }
+#ifdef ANJ_WITH_ADAPTIVE_BLOCK_SIZE
+        _anj_exchange_reset_block_size_limit(&anj->exchange_ctx);
+#endif // ANJ_WITH_ADAPTIVE_BLOCK_SIZE
+#ifdef ANJ_WITH_PMTU_PROBING
+        _anj_srv_conn_pmtu_connected(&anj->pmtu, &anj->connection_ctx,
+                                     anj->security_instance.iid);
+#endif // ANJ_WITH_PMTU_PROBING
+#ifdef ANJ_WITH_ADAPTIVE_RTO
+        _anj_exchange_reset_rto(&anj->exchange_ctx);
+#endif // ANJ_WITH_ADAPTIVE_RTO
+#ifdef ANJ_WITH_COUNTER_TOKENS
+        _anj_exchange_reseed_tokens(&anj->exchange_ctx);
+#endif // ANJ_WITH_COUNTER_TOKENS
         anj->server_state.details.bootstrap.bootstrap_state =
                 _ANJ_SRV_BOOTSTRAP_STATE_BOOTSTRAP_IN_PROGRESS;
         _anj_exchange_handlers_t exchange_handlers = { 0 };
-        _anj_coap_msg_t msg;
-        memset(&msg, 0, sizeof(msg));
-        if (_anj_bootstrap_process(anj, &msg, &exchange_handlers)
+        _ANJ_CORE_SCRATCH_MSG(anj, msg, out_msg);
+        memset(msg, 0, sizeof(*msg));
+        if (_anj_bootstrap_process(anj, msg, &exchange_handlers)
                         != _ANJ_BOOTSTRAP_NEW_REQUEST_TO_SEND
-                || _anj_srv_conn_prepare_client_request(anj, &msg,
+                || _anj_srv_conn_prepare_client_request(anj, msg,
                                                         &exchange_handlers)) {
             anj->server_state.details.bootstrap.bootstrap_state =
                     _ANJ_SRV_BOOTSTRAP_STATE_FINISH_DISCONNECT_AND_RETRY;
@@ -303,9 +340,9 @@ _anj_core_next_action_t _anj_server_bootstrap_process_bootstrap_operation(
     case _ANJ_SRV_BOOTSTRAP_STATE_FINISH_DISCONNECT_AND_RETRY: {
         _anj_bootstrap_connection_lost(anj);
         _anj_exchange_handlers_t exchange_handlers = { 0 };
-        _anj_coap_msg_t msg;
-        memset(&msg, 0, sizeof(msg));
-        int result = _anj_bootstrap_process(anj, &msg, &exchange_handlers);
+        _ANJ_CORE_SCRATCH_MSG(anj, msg, out_msg);
+        memset(msg, 0, sizeof(*msg));
+        int result = _anj_bootstrap_process(anj, msg, &exchange_handlers);
         assert(result == _ANJ_BOOTSTRAP_ERR_NETWORK);
         (void) result;
         anj->server_state.details.bootstrap.bootstrap_state =
@@ -345,7 +382,7 @@ _anj_core_next_action_t _anj_server_bootstrap_process_bootstrap_operation(
     case _ANJ_SRV_BOOTSTRAP_STATE_WAITING: {
         if (anj_time_monotonic_leq(
                     anj->server_state.details.bootstrap.bootstrap_timeout,
-                    anj_time_monotonic_now())) {
+                    _ANJ_CORE_NOW(anj))) {
             anj->server_state.details.bootstrap.bootstrap_state =
                     _ANJ_SRV_BOOTSTRAP_STATE_CONNECTION_IN_PROGRESS;
             return _ANJ_CORE_NEXT_ACTION_CONTINUE;
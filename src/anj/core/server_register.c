@@ -33,9 +33,12 @@
 #endif // ANJ_WITH_LWM2M_SEND
 
 #include "../dm/dm_integration.h"
+#include "../exchange.h"
+#include "../metrics.h"
 #include "core_utils.h"
 #include "register.h"
 #include "server_register.h"
+#include "session_persistence.h"
 #include "srv_conn.h"
 
 /**
@@ -43,7 +46,12 @@
  * object definition and there is no point in repeating it for constrained
  * devices.
  */
-static int register_op_read_data_model(anj_t *anj) {
+int _anj_server_register_read_data_model(anj_t *anj) {
+#ifdef ANJ_WITH_SERVER_DATA_CACHE
+    if (anj->server_instance.dm_data_cached) {
+        return 0;
+    }
+#endif // ANJ_WITH_SERVER_DATA_CACHE
     if (_anj_dm_get_server_obj_instance_data(anj, &anj->server_instance.ssid,
                                              &anj->server_instance.iid)
             || anj->server_instance.ssid == ANJ_ID_INVALID
@@ -116,6 +124,9 @@ static int register_op_read_data_model(anj_t *anj) {
         return -1;
     }
 
+#ifdef ANJ_WITH_SERVER_DATA_CACHE
+    anj->server_instance.dm_data_cached = true;
+#endif // ANJ_WITH_SERVER_DATA_CACHE
     return 0;
 }
 
@@ -135,14 +146,14 @@ static int register_op_post_connect_operations(anj_t *anj) {
         // Binding and Modes” resource in the Device Object (/3/0/16)"
         .binding = ANJ_SUPPORTED_BINDING_MODES
     };
-    _anj_coap_msg_t msg;
-    memset(&msg, 0, sizeof(msg));
-    _anj_register_register(anj, &register_attr, &msg, &exchange_handlers);
-    return _anj_srv_conn_prepare_client_request(anj, &msg, &exchange_handlers);
+    _ANJ_CORE_SCRATCH_MSG(anj, msg, out_msg);
+    memset(msg, 0, sizeof(*msg));
+    _anj_register_register(anj, &register_attr, msg, &exchange_handlers);
+    return _anj_srv_conn_prepare_client_request(anj, msg, &exchange_handlers);
 }
 
 int _anj_server_register_start_register_operation(anj_t *anj) {
-    if (register_op_read_data_model(anj)) {
+    if (_anj_server_register_read_data_model(anj)) {
         log(L_ERROR, "Could not get data for registration");
         return -1;
     }
@@ -154,17 +165,44 @@ int _anj_server_register_start_register_operation(anj_t *anj) {
             ANJ_TIME_MONOTONIC_ZERO;
     anj->server_state.details.registration.retry_seq_count = 0;
 
+#ifdef ANJ_WITH_SESSION_PERSISTENCE
+    // restored observations are kept until it's known whether the session can
+    // be resumed
+    if (_anj_core_session_resume_pending(anj)) {
+        return 0;
+    }
+#endif // ANJ_WITH_SESSION_PERSISTENCE
 #ifdef ANJ_WITH_LWM2M_SEND
     anj_send_abort(anj, ANJ_SEND_ID_ALL);
 #endif // ANJ_WITH_LWM2M_SEND
 #ifdef ANJ_WITH_OBSERVE
     _anj_observe_remove_all_observations(anj, ANJ_OBSERVE_ANY_SERVER);
 #endif // ANJ_WITH_OBSERVE
+#ifdef ANJ_WITH_SCHEDULING_JITTER
+    if (anj_time_duration_gt(anj->register_spread, ANJ_TIME_DURATION_ZERO)) {
+        // spread Registers of devices started at the same time; wait in the
+        // same way as between retries
+        anj_time_duration_t delay = _anj_core_utils_jitter(
+                anj, _ANJ_CORE_JITTER_REGISTER, 0, anj->register_spread);
+        anj->server_state.details.registration.retry_timeout =
+                anj_time_monotonic_add(_ANJ_CORE_NOW(anj), delay);
+        anj->server_state.details.registration.registration_state =
+                _ANJ_SRV_REG_STATE_RESTART_IN_PROGRESS;
+        log(L_INFO,
+            "Register will be sent with %s"
+            "s delay",
+            ANJ_TIME_DURATION_AS_STRING(delay, ANJ_TIME_UNIT_S));
+    }
+#endif // ANJ_WITH_SCHEDULING_JITTER
 
     return 0;
 }
 
 static void calculate_communication_retry_timeout(anj_t *anj) {
+#ifdef ANJ_WITH_SESSION_PERSISTENCE
+    // server may have lost the session as well, so start from scratch
+    _anj_core_session_resume_drop(anj);
+#endif // ANJ_WITH_SESSION_PERSISTENCE
     anj->server_state.details.registration.retry_count++;
     if (anj->server_state.details.registration.retry_count
             < anj->server_instance.retry_res.retry_count) {
@@ -181,9 +219,17 @@ static void calculate_communication_retry_timeout(anj_t *anj) {
         delay = anj_time_duration_mul(
                 delay,
                 1 << (anj->server_state.details.registration.retry_count - 1));
+#ifdef ANJ_WITH_SCHEDULING_JITTER
+        delay = anj_time_duration_add(
+                delay,
+                _anj_core_utils_jitter_percent(
+                        anj, _ANJ_CORE_JITTER_REGISTER_RETRY,
+                        anj->server_state.details.registration.retry_count,
+                        delay, anj->retry_spread_percent));
+#endif // ANJ_WITH_SCHEDULING_JITTER
 
         anj->server_state.details.registration.retry_timeout =
-                anj_time_monotonic_add(anj_time_monotonic_now(), delay);
+                anj_time_monotonic_add(_ANJ_CORE_NOW(anj), delay);
         log(L_INFO,
             "Registration retry no. %" PRIu16 " will start with %s"
             "s delay",
@@ -204,23 +250,29 @@ static void calculate_communication_retry_timeout(anj_t *anj) {
         return;
     }
 
+    anj_time_duration_t seq_delay = anj_time_duration_new(
+            anj->server_instance.retry_res.seq_delay_timer, ANJ_TIME_UNIT_S);
+#ifdef ANJ_WITH_SCHEDULING_JITTER
+    seq_delay = anj_time_duration_add(
+            seq_delay,
+            _anj_core_utils_jitter_percent(
+                    anj, _ANJ_CORE_JITTER_REGISTER_SEQ_RETRY,
+                    anj->server_state.details.registration.retry_seq_count,
+                    seq_delay, anj->retry_spread_percent));
+#endif // ANJ_WITH_SCHEDULING_JITTER
     anj->server_state.details.registration.retry_timeout =
-            anj_time_monotonic_add(
-                    anj_time_monotonic_now(),
-                    anj_time_duration_new(
-                            anj->server_instance.retry_res.seq_delay_timer,
-                            ANJ_TIME_UNIT_S));
+            anj_time_monotonic_add(_ANJ_CORE_NOW(anj), seq_delay);
     anj->server_state.details.registration.retry_count = 0;
     log(L_INFO,
-        "Registration retry sequence no. %" PRIu16 " will start with %" PRIu32
+        "Registration retry sequence no. %" PRIu16 " will start with %s"
         "s delay",
         anj->server_state.details.registration.retry_seq_count,
-        anj->server_instance.retry_res.seq_delay_timer);
+        ANJ_TIME_DURATION_AS_STRING(seq_delay, ANJ_TIME_UNIT_S));
     // disconnect with network context cleanup and reconnect
     anj->server_state.details.registration.registration_state =
             _ANJ_SRV_REG_STATE_CLEANUP_IN_PROGRESS;
     // refresh data model - if operation failed, use old values
-    register_op_read_data_model(anj);
+    _anj_server_register_read_data_model(anj);
 }
 
 _anj_core_next_action_t
@@ -237,6 +289,29 @@ _anj_server_register_process_register_operation(anj_t *anj,
             return _ANJ_CORE_NEXT_ACTION_LEAVE;
         }
         if (anj_net_is_ok(result)) {
+            if (anj->security_instance.type == ANJ_NET_BINDING_DTLS) {
+                _ANJ_METRICS_INC(&anj->metrics, dtls_handshakes);
+            }
+#ifdef ANJ_WITH_ADAPTIVE_BLOCK_SIZE
+            _anj_exchange_reset_block_size_limit(&anj->exchange_ctx);
+#endif // ANJ_WITH_ADAPTIVE_BLOCK_SIZE
+#ifdef ANJ_WITH_PMTU_PROBING
+            _anj_srv_conn_pmtu_connected(&anj->pmtu, &anj->connection_ctx,
+                                         anj->security_instance.iid);
+#endif // ANJ_WITH_PMTU_PROBING
+#ifdef ANJ_WITH_ADAPTIVE_RTO
+            _anj_exchange_reset_rto(&anj->exchange_ctx);
+#endif // ANJ_WITH_ADAPTIVE_RTO
+#ifdef ANJ_WITH_COUNTER_TOKENS
+            _anj_exchange_reseed_tokens(&anj->exchange_ctx);
+#endif // ANJ_WITH_COUNTER_TOKENS
+#ifdef ANJ_WITH_SESSION_PERSISTENCE
+            if (_anj_core_session_resume_pending(anj)) {
+                log(L_INFO, "Resuming restored session, Register skipped");
+                *out_status = ANJ_CONN_STATUS_REGISTERED;
+                return _ANJ_CORE_NEXT_ACTION_CONTINUE;
+            }
+#endif // ANJ_WITH_SESSION_PERSISTENCE
             anj->server_state.details.registration.registration_state =
                     _ANJ_SRV_REG_STATE_REGISTER_IN_PROGRESS;
             result = register_op_post_connect_operations(anj);
@@ -299,7 +374,7 @@ _anj_server_register_process_register_operation(anj_t *anj,
     case _ANJ_SRV_REG_STATE_RESTART_IN_PROGRESS: {
         if (anj_time_monotonic_lt(
                     anj->server_state.details.registration.retry_timeout,
-                    anj_time_monotonic_now())) {
+                    _ANJ_CORE_NOW(anj))) {
             anj->server_state.details.registration.registration_state =
                     _ANJ_SRV_REG_STATE_CONNECTION_IN_PROGRESS;
             return _ANJ_CORE_NEXT_ACTION_CONTINUE;
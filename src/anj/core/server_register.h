@@ -29,6 +29,16 @@
 #    define _ANJ_SRV_REG_STATE_RESTART_IN_PROGRESS 7
 #    define _ANJ_SRV_REG_STATE_REGISTRATION_FAILURE_IN_PROGRESS 8
 
+/**
+ * Reads the Server and Security Object instances used for registration and
+ * prepares the network configuration for the connection to the LwM2M Server.
+ *
+ * @param anj  Anjay object to operate on.
+ *
+ * @returns 0 on success, negative value in case of error.
+ */
+int _anj_server_register_read_data_model(anj_t *anj);
+
 /**
  * Starts the process of registering the client to the LwM2M server. All errors
  * returned by this function are result of invalid configuration or internal
@@ -0,0 +1,283 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#define ANJ_LOG_SOURCE_FILE_ID 67
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/compat/net/anj_net_wrapper.h>
+#include <anj/compat/time.h>
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/log.h>
+#include <anj/persistence.h>
+#include <anj/time.h>
+
+#ifdef ANJ_WITH_OBSERVE
+#    include "../observe/observe.h"
+#endif // ANJ_WITH_OBSERVE
+
+#include "../dm/dm_integration.h"
+#include "../exchange.h"
+#include "../utils.h"
+#include "core.h"
+#include "core_utils.h"
+#include "server_register.h"
+#include "session_persistence.h"
+#include "srv_conn.h"
+
+#ifdef ANJ_WITH_SESSION_PERSISTENCE
+
+static const uint8_t g_persistence_magic[] = { 'S', 'E', 'S' };
+#    define PERSISTENCE_VERSION 1
+
+// Endpoint name is stored only to detect that the session belongs to
+// a different client, so in RESTORE mode it is compared chunk by chunk instead
+// of being copied.
+static int endpoint_persistence(anj_t *anj,
+                                const anj_persistence_context_t *ctx) {
+    const char *endpoint = anj->endpoint_name ? anj->endpoint_name : "";
+    uint32_t len = (uint32_t) strlen(endpoint);
+    uint32_t stored_len = len;
+    if (anj_persistence_u32(ctx, &stored_len)) {
+        return -1;
+    }
+    if (anj_persistence_direction(ctx) == ANJ_PERSISTENCE_STORE) {
+        return _anj_persistence_store_bytes(ctx, endpoint, len);
+    }
+    if (stored_len != len) {
+        return -1;
+    }
+    char chunk[32];
+    for (uint32_t offset = 0; offset < len; offset += sizeof(chunk)) {
+        size_t chunk_len = len - offset < sizeof(chunk) ? len - offset
+                                                        : sizeof(chunk);
+        if (anj_persistence_bytes(ctx, chunk, chunk_len)
+                || memcmp(chunk, endpoint + offset, chunk_len)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int location_path_persistence(anj_t *anj,
+                                     const anj_persistence_context_t *ctx) {
+    _anj_register_ctx_t *register_ctx = &anj->state_ctx.register_ctx;
+    for (size_t i = 0; i < ANJ_COAP_MAX_LOCATION_PATHS_NUMBER; i++) {
+        uint16_t len = (uint16_t) register_ctx->location_path_len[i];
+        if (anj_persistence_u16(ctx, &len)
+                || len > ANJ_COAP_MAX_LOCATION_PATH_SIZE
+                || anj_persistence_bytes(ctx, register_ctx->location_path[i],
+                                         len)) {
+            return -1;
+        }
+        register_ctx->location_path_len[i] = len;
+    }
+    return 0;
+}
+
+static int duration_persistence(const anj_persistence_context_t *ctx,
+                                anj_time_duration_t *inout_duration) {
+    int64_t us = anj_time_duration_to_scalar(*inout_duration, ANJ_TIME_UNIT_US);
+    if (anj_persistence_i64(ctx, &us)) {
+        return -1;
+    }
+    *inout_duration = anj_time_duration_new(us, ANJ_TIME_UNIT_US);
+    return 0;
+}
+
+// Monotonic clock restarts together with the device, so all points in time are
+// stored relative to the moment of the store operation, and that moment is
+// stored as real time.
+static int base_time_persistence(const anj_persistence_context_t *ctx,
+                                 anj_time_monotonic_t *out_base) {
+    anj_time_real_t real_now = anj_time_real_now();
+    int64_t stored_real_us =
+            anj_time_real_to_scalar(real_now, ANJ_TIME_UNIT_US);
+    if (anj_persistence_i64(ctx, &stored_real_us)) {
+        return -1;
+    }
+    anj_time_duration_t elapsed = anj_time_real_diff(
+            real_now, anj_time_real_new(stored_real_us, ANJ_TIME_UNIT_US));
+    if (anj_time_duration_lt(elapsed, ANJ_TIME_DURATION_ZERO)) {
+        // real time clock went backwards, assume no time has passed
+        elapsed = ANJ_TIME_DURATION_ZERO;
+    }
+    *out_base = anj_time_monotonic_sub(anj_time_monotonic_now(), elapsed);
+    return 0;
+}
+
+#    ifdef ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
+// On restore, the socket context is created right away, so that the DTLS state
+// can be handed over to it before the first connect.
+static int net_session_persistence(anj_t *anj,
+                                   const anj_persistence_context_t *ctx) {
+    bool with_net_session =
+            anj->connection_ctx.net_ctx
+            && anj->connection_ctx.type == ANJ_NET_BINDING_DTLS;
+    if (anj_persistence_bool(ctx, &with_net_session)) {
+        return -1;
+    }
+    if (!with_net_session) {
+        return 0;
+    }
+    if (anj_persistence_direction(ctx) == ANJ_PERSISTENCE_STORE) {
+        return anj_net_session_store(anj->connection_ctx.type,
+                                     anj->connection_ctx.net_ctx, ctx)
+                       ? -1
+                       : 0;
+    }
+    if (_anj_server_register_read_data_model(anj)
+            || anj->security_instance.type != ANJ_NET_BINDING_DTLS
+            || _anj_srv_conn_create(&anj->connection_ctx,
+                                    anj->security_instance.type,
+                                    &anj->net_socket_cfg)
+            || anj_net_session_restore(anj->connection_ctx.type,
+                                       anj->connection_ctx.net_ctx, ctx)) {
+        return -1;
+    }
+    return 0;
+}
+#    endif // ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
+
+static int session_persistence(anj_t *anj,
+                               const anj_persistence_context_t *ctx,
+                               anj_time_monotonic_t *inout_next_update_time,
+                               anj_time_duration_t *inout_lifetime,
+                               bool *inout_update_with_payload) {
+    anj_time_monotonic_t base;
+    uint16_t ssid = anj->server_instance.ssid;
+    if (anj_persistence_version(ctx, g_persistence_magic,
+                                sizeof(g_persistence_magic),
+                                PERSISTENCE_VERSION, NULL)
+            || base_time_persistence(ctx, &base)
+            || endpoint_persistence(anj, ctx)
+            || anj_persistence_u16(ctx, &ssid)
+            || ssid != anj->server_instance.ssid
+            || duration_persistence(ctx, inout_lifetime)
+            || location_path_persistence(anj, ctx)
+            || _anj_persistence_monotonic_time(ctx, base,
+                                               inout_next_update_time)
+            || anj_persistence_bool(ctx, inout_update_with_payload)
+#    ifdef ANJ_WITH_LWM2M_SEND
+            || anj_persistence_u16(ctx, &anj->send_ctx.send_id_counter)
+#    endif // ANJ_WITH_LWM2M_SEND
+#    ifdef ANJ_WITH_OBSERVE
+            || _anj_observe_persistence(anj, ctx, base)
+#    endif // ANJ_WITH_OBSERVE
+#    ifdef ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
+            || net_session_persistence(anj, ctx)
+#    endif // ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
+    ) {
+        return -1;
+    }
+    return 0;
+}
+
+static void clear_restored_state(anj_t *anj) {
+    anj->session_resume.pending = false;
+    memset(&anj->state_ctx.register_ctx.location_path_len, 0,
+           sizeof(anj->state_ctx.register_ctx.location_path_len));
+#    ifdef ANJ_WITH_OBSERVE
+    _anj_observe_remove_all_observations(anj, ANJ_OBSERVE_ANY_SERVER);
+#    endif // ANJ_WITH_OBSERVE
+#    ifdef ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
+    // socket context may hold the restored DTLS state, and may not even match
+    // the server the client is going to connect to
+    _anj_srv_conn_close(&anj->connection_ctx, true);
+#    endif // ANJ_NET_WITH_DTLS_SESSION_PERSISTENCE
+}
+
+int anj_core_session_store(anj_t *anj, const anj_persistence_context_t *ctx) {
+    assert(anj && ctx);
+    assert(anj_persistence_direction(ctx) == ANJ_PERSISTENCE_STORE);
+
+    if (!_anj_core_client_registered(anj)
+            || _anj_exchange_ongoing_exchange(&anj->exchange_ctx)) {
+        log(L_ERROR, "Invalid state for the operation");
+        return -1;
+    }
+    anj_time_monotonic_t next_update_time =
+            anj->server_state.details.registered.next_update_time;
+    anj_time_duration_t lifetime = anj->server_instance.lifetime;
+    bool update_with_payload =
+            anj->server_state.details.registered.update_with_payload;
+    if (session_persistence(anj, ctx, &next_update_time, &lifetime,
+                            &update_with_payload)) {
+        log(L_ERROR, "Failed to store session state");
+        return -1;
+    }
+    log(L_INFO, "Session state stored successfully");
+    return 0;
+}
+
+int anj_core_session_restore(anj_t *anj,
+                             const anj_persistence_context_t *ctx) {
+    assert(anj && ctx);
+    assert(anj_persistence_direction(ctx) == ANJ_PERSISTENCE_RESTORE);
+
+    if (anj->server_state.conn_status != ANJ_CONN_STATUS_INITIAL) {
+        log(L_ERROR, "Invalid state for the operation");
+        return -1;
+    }
+    // SSID is compared with the one in the data model
+    if (_anj_dm_get_server_obj_instance_data(anj, &anj->server_instance.ssid,
+                                             &anj->server_instance.iid)
+            || anj->server_instance.ssid == ANJ_ID_INVALID
+            || session_persistence(anj, ctx,
+                                   &anj->session_resume.next_update_time,
+                                   &anj->session_resume.lifetime,
+                                   &anj->session_resume.update_with_payload)) {
+        log(L_ERROR, "Failed to restore session state");
+        clear_restored_state(anj);
+        return -1;
+    }
+    anj->session_resume.pending = true;
+    log(L_INFO, "Session state restored successfully");
+    return 0;
+}
+
+bool _anj_core_session_resume_pending(anj_t *anj) {
+    return anj->session_resume.pending;
+}
+
+void _anj_core_session_resume_drop(anj_t *anj) {
+    if (!anj->session_resume.pending) {
+        return;
+    }
+    log(L_INFO, "Restored session dropped");
+    clear_restored_state(anj);
+}
+
+void _anj_core_session_resume_finish(anj_t *anj) {
+    if (!anj->session_resume.pending) {
+        return;
+    }
+    anj->session_resume.pending = false;
+    // if the stored time has already passed, Update is sent right away
+    if (anj_time_monotonic_is_valid(anj->session_resume.next_update_time)) {
+        anj->server_state.details.registered.next_update_time =
+                anj->session_resume.next_update_time;
+    }
+    if (!anj_time_duration_eq(anj->session_resume.lifetime,
+                              anj->server_instance.lifetime)) {
+        anj->server_state.details.registered.update_with_lifetime = true;
+    }
+    anj->server_state.details.registered.update_with_payload =
+            anj->session_resume.update_with_payload;
+    log(L_INFO, "Registration session resumed");
+}
+
+#endif // ANJ_WITH_SESSION_PERSISTENCE
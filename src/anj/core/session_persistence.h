@@ -0,0 +1,43 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#ifndef ANJ_SRC_CORE_SESSION_PERSISTENCE_H
+#    define ANJ_SRC_CORE_SESSION_PERSISTENCE_H
+
+#    include <stdbool.h>
+
+#    include <anj/core.h>
+
+#    ifdef ANJ_WITH_SESSION_PERSISTENCE
+
+/**
+ * Checks whether the session restored with @ref anj_core_session_restore is
+ * waiting to be resumed.
+ */
+bool _anj_core_session_resume_pending(anj_t *anj);
+
+/**
+ * Drops the restored session, if any, together with restored observations.
+ * Must be called when the client can't resume the session and has to perform a
+ * regular registration.
+ */
+void _anj_core_session_resume_drop(anj_t *anj);
+
+/**
+ * Applies the restored state of the registration session. Must be called after
+ * the state of ANJ_CONN_STATUS_REGISTERED is initialized, does nothing if no
+ * session is waiting to be resumed.
+ */
+void _anj_core_session_resume_finish(anj_t *anj);
+
+#    endif // ANJ_WITH_SESSION_PERSISTENCE
+
+#endif // ANJ_SRC_CORE_SESSION_PERSISTENCE_H
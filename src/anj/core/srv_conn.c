@@ -12,6 +12,7 @@
 #define ANJ_LOG_SOURCE_FILE_ID 13
 
 #include <assert.h>
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
@@ -24,10 +25,19 @@
 #include <anj/time.h>
 #include <anj/utils.h>
 
+#if defined(ANJ_WITH_NAT_KEEPALIVE_PROBING) && defined(ANJ_WITH_PERSISTENCE)
+#    include <anj/persistence.h>
+#endif // defined(ANJ_WITH_NAT_KEEPALIVE_PROBING) &&
+       // defined(ANJ_WITH_PERSISTENCE)
+
 #include "../coap/coap.h"
+#include "../coap_downloader_shared.h"
 #include "../exchange.h"
 #include "../exchange_cache.h"
+#include "../metrics.h"
+#include "../trace.h"
 #include "core_utils.h"
+#include "register.h"
 #include "srv_conn.h"
 
 #define _ANJ_SRV_CONN_MINIMAL_BLOCK_SIZE 16
@@ -39,17 +49,13 @@ static int net_again_is_error(int result) {
                    : result;
 }
 
-int _anj_srv_conn_connect(_anj_server_connection_ctx_t *ctx,
-                          anj_net_binding_type_t type,
-                          const anj_net_config_t *net_socket_cfg,
-                          const char *hostname,
-                          const char *port) {
-    assert(ctx && hostname && port && !ctx->send_in_progress);
-    int result;
-
+int _anj_srv_conn_create(_anj_server_connection_ctx_t *ctx,
+                         anj_net_binding_type_t type,
+                         const anj_net_config_t *net_socket_cfg) {
+    assert(ctx);
     if (!ctx->net_ctx) {
         memset(ctx, 0, sizeof(*ctx));
-        result = anj_net_create_ctx(type, &ctx->net_ctx, net_socket_cfg);
+        int result = anj_net_create_ctx(type, &ctx->net_ctx, net_socket_cfg);
         if (!anj_net_is_ok(result)) {
             log(L_ERROR, "Could not create socket: %d", result);
             return result;
@@ -57,6 +63,19 @@ int _anj_srv_conn_connect(_anj_server_connection_ctx_t *ctx,
         log(L_DEBUG, "Socket created successfully");
     }
     ctx->type = type;
+    return ANJ_NET_OK;
+}
+
+int _anj_srv_conn_connect(_anj_server_connection_ctx_t *ctx,
+                          anj_net_binding_type_t type,
+                          const anj_net_config_t *net_socket_cfg,
+                          const char *hostname,
+                          const char *port) {
+    assert(ctx && hostname && port && !ctx->send_in_progress);
+    int result = _anj_srv_conn_create(ctx, type, net_socket_cfg);
+    if (!anj_net_is_ok(result)) {
+        return result;
+    }
 
     anj_net_socket_state_t state;
     result = anj_net_get_state(ctx->type, ctx->net_ctx, &state);
@@ -118,15 +137,10 @@ int _anj_srv_conn_close(_anj_server_connection_ctx_t *ctx, bool cleanup) {
     return result;
 }
 
-int _anj_srv_conn_send(_anj_server_connection_ctx_t *ctx,
-                       const uint8_t *buffer,
-                       size_t length) {
-    assert(ctx && ctx->net_ctx);
-    size_t consumed_bytes;
-    ctx->send_in_progress = true;
-    int result =
-            anj_net_send(ctx->type, ctx->net_ctx, &consumed_bytes,
-                         &buffer[ctx->bytes_sent], length - ctx->bytes_sent);
+static int handle_send_result(_anj_server_connection_ctx_t *ctx,
+                              int result,
+                              size_t consumed_bytes,
+                              size_t length) {
     if (anj_net_is_ok(result)) {
         log(L_TRACE, "Sent %zu bytes", consumed_bytes);
         ctx->bytes_sent += consumed_bytes;
@@ -144,6 +158,59 @@ int _anj_srv_conn_send(_anj_server_connection_ctx_t *ctx,
     return result;
 }
 
+int _anj_srv_conn_send(_anj_server_connection_ctx_t *ctx,
+                       const uint8_t *buffer,
+                       size_t length) {
+    assert(ctx && ctx->net_ctx);
+    size_t consumed_bytes;
+    ctx->send_in_progress = true;
+    int result =
+            anj_net_send(ctx->type, ctx->net_ctx, &consumed_bytes,
+                         &buffer[ctx->bytes_sent], length - ctx->bytes_sent);
+    return handle_send_result(ctx, result, consumed_bytes, length);
+}
+
+#ifdef ANJ_NET_WITH_SEND_VEC
+int _anj_srv_conn_send_vec(_anj_server_connection_ctx_t *ctx,
+                           const uint8_t *header,
+                           size_t header_length,
+                           const uint8_t *payload,
+                           size_t payload_length) {
+    assert(ctx && ctx->net_ctx && header && (payload || !payload_length));
+    size_t length = header_length + payload_length;
+    anj_net_iovec_t iov[2];
+    size_t iov_count = 0;
+    // skip the part of the message sent by previous calls
+    if (ctx->bytes_sent < header_length) {
+        iov[iov_count++] = (anj_net_iovec_t) {
+            .buf = &header[ctx->bytes_sent],
+            .length = header_length - ctx->bytes_sent
+        };
+        if (payload_length) {
+            iov[iov_count++] = (anj_net_iovec_t) {
+                .buf = payload,
+                .length = payload_length
+            };
+        }
+    } else {
+        iov[iov_count++] = (anj_net_iovec_t) {
+            .buf = &payload[ctx->bytes_sent - header_length],
+            .length = length - ctx->bytes_sent
+        };
+    }
+    size_t consumed_bytes;
+    ctx->send_in_progress = true;
+    int result = anj_net_send_vec(ctx->type, ctx->net_ctx, &consumed_bytes,
+                                  iov, iov_count);
+    return handle_send_result(ctx, result, consumed_bytes, length);
+}
+
+// DTLS records are encrypted from a single contiguous buffer
+static bool send_vec_supported(const _anj_server_connection_ctx_t *ctx) {
+    return ctx->type != ANJ_NET_BINDING_DTLS;
+}
+#endif // ANJ_NET_WITH_SEND_VEC
+
 int _anj_srv_conn_receive(_anj_server_connection_ctx_t *ctx,
                           uint8_t *buffer,
                           size_t *out_length,
@@ -173,18 +240,27 @@ int _anj_srv_conn_calculate_max_payload_size(_anj_server_connection_ctx_t *ctx,
                                              size_t payload_buff_size,
                                              size_t out_msg_buffer_size,
                                              bool server_request,
+                                             size_t security_overhead,
                                              size_t *out_payload_size) {
     assert(ctx && ctx->net_ctx && msg && payload_buff_size > 0
            && out_msg_buffer_size > 0);
 
     size_t max_msg_size = ANJ_MIN(out_msg_buffer_size, (size_t) ctx->mtu);
     size_t header_max_size =
-            server_request ? _ANJ_COAP_UDP_RESPONSE_MSG_HEADER_MAX_SIZE
-                           : _anj_coap_calculate_msg_header_max_size(msg);
+            (server_request ? _ANJ_COAP_UDP_RESPONSE_MSG_HEADER_MAX_SIZE
+                            : _anj_coap_calculate_msg_header_max_size(msg))
+            + security_overhead;
     if (header_max_size > max_msg_size) {
         log(L_ERROR, "Buffer too small for message");
         return _ANJ_SRV_CONN_GENERIC_ERROR;
     }
+#ifdef ANJ_NET_WITH_SEND_VEC
+    // payload is sent directly from the payload buffer, unless it has to be
+    // protected together with the header
+    if (!security_overhead && send_vec_supported(ctx)) {
+        max_msg_size = (size_t) ctx->mtu;
+    }
+#endif // ANJ_NET_WITH_SEND_VEC
     size_t max_payload_size =
             ANJ_MIN((max_msg_size - header_max_size), payload_buff_size);
     if (max_payload_size < _ANJ_SRV_CONN_MINIMAL_BLOCK_SIZE) {
@@ -195,6 +271,457 @@ int _anj_srv_conn_calculate_max_payload_size(_anj_server_connection_ctx_t *ctx,
     return 0;
 }
 
+#ifdef ANJ_WITH_PMTU_PROBING
+// largest UDP payload that has to be delivered over any IPv4 path: 576 bytes
+// minus IP and UDP headers, the search never goes below it
+#    define _ANJ_SRV_CONN_PMTU_BASE 548
+// search is finished when the range of unknown sizes gets that small
+#    define _ANJ_SRV_CONN_PMTU_SEARCH_ACCURACY 32
+
+static int32_t pmtu_base(const _anj_srv_conn_pmtu_t *pmtu) {
+    return ANJ_MIN(pmtu->reported, _ANJ_SRV_CONN_PMTU_BASE);
+}
+
+static void pmtu_update_limit(_anj_srv_conn_pmtu_t *pmtu,
+                              _anj_server_connection_ctx_t *ctx) {
+    // probe the middle of the range of sizes not known to be delivered or
+    // lost, larger messages are split into smaller blocks
+    if (pmtu->lost - pmtu->confirmed > _ANJ_SRV_CONN_PMTU_SEARCH_ACCURACY) {
+        ctx->mtu = pmtu->confirmed + (pmtu->lost - pmtu->confirmed) / 2;
+    } else {
+        ctx->mtu = pmtu->confirmed;
+    }
+}
+
+void _anj_srv_conn_pmtu_connected(_anj_srv_conn_pmtu_t *pmtu,
+                                  _anj_server_connection_ctx_t *ctx,
+                                  anj_iid_t security_iid) {
+    assert(pmtu && ctx && ctx->mtu > 0);
+    bool known_server =
+            pmtu->reported > 0 && pmtu->security_iid == security_iid;
+    pmtu->security_iid = security_iid;
+    pmtu->reported = ctx->mtu;
+    pmtu->sent_max = 0;
+    if (ctx->type != ANJ_NET_BINDING_UDP
+            && ctx->type != ANJ_NET_BINDING_DTLS) {
+        // nothing to probe, the MTU of the transport is used as it is
+        pmtu->confirmed = pmtu->reported;
+        pmtu->lost = pmtu->reported + 1;
+        return;
+    }
+    pmtu->lost = ANJ_MIN(known_server ? pmtu->lost : INT32_MAX,
+                         pmtu->reported + 1);
+    if (!known_server || pmtu->confirmed >= pmtu->lost) {
+        pmtu->confirmed = pmtu_base(pmtu);
+    }
+    pmtu_update_limit(pmtu, ctx);
+    log(L_DEBUG, "Path MTU confirmed: %" PRId32 ", next limit: %" PRId32,
+        pmtu->confirmed, ctx->mtu);
+}
+
+void _anj_srv_conn_pmtu_sent(_anj_srv_conn_pmtu_t *pmtu, size_t msg_size) {
+    assert(pmtu);
+    if (msg_size > (size_t) pmtu->sent_max) {
+        pmtu->sent_max = (int32_t) msg_size;
+    }
+}
+
+void _anj_srv_conn_pmtu_finished(_anj_srv_conn_pmtu_t *pmtu,
+                                 _anj_server_connection_ctx_t *ctx,
+                                 int result) {
+    assert(pmtu && ctx);
+    int32_t sent_max = pmtu->sent_max;
+    pmtu->sent_max = 0;
+    if (!sent_max || pmtu->reported <= 0) {
+        return;
+    }
+    if (result == _ANJ_EXCHANGE_RESULT_SUCCESS
+            || result == _ANJ_EXCHANGE_ERROR_SERVER_RESPONSE) {
+        if (sent_max <= pmtu->confirmed) {
+            return;
+        }
+        pmtu->confirmed = ANJ_MIN(sent_max, pmtu->lost - 1);
+        log(L_INFO, "Path MTU confirmed: %" PRId32, pmtu->confirmed);
+    } else if (result == _ANJ_EXCHANGE_ERROR_TIMEOUT) {
+        if (sent_max > pmtu->confirmed) {
+            pmtu->lost = sent_max;
+            log(L_INFO, "Path MTU probe of %" PRId32 " bytes lost", sent_max);
+        } else if (sent_max > pmtu_base(pmtu)) {
+            // datagrams of confirmed size are lost, the path has changed
+            pmtu->lost = sent_max;
+            pmtu->confirmed = pmtu_base(pmtu);
+            log(L_WARNING, "Datagram of %" PRId32 " bytes lost, Path MTU "
+                           "search restarted", sent_max);
+        } else {
+            return;
+        }
+    } else {
+        return;
+    }
+    pmtu_update_limit(pmtu, ctx);
+}
+#endif // ANJ_WITH_PMTU_PROBING
+
+#ifdef ANJ_WITH_NAT_KEEPALIVE_PROBING
+// search is finished when the range of unknown idle times gets that small
+#    define _ANJ_SRV_CONN_NAT_SEARCH_ACCURACY \
+        anj_time_duration_new(15, ANJ_TIME_UNIT_S)
+
+// zero upper bound means that the search is disabled
+static bool nat_enabled(const _anj_srv_conn_nat_t *nat) {
+    return !anj_time_duration_eq(nat->max, ANJ_TIME_DURATION_ZERO);
+}
+
+void _anj_srv_conn_nat_init(_anj_srv_conn_nat_t *nat,
+                            anj_time_duration_t min,
+                            anj_time_duration_t max) {
+    assert(nat);
+    nat->max = max;
+    nat->min = anj_time_duration_eq(min, ANJ_TIME_DURATION_ZERO)
+                       ? anj_time_duration_new(30, ANJ_TIME_UNIT_S)
+                       : min;
+    if (!nat_enabled(nat)) {
+        nat->min = ANJ_TIME_DURATION_ZERO;
+    } else if (anj_time_duration_lt(nat->max, nat->min)) {
+        nat->max = nat->min;
+    }
+    nat->confirmed = nat->min;
+    nat->lost = nat->max;
+    nat->last_traffic = ANJ_TIME_MONOTONIC_INVALID;
+    nat->request_idle = ANJ_TIME_DURATION_ZERO;
+}
+
+anj_time_duration_t
+_anj_srv_conn_nat_interval(const _anj_srv_conn_nat_t *nat) {
+    assert(nat);
+    if (!nat_enabled(nat)) {
+        return ANJ_TIME_DURATION_INVALID;
+    }
+    // probe the middle of the range of idle times not known to be confirmed
+    // or lost, like the Path MTU
+    anj_time_duration_t range =
+            anj_time_duration_sub(nat->lost, nat->confirmed);
+    if (anj_time_duration_gt(range, _ANJ_SRV_CONN_NAT_SEARCH_ACCURACY)) {
+        return anj_time_duration_add(nat->confirmed,
+                                     anj_time_duration_div(range, 2));
+    }
+    return nat->confirmed;
+}
+
+void _anj_srv_conn_nat_traffic(_anj_srv_conn_nat_t *nat,
+                               anj_time_monotonic_t now) {
+    assert(nat);
+    nat->last_traffic = now;
+    nat->request_idle = ANJ_TIME_DURATION_ZERO;
+}
+
+void _anj_srv_conn_nat_received(_anj_srv_conn_nat_t *nat,
+                                anj_time_monotonic_t now) {
+    assert(nat);
+    nat->request_idle = ANJ_TIME_DURATION_ZERO;
+    if (!nat_enabled(nat) || !anj_time_monotonic_is_valid(nat->last_traffic)) {
+        return;
+    }
+    anj_time_duration_t idle = anj_time_monotonic_diff(now, nat->last_traffic);
+    if (!anj_time_duration_gt(idle, nat->confirmed)) {
+        return;
+    }
+    if (!anj_time_duration_lt(idle, nat->lost)) {
+        // the connection was lost for another reason than the NAT
+        nat->lost = nat->max;
+    }
+    nat->confirmed = anj_time_duration_lt(idle, nat->lost) ? idle : nat->lost;
+    log(L_INFO, "NAT binding confirmed after %ss idle",
+        ANJ_TIME_DURATION_AS_STRING(nat->confirmed, ANJ_TIME_UNIT_S));
+}
+
+void _anj_srv_conn_nat_client_request(_anj_srv_conn_nat_t *nat,
+                                      anj_time_monotonic_t now) {
+    assert(nat);
+    nat->request_idle =
+            anj_time_monotonic_is_valid(nat->last_traffic)
+                    ? anj_time_monotonic_diff(now, nat->last_traffic)
+                    : ANJ_TIME_DURATION_ZERO;
+}
+
+void _anj_srv_conn_nat_lost(_anj_srv_conn_nat_t *nat) {
+    assert(nat);
+    anj_time_duration_t idle = nat->request_idle;
+    nat->request_idle = ANJ_TIME_DURATION_ZERO;
+    // bindings are assumed to survive the lower bound, so a loss after a
+    // shorter idle time is an outage and says nothing about the NAT
+    if (!nat_enabled(nat) || !anj_time_duration_gt(idle, nat->min)) {
+        return;
+    }
+    if (anj_time_duration_gt(idle, nat->confirmed)) {
+        if (anj_time_duration_lt(idle, nat->lost)) {
+            nat->lost = idle;
+            log(L_INFO, "NAT binding lost after %ss idle",
+                ANJ_TIME_DURATION_AS_STRING(idle, ANJ_TIME_UNIT_S));
+        }
+    } else {
+        // binding expires earlier than confirmed, the network has changed
+        nat->lost = idle;
+        nat->confirmed = nat->min;
+        log(L_WARNING, "NAT binding lost after %ss idle, search restarted",
+            ANJ_TIME_DURATION_AS_STRING(idle, ANJ_TIME_UNIT_S));
+    }
+}
+
+#    ifdef ANJ_WITH_PERSISTENCE
+static const char g_nat_persistence_header[] = "NAT1";
+
+int anj_core_nat_keepalive_store(anj_t *anj,
+                                 const anj_persistence_context_t *ctx) {
+    assert(anj && ctx);
+    assert(anj_persistence_direction(ctx) == ANJ_PERSISTENCE_STORE);
+    int64_t confirmed_us =
+            anj_time_duration_to_scalar(anj->nat.confirmed, ANJ_TIME_UNIT_US);
+    int64_t lost_us =
+            anj_time_duration_to_scalar(anj->nat.lost, ANJ_TIME_UNIT_US);
+    if (anj_persistence_magic(ctx, g_nat_persistence_header,
+                              sizeof(g_nat_persistence_header))
+            || anj_persistence_i64(ctx, &confirmed_us)
+            || anj_persistence_i64(ctx, &lost_us)) {
+        log(L_ERROR, "Failed to store NAT binding timeout");
+        return -1;
+    }
+    return 0;
+}
+
+static anj_time_duration_t nat_clamp(const _anj_srv_conn_nat_t *nat,
+                                     anj_time_duration_t value) {
+    if (anj_time_duration_lt(value, nat->min)) {
+        return nat->min;
+    }
+    return anj_time_duration_gt(value, nat->max) ? nat->max : value;
+}
+
+int anj_core_nat_keepalive_restore(anj_t *anj,
+                                   const anj_persistence_context_t *ctx) {
+    assert(anj && ctx);
+    assert(anj_persistence_direction(ctx) == ANJ_PERSISTENCE_RESTORE);
+    int64_t confirmed_us;
+    int64_t lost_us;
+    if (anj_persistence_magic(ctx, g_nat_persistence_header,
+                              sizeof(g_nat_persistence_header))
+            || anj_persistence_i64(ctx, &confirmed_us)
+            || anj_persistence_i64(ctx, &lost_us) || confirmed_us < 0
+            || lost_us < confirmed_us) {
+        log(L_ERROR, "Failed to restore NAT binding timeout");
+        return -1;
+    }
+    // bounds may have changed since the values were stored
+    anj->nat.confirmed = nat_clamp(
+            &anj->nat, anj_time_duration_new(confirmed_us, ANJ_TIME_UNIT_US));
+    anj->nat.lost = nat_clamp(&anj->nat,
+                              anj_time_duration_new(lost_us, ANJ_TIME_UNIT_US));
+    log(L_INFO, "NAT binding timeout restored, keep-alive after %ss idle",
+        ANJ_TIME_DURATION_AS_STRING(_anj_srv_conn_nat_interval(&anj->nat),
+                                    ANJ_TIME_UNIT_S));
+    return 0;
+}
+#    endif // ANJ_WITH_PERSISTENCE
+#endif     // ANJ_WITH_NAT_KEEPALIVE_PROBING
+
+static size_t security_overhead(anj_t *anj) {
+#ifdef ANJ_WITH_OSCORE
+    if (anj->oscore_ctx.active) {
+        return _ANJ_OSCORE_MAX_OVERHEAD;
+    }
+#endif // ANJ_WITH_OSCORE
+    (void) anj;
+    return 0;
+}
+
+#ifdef ANJ_NET_WITH_SEND_VEC
+// payload protected with OSCORE is encrypted in the message buffer
+static bool send_payload_separately(anj_t *anj) {
+    return !security_overhead(anj) && send_vec_supported(&anj->connection_ctx);
+}
+#endif // ANJ_NET_WITH_SEND_VEC
+
+static int encode_udp_msg(anj_t *anj, _anj_coap_msg_t *msg) {
+#ifdef ANJ_WITH_SCRATCH_ARENA
+#    ifdef ANJ_COAP_WITH_MSG_TEMPLATES
+    _anj_coap_msg_templates_t *templates = &anj->coap_msg_templates;
+#    else  // ANJ_COAP_WITH_MSG_TEMPLATES
+    _anj_coap_msg_templates_t *templates = NULL;
+#    endif // ANJ_COAP_WITH_MSG_TEMPLATES
+    bool with_payload = true;
+#    ifdef ANJ_NET_WITH_SEND_VEC
+    if (send_payload_separately(anj)) {
+        with_payload = false;
+        anj->out_payload = msg->payload;
+        anj->out_payload_len = msg->payload ? msg->payload_size : 0;
+    }
+#    endif // ANJ_NET_WITH_SEND_VEC
+    return _anj_coap_encode_udp_with_scratch(
+            anj->scratch.coap_options, templates, msg, anj->out_buffer,
+            ANJ_OUT_MSG_BUFFER_SIZE, with_payload, &anj->out_msg_len);
+#else  // ANJ_WITH_SCRATCH_ARENA
+#    ifdef ANJ_NET_WITH_SEND_VEC
+    if (send_payload_separately(anj)) {
+#        ifdef ANJ_COAP_WITH_MSG_TEMPLATES
+        int res = _anj_coap_encode_udp_header_with_templates(
+                &anj->coap_msg_templates, msg, anj->out_buffer,
+                ANJ_OUT_MSG_BUFFER_SIZE, &anj->out_msg_len);
+#        else  // ANJ_COAP_WITH_MSG_TEMPLATES
+        int res = _anj_coap_encode_udp_header(
+                msg, anj->out_buffer, ANJ_OUT_MSG_BUFFER_SIZE,
+                &anj->out_msg_len);
+#        endif // ANJ_COAP_WITH_MSG_TEMPLATES
+        anj->out_payload = msg->payload;
+        anj->out_payload_len = msg->payload ? msg->payload_size : 0;
+        return res;
+    }
+#    endif // ANJ_NET_WITH_SEND_VEC
+#    ifdef ANJ_COAP_WITH_MSG_TEMPLATES
+    return _anj_coap_encode_udp_with_templates(
+            &anj->coap_msg_templates, msg, anj->out_buffer,
+            ANJ_OUT_MSG_BUFFER_SIZE, &anj->out_msg_len);
+#    else  // ANJ_COAP_WITH_MSG_TEMPLATES
+    return _anj_coap_encode_udp(msg, anj->out_buffer, ANJ_OUT_MSG_BUFFER_SIZE,
+                                &anj->out_msg_len);
+#    endif // ANJ_COAP_WITH_MSG_TEMPLATES
+#endif // ANJ_WITH_SCRATCH_ARENA
+}
+
+#ifdef ANJ_WITH_ENCODED_RETRANSMISSIONS
+// out_buffer is not shared with incoming messages (see init.h), so what is
+// encoded there stays valid until the next message is encoded
+static void
+store_encoded_msg(anj_t *anj, const _anj_coap_msg_t *msg, int res) {
+    anj->out_msg_con_encoded =
+            !res
+            && msg->coap_binding_data.type == ANJ_COAP_UDP_TYPE_CONFIRMABLE;
+    anj->out_msg_mid = msg->coap_binding_data.message_id;
+#    ifdef ANJ_WITH_CACHE
+    // if the message is a response that has just been cached, keep it encoded
+    const uint8_t *payload = NULL;
+    size_t payload_len = 0;
+#        ifdef ANJ_NET_WITH_SEND_VEC
+    if (send_payload_separately(anj)) {
+        payload = anj->out_payload;
+        payload_len = anj->out_payload_len;
+    }
+#        endif // ANJ_NET_WITH_SEND_VEC
+    _anj_exchange_cache_set_datagram(&anj->exchange_cache,
+                                     res ? NULL : anj->out_buffer,
+                                     anj->out_msg_len, payload, payload_len);
+#    endif // ANJ_WITH_CACHE
+}
+
+#endif // ANJ_WITH_ENCODED_RETRANSMISSIONS
+
+static bool msg_already_encoded(anj_t *anj, const _anj_coap_msg_t *msg) {
+#ifdef ANJ_WITH_ENCODED_RETRANSMISSIONS
+    // Message ID of a Confirmable message is only repeated in retransmissions
+    return anj->out_msg_con_encoded
+           && msg->coap_binding_data.type == ANJ_COAP_UDP_TYPE_CONFIRMABLE
+           && msg->coap_binding_data.message_id == anj->out_msg_mid;
+#else  // ANJ_WITH_ENCODED_RETRANSMISSIONS
+    (void) anj;
+    (void) msg;
+    return false;
+#endif // ANJ_WITH_ENCODED_RETRANSMISSIONS
+}
+
+static int encode_out_msg(anj_t *anj, _anj_coap_msg_t *msg) {
+    int res = encode_udp_msg(anj, msg);
+#ifdef ANJ_WITH_OSCORE
+    if (!res && anj->oscore_ctx.active) {
+        res = _anj_oscore_protect(&anj->oscore_ctx, anj->out_buffer,
+                                  &anj->out_msg_len, ANJ_OUT_MSG_BUFFER_SIZE);
+    }
+#endif // ANJ_WITH_OSCORE
+#ifdef ANJ_COAP_WITH_HEADER_COMPRESSION
+    if (!res && anj->connection_ctx.type == ANJ_NET_BINDING_NON_IP) {
+        _anj_location_path_t location_path;
+        _anj_register_get_location_path(anj, &location_path);
+        res = _anj_coap_compress(anj->out_buffer, &anj->out_msg_len,
+                                 &location_path);
+    }
+#endif // ANJ_COAP_WITH_HEADER_COMPRESSION
+#ifdef ANJ_WITH_ENCODED_RETRANSMISSIONS
+    store_encoded_msg(anj, msg, res);
+#endif // ANJ_WITH_ENCODED_RETRANSMISSIONS
+    if (!res) {
+        _ANJ_CORE_USAGE_UPDATE(anj, out_buffer_max, anj->out_msg_len);
+        _ANJ_CORE_USAGE_UPDATE(anj, payload_buffer_max, msg->payload_size);
+    }
+    return res;
+}
+
+static int send_msg(anj_t *anj, size_t *out_msg_size) {
+#ifdef ANJ_NET_WITH_SEND_VEC
+    if (send_payload_separately(anj)) {
+        *out_msg_size = anj->out_msg_len + anj->out_payload_len;
+        return _anj_srv_conn_send_vec(&anj->connection_ctx, anj->out_buffer,
+                                      anj->out_msg_len, anj->out_payload,
+                                      anj->out_payload_len);
+    }
+#endif // ANJ_NET_WITH_SEND_VEC
+    *out_msg_size = anj->out_msg_len;
+    return _anj_srv_conn_send(&anj->connection_ctx, anj->out_buffer,
+                              anj->out_msg_len);
+}
+
+static int send_out_msg(anj_t *anj) {
+    _ANJ_TRACE(&anj->trace, NET_SEND, BEGIN, 0);
+    size_t msg_size;
+    int result = send_msg(anj, &msg_size);
+    if (anj_net_is_ok(result)) {
+        _ANJ_METRICS_ADD(&anj->metrics, bytes_sent, msg_size);
+    }
+    _ANJ_TRACE(&anj->trace, NET_SEND, END,
+               anj_net_is_ok(result) ? (int32_t) msg_size : result);
+    return result;
+}
+
+#if defined(ANJ_WITH_CACHE) && defined(ANJ_WITH_ENCODED_RETRANSMISSIONS)
+static int send_cached_msg(anj_t *anj,
+                           const uint8_t *datagram,
+                           size_t datagram_len) {
+    _ANJ_TRACE(&anj->trace, NET_SEND, BEGIN, 0);
+    int result =
+            _anj_srv_conn_send(&anj->connection_ctx, datagram, datagram_len);
+    if (anj_net_is_ok(result)) {
+        _ANJ_METRICS_ADD(&anj->metrics, bytes_sent, datagram_len);
+    }
+    _ANJ_TRACE(&anj->trace, NET_SEND, END,
+               anj_net_is_ok(result) ? (int32_t) datagram_len : result);
+    return result;
+}
+#endif // defined(ANJ_WITH_CACHE) && defined(ANJ_WITH_ENCODED_RETRANSMISSIONS)
+
+static void pmtu_on_sent(anj_t *anj) {
+#ifdef ANJ_WITH_PMTU_PROBING
+    // only a response to a Confirmable request proves that it was delivered
+    if (!anj->exchange_ctx.server_request && anj->exchange_ctx.confirmable) {
+        size_t msg_size = anj->out_msg_len;
+#    ifdef ANJ_NET_WITH_SEND_VEC
+        if (send_payload_separately(anj)) {
+            msg_size += anj->out_payload_len;
+        }
+#    endif // ANJ_NET_WITH_SEND_VEC
+        _anj_srv_conn_pmtu_sent(&anj->pmtu, msg_size);
+    }
+#else  // ANJ_WITH_PMTU_PROBING
+    (void) anj;
+#endif // ANJ_WITH_PMTU_PROBING
+}
+
+static void pmtu_on_exchange_finished(anj_t *anj) {
+#ifdef ANJ_WITH_PMTU_PROBING
+    _anj_srv_conn_pmtu_finished(
+            &anj->pmtu, &anj->connection_ctx,
+            _anj_exchange_get_last_result(&anj->exchange_ctx));
+#else  // ANJ_WITH_PMTU_PROBING
+    (void) anj;
+#endif // ANJ_WITH_PMTU_PROBING
+}
+
 // For the first _anj_srv_conn_handle_request() call, _anj_exchange_get_state()
 // always returns ANJ_EXCHANGE_STATE_WAITING_SEND_CONFIRMATION even though
 // message is not sent yet (check exchange.h API documentation).
@@ -202,24 +729,34 @@ int _anj_srv_conn_handle_request(anj_t *anj) {
     int result = 0;
     _anj_exchange_state_t exchange_state =
             _anj_exchange_get_state(&anj->exchange_ctx);
-    _anj_coap_msg_t msg;
-    memset(&msg, 0, sizeof(msg));
+    _ANJ_CORE_SCRATCH_MSG(anj, msg, conn_msg);
+    memset(msg, 0, sizeof(*msg));
     while (1) {
 #ifdef ANJ_WITH_CACHE
         if (anj->exchange_cache.handling_retransmission) {
-            _anj_exchange_cache_get(&anj->exchange_cache, &msg);
-            result = _anj_coap_encode_udp(&msg,
-                                          anj->out_buffer,
-                                          ANJ_OUT_MSG_BUFFER_SIZE,
-                                          &anj->out_msg_len);
+#    ifdef ANJ_WITH_ENCODED_RETRANSMISSIONS
+            // the response is sent as it was encoded, out_buffer is not used
+            const uint8_t *datagram;
+            size_t datagram_len;
+            _anj_exchange_cache_get_datagram(&anj->exchange_cache, &datagram,
+                                             &datagram_len);
+            if (!datagram_len) {
+                // If something goes wrong then just drop retransmitted request
+                anj->exchange_cache.handling_retransmission = false;
+                continue;
+            }
+            result = send_cached_msg(anj, datagram, datagram_len);
+#    else  // ANJ_WITH_ENCODED_RETRANSMISSIONS
+            _anj_exchange_cache_get(&anj->exchange_cache, msg);
+            result = encode_out_msg(anj, msg);
             if (result) {
                 ANJ_CORE_LOG_COAP_ERROR(result);
                 // If something goes wrong then just drop retransmitted request
                 anj->exchange_cache.handling_retransmission = false;
                 continue;
             }
-            result = _anj_srv_conn_send(&anj->connection_ctx, anj->out_buffer,
-                                        anj->out_msg_len);
+            result = send_out_msg(anj);
+#    endif // ANJ_WITH_ENCODED_RETRANSMISSIONS
 
             if (anj_net_is_inprogress(result)) {
                 return result;
@@ -237,11 +774,10 @@ int _anj_srv_conn_handle_request(anj_t *anj) {
                     || exchange_state == ANJ_EXCHANGE_STATE_MSG_TO_SEND) {
             // For both cases we need to send a message but for new message we
             // also need to build CoAP message first.
-            if (exchange_state == ANJ_EXCHANGE_STATE_MSG_TO_SEND) {
-                result = _anj_coap_encode_udp(&msg,
-                                              anj->out_buffer,
-                                              ANJ_OUT_MSG_BUFFER_SIZE,
-                                              &anj->out_msg_len);
+            // Retransmission may be sent as it was encoded before.
+            if (exchange_state == ANJ_EXCHANGE_STATE_MSG_TO_SEND
+                    && !msg_already_encoded(anj, msg)) {
+                result = encode_out_msg(anj, msg);
                 if (result) {
                     ANJ_CORE_LOG_COAP_ERROR(result);
                     _anj_exchange_terminate(&anj->exchange_ctx,
@@ -249,26 +785,28 @@ int _anj_srv_conn_handle_request(anj_t *anj) {
                     return result;
                 }
             }
-            result = _anj_srv_conn_send(&anj->connection_ctx, anj->out_buffer,
-                                        anj->out_msg_len);
+            result = send_out_msg(anj);
             if (anj_net_is_inprogress(result)) {
                 // check for send ACK timeout, error suggests network issue
                 exchange_state =
                         _anj_exchange_process(&anj->exchange_ctx,
-                                              ANJ_EXCHANGE_EVENT_NONE, &msg);
+                                              ANJ_EXCHANGE_EVENT_NONE, msg);
                 if (exchange_state == ANJ_EXCHANGE_STATE_FINISHED) {
+                    pmtu_on_exchange_finished(anj);
                     return -1;
                 }
                 return result;
             } else if (result) {
                 _anj_exchange_terminate(&anj->exchange_ctx,
                                         _ANJ_EXCHANGE_ERROR_NETWORK);
+                pmtu_on_exchange_finished(anj);
                 return result;
             }
+            pmtu_on_sent(anj);
             exchange_state =
                     _anj_exchange_process(&anj->exchange_ctx,
                                           ANJ_EXCHANGE_EVENT_SEND_CONFIRMATION,
-                                          &msg);
+                                          msg);
         }
 
         if (exchange_state == ANJ_EXCHANGE_STATE_WAITING_MSG) {
@@ -279,7 +817,7 @@ int _anj_srv_conn_handle_request(anj_t *anj) {
                 // check for receive timeout
                 exchange_state =
                         _anj_exchange_process(&anj->exchange_ctx,
-                                              ANJ_EXCHANGE_EVENT_NONE, &msg);
+                                              ANJ_EXCHANGE_EVENT_NONE, msg);
                 if (exchange_state == ANJ_EXCHANGE_STATE_WAITING_MSG) {
                     // we're still waiting for a message
                     return result;
@@ -289,23 +827,40 @@ int _anj_srv_conn_handle_request(anj_t *anj) {
                                         _ANJ_EXCHANGE_ERROR_NETWORK);
                 return result;
             } else {
-                result = _anj_coap_decode_udp(anj->in_buffer, msg_size, &msg);
+                _ANJ_METRICS_ADD(&anj->metrics, bytes_received, msg_size);
+                _ANJ_CORE_USAGE_UPDATE(anj, in_buffer_max, msg_size);
+                _ANJ_TRACE(&anj->trace, NET_RECV, INSTANT, msg_size);
+                result = _ANJ_CORE_DECODE_IN_MSG(anj, msg_size, msg);
                 if (result) {
                     ANJ_CORE_LOG_COAP_ERROR(result);
                     // drop message and continue waiting
-                } else {
+                } else
+#ifdef ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+                        // responses to the CoAP downloader requests are
+                        // consumed by the downloader
+                        if (!_anj_coap_downloader_shared_handle_msg(anj, msg))
+#endif // ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+                {
+#ifdef ANJ_WITH_PIPELINED_NOTIFICATIONS
+                    // response to a notification sent next to this exchange
+                    if (_anj_srv_conn_handle_pipelined_response(anj, msg)) {
+                        log(L_TRACE, "Pipelined request response received");
+                    } else
+#endif // ANJ_WITH_PIPELINED_NOTIFICATIONS
 #ifdef ANJ_WITH_CACHE
                     // check if it isn't a retransmission
                     if (_anj_exchange_cache_check(
                                 &anj->exchange_cache,
-                                msg.coap_binding_data.message_id)
-                            == _ANJ_EXCHANGE_CACHE_MISS)
+                                msg->coap_binding_data.message_id)
+                            != _ANJ_EXCHANGE_CACHE_MISS) {
+                        _ANJ_METRICS_INC(&anj->metrics, cache_hits);
+                    } else
 #endif // ANJ_WITH_CACHE
                     {
                         exchange_state = _anj_exchange_process(
                                 &anj->exchange_ctx,
                                 ANJ_EXCHANGE_EVENT_NEW_MSG,
-                                &msg);
+                                msg);
                     }
                 }
             }
@@ -317,14 +872,14 @@ int _anj_srv_conn_handle_request(anj_t *anj) {
             // related variables
             anj->connection_ctx.bytes_sent = 0;
             anj->connection_ctx.send_in_progress = false;
+            pmtu_on_exchange_finished(anj);
             return 0;
         }
     }
 }
 
 static int encode_coap_msg(anj_t *anj, _anj_coap_msg_t *msg) {
-    int res = _anj_coap_encode_udp(msg, anj->out_buffer,
-                                   ANJ_OUT_MSG_BUFFER_SIZE, &anj->out_msg_len);
+    int res = encode_out_msg(anj, msg);
     if (res) {
         _anj_exchange_terminate(&anj->exchange_ctx,
                                 _ANJ_EXCHANGE_ERROR_PROTOCOL);
@@ -342,6 +897,7 @@ int _anj_srv_conn_prepare_client_request(anj_t *anj,
                                                  ANJ_OUT_PAYLOAD_BUFFER_SIZE,
                                                  ANJ_OUT_MSG_BUFFER_SIZE,
                                                  false,
+                                                 security_overhead(anj),
                                                  &payload_size)) {
         return -1;
     }
@@ -352,6 +908,9 @@ int _anj_srv_conn_prepare_client_request(anj_t *anj,
             != ANJ_EXCHANGE_STATE_MSG_TO_SEND) {
         return -1;
     }
+#ifdef ANJ_WITH_NAT_KEEPALIVE_PROBING
+    _anj_srv_conn_nat_client_request(&anj->nat, _ANJ_CORE_NOW(anj));
+#endif // ANJ_WITH_NAT_KEEPALIVE_PROBING
     return encode_coap_msg(anj, new_request);
 }
 
@@ -365,6 +924,7 @@ int _anj_srv_conn_prepare_server_request(anj_t *anj,
                                                  ANJ_OUT_PAYLOAD_BUFFER_SIZE,
                                                  ANJ_OUT_MSG_BUFFER_SIZE,
                                                  true,
+                                                 security_overhead(anj),
                                                  &payload_size)) {
         return -1;
     }
@@ -381,15 +941,241 @@ int _anj_srv_conn_prepare_server_request(anj_t *anj,
     return encode_coap_msg(anj, request);
 }
 
+#ifdef ANJ_WITH_PIPELINED_NOTIFICATIONS
+_anj_pipelined_exchange_t *_anj_srv_conn_free_pipelined_exchange(anj_t *anj) {
+    for (size_t i = 0; i < _ANJ_PIPELINED_EXCHANGES_NUMBER; i++) {
+        if (!_anj_exchange_ongoing_exchange(&anj->pipelined[i].exchange_ctx)) {
+            return &anj->pipelined[i];
+        }
+    }
+    return NULL;
+}
+
+int _anj_srv_conn_prepare_pipelined_request(anj_t *anj,
+                                            _anj_pipelined_exchange_t *pipelined,
+                                            _anj_coap_msg_t *new_request,
+                                            _anj_exchange_handlers_t *handlers) {
+    assert(!_anj_srv_conn_pipelined_request_deferred(anj));
+    size_t payload_size;
+    if (_anj_srv_conn_calculate_max_payload_size(
+                &anj->connection_ctx, new_request,
+                sizeof(pipelined->payload_buffer), ANJ_OUT_MSG_BUFFER_SIZE,
+                false, security_overhead(anj), &payload_size)) {
+        return -1;
+    }
+    if (_anj_exchange_new_pipelined_request(
+                &anj->exchange_ctx, &pipelined->exchange_ctx, new_request,
+                handlers, pipelined->payload_buffer, payload_size)
+            != ANJ_EXCHANGE_STATE_MSG_TO_SEND) {
+        return -1;
+    }
+    if (_anj_exchange_pipelined_request_deferred(&pipelined->exchange_ctx)) {
+        log(L_DEBUG, "Request deferred until the ongoing exchange finishes");
+        return 0;
+    }
+    // the main exchange is waiting for a response or is finished, so the
+    // output buffer is free until this message is sent
+    int result = encode_out_msg(anj, new_request);
+    if (result) {
+        _anj_exchange_terminate(&pipelined->exchange_ctx,
+                                _ANJ_EXCHANGE_ERROR_PROTOCOL);
+        ANJ_CORE_LOG_COAP_ERROR(result);
+    }
+    return result;
+}
+
+static bool pipelined_request_sent(_anj_exchange_ctx_t *ctx) {
+    return _anj_exchange_ongoing_exchange(ctx)
+           && !_anj_exchange_pipelined_request_deferred(ctx);
+}
+
+// Message of the main exchange may be encoded in the output buffer, but not
+// sent yet, see _anj_srv_conn_handle_request()
+static bool out_buffer_in_use(anj_t *anj) {
+#    ifdef ANJ_WITH_CACHE
+    if (anj->exchange_cache.handling_retransmission) {
+        return true;
+    }
+#    endif // ANJ_WITH_CACHE
+    _anj_exchange_state_t state = _anj_exchange_get_state(&anj->exchange_ctx);
+    return anj->connection_ctx.send_in_progress
+           || (state != ANJ_EXCHANGE_STATE_FINISHED
+               && state != ANJ_EXCHANGE_STATE_WAITING_MSG);
+}
+
+static int handle_pipelined_request(anj_t *anj, _anj_exchange_ctx_t *ctx) {
+    _anj_coap_msg_t msg;
+    memset(&msg, 0, sizeof(msg));
+    _anj_exchange_state_t state = _anj_exchange_get_state(ctx);
+    if (state == ANJ_EXCHANGE_STATE_WAITING_MSG) {
+        if (out_buffer_in_use(anj)) {
+            // possible retransmission has to wait
+            return 0;
+        }
+        // check for the response timeout
+        state = _anj_exchange_process(ctx, ANJ_EXCHANGE_EVENT_NONE, &msg);
+        if (state != ANJ_EXCHANGE_STATE_MSG_TO_SEND) {
+            return 0;
+        }
+        if (!msg_already_encoded(anj, &msg)) {
+            int result = encode_out_msg(anj, &msg);
+            if (result) {
+                _anj_exchange_terminate(ctx, _ANJ_EXCHANGE_ERROR_PROTOCOL);
+                ANJ_CORE_LOG_COAP_ERROR(result);
+                return 0;
+            }
+        }
+    }
+    // message prepared for this exchange is kept in the output buffer
+    int result = send_out_msg(anj);
+    if (anj_net_is_inprogress(result)) {
+        // check for send ACK timeout
+        if (_anj_exchange_process(ctx, ANJ_EXCHANGE_EVENT_NONE, &msg)
+                == ANJ_EXCHANGE_STATE_FINISHED) {
+            anj->connection_ctx.bytes_sent = 0;
+            anj->connection_ctx.send_in_progress = false;
+            return 0;
+        }
+        return result;
+    } else if (result) {
+        _anj_exchange_terminate(ctx, _ANJ_EXCHANGE_ERROR_NETWORK);
+        return 0;
+    }
+    _anj_exchange_process(ctx, ANJ_EXCHANGE_EVENT_SEND_CONFIRMATION, &msg);
+    return 0;
+}
+
+int _anj_srv_conn_handle_pipelined_requests(anj_t *anj) {
+    // message partially sent goes first, it occupies the output buffer
+    for (size_t i = 0; i < _ANJ_PIPELINED_EXCHANGES_NUMBER; i++) {
+        _anj_exchange_ctx_t *ctx = &anj->pipelined[i].exchange_ctx;
+        if (_anj_exchange_get_state(ctx)
+                == ANJ_EXCHANGE_STATE_WAITING_SEND_CONFIRMATION) {
+            int result = handle_pipelined_request(anj, ctx);
+            if (result) {
+                return result;
+            }
+        }
+    }
+    for (size_t i = 0; i < _ANJ_PIPELINED_EXCHANGES_NUMBER; i++) {
+        _anj_exchange_ctx_t *ctx = &anj->pipelined[i].exchange_ctx;
+        if (pipelined_request_sent(ctx)) {
+            int result = handle_pipelined_request(anj, ctx);
+            if (result) {
+                return result;
+            }
+        }
+    }
+    return 0;
+}
+
+bool _anj_srv_conn_handle_pipelined_response(anj_t *anj,
+                                             _anj_coap_msg_t *msg) {
+    for (size_t i = 0; i < _ANJ_PIPELINED_EXCHANGES_NUMBER; i++) {
+        _anj_exchange_ctx_t *ctx = &anj->pipelined[i].exchange_ctx;
+        if (_anj_exchange_acknowledged_by(ctx, msg)) {
+            _anj_exchange_process(ctx, ANJ_EXCHANGE_EVENT_NEW_MSG, msg);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool _anj_srv_conn_pipelined_requests_ongoing(anj_t *anj) {
+    for (size_t i = 0; i < _ANJ_PIPELINED_EXCHANGES_NUMBER; i++) {
+        if (pipelined_request_sent(&anj->pipelined[i].exchange_ctx)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+anj_time_monotonic_t _anj_srv_conn_pipelined_requests_timeout(anj_t *anj) {
+    anj_time_monotonic_t timeout = ANJ_TIME_MONOTONIC_INVALID;
+    for (size_t i = 0; i < _ANJ_PIPELINED_EXCHANGES_NUMBER; i++) {
+        _anj_exchange_ctx_t *ctx = &anj->pipelined[i].exchange_ctx;
+        if (!pipelined_request_sent(ctx)) {
+            continue;
+        }
+        anj_time_monotonic_t next = _anj_exchange_next_timeout(ctx);
+        if (!anj_time_monotonic_is_valid(timeout)
+                || (anj_time_monotonic_is_valid(next)
+                    && anj_time_monotonic_lt(next, timeout))) {
+            timeout = next;
+        }
+    }
+    return timeout;
+}
+
+static _anj_exchange_ctx_t *deferred_request(anj_t *anj) {
+    for (size_t i = 0; i < _ANJ_PIPELINED_EXCHANGES_NUMBER; i++) {
+        if (_anj_exchange_pipelined_request_deferred(
+                    &anj->pipelined[i].exchange_ctx)) {
+            return &anj->pipelined[i].exchange_ctx;
+        }
+    }
+    return NULL;
+}
+
+bool _anj_srv_conn_pipelined_request_deferred(anj_t *anj) {
+    return deferred_request(anj) != NULL;
+}
+
+int _anj_srv_conn_take_over_pipelined_request(anj_t *anj) {
+    _anj_exchange_ctx_t *deferred = deferred_request(anj);
+    assert(deferred);
+    if (_anj_exchange_take_over(&anj->exchange_ctx, deferred)) {
+        return -1;
+    }
+    _anj_coap_msg_t msg = anj->exchange_ctx.base_msg;
+    return encode_coap_msg(anj, &msg);
+}
+
+void _anj_srv_conn_terminate_pipelined_requests(anj_t *anj) {
+    for (size_t i = 0; i < _ANJ_PIPELINED_EXCHANGES_NUMBER; i++) {
+        _anj_exchange_terminate(&anj->pipelined[i].exchange_ctx,
+                                _ANJ_EXCHANGE_ERROR_TERMINATED);
+    }
+}
+#endif // ANJ_WITH_PIPELINED_NOTIFICATIONS
+
 anj_time_duration_t _anj_srv_conn_calculate_max_transmit_wait(
         const anj_exchange_udp_tx_params_t *params) {
     // MAX_TRANSMIT_WAIT = ACK_TIMEOUT * ((2 ** (MAX_RETRANSMIT + 1)) - 1) *
     //                     ACK_RANDOM_FACTOR
-    return anj_time_duration_fmul(params->ack_timeout,
-                                  ((double) (1 << (params->max_retransmit + 1))
-                                   - 1) * params->ack_random_factor);
+    return _anj_exchange_mul_ack_random_factor(
+            params, params->ack_timeout,
+            (1 << (params->max_retransmit + 1)) - 1);
 }
 
 int _anj_srv_conn_queue_mode_rx_off(_anj_server_connection_ctx_t *ctx) {
     return anj_net_queue_mode_rx_off(ctx->type, ctx->net_ctx);
 }
+
+#ifdef ANJ_NET_WITH_RELEASE_ASSISTANCE
+void _anj_srv_conn_release_assistance(_anj_server_connection_ctx_t *ctx,
+                                      anj_net_release_hint_t hint) {
+    assert(ctx);
+    if (!ctx->net_ctx) {
+        return;
+    }
+    int res = anj_net_release_assistance(ctx->type, ctx->net_ctx, hint);
+    if (!anj_net_is_ok(res) && res != ANJ_NET_ENOTSUP) {
+        log(L_WARNING, "Release assistance hint not passed: %d", res);
+    }
+}
+#endif // ANJ_NET_WITH_RELEASE_ASSISTANCE
+
+#ifdef ANJ_NET_WITH_POLL_HANDLE
+int _anj_srv_conn_get_poll_handle(_anj_server_connection_ctx_t *ctx,
+                                  anj_net_poll_handle_t *out_handle,
+                                  bool *out_data_pending) {
+    assert(ctx && out_handle && out_data_pending);
+    if (!ctx->net_ctx) {
+        return _ANJ_SRV_CONN_GENERIC_ERROR;
+    }
+    *out_data_pending = false;
+    return anj_net_get_poll_handle(ctx->type, ctx->net_ctx, out_handle,
+                                   out_data_pending);
+}
+#endif // ANJ_NET_WITH_POLL_HANDLE
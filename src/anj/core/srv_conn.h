@@ -21,6 +21,21 @@
 #    include <anj/defs.h>
 #    include <anj/time.h>
 
+/**
+ * Creates the network socket context, if it doesn't exist yet. Called by
+ * @ref _anj_srv_conn_connect, may be called earlier if the context has to be
+ * set up before connecting.
+ *
+ * @param ctx              Server connection context.
+ * @param type             Type of the network socket.
+ * @param net_socket_cfg   Pointer to the network socket configuration, or NULL.
+ *
+ * @return @ref ANJ_NET_OK on success, a negative value in case of an error.
+ */
+int _anj_srv_conn_create(_anj_server_connection_ctx_t *ctx,
+                         anj_net_binding_type_t type,
+                         const anj_net_config_t *net_socket_cfg);
+
 /**
  * Establishes a connection to the server. If @ref ANJ_NET_EINPROGRESS is
  * returned, this function must be called again with the same arguments.
@@ -68,6 +83,29 @@ int _anj_srv_conn_send(_anj_server_connection_ctx_t *ctx,
                        const uint8_t *buffer,
                        size_t length);
 
+#    ifdef ANJ_NET_WITH_SEND_VEC
+/**
+ * Works like @ref _anj_srv_conn_send, but sends the message made of
+ * @p header directly followed by @p payload, without copying them into a
+ * single buffer.
+ *
+ * @param ctx            Server connection context.
+ * @param header         Pointer to the encoded CoAP header and options.
+ * @param header_length  Length of the header.
+ * @param payload        Pointer to the payload, may be NULL if
+ *                       @p payload_length is 0.
+ * @param payload_length Length of the payload.
+ *
+ * @return @ref ANJ_NET_OK or @ref ANJ_NET_EINPROGRESS on success, a negative
+ *         value in case of an error.
+ */
+int _anj_srv_conn_send_vec(_anj_server_connection_ctx_t *ctx,
+                           const uint8_t *header,
+                           size_t header_length,
+                           const uint8_t *payload,
+                           size_t payload_length);
+#    endif // ANJ_NET_WITH_SEND_VEC
+
 /**
  * Receives a message from the server. If this function returns error,
  * connection must be closed. @ref ANJ_NET_OK returned means that new message
@@ -96,6 +134,11 @@ int _anj_srv_conn_receive(_anj_server_connection_ctx_t *ctx,
  * @param      payload_buff_size   Size of the payload buffer.
  * @param      out_msg_buffer_size Size of the message buffer.
  * @param      server_request      Indicates if the message is a server request.
+ * @param      security_overhead   Number of bytes the message grows by when it
+ *                                 is protected at the message layer, see
+ *                                 @ref ANJ_WITH_OSCORE. If non-zero, the
+ *                                 payload is never sent separately from the
+ *                                 header.
  * @param[out] out_payload_size    Pointer to the calculated payload size.
  *
  * @return 0 on success, a negative value in case of an error.
@@ -105,8 +148,111 @@ int _anj_srv_conn_calculate_max_payload_size(_anj_server_connection_ctx_t *ctx,
                                              size_t payload_buff_size,
                                              size_t out_msg_buffer_size,
                                              bool server_request,
+                                             size_t security_overhead,
                                              size_t *out_payload_size);
 
+#ifdef ANJ_WITH_PMTU_PROBING
+/**
+ * Starts Path MTU probing for a newly set up connection with the LwM2M Server.
+ * The MTU confirmed and lost in the previous connections with the same server
+ * is kept, as long as it doesn't exceed the MTU reported by the network layer.
+ * <c>ctx->mtu</c> is replaced with the size of the next probe, or with the
+ * discovered MTU once the search is finished. Only UDP and DTLS connections
+ * are probed.
+ *
+ * @param pmtu         Path MTU probing state.
+ * @param ctx          Connected server connection context.
+ * @param security_iid Security Object Instance ID of the server.
+ */
+void _anj_srv_conn_pmtu_connected(_anj_srv_conn_pmtu_t *pmtu,
+                                  _anj_server_connection_ctx_t *ctx,
+                                  anj_iid_t security_iid);
+
+/**
+ * Records the size of a datagram of the ongoing Confirmable client request.
+ *
+ * @param pmtu     Path MTU probing state.
+ * @param msg_size Size of the sent datagram.
+ */
+void _anj_srv_conn_pmtu_sent(_anj_srv_conn_pmtu_t *pmtu, size_t msg_size);
+
+/**
+ * Updates the search after a client request is finished. A response from the
+ * server confirms the largest datagram sent, a timeout marks it as lost. A
+ * timeout of a datagram not larger than the confirmed MTU means that the path
+ * has changed, so the search starts again from the minimal MTU.
+ *
+ * @param pmtu   Path MTU probing state.
+ * @param ctx    Server connection context, <c>ctx->mtu</c> is updated.
+ * @param result Result of the exchange.
+ */
+void _anj_srv_conn_pmtu_finished(_anj_srv_conn_pmtu_t *pmtu,
+                                 _anj_server_connection_ctx_t *ctx,
+                                 int result);
+#endif // ANJ_WITH_PMTU_PROBING
+
+#ifdef ANJ_WITH_NAT_KEEPALIVE_PROBING
+/**
+ * Starts the search for the NAT binding timeout. Zero bounds are replaced with
+ * the defaults.
+ *
+ * @param nat NAT binding timeout search state.
+ * @param min Idle time after which the binding is assumed to exist.
+ * @param max Longest idle time the search may end with.
+ */
+void _anj_srv_conn_nat_init(_anj_srv_conn_nat_t *nat,
+                            anj_time_duration_t min,
+                            anj_time_duration_t max);
+
+/**
+ * Returns the idle time after which the binding should be refreshed: the
+ * middle of the range of times not known to be confirmed or lost, or the
+ * confirmed time once the search is finished.
+ *
+ * @param nat NAT binding timeout search state.
+ */
+anj_time_duration_t
+_anj_srv_conn_nat_interval(const _anj_srv_conn_nat_t *nat);
+
+/**
+ * Marks the end of an exchange with the server, the idle time is counted from
+ * it.
+ *
+ * @param nat NAT binding timeout search state.
+ * @param now Current time.
+ */
+void _anj_srv_conn_nat_traffic(_anj_srv_conn_nat_t *nat,
+                               anj_time_monotonic_t now);
+
+/**
+ * Updates the search after a message from the server is received while the
+ * connection is idle: the binding has survived the idle time before it.
+ *
+ * @param nat NAT binding timeout search state.
+ * @param now Current time.
+ */
+void _anj_srv_conn_nat_received(_anj_srv_conn_nat_t *nat,
+                                anj_time_monotonic_t now);
+
+/**
+ * Records the idle time before a client request, used if the request fails.
+ *
+ * @param nat NAT binding timeout search state.
+ * @param now Current time.
+ */
+void _anj_srv_conn_nat_client_request(_anj_srv_conn_nat_t *nat,
+                                      anj_time_monotonic_t now);
+
+/**
+ * Updates the search after the connection is lost: if it happened during the
+ * first client request after an idle time, the binding is assumed to have
+ * expired during that time.
+ *
+ * @param nat NAT binding timeout search state.
+ */
+void _anj_srv_conn_nat_lost(_anj_srv_conn_nat_t *nat);
+#endif // ANJ_WITH_NAT_KEEPALIVE_PROBING
+
 /**
  * Handles the LwM2M request. If @ref ANJ_NET_EAGAIN or @ref ANJ_NET_EINPROGRESS
  * is returned, this function must be called again. If different value is
@@ -158,6 +304,111 @@ int _anj_srv_conn_prepare_server_request(anj_t *anj,
                                          uint8_t response_code,
                                          _anj_exchange_handlers_t *handlers);
 
+#ifdef ANJ_WITH_PIPELINED_NOTIFICATIONS
+/**
+ * Looks for a pipelined exchange context without an ongoing exchange. There
+ * are @ref ANJ_PIPELINED_NOTIFICATIONS_NSTART - 1 of them, which limits the
+ * number of outstanding Confirmable requests.
+ *
+ * @param anj Anjay instance.
+ *
+ * @return Free pipelined exchange context, NULL if there is none.
+ */
+_anj_pipelined_exchange_t *_anj_srv_conn_free_pipelined_exchange(anj_t *anj);
+
+/**
+ * Starts new LwM2M client request in the @p pipelined exchange context, next
+ * to the main exchange context which waits for a response or has no ongoing
+ * exchange. Single message is encoded and must be sent right away with
+ * @ref _anj_srv_conn_handle_pipelined_requests. Block-Wise request is kept
+ * until @ref _anj_srv_conn_take_over_pipelined_request is called, there may be
+ * only one such request.
+ *
+ * @param anj         Anjay instance.
+ * @param pipelined   Free pipelined exchange context.
+ * @param new_request Pointer to the CoAP message.
+ * @param handlers    Pointer to the exchange handlers.
+ *
+ * @return 0 on success, a negative value in case of an error.
+ */
+int _anj_srv_conn_prepare_pipelined_request(anj_t *anj,
+                                            _anj_pipelined_exchange_t *pipelined,
+                                            _anj_coap_msg_t *new_request,
+                                            _anj_exchange_handlers_t *handlers);
+
+/**
+ * Continues the exchanges in the pipelined exchange contexts: sends prepared
+ * messages and retransmissions, and checks for timeouts. The output buffer is
+ * used only if the main exchange context doesn't keep a message there.
+ *
+ * Errors finish the affected exchange only, they are not relevant for the main
+ * exchange.
+ *
+ * @param anj Anjay instance.
+ *
+ * @return 0 or @ref ANJ_NET_EINPROGRESS if a message is being sent and the
+ *         output buffer must not be used until this function is called again.
+ */
+int _anj_srv_conn_handle_pipelined_requests(anj_t *anj);
+
+/**
+ * Passes @p msg to the pipelined exchange context it responds to. Must be
+ * called for each incoming message before it's processed otherwise.
+ *
+ * @param anj Anjay instance.
+ * @param msg Decoded incoming message.
+ *
+ * @return true if @p msg has been consumed.
+ */
+bool _anj_srv_conn_handle_pipelined_response(anj_t *anj,
+                                             _anj_coap_msg_t *msg);
+
+/**
+ * Checks if any request in the pipelined exchange contexts is sent and not
+ * finished yet.
+ *
+ * @param anj Anjay instance.
+ */
+bool _anj_srv_conn_pipelined_requests_ongoing(anj_t *anj);
+
+/**
+ * Returns the earliest point in time at which
+ * @ref _anj_srv_conn_handle_pipelined_requests has to be called, because of
+ * a retransmission or a timeout.
+ *
+ * @param anj Anjay instance.
+ *
+ * @return ANJ_TIME_MONOTONIC_INVALID if there is no such request.
+ */
+anj_time_monotonic_t _anj_srv_conn_pipelined_requests_timeout(anj_t *anj);
+
+/**
+ * Checks if there is a request in the pipelined exchange contexts that waits
+ * for the main exchange context to become free.
+ *
+ * @param anj Anjay instance.
+ */
+bool _anj_srv_conn_pipelined_request_deferred(anj_t *anj);
+
+/**
+ * Moves the deferred request to the main exchange context, which must not have
+ * an ongoing exchange, and prepares it to be sent with
+ * @ref _anj_srv_conn_handle_request.
+ *
+ * @param anj Anjay instance.
+ *
+ * @return 0 on success, a negative value in case of an error.
+ */
+int _anj_srv_conn_take_over_pipelined_request(anj_t *anj);
+
+/**
+ * Terminates the exchanges in all pipelined exchange contexts.
+ *
+ * @param anj Anjay instance.
+ */
+void _anj_srv_conn_terminate_pipelined_requests(anj_t *anj);
+#endif // ANJ_WITH_PIPELINED_NOTIFICATIONS
+
 /**
  * Calculates MAX_TRANSMIT_WAIT based on the given CoAP transmission parameters.
  *
@@ -177,4 +428,32 @@ anj_time_duration_t _anj_srv_conn_calculate_max_transmit_wait(
  */
 int _anj_srv_conn_queue_mode_rx_off(_anj_server_connection_ctx_t *ctx);
 
+#    ifdef ANJ_NET_WITH_RELEASE_ASSISTANCE
+/**
+ * Tells the network layer how much more traffic is expected on the server
+ * connection. Failures are only logged, since it's just a hint.
+ *
+ * @param ctx  Server connection context.
+ * @param hint Traffic expected on the connection.
+ */
+void _anj_srv_conn_release_assistance(_anj_server_connection_ctx_t *ctx,
+                                      anj_net_release_hint_t hint);
+#    endif // ANJ_NET_WITH_RELEASE_ASSISTANCE
+
+#    ifdef ANJ_NET_WITH_POLL_HANDLE
+/**
+ * Gets the handle to wait on for incoming messages of the server connection.
+ *
+ * @param      ctx              Server connection context.
+ * @param[out] out_handle       Handle to wait on.
+ * @param[out] out_data_pending Set to true if a message can be received
+ *                              without waiting.
+ *
+ * @return 0 on success, a non-zero value if the handle is not available.
+ */
+int _anj_srv_conn_get_poll_handle(_anj_server_connection_ctx_t *ctx,
+                                  anj_net_poll_handle_t *out_handle,
+                                  bool *out_data_pending);
+#    endif // ANJ_NET_WITH_POLL_HANDLE
+
 #endif // ANJ_SRC_CORE_SRV_CONN_H
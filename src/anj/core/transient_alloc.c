@@ -0,0 +1,89 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#define ANJ_LOG_SOURCE_FILE_ID 81
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/core.h>
+#include <anj/log.h>
+
+#include "core_utils.h"
+#include "transient_alloc.h"
+
+#ifdef ANJ_WITH_TRANSIENT_ALLOC
+
+int anj_block_pool_init(anj_block_pool_t *pool,
+                        void *memory,
+                        size_t memory_size,
+                        size_t block_size) {
+    assert(pool && memory);
+    size_t aligned_block_size = ANJ_BLOCK_POOL_BLOCK_SIZE(block_size);
+    if ((uintptr_t) memory % _ANJ_BLOCK_POOL_ALIGN
+            || memory_size < aligned_block_size) {
+        log(L_ERROR, "Invalid block pool parameters");
+        return -1;
+    }
+    pool->free_blocks = NULL;
+    pool->block_size = block_size;
+    uint8_t *block = (uint8_t *) memory;
+    // blocks are aligned, so links can be accessed directly
+    for (size_t i = 0; i < memory_size / aligned_block_size; i++) {
+        *(void **) block = pool->free_blocks;
+        pool->free_blocks = block;
+        block += aligned_block_size;
+    }
+    return 0;
+}
+
+void *anj_block_pool_alloc(void *pool, size_t size) {
+    assert(pool);
+    anj_block_pool_t *block_pool = (anj_block_pool_t *) pool;
+    void *block = block_pool->free_blocks;
+    if (size > block_pool->block_size || !block) {
+        return NULL;
+    }
+    block_pool->free_blocks = *(void **) block;
+    return block;
+}
+
+void anj_block_pool_free(void *pool, void *ptr) {
+    assert(pool);
+    anj_block_pool_t *block_pool = (anj_block_pool_t *) pool;
+    if (ptr) {
+        *(void **) ptr = block_pool->free_blocks;
+        block_pool->free_blocks = ptr;
+    }
+}
+
+void *_anj_transient_alloc(anj_t *anj, size_t size) {
+    assert(anj && size <= ANJ_TRANSIENT_ALLOC_MAX_SIZE);
+    void *ptr = anj->transient_alloc
+                        ? anj->transient_alloc(anj->transient_alloc_arg, size)
+                        : NULL;
+    if (!ptr) {
+        log(L_WARNING, "No memory for a transient buffer of %zu bytes", size);
+    }
+    return ptr;
+}
+
+void _anj_transient_free(anj_t *anj, void *ptr) {
+    assert(anj);
+    if (ptr) {
+        assert(anj->transient_free);
+        anj->transient_free(anj->transient_alloc_arg, ptr);
+    }
+}
+
+#endif // ANJ_WITH_TRANSIENT_ALLOC
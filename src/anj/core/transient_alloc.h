@@ -0,0 +1,43 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#ifndef ANJ_SRC_CORE_TRANSIENT_ALLOC_H
+#    define ANJ_SRC_CORE_TRANSIENT_ALLOC_H
+
+#    include <stddef.h>
+
+#    include <anj/core.h>
+
+#    ifdef ANJ_WITH_TRANSIENT_ALLOC
+
+/**
+ * Allocates a buffer with @ref anj_configuration_t::transient_alloc. It must be
+ * released with @ref _anj_transient_free before @ref anj_core_step returns.
+ *
+ * @param anj  Anjay object.
+ * @param size Size of the buffer, at most @ref ANJ_TRANSIENT_ALLOC_MAX_SIZE.
+ *
+ * @return Allocated buffer, or NULL if no allocator is configured or it has no
+ *         memory available.
+ */
+void *_anj_transient_alloc(anj_t *anj, size_t size);
+
+/**
+ * Releases a buffer returned by @ref _anj_transient_alloc.
+ *
+ * @param anj Anjay object.
+ * @param ptr Buffer to release, or NULL.
+ */
+void _anj_transient_free(anj_t *anj, void *ptr);
+
+#    endif // ANJ_WITH_TRANSIENT_ALLOC
+
+#endif // ANJ_SRC_CORE_TRANSIENT_ALLOC_H
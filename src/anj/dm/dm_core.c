@@ -24,8 +24,10 @@
 #include <anj/utils.h>
 
 #include "../core/core.h"
+#include "../trace.h"
 #include "../utils.h"
 #include "dm_core.h"
+#include "dm_integration.h"
 #include "dm_io.h"
 
 bool _anj_dm_is_readable_resource(anj_dm_res_kind_t kind) {
@@ -39,21 +41,73 @@ bool _anj_dm_is_writable_resource(anj_dm_res_kind_t kind, bool is_bootstrap) {
            || (is_bootstrap && kind != ANJ_DM_RES_E);
 }
 
-uint16_t _anj_dm_count_res_insts(const anj_dm_res_t *res) {
+#ifdef ANJ_DM_WITH_RES_INST_BITMAP
+static uint16_t bitmap_popcount(uint32_t word) {
+#    if defined(__GNUC__) || defined(__clang__)
+    return (uint16_t) __builtin_popcount(word);
+#    else  // defined(__GNUC__) || defined(__clang__)
     uint16_t count = 0;
-    for (uint16_t idx = 0; idx < res->max_inst_count; idx++) {
-        if (res->insts[idx] == ANJ_ID_INVALID) {
-            break;
-        }
+    for (; word; word &= word - 1) {
         count++;
     }
     return count;
+#    endif // defined(__GNUC__) || defined(__clang__)
 }
 
-uint16_t _anj_dm_count_obj_insts(const anj_dm_obj_t *obj) {
+// word must not be 0
+static uint16_t bitmap_ctz(uint32_t word) {
+#    if defined(__GNUC__) || defined(__clang__)
+    return (uint16_t) __builtin_ctz(word);
+#    else  // defined(__GNUC__) || defined(__clang__)
     uint16_t count = 0;
-    for (uint16_t idx = 0; idx < obj->max_inst_count; idx++) {
-        if (obj->insts[idx].iid == ANJ_ID_INVALID) {
+    for (; !(word & 1); word >>= 1) {
+        count++;
+    }
+    return count;
+#    endif // defined(__GNUC__) || defined(__clang__)
+}
+#endif // ANJ_DM_WITH_RES_INST_BITMAP
+
+/* Defines Name(), returning the index of the first of count elements of arr,
+ * sorted by ID, whose ID (arr[idx] followed by Member) is not lower than id. */
+#define DEFINE_FIND_ID_IDX(Name, Arr_type, Member)                            \
+    static uint16_t Name(Arr_type arr, uint16_t count, uint16_t id) {         \
+        uint16_t begin = 0;                                                   \
+        uint16_t end = count;                                                 \
+        while (begin < end) {                                                 \
+            uint16_t mid = (uint16_t) (begin + (end - begin) / 2);            \
+            if (arr[mid] Member < id) {                                       \
+                begin = (uint16_t) (mid + 1);                                 \
+            } else {                                                          \
+                end = mid;                                                    \
+            }                                                                 \
+        }                                                                     \
+        return begin;                                                         \
+    }
+
+DEFINE_FIND_ID_IDX(find_obj_ptr_idx, const anj_dm_obj_t *const *, ->oid)
+DEFINE_FIND_ID_IDX(find_inst_idx, const anj_dm_obj_inst_t *, .iid)
+DEFINE_FIND_ID_IDX(find_res_idx, const anj_dm_res_t *, .rid)
+// arrays of IIDs or RIIDs
+DEFINE_FIND_ID_IDX(find_id_idx, const uint16_t *, )
+
+uint16_t _anj_dm_count_res_insts(const anj_dm_obj_inst_t *inst,
+                                 const anj_dm_res_t *res) {
+#ifdef ANJ_DM_WITH_RES_INST_BITMAP
+    if (res->insts_bitmap) {
+        uint16_t count = 0;
+        for (size_t idx = 0;
+             idx < ANJ_DM_RES_INST_BITMAP_SIZE((size_t) res->max_inst_count);
+             idx++) {
+            count = (uint16_t) (count + bitmap_popcount(res->insts_bitmap[idx]));
+        }
+        return count;
+    }
+#endif // ANJ_DM_WITH_RES_INST_BITMAP
+    const anj_riid_t *insts = _anj_dm_res_insts(inst, res);
+    uint16_t count = 0;
+    for (uint16_t idx = 0; idx < res->max_inst_count; idx++) {
+        if (insts[idx] == ANJ_ID_INVALID) {
             break;
         }
         count++;
@@ -61,50 +115,203 @@ uint16_t _anj_dm_count_obj_insts(const anj_dm_obj_t *obj) {
     return count;
 }
 
-const anj_dm_obj_t *_anj_dm_find_obj(_anj_dm_data_model_t *dm, anj_oid_t oid) {
-    for (uint16_t idx = 0; idx < dm->objs_count; idx++) {
-        if (dm->objs[idx]->oid == oid) {
-            return dm->objs[idx];
-        } else if (dm->objs[idx]->oid > oid) {
-            break;
+uint16_t _anj_dm_count_insts(const anj_dm_obj_inst_t *insts,
+                             uint16_t max_inst_count) {
+    // used slots are followed by ANJ_ID_INVALID ones, see _anj_dm_find_inst
+    return _anj_dm_find_inst_idx(insts, max_inst_count, ANJ_ID_INVALID);
+}
+
+uint16_t _anj_dm_count_obj_insts(const anj_dm_obj_t *obj) {
+#ifdef ANJ_DM_WITH_LAZY_INSTS
+    if (_anj_dm_is_lazy_obj(obj)) {
+        uint16_t count = 0;
+        for (const anj_dm_obj_inst_t *inst = _anj_dm_first_inst(obj);
+             inst && count < UINT16_MAX;
+             inst = _anj_dm_next_inst(obj, inst->iid)) {
+            count++;
         }
+        return count;
     }
-    return NULL;
+#endif // ANJ_DM_WITH_LAZY_INSTS
+    return _anj_dm_count_insts(obj->insts, obj->max_inst_count);
 }
 
-static const anj_dm_obj_inst_t *_anj_dm_find_inst(const anj_dm_obj_t *obj,
-                                                  anj_iid_t iid) {
-    for (uint16_t idx = 0; idx < obj->max_inst_count; idx++) {
-        if (obj->insts[idx].iid == iid) {
-            return &obj->insts[idx];
-        } else if (obj->insts[idx].iid > iid) {
-            break;
+uint16_t _anj_dm_find_inst_idx(const anj_dm_obj_inst_t *insts,
+                               uint16_t inst_count,
+                               anj_iid_t iid) {
+    return find_inst_idx(insts, inst_count, iid);
+}
+
+/* IIDs are sorted and unique, so insts[idx].iid >= idx for each used slot, and
+ * the lowest free IID is the first idx for which the inequality is strict. */
+anj_iid_t _anj_dm_find_free_iid(const anj_dm_obj_inst_t *insts,
+                                uint16_t inst_count) {
+    uint16_t begin = 0;
+    uint16_t end = inst_count;
+    while (begin < end) {
+        uint16_t mid = (uint16_t) (begin + (end - begin) / 2);
+        if (insts[mid].iid == mid) {
+            begin = (uint16_t) (mid + 1);
+        } else {
+            end = mid;
         }
     }
+    return begin;
+}
+
+uint16_t _anj_dm_find_obj_idx(_anj_dm_data_model_t *dm, anj_oid_t oid) {
+    return find_obj_ptr_idx(dm->objs, dm->objs_count, oid);
+}
+
+const anj_dm_obj_t *_anj_dm_find_obj(_anj_dm_data_model_t *dm, anj_oid_t oid) {
+    uint16_t idx = _anj_dm_find_obj_idx(dm, oid);
+    if (idx < dm->objs_count && dm->objs[idx]->oid == oid) {
+        return dm->objs[idx];
+    }
     return NULL;
 }
 
+/* Unused slots of the insts array are filled with ANJ_ID_INVALID, which is
+ * the highest possible ID, so the whole array is sorted and can be
+ * bisected. */
+const anj_dm_obj_inst_t *_anj_dm_find_inst(const anj_dm_obj_t *obj,
+                                           anj_iid_t iid) {
+    if (!obj->max_inst_count) {
+        return NULL;
+    }
+#ifdef ANJ_DM_WITH_LAZY_INSTS
+    if (_anj_dm_is_lazy_obj(obj)) {
+        return iid == ANJ_ID_INVALID ? NULL
+                                     : obj->handlers->inst_lookup(obj, iid);
+    }
+#endif // ANJ_DM_WITH_LAZY_INSTS
+#ifdef ANJ_DM_WITH_DENSE_ID_LOOKUP
+    if (iid >= obj->insts[0].iid) {
+        uint32_t guess = (uint32_t) (iid - obj->insts[0].iid);
+        if (guess < obj->max_inst_count && obj->insts[guess].iid == iid) {
+            return &obj->insts[guess];
+        }
+    }
+#endif // ANJ_DM_WITH_DENSE_ID_LOOKUP
+    uint16_t idx = _anj_dm_find_inst_idx(obj->insts, obj->max_inst_count, iid);
+    return idx < obj->max_inst_count && obj->insts[idx].iid == iid
+                   ? &obj->insts[idx]
+                   : NULL;
+}
+
+const anj_dm_obj_inst_t *_anj_dm_first_inst(const anj_dm_obj_t *obj) {
+    if (!obj->max_inst_count) {
+        return NULL;
+    }
+#ifdef ANJ_DM_WITH_LAZY_INSTS
+    if (_anj_dm_is_lazy_obj(obj)) {
+        return obj->handlers->inst_first(obj);
+    }
+#endif // ANJ_DM_WITH_LAZY_INSTS
+    return obj->insts[0].iid != ANJ_ID_INVALID ? &obj->insts[0] : NULL;
+}
+
+const anj_dm_obj_inst_t *_anj_dm_next_inst(const anj_dm_obj_t *obj,
+                                           anj_iid_t iid) {
+    assert(iid != ANJ_ID_INVALID);
+#ifdef ANJ_DM_WITH_LAZY_INSTS
+    if (_anj_dm_is_lazy_obj(obj)) {
+        return obj->handlers->inst_next(obj, iid);
+    }
+#endif // ANJ_DM_WITH_LAZY_INSTS
+    uint16_t idx = _anj_dm_find_inst_idx(obj->insts, obj->max_inst_count,
+                                         (anj_iid_t) (iid + 1));
+    return idx < obj->max_inst_count && obj->insts[idx].iid != ANJ_ID_INVALID
+                   ? &obj->insts[idx]
+                   : NULL;
+}
+
 static const anj_dm_res_t *_anj_dm_find_res(const anj_dm_obj_inst_t *inst,
                                             anj_rid_t rid) {
-    for (uint16_t idx = 0; idx < inst->res_count; idx++) {
-        if (inst->resources[idx].rid == rid) {
-            return &inst->resources[idx];
-        } else if (inst->resources[idx].rid > rid) {
-            break;
+    if (!inst->res_count) {
+        return NULL;
+    }
+#ifdef ANJ_DM_WITH_RID_INDEX
+    if (inst->rid_index) {
+        uint32_t offset = (uint32_t) (rid - inst->rid_index_first);
+        if (rid < inst->rid_index_first || offset >= inst->rid_index_size
+                || !inst->rid_index[offset]) {
+            return NULL;
         }
+        const anj_dm_res_t *res = &inst->resources[inst->rid_index[offset] - 1];
+        assert(inst->rid_index[offset] <= inst->res_count && res->rid == rid);
+        return res;
     }
-    return NULL;
+#endif // ANJ_DM_WITH_RID_INDEX
+#ifdef ANJ_DM_WITH_DENSE_ID_LOOKUP
+    if (rid >= inst->resources[0].rid) {
+        uint32_t guess = (uint32_t) (rid - inst->resources[0].rid);
+        if (guess < inst->res_count && inst->resources[guess].rid == rid) {
+            return &inst->resources[guess];
+        }
+    }
+#endif // ANJ_DM_WITH_DENSE_ID_LOOKUP
+    uint16_t idx = find_res_idx(inst->resources, inst->res_count, rid);
+    return idx < inst->res_count && inst->resources[idx].rid == rid
+                   ? &inst->resources[idx]
+                   : NULL;
 }
 
-bool _anj_dm_res_inst_exists(const anj_dm_res_t *res, anj_riid_t riid) {
-    for (uint16_t idx = 0; idx < res->max_inst_count; idx++) {
-        if (res->insts[idx] == riid) {
+bool _anj_dm_res_inst_exists(const anj_dm_obj_inst_t *inst,
+                             const anj_dm_res_t *res,
+                             anj_riid_t riid) {
+    if (!res->max_inst_count) {
+        return false;
+    }
+#ifdef ANJ_DM_WITH_RES_INST_BITMAP
+    if (res->insts_bitmap) {
+        return riid < res->max_inst_count
+               && (res->insts_bitmap[riid / 32] & (UINT32_C(1) << (riid % 32)));
+    }
+#endif // ANJ_DM_WITH_RES_INST_BITMAP
+    const anj_riid_t *insts = _anj_dm_res_insts(inst, res);
+#ifdef ANJ_DM_WITH_DENSE_ID_LOOKUP
+    if (riid >= insts[0]) {
+        uint32_t guess = (uint32_t) (riid - insts[0]);
+        if (guess < res->max_inst_count && insts[guess] == riid) {
             return true;
-        } else if (res->insts[idx] > riid) {
-            break;
         }
     }
-    return false;
+#endif // ANJ_DM_WITH_DENSE_ID_LOOKUP
+    uint16_t idx = find_id_idx(insts, res->max_inst_count, riid);
+    return idx < res->max_inst_count && insts[idx] == riid;
+}
+
+anj_riid_t _anj_dm_next_res_inst(const anj_dm_obj_inst_t *inst,
+                                 const anj_dm_res_t *res,
+                                 uint16_t *cursor) {
+    if (*cursor >= res->max_inst_count) {
+        return ANJ_ID_INVALID;
+    }
+#ifdef ANJ_DM_WITH_RES_INST_BITMAP
+    if (res->insts_bitmap) {
+        size_t idx = *cursor / 32;
+        // clear bits of IDs lower than the cursor
+        uint32_t word = res->insts_bitmap[idx]
+                        & (UINT32_MAX << (*cursor % 32));
+        while (!word) {
+            if (++idx >= ANJ_DM_RES_INST_BITMAP_SIZE(
+                                 (size_t) res->max_inst_count)) {
+                *cursor = res->max_inst_count;
+                return ANJ_ID_INVALID;
+            }
+            word = res->insts_bitmap[idx];
+        }
+        anj_riid_t riid = (anj_riid_t) (idx * 32 + bitmap_ctz(word));
+        *cursor = (uint16_t) (riid + 1);
+        return riid;
+    }
+#endif // ANJ_DM_WITH_RES_INST_BITMAP
+    anj_riid_t riid = _anj_dm_res_insts(inst, res)[*cursor];
+    if (riid != ANJ_ID_INVALID) {
+        (*cursor)++;
+    }
+    return riid;
 }
 
 int _anj_dm_call_transaction_begin(anj_t *anj, const anj_dm_obj_t *obj) {
@@ -118,17 +325,14 @@ int _anj_dm_get_obj_ptr_ensure_transaction_begin(anj_t *anj,
                                                  anj_oid_t oid,
                                                  const anj_dm_obj_t **out_obj) {
     _anj_dm_data_model_t *dm = &anj->dm;
-    for (uint16_t idx = 0; idx < dm->objs_count; idx++) {
-        if (dm->objs[idx]->oid == oid) {
-            *out_obj = dm->objs[idx];
-            if (!dm->in_transaction[idx]) {
-                dm->in_transaction[idx] = true;
-                return _anj_dm_call_transaction_begin(anj, *out_obj);
-            }
-            return 0;
-        } else if (dm->objs[idx]->oid > oid) {
-            break;
+    uint16_t idx = _anj_dm_find_obj_idx(dm, oid);
+    if (idx < dm->objs_count && dm->objs[idx]->oid == oid) {
+        *out_obj = dm->objs[idx];
+        if (!dm->in_transaction[idx]) {
+            dm->in_transaction[idx] = true;
+            return _anj_dm_call_transaction_begin(anj, *out_obj);
         }
+        return 0;
     }
     dm_log(L_ERROR, "Object /%" PRIu16 " not found in data model", oid);
     return ANJ_DM_ERR_NOT_FOUND;
@@ -169,7 +373,7 @@ int _anj_dm_get_obj_ptrs(const anj_dm_obj_t *obj,
         return ANJ_DM_ERR_NOT_FOUND;
     }
 
-    if (!_anj_dm_res_inst_exists(res, path->ids[ANJ_ID_RIID])) {
+    if (!_anj_dm_res_inst_exists(inst, res, path->ids[ANJ_ID_RIID])) {
         dm_log(L_WARNING, "Resource Instance not found");
         return ANJ_DM_ERR_NOT_FOUND;
     }
@@ -184,9 +388,9 @@ finalize:
     return 0;
 }
 
-int _anj_dm_get_entity_ptrs(_anj_dm_data_model_t *dm,
-                            const anj_uri_path_t *path,
-                            _anj_dm_entity_ptrs_t *out_ptrs) {
+static int resolve_entity_ptrs(_anj_dm_data_model_t *dm,
+                               const anj_uri_path_t *path,
+                               _anj_dm_entity_ptrs_t *out_ptrs) {
     assert(anj_uri_path_has(path, ANJ_ID_OID));
     const anj_dm_obj_t *obj = _anj_dm_find_obj(dm, path->ids[ANJ_ID_OID]);
     if (!obj) {
@@ -196,6 +400,290 @@ int _anj_dm_get_entity_ptrs(_anj_dm_data_model_t *dm,
     return _anj_dm_get_obj_ptrs(obj, path, out_ptrs);
 }
 
+#ifdef ANJ_DM_WITH_INST_ARRAY
+anj_iid_t anj_dm_inst_array_find_free_iid(const anj_dm_obj_inst_t *insts,
+                                          uint16_t max_inst_count) {
+    assert(insts || !max_inst_count);
+    uint16_t inst_count = _anj_dm_count_insts(insts, max_inst_count);
+    if (inst_count >= max_inst_count) {
+        return ANJ_ID_INVALID;
+    }
+    return _anj_dm_find_free_iid(insts, inst_count);
+}
+
+int anj_dm_inst_array_insert(anj_dm_obj_inst_t *insts,
+                             uint16_t max_inst_count,
+                             const anj_dm_obj_inst_t *inst) {
+    assert((insts || !max_inst_count) && inst);
+    assert(inst->iid != ANJ_ID_INVALID);
+    uint16_t inst_count = _anj_dm_count_insts(insts, max_inst_count);
+    if (inst_count >= max_inst_count) {
+        dm_log(L_ERROR, "Maximum number of instances reached");
+        return ANJ_DM_ERR_METHOD_NOT_ALLOWED;
+    }
+    uint16_t idx = _anj_dm_find_inst_idx(insts, inst_count, inst->iid);
+    if (idx < inst_count && insts[idx].iid == inst->iid) {
+        dm_log(L_ERROR, "Instance already exists");
+        return ANJ_DM_ERR_BAD_REQUEST;
+    }
+    memmove(&insts[idx + 1], &insts[idx],
+            (size_t) (inst_count - idx) * sizeof(*insts));
+    insts[idx] = *inst;
+    return 0;
+}
+
+int anj_dm_inst_array_remove(anj_dm_obj_inst_t *insts,
+                             uint16_t max_inst_count,
+                             anj_iid_t iid) {
+    assert(insts || !max_inst_count);
+    uint16_t inst_count = _anj_dm_count_insts(insts, max_inst_count);
+    uint16_t idx = _anj_dm_find_inst_idx(insts, inst_count, iid);
+    if (idx >= inst_count || insts[idx].iid != iid) {
+        return ANJ_DM_ERR_NOT_FOUND;
+    }
+    memmove(&insts[idx], &insts[idx + 1],
+            (size_t) (inst_count - idx - 1) * sizeof(*insts));
+    insts[inst_count - 1].iid = ANJ_ID_INVALID;
+    return 0;
+}
+#endif // ANJ_DM_WITH_INST_ARRAY
+
+#ifdef ANJ_DM_WITH_SHARED_OBJ_DEFS
+static uint16_t find_iid_idx(const anj_iid_t *iids,
+                             uint16_t inst_count,
+                             anj_iid_t iid) {
+    return find_id_idx(iids, inst_count, iid);
+}
+
+static const anj_dm_obj_inst_t *
+materialize_shared_inst(const anj_dm_obj_t *obj, uint16_t idx) {
+    anj_dm_shared_obj_t *shared_obj =
+            ANJ_CONTAINER_OF(obj, anj_dm_shared_obj_t, obj);
+    if (idx >= obj->max_inst_count || shared_obj->iids[idx] == ANJ_ID_INVALID) {
+        return NULL;
+    }
+    shared_obj->inst = *shared_obj->inst_def;
+    shared_obj->inst.iid = shared_obj->iids[idx];
+    return &shared_obj->inst;
+}
+
+const anj_dm_obj_inst_t *anj_dm_shared_obj_inst_lookup(const anj_dm_obj_t *obj,
+                                                       anj_iid_t iid) {
+    const anj_iid_t *iids =
+            ANJ_CONTAINER_OF(obj, anj_dm_shared_obj_t, obj)->iids;
+    uint16_t idx = find_iid_idx(iids, obj->max_inst_count, iid);
+    return idx < obj->max_inst_count && iids[idx] == iid
+                   ? materialize_shared_inst(obj, idx)
+                   : NULL;
+}
+
+const anj_dm_obj_inst_t *anj_dm_shared_obj_inst_first(const anj_dm_obj_t *obj) {
+    return materialize_shared_inst(obj, 0);
+}
+
+const anj_dm_obj_inst_t *anj_dm_shared_obj_inst_next(const anj_dm_obj_t *obj,
+                                                     anj_iid_t iid) {
+    assert(iid != ANJ_ID_INVALID);
+    const anj_iid_t *iids =
+            ANJ_CONTAINER_OF(obj, anj_dm_shared_obj_t, obj)->iids;
+    return materialize_shared_inst(
+            obj, find_iid_idx(iids, obj->max_inst_count, (anj_iid_t) (iid + 1)));
+}
+
+int anj_dm_shared_obj_inst_add(anj_dm_shared_obj_t *shared_obj,
+                               anj_iid_t iid) {
+    assert(shared_obj && iid != ANJ_ID_INVALID);
+    anj_iid_t *iids = shared_obj->iids;
+    uint16_t max_inst_count = shared_obj->obj.max_inst_count;
+    uint16_t inst_count = find_iid_idx(iids, max_inst_count, ANJ_ID_INVALID);
+    if (inst_count >= max_inst_count) {
+        dm_log(L_ERROR, "Maximum number of instances reached");
+        return ANJ_DM_ERR_METHOD_NOT_ALLOWED;
+    }
+    uint16_t idx = find_iid_idx(iids, inst_count, iid);
+    if (idx < inst_count && iids[idx] == iid) {
+        dm_log(L_ERROR, "Instance already exists");
+        return ANJ_DM_ERR_BAD_REQUEST;
+    }
+    memmove(&iids[idx + 1], &iids[idx],
+            (size_t) (inst_count - idx) * sizeof(*iids));
+    iids[idx] = iid;
+    return 0;
+}
+
+int anj_dm_shared_obj_inst_remove(anj_dm_shared_obj_t *shared_obj,
+                                  anj_iid_t iid) {
+    assert(shared_obj);
+    anj_iid_t *iids = shared_obj->iids;
+    uint16_t inst_count = find_iid_idx(iids, shared_obj->obj.max_inst_count,
+                                       ANJ_ID_INVALID);
+    uint16_t idx = find_iid_idx(iids, inst_count, iid);
+    if (idx >= inst_count || iids[idx] != iid) {
+        return ANJ_DM_ERR_NOT_FOUND;
+    }
+    memmove(&iids[idx], &iids[idx + 1],
+            (size_t) (inst_count - idx - 1) * sizeof(*iids));
+    iids[inst_count - 1] = ANJ_ID_INVALID;
+    return 0;
+}
+#endif // ANJ_DM_WITH_SHARED_OBJ_DEFS
+
+#ifdef ANJ_DM_WITH_PATH_HANDLES
+static int resolve_path_handle(_anj_dm_data_model_t *dm,
+                               const anj_uri_path_t *path,
+                               anj_dm_path_handle_t *out_handle) {
+    int result = resolve_entity_ptrs(dm, path, &out_handle->ptrs);
+    if (result) {
+        out_handle->ptrs.obj = NULL;
+        return result;
+    }
+    out_handle->path = *path;
+    out_handle->generation = dm->generation;
+    return 0;
+}
+
+static bool path_handle_valid(_anj_dm_data_model_t *dm,
+                              const anj_dm_path_handle_t *handle) {
+#    ifdef ANJ_DM_WITH_LAZY_INSTS
+    /* definitions returned by the handlers are valid only until their next
+     * call, so they have to be looked up each time */
+    if (handle->ptrs.obj && handle->ptrs.inst
+            && _anj_dm_is_lazy_obj(handle->ptrs.obj)) {
+        return false;
+    }
+#    endif // ANJ_DM_WITH_LAZY_INSTS
+    return handle->ptrs.obj && handle->generation == dm->generation;
+}
+
+static size_t path_cache_slot(const anj_uri_path_t *path) {
+    uint32_t hash = 0;
+    for (size_t i = 0; i < path->uri_len; i++) {
+        hash = hash * 31 + path->ids[i];
+    }
+    return hash % ANJ_DM_PATH_HANDLE_CACHE_SIZE;
+}
+
+int _anj_dm_get_path_handle_ptrs(_anj_dm_data_model_t *dm,
+                                 anj_dm_path_handle_t *handle,
+                                 _anj_dm_entity_ptrs_t *out_ptrs) {
+    assert(dm && handle && out_ptrs);
+    if (!path_handle_valid(dm, handle)) {
+        if (!anj_uri_path_has(&handle->path, ANJ_ID_OID)) {
+            return _ANJ_DM_ERR_INPUT_ARG;
+        }
+        int result = resolve_path_handle(dm, &handle->path, handle);
+        if (result) {
+            return result;
+        }
+    }
+    *out_ptrs = handle->ptrs;
+    return 0;
+}
+
+int anj_dm_path_handle_resolve(anj_t *anj,
+                               const anj_uri_path_t *path,
+                               anj_dm_path_handle_t *out_handle) {
+    assert(anj && path && out_handle && anj_uri_path_has(path, ANJ_ID_OID));
+    int result = resolve_path_handle(&anj->dm, path, out_handle);
+    /* keep the path, so that it can be resolved again later */
+    out_handle->path = *path;
+    return result;
+}
+
+int _anj_dm_get_entity_ptrs(_anj_dm_data_model_t *dm,
+                            const anj_uri_path_t *path,
+                            _anj_dm_entity_ptrs_t *out_ptrs) {
+    anj_dm_path_handle_t *entry = &dm->path_cache[path_cache_slot(path)];
+    if (!path_handle_valid(dm, entry)
+            || !anj_uri_path_equal(&entry->path, path)) {
+        int result = resolve_path_handle(dm, path, entry);
+        if (result) {
+            return result;
+        }
+    }
+    *out_ptrs = entry->ptrs;
+    return 0;
+}
+#else  // ANJ_DM_WITH_PATH_HANDLES
+int _anj_dm_get_entity_ptrs(_anj_dm_data_model_t *dm,
+                            const anj_uri_path_t *path,
+                            _anj_dm_entity_ptrs_t *out_ptrs) {
+    return resolve_entity_ptrs(dm, path, out_ptrs);
+}
+#endif // ANJ_DM_WITH_PATH_HANDLES
+
+void _anj_dm_structure_changed(_anj_dm_data_model_t *dm) {
+    assert(dm);
+#ifdef ANJ_DM_WITH_PATH_HANDLES
+    dm->generation++;
+#endif // ANJ_DM_WITH_PATH_HANDLES
+#ifdef ANJ_DM_WITH_LINK_SET_HASH
+    dm->link_set_hash_valid = false;
+#endif // ANJ_DM_WITH_LINK_SET_HASH
+#ifdef ANJ_DM_WITH_REGISTER_PAYLOAD_CACHE
+    dm->reg_payload_cache_valid = false;
+#endif // ANJ_DM_WITH_REGISTER_PAYLOAD_CACHE
+#ifdef ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+    dm->device_read_cache_valid = false;
+#endif // ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+#ifdef ANJ_DM_WITH_READABLE_RES_COUNT_CACHE
+    memset(dm->readable_res_count_valid, 0,
+           sizeof(dm->readable_res_count_valid));
+#endif // ANJ_DM_WITH_READABLE_RES_COUNT_CACHE
+#ifdef ANJ_DM_WITH_READ_CACHE
+    _anj_dm_read_cache_invalidate(dm, &ANJ_MAKE_ROOT_PATH());
+#endif // ANJ_DM_WITH_READ_CACHE
+    (void) dm;
+}
+
+#ifdef ANJ_WITH_BOOTSTRAP_WRITE_BATCHING
+static bool is_batched_operation(const _anj_dm_data_model_t *dm) {
+    return dm->bootstrap_operation && dm->operation == ANJ_OP_DM_WRITE_REPLACE;
+}
+
+static void end_transactions(anj_t *anj, anj_dm_transaction_result_t result) {
+    _anj_dm_data_model_t *dm = &anj->dm;
+    for (uint16_t idx = 0; idx < dm->objs_count; idx++) {
+        const anj_dm_obj_t *obj = dm->objs[idx];
+        if (dm->in_transaction[idx] && obj->handlers->transaction_end) {
+            obj->handlers->transaction_end(anj, obj, result);
+        }
+        dm->in_transaction[idx] = false;
+    }
+}
+
+static void commit_bootstrap_batch(anj_t *anj) {
+    _anj_dm_data_model_t *dm = &anj->dm;
+    if (!dm->bootstrap_batch_pending) {
+        return;
+    }
+    dm->bootstrap_batch_pending = false;
+    int res = 0;
+    for (uint16_t idx = 0; idx < dm->objs_count && !res; idx++) {
+        const anj_dm_obj_t *obj = dm->objs[idx];
+        if (dm->in_transaction[idx] && obj->handlers->transaction_validate) {
+            res = obj->handlers->transaction_validate(anj, obj);
+        }
+    }
+    if (res) {
+        dm_log(L_ERROR, "Bootstrap-Write batch validation failed");
+        dm->bootstrap_batch_failed = true;
+    }
+    end_transactions(anj, res ? ANJ_DM_TRANSACTION_FAILURE
+                              : ANJ_DM_TRANSACTION_SUCCESS);
+}
+
+int _anj_dm_bootstrap_batch_commit(anj_t *anj) {
+    assert(anj);
+    if (!anj->dm.op_in_progress) {
+        commit_bootstrap_batch(anj);
+    }
+    bool failed = anj->dm.bootstrap_batch_failed;
+    anj->dm.bootstrap_batch_failed = false;
+    return failed ? -1 : 0;
+}
+#endif // ANJ_WITH_BOOTSTRAP_WRITE_BATCHING
+
 int _anj_dm_operation_begin(anj_t *anj,
                             _anj_op_t operation,
                             bool is_bootstrap_request,
@@ -203,11 +691,22 @@ int _anj_dm_operation_begin(anj_t *anj,
     assert(anj);
     _anj_dm_data_model_t *dm = &anj->dm;
     assert(!dm->op_in_progress);
+#ifdef ANJ_WITH_BOOTSTRAP_WRITE_BATCHING
+    // any other operation must see the committed data model
+    if (!is_bootstrap_request || operation != ANJ_OP_DM_WRITE_REPLACE) {
+        commit_bootstrap_batch(anj);
+    }
+#endif // ANJ_WITH_BOOTSTRAP_WRITE_BATCHING
 
+    _ANJ_TRACE(&anj->trace, DM_OPERATION, BEGIN, operation);
     dm->operation = operation;
     dm->bootstrap_operation = is_bootstrap_request;
     dm->is_transactional = false;
     dm->op_in_progress = true;
+#ifdef ANJ_DM_WITH_RES_READ_BATCH
+    dm->read_batch_obj = NULL;
+    dm->read_batch_res = NULL;
+#endif // ANJ_DM_WITH_RES_READ_BATCH
 
     if (!is_bootstrap_request) {
         if (path != NULL && _anj_uri_path_to_security_or_oscore_obj(path)) {
@@ -224,6 +723,11 @@ int _anj_dm_operation_begin(anj_t *anj,
     case ANJ_OP_DM_WRITE_COMP:
         dm->is_transactional = true;
         dm->op_ctx.write_ctx.path.uri_len = 0;
+        // Object of the previous record, see _anj_dm_write_entry
+        dm->entity_ptrs.obj = NULL;
+#    ifdef ANJ_DM_WITH_BATCHED_WRITE_COMP
+        dm->write_comp_payload_received = false;
+#    endif // ANJ_DM_WITH_BATCHED_WRITE_COMP
         return 0;
 #endif // ANJ_WITH_COMPOSITE_OPERATIONS
     case ANJ_OP_REGISTER:
@@ -268,6 +772,12 @@ int _anj_dm_operation_validate(anj_t *anj) {
     _anj_dm_data_model_t *dm = &anj->dm;
     assert(dm->op_in_progress);
     assert(dm->is_transactional);
+#ifdef ANJ_WITH_BOOTSTRAP_WRITE_BATCHING
+    if (is_batched_operation(dm)) {
+        // validated when the batch is committed
+        return 0;
+    }
+#endif // ANJ_WITH_BOOTSTRAP_WRITE_BATCHING
     int res = 0;
     for (uint16_t idx = 0; idx < dm->objs_count && !res; idx++) {
         const anj_dm_obj_t *obj = dm->objs[idx];
@@ -282,6 +792,20 @@ void _anj_dm_operation_end(anj_t *anj, anj_dm_transaction_result_t result) {
     assert(anj);
     _anj_dm_data_model_t *dm = &anj->dm;
     assert(dm->op_in_progress);
+#ifdef ANJ_WITH_BOOTSTRAP_WRITE_BATCHING
+    if (dm->is_transactional && is_batched_operation(dm)) {
+        if (result == ANJ_DM_TRANSACTION_SUCCESS) {
+            dm->bootstrap_batch_pending = true;
+        } else {
+            // previous Bootstrap-Writes of the batch are rolled back as well
+            dm->bootstrap_batch_pending = false;
+            dm->bootstrap_batch_failed = true;
+            end_transactions(anj, result);
+        }
+    } else if (dm->is_transactional) {
+        end_transactions(anj, result);
+    }
+#else  // ANJ_WITH_BOOTSTRAP_WRITE_BATCHING
     if (dm->is_transactional) {
         for (uint16_t idx = 0; idx < dm->objs_count; idx++) {
             const anj_dm_obj_t *obj = dm->objs[idx];
@@ -291,7 +815,28 @@ void _anj_dm_operation_end(anj_t *anj, anj_dm_transaction_result_t result) {
             dm->in_transaction[idx] = false;
         }
     }
+#endif // ANJ_WITH_BOOTSTRAP_WRITE_BATCHING
+    /* Instances created or removed during Bootstrap are not reported as
+     * changes of the data model */
+    switch (dm->operation) {
+    case ANJ_OP_DM_WRITE_REPLACE:
+    case ANJ_OP_DM_WRITE_PARTIAL_UPDATE:
+    case ANJ_OP_DM_WRITE_COMP:
+    case ANJ_OP_DM_CREATE:
+    case ANJ_OP_DM_DELETE:
+        _anj_dm_structure_changed(dm);
+        break;
+#ifdef ANJ_DM_WITH_READ_CACHE
+    case ANJ_OP_DM_EXECUTE:
+        // values changed by the Execute handler aren't reported
+        _anj_dm_read_cache_invalidate(dm, &ANJ_MAKE_ROOT_PATH());
+        break;
+#endif // ANJ_DM_WITH_READ_CACHE
+    default:
+        break;
+    }
     dm->op_in_progress = false;
+    _ANJ_TRACE(&anj->trace, DM_OPERATION, END, result);
 }
 
 void _anj_dm_initialize(anj_t *anj) {
@@ -300,7 +845,9 @@ void _anj_dm_initialize(anj_t *anj) {
 }
 
 #ifndef NDEBUG
-static int check_res(const anj_dm_obj_t *obj, const anj_dm_res_t *res) {
+static int check_res(const anj_dm_obj_t *obj,
+                     const anj_dm_obj_inst_t *inst,
+                     const anj_dm_res_t *res) {
     // handlers check
     if ((res->kind == ANJ_DM_RES_E && !obj->handlers->res_execute)
             || (_anj_dm_is_readable_resource(res->kind)
@@ -326,16 +873,28 @@ static int check_res(const anj_dm_obj_t *obj, const anj_dm_res_t *res) {
                  )) {
         goto res_error;
     }
+#ifdef ANJ_DM_WITH_RES_INST_BITMAP
+    if (_anj_dm_is_multi_instance_resource(res->kind) && res->insts_bitmap) {
+        // IDs not lower than max_inst_count are not allowed
+        if (res->max_inst_count % 32
+                && (res->insts_bitmap[res->max_inst_count / 32]
+                    & (UINT32_MAX << (res->max_inst_count % 32)))) {
+            goto res_error;
+        }
+        return 0;
+    }
+#endif // ANJ_DM_WITH_RES_INST_BITMAP
     if (_anj_dm_is_multi_instance_resource(res->kind) && res->max_inst_count) {
-        if (!res->insts) {
+        const anj_riid_t *insts = _anj_dm_res_insts(inst, res);
+        if (!insts) {
             goto res_error;
         }
         anj_rid_t last_riid = 0;
         for (uint16_t idx = 0; idx < res->max_inst_count; idx++) {
-            if (idx != 0 && res->insts[idx] <= last_riid) {
+            if (idx != 0 && insts[idx] <= last_riid) {
                 goto res_error;
             }
-            last_riid = res->insts[idx];
+            last_riid = insts[idx];
             if (last_riid == ANJ_ID_INVALID) {
                 break;
             }
@@ -352,6 +911,21 @@ int _anj_dm_check_obj(const anj_dm_obj_t *obj) {
     if (obj->max_inst_count == 0) {
         return 0;
     }
+#    ifdef ANJ_DM_WITH_LAZY_INSTS
+    if (obj->handlers
+            && (obj->handlers->inst_lookup || obj->handlers->inst_first
+                || obj->handlers->inst_next)) {
+        // Instances are enumerated on demand, so they can't be checked here;
+        // Instances of Objects used by the library itself are accessed directly
+        if (!_anj_dm_is_lazy_obj(obj) || obj->insts
+                || obj->oid == ANJ_OBJ_ID_SECURITY
+                || obj->oid == ANJ_OBJ_ID_SERVER
+                || obj->oid == ANJ_OBJ_ID_OSCORE) {
+            goto obj_error;
+        }
+        return 0;
+    }
+#    endif // ANJ_DM_WITH_LAZY_INSTS
     if (!obj->insts || !obj->handlers) {
         goto obj_error;
     }
@@ -388,11 +962,38 @@ int _anj_dm_check_obj_instance(const anj_dm_obj_t *obj,
     for (uint16_t res_idx = 0; res_idx < inst->res_count; res_idx++) {
         const anj_dm_res_t *res = &inst->resources[res_idx];
         if (res->rid == ANJ_ID_INVALID || (res_idx != 0 && res->rid <= last_rid)
-                || check_res(obj, res)) {
+                || check_res(obj, inst, res)) {
             goto instance_error;
         }
         last_rid = res->rid;
+#    ifdef ANJ_DM_WITH_RID_INDEX
+        if (inst->rid_index
+                && (res->rid < inst->rid_index_first
+                    || res->rid - inst->rid_index_first
+                                   >= inst->rid_index_size
+                    || inst->rid_index[res->rid - inst->rid_index_first]
+                                   != res_idx + 1)) {
+            goto instance_error;
+        }
+#    endif // ANJ_DM_WITH_RID_INDEX
     }
+#    ifdef ANJ_DM_WITH_RID_INDEX
+    if (inst->rid_index) {
+        if (inst->res_count > UINT8_MAX) {
+            goto instance_error;
+        }
+        // every Resource is referenced once, other elements must be zeroed
+        uint16_t referenced = 0;
+        for (uint16_t offset = 0; offset < inst->rid_index_size; offset++) {
+            if (inst->rid_index[offset]) {
+                referenced++;
+            }
+        }
+        if (referenced != inst->res_count) {
+            goto instance_error;
+        }
+    }
+#    endif // ANJ_DM_WITH_RID_INDEX
     return 0;
 
 instance_error:
@@ -416,15 +1017,10 @@ int anj_dm_add_obj(anj_t *anj, const anj_dm_obj_t *obj) {
         return _ANJ_DM_ERR_MEMORY;
     }
 
-    uint16_t idx;
-    for (idx = 0; idx < dm->objs_count; idx++) {
-        if (dm->objs[idx]->oid > obj->oid) {
-            break;
-        }
-        if (dm->objs[idx]->oid == obj->oid) {
-            dm_log(L_ERROR, "Object %" PRIu16 " exists", obj->oid);
-            return _ANJ_DM_ERR_LOGIC;
-        }
+    uint16_t idx = _anj_dm_find_obj_idx(dm, obj->oid);
+    if (idx < dm->objs_count && dm->objs[idx]->oid == obj->oid) {
+        dm_log(L_ERROR, "Object %" PRIu16 " exists", obj->oid);
+        return _ANJ_DM_ERR_LOGIC;
     }
 
     for (uint16_t i = dm->objs_count; i > idx; i--) {
@@ -447,15 +1043,8 @@ int anj_dm_remove_obj(anj_t *anj, anj_oid_t oid) {
         return _ANJ_DM_ERR_LOGIC;
     }
 
-    uint16_t idx;
-    bool found = false;
-    for (idx = 0; idx < dm->objs_count; idx++) {
-        if (dm->objs[idx]->oid == oid) {
-            found = true;
-            break;
-        }
-    }
-    if (!found) {
+    uint16_t idx = _anj_dm_find_obj_idx(dm, oid);
+    if (idx == dm->objs_count || dm->objs[idx]->oid != oid) {
         dm_log(L_ERROR, "Object %" PRIu16 " not found", oid);
         return ANJ_DM_ERR_NOT_FOUND;
     }
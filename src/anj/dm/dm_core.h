@@ -81,6 +81,16 @@ int _anj_dm_get_entity_ptrs(_anj_dm_data_model_t *dm,
                             const anj_uri_path_t *path,
                             _anj_dm_entity_ptrs_t *out_ptrs);
 
+#    ifdef ANJ_DM_WITH_PATH_HANDLES
+/**
+ * Returns entity pointers of the @p handle, resolving its path again if the
+ * handle is stale.
+ */
+int _anj_dm_get_path_handle_ptrs(_anj_dm_data_model_t *dm,
+                                 anj_dm_path_handle_t *handle,
+                                 _anj_dm_entity_ptrs_t *out_ptrs);
+#    endif // ANJ_DM_WITH_PATH_HANDLES
+
 #    ifndef NDEBUG
 int _anj_dm_check_obj_instance(const anj_dm_obj_t *obj,
                                const anj_dm_obj_inst_t *inst);
@@ -95,14 +105,117 @@ static inline bool _anj_dm_is_multi_instance_resource(anj_dm_res_kind_t kind) {
 
 const anj_dm_obj_t *_anj_dm_find_obj(_anj_dm_data_model_t *dm, anj_oid_t oid);
 
-bool _anj_dm_res_inst_exists(const anj_dm_res_t *res, anj_riid_t riid);
+/**
+ * Returns index in the objs array of the first Object with OID not lower than
+ * @p oid, or objs_count if there is no such Object.
+ */
+uint16_t _anj_dm_find_obj_idx(_anj_dm_data_model_t *dm, anj_oid_t oid);
+
+/**
+ * Returns the array of Resource Instance IDs of @p res, which is an element of
+ * the @ref anj_dm_obj_inst_t::resources array of @p inst.
+ */
+static inline const anj_riid_t *
+_anj_dm_res_insts(const anj_dm_obj_inst_t *inst, const anj_dm_res_t *res) {
+#    ifdef ANJ_DM_WITH_SHARED_RES_DEFS
+    if (inst->res_insts) {
+        return inst->res_insts[res - inst->resources];
+    }
+#    else  // ANJ_DM_WITH_SHARED_RES_DEFS
+    (void) inst;
+#    endif // ANJ_DM_WITH_SHARED_RES_DEFS
+    return res->insts;
+}
+
+bool _anj_dm_res_inst_exists(const anj_dm_obj_inst_t *inst,
+                             const anj_dm_res_t *res,
+                             anj_riid_t riid);
+
+/**
+ * Returns the ID of the first Resource Instance of @p res found at position
+ * @p cursor or later, and moves @p cursor past it. Returns @ref ANJ_ID_INVALID
+ * if there are no more Resource Instances. Iteration starts with @p cursor set
+ * to 0; its value is an index in the array of Resource Instance IDs, or an ID
+ * itself if @ref anj_dm_res_t::insts_bitmap is used.
+ */
+anj_riid_t _anj_dm_next_res_inst(const anj_dm_obj_inst_t *inst,
+                                 const anj_dm_res_t *res,
+                                 uint16_t *cursor);
+
+/**
+ * Returns the lowest Resource Instance ID of @p res, or @ref ANJ_ID_INVALID if
+ * it has no Resource Instances.
+ */
+static inline anj_riid_t
+_anj_dm_first_res_inst(const anj_dm_obj_inst_t *inst,
+                       const anj_dm_res_t *res) {
+    uint16_t cursor = 0;
+    return _anj_dm_next_res_inst(inst, res, &cursor);
+}
 
 bool _anj_dm_is_readable_resource(anj_dm_res_kind_t kind);
 
 bool _anj_dm_is_writable_resource(anj_dm_res_kind_t kind, bool is_bootstrap);
 
-uint16_t _anj_dm_count_res_insts(const anj_dm_res_t *res);
+uint16_t _anj_dm_count_res_insts(const anj_dm_obj_inst_t *inst,
+                                 const anj_dm_res_t *res);
 
 uint16_t _anj_dm_count_obj_insts(const anj_dm_obj_t *obj);
 
+#    ifdef ANJ_DM_WITH_LAZY_INSTS
+/**
+ * Checks if Instances of @p obj are enumerated by its handlers, see
+ * @ref anj_dm_inst_lookup_t.
+ */
+static inline bool _anj_dm_is_lazy_obj(const anj_dm_obj_t *obj) {
+    return obj->handlers && obj->handlers->inst_lookup
+           && obj->handlers->inst_first && obj->handlers->inst_next;
+}
+#    endif // ANJ_DM_WITH_LAZY_INSTS
+
+/**
+ * Returns the Instance of @p obj with ID @p iid, or NULL if there is no such
+ * Instance.
+ */
+const anj_dm_obj_inst_t *_anj_dm_find_inst(const anj_dm_obj_t *obj,
+                                           anj_iid_t iid);
+
+/**
+ * Returns the Instance of @p obj with the lowest ID, or NULL if there are no
+ * Instances.
+ */
+const anj_dm_obj_inst_t *_anj_dm_first_inst(const anj_dm_obj_t *obj);
+
+/**
+ * Returns the Instance of @p obj with the lowest ID greater than @p iid, or
+ * NULL if there is no such Instance.
+ *
+ * For Objects enumerating their Instances with handlers, the returned pointer
+ * is valid only until the next call to any of these functions for @p obj.
+ */
+const anj_dm_obj_inst_t *_anj_dm_next_inst(const anj_dm_obj_t *obj,
+                                           anj_iid_t iid);
+
+/**
+ * Returns the number of used slots of the sorted @p insts array.
+ */
+uint16_t _anj_dm_count_insts(const anj_dm_obj_inst_t *insts,
+                             uint16_t max_inst_count);
+
+/**
+ * Returns index of the first of @p inst_count used slots of the sorted
+ * @p insts array with IID not lower than @p iid, or @p inst_count if there is
+ * no such slot.
+ */
+uint16_t _anj_dm_find_inst_idx(const anj_dm_obj_inst_t *insts,
+                               uint16_t inst_count,
+                               anj_iid_t iid);
+
+/**
+ * Returns the lowest IID not used by any of @p inst_count used slots of the
+ * sorted @p insts array.
+ */
+anj_iid_t _anj_dm_find_free_iid(const anj_dm_obj_inst_t *insts,
+                                uint16_t inst_count);
+
 #endif // SRC_ANJ_DM_DM_CORE_H
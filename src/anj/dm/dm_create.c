@@ -27,16 +27,6 @@
 #include "dm_core.h"
 #include "dm_io.h"
 
-static anj_iid_t find_free_iid(const anj_dm_obj_t *obj) {
-    for (uint16_t idx = 0; idx < UINT16_MAX; idx++) {
-        if (idx >= obj->max_inst_count || idx != obj->insts[idx].iid) {
-            return idx;
-        }
-    }
-    ANJ_UNREACHABLE("object has more than 65534 instances");
-    return 0;
-}
-
 int _anj_dm_begin_create_op(anj_t *anj, const anj_uri_path_t *base_path) {
     assert(base_path && anj_uri_path_is(base_path, ANJ_ID_OID));
     _anj_dm_data_model_t *dm = &anj->dm;
@@ -62,6 +52,21 @@ int _anj_dm_begin_create_op(anj_t *anj, const anj_uri_path_t *base_path) {
     return result;
 }
 
+static anj_iid_t find_free_iid(const anj_dm_obj_t *obj, uint16_t inst_count) {
+#ifdef ANJ_DM_WITH_LAZY_INSTS
+    if (_anj_dm_is_lazy_obj(obj)) {
+        anj_iid_t iid = 0;
+        for (const anj_dm_obj_inst_t *inst = _anj_dm_first_inst(obj);
+             inst && inst->iid == iid;
+             inst = _anj_dm_next_inst(obj, inst->iid)) {
+            iid++;
+        }
+        return iid;
+    }
+#endif // ANJ_DM_WITH_LAZY_INSTS
+    return _anj_dm_find_free_iid(obj->insts, inst_count);
+}
+
 int _anj_dm_create_object_instance(anj_t *anj, anj_iid_t iid) {
     _anj_dm_data_model_t *dm = &anj->dm;
     assert(dm->op_in_progress
@@ -71,23 +76,22 @@ int _anj_dm_create_object_instance(anj_t *anj, anj_iid_t iid) {
            && !dm->op_ctx.write_ctx.instance_creation_attempted);
     const anj_dm_obj_t *obj = dm->entity_ptrs.obj;
 
-    if (_anj_dm_count_obj_insts(obj) >= obj->max_inst_count) {
+    uint16_t inst_count = _anj_dm_count_obj_insts(obj);
+    if (inst_count >= obj->max_inst_count) {
         dm_log(L_ERROR, "Maximum number of instances reached");
         return ANJ_DM_ERR_METHOD_NOT_ALLOWED;
     }
     if (iid == ANJ_ID_INVALID) {
-        iid = find_free_iid(obj);
+        iid = find_free_iid(obj, inst_count);
         dm->iid_provided = false;
         dm_log(L_DEBUG,
                "Creating instance with auto-generated IID: %" PRIu16,
                iid);
     } else {
         dm->iid_provided = true;
-        for (uint16_t idx = 0; idx < obj->max_inst_count; idx++) {
-            if (iid == obj->insts[idx].iid) {
-                dm_log(L_ERROR, "Instance already exists");
-                return ANJ_DM_ERR_BAD_REQUEST;
-            }
+        if (_anj_dm_find_inst(obj, iid)) {
+            dm_log(L_ERROR, "Instance already exists");
+            return ANJ_DM_ERR_BAD_REQUEST;
         }
     }
 
@@ -103,12 +107,7 @@ int _anj_dm_create_object_instance(anj_t *anj, anj_iid_t iid) {
     }
 
     // find new instance
-    for (uint16_t idx = 0; idx < obj->max_inst_count; idx++) {
-        if (obj->insts[idx].iid == iid) {
-            dm->entity_ptrs.inst = &obj->insts[idx];
-            break;
-        }
-    }
+    dm->entity_ptrs.inst = _anj_dm_find_inst(obj, iid);
     assert(dm->entity_ptrs.inst);
     assert(!_anj_dm_check_obj_instance(obj, dm->entity_ptrs.inst));
 
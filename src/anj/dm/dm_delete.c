@@ -49,6 +49,7 @@ static int delete_instance(anj_t *anj) {
     return 0;
 }
 
+#ifdef ANJ_WITH_BOOTSTRAP
 static bool is_oscore_bootstrap_instance(anj_t *anj) {
     _anj_dm_data_model_t *dm = &anj->dm;
     const anj_dm_obj_t *security_object =
@@ -83,7 +84,6 @@ static bool is_oscore_bootstrap_instance(anj_t *anj) {
     return false;
 }
 
-#ifdef ANJ_WITH_BOOTSTRAP
 static bool is_bootstrap_instance(anj_t *anj) {
     _anj_dm_data_model_t *dm = &anj->dm;
     if (dm->entity_ptrs.obj->oid == ANJ_OBJ_ID_SECURITY) {
@@ -133,31 +133,30 @@ static int process_bootstrap_delete_op(anj_t *anj,
             if (result) {
                 return result;
             }
-            dm->entity_ptrs.obj = dm->objs[idx];
-            uint16_t inst_idx = 0;
-            uint16_t inst_count = _anj_dm_count_obj_insts(dm->objs[idx]);
-            for (uint16_t i = 0; i < inst_count; i++) {
-                dm->entity_ptrs.inst = &dm->objs[idx]->insts[inst_idx];
+            const anj_dm_obj_t *obj = dm->objs[idx];
+            dm->entity_ptrs.obj = obj;
+            dm->entity_ptrs.inst = _anj_dm_first_inst(obj);
+            while (dm->entity_ptrs.inst) {
+                anj_iid_t iid = dm->entity_ptrs.inst->iid;
                 // ignore instance if it not the targeted one or if it is
-                // bootstrap instance, inrcrement inst_idx to skip bootstrap
-                // instance or find valid one
+                // bootstrap instance
                 bool bootstrap_instance = is_bootstrap_instance(anj);
-                if ((!all_instances
-                     && base_path->ids[ANJ_ID_IID] != dm->entity_ptrs.inst->iid)
+                if ((!all_instances && base_path->ids[ANJ_ID_IID] != iid)
                         || bootstrap_instance) {
                     if (!all_objects && !all_instances && bootstrap_instance) {
                         dm_log(L_ERROR,
                                "Bootstrap-Server Instance can't be deleted");
                         return ANJ_DM_ERR_BAD_REQUEST;
                     }
-                    inst_idx++;
-                    continue;
-                }
-                result = delete_instance(anj);
-                // end in case of error or if targeted instance was deleted
-                if (result || (!all_objects && !all_instances)) {
-                    return result;
+                } else {
+                    result = delete_instance(anj);
+                    // end in case of error or if targeted instance was
+                    // deleted
+                    if (result || (!all_objects && !all_instances)) {
+                        return result;
+                    }
                 }
+                dm->entity_ptrs.inst = _anj_dm_next_inst(obj, iid);
             }
         }
     }
@@ -24,9 +24,20 @@
 
 #include "dm_core.h"
 
+#ifdef ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
+#    include <anj/compat/time.h>
+#    include <anj/time.h>
+
+#    include "../exchange.h"
+#endif // ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
+
 #ifdef ANJ_WITH_DEFAULT_DEVICE_OBJ
 
-#    define ANJ_DM_DEVICE_RESOURCES_COUNT 8
+#    ifdef ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
+#        define ANJ_DM_DEVICE_RESOURCES_COUNT 9
+#    else  // ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
+#        define ANJ_DM_DEVICE_RESOURCES_COUNT 8
+#    endif // ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
 
 enum {
     RID_MANUFACTURER = 0,
@@ -35,6 +46,7 @@ enum {
     RID_FIRMWARE_VERSION = 3,
     RID_REBOOT = 4,
     RID_ERROR_CODE = 11,
+    RID_CURRENT_TIME = 13,
     RID_BINDING_MODES = 16,
     RID_SOFTWARE_VERSION = 19
 };
@@ -46,6 +58,9 @@ enum {
     RID_FIRMWARE_VERSION_IDX,
     RID_REBOOT_IDX,
     RID_ERROR_CODE_IDX,
+#    ifdef ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
+    RID_CURRENT_TIME_IDX,
+#    endif // ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
     RID_BINDING_MODES_IDX,
     RID_SOFTWARE_VERSION_IDX,
     _RID_LAST
@@ -93,6 +108,13 @@ static const anj_dm_res_t RES[ANJ_DM_DEVICE_RESOURCES_COUNT] = {
         .max_inst_count = ANJ_ARRAY_SIZE(RES_INST),
         .insts = RES_INST
     },
+#    ifdef ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
+    [RID_CURRENT_TIME_IDX] = {
+        .rid = RID_CURRENT_TIME,
+        .type = ANJ_DATA_TYPE_TIME,
+        .kind = ANJ_DM_RES_RW
+    },
+#    endif // ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
     [RID_BINDING_MODES_IDX] = {
         .rid = RID_BINDING_MODES,
         .type = ANJ_DATA_TYPE_STRING,
@@ -172,15 +194,78 @@ static int res_read(anj_t *anj,
         out_value->int_value = 0;
         return 0;
     }
+#    ifdef ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
+    case RID_CURRENT_TIME:
+        out_value->time_value = anj_time_real_to_scalar(anj_time_real_now(),
+                                                        ANJ_TIME_UNIT_S);
+        break;
+#    endif // ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
     default:
         return ANJ_DM_ERR_NOT_FOUND;
     }
     return 0;
 }
 
+#    ifdef ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
+static int res_write(anj_t *anj,
+                     const anj_dm_obj_t *obj,
+                     anj_iid_t iid,
+                     anj_rid_t rid,
+                     anj_riid_t riid,
+                     const anj_res_value_t *value) {
+    (void) anj;
+    (void) iid;
+    (void) riid;
+
+    anj_dm_device_obj_t *ctx = ANJ_CONTAINER_OF(obj, anj_dm_device_obj_t, obj);
+
+    if (rid != RID_CURRENT_TIME) {
+        return ANJ_DM_ERR_NOT_FOUND;
+    }
+    if (!ctx->current_time_cb) {
+        dm_log(L_ERROR, "Current time callback not set");
+        return ANJ_DM_ERR_METHOD_NOT_ALLOWED;
+    }
+    // applied once the whole Write succeeds
+    ctx->written_time = anj_time_real_new(value->time_value, ANJ_TIME_UNIT_S);
+    return 0;
+}
+
+static int transaction_begin(anj_t *anj, const anj_dm_obj_t *obj) {
+    (void) anj;
+    anj_dm_device_obj_t *ctx = ANJ_CONTAINER_OF(obj, anj_dm_device_obj_t, obj);
+    ctx->written_time = ANJ_TIME_REAL_INVALID;
+    return 0;
+}
+
+static void transaction_end(anj_t *anj,
+                            const anj_dm_obj_t *obj,
+                            anj_dm_transaction_result_t result) {
+    anj_dm_device_obj_t *ctx = ANJ_CONTAINER_OF(obj, anj_dm_device_obj_t, obj);
+    if (result != ANJ_DM_TRANSACTION_SUCCESS
+            || !anj_time_real_is_valid(ctx->written_time)) {
+        return;
+    }
+    anj_time_duration_t round_trip = ANJ_TIME_DURATION_ZERO;
+#        ifdef ANJ_WITH_ADAPTIVE_RTO
+    anj_time_duration_t srtt = _anj_exchange_srtt(&anj->exchange_ctx);
+    if (anj_time_duration_is_valid(srtt)) {
+        round_trip = srtt;
+    }
+#        endif // ANJ_WITH_ADAPTIVE_RTO
+    ctx->current_time_cb(ctx->current_time_cb_arg, anj, ctx->written_time,
+                         round_trip);
+}
+#    endif // ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
+
 static const anj_dm_handlers_t HANDLERS = {
     .res_read = res_read,
-    .res_execute = res_execute
+    .res_execute = res_execute,
+#    ifdef ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
+    .res_write = res_write,
+    .transaction_begin = transaction_begin,
+    .transaction_end = transaction_end,
+#    endif // ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
 };
 
 int anj_dm_device_obj_install(anj_t *anj,
@@ -211,6 +296,19 @@ int anj_dm_device_obj_install(anj_t *anj,
         device_obj->reboot_cb = obj_init->reboot_cb;
         device_obj->reboot_cb_arg = obj_init->reboot_cb_arg;
     }
+#    ifdef ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
+    device_obj->current_time_cb = obj_init->current_time_cb;
+    device_obj->current_time_cb_arg = obj_init->current_time_cb_arg;
+#    endif // ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
+#    ifdef ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+    // stored Reads are dropped by anj_dm_add_obj()
+    anj->device_read_cache.obj = &device_obj->obj;
+#        ifdef ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
+    anj->device_read_cache.first_mutable_rid = RID_CURRENT_TIME;
+#        else  // ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
+    anj->device_read_cache.first_mutable_rid = ANJ_ID_INVALID;
+#        endif // ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
+#    endif     // ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
     int res = anj_dm_add_obj(anj, &device_obj->obj);
     if (!res) {
         dm_log(L_INFO, "Device object installed");
@@ -149,7 +149,6 @@ int _anj_dm_begin_bootstrap_discover_op(anj_t *anj,
 
     dm->op_count = 0;
     disc_ctx->obj_idx = 0;
-    disc_ctx->inst_idx = 0;
     disc_ctx->level = ANJ_ID_OID;
     bool all_objects = !base_path || !anj_uri_path_has(base_path, ANJ_ID_OID);
     for (uint16_t idx = 0; idx < dm->objs_count; idx++) {
@@ -188,20 +187,20 @@ int _anj_dm_get_bootstrap_discover_record(anj_t *anj,
         *out_path = ANJ_MAKE_OBJECT_PATH(obj->oid);
         *out_version = obj->version;
 
-        if (obj->max_inst_count != 0 && obj->insts[0].iid != ANJ_ID_INVALID) {
+        dm->entity_ptrs.inst = _anj_dm_first_inst(obj);
+        if (dm->entity_ptrs.inst) {
             disc_ctx->level = ANJ_ID_IID;
         } else {
             disc_ctx->obj_idx++;
         }
     } else {
-        assert(disc_ctx->inst_idx < obj->max_inst_count);
-        const anj_dm_obj_inst_t *inst = &obj->insts[disc_ctx->inst_idx];
+        const anj_dm_obj_inst_t *inst = dm->entity_ptrs.inst;
+        assert(inst);
         *out_path = ANJ_MAKE_INSTANCE_PATH(obj->oid, inst->iid);
         get_ssid_and_uri(anj, obj, inst, out_ssid, out_uri);
 
-        disc_ctx->inst_idx++;
-        if (disc_ctx->inst_idx == _anj_dm_count_obj_insts(obj)) {
-            disc_ctx->inst_idx = 0;
+        dm->entity_ptrs.inst = _anj_dm_next_inst(obj, inst->iid);
+        if (!dm->entity_ptrs.inst) {
             disc_ctx->obj_idx++;
             disc_ctx->level = ANJ_ID_OID;
         }
@@ -213,6 +212,27 @@ int _anj_dm_get_bootstrap_discover_record(anj_t *anj,
 #endif // ANJ_WITH_BOOTSTRAP_DISCOVER
 
 #ifdef ANJ_WITH_DISCOVER
+static void count_inst_records(_anj_dm_data_model_t *dm,
+                               const anj_dm_obj_inst_t *inst,
+                               const anj_uri_path_t *base_path,
+                               bool all_resources) {
+    if (all_resources) {
+        dm->op_count++;
+    }
+    for (uint16_t res_idx = 0; res_idx < inst->res_count; res_idx++) {
+        const anj_dm_res_t *res = &inst->resources[res_idx];
+        if (!all_resources && base_path->ids[ANJ_ID_RID] == res->rid) {
+            dm->op_ctx.disc_ctx.res_idx = res_idx;
+        }
+        if (all_resources || base_path->ids[ANJ_ID_RID] == res->rid) {
+            dm->op_count++;
+            if (_anj_dm_is_multi_instance_resource(res->kind)) {
+                dm->op_count += _anj_dm_count_res_insts(inst, res);
+            }
+        }
+    }
+}
+
 int _anj_dm_begin_discover_op(anj_t *anj, const anj_uri_path_t *base_path) {
     assert(anj);
     assert(base_path);
@@ -229,7 +249,6 @@ int _anj_dm_begin_discover_op(anj_t *anj, const anj_uri_path_t *base_path) {
     bool all_instances = !anj_uri_path_has(base_path, ANJ_ID_IID);
     bool all_resources =
             all_instances || !anj_uri_path_has(base_path, ANJ_ID_RID);
-    disc_ctx->inst_idx = 0;
     disc_ctx->res_idx = 0;
     disc_ctx->res_inst_idx = 0;
     if (all_instances) {
@@ -249,30 +268,18 @@ int _anj_dm_begin_discover_op(anj_t *anj, const anj_uri_path_t *base_path) {
 
     const anj_dm_obj_t *obj = dm->entity_ptrs.obj;
 
-    for (uint16_t idx = 0; idx < obj->max_inst_count; idx++) {
-        const anj_dm_obj_inst_t *inst = &obj->insts[idx];
-        if (inst->iid == ANJ_ID_INVALID) {
-            break;
-        }
-        if (!all_instances && base_path->ids[ANJ_ID_IID] == inst->iid) {
-            disc_ctx->inst_idx = idx;
+    if (all_instances) {
+        for (const anj_dm_obj_inst_t *inst = _anj_dm_first_inst(obj); inst;
+             inst = _anj_dm_next_inst(obj, inst->iid)) {
+            count_inst_records(dm, inst, base_path, all_resources);
         }
-        if (all_instances || base_path->ids[ANJ_ID_IID] == inst->iid) {
-            if (all_resources) {
-                dm->op_count++;
-            }
-            for (uint16_t res_idx = 0; res_idx < inst->res_count; res_idx++) {
-                const anj_dm_res_t *res = &inst->resources[res_idx];
-                if (!all_resources && base_path->ids[ANJ_ID_RID] == res->rid) {
-                    disc_ctx->res_idx = res_idx;
-                }
-                if (all_resources || base_path->ids[ANJ_ID_RID] == res->rid) {
-                    dm->op_count++;
-                    if (_anj_dm_is_multi_instance_resource(res->kind)) {
-                        dm->op_count += _anj_dm_count_res_insts(res);
-                    }
-                }
-            }
+        dm->entity_ptrs.inst = _anj_dm_first_inst(obj);
+    } else {
+        dm->entity_ptrs.inst =
+                _anj_dm_find_inst(obj, base_path->ids[ANJ_ID_IID]);
+        if (dm->entity_ptrs.inst) {
+            count_inst_records(dm, dm->entity_ptrs.inst, base_path,
+                               all_resources);
         }
     }
     dm->op_ctx.disc_ctx.total_op_count = dm->op_count;
@@ -283,22 +290,24 @@ static void get_inst_record(_anj_dm_data_model_t *dm,
                             anj_uri_path_t *out_path) {
     _anj_dm_disc_ctx_t *disc_ctx = &dm->op_ctx.disc_ctx;
     const anj_dm_obj_t *obj = dm->entity_ptrs.obj;
-    assert(disc_ctx->inst_idx < obj->max_inst_count);
-    const anj_dm_obj_inst_t *inst = &obj->insts[disc_ctx->inst_idx];
+    const anj_dm_obj_inst_t *inst = dm->entity_ptrs.inst;
+    assert(inst);
     *out_path = ANJ_MAKE_INSTANCE_PATH(obj->oid, inst->iid);
     if (inst->res_count) {
         disc_ctx->level = ANJ_ID_RID;
     } else {
-        disc_ctx->inst_idx++;
+        dm->entity_ptrs.inst = _anj_dm_next_inst(obj, inst->iid);
     }
 }
 
-static void increment_idx_starting_from_res(_anj_dm_disc_ctx_t *disc_ctx,
-                                            uint16_t res_count) {
+static void increment_idx_starting_from_res(_anj_dm_data_model_t *dm) {
+    _anj_dm_disc_ctx_t *disc_ctx = &dm->op_ctx.disc_ctx;
+    const anj_dm_obj_inst_t *inst = dm->entity_ptrs.inst;
     disc_ctx->res_idx++;
-    if (disc_ctx->res_idx == res_count) {
+    if (disc_ctx->res_idx == inst->res_count) {
         disc_ctx->res_idx = 0;
-        disc_ctx->inst_idx++;
+        dm->entity_ptrs.inst =
+                _anj_dm_next_inst(dm->entity_ptrs.obj, inst->iid);
         disc_ctx->level = ANJ_ID_IID;
     }
 }
@@ -308,14 +317,14 @@ static void get_res_record(_anj_dm_data_model_t *dm,
                            const uint16_t **out_dim) {
     _anj_dm_disc_ctx_t *disc_ctx = &dm->op_ctx.disc_ctx;
     const anj_dm_obj_t *obj = dm->entity_ptrs.obj;
-    const anj_dm_obj_inst_t *inst = &obj->insts[disc_ctx->inst_idx];
+    const anj_dm_obj_inst_t *inst = dm->entity_ptrs.inst;
     assert(disc_ctx->res_idx < inst->res_count);
     const anj_dm_res_t *res = &inst->resources[disc_ctx->res_idx];
     *out_path = ANJ_MAKE_RESOURCE_PATH(obj->oid, inst->iid, res->rid);
     bool is_multi_instance = _anj_dm_is_multi_instance_resource(res->kind);
     uint16_t inst_count = 0;
     if (is_multi_instance) {
-        inst_count = _anj_dm_count_res_insts(res);
+        inst_count = _anj_dm_count_res_insts(inst, res);
         *out_dim = &dm->op_ctx.disc_ctx.dim;
         dm->op_ctx.disc_ctx.dim = inst_count;
         if (inst_count) {
@@ -323,7 +332,7 @@ static void get_res_record(_anj_dm_data_model_t *dm,
         }
     }
     if (!is_multi_instance || !inst_count) {
-        increment_idx_starting_from_res(disc_ctx, inst->res_count);
+        increment_idx_starting_from_res(dm);
     }
 }
 
@@ -331,19 +340,19 @@ static void get_res_inst_record(_anj_dm_data_model_t *dm,
                                 anj_uri_path_t *out_path) {
     _anj_dm_disc_ctx_t *disc_ctx = &dm->op_ctx.disc_ctx;
     const anj_dm_obj_t *obj = dm->entity_ptrs.obj;
-    const anj_dm_obj_inst_t *inst = &obj->insts[disc_ctx->inst_idx];
+    const anj_dm_obj_inst_t *inst = dm->entity_ptrs.inst;
     const anj_dm_res_t *res = &inst->resources[disc_ctx->res_idx];
-    uint16_t insts_count = _anj_dm_count_res_insts(res);
-    assert(disc_ctx->res_inst_idx < insts_count);
-    anj_riid_t riid = res->insts[disc_ctx->res_inst_idx];
+    anj_riid_t riid =
+            _anj_dm_next_res_inst(inst, res, &disc_ctx->res_inst_idx);
+    assert(riid != ANJ_ID_INVALID);
     *out_path = ANJ_MAKE_RESOURCE_INSTANCE_PATH(obj->oid, inst->iid, res->rid,
                                                 riid);
 
-    disc_ctx->res_inst_idx++;
-    if (disc_ctx->res_inst_idx == insts_count) {
+    uint16_t cursor = disc_ctx->res_inst_idx;
+    if (_anj_dm_next_res_inst(inst, res, &cursor) == ANJ_ID_INVALID) {
         disc_ctx->res_inst_idx = 0;
         disc_ctx->level = ANJ_ID_RID;
-        increment_idx_starting_from_res(disc_ctx, inst->res_count);
+        increment_idx_starting_from_res(dm);
     }
 }
 
@@ -47,6 +47,13 @@ int _anj_dm_execute(anj_t *anj,
     int result = dm->entity_ptrs.obj->handlers->res_execute(
             anj, dm->entity_ptrs.obj, dm->entity_ptrs.inst->iid,
             dm->entity_ptrs.res->rid, execute_arg, execute_arg_len);
+#ifdef ANJ_WITH_SEPARATE_RESPONSE
+    if (result == ANJ_DM_PENDING && dm->pending_allowed) {
+        dm_log(L_DEBUG, "Execute operation pending");
+        dm->pending = true;
+        return 0;
+    }
+#endif // ANJ_WITH_SEPARATE_RESPONSE
     if (result) {
         dm_log(L_ERROR, "res_execute handler failed.");
         return result;
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#define ANJ_LOG_SOURCE_FILE_ID 71
+
+#include <assert.h>
+#include <stddef.h>
+
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/dm/core.h>
+#include <anj/dm/execute_job.h>
+#include <anj/log.h>
+#include <anj/utils.h>
+
+#include "dm_core.h"
+
+#ifdef ANJ_DM_WITH_EXECUTE_JOB
+
+void anj_dm_execute_job_init(anj_dm_execute_job_t *job,
+                             const anj_uri_path_t *status_path) {
+    assert(job);
+    assert(!status_path || anj_uri_path_has(status_path, ANJ_ID_RID));
+    job->status_path = status_path ? *status_path : ANJ_MAKE_ROOT_PATH();
+    job->state = ANJ_DM_EXECUTE_JOB_STATE_IDLE;
+    job->result = 0;
+}
+
+int anj_dm_execute_job_start(anj_dm_execute_job_t *job) {
+    assert(job);
+    if (job->state == ANJ_DM_EXECUTE_JOB_STATE_RUNNING) {
+        dm_log(L_WARNING, "Job already running");
+        return ANJ_DM_ERR_SERVICE_UNAVAILABLE;
+    }
+    job->state = ANJ_DM_EXECUTE_JOB_STATE_RUNNING;
+    job->result = 0;
+    return 0;
+}
+
+int anj_dm_execute_job_finish(anj_t *anj,
+                              anj_dm_execute_job_t *job,
+                              int result) {
+    assert(anj && job);
+    if (job->state != ANJ_DM_EXECUTE_JOB_STATE_RUNNING) {
+        dm_log(L_ERROR, "Job not running");
+        return -1;
+    }
+    job->state = result ? ANJ_DM_EXECUTE_JOB_STATE_FAILED
+                        : ANJ_DM_EXECUTE_JOB_STATE_SUCCEEDED;
+    job->result = result;
+    if (anj_uri_path_has(&job->status_path, ANJ_ID_RID)) {
+        anj_core_data_model_changed(anj, &job->status_path,
+                                    ANJ_CORE_CHANGE_TYPE_VALUE_CHANGED);
+    }
+    return 0;
+}
+
+anj_dm_execute_job_state_t
+anj_dm_execute_job_get_state(const anj_dm_execute_job_t *job) {
+    assert(job);
+    return job->state;
+}
+
+int anj_dm_execute_job_get_result(const anj_dm_execute_job_t *job) {
+    assert(job);
+    return job->result;
+}
+
+#endif // ANJ_DM_WITH_EXECUTE_JOB
@@ -22,8 +22,11 @@
 #include <anj/dm/core.h>
 #include <anj/dm/defs.h>
 #include <anj/dm/fw_update.h>
+#include <anj/log.h>
 #include <anj/utils.h>
 
+#include "dm_core.h"
+
 #ifdef ANJ_WITH_DEFAULT_FOTA_OBJ
 
 /* FOTA method support */
@@ -204,21 +207,286 @@ static void fw_data_model_changed(anj_t *anj,
                                 ANJ_CORE_CHANGE_TYPE_VALUE_CHANGED);
 }
 
+#    ifdef ANJ_FOTA_WITH_PACKAGE_DIGEST
+static bool digest_handlers_set(const anj_dm_fw_update_handlers_t *handlers) {
+    return handlers->digest_init && handlers->digest_update
+           && handlers->digest_finish;
+}
+
+static anj_dm_fw_update_result_t
+digest_start(anj_dm_fw_update_entity_ctx_t *entity_ctx) {
+    entity_ctx->repr.digest_in_progress = false;
+    if (!digest_handlers_set(entity_ctx->repr.user_handlers)) {
+        return ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+    }
+    if (entity_ctx->repr.user_handlers->digest_init(
+                entity_ctx->repr.user_ptr)) {
+        dm_log(L_ERROR, "Failed to initialize package digest");
+        return ANJ_DM_FW_UPDATE_RESULT_FAILED;
+    }
+    entity_ctx->repr.digest_in_progress = true;
+    return ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+}
+
+static anj_dm_fw_update_result_t
+digest_feed(anj_dm_fw_update_entity_ctx_t *entity_ctx,
+            const void *data,
+            size_t data_size) {
+    if (!entity_ctx->repr.digest_in_progress) {
+        return ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+    }
+    if (entity_ctx->repr.user_handlers->digest_update(entity_ctx->repr.user_ptr,
+                                                      data, data_size)) {
+        dm_log(L_ERROR, "Failed to update package digest");
+        return ANJ_DM_FW_UPDATE_RESULT_FAILED;
+    }
+    return ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+}
+
+static anj_dm_fw_update_result_t
+digest_verify(anj_dm_fw_update_entity_ctx_t *entity_ctx) {
+    if (!entity_ctx->repr.digest_in_progress) {
+        return ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+    }
+    entity_ctx->repr.digest_in_progress = false;
+    uint8_t digest[ANJ_FOTA_DIGEST_MAX_SIZE];
+    size_t digest_size = 0;
+    if (entity_ctx->repr.user_handlers->digest_finish(entity_ctx->repr.user_ptr,
+                                                      digest, &digest_size)) {
+        dm_log(L_ERROR, "Failed to finalize package digest");
+        return ANJ_DM_FW_UPDATE_RESULT_FAILED;
+    }
+    size_t expected_size = entity_ctx->repr.expected_digest_size;
+    entity_ctx->repr.expected_digest_size = 0;
+    if (!expected_size) {
+        dm_log(L_ERROR, "Expected package digest not set");
+        return ANJ_DM_FW_UPDATE_RESULT_INTEGRITY_FAILURE;
+    }
+    uint8_t diff = (uint8_t) (digest_size != expected_size);
+    for (size_t i = 0; !diff && i < expected_size; i++) {
+        diff |= (uint8_t) (digest[i] ^ entity_ctx->repr.expected_digest[i]);
+    }
+    if (diff) {
+        dm_log(L_ERROR, "Package digest mismatch");
+        return ANJ_DM_FW_UPDATE_RESULT_INTEGRITY_FAILURE;
+    }
+    return ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+}
+#    endif // ANJ_FOTA_WITH_PACKAGE_DIGEST
+
 static void reset(anj_t *anj, anj_dm_fw_update_entity_ctx_t *entity_ctx) {
     entity_ctx->repr.user_handlers->reset_handler(entity_ctx->repr.user_ptr);
     entity_ctx->repr.state = ANJ_DM_FW_UPDATE_STATE_IDLE;
     fw_data_model_changed(anj, entity_ctx, ANJ_DM_FW_UPDATE_RID_STATE);
 
+#    ifdef ANJ_FOTA_WITH_PACKAGE_DIGEST
+    entity_ctx->repr.digest_in_progress = false;
+    entity_ctx->repr.expected_digest_size = 0;
+#    endif // ANJ_FOTA_WITH_PACKAGE_DIGEST
+
 #    ifdef ANJ_FOTA_WITH_PUSH_METHOD
     entity_ctx->repr.write_start_called = false;
 #    endif // ANJ_FOTA_WITH_PUSH_METHOD
 
+#    ifdef ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
+    entity_ctx->repr.staging_pending = 0;
+    entity_ctx->repr.finish_pending = false;
+#    endif // ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
+
 #    ifdef ANJ_FOTA_WITH_PULL_METHOD
     entity_ctx->repr.uri[0] = '\0';
     fw_data_model_changed(anj, entity_ctx, ANJ_DM_FW_UPDATE_RID_PACKAGE_URI);
 #    endif // ANJ_FOTA_WITH_PULL_METHOD
 }
 
+#    ifdef ANJ_FOTA_WITH_PUSH_METHOD
+static anj_dm_fw_update_result_t
+package_write_finish(anj_dm_fw_update_entity_ctx_t *entity_ctx) {
+#        ifdef ANJ_FOTA_WITH_PACKAGE_DIGEST
+    // verified before finish, so that a corrupted package is not finalized in
+    // the storage
+    anj_dm_fw_update_result_t result = digest_verify(entity_ctx);
+    if (result != ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
+        return result;
+    }
+#        endif // ANJ_FOTA_WITH_PACKAGE_DIGEST
+#        ifdef ANJ_FOTA_WITH_DECOMPRESSION
+    bool decompress = true;
+#            ifdef ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
+    // asynchronous writes bypass the decompressor
+    decompress = !entity_ctx->repr.user_handlers->package_write_async_handler;
+#            endif // ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
+    if (decompress) {
+        anj_dm_fw_update_result_t decompress_result =
+                anj_dm_fw_update_decompress_finish(
+                        &entity_ctx->repr.decompress);
+        if (decompress_result != ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
+            return decompress_result;
+        }
+    }
+#        endif // ANJ_FOTA_WITH_DECOMPRESSION
+#        ifdef ANJ_FOTA_WITH_DELTA_UPDATE
+    if (entity_ctx->repr.user_handlers->old_image_read) {
+        // the digest covers the received patch, not the resulting image
+        anj_dm_fw_update_result_t delta_result =
+                anj_dm_fw_update_delta_finish(&entity_ctx->repr.delta);
+        if (delta_result != ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
+            return delta_result;
+        }
+    }
+#        endif // ANJ_FOTA_WITH_DELTA_UPDATE
+#        ifdef ANJ_FOTA_WITH_PAGE_ALIGNED_WRITES
+    if (entity_ctx->repr.user_handlers->write_page_size) {
+        anj_dm_fw_update_result_t page_result =
+                anj_dm_fw_update_page_writer_finish(
+                        &entity_ctx->repr.page_writer);
+        if (page_result != ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
+            return page_result;
+        }
+    }
+#        endif // ANJ_FOTA_WITH_PAGE_ALIGNED_WRITES
+    return entity_ctx->repr.user_handlers->package_write_finish_handler(
+            entity_ctx->repr.user_ptr);
+}
+
+// receives the final package, i.e. the new image if it's a delta patch
+static anj_dm_fw_update_result_t
+package_write_image(void *entity_ctx_ptr, const void *data, size_t data_size) {
+    anj_dm_fw_update_entity_ctx_t *entity_ctx =
+            (anj_dm_fw_update_entity_ctx_t *) entity_ctx_ptr;
+#        ifdef ANJ_FOTA_WITH_PAGE_ALIGNED_WRITES
+    if (entity_ctx->repr.user_handlers->write_page_size) {
+        return anj_dm_fw_update_page_writer_feed(&entity_ctx->repr.page_writer,
+                                                 data, data_size);
+    }
+#        endif // ANJ_FOTA_WITH_PAGE_ALIGNED_WRITES
+    return entity_ctx->repr.user_handlers->package_write_handler(
+            entity_ctx->repr.user_ptr, data, data_size);
+}
+
+#        ifdef ANJ_FOTA_WITH_DELTA_UPDATE
+static int old_image_read(void *entity_ctx_ptr,
+                          size_t offset,
+                          void *buff,
+                          size_t size) {
+    anj_dm_fw_update_entity_ctx_t *entity_ctx =
+            (anj_dm_fw_update_entity_ctx_t *) entity_ctx_ptr;
+    return entity_ctx->repr.user_handlers->old_image_read(
+            entity_ctx->repr.user_ptr, offset, buff, size);
+}
+#        endif // ANJ_FOTA_WITH_DELTA_UPDATE
+
+// receives the package after decompression, if it's enabled
+static anj_dm_fw_update_result_t
+package_write_plain(void *entity_ctx_ptr, const void *data, size_t data_size) {
+#        ifdef ANJ_FOTA_WITH_DELTA_UPDATE
+    anj_dm_fw_update_entity_ctx_t *entity_ctx =
+            (anj_dm_fw_update_entity_ctx_t *) entity_ctx_ptr;
+    if (entity_ctx->repr.user_handlers->old_image_read) {
+        return anj_dm_fw_update_delta_feed(&entity_ctx->repr.delta, data,
+                                           data_size);
+    }
+#        endif // ANJ_FOTA_WITH_DELTA_UPDATE
+    return package_write_image(entity_ctx_ptr, data, data_size);
+}
+
+static anj_dm_fw_update_result_t
+package_write(anj_dm_fw_update_entity_ctx_t *entity_ctx,
+              const void *data,
+              size_t data_size) {
+#        ifdef ANJ_FOTA_WITH_DECOMPRESSION
+    return anj_dm_fw_update_decompress_feed(&entity_ctx->repr.decompress, data,
+                                            data_size);
+#        else  // ANJ_FOTA_WITH_DECOMPRESSION
+    return package_write_plain(entity_ctx, data, data_size);
+#        endif // ANJ_FOTA_WITH_DECOMPRESSION
+}
+
+static int package_write_failed(anj_t *anj,
+                                anj_dm_fw_update_entity_ctx_t *entity_ctx,
+                                anj_dm_fw_update_result_t result) {
+    entity_ctx->repr.result = (int8_t) result;
+    reset(anj, entity_ctx);
+    fw_data_model_changed(anj, entity_ctx, ANJ_DM_FW_UPDATE_RID_UPDATE_RESULT);
+    return ANJ_DM_ERR_INTERNAL;
+}
+
+static int package_download_finish(anj_t *anj,
+                                   anj_dm_fw_update_entity_ctx_t *entity_ctx) {
+    anj_dm_fw_update_result_t result = package_write_finish(entity_ctx);
+    if (result != ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
+        return package_write_failed(anj, entity_ctx, result);
+    }
+    entity_ctx->repr.result = ANJ_DM_FW_UPDATE_RESULT_INITIAL;
+    entity_ctx->repr.state = ANJ_DM_FW_UPDATE_STATE_DOWNLOADED;
+    fw_data_model_changed(anj, entity_ctx, ANJ_DM_FW_UPDATE_RID_UPDATE_RESULT);
+    fw_data_model_changed(anj, entity_ctx, ANJ_DM_FW_UPDATE_RID_STATE);
+    return 0;
+}
+#    endif // ANJ_FOTA_WITH_PUSH_METHOD
+
+#    ifdef ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
+static int staging_complete(anj_t *anj,
+                            anj_dm_fw_update_entity_ctx_t *entity_ctx,
+                            anj_dm_fw_update_result_t result) {
+    assert(entity_ctx->repr.staging_pending);
+    entity_ctx->repr.staging_pending--;
+    if (result != ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
+        return package_write_failed(anj, entity_ctx, result);
+    }
+    if (!entity_ctx->repr.staging_pending && entity_ctx->repr.finish_pending) {
+        entity_ctx->repr.finish_pending = false;
+        return package_download_finish(anj, entity_ctx);
+    }
+    return 0;
+}
+
+static int package_write_async(anj_t *anj,
+                               anj_dm_fw_update_entity_ctx_t *entity_ctx,
+                               const anj_res_value_t *value) {
+    size_t chunk_length = value->bytes_or_string.chunk_length;
+    if (chunk_length > ANJ_FOTA_PUSH_STAGING_BUFFER_SIZE) {
+        dm_log(L_ERROR, "Package chunk does not fit in the staging buffer");
+        return package_write_failed(anj, entity_ctx,
+                                    ANJ_DM_FW_UPDATE_RESULT_OUT_OF_MEMORY);
+    }
+    if (entity_ctx->repr.staging_pending
+            == ANJ_ARRAY_SIZE(entity_ctx->repr.staging)) {
+        if (!entity_ctx->repr.user_handlers->package_write_wait_handler) {
+            return ANJ_DM_ERR_SERVICE_UNAVAILABLE;
+        }
+        int res = staging_complete(
+                anj, entity_ctx,
+                entity_ctx->repr.user_handlers->package_write_wait_handler(
+                        entity_ctx->repr.user_ptr));
+        if (res) {
+            return res;
+        }
+    }
+
+    // writes are completed in order, so the next buffer is always the free one
+    uint8_t *buffer = entity_ctx->repr.staging[entity_ctx->repr.staging_next];
+    memcpy(buffer, value->bytes_or_string.data, chunk_length);
+    anj_dm_fw_update_result_t result =
+            entity_ctx->repr.user_handlers->package_write_async_handler(
+                    entity_ctx->repr.user_ptr, buffer, chunk_length);
+#        ifdef ANJ_FOTA_WITH_PACKAGE_DIGEST
+    if (result == ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
+        result = digest_feed(entity_ctx, buffer, chunk_length);
+    }
+#        endif // ANJ_FOTA_WITH_PACKAGE_DIGEST
+    if (result != ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
+        return package_write_failed(anj, entity_ctx, result);
+    }
+    entity_ctx->repr.staging_next ^= 1;
+    entity_ctx->repr.staging_pending++;
+    if (writing_last_data_chunk(value)) {
+        entity_ctx->repr.finish_pending = true;
+    }
+    return 0;
+}
+#    endif // ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
+
 static int res_write(anj_t *anj,
                      const anj_dm_obj_t *obj,
                      anj_iid_t iid,
@@ -261,6 +529,13 @@ static int res_write(anj_t *anj,
 
         // handle first chunk if needed
         if (!entity->repr.write_start_called) {
+#        ifdef ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
+            // download aborted by a failed asynchronous write, the rest of the
+            // package must not be taken for a new one
+            if (value->bytes_or_string.offset) {
+                return ANJ_DM_ERR_INTERNAL;
+            }
+#        endif // ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
             result = entity->repr.user_handlers->package_write_start_handler(
                     entity->repr.user_ptr);
             if (result != ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
@@ -270,38 +545,56 @@ static int res_write(anj_t *anj,
                 return ANJ_DM_ERR_INTERNAL;
             }
             entity->repr.write_start_called = true;
+#        ifdef ANJ_FOTA_WITH_DELTA_UPDATE
+            if (entity->repr.user_handlers->old_image_read) {
+                anj_dm_fw_update_delta_init(&entity->repr.delta,
+                                            old_image_read, package_write_image,
+                                            entity);
+            }
+#        endif // ANJ_FOTA_WITH_DELTA_UPDATE
+#        ifdef ANJ_FOTA_WITH_PAGE_ALIGNED_WRITES
+            if (entity->repr.user_handlers->write_page_size) {
+                anj_dm_fw_update_page_writer_init(
+                        &entity->repr.page_writer,
+                        entity->repr.user_handlers->package_write_handler,
+                        entity->repr.user_ptr,
+                        entity->repr.user_handlers->write_page_size, 0);
+            }
+#        endif // ANJ_FOTA_WITH_PAGE_ALIGNED_WRITES
+#        ifdef ANJ_FOTA_WITH_DECOMPRESSION
+            anj_dm_fw_update_decompress_init(&entity->repr.decompress,
+                                             package_write_plain, entity);
+#        endif // ANJ_FOTA_WITH_DECOMPRESSION
+#        ifdef ANJ_FOTA_WITH_PACKAGE_DIGEST
+            result = digest_start(entity);
+            if (result != ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
+                return package_write_failed(anj, entity, result);
+            }
+#        endif // ANJ_FOTA_WITH_PACKAGE_DIGEST
         }
 
+#        ifdef ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
+        if (entity->repr.user_handlers->package_write_async_handler) {
+            return package_write_async(anj, entity, value);
+        }
+#        endif // ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
+
         // write actual data
-        result = entity->repr.user_handlers->package_write_handler(
-                entity->repr.user_ptr,
-                value->bytes_or_string.data,
-                value->bytes_or_string.chunk_length);
+        result = package_write(entity, value->bytes_or_string.data,
+                               value->bytes_or_string.chunk_length);
+#        ifdef ANJ_FOTA_WITH_PACKAGE_DIGEST
+        if (result == ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
+            result = digest_feed(entity, value->bytes_or_string.data,
+                                 value->bytes_or_string.chunk_length);
+        }
+#        endif // ANJ_FOTA_WITH_PACKAGE_DIGEST
         if (result != ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
-            entity->repr.result = (int8_t) result;
-            reset(anj, entity);
-            fw_data_model_changed(
-                    anj, entity, ANJ_DM_FW_UPDATE_RID_UPDATE_RESULT);
-            return ANJ_DM_ERR_INTERNAL;
+            return package_write_failed(anj, entity, result);
         }
 
         // check if that's the last chunk (block)
         if (writing_last_data_chunk(value)) {
-            result = entity->repr.user_handlers->package_write_finish_handler(
-                    entity->repr.user_ptr);
-            if (result != ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
-                entity->repr.result = (int8_t) result;
-                reset(anj, entity);
-                fw_data_model_changed(
-                        anj, entity, ANJ_DM_FW_UPDATE_RID_UPDATE_RESULT);
-                return ANJ_DM_ERR_INTERNAL;
-            } else {
-                entity->repr.result = ANJ_DM_FW_UPDATE_RESULT_INITIAL;
-                entity->repr.state = ANJ_DM_FW_UPDATE_STATE_DOWNLOADED;
-                fw_data_model_changed(
-                        anj, entity, ANJ_DM_FW_UPDATE_RID_UPDATE_RESULT);
-                fw_data_model_changed(anj, entity, ANJ_DM_FW_UPDATE_RID_STATE);
-            }
+            return package_download_finish(anj, entity);
         }
 
         return 0;
@@ -351,6 +644,16 @@ static int res_write(anj_t *anj,
 
         entity->repr.state = ANJ_DM_FW_UPDATE_STATE_DOWNLOADING;
         fw_data_model_changed(anj, entity, ANJ_DM_FW_UPDATE_RID_STATE);
+#        ifdef ANJ_FOTA_WITH_PACKAGE_DIGEST
+        result = digest_start(entity);
+        if (result != ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
+            entity->repr.result = (int8_t) result;
+            reset(anj, entity);
+            fw_data_model_changed(
+                    anj, entity, ANJ_DM_FW_UPDATE_RID_UPDATE_RESULT);
+            return ANJ_DM_ERR_INTERNAL;
+        }
+#        endif // ANJ_FOTA_WITH_PACKAGE_DIGEST
         return 0;
 #    endif // !defined (ANJ_FOTA_WITH_PULL_METHOD)
     }
@@ -477,11 +780,32 @@ int anj_dm_fw_update_object_install(anj_t *anj,
     memset(entity_ctx, 0, sizeof(*entity_ctx));
 
 #    ifdef ANJ_FOTA_WITH_PUSH_METHOD
-    if (!handlers->package_write_start_handler
-            || !handlers->package_write_handler
+    bool write_handler_set = !!handlers->package_write_handler;
+#        ifdef ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
+    write_handler_set =
+            write_handler_set || !!handlers->package_write_async_handler;
+#        endif // ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
+    if (!handlers->package_write_start_handler || !write_handler_set
             || !handlers->package_write_finish_handler) {
         return -1;
     }
+#        ifdef ANJ_FOTA_WITH_DELTA_UPDATE
+    if (handlers->old_image_read && !handlers->package_write_handler) {
+        return -1;
+    }
+#            ifdef ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
+    if (handlers->old_image_read && handlers->package_write_async_handler) {
+        return -1;
+    }
+#            endif // ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
+#        endif     // ANJ_FOTA_WITH_DELTA_UPDATE
+#        ifdef ANJ_FOTA_WITH_PAGE_ALIGNED_WRITES
+    if (handlers->write_page_size
+            && (handlers->write_page_size > ANJ_FOTA_WRITE_PAGE_MAX_SIZE
+                || !handlers->package_write_handler)) {
+        return -1;
+    }
+#        endif // ANJ_FOTA_WITH_PAGE_ALIGNED_WRITES
     entity_ctx->repr.write_start_called = false;
 #    endif // ANJ_FOTA_WITH_PUSH_METHOD
 
@@ -491,6 +815,15 @@ int anj_dm_fw_update_object_install(anj_t *anj,
     }
 #    endif // ANJ_FOTA_WITH_PULL_METHOD
 
+#    ifdef ANJ_FOTA_WITH_PACKAGE_DIGEST
+    // digest handlers are optional, but only all together
+    if (!digest_handlers_set(handlers)
+            && (handlers->digest_init || handlers->digest_update
+                || handlers->digest_finish)) {
+        return -1;
+    }
+#    endif // ANJ_FOTA_WITH_PACKAGE_DIGEST
+
     entity_ctx->repr.user_ptr = user_ptr;
     entity_ctx->repr.user_handlers = handlers;
 
@@ -531,6 +864,11 @@ int anj_dm_fw_update_object_set_download_result(
     if (entity_ctx->repr.state != ANJ_DM_FW_UPDATE_STATE_DOWNLOADING) {
         return -1;
     }
+#    ifdef ANJ_FOTA_WITH_PACKAGE_DIGEST
+    if (result == ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
+        result = digest_verify(entity_ctx);
+    }
+#    endif // ANJ_FOTA_WITH_PACKAGE_DIGEST
     if (result != ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
         entity_ctx->repr.result = (int8_t) result;
         reset(anj, entity_ctx);
@@ -546,4 +884,53 @@ int anj_dm_fw_update_object_set_download_result(
     return 0;
 }
 
+#    ifdef ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
+int anj_dm_fw_update_object_package_write_completed(
+        anj_t *anj,
+        anj_dm_fw_update_entity_ctx_t *entity_ctx,
+        anj_dm_fw_update_result_t result) {
+    assert(entity_ctx);
+    if (!entity_ctx->repr.staging_pending) {
+        return -1;
+    }
+    (void) staging_complete(anj, entity_ctx, result);
+    return 0;
+}
+#    endif // ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
+
+#    ifdef ANJ_FOTA_WITH_PACKAGE_DIGEST
+int anj_dm_fw_update_object_set_expected_digest(
+        anj_dm_fw_update_entity_ctx_t *entity_ctx,
+        const uint8_t *digest,
+        size_t digest_size) {
+    assert(entity_ctx && digest);
+    if (!digest_size
+            || digest_size > sizeof(entity_ctx->repr.expected_digest)) {
+        return -1;
+    }
+    memcpy(entity_ctx->repr.expected_digest, digest, digest_size);
+    entity_ctx->repr.expected_digest_size = digest_size;
+    return 0;
+}
+
+#        ifdef ANJ_FOTA_WITH_PULL_METHOD
+int anj_dm_fw_update_object_digest_update(
+        anj_dm_fw_update_entity_ctx_t *entity_ctx,
+        const void *data,
+        size_t data_size) {
+    assert(entity_ctx);
+    if (entity_ctx->repr.state != ANJ_DM_FW_UPDATE_STATE_DOWNLOADING) {
+        return -1;
+    }
+    if (digest_feed(entity_ctx, data, data_size)
+            != ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
+        // the package can't be verified anymore
+        entity_ctx->repr.expected_digest_size = 0;
+        return -1;
+    }
+    return 0;
+}
+#        endif // ANJ_FOTA_WITH_PULL_METHOD
+#    endif     // ANJ_FOTA_WITH_PACKAGE_DIGEST
+
 #endif // ANJ_WITH_DEFAULT_FOTA_OBJ
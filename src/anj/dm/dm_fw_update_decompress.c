@@ -0,0 +1,228 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#define ANJ_LOG_SOURCE_FILE_ID 79
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/dm/fw_update.h>
+#include <anj/log.h>
+#include <anj/utils.h>
+
+#include "dm_core.h"
+
+#ifdef ANJ_FOTA_WITH_DECOMPRESSION
+
+#    define COMPRESSED_HEADER "ANJZ"
+#    define COMPRESSED_HEADER_LEN (sizeof(COMPRESSED_HEADER) - 1)
+
+#    define WINDOW_MASK (((size_t) 1 << ANJ_FOTA_DECOMPRESSION_WINDOW_BITS) - 1)
+
+enum {
+    DECOMPRESS_STATE_HEADER,
+    DECOMPRESS_STATE_PARAMS,
+    DECOMPRESS_STATE_PASSTHROUGH,
+    DECOMPRESS_STATE_TAG,
+    DECOMPRESS_STATE_LITERAL,
+    DECOMPRESS_STATE_INDEX,
+    DECOMPRESS_STATE_COUNT,
+    DECOMPRESS_STATE_ERROR
+};
+
+static anj_dm_fw_update_result_t
+decompress_failed(anj_dm_fw_update_decompress_ctx_t *ctx,
+                  anj_dm_fw_update_result_t result) {
+    ctx->state = DECOMPRESS_STATE_ERROR;
+    return result;
+}
+
+static anj_dm_fw_update_result_t
+write_output(anj_dm_fw_update_decompress_ctx_t *ctx,
+             const void *data,
+             size_t size) {
+    if (!size) {
+        return ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+    }
+    anj_dm_fw_update_result_t result = ctx->output(ctx->user_ptr, data, size);
+    if (result != ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
+        return decompress_failed(ctx, result);
+    }
+    return ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+}
+
+static anj_dm_fw_update_result_t
+flush_window(anj_dm_fw_update_decompress_ctx_t *ctx) {
+    // the window is flushed every time it wraps, so the data is contiguous
+    size_t len = ctx->head - ctx->flushed;
+    size_t pos = ctx->flushed & WINDOW_MASK;
+    ctx->flushed = ctx->head;
+    return write_output(ctx, &ctx->window[pos], len);
+}
+
+static anj_dm_fw_update_result_t
+emit(anj_dm_fw_update_decompress_ctx_t *ctx, uint8_t byte) {
+    ctx->window[ctx->head & WINDOW_MASK] = byte;
+    if (!(++ctx->head & WINDOW_MASK)) {
+        return flush_window(ctx);
+    }
+    return ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+}
+
+static void
+expect(anj_dm_fw_update_decompress_ctx_t *ctx, uint8_t state, uint8_t bits) {
+    ctx->state = state;
+    ctx->bits_left = bits;
+    ctx->value = 0;
+}
+
+static anj_dm_fw_update_result_t
+symbol_complete(anj_dm_fw_update_decompress_ctx_t *ctx) {
+    anj_dm_fw_update_result_t result = ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+    switch (ctx->state) {
+    case DECOMPRESS_STATE_TAG:
+        if (ctx->value) {
+            expect(ctx, DECOMPRESS_STATE_LITERAL, 8);
+        } else {
+            expect(ctx, DECOMPRESS_STATE_INDEX, ctx->window_bits);
+        }
+        break;
+    case DECOMPRESS_STATE_LITERAL:
+        result = emit(ctx, (uint8_t) ctx->value);
+        expect(ctx, DECOMPRESS_STATE_TAG, 1);
+        break;
+    case DECOMPRESS_STATE_INDEX:
+        ctx->index = (uint16_t) (ctx->value + 1);
+        expect(ctx, DECOMPRESS_STATE_COUNT, ctx->lookahead_bits);
+        break;
+    default:
+        assert(ctx->state == DECOMPRESS_STATE_COUNT);
+        // offsets before the start of data refer to the zeroed window
+        for (size_t i = 0;
+             i <= ctx->value && result == ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+             i++) {
+            result = emit(ctx, ctx->window[(ctx->head - ctx->index)
+                                           & WINDOW_MASK]);
+        }
+        expect(ctx, DECOMPRESS_STATE_TAG, 1);
+        break;
+    }
+    return result;
+}
+
+static anj_dm_fw_update_result_t
+decode_byte(anj_dm_fw_update_decompress_ctx_t *ctx, uint8_t byte) {
+    for (int bit = 7; bit >= 0; bit--) {
+        ctx->value = (uint16_t) ((ctx->value << 1) | ((byte >> bit) & 1));
+        if (--ctx->bits_left) {
+            continue;
+        }
+        anj_dm_fw_update_result_t result = symbol_complete(ctx);
+        if (result != ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
+            return result;
+        }
+    }
+    return ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+}
+
+static anj_dm_fw_update_result_t
+read_params(anj_dm_fw_update_decompress_ctx_t *ctx, uint8_t params) {
+    ctx->window_bits = (uint8_t) (params >> 4);
+    ctx->lookahead_bits = (uint8_t) (params & 0x0F);
+    if (ctx->window_bits < 4
+            || ctx->window_bits > ANJ_FOTA_DECOMPRESSION_WINDOW_BITS
+            || ctx->lookahead_bits < 3
+            || ctx->lookahead_bits >= ctx->window_bits) {
+        dm_log(L_ERROR, "Unsupported compressed package parameters: %u, %u",
+               (unsigned) ctx->window_bits, (unsigned) ctx->lookahead_bits);
+        return decompress_failed(
+                ctx, ANJ_DM_FW_UPDATE_RESULT_UNSUPPORTED_PACKAGE_TYPE);
+    }
+    expect(ctx, DECOMPRESS_STATE_TAG, 1);
+    return ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+}
+
+void anj_dm_fw_update_decompress_init(anj_dm_fw_update_decompress_ctx_t *ctx,
+                                      anj_dm_fw_update_package_write_t *output,
+                                      void *user_ptr) {
+    assert(ctx && output);
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->output = output;
+    ctx->user_ptr = user_ptr;
+    ctx->state = DECOMPRESS_STATE_HEADER;
+}
+
+anj_dm_fw_update_result_t
+anj_dm_fw_update_decompress_feed(anj_dm_fw_update_decompress_ctx_t *ctx,
+                                 const void *data,
+                                 size_t data_size) {
+    assert(ctx && (data || !data_size));
+    const uint8_t *in = (const uint8_t *) data;
+    const uint8_t *end = in + data_size;
+
+    while (in < end && ctx->state == DECOMPRESS_STATE_HEADER) {
+        if (*in != (uint8_t) COMPRESSED_HEADER[ctx->header_len]) {
+            // not compressed, pass the header prefix seen so far as well
+            ctx->state = DECOMPRESS_STATE_PASSTHROUGH;
+            anj_dm_fw_update_result_t result =
+                    write_output(ctx, COMPRESSED_HEADER, ctx->header_len);
+            if (result != ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
+                return result;
+            }
+            break;
+        }
+        in++;
+        if (++ctx->header_len == COMPRESSED_HEADER_LEN) {
+            ctx->state = DECOMPRESS_STATE_PARAMS;
+        }
+    }
+    if (in < end && ctx->state == DECOMPRESS_STATE_PARAMS) {
+        anj_dm_fw_update_result_t result = read_params(ctx, *in++);
+        if (result != ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
+            return result;
+        }
+    }
+
+    switch (ctx->state) {
+    case DECOMPRESS_STATE_ERROR:
+        return ANJ_DM_FW_UPDATE_RESULT_FAILED;
+    case DECOMPRESS_STATE_PASSTHROUGH:
+        return write_output(ctx, in, (size_t) (end - in));
+    default:
+        break;
+    }
+    for (; in < end; in++) {
+        anj_dm_fw_update_result_t result = decode_byte(ctx, *in);
+        if (result != ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
+            return result;
+        }
+    }
+    return ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+}
+
+anj_dm_fw_update_result_t
+anj_dm_fw_update_decompress_finish(anj_dm_fw_update_decompress_ctx_t *ctx) {
+    assert(ctx);
+    switch (ctx->state) {
+    case DECOMPRESS_STATE_ERROR:
+        return ANJ_DM_FW_UPDATE_RESULT_FAILED;
+    case DECOMPRESS_STATE_HEADER:
+        // package shorter than the header
+        return write_output(ctx, COMPRESSED_HEADER, ctx->header_len);
+    default:
+        // the last symbol may be followed by up to 7 bits of padding
+        return flush_window(ctx);
+    }
+}
+
+#endif // ANJ_FOTA_WITH_DECOMPRESSION
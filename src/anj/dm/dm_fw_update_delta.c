@@ -0,0 +1,262 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#define ANJ_LOG_SOURCE_FILE_ID 78
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/dm/fw_update.h>
+#include <anj/log.h>
+#include <anj/utils.h>
+
+#include "dm_core.h"
+
+#ifdef ANJ_FOTA_WITH_DELTA_UPDATE
+
+#    define DELTA_MAGIC "ANJD"
+#    define DELTA_MAGIC_LEN (sizeof(DELTA_MAGIC) - 1)
+
+enum {
+    DELTA_STATE_MAGIC,
+    DELTA_STATE_NEW_SIZE,
+    DELTA_STATE_OPCODE,
+    DELTA_STATE_ARG,
+    DELTA_STATE_DATA,
+    DELTA_STATE_ERROR
+};
+
+enum {
+    DELTA_OP_DIFF = 0x00,
+    DELTA_OP_EXTRA = 0x01,
+    DELTA_OP_COPY = 0x02,
+    DELTA_OP_SEEK = 0x03
+};
+
+static anj_dm_fw_update_result_t
+delta_failed(anj_dm_fw_update_delta_ctx_t *ctx,
+             anj_dm_fw_update_result_t result) {
+    ctx->state = DELTA_STATE_ERROR;
+    return result;
+}
+
+static anj_dm_fw_update_result_t
+malformed_patch(anj_dm_fw_update_delta_ctx_t *ctx) {
+    dm_log(L_ERROR, "Malformed delta patch");
+    return delta_failed(ctx, ANJ_DM_FW_UPDATE_RESULT_INTEGRITY_FAILURE);
+}
+
+static anj_dm_fw_update_result_t
+flush_window(anj_dm_fw_update_delta_ctx_t *ctx) {
+    if (!ctx->window_len) {
+        return ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+    }
+    anj_dm_fw_update_result_t result =
+            ctx->new_image_write(ctx->user_ptr, ctx->window, ctx->window_len);
+    ctx->window_len = 0;
+    if (result != ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
+        return delta_failed(ctx, result);
+    }
+    return ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+}
+
+/* Returns true once the last byte of the LEB128 number has been read. */
+static bool read_arg_byte(anj_dm_fw_update_delta_ctx_t *ctx,
+                          uint8_t byte,
+                          bool *out_overflow) {
+    if (ctx->arg_shift >= 64
+            || (ctx->arg_shift == 63 && (byte & 0x7F) > 1)) {
+        *out_overflow = true;
+        return true;
+    }
+    ctx->arg |= (uint64_t) (byte & 0x7F) << ctx->arg_shift;
+    ctx->arg_shift += 7;
+    return !(byte & 0x80);
+}
+
+static anj_dm_fw_update_result_t
+start_command(anj_dm_fw_update_delta_ctx_t *ctx) {
+    if (ctx->opcode == DELTA_OP_SEEK) {
+        // zigzag encoding: 0, -1, 1, -2, ... are stored as 0, 1, 2, 3, ...
+        uint64_t magnitude = (ctx->arg >> 1) + (ctx->arg & 1);
+        if (ctx->arg & 1) {
+            if (magnitude > ctx->old_offset) {
+                return malformed_patch(ctx);
+            }
+            ctx->old_offset -= (size_t) magnitude;
+        } else {
+            if (magnitude > SIZE_MAX - ctx->old_offset) {
+                return malformed_patch(ctx);
+            }
+            ctx->old_offset += (size_t) magnitude;
+        }
+        ctx->state = DELTA_STATE_OPCODE;
+        return ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+    }
+    if (ctx->arg > ctx->new_size - ctx->new_offset) {
+        // the patch would produce more data than declared
+        return malformed_patch(ctx);
+    }
+    ctx->remaining = (size_t) ctx->arg;
+    ctx->new_offset += ctx->remaining;
+    ctx->state = ctx->remaining ? DELTA_STATE_DATA : DELTA_STATE_OPCODE;
+    return ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+}
+
+static anj_dm_fw_update_result_t
+process_data(anj_dm_fw_update_delta_ctx_t *ctx,
+             const uint8_t **inout_data,
+             size_t *inout_size) {
+    bool needs_input = (ctx->opcode != DELTA_OP_COPY);
+    while (ctx->remaining && (*inout_size || !needs_input)) {
+        if (ctx->window_len == sizeof(ctx->window)) {
+            anj_dm_fw_update_result_t result = flush_window(ctx);
+            if (result != ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
+                return result;
+            }
+        }
+        size_t len = ANJ_MIN(ctx->remaining,
+                             sizeof(ctx->window) - ctx->window_len);
+        if (needs_input) {
+            len = ANJ_MIN(len, *inout_size);
+        }
+        uint8_t *out = &ctx->window[ctx->window_len];
+
+        if (ctx->opcode == DELTA_OP_EXTRA) {
+            memcpy(out, *inout_data, len);
+        } else {
+            if (ctx->old_image_read(ctx->user_ptr, ctx->old_offset, out,
+                                    len)) {
+                dm_log(L_ERROR, "Could not read the old firmware image");
+                return delta_failed(ctx, ANJ_DM_FW_UPDATE_RESULT_FAILED);
+            }
+            ctx->old_offset += len;
+            if (ctx->opcode == DELTA_OP_DIFF) {
+                for (size_t i = 0; i < len; i++) {
+                    out[i] = (uint8_t) (out[i] + (*inout_data)[i]);
+                }
+            }
+        }
+        if (needs_input) {
+            *inout_data += len;
+            *inout_size -= len;
+        }
+        ctx->window_len += len;
+        ctx->remaining -= len;
+    }
+    if (!ctx->remaining) {
+        ctx->state = DELTA_STATE_OPCODE;
+    }
+    return ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+}
+
+void anj_dm_fw_update_delta_init(
+        anj_dm_fw_update_delta_ctx_t *ctx,
+        anj_dm_fw_update_old_image_read_t *old_image_read,
+        anj_dm_fw_update_package_write_t *new_image_write,
+        void *user_ptr) {
+    assert(ctx && old_image_read && new_image_write);
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->old_image_read = old_image_read;
+    ctx->new_image_write = new_image_write;
+    ctx->user_ptr = user_ptr;
+    ctx->state = DELTA_STATE_MAGIC;
+}
+
+anj_dm_fw_update_result_t
+anj_dm_fw_update_delta_feed(anj_dm_fw_update_delta_ctx_t *ctx,
+                            const void *data,
+                            size_t data_size) {
+    assert(ctx && (data || !data_size));
+    const uint8_t *in = (const uint8_t *) data;
+
+    while (data_size || ctx->state == DELTA_STATE_DATA) {
+        anj_dm_fw_update_result_t result = ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+        switch (ctx->state) {
+        case DELTA_STATE_MAGIC:
+            // the magic is counted in arg until the new image size is read
+            if (*in != (uint8_t) DELTA_MAGIC[ctx->arg]) {
+                return malformed_patch(ctx);
+            }
+            in++;
+            data_size--;
+            if (++ctx->arg == DELTA_MAGIC_LEN) {
+                ctx->arg = 0;
+                ctx->state = DELTA_STATE_NEW_SIZE;
+            }
+            break;
+        case DELTA_STATE_NEW_SIZE:
+        case DELTA_STATE_ARG: {
+            bool overflow = false;
+            bool arg_complete = read_arg_byte(ctx, *in, &overflow);
+            in++;
+            data_size--;
+            if (overflow || (arg_complete && ctx->arg > SIZE_MAX)) {
+                return malformed_patch(ctx);
+            }
+            if (!arg_complete) {
+                break;
+            }
+            if (ctx->state == DELTA_STATE_NEW_SIZE) {
+                ctx->new_size = (size_t) ctx->arg;
+                ctx->state = DELTA_STATE_OPCODE;
+            } else {
+                result = start_command(ctx);
+            }
+            break;
+        }
+        case DELTA_STATE_OPCODE:
+            if (*in > DELTA_OP_SEEK) {
+                return malformed_patch(ctx);
+            }
+            ctx->opcode = *in;
+            ctx->arg = 0;
+            ctx->arg_shift = 0;
+            ctx->state = DELTA_STATE_ARG;
+            in++;
+            data_size--;
+            break;
+        case DELTA_STATE_DATA:
+            result = process_data(ctx, &in, &data_size);
+            if (ctx->state == DELTA_STATE_DATA && !data_size) {
+                // waiting for the rest of the DIFF or EXTRA data
+                return result;
+            }
+            break;
+        default:
+            return ANJ_DM_FW_UPDATE_RESULT_INTEGRITY_FAILURE;
+        }
+        if (result != ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
+            return result;
+        }
+    }
+    return ctx->state == DELTA_STATE_ERROR
+                   ? ANJ_DM_FW_UPDATE_RESULT_INTEGRITY_FAILURE
+                   : ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+}
+
+anj_dm_fw_update_result_t
+anj_dm_fw_update_delta_finish(anj_dm_fw_update_delta_ctx_t *ctx) {
+    assert(ctx);
+    if (ctx->state == DELTA_STATE_ERROR) {
+        return ANJ_DM_FW_UPDATE_RESULT_INTEGRITY_FAILURE;
+    }
+    if (ctx->state != DELTA_STATE_OPCODE || ctx->new_offset != ctx->new_size) {
+        dm_log(L_ERROR, "Incomplete delta patch");
+        return delta_failed(ctx, ANJ_DM_FW_UPDATE_RESULT_INTEGRITY_FAILURE);
+    }
+    return flush_window(ctx);
+}
+
+#endif // ANJ_FOTA_WITH_DELTA_UPDATE
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/dm/fw_update.h>
+#include <anj/utils.h>
+
+#ifdef ANJ_FOTA_WITH_PAGE_ALIGNED_WRITES
+
+static anj_dm_fw_update_result_t
+write_piece(anj_dm_fw_update_page_writer_ctx_t *ctx,
+            const void *data,
+            size_t size) {
+    ctx->offset += size;
+    return ctx->output(ctx->user_ptr, data, size);
+}
+
+void anj_dm_fw_update_page_writer_init(
+        anj_dm_fw_update_page_writer_ctx_t *ctx,
+        anj_dm_fw_update_package_write_t *output,
+        void *user_ptr,
+        size_t page_size,
+        size_t start_offset) {
+    assert(ctx && output);
+    assert(page_size > 0 && page_size <= ANJ_FOTA_WRITE_PAGE_MAX_SIZE);
+    ctx->output = output;
+    ctx->user_ptr = user_ptr;
+    ctx->page_size = page_size;
+    ctx->offset = start_offset;
+    ctx->page_len = 0;
+}
+
+anj_dm_fw_update_result_t
+anj_dm_fw_update_page_writer_feed(anj_dm_fw_update_page_writer_ctx_t *ctx,
+                                  const void *data,
+                                  size_t data_size) {
+    assert(ctx && (data || !data_size));
+    const uint8_t *in = (const uint8_t *) data;
+    const uint8_t *end = in + data_size;
+
+    while (in < end) {
+        // shorter than a page only if the start offset wasn't aligned
+        size_t piece = ctx->page_size - ctx->offset % ctx->page_size;
+        size_t available = (size_t) (end - in);
+        anj_dm_fw_update_result_t result = ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+        if (!ctx->page_len && available >= piece) {
+            result = write_piece(ctx, in, piece);
+            in += piece;
+        } else {
+            size_t len = ANJ_MIN(piece - ctx->page_len, available);
+            memcpy(&ctx->page[ctx->page_len], in, len);
+            ctx->page_len += len;
+            in += len;
+            if (ctx->page_len == piece) {
+                ctx->page_len = 0;
+                result = write_piece(ctx, ctx->page, piece);
+            }
+        }
+        if (result != ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
+            return result;
+        }
+    }
+    return ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+}
+
+anj_dm_fw_update_result_t
+anj_dm_fw_update_page_writer_finish(anj_dm_fw_update_page_writer_ctx_t *ctx) {
+    assert(ctx);
+    if (!ctx->page_len) {
+        return ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+    }
+    size_t len = ctx->page_len;
+    ctx->page_len = 0;
+    return write_piece(ctx, ctx->page, len);
+}
+
+#endif // ANJ_FOTA_WITH_PAGE_ALIGNED_WRITES
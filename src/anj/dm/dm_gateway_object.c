@@ -0,0 +1,452 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#define ANJ_LOG_SOURCE_FILE_ID 80
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/dm/core.h>
+#include <anj/dm/defs.h>
+#include <anj/dm/gateway_object.h>
+#include <anj/log.h>
+#include <anj/utils.h>
+
+#include "../utils.h"
+#include "dm_core.h"
+#include "dm_integration.h"
+#include "dm_io.h"
+
+#ifdef ANJ_WITH_LWM2M_GATEWAY
+
+#    define ANJ_DM_GATEWAY_RESOURCES_COUNT 3
+
+enum {
+    RID_DEVICE_ID = 0,
+    RID_PREFIX = 1,
+    RID_IOT_DEVICE_OBJECTS = 3
+};
+
+enum {
+    RID_DEVICE_ID_IDX = 0,
+    RID_PREFIX_IDX,
+    RID_IOT_DEVICE_OBJECTS_IDX,
+    _RID_LAST
+};
+
+ANJ_STATIC_ASSERT(_RID_LAST == ANJ_DM_GATEWAY_RESOURCES_COUNT,
+                  gateway_resources_count_mismatch);
+
+static const anj_dm_res_t RES[ANJ_DM_GATEWAY_RESOURCES_COUNT] = {
+    [RID_DEVICE_ID_IDX] = {
+        .rid = RID_DEVICE_ID,
+        .type = ANJ_DATA_TYPE_STRING,
+        .kind = ANJ_DM_RES_R
+    },
+    [RID_PREFIX_IDX] = {
+        .rid = RID_PREFIX,
+        .type = ANJ_DATA_TYPE_STRING,
+        .kind = ANJ_DM_RES_R
+    },
+    [RID_IOT_DEVICE_OBJECTS_IDX] = {
+        .rid = RID_IOT_DEVICE_OBJECTS,
+        .type = ANJ_DATA_TYPE_STRING,
+        .kind = ANJ_DM_RES_R
+    }
+};
+
+static uint16_t devices_count(const anj_dm_gateway_obj_t *gateway_obj) {
+    return _anj_dm_count_insts(gateway_obj->insts, ANJ_GATEWAY_MAX_DEVICES);
+}
+
+static anj_dm_gateway_device_t *find_device(anj_dm_gateway_obj_t *gateway_obj,
+                                            anj_iid_t iid) {
+    uint16_t count = devices_count(gateway_obj);
+    uint16_t idx = _anj_dm_find_inst_idx(gateway_obj->insts, count, iid);
+    if (idx == count || gateway_obj->insts[idx].iid != iid) {
+        return NULL;
+    }
+    return &gateway_obj->devices[idx];
+}
+
+static anj_iid_t device_iid(const anj_dm_gateway_obj_t *gateway_obj,
+                            const anj_dm_gateway_device_t *device) {
+    return gateway_obj->insts[device - gateway_obj->devices].iid;
+}
+
+static bool append(char *buff, size_t *inout_len, const char *str) {
+    size_t str_len = strlen(str);
+    // leaves space for the terminating null character
+    if (str_len >= ANJ_GATEWAY_IOT_DEVICE_OBJECTS_BUFFER_SIZE - *inout_len) {
+        return false;
+    }
+    memcpy(&buff[*inout_len], str, str_len + 1);
+    *inout_len += str_len;
+    return true;
+}
+
+static bool append_link(char *buff,
+                        size_t *inout_len,
+                        const char *prefix,
+                        anj_oid_t oid,
+                        const anj_iid_t *iid) {
+    char id_str[ANJ_U16_STR_MAX_LEN + 1];
+    if ((*inout_len && !append(buff, inout_len, ","))
+            || !append(buff, inout_len, "</")
+            || !append(buff, inout_len, prefix)
+            || !append(buff, inout_len, "/")) {
+        return false;
+    }
+    id_str[anj_uint32_to_string_value(id_str, oid)] = '\0';
+    if (!append(buff, inout_len, id_str)) {
+        return false;
+    }
+    if (iid) {
+        id_str[anj_uint32_to_string_value(id_str, *iid)] = '\0';
+        if (!append(buff, inout_len, "/") || !append(buff, inout_len, id_str)) {
+            return false;
+        }
+    }
+    return append(buff, inout_len, ">");
+}
+
+// lists the Objects and Object Instances like in the Register payload
+static int build_iot_device_objects(anj_dm_gateway_obj_t *gateway_obj,
+                                    const anj_dm_gateway_device_t *device) {
+    char *buff = gateway_obj->iot_device_objects;
+    size_t len = 0;
+    buff[0] = '\0';
+    for (uint16_t idx = 0; idx < device->objs_count; idx++) {
+        const anj_dm_obj_t *obj = device->objs[idx];
+        const anj_dm_obj_inst_t *inst = _anj_dm_first_inst(obj);
+        if (!inst
+                && !append_link(buff, &len, device->prefix, obj->oid, NULL)) {
+            return -1;
+        }
+        for (; inst; inst = _anj_dm_next_inst(obj, inst->iid)) {
+            if (!append_link(buff, &len, device->prefix, obj->oid,
+                             &inst->iid)) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+static int res_read(anj_t *anj,
+                    const anj_dm_obj_t *obj,
+                    anj_iid_t iid,
+                    anj_rid_t rid,
+                    anj_riid_t riid,
+                    anj_res_value_t *out_value) {
+    (void) anj;
+    (void) riid;
+
+    anj_dm_gateway_obj_t *gateway_obj =
+            ANJ_CONTAINER_OF(obj, anj_dm_gateway_obj_t, obj);
+    const anj_dm_gateway_device_t *device = find_device(gateway_obj, iid);
+    assert(device);
+
+    switch (rid) {
+    case RID_DEVICE_ID:
+        out_value->bytes_or_string.data = device->device_id;
+        break;
+    case RID_PREFIX:
+        out_value->bytes_or_string.data = device->prefix;
+        break;
+    case RID_IOT_DEVICE_OBJECTS:
+        if (build_iot_device_objects(gateway_obj, device)) {
+            dm_log(L_ERROR, "IoT Device Objects of /25/%" PRIu16
+                            " don't fit in the buffer",
+                   iid);
+            return ANJ_DM_ERR_INTERNAL;
+        }
+        out_value->bytes_or_string.data = gateway_obj->iot_device_objects;
+        break;
+    default:
+        return ANJ_DM_ERR_NOT_FOUND;
+    }
+    return 0;
+}
+
+static const anj_dm_handlers_t HANDLERS = {
+    .res_read = res_read
+};
+
+static bool prefix_valid(const char *prefix) {
+    // otherwise the Prefix couldn't be told apart from the data model path
+    return prefix[0] && (prefix[0] < '0' || prefix[0] > '9')
+           && !strchr(prefix, '/') && strcmp(prefix, "bs");
+}
+
+static void iot_device_objects_changed(anj_t *anj,
+                                       const anj_dm_gateway_obj_t *gateway_obj,
+                                       const anj_dm_gateway_device_t *device) {
+    anj_core_data_model_changed(
+            anj,
+            &ANJ_MAKE_RESOURCE_PATH(ANJ_OBJ_ID_LWM2M_GATEWAY,
+                                    device_iid(gateway_obj, device),
+                                    RID_IOT_DEVICE_OBJECTS),
+            ANJ_CORE_CHANGE_TYPE_VALUE_CHANGED);
+}
+
+int anj_dm_gateway_obj_install(anj_t *anj, anj_dm_gateway_obj_t *gateway_obj) {
+    assert(anj && gateway_obj);
+    if (anj->dm.gateway) {
+        dm_log(L_ERROR, "Gateway object already installed");
+        return _ANJ_DM_ERR_LOGIC;
+    }
+
+    memset(gateway_obj, 0, sizeof(*gateway_obj));
+    gateway_obj->obj = (anj_dm_obj_t) {
+        .oid = ANJ_OBJ_ID_LWM2M_GATEWAY,
+        .version = "2.0",
+        .max_inst_count = ANJ_GATEWAY_MAX_DEVICES,
+        .insts = gateway_obj->insts,
+        .handlers = &HANDLERS
+    };
+    for (uint16_t idx = 0; idx < ANJ_GATEWAY_MAX_DEVICES; idx++) {
+        gateway_obj->insts[idx].iid = ANJ_ID_INVALID;
+    }
+
+    int res = anj_dm_add_obj(anj, &gateway_obj->obj);
+    if (!res) {
+        anj->dm.gateway = gateway_obj;
+        dm_log(L_INFO, "Gateway object installed");
+    }
+    return res;
+}
+
+int anj_dm_gateway_add_device(anj_t *anj,
+                              anj_dm_gateway_obj_t *gateway_obj,
+                              anj_iid_t iid,
+                              const char *device_id,
+                              const char *prefix) {
+    assert(anj && gateway_obj && device_id && prefix);
+    if (anj->dm.op_in_progress) {
+        return _ANJ_DM_ERR_LOGIC;
+    }
+    if (iid == ANJ_ID_INVALID || !prefix_valid(prefix)) {
+        dm_log(L_ERROR, "Invalid End IoT Device IID or Prefix");
+        return _ANJ_DM_ERR_INPUT_ARG;
+    }
+    uint16_t count = devices_count(gateway_obj);
+    if (count == ANJ_GATEWAY_MAX_DEVICES) {
+        dm_log(L_ERROR, "No space for a new End IoT Device");
+        return _ANJ_DM_ERR_MEMORY;
+    }
+    for (uint16_t idx = 0; idx < count; idx++) {
+        if (!strcmp(gateway_obj->devices[idx].prefix, prefix)) {
+            dm_log(L_ERROR, "Prefix %s already used", prefix);
+            return _ANJ_DM_ERR_LOGIC;
+        }
+    }
+    uint16_t idx = _anj_dm_find_inst_idx(gateway_obj->insts, count, iid);
+    if (idx < count && gateway_obj->insts[idx].iid == iid) {
+        dm_log(L_ERROR, "End IoT Device /25/%" PRIu16 " exists", iid);
+        return _ANJ_DM_ERR_LOGIC;
+    }
+
+    memmove(&gateway_obj->insts[idx + 1], &gateway_obj->insts[idx],
+            (size_t) (count - idx) * sizeof(gateway_obj->insts[0]));
+    memmove(&gateway_obj->devices[idx + 1], &gateway_obj->devices[idx],
+            (size_t) (count - idx) * sizeof(gateway_obj->devices[0]));
+    memset(&gateway_obj->insts[idx], 0, sizeof(gateway_obj->insts[idx]));
+    gateway_obj->insts[idx].iid = iid;
+    gateway_obj->insts[idx].resources = RES;
+    gateway_obj->insts[idx].res_count = ANJ_DM_GATEWAY_RESOURCES_COUNT;
+    memset(&gateway_obj->devices[idx], 0, sizeof(gateway_obj->devices[idx]));
+    gateway_obj->devices[idx].device_id = device_id;
+    gateway_obj->devices[idx].prefix = prefix;
+
+    anj_core_data_model_changed(
+            anj, &ANJ_MAKE_INSTANCE_PATH(ANJ_OBJ_ID_LWM2M_GATEWAY, iid),
+            ANJ_CORE_CHANGE_TYPE_ADDED);
+    return 0;
+}
+
+int anj_dm_gateway_remove_device(anj_t *anj,
+                                 anj_dm_gateway_obj_t *gateway_obj,
+                                 anj_iid_t iid) {
+    assert(anj && gateway_obj);
+    if (anj->dm.op_in_progress) {
+        return _ANJ_DM_ERR_LOGIC;
+    }
+    uint16_t count = devices_count(gateway_obj);
+    uint16_t idx = _anj_dm_find_inst_idx(gateway_obj->insts, count, iid);
+    if (idx == count || gateway_obj->insts[idx].iid != iid) {
+        dm_log(L_ERROR, "End IoT Device /25/%" PRIu16 " not found", iid);
+        return ANJ_DM_ERR_NOT_FOUND;
+    }
+
+    memmove(&gateway_obj->insts[idx], &gateway_obj->insts[idx + 1],
+            (size_t) (count - idx - 1) * sizeof(gateway_obj->insts[0]));
+    memmove(&gateway_obj->devices[idx], &gateway_obj->devices[idx + 1],
+            (size_t) (count - idx - 1) * sizeof(gateway_obj->devices[0]));
+    gateway_obj->insts[count - 1].iid = ANJ_ID_INVALID;
+
+    anj_core_data_model_changed(
+            anj, &ANJ_MAKE_INSTANCE_PATH(ANJ_OBJ_ID_LWM2M_GATEWAY, iid),
+            ANJ_CORE_CHANGE_TYPE_DELETED);
+    return 0;
+}
+
+int anj_dm_gateway_add_obj(anj_t *anj,
+                           anj_dm_gateway_obj_t *gateway_obj,
+                           anj_iid_t iid,
+                           const anj_dm_obj_t *obj) {
+    assert(anj && gateway_obj && obj);
+    assert(!_anj_validate_obj_version(obj->version));
+    assert(!_anj_dm_check_obj(obj));
+
+    if (anj->dm.op_in_progress) {
+        return _ANJ_DM_ERR_LOGIC;
+    }
+    anj_dm_gateway_device_t *device = find_device(gateway_obj, iid);
+    if (!device) {
+        dm_log(L_ERROR, "End IoT Device /25/%" PRIu16 " not found", iid);
+        return ANJ_DM_ERR_NOT_FOUND;
+    }
+    if (device->objs_count == ANJ_GATEWAY_MAX_DEVICE_OBJECTS) {
+        dm_log(L_ERROR, "No space for a new object");
+        return _ANJ_DM_ERR_MEMORY;
+    }
+
+    // kept sorted by Object ID, like the data model of the Gateway
+    uint16_t idx = 0;
+    while (idx < device->objs_count && device->objs[idx]->oid < obj->oid) {
+        idx++;
+    }
+    if (idx < device->objs_count && device->objs[idx]->oid == obj->oid) {
+        dm_log(L_ERROR, "Object %" PRIu16 " exists", obj->oid);
+        return _ANJ_DM_ERR_LOGIC;
+    }
+    for (uint16_t i = device->objs_count; i > idx; i--) {
+        device->objs[i] = device->objs[i - 1];
+    }
+    device->objs[idx] = obj;
+    device->objs_count++;
+
+    iot_device_objects_changed(anj, gateway_obj, device);
+    return 0;
+}
+
+int anj_dm_gateway_remove_obj(anj_t *anj,
+                              anj_dm_gateway_obj_t *gateway_obj,
+                              anj_iid_t iid,
+                              anj_oid_t oid) {
+    assert(anj && gateway_obj);
+    if (anj->dm.op_in_progress) {
+        return _ANJ_DM_ERR_LOGIC;
+    }
+    anj_dm_gateway_device_t *device = find_device(gateway_obj, iid);
+    uint16_t idx = 0;
+    while (device && idx < device->objs_count
+           && device->objs[idx]->oid != oid) {
+        idx++;
+    }
+    if (!device || idx == device->objs_count) {
+        dm_log(L_ERROR, "Object %" PRIu16 " of /25/%" PRIu16 " not found", oid,
+               iid);
+        return ANJ_DM_ERR_NOT_FOUND;
+    }
+    for (uint16_t i = idx; i < device->objs_count - 1; i++) {
+        device->objs[i] = device->objs[i + 1];
+    }
+    device->objs_count--;
+    device->objs[device->objs_count] = NULL;
+
+    iot_device_objects_changed(anj, gateway_obj, device);
+    return 0;
+}
+
+// the data model is handled as a whole by dm_core, so the Objects of the
+// device simply take the place of the Objects of the Gateway
+static void objs_swapped(_anj_dm_data_model_t *dm) {
+#    ifdef ANJ_DM_WITH_PATH_HANDLES
+    dm->generation++;
+#    endif // ANJ_DM_WITH_PATH_HANDLES
+#    ifdef ANJ_DM_WITH_READABLE_RES_COUNT_CACHE
+    memset(dm->readable_res_count_valid, 0,
+           sizeof(dm->readable_res_count_valid));
+#    endif // ANJ_DM_WITH_READABLE_RES_COUNT_CACHE
+    (void) dm;
+}
+
+int _anj_dm_gateway_select_device(anj_t *anj,
+                                  const char *prefix,
+                                  size_t prefix_len) {
+    assert(anj && prefix);
+    _anj_dm_data_model_t *dm = &anj->dm;
+    anj_dm_gateway_obj_t *gateway_obj = dm->gateway;
+    assert(!dm->op_in_progress);
+    assert(!gateway_obj || !gateway_obj->selected);
+
+    uint16_t count = gateway_obj ? devices_count(gateway_obj) : 0;
+    uint16_t idx = 0;
+    while (idx < count
+           && (strlen(gateway_obj->devices[idx].prefix) != prefix_len
+               || memcmp(gateway_obj->devices[idx].prefix, prefix,
+                         prefix_len))) {
+        idx++;
+    }
+    if (idx == count) {
+        dm_log(L_ERROR, "End IoT Device %.*s not found", (int) prefix_len,
+               prefix);
+        return ANJ_DM_ERR_NOT_FOUND;
+    }
+
+    anj_dm_gateway_device_t *device = &gateway_obj->devices[idx];
+    memcpy(gateway_obj->gateway_objs, dm->objs, sizeof(dm->objs));
+    gateway_obj->gateway_objs_count = dm->objs_count;
+    memset(dm->objs, 0, sizeof(dm->objs));
+    memcpy(dm->objs, device->objs,
+           device->objs_count * sizeof(device->objs[0]));
+    dm->objs_count = device->objs_count;
+    gateway_obj->selected = device;
+    objs_swapped(dm);
+    dm_log(L_DEBUG, "End IoT Device /25/%" PRIu16 " selected",
+           device_iid(gateway_obj, device));
+    return 0;
+}
+
+void _anj_dm_gateway_deselect_device(anj_t *anj) {
+    assert(anj);
+    _anj_dm_data_model_t *dm = &anj->dm;
+    anj_dm_gateway_obj_t *gateway_obj = dm->gateway;
+    if (!gateway_obj || !gateway_obj->selected) {
+        return;
+    }
+    assert(!dm->op_in_progress);
+
+    // Objects can't be added nor removed during the operation
+    anj_dm_gateway_device_t *device = gateway_obj->selected;
+    memcpy(dm->objs, gateway_obj->gateway_objs, sizeof(dm->objs));
+    dm->objs_count = gateway_obj->gateway_objs_count;
+    gateway_obj->selected = NULL;
+    objs_swapped(dm);
+    if (dm->operation == ANJ_OP_DM_CREATE
+            || dm->operation == ANJ_OP_DM_DELETE) {
+        iot_device_objects_changed(anj, gateway_obj, device);
+    }
+}
+
+bool _anj_dm_gateway_device_selected(anj_t *anj) {
+    assert(anj);
+    return anj->dm.gateway && anj->dm.gateway->selected;
+}
+
+#endif // ANJ_WITH_LWM2M_GATEWAY
@@ -14,6 +14,7 @@
 #include <assert.h>
 #include <inttypes.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include <anj/core.h>
 #include <anj/defs.h>
@@ -27,6 +28,7 @@
 #endif // ANJ_WITH_OBSERVE
 
 #include "../coap/coap.h"
+#include "../core/transient_alloc.h"
 #include "../io/io.h"
 #include "../utils.h"
 #include "dm_core.h"
@@ -247,6 +249,130 @@ static int process_discover(anj_t *anj,
 }
 #endif // ANJ_WITH_DISCOVER
 
+#ifdef ANJ_WITH_TLV_ENCODER
+// TLV encodes the length of a Multiple Resource before its instances, so the
+// encoder has to know how many of them will follow the first one. TLV is never
+// used for composite operations, so entity_ptrs still point to the Resource
+// of the entry just read.
+static void provide_res_insts_count(anj_t *anj) {
+    _anj_dm_data_model_t *dm = &anj->dm;
+    if (_anj_io_out_ctx_get_format(&anj->anj_io.out_ctx)
+            != _ANJ_COAP_FORMAT_OMA_LWM2M_TLV) {
+        return;
+    }
+    const anj_dm_obj_inst_t *inst = dm->entity_ptrs.inst;
+    const anj_dm_res_t *res = dm->entity_ptrs.res;
+    if (anj_uri_path_is(&dm->out_record.path, ANJ_ID_RIID)
+            && dm->out_record.path.ids[ANJ_ID_RIID]
+                           == _anj_dm_first_res_inst(inst, res)) {
+        _anj_io_out_ctx_set_res_insts_count(
+                &anj->anj_io.out_ctx, _anj_dm_count_res_insts(inst, res));
+    }
+}
+#endif // ANJ_WITH_TLV_ENCODER
+
+#ifdef ANJ_WITH_SMALLEST_FORMAT
+// Called right after the READ operation has begun, so entity_ptrs point to the
+// Resource targeted by the request. Every hierarchical format repeats at least
+// part of the path next to the value, so if the payload is a single value, a
+// format that carries the bare value is always smaller.
+static uint16_t choose_read_format(anj_t *anj,
+                                   const anj_uri_path_t *path,
+                                   size_t res_count,
+                                   uint16_t accept) {
+    if (accept != _ANJ_COAP_FORMAT_NOT_DEFINED || res_count != 1
+            || !anj_uri_path_has(path, ANJ_ID_RID)) {
+        return accept;
+    }
+    const anj_dm_res_t *res = anj->dm.entity_ptrs.res;
+    // a Multiple Resource might get more instances in the next notification
+    if (_anj_dm_is_multi_instance_resource(res->kind)
+            && !anj_uri_path_has(path, ANJ_ID_RIID)) {
+        return accept;
+    }
+    return _anj_io_out_smallest_format(res->type);
+}
+#endif // ANJ_WITH_SMALLEST_FORMAT
+
+#ifdef ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+static _anj_dm_preencoded_read_t *preencoded_read_slot(anj_t *anj) {
+    return &anj->device_read_cache
+                    .slots[anj->dm.op_ctx.read_ctx.preencoded_slot];
+}
+
+// Stores the state of the Read that follows the payload recorded so far.
+static void preencoded_read_snapshot(anj_t *anj) {
+    _anj_dm_data_model_t *ctx = &anj->dm;
+    _anj_dm_preencoded_read_t *slot = preencoded_read_slot(anj);
+    slot->out_ctx = anj->anj_io.out_ctx;
+    slot->read_ctx = ctx->op_ctx.read_ctx;
+    slot->entity_ptrs = ctx->entity_ptrs;
+    slot->op_count = ctx->op_count;
+    slot->prefix_len = slot->payload_len;
+}
+
+static void preencoded_read_finish(anj_t *anj) {
+    preencoded_read_slot(anj)->complete = true;
+    anj->dm.op_ctx.read_ctx.preencoded = _ANJ_DM_PREENCODED_READ_NONE;
+}
+
+static void preencoded_read_append(anj_t *anj,
+                                   const uint8_t *data,
+                                   size_t data_len) {
+    _anj_dm_preencoded_read_t *slot = preencoded_read_slot(anj);
+    if (data_len > sizeof(slot->payload) - slot->payload_len) {
+        // the Resources recorded up to the last snapshot are used
+        preencoded_read_finish(anj);
+        return;
+    }
+    memcpy(&slot->payload[slot->payload_len], data, data_len);
+    slot->payload_len += data_len;
+}
+
+// Called right after the READ operation has begun. A Read of the Instance of
+// the default Device Object either starts from the payload recorded for the
+// same content format, or records it for the next Reads.
+static void begin_preencoded_read(anj_t *anj, const anj_uri_path_t *path) {
+    _anj_dm_data_model_t *ctx = &anj->dm;
+    _anj_dm_device_read_cache_t *cache = &anj->device_read_cache;
+    if (!ctx->device_read_cache_valid) {
+        for (size_t i = 0; i < ANJ_ARRAY_SIZE(cache->slots); i++) {
+            cache->slots[i].format = _ANJ_COAP_FORMAT_NOT_DEFINED;
+            cache->slots[i].complete = false;
+        }
+        cache->next_slot = 0;
+        ctx->device_read_cache_valid = true;
+    }
+    if (!cache->obj || ctx->entity_ptrs.obj != cache->obj
+            || !anj_uri_path_is(path, ANJ_ID_IID) || !ctx->op_count) {
+        return;
+    }
+    uint16_t format = _anj_io_out_ctx_get_format(&anj->anj_io.out_ctx);
+    uint8_t idx = 0;
+    while (idx < ANJ_ARRAY_SIZE(cache->slots)
+           && cache->slots[idx].format != format) {
+        idx++;
+    }
+    _anj_dm_read_ctx_t *read_ctx = &ctx->op_ctx.read_ctx;
+    if (idx < ANJ_ARRAY_SIZE(cache->slots) && cache->slots[idx].complete) {
+        read_ctx->preencoded = _ANJ_DM_PREENCODED_READ_COPYING;
+        read_ctx->preencoded_slot = idx;
+        read_ctx->preencoded_offset = 0;
+        return;
+    }
+    if (idx == ANJ_ARRAY_SIZE(cache->slots)) {
+        idx = cache->next_slot;
+        cache->next_slot =
+                (uint8_t) ((idx + 1) % ANJ_ARRAY_SIZE(cache->slots));
+    }
+    cache->slots[idx].format = format;
+    cache->slots[idx].payload_len = 0;
+    read_ctx->preencoded = _ANJ_DM_PREENCODED_READ_RECORDING;
+    read_ctx->preencoded_slot = idx;
+    preencoded_read_snapshot(anj);
+}
+#endif // ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+
 static int process_read(anj_t *anj,
                         uint8_t *buff,
                         size_t buff_len,
@@ -273,17 +399,42 @@ static int process_read(anj_t *anj,
             }
         }
 #else  // ANJ_WITH_COMPOSITE_OPERATIONS
+        (void) composite;
         assert(composite == false);
 #endif // ANJ_WITH_COMPOSITE_OPERATIONS
         if (!ctx->data_to_copy && ctx->op_count > 0) {
+#ifdef ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+            if (ctx->op_ctx.read_ctx.preencoded
+                    == _ANJ_DM_PREENCODED_READ_RECORDING) {
+                preencoded_read_snapshot(anj);
+            }
+#endif // ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
             ret_dm = _anj_dm_get_read_entry(anj, &ctx->out_record);
             if (ret_dm && ret_dm != _ANJ_DM_LAST_RECORD) {
                 return ret_dm;
             }
+#ifdef ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+            if (ctx->op_ctx.read_ctx.preencoded
+                            == _ANJ_DM_PREENCODED_READ_RECORDING
+                    && ctx->out_record.path.ids[ANJ_ID_RID]
+                                   == anj->device_read_cache
+                                              .first_mutable_rid) {
+                preencoded_read_finish(anj);
+            }
+#endif // ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
             dm_log(L_TRACE, "Reading from:");
             resource_uri_trace_log(&ctx->out_record.path);
+#ifdef ANJ_WITH_TLV_ENCODER
+            provide_res_insts_count(anj);
+#endif // ANJ_WITH_TLV_ENCODER
+#ifdef ANJ_WITH_DIRECT_PAYLOAD_ENCODING
+            ret_anj = _anj_io_out_ctx_new_entry_direct(
+                    &anj->anj_io.out_ctx, &ctx->out_record,
+                    &buff[*out_payload_len], buff_len - *out_payload_len);
+#else  // ANJ_WITH_DIRECT_PAYLOAD_ENCODING
             ret_anj = _anj_io_out_ctx_new_entry(&anj->anj_io.out_ctx,
                                                 &ctx->out_record);
+#endif // ANJ_WITH_DIRECT_PAYLOAD_ENCODING
             if (ret_anj) {
                 dm_log(L_ERROR, "anj_io out ctx error %d", ret_anj);
                 return map_anj_io_err_to_coap_code(ret_anj);
@@ -295,15 +446,71 @@ static int process_read(anj_t *anj,
                                               &buff[*out_payload_len],
                                               buff_len - *out_payload_len,
                                               &copied_bytes);
+#ifdef ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+        if (ctx->op_ctx.read_ctx.preencoded
+                == _ANJ_DM_PREENCODED_READ_RECORDING) {
+            preencoded_read_append(anj, &buff[*out_payload_len],
+                                   copied_bytes);
+        }
+#endif // ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
         *out_payload_len += copied_bytes;
         int ret = handle_read_payload_result(ctx, ret_anj, ret_dm,
                                              *out_payload_len, buff_len);
+#ifdef ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+        if (!ret
+                && ctx->op_ctx.read_ctx.preencoded
+                           == _ANJ_DM_PREENCODED_READ_RECORDING) {
+            // the whole payload is recorded
+            preencoded_read_snapshot(anj);
+            preencoded_read_finish(anj);
+        }
+#endif // ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
         if (ret != _DM_CONTINUE) {
             return ret;
         }
     }
 }
 
+#ifdef ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+static int process_preencoded_read(anj_t *anj,
+                                   uint8_t *buff,
+                                   size_t buff_len,
+                                   size_t *out_payload_len) {
+    _anj_dm_data_model_t *ctx = &anj->dm;
+    _anj_dm_read_ctx_t *read_ctx = &ctx->op_ctx.read_ctx;
+    const _anj_dm_preencoded_read_t *slot = preencoded_read_slot(anj);
+    assert(read_ctx->preencoded_offset <= slot->prefix_len);
+    size_t to_copy = slot->prefix_len - read_ctx->preencoded_offset;
+    if (to_copy > buff_len) {
+        to_copy = buff_len;
+    }
+    memcpy(buff, &slot->payload[read_ctx->preencoded_offset], to_copy);
+    *out_payload_len = to_copy;
+    if (read_ctx->preencoded_offset + to_copy < slot->prefix_len) {
+        read_ctx->preencoded_offset += to_copy;
+        return _ANJ_EXCHANGE_BLOCK_TRANSFER_NEEDED;
+    }
+    // the rest of the payload is encoded from the stored state
+    anj->anj_io.out_ctx = slot->out_ctx;
+    *read_ctx = slot->read_ctx;
+    read_ctx->preencoded = _ANJ_DM_PREENCODED_READ_NONE;
+    ctx->entity_ptrs = slot->entity_ptrs;
+    ctx->op_count = slot->op_count;
+    ctx->data_to_copy = false;
+    if (!ctx->op_count) {
+        return 0;
+    }
+    if (to_copy == buff_len) {
+        return _ANJ_EXCHANGE_BLOCK_TRANSFER_NEEDED;
+    }
+    size_t copied_bytes;
+    int ret = process_read(anj, &buff[to_copy], buff_len - to_copy,
+                           &copied_bytes, NULL, false);
+    *out_payload_len += copied_bytes;
+    return ret;
+}
+#endif // ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+
 static int process_register(anj_t *anj,
                             uint8_t *buff,
                             size_t buff_len,
@@ -344,6 +551,51 @@ static int process_register(anj_t *anj,
     }
 }
 
+#ifdef ANJ_DM_WITH_REGISTER_PAYLOAD_CACHE
+static void begin_register_payload_rendering(anj_t *anj) {
+    anj->dm.data_to_copy = false;
+    _anj_dm_begin_register_op(anj);
+    _anj_io_register_ctx_init(&anj->anj_io.register_ctx);
+}
+
+static void prepare_register_payload_cache(anj_t *anj) {
+    _anj_dm_data_model_t *ctx = &anj->dm;
+    if (!ctx->reg_payload_cache_valid) {
+        int ret = process_register(anj, ctx->reg_payload_cache,
+                                   sizeof(ctx->reg_payload_cache),
+                                   &ctx->reg_payload_cache_len);
+        ctx->reg_payload_cache_valid = true;
+        ctx->reg_payload_cache_overflow = !!ret;
+        if (ret) {
+            dm_log(L_DEBUG, "Register payload doesn't fit in the cache");
+        }
+        // start over, either from the cache or from the first record
+        begin_register_payload_rendering(anj);
+    }
+    ctx->op_ctx.reg_ctx.from_cache = !ctx->reg_payload_cache_overflow;
+    ctx->op_ctx.reg_ctx.cache_offset = 0;
+}
+
+static int process_register_from_cache(anj_t *anj,
+                                       uint8_t *buff,
+                                       size_t buff_len,
+                                       size_t *out_payload_len) {
+    _anj_dm_data_model_t *ctx = &anj->dm;
+    _anj_dm_reg_ctx_t *reg_ctx = &ctx->op_ctx.reg_ctx;
+    assert(reg_ctx->cache_offset <= ctx->reg_payload_cache_len);
+    size_t to_copy = ctx->reg_payload_cache_len - reg_ctx->cache_offset;
+    if (to_copy > buff_len) {
+        to_copy = buff_len;
+    }
+    memcpy(buff, &ctx->reg_payload_cache[reg_ctx->cache_offset], to_copy);
+    reg_ctx->cache_offset += to_copy;
+    *out_payload_len = to_copy;
+    return reg_ctx->cache_offset < ctx->reg_payload_cache_len
+                   ? _ANJ_EXCHANGE_BLOCK_TRANSFER_NEEDED
+                   : 0;
+}
+#endif // ANJ_DM_WITH_REGISTER_PAYLOAD_CACHE
+
 #ifdef ANJ_WITH_COMPOSITE_OPERATIONS
 static int read_composite(anj_t *anj,
                           const void *uri_paths,
@@ -379,10 +631,154 @@ static int read_composite(anj_t *anj,
         if (res) {
             return res;
         }
+        if (*out_payload_len == buff_len
+                && *already_processed + 1 < uri_path_count) {
+            // last record of this path filled the buffer, next path will be
+            // processed in the next block
+            (*already_processed)++;
+            return _ANJ_EXCHANGE_BLOCK_TRANSFER_NEEDED;
+        }
     }
     return 0;
 }
-#endif // ANJ_WITH_COMPOSITE_OPERATIONS
+
+#    ifdef ANJ_DM_WITH_COMP_READ_PATH_STREAMING
+// Builds the first block of the response, decoding paths from the request
+// payload again. Paths that don't make it to this block are copied to
+// comp_read_paths, because the payload is not available later.
+static int read_composite_streamed_with(anj_t *anj,
+                                        _anj_io_in_ctx_t *in_ctx,
+                                        uint8_t *buff,
+                                        size_t buff_len,
+                                        size_t *out_payload_len,
+                                        uint16_t *out_format) {
+    _anj_dm_data_model_t *ctx = &anj->dm;
+    size_t path_count = ctx->comp_read_path_count;
+    size_t processed = 0;
+    bool block_full = false;
+    int res;
+    ctx->comp_read_streaming = false;
+    ctx->comp_read_path_count = 0;
+    ctx->comp_read_already_processed = 0;
+    *out_payload_len = 0;
+    *out_format = _anj_io_out_ctx_get_format(&anj->anj_io.out_ctx);
+
+    if (path_count == 0) {
+        // for handling empty responses
+        return _anj_io_out_ctx_get_payload(&anj->anj_io.out_ctx, buff,
+                                           buff_len, out_payload_len);
+    }
+    if ((res = _anj_io_in_ctx_init(in_ctx, ANJ_OP_DM_READ_COMP, NULL,
+                                   ctx->comp_read_content_format))
+            || (res = _anj_io_in_ctx_feed_payload(in_ctx,
+                                                  ctx->comp_read_payload,
+                                                  ctx->comp_read_payload_len,
+                                                  true))) {
+        dm_log(L_ERROR, "anj_io in ctx error: %d", res);
+        return map_anj_io_err_to_coap_code(res);
+    }
+    while (true) {
+        anj_data_type_t type = ANJ_DATA_TYPE_ANY;
+        const anj_res_value_t *value;
+        const anj_uri_path_t *path;
+        res = _anj_io_in_ctx_get_entry(in_ctx, &type, &value, &path);
+        if (res == _ANJ_IO_EOF) {
+            break;
+        } else if (res) {
+            // not expected, the payload has been decoded once already
+            dm_log(L_ERROR, "anj_io in ctx error: %d", res);
+            return map_anj_io_err_to_coap_code(res);
+        }
+        if (_anj_dm_path_has_readable_resources(ctx, path)) {
+            continue;
+        }
+        if (block_full) {
+            if (ctx->comp_read_path_count == ANJ_DM_MAX_COMP_READ_ENTRIES) {
+                dm_log(L_ERROR,
+                       "Exceeded maximum number of composite read paths");
+                return _ANJ_DM_ERR_LOGIC;
+            }
+            ctx->comp_read_paths[ctx->comp_read_path_count++] = *path;
+            continue;
+        }
+        size_t copied_bytes;
+        res = process_read(anj, &buff[*out_payload_len],
+                           buff_len - *out_payload_len, &copied_bytes, path,
+                           true);
+        *out_payload_len += copied_bytes;
+        processed++;
+        if (res == _ANJ_EXCHANGE_BLOCK_TRANSFER_NEEDED) {
+            // the rest of this path will be processed in the next block
+            block_full = true;
+            ctx->comp_read_paths[ctx->comp_read_path_count++] = *path;
+        } else if (res) {
+            return res;
+        } else if (*out_payload_len == buff_len && processed < path_count) {
+            block_full = true;
+        }
+    }
+    return block_full ? _ANJ_EXCHANGE_BLOCK_TRANSFER_NEEDED : 0;
+}
+
+static int read_composite_streamed(anj_t *anj,
+                                   uint8_t *buff,
+                                   size_t buff_len,
+                                   size_t *out_payload_len,
+                                   uint16_t *out_format) {
+#        ifdef ANJ_WITH_TRANSIENT_ALLOC
+    // the decoder is needed only while the first block is prepared
+    _anj_io_in_ctx_t *in_ctx = (_anj_io_in_ctx_t *) _anj_transient_alloc(
+            anj, sizeof(_anj_io_in_ctx_t));
+    if (!in_ctx) {
+        return ANJ_DM_ERR_SERVICE_UNAVAILABLE;
+    }
+    int res = read_composite_streamed_with(anj, in_ctx, buff, buff_len,
+                                           out_payload_len, out_format);
+    _anj_transient_free(anj, in_ctx);
+    return res;
+#        else  // ANJ_WITH_TRANSIENT_ALLOC
+    return read_composite_streamed_with(anj, &anj->comp_read_in_ctx, buff,
+                                        buff_len, out_payload_len, out_format);
+#        endif // ANJ_WITH_TRANSIENT_ALLOC
+}
+#    endif // ANJ_DM_WITH_COMP_READ_PATH_STREAMING
+#endif     // ANJ_WITH_COMPOSITE_OPERATIONS
+
+#ifdef ANJ_WITH_SEPARATE_RESPONSE
+static int restart_pending_read(anj_t *anj) {
+    _anj_dm_data_model_t *ctx = &anj->dm;
+#    ifdef ANJ_DM_WITH_RES_READ_BATCH
+    ctx->read_batch_obj = NULL;
+    ctx->read_batch_res = NULL;
+#    endif // ANJ_DM_WITH_RES_READ_BATCH
+    int ret_val = _anj_dm_begin_read_op(anj, &ctx->pending_read_path);
+    if (ret_val) {
+        return ret_val;
+    }
+    size_t res_count = 0;
+    _anj_dm_get_readable_res_count(anj, &res_count);
+    ret_val = _anj_io_out_ctx_init(&anj->anj_io.out_ctx, ANJ_OP_DM_READ,
+                                   &ctx->pending_read_path, res_count,
+                                   ctx->pending_read_format);
+    if (ret_val) {
+        return map_anj_io_err_to_coap_code(ret_val);
+    }
+    return 0;
+}
+
+int anj_dm_complete_pending(anj_t *anj, int result) {
+    assert(anj);
+    _anj_dm_data_model_t *ctx = &anj->dm;
+    if (!ctx->op_in_progress || !ctx->pending || ctx->pending_completed) {
+        dm_log(L_ERROR, "No pending operation");
+        return -1;
+    }
+    assert(result <= 0);
+    ctx->pending_completed = true;
+    ctx->pending_result = result;
+    return 0;
+}
+#endif // ANJ_WITH_SEPARATE_RESPONSE
 
 static uint8_t _dm_read_payload(void *arg_ptr,
                                 uint8_t *buff,
@@ -392,10 +788,35 @@ static uint8_t _dm_read_payload(void *arg_ptr,
     _anj_dm_data_model_t *ctx = &anj->dm;
     int ret_val = 0;
 
+#ifdef ANJ_WITH_SEPARATE_RESPONSE
+    if (ctx->pending) {
+        if (!ctx->pending_completed) {
+            return _ANJ_EXCHANGE_SEPARATE_RESPONSE;
+        }
+        ctx->pending = false;
+        if (ctx->pending_result) {
+            return map_err_to_coap_code(ctx->pending_result);
+        }
+        if (ctx->operation == ANJ_OP_DM_READ) {
+            ret_val = restart_pending_read(anj);
+            if (ret_val) {
+                return map_err_to_coap_code(ret_val);
+            }
+        }
+    }
+#endif // ANJ_WITH_SEPARATE_RESPONSE
+
     switch (ctx->operation) {
     case ANJ_OP_REGISTER:
     case ANJ_OP_UPDATE:
         out_params->format = _ANJ_COAP_FORMAT_LINK_FORMAT;
+#ifdef ANJ_DM_WITH_REGISTER_PAYLOAD_CACHE
+        if (ctx->op_ctx.reg_ctx.from_cache) {
+            ret_val = process_register_from_cache(anj, buff, buff_len,
+                                                  &out_params->payload_len);
+            break;
+        }
+#endif // ANJ_DM_WITH_REGISTER_PAYLOAD_CACHE
         ret_val =
                 process_register(anj, buff, buff_len, &out_params->payload_len);
         break;
@@ -417,11 +838,27 @@ static uint8_t _dm_read_payload(void *arg_ptr,
         break;
     case ANJ_OP_DM_READ:
         out_params->format = _anj_io_out_ctx_get_format(&anj->anj_io.out_ctx);
+#ifdef ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+        if (ctx->op_ctx.read_ctx.preencoded
+                == _ANJ_DM_PREENCODED_READ_COPYING) {
+            ret_val = process_preencoded_read(anj, buff, buff_len,
+                                              &out_params->payload_len);
+            break;
+        }
+#endif // ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
         ret_val = process_read(anj, buff, buff_len, &out_params->payload_len,
                                NULL, false);
         break;
 #ifdef ANJ_WITH_COMPOSITE_OPERATIONS
     case ANJ_OP_DM_READ_COMP:
+#    ifdef ANJ_DM_WITH_COMP_READ_PATH_STREAMING
+        if (ctx->comp_read_streaming) {
+            ret_val = read_composite_streamed(anj, buff, buff_len,
+                                              &out_params->payload_len,
+                                              &out_params->format);
+            break;
+        }
+#    endif // ANJ_DM_WITH_COMP_READ_PATH_STREAMING
         ret_val = read_composite(anj, ctx->comp_read_paths,
                                  ctx->comp_read_path_count, false,
                                  &ctx->comp_read_already_processed, buff,
@@ -455,6 +892,14 @@ static uint8_t _dm_read_payload(void *arg_ptr,
         break;
     }
 
+#ifdef ANJ_WITH_SEPARATE_RESPONSE
+    // the first block of the response is the only one that can be deferred
+    ctx->pending_allowed = false;
+    if (ret_val == _ANJ_DM_PENDING_RECORD) {
+        dm_log(L_DEBUG, "Read operation pending");
+        return _ANJ_EXCHANGE_SEPARATE_RESPONSE;
+    }
+#endif // ANJ_WITH_SEPARATE_RESPONSE
     if (ret_val && ret_val != _ANJ_EXCHANGE_BLOCK_TRANSFER_NEEDED) {
         return map_err_to_coap_code(ret_val);
     } else if (ret_val == _ANJ_EXCHANGE_BLOCK_TRANSFER_NEEDED) {
@@ -525,6 +970,23 @@ static int process_write(anj_t *anj,
         if (!ret_anj) {
 #ifdef ANJ_WITH_COMPOSITE_OPERATIONS
             if (ctx->operation == ANJ_OP_DM_READ_COMP) {
+#    ifdef ANJ_DM_WITH_COMP_READ_PATH_STREAMING
+                if (ctx->comp_read_streaming) {
+                    // paths are only counted, they will be decoded again
+                    // while the response is being built
+                    if (_anj_dm_path_has_readable_resources(&anj->dm, path)
+                            == 0) {
+                        size_t path_res_count;
+                        ret_dm = _anj_dm_count_readable_res_if_allowed(
+                                anj, path, &path_res_count);
+                        if (ret_dm) {
+                            return ret_dm;
+                        }
+                        ctx->comp_read_res_count += path_res_count;
+                        ctx->comp_read_path_count++;
+                    }
+                } else
+#    endif // ANJ_DM_WITH_COMP_READ_PATH_STREAMING
                 if (ctx->comp_read_path_count == ANJ_DM_MAX_COMP_READ_ENTRIES) {
                     /* No space for another path, respond with
                      * ANJ_COAP_CODE_INTERNAL_SERVER_ERROR */
@@ -573,6 +1035,84 @@ static int process_write(anj_t *anj,
     }
 }
 
+#ifdef ANJ_DM_WITH_BATCHED_WRITE_COMP
+// Decodes paths of a single-message Write-Composite request and begins
+// transactions of all targeted Objects, in the order of the data model, before
+// any record is written. The payload is then decoded again by process_write().
+static int begin_write_comp_transactions(anj_t *anj,
+                                         uint8_t *payload,
+                                         size_t payload_len) {
+    _anj_dm_data_model_t *ctx = &anj->dm;
+    _anj_io_in_ctx_t *in_ctx = &anj->anj_io.in_ctx;
+    uint16_t format = in_ctx->format;
+    bool targeted[ANJ_DM_MAX_OBJECTS_NUMBER] = { false };
+    int res = _anj_io_in_ctx_feed_payload(in_ctx, payload, payload_len, true);
+    while (!res) {
+        anj_data_type_t type = ANJ_DATA_TYPE_ANY;
+        const anj_res_value_t *value;
+        const anj_uri_path_t *path;
+        res = _anj_io_in_ctx_get_entry(in_ctx, &type, &value, &path);
+        if (res == _ANJ_IO_EOF) {
+            res = 0;
+            break;
+        } else if (res && res != _ANJ_IO_WANT_TYPE_DISAMBIGUATION) {
+            break;
+        }
+        if (!path) {
+            dm_log(L_ERROR, "anj_io in ctx no path given");
+            return ANJ_COAP_CODE_INTERNAL_SERVER_ERROR;
+        }
+        if (_anj_uri_path_to_security_or_oscore_obj(path)) {
+            return ANJ_DM_ERR_UNAUTHORIZED;
+        }
+        anj_uri_path_t record_path = *path;
+        if (res == _ANJ_IO_WANT_TYPE_DISAMBIGUATION) {
+            int ret_dm = _anj_dm_get_resource_type(anj, &record_path, &type);
+            if (ret_dm) {
+                return ret_dm;
+            }
+            res = _anj_io_in_ctx_get_entry(in_ctx, &type, &value, &path);
+        }
+        if (!res && type == ANJ_DATA_TYPE_NULL
+                && !anj_uri_path_has(&record_path, ANJ_ID_RIID)) {
+            dm_log(L_ERROR, "Invalid path");
+            return ANJ_DM_ERR_BAD_REQUEST;
+        }
+        // other invalid paths are reported when the record is written
+        if (!res && anj_uri_path_has(&record_path, ANJ_ID_RID)) {
+            uint16_t idx =
+                    _anj_dm_find_obj_idx(ctx, record_path.ids[ANJ_ID_OID]);
+            if (idx == ctx->objs_count
+                    || ctx->objs[idx]->oid != record_path.ids[ANJ_ID_OID]) {
+                dm_log(L_ERROR, "Object /%" PRIu16 " not found in data model",
+                       record_path.ids[ANJ_ID_OID]);
+                return ANJ_DM_ERR_NOT_FOUND;
+            }
+            targeted[idx] = true;
+        }
+    }
+    if (res) {
+        dm_log(L_ERROR, "anj_io in ctx error %d", res);
+        return map_anj_io_err_to_coap_code(res);
+    }
+
+    for (uint16_t idx = 0; idx < ctx->objs_count; idx++) {
+        if (targeted[idx] && !ctx->in_transaction[idx]) {
+            ctx->in_transaction[idx] = true;
+            if ((res = _anj_dm_call_transaction_begin(anj, ctx->objs[idx]))) {
+                return res;
+            }
+        }
+    }
+    if ((res = _anj_io_in_ctx_init(in_ctx, ANJ_OP_DM_WRITE_COMP,
+                                   &ctx->op_ctx.write_ctx.path, format))) {
+        dm_log(L_ERROR, "anj_io in ctx error %d", res);
+        return map_anj_io_err_to_coap_code(res);
+    }
+    return 0;
+}
+#endif // ANJ_DM_WITH_BATCHED_WRITE_COMP
+
 static uint8_t _dm_write_payload(void *arg_ptr,
                                  uint8_t *payload,
                                  size_t payload_len,
@@ -587,12 +1127,40 @@ static uint8_t _dm_write_payload(void *arg_ptr,
     case ANJ_OP_DM_WRITE_COMP:
     case ANJ_OP_DM_CREATE:
     case ANJ_OP_DM_READ_COMP:
+#ifdef ANJ_DM_WITH_COMP_READ_PATH_STREAMING
+        if (ctx->operation == ANJ_OP_DM_READ_COMP
+                && !ctx->comp_read_payload_received) {
+            // paths of a block-wise request have to be stored
+            ctx->comp_read_payload_received = true;
+            ctx->comp_read_streaming = last_block;
+            ctx->comp_read_payload = payload;
+            ctx->comp_read_payload_len = payload_len;
+        }
+#endif // ANJ_DM_WITH_COMP_READ_PATH_STREAMING
+#ifdef ANJ_DM_WITH_BATCHED_WRITE_COMP
+        if (ctx->operation == ANJ_OP_DM_WRITE_COMP
+                && !ctx->write_comp_payload_received) {
+            ctx->write_comp_payload_received = true;
+            // Objects targeted by block-wise requests are begun when reached
+            if (last_block
+                    && (ret_val = begin_write_comp_transactions(
+                                anj, payload, payload_len))) {
+                break;
+            }
+        }
+#endif // ANJ_DM_WITH_BATCHED_WRITE_COMP
         ret_val = process_write(anj, payload, payload_len, last_block);
 #ifdef ANJ_WITH_COMPOSITE_OPERATIONS
         if (ret_val == 0 && ctx->operation == ANJ_OP_DM_READ_COMP
                 && last_block) {
             size_t res_count = 0;
 
+#    ifdef ANJ_DM_WITH_COMP_READ_PATH_STREAMING
+            // paths read directly from the payload have been counted already
+            if (ctx->comp_read_streaming) {
+                res_count = ctx->comp_read_res_count;
+            } else
+#    endif // ANJ_DM_WITH_COMP_READ_PATH_STREAMING
             for (size_t i = 0, path_res_count; i < ctx->comp_read_path_count;
                  i++) {
                 ret_val = _anj_dm_count_readable_res_if_allowed(
@@ -636,6 +1204,13 @@ static uint8_t _dm_write_payload(void *arg_ptr,
     if (last_block && ctx->is_transactional && !ret_val) {
         ret_val = _anj_dm_operation_validate(anj);
     }
+#ifdef ANJ_DM_WITH_WRITE_BLOCK_COMMIT
+    // Data written so far is committed before the next block is requested,
+    // which happens only after this function returns.
+    if (!last_block && ctx->is_transactional && !ret_val) {
+        ret_val = _anj_dm_write_block_commit(anj);
+    }
+#endif // ANJ_DM_WITH_WRITE_BLOCK_COMMIT
     if (ret_val) {
         return map_err_to_coap_code(ret_val);
     }
@@ -665,8 +1240,32 @@ static void _dm_process_finalization(void *arg_ptr,
                                            ? ANJ_DM_TRANSACTION_SUCCESS
                                            : ANJ_DM_TRANSACTION_FAILURE);
     }
+#ifdef ANJ_WITH_LWM2M_GATEWAY
+    _anj_dm_gateway_deselect_device(anj);
+#endif // ANJ_WITH_LWM2M_GATEWAY
 }
 
+#ifdef ANJ_WITH_LWM2M_GATEWAY
+static int select_gateway_device(anj_t *anj,
+                                 const _anj_coap_msg_t *request,
+                                 bool bootstrap_call) {
+    if (bootstrap_call) {
+        dm_log(L_ERROR, "Bootstrap of End IoT Devices not supported");
+        return ANJ_DM_ERR_BAD_REQUEST;
+    }
+#    ifdef ANJ_WITH_COMPOSITE_OPERATIONS
+    if (request->operation == ANJ_OP_DM_READ_COMP
+            || request->operation == ANJ_OP_DM_WRITE_COMP) {
+        dm_log(L_ERROR, "Composite operations on End IoT Devices not "
+                        "supported");
+        return ANJ_DM_ERR_NOT_IMPLEMENTED;
+    }
+#    endif // ANJ_WITH_COMPOSITE_OPERATIONS
+    return _anj_dm_gateway_select_device(anj, request->gateway_prefix,
+                                         request->gateway_prefix_len);
+}
+#endif // ANJ_WITH_LWM2M_GATEWAY
+
 void _anj_dm_process_request(anj_t *anj,
                              const _anj_coap_msg_t *request,
                              uint16_t ssid,
@@ -677,6 +1276,11 @@ void _anj_dm_process_request(anj_t *anj,
     assert(!ctx->op_in_progress);
 
     ctx->data_to_copy = false;
+#ifdef ANJ_WITH_SEPARATE_RESPONSE
+    ctx->pending_allowed = false;
+    ctx->pending = false;
+    ctx->pending_completed = false;
+#endif // ANJ_WITH_SEPARATE_RESPONSE
 
     *out_handlers = (_anj_exchange_handlers_t) {
         .read_payload = _dm_read_payload,
@@ -689,10 +1293,20 @@ void _anj_dm_process_request(anj_t *anj,
 #ifdef ANJ_WITH_OBSERVE
     ctx->ssid = ssid;
 #endif // ANJ_WITH_OBSERVE
+#ifdef ANJ_WITH_LWM2M_GATEWAY
+    if (request->gateway_prefix) {
+        int res = select_gateway_device(anj, request, bootstrap_call);
+        if (res) {
+            *out_response_code = map_err_to_coap_code(res);
+            return;
+        }
+    }
+#endif // ANJ_WITH_LWM2M_GATEWAY
     int ret_val = _anj_dm_operation_begin(anj, request->operation,
                                           bootstrap_call, &request->uri);
     if (!ret_val) {
         size_t res_count = 0;
+        uint16_t format;
         switch (ctx->operation) {
         case ANJ_OP_DM_DISCOVER:
             dm_log(L_DEBUG, "Discover operation");
@@ -740,14 +1354,29 @@ void _anj_dm_process_request(anj_t *anj,
             if (!res_count) {
                 dm_log(L_INFO, "No readable resources for given path");
             }
+#ifdef ANJ_WITH_SMALLEST_FORMAT
+            format = choose_read_format(anj, &request->uri, res_count,
+                                        request->accept);
+#else  // ANJ_WITH_SMALLEST_FORMAT
+            format = request->accept;
+#endif // ANJ_WITH_SMALLEST_FORMAT
             ret_val = _anj_io_out_ctx_init(&anj->anj_io.out_ctx, ANJ_OP_DM_READ,
-                                           &request->uri, res_count,
-                                           request->accept);
+                                           &request->uri, res_count, format);
             if (ret_val) {
                 ret_val = ret_val != _ANJ_IO_ERR_UNSUPPORTED_FORMAT
                                   ? map_anj_io_err_to_coap_code(ret_val)
                                   : ANJ_COAP_CODE_NOT_ACCEPTABLE;
             }
+#ifdef ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+            if (!ret_val) {
+                begin_preencoded_read(anj, &request->uri);
+            }
+#endif // ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+#ifdef ANJ_WITH_SEPARATE_RESPONSE
+            ctx->pending_allowed = true;
+            ctx->pending_read_path = request->uri;
+            ctx->pending_read_format = format;
+#endif // ANJ_WITH_SEPARATE_RESPONSE
             *out_response_code = ANJ_COAP_CODE_CONTENT;
             break;
 #ifdef ANJ_WITH_COMPOSITE_OPERATIONS
@@ -756,6 +1385,12 @@ void _anj_dm_process_request(anj_t *anj,
             ctx->comp_read_path_count = 0;
             ctx->comp_read_already_processed = 0;
             ctx->comp_read_format = request->accept;
+#    ifdef ANJ_DM_WITH_COMP_READ_PATH_STREAMING
+            ctx->comp_read_streaming = false;
+            ctx->comp_read_payload_received = false;
+            ctx->comp_read_content_format = request->content_format;
+            ctx->comp_read_res_count = 0;
+#    endif // ANJ_DM_WITH_COMP_READ_PATH_STREAMING
             ret_val = _anj_io_in_ctx_init(&anj->anj_io.in_ctx, ctx->operation,
                                           NULL, request->content_format);
             if (ret_val) {
@@ -767,6 +1402,9 @@ void _anj_dm_process_request(anj_t *anj,
 #endif // ANJ_WITH_COMPOSITE_OPERATIONS
         case ANJ_OP_DM_EXECUTE:
             dm_log(L_DEBUG, "Execute operation");
+#ifdef ANJ_WITH_SEPARATE_RESPONSE
+            ctx->pending_allowed = true;
+#endif // ANJ_WITH_SEPARATE_RESPONSE
             if (!request->payload_size) {
                 // write_handler won't be called for empty payload
                 ret_val = _anj_dm_execute(anj, NULL, 0);
@@ -791,6 +1429,9 @@ void _anj_dm_process_request(anj_t *anj,
         // error code is printed in exchange module
         dm_log(L_ERROR, "Operation initialization failed");
         _anj_dm_operation_end(anj, ANJ_DM_TRANSACTION_FAILURE);
+#ifdef ANJ_WITH_LWM2M_GATEWAY
+        _anj_dm_gateway_deselect_device(anj);
+#endif // ANJ_WITH_LWM2M_GATEWAY
     }
 }
 
@@ -809,6 +1450,9 @@ void _anj_dm_process_register_update_payload(
     _anj_dm_operation_begin(anj, ANJ_OP_REGISTER, false, NULL);
     dm_log(L_DEBUG, "Register/update operation");
     _anj_io_register_ctx_init(&anj->anj_io.register_ctx);
+#ifdef ANJ_DM_WITH_REGISTER_PAYLOAD_CACHE
+    prepare_register_payload_cache(anj);
+#endif // ANJ_DM_WITH_REGISTER_PAYLOAD_CACHE
 }
 
 void _anj_dm_observe_finalize_operation(anj_t *anj, int result) {
@@ -816,6 +1460,71 @@ void _anj_dm_observe_finalize_operation(anj_t *anj, int result) {
     _dm_process_finalization(anj, NULL, result);
 }
 
+#ifdef ANJ_WITH_INTERLEAVED_NOTIFICATIONS
+static void swap_bytes(void *a, void *b, size_t size) {
+    uint8_t *a_bytes = (uint8_t *) a;
+    uint8_t *b_bytes = (uint8_t *) b;
+    for (size_t i = 0; i < size; i++) {
+        uint8_t tmp = a_bytes[i];
+        a_bytes[i] = b_bytes[i];
+        b_bytes[i] = tmp;
+    }
+}
+
+#    define SWAP_FIELD(Dm, State, Field) \
+        swap_bytes(&(Dm)->Field, &(State)->Field, sizeof((Dm)->Field))
+
+void _anj_dm_swap_operation(anj_t *anj,
+                            _anj_dm_op_state_t *state,
+                            _anj_io_out_ctx_t *out_ctx) {
+    assert(anj && state && out_ctx);
+    _anj_dm_data_model_t *dm = &anj->dm;
+    SWAP_FIELD(dm, state, op_ctx);
+    SWAP_FIELD(dm, state, entity_ptrs);
+    SWAP_FIELD(dm, state, bootstrap_operation);
+    SWAP_FIELD(dm, state, is_transactional);
+    SWAP_FIELD(dm, state, op_count);
+    SWAP_FIELD(dm, state, op_in_progress);
+    SWAP_FIELD(dm, state, operation);
+    SWAP_FIELD(dm, state, data_to_copy);
+    SWAP_FIELD(dm, state, out_record);
+    SWAP_FIELD(dm, state, ssid);
+    SWAP_FIELD(dm, state, iid_provided);
+#    ifdef ANJ_DM_WITH_RES_READ_BATCH
+    SWAP_FIELD(dm, state, read_batch_obj);
+    SWAP_FIELD(dm, state, read_batch_iid);
+    SWAP_FIELD(dm, state, read_batch_res);
+#    endif // ANJ_DM_WITH_RES_READ_BATCH
+#    ifdef ANJ_WITH_COMPOSITE_OPERATIONS
+    SWAP_FIELD(dm, state, comp_read_paths);
+    SWAP_FIELD(dm, state, comp_read_path_count);
+    SWAP_FIELD(dm, state, comp_read_already_processed);
+    SWAP_FIELD(dm, state, comp_read_format);
+    SWAP_FIELD(dm, state, comp_read_current_object);
+#        ifdef ANJ_DM_WITH_COMP_READ_PATH_STREAMING
+    SWAP_FIELD(dm, state, comp_read_streaming);
+    SWAP_FIELD(dm, state, comp_read_payload_received);
+    SWAP_FIELD(dm, state, comp_read_payload);
+    SWAP_FIELD(dm, state, comp_read_payload_len);
+    SWAP_FIELD(dm, state, comp_read_content_format);
+    SWAP_FIELD(dm, state, comp_read_res_count);
+#        endif // ANJ_DM_WITH_COMP_READ_PATH_STREAMING
+#        ifdef ANJ_DM_WITH_BATCHED_WRITE_COMP
+    SWAP_FIELD(dm, state, write_comp_payload_received);
+#        endif // ANJ_DM_WITH_BATCHED_WRITE_COMP
+#    endif     // ANJ_WITH_COMPOSITE_OPERATIONS
+#    ifdef ANJ_WITH_SEPARATE_RESPONSE
+    SWAP_FIELD(dm, state, pending_allowed);
+    SWAP_FIELD(dm, state, pending);
+    SWAP_FIELD(dm, state, pending_completed);
+    SWAP_FIELD(dm, state, pending_result);
+    SWAP_FIELD(dm, state, pending_read_path);
+    SWAP_FIELD(dm, state, pending_read_format);
+#    endif // ANJ_WITH_SEPARATE_RESPONSE
+    swap_bytes(&anj->anj_io.out_ctx, out_ctx, sizeof(*out_ctx));
+}
+#endif // ANJ_WITH_INTERLEAVED_NOTIFICATIONS
+
 #ifdef ANJ_WITH_OBSERVE
 int _anj_dm_observe_is_any_resource_readable(anj_t *anj,
                                              const anj_uri_path_t *path) {
@@ -890,6 +1599,12 @@ int _anj_dm_observe_build_msg(anj_t *anj,
             res_count += path_res_count;
         }
 
+#        ifdef ANJ_WITH_SMALLEST_FORMAT
+        if (!composite) {
+            *inout_format = choose_read_format(anj, paths[0], res_count,
+                                               *inout_format);
+        }
+#        endif // ANJ_WITH_SMALLEST_FORMAT
         res = _anj_io_out_ctx_init(&anj->anj_io.out_ctx, op,
                                    composite ? &ANJ_MAKE_ROOT_PATH() : paths[0],
                                    res_count, *inout_format);
@@ -938,6 +1653,10 @@ int _anj_dm_observe_build_msg(anj_t *anj,
             return ANJ_COAP_CODE_METHOD_NOT_ALLOWED;
         }
 
+#        ifdef ANJ_WITH_SMALLEST_FORMAT
+        *inout_format = choose_read_format(anj, paths[0], res_count,
+                                           *inout_format);
+#        endif // ANJ_WITH_SMALLEST_FORMAT
         res = _anj_io_out_ctx_init(&anj->anj_io.out_ctx, ANJ_OP_DM_READ,
                                    paths[0], res_count, *inout_format);
         if (res) {
@@ -1003,6 +1722,137 @@ int _anj_dm_bootstrap_validation(anj_t *anj) {
     // there is no SSID matching pair of server instance and security instance
     return -1;
 }
+
+#    ifdef ANJ_WITH_BOOTSTRAP_PACK
+int _anj_dm_bootstrap_pack_begin(anj_t *anj) {
+    assert(anj && !anj->dm.op_in_progress);
+    int res = _anj_io_in_ctx_init(&anj->anj_io.in_ctx, ANJ_OP_DM_WRITE_REPLACE,
+                                  &ANJ_MAKE_ROOT_PATH(),
+                                  _ANJ_COAP_FORMAT_SENML_CBOR);
+    if (res) {
+        dm_log(L_ERROR, "anj_io in ctx error: %d", res);
+    }
+    return res;
+}
+
+static int bootstrap_pack_end_instance(anj_t *anj) {
+    int res = _anj_dm_operation_validate(anj);
+    _anj_dm_operation_end(anj, res ? ANJ_DM_TRANSACTION_FAILURE
+                                   : ANJ_DM_TRANSACTION_SUCCESS);
+    return res;
+}
+
+/**
+ * Records of every Instance are written by a separate Bootstrap-Write operation
+ * on the Instance, as if the LwM2M Bootstrap-Server sent them one by one.
+ */
+static int bootstrap_pack_select_instance(anj_t *anj,
+                                          const anj_uri_path_t *path) {
+    if (!anj_uri_path_has(path, ANJ_ID_IID)) {
+        dm_log(L_ERROR, "Bootstrap-Pack record without Instance ID");
+        return ANJ_DM_ERR_BAD_REQUEST;
+    }
+    anj_uri_path_t inst_path = ANJ_MAKE_INSTANCE_PATH(path->ids[ANJ_ID_OID],
+                                                      path->ids[ANJ_ID_IID]);
+    if (anj->dm.op_in_progress) {
+        if (anj_uri_path_equal(&anj->dm.op_ctx.write_ctx.path, &inst_path)) {
+            return 0;
+        }
+        int res = bootstrap_pack_end_instance(anj);
+        if (res) {
+            return res;
+        }
+    }
+    dm_log(L_DEBUG, "Bootstrap-Pack write to:");
+    uri_log(&inst_path);
+    return _anj_dm_operation_begin(anj, ANJ_OP_DM_WRITE_REPLACE, true,
+                                   &inst_path);
+}
+
+static int process_bootstrap_pack(anj_t *anj,
+                                  uint8_t *payload,
+                                  size_t payload_len,
+                                  bool last_block) {
+    int ret_anj = _anj_io_in_ctx_feed_payload(&anj->anj_io.in_ctx, payload,
+                                              payload_len, last_block);
+    if (ret_anj) {
+        dm_log(L_ERROR, "anj_io in ctx error: %d", ret_anj);
+        return map_anj_io_err_to_coap_code(ret_anj);
+    }
+
+    const anj_res_value_t *value;
+    const anj_uri_path_t *path;
+    anj_io_out_entry_t record;
+    int ret_dm;
+
+    while (true) {
+        record.type = ANJ_DATA_TYPE_ANY;
+        ret_anj = _anj_io_in_ctx_get_entry(&anj->anj_io.in_ctx, &record.type,
+                                           &value, &path);
+        if (!ret_anj || ret_anj == _ANJ_IO_WANT_TYPE_DISAMBIGUATION) {
+            if (!path) {
+                dm_log(L_ERROR, "anj_io in ctx no path given");
+                return ANJ_COAP_CODE_INTERNAL_SERVER_ERROR;
+            }
+            ret_dm = bootstrap_pack_select_instance(anj, path);
+            if (ret_dm) {
+                return ret_dm;
+            }
+            record.path = *path;
+        }
+        if (ret_anj == _ANJ_IO_WANT_TYPE_DISAMBIGUATION) {
+            ret_dm = _anj_dm_get_resource_type(anj, &record.path, &record.type);
+            if (ret_dm) {
+                return ret_dm;
+            }
+            ret_anj = _anj_io_in_ctx_get_entry(&anj->anj_io.in_ctx,
+                                               &record.type, &value, &path);
+        }
+        if (!ret_anj) {
+            if (!value) {
+                dm_log(L_ERROR, "anj_io in ctx no value given");
+                return ANJ_DM_ERR_BAD_REQUEST;
+            }
+            record.value = *value;
+            dm_log(L_TRACE, "Writing to:");
+            resource_uri_trace_log(&record.path);
+            ret_dm = _anj_dm_write_entry(anj, &record);
+            if (ret_dm) {
+                return ret_dm;
+            }
+        } else if ((ret_anj == _ANJ_IO_WANT_NEXT_PAYLOAD && !last_block)
+                   || ret_anj == _ANJ_IO_EOF) {
+            return 0;
+        } else {
+            dm_log(L_ERROR, "anj_io in ctx error %d", ret_anj);
+            return map_anj_io_err_to_coap_code(ret_anj);
+        }
+    }
+}
+
+uint8_t _anj_dm_bootstrap_pack_write(anj_t *anj,
+                                     uint8_t *payload,
+                                     size_t payload_len,
+                                     bool last_block) {
+    assert(anj);
+    int res = process_bootstrap_pack(anj, payload, payload_len, last_block);
+    if (!res && last_block && anj->dm.op_in_progress) {
+        res = bootstrap_pack_end_instance(anj);
+    }
+    if (res) {
+        return map_err_to_coap_code(res);
+    }
+    return 0;
+}
+
+void _anj_dm_bootstrap_pack_end(anj_t *anj) {
+    assert(anj);
+    if (anj->dm.op_in_progress) {
+        dm_log(L_ERROR, "Bootstrap-Pack not applied completely");
+        _anj_dm_operation_end(anj, ANJ_DM_TRANSACTION_FAILURE);
+    }
+}
+#    endif // ANJ_WITH_BOOTSTRAP_PACK
 #endif // ANJ_WITH_BOOTSTRAP
 
 int _anj_dm_get_server_obj_instance_data(anj_t *anj,
@@ -171,6 +171,25 @@ int _anj_dm_observe_build_msg(anj_t *anj,
  */
 void _anj_dm_observe_finalize_operation(anj_t *anj, int result);
 
+#    ifdef ANJ_WITH_INTERLEAVED_NOTIFICATIONS
+/**
+ * Exchanges the state of the ongoing data model operation, including the
+ * output context used to encode its payload, with the one kept in @p state
+ * and @p out_ctx. Used to prepare a notification between the blocks of a
+ * Block-Wise Read, since the data model handles one operation at a time.
+ *
+ * @p state and @p out_ctx must be zero-initialized before the first call, if
+ * there is no other operation to be swapped in.
+ *
+ * @param anj     Anjay object to operate on.
+ * @param state   Operation kept aside.
+ * @param out_ctx Output context of the operation kept aside.
+ */
+void _anj_dm_swap_operation(anj_t *anj,
+                            _anj_dm_op_state_t *state,
+                            _anj_io_out_ctx_t *out_ctx);
+#    endif // ANJ_WITH_INTERLEAVED_NOTIFICATIONS
+
 /**
  * Called by the bootstrap API during Bootstrap-Finish handling, checks if there
  * is at least one instance of the Server object and one non-bootstrap instance
@@ -185,6 +204,94 @@ void _anj_dm_observe_finalize_operation(anj_t *anj, int result);
  */
 int _anj_dm_bootstrap_validation(anj_t *anj);
 
+#    ifdef ANJ_WITH_BOOTSTRAP_WRITE_BATCHING
+/**
+ * Validates the Objects written by the pending batch of Bootstrap-Write
+ * operations and commits or rolls back the changes. Must be called during
+ * Bootstrap-Finish handling, before @ref _anj_dm_bootstrap_validation, and
+ * when the bootstrap sequence is interrupted.
+ *
+ * @param anj Anjay object to operate on.
+ *
+ * @returns 0 on success, a non-zero value if any Bootstrap-Write of the batch
+ *          failed or the written Objects are not valid.
+ */
+int _anj_dm_bootstrap_batch_commit(anj_t *anj);
+#    endif // ANJ_WITH_BOOTSTRAP_WRITE_BATCHING
+
+#    ifdef ANJ_WITH_BOOTSTRAP_PACK
+/**
+ * Prepares the data model for the SenML CBOR payload of the response to the
+ * Bootstrap-Pack-Request. Must be called before the request is sent.
+ *
+ * @param anj Anjay object to operate on.
+ *
+ * @returns 0 on success, a non-zero value in case of an error.
+ */
+int _anj_dm_bootstrap_pack_begin(anj_t *anj);
+
+/**
+ * Writes the next block of the Bootstrap-Pack to the data model. Records of
+ * every Object Instance are applied as a Bootstrap-Write operation on that
+ * Instance, so they must be contiguous in the payload. Compliant with @ref
+ * _anj_exchange_write_payload_t.
+ *
+ * @param anj         Anjay object to operate on.
+ * @param payload     Payload block.
+ * @param payload_len Length of the payload block.
+ * @param last_block  Flag indicating if this is the last block of payload.
+ *
+ * @returns 0 on success, a ANJ_COAP_CODE_* code in case of error.
+ */
+uint8_t _anj_dm_bootstrap_pack_write(anj_t *anj,
+                                     uint8_t *payload,
+                                     size_t payload_len,
+                                     bool last_block);
+
+/**
+ * Must be called when the Bootstrap-Pack-Request exchange is finished, in
+ * particular when it failed in the middle of the payload. Discards the changes
+ * of the Instance being written, if any.
+ *
+ * @param anj Anjay object to operate on.
+ */
+void _anj_dm_bootstrap_pack_end(anj_t *anj);
+#    endif // ANJ_WITH_BOOTSTRAP_PACK
+
+#    ifdef ANJ_WITH_LWM2M_GATEWAY
+/**
+ * Puts the data model of the End IoT Device with Prefix @p prefix in place of
+ * the data model of the Gateway, so that the following operation is performed
+ * on the device. Must be called before @ref _anj_dm_operation_begin.
+ *
+ * @param anj        Anjay object to operate on.
+ * @param prefix     Prefix of the device, not null-terminated.
+ * @param prefix_len Length of @p prefix.
+ *
+ * @returns 0 on success, @ref ANJ_DM_ERR_NOT_FOUND if there is no such device.
+ */
+int _anj_dm_gateway_select_device(anj_t *anj,
+                                  const char *prefix,
+                                  size_t prefix_len);
+
+/**
+ * Restores the data model of the Gateway after the operation on the device
+ * selected with @ref _anj_dm_gateway_select_device has ended. Does nothing if
+ * no device is selected.
+ *
+ * @param anj Anjay object to operate on.
+ */
+void _anj_dm_gateway_deselect_device(anj_t *anj);
+
+/**
+ * Checks if an operation on an End IoT Device is in progress, i.e. the data
+ * model of the Gateway is not in place.
+ *
+ * @param anj Anjay object to operate on.
+ */
+bool _anj_dm_gateway_device_selected(anj_t *anj);
+#    endif // ANJ_WITH_LWM2M_GATEWAY
+
 /**
  * Finds existing Server Object Instance and returns its SSID and IID. @p
  * out_ssid can be used in @ref _anj_dm_get_security_obj_instance_iid to find
@@ -35,6 +35,15 @@ extern "C" {
  */
 #    define _ANJ_DM_NO_RECORD 2
 
+#    ifdef ANJ_WITH_SEPARATE_RESPONSE
+/**
+ * The value of the Resource is not available yet, the handler returned
+ * @ref ANJ_DM_PENDING. This value can be returned by:
+ *      - @ref _anj_dm_get_read_entry
+ */
+#        define _ANJ_DM_PENDING_RECORD 3
+#    endif // ANJ_WITH_SEPARATE_RESPONSE
+
 /**
  * A group of error codes resulting from incorrect API usage or memory
  * issues. If this occurs, the @ref ANJ_COAP_CODE_INTERNAL_SERVER_ERROR should
@@ -217,6 +226,22 @@ int _anj_dm_create_object_instance(anj_t *anj, anj_iid_t iid);
  */
 int _anj_dm_write_entry(anj_t *anj, const anj_io_out_entry_t *record);
 
+#    ifdef ANJ_DM_WITH_WRITE_BLOCK_COMMIT
+/**
+ * Calls @ref anj_dm_transaction_block_commit_t handlers of all Objects that
+ * take part in the ongoing transactional operation. Should be called after all
+ * records of a non-final block of a block-wise request have been passed to
+ * @ref _anj_dm_write_entry.
+ *
+ * @param anj Anjay object to operate on.
+ *
+ * @returns
+ * - 0 on success,
+ * - a negative value in case of error.
+ */
+int _anj_dm_write_block_commit(anj_t *anj);
+#    endif // ANJ_DM_WITH_WRITE_BLOCK_COMMIT
+
 /**
  * Returns information Resource value type, might be useful when payload format
  * does not contain information about the type of data.
@@ -233,6 +258,28 @@ int _anj_dm_get_resource_type(anj_t *anj,
                               const anj_uri_path_t *path,
                               anj_data_type_t *out_type);
 
+/**
+ * Invalidates all information cached about the structure of the data model,
+ * e.g. path handles. Has to be called whenever Objects, Object Instances or
+ * Resource Instances might have been added or removed.
+ *
+ * @param dm Data model to operate on.
+ */
+void _anj_dm_structure_changed(_anj_dm_data_model_t *dm);
+
+#    ifdef ANJ_DM_WITH_READ_CACHE
+/**
+ * Drops cached values of Resources and Resource Instances at or below
+ * @p path, so that they are read with the handler again.
+ *
+ * @param dm   Data model to operate on.
+ * @param path Path of the changed part of the data model, root path drops all
+ *             cached values.
+ */
+void _anj_dm_read_cache_invalidate(_anj_dm_data_model_t *dm,
+                                   const anj_uri_path_t *path);
+#    endif // ANJ_DM_WITH_READ_CACHE
+
 /**
  * Processes REGISTER operation. Should be repeatedly called until it returns
  * the @ref _ANJ_DM_LAST_RECORD. Provides information about Objects and Object
@@ -252,6 +299,17 @@ int _anj_dm_get_register_record(anj_t *anj,
                                 anj_uri_path_t *out_path,
                                 const char **out_version);
 
+#    ifdef ANJ_DM_WITH_LINK_SET_HASH
+/**
+ * Returns the hash of all Objects (with their versions) and Object Instances
+ * provided by @ref _anj_dm_get_register_record. Equal hashes mean, with high
+ * probability, the same Register payload.
+ *
+ * @param anj Anjay object to operate on.
+ */
+uint32_t _anj_dm_link_set_hash(anj_t *anj);
+#    endif // ANJ_DM_WITH_LINK_SET_HASH
+
 #    ifdef ANJ_WITH_DISCOVER
 /**
  * Processes DISCOVER operation. Should be repeatedly called until it returns
@@ -0,0 +1,184 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#define ANJ_LOG_SOURCE_FILE_ID 69
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/dm/core.h>
+#include <anj/dm/defs.h>
+#include <anj/dm/metrics_object.h>
+#include <anj/log.h>
+#include <anj/metrics.h>
+#include <anj/time.h>
+#include <anj/utils.h>
+
+#include "dm_core.h"
+
+#ifdef ANJ_WITH_DEFAULT_METRICS_OBJ
+
+#    define ANJ_DM_METRICS_RESOURCES_COUNT 12
+
+enum {
+    RID_RETRANSMISSIONS = 0,
+    RID_CACHE_HITS = 1,
+    RID_BLOCKS_TRANSFERRED = 2,
+    RID_NOTIFICATIONS_SENT = 3,
+    RID_DTLS_HANDSHAKES = 4,
+    RID_BYTES_SENT = 5,
+    RID_BYTES_RECEIVED = 6,
+    RID_EXCHANGES = 7,
+    RID_EXCHANGE_TIME_MIN = 8,
+    RID_EXCHANGE_TIME_MAX = 9,
+    RID_EXCHANGE_TIME_AVG = 10,
+    RID_RESET = 11,
+    _RID_LAST
+};
+
+ANJ_STATIC_ASSERT(_RID_LAST == ANJ_DM_METRICS_RESOURCES_COUNT,
+                  metrics_resources_count_mismatch);
+
+#    define METRICS_RES_R(Rid)          \
+        {                               \
+            .rid = (Rid),               \
+            .type = ANJ_DATA_TYPE_INT,  \
+            .kind = ANJ_DM_RES_R        \
+        }
+
+// Resource IDs are contiguous, so they are used as indexes
+static const anj_dm_res_t RES[ANJ_DM_METRICS_RESOURCES_COUNT] = {
+    [RID_RETRANSMISSIONS] = METRICS_RES_R(RID_RETRANSMISSIONS),
+    [RID_CACHE_HITS] = METRICS_RES_R(RID_CACHE_HITS),
+    [RID_BLOCKS_TRANSFERRED] = METRICS_RES_R(RID_BLOCKS_TRANSFERRED),
+    [RID_NOTIFICATIONS_SENT] = METRICS_RES_R(RID_NOTIFICATIONS_SENT),
+    [RID_DTLS_HANDSHAKES] = METRICS_RES_R(RID_DTLS_HANDSHAKES),
+    [RID_BYTES_SENT] = METRICS_RES_R(RID_BYTES_SENT),
+    [RID_BYTES_RECEIVED] = METRICS_RES_R(RID_BYTES_RECEIVED),
+    [RID_EXCHANGES] = METRICS_RES_R(RID_EXCHANGES),
+    [RID_EXCHANGE_TIME_MIN] = METRICS_RES_R(RID_EXCHANGE_TIME_MIN),
+    [RID_EXCHANGE_TIME_MAX] = METRICS_RES_R(RID_EXCHANGE_TIME_MAX),
+    [RID_EXCHANGE_TIME_AVG] = METRICS_RES_R(RID_EXCHANGE_TIME_AVG),
+    [RID_RESET] = {
+        .rid = RID_RESET,
+        .kind = ANJ_DM_RES_E
+    }
+};
+
+static int64_t as_ms(anj_time_duration_t duration) {
+    return anj_time_duration_to_scalar(duration, ANJ_TIME_UNIT_MS);
+}
+
+static int res_read(anj_t *anj,
+                    const anj_dm_obj_t *obj,
+                    anj_iid_t iid,
+                    anj_rid_t rid,
+                    anj_riid_t riid,
+                    anj_res_value_t *out_value) {
+    (void) obj;
+    (void) iid;
+    (void) riid;
+
+    anj_metrics_t metrics;
+    anj_core_metrics_get(anj, &metrics);
+
+    switch (rid) {
+    case RID_RETRANSMISSIONS:
+        out_value->int_value = metrics.retransmissions;
+        break;
+    case RID_CACHE_HITS:
+        out_value->int_value = metrics.cache_hits;
+        break;
+    case RID_BLOCKS_TRANSFERRED:
+        out_value->int_value = metrics.blocks_transferred;
+        break;
+    case RID_NOTIFICATIONS_SENT:
+        out_value->int_value = metrics.notifications_sent;
+        break;
+    case RID_DTLS_HANDSHAKES:
+        out_value->int_value = metrics.dtls_handshakes;
+        break;
+    case RID_BYTES_SENT:
+        out_value->int_value = (int64_t) metrics.bytes_sent;
+        break;
+    case RID_BYTES_RECEIVED:
+        out_value->int_value = (int64_t) metrics.bytes_received;
+        break;
+    case RID_EXCHANGES:
+        out_value->int_value = metrics.exchanges;
+        break;
+    case RID_EXCHANGE_TIME_MIN:
+        out_value->int_value = as_ms(metrics.exchange_time_min);
+        break;
+    case RID_EXCHANGE_TIME_MAX:
+        out_value->int_value = as_ms(metrics.exchange_time_max);
+        break;
+    case RID_EXCHANGE_TIME_AVG:
+        out_value->int_value =
+                metrics.exchanges
+                        ? as_ms(metrics.exchange_time_total) / metrics.exchanges
+                        : 0;
+        break;
+    default:
+        return ANJ_DM_ERR_NOT_FOUND;
+    }
+    return 0;
+}
+
+static int res_execute(anj_t *anj,
+                       const anj_dm_obj_t *obj,
+                       anj_iid_t iid,
+                       anj_rid_t rid,
+                       const char *execute_arg,
+                       size_t execute_arg_len) {
+    (void) obj;
+    (void) iid;
+    (void) execute_arg;
+    (void) execute_arg_len;
+
+    if (rid != RID_RESET) {
+        return ANJ_DM_ERR_NOT_FOUND;
+    }
+    anj_core_metrics_reset(anj);
+    return 0;
+}
+
+static const anj_dm_handlers_t HANDLERS = {
+    .res_read = res_read,
+    .res_execute = res_execute
+};
+
+int anj_dm_metrics_obj_install(anj_t *anj, anj_dm_metrics_obj_t *metrics_obj) {
+    assert(anj && metrics_obj);
+
+    memset(metrics_obj, 0, sizeof(*metrics_obj));
+    metrics_obj->obj = (anj_dm_obj_t) {
+        .oid = ANJ_METRICS_OBJ_OID,
+        .version = "1.0",
+        .max_inst_count = 1,
+        .insts = &metrics_obj->inst,
+        .handlers = &HANDLERS
+    };
+    metrics_obj->inst.resources = RES;
+    metrics_obj->inst.res_count = ANJ_DM_METRICS_RESOURCES_COUNT;
+    metrics_obj->inst.iid = 0;
+
+    int res = anj_dm_add_obj(anj, &metrics_obj->obj);
+    if (!res) {
+        dm_log(L_INFO, "Metrics object installed");
+    }
+    return res;
+}
+
+#endif // ANJ_WITH_DEFAULT_METRICS_OBJ
@@ -16,6 +16,7 @@
 #include <stdint.h>
 #include <string.h>
 
+#include <anj/compat/time.h>
 #include <anj/core.h>
 #include <anj/defs.h>
 #include <anj/dm/core.h>
@@ -27,14 +28,16 @@
 #include "dm_core.h"
 #include "dm_io.h"
 
-static size_t get_readable_res_count_from_resource(const anj_dm_res_t *res) {
+static size_t
+get_readable_res_count_from_resource(const anj_dm_obj_inst_t *inst,
+                                     const anj_dm_res_t *res) {
     if (!_anj_dm_is_readable_resource(res->kind)) {
         return 0;
     }
     if (!_anj_dm_is_multi_instance_resource(res->kind)) {
         return 1;
     }
-    return _anj_dm_count_res_insts(res);
+    return _anj_dm_count_res_insts(inst, res);
 }
 
 static size_t
@@ -42,23 +45,38 @@ get_readable_res_count_from_instance(const anj_dm_obj_inst_t *inst) {
     size_t count = 0;
 
     for (uint16_t idx = 0; idx < inst->res_count; idx++) {
-        count += get_readable_res_count_from_resource(&inst->resources[idx]);
+        count += get_readable_res_count_from_resource(inst,
+                                                      &inst->resources[idx]);
     }
     return count;
 }
 
-static size_t get_readable_res_count_from_object(const anj_dm_obj_t *obj) {
+static size_t count_readable_res_in_object(const anj_dm_obj_t *obj) {
     size_t count = 0;
 
-    for (uint16_t idx = 0; idx < obj->max_inst_count; idx++) {
-        if (obj->insts[idx].iid == ANJ_ID_INVALID) {
-            break;
-        }
-        count += get_readable_res_count_from_instance(&obj->insts[idx]);
+    for (const anj_dm_obj_inst_t *inst = _anj_dm_first_inst(obj); inst;
+         inst = _anj_dm_next_inst(obj, inst->iid)) {
+        count += get_readable_res_count_from_instance(inst);
     }
     return count;
 }
 
+static size_t get_readable_res_count_from_object(_anj_dm_data_model_t *dm,
+                                                 const anj_dm_obj_t *obj) {
+#ifdef ANJ_DM_WITH_READABLE_RES_COUNT_CACHE
+    uint16_t idx = _anj_dm_find_obj_idx(dm, obj->oid);
+    assert(idx < dm->objs_count && dm->objs[idx] == obj);
+    if (!dm->readable_res_count_valid[idx]) {
+        dm->readable_res_count[idx] = count_readable_res_in_object(obj);
+        dm->readable_res_count_valid[idx] = true;
+    }
+    return dm->readable_res_count[idx];
+#else  // ANJ_DM_WITH_READABLE_RES_COUNT_CACHE
+    (void) dm;
+    return count_readable_res_in_object(obj);
+#endif // ANJ_DM_WITH_READABLE_RES_COUNT_CACHE
+}
+
 static int
 get_readable_res_count_and_set_start_level(_anj_dm_data_model_t *dm) {
     _anj_dm_read_ctx_t *read_ctx = &dm->op_ctx.read_ctx;
@@ -78,7 +96,8 @@ get_readable_res_count_and_set_start_level(_anj_dm_data_model_t *dm) {
         }
         read_ctx->base_level = ANJ_ID_RID;
         read_ctx->total_op_count =
-                get_readable_res_count_from_resource(entity_ptrs->res);
+                get_readable_res_count_from_resource(entity_ptrs->inst,
+                                                     entity_ptrs->res);
     } else if (entity_ptrs->inst) {
         read_ctx->base_level = ANJ_ID_IID;
         read_ctx->total_op_count =
@@ -86,20 +105,34 @@ get_readable_res_count_and_set_start_level(_anj_dm_data_model_t *dm) {
     } else {
         read_ctx->base_level = ANJ_ID_OID;
         read_ctx->total_op_count =
-                get_readable_res_count_from_object(entity_ptrs->obj);
+                get_readable_res_count_from_object(dm, entity_ptrs->obj);
     }
 
     dm->op_count = read_ctx->total_op_count;
     return 0;
 }
 
+static void reset_read_ctx(_anj_dm_data_model_t *dm) {
+    _anj_dm_read_ctx_t *read_ctx = &dm->op_ctx.read_ctx;
+    read_ctx->next_inst = false;
+    read_ctx->res_idx = 0;
+    read_ctx->res_inst_idx = 0;
+#ifdef ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+    read_ctx->preencoded = _ANJ_DM_PREENCODED_READ_NONE;
+#endif // ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+    if (read_ctx->base_level == ANJ_ID_OID) {
+        dm->entity_ptrs.inst = _anj_dm_first_inst(dm->entity_ptrs.obj);
+    }
+}
+
 #if defined(ANJ_WITH_COMPOSITE_OPERATIONS) || defined(ANJ_WITH_OBSERVE)
-static bool resource_can_be_read(const anj_dm_res_t *res) {
+static bool resource_can_be_read(const anj_dm_obj_inst_t *inst,
+                                 const anj_dm_res_t *res) {
     if (!_anj_dm_is_readable_resource(res->kind)) {
         return false;
     }
     if (_anj_dm_is_multi_instance_resource(res->kind)
-            && (res->max_inst_count == 0 || res->insts[0] == ANJ_ID_INVALID)) {
+            && _anj_dm_first_res_inst(inst, res) == ANJ_ID_INVALID) {
         return false;
     }
     return true;
@@ -107,7 +140,7 @@ static bool resource_can_be_read(const anj_dm_res_t *res) {
 
 static bool instance_can_be_read(const anj_dm_obj_inst_t *inst) {
     for (uint16_t idx = 0; idx < inst->res_count; idx++) {
-        if (resource_can_be_read(&inst->resources[idx])) {
+        if (resource_can_be_read(inst, &inst->resources[idx])) {
             return true;
         }
     }
@@ -115,9 +148,9 @@ static bool instance_can_be_read(const anj_dm_obj_inst_t *inst) {
 }
 
 static bool object_can_be_read(const anj_dm_obj_t *obj) {
-    for (uint16_t idx = 0; idx < obj->max_inst_count; idx++) {
-        if (obj->insts[idx].iid != ANJ_ID_INVALID
-                && instance_can_be_read(&obj->insts[idx])) {
+    for (const anj_dm_obj_inst_t *inst = _anj_dm_first_inst(obj); inst;
+         inst = _anj_dm_next_inst(obj, inst->iid)) {
+        if (instance_can_be_read(inst)) {
             return true;
         }
     }
@@ -147,7 +180,7 @@ int _anj_dm_path_has_readable_resources(_anj_dm_data_model_t *dm,
 
         if (anj_uri_path_is(path, ANJ_ID_RIID)
                 || anj_uri_path_is(path, ANJ_ID_RID)) {
-            return resource_can_be_read(entity_ptrs.res)
+            return resource_can_be_read(entity_ptrs.inst, entity_ptrs.res)
                            ? 0
                            : ANJ_DM_ERR_METHOD_NOT_ALLOWED;
         } else if (anj_uri_path_is(path, ANJ_ID_IID)) {
@@ -164,54 +197,207 @@ int _anj_dm_path_has_readable_resources(_anj_dm_data_model_t *dm,
 }
 #endif // defined(ANJ_WITH_COMPOSITE_OPERATIONS) || defined(ANJ_WITH_OBSERVE)
 
+#ifdef ANJ_DM_WITH_READ_CACHE
+// strings and opaque values point to memory of the Object, so aren't cached
+#    define READ_CACHE_TYPES                                              \
+        (ANJ_DATA_TYPE_INT | ANJ_DATA_TYPE_DOUBLE | ANJ_DATA_TYPE_BOOL    \
+         | ANJ_DATA_TYPE_OBJLNK | ANJ_DATA_TYPE_UINT | ANJ_DATA_TYPE_TIME)
+
+static bool read_cache_enabled(const anj_dm_res_t *res) {
+    return res->read_cache_max_age_ms && (res->type & READ_CACHE_TYPES);
+}
+
+static anj_uri_path_t read_cache_path(const _anj_dm_entity_ptrs_t *ptrs) {
+    return ptrs->riid != ANJ_ID_INVALID
+                   ? ANJ_MAKE_RESOURCE_INSTANCE_PATH(ptrs->obj->oid,
+                                                     ptrs->inst->iid,
+                                                     ptrs->res->rid, ptrs->riid)
+                   : ANJ_MAKE_RESOURCE_PATH(ptrs->obj->oid, ptrs->inst->iid,
+                                            ptrs->res->rid);
+}
+
+static _anj_dm_read_cache_entry_t *
+read_cache_find(anj_t *anj, const _anj_dm_entity_ptrs_t *ptrs) {
+    if (!read_cache_enabled(ptrs->res)) {
+        return NULL;
+    }
+    anj_uri_path_t path = read_cache_path(ptrs);
+    for (size_t i = 0; i < ANJ_DM_READ_CACHE_SIZE; i++) {
+        _anj_dm_read_cache_entry_t *entry = &anj->dm.read_cache[i];
+        if (anj_uri_path_equal(&entry->path, &path)) {
+            if (anj_time_monotonic_lt(
+                        _ANJ_STEP_TIME_NOW(&anj->step_time), entry->expires)) {
+                return entry;
+            }
+            entry->path = ANJ_MAKE_ROOT_PATH();
+            return NULL;
+        }
+    }
+    return NULL;
+}
+
+static void read_cache_put(anj_t *anj,
+                           const _anj_dm_entity_ptrs_t *ptrs,
+                           const anj_res_value_t *value) {
+    if (!read_cache_enabled(ptrs->res)) {
+        return;
+    }
+    anj_uri_path_t path = read_cache_path(ptrs);
+    // the entry of the Resource, otherwise an unused one, otherwise the one
+    // expiring first
+    _anj_dm_read_cache_entry_t *slot = NULL;
+    for (size_t i = 0; i < ANJ_DM_READ_CACHE_SIZE; i++) {
+        _anj_dm_read_cache_entry_t *entry = &anj->dm.read_cache[i];
+        if (anj_uri_path_equal(&entry->path, &path)) {
+            slot = entry;
+            break;
+        }
+        if (!slot || (anj_uri_path_length(&slot->path)
+                      && (!anj_uri_path_length(&entry->path)
+                          || anj_time_monotonic_lt(entry->expires,
+                                                   slot->expires)))) {
+            slot = entry;
+        }
+    }
+    slot->path = path;
+    slot->value = *value;
+    slot->expires = anj_time_monotonic_add(
+            _ANJ_STEP_TIME_NOW(&anj->step_time),
+            anj_time_duration_new(ptrs->res->read_cache_max_age_ms,
+                                  ANJ_TIME_UNIT_MS));
+}
+
+void _anj_dm_read_cache_invalidate(_anj_dm_data_model_t *dm,
+                                   const anj_uri_path_t *path) {
+    assert(dm && path);
+    for (size_t i = 0; i < ANJ_DM_READ_CACHE_SIZE; i++) {
+        _anj_dm_read_cache_entry_t *entry = &dm->read_cache[i];
+        if (anj_uri_path_length(&entry->path)
+                && !anj_uri_path_outside_base(&entry->path, path)) {
+            entry->path = ANJ_MAKE_ROOT_PATH();
+        }
+    }
+}
+#endif // ANJ_DM_WITH_READ_CACHE
+
 static int get_read_value(anj_t *anj,
                           anj_res_value_t *out_value,
                           _anj_dm_entity_ptrs_t *ptrs) {
     memset(out_value, 0, sizeof(*out_value));
+#ifdef ANJ_OBSERVE_WITH_VALUE_CACHE
+    if (anj->dm.cached_read_value) {
+        /* the cached value serves a single read only */
+        *out_value = *anj->dm.cached_read_value;
+        anj->dm.cached_read_value = NULL;
+        return 0;
+    }
+#endif // ANJ_OBSERVE_WITH_VALUE_CACHE
+#ifdef ANJ_DM_WITH_READ_CACHE
+    const _anj_dm_read_cache_entry_t *cached = read_cache_find(anj, ptrs);
+    if (cached) {
+        *out_value = cached->value;
+        return 0;
+    }
+#endif // ANJ_DM_WITH_READ_CACHE
     int ret = ptrs->obj->handlers->res_read(anj, ptrs->obj, ptrs->inst->iid,
                                             ptrs->res->rid, ptrs->riid,
                                             out_value);
+#ifdef ANJ_WITH_SEPARATE_RESPONSE
+    if (ret == ANJ_DM_PENDING) {
+        if (!anj->dm.pending_allowed) {
+            dm_log(L_ERROR, "Read of the Resource can't be deferred");
+            return ANJ_DM_ERR_INTERNAL;
+        }
+        anj->dm.pending = true;
+        return _ANJ_DM_PENDING_RECORD;
+    }
+#endif // ANJ_WITH_SEPARATE_RESPONSE
     if (!ret && ptrs->res->type == ANJ_DATA_TYPE_STRING) {
         out_value->bytes_or_string.chunk_length =
                 out_value->bytes_or_string.data
                         ? strlen((const char *) out_value->bytes_or_string.data)
                         : 0;
     }
+#ifdef ANJ_DM_WITH_READ_CACHE
+    if (!ret) {
+        read_cache_put(anj, ptrs, out_value);
+    }
+#endif // ANJ_DM_WITH_READ_CACHE
     return ret;
 }
 
+#ifdef ANJ_DM_WITH_RES_READ_BATCH
+static int call_res_read_batch(anj_t *anj, const _anj_dm_entity_ptrs_t *ptrs) {
+    _anj_dm_data_model_t *dm = &anj->dm;
+    anj_dm_res_read_batch_t *handler = ptrs->obj->handlers->res_read_batch;
+    if (!handler
+            || (dm->read_batch_obj == ptrs->obj
+                && dm->read_batch_iid == ptrs->inst->iid
+                && (!dm->read_batch_res || dm->read_batch_res == ptrs->res))) {
+        return 0;
+    }
+#    ifdef ANJ_OBSERVE_WITH_VALUE_CACHE
+    if (dm->cached_read_value) {
+        return 0;
+    }
+#    endif // ANJ_OBSERVE_WITH_VALUE_CACHE
+#    ifdef ANJ_DM_WITH_READ_CACHE
+    if (read_cache_find(anj, ptrs)) {
+        return 0;
+    }
+#    endif // ANJ_DM_WITH_READ_CACHE
+    const anj_rid_t *rids = NULL;
+    size_t rids_count = 0;
+    anj_id_type_t base_level = dm->op_ctx.read_ctx.base_level;
+    dm->read_batch_obj = ptrs->obj;
+    dm->read_batch_iid = ptrs->inst->iid;
+    dm->read_batch_res = NULL;
+    if (base_level == ANJ_ID_RID || base_level == ANJ_ID_RIID) {
+        /* Other Resources of the Instance may be targeted by next paths of a
+         * Read-Composite, so only this Resource is marked as prepared */
+        dm->read_batch_res = ptrs->res;
+        rids = &ptrs->res->rid;
+        rids_count = 1;
+    }
+    return handler(anj, ptrs->obj, ptrs->inst->iid, rids, rids_count);
+}
+#endif // ANJ_DM_WITH_RES_READ_BATCH
+
 static void increment_idx_starting_from_res(_anj_dm_read_ctx_t *read_ctx,
                                             uint16_t res_count) {
     read_ctx->res_idx++;
     if (read_ctx->res_idx == res_count) {
         read_ctx->res_idx = 0;
-        read_ctx->inst_idx++;
+        read_ctx->next_inst = true;
     }
 }
 
 static void get_readable_resource(_anj_dm_data_model_t *dm) {
     _anj_dm_read_ctx_t *read_ctx = &dm->op_ctx.read_ctx;
     _anj_dm_entity_ptrs_t *entity_ptrs = &dm->entity_ptrs;
-    const anj_dm_obj_t *obj = entity_ptrs->obj;
     const anj_dm_res_t *res;
     bool found = false;
     while (!found) {
-        if (read_ctx->base_level == ANJ_ID_OID) {
-            assert(read_ctx->inst_idx < obj->max_inst_count);
-            entity_ptrs->inst = &obj->insts[read_ctx->inst_idx];
+        /* the Instance of the previous record is kept until now, since it may
+         * be materialized by the inst_next handler into the same buffer */
+        if (read_ctx->base_level == ANJ_ID_OID && read_ctx->next_inst) {
+            entity_ptrs->inst = _anj_dm_next_inst(entity_ptrs->obj,
+                                                  entity_ptrs->inst->iid);
+            read_ctx->next_inst = false;
         }
+        assert(entity_ptrs->inst);
         assert(read_ctx->res_idx < entity_ptrs->inst->res_count);
         res = &entity_ptrs->inst->resources[read_ctx->res_idx];
         if (_anj_dm_is_readable_resource(res->kind)) {
             if (_anj_dm_is_multi_instance_resource(res->kind)
-                    && res->max_inst_count != 0
-                    && res->insts[0] != ANJ_ID_INVALID) {
-                uint16_t inst_count = _anj_dm_count_res_insts(res);
-                assert(read_ctx->res_inst_idx < inst_count);
-                entity_ptrs->riid = res->insts[read_ctx->res_inst_idx];
-                // increment resource instance index
-                read_ctx->res_inst_idx++;
-                if (read_ctx->res_inst_idx == inst_count) {
+                    && _anj_dm_first_res_inst(entity_ptrs->inst, res)
+                                   != ANJ_ID_INVALID) {
+                entity_ptrs->riid = _anj_dm_next_res_inst(
+                        entity_ptrs->inst, res, &read_ctx->res_inst_idx);
+                assert(entity_ptrs->riid != ANJ_ID_INVALID);
+                uint16_t cursor = read_ctx->res_inst_idx;
+                if (_anj_dm_next_res_inst(entity_ptrs->inst, res, &cursor)
+                        == ANJ_ID_INVALID) {
                     read_ctx->res_inst_idx = 0;
                     increment_idx_starting_from_res(
                             read_ctx, entity_ptrs->inst->res_count);
@@ -251,9 +437,10 @@ int _anj_dm_get_read_entry(anj_t *anj, anj_io_out_entry_t *out_record) {
     // there is nothing to do on ANJ_ID_RIID level
     if (read_ctx->base_level == ANJ_ID_RID) {
         if (_anj_dm_is_multi_instance_resource(entity_ptrs->res->kind)) {
-            assert(read_ctx->res_inst_idx < entity_ptrs->res->max_inst_count);
             entity_ptrs->riid =
-                    entity_ptrs->res->insts[read_ctx->res_inst_idx++];
+                    _anj_dm_next_res_inst(entity_ptrs->inst, entity_ptrs->res,
+                                          &read_ctx->res_inst_idx);
+            assert(entity_ptrs->riid != ANJ_ID_INVALID);
         }
         // there is nothing to do on ANJ_ID_RID level for single-instance case
     }
@@ -267,7 +454,15 @@ int _anj_dm_get_read_entry(anj_t *anj, anj_io_out_entry_t *out_record) {
                     ? ANJ_MAKE_RESOURCE_INSTANCE_PATH(obj->oid, obj_inst->iid,
                                                       res->rid, riid)
                     : ANJ_MAKE_RESOURCE_PATH(obj->oid, obj_inst->iid, res->rid);
+#ifdef ANJ_DM_WITH_RES_READ_BATCH
+    int result = call_res_read_batch(anj, entity_ptrs);
+    if (result) {
+        return result;
+    }
+    result = get_read_value(anj, &out_record->value, entity_ptrs);
+#else  // ANJ_DM_WITH_RES_READ_BATCH
     int result = get_read_value(anj, &out_record->value, entity_ptrs);
+#endif // ANJ_DM_WITH_RES_READ_BATCH
     if (result) {
         return result;
     }
@@ -319,11 +514,11 @@ int _anj_dm_count_readable_res_if_allowed(anj_t *anj,
         if (ptrs.riid != ANJ_ID_INVALID) {
             count = _anj_dm_is_readable_resource(ptrs.res->kind) ? 1 : 0;
         } else if (ptrs.res) {
-            count = get_readable_res_count_from_resource(ptrs.res);
+            count = get_readable_res_count_from_resource(ptrs.inst, ptrs.res);
         } else if (ptrs.inst) {
             count = get_readable_res_count_from_instance(ptrs.inst);
         } else {
-            count = get_readable_res_count_from_object(ptrs.obj);
+            count = get_readable_res_count_from_object(dm, ptrs.obj);
         }
     } else {
         for (uint16_t idx = 0; idx < dm->objs_count; idx++) {
@@ -331,7 +526,7 @@ int _anj_dm_count_readable_res_if_allowed(anj_t *anj,
                     || dm->objs[idx]->oid == ANJ_OBJ_ID_OSCORE) {
                 continue;
             }
-            count += get_readable_res_count_from_object(dm->objs[idx]);
+            count += get_readable_res_count_from_object(dm, dm->objs[idx]);
         }
     }
     *out_res_count = count;
@@ -345,7 +540,6 @@ int _anj_dm_composite_next_path(anj_t *anj, const anj_uri_path_t *path) {
     assert(dm->operation == ANJ_OP_DM_READ_COMP);
 
     int ret = 0;
-    _anj_dm_read_ctx_t *read_ctx = &dm->op_ctx.read_ctx;
     bool root_path = !anj_uri_path_has(path, ANJ_ID_OID);
 
     assert(dm->op_count == 0);
@@ -391,42 +585,30 @@ int _anj_dm_composite_next_path(anj_t *anj, const anj_uri_path_t *path) {
         return ret;
     }
 
-    read_ctx->inst_idx = 0;
-    read_ctx->res_idx = 0;
-    read_ctx->res_inst_idx = 0;
-
+    reset_read_ctx(dm);
     return 0;
 }
 #endif // ANJ_WITH_COMPOSITE_OPERATIONS
 
-int _anj_dm_get_resource_value(anj_t *anj,
-                               const anj_uri_path_t *path,
-                               anj_res_value_t *out_value,
-                               anj_data_type_t *out_type,
-                               bool *out_multi_res) {
-    assert(anj && path);
-    _anj_dm_data_model_t *dm = &anj->dm;
-    if (!anj_uri_path_has(path, ANJ_ID_RID)) {
-        dm_log(L_ERROR, "Incorect path");
-        return ANJ_DM_ERR_BAD_REQUEST;
-    }
-    _anj_dm_entity_ptrs_t ptrs;
-    int ret = _anj_dm_get_entity_ptrs(dm, path, &ptrs);
-    if (ret) {
-        return ret;
-    }
+static int get_resource_value_from_ptrs(anj_t *anj,
+                                        const anj_uri_path_t *path,
+                                        _anj_dm_entity_ptrs_t *ptrs,
+                                        anj_res_value_t *out_value,
+                                        anj_data_type_t *out_type,
+                                        bool *out_multi_res) {
     if (out_type) {
-        *out_type = ptrs.res->type;
+        *out_type = ptrs->res->type;
     }
     if (!out_value) {
         return 0;
     }
-    if (!_anj_dm_is_readable_resource(ptrs.res->kind)) {
+    if (!_anj_dm_is_readable_resource(ptrs->res->kind)) {
         dm_log(L_ERROR, "Resource is not readable");
         return ANJ_DM_ERR_METHOD_NOT_ALLOWED;
     }
 
-    bool is_multi_instance = _anj_dm_is_multi_instance_resource(ptrs.res->kind);
+    bool is_multi_instance =
+            _anj_dm_is_multi_instance_resource(ptrs->res->kind);
     if (out_multi_res) {
         *out_multi_res = is_multi_instance ? true : false;
     }
@@ -435,7 +617,27 @@ int _anj_dm_get_resource_value(anj_t *anj,
         return ANJ_DM_ERR_BAD_REQUEST;
     }
 
-    return get_read_value(anj, out_value, &ptrs);
+    return get_read_value(anj, out_value, ptrs);
+}
+
+int _anj_dm_get_resource_value(anj_t *anj,
+                               const anj_uri_path_t *path,
+                               anj_res_value_t *out_value,
+                               anj_data_type_t *out_type,
+                               bool *out_multi_res) {
+    assert(anj && path);
+    _anj_dm_data_model_t *dm = &anj->dm;
+    if (!anj_uri_path_has(path, ANJ_ID_RID)) {
+        dm_log(L_ERROR, "Incorect path");
+        return ANJ_DM_ERR_BAD_REQUEST;
+    }
+    _anj_dm_entity_ptrs_t ptrs;
+    int ret = _anj_dm_get_entity_ptrs(dm, path, &ptrs);
+    if (ret) {
+        return ret;
+    }
+    return get_resource_value_from_ptrs(anj, path, &ptrs, out_value, out_type,
+                                        out_multi_res);
 }
 
 int _anj_dm_get_resource_type(anj_t *anj,
@@ -476,10 +678,7 @@ int _anj_dm_begin_read_op(anj_t *anj, const anj_uri_path_t *base_path) {
         return result;
     }
 
-    _anj_dm_read_ctx_t *read_ctx = &dm->op_ctx.read_ctx;
-    read_ctx->inst_idx = 0;
-    read_ctx->res_idx = 0;
-    read_ctx->res_inst_idx = 0;
+    reset_read_ctx(dm);
     return 0;
 }
 
@@ -489,3 +688,22 @@ int anj_dm_res_read(anj_t *anj,
     assert(anj && path && out_value && anj_uri_path_has(path, ANJ_ID_RID));
     return _anj_dm_get_resource_value(anj, path, out_value, NULL, NULL);
 }
+
+#ifdef ANJ_DM_WITH_PATH_HANDLES
+int anj_dm_res_read_by_handle(anj_t *anj,
+                              anj_dm_path_handle_t *handle,
+                              anj_res_value_t *out_value) {
+    assert(anj && handle && out_value);
+    if (!anj_uri_path_has(&handle->path, ANJ_ID_RID)) {
+        dm_log(L_ERROR, "Incorect path");
+        return ANJ_DM_ERR_BAD_REQUEST;
+    }
+    _anj_dm_entity_ptrs_t ptrs;
+    int ret = _anj_dm_get_path_handle_ptrs(&anj->dm, handle, &ptrs);
+    if (ret) {
+        return ret;
+    }
+    return get_resource_value_from_ptrs(anj, &handle->path, &ptrs, out_value,
+                                        NULL, NULL);
+}
+#endif // ANJ_DM_WITH_PATH_HANDLES
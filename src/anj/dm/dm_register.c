@@ -37,7 +37,6 @@ int _anj_dm_begin_register_op(anj_t *anj) {
     }
     reg_ctx->level = ANJ_ID_OID;
     reg_ctx->obj_idx = 0;
-    reg_ctx->inst_idx = 0;
     return 0;
 }
 
@@ -62,23 +61,23 @@ int _anj_dm_get_register_record(anj_t *anj,
         const anj_dm_obj_t *obj = dm->objs[reg_ctx->obj_idx];
         *out_path = ANJ_MAKE_OBJECT_PATH(obj->oid);
         *out_version = obj->version;
-        uint16_t inst_count = _anj_dm_count_obj_insts(obj);
-        if (!inst_count) {
+        const anj_dm_obj_inst_t *inst = _anj_dm_first_inst(obj);
+        if (!inst) {
             reg_ctx->obj_idx++;
         } else {
             reg_ctx->level = ANJ_ID_IID;
-            reg_ctx->inst_idx = 0;
+            reg_ctx->iid = inst->iid;
         }
     } else {
         const anj_dm_obj_t *obj = dm->objs[reg_ctx->obj_idx];
-        uint16_t inst_count = _anj_dm_count_obj_insts(obj);
-        assert(reg_ctx->inst_idx < inst_count);
+        assert(reg_ctx->iid != ANJ_ID_INVALID);
 
-        *out_path = ANJ_MAKE_INSTANCE_PATH(obj->oid,
-                                           obj->insts[reg_ctx->inst_idx].iid);
+        *out_path = ANJ_MAKE_INSTANCE_PATH(obj->oid, reg_ctx->iid);
         *out_version = NULL;
-        reg_ctx->inst_idx++;
-        if (reg_ctx->inst_idx == inst_count) {
+        const anj_dm_obj_inst_t *next = _anj_dm_next_inst(obj, reg_ctx->iid);
+        if (next) {
+            reg_ctx->iid = next->iid;
+        } else {
             reg_ctx->level = ANJ_ID_OID;
             reg_ctx->obj_idx++;
         }
@@ -87,3 +86,41 @@ int _anj_dm_get_register_record(anj_t *anj,
     dm->op_count--;
     return dm->op_count > 0 ? 0 : _ANJ_DM_LAST_RECORD;
 }
+
+#ifdef ANJ_DM_WITH_LINK_SET_HASH
+// FNV-1a
+static uint32_t hash_u16(uint32_t hash, uint16_t value) {
+    hash = (hash ^ (uint8_t) value) * 16777619U;
+    return (hash ^ (uint8_t) (value >> 8)) * 16777619U;
+}
+
+uint32_t _anj_dm_link_set_hash(anj_t *anj) {
+    assert(anj);
+    _anj_dm_data_model_t *dm = &anj->dm;
+    if (dm->link_set_hash_valid) {
+        return dm->link_set_hash;
+    }
+    uint32_t hash = 2166136261U;
+    for (uint16_t idx = 0; idx < dm->objs_count; idx++) {
+        const anj_dm_obj_t *obj = dm->objs[idx];
+        if (obj->oid == ANJ_OBJ_ID_SECURITY || obj->oid == ANJ_OBJ_ID_OSCORE) {
+            continue;
+        }
+        hash = hash_u16(hash, obj->oid);
+        // separates the version from Instance IDs
+        hash = (hash ^ 0xFF) * 16777619U;
+        for (const char *c = obj->version; c && *c; c++) {
+            hash = (hash ^ (uint8_t) *c) * 16777619U;
+        }
+        uint16_t inst_count = _anj_dm_count_obj_insts(obj);
+        hash = hash_u16(hash, inst_count);
+        for (const anj_dm_obj_inst_t *inst = _anj_dm_first_inst(obj); inst;
+             inst = _anj_dm_next_inst(obj, inst->iid)) {
+            hash = hash_u16(hash, inst->iid);
+        }
+    }
+    dm->link_set_hash = hash;
+    dm->link_set_hash_valid = true;
+    return hash;
+}
+#endif // ANJ_DM_WITH_LINK_SET_HASH
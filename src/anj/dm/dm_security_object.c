@@ -183,6 +183,13 @@ static anj_dm_security_instance_t *find_sec_inst(const anj_dm_obj_t *obj,
 }
 
 #    ifdef ANJ_WITH_SECURITY
+#        ifdef ANJ_SEC_OBJ_WITH_EXTERNAL_KEYS_ONLY
+#            define KEY_BUFF(Inst, Name) NULL, 0
+#        else  // ANJ_SEC_OBJ_WITH_EXTERNAL_KEYS_ONLY
+#            define KEY_BUFF(Inst, Name) \
+                (Inst)->Name##_buff, sizeof((Inst)->Name##_buff)
+#        endif // ANJ_SEC_OBJ_WITH_EXTERNAL_KEYS_ONLY
+
 static int write_security_info(anj_t *anj,
                                const anj_res_value_t *value,
                                anj_crypto_security_info_t *sec_info,
@@ -255,8 +262,7 @@ static int res_write(anj_t *anj,
     case ANJ_DM_SECURITY_RID_PUBLIC_KEY_OR_IDENTITY:
         return write_security_info(anj, value,
                                    &sec_inst->public_key_or_identity,
-                                   sec_inst->public_key_or_identity_buff,
-                                   ANJ_SEC_OBJ_MAX_PUBLIC_KEY_OR_IDENTITY_SIZE,
+                                   KEY_BUFF(sec_inst, public_key_or_identity),
 #        ifdef ANJ_WITH_CERTIFICATES
                                    ANJ_CRYPTO_SECURITY_TAG_CERTIFICATE_CHAIN
 #        else  // ANJ_WITH_CERTIFICATES
@@ -265,13 +271,11 @@ static int res_write(anj_t *anj,
         );
     case ANJ_DM_SECURITY_RID_SERVER_PUBLIC_KEY:
         return write_security_info(anj, value, &sec_inst->server_public_key,
-                                   sec_inst->server_public_key_buff,
-                                   ANJ_SEC_OBJ_MAX_SERVER_PUBLIC_KEY_SIZE,
+                                   KEY_BUFF(sec_inst, server_public_key),
                                    ANJ_CRYPTO_SECURITY_TAG_CERTIFICATE_CHAIN);
     case ANJ_DM_SECURITY_RID_SECRET_KEY:
         return write_security_info(anj, value, &sec_inst->secret_key,
-                                   sec_inst->secret_key_buff,
-                                   ANJ_SEC_OBJ_MAX_SECRET_KEY_SIZE,
+                                   KEY_BUFF(sec_inst, secret_key),
 #        ifdef ANJ_WITH_CERTIFICATES
                                    ANJ_CRYPTO_SECURITY_TAG_PRIVATE_KEY
 #        else  // ANJ_WITH_CERTIFICATES
@@ -472,6 +476,11 @@ static void transaction_end(anj_t *anj,
                sizeof(ctx->security_instances));
         memcpy(ctx->inst, ctx->cache_inst, sizeof(ctx->inst));
     }
+#    ifdef ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
+    else {
+        ctx->dirty = true;
+    }
+#    endif // ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
 }
 
 static const anj_dm_handlers_t HANDLERS = {
@@ -490,6 +499,10 @@ static const anj_dm_handlers_t HANDLERS = {
 void anj_dm_security_obj_init(anj_dm_security_obj_t *security_obj_ctx) {
     assert(security_obj_ctx);
     memset(security_obj_ctx, 0, sizeof(*security_obj_ctx));
+#    ifdef ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
+    // nothing is stored yet
+    security_obj_ctx->dirty = true;
+#    endif // ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
 
     security_obj_ctx->obj = (anj_dm_obj_t) {
         .oid = ANJ_OBJ_ID_SECURITY,
@@ -511,19 +524,30 @@ void anj_dm_security_obj_init(anj_dm_security_obj_t *security_obj_ctx) {
 static int copy_security_info(anj_crypto_security_info_t *dest,
                               const anj_crypto_security_info_t *src,
                               uint8_t *buffer,
-                              size_t buffer_size) {
+                              size_t buffer_size,
+                              const char *size_option) {
     *dest = *src;
     if (src->source != ANJ_CRYPTO_DATA_SOURCE_BUFFER) {
         return 0; // nothing to copy
     }
+#        ifdef ANJ_SEC_OBJ_WITH_EXTERNAL_KEYS_ONLY
+    (void) buffer;
+    (void) buffer_size;
+    (void) size_option;
+    dm_log(L_ERROR, "Security info must be kept in the crypto storage");
+    return -1;
+#        else  // ANJ_SEC_OBJ_WITH_EXTERNAL_KEYS_ONLY
     if (src->info.buffer.data_size > buffer_size) {
-        dm_log(L_ERROR, "Internal buffer too small for security info");
+        dm_log(L_ERROR,
+               "Internal buffer too small for security info, increase %s",
+               size_option);
         return -1;
     }
     memcpy(buffer, src->info.buffer.data, src->info.buffer.data_size);
     // set the destination buffer to point to the copied data
     dest->info.buffer.data = buffer;
     return 0;
+#        endif // ANJ_SEC_OBJ_WITH_EXTERNAL_KEYS_ONLY
 }
 #    endif // ANJ_WITH_SECURITY
 
@@ -566,22 +590,19 @@ int anj_dm_security_obj_add_instance(
 #    ifdef ANJ_WITH_SECURITY
     if (copy_security_info(&sec_inst->public_key_or_identity,
                            &instance->public_key_or_identity,
-                           sec_inst->public_key_or_identity_buff,
-                           ANJ_SEC_OBJ_MAX_PUBLIC_KEY_OR_IDENTITY_SIZE)) {
-        dm_log(L_ERROR, "Increase ANJ_SEC_OBJ_MAX_PUBLIC_KEY_OR_IDENTITY_SIZE");
+                           KEY_BUFF(sec_inst, public_key_or_identity),
+                           "ANJ_SEC_OBJ_MAX_PUBLIC_KEY_OR_IDENTITY_SIZE")) {
         return -1;
     }
     if (copy_security_info(&sec_inst->server_public_key,
                            &instance->server_public_key,
-                           sec_inst->server_public_key_buff,
-                           ANJ_SEC_OBJ_MAX_SERVER_PUBLIC_KEY_SIZE)) {
-        dm_log(L_ERROR, "Increase ANJ_SEC_OBJ_MAX_SERVER_PUBLIC_KEY_SIZE");
+                           KEY_BUFF(sec_inst, server_public_key),
+                           "ANJ_SEC_OBJ_MAX_SERVER_PUBLIC_KEY_SIZE")) {
         return -1;
     }
     if (copy_security_info(&sec_inst->secret_key, &instance->secret_key,
-                           sec_inst->secret_key_buff,
-                           ANJ_SEC_OBJ_MAX_SECRET_KEY_SIZE)) {
-        dm_log(L_ERROR, "Increase ANJ_SEC_OBJ_MAX_SECRET_KEY_SIZE");
+                           KEY_BUFF(sec_inst, secret_key),
+                           "ANJ_SEC_OBJ_MAX_SECRET_KEY_SIZE")) {
         return -1;
     }
 #    endif // ANJ_WITH_SECURITY
@@ -649,6 +670,39 @@ int anj_dm_security_obj_get_psk(const anj_t *anj,
     dm_log(L_ERROR, "No PSK found for the server");
     return ANJ_DM_ERR_NOT_FOUND;
 }
+
+#        ifdef ANJ_WITH_RAW_PUBLIC_KEY
+int anj_dm_security_obj_get_rpk(const anj_t *anj,
+                                bool bootstrap_credentials,
+                                anj_net_rpk_info_t *out_rpk) {
+    assert(anj && out_rpk);
+    const anj_dm_obj_t *obj = anj->dm.objs[0];
+    // security object is always the first one
+    assert(obj && obj->oid == ANJ_OBJ_ID_SECURITY);
+    anj_dm_security_obj_t *ctx =
+            ANJ_CONTAINER_OF(obj, anj_dm_security_obj_t, obj);
+
+    for (int i = 0; i < ANJ_DM_SECURITY_OBJ_INSTANCES; i++) {
+        anj_dm_security_instance_t *sec_inst = &ctx->security_instances[i];
+        if (sec_inst->iid == ANJ_ID_INVALID) {
+            continue;
+        }
+        if (sec_inst->bootstrap_server != bootstrap_credentials) {
+            continue;
+        }
+        out_rpk->public_key = sec_inst->public_key_or_identity;
+        out_rpk->private_key = sec_inst->secret_key;
+        out_rpk->server_public_key = sec_inst->server_public_key;
+        out_rpk->public_key.tag = ANJ_CRYPTO_SECURITY_TAG_CERTIFICATE_CHAIN;
+        out_rpk->private_key.tag = ANJ_CRYPTO_SECURITY_TAG_PRIVATE_KEY;
+        out_rpk->server_public_key.tag =
+                ANJ_CRYPTO_SECURITY_TAG_CERTIFICATE_CHAIN;
+        return 0;
+    }
+    dm_log(L_ERROR, "No Raw Public Key credentials found for the server");
+    return ANJ_DM_ERR_NOT_FOUND;
+}
+#        endif // ANJ_WITH_RAW_PUBLIC_KEY
 #    endif // ANJ_WITH_SECURITY
 
 #    ifdef ANJ_WITH_PERSISTENCE
@@ -666,12 +720,11 @@ int anj_dm_security_obj_get_psk(const anj_t *anj,
 #            define HAS_BOOTSTRAP_SUPPORT 0x00u
 #        endif
 
-static const uint8_t g_persistence_header[] = { 'S',
-                                                'E',
-                                                'C',
-                                                0x01, // version
-                                                HAS_SECURITY_SUPPORT,
-                                                HAS_BOOTSTRAP_SUPPORT };
+static const uint8_t g_persistence_magic[] = { 'S', 'E', 'C' };
+#        define PERSISTENCE_VERSION 1
+// blobs are not portable between builds with a different feature set
+static const uint8_t g_persistence_features[] = { HAS_SECURITY_SUPPORT,
+                                                  HAS_BOOTSTRAP_SUPPORT };
 
 #        ifdef ANJ_WITH_SECURITY
 // store: source - u8, size - u32, data - u8[]
@@ -694,6 +747,25 @@ static int security_persistence(anj_t *anj,
             info->source = ANJ_CRYPTO_DATA_SOURCE_EMPTY;
             return 0;
         case 1:
+#            ifdef ANJ_SEC_OBJ_WITH_EXTERNAL_KEYS_ONLY
+            (void) buffer;
+            (void) buffer_size;
+            dm_log(L_ERROR, "Security info must be kept in the crypto storage");
+            return -1;
+#            else  // ANJ_SEC_OBJ_WITH_EXTERNAL_KEYS_ONLY
+#                ifdef ANJ_PERSISTENCE_WITH_MEMORY_MAPPED_RESTORE
+            if (anj_persistence_memory_mapped(ctx)) {
+                // referenced in place, so the buffer size doesn't matter
+                const void *data;
+                if (anj_persistence_bytes_ref(ctx, &data, record_size)) {
+                    return -1;
+                }
+                info->source = ANJ_CRYPTO_DATA_SOURCE_BUFFER;
+                info->info.buffer.data = data;
+                info->info.buffer.data_size = record_size;
+                return 0;
+            }
+#                endif // ANJ_PERSISTENCE_WITH_MEMORY_MAPPED_RESTORE
             if (buffer_size < record_size) {
                 dm_log(L_ERROR, "Buffer too small for security info");
                 return -1;
@@ -705,6 +777,7 @@ static int security_persistence(anj_t *anj,
             info->info.buffer.data = (uint8_t *) buffer;
             info->info.buffer.data_size = record_size;
             return 0;
+#            endif // ANJ_SEC_OBJ_WITH_EXTERNAL_KEYS_ONLY
 #            ifdef ANJ_WITH_EXTERNAL_CRYPTO_STORAGE
         case 2:
             if (record_size > ANJ_CRYPTO_STORAGE_PERSISTENCE_INFO_MAX_SIZE) {
@@ -726,6 +799,9 @@ static int security_persistence(anj_t *anj,
     }
     uint8_t source;
     uint32_t record_size;
+    // data might be referenced in place after a memory-mapped restore, so it's
+    // not necessarily in the buffer
+    const void *data = NULL;
 #            ifdef ANJ_WITH_EXTERNAL_CRYPTO_STORAGE
     uint8_t external_buff[ANJ_CRYPTO_STORAGE_PERSISTENCE_INFO_MAX_SIZE];
 #            endif // ANJ_WITH_EXTERNAL_CRYPTO_STORAGE
@@ -738,6 +814,7 @@ static int security_persistence(anj_t *anj,
     case ANJ_CRYPTO_DATA_SOURCE_BUFFER:
         source = 1;
         record_size = (uint32_t) info->info.buffer.data_size;
+        data = info->info.buffer.data;
         break;
 #            ifdef ANJ_WITH_EXTERNAL_CRYPTO_STORAGE
     case ANJ_CRYPTO_DATA_SOURCE_EXTERNAL:
@@ -752,6 +829,7 @@ static int security_persistence(anj_t *anj,
         assert(external_record_size
                <= ANJ_CRYPTO_STORAGE_PERSISTENCE_INFO_MAX_SIZE);
         record_size = (uint32_t) external_record_size;
+        data = external_buff;
         break;
 #            endif // ANJ_WITH_EXTERNAL_CRYPTO_STORAGE
     default:
@@ -765,12 +843,7 @@ static int security_persistence(anj_t *anj,
     if (record_size == 0) {
         return 0;
     }
-#            ifdef ANJ_WITH_EXTERNAL_CRYPTO_STORAGE
-    if (anj_persistence_bytes(ctx, source == 1 ? buffer : external_buff,
-                              record_size)) {
-#            else  // ANJ_WITH_EXTERNAL_CRYPTO_STORAGE
-    if (anj_persistence_bytes(ctx, buffer, record_size)) {
-#            endif // ANJ_WITH_EXTERNAL_CRYPTO_STORAGE
+    if (anj_persistence_bytes(ctx, (void *) (intptr_t) data, record_size)) {
         return -1;
     }
     return 0;
@@ -795,14 +868,11 @@ static int instance_persistence(anj_t *anj,
 #        ifdef ANJ_WITH_SECURITY
             || security_persistence(
                        anj, ctx, &sec_inst->public_key_or_identity,
-                       sec_inst->public_key_or_identity_buff,
-                       sizeof(sec_inst->public_key_or_identity_buff))
+                       KEY_BUFF(sec_inst, public_key_or_identity))
             || security_persistence(anj, ctx, &sec_inst->server_public_key,
-                                    sec_inst->server_public_key_buff,
-                                    sizeof(sec_inst->server_public_key_buff))
+                                    KEY_BUFF(sec_inst, server_public_key))
             || security_persistence(anj, ctx, &sec_inst->secret_key,
-                                    sec_inst->secret_key_buff,
-                                    sizeof(sec_inst->secret_key_buff))
+                                    KEY_BUFF(sec_inst, secret_key))
 #        endif // ANJ_WITH_SECURITY
     ) {
         return -1;
@@ -832,8 +902,11 @@ int anj_dm_security_obj_store(anj_t *anj,
         return -1;
     }
 
-    if (anj_persistence_magic(ctx, g_persistence_header,
-                              sizeof(g_persistence_header))) {
+    if (anj_persistence_version(ctx, g_persistence_magic,
+                                sizeof(g_persistence_magic),
+                                PERSISTENCE_VERSION, NULL)
+            || anj_persistence_magic(ctx, g_persistence_features,
+                                     sizeof(g_persistence_features))) {
         return -1;
     }
     if (anj_persistence_u8(ctx, &instance_count)) {
@@ -858,8 +931,11 @@ int anj_dm_security_obj_restore(anj_t *anj,
     assert(anj_persistence_direction(ctx) == ANJ_PERSISTENCE_RESTORE);
     assert(!security_obj_ctx->installed);
 
-    if (anj_persistence_magic(ctx, g_persistence_header,
-                              sizeof(g_persistence_header))) {
+    if (anj_persistence_version(ctx, g_persistence_magic,
+                                sizeof(g_persistence_magic),
+                                PERSISTENCE_VERSION, NULL)
+            || anj_persistence_magic(ctx, g_persistence_features,
+                                     sizeof(g_persistence_features))) {
         return -1;
     }
     uint8_t instance_count = 0;
@@ -874,6 +950,9 @@ int anj_dm_security_obj_restore(anj_t *anj,
             goto err;
         }
     }
+#        ifdef ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
+    security_obj_ctx->dirty = false;
+#        endif // ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
     return 0;
 
 err:
@@ -457,6 +457,11 @@ static void transaction_end(anj_t *anj,
                sizeof(ctx->server_instance));
         memcpy(&ctx->inst, &ctx->cache_inst, sizeof(ctx->inst));
     }
+#    ifdef ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
+    else {
+        ctx->dirty = true;
+    }
+#    endif // ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
 }
 
 static const anj_dm_handlers_t HANDLERS = {
@@ -476,6 +481,10 @@ static const anj_dm_handlers_t HANDLERS = {
 void anj_dm_server_obj_init(anj_dm_server_obj_t *server_obj_ctx) {
     assert(server_obj_ctx);
     memset(server_obj_ctx, 0, sizeof(*server_obj_ctx));
+#    ifdef ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
+    // nothing is stored yet
+    server_obj_ctx->dirty = true;
+#    endif // ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
 
     server_obj_ctx->obj = (anj_dm_obj_t) {
         .oid = ANJ_OBJ_ID_SERVER,
@@ -550,8 +559,8 @@ int anj_dm_server_obj_install(anj_t *anj, anj_dm_server_obj_t *server_obj_ctx) {
 
 #    ifdef ANJ_WITH_PERSISTENCE
 
-static const uint8_t g_persistence_header[] = { 'S', 'E', 'R',
-                                                0x01 }; // version
+static const uint8_t g_persistence_magic[] = { 'S', 'E', 'R' };
+#        define PERSISTENCE_VERSION 1
 
 static int instance_persistence(anj_dm_server_obj_t *server_obj_ctx,
                                 const anj_persistence_context_t *ctx) {
@@ -587,8 +596,9 @@ int anj_dm_server_obj_store(anj_dm_server_obj_t *server_obj_ctx,
         dm_log(L_ERROR, "No Server Object instance to store");
         return -1;
     }
-    if (anj_persistence_magic(ctx, g_persistence_header,
-                              sizeof(g_persistence_header))) {
+    if (anj_persistence_version(ctx, g_persistence_magic,
+                                sizeof(g_persistence_magic),
+                                PERSISTENCE_VERSION, NULL)) {
         return -1;
     }
     return instance_persistence(server_obj_ctx, ctx);
@@ -599,8 +609,9 @@ int anj_dm_server_obj_restore(anj_dm_server_obj_t *server_obj_ctx,
     assert(anj_persistence_direction(ctx) == ANJ_PERSISTENCE_RESTORE);
     assert(!server_obj_ctx->installed);
 
-    if (anj_persistence_magic(ctx, g_persistence_header,
-                              sizeof(g_persistence_header))) {
+    if (anj_persistence_version(ctx, g_persistence_magic,
+                                sizeof(g_persistence_magic),
+                                PERSISTENCE_VERSION, NULL)) {
         return -1;
     }
     if (instance_persistence(server_obj_ctx, ctx)
@@ -608,6 +619,9 @@ int anj_dm_server_obj_restore(anj_dm_server_obj_t *server_obj_ctx,
         server_obj_ctx->inst.iid = ANJ_ID_INVALID;
         return -1;
     }
+#        ifdef ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
+    server_obj_ctx->dirty = false;
+#        endif // ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
     return 0;
 }
 #    endif // ANJ_WITH_PERSISTENCE
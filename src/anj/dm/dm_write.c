@@ -111,9 +111,9 @@ static int begin_write_replace_operation(anj_t *anj) {
     } else if (anj_uri_path_is(path, ANJ_ID_RID)
                && _anj_dm_is_multi_instance_resource(res->kind)) {
         // remove all res_insts
-        uint16_t inst_count = _anj_dm_count_res_insts(res);
+        uint16_t inst_count = _anj_dm_count_res_insts(entity_ptrs->inst, res);
         for (uint16_t idx = 0; idx < inst_count; idx++) {
-            entity_ptrs->riid = res->insts[0];
+            entity_ptrs->riid = _anj_dm_first_res_inst(entity_ptrs->inst, res);
             result = _anj_dm_delete_res_instance(anj);
             if (result) {
                 return result;
@@ -135,21 +135,28 @@ static int handle_res_instances(anj_t *anj, const anj_io_out_entry_t *record) {
 #ifdef ANJ_WITH_COMPOSITE_OPERATIONS
     if (record->type == ANJ_DATA_TYPE_NULL) {
         assert(dm->operation == ANJ_OP_DM_WRITE_COMP);
-        if (!_anj_dm_res_inst_exists(res, record->path.ids[ANJ_ID_RIID])) {
+        if (!_anj_dm_res_inst_exists(inst, res,
+                                     record->path.ids[ANJ_ID_RIID])) {
             return 0;
         }
         return _anj_dm_delete_res_instance(anj);
     }
 #endif // ANJ_WITH_COMPOSITE_OPERATIONS
 
-    uint16_t inst_count = _anj_dm_count_res_insts(res);
     // found res_inst or create new
-    for (uint16_t idx = 0; idx < inst_count; idx++) {
-        if (res->insts[idx] == record->path.ids[ANJ_ID_RIID]) {
-            return 0;
-        }
+    if (_anj_dm_res_inst_exists(inst, res, record->path.ids[ANJ_ID_RIID])) {
+        return 0;
+    }
+    bool no_space;
+#ifdef ANJ_DM_WITH_RES_INST_BITMAP
+    if (res->insts_bitmap) {
+        no_space = record->path.ids[ANJ_ID_RIID] >= res->max_inst_count;
+    } else
+#endif // ANJ_DM_WITH_RES_INST_BITMAP
+    {
+        no_space = _anj_dm_count_res_insts(inst, res) == res->max_inst_count;
     }
-    if (inst_count == res->max_inst_count) {
+    if (no_space) {
         dm_log(L_ERROR, "No space for new resource instance");
         return _ANJ_DM_ERR_MEMORY;
     }
@@ -227,10 +234,14 @@ int _anj_dm_write_entry(anj_t *anj, const anj_io_out_entry_t *record) {
             return ANJ_DM_ERR_BAD_REQUEST;
         }
 
-        result = _anj_dm_get_obj_ptr_ensure_transaction_begin(
-                anj, record->path.ids[ANJ_ID_OID], &dm->entity_ptrs.obj);
-        if (result) {
-            return result;
+        // consecutive records usually target the same Object
+        if (!dm->entity_ptrs.obj
+                || dm->entity_ptrs.obj->oid != record->path.ids[ANJ_ID_OID]) {
+            result = _anj_dm_get_obj_ptr_ensure_transaction_begin(
+                    anj, record->path.ids[ANJ_ID_OID], &dm->entity_ptrs.obj);
+            if (result) {
+                return result;
+            }
         }
     }
 #endif // ANJ_WITH_COMPOSITE_OPERATIONS
@@ -332,3 +343,23 @@ int _anj_dm_begin_write_op(anj_t *anj, const anj_uri_path_t *base_path) {
         return _anj_dm_get_obj_ptrs(obj, base_path, &dm->entity_ptrs);
     }
 }
+
+#ifdef ANJ_DM_WITH_WRITE_BLOCK_COMMIT
+int _anj_dm_write_block_commit(anj_t *anj) {
+    assert(anj);
+    _anj_dm_data_model_t *dm = &anj->dm;
+    assert(dm->op_in_progress && dm->is_transactional);
+    int res = 0;
+    for (uint16_t idx = 0; idx < dm->objs_count && !res; idx++) {
+        const anj_dm_obj_t *obj = dm->objs[idx];
+        if (dm->in_transaction[idx]
+                && obj->handlers->transaction_block_commit) {
+            res = obj->handlers->transaction_block_commit(anj, obj);
+        }
+    }
+    if (res) {
+        dm_log(L_ERROR, "Commit of the written block failed");
+    }
+    return res;
+}
+#endif // ANJ_DM_WITH_WRITE_BLOCK_COMMIT
@@ -28,8 +28,15 @@
 #include "coap/coap.h"
 #include "exchange.h"
 #include "exchange_cache.h"
+#include "metrics.h"
+#include "trace.h"
 #include "utils.h"
 
+#if defined(ANJ_WITH_ADAPTIVE_RTO) || defined(ANJ_METRICS_WITH_HISTOGRAMS)
+#    define WITH_RTT_MEASUREMENT
+#endif // defined(ANJ_WITH_ADAPTIVE_RTO) ||
+       // defined(ANJ_METRICS_WITH_HISTOGRAMS)
+
 static uint8_t
 default_read_payload_handler(void *arg_ptr,
                              uint8_t *buff,
@@ -73,22 +80,306 @@ static void set_default_handlers(_anj_exchange_handlers_t *handlers) {
     }
 }
 
+#ifdef ANJ_WITH_ADAPTIVE_BLOCK_SIZE
+#    define MAX_BLOCK_SIZE 1024
+#    define MIN_BLOCK_SIZE 16
+
+static void block_size_on_timeout(_anj_exchange_ctx_t *ctx) {
+    if (ctx->block_size_timeout) {
+        return;
+    }
+    ctx->block_size_timeout = true;
+    ctx->block_size_successes = 0;
+    // lost blocks are likely fragmented on the way, try smaller ones next time
+    if (ctx->block_transfer && ctx->block_size > MIN_BLOCK_SIZE) {
+        ctx->block_size_limit = (uint16_t) (ctx->block_size >> 1);
+        exchange_log(L_INFO, "block size limited to %" PRIu16,
+                     ctx->block_size_limit);
+    }
+}
+
+static void block_size_on_finish(_anj_exchange_ctx_t *ctx, int result) {
+    if (!ctx->block_size_limit || ctx->block_size_timeout
+            || result != _ANJ_EXCHANGE_RESULT_SUCCESS) {
+        return;
+    }
+    if (++ctx->block_size_successes < ANJ_ADAPTIVE_BLOCK_SIZE_GROWTH_THRESHOLD) {
+        return;
+    }
+    ctx->block_size_successes = 0;
+    ctx->block_size_limit = (uint16_t) (ctx->block_size_limit << 1);
+    if (ctx->block_size_limit >= MAX_BLOCK_SIZE) {
+        ctx->block_size_limit = 0;
+        exchange_log(L_INFO, "block size no longer limited");
+    } else {
+        exchange_log(L_INFO, "block size limited to %" PRIu16,
+                     ctx->block_size_limit);
+    }
+}
+
+void _anj_exchange_reset_block_size_limit(_anj_exchange_ctx_t *ctx) {
+    assert(ctx);
+    ctx->block_size_limit = 0;
+    ctx->block_size_successes = 0;
+    ctx->block_size_timeout = false;
+}
+#endif // ANJ_WITH_ADAPTIVE_BLOCK_SIZE
+
+#ifdef ANJ_WITH_ADAPTIVE_RTO
+// K factors of the estimators and weights of their results in the overall RTO,
+// as defined by CoCoA
+#    define RTO_STRONG_K 4
+#    define RTO_WEAK_K 1
+// weights are in quarters, so that only integer arithmetic is needed
+#    define RTO_STRONG_WEIGHT 2
+#    define RTO_WEAK_WEIGHT 1
+
+static anj_time_duration_t
+rtt_estimator_update(_anj_exchange_rtt_estimator_t *estimator,
+                     anj_time_duration_t rtt,
+                     int32_t k) {
+    if (!estimator->valid) {
+        estimator->valid = true;
+        estimator->srtt = rtt;
+        estimator->rttvar = anj_time_duration_div(rtt, 2);
+    } else {
+        // RFC 6298: alpha = 1/8, beta = 1/4
+        anj_time_duration_t delta = anj_time_duration_sub(estimator->srtt, rtt);
+        if (anj_time_duration_lt(delta, ANJ_TIME_DURATION_ZERO)) {
+            delta = anj_time_duration_sub(ANJ_TIME_DURATION_ZERO, delta);
+        }
+        estimator->rttvar = anj_time_duration_add(
+                anj_time_duration_div(anj_time_duration_mul(estimator->rttvar,
+                                                            3),
+                                      4),
+                anj_time_duration_div(delta, 4));
+        estimator->srtt = anj_time_duration_add(
+                anj_time_duration_div(anj_time_duration_mul(estimator->srtt, 7),
+                                      8),
+                anj_time_duration_div(rtt, 8));
+    }
+    return anj_time_duration_add(estimator->srtt,
+                                 anj_time_duration_mul(estimator->rttvar, k));
+}
+
+static void rto_on_rtt(_anj_exchange_ctx_t *ctx, anj_time_duration_t rtt) {
+    // it's unknown which transmission is answered, so such round-trip times
+    // are used only by the weak estimator, and only if there were at most two
+    // retransmissions
+    if (ctx->retry_count > 2) {
+        return;
+    }
+    bool strong = !ctx->retry_count;
+    anj_time_duration_t estimate = rtt_estimator_update(
+            strong ? &ctx->rto.strong : &ctx->rto.weak, rtt,
+            strong ? RTO_STRONG_K : RTO_WEAK_K);
+    int32_t weight = strong ? RTO_STRONG_WEIGHT : RTO_WEAK_WEIGHT;
+    anj_time_duration_t overall = anj_time_duration_is_valid(ctx->rto.overall)
+                                          ? ctx->rto.overall
+                                          : ctx->tx_params.ack_timeout;
+    overall = anj_time_duration_add(
+            anj_time_duration_div(anj_time_duration_mul(estimate, weight), 4),
+            anj_time_duration_div(anj_time_duration_mul(overall, 4 - weight),
+                                  4));
+    anj_time_duration_t min =
+            anj_time_duration_new(ANJ_ADAPTIVE_RTO_MIN_MS, ANJ_TIME_UNIT_MS);
+    ctx->rto.overall = anj_time_duration_lt(overall, min) ? min : overall;
+    exchange_log(L_TRACE, "RTT %sms, RTO updated to %sms",
+                 ANJ_TIME_DURATION_AS_STRING(rtt, ANJ_TIME_UNIT_MS),
+                 ANJ_TIME_DURATION_AS_STRING(ctx->rto.overall,
+                                             ANJ_TIME_UNIT_MS));
+}
+
+void _anj_exchange_reset_rto(_anj_exchange_ctx_t *ctx) {
+    assert(ctx);
+    ctx->rto.strong.valid = false;
+    ctx->rto.weak.valid = false;
+    ctx->rto.overall = ANJ_TIME_DURATION_INVALID;
+}
+
+anj_time_duration_t _anj_exchange_srtt(const _anj_exchange_ctx_t *ctx) {
+    assert(ctx);
+    return ctx->rto.strong.valid ? ctx->rto.strong.srtt
+                                 : ANJ_TIME_DURATION_INVALID;
+}
+#endif // ANJ_WITH_ADAPTIVE_RTO
+
+#ifdef WITH_RTT_MEASUREMENT
+static void rtt_on_response(_anj_exchange_ctx_t *ctx) {
+    if (!anj_time_monotonic_is_valid(ctx->rtt_start_timestamp)) {
+        return;
+    }
+    anj_time_duration_t rtt =
+            anj_time_monotonic_diff(_ANJ_STEP_TIME_NOW(ctx->step_time),
+                                    ctx->rtt_start_timestamp);
+    ctx->rtt_start_timestamp = ANJ_TIME_MONOTONIC_INVALID;
+#    ifdef ANJ_METRICS_WITH_HISTOGRAMS
+    // after a retransmission it's unknown which transmission is answered
+    if (!ctx->retry_count) {
+        _anj_metrics_histogram_add(ctx->metrics, ANJ_METRICS_HISTOGRAM_ACK_RTT,
+                                   rtt);
+    }
+#    endif // ANJ_METRICS_WITH_HISTOGRAMS
+#    ifdef ANJ_WITH_ADAPTIVE_RTO
+    rto_on_rtt(ctx, rtt);
+#    endif // ANJ_WITH_ADAPTIVE_RTO
+}
+#endif // WITH_RTT_MEASUREMENT
+
+#ifdef ANJ_WITH_ETAG
+// FNV-1a
+static uint64_t etag_hash(uint64_t hash, const uint8_t *data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+// On input, msg->etag is the ETag that the peer already has: the one from the
+// request, or the one of the previous notification. It is replaced with the
+// ETag of the payload, if the payload is sent in a single message; if both are
+// equal, the payload is dropped and the message gets the 2.03 Valid code.
+static void etag_apply(_anj_coap_msg_t *msg) {
+    _anj_etag_t known = msg->etag;
+    msg->etag.size = 0;
+    if (msg->msg_code != ANJ_COAP_CODE_CONTENT || !msg->payload_size
+            || msg->block.block_type == ANJ_OPTION_BLOCK_2
+            || msg->block.block_type == ANJ_OPTION_BLOCK_BOTH) {
+        return;
+    }
+    uint8_t format[2] = { (uint8_t) (msg->content_format >> 8),
+                          (uint8_t) msg->content_format };
+    uint64_t hash = etag_hash(14695981039346656037ULL, format, sizeof(format));
+    hash = etag_hash(hash, msg->payload, msg->payload_size);
+    for (size_t i = 0; i < sizeof(hash); i++) {
+        msg->etag.bytes[i] = (uint8_t) (hash >> (56 - 8 * i));
+    }
+    msg->etag.size = sizeof(hash);
+    if (known.size == msg->etag.size
+            && !memcmp(known.bytes, msg->etag.bytes, msg->etag.size)) {
+        exchange_log(L_DEBUG, "payload not changed, sending 2.03 Valid");
+        msg->msg_code = ANJ_COAP_CODE_VALID;
+        msg->payload_size = 0;
+    }
+}
+#endif // ANJ_WITH_ETAG
+
+static uint16_t initial_block_size(_anj_exchange_ctx_t *ctx, size_t buff_len) {
+    uint16_t block_size = _anj_determine_block_buffer_size(buff_len);
+#ifdef ANJ_WITH_ADAPTIVE_BLOCK_SIZE
+    ctx->block_size_timeout = false;
+    if (ctx->block_size_limit) {
+        block_size = ANJ_MIN(block_size, ctx->block_size_limit);
+    }
+#else  // ANJ_WITH_ADAPTIVE_BLOCK_SIZE
+    (void) ctx;
+#endif // ANJ_WITH_ADAPTIVE_BLOCK_SIZE
+    return block_size;
+}
+
+#ifdef ANJ_WITH_BLOCK2_PREFETCH
+static void swap_prefetch_buffer(_anj_exchange_ctx_t *ctx) {
+    uint8_t *buff = ctx->payload_buff;
+    ctx->payload_buff = ctx->prefetch_buff;
+    ctx->prefetch_buff = buff;
+    ctx->prefetch_swapped = !ctx->prefetch_swapped;
+}
+
+// Called while waiting for the request for the next block, so that the block
+// is ready when the request arrives
+static void prefetch_next_block(_anj_exchange_ctx_t *ctx) {
+    if (!ctx->server_request || !ctx->block_transfer || !ctx->block2_pending
+            || ctx->prefetched || !ctx->prefetch_buff
+            || ctx->block_size > ctx->prefetch_buff_len) {
+        return;
+    }
+    ctx->prefetch_read_result = (_anj_exchange_read_result_t) { 0 };
+    ctx->prefetch_result =
+            ctx->handlers.read_payload(ctx->handlers.arg, ctx->prefetch_buff,
+                                       ctx->block_size,
+                                       &ctx->prefetch_read_result);
+    ctx->prefetched = true;
+    exchange_log(L_TRACE, "block %" PRIu32 " prefetched",
+                 ctx->block_number + 1);
+}
+
+static uint8_t take_prefetched_block(_anj_exchange_ctx_t *ctx,
+                                     _anj_exchange_read_result_t *out_result) {
+    assert(ctx->prefetched);
+    ctx->prefetched = false;
+    swap_prefetch_buffer(ctx);
+    *out_result = ctx->prefetch_read_result;
+    return ctx->prefetch_result;
+}
+#endif // ANJ_WITH_BLOCK2_PREFETCH
+
 static _anj_exchange_state_t finalize_exchange(_anj_exchange_ctx_t *ctx,
                                                const _anj_coap_msg_t *msg,
                                                int result) {
+#ifdef ANJ_WITH_ADAPTIVE_BLOCK_SIZE
+    block_size_on_finish(ctx, result);
+#endif // ANJ_WITH_ADAPTIVE_BLOCK_SIZE
+#ifdef ANJ_WITH_PMTU_PROBING
+    ctx->last_result = result;
+#endif // ANJ_WITH_PMTU_PROBING
+#ifdef ANJ_WITH_METRICS
+    if (result == _ANJ_EXCHANGE_RESULT_SUCCESS) {
+        anj_time_duration_t duration =
+                anj_time_monotonic_diff(_ANJ_STEP_TIME_NOW(ctx->step_time),
+                                        ctx->start_timestamp);
+        _anj_metrics_exchange_finished(ctx->metrics, duration);
+#    ifdef ANJ_METRICS_WITH_HISTOGRAMS
+        if (ctx->server_request) {
+            // notifications turned into Block-Wise transfers are not counted
+            if (ctx->op != ANJ_OP_INF_NON_CON_NOTIFY) {
+                _anj_metrics_histogram_add(ctx->metrics,
+                                           ANJ_METRICS_HISTOGRAM_SERVER_REQUEST,
+                                           duration);
+            }
+        } else if (ctx->base_msg.operation == ANJ_OP_INF_CON_SEND
+                   || ctx->base_msg.operation == ANJ_OP_INF_NON_CON_SEND) {
+            _anj_metrics_histogram_add(ctx->metrics, ANJ_METRICS_HISTOGRAM_SEND,
+                                       duration);
+        }
+#    endif // ANJ_METRICS_WITH_HISTOGRAMS
+    }
+#endif // ANJ_WITH_METRICS
     ctx->handlers.completion(ctx->handlers.arg, msg, result);
     ctx->state = ANJ_EXCHANGE_STATE_FINISHED;
+    _ANJ_TRACE(ctx->trace, EXCHANGE, END, result);
     ctx->block_transfer = false;
     ctx->request_prepared = false;
+#ifdef WITH_RTT_MEASUREMENT
+    ctx->rtt_start_timestamp = ANJ_TIME_MONOTONIC_INVALID;
+#endif // WITH_RTT_MEASUREMENT
+#ifdef ANJ_WITH_BLOCK2_PREFETCH
+    ctx->block2_pending = false;
+    ctx->prefetched = false;
+    if (ctx->prefetch_swapped) {
+        swap_prefetch_buffer(ctx);
+    }
+#endif // ANJ_WITH_BLOCK2_PREFETCH
+#ifdef ANJ_WITH_SEPARATE_RESPONSE
+    ctx->response_deferred = false;
+    ctx->separate_response_sent = false;
+#endif // ANJ_WITH_SEPARATE_RESPONSE
     return ctx->state;
 }
 
 static int exchange_param_init(_anj_exchange_ctx_t *ctx) {
     ctx->retry_count = 0;
     ctx->block_number = 0;
+#ifdef ANJ_WITH_METRICS
+    ctx->start_timestamp = _ANJ_STEP_TIME_NOW(ctx->step_time);
+#endif // ANJ_WITH_METRICS
     // RFC 7252 "The initial timeout is set to a random number between
     // ACK_TIMEOUT and (ACK_TIMEOUT * ACK_RANDOM_FACTOR)"
     anj_time_duration_t ack_timeout = ctx->tx_params.ack_timeout;
+#ifdef ANJ_WITH_ADAPTIVE_RTO
+    if (anj_time_duration_is_valid(ctx->rto.overall)) {
+        ack_timeout = ctx->rto.overall;
+    }
+#endif // ANJ_WITH_ADAPTIVE_RTO
 
     if (ctx->server_request) {
         ctx->timeout = ctx->server_exchange_timeout;
@@ -99,35 +390,46 @@ static int exchange_param_init(_anj_exchange_ctx_t *ctx) {
             exchange_log(L_ERROR, "Could not generate random number");
             return -1;
         }
-        double random_factor = ((double) random / (double) UINT32_MAX)
-                               * (ctx->tx_params.ack_random_factor - 1.0);
-        ctx->timeout = anj_time_duration_fmul(ack_timeout, random_factor + 1.0);
+        ctx->timeout = _anj_exchange_initial_timeout(&ctx->tx_params,
+                                                     ack_timeout, random);
     }
-    ctx->timeout_timestamp =
-            anj_time_monotonic_add(anj_time_monotonic_now(), ctx->timeout);
+    anj_time_monotonic_t now = _ANJ_STEP_TIME_NOW(ctx->step_time);
+    ctx->timeout_timestamp = anj_time_monotonic_add(now, ctx->timeout);
     ctx->send_confirmation_timeout_timestamp =
-            anj_time_monotonic_add(anj_time_monotonic_now(),
-                                   _ANJ_EXCHANGE_COAP_PROCESSING_DELAY);
+            anj_time_monotonic_add(now, _ANJ_EXCHANGE_COAP_PROCESSING_DELAY);
     return 0;
 }
 
 static void reset_exchange_params(_anj_exchange_ctx_t *ctx) {
     ctx->timeout_timestamp =
-            anj_time_monotonic_add(anj_time_monotonic_now(), ctx->timeout);
+            anj_time_monotonic_add(_ANJ_STEP_TIME_NOW(ctx->step_time),
+                                   ctx->timeout);
     ctx->retry_count = 0;
 }
 
-static bool timeout_occurred(anj_time_monotonic_t timeout_timestamp) {
-    return anj_time_monotonic_geq(anj_time_monotonic_now(), timeout_timestamp);
+static bool timeout_occurred(_anj_exchange_ctx_t *ctx,
+                             anj_time_monotonic_t timeout_timestamp) {
+#ifndef ANJ_WITH_STEP_TIME_CACHE
+    (void) ctx;
+#endif // ANJ_WITH_STEP_TIME_CACHE
+    return anj_time_monotonic_geq(_ANJ_STEP_TIME_NOW(ctx->step_time),
+                                  timeout_timestamp);
 }
 
 static void handle_send_confirmation(_anj_exchange_ctx_t *ctx,
                                      _anj_exchange_event_t event) {
     // no retransmission if the message is not sent in the allowed time
-    if (timeout_occurred(ctx->send_confirmation_timeout_timestamp)) {
+    if (timeout_occurred(ctx, ctx->send_confirmation_timeout_timestamp)) {
         exchange_log(L_ERROR, "sending timeout occurred");
         finalize_exchange(ctx, NULL, _ANJ_EXCHANGE_ERROR_TIMEOUT);
     } else if (event == ANJ_EXCHANGE_EVENT_SEND_CONFIRMATION) {
+#ifdef ANJ_WITH_SEPARATE_RESPONSE
+        if (ctx->response_deferred) {
+            ctx->state = ANJ_EXCHANGE_STATE_WAITING_MSG;
+            exchange_log(L_TRACE, "empty ACK sent, waiting for the response");
+            return;
+        }
+#endif // ANJ_WITH_SEPARATE_RESPONSE
         if (!ctx->confirmable && !ctx->block_transfer) {
             // The msg_code is determined while handling a server request.
             // It is either set based on the callback's return value,
@@ -140,30 +442,130 @@ static void handle_send_confirmation(_anj_exchange_ctx_t *ctx,
         } else {
             ctx->state = ANJ_EXCHANGE_STATE_WAITING_MSG;
             exchange_log(L_TRACE, "message sent, waiting for response");
+#ifdef WITH_RTT_MEASUREMENT
+            // retransmissions are measured from the first transmission
+            if (!ctx->server_request && ctx->confirmable
+                    && !ctx->retry_count) {
+                ctx->rtt_start_timestamp = _ANJ_STEP_TIME_NOW(ctx->step_time);
+            }
+#endif // WITH_RTT_MEASUREMENT
         }
     }
 }
 
+#ifdef ANJ_WITH_SEPARATE_RESPONSE
+static void handle_separate_response_ack(_anj_exchange_ctx_t *ctx) {
+    ctx->separate_response_sent = false;
+    ctx->base_msg.separate_response = false;
+    if (!ctx->block_transfer) {
+        exchange_log(L_TRACE, "exchange finished");
+        finalize_exchange(ctx, NULL,
+                          ctx->msg_code >= ANJ_COAP_CODE_BAD_REQUEST
+                                  ? _ANJ_EXCHANGE_ERROR_REQUEST
+                                  : _ANJ_EXCHANGE_RESULT_SUCCESS);
+        return;
+    }
+    // next blocks are requested by the LwM2M Server like in case of a
+    // piggybacked response
+    exchange_log(L_TRACE, "separate response acknowledged, waiting for "
+                          "the next block request");
+    ctx->server_request = true;
+    ctx->confirmable = false;
+    ctx->timeout = ctx->server_exchange_timeout;
+    reset_exchange_params(ctx);
+}
+#endif // ANJ_WITH_SEPARATE_RESPONSE
+
 // This function can be used only to handle server responses.
 static bool is_separate_response_mode(const _anj_coap_msg_t *msg) {
     return msg->coap_binding_data.type == ANJ_COAP_UDP_TYPE_CONFIRMABLE;
 }
 
+#ifdef ANJ_WITH_COUNTER_TOKENS
+#    define TOKEN_RESEED_PERIOD 65536
+
+#    if ANJ_COAP_TOKEN_SIZE > 0
 /**
- * Creates a new CoAP token. The token is a pseudo-random 8-byte value.
- * During @ref _anj_coap_encode_udp call token is not created again.
+ * Returns the next value of the counter mixed with the key by the SplitMix64
+ * generator. As it is a bijection, values don't repeat until the key is
+ * reseeded.
  */
-static int token_create(_anj_coap_token_t *token) {
-    token->size = _ANJ_COAP_MAX_TOKEN_LENGTH;
-    assert(_ANJ_COAP_MAX_TOKEN_LENGTH == 8);
-    uint64_t random;
-    if (anj_rng_generate((uint8_t *) &random, sizeof(random))) {
+static int token_generate(_anj_exchange_ctx_t *ctx, uint64_t *out_value) {
+    if (!(ctx->token_counter % TOKEN_RESEED_PERIOD)) {
+        if (anj_rng_generate((uint8_t *) &ctx->token_key,
+                             sizeof(ctx->token_key))) {
+            exchange_log(L_ERROR, "Could not generate random number");
+            return -1;
+        }
+    }
+    uint64_t value = ctx->token_key
+                     + (uint64_t) ++ctx->token_counter * 0x9E3779B97F4A7C15ULL;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    *out_value = value ^ (value >> 31);
+    return 0;
+}
+#    endif // ANJ_COAP_TOKEN_SIZE > 0
+
+void _anj_exchange_reseed_tokens(_anj_exchange_ctx_t *ctx) {
+    assert(ctx);
+    ctx->token_counter = 0;
+}
+#elif ANJ_COAP_TOKEN_SIZE > 0 // ANJ_WITH_COUNTER_TOKENS
+static int token_generate(_anj_exchange_ctx_t *ctx, uint64_t *out_value) {
+    (void) ctx;
+    if (anj_rng_generate((uint8_t *) out_value, sizeof(*out_value))) {
         exchange_log(L_ERROR, "Could not generate random number");
         return -1;
     }
-    memcpy(token->bytes, &random, sizeof(random));
     return 0;
 }
+#endif // ANJ_WITH_COUNTER_TOKENS
+
+#if ANJ_COAP_TOKEN_SIZE > 0
+// short tokens might collide a few times in a row
+#    define TOKEN_MAX_ATTEMPTS 8
+
+static bool token_used(_anj_exchange_ctx_t *ctx,
+                       const _anj_coap_token_t *token) {
+    // a late response to the previous request must not match the new one
+    if (_anj_tokens_equal(token, &ctx->base_msg.token)) {
+        return true;
+    }
+    return ctx->token_in_use
+           && ctx->token_in_use(ctx->token_in_use_arg, token);
+}
+#endif // ANJ_COAP_TOKEN_SIZE > 0
+
+/**
+ * Creates a new CoAP token of @ref ANJ_COAP_TOKEN_SIZE bytes, not used by the
+ * previous request nor by other modules. During @ref _anj_coap_encode_udp call
+ * token is not created again.
+ */
+static int token_create(_anj_exchange_ctx_t *ctx, _anj_coap_token_t *token) {
+#if ANJ_COAP_TOKEN_SIZE > 0
+    for (int attempt = 0; attempt < TOKEN_MAX_ATTEMPTS; attempt++) {
+        uint64_t value;
+        if (token_generate(ctx, &value)) {
+            return -1;
+        }
+        _anj_coap_token_t new_token = {
+            .size = ANJ_COAP_TOKEN_SIZE
+        };
+        memcpy(new_token.bytes, &value, ANJ_COAP_TOKEN_SIZE);
+        if (!token_used(ctx, &new_token)) {
+            *token = new_token;
+            return 0;
+        }
+    }
+    exchange_log(L_ERROR, "Could not generate unused token");
+    return -1;
+#else  // ANJ_COAP_TOKEN_SIZE > 0
+    (void) ctx;
+    token->size = 0;
+    return 0;
+#endif // ANJ_COAP_TOKEN_SIZE > 0
+}
 
 /**
  * Creates a new CoAP Message ID.
@@ -177,10 +579,28 @@ static void init_msd_id(_anj_exchange_ctx_t *ctx, _anj_coap_msg_t *msg) {
 static void handle_server_response(_anj_exchange_ctx_t *ctx,
                                    _anj_coap_msg_t *in_out_msg) {
     if (in_out_msg->operation == ANJ_OP_COAP_EMPTY_MSG) {
+#ifdef WITH_RTT_MEASUREMENT
+        rtt_on_response(ctx);
+#endif // WITH_RTT_MEASUREMENT
+#ifdef ANJ_WITH_SEPARATE_RESPONSE
+        if (ctx->separate_response_sent) {
+            handle_separate_response_ack(ctx);
+            return;
+        }
+#endif // ANJ_WITH_SEPARATE_RESPONSE
         if (ctx->base_msg.operation == ANJ_OP_INF_CON_NOTIFY) {
             finalize_exchange(ctx, in_out_msg, _ANJ_EXCHANGE_RESULT_SUCCESS);
             return;
-        } else {
+        }
+#ifdef ANJ_LWM2M_SEND_WITH_NO_RESPONSE
+        else if (ctx->base_msg.no_response) {
+            // 2.xx response is suppressed, empty ACK confirms the delivery
+            exchange_log(L_TRACE, "empty ACK with No-Response, finished");
+            finalize_exchange(ctx, in_out_msg, _ANJ_EXCHANGE_RESULT_SUCCESS);
+            return;
+        }
+#endif // ANJ_LWM2M_SEND_WITH_NO_RESPONSE
+        else {
             exchange_log(
                     L_DEBUG,
                     "empty message received, waiting for separate response");
@@ -204,6 +624,9 @@ static void handle_server_response(_anj_exchange_ctx_t *ctx,
                      COAP_CODE_FORMAT(ANJ_COAP_CODE_SERVICE_UNAVAILABLE));
         goto send_service_unavailable;
     }
+#ifdef WITH_RTT_MEASUREMENT
+    rtt_on_response(ctx);
+#endif // WITH_RTT_MEASUREMENT
 
     if (in_out_msg->msg_code >= ANJ_COAP_CODE_BAD_REQUEST) {
         exchange_log(L_ERROR, "received error response: %s",
@@ -220,6 +643,9 @@ static void handle_server_response(_anj_exchange_ctx_t *ctx,
     if (in_out_msg->block.block_type != ANJ_OPTION_BLOCK_NOT_DEFINED) {
         exchange_log(L_DEBUG, "next block received, block number: %" PRIu32,
                      in_out_msg->block.number);
+        if (in_out_msg->block.number) {
+            _ANJ_METRICS_INC(ctx->metrics, blocks_transferred);
+        }
     }
 
     // HACK: The server must reset the more_flag for the last BLOCK1 ACK message
@@ -291,7 +717,7 @@ static void handle_server_response(_anj_exchange_ctx_t *ctx,
         ctx->state = ANJ_EXCHANGE_STATE_WAITING_SEND_CONFIRMATION;
         reset_exchange_params(ctx);
         init_msd_id(ctx, &ctx->base_msg);
-        if (token_create(&ctx->base_msg.token)) {
+        if (token_create(ctx, &ctx->base_msg.token)) {
             finalize_exchange(ctx, NULL, _ANJ_EXCHANGE_ERROR_REQUEST);
         }
         *in_out_msg = ctx->base_msg;
@@ -368,6 +794,7 @@ static void handle_server_request(_anj_exchange_ctx_t *ctx,
     }
     exchange_log(L_DEBUG, "next block received, block number: %" PRIu32,
                  in_out_msg->block.number);
+    _ANJ_METRICS_INC(ctx->metrics, blocks_transferred);
 
     if (in_out_msg->payload_size != 0) {
         if (!in_out_msg->block.more_flag) { // last block
@@ -392,11 +819,19 @@ static void handle_server_request(_anj_exchange_ctx_t *ctx,
     // ANJ_COAP_CODE_CONTINUE means that server is still sending payload, we
     // want to read payload after last write block is received
     if (response_code != ANJ_COAP_CODE_CONTINUE) {
-        in_out_msg->payload = ctx->payload_buff;
         _anj_exchange_read_result_t read_result = { 0 };
-        uint8_t result =
-                ctx->handlers.read_payload(ctx->handlers.arg, ctx->payload_buff,
-                                           ctx->block_size, &read_result);
+        uint8_t result;
+#ifdef ANJ_WITH_BLOCK2_PREFETCH
+        if (ctx->prefetched) {
+            result = take_prefetched_block(ctx, &read_result);
+        } else
+#endif // ANJ_WITH_BLOCK2_PREFETCH
+        {
+            result = ctx->handlers.read_payload(ctx->handlers.arg,
+                                                ctx->payload_buff,
+                                                ctx->block_size, &read_result);
+        }
+        in_out_msg->payload = ctx->payload_buff;
         payload_size = read_result.payload_len;
         in_out_msg->content_format = read_result.format;
         if (read_result.with_create_path) {
@@ -404,9 +839,18 @@ static void handle_server_request(_anj_exchange_ctx_t *ctx,
             in_out_msg->attr.create_attr.oid = read_result.created_oid;
             in_out_msg->attr.create_attr.iid = read_result.created_iid;
         }
+#ifdef ANJ_WITH_SEPARATE_RESPONSE
+        if (result == _ANJ_EXCHANGE_SEPARATE_RESPONSE) {
+            exchange_log(L_ERROR, "response can't be deferred at this point");
+            result = ANJ_COAP_CODE_INTERNAL_SERVER_ERROR;
+        }
+#endif // ANJ_WITH_SEPARATE_RESPONSE
 
         if (result == _ANJ_EXCHANGE_BLOCK_TRANSFER_NEEDED) {
             ctx->block_transfer = true;
+#ifdef ANJ_WITH_BLOCK2_PREFETCH
+            ctx->block2_pending = true;
+#endif // ANJ_WITH_BLOCK2_PREFETCH
 #ifdef ANJ_WITH_COMPOSITE_OPERATIONS
             if (in_out_msg->block.block_type == ANJ_OPTION_BLOCK_1) {
                 in_out_msg->block.block_type = ANJ_OPTION_BLOCK_BOTH;
@@ -453,6 +897,9 @@ send_response:
         in_out_msg->payload_size = payload_size;
     }
     in_out_msg->msg_code = response_code;
+#ifdef ANJ_WITH_ETAG
+    etag_apply(in_out_msg);
+#endif // ANJ_WITH_ETAG
 #ifdef ANJ_WITH_CACHE
     // store the response in case of retransmission
     _anj_exchange_cache_add(ctx->cache, &ctx->tx_params, in_out_msg);
@@ -465,6 +912,9 @@ send_service_unavailable:
     in_out_msg->payload_size = 0;
     in_out_msg->msg_code = ANJ_COAP_CODE_SERVICE_UNAVAILABLE;
     in_out_msg->block.block_type = ANJ_OPTION_BLOCK_NOT_DEFINED;
+#ifdef ANJ_WITH_ETAG
+    etag_apply(in_out_msg);
+#endif // ANJ_WITH_ETAG
 #ifdef ANJ_WITH_CACHE
     // store the response in case of retransmission
     _anj_exchange_cache_add(ctx->cache, &ctx->tx_params, in_out_msg);
@@ -472,6 +922,76 @@ send_service_unavailable:
     return;
 }
 
+#ifdef ANJ_WITH_SEPARATE_RESPONSE
+static void defer_response(_anj_exchange_ctx_t *ctx,
+                           _anj_coap_msg_t *in_out_msg) {
+    exchange_log(L_DEBUG, "response not ready, sending empty ACK");
+    ctx->response_deferred = true;
+    // token and options of the request are needed to prepare the response
+    ctx->base_msg = *in_out_msg;
+    in_out_msg->operation = ANJ_OP_COAP_EMPTY_MSG;
+    in_out_msg->payload_size = 0;
+    in_out_msg->block.block_type = ANJ_OPTION_BLOCK_NOT_DEFINED;
+}
+
+static _anj_exchange_state_t
+send_separate_response(_anj_exchange_ctx_t *ctx, _anj_coap_msg_t *out_msg) {
+    _anj_coap_msg_t *response = &ctx->base_msg;
+    _anj_exchange_read_result_t read_result = { 0 };
+    uint8_t result =
+            ctx->handlers.read_payload(ctx->handlers.arg, ctx->payload_buff,
+                                       ctx->block_size, &read_result);
+    if (result == _ANJ_EXCHANGE_SEPARATE_RESPONSE) {
+        return ANJ_EXCHANGE_STATE_WAITING_MSG;
+    }
+    ctx->response_deferred = false;
+    response->payload = ctx->payload_buff;
+    response->payload_size = read_result.payload_len;
+    response->content_format = read_result.format;
+    response->msg_code = ctx->msg_code;
+    if (read_result.with_create_path) {
+        response->attr.create_attr.has_uri = true;
+        response->attr.create_attr.oid = read_result.created_oid;
+        response->attr.create_attr.iid = read_result.created_iid;
+    }
+    if (result == _ANJ_EXCHANGE_BLOCK_TRANSFER_NEEDED) {
+        ctx->block_transfer = true;
+        response->block = (_anj_block_t) {
+            .more_flag = true,
+            .number = 0,
+            .block_type = ANJ_OPTION_BLOCK_2,
+            .size = ctx->block_size
+        };
+    } else {
+        response->block.block_type = ANJ_OPTION_BLOCK_NOT_DEFINED;
+        if (result) {
+            exchange_log(L_ERROR, "response with error code: %s",
+                         COAP_CODE_FORMAT(result));
+            response->msg_code = result;
+            response->payload_size = 0;
+            ctx->msg_code = result;
+        }
+    }
+#    ifdef ANJ_WITH_ETAG
+    etag_apply(response);
+#    endif // ANJ_WITH_ETAG
+    // from now on, the exchange proceeds like a Confirmable client request
+    // until the response is acknowledged
+    response->separate_response = true;
+    init_msd_id(ctx, response);
+    ctx->server_request = false;
+    ctx->confirmable = true;
+    ctx->separate_response_sent = true;
+    if (exchange_param_init(ctx)) {
+        return finalize_exchange(ctx, NULL, _ANJ_EXCHANGE_ERROR_REQUEST);
+    }
+    exchange_log(L_DEBUG, "separate response created");
+    ctx->state = ANJ_EXCHANGE_STATE_WAITING_SEND_CONFIRMATION;
+    *out_msg = *response;
+    return ANJ_EXCHANGE_STATE_MSG_TO_SEND;
+}
+#endif // ANJ_WITH_SEPARATE_RESPONSE
+
 _anj_exchange_state_t
 _anj_exchange_new_server_request(_anj_exchange_ctx_t *ctx,
                                  uint8_t response_msg_code,
@@ -482,7 +1002,7 @@ _anj_exchange_new_server_request(_anj_exchange_ctx_t *ctx,
     assert(ctx && in_out_msg && handlers && buff && buff_len >= 16);
     assert(ctx->state == ANJ_EXCHANGE_STATE_FINISHED);
     uint8_t result = 0;
-    ctx->block_size = _anj_determine_block_buffer_size(buff_len);
+    ctx->block_size = initial_block_size(ctx, buff_len);
     ctx->payload_buff = buff;
     ctx->server_request = true;
     ctx->confirmable = false;
@@ -490,6 +1010,7 @@ _anj_exchange_new_server_request(_anj_exchange_ctx_t *ctx,
     set_default_handlers(&ctx->handlers);
     ctx->op = in_out_msg->operation;
     ctx->msg_code = response_msg_code;
+    _ANJ_TRACE(ctx->trace, EXCHANGE, BEGIN, ctx->op);
 
     if (exchange_param_init(ctx)) {
         result = ANJ_COAP_CODE_INTERNAL_SERVER_ERROR;
@@ -554,12 +1075,20 @@ _anj_exchange_new_server_request(_anj_exchange_ctx_t *ctx,
         }
         if (result == _ANJ_EXCHANGE_BLOCK_TRANSFER_NEEDED) {
             ctx->block_transfer = true;
+#ifdef ANJ_WITH_BLOCK2_PREFETCH
+            ctx->block2_pending = true;
+#endif // ANJ_WITH_BLOCK2_PREFETCH
             in_out_msg->block = (_anj_block_t) {
                 .more_flag = true,
                 .number = 0,
                 .block_type = ANJ_OPTION_BLOCK_2,
                 .size = ctx->block_size
             };
+#ifdef ANJ_WITH_SEPARATE_RESPONSE
+        } else if (result == _ANJ_EXCHANGE_SEPARATE_RESPONSE) {
+            defer_response(ctx, in_out_msg);
+            result = 0;
+#endif // ANJ_WITH_SEPARATE_RESPONSE
         } else {
             in_out_msg->block.block_type = ANJ_OPTION_BLOCK_NOT_DEFINED;
         }
@@ -577,6 +1106,9 @@ respone_with_error:
     }
     exchange_log(L_TRACE, "new response created");
     ctx->state = ANJ_EXCHANGE_STATE_WAITING_SEND_CONFIRMATION;
+#ifdef ANJ_WITH_ETAG
+    etag_apply(in_out_msg);
+#endif // ANJ_WITH_ETAG
 #ifdef ANJ_WITH_CACHE
     // store the response in case of retransmission
     _anj_exchange_cache_add(ctx->cache, &ctx->tx_params, in_out_msg);
@@ -593,7 +1125,7 @@ _anj_exchange_new_client_request(_anj_exchange_ctx_t *ctx,
     assert(ctx && in_out_msg && handlers && buff && buff_len >= 16);
     assert(ctx->state == ANJ_EXCHANGE_STATE_FINISHED);
     uint8_t result = 0;
-    ctx->block_size = _anj_determine_block_buffer_size(buff_len);
+    ctx->block_size = initial_block_size(ctx, buff_len);
     ctx->payload_buff = buff;
     ctx->server_request = false;
     ctx->block_transfer = false;
@@ -602,13 +1134,14 @@ _anj_exchange_new_client_request(_anj_exchange_ctx_t *ctx,
     set_default_handlers(&ctx->handlers);
 
     _anj_op_t *op = &in_out_msg->operation;
+    _ANJ_TRACE(ctx->trace, EXCHANGE, BEGIN, *op);
     ctx->confirmable =
             (*op == ANJ_OP_INF_NON_CON_SEND || *op == ANJ_OP_INF_NON_CON_NOTIFY)
                     ? false
                     : true;
 
     if (*op != ANJ_OP_INF_CON_NOTIFY && *op != ANJ_OP_INF_NON_CON_NOTIFY) {
-        if (token_create(&in_out_msg->token)) {
+        if (token_create(ctx, &in_out_msg->token)) {
             return finalize_exchange(ctx, NULL, _ANJ_EXCHANGE_ERROR_REQUEST);
         }
     }
@@ -618,11 +1151,33 @@ _anj_exchange_new_client_request(_anj_exchange_ctx_t *ctx,
     if (exchange_param_init(ctx)) {
         return finalize_exchange(ctx, NULL, _ANJ_EXCHANGE_ERROR_REQUEST);
     }
+#ifdef ANJ_COAP_DOWNLOADER_WITH_RESUME
+    // resumed download starts from the block given in the request
+    if (*op == ANJ_OP_COAP_DOWNLOADER_GET
+            && in_out_msg->block.block_type == ANJ_OPTION_BLOCK_2) {
+        ctx->block_number = in_out_msg->block.number;
+    }
+#endif // ANJ_COAP_DOWNLOADER_WITH_RESUME
 
     in_out_msg->payload = buff;
     _anj_exchange_read_result_t read_result = { 0 };
+#ifdef ANJ_METRICS_WITH_HISTOGRAMS
+    bool notification =
+            *op == ANJ_OP_INF_CON_NOTIFY || *op == ANJ_OP_INF_NON_CON_NOTIFY;
+    // the cached step time is not updated while the payload is being built
+    anj_time_monotonic_t build_start = notification
+                                               ? anj_time_monotonic_now()
+                                               : ANJ_TIME_MONOTONIC_INVALID;
+#endif // ANJ_METRICS_WITH_HISTOGRAMS
     result = ctx->handlers.read_payload(ctx->handlers.arg, buff,
                                         ctx->block_size, &read_result);
+#ifdef ANJ_METRICS_WITH_HISTOGRAMS
+    if (notification) {
+        _anj_metrics_histogram_add(
+                ctx->metrics, ANJ_METRICS_HISTOGRAM_NOTIFICATION_BUILD,
+                anj_time_monotonic_diff(anj_time_monotonic_now(), build_start));
+    }
+#endif // ANJ_METRICS_WITH_HISTOGRAMS
     in_out_msg->payload_size = read_result.payload_len;
     in_out_msg->content_format = read_result.format;
     if (result == _ANJ_EXCHANGE_BLOCK_TRANSFER_NEEDED) {
@@ -633,6 +1188,10 @@ _anj_exchange_new_client_request(_anj_exchange_ctx_t *ctx,
             .block_type = ANJ_OPTION_BLOCK_1,
             .size = ctx->block_size
         };
+#ifdef ANJ_LWM2M_SEND_WITH_NO_RESPONSE
+        // 2.31 Continue responses are needed to send the next blocks
+        in_out_msg->no_response = false;
+#endif // ANJ_LWM2M_SEND_WITH_NO_RESPONSE
         if (*op == ANJ_OP_INF_NON_CON_SEND) {
             *op = ANJ_OP_INF_CON_SEND;
             ctx->confirmable = true;
@@ -647,6 +1206,9 @@ _anj_exchange_new_client_request(_anj_exchange_ctx_t *ctx,
             ctx->op = ANJ_OP_INF_NON_CON_NOTIFY;
             *op = ANJ_OP_INF_NON_CON_NOTIFY;
             in_out_msg->block.block_type = ANJ_OPTION_BLOCK_2;
+#ifdef ANJ_WITH_BLOCK2_PREFETCH
+            ctx->block2_pending = true;
+#endif // ANJ_WITH_BLOCK2_PREFETCH
             // recalculate timeout for the first message
             if (exchange_param_init(ctx)) {
                 return finalize_exchange(ctx, NULL,
@@ -658,6 +1220,12 @@ _anj_exchange_new_client_request(_anj_exchange_ctx_t *ctx,
                      COAP_CODE_FORMAT(result));
         return finalize_exchange(ctx, NULL, _ANJ_EXCHANGE_ERROR_REQUEST);
     }
+#ifdef ANJ_WITH_ETAG
+    if (*op == ANJ_OP_INF_CON_NOTIFY || *op == ANJ_OP_INF_NON_CON_NOTIFY) {
+        in_out_msg->msg_code = ANJ_COAP_CODE_CONTENT;
+        etag_apply(in_out_msg);
+    }
+#endif // ANJ_WITH_ETAG
 
     exchange_log(L_TRACE, "new request created");
     ctx->state = ANJ_EXCHANGE_STATE_WAITING_SEND_CONFIRMATION;
@@ -665,9 +1233,9 @@ _anj_exchange_new_client_request(_anj_exchange_ctx_t *ctx,
     return ANJ_EXCHANGE_STATE_MSG_TO_SEND;
 }
 
-_anj_exchange_state_t _anj_exchange_process(_anj_exchange_ctx_t *ctx,
-                                            _anj_exchange_event_t event,
-                                            _anj_coap_msg_t *in_out_msg) {
+static _anj_exchange_state_t exchange_process(_anj_exchange_ctx_t *ctx,
+                                              _anj_exchange_event_t event,
+                                              _anj_coap_msg_t *in_out_msg) {
     assert(ctx && in_out_msg);
     assert(ctx->state == ANJ_EXCHANGE_STATE_WAITING_MSG
            || ctx->state == ANJ_EXCHANGE_STATE_WAITING_SEND_CONFIRMATION);
@@ -695,9 +1263,26 @@ _anj_exchange_state_t _anj_exchange_process(_anj_exchange_ctx_t *ctx,
             reset_exchange_params(ctx);
             return ANJ_EXCHANGE_STATE_MSG_TO_SEND;
         }
+#ifdef ANJ_WITH_SEPARATE_RESPONSE
+        if (ctx->state == ANJ_EXCHANGE_STATE_WAITING_MSG
+                && ctx->response_deferred) {
+            return send_separate_response(ctx, in_out_msg);
+        }
+#endif // ANJ_WITH_SEPARATE_RESPONSE
         return ctx->state;
     }
 
+#ifdef ANJ_WITH_SEPARATE_RESPONSE
+    // the response may become ready at any time, it is checked whenever there
+    // is no incoming message to handle
+    if (event != ANJ_EXCHANGE_EVENT_NEW_MSG && ctx->response_deferred) {
+        _anj_exchange_state_t state = send_separate_response(ctx, in_out_msg);
+        if (state != ANJ_EXCHANGE_STATE_WAITING_MSG) {
+            return state;
+        }
+    }
+#endif // ANJ_WITH_SEPARATE_RESPONSE
+
     if (event == ANJ_EXCHANGE_EVENT_NEW_MSG) {
         if (ctx->server_request) {
             handle_server_request(ctx, in_out_msg);
@@ -706,7 +1291,7 @@ _anj_exchange_state_t _anj_exchange_process(_anj_exchange_ctx_t *ctx,
         }
         if (ctx->state == ANJ_EXCHANGE_STATE_WAITING_SEND_CONFIRMATION) {
             ctx->send_confirmation_timeout_timestamp =
-                    anj_time_monotonic_add(anj_time_monotonic_now(),
+                    anj_time_monotonic_add(_ANJ_STEP_TIME_NOW(ctx->step_time),
                                            _ANJ_EXCHANGE_COAP_PROCESSING_DELAY);
             return ANJ_EXCHANGE_STATE_MSG_TO_SEND;
         }
@@ -714,15 +1299,24 @@ _anj_exchange_state_t _anj_exchange_process(_anj_exchange_ctx_t *ctx,
             return ctx->state;
         }
     }
+#ifdef ANJ_WITH_BLOCK2_PREFETCH
+    if (event == ANJ_EXCHANGE_EVENT_NONE) {
+        prefetch_next_block(ctx);
+    }
+#endif // ANJ_WITH_BLOCK2_PREFETCH
 
-    if (timeout_occurred(ctx->timeout_timestamp)) {
+    if (timeout_occurred(ctx, ctx->timeout_timestamp)) {
+#ifdef ANJ_WITH_ADAPTIVE_BLOCK_SIZE
+        block_size_on_timeout(ctx);
+#endif // ANJ_WITH_ADAPTIVE_BLOCK_SIZE
         if (ctx->server_request) {
             exchange_log(L_ERROR, "server request timeout occurred");
             return finalize_exchange(ctx, NULL, _ANJ_EXCHANGE_ERROR_TIMEOUT);
         } else {
             if (ctx->retry_count < ctx->tx_params.max_retransmit) {
                 ctx->retry_count++;
-                anj_time_monotonic_t time_real_now = anj_time_monotonic_now();
+                anj_time_monotonic_t time_real_now =
+                        _ANJ_STEP_TIME_NOW(ctx->step_time);
                 ctx->timeout_timestamp = anj_time_monotonic_add(
                         time_real_now,
                         anj_time_duration_mul(ctx->timeout,
@@ -732,6 +1326,7 @@ _anj_exchange_state_t _anj_exchange_process(_anj_exchange_ctx_t *ctx,
                                 time_real_now,
                                 _ANJ_EXCHANGE_COAP_PROCESSING_DELAY);
                 exchange_log(L_WARNING, "timeout occurred, retrying");
+                _ANJ_METRICS_INC(ctx->metrics, retransmissions);
                 ctx->state = ANJ_EXCHANGE_STATE_WAITING_SEND_CONFIRMATION;
                 *in_out_msg = ctx->base_msg;
                 return ANJ_EXCHANGE_STATE_MSG_TO_SEND;
@@ -745,6 +1340,23 @@ _anj_exchange_state_t _anj_exchange_process(_anj_exchange_ctx_t *ctx,
     return ANJ_EXCHANGE_STATE_WAITING_MSG;
 }
 
+_anj_exchange_state_t _anj_exchange_process(_anj_exchange_ctx_t *ctx,
+                                            _anj_exchange_event_t event,
+                                            _anj_coap_msg_t *in_out_msg) {
+#ifdef ANJ_WITH_TRACE
+    _anj_exchange_state_t prev_state = ctx->state;
+    _anj_exchange_state_t state = exchange_process(ctx, event, in_out_msg);
+    // completion is recorded by finalize_exchange()
+    if (ctx->state != prev_state
+            && ctx->state != ANJ_EXCHANGE_STATE_FINISHED) {
+        _ANJ_TRACE(ctx->trace, EXCHANGE, INSTANT, ctx->state);
+    }
+    return state;
+#else  // ANJ_WITH_TRACE
+    return exchange_process(ctx, event, in_out_msg);
+#endif // ANJ_WITH_TRACE
+}
+
 void _anj_exchange_terminate(_anj_exchange_ctx_t *ctx, int reason) {
     assert(ctx);
     assert(reason == _ANJ_EXCHANGE_ERROR_NETWORK
@@ -774,10 +1386,27 @@ _anj_exchange_state_t _anj_exchange_get_state(_anj_exchange_ctx_t *ctx) {
     return ctx->state;
 }
 
+#ifdef ANJ_WITH_PMTU_PROBING
+int _anj_exchange_get_last_result(_anj_exchange_ctx_t *ctx) {
+    assert(ctx);
+    return ctx->last_result;
+}
+#endif // ANJ_WITH_PMTU_PROBING
+
+#ifdef ANJ_NET_WITH_POLL_HANDLE
+anj_time_monotonic_t _anj_exchange_next_timeout(_anj_exchange_ctx_t *ctx) {
+    assert(ctx);
+    if (ctx->state != ANJ_EXCHANGE_STATE_WAITING_MSG) {
+        return ANJ_TIME_MONOTONIC_INVALID;
+    }
+    return ctx->timeout_timestamp;
+}
+#endif // ANJ_NET_WITH_POLL_HANDLE
+
 int _anj_exchange_set_udp_tx_params(
         _anj_exchange_ctx_t *ctx, const anj_exchange_udp_tx_params_t *params) {
     assert(ctx && params);
-    if (params->ack_random_factor < 1.0
+    if (params->ack_random_factor < ANJ_ACK_RANDOM_FACTOR(1.0)
             || anj_time_duration_lt(params->ack_timeout,
                                     anj_time_duration_new(1000,
                                                           ANJ_TIME_UNIT_MS))) {
@@ -785,6 +1414,15 @@ int _anj_exchange_set_udp_tx_params(
         return -1;
     }
     ctx->tx_params = *params;
+#ifdef ANJ_TIME_INTEGER_ONLY
+    exchange_log(L_DEBUG,
+                 "UDP TX params set: ack_timeout=%sms"
+                 ", ack_random_factor=%" PRIu32 "/%d, max_retransmit=%" PRIu16,
+                 ANJ_TIME_DURATION_AS_STRING(ctx->tx_params.ack_timeout,
+                                             ANJ_TIME_UNIT_MS),
+                 ctx->tx_params.ack_random_factor, ANJ_ACK_RANDOM_FACTOR_ONE,
+                 ctx->tx_params.max_retransmit);
+#else  // ANJ_TIME_INTEGER_ONLY
     exchange_log(L_DEBUG,
                  "UDP TX params set: ack_timeout=%sms"
                  ", ack_random_factor=%f, max_retransmit=%" PRIu16,
@@ -792,9 +1430,55 @@ int _anj_exchange_set_udp_tx_params(
                                              ANJ_TIME_UNIT_MS),
                  ctx->tx_params.ack_random_factor,
                  ctx->tx_params.max_retransmit);
+#endif // ANJ_TIME_INTEGER_ONLY
     return 0;
 }
 
+anj_time_duration_t
+_anj_exchange_mul_ack_random_factor(const anj_exchange_udp_tx_params_t *params,
+                                    anj_time_duration_t duration,
+                                    int32_t multiplier) {
+    assert(params);
+#ifdef ANJ_TIME_INTEGER_ONLY
+    return anj_time_duration_div(
+            anj_time_duration_mul(anj_time_duration_mul(duration, multiplier),
+                                  (int32_t) params->ack_random_factor),
+            ANJ_ACK_RANDOM_FACTOR_ONE);
+#else  // ANJ_TIME_INTEGER_ONLY
+    return anj_time_duration_fmul(duration, (double) multiplier
+                                                    * params->ack_random_factor);
+#endif // ANJ_TIME_INTEGER_ONLY
+}
+
+anj_time_duration_t
+_anj_exchange_initial_timeout(const anj_exchange_udp_tx_params_t *params,
+                              anj_time_duration_t ack_timeout,
+                              uint32_t random) {
+    assert(params);
+#ifdef ANJ_TIME_INTEGER_ONLY
+    if (!anj_time_duration_is_valid(ack_timeout)) {
+        return ANJ_TIME_DURATION_INVALID;
+    }
+    // span * random / 2^32, split so that the product doesn't overflow
+    uint64_t span = (uint64_t) anj_time_duration_div(
+                            anj_time_duration_mul(
+                                    ack_timeout,
+                                    (int32_t) (params->ack_random_factor
+                                               - ANJ_ACK_RANDOM_FACTOR_ONE)),
+                            ANJ_ACK_RANDOM_FACTOR_ONE)
+                            .us;
+    uint64_t extra = (span >> 32) * random
+                     + (((span & UINT32_MAX) * random) >> 32);
+    return anj_time_duration_add(
+            ack_timeout, anj_time_duration_new((int64_t) extra,
+                                               ANJ_TIME_UNIT_US));
+#else  // ANJ_TIME_INTEGER_ONLY
+    double random_factor = ((double) random / (double) UINT32_MAX)
+                           * (params->ack_random_factor - 1.0);
+    return anj_time_duration_fmul(ack_timeout, random_factor + 1.0);
+#endif // ANJ_TIME_INTEGER_ONLY
+}
+
 void _anj_exchange_set_server_request_timeout(
         _anj_exchange_ctx_t *ctx, anj_time_duration_t server_exchange_timeout) {
     assert(ctx);
@@ -812,6 +1496,9 @@ int _anj_exchange_init(_anj_exchange_ctx_t *ctx) {
     ctx->state = ANJ_EXCHANGE_STATE_FINISHED;
     ctx->tx_params = ANJ_EXCHANGE_UDP_TX_PARAMS_DEFAULT;
     ctx->server_exchange_timeout = ANJ_EXCHANGE_SERVER_REQUEST_TIMEOUT;
+#ifdef ANJ_WITH_ADAPTIVE_RTO
+    _anj_exchange_reset_rto(ctx);
+#endif // ANJ_WITH_ADAPTIVE_RTO
     if (anj_rng_generate((uint8_t *) &ctx->msg_id, sizeof(ctx->msg_id))) {
         exchange_log(L_ERROR, "Could not generate random number");
         return -1;
@@ -820,6 +1507,149 @@ int _anj_exchange_init(_anj_exchange_ctx_t *ctx) {
     return 0;
 }
 
+#ifdef ANJ_WITH_PIPELINED_NOTIFICATIONS
+bool _anj_exchange_pipelining_allowed(_anj_exchange_ctx_t *ctx) {
+    assert(ctx);
+    if (ctx->state != ANJ_EXCHANGE_STATE_WAITING_MSG) {
+        return false;
+    }
+#    ifdef ANJ_WITH_INTERLEAVED_NOTIFICATIONS
+    // waiting for the request for the next block of a Read response
+    if (ctx->server_request) {
+        return ctx->block_transfer
+               && (ctx->op == ANJ_OP_DM_READ || ctx->op == ANJ_OP_DM_READ_COMP);
+    }
+#    endif // ANJ_WITH_INTERLEAVED_NOTIFICATIONS
+    return !ctx->server_request && ctx->confirmable
+           && (ctx->base_msg.operation == ANJ_OP_UPDATE
+               || ctx->base_msg.operation == ANJ_OP_INF_CON_SEND);
+}
+
+_anj_exchange_state_t
+_anj_exchange_new_pipelined_request(_anj_exchange_ctx_t *ctx,
+                                    _anj_exchange_ctx_t *pipelined,
+                                    _anj_coap_msg_t *in_out_msg,
+                                    _anj_exchange_handlers_t *handlers,
+                                    uint8_t *buff,
+                                    size_t buff_len) {
+    assert(ctx && pipelined);
+    assert(ctx->state == ANJ_EXCHANGE_STATE_FINISHED
+           || _anj_exchange_pipelining_allowed(ctx));
+    assert(pipelined->state == ANJ_EXCHANGE_STATE_FINISHED);
+    assert(buff != ctx->payload_buff);
+    // copy transmission parameters, cache and Message ID counter
+    *pipelined = *ctx;
+    pipelined->state = ANJ_EXCHANGE_STATE_FINISHED;
+    pipelined->request_prepared = false;
+#    ifdef ANJ_WITH_SEPARATE_RESPONSE
+    // ctx might be a server request
+    pipelined->response_deferred = false;
+    pipelined->separate_response_sent = false;
+#    endif // ANJ_WITH_SEPARATE_RESPONSE
+#    ifdef ANJ_WITH_BLOCK2_PREFETCH
+    // the buffer is used by ctx
+    pipelined->prefetch_buff = NULL;
+    pipelined->prefetch_swapped = false;
+    pipelined->prefetched = false;
+#    endif // ANJ_WITH_BLOCK2_PREFETCH
+#    ifdef ANJ_WITH_TRACE
+    // would overlap with the events of ctx
+    pipelined->trace = NULL;
+#    endif // ANJ_WITH_TRACE
+    _anj_exchange_state_t state = _anj_exchange_new_client_request(
+            pipelined, in_out_msg, handlers, buff, buff_len);
+    ctx->msg_id = pipelined->msg_id;
+#    ifdef ANJ_WITH_COUNTER_TOKENS
+    ctx->token_key = pipelined->token_key;
+    ctx->token_counter = pipelined->token_counter;
+#    endif // ANJ_WITH_COUNTER_TOKENS
+    return state;
+}
+
+bool _anj_exchange_pipelined_request_deferred(_anj_exchange_ctx_t *pipelined) {
+    assert(pipelined);
+    return pipelined->state != ANJ_EXCHANGE_STATE_FINISHED
+           && pipelined->block_transfer;
+}
+
+bool _anj_exchange_acknowledged_by(const _anj_exchange_ctx_t *pipelined,
+                                   const _anj_coap_msg_t *msg) {
+    assert(pipelined && msg);
+    return pipelined->state == ANJ_EXCHANGE_STATE_WAITING_MSG
+           && !pipelined->server_request && pipelined->confirmable
+           && (msg->operation == ANJ_OP_COAP_EMPTY_MSG
+               || msg->operation == ANJ_OP_COAP_RESET)
+           && msg->coap_binding_data.message_id
+                      == pipelined->base_msg.coap_binding_data.message_id;
+}
+
+void _anj_exchange_set_completion(_anj_exchange_ctx_t *ctx,
+                                  _anj_exchange_completion_t *completion,
+                                  void *arg) {
+    assert(ctx && completion);
+    assert(ctx->state != ANJ_EXCHANGE_STATE_FINISHED && !ctx->block_transfer);
+    // the whole payload is already read
+    ctx->handlers.read_payload = default_read_payload_handler;
+    ctx->handlers.completion = completion;
+    ctx->handlers.arg = arg;
+}
+
+int _anj_exchange_take_over(_anj_exchange_ctx_t *ctx,
+                            _anj_exchange_ctx_t *pipelined) {
+    assert(ctx && pipelined);
+    assert(ctx->state == ANJ_EXCHANGE_STATE_FINISHED);
+    assert(_anj_exchange_pipelined_request_deferred(pipelined));
+    // ctx might have used more Message IDs in the meantime
+    uint16_t msg_id = ctx->msg_id;
+#    ifdef ANJ_WITH_COUNTER_TOKENS
+    uint64_t token_key = ctx->token_key;
+    uint32_t token_counter = ctx->token_counter;
+#    endif // ANJ_WITH_COUNTER_TOKENS
+#    ifdef ANJ_WITH_ADAPTIVE_BLOCK_SIZE
+    uint16_t block_size_limit = ctx->block_size_limit;
+    uint8_t block_size_successes = ctx->block_size_successes;
+#    endif // ANJ_WITH_ADAPTIVE_BLOCK_SIZE
+#    ifdef ANJ_WITH_ADAPTIVE_RTO
+    _anj_exchange_rto_t rto = ctx->rto;
+#    endif // ANJ_WITH_ADAPTIVE_RTO
+#    ifdef ANJ_WITH_TRACE
+    _anj_trace_t *trace = ctx->trace;
+#    endif // ANJ_WITH_TRACE
+#    ifdef ANJ_WITH_BLOCK2_PREFETCH
+    // finished exchange has the buffers swapped back already
+    assert(!ctx->prefetch_swapped);
+    uint8_t *prefetch_buff = ctx->prefetch_buff;
+#    endif // ANJ_WITH_BLOCK2_PREFETCH
+    *ctx = *pipelined;
+    ctx->msg_id = msg_id;
+#    ifdef ANJ_WITH_COUNTER_TOKENS
+    ctx->token_key = token_key;
+    ctx->token_counter = token_counter;
+#    endif // ANJ_WITH_COUNTER_TOKENS
+#    ifdef ANJ_WITH_ADAPTIVE_BLOCK_SIZE
+    ctx->block_size_limit = block_size_limit;
+    ctx->block_size_successes = block_size_successes;
+#    endif // ANJ_WITH_ADAPTIVE_BLOCK_SIZE
+#    ifdef ANJ_WITH_ADAPTIVE_RTO
+    ctx->rto = rto;
+#    endif // ANJ_WITH_ADAPTIVE_RTO
+#    ifdef ANJ_WITH_TRACE
+    ctx->trace = trace;
+    _ANJ_TRACE(ctx->trace, EXCHANGE, BEGIN, ctx->base_msg.operation);
+#    endif // ANJ_WITH_TRACE
+#    ifdef ANJ_WITH_BLOCK2_PREFETCH
+    ctx->prefetch_buff = prefetch_buff;
+#    endif // ANJ_WITH_BLOCK2_PREFETCH
+    pipelined->state = ANJ_EXCHANGE_STATE_FINISHED;
+    if (exchange_param_init(ctx)) {
+        finalize_exchange(ctx, NULL, _ANJ_EXCHANGE_ERROR_REQUEST);
+        return -1;
+    }
+    exchange_log(L_TRACE, "pipelined request taken over");
+    return 0;
+}
+#endif // ANJ_WITH_PIPELINED_NOTIFICATIONS
+
 #ifdef ANJ_WITH_CACHE
 void _anj_exchange_setup_cache(_anj_exchange_ctx_t *ctx,
                                _anj_exchange_cache_t *cache) {
@@ -830,11 +1660,64 @@ void _anj_exchange_setup_cache(_anj_exchange_ctx_t *ctx,
     // time
     ctx->cache->cache_recent.expiration_time = ANJ_TIME_MONOTONIC_INVALID;
     ctx->cache->handling_retransmission = false;
+#    ifdef ANJ_WITH_ENCODED_RETRANSMISSIONS
+    ctx->cache->datagram_pending = false;
+#    endif // ANJ_WITH_ENCODED_RETRANSMISSIONS
 #    if ANJ_CACHE_ENTRIES_NUMBER > 1
     for (uint8_t i = 0; i < ANJ_ARRAY_SIZE(ctx->cache->cache_non_recent); i++) {
         ctx->cache->cache_non_recent[i].expiration_time =
                 ANJ_TIME_MONOTONIC_INVALID;
     }
 #    endif // ANJ_CACHE_ENTRIES_NUMBER > 1
+#    ifdef ANJ_CACHE_WITH_FULL_ENTRIES
+    _anj_exchange_cache_init_full_entries(ctx->cache);
+#    endif // ANJ_CACHE_WITH_FULL_ENTRIES
 }
 #endif // ANJ_WITH_CACHE
+
+#ifdef ANJ_WITH_BLOCK2_PREFETCH
+void _anj_exchange_setup_prefetch_buffer(_anj_exchange_ctx_t *ctx,
+                                         uint8_t *buff,
+                                         size_t buff_len) {
+    assert(ctx && buff);
+    ctx->prefetch_buff = buff;
+    ctx->prefetch_buff_len = buff_len;
+    ctx->prefetch_swapped = false;
+}
+#endif // ANJ_WITH_BLOCK2_PREFETCH
+
+void _anj_exchange_setup_token_check(_anj_exchange_ctx_t *ctx,
+                                     _anj_exchange_token_in_use_t *token_in_use,
+                                     void *arg) {
+    assert(ctx && token_in_use);
+    ctx->token_in_use = token_in_use;
+    ctx->token_in_use_arg = arg;
+}
+
+#ifdef ANJ_WITH_METRICS
+void _anj_exchange_setup_metrics(_anj_exchange_ctx_t *ctx,
+                                 anj_metrics_t *metrics) {
+    assert(ctx && metrics);
+    ctx->metrics = metrics;
+}
+#endif // ANJ_WITH_METRICS
+
+#ifdef ANJ_WITH_TRACE
+void _anj_exchange_setup_trace(_anj_exchange_ctx_t *ctx, _anj_trace_t *trace) {
+    assert(ctx && trace);
+    ctx->trace = trace;
+}
+#endif // ANJ_WITH_TRACE
+
+#ifdef ANJ_WITH_STEP_TIME_CACHE
+void _anj_exchange_setup_step_time(_anj_exchange_ctx_t *ctx,
+                                   const _anj_step_time_t *step_time) {
+    assert(ctx && step_time);
+    ctx->step_time = step_time;
+#    ifdef ANJ_WITH_CACHE
+    if (ctx->cache) {
+        ctx->cache->step_time = step_time;
+    }
+#    endif // ANJ_WITH_CACHE
+}
+#endif // ANJ_WITH_STEP_TIME_CACHE
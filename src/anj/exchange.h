@@ -224,6 +224,19 @@ bool _anj_exchange_ongoing_exchange(_anj_exchange_ctx_t *ctx);
  */
 _anj_exchange_state_t _anj_exchange_get_state(_anj_exchange_ctx_t *ctx);
 
+#    ifdef ANJ_WITH_PMTU_PROBING
+/**
+ * Gets the result of the last finished exchange, as passed to its completion
+ * handler.
+ *
+ * @param ctx  Exchange context.
+ *
+ * @returns @ref _ANJ_EXCHANGE_RESULT_SUCCESS or one of the
+ *          _ANJ_EXCHANGE_ERROR_* codes.
+ */
+int _anj_exchange_get_last_result(_anj_exchange_ctx_t *ctx);
+#    endif // ANJ_WITH_PMTU_PROBING
+
 /**
  * Sets the CoAP transmission parameters for given context. If never called, the
  * default values will be used (RFC 7252).
@@ -236,6 +249,31 @@ _anj_exchange_state_t _anj_exchange_get_state(_anj_exchange_ctx_t *ctx);
 int _anj_exchange_set_udp_tx_params(_anj_exchange_ctx_t *ctx,
                                     const anj_exchange_udp_tx_params_t *params);
 
+/**
+ * Returns @p duration multiplied by @p multiplier and ACK_RANDOM_FACTOR of
+ * @p params. With @ref ANJ_TIME_INTEGER_ONLY, no floating-point operations are
+ * involved.
+ */
+anj_time_duration_t
+_anj_exchange_mul_ack_random_factor(const anj_exchange_udp_tx_params_t *params,
+                                    anj_time_duration_t duration,
+                                    int32_t multiplier);
+
+/**
+ * Returns the initial timeout of a confirmable message, which according to
+ * RFC 7252 is "a random number between ACK_TIMEOUT and
+ * (ACK_TIMEOUT * ACK_RANDOM_FACTOR)".
+ *
+ * @param params      CoAP transmission parameters.
+ * @param ack_timeout ACK_TIMEOUT, which may differ from the one in @p params
+ *                    if it is estimated from round-trip times.
+ * @param random      Random number, uniformly distributed.
+ */
+anj_time_duration_t
+_anj_exchange_initial_timeout(const anj_exchange_udp_tx_params_t *params,
+                              anj_time_duration_t ack_timeout,
+                              uint32_t random);
+
 /**
  * Sets the maximum time of the CoAP exchange - this is the time to wait for the
  * next block of the LwM2M Server request. The default value is @ref
@@ -258,9 +296,234 @@ void _anj_exchange_set_server_request_timeout(
  */
 int _anj_exchange_init(_anj_exchange_ctx_t *ctx);
 
+#    ifdef ANJ_NET_WITH_POLL_HANDLE
+/**
+ * Returns the time at which the exchange times out or the message is
+ * retransmitted, unless a message is received earlier. Until then calling
+ * @ref _anj_exchange_process with @ref ANJ_EXCHANGE_EVENT_NONE has no effect.
+ *
+ * @param ctx Exchange context
+ *
+ * @returns Time of the next timeout, or @ref ANJ_TIME_MONOTONIC_INVALID if the
+ *          exchange is not in @ref ANJ_EXCHANGE_STATE_WAITING_MSG state.
+ */
+anj_time_monotonic_t _anj_exchange_next_timeout(_anj_exchange_ctx_t *ctx);
+#    endif // ANJ_NET_WITH_POLL_HANDLE
+
+#    ifdef ANJ_WITH_ADAPTIVE_BLOCK_SIZE
+/**
+ * Forgets the block size limit learned from the previous exchanges. Should be
+ * called after a new connection with the LwM2M Server is set up, since the
+ * limit depends on the network path.
+ *
+ * @param ctx Exchange context
+ */
+void _anj_exchange_reset_block_size_limit(_anj_exchange_ctx_t *ctx);
+#    endif // ANJ_WITH_ADAPTIVE_BLOCK_SIZE
+
+#    ifdef ANJ_WITH_ADAPTIVE_RTO
+/**
+ * Forgets the retransmission timeout estimated from the previous exchanges, so
+ * that ACK_TIMEOUT is used until new round-trip times are measured. Should be
+ * called after a new connection with the LwM2M Server is set up.
+ *
+ * @param ctx Exchange context
+ */
+void _anj_exchange_reset_rto(_anj_exchange_ctx_t *ctx);
+
+/**
+ * Returns the smoothed round-trip time of the exchanges answered without a
+ * retransmission, or @ref ANJ_TIME_DURATION_INVALID if none was measured since
+ * the last @ref _anj_exchange_reset_rto.
+ *
+ * @param ctx Exchange context
+ */
+anj_time_duration_t _anj_exchange_srtt(const _anj_exchange_ctx_t *ctx);
+#    endif // ANJ_WITH_ADAPTIVE_RTO
+
+#    ifdef ANJ_WITH_COUNTER_TOKENS
+/**
+ * Makes the key from which tokens are derived to be generated again before the
+ * next token is created. Should be called after a new connection with the
+ * LwM2M Server is set up.
+ *
+ * @param ctx Exchange context
+ */
+void _anj_exchange_reseed_tokens(_anj_exchange_ctx_t *ctx);
+#    endif // ANJ_WITH_COUNTER_TOKENS
+
+#    ifdef ANJ_WITH_PIPELINED_NOTIFICATIONS
+/**
+ * Checks if @p ctx waits for the response to a confirmable Update or Send
+ * request, so that a notification can be prepared in another exchange context
+ * in the meantime. It's also possible if @p ctx has no ongoing exchange. With @ref ANJ_WITH_INTERLEAVED_NOTIFICATIONS, it is also the
+ * case if @p ctx waits for the request for the next block of a Read or
+ * Read-Composite response.
+ *
+ * @param ctx Exchange context
+ *
+ * @returns True if @ref _anj_exchange_new_pipelined_request can be called while
+ *          @p ctx is in use.
+ */
+bool _anj_exchange_pipelining_allowed(_anj_exchange_ctx_t *ctx);
+
+/**
+ * Creates a new LwM2M Client request in @p pipelined context, next to the
+ * exchange in @p ctx. @p pipelined is set up with the same parameters as
+ * @p ctx, and both contexts share the Message ID counter.
+ *
+ * If the request is a single message, it can be sent right away and finished
+ * as usual, the response is recognized with
+ * @ref _anj_exchange_acknowledged_by. Otherwise, it has to wait until @p ctx
+ * has no ongoing exchange, see @ref _anj_exchange_take_over.
+ *
+ * @param ctx        Context of the ongoing exchange, or of the finished one.
+ * @param pipelined  Context for the new request, must not be in use.
+ * @param in_out_msg Same as for @ref _anj_exchange_new_client_request.
+ * @param handlers   Same as for @ref _anj_exchange_new_client_request.
+ * @param buff       Payload buffer, different than the one used by @p ctx.
+ * @param buff_len   Payload buffer length.
+ *
+ * @returns Same as @ref _anj_exchange_new_client_request.
+ */
+_anj_exchange_state_t
+_anj_exchange_new_pipelined_request(_anj_exchange_ctx_t *ctx,
+                                    _anj_exchange_ctx_t *pipelined,
+                                    _anj_coap_msg_t *in_out_msg,
+                                    _anj_exchange_handlers_t *handlers,
+                                    uint8_t *buff,
+                                    size_t buff_len);
+
+/**
+ * Checks if the request created with @ref _anj_exchange_new_pipelined_request
+ * has to wait until the exchange it was created alongside is finished.
+ *
+ * @param pipelined Context of the pipelined request.
+ *
+ * @returns True if the request needs a block-wise transfer.
+ */
+bool _anj_exchange_pipelined_request_deferred(_anj_exchange_ctx_t *pipelined);
+
+/**
+ * Checks if @p msg is the empty ACK or the Reset message in response to the
+ * Confirmable request sent in @p pipelined context. Incoming messages are
+ * processed by the main exchange context, this one is recognized by its
+ * Message ID and has to be passed to @p pipelined instead.
+ *
+ * @param pipelined Context of the pipelined request.
+ * @param msg       Incoming message.
+ *
+ * @returns True if @p msg has to be processed in @p pipelined context.
+ */
+bool _anj_exchange_acknowledged_by(const _anj_exchange_ctx_t *pipelined,
+                                   const _anj_coap_msg_t *msg);
+
+/**
+ * Replaces the completion handler of the request in @p ctx, which has been
+ * prepared in a single message. Used when the module that prepared the request
+ * no longer keeps its state until the response arrives.
+ *
+ * @param ctx        Exchange context with the ongoing exchange.
+ * @param completion New completion handler.
+ * @param arg        Argument passed to @p completion.
+ */
+void _anj_exchange_set_completion(_anj_exchange_ctx_t *ctx,
+                                  _anj_exchange_completion_t *completion,
+                                  void *arg);
+
+/**
+ * Moves the deferred request from @p pipelined to @p ctx, which must not have
+ * an ongoing exchange. Transmission timeouts are calculated again, as if the
+ * request was created now. Afterwards, @p pipelined can be used again.
+ *
+ * @param ctx       Exchange context to continue the exchange in.
+ * @param pipelined Context of the pipelined request.
+ *
+ * @returns 0 on success, negative value if the exchange has been finished with
+ *          an error.
+ */
+int _anj_exchange_take_over(_anj_exchange_ctx_t *ctx,
+                            _anj_exchange_ctx_t *pipelined);
+#    endif // ANJ_WITH_PIPELINED_NOTIFICATIONS
+
 #    ifdef ANJ_WITH_CACHE
 void _anj_exchange_setup_cache(_anj_exchange_ctx_t *ctx,
                                _anj_exchange_cache_t *cache);
 #    endif // ANJ_WITH_CACHE
 
+/**
+ * Makes the exchange check every new token of a client request with
+ * @p token_in_use, and generate another one if it's already in use. Must be
+ * called after context initialization; contexts of pipelined requests inherit
+ * the setting.
+ *
+ * @param ctx          Exchange context.
+ * @param token_in_use Function checking the token.
+ * @param arg          Argument passed to @p token_in_use.
+ */
+void _anj_exchange_setup_token_check(_anj_exchange_ctx_t *ctx,
+                                     _anj_exchange_token_in_use_t *token_in_use,
+                                     void *arg);
+
+#    ifdef ANJ_WITH_METRICS
+/**
+ * Makes the exchange update @p metrics: retransmissions, blocks of Block-Wise
+ * transfers and durations of successful exchanges are counted. Must be called
+ * after context initialization; contexts of pipelined requests inherit the
+ * setting.
+ *
+ * @param ctx     Exchange context.
+ * @param metrics Metrics to update.
+ */
+void _anj_exchange_setup_metrics(_anj_exchange_ctx_t *ctx,
+                                 anj_metrics_t *metrics);
+#    endif // ANJ_WITH_METRICS
+
+#    ifdef ANJ_WITH_TRACE
+/**
+ * Makes the exchange record its start, state changes and completion in
+ * @p trace. Must be called after context initialization; requests pipelined
+ * from the context are recorded only once taken over by it.
+ *
+ * @param ctx   Exchange context.
+ * @param trace Ring buffer to record the events in.
+ */
+void _anj_exchange_setup_trace(_anj_exchange_ctx_t *ctx, _anj_trace_t *trace);
+#    endif // ANJ_WITH_TRACE
+
+#    ifdef ANJ_WITH_STEP_TIME_CACHE
+/**
+ * Makes the exchange, and its cache if already set up, use the time cached in
+ * @p step_time instead of reading the clock whenever it is valid. Must be
+ * called after @ref _anj_exchange_setup_cache; contexts of pipelined requests
+ * inherit the setting.
+ *
+ * @param ctx       Exchange context.
+ * @param step_time Time cached by @ref anj_core_step.
+ */
+void _anj_exchange_setup_step_time(_anj_exchange_ctx_t *ctx,
+                                   const _anj_step_time_t *step_time);
+#    endif // ANJ_WITH_STEP_TIME_CACHE
+
+#    ifdef ANJ_WITH_BLOCK2_PREFETCH
+/**
+ * Makes the exchange prepare the next block of a Block-Wise response to a
+ * LwM2M Server request in @p buff, while it waits for the request for that
+ * block. The read_payload handler is then called from
+ * @ref _anj_exchange_process with @ref ANJ_EXCHANGE_EVENT_NONE, and the
+ * request is answered without calling it.
+ *
+ * Must be called after context initialization; contexts of pipelined requests
+ * don't prefetch blocks until taken over.
+ *
+ * @param ctx      Exchange context.
+ * @param buff     Buffer for the prefetched block, different than the payload
+ *                 buffers given for new exchanges.
+ * @param buff_len Buffer length, blocks bigger than that are not prefetched.
+ */
+void _anj_exchange_setup_prefetch_buffer(_anj_exchange_ctx_t *ctx,
+                                         uint8_t *buff,
+                                         size_t buff_len);
+#    endif // ANJ_WITH_BLOCK2_PREFETCH
+
 #endif // SRC_ANJ_EXCHANGE_H
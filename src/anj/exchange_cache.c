@@ -24,9 +24,18 @@
 
 #include "exchange.h"
 #include "exchange_cache.h"
+#include "utils.h"
 
 #ifdef ANJ_WITH_CACHE
 
+#    ifdef ANJ_CACHE_WITH_FULL_ENTRIES
+#        if ANJ_CACHE_ENTRIES_NUMBER > UINT8_MAX
+#            error "ANJ_CACHE_ENTRIES_NUMBER is too big for the Message ID index"
+#        endif // ANJ_CACHE_ENTRIES_NUMBER > UINT8_MAX
+
+#        define NO_ENTRY UINT8_MAX
+#    endif // ANJ_CACHE_WITH_FULL_ENTRIES
+
 /**
  * Calculates CoAP EXCHANGE_LIFETIME in milliseconds based on transmission
  * parameters stored in @p ctx.
@@ -43,12 +52,10 @@
  */
 static anj_time_duration_t
 get_exchange_lifetime(const anj_exchange_udp_tx_params_t *tx_params) {
-    double ack_random_factor = tx_params->ack_random_factor;
     uint16_t max_retransmit = tx_params->max_retransmit;
     anj_time_duration_t ack_timeout = tx_params->ack_timeout;
-    anj_time_duration_t max_transmit_span = anj_time_duration_fmul(
-            ack_timeout,
-            ((double) ((1 << max_retransmit) - 1)) * ack_random_factor);
+    anj_time_duration_t max_transmit_span = _anj_exchange_mul_ack_random_factor(
+            tx_params, ack_timeout, (1 << max_retransmit) - 1);
 
     anj_time_duration_t exchange_lifetime = max_transmit_span;
     exchange_lifetime = anj_time_duration_add(
@@ -86,18 +93,164 @@ static void drop_expired(_anj_exchange_cache_t *ctx,
 #    endif // ANJ_CACHE_ENTRIES_NUMBER > 1
 }
 
+#    ifdef ANJ_CACHE_WITH_FULL_ENTRIES
+static uint8_t *mid_index_bucket(_anj_exchange_cache_t *ctx, uint16_t mid) {
+    return &ctx->mid_index[mid % ANJ_ARRAY_SIZE(ctx->mid_index)];
+}
+
+static void mid_index_remove(_anj_exchange_cache_t *ctx, uint8_t id) {
+    uint8_t *link = mid_index_bucket(ctx, ctx->cache_non_recent[id].mid);
+    while (*link != id) {
+        assert(*link != NO_ENTRY);
+        link = &ctx->cache_non_recent[*link].next_id;
+    }
+    *link = ctx->cache_non_recent[id].next_id;
+}
+
+static void mid_index_insert(_anj_exchange_cache_t *ctx, uint8_t id) {
+    uint8_t *bucket = mid_index_bucket(ctx, ctx->cache_non_recent[id].mid);
+    ctx->cache_non_recent[id].next_id = *bucket;
+    *bucket = id;
+}
+
+static void release_full_entry(_anj_exchange_cache_t *ctx, uint8_t id) {
+    uint8_t full_id = ctx->cache_non_recent[id].full_entry_id;
+    if (full_id != NO_ENTRY) {
+        ctx->full_entries[full_id].non_recent_id = NO_ENTRY;
+        ctx->cache_non_recent[id].full_entry_id = NO_ENTRY;
+    }
+}
+
+/**
+ * Picks a slot for the response that is no longer the most recent one: a free
+ * one if possible, otherwise the one of the entry that expires first.
+ */
+static uint8_t find_full_entry_slot(_anj_exchange_cache_t *ctx) {
+    uint8_t candidate_id = 0;
+    anj_time_monotonic_t oldest_cache_time = ANJ_TIME_MONOTONIC_INVALID;
+    for (uint8_t i = 0; i < ANJ_ARRAY_SIZE(ctx->full_entries); i++) {
+        uint8_t non_recent_id = ctx->full_entries[i].non_recent_id;
+        if (non_recent_id == NO_ENTRY) {
+            return i;
+        }
+        anj_time_monotonic_t expiration_time =
+                ctx->cache_non_recent[non_recent_id].expiration_time;
+        if (!anj_time_monotonic_gt(expiration_time, oldest_cache_time)) {
+            oldest_cache_time = expiration_time;
+            candidate_id = i;
+        }
+    }
+    return candidate_id;
+}
+
+/**
+ * Keeps the response from cache_recent, that has just been moved to
+ * cache_non_recent[@p non_recent_id], with its payload.
+ */
+static void save_full_entry(_anj_exchange_cache_t *ctx, uint8_t non_recent_id) {
+    const _anj_coap_msg_t *response = &ctx->cache_recent.response;
+    size_t payload_size = response->payload ? response->payload_size : 0;
+    if (payload_size > sizeof(ctx->payload_arena)) {
+        exchange_log(L_TRACE, "Payload too big to be kept in cache");
+        return;
+    }
+
+    if (ctx->payload_arena_offset + payload_size
+            > sizeof(ctx->payload_arena)) {
+        ctx->payload_arena_offset = 0;
+    }
+    size_t payload_end = ctx->payload_arena_offset + payload_size;
+    // drop payloads that will be overwritten
+    for (uint8_t i = 0; i < ANJ_ARRAY_SIZE(ctx->full_entries); i++) {
+        _anj_exchange_cache_msg_full_t *entry = &ctx->full_entries[i];
+        if (entry->non_recent_id != NO_ENTRY
+                && entry->payload_offset < payload_end
+                && ctx->payload_arena_offset
+                           < entry->payload_offset
+                                     + entry->response.payload_size) {
+            exchange_log(L_TRACE, "Dropped payload of cache n=%d",
+                         entry->non_recent_id);
+            release_full_entry(ctx, entry->non_recent_id);
+        }
+    }
+
+    uint8_t full_id = find_full_entry_slot(ctx);
+    _anj_exchange_cache_msg_full_t *entry = &ctx->full_entries[full_id];
+    if (entry->non_recent_id != NO_ENTRY) {
+        release_full_entry(ctx, entry->non_recent_id);
+    }
+    entry->response = *response;
+    entry->response.payload_size = payload_size;
+    entry->payload_offset = ctx->payload_arena_offset;
+    entry->non_recent_id = non_recent_id;
+    if (payload_size) {
+        memcpy(&ctx->payload_arena[entry->payload_offset],
+               ctx->cache_recent.payload, payload_size);
+    }
+    ctx->payload_arena_offset = payload_end;
+    ctx->cache_non_recent[non_recent_id].full_entry_id = full_id;
+    exchange_log(L_TRACE, "Kept payload of cache n=%d", non_recent_id);
+}
+
+void _anj_exchange_cache_init_full_entries(_anj_exchange_cache_t *ctx) {
+    // every entry always belongs to a bucket, even if it's invalid
+    memset(ctx->mid_index, NO_ENTRY, sizeof(ctx->mid_index));
+    for (uint8_t i = 0; i < ANJ_ARRAY_SIZE(ctx->cache_non_recent); i++) {
+        ctx->cache_non_recent[i].mid = 0;
+        ctx->cache_non_recent[i].full_entry_id = NO_ENTRY;
+        mid_index_insert(ctx, i);
+    }
+    for (uint8_t i = 0; i < ANJ_ARRAY_SIZE(ctx->full_entries); i++) {
+        ctx->full_entries[i].non_recent_id = NO_ENTRY;
+    }
+    ctx->payload_arena_offset = 0;
+    ctx->retransmitted_full_id = NO_ENTRY;
+}
+#    endif // ANJ_CACHE_WITH_FULL_ENTRIES
+
+static uint16_t recent_mid(const _anj_exchange_cache_t *ctx) {
+#    ifdef ANJ_WITH_ENCODED_RETRANSMISSIONS
+    return ctx->cache_recent.mid;
+#    else  // ANJ_WITH_ENCODED_RETRANSMISSIONS
+    return ctx->cache_recent.response.coap_binding_data.message_id;
+#    endif // ANJ_WITH_ENCODED_RETRANSMISSIONS
+}
+
 static void save_recent_cache(_anj_exchange_cache_t *ctx,
                               const _anj_coap_msg_t *response,
                               anj_time_monotonic_t expiration_time) {
+#    ifdef ANJ_WITH_ENCODED_RETRANSMISSIONS
+    // datagram is stored after the response is encoded
+    ctx->cache_recent.mid = response->coap_binding_data.message_id;
+    ctx->cache_recent.datagram_len = 0;
+    ctx->datagram_pending = true;
+#    else  // ANJ_WITH_ENCODED_RETRANSMISSIONS
     memcpy(&ctx->cache_recent.response, response, sizeof(*response));
     if (response->payload && response->payload_size) {
-        memcpy(&ctx->cache_recent.payload,
+        memcpy(ctx->cache_recent.payload,
                response->payload,
                response->payload_size);
     }
+#    endif // ANJ_WITH_ENCODED_RETRANSMISSIONS
     ctx->cache_recent.expiration_time = expiration_time;
 }
 
+#    ifdef ANJ_WITH_RESOURCE_USAGE
+// called right after cache_recent is saved
+static void update_used_entries_max(_anj_exchange_cache_t *ctx) {
+    size_t used = 1;
+#        if ANJ_CACHE_ENTRIES_NUMBER > 1
+    for (uint8_t i = 0; i < ANJ_ARRAY_SIZE(ctx->cache_non_recent); i++) {
+        if (anj_time_monotonic_is_valid(
+                    ctx->cache_non_recent[i].expiration_time)) {
+            used++;
+        }
+    }
+#        endif // ANJ_CACHE_ENTRIES_NUMBER > 1
+    ctx->used_entries_max = ANJ_MAX(ctx->used_entries_max, used);
+}
+#    endif // ANJ_WITH_RESOURCE_USAGE
+
 void _anj_exchange_cache_add(_anj_exchange_cache_t *ctx,
                              const anj_exchange_udp_tx_params_t *tx_params,
                              const _anj_coap_msg_t *response) {
@@ -107,7 +260,7 @@ void _anj_exchange_cache_add(_anj_exchange_cache_t *ctx,
     }
 
     // calculate the expiration time for currently processed entry
-    anj_time_monotonic_t time_now = anj_time_monotonic_now();
+    anj_time_monotonic_t time_now = _ANJ_STEP_TIME_NOW(ctx->step_time);
     anj_time_monotonic_t expiration_time =
             anj_time_monotonic_add(time_now, get_exchange_lifetime(tx_params));
 
@@ -118,6 +271,9 @@ void _anj_exchange_cache_add(_anj_exchange_cache_t *ctx,
     // check if the recent cache expired. If it did, the non-recent ones did too
     if (!anj_time_monotonic_is_valid(ctx->cache_recent.expiration_time)) {
         save_recent_cache(ctx, response, expiration_time);
+#        ifdef ANJ_WITH_RESOURCE_USAGE
+        update_used_entries_max(ctx);
+#        endif // ANJ_WITH_RESOURCE_USAGE
         exchange_log(L_TRACE, "Saved latest cache");
         return;
     }
@@ -143,33 +299,64 @@ void _anj_exchange_cache_add(_anj_exchange_cache_t *ctx,
     }
 
     // move the most recent cache to the non-recent array
-    ctx->cache_non_recent[candidate_id].mid =
-            ctx->cache_recent.response.coap_binding_data.message_id;
+#        ifdef ANJ_CACHE_WITH_FULL_ENTRIES
+    release_full_entry(ctx, candidate_id);
+    mid_index_remove(ctx, candidate_id);
+#        endif // ANJ_CACHE_WITH_FULL_ENTRIES
+    ctx->cache_non_recent[candidate_id].mid = recent_mid(ctx);
     ctx->cache_non_recent[candidate_id].expiration_time =
             ctx->cache_recent.expiration_time;
+#        ifdef ANJ_CACHE_WITH_FULL_ENTRIES
+    mid_index_insert(ctx, candidate_id);
+    save_full_entry(ctx, candidate_id);
+#        endif // ANJ_CACHE_WITH_FULL_ENTRIES
 
 #    endif // ANJ_CACHE_ENTRIES_NUMBER > 1
 
     // update most recent cache
     save_recent_cache(ctx, response, expiration_time);
+#    ifdef ANJ_WITH_RESOURCE_USAGE
+    update_used_entries_max(ctx);
+#    endif // ANJ_WITH_RESOURCE_USAGE
     exchange_log(L_TRACE, "Saved cache");
 }
 
 int _anj_exchange_cache_check(_anj_exchange_cache_t *ctx, uint16_t msg_id) {
     // free slots with expired entries
-    anj_time_monotonic_t time_now = anj_time_monotonic_now();
+    anj_time_monotonic_t time_now = _ANJ_STEP_TIME_NOW(ctx->step_time);
     drop_expired(ctx, time_now);
     exchange_log(L_TRACE, "Checking cache");
 
     // check if it's the most recent message
-    if (ctx->cache_recent.response.coap_binding_data.message_id == msg_id
+    if (recent_mid(ctx) == msg_id
             && anj_time_monotonic_is_valid(ctx->cache_recent.expiration_time)) {
         ctx->handling_retransmission = true;
+#    ifdef ANJ_CACHE_WITH_FULL_ENTRIES
+        ctx->retransmitted_full_id = NO_ENTRY;
+#    endif // ANJ_CACHE_WITH_FULL_ENTRIES
         exchange_log(L_TRACE, "Found most recent");
         return _ANJ_EXCHANGE_CACHE_HIT_RECENT;
     }
 
-#    if ANJ_CACHE_ENTRIES_NUMBER > 1
+#    ifdef ANJ_CACHE_WITH_FULL_ENTRIES
+    // if not, check the older ones with the same hash
+    for (uint8_t i = *mid_index_bucket(ctx, msg_id); i != NO_ENTRY;
+         i = ctx->cache_non_recent[i].next_id) {
+        if (ctx->cache_non_recent[i].mid != msg_id
+                || !anj_time_monotonic_is_valid(
+                           ctx->cache_non_recent[i].expiration_time)) {
+            continue;
+        }
+        if (ctx->cache_non_recent[i].full_entry_id != NO_ENTRY) {
+            ctx->handling_retransmission = true;
+            ctx->retransmitted_full_id = ctx->cache_non_recent[i].full_entry_id;
+            exchange_log(L_TRACE, "Found non recent with payload");
+            return _ANJ_EXCHANGE_CACHE_HIT_RECENT;
+        }
+        exchange_log(L_TRACE, "Found non recent");
+        return _ANJ_EXCHANGE_CACHE_HIT_NON_RECENT;
+    }
+#    elif ANJ_CACHE_ENTRIES_NUMBER > 1
     // if not, check the older ones
     for (uint8_t i = 0; i < ANJ_ARRAY_SIZE(ctx->cache_non_recent); i++) {
         if (ctx->cache_non_recent[i].mid == msg_id
@@ -179,17 +366,59 @@ int _anj_exchange_cache_check(_anj_exchange_cache_t *ctx, uint16_t msg_id) {
             return _ANJ_EXCHANGE_CACHE_HIT_NON_RECENT;
         }
     }
-#    endif // ANJ_CACHE_ENTRIES_NUMBER > 1
+#    endif // ANJ_CACHE_WITH_FULL_ENTRIES
 
     return _ANJ_EXCHANGE_CACHE_MISS;
 }
 
+#    ifdef ANJ_WITH_ENCODED_RETRANSMISSIONS
+void _anj_exchange_cache_set_datagram(_anj_exchange_cache_t *ctx,
+                                      const uint8_t *header,
+                                      size_t header_len,
+                                      const uint8_t *payload,
+                                      size_t payload_len) {
+    if (!ctx->datagram_pending) {
+        return;
+    }
+    ctx->datagram_pending = false;
+    if (!header
+            || header_len + payload_len > sizeof(ctx->cache_recent.datagram)) {
+        exchange_log(L_TRACE, "Response not encoded, can't be cached");
+        return;
+    }
+    memcpy(ctx->cache_recent.datagram, header, header_len);
+    if (payload_len) {
+        memcpy(&ctx->cache_recent.datagram[header_len], payload, payload_len);
+    }
+    ctx->cache_recent.datagram_len = header_len + payload_len;
+}
+
+void _anj_exchange_cache_get_datagram(_anj_exchange_cache_t *ctx,
+                                      const uint8_t **out_datagram,
+                                      size_t *out_len) {
+    assert(ctx->handling_retransmission);
+    *out_datagram = ctx->cache_recent.datagram;
+    *out_len = ctx->cache_recent.datagram_len;
+    exchange_log(L_TRACE, "Get recent cache");
+}
+#    else  // ANJ_WITH_ENCODED_RETRANSMISSIONS
 void _anj_exchange_cache_get(_anj_exchange_cache_t *ctx,
                              _anj_coap_msg_t *response) {
     assert(ctx->handling_retransmission);
+#    ifdef ANJ_CACHE_WITH_FULL_ENTRIES
+    if (ctx->retransmitted_full_id != NO_ENTRY) {
+        const _anj_exchange_cache_msg_full_t *entry =
+                &ctx->full_entries[ctx->retransmitted_full_id];
+        *response = entry->response;
+        response->payload = &ctx->payload_arena[entry->payload_offset];
+        exchange_log(L_TRACE, "Get non recent cache");
+        return;
+    }
+#    endif // ANJ_CACHE_WITH_FULL_ENTRIES
     *response = ctx->cache_recent.response;
     response->payload = ctx->cache_recent.payload;
     exchange_log(L_TRACE, "Get recent cache");
 }
+#    endif // ANJ_WITH_ENCODED_RETRANSMISSIONS
 
 #endif // ANJ_WITH_CACHE
@@ -48,7 +48,9 @@ void _anj_exchange_cache_add(_anj_exchange_cache_t *ctx,
  *
  * If the message ID matches a recent or non-recent cached response,
  * the function indicates the type of match. Matching recent responses
- * also enable retransmission handling logic via the internal flag.
+ * also enable retransmission handling logic via the internal flag. With
+ * @ref ANJ_CACHE_WITH_FULL_ENTRIES, non-recent responses that are still kept
+ * with payload are treated like the recent one.
  *
  * Expired entries are dropped before the check.
  *
@@ -63,12 +65,50 @@ void _anj_exchange_cache_add(_anj_exchange_cache_t *ctx,
  */
 int _anj_exchange_cache_check(_anj_exchange_cache_t *ctx, uint16_t msg_id);
 
+#        ifdef ANJ_WITH_ENCODED_RETRANSMISSIONS
+/**
+ * Stores the datagram the response added with the last call to
+ * @ref _anj_exchange_cache_add was encoded to. The response may be split into
+ * a header and a payload sent separately, they are stored one after another.
+ * Does nothing if the datagram of the most recent response is already stored.
+ *
+ * @param ctx         Exchange cache context.
+ * @param header      Encoded header, or the whole datagram. If NULL, the
+ *                    response couldn't be encoded and retransmitted requests
+ *                    will be dropped.
+ * @param header_len  Length of @p header.
+ * @param payload     Payload sent separately, may be NULL.
+ * @param payload_len Length of @p payload.
+ */
+void _anj_exchange_cache_set_datagram(_anj_exchange_cache_t *ctx,
+                                      const uint8_t *header,
+                                      size_t header_len,
+                                      const uint8_t *payload,
+                                      size_t payload_len);
+
+/**
+ * Retrieves the encoded response for a retransmitted message.
+ *
+ * This function must only be called after _anj_exchange_cache_check()
+ * has returned _ANJ_EXCHANGE_CACHE_HIT_RECENT. Unlike
+ * @ref _anj_exchange_cache_get, the response doesn't have to be encoded again.
+ *
+ * @param ctx                Exchange cache context.
+ * @param[out] out_datagram  Encoded response.
+ * @param[out] out_len       Length of @p out_datagram, 0 if the response
+ *                           couldn't be encoded.
+ */
+void _anj_exchange_cache_get_datagram(_anj_exchange_cache_t *ctx,
+                                      const uint8_t **out_datagram,
+                                      size_t *out_len);
+#        else // ANJ_WITH_ENCODED_RETRANSMISSIONS
 /**
  * Retrieves the cached response for a retransmitted message.
  *
  * This function must only be called after _anj_exchange_cache_check()
  * has returned _ANJ_EXCHANGE_CACHE_GET_RECENT. It copies the cached
- * response into @p response and resets the retransmission flag.
+ * response into @p response and resets the retransmission flag. The payload
+ * of a non-recent response points into the payload arena of @p ctx.
  *
  * @param ctx     Exchange cache context.
  * @param[out]    response Output parameter that will receive the cached
@@ -78,6 +118,18 @@ int _anj_exchange_cache_check(_anj_exchange_cache_t *ctx, uint16_t msg_id);
  */
 void _anj_exchange_cache_get(_anj_exchange_cache_t *ctx,
                              _anj_coap_msg_t *response);
+#        endif // ANJ_WITH_ENCODED_RETRANSMISSIONS
+
+#        ifdef ANJ_CACHE_WITH_FULL_ENTRIES
+/**
+ * Clears the responses kept with payload and the Message ID index of
+ * non-recent entries. Called by @ref _anj_exchange_setup_cache, after all
+ * entries are invalidated.
+ *
+ * @param ctx Exchange cache context.
+ */
+void _anj_exchange_cache_init_full_entries(_anj_exchange_cache_t *ctx);
+#        endif // ANJ_CACHE_WITH_FULL_ENTRIES
 
 #    endif // ANJ_WITH_CACHE
 
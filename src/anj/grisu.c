@@ -0,0 +1,520 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "grisu.h"
+
+#if defined(ANJ_WITH_FAST_NUMBER_FORMATTING) \
+        || defined(ANJ_WITH_FAST_NUMBER_PARSING)
+
+/*
+ * Grisu2 algorithm by Florian Loitsch, "Printing Floating-Point Numbers Quickly
+ * and Accurately with Integers" (PLDI 2010). The result always converts back
+ * to the same double and is the shortest such representation for the vast
+ * majority of values.
+ *
+ * The same cached powers of ten are used for the opposite conversion, see
+ * @ref _anj_decimal_to_double.
+ */
+
+typedef struct {
+    uint64_t f;
+    int e;
+} diy_fp_t;
+
+#    define DP_SIGNIFICAND_SIZE 52
+#    define DP_EXPONENT_BIAS (0x3FF + DP_SIGNIFICAND_SIZE)
+#    define DP_MIN_EXPONENT (-DP_EXPONENT_BIAS + 1)
+#    define DP_HIDDEN_BIT (UINT64_C(1) << DP_SIGNIFICAND_SIZE)
+#    define DP_SIGNIFICAND_MASK (DP_HIDDEN_BIT - 1)
+#    define DIY_FP_TOP_BIT (UINT64_C(1) << 63)
+
+/* Normalized 64-bit significands of 10^k for k = -348, -340, ..., 340 */
+static const uint64_t CACHED_POWERS_F[] = {
+    UINT64_C(0xfa8fd5a0081c0288), UINT64_C(0xbaaee17fa23ebf76),
+    UINT64_C(0x8b16fb203055ac76), UINT64_C(0xcf42894a5dce35ea),
+    UINT64_C(0x9a6bb0aa55653b2d), UINT64_C(0xe61acf033d1a45df),
+    UINT64_C(0xab70fe17c79ac6ca), UINT64_C(0xff77b1fcbebcdc4f),
+    UINT64_C(0xbe5691ef416bd60c), UINT64_C(0x8dd01fad907ffc3c),
+    UINT64_C(0xd3515c2831559a83), UINT64_C(0x9d71ac8fada6c9b5),
+    UINT64_C(0xea9c227723ee8bcb), UINT64_C(0xaecc49914078536d),
+    UINT64_C(0x823c12795db6ce57), UINT64_C(0xc21094364dfb5637),
+    UINT64_C(0x9096ea6f3848984f), UINT64_C(0xd77485cb25823ac7),
+    UINT64_C(0xa086cfcd97bf97f4), UINT64_C(0xef340a98172aace5),
+    UINT64_C(0xb23867fb2a35b28e), UINT64_C(0x84c8d4dfd2c63f3b),
+    UINT64_C(0xc5dd44271ad3cdba), UINT64_C(0x936b9fcebb25c996),
+    UINT64_C(0xdbac6c247d62a584), UINT64_C(0xa3ab66580d5fdaf6),
+    UINT64_C(0xf3e2f893dec3f126), UINT64_C(0xb5b5ada8aaff80b8),
+    UINT64_C(0x87625f056c7c4a8b), UINT64_C(0xc9bcff6034c13053),
+    UINT64_C(0x964e858c91ba2655), UINT64_C(0xdff9772470297ebd),
+    UINT64_C(0xa6dfbd9fb8e5b88f), UINT64_C(0xf8a95fcf88747d94),
+    UINT64_C(0xb94470938fa89bcf), UINT64_C(0x8a08f0f8bf0f156b),
+    UINT64_C(0xcdb02555653131b6), UINT64_C(0x993fe2c6d07b7fac),
+    UINT64_C(0xe45c10c42a2b3b06), UINT64_C(0xaa242499697392d3),
+    UINT64_C(0xfd87b5f28300ca0e), UINT64_C(0xbce5086492111aeb),
+    UINT64_C(0x8cbccc096f5088cc), UINT64_C(0xd1b71758e219652c),
+    UINT64_C(0x9c40000000000000), UINT64_C(0xe8d4a51000000000),
+    UINT64_C(0xad78ebc5ac620000), UINT64_C(0x813f3978f8940984),
+    UINT64_C(0xc097ce7bc90715b3), UINT64_C(0x8f7e32ce7bea5c70),
+    UINT64_C(0xd5d238a4abe98068), UINT64_C(0x9f4f2726179a2245),
+    UINT64_C(0xed63a231d4c4fb27), UINT64_C(0xb0de65388cc8ada8),
+    UINT64_C(0x83c7088e1aab65db), UINT64_C(0xc45d1df942711d9a),
+    UINT64_C(0x924d692ca61be758), UINT64_C(0xda01ee641a708dea),
+    UINT64_C(0xa26da3999aef774a), UINT64_C(0xf209787bb47d6b85),
+    UINT64_C(0xb454e4a179dd1877), UINT64_C(0x865b86925b9bc5c2),
+    UINT64_C(0xc83553c5c8965d3d), UINT64_C(0x952ab45cfa97a0b3),
+    UINT64_C(0xde469fbd99a05fe3), UINT64_C(0xa59bc234db398c25),
+    UINT64_C(0xf6c69a72a3989f5c), UINT64_C(0xb7dcbf5354e9bece),
+    UINT64_C(0x88fcf317f22241e2), UINT64_C(0xcc20ce9bd35c78a5),
+    UINT64_C(0x98165af37b2153df), UINT64_C(0xe2a0b5dc971f303a),
+    UINT64_C(0xa8d9d1535ce3b396), UINT64_C(0xfb9b7cd9a4a7443c),
+    UINT64_C(0xbb764c4ca7a44410), UINT64_C(0x8bab8eefb6409c1a),
+    UINT64_C(0xd01fef10a657842c), UINT64_C(0x9b10a4e5e9913129),
+    UINT64_C(0xe7109bfba19c0c9d), UINT64_C(0xac2820d9623bf429),
+    UINT64_C(0x80444b5e7aa7cf85), UINT64_C(0xbf21e44003acdd2d),
+    UINT64_C(0x8e679c2f5e44ff8f), UINT64_C(0xd433179d9c8cb841),
+    UINT64_C(0x9e19db92b4e31ba9), UINT64_C(0xeb96bf6ebadf77d9),
+    UINT64_C(0xaf87023b9bf0ee6b)
+};
+
+/* Binary exponents matching CACHED_POWERS_F */
+static const int16_t CACHED_POWERS_E[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954,
+    -927, -901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635,
+    -608, -582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316,
+    -289, -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30, 56,
+    83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348, 375, 402, 428, 455,
+    481, 508, 534, 561, 588, 614, 641, 667, 694, 720, 747, 774, 800, 827, 853,
+    880, 907, 933, 960, 986, 1013, 1039, 1066
+};
+
+static const uint64_t POW10[] = { UINT64_C(1),
+                                  UINT64_C(10),
+                                  UINT64_C(100),
+                                  UINT64_C(1000),
+                                  UINT64_C(10000),
+                                  UINT64_C(100000),
+                                  UINT64_C(1000000),
+                                  UINT64_C(10000000),
+                                  UINT64_C(100000000),
+                                  UINT64_C(1000000000),
+                                  UINT64_C(10000000000),
+                                  UINT64_C(100000000000),
+                                  UINT64_C(1000000000000),
+                                  UINT64_C(10000000000000),
+                                  UINT64_C(100000000000000),
+                                  UINT64_C(1000000000000000),
+                                  UINT64_C(10000000000000000),
+                                  UINT64_C(100000000000000000),
+                                  UINT64_C(1000000000000000000),
+                                  UINT64_C(10000000000000000000) };
+
+static diy_fp_t diy_fp_normalize(diy_fp_t value) {
+    while (!(value.f & DIY_FP_TOP_BIT)) {
+        value.f <<= 1;
+        value.e--;
+    }
+    return value;
+}
+
+static diy_fp_t diy_fp_mul(diy_fp_t x, diy_fp_t y) {
+    const uint64_t mask_32 = UINT64_C(0xFFFFFFFF);
+    uint64_t a = x.f >> 32;
+    uint64_t b = x.f & mask_32;
+    uint64_t c = y.f >> 32;
+    uint64_t d = y.f & mask_32;
+    uint64_t ac = a * c;
+    uint64_t bc = b * c;
+    uint64_t ad = a * d;
+    uint64_t bd = b * d;
+    uint64_t tmp = (bd >> 32) + (ad & mask_32) + (bc & mask_32);
+    tmp += UINT64_C(1) << 31; // round
+    diy_fp_t result = {
+        .f = ac + (ad >> 32) + (bc >> 32) + (tmp >> 32),
+        .e = x.e + y.e + 64
+    };
+    return result;
+}
+
+#    ifdef ANJ_WITH_FAST_NUMBER_FORMATTING
+static diy_fp_t diy_fp_from_double(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    int biased_e = (int) ((bits >> DP_SIGNIFICAND_SIZE) & 0x7FF);
+    uint64_t significand = bits & DP_SIGNIFICAND_MASK;
+    diy_fp_t result;
+    if (biased_e) {
+        result.f = significand | DP_HIDDEN_BIT;
+        result.e = biased_e - DP_EXPONENT_BIAS;
+    } else {
+        result.f = significand;
+        result.e = DP_MIN_EXPONENT;
+    }
+    return result;
+}
+
+static void normalized_boundaries(diy_fp_t value,
+                                  diy_fp_t *out_minus,
+                                  diy_fp_t *out_plus) {
+    diy_fp_t plus = {
+        .f = (value.f << 1) + 1,
+        .e = value.e - 1
+    };
+    plus = diy_fp_normalize(plus);
+    diy_fp_t minus;
+    if (value.f == DP_HIDDEN_BIT) {
+        minus.f = (value.f << 2) - 1;
+        minus.e = value.e - 2;
+    } else {
+        minus.f = (value.f << 1) - 1;
+        minus.e = value.e - 1;
+    }
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+    *out_minus = minus;
+    *out_plus = plus;
+}
+
+/* Returns 10^-K such that the exponent of the product with a value with
+ * binary exponent e is in the [-60, -32] range. */
+static diy_fp_t cached_power(int e, int *out_k) {
+    // 0.30102999566398114 is log10(2)
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int k = (int) dk;
+    if (dk - k > 0.0) {
+        k++;
+    }
+    size_t index = (size_t) ((k >> 3) + 1);
+    assert(index < sizeof(CACHED_POWERS_E) / sizeof(CACHED_POWERS_E[0]));
+    *out_k = -(-348 + (int) index * 8);
+    diy_fp_t result = {
+        .f = CACHED_POWERS_F[index],
+        .e = CACHED_POWERS_E[index]
+    };
+    return result;
+}
+
+static void grisu_round(char *digits,
+                        size_t len,
+                        uint64_t delta,
+                        uint64_t rest,
+                        uint64_t ten_kappa,
+                        uint64_t wp_w) {
+    while (rest < wp_w && delta - rest >= ten_kappa
+           && (rest + ten_kappa < wp_w
+               || wp_w - rest > rest + ten_kappa - wp_w)) {
+        digits[len - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+static size_t
+digit_gen(diy_fp_t w, diy_fp_t mp, uint64_t delta, char *digits, int *k) {
+    const diy_fp_t one = {
+        .f = UINT64_C(1) << -mp.e,
+        .e = mp.e
+    };
+    const uint64_t wp_w = mp.f - w.f;
+    uint32_t p1 = (uint32_t) (mp.f >> -one.e);
+    uint64_t p2 = mp.f & (one.f - 1);
+    int kappa = 0;
+    while (kappa < 10 && p1 >= POW10[kappa]) {
+        kappa++;
+    }
+    size_t len = 0;
+    while (kappa > 0) {
+        uint32_t divisor = (uint32_t) POW10[kappa - 1];
+        uint32_t d = p1 / divisor;
+        p1 %= divisor;
+        if (d || len) {
+            digits[len++] = (char) ('0' + d);
+        }
+        kappa--;
+        uint64_t tmp = ((uint64_t) p1 << -one.e) + p2;
+        if (tmp <= delta) {
+            *k += kappa;
+            grisu_round(digits, len, delta, tmp, POW10[kappa] << -one.e, wp_w);
+            return len;
+        }
+    }
+    for (;;) {
+        p2 *= 10;
+        delta *= 10;
+        char d = (char) (p2 >> -one.e);
+        if (d || len) {
+            digits[len++] = (char) ('0' + d);
+        }
+        p2 &= one.f - 1;
+        kappa--;
+        if (p2 < delta) {
+            *k += kappa;
+            int index = -kappa;
+            grisu_round(digits, len, delta, p2, one.f,
+                        wp_w * (index < 20 ? POW10[index] : 0));
+            return len;
+        }
+    }
+}
+
+size_t _anj_grisu2(double value, char *out_digits, int *out_exponent) {
+    assert(value > 0.0);
+    diy_fp_t v = diy_fp_from_double(value);
+    diy_fp_t w_minus;
+    diy_fp_t w_plus;
+    normalized_boundaries(v, &w_minus, &w_plus);
+    int k;
+    const diy_fp_t c_mk = cached_power(w_plus.e, &k);
+    const diy_fp_t w = diy_fp_mul(diy_fp_normalize(v), c_mk);
+    diy_fp_t wp = diy_fp_mul(w_plus, c_mk);
+    diy_fp_t wm = diy_fp_mul(w_minus, c_mk);
+    wm.f++;
+    wp.f--;
+    size_t len = digit_gen(w, wp, wp.f - wm.f, out_digits, &k);
+    *out_exponent = k;
+    return len;
+}
+#    endif // ANJ_WITH_FAST_NUMBER_FORMATTING
+
+#    ifdef ANJ_WITH_FAST_NUMBER_PARSING
+/* Large enough for the exact values compared in decimal_is_above_halfway() */
+#        define BIGNUM_LIMBS 40
+
+typedef struct {
+    uint32_t limbs[BIGNUM_LIMBS];
+    size_t len;
+} bignum_t;
+
+static void bignum_init(bignum_t *num, uint64_t value) {
+    num->limbs[0] = (uint32_t) value;
+    num->limbs[1] = (uint32_t) (value >> 32);
+    num->len = num->limbs[1] ? 2 : 1;
+}
+
+static void bignum_mul_u32(bignum_t *num, uint32_t factor) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < num->len; i++) {
+        uint64_t product = (uint64_t) num->limbs[i] * factor + carry;
+        num->limbs[i] = (uint32_t) product;
+        carry = product >> 32;
+    }
+    if (carry) {
+        assert(num->len < BIGNUM_LIMBS);
+        num->limbs[num->len++] = (uint32_t) carry;
+    }
+}
+
+static void bignum_mul_pow5(bignum_t *num, unsigned exponent) {
+    // 5^13 is the largest power of 5 that fits in uint32_t
+    for (; exponent >= 13; exponent -= 13) {
+        bignum_mul_u32(num, UINT32_C(1220703125));
+    }
+    uint32_t factor = 1;
+    for (; exponent > 0; exponent--) {
+        factor *= 5;
+    }
+    bignum_mul_u32(num, factor);
+}
+
+static void bignum_shl(bignum_t *num, unsigned bits) {
+    size_t limb_shift = bits / 32;
+    unsigned bit_shift = bits % 32;
+    assert(num->len + limb_shift < BIGNUM_LIMBS);
+    num->limbs[num->len] = 0;
+    for (size_t i = num->len + 1; i > 0; i--) {
+        uint32_t high = num->limbs[i - 1];
+        uint32_t low = i > 1 ? num->limbs[i - 2] : 0;
+        num->limbs[i - 1 + limb_shift] =
+                bit_shift ? (high << bit_shift) | (low >> (32 - bit_shift))
+                          : high;
+    }
+    for (size_t i = 0; i < limb_shift; i++) {
+        num->limbs[i] = 0;
+    }
+    num->len += limb_shift + 1;
+    while (num->len > 1 && !num->limbs[num->len - 1]) {
+        num->len--;
+    }
+}
+
+static int bignum_cmp(const bignum_t *a, const bignum_t *b) {
+    if (a->len != b->len) {
+        return a->len > b->len ? 1 : -1;
+    }
+    for (size_t i = a->len; i > 0; i--) {
+        if (a->limbs[i - 1] != b->limbs[i - 1]) {
+            return a->limbs[i - 1] > b->limbs[i - 1] ? 1 : -1;
+        }
+    }
+    return 0;
+}
+
+/* Compares significand * 10^exponent with halfway * 2^binary_exponent. */
+static int decimal_cmp_halfway(uint64_t significand,
+                               int exponent,
+                               uint64_t halfway,
+                               int binary_exponent) {
+    bignum_t decimal;
+    bignum_t binary;
+    bignum_init(&decimal, significand);
+    bignum_init(&binary, halfway);
+    // both sides are multiplied by 10^-exponent if exponent is negative, and
+    // the common power of 2 is removed
+    if (exponent >= 0) {
+        bignum_mul_pow5(&decimal, (unsigned) exponent);
+    } else {
+        bignum_mul_pow5(&binary, (unsigned) -exponent);
+    }
+    int shift = exponent - binary_exponent;
+    if (shift > 0) {
+        bignum_shl(&decimal, (unsigned) shift);
+    } else if (shift < 0) {
+        bignum_shl(&binary, (unsigned) -shift);
+    }
+    return bignum_cmp(&decimal, &binary);
+}
+
+/* Powers of ten that are exactly representable as double */
+static const double EXACT_POW10[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                      1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                      1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                      1e18, 1e19, 1e20, 1e21, 1e22 };
+
+/* Maximum error of the approximation in diy_fp units, see below */
+#        define APPROXIMATION_ERROR 16
+#        define TRUNCATION_ERROR 64
+
+int _anj_decimal_to_double(uint64_t significand,
+                           int exponent,
+                           bool truncated,
+                           double *out_value) {
+    if (!significand) {
+        *out_value = 0.0;
+        return 0;
+    }
+    int digits = 1;
+    while (digits < 20 && significand >= POW10[digits]) {
+        digits++;
+    }
+    if (exponent + digits > DBL_MAX_10_EXP + 1) {
+        return -1; // at least 10^309
+    }
+    if (exponent + digits < -324) {
+        *out_value = 0.0; // below half of the smallest subnormal value
+        return 0;
+    }
+
+    // Clinger's fast path: both operands are exact, so the single rounding of
+    // the floating-point operation gives the correctly rounded result
+    if (!truncated && significand <= DP_HIDDEN_BIT << 1 && exponent >= -22
+            && exponent <= 22) {
+        *out_value = exponent >= 0
+                             ? (double) significand * EXACT_POW10[exponent]
+                             : (double) significand / EXACT_POW10[-exponent];
+        return 0;
+    }
+
+    // 10^exponent = 10^(-348 + 8 * index) * 10^remainder; each of the (at most
+    // three) roundings is below one unit of the result, the normalizations may
+    // double it
+    const diy_fp_t input = {
+        .f = significand,
+        .e = 0
+    };
+    diy_fp_t w = diy_fp_normalize(input);
+    const unsigned index = (unsigned) (exponent + 348) / 8;
+    const unsigned remainder = (unsigned) (exponent + 348) % 8;
+    assert(index < sizeof(CACHED_POWERS_E) / sizeof(CACHED_POWERS_E[0]));
+    if (remainder) {
+        const diy_fp_t pow10 = {
+            .f = POW10[remainder],
+            .e = 0
+        };
+        w = diy_fp_normalize(diy_fp_mul(w, diy_fp_normalize(pow10)));
+    }
+    const diy_fp_t cached = {
+        .f = CACHED_POWERS_F[index],
+        .e = CACHED_POWERS_E[index]
+    };
+    w = diy_fp_normalize(diy_fp_mul(w, cached));
+    uint64_t error = APPROXIMATION_ERROR + (truncated ? TRUNCATION_ERROR : 0);
+
+    // w.f * 2^w.e is in [2^(w.e + 63), 2^(w.e + 64)), subnormal values have
+    // less significant bits
+    int precision = DP_SIGNIFICAND_SIZE + 1;
+    if (w.e + 63 < DP_MIN_EXPONENT + DP_SIGNIFICAND_SIZE) {
+        precision -= DP_MIN_EXPONENT + DP_SIGNIFICAND_SIZE - (w.e + 63);
+    }
+    if (precision < 0) {
+        *out_value = 0.0;
+        return 0;
+    }
+    const unsigned shift = 64 - (unsigned) precision;
+    uint64_t result;
+    uint64_t rest;
+    uint64_t half;
+    if (shift == 64) {
+        result = 0;
+        rest = w.f;
+        half = DIY_FP_TOP_BIT;
+    } else {
+        result = w.f >> shift;
+        rest = w.f & ((UINT64_C(1) << shift) - 1);
+        half = UINT64_C(1) << (shift - 1);
+    }
+    const int binary_exponent = w.e + (int) shift;
+
+    bool round_up;
+    if (rest > half + error) {
+        round_up = true;
+    } else if (rest + error < half) {
+        round_up = false;
+    } else {
+        // too close to the halfway point between two doubles, compare exactly
+        int cmp = decimal_cmp_halfway(significand, exponent, 2 * result + 1,
+                                      binary_exponent - 1);
+        if (truncated) {
+            // the real value is somewhere between significand and
+            // significand + 1
+            if (cmp >= 0) {
+                round_up = true;
+            } else if (decimal_cmp_halfway(significand + 1, exponent,
+                                           2 * result + 1, binary_exponent - 1)
+                       <= 0) {
+                round_up = false;
+            } else {
+                round_up = rest >= half;
+            }
+        } else {
+            round_up = cmp > 0 || (cmp == 0 && (result & 1));
+        }
+    }
+    if (round_up) {
+        result++;
+    }
+
+    double value = ldexp((double) result, binary_exponent);
+    if (isinf(value)) {
+        return -1;
+    }
+    *out_value = value;
+    return 0;
+}
+#    endif // ANJ_WITH_FAST_NUMBER_PARSING
+
+#endif // defined(ANJ_WITH_FAST_NUMBER_FORMATTING) ||
+       // defined(ANJ_WITH_FAST_NUMBER_PARSING)
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#ifndef SRC_ANJ_GRISU_H
+#    define SRC_ANJ_GRISU_H
+
+#    include <stdbool.h>
+#    include <stddef.h>
+#    include <stdint.h>
+
+#    ifdef ANJ_WITH_FAST_NUMBER_FORMATTING
+
+/** Maximum number of digits produced by @ref _anj_grisu2. */
+#        define _ANJ_GRISU2_MAX_DIGITS 17
+
+/**
+ * Finds the shortest decimal representation of @p value that converts back to
+ * the same double.
+ *
+ * @param      value        Positive, finite value to convert.
+ * @param[out] out_digits   Buffer for at least @ref _ANJ_GRISU2_MAX_DIGITS
+ *                          decimal digits, the first one is not zero.
+ * @param[out] out_exponent Decimal exponent: @p value equals the digits, read
+ *                          as an integer, multiplied by 10^exponent.
+ *
+ * @returns Number of digits written.
+ */
+size_t _anj_grisu2(double value, char *out_digits, int *out_exponent);
+
+#    endif // ANJ_WITH_FAST_NUMBER_FORMATTING
+
+#    ifdef ANJ_WITH_FAST_NUMBER_PARSING
+
+/**
+ * Converts @p significand * 10^@p exponent to the nearest double, ties are
+ * rounded to even. If @p truncated is set and the dropped digits are needed to
+ * choose between two doubles, the approximated value is used.
+ *
+ * @param      significand Decimal significand, at most 19 digits.
+ * @param      exponent    Decimal exponent.
+ * @param      truncated   Set if some non-zero digits were dropped from
+ *                         @p significand, i.e. the real value is a bit larger.
+ * @param[out] out_value   Result, values below the smallest subnormal double
+ *                         are rounded to zero.
+ *
+ * @returns 0 on success, -1 if the value is too large for double.
+ */
+int _anj_decimal_to_double(uint64_t significand,
+                           int exponent,
+                           bool truncated,
+                           double *out_value);
+
+#    endif // ANJ_WITH_FAST_NUMBER_PARSING
+
+#endif // SRC_ANJ_GRISU_H
@@ -0,0 +1,753 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#define ANJ_LOG_SOURCE_FILE_ID 82
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/compat/net/anj_net_api.h>
+#include <anj/compat/time.h>
+#include <anj/defs.h>
+#include <anj/http_downloader.h>
+#include <anj/log.h>
+#include <anj/time.h>
+#include <anj/utils.h>
+
+#include "core/srv_conn.h"
+
+#ifdef ANJ_WITH_HTTP_DOWNLOADER
+
+#    define downloader_log(...) anj_log(http_downloader, __VA_ARGS__)
+
+#    define DEFAULT_TIMEOUT_S 30
+
+// returned by the parser if the next line hasn't been received yet
+#    define NEED_MORE_DATA 1
+
+static bool download_in_progress(anj_http_downloader_t *ctx) {
+    return ctx->status == ANJ_HTTP_DOWNLOADER_STATUS_STARTING
+           || ctx->status == ANJ_HTTP_DOWNLOADER_STATUS_DOWNLOADING
+           || ctx->status == ANJ_HTTP_DOWNLOADER_STATUS_FINISHING;
+}
+
+static char to_lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char) (c - 'A' + 'a') : c;
+}
+
+static bool equal_ignore_case(const char *str, size_t len, const char *lower) {
+    if (strlen(lower) != len) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (to_lower(str[i]) != lower[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool contains_ignore_case(const char *str,
+                                 size_t len,
+                                 const char *lower) {
+    size_t lower_len = strlen(lower);
+    for (size_t i = 0; i + lower_len <= len; i++) {
+        if (equal_ignore_case(&str[i], lower_len, lower)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void trim(const char **str, size_t *len) {
+    while (*len && (**str == ' ' || **str == '\t')) {
+        (*str)++;
+        (*len)--;
+    }
+    while (*len && ((*str)[*len - 1] == ' ' || (*str)[*len - 1] == '\t')) {
+        (*len)--;
+    }
+}
+
+static int parse_uri(anj_http_downloader_t *ctx, const char *uri) {
+    const char *default_port;
+    if (!strncmp(uri, "http://", sizeof("http://") - 1)) {
+#    ifndef ANJ_NET_WITH_TCP
+        return -1;
+#    endif // ANJ_NET_WITH_TCP
+        uri += sizeof("http://") - 1;
+        ctx->binding = ANJ_NET_BINDING_TCP;
+        default_port = "80";
+    } else if (!strncmp(uri, "https://", sizeof("https://") - 1)) {
+#    ifndef ANJ_NET_WITH_TLS
+        return -1;
+#    endif // ANJ_NET_WITH_TLS
+        uri += sizeof("https://") - 1;
+        ctx->binding = ANJ_NET_BINDING_TLS;
+        default_port = "443";
+    } else {
+        return -1;
+    }
+
+    const char *rest;
+    if (*uri == '[') {
+        // IPv6 address literal
+        ctx->host = uri + 1;
+        rest = strchr(ctx->host, ']');
+        if (!rest) {
+            return -1;
+        }
+        ctx->host_len = (size_t) (rest - ctx->host);
+        rest++;
+    } else {
+        ctx->host = uri;
+        ctx->host_len = strcspn(uri, ":/?#");
+        rest = uri + ctx->host_len;
+    }
+    if (!ctx->host_len || ctx->host_len >= ANJ_SERVER_URI_MAX_SIZE) {
+        return -1;
+    }
+
+    if (*rest == ':') {
+        ctx->port = rest + 1;
+        ctx->port_len = strcspn(ctx->port, "/?#");
+        uint32_t port;
+        if (!ctx->port_len || ctx->port_len > ANJ_U16_STR_MAX_LEN
+                || anj_string_to_uint32_value(&port, ctx->port, ctx->port_len)
+                || !port || port > UINT16_MAX) {
+            return -1;
+        }
+        rest = ctx->port + ctx->port_len;
+    } else if (*rest && !strchr("/?#", *rest)) {
+        return -1;
+    } else {
+        ctx->port = default_port;
+        ctx->port_len = strlen(default_port);
+    }
+    ctx->path = rest;
+    return 0;
+}
+
+static bool request_append(anj_http_downloader_t *ctx,
+                           const char *str,
+                           size_t len) {
+    if (len > sizeof(ctx->buffer) - ctx->buffer_len) {
+        return false;
+    }
+    memcpy(&ctx->buffer[ctx->buffer_len], str, len);
+    ctx->buffer_len += len;
+    return true;
+}
+
+#    define REQUEST_APPEND_LITERAL(Ctx, Str) \
+        request_append(Ctx, Str, sizeof(Str) - 1)
+
+static int build_request(anj_http_downloader_t *ctx) {
+    ctx->buffer_len = 0;
+    // fragment is not sent, and the path must begin with a slash
+    size_t path_len = strcspn(ctx->path, "#");
+    bool ipv6_literal = memchr(ctx->host, ':', ctx->host_len);
+    bool ok = REQUEST_APPEND_LITERAL(ctx, "GET ")
+              && (ctx->path[0] == '/' || REQUEST_APPEND_LITERAL(ctx, "/"))
+              && request_append(ctx, ctx->path, path_len)
+              && REQUEST_APPEND_LITERAL(ctx, " HTTP/1.1\r\nHost: ")
+              && (!ipv6_literal || REQUEST_APPEND_LITERAL(ctx, "["))
+              && request_append(ctx, ctx->host, ctx->host_len)
+              && (!ipv6_literal || REQUEST_APPEND_LITERAL(ctx, "]"))
+              && REQUEST_APPEND_LITERAL(ctx, ":")
+              && request_append(ctx, ctx->port, ctx->port_len)
+              && REQUEST_APPEND_LITERAL(ctx, "\r\n");
+    if (ok && ctx->offset > 0) {
+        char offset_str[ANJ_U64_STR_MAX_LEN + 1];
+        size_t offset_len = anj_uint64_to_string_value(offset_str, ctx->offset);
+        ok = REQUEST_APPEND_LITERAL(ctx, "Range: bytes=")
+             && request_append(ctx, offset_str, offset_len)
+             && REQUEST_APPEND_LITERAL(ctx, "-\r\n");
+        // resumed download is continued only if the resource hasn't changed
+        if (ok && ctx->offset > ctx->start_offset) {
+            ok = REQUEST_APPEND_LITERAL(ctx, "If-Range: ")
+                 && request_append(ctx, ctx->etag, strlen(ctx->etag))
+                 && REQUEST_APPEND_LITERAL(ctx, "\r\n");
+        }
+    }
+    if (ok && !ctx->keep_alive) {
+        ok = REQUEST_APPEND_LITERAL(ctx, "Connection: close\r\n");
+    }
+    ok = ok && REQUEST_APPEND_LITERAL(ctx, "\r\n");
+    return ok ? 0 : -1;
+}
+
+static bool connection_matches(anj_http_downloader_t *ctx) {
+    return ctx->conn_host[0] && ctx->conn_binding == ctx->binding
+           && strlen(ctx->conn_host) == ctx->host_len
+           && !memcmp(ctx->conn_host, ctx->host, ctx->host_len)
+           && strlen(ctx->conn_port) == ctx->port_len
+           && !memcmp(ctx->conn_port, ctx->port, ctx->port_len);
+}
+
+static int connect_with_server(anj_http_downloader_t *ctx) {
+    char hostname[ANJ_SERVER_URI_MAX_SIZE] = { 0 };
+    char port[ANJ_U16_STR_MAX_LEN + 1] = { 0 };
+    memcpy(hostname, ctx->host, ctx->host_len);
+    memcpy(port, ctx->port, ctx->port_len);
+    int result = _anj_srv_conn_connect(&ctx->connection_ctx, ctx->binding,
+                                       &ctx->net_socket_cfg, hostname, port);
+    if (anj_net_is_ok(result)) {
+        strcpy(ctx->conn_host, hostname);
+        strcpy(ctx->conn_port, port);
+        ctx->conn_binding = ctx->binding;
+    }
+    return result;
+}
+
+static int close_connection(anj_http_downloader_t *ctx) {
+    int result = _anj_srv_conn_close(&ctx->connection_ctx, true);
+    if (!anj_net_is_inprogress(result)) {
+        ctx->conn_host[0] = '\0';
+    }
+    return result;
+}
+
+static void deliver(anj_http_downloader_t *ctx,
+                    const uint8_t *data,
+                    size_t len) {
+    // the server ignored the Range header and sent the whole resource
+    if (ctx->skip) {
+        size_t skipped = (size_t) ANJ_MIN((uint64_t) len, ctx->skip);
+        data += skipped;
+        len -= skipped;
+        ctx->skip -= skipped;
+        if (!len) {
+            return;
+        }
+    }
+    ctx->offset += len;
+    ctx->last_reported_status = ANJ_HTTP_DOWNLOADER_STATUS_DOWNLOADING;
+    ctx->event_cb(ctx->event_cb_arg, ctx,
+                  ANJ_HTTP_DOWNLOADER_STATUS_DOWNLOADING, data, len);
+}
+
+static int handle_status_line(anj_http_downloader_t *ctx,
+                              const char *line,
+                              size_t len) {
+    uint32_t status;
+    if (len < sizeof("HTTP/1.x 200") - 1 || memcmp(line, "HTTP/1.", 7)
+            || line[8] != ' '
+            || anj_string_to_uint32_value(&status, &line[9], 3)) {
+        downloader_log(L_ERROR, "Invalid status line");
+        return ANJ_HTTP_DOWNLOADER_ERR_INVALID_RESPONSE;
+    }
+    ctx->http_status = (uint16_t) status;
+    // HTTP/1.0 connections are not persistent by default
+    ctx->connection_close = line[7] == '0';
+    return 0;
+}
+
+static int handle_header(anj_http_downloader_t *ctx,
+                         const char *line,
+                         size_t len) {
+    const char *colon = (const char *) memchr(line, ':', len);
+    if (!colon) {
+        downloader_log(L_ERROR, "Invalid header");
+        return ANJ_HTTP_DOWNLOADER_ERR_INVALID_RESPONSE;
+    }
+    size_t name_len = (size_t) (colon - line);
+    const char *value = colon + 1;
+    size_t value_len = len - name_len - 1;
+    trim(&value, &value_len);
+
+    if (equal_ignore_case(line, name_len, "content-length")) {
+        if (anj_string_to_uint64_value(&ctx->remaining, value, value_len)) {
+            downloader_log(L_ERROR, "Invalid Content-Length");
+            return ANJ_HTTP_DOWNLOADER_ERR_INVALID_RESPONSE;
+        }
+        ctx->has_content_length = true;
+    } else if (equal_ignore_case(line, name_len, "transfer-encoding")) {
+        ctx->chunked = contains_ignore_case(value, value_len, "chunked");
+    } else if (equal_ignore_case(line, name_len, "connection")) {
+        if (contains_ignore_case(value, value_len, "close")) {
+            ctx->connection_close = true;
+        }
+    } else if (equal_ignore_case(line, name_len, "etag")) {
+        if (ctx->offset > ctx->start_offset
+                && (strlen(ctx->etag) != value_len
+                    || memcmp(ctx->etag, value, value_len))) {
+            downloader_log(L_ERROR, "Resource changed on the server");
+            return ANJ_HTTP_DOWNLOADER_ERR_ETAG_MISMATCH;
+        }
+        // without ETag the download can't be resumed safely
+        if (value_len <= _ANJ_HTTP_DOWNLOADER_ETAG_MAX_LEN) {
+            memcpy(ctx->etag, value, value_len);
+            ctx->etag[value_len] = '\0';
+        } else {
+            ctx->etag[0] = '\0';
+        }
+    } else if (equal_ignore_case(line, name_len, "content-range")) {
+        uint64_t first_byte;
+        size_t prefix_len = sizeof("bytes ") - 1;
+        ctx->range_mismatch =
+                value_len <= prefix_len || memcmp(value, "bytes ", prefix_len)
+                || anj_string_to_uint64_value(
+                           &first_byte, &value[prefix_len],
+                           strcspn(&value[prefix_len], "-"))
+                || first_byte != ctx->offset;
+    }
+    return 0;
+}
+
+static int handle_headers_end(anj_http_downloader_t *ctx) {
+    if (ctx->http_status == 206) {
+        if (ctx->range_mismatch) {
+            downloader_log(L_ERROR, "Unexpected Content-Range");
+            return ANJ_HTTP_DOWNLOADER_ERR_INVALID_RESPONSE;
+        }
+    } else if (ctx->http_status == 200) {
+        // If-Range precondition failed
+        if (ctx->offset > ctx->start_offset) {
+            downloader_log(L_ERROR, "Resource changed on the server");
+            return ANJ_HTTP_DOWNLOADER_ERR_ETAG_MISMATCH;
+        }
+        ctx->skip = ctx->offset;
+    } else {
+        downloader_log(L_ERROR, "Unexpected status code: %" PRIu16,
+                       ctx->http_status);
+        return ANJ_HTTP_DOWNLOADER_ERR_INVALID_RESPONSE;
+    }
+
+    if (ctx->chunked) {
+        ctx->has_content_length = false;
+        ctx->parse_state = _ANJ_HTTP_DOWNLOADER_PARSE_CHUNK_SIZE;
+    } else if (ctx->has_content_length) {
+        ctx->parse_state = ctx->remaining ? _ANJ_HTTP_DOWNLOADER_PARSE_BODY
+                                          : _ANJ_HTTP_DOWNLOADER_PARSE_DONE;
+    } else {
+        // body ends when the server closes the connection
+        ctx->connection_close = true;
+        ctx->parse_state = _ANJ_HTTP_DOWNLOADER_PARSE_BODY;
+    }
+    return 0;
+}
+
+static int parse_chunk_size(const char *line, size_t len, uint64_t *out) {
+    uint64_t value = 0;
+    size_t i;
+    for (i = 0; i < len; i++) {
+        char c = to_lower(line[i]);
+        uint64_t digit;
+        if (c >= '0' && c <= '9') {
+            digit = (uint64_t) (c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            digit = (uint64_t) (c - 'a' + 10);
+        } else {
+            break;
+        }
+        if (value > (UINT64_MAX >> 4)) {
+            return -1;
+        }
+        value = (value << 4) | digit;
+    }
+    // chunk extensions are ignored
+    if (!i || (i < len && !strchr("; \t", line[i]))) {
+        return -1;
+    }
+    *out = value;
+    return 0;
+}
+
+static int handle_line(anj_http_downloader_t *ctx,
+                       const char *line,
+                       size_t len) {
+    switch (ctx->parse_state) {
+    case _ANJ_HTTP_DOWNLOADER_PARSE_STATUS_LINE:
+        ctx->parse_state = _ANJ_HTTP_DOWNLOADER_PARSE_HEADERS;
+        return handle_status_line(ctx, line, len);
+    case _ANJ_HTTP_DOWNLOADER_PARSE_HEADERS:
+        return len ? handle_header(ctx, line, len) : handle_headers_end(ctx);
+    case _ANJ_HTTP_DOWNLOADER_PARSE_CHUNK_SIZE:
+        if (parse_chunk_size(line, len, &ctx->remaining)) {
+            downloader_log(L_ERROR, "Invalid chunk size");
+            return ANJ_HTTP_DOWNLOADER_ERR_INVALID_RESPONSE;
+        }
+        ctx->parse_state = ctx->remaining
+                                   ? _ANJ_HTTP_DOWNLOADER_PARSE_CHUNK_DATA
+                                   : _ANJ_HTTP_DOWNLOADER_PARSE_TRAILERS;
+        return 0;
+    case _ANJ_HTTP_DOWNLOADER_PARSE_CHUNK_END:
+        if (len) {
+            downloader_log(L_ERROR, "Invalid chunk");
+            return ANJ_HTTP_DOWNLOADER_ERR_INVALID_RESPONSE;
+        }
+        ctx->parse_state = _ANJ_HTTP_DOWNLOADER_PARSE_CHUNK_SIZE;
+        return 0;
+    case _ANJ_HTTP_DOWNLOADER_PARSE_TRAILERS:
+        if (!len) {
+            ctx->parse_state = _ANJ_HTTP_DOWNLOADER_PARSE_DONE;
+        }
+        return 0;
+    default:
+        ANJ_UNREACHABLE("Invalid parser state");
+        return ANJ_HTTP_DOWNLOADER_ERR_INVALID_RESPONSE;
+    }
+}
+
+static bool take_line(anj_http_downloader_t *ctx,
+                      size_t *pos,
+                      const char **out_line,
+                      size_t *out_len) {
+    const char *start = (const char *) &ctx->buffer[*pos];
+    size_t available = ctx->buffer_len - *pos;
+    for (size_t i = 0; i + 1 < available; i++) {
+        if (start[i] == '\r' && start[i + 1] == '\n') {
+            *out_line = start;
+            *out_len = i;
+            *pos += i + 2;
+            return true;
+        }
+    }
+    return false;
+}
+
+static int parse(anj_http_downloader_t *ctx) {
+    size_t pos = 0;
+    int result = 0;
+    while (!result && ctx->parse_state != _ANJ_HTTP_DOWNLOADER_PARSE_DONE) {
+        bool in_chunk = ctx->parse_state == _ANJ_HTTP_DOWNLOADER_PARSE_CHUNK_DATA;
+        if (in_chunk || ctx->parse_state == _ANJ_HTTP_DOWNLOADER_PARSE_BODY) {
+            size_t len = ctx->buffer_len - pos;
+            if (!len) {
+                break;
+            }
+            bool limited = in_chunk || ctx->has_content_length;
+            if (limited) {
+                len = (size_t) ANJ_MIN((uint64_t) len, ctx->remaining);
+                ctx->remaining -= len;
+                if (!ctx->remaining) {
+                    ctx->parse_state = in_chunk
+                                               ? _ANJ_HTTP_DOWNLOADER_PARSE_CHUNK_END
+                                               : _ANJ_HTTP_DOWNLOADER_PARSE_DONE;
+                }
+            }
+            deliver(ctx, &ctx->buffer[pos], len);
+            pos += len;
+            // the event callback might have terminated the download
+            if (ctx->status != ANJ_HTTP_DOWNLOADER_STATUS_DOWNLOADING) {
+                result = ANJ_HTTP_DOWNLOADER_ERR_TERMINATED;
+            }
+            continue;
+        }
+        const char *line;
+        size_t line_len;
+        if (!take_line(ctx, &pos, &line, &line_len)) {
+            if (!pos && ctx->buffer_len == sizeof(ctx->buffer)) {
+                downloader_log(L_ERROR, "Response line too long");
+                result = ANJ_HTTP_DOWNLOADER_ERR_INVALID_RESPONSE;
+            }
+            break;
+        }
+        result = handle_line(ctx, line, line_len);
+    }
+    memmove(ctx->buffer, &ctx->buffer[pos], ctx->buffer_len - pos);
+    ctx->buffer_len -= pos;
+    return result;
+}
+
+static void set_recv_deadline(anj_http_downloader_t *ctx) {
+    ctx->recv_deadline =
+            anj_time_monotonic_add(anj_time_monotonic_now(), ctx->timeout);
+}
+
+static int send_request(anj_http_downloader_t *ctx) {
+    int result = _anj_srv_conn_send(&ctx->connection_ctx, ctx->buffer,
+                                    ctx->buffer_len);
+    if (anj_net_is_inprogress(result)) {
+        return result;
+    }
+    if (!anj_net_is_ok(result)) {
+        downloader_log(L_ERROR, "Failed to send request: %d", result);
+        return ANJ_HTTP_DOWNLOADER_ERR_NETWORK;
+    }
+    ctx->request_pending = false;
+    ctx->buffer_len = 0;
+    ctx->parse_state = _ANJ_HTTP_DOWNLOADER_PARSE_STATUS_LINE;
+    ctx->http_status = 0;
+    ctx->chunked = false;
+    ctx->has_content_length = false;
+    ctx->connection_close = false;
+    ctx->range_mismatch = ctx->offset > 0;
+    ctx->remaining = 0;
+    ctx->skip = 0;
+    set_recv_deadline(ctx);
+    return 0;
+}
+
+static int receive_response(anj_http_downloader_t *ctx) {
+    while (ctx->parse_state != _ANJ_HTTP_DOWNLOADER_PARSE_DONE) {
+        size_t received;
+        int result = _anj_srv_conn_receive(&ctx->connection_ctx,
+                                           &ctx->buffer[ctx->buffer_len],
+                                           &received,
+                                           sizeof(ctx->buffer)
+                                                   - ctx->buffer_len);
+        if (anj_net_is_again(result)) {
+            if (anj_time_monotonic_gt(anj_time_monotonic_now(),
+                                      ctx->recv_deadline)) {
+                downloader_log(L_ERROR, "No data received in time");
+                return ANJ_HTTP_DOWNLOADER_ERR_TIMEOUT;
+            }
+            return result;
+        }
+        if (!anj_net_is_ok(result)) {
+            downloader_log(L_ERROR, "Failed to receive response: %d", result);
+            return ANJ_HTTP_DOWNLOADER_ERR_NETWORK;
+        }
+        if (!received) {
+            // connection closed by the server
+            if (ctx->parse_state == _ANJ_HTTP_DOWNLOADER_PARSE_BODY
+                    && !ctx->has_content_length) {
+                ctx->parse_state = _ANJ_HTTP_DOWNLOADER_PARSE_DONE;
+                return 0;
+            }
+            downloader_log(L_ERROR, "Connection closed by the server");
+            return ANJ_HTTP_DOWNLOADER_ERR_NETWORK;
+        }
+        ctx->buffer_len += received;
+        set_recv_deadline(ctx);
+        result = parse(ctx);
+        if (result) {
+            return result;
+        }
+    }
+    // anything following the response is unexpected
+    if (ctx->buffer_len) {
+        ctx->connection_close = true;
+    }
+    return 0;
+}
+
+static bool try_resume(anj_http_downloader_t *ctx) {
+    // data passed to the application can't be validated without ETag
+    if (ctx->resume_attempts >= ctx->max_resume_attempts
+            || (ctx->offset > ctx->start_offset && !ctx->etag[0])
+            || build_request(ctx)) {
+        return false;
+    }
+    ctx->resume_attempts++;
+    downloader_log(L_WARNING, "Resuming download from offset %" PRIu64,
+                   ctx->offset);
+    ctx->reconnect = true;
+    ctx->status = ANJ_HTTP_DOWNLOADER_STATUS_STARTING;
+    // the application sees a single download
+    ctx->last_reported_status = ANJ_HTTP_DOWNLOADER_STATUS_STARTING;
+    return true;
+}
+
+static void handle_event_cb(anj_http_downloader_t *ctx,
+                            anj_http_downloader_status_t current_status) {
+    if (ctx->last_reported_status != current_status) {
+        ctx->event_cb(ctx->event_cb_arg, ctx, current_status, NULL, 0);
+        ctx->last_reported_status = current_status;
+    }
+}
+
+void anj_http_downloader_step(anj_http_downloader_t *ctx) {
+    assert(ctx);
+
+    switch (ctx->status) {
+    case ANJ_HTTP_DOWNLOADER_STATUS_STARTING: {
+        handle_event_cb(ctx, ANJ_HTTP_DOWNLOADER_STATUS_STARTING);
+        // idle connection to another server, or a broken one
+        if (ctx->conn_host[0]
+                && (ctx->reconnect || !connection_matches(ctx))) {
+            if (anj_net_is_inprogress(close_connection(ctx))) {
+                break;
+            }
+            ctx->reconnect = false;
+        }
+        if (!ctx->conn_host[0]) {
+            int result = connect_with_server(ctx);
+            if (anj_net_is_inprogress(result)) {
+                break;
+            }
+            if (!anj_net_is_ok(result)) {
+                ctx->status = ANJ_HTTP_DOWNLOADER_STATUS_FINISHING;
+                ctx->error_code = ANJ_HTTP_DOWNLOADER_ERR_NETWORK;
+                downloader_log(L_ERROR, "Failed to connect to server: %d",
+                               result);
+                break;
+            }
+            downloader_log(L_DEBUG, "Connected to server");
+        } else {
+            downloader_log(L_DEBUG, "Reusing connection");
+        }
+        ctx->request_pending = true;
+        ctx->status = ANJ_HTTP_DOWNLOADER_STATUS_DOWNLOADING;
+        break;
+    }
+    case ANJ_HTTP_DOWNLOADER_STATUS_DOWNLOADING: {
+        int result = ctx->request_pending ? send_request(ctx) : 0;
+        if (!result) {
+            result = receive_response(ctx);
+        }
+        if (anj_net_is_again(result) || anj_net_is_inprogress(result)) {
+            break;
+        }
+        if (result == ANJ_HTTP_DOWNLOADER_ERR_NETWORK && try_resume(ctx)) {
+            break;
+        }
+        if (result) {
+            ctx->error_code = result;
+            downloader_log(L_ERROR, "Download failed with error: %d", result);
+        }
+        ctx->status = ANJ_HTTP_DOWNLOADER_STATUS_FINISHING;
+        break;
+    }
+    case ANJ_HTTP_DOWNLOADER_STATUS_FINISHING: {
+        handle_event_cb(ctx, ANJ_HTTP_DOWNLOADER_STATUS_FINISHING);
+        int result = 0;
+        if (ctx->error_code || !ctx->keep_alive || ctx->connection_close) {
+            result = close_connection(ctx);
+            if (anj_net_is_inprogress(result)) {
+                break;
+            }
+        }
+        if (result && ctx->error_code == 0) {
+            ctx->error_code = ANJ_HTTP_DOWNLOADER_ERR_NETWORK;
+            downloader_log(L_ERROR, "Socket closed with error: %d", result);
+        }
+        if (ctx->error_code) {
+            ctx->status = ANJ_HTTP_DOWNLOADER_STATUS_FAILED;
+        } else {
+            ctx->status = ANJ_HTTP_DOWNLOADER_STATUS_FINISHED;
+            downloader_log(L_INFO, "Download finished successfully");
+        }
+        break;
+    }
+    default:
+        handle_event_cb(ctx, ctx->status);
+        break;
+    }
+}
+
+anj_time_duration_t
+anj_http_downloader_next_step_time(anj_http_downloader_t *ctx) {
+    assert(ctx);
+    if (download_in_progress(ctx)
+            || ctx->last_reported_status != ctx->status) {
+        return ANJ_TIME_DURATION_ZERO;
+    }
+    return ANJ_TIME_DURATION_INVALID;
+}
+
+int anj_http_downloader_init(
+        anj_http_downloader_t *ctx,
+        const anj_http_downloader_configuration_t *config) {
+    assert(ctx);
+    assert(config);
+
+    memset(ctx, 0, sizeof(*ctx));
+
+    if (config->event_cb == NULL) {
+        downloader_log(L_ERROR, "Status callback is not set");
+        return ANJ_HTTP_DOWNLOADER_ERR_INVALID_CONFIGURATION;
+    }
+    ctx->event_cb = config->event_cb;
+    ctx->event_cb_arg = config->event_cb_arg;
+    ctx->max_resume_attempts = config->max_resume_attempts;
+    ctx->keep_alive = config->keep_alive;
+    ctx->timeout = config->timeout;
+    if (!anj_time_duration_is_valid(ctx->timeout)
+            || !anj_time_duration_gt(ctx->timeout, ANJ_TIME_DURATION_ZERO)) {
+        ctx->timeout = anj_time_duration_new(DEFAULT_TIMEOUT_S, ANJ_TIME_UNIT_S);
+    }
+
+    ctx->status = ANJ_HTTP_DOWNLOADER_STATUS_INITIAL;
+    ctx->last_reported_status = ANJ_HTTP_DOWNLOADER_STATUS_INITIAL;
+    return 0;
+}
+
+int anj_http_downloader_get_error(anj_http_downloader_t *ctx) {
+    assert(ctx);
+    return ctx->error_code;
+}
+
+uint16_t anj_http_downloader_get_http_status(anj_http_downloader_t *ctx) {
+    assert(ctx);
+    return ctx->http_status;
+}
+
+int anj_http_downloader_start(anj_http_downloader_t *ctx,
+                              const char *uri,
+                              size_t offset,
+                              const anj_net_config_t *net_config) {
+    assert(ctx);
+    assert(uri);
+    if (download_in_progress(ctx)) {
+        downloader_log(L_ERROR, "Download already in progress");
+        return ANJ_HTTP_DOWNLOADER_ERR_IN_PROGRESS;
+    }
+
+    downloader_log(L_INFO, "Starting HTTP download from %s", uri);
+
+    if (parse_uri(ctx, uri)) {
+        downloader_log(L_ERROR, "Invalid or unsupported URI");
+        return ANJ_HTTP_DOWNLOADER_ERR_INVALID_URI;
+    }
+    if (!net_config && ctx->binding == ANJ_NET_BINDING_TLS) {
+        downloader_log(L_ERROR, "No network configuration for HTTPS");
+        return ANJ_HTTP_DOWNLOADER_ERR_INVALID_CONFIGURATION;
+    }
+    ctx->offset = offset;
+    ctx->start_offset = offset;
+    ctx->etag[0] = '\0';
+    if (build_request(ctx)) {
+        downloader_log(L_ERROR, "Request does not fit in the buffer");
+        return ANJ_HTTP_DOWNLOADER_ERR_INVALID_URI;
+    }
+
+    if (net_config) {
+        ctx->net_socket_cfg = *net_config;
+    } else {
+        memset(&ctx->net_socket_cfg, 0, sizeof(ctx->net_socket_cfg));
+    }
+    ctx->error_code = 0;
+    ctx->http_status = 0;
+    ctx->resume_attempts = 0;
+    ctx->reconnect = false;
+    ctx->status = ANJ_HTTP_DOWNLOADER_STATUS_STARTING;
+    return 0;
+}
+
+void anj_http_downloader_terminate(anj_http_downloader_t *ctx) {
+    assert(ctx);
+
+    if (ctx->status != ANJ_HTTP_DOWNLOADER_STATUS_STARTING
+            && ctx->status != ANJ_HTTP_DOWNLOADER_STATUS_DOWNLOADING) {
+        downloader_log(L_DEBUG, "No download in progress");
+        return;
+    }
+    downloader_log(L_INFO, "Terminating HTTP download");
+    ctx->error_code = ANJ_HTTP_DOWNLOADER_ERR_TERMINATED;
+    ctx->status = ANJ_HTTP_DOWNLOADER_STATUS_FINISHING;
+}
+
+int anj_http_downloader_disconnect(anj_http_downloader_t *ctx) {
+    assert(ctx);
+    if (download_in_progress(ctx)) {
+        return ANJ_HTTP_DOWNLOADER_ERR_IN_PROGRESS;
+    }
+    return close_connection(ctx);
+}
+
+#endif // ANJ_WITH_HTTP_DOWNLOADER
@@ -67,6 +67,71 @@ size_t anj_base64_estimate_decoded_size(size_t input_length) {
     return 3 * ((input_length + 3) / 4);
 }
 
+#    ifdef ANJ_WITH_BASE64_FAST_PATH
+#        define BASE64_INVALID_CHAR 0xFF
+
+/* Encodes all complete 3-byte groups of input, returns number of bytes
+ * consumed. */
+static size_t encode_triplets(char *out,
+                              const uint8_t *input,
+                              size_t input_length,
+                              const char *alphabet) {
+    size_t full_length = input_length - input_length % 3;
+    for (size_t i = 0; i < full_length; i += 3) {
+        uint32_t group = ((uint32_t) input[i] << 16)
+                         | ((uint32_t) input[i + 1] << 8) | input[i + 2];
+        *out++ = alphabet[(group >> 18) & 0x3F];
+        *out++ = alphabet[(group >> 12) & 0x3F];
+        *out++ = alphabet[(group >> 6) & 0x3F];
+        *out++ = alphabet[group & 0x3F];
+    }
+    return full_length;
+}
+
+static void build_decode_lookup(uint8_t *lookup, anj_base64_config_t config) {
+    memset(lookup, BASE64_INVALID_CHAR, 256);
+    // iterate backwards so that the first occurrence wins, like in memchr()
+    for (uint8_t i = 64; i > 0; i--) {
+        lookup[(uint8_t) config.alphabet[i - 1]] = (uint8_t) (i - 1);
+    }
+    // characters below are handled by the per-character path
+    lookup[0] = BASE64_INVALID_CHAR;
+    lookup[(uint8_t) config.padding_char] = BASE64_INVALID_CHAR;
+    for (const char *ws = " \t\n\v\f\r"; *ws; ws++) {
+        lookup[(uint8_t) *ws] = BASE64_INVALID_CHAR;
+    }
+}
+
+/* Decodes consecutive groups of 4 alphabet characters, stops at the first
+ * character that needs the per-character path (whitespace, padding, invalid
+ * character or end of data) or when there is no space left in the output. */
+static const uint8_t *decode_quads(const uint8_t *lookup,
+                                   const uint8_t *current,
+                                   const uint8_t *end,
+                                   uint8_t *out,
+                                   size_t *out_length,
+                                   size_t out_size) {
+    // the per-character path checks the space before each character, so the
+    // whole group requires space for all 3 bytes it produces
+    while (out_size - *out_length >= 3 && end - current >= 4) {
+        uint8_t a, b, c, d;
+        if ((a = lookup[current[0]]) == BASE64_INVALID_CHAR
+                || (b = lookup[current[1]]) == BASE64_INVALID_CHAR
+                || (c = lookup[current[2]]) == BASE64_INVALID_CHAR
+                || (d = lookup[current[3]]) == BASE64_INVALID_CHAR) {
+            break;
+        }
+        uint32_t group = ((uint32_t) a << 18) | ((uint32_t) b << 12)
+                         | ((uint32_t) c << 6) | d;
+        out[(*out_length)++] = (uint8_t) (group >> 16);
+        out[(*out_length)++] = (uint8_t) (group >> 8);
+        out[(*out_length)++] = (uint8_t) group;
+        current += 4;
+    }
+    return current;
+}
+#    endif // ANJ_WITH_BASE64_FAST_PATH
+
 int anj_base64_encode_custom(char *out,
                              size_t out_length,
                              const uint8_t *input,
@@ -81,7 +146,13 @@ int anj_base64_encode_custom(char *out,
         return -1;
     }
 
-    for (i = 0; i < input_length; ++i) {
+#    ifdef ANJ_WITH_BASE64_FAST_PATH
+    i = encode_triplets(out, input, input_length, config.alphabet);
+    out += i / 3 * 4;
+#    else  // ANJ_WITH_BASE64_FAST_PATH
+    i = 0;
+#    endif // ANJ_WITH_BASE64_FAST_PATH
+    for (; i < input_length; ++i) {
         num = input[i];
         if (i % 3 == 0) {
             *out++ = config.alphabet[num >> 2];
@@ -119,20 +190,48 @@ int anj_base64_decode_custom(size_t *out_bytes_decoded,
                              size_t out_size,
                              const char *b64_data,
                              anj_base64_config_t config) {
+    return anj_base64_decode_custom_n(out_bytes_decoded, out, out_size,
+                                      b64_data, strlen(b64_data), config);
+}
 
+int anj_base64_decode_custom_n(size_t *out_bytes_decoded,
+                               uint8_t *out,
+                               size_t out_size,
+                               const char *b64_data,
+                               size_t b64_length,
+                               anj_base64_config_t config) {
     uint32_t accumulator = 0;
     uint8_t bits = 0;
     const uint8_t *current = (const uint8_t *) b64_data;
+    const uint8_t *const end = current + b64_length;
     size_t out_length = 0;
     size_t padding = 0;
+#    ifdef ANJ_WITH_BASE64_FAST_PATH
+    uint8_t lookup[256];
+    build_decode_lookup(lookup, config);
+#    endif // ANJ_WITH_BASE64_FAST_PATH
 
-    while (*current) {
+    while (current != end) {
+#    ifdef ANJ_WITH_BASE64_FAST_PATH
+        // groups of 4 characters are aligned to output bytes only if no bits
+        // are left in the accumulator
+        if (!bits && !padding) {
+            current = decode_quads(lookup, current, end, out, &out_length,
+                                   out_size);
+            if (current == end) {
+                break;
+            }
+        }
+#    endif // ANJ_WITH_BASE64_FAST_PATH
         int ch = *current++;
 
         if (out_length >= out_size) {
             return -1;
         }
-        if (isspace(ch)) {
+        if (!ch) {
+            // would be taken for padding if padding_char is not set
+            return -1;
+        } else if (isspace(ch)) {
             if (config.allow_whitespace) {
                 continue;
             } else {
@@ -207,6 +207,21 @@ int anj_base64_decode_custom(size_t *out_bytes_decoded,
                              const char *input,
                              anj_base64_config_t config);
 
+/**
+ * Does the same as @ref anj_base64_decode_custom, except that @p input is not
+ * null-terminated, but @p input_length bytes long. Null characters in the input
+ * are invalid.
+ *
+ * @p out may point to the same buffer as @p input, the data is then decoded in
+ * place.
+ */
+int anj_base64_decode_custom_n(size_t *out_bytes_decoded,
+                               uint8_t *out,
+                               size_t out_length,
+                               const char *input,
+                               size_t input_length,
+                               anj_base64_config_t config);
+
 /**
  * Decodes specified base64 input.
  *
@@ -43,11 +43,27 @@ static int fill_prebuffer(_anj_cbor_ll_decoder_t *ctx, uint8_t min_size) {
     if (ctx->prebuffer_size - ctx->prebuffer_offset >= min_size) {
         return 0;
     }
+    if (ctx->input_last
+            && (ctx->window != ctx->prebuffer
+                || ctx->prebuffer_offset == ctx->prebuffer_size)) {
+        // The rest of the payload is already in the input buffer, so there is
+        // no need to copy anything - the window is moved over the input.
+        if (ctx->window != ctx->prebuffer) {
+            ctx->input -= ctx->prebuffer_size - ctx->prebuffer_offset;
+        }
+        ctx->window = ctx->input;
+        ctx->prebuffer_size = (uint8_t) ANJ_MIN(
+                (size_t) UINT8_MAX, (size_t) (ctx->input_end - ctx->input));
+        ctx->prebuffer_offset = 0;
+        ctx->input += ctx->prebuffer_size;
+        return 0;
+    }
+    assert(ctx->window == ctx->prebuffer);
     if (ctx->prebuffer_offset) {
         ctx->prebuffer_size -= ctx->prebuffer_offset;
         if (ctx->prebuffer_size) {
             memmove(ctx->prebuffer,
-                    ctx->prebuffer + ctx->prebuffer_offset,
+                    ctx->window + ctx->prebuffer_offset,
                     ctx->prebuffer_size);
         }
         ctx->prebuffer_offset = 0;
@@ -210,7 +226,7 @@ static int preprocess_next_value(_anj_cbor_ll_decoder_t *ctx) {
             return 0;
         }
 
-        uint8_t byte = ctx->prebuffer[ctx->prebuffer_offset++];
+        uint8_t byte = ctx->window[ctx->prebuffer_offset++];
         if (byte == CBOR_INDEFINITE_STRUCTURE_BREAK) {
             /* end of the indefinite map, array or byte/text string */
 #    if _ANJ_MAX_CBOR_NEST_STACK_SIZE > 0
@@ -360,36 +376,18 @@ static int parse_uint(_anj_cbor_ll_decoder_t *ctx, uint64_t *out_value) {
     if (result) {
         return result;
     }
-    union {
-        uint8_t u8;
-        uint16_t u16;
-        uint32_t u32;
-        uint64_t u64;
-    } value;
     if (ctx->prebuffer_offset + ext_len_size > ctx->prebuffer_size) {
         assert(ctx->input_last);
         ctx->state = ANJ_CBOR_LL_DECODER_STATE_ERROR;
         return _ANJ_IO_ERR_FORMAT;
     }
-    memcpy(&value, ctx->prebuffer + ctx->prebuffer_offset, ext_len_size);
+    const uint8_t *bytes = ctx->window + ctx->prebuffer_offset;
     ctx->prebuffer_offset += ext_len_size;
-    switch (ext_len_size) {
-    case 1:
-        *out_value = value.u8;
-        return 0;
-    case 2:
-        *out_value = _anj_convert_be16(value.u16);
-        return 0;
-    case 4:
-        *out_value = _anj_convert_be32(value.u32);
-        return 0;
-    case 8:
-        *out_value = _anj_convert_be64(value.u64);
-        return 0;
-    default:
-        ANJ_UNREACHABLE("unsupported extended length size");
-        return _ANJ_IO_ERR_LOGIC;
+    *out_value = 0;
+    for (uint8_t i = 0; i < ext_len_size; i++) {
+        *out_value = (*out_value << 8) | bytes[i];
     }
+    return 0;
 }
 
 static int parse_size(_anj_cbor_ll_decoder_t *ctx, size_t *out_value) {
@@ -587,7 +585,7 @@ static int decode_float(_anj_cbor_ll_decoder_t *ctx, float *out_value) {
             result = _ANJ_IO_ERR_FORMAT;
         } else {
             memcpy(&value,
-                   ctx->prebuffer + ctx->prebuffer_offset,
+                   ctx->window + ctx->prebuffer_offset,
                    sizeof(value));
             ctx->prebuffer_offset += sizeof(value);
             *out_value = decode_half_float(_anj_convert_be16(value));
@@ -605,7 +603,7 @@ static int decode_float(_anj_cbor_ll_decoder_t *ctx, float *out_value) {
             result = _ANJ_IO_ERR_FORMAT;
         } else {
             memcpy(&value,
-                   ctx->prebuffer + ctx->prebuffer_offset,
+                   ctx->window + ctx->prebuffer_offset,
                    sizeof(value));
             ctx->prebuffer_offset += sizeof(value);
             *out_value = _anj_ntohf(value);
@@ -760,7 +758,7 @@ static int decode_double(_anj_cbor_ll_decoder_t *ctx, double *out_value) {
                 result = _ANJ_IO_ERR_FORMAT;
             } else {
                 memcpy(&value,
-                       ctx->prebuffer + ctx->prebuffer_offset,
+                       ctx->window + ctx->prebuffer_offset,
                        sizeof(value));
                 ctx->prebuffer_offset += sizeof(value);
                 *out_value = _anj_ntohd(value);
@@ -1200,7 +1198,7 @@ static int bytes_get_some_impl(_anj_cbor_ll_decoder_bytes_ctx_t *bytes_ctx,
             if (can_rewind_by < prebuffered_bytes) {
                 // Can't "unbuffer everything" - next payload already provided
                 // return the prebuffer
-                *out_buf = ctx->prebuffer + ctx->prebuffer_offset;
+                *out_buf = ctx->window + ctx->prebuffer_offset;
                 *out_buf_size =
                         ANJ_MIN(prebuffered_bytes, bytes_ctx->bytes_available);
                 ctx->prebuffer_offset += (uint8_t) *out_buf_size;
@@ -1244,6 +1242,7 @@ static int bytes_get_some_impl(_anj_cbor_ll_decoder_bytes_ctx_t *bytes_ctx,
 
 void anj_cbor_ll_decoder_init(_anj_cbor_ll_decoder_t *ctx) {
     memset(ctx, 0, sizeof(*ctx));
+    ctx->window = ctx->prebuffer;
     ctx->state = ANJ_CBOR_LL_DECODER_STATE_OK;
     ctx->needs_preprocessing = true;
     ctx->after_tag = false;
@@ -27,8 +27,13 @@
 // The size of the internal_buff has been calculated so that a
 // single record never exceeds its size.
 int _anj_cbor_encode_value(_anj_io_buff_t *buff_ctx,
-                           const anj_io_out_entry_t *entry) {
+                           const anj_io_out_entry_t *entry,
+                           bool shortest_float) {
     size_t buf_pos = buff_ctx->bytes_in_internal_buff;
+    uint8_t *record_buff = _anj_io_record_buff(buff_ctx);
+#    ifndef ANJ_WITH_CBOR_ENCODE_SHORTEST_FLOAT
+    (void) shortest_float;
+#    endif // ANJ_WITH_CBOR_ENCODE_SHORTEST_FLOAT
 
     switch (entry->type) {
     case ANJ_DATA_TYPE_BYTES: {
@@ -39,7 +44,7 @@ int _anj_cbor_encode_value(_anj_io_buff_t *buff_ctx,
             return _ANJ_IO_ERR_INPUT_ARG;
         }
         buf_pos += anj_cbor_ll_bytes_begin(
-                &buff_ctx->internal_buff[buf_pos],
+                &record_buff[buf_pos],
                 entry->value.bytes_or_string.chunk_length);
         buff_ctx->is_extended_type = true;
         buff_ctx->remaining_bytes = entry->value.bytes_or_string.chunk_length;
@@ -58,7 +63,7 @@ int _anj_cbor_encode_value(_anj_io_buff_t *buff_ctx,
             string_length =
                     strlen((const char *) entry->value.bytes_or_string.data);
         }
-        buf_pos += anj_cbor_ll_string_begin(&buff_ctx->internal_buff[buf_pos],
+        buf_pos += anj_cbor_ll_string_begin(&record_buff[buf_pos],
                                             string_length);
         buff_ctx->is_extended_type = true;
         buff_ctx->remaining_bytes = string_length;
@@ -69,8 +74,7 @@ int _anj_cbor_encode_value(_anj_io_buff_t *buff_ctx,
         if (!entry->value.external_data.get_external_data) {
             return _ANJ_IO_ERR_INPUT_ARG;
         }
-        buf_pos += anj_cbor_ll_indefinite_bytes_begin(
-                &buff_ctx->internal_buff[buf_pos]);
+        buf_pos += anj_cbor_ll_indefinite_bytes_begin(&record_buff[buf_pos]);
         buff_ctx->is_extended_type = true;
         // HACK: for ANJ_WITH_EXTERNAL_* types set it to constant value
         // because we don't know the length
@@ -81,32 +85,38 @@ int _anj_cbor_encode_value(_anj_io_buff_t *buff_ctx,
         if (!entry->value.external_data.get_external_data) {
             return _ANJ_IO_ERR_INPUT_ARG;
         }
-        buf_pos += anj_cbor_ll_indefinite_string_begin(
-                &buff_ctx->internal_buff[buf_pos]);
+        buf_pos += anj_cbor_ll_indefinite_string_begin(&record_buff[buf_pos]);
         buff_ctx->is_extended_type = true;
         buff_ctx->remaining_bytes = 1;
         break;
     }
 #    endif // ANJ_WITH_EXTERNAL_DATA
     case ANJ_DATA_TYPE_TIME: {
-        buf_pos += anj_cbor_ll_encode_tag(&buff_ctx->internal_buff[buf_pos],
+        buf_pos += anj_cbor_ll_encode_tag(&record_buff[buf_pos],
                                           CBOR_TAG_INTEGER_DATE_TIME);
-        buf_pos += anj_cbor_ll_encode_int(&buff_ctx->internal_buff[buf_pos],
+        buf_pos += anj_cbor_ll_encode_int(&record_buff[buf_pos],
                                           entry->value.time_value);
         break;
     }
     case ANJ_DATA_TYPE_INT: {
-        buf_pos += anj_cbor_ll_encode_int(&buff_ctx->internal_buff[buf_pos],
+        buf_pos += anj_cbor_ll_encode_int(&record_buff[buf_pos],
                                           entry->value.int_value);
         break;
     }
     case ANJ_DATA_TYPE_DOUBLE: {
-        buf_pos += anj_cbor_ll_encode_double(&buff_ctx->internal_buff[buf_pos],
+#    ifdef ANJ_WITH_CBOR_ENCODE_SHORTEST_FLOAT
+        if (shortest_float) {
+            buf_pos += anj_cbor_ll_encode_double_shortest(
+                    &record_buff[buf_pos], entry->value.double_value);
+            break;
+        }
+#    endif // ANJ_WITH_CBOR_ENCODE_SHORTEST_FLOAT
+        buf_pos += anj_cbor_ll_encode_double(&record_buff[buf_pos],
                                              entry->value.double_value);
         break;
     }
     case ANJ_DATA_TYPE_BOOL: {
-        buf_pos += anj_cbor_ll_encode_bool(&buff_ctx->internal_buff[buf_pos],
+        buf_pos += anj_cbor_ll_encode_bool(&record_buff[buf_pos],
                                            entry->value.bool_value);
         break;
     }
@@ -117,7 +127,7 @@ int _anj_cbor_encode_value(_anj_io_buff_t *buff_ctx,
         break;
     }
     case ANJ_DATA_TYPE_UINT: {
-        buf_pos += anj_cbor_ll_encode_uint(&buff_ctx->internal_buff[buf_pos],
+        buf_pos += anj_cbor_ll_encode_uint(&record_buff[buf_pos],
                                            entry->value.uint_value);
         break;
     }
@@ -140,7 +150,7 @@ int _anj_cbor_out_ctx_new_entry(_anj_io_out_ctx_t *ctx,
         return _ANJ_IO_ERR_LOGIC;
     }
 
-    int res = _anj_cbor_encode_value(&ctx->buff, entry);
+    int res = _anj_cbor_encode_value(&ctx->buff, entry, false);
     if (res) {
         return res;
     }
@@ -50,8 +50,14 @@ int _anj_get_lwm2m_cbor_map_ends(_anj_io_out_ctx_t *ctx,
 #    endif // ANJ_WITH_LWM2M_CBOR
 
 #    if defined(ANJ_WITH_CBOR) || defined(ANJ_WITH_LWM2M_CBOR)
+/**
+ * Encodes the value of @p entry. If @p shortest_float is set and
+ * ANJ_WITH_CBOR_ENCODE_SHORTEST_FLOAT is enabled, doubles are encoded with
+ * @ref anj_cbor_ll_encode_double_shortest.
+ */
 int _anj_cbor_encode_value(_anj_io_buff_t *buff_ctx,
-                           const anj_io_out_entry_t *entry);
+                           const anj_io_out_entry_t *entry,
+                           bool shortest_float);
 #    endif // defined(ANJ_WITH_CBOR) || defined(ANJ_WITH_LWM2M_CBOR)
 
 #endif // SRC_ANJ_IO_CBOR_ENCODER_H
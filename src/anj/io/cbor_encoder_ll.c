@@ -15,6 +15,10 @@
 #include <stdint.h>
 #include <string.h>
 
+#ifdef ANJ_WITH_CBOR_ENCODE_SHORTEST_FLOAT
+#    include <math.h>
+#endif // ANJ_WITH_CBOR_ENCODE_SHORTEST_FLOAT
+
 #include "../utils.h"
 #include "cbor_encoder_ll.h"
 #include "internal.h"
@@ -34,35 +38,29 @@ write_cbor_header(void *buffer, cbor_major_type_t major_type, uint8_t value) {
 static size_t encode_type_and_number(void *buffer,
                                      cbor_major_type_t major_type,
                                      uint64_t value) {
-    size_t bytes_written = 1;
+    uint8_t *out = (uint8_t *) buffer;
+    size_t value_length;
     if (value < 24) {
-        write_cbor_header(buffer, major_type, (uint8_t) value);
+        return write_cbor_header(buffer, major_type, (uint8_t) value);
     } else if (value <= UINT8_MAX) {
-        uint8_t portable = (uint8_t) value;
         write_cbor_header(buffer, major_type, CBOR_EXT_LENGTH_1BYTE);
-        write_to_buffer(&((uint8_t *) buffer)[bytes_written], &portable,
-                        sizeof(portable));
-        bytes_written += sizeof(portable);
+        value_length = 1;
     } else if (value <= UINT16_MAX) {
-        uint16_t portable = _anj_convert_be16((uint16_t) value);
         write_cbor_header(buffer, major_type, CBOR_EXT_LENGTH_2BYTE);
-        write_to_buffer(&((uint8_t *) buffer)[bytes_written], &portable,
-                        sizeof(portable));
-        bytes_written += sizeof(portable);
+        value_length = 2;
     } else if (value <= UINT32_MAX) {
-        uint32_t portable = _anj_convert_be32((uint32_t) value);
         write_cbor_header(buffer, major_type, CBOR_EXT_LENGTH_4BYTE);
-        write_to_buffer(&((uint8_t *) buffer)[bytes_written], &portable,
-                        sizeof(portable));
-        bytes_written += sizeof(portable);
+        value_length = 4;
     } else {
-        uint64_t portable = _anj_convert_be64((uint64_t) value);
         write_cbor_header(buffer, major_type, CBOR_EXT_LENGTH_8BYTE);
-        write_to_buffer(&((uint8_t *) buffer)[bytes_written], &portable,
-                        sizeof(portable));
-        bytes_written += sizeof(portable);
+        value_length = 8;
     }
-    return bytes_written;
+    // store big-endian bytes directly, independently of the host byte order
+    for (size_t i = value_length; i > 0; i--) {
+        out[i] = (uint8_t) value;
+        value >>= 8;
+    }
+    return value_length + 1;
 }
 
 size_t anj_cbor_ll_encode_uint(void *buffer, uint64_t value) {
@@ -111,6 +109,90 @@ size_t anj_cbor_ll_encode_double(void *buffer, double value) {
     return bytes_written;
 }
 
+#ifdef ANJ_WITH_CBOR_ENCODE_SHORTEST_FLOAT
+/* Converts a value that is exactly representable as a float to the IEEE 754
+ * half-precision format, if that can be done without losing any bits. NaNs
+ * are all mapped to the canonical half-precision quiet NaN. */
+static bool float_to_half_exact(float value, uint16_t *out_half) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint16_t sign = (uint16_t) ((bits >> 16) & 0x8000);
+    int32_t exponent = (int32_t) ((bits >> 23) & 0xFF);
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    if (exponent == 0xFF) {
+        *out_half = (uint16_t) (sign | (mantissa ? 0x7E00 : 0x7C00));
+        return true;
+    }
+    if (!exponent) {
+        // zero is fine, float subnormals are way below the half range
+        *out_half = sign;
+        return !mantissa;
+    }
+    exponent -= 127;
+    if (exponent > 15 || exponent < -24) {
+        return false;
+    }
+    if (exponent >= -14) {
+        if (mantissa & 0x1FFF) {
+            return false;
+        }
+        *out_half = (uint16_t) (sign | ((uint32_t) (exponent + 15) << 10)
+                                | (mantissa >> 13));
+        return true;
+    }
+    // half-precision subnormal: implicit leading bit becomes explicit
+    uint32_t shift = (uint32_t) (-1 - exponent);
+    mantissa |= 0x800000;
+    if (mantissa & ((UINT32_C(1) << shift) - 1)) {
+        return false;
+    }
+    *out_half = (uint16_t) (sign | (mantissa >> shift));
+    return true;
+}
+
+static size_t encode_half(void *buffer, uint16_t half) {
+    uint8_t *out = (uint8_t *) buffer;
+    size_t bytes_written =
+            write_cbor_header(buffer, CBOR_MAJOR_TYPE_FLOAT_OR_SIMPLE_VALUE,
+                              CBOR_EXT_LENGTH_2BYTE);
+    out[bytes_written++] = (uint8_t) (half >> 8);
+    out[bytes_written++] = (uint8_t) half;
+    return bytes_written;
+}
+
+size_t anj_cbor_ll_encode_double_shortest(void *buffer, double value) {
+    size_t float_length;
+    uint16_t half = 0;
+    if (isnan(value)) {
+        return encode_half(buffer, 0x7E00);
+    }
+    if (((float) value) != value) {
+        float_length = 9;
+    } else if (float_to_half_exact((float) value, &half)) {
+        float_length = 3;
+    } else {
+        float_length = 5;
+    }
+
+    // -0.0 compares equal to 0, but the integer would lose the sign
+    if (value >= (double) INT64_MIN && value < -(double) INT64_MIN
+            && value == (double) (int64_t) value
+            && !(value == 0.0 && signbit(value))) {
+        uint8_t int_buff[ANJ_CBOR_LL_SINGLE_CALL_MAX_LEN];
+        size_t int_length = anj_cbor_ll_encode_int(int_buff, (int64_t) value);
+        if (int_length <= float_length) {
+            write_to_buffer(buffer, int_buff, int_length);
+            return int_length;
+        }
+    }
+    if (float_length == 3) {
+        return encode_half(buffer, half);
+    }
+    return anj_cbor_ll_encode_double(buffer, value);
+}
+#endif // ANJ_WITH_CBOR_ENCODE_SHORTEST_FLOAT
+
 size_t anj_cbor_ll_encode_tag(void *buff, uint64_t value) {
     return encode_type_and_number(buff, CBOR_MAJOR_TYPE_TAG, value);
 }
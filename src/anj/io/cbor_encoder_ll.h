@@ -12,6 +12,7 @@
 #ifndef SRC_ANJ_IO_CBOR_ENCODER_LL_H
 #    define SRC_ANJ_IO_CBOR_ENCODER_LL_H
 
+#    include <assert.h>
 #    include <stdbool.h>
 #    include <stddef.h>
 #    include <stdint.h>
@@ -45,6 +46,15 @@ size_t anj_cbor_ll_encode_float(void *buff, float value);
 
 size_t anj_cbor_ll_encode_double(void *buff, double value);
 
+#    ifdef ANJ_WITH_CBOR_ENCODE_SHORTEST_FLOAT
+/**
+ * Encodes @p value in the shortest form that decodes back to exactly the same
+ * value: an integer if the value is integral, otherwise a half, single or
+ * double precision float.
+ */
+size_t anj_cbor_ll_encode_double_shortest(void *buff, double value);
+#    endif // ANJ_WITH_CBOR_ENCODE_SHORTEST_FLOAT
+
 size_t anj_cbor_ll_encode_tag(void *buff, uint64_t value);
 
 size_t anj_cbor_ll_string_begin(void *buff, size_t size);
@@ -65,4 +75,43 @@ size_t anj_cbor_ll_indefinite_bytes_begin(void *buff);
 
 size_t anj_cbor_ll_indefinite_record_end(void *buff);
 
+/**
+ * Specialized variants for arguments known to be at most
+ * @ref ANJ_CBOR_LL_SMALL_VALUE_MAX, e.g. SenML labels, map sizes or short
+ * strings. Such values are stored directly in the initial byte, so these
+ * functions always write exactly one byte and, with a constant argument, are
+ * folded by the compiler into a single constant store.
+ */
+#    define ANJ_CBOR_LL_SMALL_VALUE_MAX 23
+
+#    define _ANJ_CBOR_LL_INITIAL_BYTE(Major_Type, Value) \
+        ((uint8_t) (((Major_Type) << 5) | (Value)))
+
+static inline size_t anj_cbor_ll_encode_small_uint(void *buff, uint8_t value) {
+    assert(value <= ANJ_CBOR_LL_SMALL_VALUE_MAX);
+    *(uint8_t *) buff = _ANJ_CBOR_LL_INITIAL_BYTE(0, value);
+    return 1;
+}
+
+static inline size_t anj_cbor_ll_encode_small_int(void *buff, int8_t value) {
+    assert(value >= -ANJ_CBOR_LL_SMALL_VALUE_MAX - 1
+           && value <= ANJ_CBOR_LL_SMALL_VALUE_MAX);
+    *(uint8_t *) buff = value >= 0 ? _ANJ_CBOR_LL_INITIAL_BYTE(0, value)
+                                   : _ANJ_CBOR_LL_INITIAL_BYTE(1, -(value + 1));
+    return 1;
+}
+
+static inline size_t anj_cbor_ll_small_string_begin(void *buff, uint8_t size) {
+    assert(size <= ANJ_CBOR_LL_SMALL_VALUE_MAX);
+    *(uint8_t *) buff = _ANJ_CBOR_LL_INITIAL_BYTE(3, size);
+    return 1;
+}
+
+static inline size_t anj_cbor_ll_small_definite_map_begin(void *buff,
+                                                          uint8_t items_count) {
+    assert(items_count <= ANJ_CBOR_LL_SMALL_VALUE_MAX);
+    *(uint8_t *) buff = _ANJ_CBOR_LL_INITIAL_BYTE(5, items_count);
+    return 1;
+}
+
 #endif // SRC_ANJ_IO_CBOR_ENCODER_LL_H
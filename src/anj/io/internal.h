@@ -21,6 +21,8 @@
 #    include "io.h"
 
 #    define CBOR_TAG_INTEGER_DATE_TIME 0x01
+#    define CBOR_TAG_STRINGREF 25
+#    define CBOR_TAG_STRINGREF_NAMESPACE 256
 
 /**
  * Enumeration for supported SenML labels. Their numeric values correspond to
@@ -97,6 +99,20 @@ typedef enum {
 
 void _anj_io_reset_internal_buff(_anj_io_buff_t *ctx);
 
+/**
+ * Returns the buffer in which the current record is to be encoded: the
+ * payload buffer set by @ref _anj_io_out_ctx_new_entry_direct, or
+ * <c>internal_buff</c> otherwise.
+ */
+static inline uint8_t *_anj_io_record_buff(_anj_io_buff_t *buff_ctx) {
+#    ifdef ANJ_WITH_DIRECT_PAYLOAD_ENCODING
+    if (buff_ctx->direct_buff) {
+        return buff_ctx->direct_buff;
+    }
+#    endif // ANJ_WITH_DIRECT_PAYLOAD_ENCODING
+    return buff_ctx->internal_buff;
+}
+
 size_t _anj_io_out_add_objlink(_anj_io_buff_t *buff_ctx,
                                size_t buf_pos,
                                anj_oid_t oid,
@@ -30,10 +30,37 @@
 #include "text_decoder.h"
 #include "text_encoder.h"
 #include "tlv_decoder.h"
+#include "tlv_encoder.h"
 
 ANJ_STATIC_ASSERT(_ANJ_IO_CTX_BUFFER_LENGTH >= ANJ_CBOR_LL_SINGLE_CALL_MAX_LEN,
                   CBOR_buffer_too_small);
 
+/*
+ * If a single encoder (decoder) is enabled, the per-record functions call it
+ * directly instead of switching on the Content-Format. The format of the
+ * context has already been checked to be a supported one when it was
+ * initialized.
+ */
+#if defined(ANJ_WITH_SENML_CBOR) && !defined(ANJ_WITH_LWM2M_CBOR) \
+        && !defined(ANJ_WITH_CBOR) && !defined(ANJ_WITH_PLAINTEXT)  \
+        && !defined(ANJ_WITH_OPAQUE) && !defined(ANJ_WITH_TLV_ENCODER)
+#    define IO_OUT_ONLY_SENML_CBOR
+#elif defined(ANJ_WITH_LWM2M_CBOR) && !defined(ANJ_WITH_SENML_CBOR) \
+        && !defined(ANJ_WITH_CBOR) && !defined(ANJ_WITH_PLAINTEXT)  \
+        && !defined(ANJ_WITH_OPAQUE) && !defined(ANJ_WITH_TLV_ENCODER)
+#    define IO_OUT_ONLY_LWM2M_CBOR
+#endif
+
+#if defined(ANJ_WITH_SENML_CBOR) && !defined(ANJ_WITH_LWM2M_CBOR) \
+        && !defined(ANJ_WITH_CBOR) && !defined(ANJ_WITH_PLAINTEXT)  \
+        && !defined(ANJ_WITH_OPAQUE) && !defined(ANJ_WITH_TLV)
+#    define IO_IN_ONLY_SENML_CBOR
+#elif defined(ANJ_WITH_LWM2M_CBOR) && !defined(ANJ_WITH_SENML_CBOR) \
+        && !defined(ANJ_WITH_CBOR) && !defined(ANJ_WITH_PLAINTEXT)  \
+        && !defined(ANJ_WITH_OPAQUE) && !defined(ANJ_WITH_TLV)
+#    define IO_IN_ONLY_LWM2M_CBOR
+#endif
+
 static const uint16_t supported_formats_list[] = {
 #ifdef ANJ_WITH_OPAQUE
     _ANJ_COAP_FORMAT_OPAQUE_STREAM,
@@ -48,8 +75,14 @@ static const uint16_t supported_formats_list[] = {
     _ANJ_COAP_FORMAT_OMA_LWM2M_CBOR,
 #endif // ANJ_WITH_LWM2M_CBOR
 #ifdef ANJ_WITH_SENML_CBOR
-    _ANJ_COAP_FORMAT_SENML_CBOR,     _ANJ_COAP_FORMAT_SENML_ETCH_CBOR
+    _ANJ_COAP_FORMAT_SENML_CBOR,     _ANJ_COAP_FORMAT_SENML_ETCH_CBOR,
 #endif // ANJ_WITH_SENML_CBOR
+#ifdef ANJ_WITH_SENML_CBOR_STRINGREF
+    _ANJ_COAP_FORMAT_SENML_CBOR_STRINGREF,
+#endif // ANJ_WITH_SENML_CBOR_STRINGREF
+#ifdef ANJ_WITH_TLV_ENCODER
+    _ANJ_COAP_FORMAT_OMA_LWM2M_TLV,
+#endif // ANJ_WITH_TLV_ENCODER
 };
 
 void _anj_io_reset_internal_buff(_anj_io_buff_t *ctx) {
@@ -58,6 +91,9 @@ void _anj_io_reset_internal_buff(_anj_io_buff_t *ctx) {
     ctx->bytes_in_internal_buff = 0;
     ctx->is_extended_type = false;
     ctx->remaining_bytes = 0;
+#ifdef ANJ_WITH_DIRECT_PAYLOAD_ENCODING
+    ctx->direct_buff = NULL;
+#endif // ANJ_WITH_DIRECT_PAYLOAD_ENCODING
 }
 
 static int
@@ -85,6 +121,14 @@ check_format(uint16_t given_format, size_t items_count, _anj_op_t op) {
                     && op != ANJ_OP_INF_CANCEL_OBSERVE))) {
         return _ANJ_IO_ERR_FORMAT;
     }
+#ifdef ANJ_WITH_TLV_ENCODER
+    // TLV is allowed only for responses targeting a single Object Instance
+    if (given_format == _ANJ_COAP_FORMAT_OMA_LWM2M_TLV
+            && op != ANJ_OP_DM_READ && op != ANJ_OP_INF_OBSERVE
+            && op != ANJ_OP_INF_CANCEL_OBSERVE) {
+        return _ANJ_IO_ERR_UNSUPPORTED_FORMAT;
+    }
+#endif // ANJ_WITH_TLV_ENCODER
     return 0;
 }
 
@@ -99,6 +143,33 @@ static uint16_t choose_format(uint16_t given_format) {
 #endif // ANJ_WITH_LWM2M_CBOR
 }
 
+#ifdef ANJ_WITH_SMALLEST_FORMAT
+uint16_t _anj_io_out_smallest_format(anj_data_type_t type) {
+    if (type & ANJ_DATA_TYPE_BYTES) {
+#    ifdef ANJ_WITH_OPAQUE
+        return _ANJ_COAP_FORMAT_OPAQUE_STREAM;
+#    endif // ANJ_WITH_OPAQUE
+    } else if (type & (ANJ_DATA_TYPE_STRING | ANJ_DATA_TYPE_OBJLNK)) {
+#    ifdef ANJ_WITH_PLAINTEXT
+        return _ANJ_COAP_FORMAT_PLAINTEXT;
+#    endif // ANJ_WITH_PLAINTEXT
+    }
+#    ifdef ANJ_WITH_CBOR
+    // at most 9 bytes for any number, 1 byte for a boolean, plus the length of
+    // the string header
+    return _ANJ_COAP_FORMAT_CBOR;
+#    else  // ANJ_WITH_CBOR
+#        ifdef ANJ_WITH_PLAINTEXT
+    // Plain Text bytes are Base64 encoded, so they would grow by one third
+    if (!(type & ANJ_DATA_TYPE_BYTES)) {
+        return _ANJ_COAP_FORMAT_PLAINTEXT;
+    }
+#        endif // ANJ_WITH_PLAINTEXT
+    return _ANJ_COAP_FORMAT_NOT_DEFINED;
+#    endif // ANJ_WITH_CBOR
+}
+#endif // ANJ_WITH_SMALLEST_FORMAT
+
 static int get_cbor_bytes_string_data(_anj_io_buff_t *buff_ctx,
                                       const anj_io_out_entry_t *entry,
                                       void *out_buff,
@@ -372,7 +443,12 @@ int _anj_io_out_ctx_init(_anj_io_out_ctx_t *ctx,
         // choose_format() always returns LwM2M_CBOR or SenML_CBOR, so in
         // practical use, empty read is only possible for hierarchical formats,
         // read on resource that not exists will result in 4.04 response
-        if (ctx->format == _ANJ_COAP_FORMAT_SENML_CBOR) {
+        if (ctx->format == _ANJ_COAP_FORMAT_SENML_CBOR
+#ifdef ANJ_WITH_SENML_CBOR_STRINGREF
+                // no strings, so no namespace is needed
+                || ctx->format == _ANJ_COAP_FORMAT_SENML_CBOR_STRINGREF
+#endif // ANJ_WITH_SENML_CBOR_STRINGREF
+        ) {
             // empty CBOR array
             ctx->buff.internal_buff[0] = 0x80;
             ctx->buff.bytes_in_internal_buff = 1;
@@ -403,6 +479,9 @@ int _anj_io_out_ctx_init(_anj_io_out_ctx_t *ctx,
 #ifdef ANJ_WITH_SENML_CBOR
     case _ANJ_COAP_FORMAT_SENML_CBOR:
     case _ANJ_COAP_FORMAT_SENML_ETCH_CBOR:
+#    ifdef ANJ_WITH_SENML_CBOR_STRINGREF
+    case _ANJ_COAP_FORMAT_SENML_CBOR_STRINGREF:
+#    endif // ANJ_WITH_SENML_CBOR_STRINGREF
         return _anj_senml_cbor_encoder_init(ctx, &path, items_count,
                                             encode_time);
 #endif // ANJ_WITH_SENML_CBOR
@@ -410,6 +489,10 @@ int _anj_io_out_ctx_init(_anj_io_out_ctx_t *ctx,
     case _ANJ_COAP_FORMAT_OMA_LWM2M_CBOR:
         return _anj_lwm2m_cbor_encoder_init(ctx, &path, items_count);
 #endif // ANJ_WITH_LWM2M_CBOR
+#ifdef ANJ_WITH_TLV_ENCODER
+    case _ANJ_COAP_FORMAT_OMA_LWM2M_TLV:
+        return _anj_tlv_encoder_init(ctx, &path);
+#endif // ANJ_WITH_TLV_ENCODER
     default:
         // not implemented yet
         return _ANJ_IO_ERR_UNSUPPORTED_FORMAT;
@@ -425,36 +508,50 @@ int _anj_io_out_ctx_new_entry(_anj_io_out_ctx_t *ctx,
         return _ANJ_IO_ERR_LOGIC;
     }
 
+#if defined(IO_OUT_ONLY_SENML_CBOR)
+    res = _anj_senml_cbor_out_ctx_new_entry(ctx, entry);
+#elif defined(IO_OUT_ONLY_LWM2M_CBOR)
+    res = _anj_lwm2m_cbor_out_ctx_new_entry(ctx, entry);
+#else
     switch (ctx->format) {
-#ifdef ANJ_WITH_PLAINTEXT
+#    ifdef ANJ_WITH_PLAINTEXT
     case _ANJ_COAP_FORMAT_PLAINTEXT:
         res = _anj_text_out_ctx_new_entry(ctx, entry);
         break;
-#endif // ANJ_WITH_PLAINTEXT
-#ifdef ANJ_WITH_OPAQUE
+#    endif // ANJ_WITH_PLAINTEXT
+#    ifdef ANJ_WITH_OPAQUE
     case _ANJ_COAP_FORMAT_OPAQUE_STREAM:
         res = _anj_opaque_out_ctx_new_entry(ctx, entry);
         break;
-#endif // ANJ_WITH_OPAQUE
-#ifdef ANJ_WITH_CBOR
+#    endif // ANJ_WITH_OPAQUE
+#    ifdef ANJ_WITH_CBOR
     case _ANJ_COAP_FORMAT_CBOR:
         res = _anj_cbor_out_ctx_new_entry(ctx, entry);
         break;
-#endif // ANJ_WITH_CBOR
-#ifdef ANJ_WITH_SENML_CBOR
+#    endif // ANJ_WITH_CBOR
+#    ifdef ANJ_WITH_SENML_CBOR
     case _ANJ_COAP_FORMAT_SENML_CBOR:
     case _ANJ_COAP_FORMAT_SENML_ETCH_CBOR:
+#        ifdef ANJ_WITH_SENML_CBOR_STRINGREF
+    case _ANJ_COAP_FORMAT_SENML_CBOR_STRINGREF:
+#        endif // ANJ_WITH_SENML_CBOR_STRINGREF
         res = _anj_senml_cbor_out_ctx_new_entry(ctx, entry);
         break;
-#endif // ANJ_WITH_SENML_CBOR
-#ifdef ANJ_WITH_LWM2M_CBOR
+#    endif // ANJ_WITH_SENML_CBOR
+#    ifdef ANJ_WITH_LWM2M_CBOR
     case _ANJ_COAP_FORMAT_OMA_LWM2M_CBOR:
         res = _anj_lwm2m_cbor_out_ctx_new_entry(ctx, entry);
         break;
-#endif // ANJ_WITH_LWM2M_CBOR
+#    endif // ANJ_WITH_LWM2M_CBOR
+#    ifdef ANJ_WITH_TLV_ENCODER
+    case _ANJ_COAP_FORMAT_OMA_LWM2M_TLV:
+        res = _anj_tlv_out_ctx_new_entry(ctx, entry);
+        break;
+#    endif // ANJ_WITH_TLV_ENCODER
     default:
         break;
     }
+#endif // defined(IO_OUT_ONLY_SENML_CBOR)
 
 #ifdef ANJ_WITH_EXTERNAL_DATA
     if (!res && (entry->type & ANJ_DATA_TYPE_FLAG_EXTERNAL)
@@ -470,6 +567,60 @@ int _anj_io_out_ctx_new_entry(_anj_io_out_ctx_t *ctx,
     return res;
 }
 
+#ifdef ANJ_WITH_DIRECT_PAYLOAD_ENCODING
+static bool is_direct_encoding_supported(uint16_t format) {
+#    if defined(IO_OUT_ONLY_SENML_CBOR) || defined(IO_OUT_ONLY_LWM2M_CBOR)
+    (void) format;
+    return true;
+#    else  // defined(IO_OUT_ONLY_SENML_CBOR) ||
+           // defined(IO_OUT_ONLY_LWM2M_CBOR)
+    switch (format) {
+#        ifdef ANJ_WITH_CBOR
+    case _ANJ_COAP_FORMAT_CBOR:
+#        endif // ANJ_WITH_CBOR
+#        ifdef ANJ_WITH_SENML_CBOR
+    case _ANJ_COAP_FORMAT_SENML_CBOR:
+    case _ANJ_COAP_FORMAT_SENML_ETCH_CBOR:
+#        endif // ANJ_WITH_SENML_CBOR
+#        ifdef ANJ_WITH_SENML_CBOR_STRINGREF
+    case _ANJ_COAP_FORMAT_SENML_CBOR_STRINGREF:
+#        endif // ANJ_WITH_SENML_CBOR_STRINGREF
+#        ifdef ANJ_WITH_LWM2M_CBOR
+    case _ANJ_COAP_FORMAT_OMA_LWM2M_CBOR:
+#        endif // ANJ_WITH_LWM2M_CBOR
+        return true;
+    default:
+        return false;
+    }
+#    endif // defined(IO_OUT_ONLY_SENML_CBOR) ||
+           // defined(IO_OUT_ONLY_LWM2M_CBOR)
+}
+
+int _anj_io_out_ctx_new_entry_direct(_anj_io_out_ctx_t *ctx,
+                                     const anj_io_out_entry_t *entry,
+                                     void *out_buff,
+                                     size_t out_buff_len) {
+    assert(ctx && entry && out_buff);
+    _anj_io_buff_t *buff_ctx = &ctx->buff;
+
+    // the record must fit in out_buff as a whole, otherwise its remainder
+    // would have to be kept for the next block
+    if (!is_direct_encoding_supported(ctx->format) || ctx->empty
+            || buff_ctx->remaining_bytes || buff_ctx->offset
+            || out_buff_len < _ANJ_IO_CTX_BUFFER_LENGTH) {
+        return _anj_io_out_ctx_new_entry(ctx, entry);
+    }
+    // LwM2M CBOR opens the top-level map in the encoder initialization
+    memcpy(out_buff, buff_ctx->internal_buff, buff_ctx->bytes_in_internal_buff);
+    buff_ctx->direct_buff = (uint8_t *) out_buff;
+    int res = _anj_io_out_ctx_new_entry(ctx, entry);
+    if (res) {
+        buff_ctx->direct_buff = NULL;
+    }
+    return res;
+}
+#endif // ANJ_WITH_DIRECT_PAYLOAD_ENCODING
+
 void _anj_io_get_payload_from_internal_buff(_anj_io_buff_t *buff_ctx,
                                             void *out_buff,
                                             size_t out_buff_len,
@@ -483,26 +634,77 @@ void _anj_io_get_payload_from_internal_buff(_anj_io_buff_t *buff_ctx,
     size_t bytes_to_copy =
             ANJ_MIN(buff_ctx->bytes_in_internal_buff - buff_ctx->offset,
                     out_buff_len);
-    memcpy(out_buff, &(buff_ctx->internal_buff[buff_ctx->offset]),
-           bytes_to_copy);
+#ifdef ANJ_WITH_DIRECT_PAYLOAD_ENCODING
+    if (buff_ctx->direct_buff) {
+        // the record is already in place
+        assert(buff_ctx->direct_buff == out_buff && !buff_ctx->offset);
+        assert(bytes_to_copy == buff_ctx->bytes_in_internal_buff);
+        buff_ctx->direct_buff = NULL;
+    } else
+#endif // ANJ_WITH_DIRECT_PAYLOAD_ENCODING
+    {
+        memcpy(out_buff, &(buff_ctx->internal_buff[buff_ctx->offset]),
+               bytes_to_copy);
+    }
     buff_ctx->remaining_bytes -= bytes_to_copy;
     buff_ctx->offset += bytes_to_copy;
     *copied_bytes = bytes_to_copy;
 }
 
+#ifdef ANJ_WITH_LWM2M_CBOR
+static int get_lwm2m_cbor_extended_data(_anj_io_out_ctx_t *ctx,
+                                        void *out_buff,
+                                        size_t out_buff_len,
+                                        size_t *out_copied_bytes) {
+    _anj_lwm2m_cbor_encoder_t *lwm2m = &ctx->encoder.lwm2m;
+    /**
+     * For the last record, the additional data are also refers to the ends
+     * of indefinite maps, get_cbor_extended_data will ignore last
+     * lwm2m->maps_opened bytes, and they will be copied to out_buff in the
+     * _anj_get_lwm2m_cbor_map_ends.
+     */
+    int ret_val = get_cbor_extended_data(
+            &ctx->buff, ctx->entry, out_buff, out_buff_len, out_copied_bytes,
+            lwm2m->items_count ? 0 : lwm2m->maps_opened);
+    // ret_val == ANJ_IO_NEED_NEXT_CALL means that there are still bytes to
+    // be copied from internal buffer but maybe
+    // _anj_get_lwm2m_cbor_map_ends will copy more bytes
+    if (ret_val && ret_val != ANJ_IO_NEED_NEXT_CALL) {
+        return ret_val;
+    }
+    if (!lwm2m->items_count
+            && ctx->buff.remaining_bytes <= lwm2m->maps_opened) {
+        ret_val = _anj_get_lwm2m_cbor_map_ends(ctx, out_buff, out_buff_len,
+                                               out_copied_bytes);
+    }
+    if (!ctx->buff.remaining_bytes) {
+        _anj_io_reset_internal_buff(&ctx->buff);
+    }
+    return ret_val;
+}
+#endif // ANJ_WITH_LWM2M_CBOR
+
+/* Empty packets are illegal for all types apart from extended strings and
+ * extended bytes in plain text format or opaque stream. */
+static inline bool empty_chunk_allowed(const _anj_io_out_ctx_t *ctx) {
+#if defined(ANJ_WITH_PLAINTEXT) || defined(ANJ_WITH_OPAQUE)
+    return (ctx->format == _ANJ_COAP_FORMAT_PLAINTEXT
+            || ctx->format == _ANJ_COAP_FORMAT_OPAQUE_STREAM)
+           && ctx->buff.is_extended_type;
+#else  // defined(ANJ_WITH_PLAINTEXT) || defined(ANJ_WITH_OPAQUE)
+    (void) ctx;
+    return false;
+#endif // defined(ANJ_WITH_PLAINTEXT) || defined(ANJ_WITH_OPAQUE)
+}
+
 static inline int io_out_ctx_get_payload(_anj_io_out_ctx_t *ctx,
                                          void *out_buff,
                                          size_t out_buff_len,
                                          size_t *out_copied_bytes) {
     _anj_io_buff_t *buff_ctx = &ctx->buff;
 
-    /* Empty packets are illegal for all types apart from extended strings and
-     * extended bytes in plain text format or opaque stream. Empty buffer is
-     * also allowed for empty read. */
-    if (!buff_ctx->remaining_bytes
-            && !((ctx->format == _ANJ_COAP_FORMAT_PLAINTEXT
-                  || ctx->format == _ANJ_COAP_FORMAT_OPAQUE_STREAM)
-                 && buff_ctx->is_extended_type)
+    // empty buffer is also allowed for empty read
+    if (!buff_ctx->remaining_bytes && !empty_chunk_allowed(ctx)
             && !ctx->empty) {
         return _ANJ_IO_ERR_LOGIC;
     }
@@ -517,59 +719,51 @@ static inline int io_out_ctx_get_payload(_anj_io_out_ctx_t *ctx,
         return ANJ_IO_NEED_NEXT_CALL;
     }
 
+#if defined(IO_OUT_ONLY_SENML_CBOR)
+    return get_cbor_extended_data(&ctx->buff, ctx->entry, out_buff,
+                                  out_buff_len, out_copied_bytes, 0);
+#elif defined(IO_OUT_ONLY_LWM2M_CBOR)
+    return get_lwm2m_cbor_extended_data(ctx, out_buff, out_buff_len,
+                                        out_copied_bytes);
+#else
     switch (ctx->format) {
-#ifdef ANJ_WITH_PLAINTEXT
+#    ifdef ANJ_WITH_PLAINTEXT
     case _ANJ_COAP_FORMAT_PLAINTEXT:
         return _anj_text_get_extended_data_payload(
                 out_buff, out_buff_len, out_copied_bytes, buff_ctx, ctx->entry);
-#endif // ANJ_WITH_PLAINTEXT
-#ifdef ANJ_WITH_OPAQUE
+#    endif // ANJ_WITH_PLAINTEXT
+#    ifdef ANJ_WITH_OPAQUE
     case _ANJ_COAP_FORMAT_OPAQUE_STREAM:
         return _anj_opaque_get_extended_data_payload(
                 out_buff, out_buff_len, out_copied_bytes, buff_ctx, ctx->entry);
-#endif // ANJ_WITH_OPAQUE
-#ifdef ANJ_WITH_CBOR
+#    endif // ANJ_WITH_OPAQUE
+#    ifdef ANJ_WITH_CBOR
     case _ANJ_COAP_FORMAT_CBOR:
         return get_cbor_extended_data(&ctx->buff, ctx->entry, out_buff,
                                       out_buff_len, out_copied_bytes, 0);
-#endif // ANJ_WITH_CBOR
-#ifdef ANJ_WITH_SENML_CBOR
+#    endif // ANJ_WITH_CBOR
+#    ifdef ANJ_WITH_SENML_CBOR
     case _ANJ_COAP_FORMAT_SENML_CBOR:
+#        ifdef ANJ_WITH_SENML_CBOR_STRINGREF
+    case _ANJ_COAP_FORMAT_SENML_CBOR_STRINGREF:
+#        endif // ANJ_WITH_SENML_CBOR_STRINGREF
         return get_cbor_extended_data(&ctx->buff, ctx->entry, out_buff,
                                       out_buff_len, out_copied_bytes, 0);
-#endif // ANJ_WITH_SENML_CBOR
-#ifdef ANJ_WITH_LWM2M_CBOR
-    case _ANJ_COAP_FORMAT_OMA_LWM2M_CBOR: {
-        _anj_lwm2m_cbor_encoder_t *lwm2m = &ctx->encoder.lwm2m;
-        /**
-         * For the last record, the additional data are also refers to the ends
-         * of indefinite maps, get_cbor_extended_data will ignore last
-         * lwm2m->maps_opened bytes, and they will be copied to out_buff in the
-         * _anj_get_lwm2m_cbor_map_ends.
-         */
-        int ret_val = get_cbor_extended_data(
-                &ctx->buff, ctx->entry, out_buff, out_buff_len,
-                out_copied_bytes, lwm2m->items_count ? 0 : lwm2m->maps_opened);
-        // ret_val == ANJ_IO_NEED_NEXT_CALL means that there are still bytes to
-        // be copied from internal buffer but maybe
-        // _anj_get_lwm2m_cbor_map_ends will copy more bytes
-        if (ret_val && ret_val != ANJ_IO_NEED_NEXT_CALL) {
-            return ret_val;
-        }
-        if (!lwm2m->items_count
-                && ctx->buff.remaining_bytes <= lwm2m->maps_opened) {
-            ret_val = _anj_get_lwm2m_cbor_map_ends(ctx, out_buff, out_buff_len,
-                                                   out_copied_bytes);
-        }
-        if (!ctx->buff.remaining_bytes) {
-            _anj_io_reset_internal_buff(buff_ctx);
-        }
-        return ret_val;
-    }
-#endif // ANJ_WITH_LWM2M_CBOR
+#    endif // ANJ_WITH_SENML_CBOR
+#    ifdef ANJ_WITH_LWM2M_CBOR
+    case _ANJ_COAP_FORMAT_OMA_LWM2M_CBOR:
+        return get_lwm2m_cbor_extended_data(ctx, out_buff, out_buff_len,
+                                            out_copied_bytes);
+#    endif // ANJ_WITH_LWM2M_CBOR
+#    ifdef ANJ_WITH_TLV_ENCODER
+    case _ANJ_COAP_FORMAT_OMA_LWM2M_TLV:
+        return get_cbor_bytes_string_data(&ctx->buff, ctx->entry, out_buff,
+                                          out_buff_len, out_copied_bytes, 0);
+#    endif // ANJ_WITH_TLV_ENCODER
     default:
         return _ANJ_IO_ERR_LOGIC;
     }
+#endif // defined(IO_OUT_ONLY_SENML_CBOR)
 }
 
 int _anj_io_out_ctx_get_payload(_anj_io_out_ctx_t *ctx,
@@ -592,6 +786,16 @@ uint16_t _anj_io_out_ctx_get_format(_anj_io_out_ctx_t *ctx) {
     return ctx->format;
 }
 
+#ifdef ANJ_WITH_TLV_ENCODER
+void _anj_io_out_ctx_set_res_insts_count(_anj_io_out_ctx_t *ctx,
+                                         uint16_t res_insts_count) {
+    assert(ctx);
+    if (ctx->format == _ANJ_COAP_FORMAT_OMA_LWM2M_TLV && !ctx->empty) {
+        _anj_tlv_encoder_set_res_insts_count(ctx, res_insts_count);
+    }
+}
+#endif // ANJ_WITH_TLV_ENCODER
+
 size_t _anj_io_out_add_objlink(_anj_io_buff_t *buff_ctx,
                                size_t buf_pos,
                                anj_oid_t oid,
@@ -602,11 +806,10 @@ size_t _anj_io_out_add_objlink(_anj_io_buff_t *buff_ctx,
     buffer[str_size++] = ':';
     str_size += anj_uint16_to_string_value(&buffer[str_size], iid);
 
+    uint8_t *record_buff = _anj_io_record_buff(buff_ctx);
     size_t header_size =
-            anj_cbor_ll_string_begin(&buff_ctx->internal_buff[buf_pos],
-                                     str_size);
-    memcpy(&((uint8_t *) buff_ctx->internal_buff)[buf_pos + header_size],
-           buffer, str_size);
+            anj_cbor_ll_string_begin(&record_buff[buf_pos], str_size);
+    memcpy(&record_buff[buf_pos + header_size], buffer, str_size);
     return header_size + str_size;
 }
 
@@ -699,41 +902,49 @@ int _anj_io_in_ctx_feed_payload(_anj_io_in_ctx_t *ctx,
                                 size_t buff_size,
                                 bool payload_finished) {
     assert(ctx);
+#if defined(IO_IN_ONLY_SENML_CBOR)
+    return _anj_senml_cbor_decoder_feed_payload(ctx, buff, buff_size,
+                                                payload_finished);
+#elif defined(IO_IN_ONLY_LWM2M_CBOR)
+    return _anj_lwm2m_cbor_decoder_feed_payload(ctx, buff, buff_size,
+                                                payload_finished);
+#else
     switch (ctx->format) {
-#ifdef ANJ_WITH_PLAINTEXT
+#    ifdef ANJ_WITH_PLAINTEXT
     case _ANJ_COAP_FORMAT_PLAINTEXT:
         return _anj_text_decoder_feed_payload(ctx, buff, buff_size,
                                               payload_finished);
-#endif // ANJ_WITH_PLAINTEXT
-#ifdef ANJ_WITH_OPAQUE
+#    endif // ANJ_WITH_PLAINTEXT
+#    ifdef ANJ_WITH_OPAQUE
     case _ANJ_COAP_FORMAT_OPAQUE_STREAM:
         return _anj_opaque_decoder_feed_payload(ctx, buff, buff_size,
                                                 payload_finished);
-#endif // ANJ_WITH_OPAQUE
-#ifdef ANJ_WITH_CBOR
+#    endif // ANJ_WITH_OPAQUE
+#    ifdef ANJ_WITH_CBOR
     case _ANJ_COAP_FORMAT_CBOR:
         return _anj_cbor_decoder_feed_payload(ctx, buff, buff_size,
                                               payload_finished);
-#endif // ANJ_WITH_CBOR
-#ifdef ANJ_WITH_SENML_CBOR
+#    endif // ANJ_WITH_CBOR
+#    ifdef ANJ_WITH_SENML_CBOR
     case _ANJ_COAP_FORMAT_SENML_CBOR:
     case _ANJ_COAP_FORMAT_SENML_ETCH_CBOR:
         return _anj_senml_cbor_decoder_feed_payload(ctx, buff, buff_size,
                                                     payload_finished);
-#endif // ANJ_WITH_SENML_CBOR
-#ifdef ANJ_WITH_LWM2M_CBOR
+#    endif // ANJ_WITH_SENML_CBOR
+#    ifdef ANJ_WITH_LWM2M_CBOR
     case _ANJ_COAP_FORMAT_OMA_LWM2M_CBOR:
         return _anj_lwm2m_cbor_decoder_feed_payload(ctx, buff, buff_size,
                                                     payload_finished);
-#endif // ANJ_WITH_LWM2M_CBOR
-#ifdef ANJ_WITH_TLV
+#    endif // ANJ_WITH_LWM2M_CBOR
+#    ifdef ANJ_WITH_TLV
     case _ANJ_COAP_FORMAT_OMA_LWM2M_TLV:
         return _anj_tlv_decoder_feed_payload(ctx, buff, buff_size,
                                              payload_finished);
-#endif // ANJ_WITH_TLV
+#    endif // ANJ_WITH_TLV
     default:
         return _ANJ_IO_ERR_LOGIC;
     }
+#endif // defined(IO_IN_ONLY_SENML_CBOR)
 }
 
 int _anj_io_in_ctx_get_entry(_anj_io_in_ctx_t *ctx,
@@ -741,67 +952,83 @@ int _anj_io_in_ctx_get_entry(_anj_io_in_ctx_t *ctx,
                              const anj_res_value_t **out_value,
                              const anj_uri_path_t **out_path) {
     assert(ctx);
+#if defined(IO_IN_ONLY_SENML_CBOR)
+    return _anj_senml_cbor_decoder_get_entry(ctx, inout_type_bitmask,
+                                             out_value, out_path);
+#elif defined(IO_IN_ONLY_LWM2M_CBOR)
+    return _anj_lwm2m_cbor_decoder_get_entry(ctx, inout_type_bitmask,
+                                             out_value, out_path);
+#else
     switch (ctx->format) {
-#ifdef ANJ_WITH_PLAINTEXT
+#    ifdef ANJ_WITH_PLAINTEXT
     case _ANJ_COAP_FORMAT_PLAINTEXT:
         return _anj_text_decoder_get_entry(ctx, inout_type_bitmask, out_value,
                                            out_path);
-#endif // ANJ_WITH_PLAINTEXT
-#ifdef ANJ_WITH_OPAQUE
+#    endif // ANJ_WITH_PLAINTEXT
+#    ifdef ANJ_WITH_OPAQUE
     case _ANJ_COAP_FORMAT_OPAQUE_STREAM:
         return _anj_opaque_decoder_get_entry(ctx, inout_type_bitmask, out_value,
                                              out_path);
-#endif // ANJ_WITH_OPAQUE
-#ifdef ANJ_WITH_CBOR
+#    endif // ANJ_WITH_OPAQUE
+#    ifdef ANJ_WITH_CBOR
     case _ANJ_COAP_FORMAT_CBOR:
         return _anj_cbor_decoder_get_entry(ctx, inout_type_bitmask, out_value,
                                            out_path);
-#endif // ANJ_WITH_CBOR
-#ifdef ANJ_WITH_SENML_CBOR
+#    endif // ANJ_WITH_CBOR
+#    ifdef ANJ_WITH_SENML_CBOR
     case _ANJ_COAP_FORMAT_SENML_CBOR:
     case _ANJ_COAP_FORMAT_SENML_ETCH_CBOR:
         return _anj_senml_cbor_decoder_get_entry(ctx, inout_type_bitmask,
                                                  out_value, out_path);
-#endif // ANJ_WITH_SENML_CBOR
-#ifdef ANJ_WITH_LWM2M_CBOR
+#    endif // ANJ_WITH_SENML_CBOR
+#    ifdef ANJ_WITH_LWM2M_CBOR
     case _ANJ_COAP_FORMAT_OMA_LWM2M_CBOR:
         return _anj_lwm2m_cbor_decoder_get_entry(ctx, inout_type_bitmask,
                                                  out_value, out_path);
-#endif // ANJ_WITH_LWM2M_CBOR
-#ifdef ANJ_WITH_TLV
+#    endif // ANJ_WITH_LWM2M_CBOR
+#    ifdef ANJ_WITH_TLV
     case _ANJ_COAP_FORMAT_OMA_LWM2M_TLV:
         return _anj_tlv_decoder_get_entry(ctx, inout_type_bitmask, out_value,
                                           out_path);
-#endif // ANJ_WITH_TLV
+#    endif // ANJ_WITH_TLV
     default:
         return _ANJ_IO_ERR_LOGIC;
     }
+#endif // defined(IO_IN_ONLY_SENML_CBOR)
 }
 
 int _anj_io_in_ctx_get_entry_count(_anj_io_in_ctx_t *ctx, size_t *out_count) {
     assert(ctx);
     assert(out_count);
+#if defined(IO_IN_ONLY_SENML_CBOR)
+    return _anj_senml_cbor_decoder_get_entry_count(ctx, out_count);
+#elif defined(IO_IN_ONLY_LWM2M_CBOR)
+    (void) ctx;
+    (void) out_count;
+    return _ANJ_IO_ERR_FORMAT;
+#else
     switch (ctx->format) {
-#ifdef ANJ_WITH_PLAINTEXT
+#    ifdef ANJ_WITH_PLAINTEXT
     case _ANJ_COAP_FORMAT_PLAINTEXT:
         return _anj_text_decoder_get_entry_count(ctx, out_count);
-#endif // ANJ_WITH_PLAINTEXT
-#ifdef ANJ_WITH_OPAQUE
+#    endif // ANJ_WITH_PLAINTEXT
+#    ifdef ANJ_WITH_OPAQUE
     case _ANJ_COAP_FORMAT_OPAQUE_STREAM:
         return _anj_opaque_decoder_get_entry_count(ctx, out_count);
-#endif // ANJ_WITH_OPAQUE
-#ifdef ANJ_WITH_CBOR
+#    endif // ANJ_WITH_OPAQUE
+#    ifdef ANJ_WITH_CBOR
     case _ANJ_COAP_FORMAT_CBOR:
         return _anj_cbor_decoder_get_entry_count(ctx, out_count);
-#endif // ANJ_WITH_CBOR
-#ifdef ANJ_WITH_SENML_CBOR
+#    endif // ANJ_WITH_CBOR
+#    ifdef ANJ_WITH_SENML_CBOR
     case _ANJ_COAP_FORMAT_SENML_CBOR:
     case _ANJ_COAP_FORMAT_SENML_ETCH_CBOR:
         return _anj_senml_cbor_decoder_get_entry_count(ctx, out_count);
-#endif // ANJ_WITH_SENML_CBOR
+#    endif // ANJ_WITH_SENML_CBOR
     default:
         return _ANJ_IO_ERR_FORMAT;
     }
+#endif // defined(IO_IN_ONLY_SENML_CBOR)
 }
 
 int _anj_io_register_ctx_new_entry(_anj_io_register_ctx_t *ctx,
@@ -109,6 +109,23 @@ int _anj_io_out_ctx_init(_anj_io_out_ctx_t *ctx,
                          size_t items_count,
                          uint16_t format);
 
+#    ifdef ANJ_WITH_SMALLEST_FORMAT
+/**
+ * Chooses the most compact content format for a payload that consists of a
+ * single value of given @p type, e.g. a response to a READ request targeting
+ * a single-instance Resource. Formats without framing (Opaque, Plain Text)
+ * are preferred for bytes and strings, CBOR for numeric values, which would be
+ * spelled out digit by digit in Plain Text.
+ *
+ * @param type Data type of the only record of the payload.
+ *
+ * @return Chosen format, or @ref _ANJ_COAP_FORMAT_NOT_DEFINED if none of the
+ *         single value formats is enabled for @p type and the default
+ *         hierarchical format should be used.
+ */
+uint16_t _anj_io_out_smallest_format(anj_data_type_t type);
+#    endif // ANJ_WITH_SMALLEST_FORMAT
+
 /**
  * Call to add new @p entry.
  * During this call the @p entry is encoded with given format and internal
@@ -125,6 +142,30 @@ int _anj_io_out_ctx_init(_anj_io_out_ctx_t *ctx,
 int _anj_io_out_ctx_new_entry(_anj_io_out_ctx_t *ctx,
                               const anj_io_out_entry_t *entry);
 
+#    ifdef ANJ_WITH_DIRECT_PAYLOAD_ENCODING
+/**
+ * Works like @ref _anj_io_out_ctx_new_entry, but if there is enough space in
+ * @p out_buff for the whole record header, CBOR based formats encode it
+ * directly into @p out_buff instead of the internal buffer, which saves a copy
+ * of every record. Otherwise, or for other formats, it falls back to
+ * @ref _anj_io_out_ctx_new_entry.
+ *
+ * The following @ref _anj_io_out_ctx_get_payload call must be made with the
+ * same @p out_buff.
+ *
+ * @param      ctx          Context to operate on.
+ * @param      entry        Single record.
+ * @param[out] out_buff     Payload buffer, at the position of the record.
+ * @param      out_buff_len Length of payload buffer.
+ *
+ * @return 0 on success, a negative value in case of error.
+ */
+int _anj_io_out_ctx_new_entry_direct(_anj_io_out_ctx_t *ctx,
+                                     const anj_io_out_entry_t *entry,
+                                     void *out_buff,
+                                     size_t out_buff_len);
+#    endif // ANJ_WITH_DIRECT_PAYLOAD_ENCODING
+
 /**
  * Call to copy encoded message to payload buffer.
  *
@@ -196,6 +237,21 @@ int _anj_io_out_ctx_get_payload(_anj_io_out_ctx_t *ctx,
  */
 uint16_t _anj_io_out_ctx_get_format(_anj_io_out_ctx_t *ctx);
 
+#    ifdef ANJ_WITH_TLV_ENCODER
+/**
+ * Provides the number of instances of the Multiple-Instance Resource whose
+ * first Resource Instance is passed in the next call to @ref
+ * _anj_io_out_ctx_new_entry. TLV encodes the length of a Multiple Resource
+ * before its instances, so this must be called before each such Resource when
+ * TLV format is used. For other formats the call has no effect.
+ *
+ * @param ctx             Context to operate on.
+ * @param res_insts_count Number of Resource Instances that will be added.
+ */
+void _anj_io_out_ctx_set_res_insts_count(_anj_io_out_ctx_t *ctx,
+                                         uint16_t res_insts_count);
+#    endif // ANJ_WITH_TLV_ENCODER
+
 #    ifdef ANJ_WITH_EXTERNAL_DATA
 /**
  * Invoke @ref anj_close_external_data_t callback for @p entry record.
@@ -12,7 +12,6 @@
 #define ANJ_LOG_SOURCE_FILE_ID 40
 
 #include <assert.h>
-#include <ctype.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -113,60 +112,67 @@ static int get_senml_cbor_label(_anj_io_in_ctx_t *ctx) {
     }
 }
 
-static int parse_id(uint16_t *out_id, const char **id_begin) {
-    const char *id_end = *id_begin;
-    while (isdigit(*id_end)) {
-        ++id_end;
-    }
-    uint32_t value;
-    int result = anj_string_to_uint32_value(&value, *id_begin,
-                                            (size_t) (id_end - *id_begin));
-    if (result) {
-        return result;
-    }
-    if (value >= ANJ_ID_INVALID) {
-        return -1;
+static void path_parser_feed(_anj_senml_path_parser_t *parser,
+                             const char *chars,
+                             size_t count) {
+    for (size_t i = 0; i < count && !parser->error; i++) {
+        char ch = chars[i];
+        if (++parser->length >= _ANJ_IO_MAX_PATH_STRING_SIZE) {
+            parser->error = true;
+        } else if (ch == '/') {
+            if (parser->after_slash) {
+                if (!parser->id_has_digits
+                        || parser->path.uri_len
+                                   >= ANJ_ARRAY_SIZE(parser->path.ids)) {
+                    parser->error = true;
+                    break;
+                }
+                parser->path.ids[parser->path.uri_len++] =
+                        (uint16_t) parser->id;
+            }
+            parser->after_slash = true;
+            parser->id_has_digits = false;
+            parser->id = 0;
+        } else if (ch >= '0' && ch <= '9' && parser->after_slash) {
+            parser->id = 10 * parser->id + (uint32_t) (ch - '0');
+            parser->id_has_digits = true;
+            if (parser->id >= ANJ_ID_INVALID) {
+                parser->error = true;
+            }
+        } else {
+            parser->error = true;
+        }
     }
-    *out_id = (uint16_t) value;
-    *id_begin = id_end;
-    return 0;
 }
 
-static int parse_absolute_path(anj_uri_path_t *out_path, const char *input) {
-    if (!*input) {
+static int path_parser_finish(const _anj_senml_path_parser_t *parser,
+                              anj_uri_path_t *out_path) {
+    // "/" alone is the root path, otherwise every '/' is followed by an ID
+    if (parser->error || !parser->after_slash
+            || (!parser->id_has_digits && parser->path.uri_len)) {
         return _ANJ_IO_ERR_FORMAT;
     }
+    // IDs past uri_len of the parser are not set, they may be zeroed
     *out_path = ANJ_MAKE_ROOT_PATH();
-
-    if (!strcmp(input, "/")) {
-        return 0;
+    for (; out_path->uri_len < parser->path.uri_len; out_path->uri_len++) {
+        out_path->ids[out_path->uri_len] =
+                parser->path.ids[out_path->uri_len];
     }
-    for (const char *ch = input; *ch;) {
-        if (*ch++ != '/') {
-            return _ANJ_IO_ERR_FORMAT;
-        }
+    if (parser->id_has_digits) {
         if (out_path->uri_len >= ANJ_ARRAY_SIZE(out_path->ids)) {
             return _ANJ_IO_ERR_FORMAT;
         }
-        if (parse_id(&out_path->ids[out_path->uri_len], &ch)) {
-            return _ANJ_IO_ERR_FORMAT;
-        }
-        out_path->uri_len++;
+        out_path->ids[out_path->uri_len++] = (uint16_t) parser->id;
     }
     return 0;
 }
 
 static int parse_next_absolute_path(_anj_io_in_ctx_t *ctx) {
     _anj_senml_cbor_decoder_t *const senml = &ctx->decoder.senml_cbor;
-    char full_path[_ANJ_IO_MAX_PATH_STRING_SIZE];
-    size_t len1 = strlen(senml->basename);
-    size_t len2 = strlen(senml->entry.path);
-    if (len1 + len2 >= sizeof(full_path)) {
-        return _ANJ_IO_ERR_FORMAT;
-    }
-    memcpy(full_path, senml->basename, len1);
-    memcpy(full_path + len1, senml->entry.path, len2 + 1);
-    if (parse_absolute_path(&ctx->out_path, full_path)
+    const _anj_senml_path_parser_t *parser =
+            senml->entry_parse.has_name ? &senml->entry_parse.path_parser
+                                        : &senml->basename;
+    if (path_parser_finish(parser, &ctx->out_path)
             || anj_uri_path_outside_base(&ctx->out_path, &senml->base)
             || (
 #    ifdef ANJ_WITH_COMPOSITE_OPERATIONS
@@ -178,23 +184,70 @@ static int parse_next_absolute_path(_anj_io_in_ctx_t *ctx) {
     return 0;
 }
 
+/**
+ * Passes the chunks of the current text string to @p parser. If @p raw_buf is
+ * not NULL, they are also copied there, up to @p raw_buf_size bytes including
+ * the terminating nullbyte. Errors of @p parser are left to the caller, as a
+ * name may turn out to be valid only with a base name that follows it.
+ */
+static int parse_path_string(_anj_io_in_ctx_t *ctx,
+                             _anj_senml_path_parser_t *parser,
+                             char *raw_buf,
+                             size_t raw_buf_size) {
+    _anj_senml_cbor_decoder_t *const senml = &ctx->decoder.senml_cbor;
+    _anj_senml_entry_parse_state_t *const state = &senml->entry_parse;
+    int result;
+    if (!state->bytes_ctx) {
+        _anj_cbor_ll_value_type_t type;
+        if ((result = anj_cbor_ll_decoder_current_value_type(&senml->ctx,
+                                                             &type))) {
+            return result;
+        }
+        if (type != ANJ_CBOR_LL_VALUE_TEXT_STRING) {
+            return _ANJ_IO_ERR_FORMAT;
+        }
+        if ((result = anj_cbor_ll_decoder_bytes(&senml->ctx, &state->bytes_ctx,
+                                                NULL))) {
+            return result;
+        }
+    }
+    bool message_finished = false;
+    while (!message_finished) {
+        const void *chunk;
+        size_t chunk_size;
+        if ((result = anj_cbor_ll_decoder_bytes_get_some(
+                     state->bytes_ctx, &chunk, &chunk_size,
+                     &message_finished))) {
+            return result;
+        }
+        path_parser_feed(parser, (const char *) chunk, chunk_size);
+        if (raw_buf) {
+            if (state->bytes_consumed + chunk_size >= raw_buf_size) {
+                return _ANJ_IO_ERR_FORMAT;
+            }
+            memcpy(raw_buf + state->bytes_consumed, chunk, chunk_size);
+            state->bytes_consumed += chunk_size;
+            raw_buf[state->bytes_consumed] = '\0';
+        }
+    }
+    state->bytes_ctx = NULL;
+    state->bytes_consumed = 0;
+    return 0;
+}
+
 static int parse_senml_name(_anj_io_in_ctx_t *ctx) {
     _anj_senml_cbor_decoder_t *const senml = &ctx->decoder.senml_cbor;
     if (senml->entry_parse.has_name) {
         return _ANJ_IO_ERR_FORMAT;
     }
-
-    _anj_cbor_ll_value_type_t type;
-    int result = anj_cbor_ll_decoder_current_value_type(&senml->ctx, &type);
-    if (result) {
-        return result;
-    }
-    if (type != ANJ_CBOR_LL_VALUE_TEXT_STRING) {
-        return _ANJ_IO_ERR_FORMAT;
+    if (!senml->entry_parse.bytes_ctx) {
+        // the name is relative to the already parsed base name
+        senml->entry_parse.path_parser = senml->basename;
     }
-
-    if (!(result = get_short_string(ctx, senml->entry.path,
-                                    sizeof(senml->entry.path)))) {
+    int result = parse_path_string(ctx, &senml->entry_parse.path_parser,
+                                   senml->entry.path,
+                                   sizeof(senml->entry.path));
+    if (!result) {
         senml->entry_parse.has_name = true;
     }
     return result;
@@ -321,21 +374,24 @@ static int parse_senml_basename(_anj_io_in_ctx_t *ctx) {
     if (senml->entry_parse.has_basename) {
         return _ANJ_IO_ERR_FORMAT;
     }
-
-    _anj_cbor_ll_value_type_t type;
-    int result = anj_cbor_ll_decoder_current_value_type(&senml->ctx, &type);
+    if (!senml->entry_parse.bytes_ctx) {
+        memset(&senml->basename, 0, sizeof(senml->basename));
+    }
+    int result = parse_path_string(ctx, &senml->basename, NULL, 0);
     if (result) {
         return result;
     }
-    if (type != ANJ_CBOR_LL_VALUE_TEXT_STRING) {
+    if (senml->basename.error) {
         return _ANJ_IO_ERR_FORMAT;
     }
-
-    if (!(result = get_short_string(ctx, senml->basename,
-                                    sizeof(senml->basename)))) {
-        senml->entry_parse.has_basename = true;
+    senml->entry_parse.has_basename = true;
+    if (senml->entry_parse.has_name) {
+        // rare case of the name preceding the base name in the same entry
+        senml->entry_parse.path_parser = senml->basename;
+        path_parser_feed(&senml->entry_parse.path_parser, senml->entry.path,
+                         strlen(senml->entry.path));
     }
-    return result;
+    return 0;
 }
 
 int _anj_senml_cbor_decoder_init(_anj_io_in_ctx_t *ctx,
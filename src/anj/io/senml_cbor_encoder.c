@@ -31,28 +31,134 @@
 
 #    define _SENML_CBOR_PATH_MAX_LEN sizeof("/65534/65534/65534/65534")
 
-static size_t add_path(uint8_t *out_buff,
+#    ifdef ANJ_WITH_SENML_CBOR_STRINGREF
+static bool stringref_enabled(const _anj_senml_cbor_encoder_t *senml_cbor) {
+    return senml_cbor->stringref && !senml_cbor->stringref_stopped;
+}
+
+// Numbers a string the way the decoder does: only strings long enough for a
+// reference to them to be shorter are added to the namespace. Returns false
+// if the string has not been numbered.
+static bool stringref_add(_anj_senml_cbor_encoder_t *senml_cbor, size_t len) {
+    uint32_t count = senml_cbor->stringref_count;
+    size_t min_len = count < 24 ? 3 : count < 256 ? 4 : count < 65536 ? 5 : 7;
+    if (!senml_cbor->stringref || len < min_len) {
+        return false;
+    }
+    senml_cbor->stringref_count++;
+    return true;
+}
+
+static const _anj_senml_cbor_stringref_t *
+stringref_find(const _anj_senml_cbor_encoder_t *senml_cbor,
+               const anj_uri_path_t *path,
+               size_t start_index,
+               size_t end_index) {
+    size_t ids_count = end_index - start_index;
+    for (size_t i = 0; i < senml_cbor->stringref_names_count; i++) {
+        const _anj_senml_cbor_stringref_t *name =
+                &senml_cbor->stringref_names[i];
+        if (name->ids_count == ids_count
+                && !memcmp(name->ids, &path->ids[start_index],
+                           ids_count * sizeof(uint16_t))) {
+            return name;
+        }
+    }
+    return NULL;
+}
+
+static void stringref_add_name(_anj_senml_cbor_encoder_t *senml_cbor,
+                               const anj_uri_path_t *path,
+                               size_t start_index,
+                               size_t end_index,
+                               size_t len) {
+    uint32_t index = senml_cbor->stringref_count;
+    if (!stringref_add(senml_cbor, len) || !stringref_enabled(senml_cbor)
+            || senml_cbor->stringref_names_count
+                           == ANJ_SENML_CBOR_STRINGREF_NAMES) {
+        return;
+    }
+    _anj_senml_cbor_stringref_t *name =
+            &senml_cbor->stringref_names[senml_cbor->stringref_names_count++];
+    name->ids_count = (uint8_t) (end_index - start_index);
+    memcpy(name->ids, &path->ids[start_index],
+           name->ids_count * sizeof(uint16_t));
+    name->index = index;
+}
+#    endif // ANJ_WITH_SENML_CBOR_STRINGREF
+
+static size_t add_path(_anj_senml_cbor_encoder_t *senml_cbor,
+                       uint8_t *out_buff,
                        const anj_uri_path_t *path,
                        size_t start_index,
                        size_t end_index,
-                       int64_t label) {
+                       int8_t label) {
+#    ifdef ANJ_WITH_SENML_CBOR_STRINGREF
+    const _anj_senml_cbor_stringref_t *name =
+            stringref_enabled(senml_cbor)
+                    ? stringref_find(senml_cbor, path, start_index, end_index)
+                    : NULL;
+    if (name) {
+        size_t len = anj_cbor_ll_encode_small_int(out_buff, label);
+        len += anj_cbor_ll_encode_tag(&out_buff[len], CBOR_TAG_STRINGREF);
+        return len + anj_cbor_ll_encode_uint(&out_buff[len], name->index);
+    }
+#    else  // ANJ_WITH_SENML_CBOR_STRINGREF
+    (void) senml_cbor;
+#    endif // ANJ_WITH_SENML_CBOR_STRINGREF
+    // label and 1-byte string header
+    const size_t path_offset = 2;
+    char *path_buff = (char *) &out_buff[path_offset];
     size_t path_buf_pos = 0;
-    size_t out_buf_pos = 0;
-    char path_buff[_SENML_CBOR_PATH_MAX_LEN] = { 0 };
 
+    // write the path in place, it almost always fits in a 1-byte header
     for (size_t i = start_index; i < end_index; i++) {
         path_buff[path_buf_pos++] = '/';
         path_buf_pos += anj_uint16_to_string_value(&path_buff[path_buf_pos],
                                                    path->ids[i]);
     }
+    assert(path_buf_pos < _SENML_CBOR_PATH_MAX_LEN);
+#    ifdef ANJ_WITH_SENML_CBOR_STRINGREF
+    stringref_add_name(senml_cbor, path, start_index, end_index, path_buf_pos);
+#    endif // ANJ_WITH_SENML_CBOR_STRINGREF
 
-    out_buf_pos += anj_cbor_ll_encode_int(out_buff, label);
-    out_buf_pos +=
-            anj_cbor_ll_string_begin(&out_buff[out_buf_pos], path_buf_pos);
-    memcpy(&out_buff[out_buf_pos], path_buff, path_buf_pos);
+    anj_cbor_ll_encode_small_int(out_buff, label);
+    if (path_buf_pos <= ANJ_CBOR_LL_SMALL_VALUE_MAX) {
+        anj_cbor_ll_small_string_begin(&out_buff[1], (uint8_t) path_buf_pos);
+        return path_offset + path_buf_pos;
+    }
+    memmove(&path_buff[1], path_buff, path_buf_pos);
+    size_t header_len = anj_cbor_ll_string_begin(&out_buff[1], path_buf_pos);
+    assert(header_len == 2);
+    return 1 + header_len + path_buf_pos;
+}
+
+#    ifdef ANJ_WITH_SENML_CBOR_DYNAMIC_BASE_NAME
+static bool uri_path_prefix_differs(const anj_uri_path_t *path,
+                                    const anj_uri_path_t *prefix,
+                                    size_t prefix_len) {
+    for (size_t i = 0; i < prefix_len; i++) {
+        if (path->ids[i] != prefix->ids[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+#    endif // ANJ_WITH_SENML_CBOR_DYNAMIC_BASE_NAME
 
-    return out_buf_pos + path_buf_pos;
+#    ifdef ANJ_WITH_SENML_CBOR_RELATIVE_TIME
+static size_t encode_time_offset(uint8_t *out_buff, double offset) {
+#        ifdef ANJ_WITH_CBOR_ENCODE_SHORTEST_FLOAT
+    return anj_cbor_ll_encode_double_shortest(out_buff, offset);
+#        else  // ANJ_WITH_CBOR_ENCODE_SHORTEST_FLOAT
+    // samples are usually taken whole seconds apart
+    if (fabs(offset) < 0x1p53 && offset == trunc(offset)) {
+        return anj_cbor_ll_encode_int(out_buff, (int64_t) offset);
+    }
+    return anj_cbor_ll_encode_double(out_buff, offset);
+#        endif // ANJ_WITH_CBOR_ENCODE_SHORTEST_FLOAT
 }
+#    endif // ANJ_WITH_SENML_CBOR_RELATIVE_TIME
 
 // HACK:
 // The size of the internal_buff has been calculated so that a
@@ -62,6 +168,7 @@ static int prepare_payload(const anj_io_out_entry_t *entry,
                            _anj_io_buff_t *buff_ctx,
                            bool first_entry) {
     size_t buf_pos = 0;
+    uint8_t *record_buff = _anj_io_record_buff(buff_ctx);
     size_t path_len = anj_uri_path_length(&entry->path);
     if (anj_uri_path_outside_base(&entry->path, &senml_cbor->base_path)
             || !anj_uri_path_has(&entry->path, ANJ_ID_RID)) {
@@ -73,40 +180,74 @@ static int prepare_payload(const anj_io_out_entry_t *entry,
         time_s = 0.0;
     }
 
-    bool with_base_name = (first_entry && senml_cbor->base_path_len);
-    bool with_name = (path_len != senml_cbor->base_path_len);
+#    ifdef ANJ_WITH_SENML_CBOR_DYNAMIC_BASE_NAME
+    /* Base Name follows the Object Instance of the records, unless the common
+     * base path is already longer than that. */
+    size_t base_name_len = ANJ_MAX(senml_cbor->base_path_len, ANJ_ID_IID + 1);
+    bool with_base_name =
+            first_entry
+            || uri_path_prefix_differs(&entry->path, &senml_cbor->base_name,
+                                       base_name_len);
+    if (with_base_name) {
+        senml_cbor->base_name = entry->path;
+    }
+    const anj_uri_path_t *base_name = &senml_cbor->base_name;
+#    else  // ANJ_WITH_SENML_CBOR_DYNAMIC_BASE_NAME
+    size_t base_name_len = senml_cbor->base_path_len;
+    bool with_base_name = (first_entry && base_name_len);
+    const anj_uri_path_t *base_name = &senml_cbor->base_path;
+#    endif // ANJ_WITH_SENML_CBOR_DYNAMIC_BASE_NAME
+    bool with_name = (path_len != base_name_len);
     bool with_time =
             (senml_cbor->encode_time && senml_cbor->last_timestamp != time_s);
 
     // array
     if (first_entry) {
-        buf_pos += anj_cbor_ll_definite_array_begin(
-                &buff_ctx->internal_buff[buf_pos], senml_cbor->items_count);
+#    ifdef ANJ_WITH_SENML_CBOR_STRINGREF
+        if (senml_cbor->stringref) {
+            buf_pos += anj_cbor_ll_encode_tag(&record_buff[buf_pos],
+                                              CBOR_TAG_STRINGREF_NAMESPACE);
+        }
+#    endif // ANJ_WITH_SENML_CBOR_STRINGREF
+        buf_pos += anj_cbor_ll_definite_array_begin(&record_buff[buf_pos],
+                                                    senml_cbor->items_count);
     }
     // map
     size_t map_size = (size_t) (with_base_name + with_name + with_time + 1);
-    buf_pos += anj_cbor_ll_definite_map_begin(&buff_ctx->internal_buff[buf_pos],
-                                              map_size);
+    buf_pos += anj_cbor_ll_small_definite_map_begin(&record_buff[buf_pos],
+                                                    (uint8_t) map_size);
 
-    // basename - only once for READ operation
+    // basename - only once, unless it follows the Object Instance
     if (with_base_name) {
-        buf_pos += add_path(&buff_ctx->internal_buff[buf_pos],
-                            &senml_cbor->base_path, 0,
-                            senml_cbor->base_path_len, SENML_LABEL_BASE_NAME);
+        buf_pos += add_path(senml_cbor, &record_buff[buf_pos], base_name, 0,
+                            base_name_len, SENML_LABEL_BASE_NAME);
     }
     // name
     if (with_name) {
-        buf_pos +=
-                add_path(&buff_ctx->internal_buff[buf_pos], &entry->path,
-                         senml_cbor->base_path_len, path_len, SENML_LABEL_NAME);
+        buf_pos += add_path(senml_cbor, &record_buff[buf_pos], &entry->path,
+                            base_name_len, path_len, SENML_LABEL_NAME);
     }
     // base time
+#    ifdef ANJ_WITH_SENML_CBOR_RELATIVE_TIME
+    // set only once, the following records carry the offset from it
+    if (with_time && senml_cbor->last_timestamp != 0.0) {
+        buf_pos += anj_cbor_ll_encode_small_int(&record_buff[buf_pos],
+                                                SENML_LABEL_TIME);
+        buf_pos += encode_time_offset(&record_buff[buf_pos],
+                                      time_s - senml_cbor->last_timestamp);
+        with_time = false;
+    }
+#    endif // ANJ_WITH_SENML_CBOR_RELATIVE_TIME
     if (with_time) {
         senml_cbor->last_timestamp = time_s;
-        buf_pos += anj_cbor_ll_encode_int(&buff_ctx->internal_buff[buf_pos],
-                                          SENML_LABEL_BASE_TIME);
-        buf_pos += anj_cbor_ll_encode_double(&buff_ctx->internal_buff[buf_pos],
-                                             time_s);
+        buf_pos += anj_cbor_ll_encode_small_int(&record_buff[buf_pos],
+                                                SENML_LABEL_BASE_TIME);
+#    ifdef ANJ_WITH_CBOR_ENCODE_SHORTEST_FLOAT
+        buf_pos += anj_cbor_ll_encode_double_shortest(&record_buff[buf_pos],
+                                                      time_s);
+#    else  // ANJ_WITH_CBOR_ENCODE_SHORTEST_FLOAT
+        buf_pos += anj_cbor_ll_encode_double(&record_buff[buf_pos], time_s);
+#    endif // ANJ_WITH_CBOR_ENCODE_SHORTEST_FLOAT
     }
 
     // value
@@ -118,11 +259,14 @@ static int prepare_payload(const anj_io_out_entry_t *entry,
                                != entry->value.bytes_or_string.chunk_length)) {
             return _ANJ_IO_ERR_INPUT_ARG;
         }
-        buf_pos += anj_cbor_ll_encode_uint(&buff_ctx->internal_buff[buf_pos],
-                                           SENML_LABEL_VALUE_OPAQUE);
+        buf_pos += anj_cbor_ll_encode_small_uint(&record_buff[buf_pos],
+                                                 SENML_LABEL_VALUE_OPAQUE);
         buf_pos += anj_cbor_ll_bytes_begin(
-                &buff_ctx->internal_buff[buf_pos],
+                &record_buff[buf_pos],
                 entry->value.bytes_or_string.chunk_length);
+#    ifdef ANJ_WITH_SENML_CBOR_STRINGREF
+        stringref_add(senml_cbor, entry->value.bytes_or_string.chunk_length);
+#    endif // ANJ_WITH_SENML_CBOR_STRINGREF
         buff_ctx->is_extended_type = true;
         buff_ctx->remaining_bytes = entry->value.bytes_or_string.chunk_length;
         break;
@@ -140,10 +284,13 @@ static int prepare_payload(const anj_io_out_entry_t *entry,
             string_length =
                     strlen((const char *) entry->value.bytes_or_string.data);
         }
-        buf_pos += anj_cbor_ll_encode_uint(&buff_ctx->internal_buff[buf_pos],
-                                           SENML_LABEL_VALUE_STRING);
-        buf_pos += anj_cbor_ll_string_begin(&buff_ctx->internal_buff[buf_pos],
+        buf_pos += anj_cbor_ll_encode_small_uint(&record_buff[buf_pos],
+                                                 SENML_LABEL_VALUE_STRING);
+        buf_pos += anj_cbor_ll_string_begin(&record_buff[buf_pos],
                                             string_length);
+#    ifdef ANJ_WITH_SENML_CBOR_STRINGREF
+        stringref_add(senml_cbor, string_length);
+#    endif // ANJ_WITH_SENML_CBOR_STRINGREF
         buff_ctx->is_extended_type = true;
         buff_ctx->remaining_bytes = string_length;
         break;
@@ -153,10 +300,13 @@ static int prepare_payload(const anj_io_out_entry_t *entry,
         if (!entry->value.external_data.get_external_data) {
             return _ANJ_IO_ERR_INPUT_ARG;
         }
-        buf_pos += anj_cbor_ll_encode_uint(&buff_ctx->internal_buff[buf_pos],
-                                           SENML_LABEL_VALUE_OPAQUE);
-        buf_pos += anj_cbor_ll_indefinite_bytes_begin(
-                &buff_ctx->internal_buff[buf_pos]);
+        buf_pos += anj_cbor_ll_encode_small_uint(&record_buff[buf_pos],
+                                                 SENML_LABEL_VALUE_OPAQUE);
+        buf_pos += anj_cbor_ll_indefinite_bytes_begin(&record_buff[buf_pos]);
+#        ifdef ANJ_WITH_SENML_CBOR_STRINGREF
+        // decoders may or may not number the chunks
+        senml_cbor->stringref_stopped = true;
+#        endif // ANJ_WITH_SENML_CBOR_STRINGREF
         buff_ctx->is_extended_type = true;
         // HACK: for ANJ_WITH_EXTERNAL_* types set it to constant value
         // because we don't know the length
@@ -167,61 +317,74 @@ static int prepare_payload(const anj_io_out_entry_t *entry,
         if (!entry->value.external_data.get_external_data) {
             return _ANJ_IO_ERR_INPUT_ARG;
         }
-        buf_pos += anj_cbor_ll_encode_uint(&buff_ctx->internal_buff[buf_pos],
-                                           SENML_LABEL_VALUE_STRING);
-        buf_pos += anj_cbor_ll_indefinite_string_begin(
-                &buff_ctx->internal_buff[buf_pos]);
+        buf_pos += anj_cbor_ll_encode_small_uint(&record_buff[buf_pos],
+                                                 SENML_LABEL_VALUE_STRING);
+        buf_pos += anj_cbor_ll_indefinite_string_begin(&record_buff[buf_pos]);
+#        ifdef ANJ_WITH_SENML_CBOR_STRINGREF
+        // decoders may or may not number the chunks
+        senml_cbor->stringref_stopped = true;
+#        endif // ANJ_WITH_SENML_CBOR_STRINGREF
         buff_ctx->is_extended_type = true;
         buff_ctx->remaining_bytes = 1;
         break;
     }
 #    endif // ANJ_WITH_EXTERNAL_DATA
     case ANJ_DATA_TYPE_TIME: {
-        buf_pos += anj_cbor_ll_encode_uint(&buff_ctx->internal_buff[buf_pos],
-                                           SENML_LABEL_VALUE);
-        buf_pos += anj_cbor_ll_encode_tag(&buff_ctx->internal_buff[buf_pos],
+        buf_pos += anj_cbor_ll_encode_small_uint(&record_buff[buf_pos],
+                                                 SENML_LABEL_VALUE);
+        buf_pos += anj_cbor_ll_encode_tag(&record_buff[buf_pos],
                                           CBOR_TAG_INTEGER_DATE_TIME);
-        buf_pos += anj_cbor_ll_encode_int(&buff_ctx->internal_buff[buf_pos],
+        buf_pos += anj_cbor_ll_encode_int(&record_buff[buf_pos],
                                           entry->value.time_value);
         break;
     }
     case ANJ_DATA_TYPE_INT: {
-        buf_pos += anj_cbor_ll_encode_uint(&buff_ctx->internal_buff[buf_pos],
-                                           SENML_LABEL_VALUE);
-        buf_pos += anj_cbor_ll_encode_int(&buff_ctx->internal_buff[buf_pos],
+        buf_pos += anj_cbor_ll_encode_small_uint(&record_buff[buf_pos],
+                                                 SENML_LABEL_VALUE);
+        buf_pos += anj_cbor_ll_encode_int(&record_buff[buf_pos],
                                           entry->value.int_value);
         break;
     }
     case ANJ_DATA_TYPE_DOUBLE: {
-        buf_pos += anj_cbor_ll_encode_uint(&buff_ctx->internal_buff[buf_pos],
-                                           SENML_LABEL_VALUE);
-        buf_pos += anj_cbor_ll_encode_double(&buff_ctx->internal_buff[buf_pos],
+        buf_pos += anj_cbor_ll_encode_small_uint(&record_buff[buf_pos],
+                                                 SENML_LABEL_VALUE);
+#    ifdef ANJ_WITH_CBOR_ENCODE_SHORTEST_FLOAT
+        buf_pos += anj_cbor_ll_encode_double_shortest(
+                &record_buff[buf_pos], entry->value.double_value);
+#    else  // ANJ_WITH_CBOR_ENCODE_SHORTEST_FLOAT
+        buf_pos += anj_cbor_ll_encode_double(&record_buff[buf_pos],
                                              entry->value.double_value);
+#    endif // ANJ_WITH_CBOR_ENCODE_SHORTEST_FLOAT
         break;
     }
     case ANJ_DATA_TYPE_BOOL: {
-        buf_pos += anj_cbor_ll_encode_uint(&buff_ctx->internal_buff[buf_pos],
-                                           SENML_LABEL_VALUE_BOOL);
-        buf_pos += anj_cbor_ll_encode_bool(&buff_ctx->internal_buff[buf_pos],
+        buf_pos += anj_cbor_ll_encode_small_uint(&record_buff[buf_pos],
+                                                 SENML_LABEL_VALUE_BOOL);
+        buf_pos += anj_cbor_ll_encode_bool(&record_buff[buf_pos],
                                            entry->value.bool_value);
         break;
     }
     case ANJ_DATA_TYPE_OBJLNK: {
         size_t objlink_repr_len = sizeof(SENML_EXT_OBJLNK_REPR) - 1;
-        buf_pos += anj_cbor_ll_string_begin(&buff_ctx->internal_buff[buf_pos],
+        buf_pos += anj_cbor_ll_string_begin(&record_buff[buf_pos],
                                             objlink_repr_len);
-        memcpy(&buff_ctx->internal_buff[buf_pos], SENML_EXT_OBJLNK_REPR,
-               objlink_repr_len);
+        memcpy(&record_buff[buf_pos], SENML_EXT_OBJLNK_REPR, objlink_repr_len);
         buf_pos += objlink_repr_len;
-        buf_pos += _anj_io_out_add_objlink(buff_ctx, buf_pos,
-                                           entry->value.objlnk.oid,
-                                           entry->value.objlnk.iid);
+        size_t objlnk_len = _anj_io_out_add_objlink(buff_ctx, buf_pos,
+                                                    entry->value.objlnk.oid,
+                                                    entry->value.objlnk.iid);
+        buf_pos += objlnk_len;
+#    ifdef ANJ_WITH_SENML_CBOR_STRINGREF
+        // both strings have 1-byte headers
+        stringref_add(senml_cbor, objlink_repr_len);
+        stringref_add(senml_cbor, objlnk_len - 1);
+#    endif // ANJ_WITH_SENML_CBOR_STRINGREF
         break;
     }
     case ANJ_DATA_TYPE_UINT: {
-        buf_pos += anj_cbor_ll_encode_uint(&buff_ctx->internal_buff[buf_pos],
-                                           SENML_LABEL_VALUE);
-        buf_pos += anj_cbor_ll_encode_uint(&buff_ctx->internal_buff[buf_pos],
+        buf_pos += anj_cbor_ll_encode_small_uint(&record_buff[buf_pos],
+                                                 SENML_LABEL_VALUE);
+        buf_pos += anj_cbor_ll_encode_uint(&record_buff[buf_pos],
                                            entry->value.uint_value);
         break;
     }
@@ -235,8 +398,14 @@ static int prepare_payload(const anj_io_out_entry_t *entry,
 
 int _anj_senml_cbor_out_ctx_new_entry(_anj_io_out_ctx_t *ctx,
                                       const anj_io_out_entry_t *entry) {
+#    ifdef ANJ_WITH_SENML_CBOR_STRINGREF
+    assert(ctx->format == _ANJ_COAP_FORMAT_SENML_CBOR
+           || ctx->format == _ANJ_COAP_FORMAT_SENML_ETCH_CBOR
+           || ctx->format == _ANJ_COAP_FORMAT_SENML_CBOR_STRINGREF);
+#    else  // ANJ_WITH_SENML_CBOR_STRINGREF
     assert(ctx->format == _ANJ_COAP_FORMAT_SENML_CBOR
            || ctx->format == _ANJ_COAP_FORMAT_SENML_ETCH_CBOR);
+#    endif // ANJ_WITH_SENML_CBOR_STRINGREF
 
     _anj_senml_cbor_encoder_t *senml_cbor = &ctx->encoder.senml;
     _anj_io_buff_t *buff_ctx = &ctx->buff;
@@ -271,6 +440,13 @@ int _anj_senml_cbor_encoder_init(_anj_io_out_ctx_t *ctx,
     senml_cbor->items_count = items_count;
     senml_cbor->encode_time = encode_time;
     senml_cbor->last_timestamp = 0.0;
+#    ifdef ANJ_WITH_SENML_CBOR_STRINGREF
+    senml_cbor->stringref =
+            ctx->format == _ANJ_COAP_FORMAT_SENML_CBOR_STRINGREF;
+    senml_cbor->stringref_stopped = false;
+    senml_cbor->stringref_count = 0;
+    senml_cbor->stringref_names_count = 0;
+#    endif // ANJ_WITH_SENML_CBOR_STRINGREF
     return 0;
 }
 #endif // ANJ_WITH_SENML_CBOR
@@ -161,6 +161,24 @@ static int text_get_bytes(_anj_io_in_ctx_t *ctx) {
         return _ANJ_IO_WANT_NEXT_PAYLOAD;
     }
 
+    if (ctx->decoder.text.payload_finished && bytes_read
+            && bytes_read % 4 == 0
+            && !ctx->decoder.text.aux.abuf_b64.res_buf_size
+            && !ctx->out_value.bytes_or_string.chunk_length) {
+        // The whole value is in a single payload, so it is decoded in place
+        // at once, without going through the auxiliary buffers.
+        if (anj_base64_decode_custom_n(
+                    &ctx->out_value.bytes_or_string.chunk_length, bytes,
+                    bytes_read, (const char *) bytes, bytes_read,
+                    ANJ_BASE64_DEFAULT_STRICT_CONFIG)) {
+            return _ANJ_IO_ERR_FORMAT;
+        }
+        ctx->out_value.bytes_or_string.data = bytes;
+        ctx->out_value.bytes_or_string.full_length_hint =
+                ctx->out_value.bytes_or_string.chunk_length;
+        return 0;
+    }
+
     // if there are any residual bytes from previous feeding, they are
     // concatenated with new bytes
     size_t bytes_to_decode =
@@ -272,38 +290,55 @@ static int text_get_string(_anj_io_in_ctx_t *ctx) {
     return 0;
 }
 
+/**
+ * Sets @p out_text and @p out_text_size to the whole text of the value, once
+ * it is available. The text is read in place if it is in a single payload,
+ * otherwise it is accumulated in the auxiliary buffer.
+ */
 static int maybe_ask_for_next_payload(_anj_io_in_ctx_t *ctx,
-                                      uint8_t **bytes,
-                                      size_t *bytes_read) {
-    if (text_get_all_remaining_bytes(ctx, bytes_read, (void **) bytes)) {
+                                      const char **out_text,
+                                      size_t *out_text_size) {
+    uint8_t *bytes;
+    size_t bytes_read;
+    if (text_get_all_remaining_bytes(ctx, &bytes_read, (void **) &bytes)) {
         return _ANJ_IO_WANT_NEXT_PAYLOAD;
     }
-    if (*bytes_read + ctx->decoder.text.aux.abuf.size
+    if (bytes_read + ctx->decoder.text.aux.abuf.size
             >= sizeof(ctx->decoder.text.aux.abuf.buf)) {
         return _ANJ_IO_ERR_FORMAT;
     }
+    if (ctx->decoder.text.payload_finished
+            && !ctx->decoder.text.aux.abuf.size) {
+        if (bytes_read == 0) {
+            return _ANJ_IO_ERR_FORMAT;
+        }
+        *out_text = (const char *) bytes;
+        *out_text_size = bytes_read;
+        return 0;
+    }
     memcpy(ctx->decoder.text.aux.abuf.buf + ctx->decoder.text.aux.abuf.size,
-           *bytes, *bytes_read);
-    ctx->decoder.text.aux.abuf.size += *bytes_read;
+           bytes, bytes_read);
+    ctx->decoder.text.aux.abuf.size += bytes_read;
     if (!ctx->decoder.text.payload_finished) {
         ctx->decoder.text.want_payload = true;
         return _ANJ_IO_WANT_NEXT_PAYLOAD;
-    } else if (*bytes_read == 0) {
+    } else if (bytes_read == 0) {
         return _ANJ_IO_ERR_FORMAT;
     }
+    *out_text = ctx->decoder.text.aux.abuf.buf;
+    *out_text_size = ctx->decoder.text.aux.abuf.size;
     return 0;
 }
 
 static int text_get_int(_anj_io_in_ctx_t *ctx, int64_t *out_value) {
-    uint8_t *bytes;
-    size_t bytes_read;
-    int result = maybe_ask_for_next_payload(ctx, &bytes, &bytes_read);
+    const char *text;
+    size_t text_size;
+    int result = maybe_ask_for_next_payload(ctx, &text, &text_size);
     if (result) {
         return result;
     }
 
-    if (anj_string_to_int64_value(out_value, ctx->decoder.text.aux.abuf.buf,
-                                  ctx->decoder.text.aux.abuf.size)) {
+    if (anj_string_to_int64_value(out_value, text, text_size)) {
         return _ANJ_IO_ERR_FORMAT;
     }
     ctx->decoder.text.return_eof_next_time = true;
@@ -311,16 +346,15 @@ static int text_get_int(_anj_io_in_ctx_t *ctx, int64_t *out_value) {
 }
 
 static int text_get_uint(_anj_io_in_ctx_t *ctx) {
-    uint8_t *bytes;
-    size_t bytes_read;
-    int result = maybe_ask_for_next_payload(ctx, &bytes, &bytes_read);
+    const char *text;
+    size_t text_size;
+    int result = maybe_ask_for_next_payload(ctx, &text, &text_size);
     if (result) {
         return result;
     }
 
-    if (anj_string_to_uint64_value(&ctx->out_value.uint_value,
-                                   ctx->decoder.text.aux.abuf.buf,
-                                   ctx->decoder.text.aux.abuf.size)) {
+    if (anj_string_to_uint64_value(&ctx->out_value.uint_value, text,
+                                   text_size)) {
         return _ANJ_IO_ERR_FORMAT;
     }
     ctx->decoder.text.return_eof_next_time = true;
@@ -328,16 +362,15 @@ static int text_get_uint(_anj_io_in_ctx_t *ctx) {
 }
 
 static int text_get_double(_anj_io_in_ctx_t *ctx) {
-    uint8_t *bytes;
-    size_t bytes_read;
-    int result = maybe_ask_for_next_payload(ctx, &bytes, &bytes_read);
+    const char *text;
+    size_t text_size;
+    int result = maybe_ask_for_next_payload(ctx, &text, &text_size);
     if (result) {
         return result;
     }
 
-    if (anj_string_to_double_value(&ctx->out_value.double_value,
-                                   ctx->decoder.text.aux.abuf.buf,
-                                   ctx->decoder.text.aux.abuf.size)) {
+    if (anj_string_to_double_value(&ctx->out_value.double_value, text,
+                                   text_size)) {
         return _ANJ_IO_ERR_FORMAT;
     }
     ctx->decoder.text.return_eof_next_time = true;
@@ -378,18 +411,17 @@ static int text_get_bool(_anj_io_in_ctx_t *ctx) {
     }
 }
 
-static int parse_objlnk(char *objlnk,
+static int parse_objlnk(const char *objlnk,
                         size_t obj_lnk_size,
                         anj_oid_t *out_oid,
                         anj_iid_t *out_iid) {
-    if (strlen(objlnk) > 2 * ANJ_U16_STR_MAX_LEN + 1) {
+    if (obj_lnk_size > 2 * ANJ_U16_STR_MAX_LEN + 1) {
         return -1;
     }
-    char *colon = strchr(objlnk, ':');
+    const char *colon = (const char *) memchr(objlnk, ':', obj_lnk_size);
     if (!colon) {
         return -1;
     }
-    *colon = '\0';
     uint32_t oid;
     uint32_t iid;
     if (anj_string_to_uint32_value(&oid, objlnk, (size_t) (colon - objlnk))
@@ -406,16 +438,14 @@ static int parse_objlnk(char *objlnk,
 }
 
 static int text_get_objlnk(_anj_io_in_ctx_t *ctx) {
-    uint8_t *bytes;
-    size_t bytes_read;
-    int result = maybe_ask_for_next_payload(ctx, &bytes, &bytes_read);
+    const char *text;
+    size_t text_size;
+    int result = maybe_ask_for_next_payload(ctx, &text, &text_size);
     if (result) {
         return result;
     }
 
-    if (parse_objlnk(ctx->decoder.text.aux.abuf.buf,
-                     ctx->decoder.text.aux.abuf.size,
-                     &ctx->out_value.objlnk.oid,
+    if (parse_objlnk(text, text_size, &ctx->out_value.objlnk.oid,
                      &ctx->out_value.objlnk.iid)) {
         return _ANJ_IO_ERR_FORMAT;
     }
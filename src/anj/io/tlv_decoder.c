@@ -163,22 +163,25 @@ static int tlv_get_double(_anj_io_in_ctx_t *ctx) {
         ctx->decoder.tlv.want_payload = true;
         return _ANJ_IO_WANT_NEXT_PAYLOAD;
     }
-    memcpy((uint8_t *) &ctx->out_value.double_value + bytes_already_read, bytes,
-           bytes_read);
+    if (bytes_read != ctx->decoder.tlv.entries->length) {
+        // value split between payloads, assemble it in out_value first
+        memcpy((uint8_t *) &ctx->out_value.double_value + bytes_already_read,
+               bytes, bytes_read);
+        bytes = (uint8_t *) &ctx->out_value.double_value;
+    }
     if (ctx->decoder.tlv.entries->bytes_read
             == ctx->decoder.tlv.entries->length) {
         switch (ctx->decoder.tlv.entries->length) {
         case 4: {
-            // this double is stored in 4 bytes, to avoid compilation warnings
-            // we need to copy it to a uint32_t before converting it
             uint32_t tmp;
-            memcpy(&tmp, &ctx->out_value.uint_value,
-                   ctx->decoder.tlv.entries->length);
+            memcpy(&tmp, bytes, sizeof(tmp));
             ctx->out_value.double_value = _anj_ntohf(tmp);
             break;
         }
         case 8: {
-            ctx->out_value.double_value = _anj_ntohd(ctx->out_value.uint_value);
+            uint64_t tmp;
+            memcpy(&tmp, bytes, sizeof(tmp));
+            ctx->out_value.double_value = _anj_ntohd(tmp);
             break;
         }
         default:
@@ -227,6 +230,12 @@ static int tlv_get_objlnk(_anj_io_in_ctx_t *ctx) {
         ctx->decoder.tlv.want_payload = true;
         return _ANJ_IO_WANT_NEXT_PAYLOAD;
     }
+    if (bytes_read == 4) {
+        // whole value in the input buffer
+        ctx->out_value.objlnk.oid = (uint16_t) ((bytes[0] << 8) | bytes[1]);
+        ctx->out_value.objlnk.iid = (uint16_t) ((bytes[2] << 8) | bytes[3]);
+        return 0;
+    }
     for (size_t i = 0; i < bytes_read; ++i) {
         if (bytes_already_read + i < 2) {
             memcpy((uint8_t *) &ctx->out_value.objlnk.oid + bytes_already_read
@@ -248,26 +257,23 @@ static int tlv_get_objlnk(_anj_io_in_ctx_t *ctx) {
     return 0;
 }
 
-static int tlv_id_length_buff_read_by_copy(_anj_io_in_ctx_t *ctx,
-                                           uint8_t *out,
-                                           size_t length) {
+static const uint8_t *tlv_id_length_read(_anj_io_in_ctx_t *ctx,
+                                         size_t length) {
     if (ctx->decoder.tlv.id_length_buff_read_offset + length
             > sizeof(ctx->decoder.tlv.id_length_buff)) {
-        return -1;
+        return NULL;
     }
-    memcpy(out,
-           ((uint8_t *) ctx->decoder.tlv.id_length_buff)
-                   + ctx->decoder.tlv.id_length_buff_read_offset,
-           length);
+    const uint8_t *bytes = ctx->decoder.tlv.id_length
+                           + ctx->decoder.tlv.id_length_buff_read_offset;
     ctx->decoder.tlv.id_length_buff_read_offset += length;
-    return 0;
+    return bytes;
 }
 
 #    define DEF_READ_SHORTENED(Type)                                           \
         static int read_shortened_##Type(_anj_io_in_ctx_t *ctx, size_t length, \
                                          Type *out) {                          \
-            uint8_t bytes[sizeof(Type)];                                       \
-            if (tlv_id_length_buff_read_by_copy(ctx, bytes, length)) {         \
+            const uint8_t *bytes = tlv_id_length_read(ctx, length);            \
+            if (!bytes) {                                                      \
                 return -1;                                                     \
             }                                                                  \
             *out = 0;                                                          \
@@ -336,17 +342,32 @@ static int get_id(_anj_io_in_ctx_t *ctx,
 }
 
 static int get_type_and_header(_anj_io_in_ctx_t *ctx) {
+    const uint8_t *buff = (const uint8_t *) ctx->decoder.tlv.buff;
     if (ctx->decoder.tlv.type_field == 0xFF) {
-        if (tlv_buff_read_by_copy(ctx, &ctx->decoder.tlv.type_field, 1)) {
+        if (ctx->decoder.tlv.buff_size == ctx->decoder.tlv.buff_offset) {
             ctx->decoder.tlv.want_payload = true;
             return _ANJ_IO_WANT_NEXT_PAYLOAD;
         }
+        ctx->decoder.tlv.type_field = buff[ctx->decoder.tlv.buff_offset++];
         if (ctx->decoder.tlv.type_field == 0xFF) {
             return _ANJ_IO_ERR_FORMAT;
         }
         size_t id_length = (ctx->decoder.tlv.type_field & 0x20) ? 2 : 1;
         size_t length_length = ((ctx->decoder.tlv.type_field >> 3) & 3);
         ctx->decoder.tlv.id_length_buff_bytes_need = id_length + length_length;
+        ctx->decoder.tlv.id_length_buff_read_offset = 0;
+        ctx->decoder.tlv.id_length_buff_write_offset = 0;
+        if (ctx->decoder.tlv.buff_size - ctx->decoder.tlv.buff_offset
+                >= ctx->decoder.tlv.id_length_buff_bytes_need) {
+            // The whole header is in the input buffer, which is always the
+            // case for a payload not split into blocks - read it in place.
+            ctx->decoder.tlv.id_length = buff + ctx->decoder.tlv.buff_offset;
+            ctx->decoder.tlv.buff_offset +=
+                    ctx->decoder.tlv.id_length_buff_bytes_need;
+            ctx->decoder.tlv.id_length_buff_bytes_need = 0;
+            return 0;
+        }
+        ctx->decoder.tlv.id_length = ctx->decoder.tlv.id_length_buff;
     }
     if (ctx->decoder.tlv.id_length_buff_bytes_need > 0) {
         if (ctx->decoder.tlv.buff_size - ctx->decoder.tlv.buff_offset <= 0) {
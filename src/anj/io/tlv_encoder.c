@@ -0,0 +1,314 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#define ANJ_LOG_SOURCE_FILE_ID 63
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/defs.h>
+#include <anj/utils.h>
+
+#include "../coap/coap.h"
+#include "internal.h"
+#include "io.h"
+#include "tlv_encoder.h"
+
+#ifdef ANJ_WITH_TLV_ENCODER
+
+#    define TLV_ID_RIID 1
+#    define TLV_ID_RID_ARRAY 2
+#    define TLV_ID_RID 3
+
+#    define TLV_ID_TYPE_SHIFT 6
+#    define TLV_ID_16BIT 0x20
+#    define TLV_LENGTH_8BIT 0x08
+#    define TLV_LENGTH_16BIT 0x10
+#    define TLV_LENGTH_24BIT 0x18
+#    define TLV_LENGTH_3BIT_MAX 7
+#    define TLV_LENGTH_MAX 0xFFFFFF
+
+#    define TLV_FIXED_NUMBER_LENGTH 8
+#    define TLV_OBJLNK_LENGTH 4
+
+static size_t write_be(uint8_t *buff, uint64_t value, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        buff[i] = (uint8_t) (value >> (8 * (length - 1 - i)));
+    }
+    return length;
+}
+
+static size_t
+header_length(uint16_t id, size_t value_length, bool fixed_width) {
+    size_t length = (fixed_width || id > UINT8_MAX) ? 3 : 2;
+    if (value_length > UINT16_MAX) {
+        return length + 3;
+    } else if (value_length > UINT8_MAX) {
+        return length + 2;
+    } else if (value_length > TLV_LENGTH_3BIT_MAX) {
+        return length + 1;
+    }
+    return length;
+}
+
+static size_t write_header(uint8_t *buff,
+                           uint8_t tlv_id_type,
+                           uint16_t id,
+                           size_t value_length,
+                           bool fixed_width) {
+    size_t pos = 1;
+    buff[0] = (uint8_t) (tlv_id_type << TLV_ID_TYPE_SHIFT);
+    if (fixed_width || id > UINT8_MAX) {
+        buff[0] |= TLV_ID_16BIT;
+        pos += write_be(&buff[pos], id, 2);
+    } else {
+        pos += write_be(&buff[pos], id, 1);
+    }
+    if (value_length > UINT16_MAX) {
+        buff[0] |= TLV_LENGTH_24BIT;
+        pos += write_be(&buff[pos], value_length, 3);
+    } else if (value_length > UINT8_MAX) {
+        buff[0] |= TLV_LENGTH_16BIT;
+        pos += write_be(&buff[pos], value_length, 2);
+    } else if (value_length > TLV_LENGTH_3BIT_MAX) {
+        buff[0] |= TLV_LENGTH_8BIT;
+        pos += write_be(&buff[pos], value_length, 1);
+    } else {
+        buff[0] |= (uint8_t) value_length;
+    }
+    assert(pos == header_length(id, value_length, fixed_width));
+    return pos;
+}
+
+static size_t int_length(int64_t value, bool fixed_width) {
+    if (fixed_width || value < INT32_MIN || value > INT32_MAX) {
+        return 8;
+    } else if (value < INT16_MIN || value > INT16_MAX) {
+        return 4;
+    } else if (value < INT8_MIN || value > INT8_MAX) {
+        return 2;
+    }
+    return 1;
+}
+
+static size_t uint_length(uint64_t value, bool fixed_width) {
+    if (fixed_width || value > UINT32_MAX) {
+        return 8;
+    } else if (value > UINT16_MAX) {
+        return 4;
+    } else if (value > UINT8_MAX) {
+        return 2;
+    }
+    return 1;
+}
+
+/* With fixed_width set, the returned length depends only on the data type, so
+ * it is the same for all instances of a Multiple-Instance Resource. */
+static int get_value_length(const anj_io_out_entry_t *entry,
+                            bool fixed_width,
+                            size_t *out_length) {
+    switch (entry->type) {
+    case ANJ_DATA_TYPE_BYTES:
+    case ANJ_DATA_TYPE_STRING: {
+        if (fixed_width) {
+            return _ANJ_IO_ERR_UNSUPPORTED_FORMAT;
+        }
+        if (entry->value.bytes_or_string.offset != 0
+                || (entry->value.bytes_or_string.full_length_hint
+                    && entry->value.bytes_or_string.full_length_hint
+                               != entry->value.bytes_or_string.chunk_length)) {
+            return _ANJ_IO_ERR_INPUT_ARG;
+        }
+        *out_length = entry->value.bytes_or_string.chunk_length;
+        if (!*out_length && entry->type == ANJ_DATA_TYPE_STRING
+                && entry->value.bytes_or_string.data) {
+            *out_length =
+                    strlen((const char *) entry->value.bytes_or_string.data);
+        }
+        if (*out_length > TLV_LENGTH_MAX) {
+            return _ANJ_IO_ERR_INPUT_ARG;
+        }
+        return 0;
+    }
+    case ANJ_DATA_TYPE_INT:
+        *out_length = int_length(entry->value.int_value, fixed_width);
+        return 0;
+    case ANJ_DATA_TYPE_TIME:
+        *out_length = int_length(entry->value.time_value, fixed_width);
+        return 0;
+    case ANJ_DATA_TYPE_UINT:
+        *out_length = uint_length(entry->value.uint_value, fixed_width);
+        return 0;
+    case ANJ_DATA_TYPE_DOUBLE:
+        *out_length = TLV_FIXED_NUMBER_LENGTH;
+        return 0;
+    case ANJ_DATA_TYPE_BOOL:
+        *out_length = 1;
+        return 0;
+    case ANJ_DATA_TYPE_OBJLNK:
+        *out_length = TLV_OBJLNK_LENGTH;
+        return 0;
+    default:
+        // length of external data is not known in advance
+        return _ANJ_IO_ERR_UNSUPPORTED_FORMAT;
+    }
+}
+
+static void
+write_value(uint8_t *buff, const anj_io_out_entry_t *entry, size_t length) {
+    switch (entry->type) {
+    case ANJ_DATA_TYPE_INT:
+        write_be(buff, (uint64_t) entry->value.int_value, length);
+        break;
+    case ANJ_DATA_TYPE_TIME:
+        write_be(buff, (uint64_t) entry->value.time_value, length);
+        break;
+    case ANJ_DATA_TYPE_UINT:
+        write_be(buff, entry->value.uint_value, length);
+        break;
+    case ANJ_DATA_TYPE_DOUBLE: {
+        uint64_t bits;
+        memcpy(&bits, &entry->value.double_value, sizeof(bits));
+        write_be(buff, bits, length);
+        break;
+    }
+    case ANJ_DATA_TYPE_BOOL:
+        buff[0] = entry->value.bool_value ? 1 : 0;
+        break;
+    case ANJ_DATA_TYPE_OBJLNK:
+        write_be(buff, entry->value.objlnk.oid, 2);
+        write_be(&buff[2], entry->value.objlnk.iid, 2);
+        break;
+    default:
+        // bytes and strings are copied directly from the entry
+        break;
+    }
+}
+
+static int open_multi_res(_anj_tlv_encoder_t *tlv,
+                          _anj_io_buff_t *buff_ctx,
+                          const anj_io_out_entry_t *entry) {
+    size_t value_length;
+    int res = get_value_length(entry, true, &value_length);
+    if (res) {
+        return res;
+    }
+    if (!tlv->res_insts_count) {
+        return _ANJ_IO_ERR_LOGIC;
+    }
+    size_t inst_length = header_length(entry->path.ids[ANJ_ID_RIID],
+                                       value_length, true)
+                         + value_length;
+    size_t multi_res_length = inst_length * tlv->res_insts_count;
+    if (multi_res_length > TLV_LENGTH_MAX) {
+        return _ANJ_IO_ERR_INPUT_ARG;
+    }
+    buff_ctx->bytes_in_internal_buff +=
+            write_header(buff_ctx->internal_buff, TLV_ID_RID_ARRAY,
+                         entry->path.ids[ANJ_ID_RID], multi_res_length, false);
+    tlv->multi_res_rid = entry->path.ids[ANJ_ID_RID];
+    tlv->res_insts_left = tlv->res_insts_count;
+    tlv->res_insts_count = 0;
+    return 0;
+}
+
+int _anj_tlv_encoder_init(_anj_io_out_ctx_t *ctx,
+                          const anj_uri_path_t *base_path) {
+    assert(ctx && base_path);
+    // Object Instance TLVs would require the length of all their Resources
+    // before the first value is read
+    if (!anj_uri_path_has(base_path, ANJ_ID_IID)) {
+        return _ANJ_IO_ERR_UNSUPPORTED_FORMAT;
+    }
+    ctx->encoder.tlv.base_path = *base_path;
+    ctx->encoder.tlv.res_insts_count = 0;
+    ctx->encoder.tlv.res_insts_left = 0;
+    ctx->encoder.tlv.multi_res_rid = ANJ_ID_INVALID;
+    return 0;
+}
+
+void _anj_tlv_encoder_set_res_insts_count(_anj_io_out_ctx_t *ctx,
+                                          uint16_t res_insts_count) {
+    assert(ctx && ctx->format == _ANJ_COAP_FORMAT_OMA_LWM2M_TLV);
+    ctx->encoder.tlv.res_insts_count = res_insts_count;
+}
+
+int _anj_tlv_out_ctx_new_entry(_anj_io_out_ctx_t *ctx,
+                               const anj_io_out_entry_t *entry) {
+    assert(ctx);
+    assert(ctx->format == _ANJ_COAP_FORMAT_OMA_LWM2M_TLV);
+    assert(entry);
+
+    _anj_tlv_encoder_t *tlv = &ctx->encoder.tlv;
+    _anj_io_buff_t *buff_ctx = &ctx->buff;
+
+    if (buff_ctx->remaining_bytes) {
+        return _ANJ_IO_ERR_LOGIC;
+    }
+    if (!anj_uri_path_has(&entry->path, ANJ_ID_RID)
+            || anj_uri_path_outside_base(&entry->path, &tlv->base_path)) {
+        return _ANJ_IO_ERR_INPUT_ARG;
+    }
+
+    bool multi_res_inst = anj_uri_path_is(&entry->path, ANJ_ID_RIID)
+                          && !anj_uri_path_is(&tlv->base_path, ANJ_ID_RIID);
+    if (tlv->res_insts_left
+            && (!multi_res_inst
+                || entry->path.ids[ANJ_ID_RID] != tlv->multi_res_rid)) {
+        // previous Multiple Resource TLV is not complete
+        return _ANJ_IO_ERR_LOGIC;
+    }
+
+    size_t value_length;
+    int res = get_value_length(entry, multi_res_inst, &value_length);
+    if (res) {
+        return res;
+    }
+
+    _anj_io_reset_internal_buff(buff_ctx);
+    if (multi_res_inst && !tlv->res_insts_left) {
+        res = open_multi_res(tlv, buff_ctx, entry);
+        if (res) {
+            return res;
+        }
+    }
+    if (anj_uri_path_is(&entry->path, ANJ_ID_RIID)) {
+        buff_ctx->bytes_in_internal_buff += write_header(
+                &buff_ctx->internal_buff[buff_ctx->bytes_in_internal_buff],
+                TLV_ID_RIID, entry->path.ids[ANJ_ID_RIID], value_length,
+                multi_res_inst);
+    } else {
+        buff_ctx->bytes_in_internal_buff += write_header(
+                &buff_ctx->internal_buff[buff_ctx->bytes_in_internal_buff],
+                TLV_ID_RID, entry->path.ids[ANJ_ID_RID], value_length, false);
+    }
+    if (multi_res_inst) {
+        tlv->res_insts_left--;
+    }
+
+    if (entry->type == ANJ_DATA_TYPE_BYTES
+            || entry->type == ANJ_DATA_TYPE_STRING) {
+        buff_ctx->is_extended_type = true;
+        buff_ctx->remaining_bytes =
+                buff_ctx->bytes_in_internal_buff + value_length;
+    } else {
+        write_value(&buff_ctx->internal_buff[buff_ctx->bytes_in_internal_buff],
+                    entry, value_length);
+        buff_ctx->bytes_in_internal_buff += value_length;
+        buff_ctx->remaining_bytes = buff_ctx->bytes_in_internal_buff;
+    }
+    assert(buff_ctx->bytes_in_internal_buff <= _ANJ_IO_CTX_BUFFER_LENGTH);
+    return 0;
+}
+
+#endif // ANJ_WITH_TLV_ENCODER
@@ -0,0 +1,34 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#ifndef SRC_ANJ_IO_TLV_ENCODER_H
+#    define SRC_ANJ_IO_TLV_ENCODER_H
+
+#    include <stddef.h>
+#    include <stdint.h>
+
+#    include <anj/core.h>
+#    include <anj/defs.h>
+
+#    ifdef ANJ_WITH_TLV_ENCODER
+
+int _anj_tlv_encoder_init(_anj_io_out_ctx_t *ctx,
+                          const anj_uri_path_t *base_path);
+
+int _anj_tlv_out_ctx_new_entry(_anj_io_out_ctx_t *ctx,
+                               const anj_io_out_entry_t *entry);
+
+void _anj_tlv_encoder_set_res_insts_count(_anj_io_out_ctx_t *ctx,
+                                          uint16_t res_insts_count);
+
+#    endif // ANJ_WITH_TLV_ENCODER
+
+#endif // SRC_ANJ_IO_TLV_ENCODER_H
@@ -14,9 +14,16 @@
 #include <assert.h>
 #include <inttypes.h> // IWYU pragma: keep
 #include <stdarg.h>
+#include <stdbool.h> // IWYU pragma: keep
+#include <stddef.h>  // IWYU pragma: keep
+#include <stdint.h>  // IWYU pragma: keep
 #include <stdio.h>
+#include <string.h> // IWYU pragma: keep
 
 #include <anj/compat/log_impl_decls.h>
+#include <anj/compat/time.h>
+#include <anj/log.h>
+#include <anj/time.h>
 #include <anj/utils.h>
 
 #ifdef _ANJ_LOG_USES_BUILTIN_HANDLER_IMPL
@@ -29,6 +36,8 @@
 #        define formatter_va_list(...) vsnprintf(__VA_ARGS__)
 #    endif // ANJ_LOG_FORMATTER_PRINTF
 
+#    if defined(ANJ_LOG_FULL) \
+            || (defined(ANJ_LOG_MICRO) && !defined(ANJ_LOG_MICRO_DEFERRED))
 // generic variadic wrapper for formatters that accept a va_list
 static int
 formatter_variadic(char *buffer, size_t size, const char *format, ...) {
@@ -47,7 +56,6 @@ static inline int actual_formatter_str_len(size_t buffer_size,
     return ANJ_MIN(formatter_retval, (int) (buffer_size - 1));
 }
 
-#    if defined(ANJ_LOG_MICRO) || defined(ANJ_LOG_FULL)
 static const char *level_as_string(anj_log_level_t level) {
     static const char *level_strings[] = {
         [ANJ_LOG_LEVEL_L_TRACE] = "TRACE",
@@ -58,7 +66,8 @@ static const char *level_as_string(anj_log_level_t level) {
     };
     return level < ANJ_LOG_LEVEL_L_MUTED ? level_strings[level] : "???";
 }
-#    endif // defined(ANJ_LOG_MICRO) || defined(ANJ_LOG_FULL)
+#    endif // defined(ANJ_LOG_FULL) || (defined(ANJ_LOG_MICRO) &&
+           // !defined(ANJ_LOG_MICRO_DEFERRED))
 
 #    ifdef ANJ_LOG_FULL
 void anj_log_handler_impl_full(anj_log_level_t level,
@@ -98,7 +107,333 @@ void anj_log_handler_impl_full(anj_log_level_t level,
 }
 #    endif // ANJ_LOG_FULL
 
-#    ifdef ANJ_LOG_MICRO
+#    ifdef ANJ_LOG_MICRO_DEFERRED
+// Every record is stored as:
+// [DEFERRED_SYNC_BYTE][payload length][level][source file id][line][args...]
+// File id, line and integer arguments are varints (LEB128, signed ones
+// zigzag-encoded), doubles are 8 bytes of IEEE 754 representation (little
+// endian), strings are prefixed with a varint length. A record with
+// DEFERRED_LEVEL_DROPPED level carries only the number of dropped records.
+#        define DEFERRED_SYNC_BYTE 0xA5
+#        define DEFERRED_HEADER_SIZE 2
+#        define DEFERRED_PAYLOAD_MAX_SIZE UINT8_MAX
+#        define DEFERRED_LEVEL_DROPPED 0xFF
+
+// Single producer (log statements) and single consumer
+// (anj_log_deferred_read()), each of the indices is written by one side only.
+// Each side publishes its index with a release store after it's done with the
+// data, and the other side reads it with an acquire load before touching it.
+static uint8_t g_ring[ANJ_LOG_DEFERRED_BUFFER_SIZE];
+static size_t g_ring_head;
+static size_t g_ring_tail;
+static uint32_t g_dropped;
+
+typedef struct {
+    uint8_t data[DEFERRED_HEADER_SIZE + DEFERRED_PAYLOAD_MAX_SIZE];
+    size_t size;
+    bool full;
+} record_t;
+
+typedef enum {
+    LENGTH_NONE,
+    LENGTH_HH,
+    LENGTH_H,
+    LENGTH_L,
+    LENGTH_LL,
+    LENGTH_J,
+    LENGTH_Z,
+    LENGTH_T,
+    LENGTH_BIG_L
+} length_modifier_t;
+
+static size_t varint_size(uint64_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+static size_t record_space(const record_t *record) {
+    return record->full ? 0 : sizeof(record->data) - record->size;
+}
+
+static void put_varint(record_t *record, uint64_t value) {
+    if (varint_size(value) > record_space(record)) {
+        record->full = true;
+        return;
+    }
+    while (value >= 0x80) {
+        record->data[record->size++] = (uint8_t) (value | 0x80);
+        value >>= 7;
+    }
+    record->data[record->size++] = (uint8_t) value;
+}
+
+static void put_signed_varint(record_t *record, int64_t value) {
+    put_varint(record, value < 0 ? ~((uint64_t) value << 1)
+                                 : (uint64_t) value << 1);
+}
+
+static void put_double(record_t *record, double value) {
+    if (record_space(record) < sizeof(uint64_t)) {
+        record->full = true;
+        return;
+    }
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    for (size_t i = 0; i < sizeof(bits); ++i) {
+        record->data[record->size++] = (uint8_t) (bits >> (8 * i));
+    }
+}
+
+static void put_string(record_t *record, const char *str, int precision) {
+    if (!str) {
+        str = "(null)";
+    }
+    size_t len = 0;
+    // with precision given, the string doesn't have to be null-terminated
+    while ((precision < 0 || len < (size_t) precision) && str[len]) {
+        ++len;
+    }
+    size_t space = record_space(record);
+    if (varint_size(len) + len > space) {
+        // store as much as possible, the decoder marks the message as cut
+        len = space > varint_size(space) ? space - varint_size(space) : 0;
+    }
+    put_varint(record, len);
+    if (record->full) {
+        return;
+    }
+    memcpy(&record->data[record->size], str, len);
+    record->size += len;
+    if (record_space(record) == 0) {
+        record->full = true;
+    }
+}
+
+static int64_t get_signed_arg(length_modifier_t length, va_list *args) {
+    switch (length) {
+    case LENGTH_HH:
+        return (signed char) va_arg(*args, int);
+    case LENGTH_H:
+        return (short) va_arg(*args, int);
+    case LENGTH_L:
+        return va_arg(*args, long);
+    case LENGTH_LL:
+        return va_arg(*args, long long);
+    case LENGTH_J:
+        return va_arg(*args, intmax_t);
+    case LENGTH_Z:
+        return (int64_t) va_arg(*args, size_t);
+    case LENGTH_T:
+        return va_arg(*args, ptrdiff_t);
+    default:
+        return va_arg(*args, int);
+    }
+}
+
+static uint64_t get_unsigned_arg(length_modifier_t length, va_list *args) {
+    switch (length) {
+    case LENGTH_HH:
+        return (unsigned char) va_arg(*args, unsigned int);
+    case LENGTH_H:
+        return (unsigned short) va_arg(*args, unsigned int);
+    case LENGTH_L:
+        return va_arg(*args, unsigned long);
+    case LENGTH_LL:
+        return va_arg(*args, unsigned long long);
+    case LENGTH_J:
+        return va_arg(*args, uintmax_t);
+    case LENGTH_Z:
+        return va_arg(*args, size_t);
+    case LENGTH_T:
+        return (uint64_t) va_arg(*args, ptrdiff_t);
+    default:
+        return va_arg(*args, unsigned int);
+    }
+}
+
+static length_modifier_t parse_length(const char **format) {
+    const char *f = *format;
+    length_modifier_t length = LENGTH_NONE;
+    switch (*f) {
+    case 'h':
+        length = f[1] == 'h' ? LENGTH_HH : LENGTH_H;
+        break;
+    case 'l':
+        length = f[1] == 'l' ? LENGTH_LL : LENGTH_L;
+        break;
+    case 'j':
+        length = LENGTH_J;
+        break;
+    case 'z':
+        length = LENGTH_Z;
+        break;
+    case 't':
+        length = LENGTH_T;
+        break;
+    case 'L':
+        length = LENGTH_BIG_L;
+        break;
+    default:
+        return LENGTH_NONE;
+    }
+    *format = f + (length == LENGTH_HH || length == LENGTH_LL ? 2 : 1);
+    return length;
+}
+
+// Stores the arguments in the order of conversion specifications. Only the
+// values are kept, the decoder takes the format string from the source code.
+static void put_args(record_t *record, const char *format, va_list *args) {
+    for (const char *f = format; *f && !record->full; ++f) {
+        if (*f != '%') {
+            continue;
+        }
+        if (*++f == '%') {
+            continue;
+        }
+        while (*f && strchr("-+ #0", *f)) {
+            ++f;
+        }
+        if (*f == '*') {
+            put_signed_varint(record, va_arg(*args, int));
+            ++f;
+        }
+        while (*f >= '0' && *f <= '9') {
+            ++f;
+        }
+        int precision = -1;
+        if (*f == '.') {
+            precision = 0;
+            if (*++f == '*') {
+                precision = va_arg(*args, int);
+                put_signed_varint(record, precision);
+                ++f;
+            }
+            while (*f >= '0' && *f <= '9') {
+                precision = precision * 10 + (*f++ - '0');
+            }
+        }
+        length_modifier_t length = parse_length(&f);
+        switch (*f) {
+        case 'd':
+        case 'i':
+            put_signed_varint(record, get_signed_arg(length, args));
+            break;
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            put_varint(record, get_unsigned_arg(length, args));
+            break;
+        case 'c':
+            put_varint(record, (unsigned char) va_arg(*args, int));
+            break;
+        case 'p':
+            put_varint(record, (uintptr_t) va_arg(*args, void *));
+            break;
+        case 's':
+            put_string(record, va_arg(*args, const char *), precision);
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            put_double(record,
+                       length == LENGTH_BIG_L
+                               ? (double) va_arg(*args, long double)
+                               : va_arg(*args, double));
+            break;
+        default:
+            // unknown conversion, the following arguments can't be extracted
+            return;
+        }
+    }
+}
+
+static size_t ring_free_space(void) {
+    size_t head = __atomic_load_n(&g_ring_head, __ATOMIC_RELAXED);
+    size_t tail = __atomic_load_n(&g_ring_tail, __ATOMIC_ACQUIRE);
+    size_t used = (head + ANJ_LOG_DEFERRED_BUFFER_SIZE - tail)
+                  % ANJ_LOG_DEFERRED_BUFFER_SIZE;
+    return ANJ_LOG_DEFERRED_BUFFER_SIZE - 1 - used;
+}
+
+static void ring_push(const record_t *record) {
+    size_t head = __atomic_load_n(&g_ring_head, __ATOMIC_RELAXED);
+    for (size_t i = 0; i < record->size; ++i) {
+        g_ring[head] = record->data[i];
+        head = (head + 1) % ANJ_LOG_DEFERRED_BUFFER_SIZE;
+    }
+    __atomic_store_n(&g_ring_head, head, __ATOMIC_RELEASE);
+}
+
+static void record_init(record_t *record, uint8_t level) {
+    record->data[0] = DEFERRED_SYNC_BYTE;
+    record->data[2] = level;
+    record->size = DEFERRED_HEADER_SIZE + 1;
+    record->full = false;
+}
+
+static void record_finish(record_t *record) {
+    record->data[1] = (uint8_t) (record->size - DEFERRED_HEADER_SIZE);
+}
+
+void anj_log_handler_impl_micro(anj_log_level_t level,
+                                uint16_t source_file_id,
+                                uint16_t line,
+                                const char *format,
+                                ...) {
+    record_t record;
+    record_init(&record, (uint8_t) level);
+    put_varint(&record, source_file_id);
+    put_varint(&record, line);
+    va_list args;
+    va_start(args, format);
+    put_args(&record, format, &args);
+    va_end(args);
+    record_finish(&record);
+
+    size_t free_space = ring_free_space();
+    if (g_dropped) {
+        // the information about dropped records is stored only together with
+        // the next record, so that it doesn't take the space of the latter
+        record_t dropped;
+        record_init(&dropped, DEFERRED_LEVEL_DROPPED);
+        put_varint(&dropped, g_dropped);
+        record_finish(&dropped);
+        if (free_space < dropped.size + record.size) {
+            ++g_dropped;
+            return;
+        }
+        ring_push(&dropped);
+        g_dropped = 0;
+    } else if (free_space < record.size) {
+        ++g_dropped;
+        return;
+    }
+    ring_push(&record);
+}
+
+size_t anj_log_deferred_read(uint8_t *out_data, size_t out_data_size) {
+    assert(out_data || !out_data_size);
+    size_t head = __atomic_load_n(&g_ring_head, __ATOMIC_ACQUIRE);
+    size_t tail = __atomic_load_n(&g_ring_tail, __ATOMIC_RELAXED);
+    size_t read = 0;
+    while (tail != head && read < out_data_size) {
+        out_data[read++] = g_ring[tail];
+        tail = (tail + 1) % ANJ_LOG_DEFERRED_BUFFER_SIZE;
+    }
+    __atomic_store_n(&g_ring_tail, tail, __ATOMIC_RELEASE);
+    return read;
+}
+#    elif defined(ANJ_LOG_MICRO)
 void anj_log_handler_impl_micro(anj_log_level_t level,
                                 uint16_t source_file_id,
                                 uint16_t line,
@@ -136,7 +471,7 @@ void anj_log_handler_impl_micro(anj_log_level_t level,
     anj_log_handler_output(buffer, (size_t) (header_len + msg_len));
 }
 
-#    endif // ANJ_LOG_MICRO
+#    endif // ANJ_LOG_MICRO_DEFERRED
 
 #    ifdef ANJ_LOG_HANDLER_OUTPUT_STDERR
 void anj_log_handler_output(const char *output, size_t len) {
@@ -146,3 +481,201 @@ void anj_log_handler_output(const char *output, size_t len) {
 }
 #    endif // ANJ_LOG_HANDLER_OUTPUT_STDERR
 #endif     // _ANJ_LOG_USES_BUILTIN_HANDLER_IMPL
+
+#if defined(_ANJ_LOG_ENABLED) && defined(ANJ_LOG_RUNTIME_FILTERING)
+typedef struct {
+    char module[ANJ_LOG_RUNTIME_MODULE_NAME_MAX_LEN + 1];
+    anj_log_level_t level;
+} module_level_t;
+
+// lowest of all the levels below, checked before anything else
+anj_log_level_t _anj_log_runtime_min_level = ANJ_LOG_LEVEL_L_TRACE;
+
+static anj_log_level_t g_default_level = ANJ_LOG_LEVEL_L_TRACE;
+static module_level_t g_module_levels[ANJ_LOG_RUNTIME_FILTERING_MAX_MODULES];
+static size_t g_module_levels_count;
+
+static module_level_t *find_module_level(const char *module) {
+    for (size_t i = 0; i < g_module_levels_count; ++i) {
+        if (!strcmp(g_module_levels[i].module, module)) {
+            return &g_module_levels[i];
+        }
+    }
+    return NULL;
+}
+
+static void update_min_level(void) {
+    anj_log_level_t min_level = g_default_level;
+    for (size_t i = 0; i < g_module_levels_count; ++i) {
+        min_level = ANJ_MIN(min_level, g_module_levels[i].level);
+    }
+    _anj_log_runtime_min_level = min_level;
+}
+
+bool _anj_log_runtime_level_check(const char *module, anj_log_level_t level) {
+    const module_level_t *entry = find_module_level(module);
+    return level >= (entry ? entry->level : g_default_level);
+}
+
+int anj_log_runtime_level_set(const char *module, anj_log_level_t level) {
+    if (level > ANJ_LOG_LEVEL_L_MUTED) {
+        return -1;
+    }
+    if (!module) {
+        g_default_level = level;
+        update_min_level();
+        return 0;
+    }
+    module_level_t *entry = find_module_level(module);
+    if (!entry) {
+        if (strlen(module) > ANJ_LOG_RUNTIME_MODULE_NAME_MAX_LEN
+                || g_module_levels_count
+                               == ANJ_LOG_RUNTIME_FILTERING_MAX_MODULES) {
+            return -1;
+        }
+        entry = &g_module_levels[g_module_levels_count++];
+        strcpy(entry->module, module);
+    }
+    entry->level = level;
+    update_min_level();
+    return 0;
+}
+
+static int level_from_string(const char *str, anj_log_level_t *out_level) {
+    static const char *level_names[] = {
+        [ANJ_LOG_LEVEL_L_TRACE] = "TRACE",
+        [ANJ_LOG_LEVEL_L_DEBUG] = "DEBUG",
+        [ANJ_LOG_LEVEL_L_INFO] = "INFO",
+        [ANJ_LOG_LEVEL_L_WARNING] = "WARNING",
+        [ANJ_LOG_LEVEL_L_ERROR] = "ERROR",
+        [ANJ_LOG_LEVEL_L_MUTED] = "MUTED"
+    };
+    if (!strncmp(str, "L_", 2)) {
+        str += 2;
+    }
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(level_names); ++i) {
+        if (!strcmp(str, level_names[i])) {
+            *out_level = (anj_log_level_t) i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int anj_log_runtime_level_set_from_string(const char *setting) {
+    assert(setting);
+    const char *separator = strchr(setting, '=');
+    anj_log_level_t level;
+    if (!separator) {
+        return level_from_string(setting, &level)
+                       ? -1
+                       : anj_log_runtime_level_set(NULL, level);
+    }
+    size_t module_len = (size_t) (separator - setting);
+    if (!module_len || module_len > ANJ_LOG_RUNTIME_MODULE_NAME_MAX_LEN) {
+        return -1;
+    }
+    char module[ANJ_LOG_RUNTIME_MODULE_NAME_MAX_LEN + 1];
+    memcpy(module, setting, module_len);
+    module[module_len] = '\0';
+    if (!separator[1]) {
+        anj_log_runtime_level_reset(module);
+        return 0;
+    }
+    if (level_from_string(separator + 1, &level)) {
+        return -1;
+    }
+    return anj_log_runtime_level_set(module, level);
+}
+
+anj_log_level_t anj_log_runtime_level_get(const char *module) {
+    const module_level_t *entry = module ? find_module_level(module) : NULL;
+    return entry ? entry->level : g_default_level;
+}
+
+void anj_log_runtime_level_reset(const char *module) {
+    if (!module) {
+        g_module_levels_count = 0;
+        g_default_level = ANJ_LOG_LEVEL_L_TRACE;
+    } else {
+        module_level_t *entry = find_module_level(module);
+        if (!entry) {
+            return;
+        }
+        *entry = g_module_levels[--g_module_levels_count];
+    }
+    update_min_level();
+}
+#endif // defined(_ANJ_LOG_ENABLED) && defined(ANJ_LOG_RUNTIME_FILTERING)
+
+#if defined(_ANJ_LOG_ENABLED) && defined(ANJ_LOG_RATE_LIMIT)
+typedef struct {
+    const char *file;
+    int line;
+    uint32_t tokens;
+    uint32_t suppressed;
+    // time of the last token refill
+    int64_t refill_time_ms;
+} rate_limit_site_t;
+
+static rate_limit_site_t g_rate_limit_sites[ANJ_LOG_RATE_LIMIT_SITES];
+
+static void report_suppressed(const char *file, int line, uint32_t count) {
+    anj_log(anj_log, L_WARNING,
+            "%" PRIu32 " log messages from %s:%d suppressed", count, file,
+            line);
+}
+
+bool _anj_log_rate_limit_allow(const char *file, int line) {
+    int64_t now_ms = anj_time_monotonic_to_scalar(anj_time_monotonic_now(),
+                                                  ANJ_TIME_UNIT_MS);
+    // sites from a single file usually share the pointer to its name, so
+    // the line is enough to spread them over the table
+    size_t idx = (size_t) (((uintptr_t) file >> 2) + (uintptr_t) line * 31)
+                 % ANJ_LOG_RATE_LIMIT_SITES;
+    rate_limit_site_t *site = &g_rate_limit_sites[idx];
+
+    // a colliding site replaces the previous one, which is reported if any
+    // of its messages were suppressed
+    rate_limit_site_t evicted = { 0 };
+    if (site->file != file || site->line != line) {
+        evicted = *site;
+        *site = (rate_limit_site_t) {
+            .file = file,
+            .line = line,
+            .tokens = ANJ_LOG_RATE_LIMIT_BURST,
+            .refill_time_ms = now_ms
+        };
+    } else if (now_ms > site->refill_time_ms) {
+        int64_t refilled = (now_ms - site->refill_time_ms)
+                           / ANJ_LOG_RATE_LIMIT_INTERVAL_MS;
+        if (refilled >= ANJ_LOG_RATE_LIMIT_BURST - site->tokens) {
+            site->tokens = ANJ_LOG_RATE_LIMIT_BURST;
+            site->refill_time_ms = now_ms;
+        } else {
+            site->tokens += (uint32_t) refilled;
+            site->refill_time_ms += refilled * ANJ_LOG_RATE_LIMIT_INTERVAL_MS;
+        }
+    }
+
+    bool allowed = site->tokens > 0;
+    uint32_t suppressed = 0;
+    if (allowed) {
+        site->tokens--;
+        suppressed = site->suppressed;
+        site->suppressed = 0;
+    } else if (site->suppressed < UINT32_MAX) {
+        site->suppressed++;
+    }
+
+    // reported after the table is updated, as these statements are rate
+    // limited as well
+    if (evicted.suppressed) {
+        report_suppressed(evicted.file, evicted.line, evicted.suppressed);
+    }
+    if (suppressed) {
+        report_suppressed(file, line, suppressed);
+    }
+    return allowed;
+}
+#endif // defined(_ANJ_LOG_ENABLED) && defined(ANJ_LOG_RATE_LIMIT)
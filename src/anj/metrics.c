@@ -0,0 +1,96 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#define ANJ_LOG_SOURCE_FILE_ID 68
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/core.h>
+#include <anj/metrics.h>
+#include <anj/time.h>
+
+#include "metrics.h"
+
+#ifdef ANJ_WITH_METRICS
+
+void _anj_metrics_exchange_finished(anj_metrics_t *metrics,
+                                    anj_time_duration_t duration) {
+    if (!metrics) {
+        return;
+    }
+    if (!metrics->exchanges
+            || anj_time_duration_lt(duration, metrics->exchange_time_min)) {
+        metrics->exchange_time_min = duration;
+    }
+    if (anj_time_duration_gt(duration, metrics->exchange_time_max)) {
+        metrics->exchange_time_max = duration;
+    }
+    metrics->exchange_time_total =
+            anj_time_duration_add(metrics->exchange_time_total, duration);
+    metrics->exchanges++;
+}
+
+#    ifdef ANJ_METRICS_WITH_HISTOGRAMS
+void _anj_metrics_histogram_add(anj_metrics_t *metrics,
+                                anj_metrics_histogram_id_t histogram,
+                                anj_time_duration_t latency) {
+    assert(histogram < ANJ_METRICS_HISTOGRAM_COUNT);
+    if (!metrics || !anj_time_duration_is_valid(latency)
+            || anj_time_duration_lt(latency, ANJ_TIME_DURATION_ZERO)) {
+        return;
+    }
+    int64_t ms = anj_time_duration_to_scalar(latency, ANJ_TIME_UNIT_MS);
+    size_t bucket = 0;
+    while (ms > 0 && bucket < ANJ_METRICS_HISTOGRAM_BUCKETS - 1) {
+        ms >>= 1;
+        bucket++;
+    }
+    metrics->histograms[histogram].buckets[bucket]++;
+}
+
+anj_time_duration_t
+anj_metrics_histogram_percentile(const anj_metrics_histogram_t *histogram,
+                                 uint8_t percent) {
+    assert(histogram && percent <= 100);
+    uint64_t total = 0;
+    for (size_t i = 0; i < ANJ_METRICS_HISTOGRAM_BUCKETS; i++) {
+        total += histogram->buckets[i];
+    }
+    if (!total) {
+        return ANJ_TIME_DURATION_INVALID;
+    }
+    // number of samples that must not exceed the result, rounded up
+    uint64_t rank = (total * percent + 99) / 100;
+    uint64_t counted = 0;
+    for (size_t i = 0; i < ANJ_METRICS_HISTOGRAM_BUCKETS - 1; i++) {
+        counted += histogram->buckets[i];
+        if (counted >= rank) {
+            return anj_time_duration_new((int64_t) 1 << i, ANJ_TIME_UNIT_MS);
+        }
+    }
+    return ANJ_TIME_DURATION_INVALID;
+}
+#    endif // ANJ_METRICS_WITH_HISTOGRAMS
+
+void anj_core_metrics_get(anj_t *anj, anj_metrics_t *out_metrics) {
+    assert(anj && out_metrics);
+    *out_metrics = anj->metrics;
+}
+
+void anj_core_metrics_reset(anj_t *anj) {
+    assert(anj);
+    memset(&anj->metrics, 0, sizeof(anj->metrics));
+}
+
+#endif // ANJ_WITH_METRICS
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#ifndef SRC_ANJ_METRICS_H
+#    define SRC_ANJ_METRICS_H
+
+#    include <anj/metrics.h>
+#    include <anj/time.h>
+
+#    ifdef ANJ_WITH_METRICS
+
+/* Metrics pointer may be NULL for exchanges that are not counted. */
+#        define _ANJ_METRICS_ADD(Metrics, Field, Value) \
+            do {                                        \
+                if (Metrics) {                          \
+                    (Metrics)->Field += (Value);        \
+                }                                       \
+            } while (0)
+
+/**
+ * Records the duration of an exchange that finished successfully.
+ *
+ * @param metrics  Metrics to update, may be NULL.
+ * @param duration Time elapsed since the exchange has been started.
+ */
+void _anj_metrics_exchange_finished(anj_metrics_t *metrics,
+                                    anj_time_duration_t duration);
+
+#        ifdef ANJ_METRICS_WITH_HISTOGRAMS
+/**
+ * Counts a latency in one of the histograms.
+ *
+ * @param metrics   Metrics to update, may be NULL.
+ * @param histogram Histogram to update.
+ * @param latency   Latency to count, ignored if invalid or negative.
+ */
+void _anj_metrics_histogram_add(anj_metrics_t *metrics,
+                                anj_metrics_histogram_id_t histogram,
+                                anj_time_duration_t latency);
+#        endif // ANJ_METRICS_WITH_HISTOGRAMS
+
+#    else // ANJ_WITH_METRICS
+
+#        define _ANJ_METRICS_ADD(Metrics, Field, Value) ((void) 0)
+
+#    endif // ANJ_WITH_METRICS
+
+#    define _ANJ_METRICS_INC(Metrics, Field) _ANJ_METRICS_ADD(Metrics, Field, 1)
+
+#endif // SRC_ANJ_METRICS_H
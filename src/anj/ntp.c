@@ -205,6 +205,9 @@ static void transaction_end(anj_t *anj,
     }
 #    ifdef ANJ_WITH_PERSISTENCE
     else {
+#        ifdef ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
+        ctx->dirty = true;
+#        endif // ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
         ctx->event_cb(ctx->event_cb_arg, ctx, ANJ_NTP_STATUS_OBJECT_UPDATED,
                       ANJ_TIME_REAL_ZERO);
     }
@@ -225,11 +228,18 @@ static const anj_dm_obj_inst_t NTP_INST = {
 };
 
 #    ifdef ANJ_WITH_PERSISTENCE
-static const uint8_t g_persistence_header[] = { 'N', 'T', 'P',
-                                                0x01 }; // version
+static const uint8_t g_persistence_magic[] = { 'N', 'T', 'P' };
+#        ifdef ANJ_NTP_WITH_DRIFT_COMPENSATION
+// version 2 adds the clock drift estimate
+#            define PERSISTENCE_VERSION 2
+#        else // ANJ_NTP_WITH_DRIFT_COMPENSATION
+#            define PERSISTENCE_VERSION 1
+#        endif // ANJ_NTP_WITH_DRIFT_COMPENSATION
 
 static int instance_persistence(anj_ntp_t *ntp,
-                                const anj_persistence_context_t *ctx) {
+                                const anj_persistence_context_t *ctx,
+                                uint8_t version) {
+    (void) version;
     if (anj_persistence_u32(ctx, &ntp->period_hours)
             || anj_persistence_string(ctx, ntp->server_address,
                                       ANJ_NTP_SERVER_ADDR_MAX_LEN)
@@ -237,6 +247,14 @@ static int instance_persistence(anj_ntp_t *ntp,
                                       ANJ_NTP_SERVER_ADDR_MAX_LEN)) {
         return -1;
     }
+#        ifdef ANJ_NTP_WITH_DRIFT_COMPENSATION
+    if (version >= 2
+            && (anj_persistence_bool(ctx, &ntp->drift_known)
+                || anj_persistence_i32(ctx, &ntp->drift_ppb)
+                || anj_persistence_u32(ctx, &ntp->drift_uncertainty_ppb))) {
+        return -1;
+    }
+#        endif // ANJ_NTP_WITH_DRIFT_COMPENSATION
     return 0;
 }
 
@@ -244,11 +262,12 @@ int anj_ntp_obj_store(anj_ntp_t *ntp, const anj_persistence_context_t *ctx) {
     assert(ntp && ctx);
     assert(anj_persistence_direction(ctx) == ANJ_PERSISTENCE_STORE);
 
-    if (anj_persistence_magic(ctx, g_persistence_header,
-                              sizeof(g_persistence_header))) {
+    if (anj_persistence_version(ctx, g_persistence_magic,
+                                sizeof(g_persistence_magic),
+                                PERSISTENCE_VERSION, NULL)) {
         return -1;
     }
-    if (instance_persistence(ntp, ctx)) {
+    if (instance_persistence(ntp, ctx, PERSISTENCE_VERSION)) {
         ntp_log(L_ERROR, "Failed to store NTP object state");
         return -1;
     }
@@ -260,29 +279,77 @@ int anj_ntp_obj_restore(anj_ntp_t *ntp, const anj_persistence_context_t *ctx) {
     assert(ntp && ctx);
     assert(anj_persistence_direction(ctx) == ANJ_PERSISTENCE_RESTORE);
 
-    if (anj_persistence_magic(ctx, g_persistence_header,
-                              sizeof(g_persistence_header))) {
+    uint8_t version;
+    if (anj_persistence_version(ctx, g_persistence_magic,
+                                sizeof(g_persistence_magic),
+                                PERSISTENCE_VERSION, &version)) {
         return -1;
     }
-    if (instance_persistence(ntp, ctx)) {
+    if (instance_persistence(ntp, ctx, version)) {
         ntp_log(L_ERROR, "Failed to restore NTP object state");
         return -1;
     }
+#        ifdef ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
+    ntp->dirty = false;
+#        endif // ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
     ntp_log(L_INFO, "NTP object state restored successfully");
     return 0;
 }
 #    endif // ANJ_WITH_PERSISTENCE
 
-static bool ntp_period_exceeded(anj_time_monotonic_t last_sync,
-                                uint32_t period_hours) {
+#    ifdef ANJ_NTP_WITH_DRIFT_COMPENSATION
+#        define PPB 1000000000LL
+// larger values are treated as a step of the clock rather than a drift
+#        define MAX_DRIFT_PPB 500000LL
+// shorter intervals give too noisy drift estimates
+#        define MIN_DRIFT_INTERVAL_US (10LL * 60 * 1000000)
+#        define MAX_PERIOD_EXTENSION 8
+
+// time after which the uncertainty of the drift estimate accumulates to the
+// maximum acceptable error
+static anj_time_duration_t adapted_period(anj_ntp_t *ntp,
+                                          anj_time_duration_t period) {
+    if (!ntp->drift_known
+            || !anj_time_duration_gt(ntp->max_time_error,
+                                     ANJ_TIME_DURATION_ZERO)) {
+        return period;
+    }
+    anj_time_duration_t max_period =
+            anj_time_duration_mul(period, MAX_PERIOD_EXTENSION);
+    int64_t error_us =
+            anj_time_duration_to_scalar(ntp->max_time_error, ANJ_TIME_UNIT_US);
+    int64_t uncertainty_ppb =
+            ntp->drift_uncertainty_ppb ? ntp->drift_uncertainty_ppb : 1;
+    if (error_us > INT64_MAX / PPB) {
+        return max_period;
+    }
+    anj_time_duration_t adapted = anj_time_duration_new(
+            error_us * PPB / uncertainty_ppb, ANJ_TIME_UNIT_US);
+    if (anj_time_duration_gt(adapted, max_period)) {
+        return max_period;
+    }
+    return anj_time_duration_gt(adapted, period) ? adapted : period;
+}
+#    endif // ANJ_NTP_WITH_DRIFT_COMPENSATION
+
+static anj_time_duration_t sync_period(anj_ntp_t *ntp) {
+    anj_time_duration_t period = anj_time_duration_new(
+            (int64_t) ntp->period_hours, ANJ_TIME_UNIT_HOUR);
+#    ifdef ANJ_NTP_WITH_DRIFT_COMPENSATION
+    period = adapted_period(ntp, period);
+#    endif // ANJ_NTP_WITH_DRIFT_COMPENSATION
+    return period;
+}
+
+static bool ntp_period_exceeded(anj_ntp_t *ntp) {
     // period of 0 means NTP automatic synchronization is disabled
-    if (period_hours == 0) {
+    if (ntp->period_hours == 0) {
         return false;
     }
-    int64_t elapsed_hours = anj_time_duration_to_scalar(
-            anj_time_monotonic_diff(anj_time_monotonic_now(), last_sync),
-            ANJ_TIME_UNIT_HOUR);
-    return elapsed_hours >= (int64_t) period_hours;
+    return anj_time_duration_geq(
+            anj_time_monotonic_diff(anj_time_monotonic_now(),
+                                    ntp->last_sync_time),
+            sync_period(ntp));
 }
 
 static int connect_with_server(anj_ntp_t *ntp) {
@@ -331,9 +398,9 @@ static void prepare_ntp_request(anj_ntp_t *ntp) {
     ntp->ntp_msg[0] = 0x23; // LI = 0, Version = 4, Mode = 3 (client)
 }
 
-static anj_time_real_t parse_ntp_response(anj_ntp_t *ntp) {
+static anj_time_real_t parse_ntp_timestamp(const uint8_t *timestamp) {
     uint32_t seconds = 0;
-    memcpy(&seconds, &ntp->ntp_msg[40], sizeof(seconds));
+    memcpy(&seconds, timestamp, sizeof(seconds));
     seconds = _anj_convert_be32(seconds);
 
     // NTP timestamp starts from 1900, Unix timestamp starts from 1970.
@@ -354,7 +421,7 @@ static anj_time_real_t parse_ntp_response(anj_ntp_t *ntp) {
     // "fraction" is a 32-bit fraction of a second, so fraction / 2^32
     // gives the fractional part in seconds (always < 1.0).
     uint32_t fraction = 0;
-    memcpy(&fraction, &ntp->ntp_msg[44], sizeof(fraction));
+    memcpy(&fraction, timestamp + 4, sizeof(fraction));
     fraction = _anj_convert_be32(fraction);
     const int64_t NTP_FRAC_SCALE = 4294967296LL; // 2^32
     const int64_t US_PER_SEC = 1000000LL;
@@ -367,6 +434,103 @@ static anj_time_real_t parse_ntp_response(anj_ntp_t *ntp) {
             anj_time_duration_new(total_us, ANJ_TIME_UNIT_US));
 }
 
+static anj_time_real_t parse_ntp_response(anj_ntp_t *ntp) {
+    // Transmit Timestamp
+    return parse_ntp_timestamp(&ntp->ntp_msg[40]);
+}
+
+#    ifdef ANJ_NTP_WITH_DRIFT_COMPENSATION
+static void add_sample(anj_ntp_t *ntp,
+                       anj_time_real_t transmit,
+                       anj_time_duration_t delay,
+                       anj_time_monotonic_t now) {
+    if (anj_time_duration_lt(delay, ANJ_TIME_DURATION_ZERO)) {
+        delay = ANJ_TIME_DURATION_ZERO;
+    }
+    // the response spent about half of the round trip on the way back
+    anj_time_duration_t offset = anj_time_duration_sub(
+            anj_time_duration_add(anj_time_real_to_duration(transmit),
+                                  anj_time_duration_div(delay, 2)),
+            anj_time_monotonic_to_duration(now));
+    if (!ntp->samples_collected
+            || anj_time_duration_lt(delay, ntp->best_delay)) {
+        ntp->best_delay = delay;
+        ntp->best_offset = offset;
+    }
+    ntp->samples_collected++;
+}
+
+static void process_sample(anj_ntp_t *ntp) {
+    anj_time_monotonic_t now = anj_time_monotonic_now();
+    anj_time_duration_t delay =
+            anj_time_monotonic_diff(now, ntp->recv_wait_start_time);
+    anj_time_real_t transmit = parse_ntp_response(ntp);
+    // Receive Timestamp, zero if not reported by the server
+    static const uint8_t ZERO_TIMESTAMP[8] = { 0 };
+    if (memcmp(&ntp->ntp_msg[32], ZERO_TIMESTAMP, sizeof(ZERO_TIMESTAMP))) {
+        anj_time_real_t receive = parse_ntp_timestamp(&ntp->ntp_msg[32]);
+        if (anj_time_real_geq(transmit, receive)) {
+            // time spent by the server does not count to the network delay
+            delay = anj_time_duration_sub(
+                    delay, anj_time_real_diff(transmit, receive));
+        }
+    }
+    add_sample(ntp, transmit, delay, now);
+}
+
+static void update_drift(anj_ntp_t *ntp, anj_time_monotonic_t now) {
+    if (!ntp->sync_offset_known) {
+        return;
+    }
+    int64_t elapsed_us = anj_time_duration_to_scalar(
+            anj_time_monotonic_diff(now, ntp->last_successful_sync),
+            ANJ_TIME_UNIT_US);
+    int64_t offset_change_us = anj_time_duration_to_scalar(
+            anj_time_duration_sub(ntp->best_offset, ntp->sync_offset),
+            ANJ_TIME_UNIT_US);
+    if (elapsed_us < MIN_DRIFT_INTERVAL_US) {
+        return;
+    }
+    if (offset_change_us > INT64_MAX / PPB
+            || offset_change_us < -INT64_MAX / PPB
+            || offset_change_us * PPB / elapsed_us > MAX_DRIFT_PPB
+            || offset_change_us * PPB / elapsed_us < -MAX_DRIFT_PPB) {
+        ntp_log(L_WARNING, "Clock step detected, drift estimate not updated");
+        return;
+    }
+    int32_t measured_ppb = (int32_t) (offset_change_us * PPB / elapsed_us);
+    if (ntp->drift_known) {
+        int64_t change = (int64_t) measured_ppb - ntp->drift_ppb;
+        ntp->drift_uncertainty_ppb = (uint32_t) (change < 0 ? -change : change);
+        ntp->drift_ppb = (int32_t) (((int64_t) ntp->drift_ppb + measured_ppb)
+                                    / 2);
+    } else {
+        // nothing to compare with yet, assume the worst
+        ntp->drift_uncertainty_ppb = (uint32_t) (measured_ppb < 0
+                                                         ? -measured_ppb
+                                                         : measured_ppb);
+        ntp->drift_ppb = measured_ppb;
+        ntp->drift_known = true;
+    }
+#        ifdef ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
+    ntp->dirty = true;
+#        endif // ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
+    ntp_log(L_DEBUG, "Clock drift: %" PRId32 " ppb, uncertainty %" PRIu32
+                     " ppb",
+            ntp->drift_ppb, ntp->drift_uncertainty_ppb);
+}
+
+// must be called before last_successful_sync is updated
+static anj_time_real_t filtered_time(anj_ntp_t *ntp) {
+    anj_time_monotonic_t now = anj_time_monotonic_now();
+    update_drift(ntp, now);
+    ntp->sync_offset = ntp->best_offset;
+    ntp->sync_offset_known = true;
+    return anj_time_real_from_duration(anj_time_duration_add(
+            anj_time_monotonic_to_duration(now), ntp->best_offset));
+}
+#    endif // ANJ_NTP_WITH_DRIFT_COMPENSATION
+
 static void finalize_ntp_synchronization(anj_ntp_t *ntp,
                                          anj_time_real_t synchronized_time) {
     ntp->synchronized = true;
@@ -389,6 +553,20 @@ static void finalize_ntp_synchronization(anj_ntp_t *ntp,
             ms_part);
 }
 
+// a failed request in the middle of a burst does not discard the samples
+// already collected
+static void finalize_with_collected_samples(anj_ntp_t *ntp) {
+#    ifdef ANJ_NTP_WITH_DRIFT_COMPENSATION
+    if (ntp->samples_collected) {
+        ntp_log(L_WARNING, "Using %u of %u NTP samples",
+                ntp->samples_collected, ntp->samples);
+        finalize_ntp_synchronization(ntp, filtered_time(ntp));
+    }
+#    else  // ANJ_NTP_WITH_DRIFT_COMPENSATION
+    (void) ntp;
+#    endif // ANJ_NTP_WITH_DRIFT_COMPENSATION
+}
+
 void anj_ntp_step(anj_ntp_t *ntp) {
     assert(ntp && ntp->event_cb);
 
@@ -402,7 +580,7 @@ void anj_ntp_step(anj_ntp_t *ntp) {
     }
     case INTERNAL_STATE_IDLE: {
         // check if new synchronization should be started
-        if (ntp_period_exceeded(ntp->last_sync_time, ntp->period_hours)) {
+        if (ntp_period_exceeded(ntp)) {
             // reset last_sync_time time to avoid multiple calls, last_sync_time
             // is pointing to the start of synchronization attempt
             ntp->last_sync_time = anj_time_monotonic_now();
@@ -424,6 +602,9 @@ void anj_ntp_step(anj_ntp_t *ntp) {
         ntp_log(L_TRACE, "Connected to NTP server");
 
         prepare_ntp_request(ntp);
+#    ifdef ANJ_NTP_WITH_DRIFT_COMPENSATION
+        ntp->samples_collected = 0;
+#    endif // ANJ_NTP_WITH_DRIFT_COMPENSATION
         ntp->internal_state = INTERNAL_STATE_SENDING_REQUEST;
         break;
     }
@@ -454,6 +635,7 @@ void anj_ntp_step(anj_ntp_t *ntp) {
                                            ntp->response_timeout))) {
             ntp->internal_state = INTERNAL_STATE_DISCONNECTING;
             ntp_log(L_ERROR, "NTP response timed out");
+            finalize_with_collected_samples(ntp);
             break;
         }
 
@@ -463,15 +645,28 @@ void anj_ntp_step(anj_ntp_t *ntp) {
         if (!anj_net_is_ok(result)) {
             ntp->internal_state = INTERNAL_STATE_DISCONNECTING;
             ntp_log(L_ERROR, "Failed to receive NTP response: %d", result);
+            finalize_with_collected_samples(ntp);
             break;
         }
         if (recv_len < _ANJ_NTP_MSG_SIZE) {
             ntp->internal_state = INTERNAL_STATE_DISCONNECTING;
             ntp_log(L_ERROR, "Received NTP response is too short");
+            finalize_with_collected_samples(ntp);
             break;
         }
 
+#    ifdef ANJ_NTP_WITH_DRIFT_COMPENSATION
+        process_sample(ntp);
+        if (ntp->samples_collected < ntp->samples) {
+            // next request of the burst, over the same connection
+            prepare_ntp_request(ntp);
+            ntp->internal_state = INTERNAL_STATE_SENDING_REQUEST;
+            break;
+        }
+        finalize_ntp_synchronization(ntp, filtered_time(ntp));
+#    else  // ANJ_NTP_WITH_DRIFT_COMPENSATION
         finalize_ntp_synchronization(ntp, parse_ntp_response(ntp));
+#    endif // ANJ_NTP_WITH_DRIFT_COMPENSATION
         ntp->internal_state = INTERNAL_STATE_DISCONNECTING;
         break;
     }
@@ -500,12 +695,34 @@ void anj_ntp_step(anj_ntp_t *ntp) {
     }
 }
 
+anj_time_duration_t anj_ntp_next_step_time(anj_ntp_t *ntp) {
+    assert(ntp);
+    if (ntp->internal_state != INTERNAL_STATE_IDLE) {
+        return ANJ_TIME_DURATION_ZERO;
+    }
+    // period of 0 means NTP automatic synchronization is disabled
+    if (ntp->period_hours == 0) {
+        return ANJ_TIME_DURATION_INVALID;
+    }
+    anj_time_monotonic_t next_sync =
+            anj_time_monotonic_add(ntp->last_sync_time, sync_period(ntp));
+    anj_time_duration_t remaining =
+            anj_time_monotonic_diff(next_sync, anj_time_monotonic_now());
+    return anj_time_duration_gt(remaining, ANJ_TIME_DURATION_ZERO)
+                   ? remaining
+                   : ANJ_TIME_DURATION_ZERO;
+}
+
 int anj_ntp_init(anj_t *anj,
                  anj_ntp_t *ntp,
                  const anj_ntp_configuration_t *config) {
     assert(anj && ntp && config);
     ntp_log(L_DEBUG, "Initializing NTP module");
     memset(ntp, 0, sizeof(*ntp));
+#    ifdef ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
+    // nothing is stored yet
+    ntp->dirty = true;
+#    endif // ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
 
     /**
      * Validate configuration: server_address must be set and non-empty,
@@ -537,6 +754,11 @@ int anj_ntp_init(anj_t *anj,
     if (config->net_socket_cfg) {
         ntp->net_socket_cfg = *config->net_socket_cfg;
     }
+#    ifdef ANJ_NTP_WITH_DRIFT_COMPENSATION
+    // if not set, default to 1 sample
+    ntp->samples = config->samples ? config->samples : 1;
+    ntp->max_time_error = config->max_time_error;
+#    endif // ANJ_NTP_WITH_DRIFT_COMPENSATION
     strcpy(ntp->server_address, config->ntp_server_address);
     if (config->backup_ntp_server_address) {
         strcpy(ntp->backup_server_address, config->backup_ntp_server_address);
@@ -564,6 +786,51 @@ int anj_ntp_init(anj_t *anj,
     return 0;
 }
 
+#    ifdef ANJ_NTP_WITH_DRIFT_COMPENSATION
+anj_time_real_t anj_ntp_time_now(anj_ntp_t *ntp) {
+    assert(ntp);
+    if (!ntp->sync_offset_known) {
+        return ANJ_TIME_REAL_INVALID;
+    }
+    anj_time_monotonic_t now = anj_time_monotonic_now();
+    anj_time_duration_t offset = ntp->sync_offset;
+    if (ntp->drift_known) {
+        // millisecond resolution keeps the product in range for years
+        int64_t elapsed_ms = anj_time_duration_to_scalar(
+                anj_time_monotonic_diff(now, ntp->last_successful_sync),
+                ANJ_TIME_UNIT_MS);
+        offset = anj_time_duration_add(
+                offset,
+                anj_time_duration_new(elapsed_ms * ntp->drift_ppb
+                                              / (PPB / 1000),
+                                      ANJ_TIME_UNIT_US));
+    }
+    return anj_time_real_from_duration(
+            anj_time_duration_add(anj_time_monotonic_to_duration(now), offset));
+}
+#    endif // ANJ_NTP_WITH_DRIFT_COMPENSATION
+
+#    ifdef ANJ_NTP_WITH_EXTERNAL_SAMPLES
+int anj_ntp_add_sample(anj_ntp_t *ntp,
+                       anj_time_real_t server_time,
+                       anj_time_duration_t round_trip) {
+    assert(ntp && anj_time_real_is_valid(server_time));
+    if (ntp->internal_state != INTERNAL_STATE_IDLE
+            && ntp->internal_state != INTERNAL_STATE_INIT) {
+        ntp_log(L_WARNING, "NTP synchronization in progress, sample ignored");
+        return ANJ_NTP_ERR_IN_PROGRESS;
+    }
+    if (!anj_time_duration_is_valid(round_trip)) {
+        round_trip = ANJ_TIME_DURATION_ZERO;
+    }
+    ntp->samples_collected = 0;
+    add_sample(ntp, server_time, round_trip, anj_time_monotonic_now());
+    // postpones the next periodic synchronization, like an NTP exchange
+    finalize_ntp_synchronization(ntp, filtered_time(ntp));
+    return 0;
+}
+#    endif // ANJ_NTP_WITH_EXTERNAL_SAMPLES
+
 int anj_ntp_start(anj_ntp_t *ntp) {
     assert(ntp);
     if (ntp->internal_state != INTERNAL_STATE_IDLE
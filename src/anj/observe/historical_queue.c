@@ -0,0 +1,264 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#define ANJ_LOG_SOURCE_FILE_ID 70
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/defs.h>
+#include <anj/utils.h>
+
+#include "observe.h"
+#include "observe_internal.h"
+
+#ifdef ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+
+/* Varint of the time delta followed by the value header and its varint */
+#    define MAX_SAMPLE_SIZE 21
+
+static bool type_supported(anj_data_type_t type) {
+    return type == ANJ_DATA_TYPE_INT || type == ANJ_DATA_TYPE_UINT
+           || type == ANJ_DATA_TYPE_DOUBLE || type == ANJ_DATA_TYPE_BOOL;
+}
+
+static uint64_t value_to_bits(const _anj_observation_res_val_t *value,
+                              anj_data_type_t type) {
+    uint64_t bits;
+    switch (type) {
+    case ANJ_DATA_TYPE_INT:
+        return (uint64_t) value->int_value;
+    case ANJ_DATA_TYPE_UINT:
+        return value->uint_value;
+    case ANJ_DATA_TYPE_BOOL:
+        return value->bool_value ? 1 : 0;
+    default:
+        assert(type == ANJ_DATA_TYPE_DOUBLE);
+        memcpy(&bits, &value->double_value, sizeof(bits));
+        return bits;
+    }
+}
+
+static void bits_to_value(_anj_observation_res_val_t *out_value,
+                          uint64_t bits,
+                          anj_data_type_t type) {
+    switch (type) {
+    case ANJ_DATA_TYPE_INT:
+        out_value->int_value = (int64_t) bits;
+        break;
+    case ANJ_DATA_TYPE_UINT:
+        out_value->uint_value = bits;
+        break;
+    case ANJ_DATA_TYPE_BOOL:
+        out_value->bool_value = !!bits;
+        break;
+    default:
+        assert(type == ANJ_DATA_TYPE_DOUBLE);
+        memcpy(&out_value->double_value, &bits, sizeof(bits));
+        break;
+    }
+}
+
+static size_t put_varint(uint8_t *out, uint64_t value) {
+    size_t size = 0;
+    while (value >= 0x80) {
+        out[size++] = (uint8_t) (value | 0x80);
+        value >>= 7;
+    }
+    out[size++] = (uint8_t) value;
+    return size;
+}
+
+static uint64_t get_varint(const uint8_t *buff, uint16_t *inout_offset) {
+    uint64_t value = 0;
+    unsigned shift = 0;
+    uint8_t byte;
+    do {
+        byte = buff[(*inout_offset)++];
+        value |= (uint64_t) (byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return value;
+}
+
+/* Consecutive values of a double rarely differ in the sign, exponent and the
+ * lowest bits of the mantissa, so what is left after XOR-ing them and
+ * dropping trailing zeros is usually a small number. */
+static size_t put_value_delta(uint8_t *out,
+                              uint64_t prev_bits,
+                              uint64_t bits,
+                              anj_data_type_t type) {
+    if (type == ANJ_DATA_TYPE_DOUBLE) {
+        uint64_t diff = prev_bits ^ bits;
+        if (!diff) {
+            return put_varint(out, 0);
+        }
+        uint8_t trailing_zeros = 0;
+        while (!(diff & 1)) {
+            diff >>= 1;
+            trailing_zeros++;
+        }
+        size_t size = put_varint(out, (uint64_t) trailing_zeros + 1);
+        return size + put_varint(&out[size], diff);
+    }
+    uint64_t diff = bits - prev_bits;
+    /* zigzag encoding of the difference interpreted as a signed number */
+    return put_varint(out, (diff >> 63) ? ~(diff << 1) : diff << 1);
+}
+
+static uint64_t get_value_delta(const uint8_t *buff,
+                                uint16_t *inout_offset,
+                                uint64_t prev_bits,
+                                anj_data_type_t type) {
+    uint64_t encoded = get_varint(buff, inout_offset);
+    if (type == ANJ_DATA_TYPE_DOUBLE) {
+        if (!encoded) {
+            return prev_bits;
+        }
+        uint64_t diff = get_varint(buff, inout_offset) << (encoded - 1);
+        return prev_bits ^ diff;
+    }
+    uint64_t diff = (encoded & 1) ? ~(encoded >> 1) : encoded >> 1;
+    return prev_bits + diff;
+}
+
+static void read_next_sample(const _anj_observe_historical_queue_t *queue,
+                             _anj_observe_historical_queue_iter_t *iter) {
+    if (!iter->index) {
+        iter->timestamp_s = queue->first_timestamp_s;
+        iter->value = queue->first_value;
+    } else {
+        iter->timestamp_s +=
+                (int64_t) get_varint(queue->buff, &iter->offset);
+        bits_to_value(&iter->value,
+                      get_value_delta(queue->buff, &iter->offset,
+                                      value_to_bits(&iter->value, queue->type),
+                                      queue->type),
+                      queue->type);
+    }
+    iter->index++;
+}
+
+void _anj_observe_historical_queue_reset(
+        _anj_observe_historical_queue_t *queue) {
+    assert(queue);
+    queue->count = 0;
+    queue->sent_count = 0;
+    queue->size = 0;
+}
+
+void _anj_observe_historical_queue_drop(_anj_observe_historical_queue_t *queue,
+                                        size_t count) {
+    assert(queue);
+    if (count >= queue->count) {
+        _anj_observe_historical_queue_reset(queue);
+        return;
+    }
+    if (!count) {
+        return;
+    }
+    _anj_observe_historical_queue_iter_t iter = { 0 };
+    while (iter.index <= count) {
+        read_next_sample(queue, &iter);
+    }
+    /* Sample that becomes the oldest one is stored as is */
+    queue->first_timestamp_s = iter.timestamp_s;
+    queue->first_value = iter.value;
+    memmove(queue->buff, &queue->buff[iter.offset],
+            (size_t) (queue->size - iter.offset));
+    queue->size = (uint16_t) (queue->size - iter.offset);
+    queue->count = (uint16_t) (queue->count - count);
+    queue->sent_count = (uint16_t) (queue->sent_count > count
+                                            ? queue->sent_count - count
+                                            : 0);
+}
+
+int _anj_observe_historical_queue_add(_anj_observe_historical_queue_t *queue,
+                                      uint32_t max_count,
+                                      int64_t timestamp_s,
+                                      anj_data_type_t type,
+                                      const _anj_observation_res_val_t *value) {
+    assert(queue && value);
+    if (!max_count || !type_supported(type)) {
+        return -1;
+    }
+    max_count = ANJ_MIN(max_count, UINT16_MAX);
+    if (queue->count && queue->type != type) {
+        if (queue->sent_count) {
+            return -1;
+        }
+        _anj_observe_historical_queue_reset(queue);
+    }
+
+    uint8_t sample[MAX_SAMPLE_SIZE];
+    size_t sample_size = 0;
+    if (queue->count) {
+        /* If the clock goes back, the sample gets the time of the previous
+         * one */
+        uint64_t time_delta =
+                timestamp_s > queue->last_timestamp_s
+                        ? (uint64_t) (timestamp_s - queue->last_timestamp_s)
+                        : 0;
+        sample_size = put_varint(sample, time_delta);
+        sample_size += put_value_delta(&sample[sample_size],
+                                       value_to_bits(&queue->last_value, type),
+                                       value_to_bits(value, type), type);
+        timestamp_s = queue->last_timestamp_s + (int64_t) time_delta;
+    }
+    while (queue->count
+           && (queue->count >= max_count
+               || queue->size + sample_size > sizeof(queue->buff))) {
+        /* Samples included in the notification being sent must be kept */
+        if (queue->sent_count) {
+            return -1;
+        }
+        _anj_observe_historical_queue_drop(queue, 1);
+    }
+
+    if (!queue->count) {
+        queue->type = type;
+        queue->first_timestamp_s = timestamp_s;
+        queue->first_value = *value;
+    } else {
+        memcpy(&queue->buff[queue->size], sample, sample_size);
+        queue->size = (uint16_t) (queue->size + sample_size);
+    }
+    queue->count++;
+    queue->last_timestamp_s = timestamp_s;
+    queue->last_value = *value;
+    return 0;
+}
+
+void _anj_observe_historical_queue_iter_init(
+        _anj_observe_historical_queue_iter_t *iter) {
+    assert(iter);
+    memset(iter, 0, sizeof(*iter));
+}
+
+int _anj_observe_historical_queue_next(
+        const _anj_observe_historical_queue_t *queue,
+        _anj_observe_historical_queue_iter_t *iter,
+        int64_t *out_timestamp_s,
+        _anj_observation_res_val_t *out_value) {
+    assert(queue && iter && out_timestamp_s && out_value);
+    if (iter->index >= queue->count) {
+        return -1;
+    }
+    read_next_sample(queue, iter);
+    *out_timestamp_s = iter->timestamp_s;
+    *out_value = iter->value;
+    return 0;
+}
+
+#endif // ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
@@ -24,6 +24,9 @@
 #include <anj/utils.h>
 
 #include "../dm/dm_integration.h"
+#include "../io/io.h"
+#include "../metrics.h"
+#include "../utils.h"
 #include "observe.h"
 #include "observe_internal.h"
 
@@ -32,7 +35,7 @@
 #    define SUB_ABS(a, b) (((a) > (b)) ? (a) - (b) : (b) - (a))
 #    define MAX_OBSERVE_NUMBER 0xFFFFFF
 
-static void get_min_max_period(_anj_attr_notification_t *effective_attr,
+static void get_min_max_period(const _anj_attr_notification_t *effective_attr,
                                const _anj_observe_server_state_t *server_state,
                                anj_time_duration_t *max_period,
                                anj_time_duration_t *min_period) {
@@ -116,6 +119,13 @@ static int update_last_sent_value(anj_t *anj) {
 #    endif // ANJ_WITH_OBSERVE_COMPOSITE
         if (_anj_observe_attribute_has_value_change_condition(
                     &ctx->processing_observation->effective_attr)) {
+#    ifdef ANJ_OBSERVE_WITH_VALUE_CACHE
+            if (ctx->processing_observation->has_cached_value) {
+                ctx->processing_observation->last_sent_value =
+                        ctx->processing_observation->cached_value;
+                return 0;
+            }
+#    endif // ANJ_OBSERVE_WITH_VALUE_CACHE
             anj_data_type_t res_type;
             return read_resource_value(
                     anj, &ctx->processing_observation->last_sent_value,
@@ -140,6 +150,15 @@ static int update_last_sent_value(anj_t *anj) {
 
 static void mark_notification_as_sent(_anj_observe_ctx_t *ctx) {
     ctx->processing_observation->notification_to_send = false;
+#    ifdef ANJ_OBSERVE_WITH_VALUE_CACHE
+    ctx->processing_observation->has_cached_value = false;
+#    endif // ANJ_OBSERVE_WITH_VALUE_CACHE
+#    ifdef ANJ_OBSERVE_WITH_DEADLINE_INDEX
+    _anj_observe_deadline_index_update(ctx, ctx->processing_observation);
+#    endif // ANJ_OBSERVE_WITH_DEADLINE_INDEX
+#    ifdef ANJ_OBSERVE_WITH_STATE_ARRAYS
+    _anj_observe_state_arrays_update(ctx, ctx->processing_observation);
+#    endif // ANJ_OBSERVE_WITH_STATE_ARRAYS
 #    ifdef ANJ_WITH_OBSERVE_COMPOSITE
     if (ctx->processing_observation->prev) {
         _anj_observe_observation_t *prev_observation =
@@ -147,12 +166,34 @@ static void mark_notification_as_sent(_anj_observe_ctx_t *ctx) {
         while (prev_observation != ctx->processing_observation) {
             assert(prev_observation);
             prev_observation->notification_to_send = false;
+#        ifdef ANJ_OBSERVE_WITH_VALUE_CACHE
+            prev_observation->has_cached_value = false;
+#        endif // ANJ_OBSERVE_WITH_VALUE_CACHE
+#        ifdef ANJ_OBSERVE_WITH_DEADLINE_INDEX
+            _anj_observe_deadline_index_update(ctx, prev_observation);
+#        endif // ANJ_OBSERVE_WITH_DEADLINE_INDEX
+#        ifdef ANJ_OBSERVE_WITH_STATE_ARRAYS
+            _anj_observe_state_arrays_update(ctx, prev_observation);
+#        endif // ANJ_OBSERVE_WITH_STATE_ARRAYS
             prev_observation = prev_observation->prev;
         }
     }
 #    endif // ANJ_WITH_OBSERVE_COMPOSITE
 }
 
+#    ifdef ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+static void drop_sent_historical_values(_anj_observe_ctx_t *ctx) {
+    if (ctx->historical_notification) {
+        /* If the Observation is removed, the queue is cleared anyway when the
+         * slot is reused */
+        ctx->historical_notification = false;
+        _anj_observe_historical_queue_drop(
+                &ctx->processing_observation->historical_queue,
+                ctx->processing_observation->historical_queue.sent_count);
+    }
+}
+#    endif // ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+
 static void notification_exchange_completion(void *arg_ptr,
                                              const _anj_coap_msg_t *response,
                                              int result) {
@@ -162,8 +203,15 @@ static void notification_exchange_completion(void *arg_ptr,
     assert(ctx->in_progress_type == MSG_TYPE_NOTIFY);
     ctx->already_processed = 0;
     _anj_dm_observe_finalize_operation(anj, result);
+#    ifdef ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+    drop_sent_historical_values(ctx);
+#    endif // ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
     if (result == _ANJ_EXCHANGE_RESULT_SUCCESS) {
+#    ifdef ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS
+        ctx->processing_observation->last_etag = ctx->notification_etag;
+#    endif // ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS
         mark_notification_as_sent(ctx);
+        _ANJ_METRICS_INC(&anj->metrics, notifications_sent);
         observe_log(L_INFO, "Notification sent");
         return;
     }
@@ -185,6 +233,328 @@ static void notification_exchange_completion(void *arg_ptr,
     _anj_observe_remove_observation(ctx);
 }
 
+#    ifdef ANJ_WITH_PIPELINED_NOTIFICATIONS
+void _anj_observe_detach_notification(
+        anj_t *anj, _anj_observe_detached_notification_t *out_notification) {
+    assert(anj && out_notification);
+    _anj_observe_ctx_t *ctx = &anj->observe_ctx;
+    assert(ctx->in_progress_type == MSG_TYPE_NOTIFY
+           && ctx->processing_observation);
+    out_notification->observation = ctx->processing_observation;
+    out_notification->ssid = ctx->processing_observation->ssid;
+    out_notification->token = ctx->processing_observation->token;
+#        ifdef ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS
+    out_notification->etag = ctx->notification_etag;
+#        endif // ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS
+    ctx->already_processed = 0;
+    _anj_dm_observe_finalize_operation(anj, _ANJ_EXCHANGE_RESULT_SUCCESS);
+#        ifdef ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+    drop_sent_historical_values(ctx);
+#        endif // ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+    // if the notification is rejected, the Observation is removed anyway
+    mark_notification_as_sent(ctx);
+}
+
+void _anj_observe_detached_notification_completion(
+        anj_t *anj,
+        const _anj_observe_detached_notification_t *notification,
+        int result) {
+    assert(anj && notification);
+    _anj_observe_ctx_t *ctx = &anj->observe_ctx;
+    _anj_observe_observation_t *observation = notification->observation;
+    if (observation->ssid != notification->ssid
+            || !_anj_tokens_equal(&observation->token, &notification->token)) {
+        observe_log(L_DEBUG, "Observation removed before notification result");
+        return;
+    }
+    if (result == _ANJ_EXCHANGE_RESULT_SUCCESS) {
+#        ifdef ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS
+        observation->last_etag = notification->etag;
+#        endif // ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS
+        _ANJ_METRICS_INC(&anj->metrics, notifications_sent);
+        observe_log(L_INFO, "Notification sent");
+        return;
+    }
+#        ifndef ANJ_OBSERVE_OBSERVATION_CANCEL_ON_TIMEOUT
+    if (result == _ANJ_EXCHANGE_ERROR_TIMEOUT) {
+        observe_log(L_WARNING,
+                    "Timeout while waiting for notification ACK, "
+                    "but observation will be kept");
+        return;
+    }
+#        endif // ANJ_OBSERVE_OBSERVATION_CANCEL_ON_TIMEOUT
+
+    if (result == _ANJ_EXCHANGE_ERROR_SERVER_RESPONSE) {
+        observe_log(L_ERROR, "Server rejected notification");
+    } else {
+        observe_log(L_ERROR, "Notification sending failed: %d", result);
+    }
+    // other notification may be in progress
+    _anj_observe_observation_t *processing_observation =
+            ctx->processing_observation;
+    ctx->processing_observation = observation;
+    _anj_observe_remove_observation(ctx);
+    ctx->processing_observation = processing_observation;
+}
+#    endif // ANJ_WITH_PIPELINED_NOTIFICATIONS
+
+#    ifdef ANJ_OBSERVE_WITH_COMPOSITE_DELTA_NOTIFICATIONS
+static anj_time_monotonic_t calculate_next_notify_check_timestamp(
+        const _anj_observe_observation_t *observation,
+        anj_time_duration_t min_period,
+        anj_time_duration_t max_period);
+
+static bool
+must_be_included_in_delta(const _anj_observe_observation_t *observation,
+                          const _anj_observe_server_state_t *server_state,
+                          anj_time_monotonic_t current_time) {
+    if (observation->notification_to_send
+            || anj_time_monotonic_lt(current_time,
+                                     observation->last_included_timestamp)) {
+        return true;
+    }
+    anj_time_duration_t min_period;
+    anj_time_duration_t max_period;
+    get_min_max_period(&observation->effective_attr, server_state, &max_period,
+                       &min_period);
+    anj_time_monotonic_t deadline = calculate_next_notify_check_timestamp(
+            observation, min_period, max_period);
+    return anj_time_monotonic_leq(deadline, current_time);
+}
+
+/* Leaves only the paths that were reported as changed or whose maximum period
+ * has expired. The path of the Observation that triggered the notification is
+ * always kept, so that the payload is never empty. uri_paths are set in the
+ * same order in which the Observations are linked. */
+static void
+select_composite_delta_paths(_anj_observe_ctx_t *ctx,
+                             const _anj_observe_server_state_t *server_state) {
+    anj_time_monotonic_t current_time = _ANJ_STEP_TIME_NOW(ctx->step_time);
+    _anj_observe_observation_t *iterator = ctx->processing_observation;
+    size_t read_idx = 0;
+    size_t written = 0;
+    do {
+        /* Paths not present in the data model are not sent anyway */
+        if (read_idx < ctx->uri_count
+                && ctx->uri_paths[read_idx] == &iterator->path) {
+            read_idx++;
+            if (iterator == ctx->processing_observation
+                    || must_be_included_in_delta(iterator, server_state,
+                                                 current_time)) {
+                ctx->uri_paths[written++] = &iterator->path;
+            } else {
+                iterator->excluded_from_notification = true;
+            }
+        }
+        iterator = iterator->prev;
+    } while (iterator != ctx->processing_observation);
+    ctx->uri_count = written;
+}
+#    endif // ANJ_OBSERVE_WITH_COMPOSITE_DELTA_NOTIFICATIONS
+
+#    ifdef ANJ_OBSERVE_WITH_CON_POLICY
+/* Counts the notification and consumes the threshold crossing events of all
+ * Observations notified together. */
+static void count_notification(_anj_observe_observation_t *observation,
+                               bool *threshold_crossed) {
+    *threshold_crossed = *threshold_crossed || observation->threshold_crossed;
+    observation->threshold_crossed = false;
+    if (observation->non_con_count < UINT16_MAX) {
+        observation->non_con_count++;
+    }
+}
+
+static bool con_forced_by_policy(_anj_observe_observation_t *observation) {
+    bool threshold_crossed = false;
+#        ifdef ANJ_WITH_OBSERVE_COMPOSITE
+    _anj_observe_observation_t *iterator = observation;
+    do {
+        count_notification(iterator, &threshold_crossed);
+        iterator = iterator->prev;
+    } while (iterator && iterator != observation);
+#        else  // ANJ_WITH_OBSERVE_COMPOSITE
+    count_notification(observation, &threshold_crossed);
+#        endif // ANJ_WITH_OBSERVE_COMPOSITE
+    return threshold_crossed
+           || (ANJ_OBSERVE_CON_POLICY_EVERY_N > 0
+               && observation->non_con_count
+                          >= ANJ_OBSERVE_CON_POLICY_EVERY_N);
+}
+#    endif // ANJ_OBSERVE_WITH_CON_POLICY
+
+#    ifdef ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+static bool
+historical_queue_enabled(const _anj_observe_observation_t *observation) {
+    return observation->effective_attr.has_hqmax
+           && observation->effective_attr.hqmax > 0
+           && anj_uri_path_has(&observation->path, ANJ_ID_RID)
+#        ifdef ANJ_WITH_OBSERVE_COMPOSITE
+           && !observation->prev
+#        endif // ANJ_WITH_OBSERVE_COMPOSITE
+            ;
+}
+
+static int64_t historical_timestamp_now(void) {
+    return anj_time_real_to_scalar(anj_time_real_now(), ANJ_TIME_UNIT_S);
+}
+
+/* Records the current value of the observed Resource in the historical queue.
+ * Value read already for another purpose is reused, otherwise it is read here
+ * and passed back, so that it can be reused for other Observations. */
+static void
+record_historical_sample(anj_t *anj,
+                         _anj_observe_observation_t *observation,
+                         _anj_observation_res_val_t *observe_value,
+                         anj_data_type_t *res_type,
+                         bool *already_read) {
+    if (!historical_queue_enabled(observation)) {
+        return;
+    }
+    if (!*already_read) {
+        anj_res_value_t value;
+        bool multi_res = false;
+        if (_anj_dm_observe_read_resource(anj, &value, res_type, &multi_res,
+                                          &observation->path)
+                || multi_res
+                || (*res_type != ANJ_DATA_TYPE_INT
+                    && *res_type != ANJ_DATA_TYPE_UINT
+                    && *res_type != ANJ_DATA_TYPE_DOUBLE
+                    && *res_type != ANJ_DATA_TYPE_BOOL)) {
+            return;
+        }
+        _anj_observe_write_anj_res_to_observe_val(observe_value, &value,
+                                                  res_type);
+        *already_read = true;
+    }
+    if (_anj_observe_historical_queue_add(
+                &observation->historical_queue,
+                observation->effective_attr.hqmax, historical_timestamp_now(),
+                *res_type, observe_value)) {
+        observe_log(L_WARNING, "Historical sample dropped");
+    }
+}
+
+/* Observation with a pending notification is not checked again, but the value
+ * of its Resource is still recorded. */
+static void
+record_pending_historical_sample(anj_t *anj,
+                                 _anj_observe_observation_t *observation,
+                                 anj_observe_change_type_t change_type,
+                                 uint16_t ssid,
+                                 _anj_observation_res_val_t *observe_value,
+                                 anj_data_type_t *res_type,
+                                 bool *already_read) {
+    if (change_type == ANJ_OBSERVE_CHANGE_TYPE_VALUE_CHANGED
+            && observation->notification_to_send
+            && observation->observe_active
+            && (ssid == 0 ? observation->ssid : observation->ssid != ssid)) {
+        record_historical_sample(anj, observation, observe_value, res_type,
+                                 already_read);
+    }
+}
+
+static uint8_t
+build_historical_message(void *arg_ptr,
+                         uint8_t *buff,
+                         size_t buff_len,
+                         _anj_exchange_read_result_t *out_params) {
+    anj_t *anj = (anj_t *) arg_ptr;
+    _anj_observe_ctx_t *ctx = &anj->observe_ctx;
+    const _anj_observe_observation_t *observation =
+            ctx->processing_observation;
+    const _anj_observe_historical_queue_t *queue =
+            &observation->historical_queue;
+    int res;
+    size_t copied_bytes;
+
+    out_params->format = _anj_io_out_ctx_get_format(&anj->anj_io.out_ctx);
+    while (true) {
+        if (!ctx->historical_data_to_copy) {
+            anj_io_out_entry_t record = {
+                .path = observation->path,
+                .type = queue->type
+            };
+            int64_t timestamp_s;
+            _anj_observation_res_val_t value;
+            res = _anj_observe_historical_queue_next(
+                    queue, &ctx->historical_iter, &timestamp_s, &value);
+            assert(!res);
+            _anj_observe_write_observe_val_to_anj_res(&record.value, &value,
+                                                      queue->type);
+            record.timestamp = (double) timestamp_s;
+#ifdef ANJ_WITH_DIRECT_PAYLOAD_ENCODING
+            res = _anj_io_out_ctx_new_entry_direct(
+                    &anj->anj_io.out_ctx, &record,
+                    &buff[out_params->payload_len],
+                    buff_len - out_params->payload_len);
+#else  // ANJ_WITH_DIRECT_PAYLOAD_ENCODING
+            res = _anj_io_out_ctx_new_entry(&anj->anj_io.out_ctx, &record);
+#endif // ANJ_WITH_DIRECT_PAYLOAD_ENCODING
+            if (res) {
+                observe_log(L_ERROR, "anj_io out ctx error %d", res);
+                return ANJ_COAP_CODE_INTERNAL_SERVER_ERROR;
+            }
+        }
+        res = _anj_io_out_ctx_get_payload(&anj->anj_io.out_ctx,
+                                          &buff[out_params->payload_len],
+                                          buff_len - out_params->payload_len,
+                                          &copied_bytes);
+        out_params->payload_len += copied_bytes;
+        // last sample copied
+        if (res == 0 && ctx->historical_iter.index == queue->sent_count) {
+            return 0;
+        }
+        if (res == ANJ_IO_NEED_NEXT_CALL) {
+            assert(out_params->payload_len == buff_len);
+            ctx->historical_data_to_copy = true;
+            return _ANJ_EXCHANGE_BLOCK_TRANSFER_NEEDED;
+        } else if (res) {
+            observe_log(L_ERROR, "anj_io out ctx error %d", res);
+            ctx->historical_data_to_copy = false;
+            return ANJ_COAP_CODE_INTERNAL_SERVER_ERROR;
+        }
+        ctx->historical_data_to_copy = false;
+        if (buff_len == out_params->payload_len) {
+            return _ANJ_EXCHANGE_BLOCK_TRANSFER_NEEDED;
+        }
+    }
+}
+
+/* Notification of an Observation with the hqmax attribute contains all queued
+ * samples and the current value, as timestamped SenML CBOR records. Returns
+ * false if a regular notification has to be sent instead. */
+static bool prepare_historical_notification(anj_t *anj) {
+    _anj_observe_ctx_t *ctx = &anj->observe_ctx;
+    _anj_observe_observation_t *observation = ctx->processing_observation;
+    _anj_observe_historical_queue_t *queue = &observation->historical_queue;
+    ctx->historical_notification = false;
+    if (!historical_queue_enabled(observation)) {
+        return false;
+    }
+    /* Sample taken in the same second is used as the current value */
+    if (!queue->count
+            || queue->last_timestamp_s != historical_timestamp_now()) {
+        _anj_observation_res_val_t value;
+        anj_data_type_t type;
+        bool already_read = false;
+        record_historical_sample(anj, observation, &value, &type,
+                                 &already_read);
+    }
+    if (!queue->count
+            || _anj_io_out_ctx_init(&anj->anj_io.out_ctx,
+                                    ANJ_OP_INF_NON_CON_NOTIFY,
+                                    &ANJ_MAKE_ROOT_PATH(), queue->count,
+                                    _ANJ_COAP_FORMAT_SENML_CBOR)) {
+        return false;
+    }
+    queue->sent_count = queue->count;
+    _anj_observe_historical_queue_iter_init(&ctx->historical_iter);
+    ctx->historical_data_to_copy = false;
+    ctx->historical_notification = true;
+    return true;
+}
+#    endif // ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+
 static int create_notification(anj_t *anj,
                                _anj_exchange_handlers_t *out_handlers,
                                const _anj_observe_server_state_t *server_state,
@@ -201,8 +571,18 @@ static int create_notification(anj_t *anj,
         .arg = anj
     };
     ctx->in_progress_type = MSG_TYPE_NOTIFY;
+#    ifdef ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+    if (prepare_historical_notification(anj)) {
+        out_handlers->read_payload = build_historical_message;
+    }
+#    endif // ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
 
     _anj_observe_set_uri_paths_and_format(anj);
+#    ifdef ANJ_OBSERVE_WITH_COMPOSITE_DELTA_NOTIFICATIONS
+    if (ctx->processing_observation->prev) {
+        select_composite_delta_paths(ctx, server_state);
+    }
+#    endif // ANJ_OBSERVE_WITH_COMPOSITE_DELTA_NOTIFICATIONS
 #    ifdef ANJ_WITH_LWM2M12
     bool con_attr = false;
     bool has_con_attr = false;
@@ -235,14 +615,24 @@ static int create_notification(anj_t *anj,
 #    endif // ANJ_WITH_LWM2M12
     // send a confirmable notification at least once every 24 hours
     if (anj_time_monotonic_geq(
-                anj_time_monotonic_now(),
+                _ANJ_STEP_TIME_NOW(ctx->step_time),
                 ctx->processing_observation->next_conf_notify_timestamp)) {
         out_msg->operation = ANJ_OP_INF_CON_NOTIFY;
     }
+#    ifdef ANJ_OBSERVE_WITH_CON_POLICY
+    if (con_forced_by_policy(ctx->processing_observation)) {
+        out_msg->operation = ANJ_OP_INF_CON_NOTIFY;
+    }
+#    endif // ANJ_OBSERVE_WITH_CON_POLICY
 
     // set token
     memcpy(&out_msg->token, &ctx->processing_observation->token,
            sizeof(_anj_coap_token_t));
+#    ifdef ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS
+    // exchange module replaces the payload with 2.03 Valid if it is the same
+    out_msg->etag = ctx->processing_observation->last_etag;
+    ctx->notification_etag.size = 0;
+#    endif // ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS
     ctx->processing_observation->observe_number =
             (ctx->processing_observation->observe_number + 1)
             % (MAX_OBSERVE_NUMBER + 1);
@@ -250,21 +640,310 @@ static int create_notification(anj_t *anj,
 #    ifdef ANJ_WITH_OBSERVE_COMPOSITE
     sync_composite_observe_number(ctx->processing_observation);
 #    endif
-    _anj_observe_refresh_timestamp(ctx, anj_time_monotonic_now(),
+    _anj_observe_refresh_timestamp(ctx, _ANJ_STEP_TIME_NOW(ctx->step_time),
                                    out_msg->operation == ANJ_OP_INF_CON_NOTIFY);
     return 0;
 }
 
+#    ifdef ANJ_OBSERVE_NOTIFICATION_ALIGNMENT_TICK_S
+/* Moves the pmax deadline back to the closest multiple of the alignment tick,
+ * so that Observations with different pmax deadlines wake the device up at the
+ * same time. The deadline is left untouched if aligning it would violate pmin.
+ */
 static anj_time_monotonic_t
-calculate_next_notify_check_timestamp(_anj_observe_observation_t *observation,
-                                      anj_time_duration_t max_period) {
+align_deadline(anj_time_monotonic_t deadline,
+               const _anj_observe_observation_t *observation,
+               anj_time_duration_t min_period) {
+    const int64_t tick_us =
+            (int64_t) ANJ_OBSERVE_NOTIFICATION_ALIGNMENT_TICK_S * 1000000;
+    int64_t deadline_us =
+            anj_time_monotonic_to_scalar(deadline, ANJ_TIME_UNIT_US);
+    anj_time_monotonic_t aligned = anj_time_monotonic_new(
+            deadline_us - deadline_us % tick_us, ANJ_TIME_UNIT_US);
+    if (anj_time_monotonic_gt(
+                aligned, anj_time_monotonic_add(
+                                 observation->last_notify_timestamp,
+                                 min_period))) {
+        return aligned;
+    }
+    return deadline;
+}
+#    endif // ANJ_OBSERVE_NOTIFICATION_ALIGNMENT_TICK_S
+
+#    ifdef ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER
+/* If the server is offline and Notification Storing is enabled, the value of a
+ * single Resource is recorded in the notify store buffer instead of sending a
+ * notification. Returns true if the value has been recorded. */
+static bool store_notification(anj_t *anj,
+                               const _anj_observe_server_state_t *server_state) {
+    _anj_observe_ctx_t *ctx = &anj->observe_ctx;
+    _anj_observe_observation_t *observation = ctx->processing_observation;
+    if (server_state->is_server_online || !server_state->notify_store
+            || !anj_uri_path_has(&observation->path, ANJ_ID_RID)
+#        ifdef ANJ_WITH_OBSERVE_COMPOSITE
+            || observation->prev
+#        endif // ANJ_WITH_OBSERVE_COMPOSITE
+    ) {
+        return false;
+    }
+    anj_res_value_t value;
+    anj_data_type_t type;
+    bool multi_res = false;
+    /* In case of an error, the Observation will be handled as usual */
+    if (_anj_dm_observe_read_resource(anj, &value, &type, &multi_res,
+                                      &observation->path)
+            || multi_res
+            || _anj_observe_notify_store_add(ctx, &observation->path, type,
+                                             &value)) {
+        return false;
+    }
+    if (_anj_observe_attribute_has_value_change_condition(
+                &observation->effective_attr)) {
+        _anj_observe_write_anj_res_to_observe_val(
+                &observation->last_sent_value, &value, &type);
+    }
+    _anj_observe_refresh_timestamp(ctx, _ANJ_STEP_TIME_NOW(ctx->step_time),
+                                   false);
+    mark_notification_as_sent(ctx);
+    observe_log(L_DEBUG, "Notification stored");
+    return true;
+}
+#    endif // ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER
+
+static anj_time_monotonic_t calculate_next_notify_check_timestamp(
+        const _anj_observe_observation_t *observation,
+        anj_time_duration_t min_period,
+        anj_time_duration_t max_period) {
     if (anj_time_duration_eq(max_period, ANJ_TIME_DURATION_ZERO)) {
         return ANJ_TIME_MONOTONIC_INVALID;
     }
 
-    return anj_time_monotonic_add(observation->last_notify_timestamp,
-                                  max_period);
+    anj_time_monotonic_t last_notify_timestamp =
+            observation->last_notify_timestamp;
+#    ifdef ANJ_OBSERVE_WITH_COMPOSITE_DELTA_NOTIFICATIONS
+    /* Path of a composite observation might not have been sent in the last
+     * notification */
+    if (observation->prev) {
+        last_notify_timestamp = observation->last_included_timestamp;
+    }
+#    endif // ANJ_OBSERVE_WITH_COMPOSITE_DELTA_NOTIFICATIONS
+    anj_time_monotonic_t deadline =
+            anj_time_monotonic_add(last_notify_timestamp, max_period);
+#    ifdef ANJ_OBSERVE_NOTIFICATION_ALIGNMENT_TICK_S
+    deadline = align_deadline(deadline, observation, min_period);
+#    else  // ANJ_OBSERVE_NOTIFICATION_ALIGNMENT_TICK_S
+    (void) min_period;
+#    endif // ANJ_OBSERVE_NOTIFICATION_ALIGNMENT_TICK_S
+    return deadline;
+}
+
+#    ifdef ANJ_OBSERVE_WITH_NOTIFICATION_COALESCING
+/* Called after each attempt to create a notification. The first notification
+ * opens a coalescing window, and the window is closed as soon as there is
+ * nothing more to send. */
+static void update_coalescing_window(_anj_observe_ctx_t *ctx,
+                                     const _anj_coap_msg_t *out_msg,
+                                     anj_time_monotonic_t current_time) {
+    if (out_msg->operation != ANJ_OP_INF_CON_NOTIFY
+            && out_msg->operation != ANJ_OP_INF_NON_CON_NOTIFY) {
+        ctx->coalescing_start = ANJ_TIME_MONOTONIC_INVALID;
+    } else if (!anj_time_monotonic_is_valid(ctx->coalescing_start)) {
+        ctx->coalescing_start = current_time;
+    }
+}
+
+/* Checks if the Observation should be notified along with the ones that are
+ * actually due. Observations already notified since the window was opened are
+ * skipped, so that a pmax shorter than the window doesn't prolong it. */
+static bool
+within_coalescing_window(const _anj_observe_ctx_t *ctx,
+                         const _anj_observe_observation_t *observation,
+                         anj_time_monotonic_t next_notify_check_timestamp) {
+    if (!anj_time_monotonic_is_valid(ctx->coalescing_start)
+            || !anj_time_monotonic_is_valid(next_notify_check_timestamp)
+            || !anj_time_monotonic_lt(observation->last_notify_timestamp,
+                                      ctx->coalescing_start)) {
+        return false;
+    }
+    return anj_time_monotonic_leq(
+            next_notify_check_timestamp,
+            anj_time_monotonic_add(
+                    ctx->coalescing_start,
+                    anj_time_duration_new(
+                            ANJ_OBSERVE_NOTIFICATION_COALESCING_WINDOW_S,
+                            ANJ_TIME_UNIT_S)));
+}
+#    endif // ANJ_OBSERVE_WITH_NOTIFICATION_COALESCING
+
+#    ifdef ANJ_OBSERVE_WITH_DEADLINE_INDEX
+#        define DEADLINE_NOT_INDEXED UINT16_MAX
+
+static anj_time_monotonic_t
+calculate_deadline(const _anj_observe_deadline_index_t *index,
+                   const _anj_observe_observation_t *observation) {
+    if (!observation->ssid || !observation->observe_active
+            || observation->ssid != index->server_state.ssid) {
+        return ANJ_TIME_MONOTONIC_INVALID;
+    }
+    anj_time_duration_t min_period;
+    anj_time_duration_t max_period;
+    get_min_max_period(&observation->effective_attr, &index->server_state,
+                       &max_period, &min_period);
+    if (observation->notification_to_send) {
+        return anj_time_monotonic_add(observation->last_notify_timestamp,
+                                      min_period);
+    }
+    return calculate_next_notify_check_timestamp(observation, min_period,
+                                                 max_period);
+}
+
+/* Ties are resolved by Observation index, which gives the same order as
+ * a linear scan of the observations array. */
+static bool heap_entry_less(const _anj_observe_deadline_index_t *index,
+                            uint16_t pos_a,
+                            uint16_t pos_b) {
+    uint16_t a = index->heap[pos_a];
+    uint16_t b = index->heap[pos_b];
+    if (anj_time_monotonic_lt(index->deadlines[a], index->deadlines[b])) {
+        return true;
+    }
+    if (anj_time_monotonic_lt(index->deadlines[b], index->deadlines[a])) {
+        return false;
+    }
+    return a < b;
+}
+
+static void heap_swap(_anj_observe_deadline_index_t *index,
+                      uint16_t pos_a,
+                      uint16_t pos_b) {
+    uint16_t tmp = index->heap[pos_a];
+    index->heap[pos_a] = index->heap[pos_b];
+    index->heap[pos_b] = tmp;
+    index->heap_pos[index->heap[pos_a]] = pos_a;
+    index->heap_pos[index->heap[pos_b]] = pos_b;
+}
+
+static void heap_sift_up(_anj_observe_deadline_index_t *index, uint16_t pos) {
+    while (pos > 0) {
+        uint16_t parent = (uint16_t) ((pos - 1) / 2);
+        if (!heap_entry_less(index, pos, parent)) {
+            return;
+        }
+        heap_swap(index, pos, parent);
+        pos = parent;
+    }
+}
+
+static void heap_sift_down(_anj_observe_deadline_index_t *index,
+                           uint16_t pos) {
+    while (1) {
+        size_t left = 2 * (size_t) pos + 1;
+        size_t right = left + 1;
+        uint16_t smallest = pos;
+        if (left < index->heap_size
+                && heap_entry_less(index, (uint16_t) left, smallest)) {
+            smallest = (uint16_t) left;
+        }
+        if (right < index->heap_size
+                && heap_entry_less(index, (uint16_t) right, smallest)) {
+            smallest = (uint16_t) right;
+        }
+        if (smallest == pos) {
+            return;
+        }
+        heap_swap(index, pos, smallest);
+        pos = smallest;
+    }
+}
+
+static void heap_remove(_anj_observe_deadline_index_t *index,
+                        uint16_t obs_idx) {
+    uint16_t pos = index->heap_pos[obs_idx];
+    if (pos == DEADLINE_NOT_INDEXED) {
+        return;
+    }
+    uint16_t last = (uint16_t) (index->heap_size - 1);
+    uint16_t moved = index->heap[last];
+    heap_swap(index, pos, last);
+    index->heap_size = last;
+    index->heap_pos[obs_idx] = DEADLINE_NOT_INDEXED;
+    if (pos != last) {
+        heap_sift_up(index, pos);
+        heap_sift_down(index, index->heap_pos[moved]);
+    }
+}
+
+void _anj_observe_deadline_index_update(
+        _anj_observe_ctx_t *ctx, const _anj_observe_observation_t *observation) {
+    _anj_observe_deadline_index_t *index = &ctx->deadline_index;
+    if (!index->valid) {
+        return;
+    }
+    uint16_t obs_idx = (uint16_t) (observation - ctx->observations);
+    assert(obs_idx < _ANJ_OBSERVE_OBSERVATIONS_NUMBER(ctx));
+
+    if (observation->ssid == index->server_state.ssid
+            && observation->observe_active
+            && anj_time_monotonic_gt(observation->last_notify_timestamp,
+                                     index->latest_notify_timestamp)) {
+        index->latest_notify_timestamp = observation->last_notify_timestamp;
+    }
+
+    anj_time_monotonic_t deadline = calculate_deadline(index, observation);
+    if (!anj_time_monotonic_is_valid(deadline)) {
+        heap_remove(index, obs_idx);
+        return;
+    }
+    index->deadlines[obs_idx] = deadline;
+    uint16_t pos = index->heap_pos[obs_idx];
+    if (pos == DEADLINE_NOT_INDEXED) {
+        pos = index->heap_size++;
+        index->heap[pos] = obs_idx;
+        index->heap_pos[obs_idx] = pos;
+    }
+    heap_sift_up(index, pos);
+    heap_sift_down(index, index->heap_pos[obs_idx]);
+}
+
+void _anj_observe_deadline_index_invalidate(_anj_observe_ctx_t *ctx) {
+    ctx->deadline_index.valid = false;
+}
+
+static void
+deadline_index_rebuild(_anj_observe_ctx_t *ctx,
+                       const _anj_observe_server_state_t *server_state) {
+    _anj_observe_deadline_index_t *index = &ctx->deadline_index;
+    index->server_state = *server_state;
+    index->latest_notify_timestamp = ANJ_TIME_MONOTONIC_ZERO;
+    index->heap_size = 0;
+    for (size_t i = 0; i < _ANJ_OBSERVE_OBSERVATIONS_NUMBER(ctx); i++) {
+        index->heap_pos[i] = DEADLINE_NOT_INDEXED;
+    }
+    index->valid = true;
+    for (size_t i = 0; i < _ANJ_OBSERVE_OBSERVATIONS_NUMBER(ctx); i++) {
+        _anj_observe_deadline_index_update(ctx, &ctx->observations[i]);
+    }
+}
+
+/* Returns false if the index can't be used and the observations array has to
+ * be scanned. */
+static bool
+deadline_index_prepare(_anj_observe_ctx_t *ctx,
+                       const _anj_observe_server_state_t *server_state,
+                       anj_time_monotonic_t current_time) {
+    _anj_observe_deadline_index_t *index = &ctx->deadline_index;
+    if (!index->valid || index->server_state.ssid != server_state->ssid
+            || index->server_state.default_min_period
+                           != server_state->default_min_period
+            || index->server_state.default_max_period
+                           != server_state->default_max_period) {
+        deadline_index_rebuild(ctx, server_state);
+    }
+    /* If the clock went back, a notification has to be sent regardless of
+     * the attributes - let the full scan handle this rare case. */
+    return !anj_time_monotonic_lt(current_time, index->latest_notify_timestamp);
 }
+#    endif // ANJ_OBSERVE_WITH_DEADLINE_INDEX
 
 static int
 observe_process_or_get_time(anj_t *anj,
@@ -276,7 +955,8 @@ observe_process_or_get_time(anj_t *anj,
     anj_time_duration_t min_period;
     anj_time_duration_t max_period;
     anj_time_duration_t elapsed_time;
-    anj_time_monotonic_t current_time = anj_time_monotonic_now();
+    anj_time_monotonic_t current_time =
+            _ANJ_STEP_TIME_NOW(anj->observe_ctx.step_time);
     anj_time_duration_t tmp_time_to_next_notif;
     anj_time_monotonic_t next_notify_check_timestamp;
     int ret_val = 0;
@@ -285,10 +965,51 @@ observe_process_or_get_time(anj_t *anj,
         *time_to_next_notif = ANJ_TIME_DURATION_INVALID;
     }
     _anj_observe_ctx_t *ctx = &anj->observe_ctx;
-    for (size_t i = 0; i < ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER; i++) {
+#    ifdef ANJ_OBSERVE_WITH_DEADLINE_INDEX
+    /* The index doesn't know about the coalescing window, so it is used only
+     * when no coalescing is in progress. */
+    if (
+#        ifdef ANJ_OBSERVE_WITH_NOTIFICATION_COALESCING
+            !anj_time_monotonic_is_valid(ctx->coalescing_start) &&
+#        endif // ANJ_OBSERVE_WITH_NOTIFICATION_COALESCING
+            deadline_index_prepare(ctx, server_state, current_time)) {
+        const _anj_observe_deadline_index_t *index = &ctx->deadline_index;
+        while (index->heap_size) {
+            uint16_t obs_idx = index->heap[0];
+            anj_time_monotonic_t deadline = index->deadlines[obs_idx];
+            if (anj_time_monotonic_gt(deadline, current_time)) {
+                if (get_time) {
+                    *time_to_next_notif =
+                            anj_time_monotonic_diff(deadline, current_time);
+                }
+                return 0;
+            }
+            if (get_time) {
+                *time_to_next_notif = ANJ_TIME_DURATION_ZERO;
+                return 0;
+            }
+            ctx->processing_observation = &ctx->observations[obs_idx];
+#        ifdef ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER
+            /* Recorded Observation is moved further in the heap */
+            if (store_notification(anj, server_state)) {
+                continue;
+            }
+#        endif // ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER
+            ret_val = create_notification(anj, out_handlers, server_state,
+                                          out_msg);
+#        ifdef ANJ_OBSERVE_WITH_NOTIFICATION_COALESCING
+            update_coalescing_window(ctx, out_msg, current_time);
+#        endif // ANJ_OBSERVE_WITH_NOTIFICATION_COALESCING
+            return ret_val;
+        }
+        return 0;
+    }
+#    endif // ANJ_OBSERVE_WITH_DEADLINE_INDEX
+    _anj_observe_scan_begin(ctx);
+    for (size_t i = 0; i < _ANJ_OBSERVE_OBSERVATIONS_NUMBER(ctx); i++) {
         ctx->processing_observation = &ctx->observations[i];
-        if (!ctx->processing_observation->observe_active
-                || (ctx->processing_observation->ssid != server_state->ssid)) {
+        if (!_anj_observe_active_at(ctx, i)
+                || _anj_observe_ssid_at(ctx, i) != server_state->ssid) {
             continue;
         }
 
@@ -301,6 +1022,11 @@ observe_process_or_get_time(anj_t *anj,
             if (get_time) {
                 *time_to_next_notif = ANJ_TIME_DURATION_ZERO;
             } else {
+#    ifdef ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER
+                if (store_notification(anj, server_state)) {
+                    continue;
+                }
+#    endif // ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER
                 ret_val = create_notification(anj, out_handlers, server_state,
                                               out_msg);
             }
@@ -311,7 +1037,7 @@ observe_process_or_get_time(anj_t *anj,
                            server_state, &max_period, &min_period);
 
         next_notify_check_timestamp = calculate_next_notify_check_timestamp(
-                ctx->processing_observation, max_period);
+                ctx->processing_observation, min_period, max_period);
 
         if (get_time
                 && anj_time_monotonic_is_valid(next_notify_check_timestamp)) {
@@ -351,21 +1077,46 @@ observe_process_or_get_time(anj_t *anj,
             continue;
         }
 
-        if ((!anj_time_duration_eq(max_period, ANJ_TIME_DURATION_ZERO)
-             && anj_time_duration_leq(max_period, elapsed_time))
+        if ((anj_time_monotonic_is_valid(next_notify_check_timestamp)
+             && anj_time_monotonic_leq(next_notify_check_timestamp,
+                                       current_time))
+#    ifdef ANJ_OBSERVE_WITH_NOTIFICATION_COALESCING
+                || within_coalescing_window(ctx, ctx->processing_observation,
+                                            next_notify_check_timestamp)
+#    endif // ANJ_OBSERVE_WITH_NOTIFICATION_COALESCING
                 || ctx->processing_observation->notification_to_send) {
             if (get_time) {
                 *time_to_next_notif = ANJ_TIME_DURATION_ZERO;
             } else {
+#    ifdef ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER
+                if (store_notification(anj, server_state)) {
+                    continue;
+                }
+#    endif // ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER
                 ret_val = create_notification(anj, out_handlers, server_state,
                                               out_msg);
             }
             break;
         }
     }
+#    ifdef ANJ_OBSERVE_WITH_NOTIFICATION_COALESCING
+    if (!get_time) {
+        update_coalescing_window(ctx, out_msg, current_time);
+    }
+#    endif // ANJ_OBSERVE_WITH_NOTIFICATION_COALESCING
     return ret_val;
 }
 
+#    ifdef ANJ_OBSERVE_WITH_EVALUATION_SCHEDULER
+static void
+evaluate_due_observations(anj_t *anj,
+                          const _anj_observe_server_state_t *server_state);
+static void
+update_time_to_next_evaluation(anj_t *anj,
+                               const _anj_observe_server_state_t *server_state,
+                               anj_time_duration_t *time_to_next_notification);
+#    endif // ANJ_OBSERVE_WITH_EVALUATION_SCHEDULER
+
 int _anj_observe_process(anj_t *anj,
                          _anj_exchange_handlers_t *out_handlers,
                          const _anj_observe_server_state_t *server_state,
@@ -373,6 +1124,9 @@ int _anj_observe_process(anj_t *anj,
     assert(anj && server_state && out_msg && out_handlers);
     assert(server_state->ssid > 0 && server_state->ssid < UINT16_MAX);
 
+#    ifdef ANJ_OBSERVE_WITH_EVALUATION_SCHEDULER
+    evaluate_due_observations(anj, server_state);
+#    endif // ANJ_OBSERVE_WITH_EVALUATION_SCHEDULER
     return observe_process_or_get_time(anj, out_handlers, server_state, out_msg,
                                        NULL, false);
 }
@@ -391,6 +1145,12 @@ int anj_observe_time_to_next_notification(
     int ret = observe_process_or_get_time(anj, NULL, server_state, NULL,
                                           time_to_next_notification, true);
     anj->observe_ctx.processing_observation = previous_processing_observation;
+#    ifdef ANJ_OBSERVE_WITH_EVALUATION_SCHEDULER
+    if (!ret) {
+        update_time_to_next_evaluation(anj, server_state,
+                                       time_to_next_notification);
+    }
+#    endif // ANJ_OBSERVE_WITH_EVALUATION_SCHEDULER
     return ret;
 }
 
@@ -426,8 +1186,92 @@ static bool do_observation_value_crossed_threshold(const double *prev_val,
            || (*prev_val >= *th && *curr_val < *th);
 }
 
+#    ifdef ANJ_OBSERVE_WITH_INTEGER_THRESHOLDS
+// Returns negative value, 0 or positive value if val is respectively lower,
+// equal or greater than bound
+static int compare_integer_value(const _anj_observation_res_val_t *val,
+                                 anj_data_type_t type,
+                                 int64_t bound) {
+    if (type == ANJ_DATA_TYPE_UINT) {
+        if (bound < 0 || val->uint_value > (uint64_t) bound) {
+            return 1;
+        }
+        return val->uint_value < (uint64_t) bound ? -1 : 0;
+    }
+    if (val->int_value != bound) {
+        return val->int_value < bound ? -1 : 1;
+    }
+    return 0;
+}
+
+static bool
+integer_value_crossed_threshold(const _anj_observation_res_val_t *prev_val,
+                                const _anj_observation_res_val_t *curr_val,
+                                anj_data_type_t type,
+                                int64_t th_floor,
+                                int64_t th_ceil) {
+    return (compare_integer_value(prev_val, type, th_floor) <= 0
+            && compare_integer_value(curr_val, type, th_floor) > 0)
+           || (compare_integer_value(prev_val, type, th_ceil) >= 0
+               && compare_integer_value(curr_val, type, th_ceil) < 0);
+}
+
+static uint64_t
+integer_value_difference(const _anj_observation_res_val_t *a,
+                         const _anj_observation_res_val_t *b,
+                         anj_data_type_t type) {
+    if (type == ANJ_DATA_TYPE_UINT) {
+        return a->uint_value > b->uint_value ? a->uint_value - b->uint_value
+                                             : b->uint_value - a->uint_value;
+    }
+    /* Conversion to uint64_t gives the correct result even if the difference
+     * doesn't fit in int64_t */
+    return a->int_value > b->int_value
+                   ? (uint64_t) a->int_value - (uint64_t) b->int_value
+                   : (uint64_t) b->int_value - (uint64_t) a->int_value;
+}
+
+static bool integer_value_change_condition_met(
+        const _anj_observe_observation_t *observation,
+        const _anj_observation_res_val_t *current_observe_val,
+        anj_data_type_t type,
+        bool *out_threshold_crossed) {
+    const _anj_attr_notification_t *attr = &observation->effective_attr;
+    const _anj_observe_int_attr_t *int_attr = &observation->int_attr;
+    const _anj_observation_res_val_t *last_sent_value =
+            &observation->last_sent_value;
+    bool crossed =
+            (attr->has_less_than
+             && integer_value_crossed_threshold(last_sent_value,
+                                                current_observe_val, type,
+                                                int_attr->less_than_floor,
+                                                int_attr->less_than_ceil))
+            || (attr->has_greater_than
+                && integer_value_crossed_threshold(
+                           last_sent_value, current_observe_val, type,
+                           int_attr->greater_than_floor,
+                           int_attr->greater_than_ceil));
+    *out_threshold_crossed = crossed;
+    return crossed
+           || (attr->has_step
+               && integer_value_difference(last_sent_value,
+                                           current_observe_val, type)
+                          >= int_attr->step_ceil);
+}
+#    endif // ANJ_OBSERVE_WITH_INTEGER_THRESHOLDS
+
 #    define ATTRIBUTES_NOT_MET -1
 
+static void set_threshold_crossed(_anj_observe_observation_t *observation,
+                                  bool crossed) {
+#    ifdef ANJ_OBSERVE_WITH_CON_POLICY
+    observation->threshold_crossed = observation->threshold_crossed || crossed;
+#    else  // ANJ_OBSERVE_WITH_CON_POLICY
+    (void) observation;
+    (void) crossed;
+#    endif // ANJ_OBSERVE_WITH_CON_POLICY
+}
+
 static int check_attributes(anj_t *anj,
                             _anj_observation_res_val_t *current_observe_val,
                             anj_data_type_t *current_res_type,
@@ -452,16 +1296,35 @@ static int check_attributes(anj_t *anj,
             }
         }
 
+#    ifdef ANJ_OBSERVE_WITH_INTEGER_THRESHOLDS
+        if (*current_res_type == ANJ_DATA_TYPE_INT
+                || *current_res_type == ANJ_DATA_TYPE_UINT) {
+            bool crossed;
+            if (!integer_value_change_condition_met(observation,
+                                                    current_observe_val,
+                                                    *current_res_type,
+                                                    &crossed)) {
+                return ATTRIBUTES_NOT_MET;
+            }
+            set_threshold_crossed(observation, crossed);
+            return 0;
+        }
+#    endif // ANJ_OBSERVE_WITH_INTEGER_THRESHOLDS
         double last_sent_value =
                 observation_value_to_double(&observation->last_sent_value,
                                             *current_res_type);
         double current_value = observation_value_to_double(current_observe_val,
                                                            *current_res_type);
 
-        if (!((attr->has_less_than
-               && do_observation_value_crossed_threshold(
-                          &last_sent_value, &current_value, &attr->less_than))
-              ||
+        bool crossed =
+                (attr->has_less_than
+                 && do_observation_value_crossed_threshold(
+                            &last_sent_value, &current_value, &attr->less_than))
+                || (attr->has_greater_than
+                    && do_observation_value_crossed_threshold(
+                               &last_sent_value, &current_value,
+                               &attr->greater_than));
+        if (!(crossed ||
 #    ifdef ANJ_WITH_LWM2M12
               (attr->has_edge
                && (attr->edge ? !observation->last_sent_value.bool_value
@@ -470,19 +1333,293 @@ static int check_attributes(anj_t *anj,
                                         && !current_observe_val->bool_value))
               ||
 #    endif // ANJ_WITH_LWM2M12
-              (attr->has_greater_than
-               && do_observation_value_crossed_threshold(&last_sent_value,
-                                                         &current_value,
-                                                         &attr->greater_than))
-              || (attr->has_step
-                  && observation_value_difference_greater_or_equal_to_value(
-                             &last_sent_value, &current_value, &attr->step)))) {
+              (attr->has_step
+               && observation_value_difference_greater_or_equal_to_value(
+                          &last_sent_value, &current_value, &attr->step)))) {
             return ATTRIBUTES_NOT_MET;
         }
+        set_threshold_crossed(observation, crossed);
+    }
+    return 0;
+}
+
+/* observe_value, res_type and already_read are shared by all Observations
+ * handled for the same change of changed_path, so they are used only by the
+ * Observation of exactly that path. */
+static int handle_changed_observation(anj_t *anj,
+                                      const anj_uri_path_t *changed_path,
+                                      anj_observe_change_type_t change_type,
+                                      _anj_observation_res_val_t *observe_value,
+                                      anj_data_type_t *res_type,
+                                      bool *already_read) {
+    _anj_observe_ctx_t *ctx = &anj->observe_ctx;
+    _anj_observation_res_val_t own_observe_value;
+    anj_data_type_t own_res_type;
+    bool own_already_read = false;
+    const bool changed_path_observed = anj_uri_path_equal(
+            &ctx->processing_observation->path, changed_path);
+    if (!changed_path_observed) {
+        observe_value = &own_observe_value;
+        res_type = &own_res_type;
+        already_read = &own_already_read;
+    }
+    if (change_type == ANJ_OBSERVE_CHANGE_TYPE_VALUE_CHANGED) {
+        int result =
+                check_attributes(anj, observe_value, res_type, already_read);
+#    ifdef ANJ_OBSERVE_WITH_EVALUATION_SCHEDULER
+        if (*already_read) {
+            ctx->processing_observation->last_eval_timestamp =
+                    _ANJ_STEP_TIME_NOW(ctx->step_time);
+        }
+#    endif // ANJ_OBSERVE_WITH_EVALUATION_SCHEDULER
+#    ifdef ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+        if (!result || result == ATTRIBUTES_NOT_MET) {
+            record_historical_sample(anj, ctx->processing_observation,
+                                     observe_value, res_type, already_read);
+        }
+#    endif // ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+        if (result == ATTRIBUTES_NOT_MET) {
+            return 0;
+        } else if (result) {
+            return result;
+        }
     }
+#    ifdef ANJ_OBSERVE_WITH_VALUE_CACHE
+    /* Value read for the changed Resource is the whole payload only of an
+     * Observation with the same path, a notification for any other path
+     * reads the data model. */
+    ctx->processing_observation->has_cached_value =
+            change_type == ANJ_OBSERVE_CHANGE_TYPE_VALUE_CHANGED
+            && changed_path_observed && *already_read;
+    if (ctx->processing_observation->has_cached_value) {
+        ctx->processing_observation->cached_value = *observe_value;
+        ctx->processing_observation->cached_value_type = *res_type;
+    }
+#    endif // ANJ_OBSERVE_WITH_VALUE_CACHE
+    ctx->processing_observation->notification_to_send = true;
+#    ifdef ANJ_OBSERVE_WITH_DEADLINE_INDEX
+    _anj_observe_deadline_index_update(ctx, ctx->processing_observation);
+#    endif // ANJ_OBSERVE_WITH_DEADLINE_INDEX
+#    ifdef ANJ_OBSERVE_WITH_STATE_ARRAYS
+    _anj_observe_state_arrays_update(ctx, ctx->processing_observation);
+#    endif // ANJ_OBSERVE_WITH_STATE_ARRAYS
     return 0;
 }
 
+#    ifdef ANJ_OBSERVE_WITH_EVALUATION_SCHEDULER
+static bool
+evaluation_scheduled(const _anj_observe_ctx_t *ctx,
+                     size_t obs_idx,
+                     const _anj_observe_server_state_t *server_state) {
+    if (!_anj_observe_active_at(ctx, obs_idx)
+            || _anj_observe_ssid_at(ctx, obs_idx) != server_state->ssid) {
+        return false;
+    }
+    const _anj_observe_observation_t *observation = &ctx->observations[obs_idx];
+    const _anj_attr_notification_t *attr = &observation->effective_attr;
+    return attr->has_max_eval_period && attr->max_eval_period > 0
+           && (_anj_observe_attribute_has_value_change_condition(attr)
+#        ifdef ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+               || historical_queue_enabled(observation)
+#        endif // ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+           );
+}
+
+/* Sending a notification also updates last_sent_value, so it counts as an
+ * evaluation too. */
+static anj_time_monotonic_t
+last_evaluation_timestamp(const _anj_observe_observation_t *observation) {
+    return anj_time_monotonic_gt(observation->last_eval_timestamp,
+                                 observation->last_notify_timestamp)
+                   ? observation->last_eval_timestamp
+                   : observation->last_notify_timestamp;
+}
+
+static anj_time_monotonic_t
+evaluation_deadline(const _anj_observe_observation_t *observation) {
+    return anj_time_monotonic_add(
+            last_evaluation_timestamp(observation),
+            anj_time_duration_new(observation->effective_attr.max_eval_period,
+                                  ANJ_TIME_UNIT_S));
+}
+
+static bool evaluation_due(const _anj_observe_observation_t *observation,
+                           anj_time_monotonic_t current_time) {
+    return anj_time_monotonic_lt(last_evaluation_timestamp(observation),
+                                 current_time)
+           && anj_time_monotonic_leq(evaluation_deadline(observation),
+                                     current_time);
+}
+
+/* Observation which is not due yet is evaluated along with the due ones if its
+ * epmin has elapsed, so that the device wakes up less often. */
+static bool evaluation_allowed(const _anj_observe_observation_t *observation,
+                               anj_time_monotonic_t current_time) {
+    if (evaluation_due(observation, current_time)) {
+        return true;
+    }
+    anj_time_monotonic_t last_eval = last_evaluation_timestamp(observation);
+    return observation->effective_attr.has_min_eval_period
+           && anj_time_monotonic_lt(last_eval, current_time)
+           && anj_time_monotonic_leq(
+                      anj_time_monotonic_add(
+                              last_eval,
+                              anj_time_duration_new(
+                                      observation->effective_attr
+                                              .min_eval_period,
+                                      ANJ_TIME_UNIT_S)),
+                      current_time);
+}
+
+static void
+evaluate_due_observations(anj_t *anj,
+                          const _anj_observe_server_state_t *server_state) {
+    _anj_observe_ctx_t *ctx = &anj->observe_ctx;
+    anj_time_monotonic_t current_time = _ANJ_STEP_TIME_NOW(ctx->step_time);
+    bool any_due = false;
+    _anj_observe_scan_begin(ctx);
+    for (size_t i = 0; i < _ANJ_OBSERVE_OBSERVATIONS_NUMBER(ctx) && !any_due;
+         i++) {
+        any_due = evaluation_scheduled(ctx, i, server_state)
+                  && evaluation_due(&ctx->observations[i], current_time);
+    }
+    if (!any_due) {
+        return;
+    }
+
+    /* We might be in middle of handling notification when this function is
+     * called */
+    _anj_observe_observation_t *previous_processing_observation =
+            ctx->processing_observation;
+    for (size_t i = 0; i < _ANJ_OBSERVE_OBSERVATIONS_NUMBER(ctx); i++) {
+        if (!evaluation_scheduled(ctx, i, server_state)
+                || !evaluation_allowed(&ctx->observations[i], current_time)) {
+            continue;
+        }
+        /* Resource observed multiple times is read once, Observations with
+         * the same path that follow are evaluated with the same value */
+        const anj_uri_path_t path = ctx->observations[i].path;
+        const _anj_observe_scan_path_t scan_path =
+                _anj_observe_scan_path(&path);
+        bool already_read = false;
+        _anj_observation_res_val_t observe_value;
+        anj_data_type_t res_type;
+        for (size_t j = i; j < _ANJ_OBSERVE_OBSERVATIONS_NUMBER(ctx); j++) {
+            _anj_observe_observation_t *observation = &ctx->observations[j];
+            if (!evaluation_scheduled(ctx, j, server_state)
+                    || !_anj_observe_path_equal_at(ctx, j, &scan_path)
+                    || !evaluation_allowed(observation, current_time)) {
+                continue;
+            }
+            /* Failed read is not retried before the next deadline, the value
+             * of a pending notification will be read when it is sent */
+            observation->last_eval_timestamp = current_time;
+            ctx->processing_observation = observation;
+            if (observation->notification_to_send
+                    || !_anj_observe_attribute_has_value_change_condition(
+                               &observation->effective_attr)) {
+#        ifdef ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+                /* Observation with the hqmax attribute is only sampled */
+                record_historical_sample(anj, observation, &observe_value,
+                                         &res_type, &already_read);
+#        endif // ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+                continue;
+            }
+            (void) handle_changed_observation(
+                    anj, &path, ANJ_OBSERVE_CHANGE_TYPE_VALUE_CHANGED,
+                    &observe_value, &res_type, &already_read);
+        }
+    }
+    ctx->processing_observation = previous_processing_observation;
+}
+
+static void
+update_time_to_next_evaluation(anj_t *anj,
+                               const _anj_observe_server_state_t *server_state,
+                               anj_time_duration_t *time_to_next_notification) {
+    _anj_observe_ctx_t *ctx = &anj->observe_ctx;
+    anj_time_monotonic_t current_time = _ANJ_STEP_TIME_NOW(ctx->step_time);
+    _anj_observe_scan_begin(ctx);
+    for (size_t i = 0; i < _ANJ_OBSERVE_OBSERVATIONS_NUMBER(ctx); i++) {
+        /* Time of a pending notification doesn't depend on the evaluation */
+        if (_anj_observe_notification_to_send_at(ctx, i)
+                || !evaluation_scheduled(ctx, i, server_state)) {
+            continue;
+        }
+        const _anj_observe_observation_t *observation = &ctx->observations[i];
+        anj_time_duration_t time_to_evaluation =
+                anj_time_monotonic_diff(evaluation_deadline(observation),
+                                        current_time);
+        if (anj_time_duration_lt(time_to_evaluation, ANJ_TIME_DURATION_ZERO)) {
+            time_to_evaluation = ANJ_TIME_DURATION_ZERO;
+        }
+        if (!anj_time_duration_is_valid(*time_to_next_notification)
+                || anj_time_duration_lt(time_to_evaluation,
+                                        *time_to_next_notification)) {
+            *time_to_next_notification = time_to_evaluation;
+        }
+    }
+}
+#    endif // ANJ_OBSERVE_WITH_EVALUATION_SCHEDULER
+
+#    ifdef ANJ_OBSERVE_WITH_VALUE_CACHE
+/* Value read earlier may be outdated after another change of the observed
+ * Resource. If the notification is still to be sent, the value will be read
+ * again when creating it. */
+static void invalidate_cached_value(_anj_observe_observation_t *observation) {
+    observation->has_cached_value = false;
+}
+#    endif // ANJ_OBSERVE_WITH_VALUE_CACHE
+
+#    ifdef ANJ_OBSERVE_WITH_PATH_INDEX
+static void path_index_prepare(_anj_observe_ctx_t *ctx) {
+    _anj_observe_path_index_t *index = &ctx->path_index;
+    if (index->valid) {
+        return;
+    }
+    /* Insertion sort is good enough, the index is rebuilt only after the set
+     * of Observations has changed. */
+    index->size = 0;
+    for (uint16_t i = 0; i < _ANJ_OBSERVE_OBSERVATIONS_NUMBER(ctx); i++) {
+        if (!ctx->observations[i].ssid) {
+            continue;
+        }
+        uint16_t pos = index->size++;
+        while (pos > 0
+               && _anj_uri_path_compare(
+                          &ctx->observations[index->entries[pos - 1]].path,
+                          &ctx->observations[i].path)
+                          > 0) {
+            index->entries[pos] = index->entries[pos - 1];
+            pos--;
+        }
+        index->entries[pos] = i;
+    }
+    index->valid = true;
+}
+
+static uint16_t path_index_lower_bound(const _anj_observe_ctx_t *ctx,
+                                       const anj_uri_path_t *path) {
+    uint16_t low = 0;
+    uint16_t high = ctx->path_index.size;
+    while (low < high) {
+        uint16_t mid = (uint16_t) (low + (high - low) / 2);
+        if (_anj_uri_path_compare(
+                    &ctx->observations[ctx->path_index.entries[mid]].path, path)
+                < 0) {
+            low = (uint16_t) (mid + 1);
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+void _anj_observe_path_index_invalidate(_anj_observe_ctx_t *ctx) {
+    ctx->path_index.valid = false;
+}
+#    endif // ANJ_OBSERVE_WITH_PATH_INDEX
+
 int anj_observe_data_model_changed(anj_t *anj,
                                    const anj_uri_path_t *path,
                                    anj_observe_change_type_t change_type,
@@ -502,13 +1639,15 @@ int anj_observe_data_model_changed(anj_t *anj,
      * called */
     _anj_observe_observation_t *previous_processing_observation =
             ctx->processing_observation;
+    const _anj_observe_scan_path_t scan_path = _anj_observe_scan_path(path);
+    _anj_observe_scan_begin(ctx);
     switch (change_type) {
     case ANJ_OBSERVE_CHANGE_TYPE_ADDED:
 #    ifdef ANJ_WITH_OBSERVE_COMPOSITE
-        for (size_t i = 0; i < ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER; i++) {
-            if (ctx->observations[i].ssid && ctx->observations[i].prev
-                    && !anj_uri_path_outside_base(&ctx->observations[i].path,
-                                                  path)) {
+        for (size_t i = 0; i < _ANJ_OBSERVE_OBSERVATIONS_NUMBER(ctx); i++) {
+            if (_anj_observe_ssid_at(ctx, i) && ctx->observations[i].prev
+                    && !_anj_observe_path_outside_base_at(ctx, i,
+                                                          &scan_path)) {
                 ctx->processing_observation = &ctx->observations[i];
                 /* At the time of adding the observation, the path may not have
                  * existed in the data model, so we need to check this now */
@@ -520,6 +1659,14 @@ int anj_observe_data_model_changed(anj_t *anj,
                 }
                 _anj_observe_verify_effective_attributes(
                         ctx->processing_observation);
+#        ifdef ANJ_OBSERVE_WITH_DEADLINE_INDEX
+                _anj_observe_deadline_index_update(ctx,
+                                                   ctx->processing_observation);
+#        endif // ANJ_OBSERVE_WITH_DEADLINE_INDEX
+#        ifdef ANJ_OBSERVE_WITH_STATE_ARRAYS
+                _anj_observe_state_arrays_update(ctx,
+                                                 ctx->processing_observation);
+#        endif // ANJ_OBSERVE_WITH_STATE_ARRAYS
             }
         }
 #    endif // ANJ_WITH_OBSERVE_COMPOSITE
@@ -528,21 +1675,68 @@ int anj_observe_data_model_changed(anj_t *anj,
         bool already_read = false;
         _anj_observation_res_val_t observe_value;
         anj_data_type_t res_type;
-        for (size_t i = 0; i < ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER; i++) {
-            if (!ctx->observations[i].notification_to_send
-                    && ctx->observations[i].observe_active
-                    && (ssid == 0 ? ctx->observations[i].ssid
-                                  : ctx->observations[i].ssid != ssid)
-                    && (!anj_uri_path_outside_base(path,
-                                                   &ctx->observations[i].path)
+#    ifdef ANJ_OBSERVE_WITH_PATH_INDEX
+        if (change_type == ANJ_OBSERVE_CHANGE_TYPE_VALUE_CHANGED) {
+            path_index_prepare(ctx);
+            /* Only Observations with path equal to one of the prefixes of the
+             * changed path might be affected. */
+            for (size_t len = 0; len <= path->uri_len; len++) {
+                anj_uri_path_t prefix = *path;
+                prefix.uri_len = len;
+                for (uint16_t pos = path_index_lower_bound(ctx, &prefix);
+                     pos < ctx->path_index.size
+                     && anj_uri_path_equal(
+                                &ctx->observations[ctx->path_index.entries[pos]]
+                                         .path,
+                                &prefix);
+                     pos++) {
+                    uint16_t obs_idx = ctx->path_index.entries[pos];
+                    _anj_observe_observation_t *observation =
+                            &ctx->observations[obs_idx];
+                    uint16_t obs_ssid = _anj_observe_ssid_at(ctx, obs_idx);
+#        ifdef ANJ_OBSERVE_WITH_VALUE_CACHE
+                    invalidate_cached_value(observation);
+#        endif // ANJ_OBSERVE_WITH_VALUE_CACHE
+                    if (_anj_observe_notification_to_send_at(ctx, obs_idx)
+                            || !_anj_observe_active_at(ctx, obs_idx)
+                            || !(ssid == 0 ? obs_ssid : obs_ssid != ssid)) {
+#        ifdef ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+                        record_pending_historical_sample(
+                                anj, observation, change_type, ssid,
+                                &observe_value, &res_type, &already_read);
+#        endif // ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+                        continue;
+                    }
+                    ctx->processing_observation = observation;
+                    if ((result = handle_changed_observation(
+                                 anj, path, change_type, &observe_value,
+                                 &res_type, &already_read))) {
+                        ret_val = result;
+                    }
+                }
+            }
+            break;
+        }
+#    endif // ANJ_OBSERVE_WITH_PATH_INDEX
+        for (size_t i = 0; i < _ANJ_OBSERVE_OBSERVATIONS_NUMBER(ctx); i++) {
+#    ifdef ANJ_OBSERVE_WITH_VALUE_CACHE
+            if (!_anj_observe_base_outside_path_at(ctx, i, &scan_path)) {
+                invalidate_cached_value(&ctx->observations[i]);
+            }
+#    endif // ANJ_OBSERVE_WITH_VALUE_CACHE
+            if (!_anj_observe_notification_to_send_at(ctx, i)
+                    && _anj_observe_active_at(ctx, i)
+                    && (ssid == 0 ? _anj_observe_ssid_at(ctx, i)
+                                  : _anj_observe_ssid_at(ctx, i) != ssid)
+                    && (!_anj_observe_base_outside_path_at(ctx, i, &scan_path)
 #    ifdef ANJ_WITH_OBSERVE_COMPOSITE
                         /* If it is a composite observation, it is also
                            necessary to check the paths that may not have
                            existed in the data model before. */
                         || (change_type == ANJ_OBSERVE_CHANGE_TYPE_ADDED
                             && ctx->observations[i].prev
-                            && !anj_uri_path_outside_base(
-                                       &ctx->observations[i].path, path)
+                            && !_anj_observe_path_outside_base_at(ctx, i,
+                                                                  &scan_path)
                             /* If this function returns an error different than
                                ANJ_COAP_CODE_NOT_FOUND then the observation
                                should be removed in the
@@ -553,33 +1747,37 @@ int anj_observe_data_model_changed(anj_t *anj,
 #    endif // ANJ_WITH_OBSERVE_COMPOSITE
                                 )) {
                 ctx->processing_observation = &ctx->observations[i];
-                if (change_type == ANJ_OBSERVE_CHANGE_TYPE_VALUE_CHANGED) {
-                    result = check_attributes(anj, &observe_value, &res_type,
-                                              &already_read);
-                    if (result == ATTRIBUTES_NOT_MET) {
-                        continue;
-                    } else if (result) {
-                        ret_val = result;
-                        continue;
-                    }
+                if ((result = handle_changed_observation(
+                             anj, path, change_type, &observe_value,
+                             &res_type, &already_read))) {
+                    ret_val = result;
                 }
-                ctx->processing_observation->notification_to_send = true;
             }
+#    ifdef ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+            else if (!_anj_observe_base_outside_path_at(ctx, i, &scan_path)) {
+                record_pending_historical_sample(
+                        anj, &ctx->observations[i], change_type, ssid,
+                        &observe_value, &res_type, &already_read);
+            }
+#    endif // ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
         }
         break;
     }
     case ANJ_OBSERVE_CHANGE_TYPE_DELETED: {
-        for (size_t i = 0; i < ANJ_OBSERVE_MAX_WRITE_ATTRIBUTES_NUMBER; i++) {
+#    ifdef ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
+        _anj_observe_remove_attr_storage_under_path(ctx, path);
+#    else  // ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
+        for (size_t i = 0; i < _ANJ_OBSERVE_ATTR_STORAGE_NUMBER(ctx); i++) {
             if (ctx->attributes_storage[i].ssid
                     && !anj_uri_path_outside_base(
                                &ctx->attributes_storage[i].path, path)) {
                 ctx->attributes_storage[i].ssid = 0;
             }
         }
-        for (size_t i = 0; i < ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER; i++) {
-            if (ctx->observations[i].ssid
-                    && !anj_uri_path_outside_base(&ctx->observations[i].path,
-                                                  path)
+#    endif // ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
+        for (size_t i = 0; i < _ANJ_OBSERVE_OBSERVATIONS_NUMBER(ctx); i++) {
+            if (_anj_observe_ssid_at(ctx, i)
+                    && !_anj_observe_path_outside_base_at(ctx, i, &scan_path)
 #    ifdef ANJ_WITH_OBSERVE_COMPOSITE
                     && !ctx->observations[i].prev
 #    endif // ANJ_WITH_OBSERVE_COMPOSITE
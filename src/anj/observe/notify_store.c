@@ -0,0 +1,150 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#define ANJ_LOG_SOURCE_FILE_ID 62
+
+#include <assert.h>
+#include <stddef.h>
+
+#include <anj/compat/time.h>
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/log.h>
+#include <anj/lwm2m_send.h>
+#include <anj/time.h>
+
+#include "observe.h"
+#include "observe_internal.h"
+
+#ifdef ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER
+
+void _anj_observe_notify_store_set_buffer(anj_t *anj,
+                                          anj_io_out_entry_t *buffer,
+                                          size_t buffer_size) {
+    assert(anj && (buffer || !buffer_size));
+    _anj_observe_notify_store_t *store = &anj->observe_ctx.notify_store;
+    assert(!store->flushed_count);
+    store->records = buffer;
+    store->capacity = buffer_size;
+    store->first = 0;
+    store->count = 0;
+}
+
+int _anj_observe_notify_store_add(_anj_observe_ctx_t *ctx,
+                                  const anj_uri_path_t *path,
+                                  anj_data_type_t type,
+                                  const anj_res_value_t *value) {
+    _anj_observe_notify_store_t *store = &ctx->notify_store;
+    if (!store->capacity || store->flushed_count) {
+        return -1;
+    }
+    /* Values of other types may point to memory that won't be valid when the
+     * record is sent */
+    switch (type) {
+    case ANJ_DATA_TYPE_INT:
+    case ANJ_DATA_TYPE_UINT:
+    case ANJ_DATA_TYPE_DOUBLE:
+    case ANJ_DATA_TYPE_BOOL:
+    case ANJ_DATA_TYPE_TIME:
+    case ANJ_DATA_TYPE_OBJLNK:
+        break;
+    default:
+        return -1;
+    }
+
+    size_t index;
+    if (store->count == store->capacity) {
+        observe_log(L_WARNING, "Notify store full, oldest value dropped");
+        index = store->first;
+        store->first = (store->first + 1) % store->capacity;
+    } else {
+        index = (store->first + store->count) % store->capacity;
+        store->count++;
+    }
+    store->records[index] = (anj_io_out_entry_t) {
+        .type = type,
+        .value = *value,
+        .path = *path,
+#ifdef ANJ_TIME_INTEGER_ONLY
+        // whole seconds, no floating-point time arithmetic is done
+        .timestamp = (double) anj_time_real_to_scalar(anj_time_real_now(),
+                                                      ANJ_TIME_UNIT_S)
+#else  // ANJ_TIME_INTEGER_ONLY
+        .timestamp = anj_time_real_to_fscalar(anj_time_real_now(),
+                                              ANJ_TIME_UNIT_S)
+#endif // ANJ_TIME_INTEGER_ONLY
+    };
+    return 0;
+}
+
+static void reverse_records(anj_io_out_entry_t *records, size_t begin,
+                            size_t end) {
+    while (begin + 1 < end) {
+        anj_io_out_entry_t tmp = records[begin];
+        records[begin] = records[end - 1];
+        records[end - 1] = tmp;
+        begin++;
+        end--;
+    }
+}
+
+/* Moves the records to the beginning of the buffer, so that they can be
+ * passed to the Send request as a single array. */
+static void linearize(_anj_observe_notify_store_t *store) {
+    if (!store->first) {
+        return;
+    }
+    reverse_records(store->records, 0, store->first);
+    reverse_records(store->records, store->first, store->capacity);
+    reverse_records(store->records, 0, store->capacity);
+    store->first = 0;
+}
+
+static void flush_finished(anj_t *anj, uint16_t send_id, int result,
+                           void *data) {
+    (void) anj;
+    (void) send_id;
+    _anj_observe_notify_store_t *store = (_anj_observe_notify_store_t *) data;
+    if (result == ANJ_SEND_SUCCESS) {
+        observe_log(L_INFO, "Stored notifications sent");
+        store->first = (store->first + store->flushed_count) % store->capacity;
+        store->count -= store->flushed_count;
+    } else {
+        observe_log(L_WARNING, "Failed to send stored notifications: %d",
+                    result);
+    }
+    store->flushed_count = 0;
+}
+
+void _anj_observe_notify_store_flush(anj_t *anj) {
+    assert(anj);
+    _anj_observe_notify_store_t *store = &anj->observe_ctx.notify_store;
+    if (!store->count || store->flushed_count) {
+        return;
+    }
+    linearize(store);
+    store->send_request = (anj_send_request_t) {
+        .records = store->records,
+        .records_cnt = store->count,
+        .finished_handler = flush_finished,
+        .data = store,
+        .content_format = ANJ_SEND_CONTENT_FORMAT_SENML_CBOR
+    };
+    int result = anj_send_new_request(anj, &store->send_request, NULL);
+    if (result) {
+        observe_log(L_WARNING, "Could not send stored notifications: %d",
+                    result);
+        return;
+    }
+    store->flushed_count = store->count;
+}
+
+#endif // ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER
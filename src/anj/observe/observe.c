@@ -13,6 +13,7 @@
 
 #include <assert.h>
 #include <inttypes.h>
+#include <math.h>
 #include <stdbool.h>
 #include <string.h>
 
@@ -51,31 +52,258 @@ static uint8_t map_err_to_coap_code(int error_code) {
     }
 }
 
+#    ifdef ANJ_OBSERVE_WITH_STATE_ARRAYS
+void _anj_observe_state_arrays_update(
+        _anj_observe_ctx_t *ctx, const _anj_observe_observation_t *observation) {
+    _anj_observe_state_arrays_t *arrays = &ctx->state_arrays;
+    if (!arrays->valid) {
+        return;
+    }
+    size_t obs_idx = (size_t) (observation - ctx->observations);
+    assert(obs_idx < _ANJ_OBSERVE_OBSERVATIONS_NUMBER(ctx));
+    arrays->path_key[obs_idx] = _anj_uri_path_key(&observation->path);
+    arrays->ssid[obs_idx] = observation->ssid;
+    arrays->flags[obs_idx] =
+            (uint8_t) ((observation->observe_active ? _ANJ_OBSERVE_STATE_ACTIVE
+                                                    : 0)
+                       | (observation->notification_to_send
+                                  ? _ANJ_OBSERVE_STATE_NOTIFICATION_TO_SEND
+                                  : 0));
+}
+
+void _anj_observe_state_arrays_invalidate(_anj_observe_ctx_t *ctx) {
+    ctx->state_arrays.valid = false;
+}
+
+void _anj_observe_state_arrays_prepare(_anj_observe_ctx_t *ctx) {
+    if (ctx->state_arrays.valid) {
+        return;
+    }
+    ctx->state_arrays.valid = true;
+    for (size_t i = 0; i < _ANJ_OBSERVE_OBSERVATIONS_NUMBER(ctx); i++) {
+        _anj_observe_state_arrays_update(ctx, &ctx->observations[i]);
+    }
+}
+#    endif // ANJ_OBSERVE_WITH_STATE_ARRAYS
+
+#    ifdef ANJ_OBSERVE_WITH_TOKEN_INDEX
+#        define TOKEN_INDEX_EMPTY_SLOT UINT16_MAX
+
+// FNV-1a
+static uint32_t hash_u16(uint32_t hash, uint16_t value) {
+    hash = (hash ^ (uint8_t) (value >> 8)) * 16777619U;
+    return (hash ^ (uint8_t) value) * 16777619U;
+}
+
+static size_t token_slot(uint16_t ssid, const _anj_coap_token_t *token) {
+    uint32_t hash = hash_u16(2166136261U, ssid);
+    for (size_t i = 0; i < token->size; i++) {
+        hash = (hash ^ (uint8_t) token->bytes[i]) * 16777619U;
+    }
+    return hash % _ANJ_OBSERVE_TOKEN_INDEX_SIZE;
+}
+
+#        ifdef ANJ_WITH_RST_AS_CANCEL_OBSERVE
+static size_t mid_slot(uint16_t mid) {
+    return hash_u16(2166136261U, mid) % _ANJ_OBSERVE_TOKEN_INDEX_SIZE;
+}
+#        endif // ANJ_WITH_RST_AS_CANCEL_OBSERVE
+
+static size_t next_slot(size_t slot) {
+    return (slot + 1) % _ANJ_OBSERVE_TOKEN_INDEX_SIZE;
+}
+
+static size_t home_slot(const _anj_observe_ctx_t *ctx,
+                        const uint16_t *table,
+                        uint16_t obs_idx) {
+    const _anj_observe_observation_t *observation = &ctx->observations[obs_idx];
+#        ifdef ANJ_WITH_RST_AS_CANCEL_OBSERVE
+    if (table == ctx->token_index.by_mid) {
+        return mid_slot(observation->last_sent_mid);
+    }
+#        else  // ANJ_WITH_RST_AS_CANCEL_OBSERVE
+    (void) table;
+#        endif // ANJ_WITH_RST_AS_CANCEL_OBSERVE
+    return token_slot(observation->ssid, &observation->token);
+}
+
+static void table_insert(uint16_t *table, size_t slot, uint16_t obs_idx) {
+    // there are at most ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER entries, so there
+    // is always an empty slot
+    while (table[slot] != TOKEN_INDEX_EMPTY_SLOT) {
+        slot = next_slot(slot);
+    }
+    table[slot] = obs_idx;
+}
+
+static void table_remove(const _anj_observe_ctx_t *ctx,
+                         uint16_t *table,
+                         size_t slot,
+                         uint16_t obs_idx) {
+    while (table[slot] != obs_idx) {
+        if (table[slot] == TOKEN_INDEX_EMPTY_SLOT) {
+            return;
+        }
+        slot = next_slot(slot);
+    }
+    // move back entries that would not be reachable from their home slots
+    // through the emptied one
+    size_t hole = slot;
+    for (slot = next_slot(hole); table[slot] != TOKEN_INDEX_EMPTY_SLOT;
+         slot = next_slot(slot)) {
+        size_t home = home_slot(ctx, table, table[slot]);
+        if ((slot + _ANJ_OBSERVE_TOKEN_INDEX_SIZE - home)
+                        % _ANJ_OBSERVE_TOKEN_INDEX_SIZE
+                >= (slot + _ANJ_OBSERVE_TOKEN_INDEX_SIZE - hole)
+                           % _ANJ_OBSERVE_TOKEN_INDEX_SIZE) {
+            table[hole] = table[slot];
+            hole = slot;
+        }
+    }
+    table[hole] = TOKEN_INDEX_EMPTY_SLOT;
+}
+
+static uint16_t index_of(const _anj_observe_ctx_t *ctx,
+                         const _anj_observe_observation_t *observation) {
+    size_t obs_idx = (size_t) (observation - ctx->observations);
+    assert(obs_idx < _ANJ_OBSERVE_OBSERVATIONS_NUMBER(ctx));
+    return (uint16_t) obs_idx;
+}
+
+// must be called once SSID and token of a new Observation are set
+static void token_index_insert(_anj_observe_ctx_t *ctx,
+                               const _anj_observe_observation_t *observation) {
+    _anj_observe_token_index_t *index = &ctx->token_index;
+    if (!index->valid) {
+        return;
+    }
+    uint16_t obs_idx = index_of(ctx, observation);
+    table_insert(index->by_token,
+                 token_slot(observation->ssid, &observation->token), obs_idx);
+#        ifdef ANJ_WITH_RST_AS_CANCEL_OBSERVE
+    table_insert(index->by_mid, mid_slot(observation->last_sent_mid), obs_idx);
+#        endif // ANJ_WITH_RST_AS_CANCEL_OBSERVE
+}
+
+// must be called before SSID of the Observation is cleared
+static void token_index_remove(_anj_observe_ctx_t *ctx,
+                               const _anj_observe_observation_t *observation) {
+    _anj_observe_token_index_t *index = &ctx->token_index;
+    if (!index->valid) {
+        return;
+    }
+    uint16_t obs_idx = index_of(ctx, observation);
+    table_remove(ctx, index->by_token,
+                 token_slot(observation->ssid, &observation->token), obs_idx);
+#        ifdef ANJ_WITH_RST_AS_CANCEL_OBSERVE
+    table_remove(ctx, index->by_mid, mid_slot(observation->last_sent_mid),
+                 obs_idx);
+#        endif // ANJ_WITH_RST_AS_CANCEL_OBSERVE
+}
+
+void _anj_observe_token_index_invalidate(_anj_observe_ctx_t *ctx) {
+    ctx->token_index.valid = false;
+}
+
+static void token_index_prepare(_anj_observe_ctx_t *ctx) {
+    _anj_observe_token_index_t *index = &ctx->token_index;
+    if (index->valid) {
+        return;
+    }
+    // every byte of TOKEN_INDEX_EMPTY_SLOT is 0xFF
+    memset(index->by_token, 0xFF, sizeof(index->by_token));
+#        ifdef ANJ_WITH_RST_AS_CANCEL_OBSERVE
+    memset(index->by_mid, 0xFF, sizeof(index->by_mid));
+#        endif // ANJ_WITH_RST_AS_CANCEL_OBSERVE
+    index->valid = true;
+    for (size_t i = 0; i < _ANJ_OBSERVE_OBSERVATIONS_NUMBER(ctx); i++) {
+        if (ctx->observations[i].ssid != 0) {
+            token_index_insert(ctx, &ctx->observations[i]);
+        }
+    }
+}
+#    endif // ANJ_OBSERVE_WITH_TOKEN_INDEX
+
 static _anj_observe_observation_t *
 find_observation(_anj_observe_ctx_t *ctx,
                  uint16_t ssid,
                  const _anj_coap_token_t *token) {
-    for (size_t i = 0; i < ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER; i++) {
-        if (ctx->observations[i].ssid == ssid
+#    ifdef ANJ_OBSERVE_WITH_TOKEN_INDEX
+    token_index_prepare(ctx);
+    const uint16_t *table = ctx->token_index.by_token;
+    // Observations of an Observe-Composite share the token; the first one in
+    // the table is returned, so that paths are listed in the same order
+    uint16_t found = TOKEN_INDEX_EMPTY_SLOT;
+    for (size_t slot = token_slot(ssid, token);
+         table[slot] != TOKEN_INDEX_EMPTY_SLOT;
+         slot = next_slot(slot)) {
+        const _anj_observe_observation_t *observation =
+                &ctx->observations[table[slot]];
+        if (table[slot] < found && observation->ssid == ssid
+                && _anj_tokens_equal(&observation->token, token)) {
+            found = table[slot];
+        }
+    }
+    return found == TOKEN_INDEX_EMPTY_SLOT ? NULL : &ctx->observations[found];
+#    else  // ANJ_OBSERVE_WITH_TOKEN_INDEX
+    _anj_observe_scan_begin(ctx);
+    for (size_t i = 0; i < _ANJ_OBSERVE_OBSERVATIONS_NUMBER(ctx); i++) {
+        if (_anj_observe_ssid_at(ctx, i) == ssid
                 && _anj_tokens_equal(&ctx->observations[i].token, token)) {
             return &ctx->observations[i];
         }
     }
     return NULL;
+#    endif // ANJ_OBSERVE_WITH_TOKEN_INDEX
 }
 
 static _anj_observe_observation_t *
 find_spot_for_new_observation(_anj_observe_ctx_t *ctx) {
-    for (size_t i = 0; i < ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER; i++) {
+    _anj_observe_scan_begin(ctx);
+    for (size_t i = 0; i < _ANJ_OBSERVE_OBSERVATIONS_NUMBER(ctx); i++) {
         // ssid can be 0 only if the observation is not used
-        if (ctx->observations[i].ssid == 0) {
+        if (_anj_observe_ssid_at(ctx, i) == 0) {
             return &ctx->observations[i];
         }
     }
     return NULL;
 }
 
+#    ifdef ANJ_WITH_RESOURCE_USAGE
+static void update_observations_max(anj_t *anj) {
+    _anj_observe_ctx_t *ctx = &anj->observe_ctx;
+    size_t used = 0;
+    // state arrays aren't updated with the new observation yet
+    for (size_t i = 0; i < _ANJ_OBSERVE_OBSERVATIONS_NUMBER(ctx); i++) {
+        if (ctx->observations[i].ssid != 0) {
+            used++;
+        }
+    }
+    anj->resource_usage.observations_max =
+            ANJ_MAX(anj->resource_usage.observations_max, used);
+}
+#    endif // ANJ_WITH_RESOURCE_USAGE
+
 #    ifdef ANJ_WITH_OBSERVE_COMPOSITE
+#        ifdef ANJ_OBSERVE_WITH_USER_STORAGE
+/* uri_paths holds ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER paths, while the table
+ * of Observations may be bigger. Observations being added are linked from
+ * processing_observation back to first_observation, whose link closes the
+ * list into a ring after each block of the request. */
+static bool composite_paths_full(const _anj_observe_ctx_t *ctx) {
+    size_t count = 0;
+    const _anj_observe_observation_t *iterator = ctx->processing_observation;
+    while (iterator) {
+        count++;
+        if (iterator == ctx->first_observation) {
+            break;
+        }
+        iterator = iterator->prev;
+    }
+    return count >= ANJ_ARRAY_SIZE(ctx->uri_paths);
+}
+#        endif // ANJ_OBSERVE_WITH_USER_STORAGE
+
 static void get_observation_paths_for_composite(anj_t *anj) {
     _anj_observe_ctx_t *ctx = &anj->observe_ctx;
     const _anj_observe_observation_t *observation = ctx->processing_observation;
@@ -101,12 +329,31 @@ void _anj_observe_refresh_timestamp(_anj_observe_ctx_t *ctx,
     do {
 #    endif // ANJ_WITH_OBSERVE_COMPOSITE
         ctx->processing_observation->last_notify_timestamp = timestamp;
+#    ifdef ANJ_OBSERVE_WITH_COMPOSITE_DELTA_NOTIFICATIONS
+        if (!ctx->processing_observation->excluded_from_notification) {
+            ctx->processing_observation->last_included_timestamp = timestamp;
+        }
+        ctx->processing_observation->excluded_from_notification = false;
+#    endif // ANJ_OBSERVE_WITH_COMPOSITE_DELTA_NOTIFICATIONS
         if (confirmable) {
+#    ifdef ANJ_OBSERVE_WITH_CON_POLICY
+            ctx->processing_observation->next_conf_notify_timestamp =
+                    anj_time_monotonic_add(
+                            timestamp,
+                            anj_time_duration_new(
+                                    ANJ_OBSERVE_CON_POLICY_MAX_INTERVAL_S,
+                                    ANJ_TIME_UNIT_S));
+            ctx->processing_observation->non_con_count = 0;
+#    else  // ANJ_OBSERVE_WITH_CON_POLICY
             ctx->processing_observation->next_conf_notify_timestamp =
                     anj_time_monotonic_add(
                             timestamp,
                             anj_time_duration_new(1, ANJ_TIME_UNIT_DAY));
+#    endif // ANJ_OBSERVE_WITH_CON_POLICY
         }
+#    ifdef ANJ_OBSERVE_WITH_DEADLINE_INDEX
+        _anj_observe_deadline_index_update(ctx, ctx->processing_observation);
+#    endif // ANJ_OBSERVE_WITH_DEADLINE_INDEX
 #    ifdef ANJ_WITH_OBSERVE_COMPOSITE
         if (ctx->processing_observation->prev) {
             ctx->processing_observation = ctx->processing_observation->prev;
@@ -137,6 +384,33 @@ void _anj_observe_write_anj_res_to_observe_val(
     }
 }
 
+#    if defined(ANJ_OBSERVE_WITH_VALUE_CACHE) \
+            || defined(ANJ_OBSERVE_WITH_HISTORICAL_QUEUE)
+void _anj_observe_write_observe_val_to_anj_res(
+        anj_res_value_t *res_value,
+        const _anj_observation_res_val_t *observe_val,
+        anj_data_type_t type) {
+    memset(res_value, 0, sizeof(*res_value));
+    switch (type) {
+    case ANJ_DATA_TYPE_INT:
+        res_value->int_value = observe_val->int_value;
+        break;
+    case ANJ_DATA_TYPE_UINT:
+        res_value->uint_value = observe_val->uint_value;
+        break;
+    case ANJ_DATA_TYPE_DOUBLE:
+        res_value->double_value = observe_val->double_value;
+        break;
+    case ANJ_DATA_TYPE_BOOL:
+        res_value->bool_value = observe_val->bool_value;
+        break;
+    default:
+        ANJ_UNREACHABLE("incorrect data type");
+    }
+}
+#    endif // defined(ANJ_OBSERVE_WITH_VALUE_CACHE) ||
+           // defined(ANJ_OBSERVE_WITH_HISTORICAL_QUEUE)
+
 /* If st/gt/lt or edge are present but observation targets multi-instance
  * resource, then they are removed from the effective_attr and are not
  * taken into account when sending notifications.
@@ -192,9 +466,50 @@ int _anj_observe_check_if_value_condition_attributes_should_be_disabled(
     return 0;
 }
 
+#    ifdef ANJ_OBSERVE_WITH_INTEGER_THRESHOLDS
+static int64_t double_to_int64_saturated(double value) {
+    if (!(value > (double) INT64_MIN)) {
+        return INT64_MIN;
+    }
+    if (value >= (double) INT64_MAX) {
+        return INT64_MAX;
+    }
+    return (int64_t) value;
+}
+
+static void int_attr_from_double(double threshold,
+                                 int64_t *out_floor,
+                                 int64_t *out_ceil) {
+    *out_floor = double_to_int64_saturated(floor(threshold));
+    *out_ceil = double_to_int64_saturated(ceil(threshold));
+}
+
+static void calculate_int_attr(_anj_observe_observation_t *observation) {
+    const _anj_attr_notification_t *attr = &observation->effective_attr;
+    _anj_observe_int_attr_t *int_attr = &observation->int_attr;
+    memset(int_attr, 0, sizeof(*int_attr));
+    if (attr->has_greater_than) {
+        int_attr_from_double(attr->greater_than, &int_attr->greater_than_floor,
+                             &int_attr->greater_than_ceil);
+    }
+    if (attr->has_less_than) {
+        int_attr_from_double(attr->less_than, &int_attr->less_than_floor,
+                             &int_attr->less_than_ceil);
+    }
+    if (attr->has_step && attr->step > 0) {
+        double step = ceil(attr->step);
+        int_attr->step_ceil =
+                step >= (double) UINT64_MAX ? UINT64_MAX : (uint64_t) step;
+    }
+}
+#    endif // ANJ_OBSERVE_WITH_INTEGER_THRESHOLDS
+
 void _anj_observe_verify_effective_attributes(
         _anj_observe_observation_t *observation) {
     _anj_attr_notification_t *attr = &observation->effective_attr;
+#    ifdef ANJ_OBSERVE_WITH_INTEGER_THRESHOLDS
+    calculate_int_attr(observation);
+#    endif // ANJ_OBSERVE_WITH_INTEGER_THRESHOLDS
     if (_anj_observe_verify_attributes(attr, &observation->path, false)) {
         observe_log(L_WARNING, "Effective attributes are invalid, observation "
                                "will not be active");
@@ -241,10 +556,22 @@ static int calculate_effective_attr_set_init_values(
 
     if ((res = _anj_observe_check_if_value_condition_attributes_should_be_disabled(
                  anj, observation))) {
+#    ifdef ANJ_OBSERVE_WITH_DEADLINE_INDEX
+        _anj_observe_deadline_index_update(&anj->observe_ctx, observation);
+#    endif // ANJ_OBSERVE_WITH_DEADLINE_INDEX
+#    ifdef ANJ_OBSERVE_WITH_STATE_ARRAYS
+        _anj_observe_state_arrays_update(&anj->observe_ctx, observation);
+#    endif // ANJ_OBSERVE_WITH_STATE_ARRAYS
         return res;
     }
 
     _anj_observe_verify_effective_attributes(observation);
+#    ifdef ANJ_OBSERVE_WITH_DEADLINE_INDEX
+    _anj_observe_deadline_index_update(&anj->observe_ctx, observation);
+#    endif // ANJ_OBSERVE_WITH_DEADLINE_INDEX
+#    ifdef ANJ_OBSERVE_WITH_STATE_ARRAYS
+    _anj_observe_state_arrays_update(&anj->observe_ctx, observation);
+#    endif // ANJ_OBSERVE_WITH_STATE_ARRAYS
 
     return 0;
 }
@@ -253,15 +580,36 @@ void _anj_observe_remove_observation(_anj_observe_ctx_t *ctx) {
     _anj_observe_observation_t *base_observation = ctx->processing_observation;
     assert(base_observation);
 
+#    ifdef ANJ_OBSERVE_WITH_TOKEN_INDEX
+    token_index_remove(ctx, base_observation);
+#    endif // ANJ_OBSERVE_WITH_TOKEN_INDEX
     base_observation->ssid = 0;
     base_observation->notification_to_send = false;
+#    ifdef ANJ_OBSERVE_WITH_PATH_INDEX
+    _anj_observe_path_index_invalidate(ctx);
+#    endif // ANJ_OBSERVE_WITH_PATH_INDEX
+#    ifdef ANJ_OBSERVE_WITH_DEADLINE_INDEX
+    _anj_observe_deadline_index_update(ctx, base_observation);
+#    endif // ANJ_OBSERVE_WITH_DEADLINE_INDEX
+#    ifdef ANJ_OBSERVE_WITH_STATE_ARRAYS
+    _anj_observe_state_arrays_update(ctx, base_observation);
+#    endif // ANJ_OBSERVE_WITH_STATE_ARRAYS
 #    ifdef ANJ_WITH_OBSERVE_COMPOSITE
     if (base_observation->prev) {
         _anj_observe_observation_t *prev_observation = base_observation->prev;
         while (prev_observation != base_observation) {
             assert(prev_observation);
+#        ifdef ANJ_OBSERVE_WITH_TOKEN_INDEX
+            token_index_remove(ctx, prev_observation);
+#        endif // ANJ_OBSERVE_WITH_TOKEN_INDEX
             prev_observation->ssid = 0;
             prev_observation->notification_to_send = false;
+#        ifdef ANJ_OBSERVE_WITH_DEADLINE_INDEX
+            _anj_observe_deadline_index_update(ctx, prev_observation);
+#        endif // ANJ_OBSERVE_WITH_DEADLINE_INDEX
+#        ifdef ANJ_OBSERVE_WITH_STATE_ARRAYS
+            _anj_observe_state_arrays_update(ctx, prev_observation);
+#        endif // ANJ_OBSERVE_WITH_STATE_ARRAYS
             prev_observation = prev_observation->prev;
         }
     }
@@ -354,6 +702,14 @@ static int add_observation(anj_t *anj,
     (void) notification_attr; // suppress unused parameter warning
 #    endif // ANJ_WITH_LWM2M12
     _anj_observe_ctx_t *ctx = &anj->observe_ctx;
+#    if defined(ANJ_OBSERVE_WITH_USER_STORAGE) \
+            && defined(ANJ_WITH_OBSERVE_COMPOSITE)
+    if (composite_paths_full(ctx)) {
+        observe_log(L_ERROR, "Too many paths in the Observe-Composite request");
+        return ANJ_COAP_CODE_INTERNAL_SERVER_ERROR;
+    }
+#    endif // defined(ANJ_OBSERVE_WITH_USER_STORAGE) &&
+           // defined(ANJ_WITH_OBSERVE_COMPOSITE)
     observation = find_spot_for_new_observation(ctx);
     if (!observation) {
         observe_log(L_ERROR, "No space for the new observation");
@@ -362,6 +718,25 @@ static int add_observation(anj_t *anj,
     observation->path = *uri_path;
     observation->ssid = ssid;
     observation->token = *ctx->token;
+#    ifdef ANJ_WITH_RESOURCE_USAGE
+    update_observations_max(anj);
+#    endif // ANJ_WITH_RESOURCE_USAGE
+#    ifdef ANJ_OBSERVE_WITH_TOKEN_INDEX
+    token_index_insert(ctx, observation);
+#    endif // ANJ_OBSERVE_WITH_TOKEN_INDEX
+#    ifdef ANJ_OBSERVE_WITH_CON_POLICY
+    observation->non_con_count = 0;
+    observation->threshold_crossed = false;
+#    endif // ANJ_OBSERVE_WITH_CON_POLICY
+#    ifdef ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+    _anj_observe_historical_queue_reset(&observation->historical_queue);
+#    endif // ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+#    ifdef ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS
+    observation->last_etag.size = 0;
+#    endif // ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS
+#    ifdef ANJ_OBSERVE_WITH_PATH_INDEX
+    _anj_observe_path_index_invalidate(ctx);
+#    endif // ANJ_OBSERVE_WITH_PATH_INDEX
 #    ifdef ANJ_WITH_OBSERVE_COMPOSITE
     observation->accept_opt = accept_opt;
     observation->content_format_opt = content_format;
@@ -433,7 +808,8 @@ static uint8_t add_composite_observation(void *arg_ptr,
     if ((result == _ANJ_IO_EOF && !foo_obs_result)
             || result == _ANJ_IO_WANT_NEXT_PAYLOAD) {
         if (last_block) {
-            _anj_observe_refresh_timestamp(ctx, anj_time_monotonic_now(), true);
+            _anj_observe_refresh_timestamp(
+                    ctx, _ANJ_STEP_TIME_NOW(ctx->step_time), true);
             _anj_observe_set_uri_paths_and_format(anj);
         }
         return 0;
@@ -451,7 +827,53 @@ void _anj_observe_init(anj_t *anj) {
     assert(anj);
     _anj_observe_ctx_t *ctx = &anj->observe_ctx;
     memset(ctx, 0, sizeof(*ctx));
+#    ifdef ANJ_OBSERVE_WITH_USER_STORAGE
+    ctx->observations = ctx->default_observations;
+    ctx->observations_number = ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER;
+    ctx->attributes_storage = ctx->default_attributes_storage;
+    ctx->attributes_storage_number = ANJ_OBSERVE_MAX_WRITE_ATTRIBUTES_NUMBER;
+#    endif // ANJ_OBSERVE_WITH_USER_STORAGE
+#    ifdef ANJ_OBSERVE_WITH_NOTIFICATION_COALESCING
+    ctx->coalescing_start = ANJ_TIME_MONOTONIC_INVALID;
+#    endif // ANJ_OBSERVE_WITH_NOTIFICATION_COALESCING
+#    ifdef ANJ_WITH_STEP_TIME_CACHE
+    ctx->step_time = &anj->step_time;
+#    endif // ANJ_WITH_STEP_TIME_CACHE
+}
+
+#    ifdef ANJ_OBSERVE_WITH_USER_STORAGE
+int _anj_observe_set_storage(anj_t *anj,
+                             _anj_observe_observation_t *observations,
+                             uint16_t observations_number,
+                             _anj_observe_attr_storage_t *attributes_storage,
+                             uint16_t attributes_storage_number) {
+    assert(anj);
+    _anj_observe_ctx_t *ctx = &anj->observe_ctx;
+    // UINT16_MAX marks missing entries in indexes and persisted links
+    if ((observations
+         && (!observations_number || observations_number == UINT16_MAX))
+            || (attributes_storage
+                && (!attributes_storage_number
+                    || attributes_storage_number == UINT16_MAX))) {
+        observe_log(L_ERROR, "Invalid size of the Observations or attributes "
+                             "table");
+        return -1;
+    }
+    if (observations) {
+        // ssid equal to 0 marks unused entries
+        memset(observations, 0, observations_number * sizeof(*observations));
+        ctx->observations = observations;
+        ctx->observations_number = observations_number;
+    }
+    if (attributes_storage) {
+        memset(attributes_storage, 0,
+               attributes_storage_number * sizeof(*attributes_storage));
+        ctx->attributes_storage = attributes_storage;
+        ctx->attributes_storage_number = attributes_storage_number;
+    }
+    return 0;
 }
+#    endif // ANJ_OBSERVE_WITH_USER_STORAGE
 
 uint8_t _anj_observe_build_message(void *arg_ptr,
                                    uint8_t *buff,
@@ -470,10 +892,23 @@ uint8_t _anj_observe_build_message(void *arg_ptr,
     const anj_uri_path_t *uri_paths[1] = { &ctx->processing_observation->path };
 #    endif // ANJ_WITH_OBSERVE_COMPOSITE
 
+#    ifdef ANJ_OBSERVE_WITH_VALUE_CACHE
+    anj_res_value_t cached_value;
+    if (!composite && ctx->in_progress_type == MSG_TYPE_NOTIFY
+            && ctx->processing_observation->has_cached_value) {
+        _anj_observe_write_observe_val_to_anj_res(
+                &cached_value, &ctx->processing_observation->cached_value,
+                ctx->processing_observation->cached_value_type);
+        anj->dm.cached_read_value = &cached_value;
+    }
+#    endif // ANJ_OBSERVE_WITH_VALUE_CACHE
     result = _anj_dm_observe_build_msg(anj, uri_paths, ctx->uri_count,
                                        &ctx->already_processed, buff,
                                        &out_params->payload_len, buff_len,
                                        &out_params->format, composite);
+#    ifdef ANJ_OBSERVE_WITH_VALUE_CACHE
+    anj->dm.cached_read_value = NULL;
+#    endif // ANJ_OBSERVE_WITH_VALUE_CACHE
 
     if (result) {
         return result != _ANJ_EXCHANGE_BLOCK_TRANSFER_NEEDED
@@ -515,10 +950,11 @@ static void refresh_after_write_attr(anj_t *anj,
                                      const anj_uri_path_t *path,
                                      uint16_t ssid) {
     _anj_observe_ctx_t *ctx = &anj->observe_ctx;
-    for (size_t i = 0; i < ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER; i++) {
-        if (ctx->observations[i].ssid == ssid
-                && !anj_uri_path_outside_base(&ctx->observations[i].path,
-                                              path)) {
+    const _anj_observe_scan_path_t base = _anj_observe_scan_path(path);
+    _anj_observe_scan_begin(ctx);
+    for (size_t i = 0; i < _ANJ_OBSERVE_OBSERVATIONS_NUMBER(ctx); i++) {
+        if (_anj_observe_ssid_at(ctx, i) == ssid
+                && !_anj_observe_path_outside_base_at(ctx, i, &base)) {
             calculate_effective_attr_set_init_values(anj, &ctx->observations[i],
                                                      ssid);
         }
@@ -651,7 +1087,8 @@ static int parse_request(anj_t *anj,
                     break;
                 }
             }
-            _anj_observe_refresh_timestamp(ctx, anj_time_monotonic_now(), true);
+            _anj_observe_refresh_timestamp(
+                    ctx, _ANJ_STEP_TIME_NOW(ctx->step_time), true);
 #    ifdef ANJ_WITH_OBSERVE_COMPOSITE
         }
 #    endif // ANJ_WITH_OBSERVE_COMPOSITE
@@ -720,17 +1157,64 @@ int _anj_observe_new_request(anj_t *anj,
                          server_state->ssid);
 }
 
+bool _anj_observe_token_in_use(void *arg_ptr, const _anj_coap_token_t *token) {
+    assert(arg_ptr && token);
+    const _anj_observe_ctx_t *ctx = (const _anj_observe_ctx_t *) arg_ptr;
+    for (size_t i = 0; i < _ANJ_OBSERVE_OBSERVATIONS_NUMBER(ctx); i++) {
+        if (ctx->observations[i].ssid
+                && _anj_tokens_equal(&ctx->observations[i].token, token)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void _anj_observe_remove_all_observations(anj_t *anj, uint16_t ssid) {
     assert(anj && ssid != 0);
     _anj_observe_ctx_t *ctx = &anj->observe_ctx;
-    for (size_t i = 0; i < ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER; i++) {
+    for (size_t i = 0; i < _ANJ_OBSERVE_OBSERVATIONS_NUMBER(ctx); i++) {
         if (ctx->observations[i].ssid == ssid
                 || ssid == ANJ_OBSERVE_ANY_SERVER) {
             ctx->observations[i].ssid = 0;
         }
     }
+#    ifdef ANJ_OBSERVE_WITH_DEADLINE_INDEX
+    _anj_observe_deadline_index_invalidate(ctx);
+#    endif // ANJ_OBSERVE_WITH_DEADLINE_INDEX
+#    ifdef ANJ_OBSERVE_WITH_PATH_INDEX
+    _anj_observe_path_index_invalidate(ctx);
+#    endif // ANJ_OBSERVE_WITH_PATH_INDEX
+#    ifdef ANJ_OBSERVE_WITH_STATE_ARRAYS
+    _anj_observe_state_arrays_invalidate(ctx);
+#    endif // ANJ_OBSERVE_WITH_STATE_ARRAYS
+#    ifdef ANJ_OBSERVE_WITH_TOKEN_INDEX
+    _anj_observe_token_index_invalidate(ctx);
+#    endif // ANJ_OBSERVE_WITH_TOKEN_INDEX
 }
 
+#    ifdef ANJ_WITH_WARM_RESTART
+void _anj_observe_remove_observations_of_missing_paths(anj_t *anj,
+                                                       uint16_t ssid) {
+    assert(anj && ssid != 0);
+    _anj_observe_ctx_t *ctx = &anj->observe_ctx;
+    _anj_observe_observation_t *previous_processing_observation =
+            ctx->processing_observation;
+    for (size_t i = 0; i < _ANJ_OBSERVE_OBSERVATIONS_NUMBER(ctx); i++) {
+        if (ctx->observations[i].ssid == ssid
+#        ifdef ANJ_WITH_OBSERVE_COMPOSITE
+                && !ctx->observations[i].prev
+#        endif // ANJ_WITH_OBSERVE_COMPOSITE
+                && _anj_dm_observe_is_any_resource_readable(
+                           anj, &ctx->observations[i].path)
+                               == ANJ_COAP_CODE_NOT_FOUND) {
+            ctx->processing_observation = &ctx->observations[i];
+            _anj_observe_remove_observation(ctx);
+        }
+    }
+    ctx->processing_observation = previous_processing_observation;
+}
+#    endif // ANJ_WITH_WARM_RESTART
+
 #    ifdef ANJ_WITH_RST_AS_CANCEL_OBSERVE
 void _anj_observe_update_last_mid(anj_t *anj, uint16_t mid) {
     _anj_observe_ctx_t *ctx = &anj->observe_ctx;
@@ -738,19 +1222,52 @@ void _anj_observe_update_last_mid(anj_t *anj, uint16_t mid) {
     if (!observation) {
         return;
     }
+#        ifdef ANJ_OBSERVE_WITH_TOKEN_INDEX
+    if (ctx->token_index.valid && observation->ssid != 0) {
+        uint16_t obs_idx = index_of(ctx, observation);
+        table_remove(ctx, ctx->token_index.by_mid,
+                     mid_slot(observation->last_sent_mid), obs_idx);
+        table_insert(ctx->token_index.by_mid, mid_slot(mid), obs_idx);
+    }
+#        endif // ANJ_OBSERVE_WITH_TOKEN_INDEX
     observation->last_sent_mid = mid;
 }
 
 void _anj_observe_cancel_observation_by_mid(anj_t *anj, uint16_t mid) {
     _anj_observe_ctx_t *ctx = &anj->observe_ctx;
-    for (size_t i = 0; i < ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER; i++) {
+#        ifdef ANJ_OBSERVE_WITH_TOKEN_INDEX
+    token_index_prepare(ctx);
+    const uint16_t *table = ctx->token_index.by_mid;
+    size_t slot = mid_slot(mid);
+    while (table[slot] != TOKEN_INDEX_EMPTY_SLOT) {
+        _anj_observe_observation_t *observation =
+                &ctx->observations[table[slot]];
+        if (observation->last_sent_mid != mid) {
+            slot = next_slot(slot);
+            continue;
+        }
+        ctx->processing_observation = observation;
+        _anj_observe_remove_observation(ctx);
+        // removal moves the following entries back
+        slot = mid_slot(mid);
+    }
+#        else  // ANJ_OBSERVE_WITH_TOKEN_INDEX
+    for (size_t i = 0; i < _ANJ_OBSERVE_OBSERVATIONS_NUMBER(ctx); i++) {
         if (ctx->observations[i].last_sent_mid == mid
                 && ctx->observations[i].ssid != 0) {
             ctx->processing_observation = &ctx->observations[i];
             _anj_observe_remove_observation(ctx);
         }
     }
+#        endif // ANJ_OBSERVE_WITH_TOKEN_INDEX
 }
 #    endif // ANJ_WITH_RST_AS_CANCEL_OBSERVE
 
+#    ifdef ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS
+void _anj_observe_update_last_etag(anj_t *anj, const _anj_etag_t *etag) {
+    assert(anj && etag);
+    anj->observe_ctx.notification_etag = *etag;
+}
+#    endif // ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS
+
 #endif // ANJ_WITH_OBSERVE
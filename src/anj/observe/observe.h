@@ -126,6 +126,32 @@ typedef enum {
  */
 void _anj_observe_init(anj_t *anj);
 
+#        ifdef ANJ_OBSERVE_WITH_USER_STORAGE
+/**
+ * Replaces the tables of Observations and attributes embedded in @p anj with
+ * the ones provided by the user. Should be called right after
+ * @ref _anj_observe_init. Provided tables are cleared.
+ *
+ * @param anj                        Anjay object to operate on.
+ * @param observations               Table of Observations, or NULL to keep the
+ *                                   embedded one.
+ * @param observations_number        Number of entries of @p observations.
+ * @param attributes_storage         Table of attributes set with
+ *                                   Write-Attributes, or NULL to keep the
+ *                                   embedded one.
+ * @param attributes_storage_number  Number of entries of
+ *                                   @p attributes_storage.
+ *
+ * @returns 0 on success, -1 if any of the provided tables has 0 or UINT16_MAX
+ *          entries.
+ */
+int _anj_observe_set_storage(anj_t *anj,
+                             _anj_observe_observation_t *observations,
+                             uint16_t observations_number,
+                             _anj_observe_attr_storage_t *attributes_storage,
+                             uint16_t attributes_storage_number);
+#        endif // ANJ_OBSERVE_WITH_USER_STORAGE
+
 /**
  * This function should be called after receiving a request from the LwM2M
  * server related to information reporting interface:
@@ -215,6 +241,19 @@ int _anj_observe_process(anj_t *anj,
  */
 void _anj_observe_remove_all_observations(anj_t *anj, uint16_t ssid);
 
+#    ifdef ANJ_WITH_WARM_RESTART
+/**
+ * Removes observations of given server whose paths are no longer present in
+ * the data model. Composite observations are kept, their paths are allowed not
+ * to exist.
+ *
+ * @param     anj    Anjay object to operate on.
+ * @param[in] ssid   ID of the server whose observations should be checked.
+ */
+void _anj_observe_remove_observations_of_missing_paths(anj_t *anj,
+                                                       uint16_t ssid);
+#    endif // ANJ_WITH_WARM_RESTART
+
 /**
  * Removes all attribute storage records for given server. Might be called when
  * the connection to a specific LwM2M server is finished. Specification allows
@@ -227,6 +266,60 @@ void _anj_observe_remove_all_observations(anj_t *anj, uint16_t ssid);
  */
 void _anj_observe_remove_all_attr_storage(anj_t *anj, uint16_t ssid);
 
+/**
+ * Checks if @p token is used by any Observation, so that it's not reused by a
+ * client request. Meant to be passed to @ref _anj_exchange_setup_token_check.
+ *
+ * @param arg_ptr Pointer to @ref _anj_observe_ctx_t.
+ * @param token   Token to check.
+ *
+ * @returns true if @p token is used by an Observation of any LwM2M Server.
+ */
+bool _anj_observe_token_in_use(void *arg_ptr, const _anj_coap_token_t *token);
+
+#        ifdef ANJ_WITH_SESSION_PERSISTENCE
+/**
+ * Stores or restores all observations and attribute storage records. Points
+ * in time are persisted relative to @p base, see
+ * @ref _anj_persistence_monotonic_time.
+ *
+ * @param anj  Anjay object to operate on.
+ * @param ctx  Persistence context.
+ * @param base Time of the store operation on the current monotonic clock.
+ *
+ * @return 0 on success, negative value on error. In case of a restore error
+ *         all observations and attribute storage records are removed.
+ */
+int _anj_observe_persistence(anj_t *anj,
+                             const anj_persistence_context_t *ctx,
+                             anj_time_monotonic_t base);
+#        endif // ANJ_WITH_SESSION_PERSISTENCE
+
+#        ifdef ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER
+/**
+ * Sets the buffer in which notifications are recorded while the server is
+ * offline. Previously recorded values are discarded.
+ *
+ * @param anj         Anjay object to operate on.
+ * @param buffer      Array used as a ring buffer, may be NULL to disable
+ *                    recording.
+ * @param buffer_size Number of elements in @p buffer.
+ */
+void _anj_observe_notify_store_set_buffer(anj_t *anj,
+                                          anj_io_out_entry_t *buffer,
+                                          size_t buffer_size);
+
+/**
+ * Queues a LwM2M Send request with all values recorded while the server was
+ * offline. Should be called when the server becomes reachable again. Values
+ * are removed from the buffer once the Send request succeeds; in case of a
+ * failure they are kept until the next call.
+ *
+ * @param anj Anjay object to operate on.
+ */
+void _anj_observe_notify_store_flush(anj_t *anj);
+#        endif // ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER
+
 #        ifdef ANJ_WITH_DISCOVER_ATTR
 /**
  * Retrieves the attribute storage record for the given server and path. This
@@ -337,6 +430,55 @@ void _anj_observe_update_last_mid(anj_t *anj, uint16_t mid);
 void _anj_observe_cancel_observation_by_mid(anj_t *anj, uint16_t mid);
 #        endif // ANJ_WITH_RST_AS_CANCEL_OBSERVE
 
+#        ifdef ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS
+/**
+ * Sets the ETag of the notification prepared for the currently processed
+ * Observation. It is compared with the ETag of the next notification once this
+ * one is sent successfully.
+ *
+ * @param anj  Anjay object to operate on.
+ * @param etag ETag assigned to the notification by the exchange module, empty
+ *             if the notification is sent with a Block-Wise transfer.
+ */
+void _anj_observe_update_last_etag(anj_t *anj, const _anj_etag_t *etag);
+#        endif // ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS
+
+#        ifdef ANJ_WITH_PIPELINED_NOTIFICATIONS
+/**
+ * Finishes the processing of the notification prepared by the last call to
+ * @ref _anj_observe_process, without waiting for the response. Must be called
+ * only if the whole notification has been prepared in a single message, after
+ * @ref _anj_observe_update_last_mid and @ref _anj_observe_update_last_etag.
+ *
+ * The Observation is marked as notified, so that the same values are not sent
+ * again, and the data model operation is finished, so that other operations
+ * can be processed before the response arrives. Completion handler returned by
+ * @ref _anj_observe_process must not be called afterwards,
+ * @ref _anj_observe_detached_notification_completion is used instead.
+ *
+ * @param      anj              Anjay object to operate on.
+ * @param[out] out_notification Information needed to complete the
+ *                              notification.
+ */
+void _anj_observe_detach_notification(
+        anj_t *anj, _anj_observe_detached_notification_t *out_notification);
+
+/**
+ * Handles the result of the exchange of a notification detached with
+ * @ref _anj_observe_detach_notification. If the notification has been
+ * rejected, the Observation is removed, as for other notifications. It's
+ * ignored if the Observation has been removed already.
+ *
+ * @param anj          Anjay object to operate on.
+ * @param notification Detached notification.
+ * @param result       Result of the exchange.
+ */
+void _anj_observe_detached_notification_completion(
+        anj_t *anj,
+        const _anj_observe_detached_notification_t *notification,
+        int result);
+#        endif // ANJ_WITH_PIPELINED_NOTIFICATIONS
+
 #    endif // ANJ_WITH_OBSERVE
 
 #endif // SRC_ANJ_OBSERVE_H
@@ -23,6 +23,7 @@
 #include <anj/utils.h>
 
 #include "../dm/dm_integration.h"
+#include "../utils.h"
 #include "observe.h"
 #include "observe_internal.h"
 
@@ -150,21 +151,111 @@ int _anj_observe_attributes_apply_condition(
     return 0;
 }
 
+#    ifdef ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
+static int attr_storage_compare(const _anj_observe_attr_storage_t *record,
+                                const anj_uri_path_t *path,
+                                uint16_t ssid) {
+    int result = _anj_uri_path_compare(&record->path, path);
+    if (result) {
+        return result;
+    }
+    return (int) record->ssid - (int) ssid;
+}
+
+static void attr_storage_index_prepare(_anj_observe_ctx_t *ctx) {
+    _anj_observe_attr_storage_index_t *index = &ctx->attr_storage_index;
+    if (index->valid) {
+        return;
+    }
+    /* Insertion sort is good enough, the index is rebuilt only after the set
+     * of records has changed. */
+    index->size = 0;
+    for (uint16_t i = 0; i < _ANJ_OBSERVE_ATTR_STORAGE_NUMBER(ctx); i++) {
+        const _anj_observe_attr_storage_t *record = &ctx->attributes_storage[i];
+        if (!record->ssid) {
+            continue;
+        }
+        uint16_t pos = index->size++;
+        while (pos > 0
+               && attr_storage_compare(
+                          &ctx->attributes_storage[index->entries[pos - 1]],
+                          &record->path, record->ssid)
+                          > 0) {
+            index->entries[pos] = index->entries[pos - 1];
+            pos--;
+        }
+        index->entries[pos] = i;
+    }
+    index->valid = true;
+}
+
+static uint16_t attr_storage_index_lower_bound(const _anj_observe_ctx_t *ctx,
+                                               const anj_uri_path_t *path,
+                                               uint16_t ssid) {
+    uint16_t low = 0;
+    uint16_t high = ctx->attr_storage_index.size;
+    while (low < high) {
+        uint16_t mid = (uint16_t) (low + (high - low) / 2);
+        if (attr_storage_compare(
+                    &ctx->attributes_storage[ctx->attr_storage_index
+                                                     .entries[mid]],
+                    path, ssid)
+                < 0) {
+            low = (uint16_t) (mid + 1);
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+void _anj_observe_attr_storage_index_invalidate(_anj_observe_ctx_t *ctx) {
+    ctx->attr_storage_index.valid = false;
+}
+
+void _anj_observe_remove_attr_storage_under_path(_anj_observe_ctx_t *ctx,
+                                                 const anj_uri_path_t *path) {
+    attr_storage_index_prepare(ctx);
+    /* Records with paths starting with path directly follow the first record
+     * with path not ordered before it, regardless of SSID. */
+    for (uint16_t pos = attr_storage_index_lower_bound(ctx, path, 0);
+         pos < ctx->attr_storage_index.size;
+         pos++) {
+        _anj_observe_attr_storage_t *record =
+                &ctx->attributes_storage[ctx->attr_storage_index.entries[pos]];
+        if (anj_uri_path_outside_base(&record->path, path)) {
+            break;
+        }
+        record->ssid = 0;
+    }
+    _anj_observe_attr_storage_index_invalidate(ctx);
+}
+#    endif // ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
+
 static _anj_observe_attr_storage_t *
 find_spot_for_new_attr(_anj_observe_ctx_t *ctx) {
-    for (size_t i = 0; i < ANJ_OBSERVE_MAX_WRITE_ATTRIBUTES_NUMBER; ++i) {
+    for (size_t i = 0; i < _ANJ_OBSERVE_ATTR_STORAGE_NUMBER(ctx); ++i) {
         // ssid can be 0 only if the attr spot is not used
         if (ctx->attributes_storage[i].ssid == 0) {
             memset(&ctx->attributes_storage[i], 0,
                    sizeof(ctx->attributes_storage[i]));
+#    ifdef ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
+            _anj_observe_attr_storage_index_invalidate(ctx);
+#    endif // ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
             return &ctx->attributes_storage[i];
         }
     }
     return NULL;
 }
 
-static void remove_attr(_anj_observe_attr_storage_t *attr_rec) {
+static void remove_attr(_anj_observe_ctx_t *ctx,
+                        _anj_observe_attr_storage_t *attr_rec) {
     attr_rec->ssid = 0;
+#    ifdef ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
+    _anj_observe_attr_storage_index_invalidate(ctx);
+#    else  // ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
+    (void) ctx;
+#    endif // ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
 }
 
 static void update_uint_attr(bool *is_active,
@@ -248,12 +339,24 @@ static int add_attr(_anj_observe_ctx_t *ctx,
 
 _anj_observe_attr_storage_t *_anj_observe_get_attr_from_path(
         _anj_observe_ctx_t *ctx, const anj_uri_path_t *path, uint16_t ssid) {
-    for (size_t i = 0; i < ANJ_OBSERVE_MAX_WRITE_ATTRIBUTES_NUMBER; ++i) {
+#    ifdef ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
+    attr_storage_index_prepare(ctx);
+    uint16_t pos = attr_storage_index_lower_bound(ctx, path, ssid);
+    if (pos < ctx->attr_storage_index.size) {
+        _anj_observe_attr_storage_t *record =
+                &ctx->attributes_storage[ctx->attr_storage_index.entries[pos]];
+        if (record->ssid == ssid && anj_uri_path_equal(&record->path, path)) {
+            return record;
+        }
+    }
+#    else  // ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
+    for (size_t i = 0; i < _ANJ_OBSERVE_ATTR_STORAGE_NUMBER(ctx); ++i) {
         if (anj_uri_path_equal(path, &ctx->attributes_storage[i].path)
                 && ssid == ctx->attributes_storage[i].ssid) {
             return &ctx->attributes_storage[i];
         }
     }
+#    endif // ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
     return NULL;
 }
 
@@ -282,7 +385,7 @@ int _anj_observe_write_attr_handle(anj_t *anj,
     // in case of error or empty attributes, remove the record
     if (res || _anj_observe_is_empty_attr(&record->attr)) {
         observe_log(L_WARNING, "Attributes verification failed");
-        remove_attr(record);
+        remove_attr(&anj->observe_ctx, record);
     }
     observe_log(L_DEBUG, "New attributes successfully added");
     return res;
@@ -291,15 +394,58 @@ int _anj_observe_write_attr_handle(anj_t *anj,
 void _anj_observe_remove_all_attr_storage(anj_t *anj, uint16_t ssid) {
     assert(anj && ssid > 0 && ssid < ANJ_OBSERVE_ANY_SERVER);
     _anj_observe_ctx_t *ctx = &anj->observe_ctx;
-    for (size_t i = 0; i < ANJ_OBSERVE_MAX_WRITE_ATTRIBUTES_NUMBER; ++i) {
+    for (size_t i = 0; i < _ANJ_OBSERVE_ATTR_STORAGE_NUMBER(ctx); ++i) {
         if (ctx->attributes_storage[i].ssid == ssid
                 || ssid == ANJ_OBSERVE_ANY_SERVER) {
             ctx->attributes_storage[i].ssid = 0;
         }
     }
+#    ifdef ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
+    _anj_observe_attr_storage_index_invalidate(ctx);
+#    endif // ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
 }
 
 #    ifdef ANJ_WITH_DISCOVER_ATTR
+static _anj_observe_attr_storage_t *
+get_discover_attr(_anj_observe_ctx_t *ctx,
+                  const anj_uri_path_t *path,
+                  uint16_t ssid) {
+#        ifdef ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
+    _anj_observe_attr_storage_index_t *index = &ctx->attr_storage_index;
+    attr_storage_index_prepare(ctx);
+    /* Discover records come in the same order as the index, so the lookup
+     * continues from where the previous one ended and the whole operation
+     * is a single pass over the index. Binary search is used only if the
+     * path is not ordered after the previous one. */
+    uint16_t pos = index->discover_pos;
+    if (pos > index->size
+            || (pos > 0
+                && attr_storage_compare(
+                           &ctx->attributes_storage[index->entries[pos - 1]],
+                           path, ssid)
+                           >= 0)) {
+        pos = attr_storage_index_lower_bound(ctx, path, ssid);
+    }
+    while (pos < index->size
+           && attr_storage_compare(
+                      &ctx->attributes_storage[index->entries[pos]], path,
+                      ssid)
+                      < 0) {
+        pos++;
+    }
+    index->discover_pos = pos;
+    if (pos < index->size
+            && !attr_storage_compare(
+                       &ctx->attributes_storage[index->entries[pos]], path,
+                       ssid)) {
+        return &ctx->attributes_storage[index->entries[pos]];
+    }
+    return NULL;
+#        else  // ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
+    return _anj_observe_get_attr_from_path(ctx, path, ssid);
+#        endif // ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
+}
+
 int _anj_observe_get_attr_storage(anj_t *anj,
                                   uint16_t ssid,
                                   bool with_parents_attr,
@@ -317,8 +463,7 @@ int _anj_observe_get_attr_storage(anj_t *anj,
     }
     while (1) {
         _anj_observe_attr_storage_t *attr_storage =
-                _anj_observe_get_attr_from_path(&anj->observe_ctx,
-                                                &current_path, ssid);
+                get_discover_attr(&anj->observe_ctx, &current_path, ssid);
         if (attr_storage) {
             found = true;
             _anj_observe_update_attr(out_attr, &attr_storage->attr);
@@ -16,8 +16,10 @@
 
 #    include <anj/defs.h>
 #    include <anj/log.h>
+#    include <anj/utils.h>
 
 #    include "../coap/coap.h"
+#    include "../utils.h"
 #    include "observe.h"
 
 #    ifdef ANJ_WITH_OBSERVE
@@ -73,6 +75,14 @@ void _anj_observe_write_anj_res_to_observe_val(
         _anj_observation_res_val_t *observe_val,
         const anj_res_value_t *res_value,
         const anj_data_type_t *type);
+#        if defined(ANJ_OBSERVE_WITH_VALUE_CACHE) \
+                || defined(ANJ_OBSERVE_WITH_HISTORICAL_QUEUE)
+void _anj_observe_write_observe_val_to_anj_res(
+        anj_res_value_t *res_value,
+        const _anj_observation_res_val_t *observe_val,
+        anj_data_type_t type);
+#        endif // defined(ANJ_OBSERVE_WITH_VALUE_CACHE) ||
+               // defined(ANJ_OBSERVE_WITH_HISTORICAL_QUEUE)
 void _anj_observe_verify_effective_attributes(
         _anj_observe_observation_t *observation);
 
@@ -80,6 +90,263 @@ void _anj_observe_refresh_timestamp(_anj_observe_ctx_t *ctx,
                                     anj_time_monotonic_t timestamp,
                                     bool confirmable);
 
+#        ifdef ANJ_OBSERVE_WITH_DEADLINE_INDEX
+/* Deadline index */
+
+/**
+ * Recalculates the deadline of @p observation and updates its position in the
+ * deadline index. Must be called after any change of the Observation that
+ * affects the time of the next notification: ssid, observe_active,
+ * effective_attr, last_notify_timestamp or notification_to_send. Does nothing
+ * if the index is not valid, because it will be rebuilt anyway.
+ */
+void _anj_observe_deadline_index_update(
+        _anj_observe_ctx_t *ctx, const _anj_observe_observation_t *observation);
+
+/**
+ * Marks the deadline index as invalid, forcing it to be rebuilt on the next
+ * call to @ref _anj_observe_process or
+ * @ref anj_observe_time_to_next_notification.
+ */
+void _anj_observe_deadline_index_invalidate(_anj_observe_ctx_t *ctx);
+#        endif // ANJ_OBSERVE_WITH_DEADLINE_INDEX
+
+#        ifdef ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER
+/**
+ * Records the value of a Resource in the notify store buffer, using the current
+ * real time as its timestamp. If the buffer is full, the oldest record is
+ * overwritten.
+ *
+ * @returns 0 on success, -1 if the buffer is not set, a flush is in progress or
+ *          the value of type @p type can't be recorded.
+ */
+int _anj_observe_notify_store_add(_anj_observe_ctx_t *ctx,
+                                  const anj_uri_path_t *path,
+                                  anj_data_type_t type,
+                                  const anj_res_value_t *value);
+#        endif // ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER
+
+#        ifdef ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+/**
+ * Removes all samples from the historical queue.
+ */
+void _anj_observe_historical_queue_reset(
+        _anj_observe_historical_queue_t *queue);
+
+/**
+ * Appends a sample to the historical queue. If the queue already holds
+ * @p max_count samples or there is no space left in its buffer, the oldest
+ * samples are removed. If @p type differs from the type of queued samples, the
+ * queue is cleared first.
+ *
+ * @returns 0 on success, -1 if @p type is not supported, or if the sample
+ *          doesn't fit without removing samples of the notification being
+ *          sent.
+ */
+int _anj_observe_historical_queue_add(_anj_observe_historical_queue_t *queue,
+                                      uint32_t max_count,
+                                      int64_t timestamp_s,
+                                      anj_data_type_t type,
+                                      const _anj_observation_res_val_t *value);
+
+/**
+ * Removes @p count oldest samples from the historical queue.
+ */
+void _anj_observe_historical_queue_drop(_anj_observe_historical_queue_t *queue,
+                                        size_t count);
+
+/**
+ * Sets @p iter to the oldest sample of a queue.
+ */
+void _anj_observe_historical_queue_iter_init(
+        _anj_observe_historical_queue_iter_t *iter);
+
+/**
+ * Reads the sample pointed by @p iter, from the oldest to the newest one, and
+ * moves @p iter to the next one.
+ *
+ * @returns 0 on success, -1 if there are no more samples.
+ */
+int _anj_observe_historical_queue_next(
+        const _anj_observe_historical_queue_t *queue,
+        _anj_observe_historical_queue_iter_t *iter,
+        int64_t *out_timestamp_s,
+        _anj_observation_res_val_t *out_value);
+#        endif // ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+
+#        ifdef ANJ_OBSERVE_WITH_PATH_INDEX
+/**
+ * Marks the path index of Observations as outdated. Must be called whenever an
+ * Observation is added or removed. The index is rebuilt on the next call to
+ * @ref anj_observe_data_model_changed.
+ */
+void _anj_observe_path_index_invalidate(_anj_observe_ctx_t *ctx);
+#        endif // ANJ_OBSERVE_WITH_PATH_INDEX
+
+#        ifdef ANJ_OBSERVE_WITH_STATE_ARRAYS
+/**
+ * Copies ssid, observe_active and notification_to_send of @p observation to the
+ * state arrays. Must be called after any change of these fields. Does nothing
+ * if the arrays are not valid, because they will be rebuilt anyway.
+ */
+void _anj_observe_state_arrays_update(
+        _anj_observe_ctx_t *ctx, const _anj_observe_observation_t *observation);
+
+/**
+ * Marks the state arrays as outdated. Must be called after changing the fields
+ * of many Observations at once.
+ */
+void _anj_observe_state_arrays_invalidate(_anj_observe_ctx_t *ctx);
+
+/**
+ * Rebuilds the state arrays if they are not valid.
+ */
+void _anj_observe_state_arrays_prepare(_anj_observe_ctx_t *ctx);
+#        endif // ANJ_OBSERVE_WITH_STATE_ARRAYS
+
+#        ifdef ANJ_OBSERVE_WITH_TOKEN_INDEX
+/**
+ * Marks the token index of Observations as outdated. Must be called after
+ * changing SSIDs or tokens of many Observations at once; single Observations
+ * are added to and removed from the index as they are created and removed.
+ */
+void _anj_observe_token_index_invalidate(_anj_observe_ctx_t *ctx);
+#        endif // ANJ_OBSERVE_WITH_TOKEN_INDEX
+
+/* Number of entries of the Observations and attributes storage tables */
+#        ifdef ANJ_OBSERVE_WITH_USER_STORAGE
+#            define _ANJ_OBSERVE_OBSERVATIONS_NUMBER(Ctx) \
+                ((size_t) (Ctx)->observations_number)
+#            define _ANJ_OBSERVE_ATTR_STORAGE_NUMBER(Ctx) \
+                ((size_t) (Ctx)->attributes_storage_number)
+#        else  // ANJ_OBSERVE_WITH_USER_STORAGE
+#            define _ANJ_OBSERVE_OBSERVATIONS_NUMBER(Ctx) \
+                ((size_t) ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER)
+#            define _ANJ_OBSERVE_ATTR_STORAGE_NUMBER(Ctx) \
+                ((size_t) ANJ_OBSERVE_MAX_WRITE_ATTRIBUTES_NUMBER)
+#        endif // ANJ_OBSERVE_WITH_USER_STORAGE
+
+/* Scans of the Observations table. The state of the Observation at index idx
+ * may be checked with the functions below only after _anj_observe_scan_begin()
+ * and as long as all changes of the Observations are reported with
+ * _anj_observe_state_arrays_update(). */
+
+static inline void _anj_observe_scan_begin(_anj_observe_ctx_t *ctx) {
+#        ifdef ANJ_OBSERVE_WITH_STATE_ARRAYS
+    _anj_observe_state_arrays_prepare(ctx);
+#        else  // ANJ_OBSERVE_WITH_STATE_ARRAYS
+    (void) ctx;
+#        endif // ANJ_OBSERVE_WITH_STATE_ARRAYS
+}
+
+static inline uint16_t _anj_observe_ssid_at(const _anj_observe_ctx_t *ctx,
+                                            size_t idx) {
+#        ifdef ANJ_OBSERVE_WITH_STATE_ARRAYS
+    return ctx->state_arrays.ssid[idx];
+#        else  // ANJ_OBSERVE_WITH_STATE_ARRAYS
+    return ctx->observations[idx].ssid;
+#        endif // ANJ_OBSERVE_WITH_STATE_ARRAYS
+}
+
+static inline bool _anj_observe_active_at(const _anj_observe_ctx_t *ctx,
+                                          size_t idx) {
+#        ifdef ANJ_OBSERVE_WITH_STATE_ARRAYS
+    return ctx->state_arrays.flags[idx] & _ANJ_OBSERVE_STATE_ACTIVE;
+#        else  // ANJ_OBSERVE_WITH_STATE_ARRAYS
+    return ctx->observations[idx].observe_active;
+#        endif // ANJ_OBSERVE_WITH_STATE_ARRAYS
+}
+
+static inline bool
+_anj_observe_notification_to_send_at(const _anj_observe_ctx_t *ctx,
+                                     size_t idx) {
+#        ifdef ANJ_OBSERVE_WITH_STATE_ARRAYS
+    return ctx->state_arrays.flags[idx]
+           & _ANJ_OBSERVE_STATE_NOTIFICATION_TO_SEND;
+#        else  // ANJ_OBSERVE_WITH_STATE_ARRAYS
+    return ctx->observations[idx].notification_to_send;
+#        endif // ANJ_OBSERVE_WITH_STATE_ARRAYS
+}
+
+/* Path compared with paths of the Observations during a scan */
+typedef struct {
+    const anj_uri_path_t *path;
+#        ifdef ANJ_OBSERVE_WITH_STATE_ARRAYS
+    _anj_uri_path_key_t key;
+    _anj_uri_path_key_t mask;
+#        endif // ANJ_OBSERVE_WITH_STATE_ARRAYS
+} _anj_observe_scan_path_t;
+
+static inline _anj_observe_scan_path_t
+_anj_observe_scan_path(const anj_uri_path_t *path) {
+    _anj_observe_scan_path_t scan_path = {
+        .path = path,
+#        ifdef ANJ_OBSERVE_WITH_STATE_ARRAYS
+        .key = _anj_uri_path_key(path),
+        .mask = _anj_uri_path_key_mask(path->uri_len)
+#        endif // ANJ_OBSERVE_WITH_STATE_ARRAYS
+    };
+    return scan_path;
+}
+
+/* Equivalent of anj_uri_path_equal(&ctx->observations[idx].path, path) */
+static inline bool
+_anj_observe_path_equal_at(const _anj_observe_ctx_t *ctx,
+                           size_t idx,
+                           const _anj_observe_scan_path_t *scan_path) {
+#        ifdef ANJ_OBSERVE_WITH_STATE_ARRAYS
+    return ctx->state_arrays.path_key[idx] == scan_path->key;
+#        else  // ANJ_OBSERVE_WITH_STATE_ARRAYS
+    return anj_uri_path_equal(&ctx->observations[idx].path, scan_path->path);
+#        endif // ANJ_OBSERVE_WITH_STATE_ARRAYS
+}
+
+/* Equivalent of anj_uri_path_outside_base(&ctx->observations[idx].path, base),
+ * true if the Observation is not in the subtree of the scanned path */
+static inline bool
+_anj_observe_path_outside_base_at(const _anj_observe_ctx_t *ctx,
+                                  size_t idx,
+                                  const _anj_observe_scan_path_t *base) {
+#        ifdef ANJ_OBSERVE_WITH_STATE_ARRAYS
+    return _anj_uri_path_key_outside_base(ctx->state_arrays.path_key[idx],
+                                          base->key, base->mask);
+#        else  // ANJ_OBSERVE_WITH_STATE_ARRAYS
+    return anj_uri_path_outside_base(&ctx->observations[idx].path, base->path);
+#        endif // ANJ_OBSERVE_WITH_STATE_ARRAYS
+}
+
+/* Equivalent of anj_uri_path_outside_base(path, &ctx->observations[idx].path),
+ * true if the path of the Observation is not a prefix of the scanned path */
+static inline bool
+_anj_observe_base_outside_path_at(const _anj_observe_ctx_t *ctx,
+                                  size_t idx,
+                                  const _anj_observe_scan_path_t *path) {
+#        ifdef ANJ_OBSERVE_WITH_STATE_ARRAYS
+    _anj_uri_path_key_t key = ctx->state_arrays.path_key[idx];
+    return _anj_uri_path_key_outside_base(
+            path->key, key,
+            _anj_uri_path_key_mask(_anj_uri_path_key_length(key)));
+#        else  // ANJ_OBSERVE_WITH_STATE_ARRAYS
+    return anj_uri_path_outside_base(path->path, &ctx->observations[idx].path);
+#        endif // ANJ_OBSERVE_WITH_STATE_ARRAYS
+}
+
+#        ifdef ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
+/**
+ * Marks the index of attributes storage as outdated. Must be called whenever a
+ * record is added to or removed from the storage. The index is rebuilt on the
+ * next lookup.
+ */
+void _anj_observe_attr_storage_index_invalidate(_anj_observe_ctx_t *ctx);
+
+/**
+ * Removes all records of attributes storage with paths equal to or being
+ * descendants of @p path, for all servers.
+ */
+void _anj_observe_remove_attr_storage_under_path(_anj_observe_ctx_t *ctx,
+                                                 const anj_uri_path_t *path);
+#        endif // ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
+
 #    endif // ANJ_WITH_OBSERVE
 
 #endif // SRC_ANJ_OBSERVE_OBSERVE_CORE_H
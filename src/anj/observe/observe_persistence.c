@@ -0,0 +1,142 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#define ANJ_LOG_SOURCE_FILE_ID 66
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/log.h>
+#include <anj/persistence.h>
+#include <anj/time.h>
+
+#include "../utils.h"
+#include "observe.h"
+#include "observe_internal.h"
+
+#if defined(ANJ_WITH_OBSERVE) && defined(ANJ_WITH_SESSION_PERSISTENCE)
+
+// Observations are stored as raw structures, which is fine since the
+// persistence format is bound to the build anyway; only the fields that can't
+// be copied as they are (points in time and pointers) are handled separately.
+static int observation_persistence(_anj_observe_ctx_t *ctx,
+                                   _anj_observe_observation_t *observation,
+                                   const anj_persistence_context_t *pctx,
+                                   anj_time_monotonic_t base) {
+    if (anj_persistence_bytes(pctx, observation, sizeof(*observation))
+            || _anj_persistence_monotonic_time(
+                       pctx, base, &observation->last_notify_timestamp)
+            || _anj_persistence_monotonic_time(
+                       pctx, base, &observation->next_conf_notify_timestamp)) {
+        return -1;
+    }
+#    ifdef ANJ_OBSERVE_WITH_COMPOSITE_DELTA_NOTIFICATIONS
+    if (_anj_persistence_monotonic_time(
+                pctx, base, &observation->last_included_timestamp)) {
+        return -1;
+    }
+#    endif // ANJ_OBSERVE_WITH_COMPOSITE_DELTA_NOTIFICATIONS
+#    ifdef ANJ_WITH_OBSERVE_COMPOSITE
+    uint16_t prev_idx = UINT16_MAX;
+    if (anj_persistence_direction(pctx) == ANJ_PERSISTENCE_STORE
+            && observation->prev) {
+        prev_idx = (uint16_t) (observation->prev - ctx->observations);
+    }
+    if (anj_persistence_u16(pctx, &prev_idx)) {
+        return -1;
+    }
+    if (anj_persistence_direction(pctx) == ANJ_PERSISTENCE_RESTORE) {
+        if (prev_idx != UINT16_MAX
+                && prev_idx >= _ANJ_OBSERVE_OBSERVATIONS_NUMBER(ctx)) {
+            return -1;
+        }
+        observation->prev = prev_idx == UINT16_MAX
+                                    ? NULL
+                                    : &ctx->observations[prev_idx];
+    }
+#    else  // ANJ_WITH_OBSERVE_COMPOSITE
+    (void) ctx;
+#    endif // ANJ_WITH_OBSERVE_COMPOSITE
+    if (anj_persistence_direction(pctx) == ANJ_PERSISTENCE_RESTORE) {
+#    ifdef ANJ_OBSERVE_WITH_VALUE_CACHE
+        observation->has_cached_value = false;
+#    endif // ANJ_OBSERVE_WITH_VALUE_CACHE
+#    ifdef ANJ_OBSERVE_WITH_COMPOSITE_DELTA_NOTIFICATIONS
+        observation->excluded_from_notification = false;
+#    endif // ANJ_OBSERVE_WITH_COMPOSITE_DELTA_NOTIFICATIONS
+    }
+    return 0;
+}
+
+int _anj_observe_persistence(anj_t *anj,
+                             const anj_persistence_context_t *ctx,
+                             anj_time_monotonic_t base) {
+    assert(anj && ctx);
+    _anj_observe_ctx_t *observe_ctx = &anj->observe_ctx;
+#    ifdef ANJ_OBSERVE_WITH_USER_STORAGE
+    // sizes of the tables are not bound to the build, a session stored with
+    // different sizes can't be restored
+    uint16_t observations_number = observe_ctx->observations_number;
+    uint16_t attributes_storage_number = observe_ctx->attributes_storage_number;
+    if (anj_persistence_u16(ctx, &observations_number)
+            || anj_persistence_u16(ctx, &attributes_storage_number)
+            || observations_number != observe_ctx->observations_number
+            || attributes_storage_number
+                           != observe_ctx->attributes_storage_number) {
+        return -1;
+    }
+#    endif // ANJ_OBSERVE_WITH_USER_STORAGE
+    int res = anj_persistence_bytes(
+            ctx, observe_ctx->attributes_storage,
+            _ANJ_OBSERVE_ATTR_STORAGE_NUMBER(observe_ctx)
+                    * sizeof(*observe_ctx->attributes_storage));
+    for (size_t i = 0;
+         !res && i < _ANJ_OBSERVE_OBSERVATIONS_NUMBER(observe_ctx);
+         i++) {
+        res = observation_persistence(observe_ctx,
+                                      &observe_ctx->observations[i], ctx, base);
+    }
+    if (anj_persistence_direction(ctx) == ANJ_PERSISTENCE_STORE) {
+        return res;
+    }
+    if (res) {
+        for (size_t i = 0; i < _ANJ_OBSERVE_ATTR_STORAGE_NUMBER(observe_ctx);
+             i++) {
+            observe_ctx->attributes_storage[i].ssid = 0;
+        }
+        for (size_t i = 0; i < _ANJ_OBSERVE_OBSERVATIONS_NUMBER(observe_ctx);
+             i++) {
+            observe_ctx->observations[i].ssid = 0;
+        }
+    }
+#    ifdef ANJ_OBSERVE_WITH_DEADLINE_INDEX
+    _anj_observe_deadline_index_invalidate(observe_ctx);
+#    endif // ANJ_OBSERVE_WITH_DEADLINE_INDEX
+#    ifdef ANJ_OBSERVE_WITH_PATH_INDEX
+    _anj_observe_path_index_invalidate(observe_ctx);
+#    endif // ANJ_OBSERVE_WITH_PATH_INDEX
+#    ifdef ANJ_OBSERVE_WITH_STATE_ARRAYS
+    _anj_observe_state_arrays_invalidate(observe_ctx);
+#    endif // ANJ_OBSERVE_WITH_STATE_ARRAYS
+#    ifdef ANJ_OBSERVE_WITH_TOKEN_INDEX
+    _anj_observe_token_index_invalidate(observe_ctx);
+#    endif // ANJ_OBSERVE_WITH_TOKEN_INDEX
+#    ifdef ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
+    _anj_observe_attr_storage_index_invalidate(observe_ctx);
+#    endif // ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
+    return res;
+}
+
+#endif // defined(ANJ_WITH_OBSERVE) && defined(ANJ_WITH_SESSION_PERSISTENCE)
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#define ANJ_LOG_SOURCE_FILE_ID 73
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/log.h>
+#include <anj/oscore.h>
+
+#ifdef ANJ_WITH_PERSISTENCE
+#    include <anj/persistence.h>
+#endif // ANJ_WITH_PERSISTENCE
+
+#ifdef ANJ_WITH_OSCORE
+
+#    define oscore_log(...) anj_log(oscore, __VA_ARGS__)
+
+int anj_oscore_set_security_context(
+        anj_t *anj, const anj_oscore_security_context_t *security) {
+    assert(anj);
+    if (security
+            && (security->sender_id_len > ANJ_OSCORE_MAX_ID_LEN
+                || security->recipient_id_len > ANJ_OSCORE_MAX_ID_LEN
+                || (security->sender_id_len == security->recipient_id_len
+                    && !memcmp(security->sender_id, security->recipient_id,
+                               security->sender_id_len)))) {
+        oscore_log(L_ERROR, "Invalid Sender or Recipient ID");
+        return -1;
+    }
+    memset(&anj->oscore_ctx, 0, sizeof(anj->oscore_ctx));
+    if (security) {
+        anj->oscore_ctx.security = *security;
+        anj->oscore_ctx.active = true;
+    }
+    oscore_log(L_INFO, "OSCORE %s", security ? "enabled" : "disabled");
+    return 0;
+}
+
+#    ifdef ANJ_WITH_PERSISTENCE
+static const uint8_t g_persistence_header[] = { 'O', 'S', 'C', 0x01 };
+
+static int id_persistence(const anj_persistence_context_t *ctx,
+                          const uint8_t *id,
+                          size_t id_len) {
+    uint8_t len = (uint8_t) id_len;
+    uint8_t value[ANJ_OSCORE_MAX_ID_LEN] = { 0 };
+    memcpy(value, id, id_len);
+    if (anj_persistence_u8(ctx, &len)
+            || anj_persistence_bytes(ctx, value, sizeof(value))) {
+        return -1;
+    }
+    // restored state must belong to the same Security Context
+    if (len != id_len || memcmp(value, id, id_len)) {
+        oscore_log(L_ERROR, "State stored for a different Security Context");
+        return -1;
+    }
+    return 0;
+}
+
+static int ctx_persistence(_anj_oscore_ctx_t *oscore,
+                           const anj_persistence_context_t *ctx) {
+    const anj_oscore_security_context_t *security = &oscore->security;
+    uint64_t sender_seq_num = oscore->sender_seq_num;
+    bool replay_window_valid = oscore->replay_window_valid;
+    uint64_t replay_window_top = oscore->replay_window_top;
+    uint32_t replay_window = oscore->replay_window;
+    if (id_persistence(ctx, security->sender_id, security->sender_id_len)
+            || id_persistence(ctx, security->recipient_id,
+                              security->recipient_id_len)
+            || anj_persistence_u64(ctx, &sender_seq_num)
+            || anj_persistence_bool(ctx, &replay_window_valid)
+            || anj_persistence_u64(ctx, &replay_window_top)
+            || anj_persistence_u32(ctx, &replay_window)) {
+        return -1;
+    }
+    // nothing is changed unless the whole state was read
+    oscore->sender_seq_num = sender_seq_num;
+    oscore->replay_window_valid = replay_window_valid;
+    oscore->replay_window_top = replay_window_top;
+    oscore->replay_window = replay_window;
+    return 0;
+}
+
+int anj_oscore_store(anj_t *anj, const anj_persistence_context_t *ctx) {
+    assert(anj && ctx && anj->oscore_ctx.active);
+    assert(anj_persistence_direction(ctx) == ANJ_PERSISTENCE_STORE);
+
+    if (anj_persistence_magic(ctx, g_persistence_header,
+                              sizeof(g_persistence_header))
+            || ctx_persistence(&anj->oscore_ctx, ctx)) {
+        oscore_log(L_ERROR, "Failed to store OSCORE state");
+        return -1;
+    }
+    return 0;
+}
+
+int anj_oscore_restore(anj_t *anj, const anj_persistence_context_t *ctx) {
+    assert(anj && ctx && anj->oscore_ctx.active);
+    assert(anj_persistence_direction(ctx) == ANJ_PERSISTENCE_RESTORE);
+
+    if (anj_persistence_magic(ctx, g_persistence_header,
+                              sizeof(g_persistence_header))
+            || ctx_persistence(&anj->oscore_ctx, ctx)) {
+        oscore_log(L_ERROR, "Failed to restore OSCORE state");
+        return -1;
+    }
+    oscore_log(L_INFO, "OSCORE state restored");
+    return 0;
+}
+#    endif // ANJ_WITH_PERSISTENCE
+
+#endif // ANJ_WITH_OSCORE
@@ -19,6 +19,8 @@
 #include <anj/persistence.h>
 #include <anj/utils.h>
 
+#include "utils.h"
+
 #ifdef ANJ_WITH_PERSISTENCE
 
 #    define persistence_log(...) anj_log(persistence, __VA_ARGS__)
@@ -47,6 +49,220 @@ anj_persistence_restore_context_create(anj_persistence_read_cb_t *read_cb,
     return persistence_ctx;
 }
 
+#    ifdef ANJ_PERSISTENCE_WITH_BUFFERED_STORE
+static int buffered_write(void *ctx, const void *buf, size_t size) {
+    anj_persistence_buffer_t *buffer_ctx = (anj_persistence_buffer_t *) ctx;
+    const uint8_t *data = (const uint8_t *) buf;
+    while (size) {
+        size_t chunk = buffer_ctx->buffer_size - buffer_ctx->buffered;
+        if (chunk > size) {
+            chunk = size;
+        }
+        memcpy(buffer_ctx->buffer + buffer_ctx->buffered, data, chunk);
+        buffer_ctx->buffered += chunk;
+        data += chunk;
+        size -= chunk;
+        if (buffer_ctx->buffered == buffer_ctx->buffer_size) {
+            int result = anj_persistence_buffer_flush(buffer_ctx);
+            if (result) {
+                return result;
+            }
+        }
+    }
+    return 0;
+}
+
+anj_persistence_context_t anj_persistence_buffered_store_context_create(
+        anj_persistence_buffer_t *buffer_ctx,
+        void *buffer,
+        size_t buffer_size,
+        anj_persistence_write_cb_t *write_cb,
+        void *ctx) {
+    assert(buffer_ctx && buffer && buffer_size && write_cb);
+    buffer_ctx->write = write_cb;
+    buffer_ctx->ctx = ctx;
+    buffer_ctx->buffer = (uint8_t *) buffer;
+    buffer_ctx->buffer_size = buffer_size;
+    buffer_ctx->buffered = 0;
+    return anj_persistence_store_context_create(buffered_write, buffer_ctx);
+}
+
+int anj_persistence_buffer_flush(anj_persistence_buffer_t *buffer_ctx) {
+    assert(buffer_ctx);
+    if (!buffer_ctx->buffered) {
+        return 0;
+    }
+    int result = buffer_ctx->write(buffer_ctx->ctx, buffer_ctx->buffer,
+                                   buffer_ctx->buffered);
+    if (result) {
+        persistence_log(L_ERROR, "Failed to write buffered data");
+        return result;
+    }
+    buffer_ctx->buffered = 0;
+    return 0;
+}
+
+static int size_only_write(void *ctx, const void *buf, size_t size) {
+    (void) buf;
+    *(size_t *) ctx += size;
+    return 0;
+}
+
+anj_persistence_context_t
+anj_persistence_size_context_create(size_t *inout_size) {
+    assert(inout_size);
+    return anj_persistence_store_context_create(size_only_write, inout_size);
+}
+#    endif // ANJ_PERSISTENCE_WITH_BUFFERED_STORE
+
+#    ifdef ANJ_PERSISTENCE_WITH_INTEGRITY_CHECK
+static int crc_write(void *ctx, const void *buf, size_t size) {
+    anj_persistence_crc_t *crc_ctx = (anj_persistence_crc_t *) ctx;
+    crc_ctx->crc = _anj_crc32_update(crc_ctx->crc, buf, size);
+    return crc_ctx->write(crc_ctx->ctx, buf, size);
+}
+
+static int crc_read(void *ctx, void *buf, size_t size) {
+    anj_persistence_crc_t *crc_ctx = (anj_persistence_crc_t *) ctx;
+    int result = crc_ctx->read(crc_ctx->ctx, buf, size);
+    if (!result) {
+        crc_ctx->crc = _anj_crc32_update(crc_ctx->crc, buf, size);
+    }
+    return result;
+}
+
+anj_persistence_context_t
+anj_persistence_crc_store_context_create(anj_persistence_crc_t *crc_ctx,
+                                         anj_persistence_write_cb_t *write_cb,
+                                         void *ctx) {
+    assert(crc_ctx && write_cb);
+    memset(crc_ctx, 0, sizeof(*crc_ctx));
+    crc_ctx->direction = ANJ_PERSISTENCE_STORE;
+    crc_ctx->write = write_cb;
+    crc_ctx->ctx = ctx;
+    return anj_persistence_store_context_create(crc_write, crc_ctx);
+}
+
+anj_persistence_context_t
+anj_persistence_crc_restore_context_create(anj_persistence_crc_t *crc_ctx,
+                                           anj_persistence_read_cb_t *read_cb,
+                                           void *ctx) {
+    assert(crc_ctx && read_cb);
+    memset(crc_ctx, 0, sizeof(*crc_ctx));
+    crc_ctx->direction = ANJ_PERSISTENCE_RESTORE;
+    crc_ctx->read = read_cb;
+    crc_ctx->ctx = ctx;
+    return anj_persistence_restore_context_create(crc_read, crc_ctx);
+}
+
+int anj_persistence_crc_finish(anj_persistence_crc_t *crc_ctx) {
+    assert(crc_ctx);
+    uint32_t crc = crc_ctx->crc;
+    if (crc_ctx->direction == ANJ_PERSISTENCE_STORE) {
+        return crc_ctx->write(crc_ctx->ctx, &crc, sizeof(crc));
+    }
+    int result = crc_ctx->read(crc_ctx->ctx, &crc, sizeof(crc));
+    if (result) {
+        return result;
+    }
+    if (crc != crc_ctx->crc) {
+        persistence_log(L_ERROR, "Persistence CRC mismatch");
+        return -1;
+    }
+    return 0;
+}
+
+int anj_persistence_crc_verify(anj_persistence_read_cb_t *read_cb,
+                               void *ctx,
+                               size_t blob_size) {
+    assert(read_cb);
+    if (blob_size < ANJ_PERSISTENCE_CRC_SIZE) {
+        return -1;
+    }
+    uint32_t crc = 0;
+    uint8_t chunk[32];
+    size_t remaining = blob_size - ANJ_PERSISTENCE_CRC_SIZE;
+    while (remaining) {
+        size_t chunk_size = ANJ_MIN(remaining, sizeof(chunk));
+        int result = read_cb(ctx, chunk, chunk_size);
+        if (result) {
+            return result;
+        }
+        crc = _anj_crc32_update(crc, chunk, chunk_size);
+        remaining -= chunk_size;
+    }
+    uint32_t stored_crc;
+    int result = read_cb(ctx, &stored_crc, sizeof(stored_crc));
+    if (result) {
+        return result;
+    }
+    if (stored_crc != crc) {
+        persistence_log(L_WARNING, "Persistence CRC mismatch");
+        return -1;
+    }
+    return 0;
+}
+#    endif // ANJ_PERSISTENCE_WITH_INTEGRITY_CHECK
+
+#    ifdef ANJ_PERSISTENCE_WITH_MEMORY_MAPPED_RESTORE
+static const void *memory_take(anj_persistence_memory_t *memory_ctx,
+                               size_t size) {
+    if (size > memory_ctx->size - memory_ctx->offset) {
+        persistence_log(L_ERROR, "Read past the end of the blob");
+        return NULL;
+    }
+    const void *data = memory_ctx->data + memory_ctx->offset;
+    memory_ctx->offset += size;
+    return data;
+}
+
+static int memory_read(void *ctx, void *buf, size_t size) {
+    const void *data = memory_take((anj_persistence_memory_t *) ctx, size);
+    if (!data) {
+        return -1;
+    }
+    memcpy(buf, data, size);
+    return 0;
+}
+
+anj_persistence_context_t anj_persistence_memory_restore_context_create(
+        anj_persistence_memory_t *memory_ctx,
+        const void *data,
+        size_t size) {
+    assert(memory_ctx && (data || !size));
+    memory_ctx->data = (const uint8_t *) data;
+    memory_ctx->size = size;
+    memory_ctx->offset = 0;
+    return anj_persistence_restore_context_create(memory_read, memory_ctx);
+}
+
+bool anj_persistence_memory_mapped(const anj_persistence_context_t *ctx) {
+    assert(ctx);
+    return ctx->direction == ANJ_PERSISTENCE_RESTORE
+           && ctx->read == memory_read;
+}
+
+int anj_persistence_bytes_ref(const anj_persistence_context_t *ctx,
+                              const void **inout_data,
+                              size_t size) {
+    assert(ctx && inout_data);
+    if (ctx->direction == ANJ_PERSISTENCE_STORE) {
+        assert(ctx->write);
+        return ctx->write(ctx->ctx, *inout_data, size);
+    }
+    if (!anj_persistence_memory_mapped(ctx)) {
+        persistence_log(L_ERROR, "Context is not memory-mapped");
+        return -1;
+    }
+    const void *data = memory_take((anj_persistence_memory_t *) ctx->ctx, size);
+    if (!data) {
+        return -1;
+    }
+    *inout_data = data;
+    return 0;
+}
+#    endif // ANJ_PERSISTENCE_WITH_MEMORY_MAPPED_RESTORE
+
 int anj_persistence_bytes(const anj_persistence_context_t *ctx,
                           void *inout_buffer,
                           size_t buffer_size) {
@@ -116,4 +332,26 @@ int anj_persistence_magic(const anj_persistence_context_t *ctx,
     }
 }
 
+int anj_persistence_version(const anj_persistence_context_t *ctx,
+                            const void *magic,
+                            size_t magic_size,
+                            uint8_t version,
+                            uint8_t *out_version) {
+    assert(ctx && version > 0);
+    uint8_t blob_version = version;
+    int result = anj_persistence_magic(ctx, magic, magic_size);
+    if (result || (result = anj_persistence_u8(ctx, &blob_version))) {
+        return result;
+    }
+    if (blob_version == 0 || blob_version > version) {
+        persistence_log(L_ERROR, "Unsupported persistence version %u",
+                        (unsigned) blob_version);
+        return -1;
+    }
+    if (out_version) {
+        *out_version = blob_version;
+    }
+    return 0;
+}
+
 #endif // ANJ_WITH_PERSISTENCE
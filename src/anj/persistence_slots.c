@@ -0,0 +1,251 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#define ANJ_LOG_SOURCE_FILE_ID 74
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/core.h>
+#include <anj/log.h>
+#include <anj/persistence.h>
+#include <anj/persistence_slots.h>
+
+#include "utils.h"
+
+#ifdef ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
+
+#    define persistence_log(...) anj_log(persistence, __VA_ARGS__)
+
+static const uint8_t g_record_header[] = { 'R', 'E', 'C', 0x01 }; // version
+
+#    define RECORD_HEADER_SIZE (sizeof(g_record_header) + 1 + 4 + 4)
+#    define RECORD_CRC_SIZE 4
+
+typedef struct {
+    const anj_persistence_slots_t *slots;
+    uint32_t crc;
+} record_writer_t;
+
+static int record_write(void *ctx, const void *buf, size_t size) {
+    record_writer_t *writer = (record_writer_t *) ctx;
+    writer->crc = _anj_crc32_update(writer->crc, buf, size);
+    return writer->slots->write(writer->slots->ctx, buf, size);
+}
+
+static int size_write(void *ctx, const void *buf, size_t size) {
+    (void) buf;
+    *(size_t *) ctx += size;
+    return 0;
+}
+
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+} record_reader_t;
+
+static int record_read(void *ctx, void *buf, size_t size) {
+    record_reader_t *reader = (record_reader_t *) ctx;
+    if (size > reader->size) {
+        return -1;
+    }
+    memcpy(buf, reader->data, size);
+    reader->data += size;
+    reader->size -= size;
+    return 0;
+}
+
+// returns NULL if the Object is not present in this build or not set
+static bool *dirty_flag(const anj_persistence_objects_t *objects,
+                        anj_persistence_slot_t slot) {
+    switch (slot) {
+#    ifdef ANJ_WITH_DEFAULT_SECURITY_OBJ
+    case ANJ_PERSISTENCE_SLOT_SECURITY_OBJ:
+        return objects->security_obj ? &objects->security_obj->dirty : NULL;
+#    endif // ANJ_WITH_DEFAULT_SECURITY_OBJ
+#    ifdef ANJ_WITH_DEFAULT_SERVER_OBJ
+    case ANJ_PERSISTENCE_SLOT_SERVER_OBJ:
+        return objects->server_obj ? &objects->server_obj->dirty : NULL;
+#    endif // ANJ_WITH_DEFAULT_SERVER_OBJ
+#    ifdef ANJ_WITH_NTP
+    case ANJ_PERSISTENCE_SLOT_NTP_OBJ:
+        return objects->ntp ? &objects->ntp->dirty : NULL;
+#    endif // ANJ_WITH_NTP
+    default:
+        return NULL;
+    }
+}
+
+// stores or restores the Object, depending on the context direction
+static int object_persistence(anj_t *anj,
+                              const anj_persistence_objects_t *objects,
+                              anj_persistence_slot_t slot,
+                              const anj_persistence_context_t *ctx) {
+    bool store = anj_persistence_direction(ctx) == ANJ_PERSISTENCE_STORE;
+    (void) anj;
+    (void) objects;
+    (void) store;
+    switch (slot) {
+#    ifdef ANJ_WITH_DEFAULT_SECURITY_OBJ
+    case ANJ_PERSISTENCE_SLOT_SECURITY_OBJ:
+        return store ? anj_dm_security_obj_store(anj, objects->security_obj,
+                                                 ctx)
+                     : anj_dm_security_obj_restore(anj, objects->security_obj,
+                                                   ctx);
+#    endif // ANJ_WITH_DEFAULT_SECURITY_OBJ
+#    ifdef ANJ_WITH_DEFAULT_SERVER_OBJ
+    case ANJ_PERSISTENCE_SLOT_SERVER_OBJ:
+        return store ? anj_dm_server_obj_store(objects->server_obj, ctx)
+                     : anj_dm_server_obj_restore(objects->server_obj, ctx);
+#    endif // ANJ_WITH_DEFAULT_SERVER_OBJ
+#    ifdef ANJ_WITH_NTP
+    case ANJ_PERSISTENCE_SLOT_NTP_OBJ:
+        return store ? anj_ntp_obj_store(objects->ntp, ctx)
+                     : anj_ntp_obj_restore(objects->ntp, ctx);
+#    endif // ANJ_WITH_NTP
+    default:
+        return -1;
+    }
+}
+
+static int store_record(anj_t *anj,
+                        const anj_persistence_objects_t *objects,
+                        const anj_persistence_slots_t *slots,
+                        anj_persistence_slot_t slot,
+                        uint32_t sequence) {
+    // dry run first, the payload size is a part of the header
+    size_t payload_size = 0;
+    anj_persistence_context_t ctx =
+            anj_persistence_store_context_create(size_write, &payload_size);
+    if (object_persistence(anj, objects, slot, &ctx)
+            || payload_size > UINT32_MAX) {
+        return -1;
+    }
+
+    record_writer_t writer = {
+        .slots = slots,
+        .crc = 0
+    };
+    ctx = anj_persistence_store_context_create(record_write, &writer);
+    uint8_t slot_u8 = (uint8_t) slot;
+    uint32_t payload_size_u32 = (uint32_t) payload_size;
+    int res = slots->begin(slots->ctx, slot,
+                           RECORD_HEADER_SIZE + payload_size + RECORD_CRC_SIZE);
+    if (res
+            || (res = anj_persistence_magic(&ctx, g_record_header,
+                                            sizeof(g_record_header)))
+            || (res = anj_persistence_u8(&ctx, &slot_u8))
+            || (res = anj_persistence_u32(&ctx, &sequence))
+            || (res = anj_persistence_u32(&ctx, &payload_size_u32))
+            || (res = object_persistence(anj, objects, slot, &ctx))
+            || (res = slots->write(slots->ctx, &writer.crc,
+                                   sizeof(writer.crc)))) {
+        return res;
+    }
+    return slots->end(slots->ctx, slot);
+}
+
+int anj_persistence_store_dirty(anj_t *anj,
+                                const anj_persistence_objects_t *objects,
+                                const anj_persistence_slots_t *slots,
+                                uint32_t *inout_sequence) {
+    assert(anj && objects && slots && inout_sequence);
+    assert(slots->begin && slots->write && slots->end);
+    int result = 0;
+    for (int slot = 0; slot < ANJ_PERSISTENCE_SLOT_COUNT; slot++) {
+        bool *dirty = dirty_flag(objects, (anj_persistence_slot_t) slot);
+        if (!dirty || !*dirty) {
+            continue;
+        }
+        if (store_record(anj, objects, slots, (anj_persistence_slot_t) slot,
+                         *inout_sequence)) {
+            persistence_log(L_ERROR, "Failed to store record of slot %d",
+                            slot);
+            result = -1;
+            continue;
+        }
+        persistence_log(L_DEBUG, "Record of slot %d stored", slot);
+        *dirty = false;
+        (*inout_sequence)++;
+    }
+    return result;
+}
+
+// on success, out_reader covers the payload
+static int parse_record(const void *record,
+                        size_t size,
+                        anj_persistence_slot_t *out_slot,
+                        uint32_t *out_sequence,
+                        record_reader_t *out_reader) {
+    record_reader_t reader = {
+        .data = (const uint8_t *) record,
+        .size = size
+    };
+    anj_persistence_context_t ctx =
+            anj_persistence_restore_context_create(record_read, &reader);
+    uint8_t slot;
+    uint32_t payload_size;
+    if (anj_persistence_magic(&ctx, g_record_header, sizeof(g_record_header))
+            || anj_persistence_u8(&ctx, &slot)
+            || anj_persistence_u32(&ctx, out_sequence)
+            || anj_persistence_u32(&ctx, &payload_size)
+            || slot >= ANJ_PERSISTENCE_SLOT_COUNT
+            || reader.size < (size_t) payload_size + RECORD_CRC_SIZE) {
+        return -1;
+    }
+    size_t crc_offset = RECORD_HEADER_SIZE + (size_t) payload_size;
+    uint32_t crc;
+    memcpy(&crc, (const uint8_t *) record + crc_offset, sizeof(crc));
+    if (crc != _anj_crc32_update(0, record, crc_offset)) {
+        persistence_log(L_WARNING, "Record CRC mismatch");
+        return -1;
+    }
+    *out_slot = (anj_persistence_slot_t) slot;
+    out_reader->data = reader.data;
+    out_reader->size = payload_size;
+    return 0;
+}
+
+int anj_persistence_record_verify(const void *record,
+                                  size_t size,
+                                  anj_persistence_slot_t *out_slot,
+                                  uint32_t *out_sequence) {
+    assert(record && out_slot && out_sequence);
+    record_reader_t payload;
+    return parse_record(record, size, out_slot, out_sequence, &payload);
+}
+
+int anj_persistence_record_restore(anj_t *anj,
+                                   const anj_persistence_objects_t *objects,
+                                   const void *record,
+                                   size_t size) {
+    assert(anj && objects && record);
+    anj_persistence_slot_t slot;
+    uint32_t sequence;
+    record_reader_t payload;
+    if (parse_record(record, size, &slot, &sequence, &payload)
+            || !dirty_flag(objects, slot)) {
+        return -1;
+    }
+    anj_persistence_context_t ctx =
+            anj_persistence_restore_context_create(record_read, &payload);
+    if (object_persistence(anj, objects, slot, &ctx)) {
+        persistence_log(L_ERROR, "Failed to restore record of slot %d",
+                        (int) slot);
+        return -1;
+    }
+    return 0;
+}
+
+#endif // ANJ_PERSISTENCE_WITH_DIRTY_TRACKING
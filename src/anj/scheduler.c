@@ -0,0 +1,82 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#include <assert.h>
+#include <stdbool.h>
+
+#include <anj/core.h>
+#include <anj/scheduler.h>
+#include <anj/time.h>
+
+#ifdef ANJ_WITH_SCHEDULER
+
+static void consider_deadline(anj_scheduler_wakeup_t *wakeup,
+                              anj_time_duration_t timeout,
+                              anj_scheduler_reason_t reason) {
+    if (!anj_time_duration_is_valid(timeout)) {
+        return;
+    }
+    if (anj_time_duration_lt(timeout, ANJ_TIME_DURATION_ZERO)) {
+        timeout = ANJ_TIME_DURATION_ZERO;
+    }
+    // on equal deadlines the module checked first wins
+    if (wakeup->reason == ANJ_SCHEDULER_REASON_NONE
+            || anj_time_duration_lt(timeout, wakeup->timeout)) {
+        wakeup->timeout = timeout;
+        wakeup->reason = reason;
+    }
+}
+
+static void consider_core(anj_scheduler_wakeup_t *wakeup, anj_t *anj) {
+#    ifdef ANJ_NET_WITH_POLL_HANDLE
+    anj_time_duration_t timeout;
+    anj_net_poll_handle_t handle;
+    if (anj_core_next_wakeup(anj, &timeout, &handle)
+            == ANJ_CORE_WAKEUP_NET_OR_TIMER) {
+        wakeup->wait_for_net = true;
+        wakeup->net_handle = handle;
+    }
+    consider_deadline(wakeup, timeout, ANJ_SCHEDULER_REASON_CORE);
+#    else  // ANJ_NET_WITH_POLL_HANDLE
+    consider_deadline(wakeup, anj_core_next_step_time(anj),
+                      ANJ_SCHEDULER_REASON_CORE);
+#    endif // ANJ_NET_WITH_POLL_HANDLE
+}
+
+void anj_scheduler_next_wakeup(const anj_scheduler_sources_t *sources,
+                               anj_scheduler_wakeup_t *out_wakeup) {
+    assert(sources && out_wakeup);
+    out_wakeup->timeout = ANJ_TIME_DURATION_INVALID;
+    out_wakeup->reason = ANJ_SCHEDULER_REASON_NONE;
+#    ifdef ANJ_NET_WITH_POLL_HANDLE
+    out_wakeup->wait_for_net = false;
+#    endif // ANJ_NET_WITH_POLL_HANDLE
+
+    if (sources->anj) {
+        consider_core(out_wakeup, sources->anj);
+    }
+#    ifdef ANJ_WITH_NTP
+    if (sources->ntp) {
+        consider_deadline(out_wakeup, anj_ntp_next_step_time(sources->ntp),
+                          ANJ_SCHEDULER_REASON_NTP);
+    }
+#    endif // ANJ_WITH_NTP
+#    ifdef ANJ_WITH_COAP_DOWNLOADER
+    if (sources->coap_downloader) {
+        consider_deadline(out_wakeup,
+                          anj_coap_downloader_next_step_time(
+                                  sources->coap_downloader),
+                          ANJ_SCHEDULER_REASON_COAP_DOWNLOADER);
+    }
+#    endif // ANJ_WITH_COAP_DOWNLOADER
+}
+
+#endif // ANJ_WITH_SCHEDULER
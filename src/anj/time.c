@@ -11,9 +11,12 @@
 
 #define ANJ_LOG_SOURCE_FILE_ID 54
 
-#include <math.h>
 #include <stdint.h>
 
+#ifndef ANJ_TIME_INTEGER_ONLY
+#    include <math.h>
+#endif // ANJ_TIME_INTEGER_ONLY
+
 #include <anj/time.h>
 #include <anj/utils.h>
 
@@ -47,6 +50,7 @@ anj_time_duration_t anj_time_duration_new(const int64_t scalar,
     };
 }
 
+#ifndef ANJ_TIME_INTEGER_ONLY
 anj_time_duration_t anj_time_duration_fnew(const double scalar,
                                            const anj_time_unit_t unit) {
     if (isinf(scalar) || isnan(scalar)) {
@@ -57,16 +61,19 @@ anj_time_duration_t anj_time_duration_fnew(const double scalar,
         .us = (int64_t) scalar * TIME_UNIT_MULTIPLIERS[unit]
     };
 }
+#endif // ANJ_TIME_INTEGER_ONLY
 
 int64_t anj_time_duration_to_scalar(const anj_time_duration_t duration,
                                     const anj_time_unit_t unit) {
     return duration.us / TIME_UNIT_MULTIPLIERS[unit];
 }
 
+#ifndef ANJ_TIME_INTEGER_ONLY
 double anj_time_duration_to_fscalar(const anj_time_duration_t duration,
                                     const anj_time_unit_t unit) {
     return (double) duration.us / (double) TIME_UNIT_MULTIPLIERS[unit];
 }
+#endif // ANJ_TIME_INTEGER_ONLY
 
 const char *_anj_time_duration_as_string_impl(
         const anj_time_duration_t duration,
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#define ANJ_LOG_SOURCE_FILE_ID 75
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <anj/compat/time.h>
+#include <anj/core.h>
+#include <anj/trace.h>
+
+#include "trace.h"
+
+#ifdef ANJ_WITH_TRACE
+
+void _anj_trace_record(_anj_trace_t *trace,
+                       anj_trace_event_type_t type,
+                       anj_trace_phase_t phase,
+                       int32_t value) {
+    if (!trace) {
+        return;
+    }
+    size_t idx = (trace->head + trace->count) % ANJ_TRACE_BUFFER_SIZE;
+    if (trace->count == ANJ_TRACE_BUFFER_SIZE) {
+        trace->head = (trace->head + 1) % ANJ_TRACE_BUFFER_SIZE;
+        trace->dropped++;
+    } else {
+        trace->count++;
+    }
+    trace->events[idx] = (anj_trace_event_t) {
+        .timestamp = anj_time_monotonic_now(),
+        .value = value,
+        .type = (uint8_t) type,
+        .phase = (uint8_t) phase
+    };
+}
+
+size_t anj_core_trace_read(anj_t *anj,
+                           anj_trace_event_t *out_events,
+                           size_t max_count) {
+    assert(anj && (out_events || !max_count));
+    _anj_trace_t *trace = &anj->trace;
+    size_t count = 0;
+    while (count < max_count && trace->count) {
+        out_events[count++] = trace->events[trace->head];
+        trace->head = (trace->head + 1) % ANJ_TRACE_BUFFER_SIZE;
+        trace->count--;
+    }
+    return count;
+}
+
+uint32_t anj_core_trace_dropped(anj_t *anj) {
+    assert(anj);
+    uint32_t dropped = anj->trace.dropped;
+    anj->trace.dropped = 0;
+    return dropped;
+}
+
+const char *anj_trace_event_name(anj_trace_event_type_t type) {
+    switch (type) {
+    case ANJ_TRACE_EVENT_CONN_STATUS:
+        return "conn_status";
+    case ANJ_TRACE_EVENT_EXCHANGE:
+        return "exchange";
+    case ANJ_TRACE_EVENT_DM_OPERATION:
+        return "dm_operation";
+    case ANJ_TRACE_EVENT_OBSERVE_SCAN:
+        return "observe_scan";
+    case ANJ_TRACE_EVENT_NET_SEND:
+        return "net_send";
+    case ANJ_TRACE_EVENT_NET_RECV:
+        return "net_recv";
+    default:
+        return "unknown";
+    }
+}
+
+#endif // ANJ_WITH_TRACE
@@ -0,0 +1,45 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#ifndef SRC_ANJ_TRACE_H
+#    define SRC_ANJ_TRACE_H
+
+#    include <stdint.h>
+
+#    include <anj/trace.h>
+
+#    ifdef ANJ_WITH_TRACE
+
+/**
+ * Appends an event timestamped with the current monotonic time, overwriting
+ * the oldest one if the buffer is full.
+ *
+ * @param trace Ring buffer, may be NULL if the events are not recorded.
+ * @param type  @ref anj_trace_event_type_t
+ * @param phase @ref anj_trace_phase_t
+ * @param value Meaning depends on @p type.
+ */
+void _anj_trace_record(_anj_trace_t *trace,
+                       anj_trace_event_type_t type,
+                       anj_trace_phase_t phase,
+                       int32_t value);
+
+#        define _ANJ_TRACE(Trace, Type, Phase, Value)                     \
+            _anj_trace_record((Trace), ANJ_TRACE_EVENT_##Type,            \
+                              ANJ_TRACE_PHASE_##Phase, (int32_t) (Value))
+
+#    else // ANJ_WITH_TRACE
+
+#        define _ANJ_TRACE(Trace, Type, Phase, Value) ((void) 0)
+
+#    endif // ANJ_WITH_TRACE
+
+#endif // SRC_ANJ_TRACE_H
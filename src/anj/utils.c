@@ -11,6 +11,7 @@
 
 #define ANJ_LOG_SOURCE_FILE_ID 55
 
+#include <assert.h>
 #include <ctype.h>
 #include <float.h>
 #if defined(__GNUC__) && defined(__arm__) && defined(__ARM_ARCH)
@@ -28,6 +29,7 @@
 #include <anj/log.h>
 #include <anj/utils.h>
 
+#include "grisu.h"
 #include "utils.h"
 #ifdef ANJ_WITH_CUSTOM_CONVERSION_FUNCTIONS
 #    include <assert.h>
@@ -94,6 +96,19 @@ bool _anj_uri_path_to_security_or_oscore_obj(const anj_uri_path_t *path) {
     return false;
 }
 
+int _anj_uri_path_compare(const anj_uri_path_t *left,
+                          const anj_uri_path_t *right) {
+    assert(left && right);
+    size_t len =
+            left->uri_len < right->uri_len ? left->uri_len : right->uri_len;
+    for (size_t i = 0; i < len; i++) {
+        if (left->ids[i] != right->ids[i]) {
+            return left->ids[i] < right->ids[i] ? -1 : 1;
+        }
+    }
+    return (int) left->uri_len - (int) right->uri_len;
+}
+
 bool _anj_tokens_equal(const _anj_coap_token_t *left,
                        const _anj_coap_token_t *right) {
     return !(memcmp(left->bytes, right->bytes, left->size)
@@ -112,7 +127,8 @@ int _anj_validate_obj_version(const char *version) {
     return 0;
 }
 
-#ifdef ANJ_WITH_CUSTOM_CONVERSION_FUNCTIONS
+#if defined(ANJ_WITH_CUSTOM_CONVERSION_FUNCTIONS) \
+        && !defined(ANJ_WITH_FAST_NUMBER_FORMATTING)
 static size_t uint64_to_string_value_internal(uint64_t value,
                                               char *out_buff,
                                               size_t *dot_position,
@@ -142,10 +158,117 @@ static size_t uint64_to_string_value_internal(uint64_t value,
     memcpy(out_buff, &buff[idx + 1], msg_size);
     return msg_size;
 }
-#endif // ANJ_WITH_CUSTOM_CONVERSION_FUNCTIONS
+#endif // defined(ANJ_WITH_CUSTOM_CONVERSION_FUNCTIONS) &&
+       // !defined(ANJ_WITH_FAST_NUMBER_FORMATTING)
+
+#ifdef ANJ_WITH_FAST_NUMBER_FORMATTING
+static const char DIGIT_PAIRS[] = "00010203040506070809"
+                                  "10111213141516171819"
+                                  "20212223242526272829"
+                                  "30313233343536373839"
+                                  "40414243444546474849"
+                                  "50515253545556575859"
+                                  "60616263646566676869"
+                                  "70717273747576777879"
+                                  "80818283848586878889"
+                                  "90919293949596979899";
+
+static char *put_digit_pairs(char *ptr, uint32_t value, size_t pairs) {
+    for (size_t i = 0; i < pairs; i++) {
+        ptr -= 2;
+        memcpy(ptr, &DIGIT_PAIRS[2 * (value % 100)], 2);
+        value /= 100;
+    }
+    return ptr;
+}
+
+static size_t uint64_to_string_digit_pairs(char *out_buff, uint64_t value) {
+    char buff[ANJ_U64_STR_MAX_LEN];
+    char *end = &buff[sizeof(buff)];
+    char *ptr = end;
+    // 64-bit divisions are expensive on 32-bit targets, so they are used
+    // only to split off 8 digits at a time
+    while (value > UINT32_MAX) {
+        ptr = put_digit_pairs(ptr, (uint32_t) (value % 100000000U), 4);
+        value /= 100000000U;
+    }
+    uint32_t rest = (uint32_t) value;
+    while (rest >= 100) {
+        ptr = put_digit_pairs(ptr, rest % 100, 1);
+        rest /= 100;
+    }
+    if (rest >= 10) {
+        ptr = put_digit_pairs(ptr, rest, 1);
+    } else {
+        *--ptr = (char) ('0' + rest);
+    }
+    size_t len = (size_t) (end - ptr);
+    memcpy(out_buff, ptr, len);
+    return len;
+}
+
+static size_t put_exponent(char *out_buff, int exponent) {
+    size_t len = 0;
+    out_buff[len++] = 'e';
+    out_buff[len++] = exponent < 0 ? '-' : '+';
+    uint32_t abs_exponent =
+            exponent < 0 ? (uint32_t) -exponent : (uint32_t) exponent;
+    return len + uint64_to_string_digit_pairs(&out_buff[len], abs_exponent);
+}
+
+/* Formats positive, finite, non-zero value using the shortest digits that
+ * convert back to the same value. */
+static size_t double_to_string_shortest(char *out_buff,
+                                        size_t buff_size,
+                                        double value) {
+    // integral values are printed exactly, like the other implementations do
+    if (value < (double) UINT64_MAX && value == floor(value)) {
+        return uint64_to_string_digit_pairs(out_buff, (uint64_t) value);
+    }
+    char digits[_ANJ_GRISU2_MAX_DIGITS];
+    int exponent;
+    size_t digits_len = _anj_grisu2(value, digits, &exponent);
+    // position of the decimal point relative to the first digit
+    int point = (int) digits_len + exponent;
+    size_t out_len = 0;
+
+    if (value < (double) UINT64_MAX && point > 0) {
+        if ((size_t) point >= digits_len) { // X format
+            memcpy(out_buff, digits, digits_len);
+            memset(&out_buff[digits_len], '0', (size_t) point - digits_len);
+            return (size_t) point;
+        }
+        // X.Y format
+        memcpy(out_buff, digits, (size_t) point);
+        out_buff[point] = '.';
+        memcpy(&out_buff[point + 1], &digits[point],
+               digits_len - (size_t) point);
+        return digits_len + 1;
+    }
+    if (value > 1e-10 && value < 1.0
+            && 2 + (size_t) -point + digits_len <= buff_size) { // 0.X format
+        memcpy(out_buff, "0.", 2);
+        out_len = 2;
+        memset(&out_buff[out_len], '0', (size_t) -point);
+        out_len += (size_t) -point;
+        memcpy(&out_buff[out_len], digits, digits_len);
+        return out_len + digits_len;
+    }
+    // X.YeZ format
+    out_buff[out_len++] = digits[0];
+    if (digits_len > 1) {
+        out_buff[out_len++] = '.';
+        memcpy(&out_buff[out_len], &digits[1], digits_len - 1);
+        out_len += digits_len - 1;
+    }
+    return out_len + put_exponent(&out_buff[out_len], point - 1);
+}
+#endif // ANJ_WITH_FAST_NUMBER_FORMATTING
 
 size_t anj_uint64_to_string_value(char *out_buff, uint64_t value) {
-#ifdef ANJ_WITH_CUSTOM_CONVERSION_FUNCTIONS
+#ifdef ANJ_WITH_FAST_NUMBER_FORMATTING
+    return uint64_to_string_digit_pairs(out_buff, value);
+#elif defined(ANJ_WITH_CUSTOM_CONVERSION_FUNCTIONS)
     return uint64_to_string_value_internal(value, out_buff, NULL, false);
 #else  // ANJ_WITH_CUSTOM_CONVERSION_FUNCTIONS
     char buff[ANJ_U64_STR_MAX_LEN + 1];
@@ -156,7 +279,9 @@ size_t anj_uint64_to_string_value(char *out_buff, uint64_t value) {
 }
 
 size_t anj_uint32_to_string_value(char *out_buff, uint32_t value) {
-#ifdef ANJ_WITH_CUSTOM_CONVERSION_FUNCTIONS
+#ifdef ANJ_WITH_FAST_NUMBER_FORMATTING
+    return uint64_to_string_digit_pairs(out_buff, value);
+#elif defined(ANJ_WITH_CUSTOM_CONVERSION_FUNCTIONS)
     return uint64_to_string_value_internal((uint64_t) value, out_buff, NULL,
                                            false);
 #else  // ANJ_WITH_CUSTOM_CONVERSION_FUNCTIONS
@@ -168,7 +293,9 @@ size_t anj_uint32_to_string_value(char *out_buff, uint32_t value) {
 }
 
 size_t anj_uint16_to_string_value(char *out_buff, uint16_t value) {
-#ifdef ANJ_WITH_CUSTOM_CONVERSION_FUNCTIONS
+#ifdef ANJ_WITH_FAST_NUMBER_FORMATTING
+    return uint64_to_string_digit_pairs(out_buff, value);
+#elif defined(ANJ_WITH_CUSTOM_CONVERSION_FUNCTIONS)
     return uint64_to_string_value_internal((uint64_t) value, out_buff, NULL,
                                            false);
 #else  // ANJ_WITH_CUSTOM_CONVERSION_FUNCTIONS
@@ -180,7 +307,15 @@ size_t anj_uint16_to_string_value(char *out_buff, uint16_t value) {
 }
 
 size_t anj_int64_to_string_value(char *out_buff, int64_t value) {
-#ifdef ANJ_WITH_CUSTOM_CONVERSION_FUNCTIONS
+#ifdef ANJ_WITH_FAST_NUMBER_FORMATTING
+    if (value < 0) {
+        out_buff[0] = '-';
+        return 1
+               + uint64_to_string_digit_pairs(&out_buff[1],
+                                              (uint64_t) 0 - (uint64_t) value);
+    }
+    return uint64_to_string_digit_pairs(out_buff, (uint64_t) value);
+#elif defined(ANJ_WITH_CUSTOM_CONVERSION_FUNCTIONS)
     size_t msg_size = 0;
 
     /* Handle 0 and INT64_MIN cases */
@@ -213,7 +348,27 @@ size_t anj_int64_to_string_value(char *out_buff, int64_t value) {
     (sizeof("2.2250738585072014") - 1 - 2)
 
 size_t anj_double_to_string_value(char *out_buff, double value) {
-#ifdef ANJ_WITH_CUSTOM_CONVERSION_FUNCTIONS
+#ifdef ANJ_WITH_FAST_NUMBER_FORMATTING
+    size_t out_len = 0;
+    if (isnan(value)) {
+        memcpy(out_buff, "nan", 3);
+        return 3;
+    } else if (value == 0.0) {
+        out_buff[0] = '0';
+        return 1;
+    }
+    if (value < 0.0) {
+        out_buff[out_len++] = '-';
+        value = -value;
+    }
+    if (isinf(value)) {
+        memcpy(&out_buff[out_len], "inf", 3);
+        return out_len + 3;
+    }
+    return out_len
+           + double_to_string_shortest(&out_buff[out_len],
+                                       ANJ_DOUBLE_STR_MAX_LEN - out_len, value);
+#elif defined(ANJ_WITH_CUSTOM_CONVERSION_FUNCTIONS)
     size_t out_len = 0;
     char buff[ANJ_U64_STR_MAX_LEN + 1] = { 0 };
     size_t bytes_to_copy;
@@ -510,10 +665,106 @@ int anj_string_to_int64_value(int64_t *out_val,
 #endif // ANJ_WITH_CUSTOM_CONVERSION_FUNCTIONS
 }
 
+#ifdef ANJ_WITH_FAST_NUMBER_PARSING
+/* Significant digits that fit in uint64_t without overflow */
+#    define MAX_SIGNIFICANT_DIGITS 19
+/* Large enough to make every value overflow or underflow */
+#    define MAX_EXPONENT_ABS 100000
+
+static int parse_exponent(const char *buff, size_t buff_len, int *out_exp) {
+    size_t i = 0;
+    bool is_negative = false;
+    if (i < buff_len && (buff[i] == '+' || buff[i] == '-')) {
+        is_negative = buff[i] == '-';
+        i++;
+    }
+    if (i == buff_len) {
+        return -1;
+    }
+    int value = 0;
+    for (; i < buff_len; i++) {
+        if (buff[i] < '0' || buff[i] > '9') {
+            return -1;
+        }
+        if (value < MAX_EXPONENT_ABS) {
+            value = 10 * value + (buff[i] - '0');
+        }
+    }
+    *out_exp = is_negative ? -value : value;
+    return 0;
+}
+
+static int string_to_double_fast(double *out_val,
+                                 const char *buff,
+                                 size_t buff_len) {
+    size_t i = 0;
+    bool is_negative = false;
+    if (buff_len && buff[0] == '-') {
+        is_negative = true;
+        i++;
+    }
+
+    uint64_t significand = 0;
+    int significant_digits = 0;
+    int exponent = 0;
+    bool any_digits = false;
+    bool fractional_part = false;
+    bool truncated = false;
+    for (; i < buff_len; i++) {
+        if (buff[i] == '.' && !fractional_part) {
+            fractional_part = true;
+            continue;
+        }
+        if (buff[i] < '0' || buff[i] > '9') {
+            break;
+        }
+        any_digits = true;
+        int digit = buff[i] - '0';
+        if (significant_digits < MAX_SIGNIFICANT_DIGITS) {
+            if (significand || digit) {
+                significand = 10 * significand + (uint64_t) digit;
+                significant_digits++;
+            }
+            if (fractional_part) {
+                exponent--;
+            }
+        } else {
+            truncated = truncated || digit;
+            if (!fractional_part) {
+                exponent++;
+            }
+        }
+    }
+    if (!any_digits) {
+        return -1;
+    }
+    if (i < buff_len) {
+        if ((buff[i] != 'e' && buff[i] != 'E')
+                || buff_len > ANJ_DOUBLE_STR_MAX_LEN) {
+            return -1;
+        }
+        int parsed_exponent;
+        if (parse_exponent(&buff[i + 1], buff_len - i - 1, &parsed_exponent)) {
+            return -1;
+        }
+        exponent += parsed_exponent;
+    }
+
+    double value;
+    if (_anj_decimal_to_double(significand, exponent, truncated, &value)) {
+        return -1;
+    }
+    *out_val = is_negative ? -value : value;
+    return 0;
+}
+#endif // ANJ_WITH_FAST_NUMBER_PARSING
+
 int anj_string_to_double_value(double *out_val,
                                const char *buff,
                                size_t buff_len) {
-#ifdef ANJ_WITH_CUSTOM_CONVERSION_FUNCTIONS
+#ifdef ANJ_WITH_FAST_NUMBER_PARSING
+    return string_to_double_fast(out_val, buff, buff_len);
+#elif defined(ANJ_WITH_CUSTOM_CONVERSION_FUNCTIONS)
     // handle the exponent notation
     for (size_t i = 0; i < buff_len; i++) {
         if (buff[i] == 'e' || buff[i] == 'E') {
@@ -722,3 +973,49 @@ char *_anj_coap_code_format(char (*buff)[5], uint32_t code) {
 }
 
 #endif // ANJ_PLATFORM_BIG_ENDIAN
+
+uint32_t _anj_crc32_update(uint32_t crc, const void *data, size_t size) {
+    const uint8_t *bytes = (const uint8_t *) data;
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc ^= bytes[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320U & (0U - (crc & 1U)));
+        }
+    }
+    return ~crc;
+}
+
+#ifdef ANJ_WITH_SESSION_PERSISTENCE
+int _anj_persistence_monotonic_time(const anj_persistence_context_t *ctx,
+                                    anj_time_monotonic_t base,
+                                    anj_time_monotonic_t *inout_time) {
+    bool valid = false;
+    int64_t offset_us = 0;
+    if (anj_persistence_direction(ctx) == ANJ_PERSISTENCE_STORE
+            && anj_time_monotonic_is_valid(*inout_time)) {
+        valid = true;
+        offset_us = anj_time_duration_to_scalar(
+                anj_time_monotonic_diff(*inout_time, base), ANJ_TIME_UNIT_US);
+    }
+    if (anj_persistence_bool(ctx, &valid)
+            || anj_persistence_i64(ctx, &offset_us)) {
+        return -1;
+    }
+    if (anj_persistence_direction(ctx) == ANJ_PERSISTENCE_RESTORE) {
+        *inout_time = valid ? anj_time_monotonic_add(
+                                      base, anj_time_duration_new(
+                                                    offset_us, ANJ_TIME_UNIT_US))
+                            : ANJ_TIME_MONOTONIC_INVALID;
+    }
+    return 0;
+}
+
+int _anj_persistence_store_bytes(const anj_persistence_context_t *ctx,
+                                 const void *data,
+                                 size_t size) {
+    assert(anj_persistence_direction(ctx) == ANJ_PERSISTENCE_STORE
+           && ctx->write && data);
+    return ctx->write(ctx->ctx, data, size);
+}
+#endif // ANJ_WITH_SESSION_PERSISTENCE
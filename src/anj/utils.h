@@ -20,6 +20,17 @@
 
 #    include "coap/coap.h"
 
+#    ifdef ANJ_WITH_SESSION_PERSISTENCE
+#        include <anj/persistence.h>
+#        include <anj/time.h>
+#    endif // ANJ_WITH_SESSION_PERSISTENCE
+
+#    ifdef ANJ_WITH_STEP_TIME_CACHE
+#        include <anj/compat/time.h>
+#        include <anj/time.h>
+#        include <anj/utils.h>
+#    endif // ANJ_WITH_STEP_TIME_CACHE
+
 #    define _ANJ_CBOR_VAL_OR_LEN_LEN_IMPL(Val_or_len)   \
         ((Val_or_len) <= 23                             \
                  ? 1                                    \
@@ -50,6 +61,78 @@
  */
 bool _anj_uri_path_to_security_or_oscore_obj(const anj_uri_path_t *path);
 
+/**
+ * Compares two paths, ordering them lexicographically by their IDs, with a
+ * path placed before all paths it is a prefix of. In consequence, all paths
+ * with a given prefix are placed right after it in a sorted array.
+ *
+ * @param left  First path.
+ * @param right Second path.
+ *
+ * @returns negative value, 0 or positive value if @p left is respectively
+ * ordered before, equal to or ordered after @p right.
+ */
+int _anj_uri_path_compare(const anj_uri_path_t *left,
+                          const anj_uri_path_t *right);
+
+/**
+ * Path packed into a single integer: each of the 4 IDs, starting with the
+ * Object ID in the most significant bits, is stored as ID + 1 in 16 bits, with
+ * 0 for the components absent in the path (ANJ_ID_INVALID is never a valid ID,
+ * so ID + 1 always fits). As a result:
+ * - keys of two paths are equal if and only if the paths are equal,
+ * - keys are ordered the same way as paths by @ref _anj_uri_path_compare,
+ * - a path lies within the subtree of a base path of length L if and only if
+ *   their keys are equal on the first L components, see
+ *   @ref _anj_uri_path_key_outside_base.
+ */
+typedef uint64_t _anj_uri_path_key_t;
+
+static inline _anj_uri_path_key_t
+_anj_uri_path_key(const anj_uri_path_t *path) {
+    _anj_uri_path_key_t key = 0;
+    for (size_t i = 0; i < ANJ_URI_PATH_MAX_LENGTH; i++) {
+        key <<= 16;
+        if (i < path->uri_len) {
+            key |= (_anj_uri_path_key_t) path->ids[i] + 1;
+        }
+    }
+    return key;
+}
+
+/** Returns the length of the path packed into @p key. */
+static inline size_t _anj_uri_path_key_length(_anj_uri_path_key_t key) {
+    size_t uri_len = 0;
+    while (uri_len < ANJ_URI_PATH_MAX_LENGTH
+           && (key >> (16 * (ANJ_URI_PATH_MAX_LENGTH - 1 - uri_len)))
+                      & UINT16_MAX) {
+        uri_len++;
+    }
+    return uri_len;
+}
+
+/**
+ * Returns the mask of the key components present in a path of length
+ * @p uri_len.
+ */
+static inline _anj_uri_path_key_t _anj_uri_path_key_mask(size_t uri_len) {
+    return uri_len ? UINT64_MAX << (16 * (ANJ_URI_PATH_MAX_LENGTH - uri_len))
+                   : 0;
+}
+
+/**
+ * Equivalent of @ref anj_uri_path_outside_base for packed paths,
+ * @p base_mask is the result of @ref _anj_uri_path_key_mask for the length of
+ * the base path. A path shorter than the base has 0 where the base has an ID,
+ * so no separate length check is needed.
+ */
+static inline bool
+_anj_uri_path_key_outside_base(_anj_uri_path_key_t path_key,
+                               _anj_uri_path_key_t base_key,
+                               _anj_uri_path_key_t base_mask) {
+    return ((path_key ^ base_key) & base_mask) != 0;
+}
+
 /**
  * Compares two tokens.
  *
@@ -162,6 +245,65 @@ static inline bool _anj_is_power_of_2(size_t value) {
 
 char *_anj_coap_code_format(char (*buff)[5], uint32_t code);
 
+/**
+ * Updates a CRC-32 (IEEE 802.3) with @p size bytes of @p data. Computed bitwise
+ * to avoid a 1 kB lookup table.
+ *
+ * @param crc  CRC of the preceding data, 0 for the first chunk.
+ * @param data Next chunk of data.
+ * @param size Size of @p data.
+ *
+ * @returns CRC of all data so far.
+ */
+uint32_t _anj_crc32_update(uint32_t crc, const void *data, size_t size);
+
 #    define COAP_CODE_FORMAT(Code) _anj_coap_code_format(&(char[5]){ "" }, Code)
 
+#    ifdef ANJ_WITH_SESSION_PERSISTENCE
+/**
+ * Stores or restores a point in time as an offset from @p base, which must
+ * refer to the same moment in both directions: the time of the store operation
+ * and its equivalent on the monotonic clock of the restoring process.
+ * Invalid time is preserved.
+ *
+ * @return 0 on success, negative value on error.
+ */
+int _anj_persistence_monotonic_time(const anj_persistence_context_t *ctx,
+                                    anj_time_monotonic_t base,
+                                    anj_time_monotonic_t *inout_time);
+
+/**
+ * Writes @p size bytes of @p data using a context in STORE direction. Unlike
+ * @ref anj_persistence_bytes, doesn't require the data to be writable.
+ *
+ * @return 0 on success, negative value on error.
+ */
+int _anj_persistence_store_bytes(const anj_persistence_context_t *ctx,
+                                 const void *data,
+                                 size_t size);
+#    endif // ANJ_WITH_SESSION_PERSISTENCE
+
+#    ifdef ANJ_WITH_STEP_TIME_CACHE
+/**
+ * Returns the time cached by @ref anj_core_step in @p step_time, or reads the
+ * clock if @p step_time is NULL or not valid, i.e. outside of that call.
+ */
+static inline anj_time_monotonic_t
+_anj_step_time_now(const _anj_step_time_t *step_time) {
+    if (step_time && step_time->valid) {
+        return step_time->now;
+    }
+    return anj_time_monotonic_now();
+}
+
+/**
+ * Current monotonic time as seen by a module holding a pointer to the time
+ * cached by @ref anj_core_step. The argument is not evaluated if
+ * @ref ANJ_WITH_STEP_TIME_CACHE is disabled.
+ */
+#        define _ANJ_STEP_TIME_NOW(StepTime) _anj_step_time_now(StepTime)
+#    else  // ANJ_WITH_STEP_TIME_CACHE
+#        define _ANJ_STEP_TIME_NOW(StepTime) anj_time_monotonic_now()
+#    endif // ANJ_WITH_STEP_TIME_CACHE
+
 #endif // SRC_ANJ_UTILS_H
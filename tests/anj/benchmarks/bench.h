@@ -0,0 +1,52 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJ_BENCH_H
+#define ANJ_BENCH_H
+
+#include <stdint.h>
+
+/**
+ * Body of a benchmark, performs the measured operation @p iterations times.
+ */
+typedef void bench_fn_t(void *arg, uint64_t iterations);
+
+/** Stores a value so that the compiler cannot optimize its computation out. */
+extern volatile uint64_t bench_sink;
+
+/**
+ * Measures @p fn and prints the result as a single JSON line on stdout:
+ *
+ * @code
+ * {"name":"coap/decode_udp/read","param":0,"iterations":1048576,
+ *  "ns_per_op":85.31,"cycles_per_op":298.6}
+ * @endcode
+ *
+ * The number of iterations is calibrated so that a single batch takes about
+ * 20 ms, the median of several batches is reported. @c cycles_per_op is
+ * @c null if the platform has no cycle counter.
+ *
+ * @param name  Name of the benchmark, skipped if it does not contain the
+ *              filter passed on the command line.
+ * @param param Size of the benchmarked data set (number of objects,
+ *              observations etc.), 0 if not applicable.
+ * @param fn    Benchmark body.
+ * @param arg   Argument passed to @p fn.
+ */
+void bench_run(const char *name, unsigned param, bench_fn_t *fn, void *arg);
+
+/** Stops the program if @p condition is false; used to validate setup. */
+void bench_check(int condition, const char *what);
+
+void bench_io(void);
+void bench_coap(void);
+void bench_dm(void);
+void bench_observe(void);
+
+#endif // ANJ_BENCH_H
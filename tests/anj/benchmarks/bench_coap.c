@@ -0,0 +1,132 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/defs.h>
+
+#include "../../../src/anj/coap/coap.h"
+
+#include "bench.h"
+
+typedef struct {
+    uint8_t msg[128];
+    size_t msg_size;
+} decode_bench_t;
+
+static void bench_decode(void *arg, uint64_t iterations) {
+    decode_bench_t *bench = (decode_bench_t *) arg;
+    for (uint64_t i = 0; i < iterations; i++) {
+        _anj_coap_msg_t out;
+        // memset is a part of the typical usage
+        memset(&out, 0, sizeof(out));
+        bench_sink += (uint64_t) _anj_coap_decode_udp(bench->msg,
+                                                      bench->msg_size, &out);
+        bench_sink += out.payload_size;
+    }
+}
+
+static void run_decode(const char *name, const char *msg, size_t msg_size) {
+    static decode_bench_t bench;
+    bench_check(msg_size <= sizeof(bench.msg), name);
+    memcpy(bench.msg, msg, msg_size);
+    bench.msg_size = msg_size;
+    _anj_coap_msg_t out = { 0 };
+    bench_check(!_anj_coap_decode_udp(bench.msg, bench.msg_size, &out), name);
+    bench_run(name, (unsigned) msg_size, bench_decode, &bench);
+}
+
+typedef struct {
+    _anj_coap_msg_t msg;
+    uint8_t out[256];
+} encode_bench_t;
+
+static void bench_encode(void *arg, uint64_t iterations) {
+    encode_bench_t *bench = (encode_bench_t *) arg;
+    for (uint64_t i = 0; i < iterations; i++) {
+        size_t size = 0;
+        bench_sink += (uint64_t) _anj_coap_encode_udp(
+                &bench->msg, bench->out, sizeof(bench->out), &size);
+        bench_sink += size;
+    }
+}
+
+static void run_encode(const char *name, encode_bench_t *bench) {
+    size_t size;
+    bench_check(!_anj_coap_encode_udp(&bench->msg, bench->out,
+                                      sizeof(bench->out), &size),
+                name);
+    bench_run(name, (unsigned) size, bench_encode, bench);
+}
+
+static uint8_t PAYLOAD[64];
+
+void bench_coap(void) {
+    static const char READ[] =
+            "\x48"                             // CON, tkl 8
+            "\x01\x21\x37"                     // GET, msg id
+            "\x12\x34\x56\x78\x9A\xBC\xDE\xF0" // token
+            "\xB4\x33\x33\x30\x33"             // uri-path /3303
+            "\x01\x30"                         // uri-path /0
+            "\x04\x35\x37\x30\x30"             // uri-path /5700
+            "\x62\x2D\x18";                    // accept 11544
+    run_decode("coap/decode_udp/read", READ, sizeof(READ) - 1);
+
+    static const char OBSERVE[] =
+            "\x48"                             // CON, tkl 8
+            "\x01\x21\x38"                     // GET, msg id
+            "\x12\x34\x56\x78\x9A\xBC\xDE\xF1" // token
+            "\x60"                             // observe 0
+            "\x54\x33\x33\x30\x33"             // uri-path /3303
+            "\x01\x30"                         // uri-path /0
+            "\x04\x35\x37\x30\x30"             // uri-path /5700
+            "\x46\x70\x6D\x69\x6E\x3D\x35"     // uri-query pmin=5
+            "\x07\x70\x6D\x61\x78\x3D\x33\x30"; // uri-query pmax=30
+    run_decode("coap/decode_udp/observe", OBSERVE, sizeof(OBSERVE) - 1);
+
+    static char WRITE[128];
+    static const char WRITE_HEADER[] =
+            "\x48"                             // CON, tkl 8
+            "\x03\x21\x39"                     // PUT, msg id
+            "\x12\x34\x56\x78\x9A\xBC\xDE\xF2" // token
+            "\xB4\x33\x33\x30\x33"             // uri-path /3303
+            "\x01\x30"                         // uri-path /0
+            "\x12\x2D\x18"                     // content-format 11544
+            "\xFF";                            // payload marker
+    memcpy(WRITE, WRITE_HEADER, sizeof(WRITE_HEADER) - 1);
+    size_t write_size = sizeof(WRITE_HEADER) - 1;
+    memset(&WRITE[write_size], 0xA5, sizeof(PAYLOAD));
+    write_size += sizeof(PAYLOAD);
+    run_decode("coap/decode_udp/write", WRITE, write_size);
+
+    memset(PAYLOAD, 0x5A, sizeof(PAYLOAD));
+    static encode_bench_t bench;
+    memset(&bench, 0, sizeof(bench));
+    bench.msg.operation = ANJ_OP_RESPONSE;
+    bench.msg.msg_code = ANJ_COAP_CODE_CONTENT;
+    bench.msg.coap_binding_data.message_id = 0x2137;
+    bench.msg.token.size = 8;
+    memcpy(bench.msg.token.bytes, "\x12\x34\x56\x78\x9A\xBC\xDE\xF0", 8);
+    bench.msg.content_format = _ANJ_COAP_FORMAT_OMA_LWM2M_CBOR;
+    bench.msg.payload = PAYLOAD;
+    bench.msg.payload_size = sizeof(PAYLOAD);
+    run_encode("coap/encode_udp/response", &bench);
+
+    memset(&bench, 0, sizeof(bench));
+    bench.msg.operation = ANJ_OP_INF_NON_CON_NOTIFY;
+    bench.msg.token.size = 8;
+    memcpy(bench.msg.token.bytes, "\x12\x34\x56\x78\x9A\xBC\xDE\xF1", 8);
+    bench.msg.observe_number = 0x2233;
+    bench.msg.content_format = _ANJ_COAP_FORMAT_SENML_CBOR;
+    bench.msg.payload = PAYLOAD;
+    bench.msg.payload_size = sizeof(PAYLOAD);
+    run_encode("coap/encode_udp/notify", &bench);
+}
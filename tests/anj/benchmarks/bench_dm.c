@@ -0,0 +1,131 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/dm/core.h>
+
+#include "../../../src/anj/dm/dm_core.h"
+#include "../../../src/anj/dm/dm_io.h"
+#include "../../../src/anj/exchange.h"
+
+#include "bench.h"
+
+#define RES_COUNT 8
+#define BASE_OID 3300
+
+static int res_read(anj_t *anj,
+                    const anj_dm_obj_t *obj,
+                    anj_iid_t iid,
+                    anj_rid_t rid,
+                    anj_riid_t riid,
+                    anj_res_value_t *out_value) {
+    (void) anj;
+    (void) obj;
+    (void) iid;
+    (void) riid;
+    out_value->double_value = (double) rid;
+    return 0;
+}
+
+static const anj_dm_handlers_t HANDLERS = {
+    .res_read = res_read
+};
+
+static const anj_dm_res_t RESOURCES[RES_COUNT] = {
+    { .rid = 0, .kind = ANJ_DM_RES_R, .type = ANJ_DATA_TYPE_DOUBLE },
+    { .rid = 1, .kind = ANJ_DM_RES_R, .type = ANJ_DATA_TYPE_DOUBLE },
+    { .rid = 2, .kind = ANJ_DM_RES_R, .type = ANJ_DATA_TYPE_DOUBLE },
+    { .rid = 3, .kind = ANJ_DM_RES_R, .type = ANJ_DATA_TYPE_DOUBLE },
+    { .rid = 4, .kind = ANJ_DM_RES_R, .type = ANJ_DATA_TYPE_DOUBLE },
+    { .rid = 5, .kind = ANJ_DM_RES_R, .type = ANJ_DATA_TYPE_DOUBLE },
+    { .rid = 6, .kind = ANJ_DM_RES_R, .type = ANJ_DATA_TYPE_DOUBLE },
+    { .rid = 7, .kind = ANJ_DM_RES_R, .type = ANJ_DATA_TYPE_DOUBLE }
+};
+
+static anj_dm_obj_inst_t g_insts[ANJ_DM_MAX_OBJECTS_NUMBER];
+static anj_dm_obj_t g_objs[ANJ_DM_MAX_OBJECTS_NUMBER];
+static anj_t g_anj;
+
+static void setup(unsigned obj_count) {
+    memset(&g_anj, 0, sizeof(g_anj));
+    _anj_exchange_init(&g_anj.exchange_ctx);
+    _anj_dm_initialize(&g_anj);
+    for (unsigned i = 0; i < obj_count; i++) {
+        g_insts[i] = (anj_dm_obj_inst_t) {
+            .iid = 0,
+            .res_count = RES_COUNT,
+            .resources = RESOURCES
+        };
+        g_objs[i] = (anj_dm_obj_t) {
+            .oid = (anj_oid_t) (BASE_OID + i),
+            .insts = &g_insts[i],
+            .max_inst_count = 1,
+            .handlers = &HANDLERS
+        };
+        bench_check(!anj_dm_add_obj(&g_anj, &g_objs[i]), "anj_dm_add_obj");
+    }
+}
+
+static void bench_lookup(void *arg, uint64_t iterations) {
+    const anj_uri_path_t *path = (const anj_uri_path_t *) arg;
+    for (uint64_t i = 0; i < iterations; i++) {
+        _anj_dm_entity_ptrs_t ptrs;
+        bench_sink += (uint64_t) _anj_dm_get_entity_ptrs(&g_anj.dm, path,
+                                                         &ptrs);
+        bench_sink += (uintptr_t) ptrs.res;
+    }
+}
+
+static int read_instance(const anj_uri_path_t *path) {
+    int result = _anj_dm_operation_begin(&g_anj, ANJ_OP_DM_READ, false, path);
+    if (result) {
+        return result;
+    }
+    anj_io_out_entry_t record;
+    while (!(result = _anj_dm_get_read_entry(&g_anj, &record))) {
+        bench_sink += (uint64_t) record.value.double_value;
+    }
+    _anj_dm_operation_end(&g_anj, ANJ_DM_TRANSACTION_SUCCESS);
+    return result == _ANJ_DM_LAST_RECORD ? 0 : result;
+}
+
+static void bench_read(void *arg, uint64_t iterations) {
+    const anj_uri_path_t *path = (const anj_uri_path_t *) arg;
+    for (uint64_t i = 0; i < iterations; i++) {
+        bench_sink += (uint64_t) read_instance(path);
+    }
+}
+
+void bench_dm(void) {
+    static const unsigned OBJ_COUNTS[] = { 1, 8, 32, ANJ_DM_MAX_OBJECTS_NUMBER };
+    for (size_t i = 0; i < sizeof(OBJ_COUNTS) / sizeof(OBJ_COUNTS[0]); i++) {
+        unsigned count = OBJ_COUNTS[i];
+        if (count > ANJ_DM_MAX_OBJECTS_NUMBER) {
+            continue;
+        }
+        setup(count);
+        // the last Object is the worst case for linear lookups
+        anj_uri_path_t res_path = ANJ_MAKE_RESOURCE_PATH(
+                (anj_oid_t) (BASE_OID + count - 1), 0, RES_COUNT - 1);
+        anj_uri_path_t inst_path =
+                ANJ_MAKE_INSTANCE_PATH((anj_oid_t) (BASE_OID + count - 1), 0);
+        _anj_dm_entity_ptrs_t ptrs;
+        bench_check(!_anj_dm_get_entity_ptrs(&g_anj.dm, &res_path, &ptrs),
+                    "_anj_dm_get_entity_ptrs");
+        bench_check(!read_instance(&inst_path), "read_instance");
+        bench_run("dm/get_entity_ptrs", count, bench_lookup, &res_path);
+        bench_run("dm/read_instance", count, bench_read, &inst_path);
+    }
+}
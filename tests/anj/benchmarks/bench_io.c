@@ -0,0 +1,166 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/defs.h>
+
+#include "../../../src/anj/coap/coap.h"
+#include "../../../src/anj/io/io.h"
+
+#include "bench.h"
+
+#define OID 3303
+#define ENTRY_COUNT 8
+
+static const anj_data_type_t ENTRY_TYPES[ENTRY_COUNT] = {
+    ANJ_DATA_TYPE_STRING, ANJ_DATA_TYPE_INT,    ANJ_DATA_TYPE_DOUBLE,
+    ANJ_DATA_TYPE_BOOL,   ANJ_DATA_TYPE_TIME,   ANJ_DATA_TYPE_UINT,
+    ANJ_DATA_TYPE_DOUBLE, ANJ_DATA_TYPE_OBJLNK
+};
+
+/* Typical Read response: one Object Instance with a few Resources */
+static void fill_entries(anj_io_out_entry_t *entries) {
+    memset(entries, 0, ENTRY_COUNT * sizeof(*entries));
+    for (anj_rid_t rid = 0; rid < ENTRY_COUNT; rid++) {
+        entries[rid].path = ANJ_MAKE_RESOURCE_PATH(OID, 0, rid);
+        entries[rid].type = ENTRY_TYPES[rid];
+        entries[rid].timestamp = NAN;
+    }
+    entries[0].value.bytes_or_string.data = "Cel";
+    entries[1].value.int_value = -1234567;
+    entries[2].value.double_value = 23.5;
+    entries[3].value.bool_value = true;
+    entries[4].value.time_value = 1700000000;
+    entries[5].value.uint_value = 42;
+    entries[6].value.double_value = -40.25;
+    entries[7].value.objlnk.oid = 3;
+    entries[7].value.objlnk.iid = 0;
+}
+
+typedef struct {
+    uint16_t format;
+    anj_uri_path_t base_path;
+    size_t entry_count;
+    anj_io_out_entry_t entries[ENTRY_COUNT];
+    uint8_t payload[512];
+    size_t payload_size;
+    uint8_t scratch[512];
+} io_bench_t;
+
+static size_t encode(io_bench_t *bench) {
+    _anj_io_out_ctx_t ctx;
+    if (_anj_io_out_ctx_init(&ctx, ANJ_OP_DM_READ, &bench->base_path,
+                             bench->entry_count, bench->format)) {
+        return 0;
+    }
+    size_t size = 0;
+    for (size_t i = 0; i < bench->entry_count; i++) {
+        size_t copied;
+        if (_anj_io_out_ctx_new_entry(&ctx, &bench->entries[i])
+                || _anj_io_out_ctx_get_payload(&ctx, &bench->payload[size],
+                                               sizeof(bench->payload) - size,
+                                               &copied)) {
+            return 0;
+        }
+        size += copied;
+    }
+    return size;
+}
+
+static void bench_encode(void *arg, uint64_t iterations) {
+    io_bench_t *bench = (io_bench_t *) arg;
+    for (uint64_t i = 0; i < iterations; i++) {
+        bench_sink += encode(bench);
+    }
+}
+
+static size_t decode(io_bench_t *bench) {
+    // some decoders modify the payload in place
+    memcpy(bench->scratch, bench->payload, bench->payload_size);
+    _anj_io_in_ctx_t ctx;
+    if (_anj_io_in_ctx_init(&ctx, ANJ_OP_DM_WRITE_PARTIAL_UPDATE,
+                            &bench->base_path, bench->format)
+            || _anj_io_in_ctx_feed_payload(&ctx, bench->scratch,
+                                           bench->payload_size, true)) {
+        return 0;
+    }
+    size_t count = 0;
+    for (;;) {
+        anj_data_type_t type = ANJ_DATA_TYPE_ANY;
+        const anj_res_value_t *value;
+        const anj_uri_path_t *path;
+        int result = _anj_io_in_ctx_get_entry(&ctx, &type, &value, &path);
+        if (result == _ANJ_IO_WANT_TYPE_DISAMBIGUATION) {
+            type = ENTRY_TYPES[path->ids[ANJ_ID_RID]];
+            result = _anj_io_in_ctx_get_entry(&ctx, &type, &value, &path);
+        }
+        if (result == _ANJ_IO_EOF) {
+            return count;
+        }
+        if (result) {
+            return 0;
+        }
+        count++;
+    }
+}
+
+static void bench_decode(void *arg, uint64_t iterations) {
+    io_bench_t *bench = (io_bench_t *) arg;
+    for (uint64_t i = 0; i < iterations; i++) {
+        bench_sink += decode(bench);
+    }
+}
+
+static void run_format(const char *encode_name,
+                       const char *decode_name,
+                       uint16_t format,
+                       bool single_resource) {
+    static io_bench_t bench;
+    memset(&bench, 0, sizeof(bench));
+    bench.format = format;
+    fill_entries(bench.entries);
+    if (single_resource) {
+        // Plain Text carries a single Resource value
+        bench.base_path = ANJ_MAKE_RESOURCE_PATH(OID, 0, 2);
+        bench.entries[0] = bench.entries[2];
+        bench.entry_count = 1;
+    } else {
+        bench.base_path = ANJ_MAKE_INSTANCE_PATH(OID, 0);
+        bench.entry_count = ENTRY_COUNT;
+    }
+    bench.payload_size = encode(&bench);
+    bench_check(bench.payload_size > 0, encode_name);
+    bench_check(decode(&bench) == bench.entry_count, decode_name);
+    bench_run(encode_name, (unsigned) bench.payload_size, bench_encode, &bench);
+    bench_run(decode_name, (unsigned) bench.payload_size, bench_decode, &bench);
+}
+
+void bench_io(void) {
+#ifdef ANJ_WITH_SENML_CBOR
+    run_format("io/senml_cbor/encode", "io/senml_cbor/decode",
+               _ANJ_COAP_FORMAT_SENML_CBOR, false);
+#endif // ANJ_WITH_SENML_CBOR
+#ifdef ANJ_WITH_LWM2M_CBOR
+    run_format("io/lwm2m_cbor/encode", "io/lwm2m_cbor/decode",
+               _ANJ_COAP_FORMAT_OMA_LWM2M_CBOR, false);
+#endif // ANJ_WITH_LWM2M_CBOR
+#if defined(ANJ_WITH_TLV) && defined(ANJ_WITH_TLV_ENCODER)
+    run_format("io/tlv/encode", "io/tlv/decode",
+               _ANJ_COAP_FORMAT_OMA_LWM2M_TLV, false);
+#endif // defined(ANJ_WITH_TLV) && defined(ANJ_WITH_TLV_ENCODER)
+#ifdef ANJ_WITH_PLAINTEXT
+    run_format("io/text/encode", "io/text/decode", _ANJ_COAP_FORMAT_PLAINTEXT,
+               true);
+#endif // ANJ_WITH_PLAINTEXT
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/compat/time.h>
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/dm/core.h>
+#include <anj/time.h>
+
+#include "../../../src/anj/coap/coap.h"
+#include "../../../src/anj/dm/dm_io.h"
+#include "../../../src/anj/exchange.h"
+#include "../../../src/anj/observe/observe.h"
+
+#include "bench.h"
+
+#ifdef ANJ_WITH_OBSERVE
+
+#    define OID 3303
+
+static int res_read(anj_t *anj,
+                    const anj_dm_obj_t *obj,
+                    anj_iid_t iid,
+                    anj_rid_t rid,
+                    anj_riid_t riid,
+                    anj_res_value_t *out_value) {
+    (void) anj;
+    (void) obj;
+    (void) iid;
+    (void) riid;
+    out_value->double_value = (double) rid;
+    return 0;
+}
+
+static const anj_dm_handlers_t HANDLERS = {
+    .res_read = res_read
+};
+
+/* Every Observation is related to a different Resource of a single Object */
+static anj_dm_res_t g_res[ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER];
+static anj_dm_obj_inst_t g_inst = {
+    .iid = 0,
+    .res_count = ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER,
+    .resources = g_res
+};
+static anj_dm_obj_t g_obj = {
+    .oid = OID,
+    .insts = &g_inst,
+    .max_inst_count = 1,
+    .handlers = &HANDLERS
+};
+static anj_t g_anj;
+
+static const _anj_observe_server_state_t SERVER_STATE = {
+    .is_server_online = true,
+    .ssid = 1
+};
+
+static void setup(unsigned observation_count) {
+    for (size_t i = 0; i < ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER; i++) {
+        g_res[i] = (anj_dm_res_t) {
+            .rid = (anj_rid_t) i,
+            .kind = ANJ_DM_RES_R,
+            .type = ANJ_DATA_TYPE_DOUBLE
+        };
+    }
+    memset(&g_anj, 0, sizeof(g_anj));
+    _anj_exchange_init(&g_anj.exchange_ctx);
+    _anj_dm_initialize(&g_anj);
+    bench_check(!anj_dm_add_obj(&g_anj, &g_obj), "anj_dm_add_obj");
+    _anj_observe_init(&g_anj);
+
+    anj_time_monotonic_t now = anj_time_monotonic_now();
+    for (unsigned i = 0; i < observation_count; i++) {
+        _anj_observe_observation_t *observation =
+                &g_anj.observe_ctx.observations[i];
+        observation->ssid = SERVER_STATE.ssid;
+        observation->token.size = 2;
+        observation->token.bytes[0] = (uint8_t) (i >> 8);
+        observation->token.bytes[1] = (uint8_t) i;
+        observation->path = ANJ_MAKE_RESOURCE_PATH(OID, 0, (anj_rid_t) i);
+        observation->observe_active = true;
+        observation->last_notify_timestamp = now;
+        observation->next_conf_notify_timestamp = anj_time_monotonic_add(
+                now, anj_time_duration_new(1, ANJ_TIME_UNIT_DAY));
+#    ifdef ANJ_WITH_OBSERVE_COMPOSITE
+        observation->accept_opt = _ANJ_COAP_FORMAT_NOT_DEFINED;
+        observation->content_format_opt = _ANJ_COAP_FORMAT_NOT_DEFINED;
+#    endif // ANJ_WITH_OBSERVE_COMPOSITE
+    }
+}
+
+/* No attributes are set and the values do not change, so nothing is sent: this
+ * measures the cost of the periodic check of all Observations. */
+static void bench_process(void *arg, uint64_t iterations) {
+    (void) arg;
+    for (uint64_t i = 0; i < iterations; i++) {
+        _anj_exchange_handlers_t handlers;
+        _anj_coap_msg_t msg;
+        memset(&msg, 0, sizeof(msg));
+        bench_sink += (uint64_t) _anj_observe_process(&g_anj, &handlers,
+                                                      &SERVER_STATE, &msg);
+        bench_sink += (uint64_t) msg.operation;
+    }
+}
+
+static void bench_changed(void *arg, uint64_t iterations) {
+    const anj_uri_path_t *path = (const anj_uri_path_t *) arg;
+    for (uint64_t i = 0; i < iterations; i++) {
+        bench_sink += (uint64_t) anj_observe_data_model_changed(
+                &g_anj, path, ANJ_OBSERVE_CHANGE_TYPE_VALUE_CHANGED, 0);
+    }
+}
+
+void bench_observe(void) {
+    static const unsigned OBSERVATION_COUNTS[] = {
+        1, 8, 32, ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER
+    };
+    for (size_t i = 0;
+         i < sizeof(OBSERVATION_COUNTS) / sizeof(OBSERVATION_COUNTS[0]);
+         i++) {
+        unsigned count = OBSERVATION_COUNTS[i];
+        if (count > ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER) {
+            continue;
+        }
+        setup(count);
+        bench_run("observe/process_idle", count, bench_process, NULL);
+        // only the last Observation is affected
+        anj_uri_path_t path =
+                ANJ_MAKE_RESOURCE_PATH(OID, 0, (anj_rid_t) (count - 1));
+        bench_run("observe/data_model_changed", count, bench_changed, &path);
+    }
+}
+
+#else // ANJ_WITH_OBSERVE
+
+void bench_observe(void) {}
+
+#endif // ANJ_WITH_OBSERVE
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#    include <x86intrin.h>
+#    define HAVE_CYCLE_COUNTER
+#endif // defined(__x86_64__) || defined(__i386__)
+
+#include "bench.h"
+
+#define BATCHES 7
+#define MIN_BATCH_NS 20000000ULL
+
+volatile uint64_t bench_sink;
+
+static const char *g_filter;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+static uint64_t now_cycles(void) {
+#ifdef HAVE_CYCLE_COUNTER
+    return (uint64_t) __rdtsc();
+#else  // HAVE_CYCLE_COUNTER
+    return 0;
+#endif // HAVE_CYCLE_COUNTER
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+void bench_check(int condition, const char *what) {
+    if (!condition) {
+        fprintf(stderr, "benchmark setup failed: %s\n", what);
+        exit(EXIT_FAILURE);
+    }
+}
+
+void bench_run(const char *name, unsigned param, bench_fn_t *fn, void *arg) {
+    if (g_filter && !strstr(name, g_filter)) {
+        return;
+    }
+
+    // warm up and calibrate
+    uint64_t iterations = 1;
+    uint64_t elapsed;
+    for (;;) {
+        uint64_t start = now_ns();
+        fn(arg, iterations);
+        elapsed = now_ns() - start;
+        if (elapsed >= MIN_BATCH_NS / 16 || iterations >= (1ULL << 40)) {
+            break;
+        }
+        iterations *= 2;
+    }
+    if (elapsed) {
+        iterations = iterations * MIN_BATCH_NS / elapsed + 1;
+    }
+
+    double ns[BATCHES];
+    double cycles[BATCHES];
+    for (int i = 0; i < BATCHES; i++) {
+        uint64_t start_cycles = now_cycles();
+        uint64_t start = now_ns();
+        fn(arg, iterations);
+        uint64_t end = now_ns();
+        uint64_t end_cycles = now_cycles();
+        ns[i] = (double) (end - start) / (double) iterations;
+        cycles[i] = (double) (end_cycles - start_cycles) / (double) iterations;
+    }
+    qsort(ns, BATCHES, sizeof(ns[0]), compare_doubles);
+    qsort(cycles, BATCHES, sizeof(cycles[0]), compare_doubles);
+
+    printf("{\"name\":\"%s\",\"param\":%u,\"iterations\":%llu,"
+           "\"ns_per_op\":%.2f,",
+           name, param, (unsigned long long) iterations, ns[BATCHES / 2]);
+#ifdef HAVE_CYCLE_COUNTER
+    printf("\"cycles_per_op\":%.1f}\n", cycles[BATCHES / 2]);
+#else  // HAVE_CYCLE_COUNTER
+    printf("\"cycles_per_op\":null}\n");
+#endif // HAVE_CYCLE_COUNTER
+    fflush(stdout);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 2 || (argc == 2 && !strcmp(argv[1], "--help"))) {
+        fprintf(stderr, "Usage: %s [name_filter]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (argc == 2) {
+        g_filter = argv[1];
+    }
+    bench_io();
+    bench_coap();
+    bench_dm();
+    bench_observe();
+    return 0;
+}
@@ -0,0 +1,315 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/compat/net/anj_net_api.h>
+#include <anj/compat/net/anj_udp.h>
+#include <anj/compat/rng.h>
+#include <anj/compat/time.h>
+#include <anj/time.h>
+#include <anj/utils.h>
+
+#include "link.h"
+
+#define MAX_DATAGRAMS_IN_FLIGHT 64
+
+// reported by anj_udp_get_inner_mtu(), IPv6 and UDP headers subtracted
+#define INNER_MTU (LINK_MAX_DATAGRAM_SIZE - 48)
+
+// virtual real time clock starts at 2023-11-14
+#define REAL_TIME_BASE_S 1700000000
+
+typedef enum {
+    DIRECTION_UP,
+    DIRECTION_DOWN
+} direction_t;
+
+typedef struct {
+    bool in_use;
+    anj_net_socket_state_t state;
+    char hostname[64];
+} link_conn_t;
+
+typedef struct {
+    bool in_use;
+    int conn;
+    direction_t direction;
+    // preserves FIFO order of datagrams with the same delivery time
+    uint64_t seq;
+    uint64_t deliver_at_us;
+    size_t size;
+    uint8_t data[LINK_MAX_DATAGRAM_SIZE];
+} datagram_t;
+
+static struct {
+    link_profile_t profile;
+    uint32_t rng_state;
+    uint64_t now_us;
+    uint64_t busy_until_us[2];
+    uint64_t next_seq;
+    link_stats_t stats;
+    link_conn_t conns[LINK_MAX_CONNECTIONS];
+    datagram_t datagrams[MAX_DATAGRAMS_IN_FLIGHT];
+} g_link;
+
+void link_reset(const link_profile_t *profile) {
+    memset(&g_link, 0, sizeof(g_link));
+    g_link.profile = *profile;
+    // xorshift32 state must not be zero
+    g_link.rng_state = profile->seed ? profile->seed : 1;
+}
+
+uint64_t link_now_us(void) {
+    return g_link.now_us;
+}
+
+void link_advance_us(uint64_t delta_us) {
+    g_link.now_us += delta_us;
+}
+
+uint32_t link_random(void) {
+    uint32_t x = g_link.rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    g_link.rng_state = x;
+    return x;
+}
+
+const link_stats_t *link_stats(void) {
+    return &g_link.stats;
+}
+
+bool link_next_delivery_us(uint64_t *out_time_us) {
+    bool found = false;
+    for (size_t i = 0; i < MAX_DATAGRAMS_IN_FLIGHT; i++) {
+        const datagram_t *dgram = &g_link.datagrams[i];
+        if (dgram->in_use && (!found || dgram->deliver_at_us < *out_time_us)) {
+            *out_time_us = dgram->deliver_at_us;
+            found = true;
+        }
+    }
+    return found;
+}
+
+static void transmit(int conn,
+                     direction_t direction,
+                     const uint8_t *data,
+                     size_t size) {
+    const link_profile_t *profile = &g_link.profile;
+    if (direction == DIRECTION_UP) {
+        g_link.stats.messages_up++;
+        g_link.stats.bytes_up += size;
+    } else {
+        g_link.stats.messages_down++;
+        g_link.stats.bytes_down += size;
+    }
+
+    // the datagram occupies the link even if it gets lost
+    uint64_t airtime_us = 0;
+    if (profile->bitrate_bps) {
+        airtime_us = (uint64_t) (size + profile->overhead_bytes) * 8 * 1000000
+                     / profile->bitrate_bps;
+    }
+    g_link.stats.airtime_us += airtime_us;
+    uint64_t start_us = ANJ_MAX(g_link.now_us, g_link.busy_until_us[direction]);
+    g_link.busy_until_us[direction] = start_us + airtime_us;
+
+    if (link_random() % 1000 < profile->loss_permille) {
+        g_link.stats.lost++;
+        return;
+    }
+    datagram_t *dgram = NULL;
+    for (size_t i = 0; i < MAX_DATAGRAMS_IN_FLIGHT; i++) {
+        if (!g_link.datagrams[i].in_use) {
+            dgram = &g_link.datagrams[i];
+            break;
+        }
+    }
+    if (!dgram || size > sizeof(dgram->data)) {
+        // buffer overflow of the simulated link
+        g_link.stats.lost++;
+        return;
+    }
+    uint64_t jitter_us = 0;
+    if (profile->jitter_ms) {
+        jitter_us = link_random() % ((uint64_t) profile->jitter_ms * 1000);
+    }
+    dgram->in_use = true;
+    dgram->conn = conn;
+    dgram->direction = direction;
+    dgram->seq = g_link.next_seq++;
+    dgram->deliver_at_us = g_link.busy_until_us[direction]
+                           + (uint64_t) profile->delay_ms * 1000 + jitter_us;
+    dgram->size = size;
+    memcpy(dgram->data, data, size);
+}
+
+static datagram_t *find_due(direction_t direction, int conn) {
+    datagram_t *found = NULL;
+    for (size_t i = 0; i < MAX_DATAGRAMS_IN_FLIGHT; i++) {
+        datagram_t *dgram = &g_link.datagrams[i];
+        if (!dgram->in_use || dgram->direction != direction
+                || (conn >= 0 && dgram->conn != conn)
+                || dgram->deliver_at_us > g_link.now_us) {
+            continue;
+        }
+        if (!found || dgram->deliver_at_us < found->deliver_at_us
+                || (dgram->deliver_at_us == found->deliver_at_us
+                    && dgram->seq < found->seq)) {
+            found = dgram;
+        }
+    }
+    return found;
+}
+
+bool link_server_recv(int *out_conn,
+                      uint8_t *buf,
+                      size_t buf_size,
+                      size_t *out_size) {
+    datagram_t *dgram;
+    while ((dgram = find_due(DIRECTION_UP, -1))) {
+        dgram->in_use = false;
+        // datagrams sent before the connection was closed are dropped
+        if (!g_link.conns[dgram->conn].in_use) {
+            continue;
+        }
+        *out_conn = dgram->conn;
+        *out_size = ANJ_MIN(dgram->size, buf_size);
+        memcpy(buf, dgram->data, *out_size);
+        return true;
+    }
+    return false;
+}
+
+void link_server_send(int conn, const uint8_t *data, size_t size) {
+    if (conn >= 0 && conn < LINK_MAX_CONNECTIONS && g_link.conns[conn].in_use) {
+        transmit(conn, DIRECTION_DOWN, data, size);
+    }
+}
+
+const char *link_conn_hostname(int conn) {
+    if (conn < 0 || conn >= LINK_MAX_CONNECTIONS
+            || !g_link.conns[conn].in_use) {
+        return NULL;
+    }
+    return g_link.conns[conn].hostname;
+}
+
+static int conn_index(anj_net_ctx_t *ctx) {
+    return (int) ((link_conn_t *) ctx - g_link.conns);
+}
+
+int anj_udp_create_ctx(anj_net_ctx_t **ctx, const anj_net_config_t *config) {
+    (void) config;
+    for (size_t i = 0; i < LINK_MAX_CONNECTIONS; i++) {
+        link_conn_t *conn = &g_link.conns[i];
+        if (!conn->in_use) {
+            memset(conn, 0, sizeof(*conn));
+            conn->in_use = true;
+            conn->state = ANJ_NET_SOCKET_STATE_CLOSED;
+            *ctx = (anj_net_ctx_t *) conn;
+            return ANJ_NET_OK;
+        }
+    }
+    return -1;
+}
+
+int anj_udp_connect(anj_net_ctx_t *ctx,
+                    const char *hostname,
+                    const char *port) {
+    (void) port;
+    link_conn_t *conn = (link_conn_t *) ctx;
+    if (strlen(hostname) >= sizeof(conn->hostname)) {
+        return -1;
+    }
+    strcpy(conn->hostname, hostname);
+    conn->state = ANJ_NET_SOCKET_STATE_CONNECTED;
+    return ANJ_NET_OK;
+}
+
+int anj_udp_send(anj_net_ctx_t *ctx,
+                 size_t *bytes_sent,
+                 const uint8_t *buf,
+                 size_t length) {
+    link_conn_t *conn = (link_conn_t *) ctx;
+    if (conn->state != ANJ_NET_SOCKET_STATE_CONNECTED) {
+        return -1;
+    }
+    transmit(conn_index(ctx), DIRECTION_UP, buf, length);
+    *bytes_sent = length;
+    return ANJ_NET_OK;
+}
+
+int anj_udp_recv(anj_net_ctx_t *ctx,
+                 size_t *bytes_received,
+                 uint8_t *buf,
+                 size_t length) {
+    datagram_t *dgram = find_due(DIRECTION_DOWN, conn_index(ctx));
+    if (!dgram) {
+        return ANJ_NET_EAGAIN;
+    }
+    dgram->in_use = false;
+    if (dgram->size > length) {
+        return ANJ_NET_EMSGSIZE;
+    }
+    memcpy(buf, dgram->data, dgram->size);
+    *bytes_received = dgram->size;
+    return ANJ_NET_OK;
+}
+
+int anj_udp_close(anj_net_ctx_t *ctx) {
+    ((link_conn_t *) ctx)->state = ANJ_NET_SOCKET_STATE_CLOSED;
+    return ANJ_NET_OK;
+}
+
+int anj_udp_cleanup_ctx(anj_net_ctx_t **ctx) {
+    link_conn_t *conn = (link_conn_t *) *ctx;
+    conn->in_use = false;
+    conn->state = ANJ_NET_SOCKET_STATE_CLOSED;
+    *ctx = NULL;
+    return ANJ_NET_OK;
+}
+
+int anj_udp_get_state(anj_net_ctx_t *ctx, anj_net_socket_state_t *out_value) {
+    *out_value = ((link_conn_t *) ctx)->state;
+    return ANJ_NET_OK;
+}
+
+int anj_udp_get_inner_mtu(anj_net_ctx_t *ctx, int32_t *out_value) {
+    (void) ctx;
+    *out_value = INNER_MTU;
+    return ANJ_NET_OK;
+}
+
+int anj_udp_queue_mode_rx_off(anj_net_ctx_t *ctx) {
+    (void) ctx;
+    return ANJ_NET_OK;
+}
+
+anj_time_monotonic_t anj_time_monotonic_now(void) {
+    return anj_time_monotonic_new((int64_t) g_link.now_us, ANJ_TIME_UNIT_US);
+}
+
+anj_time_real_t anj_time_real_now(void) {
+    return anj_time_real_add(
+            anj_time_real_new(REAL_TIME_BASE_S, ANJ_TIME_UNIT_S),
+            anj_time_duration_new((int64_t) g_link.now_us, ANJ_TIME_UNIT_US));
+}
+
+int anj_rng_generate(uint8_t *buffer, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        buffer[i] = (uint8_t) link_random();
+    }
+    return 0;
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef LINK_H
+#define LINK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Simulated datagram link between the client and the scripted servers. It
+// also provides the virtual clock and the RNG used by the library, so that
+// every run with the same profile gives the same results.
+
+#define LINK_MAX_CONNECTIONS 2
+#define LINK_MAX_DATAGRAM_SIZE 1280
+
+typedef struct {
+    const char *name;
+    // one-way propagation delay
+    uint32_t delay_ms;
+    // uniformly distributed extra delay, datagrams may overtake each other
+    uint32_t jitter_ms;
+    // probability of losing a datagram in each direction, in 1/1000
+    uint32_t loss_permille;
+    // link rate used to compute airtime, 0 means infinite
+    uint32_t bitrate_bps;
+    // lower layer overhead added to every datagram when computing airtime
+    uint32_t overhead_bytes;
+    uint32_t seed;
+} link_profile_t;
+
+typedef struct {
+    uint32_t messages_up;
+    uint32_t messages_down;
+    uint64_t bytes_up;
+    uint64_t bytes_down;
+    uint32_t lost;
+    uint64_t airtime_us;
+} link_stats_t;
+
+void link_reset(const link_profile_t *profile);
+
+uint64_t link_now_us(void);
+void link_advance_us(uint64_t delta_us);
+// returns false if no datagram is in flight
+bool link_next_delivery_us(uint64_t *out_time_us);
+
+uint32_t link_random(void);
+
+const link_stats_t *link_stats(void);
+
+// server side of the link, connections are identified by their index
+bool link_server_recv(int *out_conn,
+                      uint8_t *buf,
+                      size_t buf_size,
+                      size_t *out_size);
+void link_server_send(int conn, const uint8_t *data, size_t size);
+// returns NULL if the connection is not in use
+const char *link_conn_hostname(int conn);
+
+#endif // LINK_H
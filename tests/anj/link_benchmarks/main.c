@@ -0,0 +1,582 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <anj/coap_downloader.h>
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/dm/core.h>
+#include <anj/dm/device_object.h>
+#include <anj/dm/fw_update.h>
+#include <anj/dm/security_object.h>
+#include <anj/dm/server_object.h>
+#include <anj/lwm2m_send.h>
+#include <anj/metrics.h>
+#include <anj/time.h>
+#include <anj/utils.h>
+
+#include "link.h"
+#include "objects.h"
+#include "server.h"
+
+// End-to-end benchmark of the client talking to a scripted LwM2M Server over
+// a simulated link. Time is virtual, so the scenarios spanning minutes of
+// link time take milliseconds to run and the results only depend on the
+// link profile, except for the CPU time.
+
+#define US_PER_MS 1000
+#define US_PER_S 1000000
+
+// time advanced in a single iteration if nothing happens earlier
+#define TICK_US (10 * US_PER_MS)
+// iterations without advancing the time before a tick is forced
+#define MAX_IDLE_ITERATIONS 100
+
+#define OBSERVE_ROUNDS 10
+#define OBSERVE_INTERVAL_S 30
+#define SEND_BURST_SIZE 8
+#define SEND_RECORDS_PER_REQUEST 4
+
+#define CONTENT_FORMAT_PLAINTEXT 0
+#define CONTENT_FORMAT_OCTET_STREAM 42
+
+#define FW_URI "coap://" FW_SERVER_HOSTNAME ":5683/fw.bin"
+
+static const link_profile_t PROFILES[] = {
+    {
+        .name = "ideal",
+        .seed = 1
+    },
+    {
+        // NB-IoT like link: long latency, low rate, occasional loss
+        .name = "nbiot",
+        .delay_ms = 400,
+        .jitter_ms = 200,
+        .loss_permille = 10,
+        .bitrate_bps = 20000,
+        .overhead_bytes = 30,
+        .seed = 2
+    },
+    {
+        // heavy loss and jitter large enough to reorder datagrams
+        .name = "lossy",
+        .delay_ms = 300,
+        .jitter_ms = 900,
+        .loss_permille = 100,
+        .bitrate_bps = 50000,
+        .overhead_bytes = 30,
+        .seed = 3
+    }
+};
+
+typedef struct bench_struct bench_t;
+
+typedef struct {
+    const char *name;
+    // scenario specific parameter, e.g. block size, reported in the results
+    unsigned param;
+    // called in every iteration once the client is registered
+    void (*step)(bench_t *bench);
+    uint32_t timeout_s;
+} scenario_t;
+
+struct bench_struct {
+    anj_t anj;
+    anj_dm_security_obj_t security_obj;
+    anj_dm_server_obj_t server_obj;
+    anj_dm_device_obj_t device_obj;
+    anj_dm_fw_update_entity_ctx_t fw_entity;
+    anj_coap_downloader_t downloader;
+    server_t server;
+    const scenario_t *scenario;
+    anj_conn_status_t conn_status;
+
+    // scenario progress
+    bool started;
+    bool finished;
+    bool completed;
+    uint32_t items;
+    uint32_t items_expected;
+    uint32_t failures;
+    uint64_t finished_at_us;
+
+    // scenario state
+    unsigned index;
+    uint64_t next_action_us;
+    uint64_t bytes;
+    anj_io_out_entry_t records[SEND_BURST_SIZE][SEND_RECORDS_PER_REQUEST];
+    // not copied by anj_send_new_request(), must outlive the operation
+    anj_send_request_t send_requests[SEND_BURST_SIZE];
+};
+
+static bench_t g_bench;
+
+static void finish(bench_t *bench, bool completed) {
+    if (!bench->finished) {
+        bench->finished = true;
+        bench->completed = completed;
+        bench->finished_at_us = link_now_us();
+    }
+}
+
+static void conn_status_cb(void *arg, anj_t *anj, anj_conn_status_t status) {
+    (void) anj;
+    ((bench_t *) arg)->conn_status = status;
+}
+
+static void scenario_register(bench_t *bench) {
+    bench->items = 1;
+    bench->items_expected = 1;
+    finish(bench, true);
+}
+
+static void observe_next(bench_t *bench);
+
+static void observe_response(server_t *server,
+                             const coap_msg_t *response,
+                             void *arg) {
+    (void) server;
+    bench_t *bench = (bench_t *) arg;
+    if (!response) {
+        // give up on this one and try again
+        bench->failures++;
+    } else if (response->code == COAP_CODE_CONTENT) {
+        bench->index++;
+    } else {
+        finish(bench, false);
+        return;
+    }
+    observe_next(bench);
+}
+
+static void observe_next(bench_t *bench) {
+    if (bench->index == SENSOR_RESOURCES_COUNT) {
+        bench->next_action_us = link_now_us();
+        return;
+    }
+    coap_msg_t request;
+    coap_msg_init(&request);
+    request.code = COAP_CODE_GET;
+    request.has_observe = true;
+    request.observe = 0;
+    snprintf(request.uri_path, sizeof(request.uri_path), "%d/0/%u",
+             SENSOR_OID, bench->index);
+    if (server_request(&bench->server, &request, observe_response, bench)) {
+        finish(bench, false);
+    }
+}
+
+static void scenario_observe(bench_t *bench) {
+    if (!bench->started) {
+        bench->started = true;
+        bench->items_expected = SENSOR_RESOURCES_COUNT * OBSERVE_ROUNDS;
+        bench->next_action_us = UINT64_MAX;
+        observe_next(bench);
+        return;
+    }
+    bench->items = bench->server.notifications;
+    if (bench->items >= bench->items_expected) {
+        finish(bench, true);
+        return;
+    }
+    if (link_now_us() < bench->next_action_us) {
+        return;
+    }
+    if (bench->index == SENSOR_RESOURCES_COUNT + OBSERVE_ROUNDS) {
+        // lost notifications are never retransmitted, stop after a while
+        finish(bench, false);
+        return;
+    }
+    for (anj_rid_t rid = 0; rid < SENSOR_RESOURCES_COUNT; rid++) {
+        sensor_obj_set_value(rid, (double) bench->index + rid / 10.0);
+        anj_core_data_model_changed(&bench->anj,
+                                    &ANJ_MAKE_RESOURCE_PATH(SENSOR_OID, 0, rid),
+                                    ANJ_CORE_CHANGE_TYPE_VALUE_CHANGED);
+    }
+    bench->index++;
+    bench->next_action_us = link_now_us() + OBSERVE_INTERVAL_S * US_PER_S;
+}
+
+static void send_finished(anj_t *anj, uint16_t send_id, int result, void *arg) {
+    (void) anj;
+    (void) send_id;
+    bench_t *bench = (bench_t *) arg;
+    if (result == ANJ_SEND_SUCCESS) {
+        bench->items++;
+    } else {
+        bench->failures++;
+    }
+    if (bench->items + bench->failures == bench->items_expected) {
+        finish(bench, bench->items == bench->items_expected);
+    }
+}
+
+static void scenario_send_burst(bench_t *bench) {
+    if (bench->started) {
+        return;
+    }
+    bench->started = true;
+    bench->items_expected = SEND_BURST_SIZE;
+    for (size_t i = 0; i < SEND_BURST_SIZE; i++) {
+        for (anj_rid_t rid = 0; rid < SEND_RECORDS_PER_REQUEST; rid++) {
+            anj_io_out_entry_t *record = &bench->records[i][rid];
+            record->path = ANJ_MAKE_RESOURCE_PATH(SENSOR_OID, 0, rid);
+            record->type = ANJ_DATA_TYPE_DOUBLE;
+            record->value.double_value = (double) i + rid / 10.0;
+            record->timestamp = (double) (1700000000 + i);
+        }
+        anj_send_request_t *request = &bench->send_requests[i];
+        *request = (anj_send_request_t) {
+            .records = bench->records[i],
+            .records_cnt = SEND_RECORDS_PER_REQUEST,
+            .finished_handler = send_finished,
+            .data = bench,
+            .content_format = ANJ_SEND_CONTENT_FORMAT_SENML_CBOR
+        };
+        uint16_t send_id;
+        if (anj_send_new_request(&bench->anj, request, &send_id)) {
+            finish(bench, false);
+            return;
+        }
+    }
+}
+
+static uint8_t block_szx(unsigned block_size) {
+    uint8_t szx = 0;
+    while ((16u << szx) < block_size) {
+        szx++;
+    }
+    return szx;
+}
+
+static void block_read_next(bench_t *bench);
+
+static void block_read_response(server_t *server,
+                                const coap_msg_t *response,
+                                void *arg) {
+    (void) server;
+    bench_t *bench = (bench_t *) arg;
+    if (!response) {
+        // request the same block again
+        bench->failures++;
+        block_read_next(bench);
+        return;
+    }
+    if (response->code != COAP_CODE_CONTENT) {
+        finish(bench, false);
+        return;
+    }
+    bench->items++;
+    bench->bytes += response->payload_size;
+    if (response->has_block2 && response->block2_more) {
+        bench->index = response->block2_num + 1;
+        block_read_next(bench);
+    } else {
+        finish(bench, bench->bytes == BLOB_SIZE);
+    }
+}
+
+static void block_read_next(bench_t *bench) {
+    coap_msg_t request;
+    coap_msg_init(&request);
+    request.code = COAP_CODE_GET;
+    request.accept = CONTENT_FORMAT_OCTET_STREAM;
+    snprintf(request.uri_path, sizeof(request.uri_path), "%d/0/0", BLOB_OID);
+    request.has_block2 = true;
+    request.block2_num = bench->index;
+    request.block2_szx = block_szx(bench->scenario->param);
+    if (server_request(&bench->server, &request, block_read_response, bench)) {
+        finish(bench, false);
+    }
+}
+
+static void scenario_block_read(bench_t *bench) {
+    if (bench->started) {
+        return;
+    }
+    bench->started = true;
+    bench->items_expected = (uint32_t) ((BLOB_SIZE + bench->scenario->param - 1)
+                                        / bench->scenario->param);
+    block_read_next(bench);
+}
+
+static void fota_write_uri(bench_t *bench);
+
+static void fota_write_response(server_t *server,
+                                const coap_msg_t *response,
+                                void *arg) {
+    (void) server;
+    bench_t *bench = (bench_t *) arg;
+    if (!response) {
+        bench->failures++;
+        fota_write_uri(bench);
+    } else if (response->code != COAP_CODE_CHANGED) {
+        finish(bench, false);
+    }
+}
+
+static void fota_write_uri(bench_t *bench) {
+    static const char uri[] = FW_URI;
+    coap_msg_t request;
+    coap_msg_init(&request);
+    request.code = COAP_CODE_PUT;
+    request.content_format = CONTENT_FORMAT_PLAINTEXT;
+    strcpy(request.uri_path, "5/0/1");
+    request.payload = (const uint8_t *) uri;
+    request.payload_size = sizeof(uri) - 1;
+    if (server_request(&bench->server, &request, fota_write_response, bench)) {
+        finish(bench, false);
+    }
+}
+
+static void scenario_fota_pull(bench_t *bench) {
+    if (bench->started) {
+        return;
+    }
+    bench->started = true;
+    bench->items_expected = (uint32_t) ((BLOB_SIZE + bench->scenario->param - 1)
+                                        / bench->scenario->param);
+    bench->server.fw_image = blob_data();
+    bench->server.fw_image_size = BLOB_SIZE;
+    bench->server.fw_block_szx = block_szx(bench->scenario->param);
+    fota_write_uri(bench);
+}
+
+static anj_dm_fw_update_result_t fw_uri_write(void *user_ptr,
+                                              const char *uri) {
+    bench_t *bench = (bench_t *) user_ptr;
+    if (anj_coap_downloader_start(&bench->downloader, uri, NULL)) {
+        return ANJ_DM_FW_UPDATE_RESULT_FAILED;
+    }
+    return ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+}
+
+static int fw_update_start(void *user_ptr) {
+    (void) user_ptr;
+    return 0;
+}
+
+static void fw_reset(void *user_ptr) {
+    bench_t *bench = (bench_t *) user_ptr;
+    anj_coap_downloader_terminate(&bench->downloader);
+}
+
+static const char *fw_get_version(void *user_ptr) {
+    (void) user_ptr;
+    return "1.0";
+}
+
+static anj_dm_fw_update_handlers_t FW_HANDLERS = {
+    .uri_write_handler = fw_uri_write,
+    .update_start_handler = fw_update_start,
+    .get_version = fw_get_version,
+    .reset_handler = fw_reset
+};
+
+static void downloader_event(void *arg,
+                             anj_coap_downloader_t *downloader,
+                             anj_coap_downloader_status_t status,
+                             const uint8_t *data,
+                             size_t data_len) {
+    (void) downloader;
+    bench_t *bench = (bench_t *) arg;
+    switch (status) {
+    case ANJ_COAP_DOWNLOADER_STATUS_DOWNLOADING:
+        if (memcmp(data, &blob_data()[bench->bytes], data_len)) {
+            finish(bench, false);
+        }
+        bench->items++;
+        bench->bytes += data_len;
+        break;
+    case ANJ_COAP_DOWNLOADER_STATUS_FINISHED:
+        anj_dm_fw_update_object_set_download_result(
+                &bench->anj, &bench->fw_entity,
+                ANJ_DM_FW_UPDATE_RESULT_SUCCESS);
+        finish(bench, bench->bytes == BLOB_SIZE);
+        break;
+    case ANJ_COAP_DOWNLOADER_STATUS_FAILED:
+        anj_dm_fw_update_object_set_download_result(
+                &bench->anj, &bench->fw_entity,
+                ANJ_DM_FW_UPDATE_RESULT_FAILED);
+        finish(bench, false);
+        break;
+    default:
+        break;
+    }
+}
+
+static const scenario_t SCENARIOS[] = {
+    { "register", 0, scenario_register, 600 },
+    { "observe", SENSOR_RESOURCES_COUNT, scenario_observe, 1200 },
+    { "send_burst", SEND_BURST_SIZE, scenario_send_burst, 600 },
+    { "block_read", 512, scenario_block_read, 3600 },
+    { "block_read", 1024, scenario_block_read, 3600 },
+    { "fota_pull", 512, scenario_fota_pull, 3600 },
+    { "fota_pull", 1024, scenario_fota_pull, 3600 }
+};
+
+static int client_init(bench_t *bench) {
+    anj_configuration_t config = {
+        .endpoint_name = "link-benchmark",
+        .connection_status_cb = conn_status_cb,
+        .connection_status_cb_arg = bench
+    };
+    if (anj_core_init(&bench->anj, &config)) {
+        return -1;
+    }
+
+    anj_dm_security_instance_init_t security_inst = {
+        .ssid = 1,
+        .server_uri = "coap://" SERVER_HOSTNAME ":5683",
+        .security_mode = ANJ_DM_SECURITY_NOSEC
+    };
+    anj_dm_security_obj_init(&bench->security_obj);
+    anj_dm_server_instance_init_t server_inst = {
+        .ssid = 1,
+        .lifetime = 3600,
+        .binding = "U",
+        .bootstrap_on_registration_failure = &(bool) { false }
+    };
+    anj_dm_server_obj_init(&bench->server_obj);
+    anj_dm_device_object_init_t device_init = {
+        .firmware_version = "1.0"
+    };
+    anj_coap_downloader_configuration_t downloader_config = {
+        .event_cb = downloader_event,
+        .event_cb_arg = bench
+    };
+    if (anj_dm_security_obj_add_instance(&bench->security_obj, &security_inst)
+            || anj_dm_security_obj_install(&bench->anj, &bench->security_obj)
+            || anj_dm_server_obj_add_instance(&bench->server_obj, &server_inst)
+            || anj_dm_server_obj_install(&bench->anj, &bench->server_obj)
+            || anj_dm_device_obj_install(&bench->anj, &bench->device_obj,
+                                         &device_init)
+            || anj_dm_fw_update_object_install(&bench->anj, &bench->fw_entity,
+                                               &FW_HANDLERS, bench)
+            || anj_dm_add_obj(&bench->anj, sensor_obj())
+            || anj_dm_add_obj(&bench->anj, blob_obj())
+            || anj_coap_downloader_init(&bench->downloader,
+                                        &downloader_config)) {
+        return -1;
+    }
+    return 0;
+}
+
+static uint64_t cpu_time_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (uint64_t) ts.tv_sec * US_PER_S + (uint64_t) ts.tv_nsec / 1000;
+}
+
+static void advance_time(bench_t *bench, unsigned *idle_iterations) {
+    uint64_t now = link_now_us();
+    uint64_t target = now + TICK_US;
+    uint64_t event;
+    if (link_next_delivery_us(&event) && event < target) {
+        target = event;
+    }
+    if (server_next_timer_us(&bench->server, &event) && event < target) {
+        target = event;
+    }
+    if (bench->next_action_us > now && bench->next_action_us < target) {
+        target = bench->next_action_us;
+    }
+    if (target <= now) {
+        // something is due now, let the client and the server handle it
+        if (++*idle_iterations < MAX_IDLE_ITERATIONS) {
+            return;
+        }
+        target = now + TICK_US;
+    }
+    *idle_iterations = 0;
+    link_advance_us(target - now);
+}
+
+static void print_result(bench_t *bench,
+                         const link_profile_t *profile,
+                         uint64_t cpu_us) {
+    const link_stats_t *stats = link_stats();
+    anj_metrics_t metrics;
+    anj_core_metrics_get(&bench->anj, &metrics);
+    printf("{\"scenario\":\"%s\",\"param\":%u,\"profile\":\"%s\","
+           "\"completed\":%s,\"items\":%" PRIu32 ",\"items_expected\":%" PRIu32
+           ",\"virtual_time_ms\":%" PRIu64 ",\"messages_up\":%" PRIu32
+           ",\"messages_down\":%" PRIu32 ",\"bytes_up\":%" PRIu64
+           ",\"bytes_down\":%" PRIu64 ",\"lost\":%" PRIu32
+           ",\"airtime_ms\":%" PRIu64 ",\"client_retransmissions\":%" PRIu32
+           ",\"server_retransmissions\":%" PRIu32 ",\"cpu_time_us\":%" PRIu64
+           "}\n",
+           bench->scenario->name, bench->scenario->param, profile->name,
+           bench->completed ? "true" : "false", bench->items,
+           bench->items_expected, bench->finished_at_us / US_PER_MS,
+           stats->messages_up, stats->messages_down, stats->bytes_up,
+           stats->bytes_down, stats->lost, stats->airtime_us / US_PER_MS,
+           metrics.retransmissions, bench->server.retransmissions, cpu_us);
+}
+
+static int run(const scenario_t *scenario, const link_profile_t *profile) {
+    bench_t *bench = &g_bench;
+    memset(bench, 0, sizeof(*bench));
+    bench->scenario = scenario;
+    link_reset(profile);
+    objects_init();
+    server_init(&bench->server);
+    if (client_init(bench)) {
+        fprintf(stderr, "client initialization failed\n");
+        return -1;
+    }
+
+    uint64_t deadline_us = (uint64_t) scenario->timeout_s * US_PER_S;
+    unsigned idle_iterations = 0;
+    uint64_t cpu_start_us = cpu_time_us();
+    while (!bench->finished && link_now_us() < deadline_us) {
+        anj_core_step(&bench->anj);
+        anj_coap_downloader_step(&bench->downloader);
+        server_step(&bench->server);
+        if (bench->conn_status == ANJ_CONN_STATUS_REGISTERED
+                && bench->server.registered) {
+            scenario->step(bench);
+        }
+        advance_time(bench, &idle_iterations);
+    }
+    if (!bench->finished) {
+        finish(bench, false);
+    }
+    uint64_t cpu_us = cpu_time_us() - cpu_start_us;
+
+    print_result(bench, profile, cpu_us);
+    anj_coap_downloader_terminate(&bench->downloader);
+    while (anj_core_shutdown(&bench->anj) == ANJ_NET_EAGAIN) {
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    const char *filter = argc > 1 ? argv[1] : NULL;
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(SCENARIOS); i++) {
+        if (filter && !strstr(SCENARIOS[i].name, filter)) {
+            continue;
+        }
+        for (size_t j = 0; j < ANJ_ARRAY_SIZE(PROFILES); j++) {
+            if (run(&SCENARIOS[i], &PROFILES[j])) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <anj/defs.h>
+#include <anj/dm/core.h>
+#include <anj/dm/defs.h>
+
+#include "objects.h"
+
+static double g_sensor_values[SENSOR_RESOURCES_COUNT];
+
+static int sensor_res_read(anj_t *anj,
+                           const anj_dm_obj_t *obj,
+                           anj_iid_t iid,
+                           anj_rid_t rid,
+                           anj_riid_t riid,
+                           anj_res_value_t *out_value) {
+    (void) anj;
+    (void) obj;
+    (void) iid;
+    (void) riid;
+    if (rid >= SENSOR_RESOURCES_COUNT) {
+        return ANJ_DM_ERR_NOT_FOUND;
+    }
+    out_value->double_value = g_sensor_values[rid];
+    return 0;
+}
+
+static const anj_dm_handlers_t SENSOR_HANDLERS = {
+    .res_read = sensor_res_read
+};
+
+#define SENSOR_RES(Rid)               \
+    {                                 \
+        .rid = (Rid),                 \
+        .type = ANJ_DATA_TYPE_DOUBLE, \
+        .kind = ANJ_DM_RES_R          \
+    }
+
+static const anj_dm_res_t SENSOR_RES[SENSOR_RESOURCES_COUNT] = {
+    SENSOR_RES(0), SENSOR_RES(1), SENSOR_RES(2), SENSOR_RES(3),
+    SENSOR_RES(4), SENSOR_RES(5), SENSOR_RES(6), SENSOR_RES(7)
+};
+
+static const anj_dm_obj_inst_t SENSOR_INST = {
+    .iid = 0,
+    .res_count = SENSOR_RESOURCES_COUNT,
+    .resources = SENSOR_RES
+};
+
+static const anj_dm_obj_t SENSOR_OBJ = {
+    .oid = SENSOR_OID,
+    .insts = &SENSOR_INST,
+    .handlers = &SENSOR_HANDLERS,
+    .max_inst_count = 1
+};
+
+const anj_dm_obj_t *sensor_obj(void) {
+    return &SENSOR_OBJ;
+}
+
+void sensor_obj_set_value(anj_rid_t rid, double value) {
+    g_sensor_values[rid] = value;
+}
+
+static uint8_t g_blob[BLOB_SIZE];
+
+static int blob_res_read(anj_t *anj,
+                         const anj_dm_obj_t *obj,
+                         anj_iid_t iid,
+                         anj_rid_t rid,
+                         anj_riid_t riid,
+                         anj_res_value_t *out_value) {
+    (void) anj;
+    (void) obj;
+    (void) iid;
+    (void) riid;
+    if (rid != 0) {
+        return ANJ_DM_ERR_NOT_FOUND;
+    }
+    out_value->bytes_or_string.data = g_blob;
+    out_value->bytes_or_string.chunk_length = sizeof(g_blob);
+    return 0;
+}
+
+static const anj_dm_handlers_t BLOB_HANDLERS = {
+    .res_read = blob_res_read
+};
+
+static const anj_dm_res_t BLOB_RES = {
+    .rid = 0,
+    .type = ANJ_DATA_TYPE_BYTES,
+    .kind = ANJ_DM_RES_R
+};
+
+static const anj_dm_obj_inst_t BLOB_INST = {
+    .iid = 0,
+    .res_count = 1,
+    .resources = &BLOB_RES
+};
+
+static const anj_dm_obj_t BLOB_OBJ = {
+    .oid = BLOB_OID,
+    .insts = &BLOB_INST,
+    .handlers = &BLOB_HANDLERS,
+    .max_inst_count = 1
+};
+
+const anj_dm_obj_t *blob_obj(void) {
+    return &BLOB_OBJ;
+}
+
+const uint8_t *blob_data(void) {
+    return g_blob;
+}
+
+void objects_init(void) {
+    for (anj_rid_t rid = 0; rid < SENSOR_RESOURCES_COUNT; rid++) {
+        g_sensor_values[rid] = 0.0;
+    }
+    for (size_t i = 0; i < sizeof(g_blob); i++) {
+        g_blob[i] = (uint8_t) (i * 7 + 1);
+    }
+}
@@ -0,0 +1,35 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef OBJECTS_H
+#define OBJECTS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <anj/dm/core.h>
+
+// Object with a single Instance of SENSOR_RESOURCES_COUNT readable values
+#define SENSOR_OID 33000
+#define SENSOR_RESOURCES_COUNT 8
+
+// Object with a single Instance with one large Opaque Resource
+#define BLOB_OID 33001
+#define BLOB_SIZE (100 * 1024)
+
+// resets the values of both Objects
+void objects_init(void);
+
+const anj_dm_obj_t *sensor_obj(void);
+void sensor_obj_set_value(anj_rid_t rid, double value);
+
+const anj_dm_obj_t *blob_obj(void);
+const uint8_t *blob_data(void);
+
+#endif // OBJECTS_H
@@ -0,0 +1,525 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/utils.h>
+
+#include "link.h"
+#include "server.h"
+
+#define OPTION_OBSERVE 6
+#define OPTION_LOCATION_PATH 8
+#define OPTION_URI_PATH 11
+#define OPTION_CONTENT_FORMAT 12
+#define OPTION_ACCEPT 17
+#define OPTION_BLOCK2 23
+
+#define PAYLOAD_MARKER 0xFF
+
+// RFC 7252 default transmission parameters
+#define ACK_TIMEOUT_US 2000000
+#define ACK_RANDOM_FACTOR_EXTRA_US 1000000
+#define MAX_RETRANSMIT 4
+
+#define REGISTRATION_LOCATION "rd/1"
+
+void coap_msg_init(coap_msg_t *msg) {
+    memset(msg, 0, sizeof(*msg));
+    msg->content_format = COAP_NO_CONTENT_FORMAT;
+    msg->accept = COAP_NO_CONTENT_FORMAT;
+}
+
+static uint32_t decode_uint(const uint8_t *data, size_t size) {
+    uint32_t value = 0;
+    for (size_t i = 0; i < size; i++) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+static int append_segment(char *path,
+                          size_t path_size,
+                          const uint8_t *segment,
+                          size_t segment_size) {
+    size_t len = strlen(path);
+    size_t separator = len ? 1 : 0;
+    if (len + separator + segment_size >= path_size) {
+        return -1;
+    }
+    if (separator) {
+        path[len++] = '/';
+    }
+    memcpy(&path[len], segment, segment_size);
+    path[len + segment_size] = '\0';
+    return 0;
+}
+
+static int read_option_nibble(const uint8_t **ptr,
+                              const uint8_t *end,
+                              uint32_t nibble,
+                              uint32_t *out_value) {
+    if (nibble < 13) {
+        *out_value = nibble;
+    } else if (nibble == 13) {
+        if (*ptr + 1 > end) {
+            return -1;
+        }
+        *out_value = 13 + **ptr;
+        *ptr += 1;
+    } else if (nibble == 14) {
+        if (*ptr + 2 > end) {
+            return -1;
+        }
+        *out_value = 269 + decode_uint(*ptr, 2);
+        *ptr += 2;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+int coap_msg_parse(const uint8_t *data, size_t size, coap_msg_t *out_msg) {
+    coap_msg_init(out_msg);
+    if (size < 4 || (data[0] >> 6) != 1) {
+        return -1;
+    }
+    out_msg->type = (data[0] >> 4) & 3;
+    out_msg->token_size = data[0] & 0x0F;
+    out_msg->code = data[1];
+    out_msg->msg_id = (uint16_t) decode_uint(&data[2], 2);
+    if (out_msg->token_size > sizeof(out_msg->token)
+            || 4 + out_msg->token_size > size) {
+        return -1;
+    }
+    memcpy(out_msg->token, &data[4], out_msg->token_size);
+
+    const uint8_t *ptr = &data[4 + out_msg->token_size];
+    const uint8_t *end = &data[size];
+    uint32_t number = 0;
+    while (ptr < end && *ptr != PAYLOAD_MARKER) {
+        uint8_t header = *ptr++;
+        uint32_t delta;
+        uint32_t length;
+        if (read_option_nibble(&ptr, end, header >> 4, &delta)
+                || read_option_nibble(&ptr, end, header & 0x0F, &length)
+                || ptr + length > end) {
+            return -1;
+        }
+        number += delta;
+        switch (number) {
+        case OPTION_OBSERVE:
+            out_msg->has_observe = true;
+            out_msg->observe = decode_uint(ptr, length);
+            break;
+        case OPTION_LOCATION_PATH:
+            if (append_segment(out_msg->location_path,
+                               sizeof(out_msg->location_path), ptr, length)) {
+                return -1;
+            }
+            break;
+        case OPTION_URI_PATH:
+            if (append_segment(out_msg->uri_path, sizeof(out_msg->uri_path),
+                               ptr, length)) {
+                return -1;
+            }
+            break;
+        case OPTION_CONTENT_FORMAT:
+            out_msg->content_format = (int) decode_uint(ptr, length);
+            break;
+        case OPTION_ACCEPT:
+            out_msg->accept = (int) decode_uint(ptr, length);
+            break;
+        case OPTION_BLOCK2: {
+            uint32_t value = decode_uint(ptr, length);
+            out_msg->has_block2 = true;
+            out_msg->block2_num = value >> 4;
+            out_msg->block2_more = !!(value & 0x08);
+            out_msg->block2_szx = (uint8_t) (value & 0x07);
+            break;
+        }
+        default:
+            // other options do not matter for the scenarios
+            break;
+        }
+        ptr += length;
+    }
+    if (ptr < end) {
+        // skip payload marker
+        ptr++;
+        out_msg->payload = ptr;
+        out_msg->payload_size = (size_t) (end - ptr);
+    }
+    return 0;
+}
+
+typedef struct {
+    uint8_t *out;
+    size_t out_size;
+    size_t size;
+    uint32_t last_number;
+    bool overflow;
+} builder_t;
+
+static void put_bytes(builder_t *builder, const void *data, size_t size) {
+    if (builder->size + size > builder->out_size) {
+        builder->overflow = true;
+        return;
+    }
+    memcpy(&builder->out[builder->size], data, size);
+    builder->size += size;
+}
+
+static void put_byte(builder_t *builder, uint8_t byte) {
+    put_bytes(builder, &byte, 1);
+}
+
+static void put_option(builder_t *builder,
+                       uint32_t number,
+                       const void *value,
+                       size_t length) {
+    // short options only, long enough for everything the server sends
+    uint32_t delta = number - builder->last_number;
+    ANJ_ASSERT(delta < 13 + 256 && length < 13 + 256, "option too long");
+    uint8_t delta_nibble = (uint8_t) (delta < 13 ? delta : 13);
+    uint8_t length_nibble = (uint8_t) (length < 13 ? length : 13);
+    put_byte(builder, (uint8_t) ((delta_nibble << 4) | length_nibble));
+    if (delta >= 13) {
+        put_byte(builder, (uint8_t) (delta - 13));
+    }
+    if (length >= 13) {
+        put_byte(builder, (uint8_t) (length - 13));
+    }
+    put_bytes(builder, value, length);
+    builder->last_number = number;
+}
+
+static void put_uint_option(builder_t *builder,
+                            uint32_t number,
+                            uint32_t value) {
+    uint8_t bytes[4];
+    size_t length = 0;
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        if (length || (value >> shift) & 0xFF) {
+            bytes[length++] = (uint8_t) (value >> shift);
+        }
+    }
+    put_option(builder, number, bytes, length);
+}
+
+static void put_path_options(builder_t *builder,
+                             uint32_t number,
+                             const char *path) {
+    while (*path) {
+        const char *separator = strchr(path, '/');
+        size_t length = separator ? (size_t) (separator - path) : strlen(path);
+        put_option(builder, number, path, length);
+        path += length;
+        if (*path == '/') {
+            path++;
+        }
+    }
+}
+
+int coap_msg_build(const coap_msg_t *msg,
+                   uint8_t *out,
+                   size_t out_size,
+                   size_t *out_msg_size) {
+    builder_t builder = {
+        .out = out,
+        .out_size = out_size
+    };
+    put_byte(&builder,
+             (uint8_t) (0x40 | (msg->type << 4) | (uint8_t) msg->token_size));
+    put_byte(&builder, msg->code);
+    put_byte(&builder, (uint8_t) (msg->msg_id >> 8));
+    put_byte(&builder, (uint8_t) msg->msg_id);
+    put_bytes(&builder, msg->token, msg->token_size);
+    if (msg->has_observe) {
+        put_uint_option(&builder, OPTION_OBSERVE, msg->observe);
+    }
+    put_path_options(&builder, OPTION_LOCATION_PATH, msg->location_path);
+    put_path_options(&builder, OPTION_URI_PATH, msg->uri_path);
+    if (msg->content_format != COAP_NO_CONTENT_FORMAT) {
+        put_uint_option(&builder, OPTION_CONTENT_FORMAT,
+                        (uint32_t) msg->content_format);
+    }
+    if (msg->accept != COAP_NO_CONTENT_FORMAT) {
+        put_uint_option(&builder, OPTION_ACCEPT, (uint32_t) msg->accept);
+    }
+    if (msg->has_block2) {
+        put_uint_option(&builder, OPTION_BLOCK2,
+                        (msg->block2_num << 4)
+                                | (msg->block2_more ? 0x08u : 0)
+                                | msg->block2_szx);
+    }
+    if (msg->payload_size) {
+        put_byte(&builder, PAYLOAD_MARKER);
+        put_bytes(&builder, msg->payload, msg->payload_size);
+    }
+    if (builder.overflow) {
+        return -1;
+    }
+    *out_msg_size = builder.size;
+    return 0;
+}
+
+static void send_msg(int conn, const coap_msg_t *msg) {
+    uint8_t buf[LINK_MAX_DATAGRAM_SIZE];
+    size_t size;
+    if (!coap_msg_build(msg, buf, sizeof(buf), &size)) {
+        link_server_send(conn, buf, size);
+    }
+}
+
+// prepares a piggybacked response, or a NON one for a NON request
+static void response_init(server_t *server,
+                          coap_msg_t *response,
+                          const coap_msg_t *request,
+                          uint8_t code) {
+    coap_msg_init(response);
+    if (request->type == COAP_TYPE_CON) {
+        response->type = COAP_TYPE_ACK;
+        response->msg_id = request->msg_id;
+    } else {
+        response->type = COAP_TYPE_NON;
+        response->msg_id = server->next_msg_id++;
+    }
+    response->code = code;
+    response->token_size = request->token_size;
+    memcpy(response->token, request->token, request->token_size);
+}
+
+static void send_empty(int conn, uint8_t type, uint16_t msg_id) {
+    coap_msg_t msg;
+    coap_msg_init(&msg);
+    msg.type = type;
+    msg.code = COAP_CODE_EMPTY;
+    msg.msg_id = msg_id;
+    send_msg(conn, &msg);
+}
+
+// returns true if the message was not processed before
+static bool mark_seen(server_t *server, uint16_t msg_id) {
+    for (size_t i = 0; i < server->seen_msg_ids_count; i++) {
+        if (server->seen_msg_ids[i] == msg_id) {
+            return false;
+        }
+    }
+    server->seen_msg_ids[server->seen_msg_ids_next] = msg_id;
+    server->seen_msg_ids_next =
+            (server->seen_msg_ids_next + 1) % SERVER_SEEN_MSG_IDS;
+    if (server->seen_msg_ids_count < SERVER_SEEN_MSG_IDS) {
+        server->seen_msg_ids_count++;
+    }
+    return true;
+}
+
+void server_init(server_t *server) {
+    memset(server, 0, sizeof(*server));
+    server->conn = -1;
+    server->next_msg_id = (uint16_t) link_random();
+    server->next_token = link_random();
+}
+
+static void finish_request(server_t *server, const coap_msg_t *response) {
+    server_response_handler_t *handler = server->handler;
+    server->request_pending = false;
+    server->handler = NULL;
+    if (!response) {
+        server->request_timeouts++;
+    }
+    if (handler) {
+        // the handler may already start the next request
+        handler(server, response, server->handler_arg);
+    }
+}
+
+int server_request(server_t *server,
+                   coap_msg_t *request,
+                   server_response_handler_t *handler,
+                   void *arg) {
+    if (server->request_pending || server->conn < 0) {
+        return -1;
+    }
+    request->type = COAP_TYPE_CON;
+    request->msg_id = server->next_msg_id++;
+    request->token_size = sizeof(request->token);
+    uint32_t token = server->next_token++;
+    memset(request->token, 0, sizeof(request->token));
+    memcpy(request->token, &token, sizeof(token));
+    if (coap_msg_build(request, server->request, sizeof(server->request),
+                       &server->request_size)) {
+        return -1;
+    }
+    server->request_pending = true;
+    server->request_msg_id = request->msg_id;
+    memcpy(server->request_token, request->token, sizeof(request->token));
+    server->request_retransmissions = 0;
+    server->retransmit_timeout_us =
+            ACK_TIMEOUT_US + link_random() % ACK_RANDOM_FACTOR_EXTRA_US;
+    server->retransmit_at_us = link_now_us() + server->retransmit_timeout_us;
+    server->handler = handler;
+    server->handler_arg = arg;
+    link_server_send(server->conn, server->request, server->request_size);
+    return 0;
+}
+
+static bool matches_request(const server_t *server, const coap_msg_t *msg) {
+    return server->request_pending && msg->token_size == 8
+           && !memcmp(msg->token, server->request_token, 8);
+}
+
+static void handle_client_request(server_t *server,
+                                  int conn,
+                                  const coap_msg_t *msg) {
+    bool is_new = mark_seen(server, msg->msg_id);
+    coap_msg_t response;
+    if (msg->code == COAP_CODE_POST && !strcmp(msg->uri_path, "rd")) {
+        response_init(server, &response, msg, COAP_CODE_CREATED);
+        strcpy(response.location_path, REGISTRATION_LOCATION);
+        server->conn = conn;
+        server->registered = true;
+        server->registrations += is_new;
+    } else if (msg->code == COAP_CODE_POST
+               && !strcmp(msg->uri_path, REGISTRATION_LOCATION)) {
+        response_init(server, &response, msg, COAP_CODE_CHANGED);
+        server->updates += is_new;
+    } else if (msg->code == COAP_CODE_DELETE
+               && !strcmp(msg->uri_path, REGISTRATION_LOCATION)) {
+        response_init(server, &response, msg, COAP_CODE_DELETED);
+        server->registered = false;
+    } else if (msg->code == COAP_CODE_POST && !strcmp(msg->uri_path, "dp")) {
+        response_init(server, &response, msg, COAP_CODE_CHANGED);
+        server->sends += is_new;
+    } else {
+        response_init(server, &response, msg, COAP_CODE_NOT_FOUND);
+    }
+    send_msg(conn, &response);
+}
+
+static void handle_lwm2m_msg(server_t *server, int conn, const coap_msg_t *msg) {
+    bool is_response = (msg->code >> 5) >= 2;
+    if (msg->type == COAP_TYPE_ACK || msg->type == COAP_TYPE_RST) {
+        if (!server->request_pending || conn != server->conn
+                || msg->msg_id != server->request_msg_id) {
+            return;
+        }
+        if (msg->type == COAP_TYPE_RST) {
+            finish_request(server, NULL);
+        } else if (msg->code == COAP_CODE_EMPTY) {
+            // separate response will follow, stop retransmitting
+            server->retransmit_at_us = UINT64_MAX;
+        } else if (matches_request(server, msg)) {
+            finish_request(server, msg);
+        }
+        return;
+    }
+    if (msg->code == COAP_CODE_EMPTY) {
+        // CoAP ping
+        if (msg->type == COAP_TYPE_CON) {
+            send_empty(conn, COAP_TYPE_RST, msg->msg_id);
+        }
+        return;
+    }
+    if (!is_response) {
+        handle_client_request(server, conn, msg);
+        return;
+    }
+    if (msg->type == COAP_TYPE_CON) {
+        send_empty(conn, COAP_TYPE_ACK, msg->msg_id);
+    }
+    if (matches_request(server, msg)) {
+        // separate response to the pending request
+        if (mark_seen(server, msg->msg_id)) {
+            finish_request(server, msg);
+        }
+    } else if (msg->has_observe && mark_seen(server, msg->msg_id)) {
+        server->notifications++;
+    }
+}
+
+static void handle_fw_request(server_t *server,
+                              int conn,
+                              const coap_msg_t *msg) {
+    if ((msg->code >> 5) != 0 || msg->code == COAP_CODE_EMPTY) {
+        return;
+    }
+    coap_msg_t response;
+    if (msg->code != COAP_CODE_GET || !server->fw_image) {
+        response_init(server, &response, msg, COAP_CODE_NOT_FOUND);
+        send_msg(conn, &response);
+        return;
+    }
+    uint8_t szx = server->fw_block_szx;
+    if (msg->has_block2 && msg->block2_szx < szx) {
+        szx = msg->block2_szx;
+    }
+    uint32_t num = msg->has_block2 ? msg->block2_num : 0;
+    size_t block_size = (size_t) 1 << (szx + 4);
+    size_t offset = (size_t) num * block_size;
+    if (offset >= server->fw_image_size) {
+        response_init(server, &response, msg, COAP_CODE_NOT_FOUND);
+        send_msg(conn, &response);
+        return;
+    }
+    response_init(server, &response, msg, COAP_CODE_CONTENT);
+    response.content_format = 42; // application/octet-stream
+    response.has_block2 = true;
+    response.block2_num = num;
+    response.block2_szx = szx;
+    response.payload = &server->fw_image[offset];
+    response.payload_size =
+            ANJ_MIN(block_size, server->fw_image_size - offset);
+    response.block2_more =
+            offset + response.payload_size < server->fw_image_size;
+    server->fw_blocks_served++;
+    send_msg(conn, &response);
+}
+
+void server_step(server_t *server) {
+    uint8_t buf[LINK_MAX_DATAGRAM_SIZE];
+    size_t size;
+    int conn;
+    while (link_server_recv(&conn, buf, sizeof(buf), &size)) {
+        coap_msg_t msg;
+        const char *hostname = link_conn_hostname(conn);
+        if (!hostname || coap_msg_parse(buf, size, &msg)) {
+            continue;
+        }
+        if (!strcmp(hostname, FW_SERVER_HOSTNAME)) {
+            handle_fw_request(server, conn, &msg);
+        } else {
+            handle_lwm2m_msg(server, conn, &msg);
+        }
+    }
+
+    if (server->request_pending && link_now_us() >= server->retransmit_at_us) {
+        if (server->request_retransmissions == MAX_RETRANSMIT) {
+            finish_request(server, NULL);
+            return;
+        }
+        server->request_retransmissions++;
+        server->retransmissions++;
+        server->retransmit_timeout_us *= 2;
+        server->retransmit_at_us = link_now_us() + server->retransmit_timeout_us;
+        link_server_send(server->conn, server->request, server->request_size);
+    }
+}
+
+bool server_next_timer_us(const server_t *server, uint64_t *out_time_us) {
+    if (!server->request_pending || server->retransmit_at_us == UINT64_MAX) {
+        return false;
+    }
+    *out_time_us = server->retransmit_at_us;
+    return true;
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Scripted LwM2M Server and CoAP firmware server on the other side of the
+// simulated link. The library's CoAP codec only handles the client side of
+// the protocol, so the server uses its own minimal encoder and parser.
+
+#define SERVER_HOSTNAME "lwm2m.example"
+#define FW_SERVER_HOSTNAME "fw.example"
+
+#define COAP_TYPE_CON 0
+#define COAP_TYPE_NON 1
+#define COAP_TYPE_ACK 2
+#define COAP_TYPE_RST 3
+
+#define COAP_CODE(Class, Detail) ((uint8_t) (((Class) << 5) | (Detail)))
+#define COAP_CODE_EMPTY COAP_CODE(0, 0)
+#define COAP_CODE_GET COAP_CODE(0, 1)
+#define COAP_CODE_POST COAP_CODE(0, 2)
+#define COAP_CODE_PUT COAP_CODE(0, 3)
+#define COAP_CODE_DELETE COAP_CODE(0, 4)
+#define COAP_CODE_CREATED COAP_CODE(2, 1)
+#define COAP_CODE_DELETED COAP_CODE(2, 2)
+#define COAP_CODE_CHANGED COAP_CODE(2, 4)
+#define COAP_CODE_CONTENT COAP_CODE(2, 5)
+#define COAP_CODE_NOT_FOUND COAP_CODE(4, 4)
+
+#define COAP_NO_CONTENT_FORMAT (-1)
+
+typedef struct {
+    uint8_t type;
+    uint8_t code;
+    uint16_t msg_id;
+    uint8_t token[8];
+    size_t token_size;
+    // segments joined with '/', without the leading one
+    char uri_path[64];
+    char location_path[32];
+    bool has_observe;
+    uint32_t observe;
+    int content_format;
+    int accept;
+    bool has_block2;
+    uint32_t block2_num;
+    bool block2_more;
+    uint8_t block2_szx;
+    const uint8_t *payload;
+    size_t payload_size;
+} coap_msg_t;
+
+int coap_msg_parse(const uint8_t *data, size_t size, coap_msg_t *out_msg);
+int coap_msg_build(const coap_msg_t *msg,
+                   uint8_t *out,
+                   size_t out_size,
+                   size_t *out_msg_size);
+void coap_msg_init(coap_msg_t *msg);
+
+typedef struct server_struct server_t;
+
+/**
+ * Called when the response to a server request arrives, or with @p response
+ * set to NULL once the request times out after all retransmissions.
+ */
+typedef void server_response_handler_t(server_t *server,
+                                       const coap_msg_t *response,
+                                       void *arg);
+
+#define SERVER_MAX_REQUEST_SIZE 256
+#define SERVER_SEEN_MSG_IDS 32
+
+struct server_struct {
+    int conn;
+    bool registered;
+    uint32_t registrations;
+    uint32_t updates;
+    uint32_t sends;
+    uint32_t notifications;
+    uint32_t retransmissions;
+    uint32_t request_timeouts;
+
+    // currently processed server request, only one at a time
+    bool request_pending;
+    uint8_t request[SERVER_MAX_REQUEST_SIZE];
+    size_t request_size;
+    uint16_t request_msg_id;
+    uint8_t request_token[8];
+    uint64_t retransmit_at_us;
+    uint64_t retransmit_timeout_us;
+    unsigned request_retransmissions;
+    server_response_handler_t *handler;
+    void *handler_arg;
+
+    uint16_t next_msg_id;
+    uint32_t next_token;
+
+    // Message IDs of client messages already processed, responses to
+    // retransmitted requests are sent again but not counted twice
+    uint16_t seen_msg_ids[SERVER_SEEN_MSG_IDS];
+    size_t seen_msg_ids_count;
+    size_t seen_msg_ids_next;
+
+    const uint8_t *fw_image;
+    size_t fw_image_size;
+    // largest block size served, as Block2 SZX
+    uint8_t fw_block_szx;
+    uint32_t fw_blocks_served;
+};
+
+void server_init(server_t *server);
+// processes all datagrams delivered to the servers and pending retransmissions
+void server_step(server_t *server);
+// returns false if there is no timer armed
+bool server_next_timer_us(const server_t *server, uint64_t *out_time_us);
+
+/**
+ * Sends a new request to the client. Fields identifying the exchange (type,
+ * Message ID and token) are filled by the server.
+ */
+int server_request(server_t *server,
+                   coap_msg_t *request,
+                   server_response_handler_t *handler,
+                   void *arg);
+
+#endif // SERVER_H
@@ -0,0 +1,204 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#define ANJ_LOG_SOURCE_FILE_ID 7
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/compat/log_impl_decls.h>
+#include <anj/log.h>
+
+#include <anj_unit_test.h>
+
+#define SYNC_BYTE 0xA5
+#define LEVEL_DROPPED 0xFF
+
+typedef struct {
+    uint8_t level;
+    uint64_t file_id;
+    uint64_t line;
+    // first varint argument, or number of dropped records
+    uint64_t arg;
+    size_t size;
+} record_t;
+
+static size_t get_varint(const uint8_t *data, uint64_t *out_value) {
+    size_t size = 0;
+    *out_value = 0;
+    do {
+        *out_value |= (uint64_t) (data[size] & 0x7F) << (7 * size);
+    } while (data[size++] & 0x80);
+    return size;
+}
+
+static record_t parse_record(const uint8_t *data) {
+    record_t record = { 0 };
+    ANJ_UNIT_ASSERT_EQUAL(data[0], SYNC_BYTE);
+    record.size = 2 + (size_t) data[1];
+    record.level = data[2];
+    size_t pos = 3;
+    if (record.level != LEVEL_DROPPED) {
+        pos += get_varint(&data[pos], &record.file_id);
+        pos += get_varint(&data[pos], &record.line);
+    }
+    pos += get_varint(&data[pos], &record.arg);
+    ANJ_UNIT_ASSERT_TRUE(pos <= record.size);
+    return record;
+}
+
+static void drain(void) {
+    uint8_t buf[ANJ_LOG_DEFERRED_BUFFER_SIZE];
+    while (anj_log_deferred_read(buf, sizeof(buf))) {
+    }
+}
+
+static void log_value(unsigned value) {
+    anj_log(deferred, L_INFO, "value %u", value);
+}
+
+ANJ_UNIT_TEST(log_deferred, flush) {
+    drain();
+    log_value(42);
+    uint8_t buf[ANJ_LOG_DEFERRED_BUFFER_SIZE];
+    size_t read = anj_log_deferred_read(buf, sizeof(buf));
+    record_t record = parse_record(buf);
+    ANJ_UNIT_ASSERT_EQUAL(read, record.size);
+    ANJ_UNIT_ASSERT_EQUAL(record.level, ANJ_LOG_LEVEL_L_INFO);
+    ANJ_UNIT_ASSERT_EQUAL(record.file_id, ANJ_LOG_SOURCE_FILE_ID);
+    ANJ_UNIT_ASSERT_EQUAL(record.arg, 42);
+    // everything has been read
+    ANJ_UNIT_ASSERT_EQUAL(anj_log_deferred_read(buf, sizeof(buf)), 0);
+}
+
+ANJ_UNIT_TEST(log_deferred, flush_in_chunks) {
+    drain();
+    log_value(1);
+    log_value(2);
+    uint8_t buf[ANJ_LOG_DEFERRED_BUFFER_SIZE];
+    size_t read = 0;
+    size_t chunk;
+    while ((chunk = anj_log_deferred_read(&buf[read], 3))) {
+        ANJ_UNIT_ASSERT_TRUE(chunk <= 3);
+        read += chunk;
+    }
+    record_t first = parse_record(buf);
+    record_t second = parse_record(&buf[first.size]);
+    ANJ_UNIT_ASSERT_EQUAL(read, first.size + second.size);
+    ANJ_UNIT_ASSERT_EQUAL(first.arg, 1);
+    ANJ_UNIT_ASSERT_EQUAL(second.arg, 2);
+}
+
+ANJ_UNIT_TEST(log_deferred, wrap_around) {
+    drain();
+    uint8_t buf[ANJ_LOG_DEFERRED_BUFFER_SIZE];
+    // pairs of records don't fill the buffer evenly, so they're split at its
+    // end in different places
+    for (unsigned i = 0; i < 5 * ANJ_LOG_DEFERRED_BUFFER_SIZE; ++i) {
+        log_value(i % 100);
+        log_value(i % 100 + 1);
+        size_t read = anj_log_deferred_read(buf, sizeof(buf));
+        record_t first = parse_record(buf);
+        record_t second = parse_record(&buf[first.size]);
+        ANJ_UNIT_ASSERT_EQUAL(read, first.size + second.size);
+        ANJ_UNIT_ASSERT_EQUAL(first.arg, i % 100);
+        ANJ_UNIT_ASSERT_EQUAL(second.arg, i % 100 + 1);
+    }
+}
+
+ANJ_UNIT_TEST(log_deferred, overflow_drops_records) {
+    drain();
+    uint8_t buf[ANJ_LOG_DEFERRED_BUFFER_SIZE];
+    log_value(0);
+    size_t record_size = anj_log_deferred_read(buf, sizeof(buf));
+    // one byte of the buffer is always left unused
+    size_t fitting = (ANJ_LOG_DEFERRED_BUFFER_SIZE - 1) / record_size;
+    for (unsigned i = 0; i < fitting + 3; ++i) {
+        log_value(i);
+    }
+    size_t read = anj_log_deferred_read(buf, sizeof(buf));
+    ANJ_UNIT_ASSERT_EQUAL(read, fitting * record_size);
+    for (size_t i = 0; i < fitting; ++i) {
+        ANJ_UNIT_ASSERT_EQUAL(parse_record(&buf[i * record_size]).arg, i);
+    }
+
+    // the number of dropped records precedes the next stored one
+    log_value(99);
+    read = anj_log_deferred_read(buf, sizeof(buf));
+    record_t dropped = parse_record(buf);
+    ANJ_UNIT_ASSERT_EQUAL(dropped.level, LEVEL_DROPPED);
+    ANJ_UNIT_ASSERT_EQUAL(dropped.arg, 3);
+    record_t record = parse_record(&buf[dropped.size]);
+    ANJ_UNIT_ASSERT_EQUAL(read, dropped.size + record.size);
+    ANJ_UNIT_ASSERT_EQUAL(record.arg, 99);
+
+    // the counter has been reset
+    log_value(100);
+    read = anj_log_deferred_read(buf, sizeof(buf));
+    ANJ_UNIT_ASSERT_EQUAL(read, record_size);
+    ANJ_UNIT_ASSERT_EQUAL(parse_record(buf).arg, 100);
+}
+
+#define CONCURRENT_RECORDS 20000
+
+static volatile bool g_producer_done;
+
+static void *producer(void *arg) {
+    (void) arg;
+    for (unsigned i = 0; i < CONCURRENT_RECORDS; ++i) {
+        log_value(i);
+    }
+    __atomic_store_n(&g_producer_done, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+ANJ_UNIT_TEST(log_deferred, concurrent_producer_and_consumer) {
+    drain();
+    g_producer_done = false;
+    pthread_t thread;
+    ANJ_UNIT_ASSERT_SUCCESS(pthread_create(&thread, NULL, producer, NULL));
+
+    // records may be split between reads, so the bytes are gathered until
+    // a whole record is available
+    uint8_t buf[2 * ANJ_LOG_DEFERRED_BUFFER_SIZE];
+    size_t buf_len = 0;
+    uint64_t received = 0;
+    uint64_t dropped = 0;
+    uint64_t next_value = 0;
+    bool done = false;
+    while (!done) {
+        done = __atomic_load_n(&g_producer_done, __ATOMIC_ACQUIRE);
+        buf_len += anj_log_deferred_read(&buf[buf_len],
+                                         sizeof(buf) - buf_len);
+        size_t pos = 0;
+        while (buf_len - pos >= 2
+               && buf_len - pos >= 2 + (size_t) buf[pos + 1]) {
+            record_t record = parse_record(&buf[pos]);
+            if (record.level == LEVEL_DROPPED) {
+                dropped += record.arg;
+                next_value += record.arg;
+            } else {
+                ANJ_UNIT_ASSERT_EQUAL(record.arg, next_value);
+                ++next_value;
+                ++received;
+            }
+            pos += record.size;
+        }
+        memmove(buf, &buf[pos], buf_len - pos);
+        buf_len -= pos;
+    }
+    ANJ_UNIT_ASSERT_SUCCESS(pthread_join(thread, NULL));
+    ANJ_UNIT_ASSERT_EQUAL(buf_len, 0);
+    ANJ_UNIT_ASSERT_TRUE(received > 0);
+    // the last dropped records are reported only with the next stored one
+    ANJ_UNIT_ASSERT_TRUE(received + dropped <= CONCURRENT_RECORDS);
+}
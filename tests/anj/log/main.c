@@ -7,7 +7,12 @@
  * See the attached LICENSE file for details.
  */
 
+#include <anj/compat/time.h>
 #include <anj/log.h>
+#include <anj/time.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdint.h>
 #include <string.h>
 
 #include <anj_unit_test.h>
@@ -16,6 +21,17 @@ bool g_lower_the_default_level_debug;
 bool g_lower_the_default_level_trace;
 bool g_increase_the_default_level_warning;
 bool g_increase_the_default_level_info;
+int g_rate_limited_count;
+uint32_t g_suppressed_count;
+int64_t g_now_ms;
+
+anj_time_monotonic_t anj_time_monotonic_now(void) {
+    return anj_time_monotonic_new(g_now_ms, ANJ_TIME_UNIT_MS);
+}
+
+anj_time_real_t anj_time_real_now(void) {
+    return anj_time_real_new(g_now_ms, ANJ_TIME_UNIT_MS);
+}
 
 int custom_log_handler(anj_log_level_t level,
                        const char *module,
@@ -39,6 +55,15 @@ int custom_log_handler(anj_log_level_t level,
             && level == ANJ_LOG_LEVEL_L_INFO) {
         g_increase_the_default_level_info = true;
     }
+    if (strcmp(module, "rate_limited") == 0) {
+        g_rate_limited_count++;
+    }
+    if (strcmp(module, "anj_log") == 0) {
+        va_list args;
+        va_start(args, format);
+        g_suppressed_count += va_arg(args, uint32_t);
+        va_end(args);
+    }
     return 0;
 }
 
@@ -52,3 +77,88 @@ ANJ_UNIT_TEST(logger_filtering_check, log_filtering_test) {
     ANJ_UNIT_ASSERT_TRUE(g_increase_the_default_level_warning);
     ANJ_UNIT_ASSERT_FALSE(g_increase_the_default_level_info);
 }
+
+ANJ_UNIT_TEST(logger_filtering_check, runtime_filtering_test) {
+    g_lower_the_default_level_debug = false;
+    g_increase_the_default_level_warning = false;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_log_runtime_level_set_from_string(
+            "lower_the_default_level=L_INFO"));
+    ANJ_UNIT_ASSERT_EQUAL(
+            anj_log_runtime_level_get("lower_the_default_level"),
+            ANJ_LOG_LEVEL_L_INFO);
+    int evaluated = 0;
+    anj_log(lower_the_default_level, L_DEBUG, "Lorem ipsum %d", ++evaluated);
+    ANJ_UNIT_ASSERT_FALSE(g_lower_the_default_level_debug);
+    // arguments of filtered out statements are not evaluated
+    ANJ_UNIT_ASSERT_EQUAL(evaluated, 0);
+    anj_log(increase_the_default_level, L_WARNING, "Lorem ipsum");
+    ANJ_UNIT_ASSERT_TRUE(g_increase_the_default_level_warning);
+
+    // level of the module takes precedence over the default one
+    ANJ_UNIT_ASSERT_SUCCESS(anj_log_runtime_level_set_from_string("MUTED"));
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_log_runtime_level_set("lower_the_default_level",
+                                      ANJ_LOG_LEVEL_L_DEBUG));
+    g_increase_the_default_level_warning = false;
+    anj_log(increase_the_default_level, L_WARNING, "Lorem ipsum");
+    ANJ_UNIT_ASSERT_FALSE(g_increase_the_default_level_warning);
+    anj_log(lower_the_default_level, L_DEBUG, "Lorem ipsum");
+    ANJ_UNIT_ASSERT_TRUE(g_lower_the_default_level_debug);
+
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_log_runtime_level_set_from_string("lower_the_default_level="));
+    ANJ_UNIT_ASSERT_EQUAL(
+            anj_log_runtime_level_get("lower_the_default_level"),
+            ANJ_LOG_LEVEL_L_MUTED);
+    g_lower_the_default_level_debug = false;
+    anj_log(lower_the_default_level, L_DEBUG, "Lorem ipsum");
+    ANJ_UNIT_ASSERT_FALSE(g_lower_the_default_level_debug);
+
+    ANJ_UNIT_ASSERT_FAILED(anj_log_runtime_level_set_from_string("=INFO"));
+    ANJ_UNIT_ASSERT_FAILED(anj_log_runtime_level_set_from_string("VERBOSE"));
+    ANJ_UNIT_ASSERT_FAILED(
+            anj_log_runtime_level_set_from_string("module=VERBOSE"));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_log_runtime_level_set_from_string("a=INFO"));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_log_runtime_level_set_from_string("b=INFO"));
+    // table of modules is full
+    ANJ_UNIT_ASSERT_FAILED(anj_log_runtime_level_set_from_string("c=INFO"));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_log_runtime_level_set_from_string("b=DEBUG"));
+
+    anj_log_runtime_level_reset(NULL);
+    ANJ_UNIT_ASSERT_EQUAL(anj_log_runtime_level_get(NULL),
+                          ANJ_LOG_LEVEL_L_TRACE);
+    ANJ_UNIT_ASSERT_EQUAL(anj_log_runtime_level_get("a"),
+                          ANJ_LOG_LEVEL_L_TRACE);
+    g_increase_the_default_level_warning = false;
+    anj_log(increase_the_default_level, L_WARNING, "Lorem ipsum");
+    ANJ_UNIT_ASSERT_TRUE(g_increase_the_default_level_warning);
+}
+
+static void log_storm(int count) {
+    for (int i = 0; i < count; ++i) {
+        anj_log(rate_limited, L_ERROR, "Lorem ipsum");
+    }
+}
+
+ANJ_UNIT_TEST(logger_rate_limit_check, rate_limit_test) {
+    log_storm(10);
+    ANJ_UNIT_ASSERT_EQUAL(g_rate_limited_count, 3);
+    ANJ_UNIT_ASSERT_EQUAL(g_suppressed_count, 0);
+
+    // one message is regained per interval, and the suppressed ones are
+    // reported before it
+    g_now_ms += 1500;
+    log_storm(2);
+    ANJ_UNIT_ASSERT_EQUAL(g_rate_limited_count, 4);
+    ANJ_UNIT_ASSERT_EQUAL(g_suppressed_count, 7);
+    g_now_ms += 500;
+    log_storm(1);
+    ANJ_UNIT_ASSERT_EQUAL(g_rate_limited_count, 5);
+    ANJ_UNIT_ASSERT_EQUAL(g_suppressed_count, 8);
+
+    // the bucket doesn't grow beyond the burst size
+    g_now_ms += 60000;
+    log_storm(5);
+    ANJ_UNIT_ASSERT_EQUAL(g_rate_limited_count, 8);
+    ANJ_UNIT_ASSERT_EQUAL(g_suppressed_count, 8);
+}
@@ -0,0 +1,256 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(__APPLE__)
+#    define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <anj/compat/net/anj_net_api.h>
+#include <anj/compat/net/anj_net_wrapper.h>
+#include <anj/defs.h>
+#include <anj/utils.h>
+
+#include <anj_unit_test.h>
+
+#ifdef ANJ_NET_WITH_IO_THREAD
+
+#    define HOST "127.0.0.1"
+#    define PORT "9997"
+
+#    define WAIT_WHILE_INPROGRESS(Ret, Call)             \
+        while (((Ret) = (Call)) == ANJ_NET_EINPROGRESS) { \
+            poll(NULL, 0, 1);                             \
+        }
+
+static int setup_server(void) {
+    int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+    ANJ_UNIT_ASSERT_NOT_EQUAL(sockfd, -1);
+    int one = 1;
+    setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr = { 0 };
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr(HOST);
+    addr.sin_port = htons((uint16_t) atoi(PORT));
+    ANJ_UNIT_ASSERT_EQUAL(
+            bind(sockfd, (struct sockaddr *) &addr, sizeof(addr)), 0);
+    return sockfd;
+}
+
+static anj_net_ctx_t *connect_ctx(void) {
+    anj_net_config_t config = {
+        .raw_socket_config = {
+            .af_setting = ANJ_NET_AF_SETTING_FORCE_INET4
+        }
+    };
+    anj_net_ctx_t *ctx = NULL;
+    ANJ_UNIT_ASSERT_EQUAL(anj_net_create_ctx(ANJ_NET_BINDING_UDP, &ctx,
+                                             &config),
+                          ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_NOT_NULL(ctx);
+    int ret;
+    WAIT_WHILE_INPROGRESS(ret, anj_net_connect(ANJ_NET_BINDING_UDP, ctx, HOST,
+                                               PORT));
+    ANJ_UNIT_ASSERT_EQUAL(ret, ANJ_NET_OK);
+    return ctx;
+}
+
+static void cleanup_ctx(anj_net_ctx_t **ctx) {
+    int ret;
+    WAIT_WHILE_INPROGRESS(ret, anj_net_cleanup_ctx(ANJ_NET_BINDING_UDP, ctx));
+    ANJ_UNIT_ASSERT_EQUAL(ret, ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_NULL(*ctx);
+}
+
+static ssize_t server_recv(int sockfd,
+                           uint8_t *buf,
+                           size_t length,
+                           struct sockaddr_in *out_addr) {
+    struct pollfd pfd = {
+        .fd = sockfd,
+        .events = POLLIN
+    };
+    ANJ_UNIT_ASSERT_EQUAL(poll(&pfd, 1, 1000), 1);
+    socklen_t addr_len = sizeof(*out_addr);
+    return recvfrom(sockfd, buf, length, 0, (struct sockaddr *) out_addr,
+                    &addr_len);
+}
+
+static void server_send(int sockfd,
+                        const struct sockaddr_in *addr,
+                        const char *data) {
+    ANJ_UNIT_ASSERT_EQUAL(sendto(sockfd, data, strlen(data), 0,
+                                 (const struct sockaddr *) addr, sizeof(*addr)),
+                          (ssize_t) strlen(data));
+}
+
+static void wait_readable(anj_net_ctx_t *ctx) {
+    anj_net_poll_handle_t handle;
+    bool data_pending;
+    ANJ_UNIT_ASSERT_EQUAL(anj_net_get_poll_handle(ANJ_NET_BINDING_UDP, ctx,
+                                                  &handle, &data_pending),
+                          ANJ_NET_OK);
+    struct pollfd pfd = {
+        .fd = handle.fd,
+        .events = POLLIN
+    };
+    ANJ_UNIT_ASSERT_EQUAL(poll(&pfd, 1, 1000), 1);
+}
+
+ANJ_UNIT_TEST(net_io_thread, round_trip) {
+    int sockfd = setup_server();
+    anj_net_ctx_t *ctx = connect_ctx();
+
+    anj_net_socket_state_t state;
+    ANJ_UNIT_ASSERT_EQUAL(anj_net_get_state(ANJ_NET_BINDING_UDP, ctx, &state),
+                          ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL(state, ANJ_NET_SOCKET_STATE_CONNECTED);
+    int32_t mtu;
+    ANJ_UNIT_ASSERT_EQUAL(anj_net_get_inner_mtu(ANJ_NET_BINDING_UDP, ctx,
+                                                &mtu),
+                          ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_TRUE(mtu > 0);
+
+    anj_net_poll_handle_t handle;
+    bool data_pending;
+    ANJ_UNIT_ASSERT_EQUAL(anj_net_get_poll_handle(ANJ_NET_BINDING_UDP, ctx,
+                                                  &handle, &data_pending),
+                          ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_FALSE(data_pending);
+    struct pollfd pfd = {
+        .fd = handle.fd,
+        .events = POLLIN
+    };
+    ANJ_UNIT_ASSERT_EQUAL(poll(&pfd, 1, 0), 0);
+
+    size_t bytes_sent = 0;
+    ANJ_UNIT_ASSERT_EQUAL(anj_net_send(ANJ_NET_BINDING_UDP, ctx, &bytes_sent,
+                                       (const uint8_t *) "hello", 5),
+                          ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL(bytes_sent, 5);
+
+    uint8_t buf[100];
+    struct sockaddr_in client_addr;
+    ANJ_UNIT_ASSERT_EQUAL(server_recv(sockfd, buf, sizeof(buf), &client_addr),
+                          5);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, "hello", 5);
+    server_send(sockfd, &client_addr, "world!");
+
+    // the handle is readable until all queued datagrams are received
+    ANJ_UNIT_ASSERT_EQUAL(poll(&pfd, 1, 1000), 1);
+    size_t bytes_received = 0;
+    ANJ_UNIT_ASSERT_EQUAL(anj_net_recv(ANJ_NET_BINDING_UDP, ctx,
+                                       &bytes_received, buf, sizeof(buf)),
+                          ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL(bytes_received, 6);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, "world!", 6);
+    ANJ_UNIT_ASSERT_EQUAL(anj_net_recv(ANJ_NET_BINDING_UDP, ctx,
+                                       &bytes_received, buf, sizeof(buf)),
+                          ANJ_NET_EAGAIN);
+    ANJ_UNIT_ASSERT_EQUAL(poll(&pfd, 1, 0), 0);
+
+    int ret;
+    WAIT_WHILE_INPROGRESS(ret, anj_net_close(ANJ_NET_BINDING_UDP, ctx));
+    ANJ_UNIT_ASSERT_EQUAL(ret, ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL(anj_net_get_state(ANJ_NET_BINDING_UDP, ctx, &state),
+                          ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL(state, ANJ_NET_SOCKET_STATE_CLOSED);
+
+    cleanup_ctx(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(anj_net_io_thread_stop(), 0);
+    close(sockfd);
+}
+
+ANJ_UNIT_TEST(net_io_thread, truncated_datagram) {
+    int sockfd = setup_server();
+    anj_net_ctx_t *ctx = connect_ctx();
+
+    size_t bytes_sent = 0;
+    ANJ_UNIT_ASSERT_EQUAL(anj_net_send(ANJ_NET_BINDING_UDP, ctx, &bytes_sent,
+                                       (const uint8_t *) "ping", 4),
+                          ANJ_NET_OK);
+    uint8_t buf[16];
+    struct sockaddr_in client_addr;
+    ANJ_UNIT_ASSERT_EQUAL(server_recv(sockfd, buf, sizeof(buf), &client_addr),
+                          4);
+    server_send(sockfd, &client_addr, "too long datagram");
+    server_send(sockfd, &client_addr, "next");
+
+    wait_readable(ctx);
+    size_t bytes_received = 0;
+    ANJ_UNIT_ASSERT_EQUAL(anj_net_recv(ANJ_NET_BINDING_UDP, ctx,
+                                       &bytes_received, buf, 8),
+                          ANJ_NET_EMSGSIZE);
+    ANJ_UNIT_ASSERT_EQUAL(bytes_received, 8);
+
+    // the following datagram is not affected
+    wait_readable(ctx);
+    ANJ_UNIT_ASSERT_EQUAL(anj_net_recv(ANJ_NET_BINDING_UDP, ctx,
+                                       &bytes_received, buf, 8),
+                          ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL(bytes_received, 4);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, "next", 4);
+
+    cleanup_ctx(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(anj_net_io_thread_stop(), 0);
+    close(sockfd);
+}
+
+ANJ_UNIT_TEST(net_io_thread, cleanup_flushes_queue) {
+    int sockfd = setup_server();
+    anj_net_ctx_t *ctx = connect_ctx();
+
+    uint8_t msg = 0;
+    size_t bytes_sent = 0;
+    size_t queued = 0;
+    // fill the queue; depending on how fast the I/O thread is, some of the
+    // datagrams may already be sent
+    while (queued < 2 * ANJ_NET_IO_THREAD_QUEUE_SIZE
+           && anj_net_is_ok(anj_net_send(ANJ_NET_BINDING_UDP, ctx,
+                                         &bytes_sent, &msg, 1))) {
+        queued++;
+        msg++;
+    }
+    ANJ_UNIT_ASSERT_TRUE(queued >= ANJ_NET_IO_THREAD_QUEUE_SIZE);
+    cleanup_ctx(&ctx);
+
+    for (size_t i = 0; i < queued; i++) {
+        uint8_t buf[4];
+        struct sockaddr_in client_addr;
+        ANJ_UNIT_ASSERT_EQUAL(
+                server_recv(sockfd, buf, sizeof(buf), &client_addr), 1);
+        ANJ_UNIT_ASSERT_EQUAL(buf[0], i);
+    }
+    ANJ_UNIT_ASSERT_EQUAL(anj_net_io_thread_stop(), 0);
+    close(sockfd);
+}
+
+ANJ_UNIT_TEST(net_io_thread, stop_with_context_in_use) {
+    anj_net_ctx_t *ctx = NULL;
+    ANJ_UNIT_ASSERT_EQUAL(anj_net_create_ctx(ANJ_NET_BINDING_UDP, &ctx, NULL),
+                          ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL(anj_net_io_thread_stop(), -1);
+    cleanup_ctx(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(anj_net_io_thread_stop(), 0);
+    // the thread is started again for new contexts
+    ANJ_UNIT_ASSERT_EQUAL(anj_net_create_ctx(ANJ_NET_BINDING_UDP, &ctx, NULL),
+                          ANJ_NET_OK);
+    cleanup_ctx(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(anj_net_io_thread_stop(), 0);
+}
+
+#endif // ANJ_NET_WITH_IO_THREAD
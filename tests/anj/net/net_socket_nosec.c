@@ -14,6 +14,7 @@
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <poll.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -113,6 +114,17 @@ static int accept_incomming_conn(int listen_sockfd, uint16_t allowed_port) {
     return ret;
 }
 
+// with ANJ_NET_WITH_ASYNC_RESOLVE, host names are resolved in background
+static int udp_connect_wait(anj_net_ctx_t *ctx,
+                            const char *host,
+                            const char *port) {
+    int ret;
+    while ((ret = anj_udp_connect(ctx, host, port)) == ANJ_NET_EINPROGRESS) {
+        poll(NULL, 0, 1);
+    }
+    return ret;
+}
+
 static int
 test_udp_connection_by_hostname(anj_net_ctx_t *ctx, int af, const char *host) {
     (void) af;
@@ -120,7 +132,8 @@ test_udp_connection_by_hostname(anj_net_ctx_t *ctx, int af, const char *host) {
     int sockfd = setup_local_server(AF_INET, DEFAULT_PORT);
     ANJ_UNIT_ASSERT_NOT_EQUAL(sockfd, -1);
 
-    ANJ_UNIT_ASSERT_EQUAL(anj_udp_connect(ctx, host, DEFAULT_PORT), ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL(udp_connect_wait(ctx, host, DEFAULT_PORT),
+                          ANJ_NET_OK);
 
     return sockfd;
 }
@@ -380,6 +393,86 @@ ANJ_UNIT_TEST(udp_socket, msg_too_big_for_recv) {
     close(sockfd);
 }
 
+#ifdef ANJ_NET_WITH_BATCH_IO
+ANJ_UNIT_TEST(udp_socket, batch_io) {
+    anj_net_ctx_t *udp_sock_ctx = NULL;
+    anj_net_socket_configuration_t sock_config = {
+        .af_setting = ANJ_NET_AF_SETTING_FORCE_INET4
+    };
+    anj_net_config_t config = {
+        .raw_socket_config = sock_config
+    };
+    ANJ_UNIT_ASSERT_EQUAL(anj_udp_create_ctx(&udp_sock_ctx, &config),
+                          ANJ_NET_OK);
+
+    int sockfd = test_default_udp_connection(udp_sock_ctx, AF_INET);
+
+    anj_net_datagram_t out[3] = {
+        { .buf = (uint8_t *) "a", .length = 1 },
+        { .buf = (uint8_t *) "bb", .length = 2 },
+        { .buf = (uint8_t *) "ccc", .length = 3 }
+    };
+    size_t count = 0;
+    ANJ_UNIT_ASSERT_EQUAL(anj_udp_send_batch(udp_sock_ctx, out, 3, &count),
+                          ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL(count, 3);
+    ANJ_UNIT_ASSERT_EQUAL(out[2].bytes, 3);
+
+    uint8_t buf[100];
+    struct sockaddr_in client_addr;
+    socklen_t client_addr_len = sizeof(client_addr);
+    for (size_t i = 0; i < 3; i++) {
+        ANJ_UNIT_ASSERT_EQUAL(recvfrom(sockfd, buf, sizeof(buf), 0,
+                                       (struct sockaddr *) &client_addr,
+                                       &client_addr_len),
+                              (ssize_t) (i + 1));
+    }
+    ANJ_UNIT_ASSERT_NOT_EQUAL(connect(sockfd, (struct sockaddr *) &client_addr,
+                                      client_addr_len),
+                              -1);
+
+    ANJ_UNIT_ASSERT_EQUAL(send(sockfd, "world!", 6, 0), 6);
+    ANJ_UNIT_ASSERT_EQUAL(send(sockfd, "Have a nice day.", 16, 0), 16);
+    ANJ_UNIT_ASSERT_EQUAL(send(sockfd, "bye", 3, 0), 3);
+
+    uint8_t in_bufs[3][8];
+    anj_net_datagram_t in[3];
+    size_t received = 0;
+    // on MacOS even if data was sent, recv might return EAGAIN in the first
+    // call, and the datagrams may be delivered in separate batches
+    while (received < 3) {
+        for (size_t i = received; i < 3; i++) {
+            in[i].buf = in_bufs[i];
+            in[i].length = sizeof(in_bufs[i]);
+        }
+        int ret = anj_udp_recv_batch(udp_sock_ctx, &in[received],
+                                     3 - received, &count);
+        ANJ_UNIT_ASSERT_TRUE(ret == ANJ_NET_OK || ret == ANJ_NET_EAGAIN);
+        if (ret == ANJ_NET_OK) {
+            received += count;
+        }
+    }
+    ANJ_UNIT_ASSERT_EQUAL(in[0].bytes, 6);
+    ANJ_UNIT_ASSERT_FALSE(in[0].truncated);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(in_bufs[0], "world!", 6);
+    ANJ_UNIT_ASSERT_EQUAL(in[1].bytes, 8);
+    ANJ_UNIT_ASSERT_TRUE(in[1].truncated);
+    ANJ_UNIT_ASSERT_EQUAL(in[2].bytes, 3);
+    ANJ_UNIT_ASSERT_FALSE(in[2].truncated);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(in_bufs[2], "bye", 3);
+
+    ANJ_UNIT_ASSERT_EQUAL(anj_udp_recv_batch(udp_sock_ctx, in, 3, &count),
+                          ANJ_NET_EAGAIN);
+    ANJ_UNIT_ASSERT_EQUAL(count, 0);
+
+    /* after test cleanup */
+    ANJ_UNIT_ASSERT_EQUAL(anj_udp_cleanup_ctx(&udp_sock_ctx), ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_NULL(udp_sock_ctx);
+    shutdown(sockfd, SHUT_RDWR);
+    close(sockfd);
+}
+#endif // ANJ_NET_WITH_BATCH_IO
+
 ANJ_UNIT_TEST(udp_socket, call_with_NULL_ctx) {
     uint8_t buf[100];
     size_t bytes_sent = 0;
@@ -392,6 +485,13 @@ ANJ_UNIT_TEST(udp_socket, call_with_NULL_ctx) {
                           ANJ_NET_EBADFD);
     ANJ_UNIT_ASSERT_EQUAL(anj_udp_recv(NULL, &bytes_received, buf, 10),
                           ANJ_NET_EBADFD);
+#ifdef ANJ_NET_WITH_BATCH_IO
+    size_t count = 0;
+    ANJ_UNIT_ASSERT_EQUAL(anj_udp_recv_batch(NULL, NULL, 0, &count),
+                          ANJ_NET_EBADFD);
+    ANJ_UNIT_ASSERT_EQUAL(anj_udp_send_batch(NULL, NULL, 0, &count),
+                          ANJ_NET_EBADFD);
+#endif // ANJ_NET_WITH_BATCH_IO
     ANJ_UNIT_ASSERT_EQUAL(anj_udp_close(NULL), ANJ_NET_EBADFD);
 
     ANJ_UNIT_ASSERT_EQUAL(anj_udp_cleanup_ctx(NULL), ANJ_NET_EBADFD);
@@ -410,10 +510,17 @@ ANJ_UNIT_TEST(udp_socket, connect_ipv4_invalid_hostname) {
 
     ANJ_UNIT_ASSERT_EQUAL(anj_udp_connect(udp_sock_ctx, NULL, DEFAULT_PORT),
                           ANJ_NET_EINVAL);
+#ifdef ANJ_NET_WITH_ASYNC_RESOLVE
     ANJ_UNIT_ASSERT_EQUAL(
             anj_udp_connect(udp_sock_ctx,
                             "supper_dummy_host_name_not_exist.com",
                             DEFAULT_PORT),
+            ANJ_NET_EINPROGRESS);
+#endif // ANJ_NET_WITH_ASYNC_RESOLVE
+    ANJ_UNIT_ASSERT_EQUAL(
+            udp_connect_wait(udp_sock_ctx,
+                             "supper_dummy_host_name_not_exist.com",
+                             DEFAULT_PORT),
             ANJ_NET_FAILED);
 
     /* after test cleanup */
@@ -421,6 +528,22 @@ ANJ_UNIT_TEST(udp_socket, connect_ipv4_invalid_hostname) {
     ANJ_UNIT_ASSERT_NULL(udp_sock_ctx);
 }
 
+#ifdef ANJ_NET_WITH_ASYNC_RESOLVE
+ANJ_UNIT_TEST(udp_socket, cleanup_during_resolution) {
+    anj_net_ctx_t *udp_sock_ctx = NULL;
+    ANJ_UNIT_ASSERT_EQUAL(anj_udp_create_ctx(&udp_sock_ctx, NULL), ANJ_NET_OK);
+
+    ANJ_UNIT_ASSERT_EQUAL(
+            anj_udp_connect(udp_sock_ctx,
+                            "supper_dummy_host_name_not_exist.com",
+                            DEFAULT_PORT),
+            ANJ_NET_EINPROGRESS);
+    // the resolver thread frees the abandoned job by itself
+    ANJ_UNIT_ASSERT_EQUAL(anj_udp_cleanup_ctx(&udp_sock_ctx), ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_NULL(udp_sock_ctx);
+}
+#endif // ANJ_NET_WITH_ASYNC_RESOLVE
+
 ANJ_UNIT_TEST(udp_socket, connect_invalid_port) {
     anj_net_ctx_t *udp_sock_ctx = NULL;
     anj_net_socket_configuration_t sock_config = {
@@ -539,3 +662,134 @@ ANJ_UNIT_TEST(udp_socket, op_on_already_closed_socket) {
     shutdown(sockfd, SHUT_RDWR);
     close(sockfd);
 }
+
+#ifdef ANJ_NET_WITH_POLL_HANDLE
+ANJ_UNIT_TEST(udp_socket, poll_handle) {
+    size_t bytes_sent = 0;
+    size_t bytes_received = 0;
+    anj_net_poll_handle_t handle;
+    bool data_pending;
+
+    anj_net_ctx_t *udp_sock_ctx = NULL;
+    anj_net_socket_configuration_t sock_config = {
+        .af_setting = ANJ_NET_AF_SETTING_FORCE_INET4
+    };
+    anj_net_config_t config = {
+        .raw_socket_config = sock_config
+    };
+    ANJ_UNIT_ASSERT_EQUAL(anj_udp_create_ctx(&udp_sock_ctx, &config),
+                          ANJ_NET_OK);
+
+    int sockfd = test_default_udp_connection(udp_sock_ctx, AF_INET);
+    ANJ_UNIT_ASSERT_EQUAL(anj_udp_get_poll_handle(udp_sock_ctx, &handle,
+                                                  &data_pending),
+                          ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_FALSE(data_pending);
+    struct pollfd pfd = {
+        .fd = handle.fd,
+        .events = POLLIN
+    };
+    ANJ_UNIT_ASSERT_EQUAL(poll(&pfd, 1, 0), 0);
+
+    ANJ_UNIT_ASSERT_EQUAL(anj_udp_send(udp_sock_ctx, &bytes_sent,
+                                       (const uint8_t *) "hello", 5),
+                          ANJ_NET_OK);
+    uint8_t buf[100];
+    struct sockaddr_in client_addr;
+    socklen_t client_addr_len = sizeof(client_addr);
+    ANJ_UNIT_ASSERT_EQUAL(recvfrom(sockfd, buf, sizeof(buf), 0,
+                                   (struct sockaddr *) &client_addr,
+                                   &client_addr_len),
+                          5);
+    ANJ_UNIT_ASSERT_EQUAL(sendto(sockfd, "world!", 6, 0,
+                                 (struct sockaddr *) &client_addr,
+                                 client_addr_len),
+                          6);
+
+    // handle becomes readable until the message is received
+    ANJ_UNIT_ASSERT_EQUAL(poll(&pfd, 1, 1000), 1);
+    ANJ_UNIT_ASSERT_TRUE(pfd.revents & POLLIN);
+    UDP_RECV(sizeof(buf));
+    ANJ_UNIT_ASSERT_EQUAL(bytes_received, 6);
+    ANJ_UNIT_ASSERT_EQUAL(poll(&pfd, 1, 0), 0);
+
+    ANJ_UNIT_ASSERT_EQUAL(anj_udp_close(udp_sock_ctx), ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL(anj_udp_get_poll_handle(udp_sock_ctx, &handle,
+                                                  &data_pending),
+                          ANJ_NET_EBADFD);
+
+    /* after test cleanup */
+    ANJ_UNIT_ASSERT_EQUAL(anj_udp_cleanup_ctx(&udp_sock_ctx), ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_NULL(udp_sock_ctx);
+    shutdown(sockfd, SHUT_RDWR);
+    close(sockfd);
+}
+#endif // ANJ_NET_WITH_POLL_HANDLE
+
+#if defined(ANJ_NET_WITH_HAPPY_EYEBALLS) && defined(ANJ_NET_WITH_POLL_HANDLE)
+static sa_family_t get_connected_family(anj_net_ctx_t *ctx) {
+    anj_net_poll_handle_t handle;
+    bool data_pending;
+    ANJ_UNIT_ASSERT_EQUAL(anj_udp_get_poll_handle(ctx, &handle, &data_pending),
+                          ANJ_NET_OK);
+    struct sockaddr_storage addr;
+    socklen_t addr_len = sizeof(addr);
+    ANJ_UNIT_ASSERT_EQUAL(getsockname(handle.fd, (struct sockaddr *) &addr,
+                                      &addr_len),
+                          0);
+    return addr.ss_family;
+}
+
+ANJ_UNIT_TEST(udp_socket, happy_eyeballs_other_family) {
+    anj_net_ctx_t *udp_sock_ctx = NULL;
+    anj_net_socket_configuration_t sock_config = {
+        .af_setting = ANJ_NET_AF_SETTING_PREFERRED_INET6
+    };
+    anj_net_config_t config = {
+        .raw_socket_config = sock_config
+    };
+    ANJ_UNIT_ASSERT_EQUAL(anj_udp_create_ctx(&udp_sock_ctx, &config),
+                          ANJ_NET_OK);
+
+    // there is no IPv6 address to try for a numeric IPv4 one
+    int sockfd = test_default_udp_connection(udp_sock_ctx, AF_INET);
+    ANJ_UNIT_ASSERT_EQUAL(get_connected_family(udp_sock_ctx), AF_INET);
+    ANJ_UNIT_ASSERT_EQUAL(anj_udp_close(udp_sock_ctx), ANJ_NET_OK);
+
+    // reconnecting goes the same way
+    ANJ_UNIT_ASSERT_EQUAL(udp_connect_wait(udp_sock_ctx, DEFAULT_HOST_IPV4,
+                                           DEFAULT_PORT),
+                          ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL(get_connected_family(udp_sock_ctx), AF_INET);
+
+    /* after test cleanup */
+    ANJ_UNIT_ASSERT_EQUAL(anj_udp_cleanup_ctx(&udp_sock_ctx), ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_NULL(udp_sock_ctx);
+    shutdown(sockfd, SHUT_RDWR);
+    close(sockfd);
+}
+
+ANJ_UNIT_TEST(udp_socket, happy_eyeballs_hostname) {
+    anj_net_ctx_t *udp_sock_ctx = NULL;
+    ANJ_UNIT_ASSERT_EQUAL(anj_udp_create_ctx(&udp_sock_ctx, NULL), ANJ_NET_OK);
+
+    int sockfd = test_udp_connection_by_hostname(udp_sock_ctx, AF_INET,
+                                                 DEFAULT_HOSTNAME);
+    sa_family_t family = get_connected_family(udp_sock_ctx);
+    ANJ_UNIT_ASSERT_TRUE(family == AF_INET || family == AF_INET6);
+    ANJ_UNIT_ASSERT_EQUAL(anj_udp_close(udp_sock_ctx), ANJ_NET_OK);
+
+    // the family that worked is remembered for the host
+    ANJ_UNIT_ASSERT_EQUAL(udp_connect_wait(udp_sock_ctx, DEFAULT_HOSTNAME,
+                                           DEFAULT_PORT),
+                          ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL(get_connected_family(udp_sock_ctx), family);
+
+    /* after test cleanup */
+    ANJ_UNIT_ASSERT_EQUAL(anj_udp_cleanup_ctx(&udp_sock_ctx), ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_NULL(udp_sock_ctx);
+    shutdown(sockfd, SHUT_RDWR);
+    close(sockfd);
+}
+#endif // defined(ANJ_NET_WITH_HAPPY_EYEBALLS) &&
+       // defined(ANJ_NET_WITH_POLL_HANDLE)
@@ -0,0 +1,291 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(__APPLE__)
+#    define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <anj/compat/rng.h>
+
+#include <mbedtls/ecp.h>
+#include <mbedtls/md.h>
+#include <mbedtls/net_sockets.h>
+#include <mbedtls/pk.h>
+#include <mbedtls/ssl.h>
+#include <mbedtls/timing.h>
+#include <mbedtls/x509_crt.h>
+
+#include "dtls_server.h"
+
+static int server_rng(void *ctx, unsigned char *out, size_t len) {
+    (void) ctx;
+    return anj_rng_generate((uint8_t *) out, len) ? -1 : 0;
+}
+
+static int server_send(void *ctx, const unsigned char *buf, size_t len) {
+    dtls_server_t *server = (dtls_server_t *) ctx;
+    ssize_t res = sendto(server->fd, buf, len, 0,
+                         (const struct sockaddr *) &server->peer,
+                         server->peer_len);
+    if (res < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK
+                       ? MBEDTLS_ERR_SSL_WANT_WRITE
+                       : MBEDTLS_ERR_NET_SEND_FAILED;
+    }
+    return (int) res;
+}
+
+static int server_recv(void *ctx, unsigned char *buf, size_t len) {
+    dtls_server_t *server = (dtls_server_t *) ctx;
+    struct sockaddr_storage addr;
+    socklen_t addr_len = sizeof(addr);
+    ssize_t res = recvfrom(server->fd, buf, len, 0, (struct sockaddr *) &addr,
+                           &addr_len);
+    if (res < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK
+                       ? MBEDTLS_ERR_SSL_WANT_READ
+                       : MBEDTLS_ERR_NET_RECV_FAILED;
+    }
+    memcpy(&server->peer, &addr, addr_len);
+    server->peer_len = addr_len;
+    return (int) res;
+}
+
+static int open_socket(dtls_server_t *server) {
+    struct sockaddr_in addr = { 0 };
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    // port chosen by the system
+    addr.sin_port = 0;
+    socklen_t addr_len = sizeof(addr);
+
+    server->fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (server->fd < 0) {
+        return -1;
+    }
+    int flags = fcntl(server->fd, F_GETFL);
+    if (flags < 0 || fcntl(server->fd, F_SETFL, flags | O_NONBLOCK)
+            || bind(server->fd, (struct sockaddr *) &addr, sizeof(addr))
+            || getsockname(server->fd, (struct sockaddr *) &addr, &addr_len)) {
+        close(server->fd);
+        return -1;
+    }
+    snprintf(server->port, sizeof(server->port), "%u",
+             (unsigned) ntohs(addr.sin_port));
+    return 0;
+}
+
+static int init_common(dtls_server_t *server) {
+    memset(server, 0, sizeof(*server));
+    mbedtls_ssl_init(&server->ssl);
+    mbedtls_ssl_config_init(&server->conf);
+    mbedtls_x509_crt_init(&server->cert);
+    mbedtls_pk_init(&server->key);
+    if (open_socket(server)) {
+        server->fd = -1;
+        return -1;
+    }
+    if (mbedtls_ssl_config_defaults(&server->conf, MBEDTLS_SSL_IS_SERVER,
+                                    MBEDTLS_SSL_TRANSPORT_DATAGRAM,
+                                    MBEDTLS_SSL_PRESET_DEFAULT)) {
+        return -1;
+    }
+    mbedtls_ssl_conf_rng(&server->conf, server_rng, NULL);
+    mbedtls_ssl_conf_min_tls_version(&server->conf,
+                                     MBEDTLS_SSL_VERSION_TLS1_2);
+    mbedtls_ssl_conf_max_tls_version(&server->conf,
+                                     MBEDTLS_SSL_VERSION_TLS1_2);
+    // the client is on the loopback interface, HelloVerifyRequest would only
+    // add a round trip
+    mbedtls_ssl_conf_dtls_cookies(&server->conf, NULL, NULL, NULL);
+    return 0;
+}
+
+static int setup_ssl(dtls_server_t *server) {
+    if (mbedtls_ssl_setup(&server->ssl, &server->conf)) {
+        return -1;
+    }
+    mbedtls_ssl_set_timer_cb(&server->ssl, &server->timer,
+                             mbedtls_timing_set_delay,
+                             mbedtls_timing_get_delay);
+    mbedtls_ssl_set_bio(&server->ssl, server, server_send, server_recv, NULL);
+    return 0;
+}
+
+int dtls_server_init_psk(dtls_server_t *server,
+                         const char *identity,
+                         const uint8_t *key,
+                         size_t key_len) {
+    static const int suites[] = { MBEDTLS_TLS_PSK_WITH_AES_128_CCM_8, 0 };
+    if (init_common(server)
+            || mbedtls_ssl_conf_psk(&server->conf, key, key_len,
+                                    (const unsigned char *) identity,
+                                    strlen(identity))) {
+        dtls_server_cleanup(server);
+        return -1;
+    }
+    mbedtls_ssl_conf_ciphersuites(&server->conf, suites);
+    if (setup_ssl(server)) {
+        dtls_server_cleanup(server);
+        return -1;
+    }
+    return 0;
+}
+
+int dtls_server_gen_key(uint8_t *spki,
+                        size_t *spki_len,
+                        uint8_t *key,
+                        size_t *key_len) {
+    mbedtls_pk_context pk;
+    mbedtls_pk_init(&pk);
+    int spki_res = -1;
+    int key_res = -1;
+    if (!mbedtls_pk_setup(&pk, mbedtls_pk_info_from_type(MBEDTLS_PK_ECKEY))
+            && !mbedtls_ecp_gen_key(MBEDTLS_ECP_DP_SECP256R1, mbedtls_pk_ec(pk),
+                                    server_rng, NULL)) {
+        // both are written at the end of the buffer
+        spki_res = mbedtls_pk_write_pubkey_der(&pk, spki,
+                                               DTLS_SERVER_KEY_MAX_LEN);
+        key_res = mbedtls_pk_write_key_der(&pk, key, DTLS_SERVER_KEY_MAX_LEN);
+    }
+    mbedtls_pk_free(&pk);
+    if (spki_res <= 0 || key_res <= 0) {
+        return -1;
+    }
+    *spki_len = (size_t) spki_res;
+    memmove(spki, spki + DTLS_SERVER_KEY_MAX_LEN - *spki_len, *spki_len);
+    *key_len = (size_t) key_res;
+    memmove(key, key + DTLS_SERVER_KEY_MAX_LEN - *key_len, *key_len);
+    return 0;
+}
+
+static int self_signed_cert(dtls_server_t *server) {
+    static const char name[] = "CN=localhost";
+    unsigned char serial[] = { 1 };
+    unsigned char der[2 * DTLS_SERVER_KEY_MAX_LEN];
+    mbedtls_x509write_cert writer;
+    mbedtls_x509write_crt_init(&writer);
+    mbedtls_x509write_crt_set_version(&writer, MBEDTLS_X509_CRT_VERSION_3);
+    mbedtls_x509write_crt_set_md_alg(&writer, MBEDTLS_MD_SHA256);
+    mbedtls_x509write_crt_set_subject_key(&writer, &server->key);
+    mbedtls_x509write_crt_set_issuer_key(&writer, &server->key);
+    int res = -1;
+    if (!mbedtls_x509write_crt_set_serial_raw(&writer, serial, sizeof(serial))
+            && !mbedtls_x509write_crt_set_validity(&writer, "20000101000000",
+                                                   "99991231235959")
+            && !mbedtls_x509write_crt_set_subject_name(&writer, name)
+            && !mbedtls_x509write_crt_set_issuer_name(&writer, name)) {
+        res = mbedtls_x509write_crt_der(&writer, der, sizeof(der), server_rng,
+                                        NULL);
+    }
+    mbedtls_x509write_crt_free(&writer);
+    if (res <= 0) {
+        return -1;
+    }
+    return mbedtls_x509_crt_parse_der(&server->cert,
+                                      der + sizeof(der) - (size_t) res,
+                                      (size_t) res);
+}
+
+static int verify_client_key(void *ctx,
+                             mbedtls_x509_crt *crt,
+                             int depth,
+                             uint32_t *flags) {
+    dtls_server_t *server = (dtls_server_t *) ctx;
+    if (depth == 0 && crt->pk_raw.len == server->client_key_len
+            && !memcmp(crt->pk_raw.p, server->client_key, crt->pk_raw.len)) {
+        server->client_key_verified = true;
+    }
+    *flags = 0;
+    return 0;
+}
+
+int dtls_server_init_rpk(dtls_server_t *server,
+                         const uint8_t *key,
+                         size_t key_len,
+                         const uint8_t *client_key,
+                         size_t client_key_len) {
+    static const int suites[] = { MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_CCM_8,
+                                  0 };
+    if (init_common(server) || client_key_len > sizeof(server->client_key)
+            || mbedtls_pk_parse_key(&server->key, key, key_len, NULL, 0,
+                                    server_rng, NULL)
+            || self_signed_cert(server)
+            || mbedtls_ssl_conf_own_cert(&server->conf, &server->cert,
+                                         &server->key)) {
+        dtls_server_cleanup(server);
+        return -1;
+    }
+    memcpy(server->client_key, client_key, client_key_len);
+    server->client_key_len = client_key_len;
+    // the client's certificate is only checked in verify_client_key()
+    mbedtls_ssl_conf_authmode(&server->conf, MBEDTLS_SSL_VERIFY_OPTIONAL);
+    mbedtls_ssl_conf_verify(&server->conf, verify_client_key, server);
+    mbedtls_ssl_conf_ciphersuites(&server->conf, suites);
+    if (setup_ssl(server)) {
+        dtls_server_cleanup(server);
+        return -1;
+    }
+    return 0;
+}
+
+static bool is_retry_result(int res) {
+    return res == MBEDTLS_ERR_SSL_WANT_READ
+           || res == MBEDTLS_ERR_SSL_WANT_WRITE;
+}
+
+void dtls_server_step(dtls_server_t *server) {
+    if (server->error) {
+        return;
+    }
+    int res;
+    if (!server->handshake_done) {
+        res = mbedtls_ssl_handshake(&server->ssl);
+        if (is_retry_result(res)) {
+            return;
+        } else if (res) {
+            server->error = res;
+            return;
+        }
+        server->handshake_done = true;
+        server->handshakes++;
+    }
+    unsigned char buf[256];
+    res = mbedtls_ssl_read(&server->ssl, buf, sizeof(buf));
+    if (is_retry_result(res)) {
+        return;
+    } else if (res <= 0) {
+        server->error = res ? res : -1;
+        return;
+    }
+    res = mbedtls_ssl_write(&server->ssl, buf, (size_t) res);
+    if (res < 0) {
+        server->error = res;
+    }
+}
+
+void dtls_server_cleanup(dtls_server_t *server) {
+    mbedtls_ssl_free(&server->ssl);
+    mbedtls_ssl_config_free(&server->conf);
+    mbedtls_x509_crt_free(&server->cert);
+    mbedtls_pk_free(&server->key);
+    if (server->fd >= 0) {
+        close(server->fd);
+        server->fd = -1;
+    }
+}
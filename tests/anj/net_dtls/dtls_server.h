@@ -0,0 +1,79 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef DTLS_SERVER_H
+#define DTLS_SERVER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+
+#include <mbedtls/pk.h>
+#include <mbedtls/ssl.h>
+#include <mbedtls/timing.h>
+#include <mbedtls/x509_crt.h>
+
+#define DTLS_SERVER_KEY_MAX_LEN 256
+
+// MbedTLS DTLS server on the loopback interface, driven from the test thread
+// with dtls_server_step(), which echoes every received record. Its socket is
+// not connected, responses go to the address of the last received datagram,
+// so the client may come back from another port.
+typedef struct {
+    int fd;
+    char port[6];
+    struct sockaddr_storage peer;
+    socklen_t peer_len;
+
+    mbedtls_ssl_context ssl;
+    mbedtls_ssl_config conf;
+    mbedtls_timing_delay_context timer;
+
+    // Raw Public Key mode only
+    mbedtls_x509_crt cert;
+    mbedtls_pk_context key;
+    uint8_t client_key[DTLS_SERVER_KEY_MAX_LEN];
+    size_t client_key_len;
+    // set if the client presented exactly client_key
+    bool client_key_verified;
+
+    bool handshake_done;
+    // first error reported by MbedTLS, the server is not stepped after it
+    int error;
+    // number of the handshakes completed by the server
+    int handshakes;
+} dtls_server_t;
+
+int dtls_server_init_psk(dtls_server_t *server,
+                         const char *identity,
+                         const uint8_t *key,
+                         size_t key_len);
+
+// Raw Public Key mode: the server sends its key in a self-signed certificate
+// and accepts only a client presenting exactly the client_key
+// SubjectPublicKeyInfo.
+int dtls_server_init_rpk(dtls_server_t *server,
+                         const uint8_t *key,
+                         size_t key_len,
+                         const uint8_t *client_key,
+                         size_t client_key_len);
+
+// Generates a P-256 key pair: the DER SubjectPublicKeyInfo and the DER private
+// key, both of at most DTLS_SERVER_KEY_MAX_LEN bytes.
+int dtls_server_gen_key(uint8_t *spki,
+                        size_t *spki_len,
+                        uint8_t *key,
+                        size_t *key_len);
+
+void dtls_server_step(dtls_server_t *server);
+
+void dtls_server_cleanup(dtls_server_t *server);
+
+#endif // DTLS_SERVER_H
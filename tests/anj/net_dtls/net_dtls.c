@@ -0,0 +1,545 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(__APPLE__)
+#    define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <poll.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/compat/crypto/storage.h>
+#include <anj/compat/net/anj_dtls.h>
+#include <anj/compat/net/anj_net_api.h>
+#include <anj/crypto.h>
+#include <anj/persistence.h>
+
+#include <anj_unit_test.h>
+
+#include "dtls_server.h"
+
+#define SERVER_HOST "127.0.0.1"
+// handshake on the loopback interface takes a few round trips, one step of
+// the client and the server is done every millisecond
+#define MAX_STEPS 5000
+
+#define PSK_IDENTITY "anjay-lite-test"
+static const uint8_t PSK_KEY[] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05,
+                                   0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B,
+                                   0x0C, 0x0D, 0x0E, 0x0F };
+
+static void psk_config(anj_net_config_t *config) {
+    memset(config, 0, sizeof(*config));
+    config->raw_socket_config.af_setting = ANJ_NET_AF_SETTING_FORCE_INET4;
+    config->secure_socket_config.security.mode = ANJ_NET_SECURITY_PSK;
+    anj_net_psk_info_t *psk = &config->secure_socket_config.security.data.psk;
+    psk->key.tag = ANJ_CRYPTO_SECURITY_TAG_PSK_KEY;
+    psk->key.source = ANJ_CRYPTO_DATA_SOURCE_BUFFER;
+    psk->key.info.buffer.data = PSK_KEY;
+    psk->key.info.buffer.data_size = sizeof(PSK_KEY);
+    psk->identity.tag = ANJ_CRYPTO_SECURITY_TAG_PSK_IDENTITY;
+    psk->identity.source = ANJ_CRYPTO_DATA_SOURCE_BUFFER;
+    psk->identity.info.buffer.data = PSK_IDENTITY;
+    psk->identity.info.buffer.data_size = strlen(PSK_IDENTITY);
+}
+
+static int connect_to(anj_net_ctx_t *ctx, dtls_server_t *server) {
+    int res = ANJ_NET_EINPROGRESS;
+    for (int i = 0; i < MAX_STEPS && res == ANJ_NET_EINPROGRESS; i++) {
+        res = anj_dtls_connect(ctx, SERVER_HOST, server->port);
+        dtls_server_step(server);
+        poll(NULL, 0, 1);
+    }
+    return res;
+}
+
+// the server sends back every message
+static void echo(anj_net_ctx_t *ctx, dtls_server_t *server, const char *msg) {
+    size_t sent = 0;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_send(ctx, &sent, (const uint8_t *) msg,
+                                        strlen(msg)),
+                          ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL(sent, strlen(msg));
+
+    uint8_t buf[64];
+    size_t received = 0;
+    int res = ANJ_NET_EAGAIN;
+    for (int i = 0; i < MAX_STEPS && res == ANJ_NET_EAGAIN; i++) {
+        dtls_server_step(server);
+        res = anj_dtls_recv(ctx, &received, buf, sizeof(buf));
+        poll(NULL, 0, 1);
+    }
+    ANJ_UNIT_ASSERT_EQUAL(res, ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL(received, strlen(msg));
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, msg, received);
+}
+
+ANJ_UNIT_TEST(dtls_socket, psk_handshake) {
+    dtls_server_t server;
+    ANJ_UNIT_ASSERT_SUCCESS(dtls_server_init_psk(&server, PSK_IDENTITY, PSK_KEY,
+                                                 sizeof(PSK_KEY)));
+    anj_net_config_t config;
+    psk_config(&config);
+    anj_net_ctx_t *ctx = NULL;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_create_ctx(&ctx, &config), ANJ_NET_OK);
+
+    ANJ_UNIT_ASSERT_EQUAL(connect_to(ctx, &server), ANJ_NET_OK);
+    anj_net_socket_state_t state;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_get_state(ctx, &state), ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL(state, ANJ_NET_SOCKET_STATE_CONNECTED);
+    echo(ctx, &server, "ping");
+    ANJ_UNIT_ASSERT_EQUAL(server.handshakes, 1);
+
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_cleanup_ctx(&ctx), ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_NULL(ctx);
+    dtls_server_cleanup(&server);
+}
+
+ANJ_UNIT_TEST(dtls_socket, max_fragment_length) {
+    dtls_server_t server;
+    ANJ_UNIT_ASSERT_SUCCESS(dtls_server_init_psk(&server, PSK_IDENTITY, PSK_KEY,
+                                                 sizeof(PSK_KEY)));
+    anj_net_config_t config;
+    psk_config(&config);
+    anj_net_ctx_t *ctx = NULL;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_create_ctx(&ctx, &config), ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL(connect_to(ctx, &server), ANJ_NET_OK);
+
+    // both message buffers are 1000 bytes long, the extension negotiated by
+    // the client limits the records sent by the server to 1024 bytes
+    ANJ_UNIT_ASSERT_EQUAL(mbedtls_ssl_get_output_max_frag_len(&server.ssl),
+                          1024);
+    echo(ctx, &server, "ping");
+
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_cleanup_ctx(&ctx), ANJ_NET_OK);
+    dtls_server_cleanup(&server);
+}
+
+ANJ_UNIT_TEST(dtls_socket, handshake_metrics) {
+    dtls_server_t server;
+    ANJ_UNIT_ASSERT_SUCCESS(dtls_server_init_psk(&server, PSK_IDENTITY, PSK_KEY,
+                                                 sizeof(PSK_KEY)));
+    anj_net_config_t config;
+    psk_config(&config);
+    anj_net_ctx_t *ctx = NULL;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_create_ctx(&ctx, &config), ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL(connect_to(ctx, &server), ANJ_NET_OK);
+
+    anj_dtls_handshake_metrics_t metrics;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_get_handshake_metrics(ctx, &metrics),
+                          ANJ_NET_OK);
+    // ClientHello and the flight with Finished, possibly packed together
+    ANJ_UNIT_ASSERT_TRUE(metrics.datagrams_sent >= 2);
+    ANJ_UNIT_ASSERT_TRUE(metrics.bytes_sent > metrics.datagrams_sent);
+    ANJ_UNIT_ASSERT_EQUAL(metrics.retransmissions, 0);
+    ANJ_UNIT_ASSERT_TRUE(metrics.duration_ms < MAX_STEPS);
+
+    // application data is not counted
+    echo(ctx, &server, "ping");
+    anj_dtls_handshake_metrics_t after_echo;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_get_handshake_metrics(ctx, &after_echo),
+                          ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(&after_echo, &metrics, sizeof(metrics));
+
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_cleanup_ctx(&ctx), ANJ_NET_OK);
+    dtls_server_cleanup(&server);
+}
+
+ANJ_UNIT_TEST(dtls_socket, handshake_metrics_retransmission) {
+    dtls_server_t server;
+    ANJ_UNIT_ASSERT_SUCCESS(dtls_server_init_psk(&server, PSK_IDENTITY, PSK_KEY,
+                                                 sizeof(PSK_KEY)));
+    anj_net_config_t config;
+    psk_config(&config);
+    anj_net_ctx_t *ctx = NULL;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_create_ctx(&ctx, &config), ANJ_NET_OK);
+
+    // the server does not respond for longer than the initial handshake
+    // timeout, so ClientHello is sent again
+    for (int i = 0; i < 3 * ANJ_MBEDTLS_HS_INITIAL_TIMEOUT_VALUE_MS / 2; i++) {
+        ANJ_UNIT_ASSERT_EQUAL(anj_dtls_connect(ctx, SERVER_HOST, server.port),
+                              ANJ_NET_EINPROGRESS);
+        poll(NULL, 0, 1);
+    }
+    ANJ_UNIT_ASSERT_EQUAL(connect_to(ctx, &server), ANJ_NET_OK);
+
+    anj_dtls_handshake_metrics_t metrics;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_get_handshake_metrics(ctx, &metrics),
+                          ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_TRUE(metrics.retransmissions >= 1);
+    ANJ_UNIT_ASSERT_TRUE(metrics.datagrams_sent >= 3);
+    ANJ_UNIT_ASSERT_TRUE(metrics.duration_ms
+                         >= ANJ_MBEDTLS_HS_INITIAL_TIMEOUT_VALUE_MS);
+
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_cleanup_ctx(&ctx), ANJ_NET_OK);
+    dtls_server_cleanup(&server);
+}
+
+ANJ_UNIT_TEST(dtls_socket, psk_unknown_identity) {
+    dtls_server_t server;
+    ANJ_UNIT_ASSERT_SUCCESS(dtls_server_init_psk(&server, "other-identity",
+                                                 PSK_KEY, sizeof(PSK_KEY)));
+    anj_net_config_t config;
+    psk_config(&config);
+    anj_net_ctx_t *ctx = NULL;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_create_ctx(&ctx, &config), ANJ_NET_OK);
+
+    // the server responds with a fatal alert
+    ANJ_UNIT_ASSERT_EQUAL(connect_to(ctx, &server), -1);
+    ANJ_UNIT_ASSERT_EQUAL(server.handshakes, 0);
+
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_cleanup_ctx(&ctx), ANJ_NET_OK);
+    dtls_server_cleanup(&server);
+}
+
+// Crypto storage resolving "psk-key" and "psk-identity" records; each of them
+// is reported as in progress the first time it is requested.
+typedef struct {
+    int calls;
+    int in_progress_calls;
+    bool fail;
+    bool key_pending;
+    bool identity_pending;
+} crypto_storage_t;
+
+int anj_crypto_storage_resolve_security_info(
+        void *crypto_ctx,
+        anj_crypto_security_info_external_t *info,
+        char *out_buffer,
+        size_t out_buffer_size,
+        size_t *out_record_size) {
+    crypto_storage_t *storage = (crypto_storage_t *) crypto_ctx;
+    storage->calls++;
+    if (storage->fail) {
+        return -1;
+    }
+    bool *pending;
+    const void *data;
+    size_t size;
+    if (!strcmp(info->identity, "psk-key")) {
+        pending = &storage->key_pending;
+        data = PSK_KEY;
+        size = sizeof(PSK_KEY);
+    } else if (!strcmp(info->identity, "psk-identity")) {
+        pending = &storage->identity_pending;
+        data = PSK_IDENTITY;
+        size = strlen(PSK_IDENTITY);
+    } else {
+        return -1;
+    }
+    if (!*pending) {
+        *pending = true;
+        storage->in_progress_calls++;
+        return ANJ_CRYPTO_STORAGE_IN_PROGRESS;
+    }
+    if (size > out_buffer_size) {
+        return -1;
+    }
+    memcpy(out_buffer, data, size);
+    *out_record_size = size;
+    return 0;
+}
+
+static void external_psk_config(anj_net_config_t *config,
+                                crypto_storage_t *storage) {
+    psk_config(config);
+    config->secure_socket_config.crypto_ctx = storage;
+    anj_net_psk_info_t *psk = &config->secure_socket_config.security.data.psk;
+    psk->key.source = ANJ_CRYPTO_DATA_SOURCE_EXTERNAL;
+    psk->key.info.external.identity = "psk-key";
+    psk->identity.source = ANJ_CRYPTO_DATA_SOURCE_EXTERNAL;
+    psk->identity.info.external.identity = "psk-identity";
+}
+
+ANJ_UNIT_TEST(dtls_socket, async_crypto_storage) {
+    dtls_server_t server;
+    ANJ_UNIT_ASSERT_SUCCESS(dtls_server_init_psk(&server, PSK_IDENTITY, PSK_KEY,
+                                                 sizeof(PSK_KEY)));
+    crypto_storage_t storage = { 0 };
+    anj_net_config_t config;
+    external_psk_config(&config, &storage);
+    anj_net_ctx_t *ctx = NULL;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_create_ctx(&ctx, &config), ANJ_NET_OK);
+
+    // nothing is sent until the key is available
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_connect(ctx, SERVER_HOST, server.port),
+                          ANJ_NET_EINPROGRESS);
+    ANJ_UNIT_ASSERT_EQUAL(storage.calls, 1);
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_connect(ctx, SERVER_HOST, server.port),
+                          ANJ_NET_EINPROGRESS);
+    ANJ_UNIT_ASSERT_EQUAL(storage.calls, 3);
+    dtls_server_step(&server);
+    ANJ_UNIT_ASSERT_EQUAL(server.error, 0);
+    ANJ_UNIT_ASSERT_FALSE(server.handshake_done);
+
+    ANJ_UNIT_ASSERT_EQUAL(connect_to(ctx, &server), ANJ_NET_OK);
+    // the key resolved in the first call is not requested again
+    ANJ_UNIT_ASSERT_EQUAL(storage.calls, 4);
+    ANJ_UNIT_ASSERT_EQUAL(storage.in_progress_calls, 2);
+    echo(ctx, &server, "ping");
+
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_cleanup_ctx(&ctx), ANJ_NET_OK);
+    dtls_server_cleanup(&server);
+}
+
+ANJ_UNIT_TEST(dtls_socket, async_crypto_storage_error) {
+    dtls_server_t server;
+    ANJ_UNIT_ASSERT_SUCCESS(dtls_server_init_psk(&server, PSK_IDENTITY, PSK_KEY,
+                                                 sizeof(PSK_KEY)));
+    crypto_storage_t storage = { 0 };
+    anj_net_config_t config;
+    external_psk_config(&config, &storage);
+    anj_net_ctx_t *ctx = NULL;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_create_ctx(&ctx, &config), ANJ_NET_OK);
+
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_connect(ctx, SERVER_HOST, server.port),
+                          ANJ_NET_EINPROGRESS);
+    storage.fail = true;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_connect(ctx, SERVER_HOST, server.port), -1);
+    ANJ_UNIT_ASSERT_EQUAL(storage.calls, 2);
+    dtls_server_step(&server);
+    ANJ_UNIT_ASSERT_EQUAL(server.error, 0);
+    ANJ_UNIT_ASSERT_FALSE(server.handshake_done);
+
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_cleanup_ctx(&ctx), ANJ_NET_OK);
+    dtls_server_cleanup(&server);
+}
+
+typedef struct {
+    uint8_t spki[DTLS_SERVER_KEY_MAX_LEN];
+    size_t spki_len;
+    uint8_t key[DTLS_SERVER_KEY_MAX_LEN];
+    size_t key_len;
+} key_pair_t;
+
+static void gen_key(key_pair_t *pair) {
+    ANJ_UNIT_ASSERT_SUCCESS(dtls_server_gen_key(pair->spki, &pair->spki_len,
+                                                pair->key, &pair->key_len));
+}
+
+static void set_buffer(anj_crypto_security_info_t *info,
+                       anj_crypto_security_tag_t tag,
+                       const uint8_t *data,
+                       size_t size) {
+    info->tag = tag;
+    info->source = ANJ_CRYPTO_DATA_SOURCE_BUFFER;
+    info->info.buffer.data = data;
+    info->info.buffer.data_size = size;
+}
+
+static void rpk_config(anj_net_config_t *config,
+                       const key_pair_t *client_public,
+                       const key_pair_t *client_private,
+                       const key_pair_t *server) {
+    memset(config, 0, sizeof(*config));
+    config->raw_socket_config.af_setting = ANJ_NET_AF_SETTING_FORCE_INET4;
+    config->secure_socket_config.security.mode = ANJ_NET_SECURITY_RPK;
+    anj_net_rpk_info_t *rpk = &config->secure_socket_config.security.data.rpk;
+    set_buffer(&rpk->public_key, ANJ_CRYPTO_SECURITY_TAG_CERTIFICATE_CHAIN,
+               client_public->spki, client_public->spki_len);
+    set_buffer(&rpk->private_key, ANJ_CRYPTO_SECURITY_TAG_PRIVATE_KEY,
+               client_private->key, client_private->key_len);
+    set_buffer(&rpk->server_public_key,
+               ANJ_CRYPTO_SECURITY_TAG_CERTIFICATE_CHAIN, server->spki,
+               server->spki_len);
+}
+
+ANJ_UNIT_TEST(dtls_socket, rpk_handshake) {
+    key_pair_t client_keys;
+    key_pair_t server_keys;
+    gen_key(&client_keys);
+    gen_key(&server_keys);
+    dtls_server_t server;
+    ANJ_UNIT_ASSERT_SUCCESS(dtls_server_init_rpk(
+            &server, server_keys.key, server_keys.key_len, client_keys.spki,
+            client_keys.spki_len));
+    anj_net_config_t config;
+    rpk_config(&config, &client_keys, &client_keys, &server_keys);
+    anj_net_ctx_t *ctx = NULL;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_create_ctx(&ctx, &config), ANJ_NET_OK);
+
+    ANJ_UNIT_ASSERT_EQUAL(connect_to(ctx, &server), ANJ_NET_OK);
+    echo(ctx, &server, "ping");
+    // the client's key is sent in the generated self-signed certificate
+    ANJ_UNIT_ASSERT_TRUE(server.client_key_verified);
+
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_cleanup_ctx(&ctx), ANJ_NET_OK);
+    dtls_server_cleanup(&server);
+}
+
+ANJ_UNIT_TEST(dtls_socket, rpk_unexpected_server_key) {
+    key_pair_t client_keys;
+    key_pair_t server_keys;
+    key_pair_t other_keys;
+    gen_key(&client_keys);
+    gen_key(&server_keys);
+    gen_key(&other_keys);
+    dtls_server_t server;
+    ANJ_UNIT_ASSERT_SUCCESS(dtls_server_init_rpk(
+            &server, server_keys.key, server_keys.key_len, client_keys.spki,
+            client_keys.spki_len));
+    anj_net_config_t config;
+    rpk_config(&config, &client_keys, &client_keys, &other_keys);
+    anj_net_ctx_t *ctx = NULL;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_create_ctx(&ctx, &config), ANJ_NET_OK);
+
+    ANJ_UNIT_ASSERT_EQUAL(connect_to(ctx, &server), -1);
+    anj_net_socket_state_t state;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_get_state(ctx, &state), ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_NOT_EQUAL(state, ANJ_NET_SOCKET_STATE_CONNECTED);
+
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_cleanup_ctx(&ctx), ANJ_NET_OK);
+    dtls_server_cleanup(&server);
+}
+
+ANJ_UNIT_TEST(dtls_socket, rpk_key_pair_mismatch) {
+    key_pair_t client_keys;
+    key_pair_t server_keys;
+    key_pair_t other_keys;
+    gen_key(&client_keys);
+    gen_key(&server_keys);
+    gen_key(&other_keys);
+    dtls_server_t server;
+    ANJ_UNIT_ASSERT_SUCCESS(dtls_server_init_rpk(
+            &server, server_keys.key, server_keys.key_len, client_keys.spki,
+            client_keys.spki_len));
+    anj_net_config_t config;
+    rpk_config(&config, &client_keys, &other_keys, &server_keys);
+    anj_net_ctx_t *ctx = NULL;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_create_ctx(&ctx, &config), ANJ_NET_OK);
+
+    // Public Key and Secret Key are checked before the handshake starts
+    ANJ_UNIT_ASSERT_EQUAL(connect_to(ctx, &server), -1);
+    ANJ_UNIT_ASSERT_EQUAL(server.handshakes, 0);
+
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_cleanup_ctx(&ctx), ANJ_NET_OK);
+    dtls_server_cleanup(&server);
+}
+
+typedef struct {
+    uint8_t data[2048];
+    size_t size;
+    size_t read_offset;
+} flash_t;
+
+static int flash_write(void *ctx, const void *buf, size_t size) {
+    flash_t *flash = (flash_t *) ctx;
+    if (flash->size + size > sizeof(flash->data)) {
+        return -1;
+    }
+    memcpy(flash->data + flash->size, buf, size);
+    flash->size += size;
+    return 0;
+}
+
+static int flash_read(void *ctx, void *buf, size_t size) {
+    flash_t *flash = (flash_t *) ctx;
+    if (flash->read_offset + size > flash->size) {
+        return -1;
+    }
+    memcpy(buf, flash->data + flash->read_offset, size);
+    flash->read_offset += size;
+    return 0;
+}
+
+static void store_session(anj_net_ctx_t *ctx, flash_t *flash) {
+    anj_persistence_context_t persistence =
+            anj_persistence_store_context_create(flash_write, flash);
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_session_store(ctx, &persistence),
+                          ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_NOT_EQUAL(flash->size, 0);
+    // the context is serialized and reset by MbedTLS, so the socket is
+    // closed as well
+    anj_net_socket_state_t state;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_get_state(ctx, &state), ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL(state, ANJ_NET_SOCKET_STATE_CLOSED);
+}
+
+ANJ_UNIT_TEST(dtls_session_persistence, store_requires_connection) {
+    anj_net_config_t config;
+    psk_config(&config);
+    anj_net_ctx_t *ctx = NULL;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_create_ctx(&ctx, &config), ANJ_NET_OK);
+
+    flash_t flash = { 0 };
+    anj_persistence_context_t persistence =
+            anj_persistence_store_context_create(flash_write, &flash);
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_session_store(ctx, &persistence),
+                          ANJ_NET_ENOTSUP);
+    ANJ_UNIT_ASSERT_EQUAL(flash.size, 0);
+
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_cleanup_ctx(&ctx), ANJ_NET_OK);
+}
+
+ANJ_UNIT_TEST(dtls_session_persistence, store_restore_reconnect) {
+    dtls_server_t server;
+    ANJ_UNIT_ASSERT_SUCCESS(dtls_server_init_psk(&server, PSK_IDENTITY, PSK_KEY,
+                                                 sizeof(PSK_KEY)));
+    anj_net_config_t config;
+    psk_config(&config);
+    anj_net_ctx_t *ctx = NULL;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_create_ctx(&ctx, &config), ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL(connect_to(ctx, &server), ANJ_NET_OK);
+    echo(ctx, &server, "before");
+
+    flash_t flash = { 0 };
+    store_session(ctx, &flash);
+    // no close_notify is sent, the server keeps the connection
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_cleanup_ctx(&ctx), ANJ_NET_OK);
+    dtls_server_step(&server);
+    ANJ_UNIT_ASSERT_EQUAL(server.error, 0);
+
+    // e.g. after a restart of the device, the client comes back from another
+    // port and the connection goes on without a handshake
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_create_ctx(&ctx, &config), ANJ_NET_OK);
+    anj_persistence_context_t persistence =
+            anj_persistence_restore_context_create(flash_read, &flash);
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_session_restore(ctx, &persistence),
+                          ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_connect(ctx, SERVER_HOST, server.port),
+                          ANJ_NET_OK);
+    anj_dtls_handshake_metrics_t metrics;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_get_handshake_metrics(ctx, &metrics),
+                          ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL(metrics.datagrams_sent, 0);
+    ANJ_UNIT_ASSERT_EQUAL(metrics.bytes_sent, 0);
+    echo(ctx, &server, "after");
+    ANJ_UNIT_ASSERT_EQUAL(server.handshakes, 1);
+
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_cleanup_ctx(&ctx), ANJ_NET_OK);
+    dtls_server_cleanup(&server);
+}
+
+ANJ_UNIT_TEST(dtls_session_persistence, connect_again_after_store) {
+    dtls_server_t server;
+    ANJ_UNIT_ASSERT_SUCCESS(dtls_server_init_psk(&server, PSK_IDENTITY, PSK_KEY,
+                                                 sizeof(PSK_KEY)));
+    anj_net_config_t config;
+    psk_config(&config);
+    anj_net_ctx_t *ctx = NULL;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_create_ctx(&ctx, &config), ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL(connect_to(ctx, &server), ANJ_NET_OK);
+
+    flash_t flash = { 0 };
+    store_session(ctx, &flash);
+    dtls_server_cleanup(&server);
+
+    // the socket is set up from scratch, so a new connection can be made
+    ANJ_UNIT_ASSERT_SUCCESS(dtls_server_init_psk(&server, PSK_IDENTITY, PSK_KEY,
+                                                 sizeof(PSK_KEY)));
+    ANJ_UNIT_ASSERT_EQUAL(connect_to(ctx, &server), ANJ_NET_OK);
+    echo(ctx, &server, "again");
+    ANJ_UNIT_ASSERT_EQUAL(server.handshakes, 1);
+
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_cleanup_ctx(&ctx), ANJ_NET_OK);
+    dtls_server_cleanup(&server);
+}
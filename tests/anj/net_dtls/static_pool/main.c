@@ -0,0 +1,133 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(__APPLE__)
+#    define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <poll.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/compat/net/anj_dtls.h>
+#include <anj/compat/net/anj_net_api.h>
+#include <anj/crypto.h>
+
+#include <anj_unit_test.h>
+
+#include "dtls_server.h"
+
+#define SERVER_HOST "127.0.0.1"
+#define MAX_STEPS 5000
+
+#define PSK_IDENTITY "anjay-lite-test"
+static const uint8_t PSK_KEY[] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05,
+                                   0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B,
+                                   0x0C, 0x0D, 0x0E, 0x0F };
+
+// The buffer allocator is global, so the in-process server allocates from the
+// same pool and the reported peaks cover both ends of the connection. The pool
+// is set up again by each test, when nothing is allocated from it.
+static uint8_t pool[256 * 1024];
+
+static void psk_config(anj_net_config_t *config) {
+    memset(config, 0, sizeof(*config));
+    config->raw_socket_config.af_setting = ANJ_NET_AF_SETTING_FORCE_INET4;
+    config->secure_socket_config.security.mode = ANJ_NET_SECURITY_PSK;
+    anj_net_psk_info_t *psk = &config->secure_socket_config.security.data.psk;
+    psk->key.tag = ANJ_CRYPTO_SECURITY_TAG_PSK_KEY;
+    psk->key.source = ANJ_CRYPTO_DATA_SOURCE_BUFFER;
+    psk->key.info.buffer.data = PSK_KEY;
+    psk->key.info.buffer.data_size = sizeof(PSK_KEY);
+    psk->identity.tag = ANJ_CRYPTO_SECURITY_TAG_PSK_IDENTITY;
+    psk->identity.source = ANJ_CRYPTO_DATA_SOURCE_BUFFER;
+    psk->identity.info.buffer.data = PSK_IDENTITY;
+    psk->identity.info.buffer.data_size = strlen(PSK_IDENTITY);
+}
+
+static int connect_to(anj_net_ctx_t *ctx, dtls_server_t *server) {
+    int res = ANJ_NET_EINPROGRESS;
+    for (int i = 0; i < MAX_STEPS && res == ANJ_NET_EINPROGRESS; i++) {
+        res = anj_dtls_connect(ctx, SERVER_HOST, server->port);
+        dtls_server_step(server);
+        poll(NULL, 0, 1);
+    }
+    return res;
+}
+
+static void echo(anj_net_ctx_t *ctx, dtls_server_t *server, const char *msg) {
+    size_t sent = 0;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_send(ctx, &sent, (const uint8_t *) msg,
+                                        strlen(msg)),
+                          ANJ_NET_OK);
+    uint8_t buf[64];
+    size_t received = 0;
+    int res = ANJ_NET_EAGAIN;
+    for (int i = 0; i < MAX_STEPS && res == ANJ_NET_EAGAIN; i++) {
+        dtls_server_step(server);
+        res = anj_dtls_recv(ctx, &received, buf, sizeof(buf));
+        poll(NULL, 0, 1);
+    }
+    ANJ_UNIT_ASSERT_EQUAL(res, ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, msg, received);
+}
+
+ANJ_UNIT_TEST(static_pool, peak_tracking) {
+    anj_dtls_memory_pool_init(pool, sizeof(pool));
+    dtls_server_t server;
+    ANJ_UNIT_ASSERT_SUCCESS(dtls_server_init_psk(&server, PSK_IDENTITY, PSK_KEY,
+                                                 sizeof(PSK_KEY)));
+    anj_net_config_t config;
+    psk_config(&config);
+    anj_net_ctx_t *ctx = NULL;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_create_ctx(&ctx, &config), ANJ_NET_OK);
+
+    anj_dtls_memory_usage_t usage;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_get_memory_usage(ctx, &usage), ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL(usage.handshake_peak, 0);
+    ANJ_UNIT_ASSERT_EQUAL(usage.steady_state_peak, 0);
+    // SSL context of the server
+    size_t before_connect = usage.current;
+
+    ANJ_UNIT_ASSERT_EQUAL(connect_to(ctx, &server), ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_get_memory_usage(ctx, &usage), ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_TRUE(usage.current > before_connect);
+    // the handshake-only state is already freed
+    ANJ_UNIT_ASSERT_TRUE(usage.handshake_peak > usage.current);
+    ANJ_UNIT_ASSERT_TRUE(usage.steady_state_peak <= usage.handshake_peak);
+    size_t handshake_peak = usage.handshake_peak;
+
+    echo(ctx, &server, "ping");
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_get_memory_usage(ctx, &usage), ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL(usage.handshake_peak, handshake_peak);
+    ANJ_UNIT_ASSERT_TRUE(usage.steady_state_peak < handshake_peak);
+
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_cleanup_ctx(&ctx), ANJ_NET_OK);
+    dtls_server_cleanup(&server);
+}
+
+ANJ_UNIT_TEST(static_pool, pool_too_small) {
+    // not enough even for the record buffers of a single SSL context
+    static uint8_t small_pool[4096];
+    anj_dtls_memory_pool_init(small_pool, sizeof(small_pool));
+    anj_net_config_t config;
+    psk_config(&config);
+    anj_net_ctx_t *ctx = NULL;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_create_ctx(&ctx, &config), ANJ_NET_OK);
+
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_connect(ctx, SERVER_HOST, "5684"), -1);
+    anj_dtls_memory_usage_t usage;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_get_memory_usage(ctx, &usage), ANJ_NET_OK);
+    ANJ_UNIT_ASSERT_EQUAL(usage.handshake_peak, 0);
+    // everything allocated before the failure is freed
+    ANJ_UNIT_ASSERT_EQUAL(usage.current, 0);
+
+    ANJ_UNIT_ASSERT_EQUAL(anj_dtls_cleanup_ctx(&ctx), ANJ_NET_OK);
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/defs.h>
+
+#include "../../src/anj/coap/coap.h"
+
+#include <anj_unit_test.h>
+
+#ifdef ANJ_COAP_WITH_HEADER_COMPRESSION
+
+static const _anj_location_path_t LOCATION_PATH = {
+    .location = { "rd", "5a3f" },
+    .location_len = { 2, 4 },
+    .location_count = 2
+};
+
+// compresses the message, then checks that decompression restores it
+static void verify_round_trip(uint8_t *buff,
+                              size_t buff_size,
+                              size_t msg_size,
+                              size_t expected_compressed_size,
+                              uint8_t expected_rule) {
+    uint8_t original[100];
+    ANJ_UNIT_ASSERT_TRUE(msg_size <= sizeof(original));
+    memcpy(original, buff, msg_size);
+
+    size_t size = msg_size;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_coap_compress(buff, &size, &LOCATION_PATH));
+    ANJ_UNIT_ASSERT_EQUAL(size, expected_compressed_size);
+    ANJ_UNIT_ASSERT_EQUAL(buff[0] >> 6, expected_rule);
+
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_coap_decompress(buff, &size, buff_size, &LOCATION_PATH));
+    ANJ_UNIT_ASSERT_EQUAL(size, msg_size);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff, original, msg_size);
+}
+
+ANJ_UNIT_TEST(coap_header_compression, update) {
+    _anj_coap_msg_t data = { 0 };
+    uint8_t buff[100];
+    size_t msg_size;
+
+    data.operation = ANJ_OP_UPDATE;
+    data.location_path = LOCATION_PATH;
+    data.attr.register_attr.has_lifetime = true;
+    data.attr.register_attr.lifetime =
+            anj_time_duration_new(150, ANJ_TIME_UNIT_S);
+    data.coap_binding_data.message_id = 0x1111;
+    data.token.size = 8;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_coap_encode_udp(&data, buff, sizeof(buff), &msg_size));
+
+    // /rd/5a3f is not sent, Uri-Query delta grows by 1 byte
+    verify_round_trip(buff, sizeof(buff), msg_size, msg_size - 8 + 1, 0);
+}
+
+ANJ_UNIT_TEST(coap_header_compression, deregister) {
+    _anj_coap_msg_t data = { 0 };
+    uint8_t buff[100];
+    size_t msg_size;
+
+    data.operation = ANJ_OP_DEREGISTER;
+    data.location_path = LOCATION_PATH;
+    data.token.size = 8;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_coap_encode_udp(&data, buff, sizeof(buff), &msg_size));
+
+    // only the header and the token are left
+    verify_round_trip(buff, sizeof(buff), msg_size, 12, 0);
+}
+
+ANJ_UNIT_TEST(coap_header_compression, register_and_send) {
+    _anj_coap_msg_t data = { 0 };
+    uint8_t buff[100];
+    size_t msg_size;
+
+    data.operation = ANJ_OP_REGISTER;
+    data.content_format = _ANJ_COAP_FORMAT_LINK_FORMAT;
+    data.payload = (uint8_t *) "</1/0>";
+    data.payload_size = 6;
+    data.attr.register_attr.has_endpoint = true;
+    data.attr.register_attr.endpoint = "name";
+    data.token.size = 8;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_coap_encode_udp(&data, buff, sizeof(buff), &msg_size));
+    verify_round_trip(buff, sizeof(buff), msg_size, msg_size - 3, 2);
+
+    data = (_anj_coap_msg_t) { 0 };
+    data.operation = ANJ_OP_INF_CON_SEND;
+    data.content_format = _ANJ_COAP_FORMAT_SENML_CBOR;
+    data.payload = (uint8_t *) "\x80";
+    data.payload_size = 1;
+    data.token.size = 8;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_coap_encode_udp(&data, buff, sizeof(buff), &msg_size));
+    verify_round_trip(buff, sizeof(buff), msg_size, msg_size - 3, 3);
+}
+
+ANJ_UNIT_TEST(coap_header_compression, no_matching_rule) {
+    // response to Read /3/0/1, without Uri-Path
+    uint8_t response[] = "\x61\x45\x22\x22\x01"
+                         "\xc0"
+                         "\xff"
+                         "42";
+    size_t size = sizeof(response) - 1;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_coap_compress(response, &size, &LOCATION_PATH));
+    ANJ_UNIT_ASSERT_EQUAL(size, sizeof(response) - 1);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(response, "\x61\x45\x22\x22\x01", 5);
+
+    // Location-Path is not known before registration
+    uint8_t deregister[] = "\x40\x04\x11\x11"
+                           "\xb2rd"
+                           "\x04"
+                           "5a3f";
+    size = sizeof(deregister) - 1;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_coap_compress(deregister, &size,
+                                               &(_anj_location_path_t) { 0 }));
+    ANJ_UNIT_ASSERT_EQUAL(size, sizeof(deregister) - 1);
+    ANJ_UNIT_ASSERT_EQUAL(deregister[0], 0x40);
+
+    // uncompressed messages are passed through
+    size = sizeof(response) - 1;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_coap_decompress(response, &size, size,
+                                                 &LOCATION_PATH));
+    ANJ_UNIT_ASSERT_EQUAL(size, sizeof(response) - 1);
+}
+
+ANJ_UNIT_TEST(coap_header_compression, decompress_errors) {
+    uint8_t buff[16] = "\x00\x04\x11\x11";
+    size_t size = 4;
+    // no space for the decompressed Uri-Path
+    ANJ_UNIT_ASSERT_EQUAL(
+            _anj_coap_decompress(buff, &size, 8, &LOCATION_PATH),
+            _ANJ_ERR_BUFF);
+    ANJ_UNIT_ASSERT_EQUAL(size, 4);
+    // rule refers to unknown Location-Path
+    ANJ_UNIT_ASSERT_EQUAL(_anj_coap_decompress(buff, &size, sizeof(buff),
+                                               &(_anj_location_path_t) { 0 }),
+                          _ANJ_ERR_MALFORMED_MESSAGE);
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_coap_decompress(buff, &size, sizeof(buff), &LOCATION_PATH));
+    ANJ_UNIT_ASSERT_EQUAL(size, 12);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff, "\x40\x04\x11\x11\xb2rd\x04"
+                                            "5a3f",
+                                      12);
+
+    // compressed message must not carry Uri-Path
+    uint8_t with_uri_path[] = "\xc0\x02\x11\x11\xb1\x33";
+    size = sizeof(with_uri_path) - 1;
+    ANJ_UNIT_ASSERT_EQUAL(_anj_coap_decompress(with_uri_path, &size, size,
+                                               &LOCATION_PATH),
+                          _ANJ_ERR_MALFORMED_MESSAGE);
+}
+
+#endif // ANJ_COAP_WITH_HEADER_COMPRESSION
@@ -11,6 +11,7 @@
 #include <string.h>
 
 #include <anj/defs.h>
+#include <anj/utils.h>
 
 #include "../../../../src/anj/coap/coap.h"
 #include "../../../../src/anj/coap/options.h"
@@ -325,3 +326,130 @@ ANJ_UNIT_TEST(coap_options, get_options_errors_check) {
     ANJ_UNIT_ASSERT_SUCCESS(_anj_coap_options_decode(
             &opts_r_3, opts2.buff_begin, 100, &bytes_read));
 }
+
+ANJ_UNIT_TEST(coap_options, get_options_mixed_with_unknown) {
+    _ANJ_COAP_OPTIONS_INIT_EMPTY_WITH_BUFF(opts, 10, 100);
+    memset(opts.buff_begin, 0xFF, 100);
+
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_coap_options_add_string(&opts, _ANJ_COAP_OPTION_URI_QUERY,
+                                         "q"));
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_coap_options_add_string(&opts, _ANJ_COAP_OPTION_URI_PATH,
+                                         "a"));
+    // options not known to the index
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_coap_options_add_string(&opts, 2, "x"));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_coap_options_add_string(&opts, 2, "y"));
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_coap_options_add_string(&opts, _ANJ_COAP_OPTION_URI_PATH,
+                                         "b"));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_coap_options_add_u16(
+            &opts, _ANJ_COAP_OPTION_CONTENT_FORMAT, 112));
+
+    _ANJ_COAP_OPTIONS_INIT_EMPTY(opts_r, 10);
+    size_t bytes_read;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_coap_options_decode(&opts_r, opts.buff_begin,
+                                                     100, &bytes_read));
+    ANJ_UNIT_ASSERT_EQUAL(opts_r.options_number, 6);
+
+    // the same lookups must give the same results on both sets of options
+    const anj_coap_options_t *all_opts[] = { &opts, &opts_r };
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(all_opts); i++) {
+        char buffer[10];
+        size_t option_size;
+        size_t iterator = 0;
+        ANJ_UNIT_ASSERT_SUCCESS(_anj_coap_options_get_string_iterate(
+                all_opts[i], _ANJ_COAP_OPTION_URI_PATH, &iterator,
+                &option_size, buffer, sizeof(buffer)));
+        ANJ_UNIT_ASSERT_EQUAL_STRING(buffer, "a");
+        ANJ_UNIT_ASSERT_SUCCESS(_anj_coap_options_get_string_iterate(
+                all_opts[i], _ANJ_COAP_OPTION_URI_PATH, &iterator,
+                &option_size, buffer, sizeof(buffer)));
+        ANJ_UNIT_ASSERT_EQUAL_STRING(buffer, "b");
+        ANJ_UNIT_ASSERT_EQUAL(_anj_coap_options_get_string_iterate(
+                                      all_opts[i], _ANJ_COAP_OPTION_URI_PATH,
+                                      &iterator, &option_size, buffer,
+                                      sizeof(buffer)),
+                              _ANJ_COAP_OPTION_MISSING);
+
+        iterator = 1;
+        ANJ_UNIT_ASSERT_SUCCESS(_anj_coap_options_get_string_iterate(
+                all_opts[i], 2, &iterator, &option_size, buffer,
+                sizeof(buffer)));
+        ANJ_UNIT_ASSERT_EQUAL_STRING(buffer, "y");
+        ANJ_UNIT_ASSERT_EQUAL(
+                _anj_coap_options_get_string_iterate(all_opts[i], 2, &iterator,
+                                                     &option_size, buffer,
+                                                     sizeof(buffer)),
+                _ANJ_COAP_OPTION_MISSING);
+        ANJ_UNIT_ASSERT_EQUAL(
+                _anj_coap_options_get_string_iterate(all_opts[i], 13, NULL,
+                                                     &option_size, buffer,
+                                                     sizeof(buffer)),
+                _ANJ_COAP_OPTION_MISSING);
+
+        uint16_t u16_value;
+        ANJ_UNIT_ASSERT_SUCCESS(_anj_coap_options_get_u16_iterate(
+                all_opts[i], _ANJ_COAP_OPTION_CONTENT_FORMAT, NULL,
+                &u16_value));
+        ANJ_UNIT_ASSERT_EQUAL(u16_value, 112);
+        ANJ_UNIT_ASSERT_SUCCESS(_anj_coap_options_get_string_iterate(
+                all_opts[i], _ANJ_COAP_OPTION_URI_QUERY, NULL, &option_size,
+                buffer, sizeof(buffer)));
+        ANJ_UNIT_ASSERT_EQUAL_STRING(buffer, "q");
+        ANJ_UNIT_ASSERT_EQUAL(_anj_coap_options_get_u16_iterate(
+                                      all_opts[i], _ANJ_COAP_OPTION_ACCEPT,
+                                      NULL, &u16_value),
+                              _ANJ_COAP_OPTION_MISSING);
+    }
+}
+
+#ifdef ANJ_COAP_WITH_MSG_TEMPLATES
+ANJ_UNIT_TEST(coap_options, add_serialized) {
+    _ANJ_COAP_OPTIONS_INIT_EMPTY_WITH_BUFF(serialized, 10, 50);
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_coap_options_add_string(
+            &serialized, _ANJ_COAP_OPTION_URI_PATH, "rd"));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_coap_options_add_string(
+            &serialized, _ANJ_COAP_OPTION_URI_PATH, "0123456789abcde"));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_coap_options_add_u16(
+            &serialized, _ANJ_COAP_OPTION_CONTENT_FORMAT, 112));
+    size_t serialized_size = 3 + 17 + 2;
+
+    _ANJ_COAP_OPTIONS_INIT_EMPTY_WITH_BUFF(opts, 10, 50);
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_coap_options_add_u16(&opts, _ANJ_COAP_OPTION_OBSERVE, 0x1234));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_coap_options_add_serialized(
+            &opts, serialized.buff_begin, serialized_size));
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_coap_options_add_u16(&opts, _ANJ_COAP_OPTION_BLOCK2, 0x45));
+
+    const uint8_t EXPECTED[] = "\x62\x12\x34" // Observe 0x1234
+                               "\x52\x72\x64" // Uri-Path (+5) "rd"
+                               "\x0D\x02"     // Uri-Path (+0), length 15
+                               "0123456789abcde"
+                               "\x11\x70" // Content-Format (+1) 112
+                               "\xB1\x45" // Block2 (+11)
+            ;
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(opts.buff_begin, EXPECTED,
+                                      sizeof(EXPECTED) - 1);
+    ANJ_UNIT_ASSERT_EQUAL(opts.options_number, 5);
+
+    size_t iterator = 1;
+    char buffer[20];
+    size_t option_size;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_coap_options_get_string_iterate(
+            &opts, _ANJ_COAP_OPTION_URI_PATH, &iterator, &option_size, buffer,
+            sizeof(buffer)));
+    ANJ_UNIT_ASSERT_EQUAL_STRING(buffer, "0123456789abcde");
+    uint16_t u16_value;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_coap_options_get_u16_iterate(
+            &opts, _ANJ_COAP_OPTION_CONTENT_FORMAT, NULL, &u16_value));
+    ANJ_UNIT_ASSERT_EQUAL(u16_value, 112);
+
+    // serialized options can't be placed before the ones already added
+    ANJ_UNIT_ASSERT_EQUAL(_anj_coap_options_add_serialized(
+                                  &opts, serialized.buff_begin,
+                                  serialized_size),
+                          _ANJ_ERR_INPUT_ARG);
+}
+#endif // ANJ_COAP_WITH_MSG_TEMPLATES
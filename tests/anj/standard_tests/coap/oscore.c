@@ -0,0 +1,359 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/defs.h>
+
+#include "../../src/anj/coap/coap.h"
+
+#include <anj_unit_test.h>
+
+#ifdef ANJ_WITH_OSCORE
+
+// RFC 8613, Appendix C.1.1, derived keys from C.1.2
+#    define CLIENT_KEY                                                        \
+        "\xf0\x91\x0e\xd7\x29\x5e\x6a\xd4\xb5\x4f\xc7\x93\x15\x43\x02\xff"
+#    define SERVER_KEY                                                        \
+        "\xff\xb1\x4e\x09\x3c\x94\xc9\xca\xc9\x47\x16\x48\xb4\xf9\x87\x10"
+#    define COMMON_IV \
+        "\x46\x22\xd4\xdd\x6d\x94\x41\x68\xee\xfb\x54\x98\x7c"
+
+static void init_client_ctx(_anj_oscore_ctx_t *ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->active = true;
+    ctx->security.sender_id_len = 0;
+    ctx->security.recipient_id[0] = 0x01;
+    ctx->security.recipient_id_len = 1;
+    memcpy(ctx->security.sender_key, CLIENT_KEY, ANJ_OSCORE_KEY_LEN);
+    memcpy(ctx->security.recipient_key, SERVER_KEY, ANJ_OSCORE_KEY_LEN);
+    memcpy(ctx->security.common_iv, COMMON_IV, ANJ_OSCORE_NONCE_LEN);
+}
+
+// mirrored context of the other endpoint
+static void init_server_ctx(_anj_oscore_ctx_t *ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->active = true;
+    ctx->security.sender_id[0] = 0x01;
+    ctx->security.sender_id_len = 1;
+    ctx->security.recipient_id_len = 0;
+    memcpy(ctx->security.sender_key, SERVER_KEY, ANJ_OSCORE_KEY_LEN);
+    memcpy(ctx->security.recipient_key, CLIENT_KEY, ANJ_OSCORE_KEY_LEN);
+    memcpy(ctx->security.common_iv, COMMON_IV, ANJ_OSCORE_NONCE_LEN);
+}
+
+ANJ_UNIT_TEST(coap_oscore, rfc8613_test_vectors) {
+    _anj_oscore_ctx_t ctx;
+    init_client_ctx(&ctx);
+    ctx.sender_seq_num = 20;
+
+    // Appendix C.4: GET coap://localhost/tv1
+    uint8_t buff[64] = "\x44\x01\x5d\x1f\x00\x00\x39\x74"
+                       "\x39localhost"
+                       "\x83tv1";
+    size_t size = 22;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_oscore_protect(&ctx, buff, &size, sizeof(buff)));
+    ANJ_UNIT_ASSERT_EQUAL(size, 35);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff,
+                                      "\x44\x02\x5d\x1f\x00\x00\x39\x74"
+                                      "\x39localhost"
+                                      "\x62\x09\x14"
+                                      "\xff\x61\x2f\x10\x92\xf1\x77\x6f\x1c"
+                                      "\x16\x68\xb3\x82\x5e",
+                                      35);
+    ANJ_UNIT_ASSERT_EQUAL(ctx.sender_seq_num, 21);
+
+    // Appendix C.7: 2.05 Content "Hello World!"
+    memcpy(buff,
+           "\x64\x44\x5d\x1f\x00\x00\x39\x74"
+           "\x90"
+           "\xff\xdb\xaa\xd1\xe9\xa7\xe7\xb2\xa8\x13\xd3\xc3\x15\x24\x37\x83"
+           "\x03\xcd\xaf\xae\x11\x91\x06",
+           32);
+    size = 32;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_oscore_unprotect(&ctx, buff, &size));
+    ANJ_UNIT_ASSERT_EQUAL(size, 21);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff,
+                                      "\x64\x45\x5d\x1f\x00\x00\x39\x74"
+                                      "\xff"
+                                      "Hello World!",
+                                      21);
+}
+
+// GET /3/0 with Observe 0, Token 0x1234
+#    define OBSERVE_REQUEST "\x42\x01\x01\x01\x12\x34\x60\x51\x33\x01\x30"
+#    define OBSERVE_REQUEST_SIZE 11
+
+// 2.05 Content with Observe 5, Content-Format 0 and "42"
+#    define NOTIFICATION "\x62\x45\x01\x01\x12\x34\x61\x05\x60\xff\x34\x32"
+#    define NOTIFICATION_SIZE 12
+
+ANJ_UNIT_TEST(coap_oscore, observe_round_trip) {
+    _anj_oscore_ctx_t client;
+    _anj_oscore_ctx_t server;
+    init_client_ctx(&client);
+    init_server_ctx(&server);
+
+    uint8_t buff[100];
+    memcpy(buff, OBSERVE_REQUEST, OBSERVE_REQUEST_SIZE);
+    size_t size = OBSERVE_REQUEST_SIZE;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_oscore_protect(&server, buff, &size, sizeof(buff)));
+    // Observe is kept outside for the proxies, Uri-Path is encrypted
+    ANJ_UNIT_ASSERT_EQUAL(buff[1], ANJ_COAP_CODE_FETCH);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff + 6, "\x60\x33\x09\x00\x01\xff", 6);
+
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_oscore_unprotect(&client, buff, &size));
+    ANJ_UNIT_ASSERT_EQUAL(size, OBSERVE_REQUEST_SIZE);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff, OBSERVE_REQUEST,
+                                      OBSERVE_REQUEST_SIZE);
+
+    // every notification carries its own Partial IV
+    for (uint8_t i = 0; i < 2; i++) {
+        memcpy(buff, NOTIFICATION, NOTIFICATION_SIZE);
+        size = NOTIFICATION_SIZE;
+        ANJ_UNIT_ASSERT_SUCCESS(
+                _anj_oscore_protect(&client, buff, &size, sizeof(buff)));
+        ANJ_UNIT_ASSERT_EQUAL(buff[1], ANJ_COAP_CODE_CONTENT);
+        ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff + 6, "\x61\x05\x32\x01", 4);
+        ANJ_UNIT_ASSERT_EQUAL(buff[10], i);
+
+        ANJ_UNIT_ASSERT_SUCCESS(_anj_oscore_unprotect(&server, buff, &size));
+        ANJ_UNIT_ASSERT_EQUAL(size, 10);
+        ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(
+                buff, "\x62\x45\x01\x01\x12\x34\xc0\xff\x34\x32", 10);
+    }
+}
+
+// GET /3/0/1, Token 0x56
+#    define READ_REQUEST "\x41\x01\x02\x02\x56\xb1\x33\x01\x30\x01\x31"
+#    define READ_REQUEST_SIZE 11
+#    define READ_RESPONSE "\x61\x45\x02\x02\x56\xff\x34\x32"
+#    define READ_RESPONSE_SIZE 8
+
+static void protect_read(_anj_oscore_ctx_t *server,
+                         uint16_t msg_id,
+                         uint8_t *out_buff,
+                         size_t *out_size) {
+    memcpy(out_buff, READ_REQUEST, READ_REQUEST_SIZE);
+    out_buff[2] = (uint8_t) (msg_id >> 8);
+    out_buff[3] = (uint8_t) msg_id;
+    *out_size = READ_REQUEST_SIZE;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_oscore_protect(server, out_buff, out_size,
+                                                ANJ_OSCORE_TAG_LEN + 40));
+}
+
+ANJ_UNIT_TEST(coap_oscore, responses) {
+    _anj_oscore_ctx_t client;
+    _anj_oscore_ctx_t server;
+    init_client_ctx(&client);
+    init_server_ctx(&server);
+
+    uint8_t buff[100];
+    size_t size;
+    protect_read(&server, 0x0202, buff, &size);
+    ANJ_UNIT_ASSERT_EQUAL(buff[1], ANJ_COAP_CODE_POST);
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_oscore_unprotect(&client, buff, &size));
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff, READ_REQUEST, READ_REQUEST_SIZE);
+
+    // first response reuses the nonce of the request
+    memcpy(buff, READ_RESPONSE, READ_RESPONSE_SIZE);
+    size = READ_RESPONSE_SIZE;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_oscore_protect(&client, buff, &size, sizeof(buff)));
+    ANJ_UNIT_ASSERT_EQUAL(buff[1], ANJ_COAP_CODE_CHANGED);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff + 5, "\x90\xff", 2);
+    ANJ_UNIT_ASSERT_EQUAL(client.sender_seq_num, 0);
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_oscore_unprotect(&server, buff, &size));
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff, READ_RESPONSE, READ_RESPONSE_SIZE);
+
+    // any further response to the same request gets a Partial IV
+    memcpy(buff, READ_RESPONSE, READ_RESPONSE_SIZE);
+    size = READ_RESPONSE_SIZE;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_oscore_protect(&client, buff, &size, sizeof(buff)));
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff + 5, "\x92\x01\x00\xff", 4);
+    ANJ_UNIT_ASSERT_EQUAL(client.sender_seq_num, 1);
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_oscore_unprotect(&server, buff, &size));
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff, READ_RESPONSE, READ_RESPONSE_SIZE);
+
+    // response to an unknown request can't be protected
+    memcpy(buff, READ_RESPONSE, READ_RESPONSE_SIZE);
+    buff[4] = 0x57;
+    size = READ_RESPONSE_SIZE;
+    ANJ_UNIT_ASSERT_EQUAL(
+            _anj_oscore_protect(&client, buff, &size, sizeof(buff)),
+            _ANJ_ERR_OSCORE);
+
+    // empty messages are not protected
+    memcpy(buff, "\x60\x00\x02\x02", 4);
+    size = 4;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_oscore_protect(&client, buff, &size, sizeof(buff)));
+    ANJ_UNIT_ASSERT_EQUAL(size, 4);
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_oscore_unprotect(&server, buff, &size));
+    ANJ_UNIT_ASSERT_EQUAL(size, 4);
+}
+
+static int unprotect_copy(_anj_oscore_ctx_t *ctx,
+                          const uint8_t *msg,
+                          size_t msg_size) {
+    uint8_t buff[64];
+    memcpy(buff, msg, msg_size);
+    return _anj_oscore_unprotect(ctx, buff, &msg_size);
+}
+
+ANJ_UNIT_TEST(coap_oscore, replay_protection) {
+    _anj_oscore_ctx_t client;
+    _anj_oscore_ctx_t server;
+    init_client_ctx(&client);
+    init_server_ctx(&server);
+
+    uint8_t requests[3][64];
+    size_t sizes[3];
+    for (uint16_t i = 0; i < 3; i++) {
+        protect_read(&server, (uint16_t) (0x0300 + i), requests[i], &sizes[i]);
+        // Token is not a part of the AAD of the request, so it can be changed
+        // to tell the requests apart
+        requests[i][4] = (uint8_t) (0x60 + i);
+    }
+
+    ANJ_UNIT_ASSERT_SUCCESS(unprotect_copy(&client, requests[1], sizes[1]));
+    // older request that was not received yet
+    ANJ_UNIT_ASSERT_SUCCESS(unprotect_copy(&client, requests[0], sizes[0]));
+    // duplicate of a recent request, e.g. a CoAP retransmission
+    ANJ_UNIT_ASSERT_SUCCESS(unprotect_copy(&client, requests[0], sizes[0]));
+    ANJ_UNIT_ASSERT_SUCCESS(unprotect_copy(&client, requests[2], sizes[2]));
+    // request 1 is no longer remembered, its Partial IV was already seen
+    ANJ_UNIT_ASSERT_EQUAL(unprotect_copy(&client, requests[1], sizes[1]),
+                          _ANJ_ERR_OSCORE);
+    ANJ_UNIT_ASSERT_EQUAL(client.replay_window_top, 2);
+    ANJ_UNIT_ASSERT_EQUAL(client.replay_window, 0x7);
+}
+
+ANJ_UNIT_TEST(coap_oscore, replay_with_another_msg_id) {
+    _anj_oscore_ctx_t client;
+    _anj_oscore_ctx_t server;
+    init_client_ctx(&client);
+    init_server_ctx(&server);
+
+    uint8_t request[64];
+    size_t size;
+    protect_read(&server, 0x0400, request, &size);
+    ANJ_UNIT_ASSERT_SUCCESS(unprotect_copy(&client, request, size));
+
+    // the outer Message ID is not protected: a copy of the request sent with
+    // another one is not a CoAP retransmission and would be handled again
+    request[3] = 0x01;
+    ANJ_UNIT_ASSERT_EQUAL(unprotect_copy(&client, request, size),
+                          _ANJ_ERR_OSCORE);
+    // retransmission with the original Message ID is still accepted
+    request[3] = 0x00;
+    ANJ_UNIT_ASSERT_SUCCESS(unprotect_copy(&client, request, size));
+    ANJ_UNIT_ASSERT_EQUAL(client.replay_window_top, 0);
+    ANJ_UNIT_ASSERT_EQUAL(client.replay_window, 0x1);
+}
+
+ANJ_UNIT_TEST(coap_oscore, invalid_messages) {
+    _anj_oscore_ctx_t client;
+    _anj_oscore_ctx_t server;
+    init_client_ctx(&client);
+    init_server_ctx(&server);
+
+    uint8_t original[64];
+    size_t original_size;
+    protect_read(&server, 0x0400, original, &original_size);
+
+    uint8_t buff[64];
+    size_t size;
+    // tampered ciphertext
+    for (size_t i = 0; i < 2; i++) {
+        memcpy(buff, original, original_size);
+        size = original_size;
+        buff[original_size - 1 - i * ANJ_OSCORE_TAG_LEN] ^= 0x01;
+        ANJ_UNIT_ASSERT_EQUAL(_anj_oscore_unprotect(&client, buff, &size),
+                              _ANJ_ERR_OSCORE);
+    }
+    // unknown kid
+    memcpy(buff, original, original_size);
+    size = original_size;
+    ANJ_UNIT_ASSERT_EQUAL(buff[8], 0x01);
+    buff[8] = 0x02;
+    ANJ_UNIT_ASSERT_EQUAL(_anj_oscore_unprotect(&client, buff, &size),
+                          _ANJ_ERR_OSCORE);
+    // kid context is not supported
+    memcpy(buff, original, original_size);
+    size = original_size;
+    buff[6] |= 0x10;
+    ANJ_UNIT_ASSERT_EQUAL(_anj_oscore_unprotect(&client, buff, &size),
+                          _ANJ_ERR_MALFORMED_MESSAGE);
+    // not protected at all
+    memcpy(buff, READ_REQUEST, READ_REQUEST_SIZE);
+    size = READ_REQUEST_SIZE;
+    ANJ_UNIT_ASSERT_EQUAL(_anj_oscore_unprotect(&client, buff, &size),
+                          _ANJ_ERR_OSCORE);
+    ANJ_UNIT_ASSERT_FALSE(client.replay_window_valid);
+
+    // rejected messages do not affect the state
+    memcpy(buff, original, original_size);
+    size = original_size;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_oscore_unprotect(&client, buff, &size));
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff, "\x41\x01\x04\x00", 4);
+}
+
+ANJ_UNIT_TEST(coap_oscore, client_request_retransmission) {
+    _anj_oscore_ctx_t client;
+    init_client_ctx(&client);
+
+    // POST /dp with "42"
+    static const uint8_t REQUEST[] = "\x41\x02\x05\x05\x77\xb2\x64\x70\xff"
+                                     "\x34\x32";
+    uint8_t first[64];
+    uint8_t buff[64];
+    memcpy(first, REQUEST, sizeof(REQUEST) - 1);
+    size_t first_size = sizeof(REQUEST) - 1;
+    // no space for the OSCORE option and the tag
+    ANJ_UNIT_ASSERT_EQUAL(_anj_oscore_protect(&client, first, &first_size,
+                                              first_size + ANJ_OSCORE_TAG_LEN),
+                          _ANJ_ERR_BUFF);
+    ANJ_UNIT_ASSERT_EQUAL(client.sender_seq_num, 0);
+
+    memcpy(first, REQUEST, sizeof(REQUEST) - 1);
+    first_size = sizeof(REQUEST) - 1;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_oscore_protect(&client, first, &first_size, sizeof(first)));
+
+    // same Message ID - the same Partial IV and ciphertext
+    memcpy(buff, REQUEST, sizeof(REQUEST) - 1);
+    size_t size = sizeof(REQUEST) - 1;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_oscore_protect(&client, buff, &size, sizeof(buff)));
+    ANJ_UNIT_ASSERT_EQUAL(size, first_size);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff, first, size);
+    ANJ_UNIT_ASSERT_EQUAL(client.sender_seq_num, 1);
+
+    // new Message ID, e.g. next block - new Partial IV
+    memcpy(buff, REQUEST, sizeof(REQUEST) - 1);
+    buff[3] = 0x06;
+    size = sizeof(REQUEST) - 1;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_oscore_protect(&client, buff, &size, sizeof(buff)));
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff + 5, "\x92\x09\x01\xff", 4);
+    ANJ_UNIT_ASSERT_EQUAL(client.sender_seq_num, 2);
+
+    // already protected
+    ANJ_UNIT_ASSERT_EQUAL(
+            _anj_oscore_protect(&client, buff, &size, sizeof(buff)),
+            _ANJ_ERR_MALFORMED_MESSAGE);
+}
+
+#endif // ANJ_WITH_OSCORE
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/defs.h>
+#include <anj/utils.h>
+
+#include "../../src/anj/coap/coap.h"
+
+#include <anj_unit_test.h>
+
+#ifdef _ANJ_COAP_WITH_TCP
+
+ANJ_UNIT_TEST(anj_coap_tcp, encode_request) {
+    _anj_coap_msg_t data = { 0 };
+    uint8_t buff[32];
+    size_t out_msg_size;
+
+    data.operation = ANJ_OP_DEREGISTER;
+    data.location_path.location[0] = "name";
+    data.location_path.location_len[0] = 4;
+    data.location_path.location_count = 1;
+    data.token.size = 1;
+    data.token.bytes[0] = 0x11;
+
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_coap_encode_tcp(&data, buff, sizeof(buff), &out_msg_size));
+
+    uint8_t EXPECTED[] = "\x51"                 // len 5, tkl 1
+                         "\x04"                 // DELETE
+                         "\x11"                 // token
+                         "\xb4\x6e\x61\x6d\x65"; // uri path /name
+    ANJ_UNIT_ASSERT_EQUAL(out_msg_size, sizeof(EXPECTED) - 1);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff, EXPECTED, sizeof(EXPECTED) - 1);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_coap_tcp_frame_size(buff, out_msg_size),
+                          out_msg_size);
+}
+
+ANJ_UNIT_TEST(anj_coap_tcp, encode_response_extended_length) {
+    _anj_coap_msg_t data = { 0 };
+    uint8_t buff[32];
+    size_t out_msg_size;
+
+    data.operation = ANJ_OP_RESPONSE;
+    data.msg_code = ANJ_COAP_CODE_CONTENT;
+    data.content_format = _ANJ_COAP_FORMAT_PLAINTEXT;
+    data.payload = (uint8_t *) "0123456789abcdef";
+    data.payload_size = 16;
+    data.token.size = 1;
+    data.token.bytes[0] = 0x22;
+
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_coap_encode_tcp(&data, buff, sizeof(buff), &out_msg_size));
+
+    uint8_t EXPECTED[] = "\xd1\x05" // len 13 + 5, tkl 1
+                         "\x45"     // 2.05 Content
+                         "\x22"     // token
+                         "\xc0"     // content format: text/plain
+                         "\xff"
+                         "0123456789abcdef";
+    ANJ_UNIT_ASSERT_EQUAL(out_msg_size, sizeof(EXPECTED) - 1);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff, EXPECTED, sizeof(EXPECTED) - 1);
+
+    ANJ_UNIT_ASSERT_EQUAL(_anj_coap_encode_tcp(&data, buff, 21, &out_msg_size),
+                          _ANJ_ERR_BUFF);
+}
+
+ANJ_UNIT_TEST(anj_coap_tcp, decode_request) {
+    uint8_t MSG[] = "\x61"     // len 6, tkl 1
+                    "\x01"     // GET
+                    "\x33"     // token
+                    "\xb1\x33" // uri path /3
+                    "\x01\x30" // uri path /0
+                    "\x01\x31"; // uri path /1
+    _anj_coap_msg_t data;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_coap_decode_tcp(MSG, sizeof(MSG) - 1, &data));
+    ANJ_UNIT_ASSERT_EQUAL(data.operation, ANJ_OP_DM_READ);
+    ANJ_UNIT_ASSERT_TRUE(
+            anj_uri_path_equal(&data.uri, &ANJ_MAKE_RESOURCE_PATH(3, 0, 1)));
+    ANJ_UNIT_ASSERT_EQUAL(data.token.size, 1);
+    ANJ_UNIT_ASSERT_EQUAL(data.token.bytes[0], 0x33);
+    ANJ_UNIT_ASSERT_EQUAL(data.payload_size, 0);
+
+    // declared length does not match the size of the frame
+    ANJ_UNIT_ASSERT_EQUAL(_anj_coap_decode_tcp(MSG, sizeof(MSG) - 2, &data),
+                          _ANJ_ERR_MALFORMED_MESSAGE);
+}
+
+ANJ_UNIT_TEST(anj_coap_tcp, decode_response) {
+    uint8_t MSG[] = "\x41"     // len 4, tkl 1
+                    "\x44"     // 2.04 Changed
+                    "\x44"     // token
+                    "\xff"
+                    "abc";
+    _anj_coap_msg_t data;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_coap_decode_tcp(MSG, sizeof(MSG) - 1, &data));
+    ANJ_UNIT_ASSERT_EQUAL(data.operation, ANJ_OP_RESPONSE);
+    ANJ_UNIT_ASSERT_EQUAL(data.msg_code, ANJ_COAP_CODE_CHANGED);
+    ANJ_UNIT_ASSERT_EQUAL(data.payload_size, 3);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(data.payload, "abc", 3);
+}
+
+ANJ_UNIT_TEST(anj_coap_tcp, ping_pong) {
+    uint8_t PING[] = "\x00\xe2";
+    _anj_coap_msg_t data;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_coap_decode_tcp(PING, sizeof(PING) - 1, &data));
+    ANJ_UNIT_ASSERT_EQUAL(data.operation, ANJ_OP_COAP_TCP_SIGNALING);
+    ANJ_UNIT_ASSERT_EQUAL(data.msg_code, _ANJ_COAP_CODE_PING);
+
+    data.msg_code = _ANJ_COAP_CODE_PONG;
+    uint8_t buff[16];
+    size_t out_msg_size;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_coap_encode_tcp(&data, buff, sizeof(buff), &out_msg_size));
+    ANJ_UNIT_ASSERT_EQUAL(out_msg_size, 2);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff, "\x00\xe3", 2);
+
+    // signaling operation requires a signaling code
+    data.msg_code = ANJ_COAP_CODE_CONTENT;
+    ANJ_UNIT_ASSERT_EQUAL(
+            _anj_coap_encode_tcp(&data, buff, sizeof(buff), &out_msg_size),
+            _ANJ_ERR_COAP_BAD_MSG);
+}
+
+ANJ_UNIT_TEST(anj_coap_tcp, frame_size) {
+    const uint8_t MSG_8BIT[] = { 0xd1, 0x05, 0x45 };
+    ANJ_UNIT_ASSERT_EQUAL(_anj_coap_tcp_frame_size(MSG_8BIT, 0), 0);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_coap_tcp_frame_size(MSG_8BIT, 1), 0);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_coap_tcp_frame_size(MSG_8BIT, 2), 0);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_coap_tcp_frame_size(MSG_8BIT, 3), 22);
+
+    const uint8_t MSG_16BIT[] = { 0xe0, 0x01, 0x00, 0x45 };
+    ANJ_UNIT_ASSERT_EQUAL(_anj_coap_tcp_frame_size(MSG_16BIT, 3), 0);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_coap_tcp_frame_size(MSG_16BIT, 4),
+                          4 + 256 + 269);
+
+    const uint8_t MSG_32BIT[] = { 0xf8, 0x00, 0x00, 0x00, 0x01, 0x45 };
+    ANJ_UNIT_ASSERT_EQUAL(_anj_coap_tcp_frame_size(MSG_32BIT, 5), 0);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_coap_tcp_frame_size(MSG_32BIT, 6),
+                          6 + 8 + 1 + 65805);
+}
+
+#endif // _ANJ_COAP_WITH_TCP
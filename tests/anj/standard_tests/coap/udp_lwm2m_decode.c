@@ -11,6 +11,7 @@
 #include <stdint.h>
 
 #include <anj/defs.h>
+#include <anj/utils.h>
 
 #include "../../src/anj/coap/coap.h"
 
@@ -47,6 +48,23 @@ ANJ_UNIT_TEST(anj_decode_udp, decode_read) {
     ANJ_UNIT_ASSERT_EQUAL(out_data.payload_size, 0);
 }
 
+ANJ_UNIT_BENCH(anj_decode_udp, decode_read, 10000) {
+    uint8_t MSG[] = "\x44"             // header v 0x01, Confirmable, tkl 4
+                    "\x01\x21\x37"     // GET code 0.1, msg id 3721
+                    "\x12\x34\x56\x78" // token
+                    "\xB1\x33"         // uri-path_1 URI_PATH 11 /3
+                    "\x01\x33"         // uri-path_2             /3
+                    "\x02\x31\x31"     // uri-path_3             /11
+                    "\x02\x31\x31"     // uri-path_4             /11
+                    "\x62\x01\x40"     // accept ACCEPT 17 SENML_ETCH_JSON 320
+            ;
+
+    _anj_coap_msg_t out_data = { 0 };
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_coap_decode_udp(MSG, sizeof(MSG) - 1, &out_data));
+    ANJ_UNIT_ASSERT_EQUAL(out_data.operation, ANJ_OP_DM_READ);
+}
+
 ANJ_UNIT_TEST(anj_decode_udp, decode_write_replace) {
     uint8_t MSG[] = "\x48"         // header v 0x01, Confirmable, tkl 8
                     "\x03\x37\x21" // PUT code 0.1
@@ -815,3 +833,85 @@ ANJ_UNIT_TEST(anj_decode_udp, decode_error_attr) {
     ANJ_UNIT_ASSERT_FAILED(
             _anj_coap_decode_udp(MSG, sizeof(MSG) - 1, &out_data));
 }
+
+#ifdef ANJ_WITH_LWM2M_GATEWAY
+ANJ_UNIT_TEST(anj_decode_udp, decode_read_with_gateway_prefix) {
+    uint8_t MSG[] = "\x44"                 // header v 0x01, Confirmable, tkl 4
+                    "\x01\x21\x37"         // GET code 0.1, msg id 3721
+                    "\x12\x34\x56\x78"     // token
+                    "\xB4\x64\x65\x76\x31" // uri-path_1 URI_PATH 11 /dev1
+                    "\x04\x33\x33\x30\x33" // uri-path_2             /3303
+                    "\x01\x30"             // uri-path_3             /0
+                    "\x04\x35\x37\x30\x30" // uri-path_4             /5700
+                    "\x02\x31\x31"         // uri-path_5             /11
+            ;
+
+    _anj_coap_msg_t out_data = { 0 };
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_coap_decode_udp(MSG, sizeof(MSG) - 1, &out_data));
+
+    ANJ_UNIT_ASSERT_EQUAL(out_data.operation, ANJ_OP_DM_READ);
+    ANJ_UNIT_ASSERT_EQUAL(out_data.gateway_prefix_len, 4);
+    ANJ_UNIT_ASSERT_EQUAL((intptr_t) out_data.gateway_prefix,
+                          (intptr_t) &MSG[9]);
+    ANJ_UNIT_ASSERT_TRUE(
+            anj_uri_path_equal(&out_data.uri, &ANJ_MAKE_RESOURCE_INSTANCE_PATH(
+                                                      3303, 0, 5700, 11)));
+}
+
+ANJ_UNIT_TEST(anj_decode_udp, decode_gateway_prefix_only) {
+    uint8_t MSG[] = "\x44"                 // header v 0x01, Confirmable, tkl 4
+                    "\x01\x21\x37"         // GET code 0.1, msg id 3721
+                    "\x12\x34\x56\x78"     // token
+                    "\xB4\x64\x65\x76\x31" // uri-path_1 URI_PATH 11 /dev1
+                    "\x61\x28"             // accept ACCEPT 17 LINK_FORMAT 40
+            ;
+
+    _anj_coap_msg_t out_data = { 0 };
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_coap_decode_udp(MSG, sizeof(MSG) - 1, &out_data));
+
+    ANJ_UNIT_ASSERT_EQUAL(out_data.gateway_prefix_len, 4);
+    ANJ_UNIT_ASSERT_EQUAL(out_data.uri.uri_len, 0);
+}
+
+ANJ_UNIT_TEST(anj_decode_udp, decode_without_gateway_prefix) {
+    uint8_t MSG[] = "\x44"             // header v 0x01, Confirmable, tkl 4
+                    "\x01\x21\x37"     // GET code 0.1, msg id 3721
+                    "\x12\x34\x56\x78" // token
+                    "\xB1\x33"         // uri-path_1 URI_PATH 11 /3
+                    "\x01\x30"         // uri-path_2             /0
+            ;
+
+    _anj_coap_msg_t out_data = { 0 };
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_coap_decode_udp(MSG, sizeof(MSG) - 1, &out_data));
+    ANJ_UNIT_ASSERT_NULL(out_data.gateway_prefix);
+    ANJ_UNIT_ASSERT_TRUE(
+            anj_uri_path_equal(&out_data.uri, &ANJ_MAKE_INSTANCE_PATH(3, 0)));
+
+    // only the first segment may be a prefix
+    uint8_t MSG_2[] = "\x44"             // header v 0x01, Confirmable, tkl 4
+                      "\x01\x21\x37"     // GET code 0.1, msg id 3721
+                      "\x12\x34\x56\x78" // token
+                      "\xB1\x33"         // uri-path_1 URI_PATH 11 /3
+                      "\x04\x64\x65\x76\x31" // uri-path_2 /dev1
+            ;
+    ANJ_UNIT_ASSERT_FAILED(
+            _anj_coap_decode_udp(MSG_2, sizeof(MSG_2) - 1, &out_data));
+}
+
+ANJ_UNIT_TEST(anj_decode_udp, decode_bootstrap_finish_not_prefix) {
+    uint8_t MSG[] = "\x44"             // header v 0x01, Confirmable, tkl 4
+                    "\x02\x21\x37"     // POST code 0.2, msg id 3721
+                    "\x12\x34\x56\x78" // token
+                    "\xB2\x62\x73"     // uri-path_1 URI_PATH 11 /bs
+            ;
+
+    _anj_coap_msg_t out_data = { 0 };
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_coap_decode_udp(MSG, sizeof(MSG) - 1, &out_data));
+    ANJ_UNIT_ASSERT_EQUAL(out_data.operation, ANJ_OP_BOOTSTRAP_FINISH);
+    ANJ_UNIT_ASSERT_NULL(out_data.gateway_prefix);
+}
+#endif // ANJ_WITH_LWM2M_GATEWAY
@@ -67,6 +67,32 @@ ANJ_UNIT_TEST(anj_prepare_udp, prepare_register) {
                          >= calculated_msg_size);
 }
 
+ANJ_UNIT_BENCH(anj_prepare_udp, prepare_register, 10000) {
+    _anj_coap_msg_t data = { 0 };
+    uint8_t buff[100];
+    size_t out_msg_size;
+
+    data.operation = ANJ_OP_REGISTER;
+    data.content_format = _ANJ_COAP_FORMAT_LINK_FORMAT;
+    data.payload = (uint8_t *) "<1/1>";
+    data.payload_size = 5;
+
+    data.attr.register_attr.has_endpoint = true;
+    data.attr.register_attr.has_lifetime = true;
+    data.attr.register_attr.has_lwm2m_ver = true;
+    data.attr.register_attr.endpoint = "name";
+    data.attr.register_attr.lifetime =
+            anj_time_duration_new(120, ANJ_TIME_UNIT_S);
+    data.attr.register_attr.lwm2m_ver = "1.2";
+
+    data.coap_binding_data.message_id = 0x01;
+    data.token.size = 8;
+
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_coap_encode_udp(&data, buff, sizeof(buff), &out_msg_size));
+    ANJ_UNIT_ASSERT_EQUAL(out_msg_size, 48);
+}
+
 ANJ_UNIT_TEST(anj_prepare_udp, prepare_update) {
     _anj_coap_msg_t data = { 0 };
     uint8_t buff[100];
@@ -740,3 +766,186 @@ ANJ_UNIT_TEST(anj_prepare_udp, prepare_response_with_double_block) {
     ANJ_UNIT_ASSERT_EQUAL(out_msg_size, 19);
 }
 #endif // ANJ_WITH_COMPOSITE_OPERATIONS
+
+#ifdef ANJ_COAP_WITH_MSG_TEMPLATES
+static void encode_with_and_without_templates(
+        _anj_coap_msg_templates_t *templates, const _anj_coap_msg_t *msg) {
+    _anj_coap_msg_t standard_msg = *msg;
+    _anj_coap_msg_t template_msg = *msg;
+    uint8_t standard_buff[200];
+    uint8_t template_buff[200];
+    size_t standard_size;
+    size_t template_size;
+
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_coap_encode_udp(&standard_msg, standard_buff,
+                                                 sizeof(standard_buff),
+                                                 &standard_size));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_coap_encode_udp_with_templates(
+            templates, &template_msg, template_buff, sizeof(template_buff),
+            &template_size));
+    ANJ_UNIT_ASSERT_EQUAL(standard_size, template_size);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(standard_buff, template_buff,
+                                      standard_size);
+}
+
+ANJ_UNIT_TEST(anj_prepare_udp, templates_notify) {
+    _anj_coap_msg_templates_t templates = { 0 };
+    _anj_coap_msg_t data = { 0 };
+
+    data.operation = ANJ_OP_INF_CON_NOTIFY;
+    data.token.size = 4;
+    memcpy(data.token.bytes, "\x01\x02\x03\x04", 4);
+    data.content_format = _ANJ_COAP_FORMAT_SENML_CBOR;
+    data.payload = (uint8_t *) "\x81\xa2\x00\x61\x61\x02\x01";
+    data.payload_size = 7;
+    data.coap_binding_data.message_id = 0x1234;
+    for (uint32_t observe_number = 0; observe_number < 0x1000000;
+         observe_number = observe_number * 16 + 1) {
+        data.observe_number = observe_number;
+        data.coap_binding_data.message_id++;
+        encode_with_and_without_templates(&templates, &data);
+    }
+    ANJ_UNIT_ASSERT_TRUE(templates.notify.valid);
+    ANJ_UNIT_ASSERT_EQUAL(templates.notify.content_format,
+                          _ANJ_COAP_FORMAT_SENML_CBOR);
+
+    // different Content-Format, Block2 option and message type
+    data.operation = ANJ_OP_INF_NON_CON_NOTIFY;
+    data.content_format = _ANJ_COAP_FORMAT_PLAINTEXT;
+    data.block = (_anj_block_t) {
+        .block_type = ANJ_OPTION_BLOCK_2,
+        .number = 20,
+        .size = 512,
+        .more_flag = true
+    };
+    encode_with_and_without_templates(&templates, &data);
+    ANJ_UNIT_ASSERT_EQUAL(templates.notify.content_format,
+                          _ANJ_COAP_FORMAT_PLAINTEXT);
+
+    // initial notification with an error code has no Observe and no payload
+    data.operation = ANJ_OP_INF_INITIAL_NOTIFY;
+    data.msg_code = ANJ_COAP_CODE_NOT_FOUND;
+    data.block.block_type = ANJ_OPTION_BLOCK_NOT_DEFINED;
+    data.payload = NULL;
+    data.payload_size = 0;
+    encode_with_and_without_templates(&templates, &data);
+    ANJ_UNIT_ASSERT_EQUAL(templates.notify.content_format,
+                          _ANJ_COAP_FORMAT_NOT_DEFINED);
+    ANJ_UNIT_ASSERT_EQUAL(templates.notify.size, 0);
+}
+
+ANJ_UNIT_TEST(anj_prepare_udp, templates_update_and_send) {
+    _anj_coap_msg_templates_t templates = { 0 };
+    _anj_coap_msg_t update = { 0 };
+    _anj_coap_msg_t send = { 0 };
+
+    update.operation = ANJ_OP_UPDATE;
+    update.token.size = 8;
+    update.location_path.location[0] = "rd";
+    update.location_path.location_len[0] = 2;
+    update.location_path.location[1] = "5a3f";
+    update.location_path.location_len[1] = 4;
+    update.location_path.location_count = 2;
+    encode_with_and_without_templates(&templates, &update);
+    ANJ_UNIT_ASSERT_TRUE(templates.update.valid);
+    ANJ_UNIT_ASSERT_EQUAL(templates.update.location_count, 2);
+
+    // Uri-Query options are added after the template
+    update.attr.register_attr.has_lifetime = true;
+    update.attr.register_attr.lifetime =
+            anj_time_duration_new(86400, ANJ_TIME_UNIT_S);
+    update.attr.register_attr.has_binding = true;
+    update.attr.register_attr.binding = "UQ";
+    encode_with_and_without_templates(&templates, &update);
+
+    // Send in between doesn't affect the Update template
+    send.operation = ANJ_OP_INF_CON_SEND;
+    send.token.size = 8;
+    send.content_format = _ANJ_COAP_FORMAT_SENML_CBOR;
+    send.payload = (uint8_t *) "\x80";
+    send.payload_size = 1;
+    send.block = (_anj_block_t) {
+        .block_type = ANJ_OPTION_BLOCK_1,
+        .number = 2,
+        .size = 64,
+        .more_flag = true
+    };
+    encode_with_and_without_templates(&templates, &send);
+    ANJ_UNIT_ASSERT_TRUE(templates.send.valid);
+    send.operation = ANJ_OP_INF_NON_CON_SEND;
+    send.block.more_flag = false;
+    encode_with_and_without_templates(&templates, &send);
+
+    // Register response with a new Location-Path of the same length
+    update.location_path.location[1] = "7b21";
+    encode_with_and_without_templates(&templates, &update);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(
+            &templates.update.buff[templates.update.location_offset[1]],
+            "7b21", 4);
+
+    update.location_path.location[0] = "a-much-longer-location";
+    update.location_path.location_len[0] = 22;
+    update.location_path.location_count = 1;
+    update.content_format = _ANJ_COAP_FORMAT_LINK_FORMAT;
+    update.payload = (uint8_t *) "</1/0>";
+    update.payload_size = 6;
+    encode_with_and_without_templates(&templates, &update);
+    ANJ_UNIT_ASSERT_EQUAL(templates.update.location_count, 1);
+}
+
+ANJ_UNIT_TEST(anj_prepare_udp, templates_missing_content_format) {
+    _anj_coap_msg_templates_t templates = { 0 };
+    _anj_coap_msg_t data = { 0 };
+    uint8_t buff[100];
+    size_t out_msg_size;
+
+    data.operation = ANJ_OP_INF_CON_SEND;
+    data.content_format = _ANJ_COAP_FORMAT_NOT_DEFINED;
+    data.payload = (uint8_t *) "\x80";
+    data.payload_size = 1;
+    ANJ_UNIT_ASSERT_EQUAL(
+            _anj_coap_encode_udp_with_templates(&templates, &data, buff,
+                                                sizeof(buff), &out_msg_size),
+            _ANJ_ERR_INPUT_ARG);
+    ANJ_UNIT_ASSERT_FALSE(templates.send.valid);
+}
+#endif // ANJ_COAP_WITH_MSG_TEMPLATES
+
+#ifdef ANJ_WITH_SCRATCH_ARENA
+ANJ_UNIT_TEST(anj_prepare_udp, scratch_same_as_stack) {
+    anj_coap_option_t options[ANJ_COAP_MAX_OPTIONS_NUMBER];
+    _anj_coap_msg_t data = { 0 };
+    uint8_t standard_buff[100];
+    uint8_t scratch_buff[100];
+    size_t standard_size;
+    size_t scratch_size;
+
+    data.operation = ANJ_OP_RESPONSE;
+    data.msg_code = ANJ_COAP_CODE_CONTENT;
+    data.coap_binding_data.type = ANJ_COAP_UDP_TYPE_CONFIRMABLE;
+    data.token.size = 8;
+    data.content_format = _ANJ_COAP_FORMAT_SENML_CBOR;
+    data.payload = (uint8_t *) "\x81\xa2\x00\x61\x61\x02\x01";
+    data.payload_size = 7;
+    data.coap_binding_data.message_id = 0x2137;
+    _anj_coap_msg_t scratch_msg = data;
+
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_coap_encode_udp(
+            &data, standard_buff, sizeof(standard_buff), &standard_size));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_coap_encode_udp_with_scratch(
+            options, NULL, &scratch_msg, scratch_buff, sizeof(scratch_buff),
+            true, &scratch_size));
+    ANJ_UNIT_ASSERT_EQUAL(standard_size, scratch_size);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(standard_buff, scratch_buff,
+                                      standard_size);
+
+    _anj_coap_msg_t decoded;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_coap_decode_udp_with_scratch(
+            options, scratch_buff, scratch_size, &decoded));
+    ANJ_UNIT_ASSERT_EQUAL(decoded.operation, ANJ_OP_RESPONSE);
+    ANJ_UNIT_ASSERT_EQUAL(decoded.coap_binding_data.message_id, 0x2137);
+    ANJ_UNIT_ASSERT_EQUAL(decoded.content_format, _ANJ_COAP_FORMAT_SENML_CBOR);
+    ANJ_UNIT_ASSERT_EQUAL(decoded.payload_size, 7);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(decoded.payload, data.payload, 7);
+}
+#endif // ANJ_WITH_SCRATCH_ARENA
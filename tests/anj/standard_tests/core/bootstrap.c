@@ -222,7 +222,7 @@ ANJ_UNIT_TEST(bootstrap, bootstrap_timeout) {
     ASSERT_EQ(_anj_bootstrap_process(&anj, &request, &exchange_handlers),
               _ANJ_BOOTSTRAP_IN_PROGRESS);
     mock_time_advance(
-            anj_time_duration_add(anj.bootstrap_ctx.bootstrap_lifetime,
+            anj_time_duration_add(anj.state_ctx.bootstrap_ctx.bootstrap_lifetime,
                                   anj_time_duration_new(1, ANJ_TIME_UNIT_S)));
 
     ASSERT_EQ(_anj_bootstrap_process(&anj, &request, &exchange_handlers),
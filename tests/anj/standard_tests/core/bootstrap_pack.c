@@ -0,0 +1,345 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/anj_config.h>
+#include <anj/compat/net/anj_net_api.h>
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/dm/core.h>
+#include <anj/dm/security_object.h>
+#include <anj/dm/server_object.h>
+
+#include "../../../../src/anj/coap/coap.h"
+#include "../../../../src/anj/core/bootstrap.h"
+#include "../../../../src/anj/dm/dm_io.h"
+#include "../../../../src/anj/core/server_bootstrap.h"
+#include "../../../../src/anj/exchange.h"
+#include "../mock/net_api_mock.h"
+#include "../mock/time_api_mock.h"
+
+#include <anj_unit_test.h>
+
+#ifdef ANJ_WITH_BOOTSTRAP_PACK
+
+#    define TEST_INIT()                                                       \
+        anj_t anj = { 0 };                                                    \
+        const char endpoint[] = "test";                                       \
+        _anj_dm_initialize(&anj);                                             \
+        anj_dm_security_obj_t sec_obj;                                        \
+        anj_dm_security_obj_init(&sec_obj);                                   \
+        anj_dm_security_instance_init_t sec_inst = {                          \
+            .server_uri = "coap://bootstrap-server.com:5693",                 \
+            .bootstrap_server = true,                                         \
+            .security_mode = ANJ_DM_SECURITY_NOSEC,                           \
+        };                                                                    \
+        ASSERT_OK(anj_dm_security_obj_add_instance(&sec_obj, &sec_inst));     \
+        ASSERT_OK(anj_dm_security_obj_install(&anj, &sec_obj));               \
+        anj_dm_server_obj_t ser_obj;                                          \
+        anj_dm_server_obj_init(&ser_obj);                                     \
+        ASSERT_OK(anj_dm_server_obj_install(&anj, &ser_obj));                 \
+        mock_time_reset();                                                    \
+        _anj_bootstrap_ctx_init(&anj, endpoint,                               \
+                                anj_time_duration_new(247, ANJ_TIME_UNIT_S)); \
+        _anj_coap_msg_t request = { 0 };                                      \
+        _anj_exchange_handlers_t exchange_handlers;                           \
+        ASSERT_EQ(_anj_bootstrap_process(&anj, &request, &exchange_handlers), \
+                  _ANJ_BOOTSTRAP_NEW_REQUEST_TO_SEND);                        \
+        ASSERT_EQ(request.operation, ANJ_OP_BOOTSTRAP_PACK_REQ)
+
+#    define SECURITY_INSTANCE_RECORDS               \
+        "\xa3\x21\x65"                              \
+        "/0/1/"                                     \
+        "\x00\x61\x30\x03\x76"                      \
+        "coap://server.com:5683" /* /0/1/0 */       \
+        "\xa2\x00\x61\x32\x02\x03" /* /0/1/2 */     \
+        "\xa2\x00\x61\x31\x04\xf4" /* /0/1/1 */     \
+        "\xa2\x00\x62\x31\x30\x02\x01" /* /0/1/10 */
+
+#    define SERVER_INSTANCE_RECORDS                 \
+        "\xa3\x21\x65"                              \
+        "/1/2/"                                     \
+        "\x00\x61\x30\x02\x01" /* /1/2/0 */         \
+        "\xa2\x00\x61\x31\x02\x18\x3c" /* /1/2/1 */ \
+        "\xa2\x00\x61\x36\x04\xf4" /* /1/2/6 */     \
+        "\xa2\x00\x61\x37\x03\x61\x55" /* /1/2/7 */
+
+static char pack[] = "\x88" SECURITY_INSTANCE_RECORDS SERVER_INSTANCE_RECORDS;
+
+static void verify_configuration(anj_t *anj) {
+    anj_res_value_t value;
+    ASSERT_OK(anj_dm_res_read(anj, &ANJ_MAKE_RESOURCE_PATH(0, 1, 0), &value));
+    ASSERT_EQ_STR((const char *) value.bytes_or_string.data,
+                  "coap://server.com:5683");
+    ASSERT_OK(anj_dm_res_read(anj, &ANJ_MAKE_RESOURCE_PATH(1, 2, 1), &value));
+    ASSERT_EQ(value.int_value, 60);
+}
+
+ANJ_UNIT_TEST(bootstrap_pack, bootstrap_pack_request) {
+    TEST_INIT();
+
+    uint8_t msg_buffer[100];
+    size_t msg_size;
+    request.token.size = 2;
+    request.token.bytes[0] = 0x01;
+    request.token.bytes[1] = 0x01;
+    request.coap_binding_data.message_id = 0x0404;
+    ASSERT_OK(_anj_coap_encode_udp(&request, msg_buffer, sizeof(msg_buffer),
+                                   &msg_size));
+    uint8_t EXPECTED[] =
+            "\x42"                             // Confirmable, tkl 2
+            "\x01\x04\x04"                     // GET 0x01, msg id 0404
+            "\x01\x01"                         // token
+            "\xb6\x62\x73\x70\x61\x63\x6b"     // uri path /bspack
+            "\x47\x65\x70\x3d\x74\x65\x73\x74" // uri-query ep=test
+            "\x21\x70";                        // accept senml+cbor
+    ASSERT_EQ_BYTES_SIZED(msg_buffer, EXPECTED, sizeof(EXPECTED) - 1);
+    ASSERT_EQ(msg_size, sizeof(EXPECTED) - 1);
+
+    ASSERT_EQ(exchange_handlers.write_payload(exchange_handlers.arg,
+                                              (uint8_t *) pack,
+                                              sizeof(pack) - 1, true),
+              0);
+    exchange_handlers.completion(exchange_handlers.arg, NULL,
+                                 _ANJ_EXCHANGE_RESULT_SUCCESS);
+    ASSERT_EQ(_anj_bootstrap_process(&anj, &request, &exchange_handlers),
+              _ANJ_BOOTSTRAP_FINISHED);
+    ASSERT_FALSE(anj.dm.op_in_progress);
+    verify_configuration(&anj);
+}
+
+ANJ_UNIT_TEST(bootstrap_pack, block_transfer) {
+    TEST_INIT();
+
+    // block boundaries inside records of both Instances
+    const size_t blocks[] = { 16, 48, sizeof(pack) - 1 - 16 - 48 };
+    size_t offset = 0;
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(blocks); i++) {
+        ASSERT_EQ(exchange_handlers.write_payload(
+                          exchange_handlers.arg, (uint8_t *) &pack[offset],
+                          blocks[i], i == ANJ_ARRAY_SIZE(blocks) - 1),
+                  0);
+        offset += blocks[i];
+        ASSERT_EQ(_anj_bootstrap_process(&anj, &request, &exchange_handlers),
+                  _ANJ_BOOTSTRAP_IN_PROGRESS);
+    }
+    exchange_handlers.completion(exchange_handlers.arg, NULL,
+                                 _ANJ_EXCHANGE_RESULT_SUCCESS);
+    ASSERT_EQ(_anj_bootstrap_process(&anj, &request, &exchange_handlers),
+              _ANJ_BOOTSTRAP_FINISHED);
+    verify_configuration(&anj);
+}
+
+ANJ_UNIT_TEST(bootstrap_pack, rejected_fallback_to_bootstrap_request) {
+    TEST_INIT();
+
+    exchange_handlers.completion(exchange_handlers.arg, NULL,
+                                 _ANJ_EXCHANGE_ERROR_SERVER_RESPONSE);
+    memset(&request, 0, sizeof(request));
+    ASSERT_EQ(_anj_bootstrap_process(&anj, &request, &exchange_handlers),
+              _ANJ_BOOTSTRAP_NEW_REQUEST_TO_SEND);
+    ASSERT_EQ(request.operation, ANJ_OP_BOOTSTRAP_REQ);
+    ASSERT_NULL(exchange_handlers.write_payload);
+    exchange_handlers.completion(exchange_handlers.arg, NULL,
+                                 _ANJ_EXCHANGE_RESULT_SUCCESS);
+    ASSERT_EQ(_anj_bootstrap_process(&anj, &request, &exchange_handlers),
+              _ANJ_BOOTSTRAP_IN_PROGRESS);
+
+    // no Server Object Instance written by the LwM2M Bootstrap-Server
+    uint8_t response_code;
+    _anj_bootstrap_finish_request(&anj, &response_code, &exchange_handlers);
+    ASSERT_EQ(response_code, ANJ_COAP_CODE_NOT_ACCEPTABLE);
+    exchange_handlers.completion(exchange_handlers.arg, NULL,
+                                 _ANJ_EXCHANGE_RESULT_SUCCESS);
+    ASSERT_EQ(_anj_bootstrap_process(&anj, &request, &exchange_handlers),
+              _ANJ_BOOTSTRAP_ERR_DATA_MODEL_VALIDATION);
+}
+
+ANJ_UNIT_TEST(bootstrap_pack, data_model_validation_error) {
+    TEST_INIT();
+
+    static char security_only[] = "\x84" SECURITY_INSTANCE_RECORDS;
+    ASSERT_EQ(exchange_handlers.write_payload(exchange_handlers.arg,
+                                              (uint8_t *) security_only,
+                                              sizeof(security_only) - 1, true),
+              0);
+    exchange_handlers.completion(exchange_handlers.arg, NULL,
+                                 _ANJ_EXCHANGE_RESULT_SUCCESS);
+    ASSERT_EQ(_anj_bootstrap_process(&anj, &request, &exchange_handlers),
+              _ANJ_BOOTSTRAP_ERR_DATA_MODEL_VALIDATION);
+}
+
+ANJ_UNIT_TEST(bootstrap_pack, write_error) {
+    TEST_INIT();
+
+    // /2/0/0 - there is no such Object
+    static char unknown_object[] = "\x81\xa3\x21\x65"
+                                   "/2/0/"
+                                   "\x00\x61\x30\x02\x01";
+    ASSERT_EQ(exchange_handlers.write_payload(exchange_handlers.arg,
+                                              (uint8_t *) unknown_object,
+                                              sizeof(unknown_object) - 1,
+                                              true),
+              ANJ_COAP_CODE_NOT_FOUND);
+    exchange_handlers.completion(exchange_handlers.arg, NULL,
+                                 _ANJ_EXCHANGE_ERROR_REQUEST);
+    ASSERT_FALSE(anj.dm.op_in_progress);
+    ASSERT_EQ(_anj_bootstrap_process(&anj, &request, &exchange_handlers),
+              _ANJ_BOOTSTRAP_ERR_DATA_MODEL_VALIDATION);
+}
+
+ANJ_UNIT_TEST(bootstrap_pack, exchange_failed_in_the_middle) {
+    TEST_INIT();
+
+    ASSERT_EQ(exchange_handlers.write_payload(exchange_handlers.arg,
+                                              (uint8_t *) pack, 80, false),
+              0);
+    ASSERT_TRUE(anj.dm.op_in_progress);
+    exchange_handlers.completion(exchange_handlers.arg, NULL,
+                                 _ANJ_EXCHANGE_ERROR_TIMEOUT);
+    ASSERT_FALSE(anj.dm.op_in_progress);
+    ASSERT_EQ(_anj_bootstrap_process(&anj, &request, &exchange_handlers),
+              _ANJ_BOOTSTRAP_ERR_EXCHANGE_ERROR);
+}
+
+#    define CORE_TEST_INIT()                                                 \
+        mock_time_reset();                                                   \
+        net_api_mock_t mock = { 0 };                                         \
+        net_api_mock_ctx_init(&mock);                                        \
+        mock.inner_mtu_value = 128;                                          \
+        anj_t anj;                                                           \
+        anj_configuration_t config = {                                       \
+            .endpoint_name = "name"                                          \
+        };                                                                   \
+        ASSERT_OK(anj_core_init(&anj, &config));                             \
+        anj_dm_security_obj_t sec_obj;                                       \
+        anj_dm_security_obj_init(&sec_obj);                                  \
+        anj_dm_security_instance_init_t sec_inst = {                         \
+            .server_uri = "coap://bootstrap-server.com:5693",                \
+            .bootstrap_server = true,                                        \
+            .security_mode = ANJ_DM_SECURITY_NOSEC,                          \
+        };                                                                   \
+        ASSERT_OK(anj_dm_security_obj_add_instance(&sec_obj, &sec_inst));    \
+        ASSERT_OK(anj_dm_security_obj_install(&anj, &sec_obj));              \
+        anj_dm_server_obj_t ser_obj;                                         \
+        anj_dm_server_obj_init(&ser_obj);                                    \
+        ASSERT_OK(anj_dm_server_obj_install(&anj, &ser_obj));                \
+        anj_core_step(&anj);                                                 \
+        ASSERT_EQ(anj.server_state.conn_status,                              \
+                  ANJ_CONN_STATUS_BOOTSTRAPPING);                            \
+        ASSERT_EQ(mock.state, ANJ_NET_SOCKET_STATE_CONNECTED);               \
+        /* allow sending data */                                             \
+        mock.bytes_to_send = 100;                                            \
+        anj_core_step(&anj);                                                 \
+        ASSERT_EQ(anj.server_state.conn_status,                              \
+                  ANJ_CONN_STATUS_BOOTSTRAPPING);                            \
+        verify_sent_request(&mock, expected_bootstrap_pack_request,          \
+                            sizeof(expected_bootstrap_pack_request) - 1, -1)
+
+static const char expected_bootstrap_pack_request[] =
+        "\x48"                             // Confirmable, tkl 8
+        "\x01\x00\x00"                     // GET, msg_id
+        "\x00\x00\x00\x00\x00\x00\x00\x00" // token
+        "\xb6\x62\x73\x70\x61\x63\x6b"     // uri path /bspack
+        "\x47\x65\x70\x3d\x6e\x61\x6d\x65" // uri-query: ep=name
+        "\x21\x70";                        // accept senml+cbor
+
+// message id and token are not compared, block2 option of the request for the
+// next block is compared if @p block_number is not negative
+static void verify_sent_request(net_api_mock_t *mock,
+                                const char *expected,
+                                size_t expected_len,
+                                int block_number) {
+    size_t len = expected_len + (block_number >= 0 ? 2 : 0);
+    ASSERT_EQ(mock->bytes_sent, len);
+    ASSERT_EQ_BYTES_SIZED(mock->send_data_buffer, expected, 2);
+    ASSERT_EQ_BYTES_SIZED(&mock->send_data_buffer[12], &expected[12],
+                          expected_len - 12);
+    if (block_number >= 0) {
+        // block2 option, block size 32
+        uint8_t block2[] = { 0x61, (uint8_t) ((block_number << 4) | 0x01) };
+        ASSERT_EQ_BYTES_SIZED(&mock->send_data_buffer[expected_len], block2,
+                              2);
+    }
+}
+
+static uint8_t response_buffer[100];
+
+static void receive_response(net_api_mock_t *mock,
+                             const char *response,
+                             size_t response_len) {
+    memcpy(response_buffer, response, response_len);
+    // correct response must contain the same token and message id as request
+    memcpy(&response_buffer[2], &mock->send_data_buffer[2], 10);
+    mock->bytes_to_recv = response_len;
+    mock->data_to_recv = response_buffer;
+}
+
+static void receive_bootstrap_pack_block(net_api_mock_t *mock,
+                                         size_t block_number) {
+    const size_t block_size = 32;
+    size_t offset = block_number * block_size;
+    bool more = (sizeof(pack) - 1 - offset > block_size);
+    size_t payload_len = more ? block_size : sizeof(pack) - 1 - offset;
+    char response[100] =
+            "\x68"                             // Ack, tkl 8
+            "\x45\x00\x00"                     // CONTENT code 2.05, msg_id
+            "\x00\x00\x00\x00\x00\x00\x00\x00" // token
+            "\xc1\x70"                         // content-format senml+cbor
+            "\xb1\x00"                         // block2
+            "\xff";                            // payload marker
+    response[15] = (char) ((block_number << 4) | (more ? 0x08 : 0) | 0x01);
+    memcpy(&response[17], &pack[offset], payload_len);
+    receive_response(mock, response, 17 + payload_len);
+}
+
+ANJ_UNIT_TEST(bootstrap_pack, mimic_bootstrap_pack) {
+    CORE_TEST_INIT();
+
+    receive_bootstrap_pack_block(&mock, 0);
+    anj_core_step(&anj);
+    verify_sent_request(&mock, expected_bootstrap_pack_request,
+                        sizeof(expected_bootstrap_pack_request) - 1, 1);
+    receive_bootstrap_pack_block(&mock, 1);
+    anj_core_step(&anj);
+    verify_sent_request(&mock, expected_bootstrap_pack_request,
+                        sizeof(expected_bootstrap_pack_request) - 1, 2);
+    receive_bootstrap_pack_block(&mock, 2);
+    anj_core_step(&anj);
+
+    // Bootstrap-Finish is not awaited
+    ASSERT_EQ(anj.server_state.conn_status, ANJ_CONN_STATUS_REGISTERING);
+    verify_configuration(&anj);
+}
+
+ANJ_UNIT_TEST(bootstrap_pack, mimic_bootstrap_pack_not_supported) {
+    CORE_TEST_INIT();
+
+    static const char not_found[] = "\x68"         // Ack, tkl 8
+                                    "\x84\x00\x00" // NOT FOUND code 4.04
+                                    "\x00\x00\x00\x00\x00\x00\x00\x00";
+    receive_response(&mock, not_found, sizeof(not_found) - 1);
+    anj_core_step(&anj);
+    ASSERT_EQ(anj.server_state.conn_status, ANJ_CONN_STATUS_BOOTSTRAPPING);
+
+    static const char expected_bootstrap_request[] =
+            "\x48"                              // Confirmable, tkl 8
+            "\x02\x00\x00"                      // POST, msg_id
+            "\x00\x00\x00\x00\x00\x00\x00\x00"  // token
+            "\xb2\x62\x73"                      // uri path /bs
+            "\x47\x65\x70\x3d\x6e\x61\x6d\x65"  // uri-query: ep=name
+            "\x07\x70\x63\x74\x3d\x31\x31\x32"; // uri-query: pct=112
+    verify_sent_request(&mock, expected_bootstrap_request,
+                        sizeof(expected_bootstrap_request) - 1, -1);
+}
+
+#endif // ANJ_WITH_BOOTSTRAP_PACK
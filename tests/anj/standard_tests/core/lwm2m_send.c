@@ -30,6 +30,15 @@
 
 #include <anj_unit_test.h>
 
+#ifdef ANJ_WITH_MSG_BUFFER_ARENA
+static uint8_t msg_buffer_arena[ANJ_MSG_BUFFER_ARENA_SIZE];
+#    define SET_MSG_BUFFER_ARENA(Config)              \
+        (Config).msg_buffer_arena = msg_buffer_arena; \
+        (Config).msg_buffer_arena_size = sizeof(msg_buffer_arena)
+#else // ANJ_WITH_MSG_BUFFER_ARENA
+#    define SET_MSG_BUFFER_ARENA(Config) (void) 0
+#endif // ANJ_WITH_MSG_BUFFER_ARENA
+
 // inner_mtu_value value will lead to block transfer for addtional objects in
 // payload
 #define _TEST_INIT(With_queue_mode, Queue_timeout)         \
@@ -43,6 +52,7 @@
         .queue_mode_enabled = With_queue_mode,             \
         .queue_mode_timeout = Queue_timeout                \
     };                                                     \
+    SET_MSG_BUFFER_ARENA(config);                          \
     ANJ_UNIT_ASSERT_SUCCESS(anj_core_init(&anj, &config)); \
     anj_dm_security_obj_t sec_obj;                         \
     anj_dm_security_obj_init(&sec_obj);                    \
@@ -309,6 +319,11 @@ ANJ_UNIT_TEST(lwm2m_send, new_send_errors) {
     ANJ_UNIT_ASSERT_EQUAL(anj_send_new_request(&anj, &send_req, NULL),
                           ANJ_SEND_ERR_NO_SPACE);
     ANJ_UNIT_ASSERT_EQUAL(send_id, 2);
+#ifdef ANJ_WITH_RESOURCE_USAGE
+    anj_resource_usage_t usage;
+    anj_core_get_resource_usage(&anj, &usage);
+    ANJ_UNIT_ASSERT_EQUAL(usage.send_queue_max, ANJ_LWM2M_SEND_QUEUE_SIZE);
+#endif // ANJ_WITH_RESOURCE_USAGE
 }
 
 ANJ_UNIT_TEST(lwm2m_send, send_id_overflow) {
@@ -334,6 +349,42 @@ ANJ_UNIT_TEST(lwm2m_send, send_id_overflow) {
     ANJ_UNIT_ASSERT_EQUAL(send_id, 2);
 }
 
+#ifdef ANJ_LWM2M_SEND_WITH_PRIORITIES
+ANJ_UNIT_TEST(lwm2m_send, send_priorities) {
+    EXTENDED_INIT();
+    PROCESS_REGISTRATION();
+
+    anj_send_request_t low_req = {
+        .finished_handler = send_finished_handler,
+        .content_format = ANJ_SEND_CONTENT_FORMAT_SENML_CBOR,
+        .records_cnt = 1,
+        .records = &default_record_1
+    };
+    anj_send_request_t high_req = low_req;
+    high_req.priority = 5;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_new_request(&anj, &low_req, NULL));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_new_request(&anj, &low_req, NULL));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_new_request(&anj, &high_req, NULL));
+    // FIFO order within the same priority
+    ANJ_UNIT_ASSERT_EQUAL(anj.send_ctx.ids[0], 3);
+    ANJ_UNIT_ASSERT_EQUAL(anj.send_ctx.ids[1], 1);
+    ANJ_UNIT_ASSERT_EQUAL(anj.send_ctx.ids[2], 2);
+    ANJ_UNIT_ASSERT_TRUE(anj.send_ctx.requests_queue[0] == &high_req);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_abort(&anj, ANJ_SEND_ID_ALL));
+
+    // request being sent stays at the head of the queue
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_new_request(&anj, &low_req, NULL));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_new_request(&anj, &low_req, NULL));
+    mock.bytes_to_send = 500;
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_TRUE(anj.send_ctx.active_exchange);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_new_request(&anj, &high_req, NULL));
+    ANJ_UNIT_ASSERT_EQUAL(anj.send_ctx.ids[0], 4);
+    ANJ_UNIT_ASSERT_EQUAL(anj.send_ctx.ids[1], 6);
+    ANJ_UNIT_ASSERT_EQUAL(anj.send_ctx.ids[2], 5);
+}
+#endif // ANJ_LWM2M_SEND_WITH_PRIORITIES
+
 ANJ_UNIT_TEST(lwm2m_send, send_abort_base_check) {
     EXTENDED_INIT();
     PROCESS_REGISTRATION();
@@ -531,6 +582,275 @@ ANJ_UNIT_TEST(lwm2m_send, two_sends_in_the_row) {
     FINAL_CHECK(2, 0);
 }
 
+#ifdef ANJ_LWM2M_SEND_WITH_FILTER
+static char short_send_48[] = "\x48"         // Confirmable, tkl 8
+                              "\x02\x00\x00" // POST 0x02, msg id
+                              "\x00\x00\x00\x00\x00\x00\x00\x00" // token
+                              "\xb2\x64\x70" // uri path /dp
+                              "\x11\x70"     // content_format: senml-cbor
+                              "\xFF"
+                              "\x81\xa2"       // map(2)
+                              "\x21\x66/3/0/9" // path
+                              "\x02\x18\x30";  // value 48
+
+static char short_send_17[] = "\x48"         // Confirmable, tkl 8
+                              "\x02\x00\x00" // POST 0x02, msg id
+                              "\x00\x00\x00\x00\x00\x00\x00\x00" // token
+                              "\xb2\x64\x70" // uri path /dp
+                              "\x11\x70"     // content_format: senml-cbor
+                              "\xFF"
+                              "\x81\xa2"        // map(2)
+                              "\x21\x67/3/0/17" // path
+                              "\x02\x07";       // value 7
+
+#    define NEW_SHORT_SEND(Value, Filter_disabled)                        \
+        short_record.value.int_value = (Value);                          \
+        send_req.filter_disabled = (Filter_disabled);                    \
+        ANJ_UNIT_ASSERT_SUCCESS(anj_send_new_request(&anj, &send_req, NULL))
+
+ANJ_UNIT_TEST(lwm2m_send, send_filter) {
+    EXTENDED_INIT();
+    PROCESS_REGISTRATION();
+    anj_io_out_entry_t short_record = default_record_1;
+    short_record.timestamp = NAN;
+    anj_send_request_t send_req = {
+        .finished_handler = send_finished_handler,
+        .content_format = ANJ_SEND_CONTENT_FORMAT_SENML_CBOR,
+        .records_cnt = 1,
+        .records = &short_record
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_send_filter_set(&anj, &ANJ_MAKE_RESOURCE_PATH(3, 0, 9), 5.0));
+
+    // no value sent yet
+    NEW_SHORT_SEND(42, false);
+    HANDLE_SEND(short_send, send_response);
+    FINAL_CHECK(1, 0);
+
+    // within the deadband, request completed without sending anything
+    NEW_SHORT_SEND(45, false);
+    mock.bytes_sent = 0;
+    mock.bytes_to_send = 500;
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+    FINAL_CHECK(2, 0);
+
+    // compared with 42, the last value sent
+    NEW_SHORT_SEND(48, false);
+    HANDLE_SEND(short_send_48, send_response);
+    FINAL_CHECK(3, 0);
+
+    NEW_SHORT_SEND(48, true);
+    HANDLE_SEND(short_send_48, send_response);
+    FINAL_CHECK(4, 0);
+
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_send_filter_remove(&anj, &ANJ_MAKE_RESOURCE_PATH(3, 0, 9)));
+    NEW_SHORT_SEND(48, false);
+    HANDLE_SEND(short_send_48, send_response);
+    FINAL_CHECK(5, 0);
+}
+
+ANJ_UNIT_TEST(lwm2m_send, send_filter_drops_records) {
+    EXTENDED_INIT();
+    PROCESS_REGISTRATION();
+    anj_io_out_entry_t short_record = default_record_1;
+    short_record.timestamp = NAN;
+    anj_send_request_t send_req = {
+        .finished_handler = send_finished_handler,
+        .content_format = ANJ_SEND_CONTENT_FORMAT_SENML_CBOR,
+        .records_cnt = 1,
+        .records = &short_record
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_send_filter_set(&anj, &ANJ_MAKE_RESOURCE_PATH(3, 0, 9), 0.0));
+    NEW_SHORT_SEND(42, false);
+    HANDLE_SEND(short_send, send_response);
+    FINAL_CHECK(1, 0);
+
+    anj_io_out_entry_t records[] = {
+        short_record,
+        {
+            .path = ANJ_MAKE_RESOURCE_PATH(3, 0, 17),
+            .type = ANJ_DATA_TYPE_INT,
+            .value.int_value = 7,
+            .timestamp = NAN
+        }
+    };
+    anj_send_request_t send_req_2 = {
+        .finished_handler = send_finished_handler,
+        .content_format = ANJ_SEND_CONTENT_FORMAT_SENML_CBOR,
+        .records_cnt = ANJ_ARRAY_SIZE(records),
+        .records = records
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_new_request(&anj, &send_req_2, NULL));
+    HANDLE_SEND(short_send_17, send_response);
+    FINAL_CHECK(2, 0);
+}
+
+ANJ_UNIT_TEST(lwm2m_send, send_filter_errors) {
+    EXTENDED_INIT();
+    ANJ_UNIT_ASSERT_EQUAL(
+            anj_send_filter_set(&anj, &ANJ_MAKE_INSTANCE_PATH(3, 0), 1.0),
+            ANJ_SEND_ERR_DATA_NOT_VALID);
+    ANJ_UNIT_ASSERT_EQUAL(
+            anj_send_filter_set(&anj, &ANJ_MAKE_RESOURCE_PATH(3, 0, 9), -1.0),
+            ANJ_SEND_ERR_DATA_NOT_VALID);
+    ANJ_UNIT_ASSERT_EQUAL(
+            anj_send_filter_remove(&anj, &ANJ_MAKE_RESOURCE_PATH(3, 0, 9)),
+            ANJ_SEND_ERR_NO_REQUEST_FOUND);
+    for (uint16_t i = 0; i < ANJ_LWM2M_SEND_FILTER_SIZE; i++) {
+        ANJ_UNIT_ASSERT_SUCCESS(anj_send_filter_set(
+                &anj, &ANJ_MAKE_RESOURCE_PATH(3, 0, i), 1.0));
+    }
+    ANJ_UNIT_ASSERT_EQUAL(
+            anj_send_filter_set(&anj,
+                                &ANJ_MAKE_RESOURCE_PATH(
+                                        3, 0, ANJ_LWM2M_SEND_FILTER_SIZE),
+                                1.0),
+            ANJ_SEND_ERR_NO_SPACE);
+    // changing the deadband of an existing filter needs no space
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_send_filter_set(&anj, &ANJ_MAKE_RESOURCE_PATH(3, 0, 0), 2.0));
+}
+#endif // ANJ_LWM2M_SEND_WITH_FILTER
+
+#ifdef ANJ_WITH_QUEUE_MODE_WAKE_WINDOW
+#ifdef ANJ_LWM2M_SEND_WITH_NON_CONFIRMABLE
+ANJ_UNIT_TEST(lwm2m_send, non_confirmable_send) {
+    EXTENDED_INIT();
+    PROCESS_REGISTRATION();
+    anj_io_out_entry_t records[] = { default_record_1, default_record_2 };
+    anj_send_request_t send_req = {
+        .finished_handler = send_finished_handler,
+        .content_format = ANJ_SEND_CONTENT_FORMAT_SENML_CBOR,
+        .records_cnt = ANJ_ARRAY_SIZE(records),
+        .records = records,
+        .non_confirmable = true
+    };
+    for (uint16_t id = 1; id <= 4; id++) {
+        ANJ_UNIT_ASSERT_SUCCESS(anj_send_new_request(&anj, &send_req, NULL));
+        mock.bytes_to_send = 500;
+        anj_core_step(&anj);
+        mock.bytes_to_send = 0;
+        ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, sizeof(basic_send) - 1);
+        if (ANJ_LWM2M_SEND_CON_EVERY_N == 0
+                || id % ANJ_LWM2M_SEND_CON_EVERY_N != 0) {
+            // Non-confirmable, finished once sent
+            ANJ_UNIT_ASSERT_EQUAL(mock.send_data_buffer[0], 0x58);
+            FINAL_CHECK(id, 0);
+        } else {
+            ANJ_UNIT_ASSERT_EQUAL(mock.send_data_buffer[0], 0x48);
+            ANJ_UNIT_ASSERT_EQUAL(anj.send_ctx.ids[0], id);
+            ADD_RESPONSE(send_response);
+            anj_core_step(&anj);
+            FINAL_CHECK(id, 0);
+        }
+        mock.bytes_sent = 0;
+    }
+}
+#endif // ANJ_LWM2M_SEND_WITH_NON_CONFIRMABLE
+
+ANJ_UNIT_TEST(lwm2m_send, send_in_queue_mode_wake_window) {
+    EXTENDED_INIT_WITH_QUEUE_MODE(anj_time_duration_new(10, ANJ_TIME_UNIT_S));
+    anj.queue_mode_wake_window = anj_time_duration_new(30, ANJ_TIME_UNIT_S);
+    PROCESS_REGISTRATION();
+
+    // next Update is planned in 75 seconds, client goes offline
+    mock_time_advance(anj_time_duration_new(11, ANJ_TIME_UNIT_S));
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_QUEUE_MODE);
+
+    // Update is due in 25 seconds, so it's sent before the Send request
+    mock_time_advance(anj_time_duration_new(39, ANJ_TIME_UNIT_S));
+    anj_io_out_entry_t records[] = { default_record_1, default_record_2 };
+    anj_send_request_t send_req = {
+        .finished_handler = send_finished_handler,
+        .content_format = ANJ_SEND_CONTENT_FORMAT_SENML_CBOR,
+        .records_cnt = ANJ_ARRAY_SIZE(records),
+        .records = records
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_new_request(&anj, &send_req, NULL));
+    mock.bytes_to_send = 500;
+    anj_core_step(&anj);
+    COPY_TOKEN_AND_MSG_ID(update, 8);
+    ANJ_UNIT_ASSERT_EQUAL(sizeof(update) - 1, mock.bytes_sent);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, update,
+                                      mock.bytes_sent);
+    ANJ_UNIT_ASSERT_TRUE(anj_time_monotonic_eq(
+            anj.server_state.details.registered.next_update_time,
+            anj_time_monotonic_add(anj_time_monotonic_now(),
+                                   anj_time_duration_new(75,
+                                                         ANJ_TIME_UNIT_S))));
+    // Send request follows right after the Update
+    mock.bytes_sent = 0;
+    ADD_RESPONSE(update_response);
+    anj_core_step(&anj);
+    COPY_TOKEN_AND_MSG_ID(basic_send, 8);
+    ANJ_UNIT_ASSERT_EQUAL(sizeof(basic_send) - 1, mock.bytes_sent);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, basic_send,
+                                      mock.bytes_sent);
+    ADD_RESPONSE(send_response);
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERED);
+    FINAL_CHECK(1, 0);
+}
+#endif // ANJ_WITH_QUEUE_MODE_WAKE_WINDOW
+
+#ifdef ANJ_LWM2M_SEND_WITH_NO_RESPONSE
+static char no_response_send[] =
+        "\x48"                             // Confirmable, tkl 8
+        "\x02\x00\x00"                     // POST 0x02, msg id
+        "\x00\x00\x00\x00\x00\x00\x00\x00" // token
+        "\xb2\x64\x70"                     // uri path /dp
+        "\x11\x70"                         // content_format: senml-cbor
+        "\xd1\xe9\x02"                     // no-response: 2.xx suppressed
+        "\xFF"
+        "\x82\xa4"                                 // map(4)
+        "\x21\x64/3/0"                             // base path
+        "\x00\x62/9"                               // path
+        "\x22\xfb\x41\xd9\x6a\x56\x4a\x00\x00\x00" // base time
+        "\x02\x18\x2a"                             // value 42
+        "\xa2"                                     // map(2)
+        "\x00\x63/17"                              // path
+        "\x03\x6b"
+        "demo_device"; // string value
+
+static char empty_ack[] = "\x60"          // header v 0x01, Ack, tkl 0
+                          "\x00\x00\x00"; // empty msg, msg id
+
+ANJ_UNIT_TEST(lwm2m_send, no_response_send) {
+    EXTENDED_INIT();
+    PROCESS_REGISTRATION();
+    anj_io_out_entry_t records[] = { default_record_1, default_record_2 };
+    anj_send_request_t send_req = {
+        .finished_handler = send_finished_handler,
+        .content_format = ANJ_SEND_CONTENT_FORMAT_SENML_CBOR,
+        .records_cnt = ANJ_ARRAY_SIZE(records),
+        .records = records,
+        .no_response = true
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_new_request(&anj, &send_req, NULL));
+    mock.bytes_to_send = 500;
+    anj_core_step(&anj);
+    mock.bytes_to_send = 0;
+    COPY_TOKEN_AND_MSG_ID(no_response_send, 8);
+    ANJ_UNIT_ASSERT_EQUAL(sizeof(no_response_send) - 1, mock.bytes_sent);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, no_response_send,
+                                      mock.bytes_sent);
+
+    // empty ACK completes the request, no response is awaited
+    empty_ack[2] = no_response_send[2];
+    empty_ack[3] = no_response_send[3];
+    mock.bytes_to_recv = sizeof(empty_ack) - 1;
+    mock.data_to_recv = (uint8_t *) empty_ack;
+    anj_core_step(&anj);
+    FINAL_CHECK(1, 0);
+}
+#endif // ANJ_LWM2M_SEND_WITH_NO_RESPONSE
+
 #ifdef ANJ_WITH_LWM2M12
 static char lwm2m_cbor_send[] =
         "\x48"                             // Confirmable, tkl 8
@@ -584,7 +904,92 @@ ANJ_UNIT_TEST(lwm2m_send, send_with_lwm2m_cbor_same_path) {
     ANJ_UNIT_ASSERT_EQUAL(anj_send_new_request(&anj, &send_req, NULL),
                           ANJ_SEND_ERR_DATA_NOT_VALID);
 }
-#endif // ANJ_WITH_LWM2M12
+
+#    ifdef ANJ_LWM2M_SEND_WITH_SORTED_RECORDS
+static char lwm2m_cbor_sorted_send[] =
+        "\x48"                             // Confirmable, tkl 8
+        "\x02\x00\x00"                     // POST 0x02, msg id
+        "\x00\x00\x00\x00\x00\x00\x00\x00" // token
+        "\xb2\x64\x70"                     // uri path /dp
+        "\x12\x2D\x18"                     // content_format: lwm2m_cbor 11544
+        "\xFF"
+        "\xBF\x01\xBF\x00\xBF\x01\x05\xFF\xFF" // {1: {0: {1: 5}},
+        "\x03\xBF\x00\xBF\x03\x18\x19"         //  3: {0: {3: 25,
+        "\x09\x07\xFF\xFF\xFF";                // 9: 7}}}
+
+ANJ_UNIT_TEST(lwm2m_send, send_with_sorted_records) {
+    EXTENDED_INIT();
+    PROCESS_REGISTRATION();
+    anj_io_out_entry_t records[] = {
+        {
+            .path = ANJ_MAKE_RESOURCE_PATH(3, 0, 3),
+            .type = ANJ_DATA_TYPE_UINT,
+            .value.uint_value = 25,
+        },
+        {
+            .path = ANJ_MAKE_RESOURCE_PATH(1, 0, 1),
+            .type = ANJ_DATA_TYPE_UINT,
+            .value.uint_value = 5,
+        },
+        {
+            .path = ANJ_MAKE_RESOURCE_PATH(3, 0, 9),
+            .type = ANJ_DATA_TYPE_UINT,
+            .value.uint_value = 7,
+        }
+    };
+    anj_send_request_t send_req = {
+        .finished_handler = send_finished_handler,
+        .content_format = ANJ_SEND_CONTENT_FORMAT_LWM2M_CBOR,
+        .records_cnt = ANJ_ARRAY_SIZE(records),
+        .records = records
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_new_request(&anj, &send_req, NULL));
+    HANDLE_SEND(lwm2m_cbor_sorted_send, send_response);
+    FINAL_CHECK(1, 0);
+    // the array of the application is left as it was
+    ANJ_UNIT_ASSERT_TRUE(anj_uri_path_equal(&records[0].path,
+                                            &ANJ_MAKE_RESOURCE_PATH(3, 0, 3)));
+}
+#    endif // ANJ_LWM2M_SEND_WITH_SORTED_RECORDS
+
+#    ifdef ANJ_WITH_SMALLEST_FORMAT
+ANJ_UNIT_TEST(lwm2m_send, send_with_smallest_format) {
+    EXTENDED_INIT();
+    PROCESS_REGISTRATION();
+    static anj_io_out_entry_t record = {
+        .path = ANJ_MAKE_RESOURCE_PATH(3, 0, 3),
+        .type = ANJ_DATA_TYPE_UINT,
+        .value.uint_value = 25,
+        .timestamp = NAN
+    };
+    anj_send_request_t send_req = {
+        .finished_handler = send_finished_handler,
+        .content_format = ANJ_SEND_CONTENT_FORMAT_SMALLEST,
+        .records_cnt = 1,
+        .records = &record
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_new_request(&anj, &send_req, NULL));
+    HANDLE_SEND(lwm2m_cbor_send, send_response);
+    FINAL_CHECK(1, 0);
+}
+
+ANJ_UNIT_TEST(lwm2m_send, send_with_smallest_format_and_timestamps) {
+    EXTENDED_INIT();
+    PROCESS_REGISTRATION();
+    anj_io_out_entry_t records[] = { default_record_1, default_record_2 };
+    anj_send_request_t send_req = {
+        .finished_handler = send_finished_handler,
+        .content_format = ANJ_SEND_CONTENT_FORMAT_SMALLEST,
+        .records_cnt = ANJ_ARRAY_SIZE(records),
+        .records = records
+    };
+    // LwM2M CBOR can't carry timestamps
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_new_request(&anj, &send_req, NULL));
+    HANDLE_SEND(basic_send, send_response);
+    FINAL_CHECK(1, 0);
+}
+#    endif // ANJ_WITH_SMALLEST_FORMAT
+#endif     // ANJ_WITH_LWM2M12
 
 ANJ_UNIT_TEST(lwm2m_send, abort_ongoing_send) {
     EXTENDED_INIT();
@@ -853,6 +1258,151 @@ ANJ_UNIT_TEST(lwm2m_send, send_with_block_transfer) {
     FINAL_CHECK(1, 0);
 }
 
+#ifdef ANJ_LWM2M_SEND_WITH_TEMPLATES
+static char template_send_block_1[] =
+        "\x48"                             // Confirmable, tkl 8
+        "\x02\x00\x00"                     // POST 0x02, msg id
+        "\x00\x00\x00\x00\x00\x00\x00\x00" // token
+        "\xb2\x64\x70"                     // uri path /dp
+        "\x11\x70"                         // content_format: senml-cbor
+        "\xD1\x02\x0A"                     // block1 0, size 64, more
+        "\xFF"
+        "\x83\xa4"                                 // map(4)
+        "\x21\x65/3303"                            // base path
+        "\x00\x67/0/5700"                          // path
+        "\x22\xfb\x40\x5b\x80\x00\x00\x00\x00\x00" // base time 110.0
+        "\x02\xfb\x40\x36\x40\x00\x00\x00\x00\x00" // value 22.25
+        "\xa2"                                     // map(2)
+        "\x00\x67/0/5701"                          // path
+        "\x02\x1b\x00\x00\x00\x00\x00\x00\x00\x07" // value 7
+        "\xa2"                                     // map(2)
+        "\x00\x67/1/";                             // part of the path
+
+static char template_send_block_2[] =
+        "\x48"                             // Confirmable, tkl 8
+        "\x02\x00\x00"                     // POST 0x02, msg id
+        "\x00\x00\x00\x00\x00\x00\x00\x00" // token
+        "\xb2\x64\x70"                     // uri path /dp
+        "\x11\x70"                         // content_format: senml-cbor
+        "\xD1\x02\x12"                     // block1 1, size 64
+        "\xFF"
+        "5850"      // rest of the path
+        "\x04\xf4"; // value false
+
+ANJ_UNIT_TEST(lwm2m_send, send_with_template) {
+    EXTENDED_INIT();
+    PROCESS_REGISTRATION();
+    anj_io_out_entry_t records[] = {
+        {
+            .path = ANJ_MAKE_RESOURCE_PATH(3303, 0, 5700),
+            .type = ANJ_DATA_TYPE_DOUBLE,
+            .timestamp = 100.0,
+            .value.double_value = 21.5
+        },
+        {
+            .path = ANJ_MAKE_RESOURCE_PATH(3303, 0, 5701),
+            .type = ANJ_DATA_TYPE_INT,
+            .timestamp = NAN,
+            .value.int_value = -5
+        },
+        {
+            .path = ANJ_MAKE_RESOURCE_PATH(3303, 1, 5850),
+            .type = ANJ_DATA_TYPE_BOOL,
+            .timestamp = NAN,
+            .value.bool_value = true
+        }
+    };
+    anj_send_template_t send_template;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_template_init(&send_template, records,
+                                                   ANJ_ARRAY_SIZE(records)));
+
+    // only the values are used, paths come from the template
+    anj_io_out_entry_t values[] = {
+        {
+            .type = ANJ_DATA_TYPE_DOUBLE,
+            .timestamp = 110.0,
+            .value.double_value = 22.25
+        },
+        {
+            .type = ANJ_DATA_TYPE_INT,
+            .timestamp = NAN,
+            .value.int_value = 7
+        },
+        {
+            .type = ANJ_DATA_TYPE_BOOL,
+            .timestamp = NAN,
+            .value.bool_value = false
+        }
+    };
+    anj_send_request_t send_req = {
+        .finished_handler = send_finished_handler,
+        .content_format = ANJ_SEND_CONTENT_FORMAT_SENML_CBOR,
+        .records_cnt = ANJ_ARRAY_SIZE(values),
+        .records = values,
+        .send_template = &send_template
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_new_request(&anj, &send_req, NULL));
+    HANDLE_SEND(template_send_block_1, send_response_block_1);
+    HANDLE_SEND(template_send_block_2, send_response_block_2);
+    FINAL_CHECK(1, 0);
+}
+
+ANJ_UNIT_TEST(lwm2m_send, send_with_template_errors) {
+    EXTENDED_INIT();
+    PROCESS_REGISTRATION();
+    anj_io_out_entry_t records[] = {
+        {
+            .path = ANJ_MAKE_RESOURCE_PATH(3303, 0, 5700),
+            .type = ANJ_DATA_TYPE_DOUBLE,
+            .timestamp = 100.0
+        },
+        {
+            .path = ANJ_MAKE_RESOURCE_PATH(3303, 0, 5701),
+            .type = ANJ_DATA_TYPE_UINT,
+            .timestamp = NAN
+        }
+    };
+    anj_send_template_t send_template;
+    // strings can't be written in place
+    anj_io_out_entry_t string_record = default_record_2;
+    ANJ_UNIT_ASSERT_EQUAL(
+            anj_send_template_init(&send_template, &string_record, 1),
+            ANJ_SEND_ERR_DATA_NOT_VALID);
+    anj_io_out_entry_t instance_record = records[0];
+    instance_record.path = ANJ_MAKE_INSTANCE_PATH(3303, 0);
+    ANJ_UNIT_ASSERT_EQUAL(
+            anj_send_template_init(&send_template, &instance_record, 1),
+            ANJ_SEND_ERR_DATA_NOT_VALID);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_template_init(&send_template, records,
+                                                   ANJ_ARRAY_SIZE(records)));
+
+    anj_send_request_t send_req = {
+        .finished_handler = send_finished_handler,
+        .content_format = ANJ_SEND_CONTENT_FORMAT_SENML_CBOR,
+        .records_cnt = 1,
+        .records = records,
+        .send_template = &send_template
+    };
+    // number of records differs
+    ANJ_UNIT_ASSERT_EQUAL(anj_send_new_request(&anj, &send_req, NULL),
+                          ANJ_SEND_ERR_DATA_NOT_VALID);
+    // type differs
+    anj_io_out_entry_t values[] = { records[0], records[1] };
+    values[1].type = ANJ_DATA_TYPE_INT;
+    send_req.records_cnt = ANJ_ARRAY_SIZE(values);
+    send_req.records = values;
+    ANJ_UNIT_ASSERT_EQUAL(anj_send_new_request(&anj, &send_req, NULL),
+                          ANJ_SEND_ERR_DATA_NOT_VALID);
+    // timestamp missing
+    values[1].type = ANJ_DATA_TYPE_UINT;
+    values[0].timestamp = NAN;
+    ANJ_UNIT_ASSERT_EQUAL(anj_send_new_request(&anj, &send_req, NULL),
+                          ANJ_SEND_ERR_DATA_NOT_VALID);
+    values[0].timestamp = 200.0;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_new_request(&anj, &send_req, NULL));
+}
+#endif // ANJ_LWM2M_SEND_WITH_TEMPLATES
+
 ANJ_UNIT_TEST(lwm2m_send, mute_send_set_meantime) {
     EXTENDED_INIT();
     PROCESS_REGISTRATION();
@@ -933,6 +1483,119 @@ ANJ_UNIT_TEST(lwm2m_send, read_payload_check) {
     }
 }
 
+#ifdef ANJ_LWM2M_SEND_WITH_RECORD_PRODUCER
+static anj_io_out_entry_t producer_records[] = {
+    {
+        .path = ANJ_MAKE_RESOURCE_PATH(3, 0, 9),
+        .type = ANJ_DATA_TYPE_INT,
+        .value.int_value = 42,
+        .timestamp = 1705597224.0
+    },
+    {
+        .path = ANJ_MAKE_RESOURCE_PATH(4, 0, 2),
+        .type = ANJ_DATA_TYPE_STRING,
+        .value.bytes_or_string.data = "demo_device"
+    },
+    {
+        .path = ANJ_MAKE_RESOURCE_PATH(3, 0, 17),
+        .type = ANJ_DATA_TYPE_DOUBLE,
+        .value.double_value = 1.5,
+        .timestamp = 1705597225.0
+    }
+};
+static size_t produced_cnt;
+static size_t producer_fail_index;
+
+static int record_producer(anj_t *anj,
+                           size_t index,
+                           anj_io_out_entry_t *out_record,
+                           void *data) {
+    (void) anj;
+    (void) data;
+    // records are requested in order, each of them once
+    ANJ_UNIT_ASSERT_EQUAL(index, produced_cnt);
+    produced_cnt++;
+    if (index == producer_fail_index) {
+        return -1;
+    }
+    *out_record = producer_records[index];
+    return 0;
+}
+
+// encodes the whole payload of the first queued request with read_payload
+// calls of at most buff_size bytes
+static size_t read_send_payload(anj_t *anj, size_t buff_size, uint8_t *out) {
+    _anj_exchange_handlers_t handlers = { 0 };
+    _anj_coap_msg_t msg;
+    memset(&msg, 0, sizeof(msg));
+    _anj_lwm2m_send_process(anj, &handlers, &msg);
+    ANJ_UNIT_ASSERT_EQUAL(msg.operation, ANJ_OP_INF_CON_SEND);
+    size_t total_len = 0;
+    uint8_t result = _ANJ_EXCHANGE_BLOCK_TRANSFER_NEEDED;
+    while (result == _ANJ_EXCHANGE_BLOCK_TRANSFER_NEEDED) {
+        _anj_exchange_read_result_t params = { 0 };
+        result = handlers.read_payload(handlers.arg, &out[total_len],
+                                       buff_size, &params);
+        total_len += params.payload_len;
+    }
+    ANJ_UNIT_ASSERT_EQUAL(result, 0);
+    handlers.completion(handlers.arg, 0, _ANJ_EXCHANGE_ERROR_TERMINATED);
+    return total_len;
+}
+
+ANJ_UNIT_TEST(lwm2m_send, record_producer_payload) {
+    EXTENDED_INIT();
+    PROCESS_REGISTRATION();
+    // records with no common path, so the payload is the same as if they were
+    // given in an array
+    anj_send_request_t array_req = {
+        .finished_handler = send_finished_handler,
+        .content_format = ANJ_SEND_CONTENT_FORMAT_SENML_CBOR,
+        .records_cnt = ANJ_ARRAY_SIZE(producer_records),
+        .records = producer_records
+    };
+    anj_send_request_t producer_req = {
+        .finished_handler = send_finished_handler,
+        .content_format = ANJ_SEND_CONTENT_FORMAT_SENML_CBOR,
+        .records_cnt = ANJ_ARRAY_SIZE(producer_records),
+        .record_producer = record_producer
+    };
+    producer_fail_index = SIZE_MAX;
+
+    for (size_t buff_size = 5; buff_size < 100; buff_size += 7) {
+        uint8_t expected[100];
+        uint8_t payload[100];
+        ANJ_UNIT_ASSERT_SUCCESS(anj_send_new_request(&anj, &array_req, NULL));
+        size_t expected_len = read_send_payload(&anj, buff_size, expected);
+
+        produced_cnt = 0;
+        ANJ_UNIT_ASSERT_SUCCESS(
+                anj_send_new_request(&anj, &producer_req, NULL));
+        ANJ_UNIT_ASSERT_EQUAL(read_send_payload(&anj, buff_size, payload),
+                              expected_len);
+        ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(payload, expected, expected_len);
+        ANJ_UNIT_ASSERT_EQUAL(produced_cnt, ANJ_ARRAY_SIZE(producer_records));
+    }
+}
+
+ANJ_UNIT_TEST(lwm2m_send, record_producer_error) {
+    EXTENDED_INIT();
+    PROCESS_REGISTRATION();
+    anj_send_request_t send_req = {
+        .finished_handler = send_finished_handler,
+        .content_format = ANJ_SEND_CONTENT_FORMAT_SENML_CBOR,
+        .records_cnt = ANJ_ARRAY_SIZE(producer_records),
+        .record_producer = record_producer
+    };
+    produced_cnt = 0;
+    producer_fail_index = 1;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_new_request(&anj, &send_req, NULL));
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(produced_cnt, 2);
+    FINAL_CHECK(1, ANJ_SEND_ERR_INTERNAL);
+}
+#endif // ANJ_LWM2M_SEND_WITH_RECORD_PRODUCER
+
 static anj_io_out_entry_t common_path_record_1 = {
     .path = ANJ_MAKE_RESOURCE_PATH(3, 0, 0),
     .type = ANJ_DATA_TYPE_INT,
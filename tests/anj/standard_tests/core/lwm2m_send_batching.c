@@ -0,0 +1,358 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/compat/net/anj_net_api.h>
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/dm/core.h>
+#include <anj/dm/security_object.h>
+#include <anj/dm/server_object.h>
+#include <anj/lwm2m_send.h>
+#include <anj/utils.h>
+
+#include "../../../../src/anj/core/lwm2m_send.h"
+#include "../../../../src/anj/exchange.h"
+#include "../mock/net_api_mock.h"
+#include "../mock/time_api_mock.h"
+
+#include <anj_unit_test.h>
+
+#ifdef ANJ_LWM2M_SEND_WITH_BATCHING
+
+#    ifdef ANJ_WITH_MSG_BUFFER_ARENA
+static uint8_t msg_buffer_arena[ANJ_MSG_BUFFER_ARENA_SIZE];
+#        define SET_MSG_BUFFER_ARENA(Config)              \
+            (Config).msg_buffer_arena = msg_buffer_arena; \
+            (Config).msg_buffer_arena_size = sizeof(msg_buffer_arena)
+#    else // ANJ_WITH_MSG_BUFFER_ARENA
+#        define SET_MSG_BUFFER_ARENA(Config) (void) 0
+#    endif // ANJ_WITH_MSG_BUFFER_ARENA
+
+// MTU big enough to send the whole payload buffer in a single message
+#    define TEST_INIT()                                                       \
+        mock_time_reset();                                                    \
+        net_api_mock_t mock = { 0 };                                          \
+        net_api_mock_ctx_init(&mock);                                         \
+        mock.inner_mtu_value = 1500;                                          \
+        anj_t anj;                                                            \
+        anj_configuration_t config = {                                        \
+            .endpoint_name = "name"                                           \
+        };                                                                    \
+        SET_MSG_BUFFER_ARENA(config);                                         \
+        ANJ_UNIT_ASSERT_SUCCESS(anj_core_init(&anj, &config));                \
+        anj_dm_security_obj_t sec_obj;                                        \
+        anj_dm_security_obj_init(&sec_obj);                                   \
+        anj_dm_server_obj_t ser_obj;                                          \
+        anj_dm_server_obj_init(&ser_obj);                                     \
+        const anj_iid_t iid = 1;                                              \
+        anj_dm_security_instance_init_t sec_inst = {                          \
+            .server_uri = "coap://server.com:5683",                           \
+            .ssid = 2,                                                        \
+            .iid = &iid,                                                      \
+            .security_mode = ANJ_DM_SECURITY_NOSEC,                           \
+        };                                                                    \
+        anj_dm_server_instance_init_t ser_inst = {                            \
+            .ssid = 2,                                                        \
+            .lifetime = 150,                                                  \
+            .binding = "U",                                                   \
+            .iid = &iid                                                       \
+        };                                                                    \
+        ANJ_UNIT_ASSERT_SUCCESS(                                              \
+                anj_dm_security_obj_add_instance(&sec_obj, &sec_inst));       \
+        ANJ_UNIT_ASSERT_SUCCESS(anj_dm_security_obj_install(&anj, &sec_obj)); \
+        ANJ_UNIT_ASSERT_SUCCESS(                                              \
+                anj_dm_server_obj_add_instance(&ser_obj, &ser_inst));         \
+        ANJ_UNIT_ASSERT_SUCCESS(anj_dm_server_obj_install(&anj, &ser_obj));   \
+        finished_cnt = 0
+
+#    define COPY_TOKEN_AND_MSG_ID(Msg, Token_size)                          \
+        memcpy(&Msg[4], anj.exchange_ctx.base_msg.token.bytes, Token_size); \
+        Msg[2] = anj.exchange_ctx.base_msg.coap_binding_data.message_id     \
+                 >> 8;                                                      \
+        Msg[3] = anj.exchange_ctx.base_msg.coap_binding_data.message_id     \
+                 & 0xFF
+
+#    define ADD_RESPONSE(Response)                 \
+        COPY_TOKEN_AND_MSG_ID(Response, 8);        \
+        mock.bytes_to_recv = sizeof(Response) - 1; \
+        mock.data_to_recv = (uint8_t *) Response
+
+static char register_response[] =
+        "\x68"                             // header v 0x01, Ack, tkl 8
+        "\x41\x00\x00"                     // CREATED code 2.1
+        "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF" // token
+        "\x82\x72\x64"                     // location-path /rd
+        "\x04\x35\x61\x33\x66";            // location-path 8 /5a3f
+
+static char send_response[] = "\x68"         // header v 0x01, Ack, tkl 8
+                              "\x44\x00\x00" // Changed code 2.04
+                              "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF"; // token
+
+#    define PROCESS_REGISTRATION()                          \
+        mock.bytes_to_send = 500;                           \
+        anj_core_step(&anj);                                \
+        mock.bytes_to_send = 100;                           \
+        ADD_RESPONSE(register_response);                    \
+        anj_core_step(&anj);                                \
+        ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status, \
+                              ANJ_CONN_STATUS_REGISTERED);  \
+        anj_core_step(&anj);                                \
+        mock.bytes_to_send = 0;                             \
+        mock.bytes_sent = 0
+
+// sends a single Send message and completes its exchange, just like in
+// lwm2m_send.c the next message may be already started in the second step
+#    define HANDLE_SEND()                                   \
+        mock.bytes_to_send = 1500;                          \
+        anj_core_step(&anj);                                \
+        ADD_RESPONSE(send_response);                        \
+        mock.bytes_to_send = 0;                             \
+        anj_core_step(&anj);                                \
+        ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status, \
+                              ANJ_CONN_STATUS_REGISTERED)
+
+#    define NOTHING_SENT()             \
+        mock.bytes_sent = 0;           \
+        mock.bytes_to_send = 1500;     \
+        anj_core_step(&anj);           \
+        mock.bytes_to_send = 0;        \
+        ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0)
+
+static size_t finished_cnt;
+static uint16_t finished_ids[ANJ_LWM2M_SEND_QUEUE_SIZE];
+static int finished_results[ANJ_LWM2M_SEND_QUEUE_SIZE];
+
+static void
+send_finished_handler(anj_t *anjay, uint16_t send_id, int result, void *data) {
+    (void) anjay;
+    (void) data;
+    ANJ_UNIT_ASSERT_TRUE(finished_cnt < ANJ_LWM2M_SEND_QUEUE_SIZE);
+    finished_ids[finished_cnt] = send_id;
+    finished_results[finished_cnt] = result;
+    finished_cnt++;
+}
+
+static anj_io_out_entry_t record_1 = {
+    .path = ANJ_MAKE_RESOURCE_PATH(3, 0, 9),
+    .type = ANJ_DATA_TYPE_INT,
+    .value.int_value = 42,
+    .timestamp = 1705597224.0
+};
+
+static anj_io_out_entry_t record_2 = {
+    .path = ANJ_MAKE_RESOURCE_PATH(3, 0, 17),
+    .type = ANJ_DATA_TYPE_STRING,
+    .value.bytes_or_string.data = "demo_device",
+    .timestamp = 1705597224.0
+};
+
+// the same payload as the one of a single request with both records
+static char merged_send[] =
+        "\x48"                             // Confirmable, tkl 8
+        "\x02\x00\x00"                     // POST 0x02, msg id
+        "\x00\x00\x00\x00\x00\x00\x00\x00" // token
+        "\xb2\x64\x70"                     // uri path /dp
+        "\x11\x70"                         // content_format: senml-cbor
+        "\xFF"
+        "\x82\xa4"                                 // array(2), map(4)
+        "\x21\x64/3/0"                             // base path
+        "\x00\x62/9"                               // path
+        "\x22\xfb\x41\xd9\x6a\x56\x4a\x00\x00\x00" // base time
+        "\x02\x18\x2a"                             // value 42
+        "\xa2"                                     // map(2)
+        "\x00\x63/17"                              // path
+        "\x03\x6b"
+        "demo_device"; // string value
+
+#    define SEND_REQUEST(Record)                                   \
+        {                                                          \
+            .finished_handler = send_finished_handler,             \
+            .content_format = ANJ_SEND_CONTENT_FORMAT_SENML_CBOR, \
+            .records_cnt = 1,                                      \
+            .records = &(Record)                                   \
+        }
+
+ANJ_UNIT_TEST(lwm2m_send_batching, requests_merged_after_hold_down) {
+    TEST_INIT();
+    PROCESS_REGISTRATION();
+    anj_send_request_t send_req_1 = SEND_REQUEST(record_1);
+    anj_send_request_t send_req_2 = SEND_REQUEST(record_2);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_new_request(&anj, &send_req_1, NULL));
+    ANJ_UNIT_ASSERT_TRUE(anj_time_monotonic_gt(_anj_lwm2m_send_ready_time(&anj),
+                                               anj_time_monotonic_now()));
+    mock_time_advance(anj_time_duration_new(ANJ_LWM2M_SEND_BATCHING_HOLD_DOWN_MS
+                                                    / 2,
+                                            ANJ_TIME_UNIT_MS));
+    NOTHING_SENT();
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_new_request(&anj, &send_req_2, NULL));
+    NOTHING_SENT();
+
+    // hold-down is counted from the first request
+    mock_time_advance(anj_time_duration_new(ANJ_LWM2M_SEND_BATCHING_HOLD_DOWN_MS
+                                                    / 2,
+                                            ANJ_TIME_UNIT_MS));
+    mock.bytes_to_send = 500;
+    anj_core_step(&anj);
+    COPY_TOKEN_AND_MSG_ID(merged_send, 8);
+    ANJ_UNIT_ASSERT_EQUAL(sizeof(merged_send) - 1, mock.bytes_sent);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, merged_send,
+                                      mock.bytes_sent);
+    ADD_RESPONSE(send_response);
+    mock.bytes_to_send = 0;
+    anj_core_step(&anj);
+
+    ANJ_UNIT_ASSERT_EQUAL(finished_cnt, 2);
+    ANJ_UNIT_ASSERT_EQUAL(finished_ids[0], 1);
+    ANJ_UNIT_ASSERT_EQUAL(finished_ids[1], 2);
+    ANJ_UNIT_ASSERT_EQUAL(finished_results[0], ANJ_SEND_SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(finished_results[1], ANJ_SEND_SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(anj.send_ctx.ids[0], 0);
+    ANJ_UNIT_ASSERT_FALSE(
+            anj_time_monotonic_is_valid(_anj_lwm2m_send_ready_time(&anj)));
+}
+
+ANJ_UNIT_TEST(lwm2m_send_batching, full_queue_skips_hold_down) {
+    TEST_INIT();
+    PROCESS_REGISTRATION();
+    anj_send_request_t send_reqs[ANJ_LWM2M_SEND_QUEUE_SIZE];
+    for (size_t i = 0; i < ANJ_LWM2M_SEND_QUEUE_SIZE; i++) {
+        send_reqs[i] = (anj_send_request_t) SEND_REQUEST(record_1);
+        ANJ_UNIT_ASSERT_SUCCESS(
+                anj_send_new_request(&anj, &send_reqs[i], NULL));
+    }
+    HANDLE_SEND();
+    ANJ_UNIT_ASSERT_EQUAL(finished_cnt, ANJ_LWM2M_SEND_QUEUE_SIZE);
+    for (size_t i = 0; i < ANJ_LWM2M_SEND_QUEUE_SIZE; i++) {
+        ANJ_UNIT_ASSERT_EQUAL(finished_ids[i], i + 1);
+        ANJ_UNIT_ASSERT_EQUAL(finished_results[i], ANJ_SEND_SUCCESS);
+    }
+}
+
+#    define BIG_STRING_SIZE (ANJ_OUT_PAYLOAD_BUFFER_SIZE * 2 / 5)
+
+ANJ_UNIT_TEST(lwm2m_send_batching, payload_size_limits_batch) {
+    TEST_INIT();
+    PROCESS_REGISTRATION();
+    static char big_string[BIG_STRING_SIZE + 1];
+    memset(big_string, 'a', BIG_STRING_SIZE);
+    anj_io_out_entry_t big_record = record_2;
+    big_record.value.bytes_or_string.data = big_string;
+
+    // only two records fit in the payload buffer
+    anj_send_request_t send_reqs[ANJ_LWM2M_SEND_QUEUE_SIZE];
+    for (size_t i = 0; i < ANJ_LWM2M_SEND_QUEUE_SIZE; i++) {
+        send_reqs[i] = (anj_send_request_t) SEND_REQUEST(big_record);
+        ANJ_UNIT_ASSERT_SUCCESS(
+                anj_send_new_request(&anj, &send_reqs[i], NULL));
+    }
+    HANDLE_SEND();
+    ANJ_UNIT_ASSERT_EQUAL(finished_cnt, 2);
+    // the remaining request is no longer in a full queue, so it waits for
+    // its hold-down time to pass
+    NOTHING_SENT();
+    mock_time_advance(anj_time_duration_new(ANJ_LWM2M_SEND_BATCHING_HOLD_DOWN_MS,
+                                            ANJ_TIME_UNIT_MS));
+    HANDLE_SEND();
+    ANJ_UNIT_ASSERT_EQUAL(finished_cnt, 3);
+    ANJ_UNIT_ASSERT_EQUAL(finished_ids[2], 3);
+    ANJ_UNIT_ASSERT_EQUAL(finished_results[2], ANJ_SEND_SUCCESS);
+}
+
+ANJ_UNIT_TEST(lwm2m_send_batching, base_path_change_during_batching) {
+    TEST_INIT();
+    PROCESS_REGISTRATION();
+    static char big_string[BIG_STRING_SIZE + 1];
+    memset(big_string, 'a', BIG_STRING_SIZE);
+    anj_io_out_entry_t big_record = record_2;
+    big_record.value.bytes_or_string.data = big_string;
+    anj_io_out_entry_t other_obj_record = big_record;
+    other_obj_record.path = ANJ_MAKE_RESOURCE_PATH(1, 1, 1);
+
+    // the second request changes the Base Name, so the batch is encoded
+    // again; the third one is appended to it and doesn't fit anymore
+    anj_send_request_t send_req_1 = SEND_REQUEST(big_record);
+    anj_send_request_t send_req_2 = SEND_REQUEST(other_obj_record);
+    anj_send_request_t send_req_3 = SEND_REQUEST(big_record);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_new_request(&anj, &send_req_1, NULL));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_new_request(&anj, &send_req_2, NULL));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_new_request(&anj, &send_req_3, NULL));
+    HANDLE_SEND();
+    ANJ_UNIT_ASSERT_EQUAL(finished_cnt, 2);
+    ANJ_UNIT_ASSERT_EQUAL(finished_ids[0], 1);
+    ANJ_UNIT_ASSERT_EQUAL(finished_ids[1], 2);
+
+    mock_time_advance(anj_time_duration_new(ANJ_LWM2M_SEND_BATCHING_HOLD_DOWN_MS,
+                                            ANJ_TIME_UNIT_MS));
+    HANDLE_SEND();
+    ANJ_UNIT_ASSERT_EQUAL(finished_cnt, 3);
+    ANJ_UNIT_ASSERT_EQUAL(finished_ids[2], 3);
+    ANJ_UNIT_ASSERT_EQUAL(finished_results[2], ANJ_SEND_SUCCESS);
+}
+
+#    ifdef ANJ_WITH_LWM2M_CBOR
+ANJ_UNIT_TEST(lwm2m_send_batching, lwm2m_cbor_request_not_merged) {
+    TEST_INIT();
+    PROCESS_REGISTRATION();
+    anj_send_request_t send_req_1 = SEND_REQUEST(record_1);
+    anj_send_request_t send_req_2 = SEND_REQUEST(record_2);
+    send_req_2.content_format = ANJ_SEND_CONTENT_FORMAT_LWM2M_CBOR;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_new_request(&anj, &send_req_1, NULL));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_new_request(&anj, &send_req_2, NULL));
+
+    // waiting for more requests makes no sense anymore
+    HANDLE_SEND();
+    ANJ_UNIT_ASSERT_EQUAL(finished_cnt, 1);
+    ANJ_UNIT_ASSERT_EQUAL(finished_ids[0], 1);
+    HANDLE_SEND();
+    ANJ_UNIT_ASSERT_EQUAL(finished_cnt, 2);
+    ANJ_UNIT_ASSERT_EQUAL(finished_ids[1], 2);
+    ANJ_UNIT_ASSERT_EQUAL(finished_results[1], ANJ_SEND_SUCCESS);
+}
+#    endif // ANJ_WITH_LWM2M_CBOR
+
+ANJ_UNIT_TEST(lwm2m_send_batching, abort_merged_request) {
+    TEST_INIT();
+    PROCESS_REGISTRATION();
+    anj_send_request_t send_req_1 = SEND_REQUEST(record_1);
+    anj_send_request_t send_req_2 = SEND_REQUEST(record_2);
+    anj_send_request_t send_req_3 = SEND_REQUEST(record_1);
+    uint16_t send_id_2;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_new_request(&anj, &send_req_1, NULL));
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_send_new_request(&anj, &send_req_2, &send_id_2));
+    mock_time_advance(anj_time_duration_new(ANJ_LWM2M_SEND_BATCHING_HOLD_DOWN_MS,
+                                            ANJ_TIME_UNIT_MS));
+    mock.bytes_to_send = 1500;
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_TRUE(_anj_exchange_ongoing_exchange(&anj.exchange_ctx));
+    // request queued during the exchange is not a part of it
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_new_request(&anj, &send_req_3, NULL));
+
+    // aborting one of the merged requests aborts the whole message
+    ANJ_UNIT_ASSERT_SUCCESS(anj_send_abort(&anj, send_id_2));
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(finished_cnt, 2);
+    ANJ_UNIT_ASSERT_EQUAL(finished_results[0], ANJ_SEND_ERR_ABORT);
+    ANJ_UNIT_ASSERT_EQUAL(finished_results[1], ANJ_SEND_ERR_ABORT);
+    ANJ_UNIT_ASSERT_EQUAL(anj.send_ctx.ids[0], 3);
+    ANJ_UNIT_ASSERT_EQUAL(anj.send_ctx.ids[1], 0);
+
+    mock_time_advance(anj_time_duration_new(ANJ_LWM2M_SEND_BATCHING_HOLD_DOWN_MS,
+                                            ANJ_TIME_UNIT_MS));
+    HANDLE_SEND();
+    ANJ_UNIT_ASSERT_EQUAL(finished_cnt, 3);
+    ANJ_UNIT_ASSERT_EQUAL(finished_ids[2], 3);
+    ANJ_UNIT_ASSERT_EQUAL(finished_results[2], ANJ_SEND_SUCCESS);
+}
+
+#endif // ANJ_LWM2M_SEND_WITH_BATCHING
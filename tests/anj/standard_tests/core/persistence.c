@@ -0,0 +1,418 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/core.h>
+#include <anj/dm/core.h>
+#include <anj/persistence.h>
+#include <anj/persistence_slots.h>
+
+#include "../../../../src/anj/dm/dm_io.h"
+
+#include <anj_unit_test.h>
+
+typedef struct {
+    uint8_t data[64];
+    size_t size;
+    size_t writes;
+    size_t last_write_size;
+    bool fail;
+} flash_t;
+
+static int flash_write(void *ctx, const void *buf, size_t size) {
+    flash_t *flash = (flash_t *) ctx;
+    if (flash->fail || flash->size + size > sizeof(flash->data)) {
+        return -1;
+    }
+    memcpy(flash->data + flash->size, buf, size);
+    flash->size += size;
+    flash->writes++;
+    flash->last_write_size = size;
+    return 0;
+}
+
+static int flash_read(void *ctx, void *buf, size_t size) {
+    flash_t *flash = (flash_t *) ctx;
+    if (size > flash->size) {
+        return -1;
+    }
+    memcpy(buf, flash->data, size);
+    memmove(flash->data, flash->data + size, flash->size - size);
+    flash->size -= size;
+    return 0;
+}
+
+static const uint8_t MAGIC[] = { 'T', 'S', 'T' };
+
+static int store_all(const anj_persistence_context_t *ctx,
+                     uint32_t *value_u32,
+                     char *str,
+                     size_t str_size,
+                     bool *value_bool) {
+    return anj_persistence_magic(ctx, MAGIC, sizeof(MAGIC))
+           || anj_persistence_u32(ctx, value_u32)
+           || anj_persistence_string(ctx, str, str_size)
+           || anj_persistence_bool(ctx, value_bool);
+}
+
+ANJ_UNIT_TEST(persistence, version) {
+    flash_t flash = { 0 };
+    anj_persistence_context_t ctx =
+            anj_persistence_store_context_create(flash_write, &flash);
+    uint8_t version = 0;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_persistence_version(&ctx, MAGIC, sizeof(MAGIC), 2, &version));
+    ANJ_UNIT_ASSERT_EQUAL(version, 2);
+    flash_t copy = flash;
+
+    // blob stored by an older version of the code is accepted
+    ctx = anj_persistence_restore_context_create(flash_read, &flash);
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_persistence_version(&ctx, MAGIC, sizeof(MAGIC), 3, &version));
+    ANJ_UNIT_ASSERT_EQUAL(version, 2);
+    // but not one stored by a newer one
+    ctx = anj_persistence_restore_context_create(flash_read, &copy);
+    ANJ_UNIT_ASSERT_FAILED(
+            anj_persistence_version(&ctx, MAGIC, sizeof(MAGIC), 1, NULL));
+}
+
+#ifdef ANJ_PERSISTENCE_WITH_BUFFERED_STORE
+
+#    define PAGE_SIZE 8
+
+ANJ_UNIT_TEST(persistence, buffered_store_writes_full_pages) {
+    flash_t flash = { 0 };
+    uint8_t page[PAGE_SIZE];
+    anj_persistence_buffer_t buffer_ctx;
+    anj_persistence_context_t ctx =
+            anj_persistence_buffered_store_context_create(
+                    &buffer_ctx, page, sizeof(page), flash_write, &flash);
+
+    uint32_t value_u32 = 0x12345678;
+    char str[16] = "anjay lite";
+    bool value_bool = true;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            store_all(&ctx, &value_u32, str, sizeof(str), &value_bool));
+    // magic, u32, u64 length + 10 characters, bool
+    const size_t expected_size = 3 + 4 + 8 + 10 + 1;
+    ANJ_UNIT_ASSERT_EQUAL(flash.writes, expected_size / PAGE_SIZE);
+    ANJ_UNIT_ASSERT_EQUAL(flash.last_write_size, PAGE_SIZE);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_persistence_buffer_flush(&buffer_ctx));
+    ANJ_UNIT_ASSERT_EQUAL(flash.writes, expected_size / PAGE_SIZE + 1);
+    ANJ_UNIT_ASSERT_EQUAL(flash.last_write_size, expected_size % PAGE_SIZE);
+    ANJ_UNIT_ASSERT_EQUAL(flash.size, expected_size);
+    // nothing left to write
+    ANJ_UNIT_ASSERT_SUCCESS(anj_persistence_buffer_flush(&buffer_ctx));
+    ANJ_UNIT_ASSERT_EQUAL(flash.writes, expected_size / PAGE_SIZE + 1);
+
+    // the blob is the same as written without buffering
+    ctx = anj_persistence_restore_context_create(flash_read, &flash);
+    uint32_t restored_u32 = 0;
+    char restored_str[16] = "";
+    bool restored_bool = false;
+    ANJ_UNIT_ASSERT_SUCCESS(store_all(&ctx, &restored_u32, restored_str,
+                                      sizeof(restored_str), &restored_bool));
+    ANJ_UNIT_ASSERT_EQUAL(restored_u32, value_u32);
+    ANJ_UNIT_ASSERT_EQUAL_STRING(restored_str, str);
+    ANJ_UNIT_ASSERT_TRUE(restored_bool);
+    ANJ_UNIT_ASSERT_EQUAL(flash.size, 0);
+}
+
+ANJ_UNIT_TEST(persistence, buffered_store_write_error) {
+    flash_t flash = { 0 };
+    uint8_t page[PAGE_SIZE];
+    anj_persistence_buffer_t buffer_ctx;
+    anj_persistence_context_t ctx =
+            anj_persistence_buffered_store_context_create(
+                    &buffer_ctx, page, sizeof(page), flash_write, &flash);
+
+    uint64_t value = 0;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_persistence_u32(&ctx, &(uint32_t) { 0 }));
+    flash.fail = true;
+    ANJ_UNIT_ASSERT_FAILED(anj_persistence_u64(&ctx, &value));
+    flash.fail = false;
+    ANJ_UNIT_ASSERT_EQUAL(flash.writes, 0);
+}
+
+ANJ_UNIT_TEST(persistence, size_only_context) {
+    size_t size = 0;
+    anj_persistence_context_t ctx = anj_persistence_size_context_create(&size);
+
+    uint32_t value_u32 = 1;
+    char str[16] = "anjay lite";
+    bool value_bool = false;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            store_all(&ctx, &value_u32, str, sizeof(str), &value_bool));
+    ANJ_UNIT_ASSERT_EQUAL(size, 3 + 4 + 8 + 10 + 1);
+
+    // the computed size matches the size of the actual blob
+    flash_t flash = { 0 };
+    ctx = anj_persistence_store_context_create(flash_write, &flash);
+    ANJ_UNIT_ASSERT_SUCCESS(
+            store_all(&ctx, &value_u32, str, sizeof(str), &value_bool));
+    ANJ_UNIT_ASSERT_EQUAL(flash.size, size);
+}
+
+#endif // ANJ_PERSISTENCE_WITH_BUFFERED_STORE
+
+#ifdef ANJ_PERSISTENCE_WITH_INTEGRITY_CHECK
+ANJ_UNIT_TEST(persistence, crc) {
+    flash_t flash = { 0 };
+    anj_persistence_crc_t crc_ctx;
+    anj_persistence_context_t ctx =
+            anj_persistence_crc_store_context_create(&crc_ctx, flash_write,
+                                                     &flash);
+    uint32_t value_u32 = 0x12345678;
+    char str[16] = "anjay lite";
+    bool value_bool = true;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            store_all(&ctx, &value_u32, str, sizeof(str), &value_bool));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_persistence_crc_finish(&crc_ctx));
+    const size_t blob_size = 3 + 4 + 8 + 10 + 1 + ANJ_PERSISTENCE_CRC_SIZE;
+    ANJ_UNIT_ASSERT_EQUAL(flash.size, blob_size);
+
+    flash_t copy = flash;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_persistence_crc_verify(flash_read, &copy, blob_size));
+    ANJ_UNIT_ASSERT_EQUAL(copy.size, 0);
+
+    ctx = anj_persistence_crc_restore_context_create(&crc_ctx, flash_read,
+                                                     &flash);
+    uint32_t restored_u32 = 0;
+    char restored_str[16] = "";
+    bool restored_bool = false;
+    ANJ_UNIT_ASSERT_SUCCESS(store_all(&ctx, &restored_u32, restored_str,
+                                      sizeof(restored_str), &restored_bool));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_persistence_crc_finish(&crc_ctx));
+    ANJ_UNIT_ASSERT_EQUAL(restored_u32, value_u32);
+    ANJ_UNIT_ASSERT_EQUAL_STRING(restored_str, str);
+    ANJ_UNIT_ASSERT_EQUAL(flash.size, 0);
+}
+
+ANJ_UNIT_TEST(persistence, crc_mismatch) {
+    flash_t flash = { 0 };
+    anj_persistence_crc_t crc_ctx;
+    anj_persistence_context_t ctx =
+            anj_persistence_crc_store_context_create(&crc_ctx, flash_write,
+                                                     &flash);
+    uint32_t value_u32 = 0x12345678;
+    char str[16] = "anjay lite";
+    bool value_bool = true;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            store_all(&ctx, &value_u32, str, sizeof(str), &value_bool));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_persistence_crc_finish(&crc_ctx));
+    const size_t blob_size = flash.size;
+
+    // flipped bit in the string, which still parses correctly
+    flash.data[3 + 4 + 8] ^= 0x01;
+    flash_t copy = flash;
+    ANJ_UNIT_ASSERT_FAILED(
+            anj_persistence_crc_verify(flash_read, &copy, blob_size));
+    ANJ_UNIT_ASSERT_FAILED(
+            anj_persistence_crc_verify(flash_read, &flash, 2));
+
+    ctx = anj_persistence_crc_restore_context_create(&crc_ctx, flash_read,
+                                                     &flash);
+    ANJ_UNIT_ASSERT_SUCCESS(
+            store_all(&ctx, &value_u32, str, sizeof(str), &value_bool));
+    ANJ_UNIT_ASSERT_FAILED(anj_persistence_crc_finish(&crc_ctx));
+}
+#endif // ANJ_PERSISTENCE_WITH_INTEGRITY_CHECK
+
+#ifdef ANJ_PERSISTENCE_WITH_MEMORY_MAPPED_RESTORE
+ANJ_UNIT_TEST(persistence, memory_mapped_restore) {
+    flash_t flash = { 0 };
+    anj_persistence_context_t ctx =
+            anj_persistence_store_context_create(flash_write, &flash);
+    uint32_t value_u32 = 0x12345678;
+    char str[16] = "anjay lite";
+    bool value_bool = true;
+    const void *cert = "certificate";
+    ANJ_UNIT_ASSERT_SUCCESS(
+            store_all(&ctx, &value_u32, str, sizeof(str), &value_bool));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_persistence_bytes_ref(&ctx, &cert, 11));
+    ANJ_UNIT_ASSERT_FALSE(anj_persistence_memory_mapped(&ctx));
+
+    anj_persistence_memory_t memory_ctx;
+    ctx = anj_persistence_memory_restore_context_create(&memory_ctx,
+                                                        flash.data, flash.size);
+    ANJ_UNIT_ASSERT_TRUE(anj_persistence_memory_mapped(&ctx));
+    uint32_t restored_u32 = 0;
+    char restored_str[16] = "";
+    bool restored_bool = false;
+    ANJ_UNIT_ASSERT_SUCCESS(store_all(&ctx, &restored_u32, restored_str,
+                                      sizeof(restored_str), &restored_bool));
+    ANJ_UNIT_ASSERT_EQUAL(restored_u32, value_u32);
+    ANJ_UNIT_ASSERT_EQUAL_STRING(restored_str, str);
+    ANJ_UNIT_ASSERT_TRUE(restored_bool);
+
+    // referenced in place, not copied
+    const void *restored_cert = NULL;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_persistence_bytes_ref(&ctx, &restored_cert, 11));
+    ANJ_UNIT_ASSERT_TRUE(restored_cert == &flash.data[flash.size - 11]);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(restored_cert, "certificate", 11);
+
+    // nothing left in the blob
+    ANJ_UNIT_ASSERT_FAILED(anj_persistence_bytes_ref(&ctx, &restored_cert, 1));
+    ANJ_UNIT_ASSERT_FAILED(anj_persistence_u8(&ctx, &(uint8_t) { 0 }));
+}
+
+ANJ_UNIT_TEST(persistence, bytes_ref_requires_memory_mapped_context) {
+    flash_t flash = { 0 };
+    anj_persistence_context_t ctx =
+            anj_persistence_store_context_create(flash_write, &flash);
+    const void *data = "data";
+    ANJ_UNIT_ASSERT_SUCCESS(anj_persistence_bytes_ref(&ctx, &data, 4));
+
+    ctx = anj_persistence_restore_context_create(flash_read, &flash);
+    ANJ_UNIT_ASSERT_FALSE(anj_persistence_memory_mapped(&ctx));
+    ANJ_UNIT_ASSERT_FAILED(anj_persistence_bytes_ref(&ctx, &data, 4));
+}
+#endif // ANJ_PERSISTENCE_WITH_MEMORY_MAPPED_RESTORE
+
+#if defined(ANJ_PERSISTENCE_WITH_DIRTY_TRACKING) \
+        && defined(ANJ_WITH_DEFAULT_SERVER_OBJ)
+
+typedef struct {
+    uint8_t areas[ANJ_PERSISTENCE_SLOT_COUNT][2][128];
+    uint8_t current[ANJ_PERSISTENCE_SLOT_COUNT];
+    anj_persistence_slot_t slot;
+    size_t offset;
+    size_t expected_size;
+    size_t records;
+} slots_mock_t;
+
+static uint8_t *writing_area(slots_mock_t *mock) {
+    // the older area is overwritten, the current one stays intact
+    return mock->areas[mock->slot][1 - mock->current[mock->slot]];
+}
+
+static int slot_begin(void *ctx, anj_persistence_slot_t slot, size_t size) {
+    slots_mock_t *mock = (slots_mock_t *) ctx;
+    mock->slot = slot;
+    mock->offset = 0;
+    mock->expected_size = size;
+    memset(writing_area(mock), 0xFF, sizeof(mock->areas[0][0]));
+    return 0;
+}
+
+static int slot_write(void *ctx, const void *buf, size_t size) {
+    slots_mock_t *mock = (slots_mock_t *) ctx;
+    if (mock->offset + size > sizeof(mock->areas[0][0])) {
+        return -1;
+    }
+    memcpy(writing_area(mock) + mock->offset, buf, size);
+    mock->offset += size;
+    return 0;
+}
+
+static int slot_end(void *ctx, anj_persistence_slot_t slot) {
+    slots_mock_t *mock = (slots_mock_t *) ctx;
+    ANJ_UNIT_ASSERT_EQUAL(mock->offset, mock->expected_size);
+    mock->current[slot] = (uint8_t) (1 - mock->current[slot]);
+    mock->records++;
+    return 0;
+}
+
+static void write_lifetime(anj_t *anj, int64_t lifetime) {
+    anj_uri_path_t path = ANJ_MAKE_RESOURCE_PATH(ANJ_OBJ_ID_SERVER, 0, 1);
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_operation_begin(
+            anj, ANJ_OP_DM_WRITE_PARTIAL_UPDATE, false, &path));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_write_entry(
+            anj,
+            &(anj_io_out_entry_t) {
+                .type = ANJ_DATA_TYPE_INT,
+                .value.int_value = lifetime,
+                .path = path
+            }));
+    _anj_dm_operation_end(anj, ANJ_DM_TRANSACTION_SUCCESS);
+}
+
+ANJ_UNIT_TEST(persistence, store_dirty) {
+    anj_t anj = { 0 };
+    _anj_dm_initialize(&anj);
+    anj_dm_server_obj_t server_obj;
+    anj_dm_server_obj_init(&server_obj);
+    anj_dm_server_instance_init_t inst = {
+        .ssid = 1,
+        .lifetime = 100,
+        .binding = "U",
+        .iid = &(anj_iid_t) { 0 }
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_server_obj_add_instance(&server_obj, &inst));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_server_obj_install(&anj, &server_obj));
+
+    slots_mock_t mock = { 0 };
+    anj_persistence_slots_t slots = {
+        .begin = slot_begin,
+        .write = slot_write,
+        .end = slot_end,
+        .ctx = &mock
+    };
+    anj_persistence_objects_t objects = { 0 };
+    objects.server_obj = &server_obj;
+    uint32_t sequence = 7;
+
+    // never stored before
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_persistence_store_dirty(&anj, &objects, &slots, &sequence));
+    ANJ_UNIT_ASSERT_EQUAL(mock.records, 1);
+    ANJ_UNIT_ASSERT_EQUAL(sequence, 8);
+    // nothing changed
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_persistence_store_dirty(&anj, &objects, &slots, &sequence));
+    ANJ_UNIT_ASSERT_EQUAL(mock.records, 1);
+
+    write_lifetime(&anj, 200);
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_persistence_store_dirty(&anj, &objects, &slots, &sequence));
+    ANJ_UNIT_ASSERT_EQUAL(mock.records, 2);
+    ANJ_UNIT_ASSERT_EQUAL(sequence, 9);
+
+    // both copies are valid, the newer one has the higher sequence number
+    uint8_t *areas[2] = { mock.areas[ANJ_PERSISTENCE_SLOT_SERVER_OBJ][0],
+                          mock.areas[ANJ_PERSISTENCE_SLOT_SERVER_OBJ][1] };
+    anj_persistence_slot_t slot;
+    uint32_t record_sequence[2];
+    for (int i = 0; i < 2; i++) {
+        ANJ_UNIT_ASSERT_SUCCESS(anj_persistence_record_verify(
+                areas[i], sizeof(mock.areas[0][0]), &slot,
+                &record_sequence[i]));
+        ANJ_UNIT_ASSERT_EQUAL(slot, ANJ_PERSISTENCE_SLOT_SERVER_OBJ);
+    }
+    // the first record went to the area not marked as the current one
+    ANJ_UNIT_ASSERT_EQUAL(record_sequence[1], 7);
+    ANJ_UNIT_ASSERT_EQUAL(record_sequence[0], 8);
+
+    anj_t anj_restored = { 0 };
+    _anj_dm_initialize(&anj_restored);
+    anj_dm_server_obj_t restored;
+    anj_dm_server_obj_init(&restored);
+    objects.server_obj = &restored;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_persistence_record_restore(
+            &anj_restored, &objects, areas[0], sizeof(mock.areas[0][0])));
+    ANJ_UNIT_ASSERT_EQUAL(restored.server_instance.lifetime, 200);
+    ANJ_UNIT_ASSERT_FALSE(restored.dirty);
+
+    // a torn or damaged record is rejected
+    areas[0][ANJ_PERSISTENCE_RECORD_OVERHEAD] ^= 0x01;
+    ANJ_UNIT_ASSERT_FAILED(anj_persistence_record_verify(
+            areas[0], sizeof(mock.areas[0][0]), &slot, &record_sequence[0]));
+    ANJ_UNIT_ASSERT_FAILED(anj_persistence_record_verify(
+            areas[1], ANJ_PERSISTENCE_RECORD_OVERHEAD, &slot,
+            &record_sequence[1]));
+}
+
+#endif // defined(ANJ_PERSISTENCE_WITH_DIRTY_TRACKING) &&
+       // defined(ANJ_WITH_DEFAULT_SERVER_OBJ)
@@ -352,8 +352,8 @@ ANJ_UNIT_TEST(register, update_with_data_model_payload) {
 
     TEST_INIT(anj, exchange_ctx);
 
-    anj.register_ctx.location_path[0][0] = 'd';
-    anj.register_ctx.location_path_len[0] = 1;
+    anj.state_ctx.register_ctx.location_path[0][0] = 'd';
+    anj.state_ctx.register_ctx.location_path_len[0] = 1;
     _anj_register_update(&anj, NULL, true, &msg, &exchange_handlers);
     ASSERT_EQ(_anj_register_operation_status(&anj),
               _ANJ_REGISTER_OPERATION_IN_PROGRESS);
@@ -390,8 +390,8 @@ ANJ_UNIT_TEST(register, update_with_lifetime) {
 
     TEST_INIT(anj, exchange_ctx);
 
-    anj.register_ctx.location_path[0][0] = 'd';
-    anj.register_ctx.location_path_len[0] = 1;
+    anj.state_ctx.register_ctx.location_path[0][0] = 'd';
+    anj.state_ctx.register_ctx.location_path_len[0] = 1;
 
     anj_time_duration_t lifetime = anj_time_duration_new(2, ANJ_TIME_UNIT_S);
     _anj_register_update(&anj, &lifetime, false, &msg, &exchange_handlers);
@@ -417,3 +417,22 @@ ANJ_UNIT_TEST(register, update_with_lifetime) {
     ASSERT_EQ(_anj_register_operation_status(&anj),
               _ANJ_REGISTER_OPERATION_FINISHED);
 }
+
+#if defined(ANJ_COAP_WITH_HEADER_COMPRESSION) && defined(ANJ_WITH_BOOTSTRAP)
+ANJ_UNIT_TEST(register, no_location_path_during_bootstrap) {
+    _anj_exchange_ctx_t exchange_ctx;
+    TEST_INIT(anj, exchange_ctx);
+    anj.state_ctx.register_ctx.location_path[0][0] = 'd';
+    anj.state_ctx.register_ctx.location_path_len[0] = 1;
+
+    _anj_location_path_t location_path;
+    _anj_register_get_location_path(&anj, &location_path);
+    ASSERT_EQ(location_path.location_count, 1);
+
+    // the same memory is used by the Bootstrap context
+    anj.server_state.conn_status = ANJ_CONN_STATUS_BOOTSTRAPPING;
+    _anj_register_get_location_path(&anj, &location_path);
+    ASSERT_EQ(location_path.location_count, 0);
+}
+#endif // defined(ANJ_COAP_WITH_HEADER_COMPRESSION) &&
+       // defined(ANJ_WITH_BOOTSTRAP)
@@ -12,16 +12,25 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <unistd.h>
+
 #include <anj/compat/net/anj_net_api.h>
+#include <anj/client_group.h>
 #include <anj/compat/time.h>
 #include <anj/core.h>
 #include <anj/defs.h>
 #include <anj/dm/core.h>
 #include <anj/dm/device_object.h>
+#include <anj/dm/metrics_object.h>
 #include <anj/dm/security_object.h>
 #include <anj/dm/server_object.h>
+#include <anj/ntp.h>
+#include <anj/scheduler.h>
 #include <anj/utils.h>
 
+#include "../../../../src/anj/coap/coap.h"
+#include "../../../../src/anj/core/dm_change_queue.h"
+#include "../../../../src/anj/dm/dm_io.h"
 #include "../../../../src/anj/exchange.h"
 #include "../mock/net_api_mock.h"
 #include "../mock/time_api_mock.h"
@@ -36,6 +45,26 @@ conn_status_cb(void *arg, anj_t *anj, anj_conn_status_t conn_status) {
     g_conn_status = conn_status;
 }
 
+#ifdef ANJ_WITH_MSG_BUFFER_POOL
+static uint8_t msg_buffer_arena[ANJ_MSG_BUFFER_ARENA_SIZE];
+static uint8_t msg_buffer_pool_memory[ANJ_MSG_BUFFER_POOL_SIZE(1, 1)];
+static anj_msg_buffer_pool_t msg_buffer_pool;
+#    define SET_MSG_BUFFER_ARENA(Config)                           \
+        (Config).msg_buffer_arena = msg_buffer_arena;              \
+        (Config).msg_buffer_arena_size = sizeof(msg_buffer_arena); \
+        ANJ_UNIT_ASSERT_SUCCESS(anj_msg_buffer_pool_init(          \
+                &msg_buffer_pool, msg_buffer_pool_memory,          \
+                sizeof(msg_buffer_pool_memory), 1, 1));            \
+        (Config).msg_buffer_pool = &msg_buffer_pool
+#elif defined(ANJ_WITH_MSG_BUFFER_ARENA)
+static uint8_t msg_buffer_arena[ANJ_MSG_BUFFER_ARENA_SIZE];
+#    define SET_MSG_BUFFER_ARENA(Config)              \
+        (Config).msg_buffer_arena = msg_buffer_arena; \
+        (Config).msg_buffer_arena_size = sizeof(msg_buffer_arena)
+#else // ANJ_WITH_MSG_BUFFER_ARENA
+#    define SET_MSG_BUFFER_ARENA(Config) (void) 0
+#endif // ANJ_WITH_MSG_BUFFER_ARENA
+
 // inner_mtu_value value will lead to block transfer for addtional objects in
 // payload
 #define _TEST_INIT(With_queue_mode, Queue_timeout)         \
@@ -51,6 +80,7 @@ conn_status_cb(void *arg, anj_t *anj, anj_conn_status_t conn_status) {
         .queue_mode_timeout = Queue_timeout,               \
         .connection_status_cb = conn_status_cb,            \
     };                                                     \
+    SET_MSG_BUFFER_ARENA(config);                          \
     ANJ_UNIT_ASSERT_SUCCESS(anj_core_init(&anj, &config)); \
     anj_dm_security_obj_t sec_obj;                         \
     anj_dm_security_obj_init(&sec_obj);                    \
@@ -211,6 +241,25 @@ ANJ_UNIT_TEST(registration_session, lifetime_check) {
     HANDLE_UPDATE(update);
 }
 
+ANJ_UNIT_TEST(registration_session, lifetime_check_batch) {
+    EXTENDED_INIT();
+    PROCESS_REGISTRATION();
+
+    // lifetime changed together with other resource - update should be sent
+    ser_obj.server_instance.lifetime = 100;
+    const anj_uri_path_t paths[] = { ANJ_MAKE_RESOURCE_PATH(3, 0, 1),
+                                     ANJ_MAKE_RESOURCE_PATH(1, 1, 1) };
+    anj_core_data_model_changed_batch(&anj, paths, ANJ_ARRAY_SIZE(paths),
+                                      ANJ_CORE_CHANGE_TYPE_VALUE_CHANGED);
+    HANDLE_UPDATE(update_with_lifetime);
+
+    // empty batch changes nothing
+    anj_core_data_model_changed_batch(&anj, NULL, 0,
+                                      ANJ_CORE_CHANGE_TYPE_VALUE_CHANGED);
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+}
+
 ANJ_UNIT_TEST(registration_session, infinite_lifetime) {
     EXTENDED_INIT();
     ser_obj.server_instance.lifetime = 0;
@@ -230,6 +279,43 @@ ANJ_UNIT_TEST(registration_session, infinite_lifetime) {
     HANDLE_UPDATE(update);
 }
 
+#ifdef ANJ_WITH_SERVER_DATA_CACHE
+ANJ_UNIT_TEST(registration_session, server_resources_cached) {
+    EXTENDED_INIT();
+    PROCESS_REGISTRATION();
+    ANJ_UNIT_ASSERT_TRUE(anj.server_instance.dm_data_cached);
+    ANJ_UNIT_ASSERT_TRUE(anj.server_instance.reg_resources_cached);
+
+    mock_time_advance(anj_time_duration_new(76, ANJ_TIME_UNIT_S));
+    HANDLE_UPDATE(update);
+    ANJ_UNIT_ASSERT_TRUE(anj.server_instance.reg_resources_cached);
+
+    // changes of other Objects keep the cache
+    anj_core_data_model_changed(&anj,
+                                &ANJ_MAKE_RESOURCE_PATH(3, 0, 1),
+                                ANJ_CORE_CHANGE_TYPE_VALUE_CHANGED);
+    ANJ_UNIT_ASSERT_TRUE(anj.server_instance.dm_data_cached);
+    ANJ_UNIT_ASSERT_TRUE(anj.server_instance.reg_resources_cached);
+
+    // reported change is read again and sent in the Update
+    ser_obj.server_instance.lifetime = 100;
+    anj_core_data_model_changed(&anj,
+                                &ANJ_MAKE_RESOURCE_PATH(1, 1, 1),
+                                ANJ_CORE_CHANGE_TYPE_VALUE_CHANGED);
+    HANDLE_UPDATE(update_with_lifetime);
+    ANJ_UNIT_ASSERT_TRUE(anj.server_instance.reg_resources_cached);
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(
+            anj.server_instance.lifetime,
+            anj_time_duration_new(100, ANJ_TIME_UNIT_S)));
+
+    anj_core_data_model_changed(&anj,
+                                &ANJ_MAKE_RESOURCE_PATH(0, 1, 0),
+                                ANJ_CORE_CHANGE_TYPE_VALUE_CHANGED);
+    ANJ_UNIT_ASSERT_FALSE(anj.server_instance.dm_data_cached);
+    ANJ_UNIT_ASSERT_FALSE(anj.server_instance.reg_resources_cached);
+}
+#endif // ANJ_WITH_SERVER_DATA_CACHE
+
 ANJ_UNIT_TEST(registration_session, update_trigger) {
     EXTENDED_INIT();
     PROCESS_REGISTRATION();
@@ -265,8 +351,57 @@ ANJ_UNIT_TEST(registration_session, update_with_data_model) {
 
     anj_core_data_model_changed(&anj, &ANJ_MAKE_INSTANCE_PATH(1, 3),
                                 ANJ_CORE_CHANGE_TYPE_ADDED);
+#ifdef ANJ_DM_WITH_LINK_SET_HASH
+    // Instance /1/3 is not really present in the data model, so the Object
+    // list is the same as in the last Register
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+#else  // ANJ_DM_WITH_LINK_SET_HASH
     HANDLE_UPDATE(update_with_data_model);
+#endif // ANJ_DM_WITH_LINK_SET_HASH
+}
+
+#ifdef ANJ_DM_WITH_LINK_SET_HASH
+static char update_with_new_object[] =
+        "\x48"                             // Confirmable, tkl 8
+        "\x02\x00\x00"                     // POST, msg_id
+        "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF" // token
+        "\xb2\x72\x64"                     // uri path /rd
+        "\x04\x35\x61\x33\x66"             // uri path /5a3f
+        "\x11\x28" // content_format: application/link-format
+        "\xFF"
+        "</1>;ver=1.2,</1/1>,</9900>";
+
+ANJ_UNIT_TEST(registration_session, update_only_if_link_set_changed) {
+    EXTENDED_INIT();
+    PROCESS_REGISTRATION();
+
+    uint32_t registered_hash = _anj_dm_link_set_hash(&anj);
+    anj_dm_obj_t obj = {
+        .oid = 9900
+    };
+    // Object added and removed again before the next step
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_add_obj(&anj, &obj));
+    ANJ_UNIT_ASSERT_NOT_EQUAL(_anj_dm_link_set_hash(&anj), registered_hash);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_remove_obj(&anj, obj.oid));
+    ANJ_UNIT_ASSERT_EQUAL(_anj_dm_link_set_hash(&anj), registered_hash);
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_add_obj(&anj, &obj));
+    HANDLE_UPDATE(update_with_new_object);
+
+    // the same structure is reported again, nothing to send
+    anj_core_data_model_changed(&anj, &ANJ_MAKE_OBJECT_PATH(9900),
+                                ANJ_CORE_CHANGE_TYPE_ADDED);
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+
+    // regular Update still goes out, without the Object list
+    mock_time_advance(anj_time_duration_new(76, ANJ_TIME_UNIT_S));
+    HANDLE_UPDATE(update);
 }
+#endif // ANJ_DM_WITH_LINK_SET_HASH
 
 static char update_with_data_model_block_1[] =
         "\x48"                             // Confirmable, tkl 8
@@ -584,13 +719,293 @@ ANJ_UNIT_TEST(registration_session, server_requests_error_handling) {
     ANJ_UNIT_ASSERT_TRUE(_anj_exchange_ongoing_exchange(&anj.exchange_ctx));
     mock_time_advance(anj_time_duration_new(5, ANJ_TIME_UNIT_S));
     anj_core_step(&anj);
+#ifdef ANJ_WITH_NAT_REBINDING_RECOVERY
+    // connection is set up again and Update is sent instead of Register
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERED);
+#else  // ANJ_WITH_NAT_REBINDING_RECOVERY
     ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
                           ANJ_CONN_STATUS_REGISTERING);
+#endif // ANJ_WITH_NAT_REBINDING_RECOVERY
     mock.bytes_to_send = 100;
 
     read_request[2] = 0x45;
 }
 
+#ifdef ANJ_WITH_METRICS
+ANJ_UNIT_TEST(registration_session, metrics) {
+    EXTENDED_INIT();
+    PROCESS_REGISTRATION();
+
+    anj_metrics_t metrics;
+    anj_core_metrics_get(&anj, &metrics);
+    ANJ_UNIT_ASSERT_EQUAL(metrics.exchanges, 1);
+    ANJ_UNIT_ASSERT_EQUAL(metrics.retransmissions, 0);
+    ANJ_UNIT_ASSERT_EQUAL(metrics.bytes_received,
+                          sizeof(register_response) - 1);
+    ANJ_UNIT_ASSERT_TRUE(metrics.bytes_sent > 0);
+    uint64_t bytes_sent = metrics.bytes_sent;
+
+    // read request and its duplicate
+    ADD_REQUEST(read_request);
+    anj_core_step(&anj);
+    CHECK_RESPONSE(read_response);
+    mock.bytes_sent = 0;
+    ADD_REQUEST(read_request);
+    anj_core_step(&anj);
+    CHECK_RESPONSE(read_response);
+    mock.bytes_sent = 0;
+    anj_core_metrics_get(&anj, &metrics);
+    ANJ_UNIT_ASSERT_EQUAL(metrics.exchanges, 2);
+#    ifdef ANJ_WITH_CACHE
+    ANJ_UNIT_ASSERT_EQUAL(metrics.cache_hits, 1);
+#    endif // ANJ_WITH_CACHE
+    ANJ_UNIT_ASSERT_EQUAL(metrics.bytes_received,
+                          sizeof(register_response) - 1
+                                  + 2 * (sizeof(read_request) - 1));
+    ANJ_UNIT_ASSERT_EQUAL(metrics.bytes_sent,
+                          bytes_sent + 2 * (sizeof(read_response) - 1));
+
+    // Update retransmitted once
+    anj_core_server_obj_registration_update_trigger_executed(&anj);
+    anj_core_step(&anj);
+    mock.bytes_sent = 0;
+    mock_time_advance(anj_time_duration_new(12, ANJ_TIME_UNIT_S));
+    anj_core_step(&anj);
+    COPY_TOKEN_AND_MSG_ID(update, 8);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, update,
+                                      mock.bytes_sent);
+    ADD_RESPONSE(update_response);
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERED);
+
+    anj_core_metrics_get(&anj, &metrics);
+    ANJ_UNIT_ASSERT_EQUAL(metrics.retransmissions, 1);
+    ANJ_UNIT_ASSERT_EQUAL(metrics.exchanges, 3);
+    ANJ_UNIT_ASSERT_EQUAL(metrics.blocks_transferred, 0);
+    ANJ_UNIT_ASSERT_EQUAL(metrics.dtls_handshakes, 0);
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(metrics.exchange_time_min,
+                                              ANJ_TIME_DURATION_ZERO));
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(
+            metrics.exchange_time_max,
+            anj_time_duration_new(12, ANJ_TIME_UNIT_S)));
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(
+            metrics.exchange_time_total,
+            anj_time_duration_new(12, ANJ_TIME_UNIT_S)));
+
+#    ifdef ANJ_WITH_DEFAULT_METRICS_OBJ
+    anj_dm_metrics_obj_t metrics_obj;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_metrics_obj_install(&anj, &metrics_obj));
+    anj_res_value_t value;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_res_read(
+            &anj, &ANJ_MAKE_RESOURCE_PATH(ANJ_METRICS_OBJ_OID, 0, 0), &value));
+    ANJ_UNIT_ASSERT_EQUAL(value.int_value, 1);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_res_read(
+            &anj, &ANJ_MAKE_RESOURCE_PATH(ANJ_METRICS_OBJ_OID, 0, 7), &value));
+    ANJ_UNIT_ASSERT_EQUAL(value.int_value, 3);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_res_read(
+            &anj, &ANJ_MAKE_RESOURCE_PATH(ANJ_METRICS_OBJ_OID, 0, 10), &value));
+    ANJ_UNIT_ASSERT_EQUAL(value.int_value, 4000);
+    ANJ_UNIT_ASSERT_FAILED(anj_dm_res_read(
+            &anj, &ANJ_MAKE_RESOURCE_PATH(ANJ_METRICS_OBJ_OID, 0, 11), &value));
+#    endif // ANJ_WITH_DEFAULT_METRICS_OBJ
+
+    anj_core_metrics_reset(&anj);
+    anj_core_metrics_get(&anj, &metrics);
+    ANJ_UNIT_ASSERT_EQUAL(metrics.exchanges, 0);
+    ANJ_UNIT_ASSERT_EQUAL(metrics.retransmissions, 0);
+    ANJ_UNIT_ASSERT_EQUAL(metrics.bytes_sent, 0);
+}
+
+#    ifdef ANJ_METRICS_WITH_HISTOGRAMS
+ANJ_UNIT_TEST(registration_session, metrics_histograms) {
+    EXTENDED_INIT();
+    PROCESS_REGISTRATION();
+
+    ADD_REQUEST(read_request);
+    anj_core_step(&anj);
+    CHECK_RESPONSE(read_response);
+    mock.bytes_sent = 0;
+
+    // Update answered after 300 ms
+    anj_core_server_obj_registration_update_trigger_executed(&anj);
+    anj_core_step(&anj);
+    COPY_TOKEN_AND_MSG_ID(update, 8);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, update,
+                                      mock.bytes_sent);
+    mock.bytes_sent = 0;
+    mock_time_advance(anj_time_duration_new(300, ANJ_TIME_UNIT_MS));
+    ADD_RESPONSE(update_response);
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERED);
+
+    anj_metrics_t metrics;
+    anj_core_metrics_get(&anj, &metrics);
+    const anj_metrics_histogram_t *server_request =
+            &metrics.histograms[ANJ_METRICS_HISTOGRAM_SERVER_REQUEST];
+    const anj_metrics_histogram_t *ack_rtt =
+            &metrics.histograms[ANJ_METRICS_HISTOGRAM_ACK_RTT];
+    ANJ_UNIT_ASSERT_EQUAL(server_request->buckets[0], 1);
+    // Register answered immediately, Update in [256, 512) ms
+    ANJ_UNIT_ASSERT_EQUAL(ack_rtt->buckets[0], 1);
+    ANJ_UNIT_ASSERT_EQUAL(ack_rtt->buckets[9], 1);
+    for (size_t i = 0; i < ANJ_METRICS_HISTOGRAM_BUCKETS; i++) {
+        ANJ_UNIT_ASSERT_EQUAL(
+                metrics.histograms[ANJ_METRICS_HISTOGRAM_SEND].buckets[i], 0);
+    }
+
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(
+            anj_metrics_histogram_percentile(ack_rtt, 50),
+            anj_time_duration_new(1, ANJ_TIME_UNIT_MS)));
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(
+            anj_metrics_histogram_percentile(ack_rtt, 99),
+            anj_time_duration_new(512, ANJ_TIME_UNIT_MS)));
+    ANJ_UNIT_ASSERT_FALSE(anj_time_duration_is_valid(
+            anj_metrics_histogram_percentile(
+                    &metrics.histograms[ANJ_METRICS_HISTOGRAM_SEND], 50)));
+
+    anj_core_metrics_reset(&anj);
+    anj_core_metrics_get(&anj, &metrics);
+    ANJ_UNIT_ASSERT_EQUAL(ack_rtt->buckets[9], 0);
+}
+#    endif // ANJ_METRICS_WITH_HISTOGRAMS
+#endif // ANJ_WITH_METRICS
+
+#ifdef ANJ_WITH_RESOURCE_USAGE
+ANJ_UNIT_TEST(registration_session, resource_usage) {
+    EXTENDED_INIT();
+    PROCESS_REGISTRATION();
+
+    anj_resource_usage_t usage;
+    anj_core_get_resource_usage(&anj, &usage);
+    ANJ_UNIT_ASSERT_EQUAL(usage.in_buffer_max, sizeof(register_response) - 1);
+    // Register message with the list of objects
+    ANJ_UNIT_ASSERT_TRUE(usage.out_buffer_max > sizeof(read_response) - 1);
+    ANJ_UNIT_ASSERT_TRUE(usage.payload_buffer_max > 0);
+
+    anj_core_resource_usage_reset(&anj);
+    anj_core_get_resource_usage(&anj, &usage);
+    ANJ_UNIT_ASSERT_EQUAL(usage.in_buffer_max, 0);
+    ANJ_UNIT_ASSERT_EQUAL(usage.out_buffer_max, 0);
+    ANJ_UNIT_ASSERT_EQUAL(usage.payload_buffer_max, 0);
+
+    ADD_REQUEST(read_request);
+    anj_core_step(&anj);
+    CHECK_RESPONSE(read_response);
+    mock.bytes_sent = 0;
+    anj_core_get_resource_usage(&anj, &usage);
+    ANJ_UNIT_ASSERT_EQUAL(usage.in_buffer_max, sizeof(read_request) - 1);
+    // "150"
+    ANJ_UNIT_ASSERT_EQUAL(usage.payload_buffer_max, 3);
+#    ifdef ANJ_NET_WITH_SEND_VEC
+    // the payload is sent straight from the payload buffer
+    ANJ_UNIT_ASSERT_EQUAL(usage.out_buffer_max, sizeof(read_response) - 1 - 3);
+#    else  // ANJ_NET_WITH_SEND_VEC
+    ANJ_UNIT_ASSERT_EQUAL(usage.out_buffer_max, sizeof(read_response) - 1);
+#    endif // ANJ_NET_WITH_SEND_VEC
+#    ifdef ANJ_WITH_CACHE
+    ANJ_UNIT_ASSERT_EQUAL(usage.exchange_cache_max, 1);
+#    endif // ANJ_WITH_CACHE
+#    ifdef ANJ_WITH_OBSERVE
+    ANJ_UNIT_ASSERT_EQUAL(usage.observations_max, 0);
+#    endif // ANJ_WITH_OBSERVE
+#    ifdef ANJ_WITH_LWM2M_SEND
+    ANJ_UNIT_ASSERT_EQUAL(usage.send_queue_max, 0);
+#    endif // ANJ_WITH_LWM2M_SEND
+}
+#endif // ANJ_WITH_RESOURCE_USAGE
+
+#ifdef ANJ_WITH_TRACE
+ANJ_UNIT_TEST(registration_session, trace) {
+    EXTENDED_INIT();
+    PROCESS_REGISTRATION();
+    anj_trace_event_t events[ANJ_TRACE_BUFFER_SIZE];
+    while (anj_core_trace_read(&anj, events, ANJ_ARRAY_SIZE(events))) {
+    }
+
+    ADD_REQUEST(read_request);
+    anj_core_step(&anj);
+    CHECK_RESPONSE(read_response);
+    mock_time_advance(anj_time_duration_new(1, ANJ_TIME_UNIT_S));
+    anj_core_step(&anj);
+
+    static const struct {
+        anj_trace_event_type_t type;
+        anj_trace_phase_t phase;
+        int32_t value;
+    } expected[] = {
+        { ANJ_TRACE_EVENT_NET_RECV, ANJ_TRACE_PHASE_INSTANT,
+          sizeof(read_request) - 1 },
+        { ANJ_TRACE_EVENT_DM_OPERATION, ANJ_TRACE_PHASE_BEGIN,
+          ANJ_OP_DM_READ },
+        { ANJ_TRACE_EVENT_EXCHANGE, ANJ_TRACE_PHASE_BEGIN, ANJ_OP_DM_READ },
+        { ANJ_TRACE_EVENT_NET_SEND, ANJ_TRACE_PHASE_BEGIN, 0 },
+        { ANJ_TRACE_EVENT_NET_SEND, ANJ_TRACE_PHASE_END,
+          sizeof(read_response) - 1 },
+        { ANJ_TRACE_EVENT_DM_OPERATION, ANJ_TRACE_PHASE_END,
+          ANJ_DM_TRANSACTION_SUCCESS },
+        { ANJ_TRACE_EVENT_EXCHANGE, ANJ_TRACE_PHASE_END, 0 },
+        { ANJ_TRACE_EVENT_OBSERVE_SCAN, ANJ_TRACE_PHASE_BEGIN, 0 },
+        { ANJ_TRACE_EVENT_OBSERVE_SCAN, ANJ_TRACE_PHASE_END, 0 },
+        { ANJ_TRACE_EVENT_OBSERVE_SCAN, ANJ_TRACE_PHASE_BEGIN, 0 },
+        { ANJ_TRACE_EVENT_OBSERVE_SCAN, ANJ_TRACE_PHASE_END, 0 }
+    };
+    ANJ_UNIT_ASSERT_EQUAL(
+            anj_core_trace_read(&anj, events, ANJ_ARRAY_SIZE(events)),
+            ANJ_ARRAY_SIZE(expected));
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(expected); i++) {
+        ANJ_UNIT_ASSERT_EQUAL(events[i].type, expected[i].type);
+        ANJ_UNIT_ASSERT_EQUAL(events[i].phase, expected[i].phase);
+        ANJ_UNIT_ASSERT_EQUAL(events[i].value, expected[i].value);
+    }
+    ANJ_UNIT_ASSERT_EQUAL(anj_time_monotonic_to_scalar(events[10].timestamp,
+                                                       ANJ_TIME_UNIT_S)
+                                  - anj_time_monotonic_to_scalar(
+                                          events[0].timestamp,
+                                          ANJ_TIME_UNIT_S),
+                          1);
+    ANJ_UNIT_ASSERT_EQUAL(anj_core_trace_dropped(&anj), 0);
+
+    // the oldest events are overwritten
+    for (int i = 0; i < ANJ_TRACE_BUFFER_SIZE + 2; i++) {
+        mock_time_advance(anj_time_duration_new(1, ANJ_TIME_UNIT_S));
+        anj_core_step(&anj);
+    }
+    ANJ_UNIT_ASSERT_EQUAL(
+            anj_core_trace_read(&anj, events, ANJ_ARRAY_SIZE(events)),
+            ANJ_TRACE_BUFFER_SIZE);
+    ANJ_UNIT_ASSERT_EQUAL(anj_core_trace_dropped(&anj),
+                          2 * (ANJ_TRACE_BUFFER_SIZE + 2)
+                                  - ANJ_TRACE_BUFFER_SIZE);
+    ANJ_UNIT_ASSERT_EQUAL(anj_core_trace_dropped(&anj), 0);
+    ANJ_UNIT_ASSERT_EQUAL(events[ANJ_TRACE_BUFFER_SIZE - 1].phase,
+                          ANJ_TRACE_PHASE_END);
+
+#    ifdef ANJ_WITH_TRACE_POSIX_EXPORTER
+    anj_core_step(&anj);
+    int fds[2];
+    ANJ_UNIT_ASSERT_SUCCESS(pipe(fds));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_core_trace_export_json(&anj, fds[1]));
+    close(fds[1]);
+    char json[512] = { 0 };
+    ANJ_UNIT_ASSERT_TRUE(read(fds[0], json, sizeof(json) - 1) > 0);
+    close(fds[0]);
+    ANJ_UNIT_ASSERT_EQUAL_STRING(
+            json,
+            "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+            "{\"name\":\"observe_scan\",\"ph\":\"B\",\"ts\":67000000,"
+            "\"pid\":1,\"tid\":4,\"args\":{\"value\":0}},\n"
+            "{\"name\":\"observe_scan\",\"ph\":\"E\",\"ts\":67000000,"
+            "\"pid\":1,\"tid\":4,\"args\":{\"value\":0}}\n"
+            "]}\n");
+    ANJ_UNIT_ASSERT_EQUAL(
+            anj_core_trace_read(&anj, events, ANJ_ARRAY_SIZE(events)), 0);
+#    endif // ANJ_WITH_TRACE_POSIX_EXPORTER
+}
+#endif // ANJ_WITH_TRACE
+
 ANJ_UNIT_TEST(registration_session, server_requests_network_error) {
     EXTENDED_INIT();
     PROCESS_REGISTRATION();
@@ -742,89 +1157,472 @@ ANJ_UNIT_TEST(registration_session, observations) {
     ANJ_UNIT_ASSERT_EQUAL(anj.observe_ctx.observations[0].ssid, 0);
 }
 
-static char deregister[] = "\x48"         // Confirmable, tkl 8
-                           "\x04\x00\x00" // DELETE, msg_id
-                           "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF" // token
-                           "\xb2\x72\x64"                     // uri path /rd
-                           "\x04\x35\x61\x33\x66";            // uri path /5a3f
-
-static char deregister_response[] = "\x68"         // header v 0x01, Ack, tkl 8
-                                    "\x42\x00\x00" // Code=Deleted
-                                    "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF"; // token
-
-#define HANDLE_DEREGISTER(Response)                                      \
-    anj_core_step(&anj);                                                 \
-    COPY_TOKEN_AND_MSG_ID(deregister, 8);                                \
-    ANJ_UNIT_ASSERT_EQUAL(sizeof(deregister) - 1, mock.bytes_sent);      \
-    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, deregister, \
-                                      mock.bytes_sent);                  \
-    ADD_RESPONSE(Response);                                              \
-    anj_core_step(&anj);                                                 \
-    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,                  \
-                          ANJ_CONN_STATUS_SUSPENDED);                    \
-    mock.bytes_sent = 0;                                                 \
-    anj_core_step(&anj);                                                 \
-    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0)
-
-static char execute_disable_request[] =
-        "\x42"         // Header: Ver=1, Type=0 (CON), TKL=2
-        "\x02\x47\x25" // Code=EXECUTE (0.05), MID=0x4725
-        "\x12\x34"     // Token
-        "\xB1\x31"     // Uri-Path: /1
-        "\x01\x31"     // Uri-Path: /1
-        "\x01\x34";    // Uri-Path: /4
+#ifdef ANJ_WITH_PIPELINED_NOTIFICATIONS
+// in lwm2m 1.1 pmin and pmax can't be set in observe request
+static void set_observe_attributes(anj_t *anj) {
+#    ifndef ANJ_WITH_LWM2M12
+    anj->observe_ctx.attributes_storage[0].ssid = 2;
+    anj->observe_ctx.attributes_storage[0].path =
+            ANJ_MAKE_RESOURCE_PATH(1, 1, 5);
+    anj->observe_ctx.attributes_storage[0].attr.has_min_period = true;
+    anj->observe_ctx.attributes_storage[0].attr.min_period = 100;
+    anj->observe_ctx.attributes_storage[0].attr.has_max_period = true;
+    anj->observe_ctx.attributes_storage[0].attr.max_period = 300;
+#    else  // ANJ_WITH_LWM2M12
+    (void) anj;
+#    endif // ANJ_WITH_LWM2M12
+}
 
-ANJ_UNIT_TEST(registration_session, server_disable_by_server) {
-    EXTENDED_INIT();
-    PROCESS_REGISTRATION();
+// Update is sent just before pmin passes, then the notification becomes ready
+// while the Update waits for the response
+#    define OBSERVE_DURING_UPDATE(Notification_mode)                       \
+        TEST_INIT();                                                       \
+        INIT_BASIC_INSTANCES();                                            \
+        ser_inst.lifetime = 1000;                                          \
+        ser_inst.disable_timeout = 800;                                    \
+        ser_inst.default_notification_mode = Notification_mode;            \
+        ADD_INSTANCES();                                                   \
+        PROCESS_REGISTRATION();                                            \
+        set_observe_attributes(&anj);                                      \
+        ADD_REQUEST(observe_request);                                      \
+        anj_core_step(&anj);                                               \
+        CHECK_RESPONSE(observe_response);                                  \
+        mock_time_advance(anj_time_duration_new(99500, ANJ_TIME_UNIT_MS)); \
+        mock.bytes_sent = 0;                                               \
+        anj_core_server_obj_registration_update_trigger_executed(&anj);    \
+        anj_core_step(&anj);                                               \
+        COPY_TOKEN_AND_MSG_ID(update, 8);                                  \
+        CHECK_RESPONSE(update);                                            \
+        mock_time_advance(anj_time_duration_new(900, ANJ_TIME_UNIT_MS));   \
+        ser_obj.server_instance.disable_timeout = 200;                     \
+        anj_core_data_model_changed(&anj,                                  \
+                                    &ANJ_MAKE_RESOURCE_PATH(1, 1, 5),      \
+                                    ANJ_CORE_CHANGE_TYPE_VALUE_CHANGED);   \
+        mock.bytes_sent = 0;                                               \
+        anj_core_step(&anj)
+
+ANJ_UNIT_TEST(registration_session, non_con_notification_during_update) {
+    OBSERVE_DURING_UPDATE(0);
+    // notification is sent while the Update waits for the response
+    CHECK_NOTIFY(notification);
+    ANJ_UNIT_ASSERT_TRUE(_anj_exchange_ongoing_exchange(&anj.exchange_ctx));
+    ANJ_UNIT_ASSERT_FALSE(
+            _anj_exchange_ongoing_exchange(&anj.pipelined[0].exchange_ctx));
 
-    mock.call_result[ANJ_NET_FUN_CLOSE] = ANJ_NET_EINPROGRESS;
-    // execute on /1/1/4
-    ADD_REQUEST(execute_disable_request);
-    anj_core_step(&anj);
-    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
-                          ANJ_CONN_STATUS_REGISTERED);
-    COPY_TOKEN_AND_MSG_ID(deregister, 8);
-    ANJ_UNIT_ASSERT_EQUAL(sizeof(deregister) - 1, mock.bytes_sent);
-    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, deregister,
-                                      mock.bytes_sent);
-    ADD_RESPONSE(deregister_response);
+    ADD_RESPONSE(update_response);
+    mock.bytes_sent = 0;
     anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+    ANJ_UNIT_ASSERT_FALSE(_anj_exchange_ongoing_exchange(&anj.exchange_ctx));
     ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
                           ANJ_CONN_STATUS_REGISTERED);
-    mock.call_result[ANJ_NET_FUN_CLOSE] = 0;
+}
+
+static char con_notification_ack[] = "\x60"          // ACK, tkl 0
+                                     "\x00\x00\x00"; // Empty msg
+
+ANJ_UNIT_TEST(registration_session, con_notification_during_update) {
+    OBSERVE_DURING_UPDATE(1);
+    // Confirmable notification is sent as well, NSTART is not reached
+    notification[0] = 0x42;
+    CHECK_NOTIFY(notification);
+    notification[0] = 0x52;
+    ANJ_UNIT_ASSERT_TRUE(_anj_exchange_ongoing_exchange(&anj.exchange_ctx));
+    ANJ_UNIT_ASSERT_TRUE(
+            _anj_exchange_ongoing_exchange(&anj.pipelined[0].exchange_ctx));
+
+    // ACK is matched with the notification by its Message ID
+    con_notification_ack[2] = mock.send_data_buffer[2];
+    con_notification_ack[3] = mock.send_data_buffer[3];
+    ADD_REQUEST(con_notification_ack);
+    mock.bytes_sent = 0;
     anj_core_step(&anj);
-    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
-                          ANJ_CONN_STATUS_SUSPENDED);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+    ANJ_UNIT_ASSERT_TRUE(_anj_exchange_ongoing_exchange(&anj.exchange_ctx));
+    ANJ_UNIT_ASSERT_FALSE(
+            _anj_exchange_ongoing_exchange(&anj.pipelined[0].exchange_ctx));
 
-    // pass 1 day and check if Anjay exits the suspended state
-    // 1 day is default disable timeout
-    mock_time_advance(anj_time_duration_new(1, ANJ_TIME_UNIT_DAY));
+    ADD_RESPONSE(update_response);
     anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+    ANJ_UNIT_ASSERT_FALSE(_anj_exchange_ongoing_exchange(&anj.exchange_ctx));
     ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
-                          ANJ_CONN_STATUS_REGISTERING);
+                          ANJ_CONN_STATUS_REGISTERED);
+    ANJ_UNIT_ASSERT_EQUAL(anj.observe_ctx.observations[0].ssid, 2);
 }
 
-ANJ_UNIT_TEST(registration_session, server_disable_failed_deregister) {
-    EXTENDED_INIT();
+ANJ_UNIT_TEST(registration_session, update_during_con_notification) {
+    TEST_INIT();
+    INIT_BASIC_INSTANCES();
+    ser_inst.lifetime = 1000;
+    ser_inst.disable_timeout = 800;
+    ser_inst.default_notification_mode = 1;
+    ADD_INSTANCES();
     PROCESS_REGISTRATION();
+    set_observe_attributes(&anj);
+    ADD_REQUEST(observe_request);
+    anj_core_step(&anj);
+    CHECK_RESPONSE(observe_response);
+    mock_time_advance(anj_time_duration_new(101, ANJ_TIME_UNIT_S));
+    ser_obj.server_instance.disable_timeout = 200;
+    anj_core_data_model_changed(&anj, &ANJ_MAKE_RESOURCE_PATH(1, 1, 5),
+                                ANJ_CORE_CHANGE_TYPE_VALUE_CHANGED);
+    mock.bytes_sent = 0;
+    anj_core_step(&anj);
+    // notification doesn't occupy the exchange used for the Update
+    notification[0] = 0x42;
+    CHECK_NOTIFY(notification);
+    notification[0] = 0x52;
+    ANJ_UNIT_ASSERT_FALSE(_anj_exchange_ongoing_exchange(&anj.exchange_ctx));
+    ANJ_UNIT_ASSERT_TRUE(
+            _anj_exchange_ongoing_exchange(&anj.pipelined[0].exchange_ctx));
+    con_notification_ack[2] = mock.send_data_buffer[2];
+    con_notification_ack[3] = mock.send_data_buffer[3];
 
-    // simulate execute on /1/0/4
-    anj_core_server_obj_disable_executed(&anj, 5);
-    HANDLE_DEREGISTER(error_response);
+    mock.bytes_sent = 0;
+    anj_core_server_obj_registration_update_trigger_executed(&anj);
+    anj_core_step(&anj);
+    COPY_TOKEN_AND_MSG_ID(update, 8);
+    CHECK_RESPONSE(update);
+    ADD_RESPONSE(update_response);
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_FALSE(_anj_exchange_ongoing_exchange(&anj.exchange_ctx));
+    ANJ_UNIT_ASSERT_TRUE(
+            _anj_exchange_ongoing_exchange(&anj.pipelined[0].exchange_ctx));
 
-    // pass 6s and check if Anjay exits the suspended state
-    mock_time_advance(anj_time_duration_new(6, ANJ_TIME_UNIT_S));
+    ADD_REQUEST(con_notification_ack);
+    mock.bytes_sent = 0;
     anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+    ANJ_UNIT_ASSERT_FALSE(
+            _anj_exchange_ongoing_exchange(&anj.pipelined[0].exchange_ctx));
     ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
-                          ANJ_CONN_STATUS_REGISTERING);
+                          ANJ_CONN_STATUS_REGISTERED);
+    ANJ_UNIT_ASSERT_EQUAL(anj.observe_ctx.observations[0].ssid, 2);
 }
 
-ANJ_UNIT_TEST(registration_session, server_disable_by_user_with_timeout) {
-    EXTENDED_INIT();
-    PROCESS_REGISTRATION();
+#    if ANJ_PIPELINED_NOTIFICATIONS_NSTART == 2
+static uint16_t sent_msg_id(net_api_mock_t *mock) {
+    return (uint16_t) ((mock->send_data_buffer[2] << 8)
+                       | mock->send_data_buffer[3]);
+}
 
-    anj_core_disable_server(&anj, anj_time_duration_new(5, ANJ_TIME_UNIT_S));
+static void change_value(anj_t *anj,
+                         anj_dm_server_obj_t *ser_obj,
+                         net_api_mock_t *mock,
+                         uint32_t value) {
+    mock_time_advance(anj_time_duration_new(101, ANJ_TIME_UNIT_S));
+    ser_obj->server_instance.disable_timeout = value;
+    anj_core_data_model_changed(anj, &ANJ_MAKE_RESOURCE_PATH(1, 1, 5),
+                                ANJ_CORE_CHANGE_TYPE_VALUE_CHANGED);
+    mock->bytes_sent = 0;
+    anj_core_step(anj);
+}
+
+static void ack_notification(anj_t *anj,
+                             net_api_mock_t *mock,
+                             uint16_t msg_id) {
+    con_notification_ack[2] = (char) (msg_id >> 8);
+    con_notification_ack[3] = (char) (msg_id & 0xFF);
+    mock->bytes_to_recv = sizeof(con_notification_ack) - 1;
+    mock->data_to_recv = (uint8_t *) con_notification_ack;
+    mock->bytes_sent = 0;
+    anj_core_step(anj);
+}
+
+ANJ_UNIT_TEST(registration_session, con_notifications_limited_by_nstart) {
+    TEST_INIT();
+    INIT_BASIC_INSTANCES();
+    ser_inst.lifetime = 1000;
+    ser_inst.disable_timeout = 800;
+    ser_inst.default_notification_mode = 1;
+    ADD_INSTANCES();
+    PROCESS_REGISTRATION();
+    // no retransmissions while the notifications wait for the ACKs
+    anj_exchange_udp_tx_params_t tx_params = {
+        .ack_timeout = anj_time_duration_new(1000, ANJ_TIME_UNIT_S),
+        .ack_random_factor = ANJ_ACK_RANDOM_FACTOR(1.0),
+        .max_retransmit = 4
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_exchange_set_udp_tx_params(&anj.exchange_ctx, &tx_params));
+#        ifdef ANJ_WITH_ADAPTIVE_RTO
+    _anj_exchange_reset_rto(&anj.exchange_ctx);
+#        endif // ANJ_WITH_ADAPTIVE_RTO
+    set_observe_attributes(&anj);
+    ADD_REQUEST(observe_request);
+    anj_core_step(&anj);
+    CHECK_RESPONSE(observe_response);
+
+    change_value(&anj, &ser_obj, &mock, 200);
+    ANJ_UNIT_ASSERT_EQUAL(mock.send_data_buffer[0], 0x42);
+    uint16_t first_msg_id = sent_msg_id(&mock);
+    ANJ_UNIT_ASSERT_FALSE(_anj_exchange_ongoing_exchange(&anj.exchange_ctx));
+    ANJ_UNIT_ASSERT_TRUE(
+            _anj_exchange_ongoing_exchange(&anj.pipelined[0].exchange_ctx));
+
+    // the only additional exchange is in use
+    change_value(&anj, &ser_obj, &mock, 201);
+    ANJ_UNIT_ASSERT_EQUAL(mock.send_data_buffer[0], 0x42);
+    uint16_t second_msg_id = sent_msg_id(&mock);
+    ANJ_UNIT_ASSERT_TRUE(_anj_exchange_ongoing_exchange(&anj.exchange_ctx));
+
+    // NSTART is reached, pmax passes in the meantime
+    mock_time_advance(anj_time_duration_new(301, ANJ_TIME_UNIT_S));
+    mock.bytes_sent = 0;
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+
+    // the notification held in the main exchange context is still prepared in
+    // the data model, so the next one waits for it
+    ack_notification(&anj, &mock, first_msg_id);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+    ANJ_UNIT_ASSERT_FALSE(
+            _anj_exchange_ongoing_exchange(&anj.pipelined[0].exchange_ctx));
+
+    ack_notification(&anj, &mock, second_msg_id);
+    ANJ_UNIT_ASSERT_FALSE(_anj_exchange_ongoing_exchange(&anj.exchange_ctx));
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_TRUE(mock.bytes_sent > 0);
+    ANJ_UNIT_ASSERT_EQUAL(mock.send_data_buffer[0], 0x42);
+    ANJ_UNIT_ASSERT_TRUE(
+            _anj_exchange_ongoing_exchange(&anj.pipelined[0].exchange_ctx));
+    ack_notification(&anj, &mock, sent_msg_id(&mock));
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+    ANJ_UNIT_ASSERT_FALSE(
+            _anj_exchange_ongoing_exchange(&anj.pipelined[0].exchange_ctx));
+    ANJ_UNIT_ASSERT_FALSE(anj_core_ongoing_operation(&anj));
+    ANJ_UNIT_ASSERT_EQUAL(anj.observe_ctx.observations[0].ssid, 2);
+}
+#    endif // ANJ_PIPELINED_NOTIFICATIONS_NSTART == 2
+
+#    ifdef ANJ_WITH_INTERLEAVED_NOTIFICATIONS
+static char block_read_request[] =
+        "\x42"         // header v 0x01, Confirmable, tkl 2
+        "\x01\x50\x00" // GET code 0.1, msg id
+        "\x12\x34"     // token
+        "\xB1\x31"     // uri-path_1 URI_PATH 11 /1
+        "\xC1\x00";    // block2 0, size 16
+
+static void request_block(anj_t *anj,
+                          net_api_mock_t *mock,
+                          uint32_t block_number) {
+    static uint16_t msg_id = 0x5000;
+    block_read_request[2] = (char) (msg_id >> 8);
+    block_read_request[3] = (char) (msg_id & 0xFF);
+    msg_id++;
+    block_read_request[9] = (char) (block_number << 4);
+    mock->bytes_to_recv = sizeof(block_read_request) - 1;
+    mock->data_to_recv = (uint8_t *) block_read_request;
+    mock->bytes_sent = 0;
+    anj_core_step(anj);
+}
+
+// Sends the request for the given block of the Read response and appends its
+// payload to Payload, returns true if more blocks follow
+static bool read_block(anj_t *anj,
+                       net_api_mock_t *mock,
+                       uint32_t block_number,
+                       uint8_t *payload,
+                       size_t *payload_len) {
+    request_block(anj, mock, block_number);
+    _anj_coap_msg_t response;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_coap_decode_udp(
+            mock->send_data_buffer, mock->bytes_sent, &response));
+    ANJ_UNIT_ASSERT_EQUAL(response.msg_code, ANJ_COAP_CODE_CONTENT);
+    ANJ_UNIT_ASSERT_EQUAL(response.block.block_type, ANJ_OPTION_BLOCK_2);
+    ANJ_UNIT_ASSERT_EQUAL(response.block.number, block_number);
+    memcpy(&payload[*payload_len], response.payload, response.payload_size);
+    *payload_len += response.payload_size;
+    return response.block.more_flag;
+}
+
+ANJ_UNIT_TEST(registration_session, non_con_notification_during_block_read) {
+    TEST_INIT();
+    INIT_BASIC_INSTANCES();
+    ser_inst.lifetime = 1000;
+    ser_inst.disable_timeout = 800;
+    ser_inst.default_notification_mode = 0;
+    ADD_INSTANCES();
+    PROCESS_REGISTRATION();
+    set_observe_attributes(&anj);
+    ADD_REQUEST(observe_request);
+    anj_core_step(&anj);
+    CHECK_RESPONSE(observe_response);
+    mock_time_advance(anj_time_duration_new(101, ANJ_TIME_UNIT_S));
+    ser_obj.server_instance.disable_timeout = 200;
+
+    // reference Read, without notifications in between
+    uint8_t expected[512];
+    size_t expected_len = 0;
+    uint32_t block = 0;
+    while (read_block(&anj, &mock, block, expected, &expected_len)) {
+        block++;
+    }
+    ANJ_UNIT_ASSERT_TRUE(block > 1);
+    ANJ_UNIT_ASSERT_FALSE(_anj_exchange_ongoing_exchange(&anj.exchange_ctx));
+
+    uint8_t payload[512];
+    size_t payload_len = 0;
+    ANJ_UNIT_ASSERT_TRUE(read_block(&anj, &mock, 0, payload, &payload_len));
+    anj_core_data_model_changed(&anj, &ANJ_MAKE_RESOURCE_PATH(1, 1, 5),
+                                ANJ_CORE_CHANGE_TYPE_VALUE_CHANGED);
+    mock.bytes_sent = 0;
+    anj_core_step(&anj);
+    // notification is sent while the Read waits for the next block request
+    CHECK_NOTIFY(notification);
+    ANJ_UNIT_ASSERT_TRUE(_anj_exchange_ongoing_exchange(&anj.exchange_ctx));
+    ANJ_UNIT_ASSERT_FALSE(
+            _anj_exchange_ongoing_exchange(&anj.pipelined[0].exchange_ctx));
+    ANJ_UNIT_ASSERT_FALSE(anj.interleaved.notification_aside);
+
+    // the Read continues where it stopped
+    block = 1;
+    while (read_block(&anj, &mock, block, payload, &payload_len)) {
+        block++;
+    }
+    ANJ_UNIT_ASSERT_FALSE(_anj_exchange_ongoing_exchange(&anj.exchange_ctx));
+    ANJ_UNIT_ASSERT_EQUAL(payload_len, expected_len);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(payload, expected, expected_len);
+    mock.bytes_sent = 0;
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+}
+
+ANJ_UNIT_TEST(registration_session, con_notification_during_block_read) {
+    TEST_INIT();
+    INIT_BASIC_INSTANCES();
+    ser_inst.lifetime = 1000;
+    ser_inst.disable_timeout = 800;
+    ser_inst.default_notification_mode = 1;
+    ADD_INSTANCES();
+    PROCESS_REGISTRATION();
+    set_observe_attributes(&anj);
+    ADD_REQUEST(observe_request);
+    anj_core_step(&anj);
+    CHECK_RESPONSE(observe_response);
+    mock_time_advance(anj_time_duration_new(101, ANJ_TIME_UNIT_S));
+    ser_obj.server_instance.disable_timeout = 200;
+
+    uint8_t payload[512];
+    size_t payload_len = 0;
+    ANJ_UNIT_ASSERT_TRUE(read_block(&anj, &mock, 0, payload, &payload_len));
+    anj_core_data_model_changed(&anj, &ANJ_MAKE_RESOURCE_PATH(1, 1, 5),
+                                ANJ_CORE_CHANGE_TYPE_VALUE_CHANGED);
+    mock.bytes_sent = 0;
+    anj_core_step(&anj);
+    // Confirmable notification is sent while the Read waits for the next
+    // block request
+    notification[0] = 0x42;
+    CHECK_NOTIFY(notification);
+    notification[0] = 0x52;
+    ANJ_UNIT_ASSERT_FALSE(anj.interleaved.notification_aside);
+    ANJ_UNIT_ASSERT_TRUE(_anj_exchange_ongoing_exchange(&anj.exchange_ctx));
+
+    con_notification_ack[2] = mock.send_data_buffer[2];
+    con_notification_ack[3] = mock.send_data_buffer[3];
+    ADD_REQUEST(con_notification_ack);
+    mock.bytes_sent = 0;
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+    ANJ_UNIT_ASSERT_TRUE(_anj_exchange_ongoing_exchange(&anj.exchange_ctx));
+    ANJ_UNIT_ASSERT_FALSE(
+            _anj_exchange_ongoing_exchange(&anj.pipelined[0].exchange_ctx));
+
+    // the Read continues where it stopped
+    uint32_t block = 1;
+    while (read_block(&anj, &mock, block, payload, &payload_len)) {
+        block++;
+    }
+    ANJ_UNIT_ASSERT_FALSE(_anj_exchange_ongoing_exchange(&anj.exchange_ctx));
+    ANJ_UNIT_ASSERT_FALSE(anj_core_ongoing_operation(&anj));
+}
+#    endif // ANJ_WITH_INTERLEAVED_NOTIFICATIONS
+#endif // ANJ_WITH_PIPELINED_NOTIFICATIONS
+
+static char deregister[] = "\x48"         // Confirmable, tkl 8
+                           "\x04\x00\x00" // DELETE, msg_id
+                           "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF" // token
+                           "\xb2\x72\x64"                     // uri path /rd
+                           "\x04\x35\x61\x33\x66";            // uri path /5a3f
+
+static char deregister_response[] = "\x68"         // header v 0x01, Ack, tkl 8
+                                    "\x42\x00\x00" // Code=Deleted
+                                    "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF"; // token
+
+#define HANDLE_DEREGISTER(Response)                                      \
+    anj_core_step(&anj);                                                 \
+    COPY_TOKEN_AND_MSG_ID(deregister, 8);                                \
+    ANJ_UNIT_ASSERT_EQUAL(sizeof(deregister) - 1, mock.bytes_sent);      \
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, deregister, \
+                                      mock.bytes_sent);                  \
+    ADD_RESPONSE(Response);                                              \
+    anj_core_step(&anj);                                                 \
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,                  \
+                          ANJ_CONN_STATUS_SUSPENDED);                    \
+    mock.bytes_sent = 0;                                                 \
+    anj_core_step(&anj);                                                 \
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0)
+
+static char execute_disable_request[] =
+        "\x42"         // Header: Ver=1, Type=0 (CON), TKL=2
+        "\x02\x47\x25" // Code=EXECUTE (0.05), MID=0x4725
+        "\x12\x34"     // Token
+        "\xB1\x31"     // Uri-Path: /1
+        "\x01\x31"     // Uri-Path: /1
+        "\x01\x34";    // Uri-Path: /4
+
+ANJ_UNIT_TEST(registration_session, server_disable_by_server) {
+    EXTENDED_INIT();
+    PROCESS_REGISTRATION();
+
+    mock.call_result[ANJ_NET_FUN_CLOSE] = ANJ_NET_EINPROGRESS;
+    // execute on /1/1/4
+    ADD_REQUEST(execute_disable_request);
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERED);
+    COPY_TOKEN_AND_MSG_ID(deregister, 8);
+    ANJ_UNIT_ASSERT_EQUAL(sizeof(deregister) - 1, mock.bytes_sent);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, deregister,
+                                      mock.bytes_sent);
+    ADD_RESPONSE(deregister_response);
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERED);
+    mock.call_result[ANJ_NET_FUN_CLOSE] = 0;
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_SUSPENDED);
+
+    // pass 1 day and check if Anjay exits the suspended state
+    // 1 day is default disable timeout
+    mock_time_advance(anj_time_duration_new(1, ANJ_TIME_UNIT_DAY));
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERING);
+}
+
+ANJ_UNIT_TEST(registration_session, server_disable_failed_deregister) {
+    EXTENDED_INIT();
+    PROCESS_REGISTRATION();
+
+    // simulate execute on /1/0/4
+    anj_core_server_obj_disable_executed(&anj, 5);
+    HANDLE_DEREGISTER(error_response);
+
+    // pass 6s and check if Anjay exits the suspended state
+    mock_time_advance(anj_time_duration_new(6, ANJ_TIME_UNIT_S));
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERING);
+}
+
+ANJ_UNIT_TEST(registration_session, server_disable_by_user_with_timeout) {
+    EXTENDED_INIT();
+    PROCESS_REGISTRATION();
+
+    anj_core_disable_server(&anj, anj_time_duration_new(5, ANJ_TIME_UNIT_S));
     HANDLE_DEREGISTER(deregister_response);
 
     // pass 5s and check if Anjay exits the suspended state
@@ -957,54 +1755,570 @@ ANJ_UNIT_TEST(registration_session, queue_mode_basic_check) {
     // 40 second before next queue mode
     mock_time_advance(anj_time_duration_new(10, ANJ_TIME_UNIT_S));
     anj_core_step(&anj);
-    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
-                          ANJ_CONN_STATUS_REGISTERED);
-    ANJ_UNIT_ASSERT_TRUE(anj_time_monotonic_eq(
-            anj.server_state.details.registered.queue_start_time,
-            anj_time_monotonic_add(anj_time_monotonic_now(),
-                                   anj_time_duration_new(40,
-                                                         ANJ_TIME_UNIT_S))));
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERED);
+    ANJ_UNIT_ASSERT_TRUE(anj_time_monotonic_eq(
+            anj.server_state.details.registered.queue_start_time,
+            anj_time_monotonic_add(anj_time_monotonic_now(),
+                                   anj_time_duration_new(40,
+                                                         ANJ_TIME_UNIT_S))));
+
+    // read request extend queue mode time
+    ADD_REQUEST(read_request);
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERED);
+    CHECK_RESPONSE(read_response);
+    ANJ_UNIT_ASSERT_TRUE(anj_time_monotonic_eq(
+            anj.server_state.details.registered.queue_start_time,
+            anj_time_monotonic_add(anj_time_monotonic_now(),
+                                   anj_time_duration_new(50,
+                                                         ANJ_TIME_UNIT_S))));
+
+    // another queue_rx_off() is successful - queue mode is started immediately
+    mock_time_advance(anj_time_duration_new(51, ANJ_TIME_UNIT_S));
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_QUEUE_MODE);
+    // next anj_core_step() is called with big delay, but still everything is ok
+    // and update is sent
+    mock_time_advance(anj_time_duration_new(3000, ANJ_TIME_UNIT_S));
+    HANDLE_UPDATE(update);
+}
+
+#ifdef ANJ_NET_WITH_POLL_HANDLE
+#    define CHECK_NEXT_WAKEUP(Wakeup, Timeout)                               \
+        do {                                                                 \
+            anj_time_duration_t timeout;                                     \
+            anj_net_poll_handle_t handle = { 0 };                            \
+            ANJ_UNIT_ASSERT_EQUAL(anj_core_next_wakeup(&anj, &timeout,       \
+                                                       &handle),             \
+                                  Wakeup);                                   \
+            ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(timeout, (Timeout)));  \
+            if ((Wakeup) == ANJ_CORE_WAKEUP_NET_OR_TIMER) {                  \
+                ANJ_UNIT_ASSERT_EQUAL(handle.fd, mock.poll_handle_fd);       \
+            }                                                                \
+        } while (0)
+
+ANJ_UNIT_TEST(registration_session, next_wakeup) {
+    EXTENDED_INIT();
+    mock.poll_handle_fd = 7;
+    CHECK_NEXT_WAKEUP(ANJ_CORE_WAKEUP_NOW, ANJ_TIME_DURATION_ZERO);
+    PROCESS_REGISTRATION();
+
+    // nothing to do but waiting for server requests until the Update
+    CHECK_NEXT_WAKEUP(ANJ_CORE_WAKEUP_NET_OR_TIMER,
+                      anj_time_duration_new(75, ANJ_TIME_UNIT_S));
+    mock_time_advance(anj_time_duration_new(25, ANJ_TIME_UNIT_S));
+    CHECK_NEXT_WAKEUP(ANJ_CORE_WAKEUP_NET_OR_TIMER,
+                      anj_time_duration_new(50, ANJ_TIME_UNIT_S));
+
+    // data already buffered by the net compat layer
+    mock.data_pending = true;
+    CHECK_NEXT_WAKEUP(ANJ_CORE_WAKEUP_NOW, ANJ_TIME_DURATION_ZERO);
+    mock.data_pending = false;
+    mock.call_result[ANJ_NET_FUN_GET_POLL_HANDLE] = ANJ_NET_ENOTSUP;
+    CHECK_NEXT_WAKEUP(ANJ_CORE_WAKEUP_NOW, ANJ_TIME_DURATION_ZERO);
+    mock.call_result[ANJ_NET_FUN_GET_POLL_HANDLE] = 0;
+
+    // Update is sent right away
+    mock_time_advance(anj_time_duration_new(51, ANJ_TIME_UNIT_S));
+    CHECK_NEXT_WAKEUP(ANJ_CORE_WAKEUP_NOW, ANJ_TIME_DURATION_ZERO);
+    anj_core_step(&anj);
+    COPY_TOKEN_AND_MSG_ID(update, 8);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, update,
+                                      sizeof(update) - 1);
+
+    // waiting for the response until retransmission
+    CHECK_NEXT_WAKEUP(ANJ_CORE_WAKEUP_NET_OR_TIMER, anj.exchange_ctx.timeout);
+    mock_time_advance(anj.exchange_ctx.timeout);
+    CHECK_NEXT_WAKEUP(ANJ_CORE_WAKEUP_NOW, ANJ_TIME_DURATION_ZERO);
+    mock.bytes_sent = 0;
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, sizeof(update) - 1);
+    CHECK_NEXT_WAKEUP(ANJ_CORE_WAKEUP_NET_OR_TIMER,
+                      anj_time_duration_mul(anj.exchange_ctx.timeout, 2));
+
+    // next Update time is counted from the first transmission
+    anj_time_duration_t retransmission_delay = anj.exchange_ctx.timeout;
+    ADD_RESPONSE(update_response);
+    anj_core_step(&anj);
+    CHECK_NEXT_WAKEUP(ANJ_CORE_WAKEUP_NET_OR_TIMER,
+                      anj_time_duration_sub(anj_time_duration_new(
+                                                    75, ANJ_TIME_UNIT_S),
+                                            retransmission_delay));
+
+    // lifetime changed - Update has to be sent
+    ser_obj.server_instance.lifetime = 100;
+    anj_core_data_model_changed(&anj,
+                                &ANJ_MAKE_RESOURCE_PATH(1, 1, 1),
+                                ANJ_CORE_CHANGE_TYPE_VALUE_CHANGED);
+    CHECK_NEXT_WAKEUP(ANJ_CORE_WAKEUP_NOW, ANJ_TIME_DURATION_ZERO);
+    HANDLE_UPDATE(update_with_lifetime);
+    CHECK_NEXT_WAKEUP(ANJ_CORE_WAKEUP_NET_OR_TIMER,
+                      anj_time_duration_new(50, ANJ_TIME_UNIT_S));
+
+    // forced state transition is handled right away
+    anj_core_disable_server(&anj, anj_time_duration_new(30, ANJ_TIME_UNIT_S));
+    CHECK_NEXT_WAKEUP(ANJ_CORE_WAKEUP_NOW, ANJ_TIME_DURATION_ZERO);
+}
+#endif // ANJ_NET_WITH_POLL_HANDLE
+
+#ifdef ANJ_WITH_BUDGETED_STEP
+#    define STEP_BUDGETED(Max_actions, Max_time, Result)                   \
+        do {                                                              \
+            anj_core_step_budget_t budget = {                             \
+                .max_actions = (Max_actions),                             \
+                .max_time = (Max_time)                                    \
+            };                                                            \
+            ANJ_UNIT_ASSERT_EQUAL(anj_core_step_budgeted(&anj, &budget,   \
+                                                         &timeout,        \
+                                                         &handle),        \
+                                  Result);                                \
+        } while (0)
+
+ANJ_UNIT_TEST(registration_session, budgeted_step) {
+    EXTENDED_INIT();
+    mock.poll_handle_fd = 7;
+    anj_time_duration_t timeout;
+    anj_net_poll_handle_t handle = { 0 };
+
+    // a single action moves the client from the initial state
+    STEP_BUDGETED(1, ANJ_TIME_DURATION_INVALID, ANJ_CORE_STEP_YIELDED);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERING);
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(timeout, ANJ_TIME_DURATION_ZERO));
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+
+    // the rest of the work is spread over following calls, the Register
+    // message is sent by one of them
+    int calls = 0;
+    while (!mock.bytes_sent) {
+        ANJ_UNIT_ASSERT_TRUE(++calls < 10);
+        STEP_BUDGETED(1, ANJ_TIME_DURATION_INVALID, ANJ_CORE_STEP_YIELDED);
+    }
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERING);
+
+    // without limits, everything is done in a single call
+    ADD_RESPONSE(register_response);
+    STEP_BUDGETED(0, ANJ_TIME_DURATION_INVALID, ANJ_CORE_STEP_WAITS_FOR_NET);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERED);
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(
+            timeout, anj_time_duration_new(75, ANJ_TIME_UNIT_S)));
+    ANJ_UNIT_ASSERT_EQUAL(handle.fd, 7);
+    mock.bytes_sent = 0;
+
+    // the time budget is checked after each action
+    mock_time_advance(anj_time_duration_new(76, ANJ_TIME_UNIT_S));
+    STEP_BUDGETED(0, ANJ_TIME_DURATION_ZERO, ANJ_CORE_STEP_YIELDED);
+    anj_core_step_result_t result = ANJ_CORE_STEP_YIELDED;
+    calls = 0;
+    while (result == ANJ_CORE_STEP_YIELDED) {
+        ANJ_UNIT_ASSERT_TRUE(++calls < 10);
+        anj_core_step_budget_t budget = {
+            .max_time = ANJ_TIME_DURATION_ZERO
+        };
+        result = anj_core_step_budgeted(&anj, &budget, &timeout, &handle);
+    }
+    // the call sending the Update reports waiting for the response
+    ANJ_UNIT_ASSERT_EQUAL(result, ANJ_CORE_STEP_WAITS_FOR_NET);
+    COPY_TOKEN_AND_MSG_ID(update, 8);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, update,
+                                      sizeof(update) - 1);
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(timeout,
+                                              anj.exchange_ctx.timeout));
+
+    // nothing happens after a permanent failure until the client is restarted
+    anj.server_state.conn_status = ANJ_CONN_STATUS_FAILURE;
+    STEP_BUDGETED(0, ANJ_TIME_DURATION_INVALID, ANJ_CORE_STEP_WAITS_FOR_APP);
+    ANJ_UNIT_ASSERT_FALSE(anj_time_duration_is_valid(timeout));
+    anj_core_restart(&anj);
+    STEP_BUDGETED(1, ANJ_TIME_DURATION_INVALID, ANJ_CORE_STEP_YIELDED);
+}
+#endif // ANJ_WITH_BUDGETED_STEP
+
+#ifdef ANJ_WITH_SCHEDULER
+static void scheduler_ntp_event_cb(void *arg,
+                                   anj_ntp_t *ntp,
+                                   anj_ntp_status_t status,
+                                   anj_time_real_t synchronized_time) {
+    (void) arg;
+    (void) ntp;
+    (void) status;
+    (void) synchronized_time;
+}
+
+#    define CHECK_SCHEDULER_WAKEUP(Reason, Timeout)                         \
+        do {                                                                \
+            anj_scheduler_wakeup_t wakeup;                                  \
+            anj_scheduler_next_wakeup(&sources, &wakeup);                   \
+            ANJ_UNIT_ASSERT_EQUAL(wakeup.reason, Reason);                   \
+            ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(wakeup.timeout,       \
+                                                      (Timeout)));          \
+        } while (0)
+
+ANJ_UNIT_TEST(registration_session, scheduler_next_wakeup) {
+    EXTENDED_INIT();
+    PROCESS_REGISTRATION();
+
+    anj_ntp_t ntp;
+    anj_ntp_configuration_t ntp_config = {
+        .event_cb = scheduler_ntp_event_cb,
+        .ntp_server_address = "test.ntp.org",
+        .ntp_period_hours = 1
+    };
+    // NTP Object is installed in another instance, so that no Update is sent
+    static anj_t ntp_anj;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_ntp_init(&ntp_anj, &ntp, &ntp_config));
+    anj_scheduler_sources_t sources = {
+        .anj = &anj,
+        .ntp = &ntp
+    };
+    // initial NTP status is reported in the next step
+    CHECK_SCHEDULER_WAKEUP(ANJ_SCHEDULER_REASON_NTP, ANJ_TIME_DURATION_ZERO);
+    anj_ntp_step(&ntp);
+
+    // Update is sent before the NTP synchronization
+    CHECK_SCHEDULER_WAKEUP(ANJ_SCHEDULER_REASON_CORE,
+                           anj_time_duration_new(75, ANJ_TIME_UNIT_S));
+#    ifdef ANJ_NET_WITH_POLL_HANDLE
+    mock.poll_handle_fd = 7;
+    anj_scheduler_wakeup_t wakeup;
+    anj_scheduler_next_wakeup(&sources, &wakeup);
+    ANJ_UNIT_ASSERT_TRUE(wakeup.wait_for_net);
+    ANJ_UNIT_ASSERT_EQUAL(wakeup.net_handle.fd, 7);
+#    endif // ANJ_NET_WITH_POLL_HANDLE
+
+    sources.anj = NULL;
+    CHECK_SCHEDULER_WAKEUP(ANJ_SCHEDULER_REASON_NTP,
+                           anj_time_duration_new(1, ANJ_TIME_UNIT_HOUR));
+    sources.ntp = NULL;
+    anj_scheduler_wakeup_t idle;
+    anj_scheduler_next_wakeup(&sources, &idle);
+    ANJ_UNIT_ASSERT_EQUAL(idle.reason, ANJ_SCHEDULER_REASON_NONE);
+    ANJ_UNIT_ASSERT_FALSE(anj_time_duration_is_valid(idle.timeout));
+
+    // forced state transition is handled right away
+    sources.anj = &anj;
+    anj_core_disable_server(&anj, anj_time_duration_new(30, ANJ_TIME_UNIT_S));
+    CHECK_SCHEDULER_WAKEUP(ANJ_SCHEDULER_REASON_CORE, ANJ_TIME_DURATION_ZERO);
+}
+#endif // ANJ_WITH_SCHEDULER
+
+#ifdef ANJ_WITH_CLIENT_GROUP
+ANJ_UNIT_TEST(registration_session, client_group) {
+    EXTENDED_INIT_WITH_QUEUE_MODE(anj_time_duration_new(50, ANJ_TIME_UNIT_S));
+    PROCESS_REGISTRATION();
+
+    // second instance has no LwM2M Server account and stays disabled
+    static anj_t other_anj;
+    anj_configuration_t other_config = {
+        .endpoint_name = "other"
+    };
+#    ifdef ANJ_WITH_MSG_BUFFER_ARENA
+    static uint8_t other_msg_buffer_arena[ANJ_MSG_BUFFER_ARENA_SIZE];
+    other_config.msg_buffer_arena = other_msg_buffer_arena;
+    other_config.msg_buffer_arena_size = sizeof(other_msg_buffer_arena);
+#    endif // ANJ_WITH_MSG_BUFFER_ARENA
+    ANJ_UNIT_ASSERT_SUCCESS(anj_core_init(&other_anj, &other_config));
+    anj_core_disable_server(&other_anj,
+                            anj_time_duration_new(100, ANJ_TIME_UNIT_S));
+    anj_core_step(&other_anj);
+
+    anj_t *const clients[] = { &anj, &other_anj };
+    anj_client_group_t group;
+    anj_client_group_init(&group, clients, 2);
+
+    // Object is rolled back if it cannot be added to all instances
+    anj_dm_obj_t obj = {
+        .oid = 9900
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_add_obj(&other_anj, &obj));
+    ANJ_UNIT_ASSERT_FAILED(anj_client_group_add_obj(&group, &obj));
+    ANJ_UNIT_ASSERT_FAILED(anj_dm_remove_obj(&anj, obj.oid));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_remove_obj(&other_anj, obj.oid));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_client_group_add_obj(&group, &obj));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_remove_obj(&anj, obj.oid));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_remove_obj(&other_anj, obj.oid));
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+
+    // client enters queue mode after 50 seconds
+    mock_time_advance(anj_time_duration_new(51, ANJ_TIME_UNIT_S));
+    anj_client_group_step(&group);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_QUEUE_MODE);
+    ANJ_UNIT_ASSERT_EQUAL(group.next_client, 1);
+
+    // Update in 5 seconds, other instance is enabled again in 30 seconds
+    mock_time_advance(anj_time_duration_new(19, ANJ_TIME_UNIT_S));
+    ANJ_UNIT_ASSERT_TRUE(
+            anj_time_duration_eq(anj_client_group_next_step_time(&group),
+                                 anj_time_duration_new(5, ANJ_TIME_UNIT_S)));
+    anj_client_group_step(&group);
+    ANJ_UNIT_ASSERT_EQUAL(group.next_client, 0);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+
+    // change is forwarded to all instances
+    ser_obj.server_instance.lifetime = 100;
+    anj_client_group_data_model_changed(&group,
+                                        &ANJ_MAKE_RESOURCE_PATH(1, 1, 1),
+                                        ANJ_CORE_CHANGE_TYPE_VALUE_CHANGED);
+    ANJ_UNIT_ASSERT_TRUE(
+            anj.server_state.details.registered.update_with_lifetime);
+}
+#endif // ANJ_WITH_CLIENT_GROUP
+
+#ifdef ANJ_DM_WITH_CHANGE_QUEUE
+ANJ_UNIT_TEST(registration_session, data_model_changed_async) {
+    EXTENDED_INIT();
+    PROCESS_REGISTRATION();
+
+    // lifetime changed - change is handled in the next anj_core_step()
+    ser_obj.server_instance.lifetime = 100;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_core_data_model_changed_async(
+            &anj, &ANJ_MAKE_RESOURCE_PATH(1, 1, 1),
+            ANJ_CORE_CHANGE_TYPE_VALUE_CHANGED));
+    ANJ_UNIT_ASSERT_FALSE(
+            anj.server_state.details.registered.update_with_lifetime);
+    ANJ_UNIT_ASSERT_TRUE(_anj_dm_change_queue_pending(&anj.dm_change_queue));
+    HANDLE_UPDATE(update_with_lifetime);
+    ANJ_UNIT_ASSERT_FALSE(_anj_dm_change_queue_pending(&anj.dm_change_queue));
+
+    // queue is full until it is drained, then it can be filled again
+    for (int lap = 0; lap < 3; lap++) {
+        for (int i = 0; i < ANJ_DM_CHANGE_QUEUE_SIZE; i++) {
+            ANJ_UNIT_ASSERT_SUCCESS(anj_core_data_model_changed_async(
+                    &anj, &ANJ_MAKE_RESOURCE_PATH(1, 1, 2),
+                    ANJ_CORE_CHANGE_TYPE_VALUE_CHANGED));
+        }
+        ANJ_UNIT_ASSERT_FAILED(anj_core_data_model_changed_async(
+                &anj, &ANJ_MAKE_RESOURCE_PATH(1, 1, 2),
+                ANJ_CORE_CHANGE_TYPE_VALUE_CHANGED));
+        anj_core_step(&anj);
+        ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+        ANJ_UNIT_ASSERT_FALSE(
+                _anj_dm_change_queue_pending(&anj.dm_change_queue));
+    }
+}
+#endif // ANJ_DM_WITH_CHANGE_QUEUE
+
+#ifdef ANJ_WITH_MSG_BUFFER_POOL
+ANJ_UNIT_TEST(registration_session, msg_buffer_pool) {
+    EXTENDED_INIT();
+    ANJ_UNIT_ASSERT_NULL(anj.in_buffer);
+    ANJ_UNIT_ASSERT_NULL(anj.payload_buffer);
+
+    // pool exhausted - nothing is done and input/output buffer is given back
+    uint8_t *free_payload = msg_buffer_pool.free_payload;
+    msg_buffer_pool.free_payload = NULL;
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+    ANJ_UNIT_ASSERT_NULL(anj.in_buffer);
+    ANJ_UNIT_ASSERT_NOT_NULL(msg_buffer_pool.free_scratch);
+    msg_buffer_pool.free_payload = free_payload;
+
+    // payload buffer is held until the response is received
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_NOT_EQUAL(mock.bytes_sent, 0);
+    ANJ_UNIT_ASSERT_NULL(anj.in_buffer);
+    ANJ_UNIT_ASSERT_TRUE(anj.payload_buffer == free_payload);
+    ANJ_UNIT_ASSERT_NULL(msg_buffer_pool.free_payload);
+    ADD_RESPONSE(register_response);
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERED);
+    ANJ_UNIT_ASSERT_NULL(anj.in_buffer);
+    ANJ_UNIT_ASSERT_NULL(anj.payload_buffer);
+    mock.bytes_sent = 0;
+
+    // input/output buffer is held until the message is sent
+    uint8_t *free_scratch = msg_buffer_pool.free_scratch;
+    anj_core_request_update(&anj);
+    mock.call_result[ANJ_NET_FUN_SEND] = ANJ_NET_EINPROGRESS;
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+    ANJ_UNIT_ASSERT_TRUE(anj.in_buffer == free_scratch);
+    ANJ_UNIT_ASSERT_NULL(msg_buffer_pool.free_scratch);
+    mock.call_result[ANJ_NET_FUN_SEND] = 0;
+    anj_core_step(&anj);
+    COPY_TOKEN_AND_MSG_ID(update, 8);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, update,
+                                      sizeof(update) - 1);
+    ANJ_UNIT_ASSERT_NULL(anj.in_buffer);
+    ANJ_UNIT_ASSERT_NOT_NULL(anj.payload_buffer);
+    ADD_RESPONSE(update_response);
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_NULL(anj.payload_buffer);
+
+    // all buffers are given back on shutdown
+    anj_core_request_update(&anj);
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_NOT_NULL(anj.payload_buffer);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_core_shutdown(&anj));
+    ANJ_UNIT_ASSERT_NOT_NULL(msg_buffer_pool.free_scratch);
+    ANJ_UNIT_ASSERT_NOT_NULL(msg_buffer_pool.free_payload);
+}
+
+ANJ_UNIT_TEST(registration_session, msg_buffer_pool_init) {
+    anj_msg_buffer_pool_t pool;
+    ANJ_UNIT_ASSERT_FAILED(anj_msg_buffer_pool_init(
+            &pool, msg_buffer_pool_memory, sizeof(msg_buffer_pool_memory) - 1,
+            1, 1));
+    ANJ_UNIT_ASSERT_FAILED(anj_msg_buffer_pool_init(
+            &pool, msg_buffer_pool_memory, sizeof(msg_buffer_pool_memory), 0,
+            1));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_msg_buffer_pool_init(
+            &pool, msg_buffer_pool_memory, sizeof(msg_buffer_pool_memory), 1,
+            1));
+    ANJ_UNIT_ASSERT_TRUE(pool.free_scratch == msg_buffer_pool_memory);
+    ANJ_UNIT_ASSERT_TRUE(pool.free_payload
+                         == msg_buffer_pool_memory
+                                    + _ANJ_MSG_BUFFER_ARENA_IN_OUT_SIZE);
+
+    anj_t anj;
+    anj_configuration_t config = {
+        .endpoint_name = "name",
+        .msg_buffer_arena = msg_buffer_arena,
+        .msg_buffer_arena_size = sizeof(msg_buffer_arena)
+    };
+    ANJ_UNIT_ASSERT_FAILED(anj_core_init(&anj, &config));
+}
+#endif // ANJ_WITH_MSG_BUFFER_POOL
+
+ANJ_UNIT_TEST(registration_session, queue_mode_force_update) {
+    // lifetime is set to 150 so next update should be sent after 75 seconds
+    // queue mode timeout is 50 seconds so after 50 seconds queue mode should be
+    // started
+    EXTENDED_INIT_WITH_QUEUE_MODE(anj_time_duration_new(50, ANJ_TIME_UNIT_S));
+    PROCESS_REGISTRATION();
+
+    mock_time_advance(anj_time_duration_new(55, ANJ_TIME_UNIT_S));
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_QUEUE_MODE);
+    ANJ_UNIT_ASSERT_TRUE(
+            anj_time_duration_eq(anj_core_next_step_time(&anj),
+                                 anj_time_duration_new(20, ANJ_TIME_UNIT_S)));
+    anj_core_request_update(&anj);
+    HANDLE_UPDATE(update);
+}
+
+#ifdef ANJ_WITH_SMS_TRIGGER
+ANJ_UNIT_TEST(registration_session, queue_mode_sms_trigger) {
+    EXTENDED_INIT_WITH_QUEUE_MODE(anj_time_duration_new(50, ANJ_TIME_UNIT_S));
+    PROCESS_REGISTRATION();
+
+    mock_time_advance(anj_time_duration_new(55, ANJ_TIME_UNIT_S));
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_QUEUE_MODE);
+    // trigger for another LwM2M Server is ignored
+    net_api_mock_sms_trigger(anj.server_instance.ssid + 1);
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_QUEUE_MODE);
+    net_api_mock_sms_trigger(anj.server_instance.ssid);
+    HANDLE_UPDATE(update);
+}
+#endif // ANJ_WITH_SMS_TRIGGER
+
+#ifdef ANJ_WITH_QUEUE_MODE_WAKE_WINDOW
+ANJ_UNIT_TEST(registration_session, queue_mode_wake_window) {
+    EXTENDED_INIT_WITH_QUEUE_MODE(anj_time_duration_new(50, ANJ_TIME_UNIT_S));
+    anj.queue_mode_wake_window = anj_time_duration_new(20, ANJ_TIME_UNIT_S);
+    PROCESS_REGISTRATION();
+
+    // queue mode timeout expired, but Update is planned in 20 seconds so the
+    // client stays online
+    mock_time_advance(anj_time_duration_new(55, ANJ_TIME_UNIT_S));
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERED);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+    ANJ_UNIT_ASSERT_TRUE(anj_time_monotonic_eq(
+            anj.server_state.details.registered.queue_start_time,
+            anj.server_state.details.registered.next_update_time));
+
+    mock_time_advance(anj_time_duration_new(21, ANJ_TIME_UNIT_S));
+    HANDLE_UPDATE(update);
+
+    // next Update is planned in 24 seconds, outside of the wake window
+    mock_time_advance(anj_time_duration_new(51, ANJ_TIME_UNIT_S));
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_QUEUE_MODE);
+}
+#endif // ANJ_WITH_QUEUE_MODE_WAKE_WINDOW
+
+#ifdef ANJ_WITH_UPDATE_HOLD_DOWN
+static char update_with_new_objects[] =
+        "\x48"                             // Confirmable, tkl 8
+        "\x02\x00\x00"                     // POST, msg_id
+        "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF" // token
+        "\xb2\x72\x64"                     // uri path /rd
+        "\x04\x35\x61\x33\x66"             // uri path /5a3f
+        "\x11\x28" // content_format: application/link-format
+        "\xFF"
+        "</1>;ver=1.2,</1/1>,</9900>,</9901>";
+
+ANJ_UNIT_TEST(registration_session, update_hold_down) {
+    EXTENDED_INIT();
+    anj.update_hold_down = anj_time_duration_new(5, ANJ_TIME_UNIT_S);
+    PROCESS_REGISTRATION();
+
+    // the trigger opens the window, nothing is sent until it ends
+    anj_core_request_update(&anj);
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+    anj_dm_obj_t obj_1 = {
+        .oid = 9900
+    };
+    anj_dm_obj_t obj_2 = {
+        .oid = 9901
+    };
+    mock_time_advance(anj_time_duration_new(2, ANJ_TIME_UNIT_S));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_add_obj(&anj, &obj_1));
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+    mock_time_advance(anj_time_duration_new(2, ANJ_TIME_UNIT_S));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_add_obj(&anj, &obj_2));
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
 
-    // read request extend queue mode time
-    ADD_REQUEST(read_request);
-    anj_core_step(&anj);
-    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
-                          ANJ_CONN_STATUS_REGISTERED);
-    CHECK_RESPONSE(read_response);
-    ANJ_UNIT_ASSERT_TRUE(anj_time_monotonic_eq(
-            anj.server_state.details.registered.queue_start_time,
-            anj_time_monotonic_add(anj_time_monotonic_now(),
-                                   anj_time_duration_new(50,
-                                                         ANJ_TIME_UNIT_S))));
+    // a single Update carries both changes
+    mock_time_advance(anj_time_duration_new(1, ANJ_TIME_UNIT_S));
+    HANDLE_UPDATE(update_with_new_objects);
 
-    // another queue_rx_off() is successful - queue mode is started immediately
-    mock_time_advance(anj_time_duration_new(51, ANJ_TIME_UNIT_S));
+    // the next trigger opens a new window
+    anj_core_server_obj_registration_update_trigger_executed(&anj);
     anj_core_step(&anj);
-    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
-                          ANJ_CONN_STATUS_QUEUE_MODE);
-    // next anj_core_step() is called with big delay, but still everything is ok
-    // and update is sent
-    mock_time_advance(anj_time_duration_new(3000, ANJ_TIME_UNIT_S));
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+    mock_time_advance(anj_time_duration_new(5, ANJ_TIME_UNIT_S));
     HANDLE_UPDATE(update);
 }
 
-ANJ_UNIT_TEST(registration_session, queue_mode_force_update) {
-    // lifetime is set to 150 so next update should be sent after 75 seconds
-    // queue mode timeout is 50 seconds so after 50 seconds queue mode should be
-    // started
-    EXTENDED_INIT_WITH_QUEUE_MODE(anj_time_duration_new(50, ANJ_TIME_UNIT_S));
+ANJ_UNIT_TEST(registration_session, update_hold_down_periodic_update) {
+    EXTENDED_INIT();
+    anj.update_hold_down = anj_time_duration_new(10, ANJ_TIME_UNIT_S);
     PROCESS_REGISTRATION();
 
-    mock_time_advance(anj_time_duration_new(55, ANJ_TIME_UNIT_S));
-    anj_core_step(&anj);
-    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
-                          ANJ_CONN_STATUS_QUEUE_MODE);
-    ANJ_UNIT_ASSERT_TRUE(
-            anj_time_duration_eq(anj_core_next_step_time(&anj),
-                                 anj_time_duration_new(20, ANJ_TIME_UNIT_S)));
+    // periodic Update is due in 75 seconds, before the window ends
+    mock_time_advance(anj_time_duration_new(70, ANJ_TIME_UNIT_S));
     anj_core_request_update(&anj);
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+    mock_time_advance(anj_time_duration_new(6, ANJ_TIME_UNIT_S));
     HANDLE_UPDATE(update);
+
+    // nothing is held back anymore
+    mock_time_advance(anj_time_duration_new(10, ANJ_TIME_UNIT_S));
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
 }
+#endif // ANJ_WITH_UPDATE_HOLD_DOWN
 
 ANJ_UNIT_TEST(registration_session, queue_mode_notifications) {
     TEST_INIT_WITH_QUEUE_MODE(anj_time_duration_new(50, ANJ_TIME_UNIT_S));
@@ -1087,6 +2401,75 @@ ANJ_UNIT_TEST(registration_session, queue_mode_notifications) {
     HANDLE_UPDATE(update);
 }
 
+#ifdef ANJ_WITH_NEXT_STEP_TIME_CACHE
+ANJ_UNIT_TEST(registration_session, queue_mode_next_notification_cache) {
+    TEST_INIT_WITH_QUEUE_MODE(anj_time_duration_new(50, ANJ_TIME_UNIT_S));
+    INIT_BASIC_INSTANCES();
+    ser_inst.lifetime = 300;
+    ser_inst.disable_timeout = 800;
+    ADD_INSTANCES();
+    PROCESS_REGISTRATION();
+
+    ADD_REQUEST(observe_request);
+#    ifndef ANJ_WITH_LWM2M12
+    anj.observe_ctx.attributes_storage[0].ssid = 2;
+    anj.observe_ctx.attributes_storage[0].path =
+            ANJ_MAKE_RESOURCE_PATH(1, 1, 5);
+    anj.observe_ctx.attributes_storage[0].attr.has_min_period = true;
+    anj.observe_ctx.attributes_storage[0].attr.min_period = 100;
+    anj.observe_ctx.attributes_storage[0].attr.has_max_period = true;
+    anj.observe_ctx.attributes_storage[0].attr.max_period = 300;
+#    endif // ANJ_WITH_LWM2M12
+    anj_core_step(&anj);
+    CHECK_RESPONSE(observe_response);
+    ANJ_UNIT_ASSERT_FALSE(anj.next_notification_cache.valid);
+
+    mock_time_advance(anj_time_duration_new(60, ANJ_TIME_UNIT_S));
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_QUEUE_MODE);
+    // the time of the next notification (pmax) is kept, Update goes first
+    ANJ_UNIT_ASSERT_TRUE(anj.next_notification_cache.valid);
+    anj_time_monotonic_t calculated_at =
+            anj.next_notification_cache.calculated_at;
+    ANJ_UNIT_ASSERT_TRUE(anj_time_monotonic_eq(
+            anj.next_notification_cache.notification_time,
+            anj_time_monotonic_add(calculated_at,
+                                   anj_time_duration_new(300 - 60,
+                                                         ANJ_TIME_UNIT_S))));
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(
+            anj_core_next_step_time(&anj),
+            anj_time_duration_new(207 - 60, ANJ_TIME_UNIT_S)));
+    mock_time_advance(anj_time_duration_new(10, ANJ_TIME_UNIT_S));
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(
+            anj_core_next_step_time(&anj),
+            anj_time_duration_new(207 - 70, ANJ_TIME_UNIT_S)));
+    ANJ_UNIT_ASSERT_TRUE(anj_time_monotonic_eq(
+            anj.next_notification_cache.calculated_at, calculated_at));
+
+    // change of the value brings the notification closer (pmin)
+    ser_obj.server_instance.disable_timeout = 200;
+    anj_core_data_model_changed(&anj,
+                                &ANJ_MAKE_RESOURCE_PATH(1, 1, 5),
+                                ANJ_CORE_CHANGE_TYPE_VALUE_CHANGED);
+    ANJ_UNIT_ASSERT_FALSE(anj.next_notification_cache.valid);
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(
+            anj_core_next_step_time(&anj),
+            anj_time_duration_new(100 - 70, ANJ_TIME_UNIT_S)));
+    ANJ_UNIT_ASSERT_TRUE(anj.next_notification_cache.valid);
+
+    mock_time_advance(anj_time_duration_new(30, ANJ_TIME_UNIT_S));
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(anj_core_next_step_time(&anj),
+                                              ANJ_TIME_DURATION_ZERO));
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERED);
+    CHECK_NOTIFY(notification);
+    ANJ_UNIT_ASSERT_FALSE(anj.next_notification_cache.valid);
+}
+#endif // ANJ_WITH_NEXT_STEP_TIME_CACHE
+
 static char observe_request_no_attributes[] =
         "\x42"         // header v 0x01, Confirmable, tkl 8
         "\x01\x11\x21" // GET code 0.1
@@ -1149,10 +2532,17 @@ ANJ_UNIT_TEST(registration_session, queue_mode_send_error) {
     // send error leads to reregistration
     net_api_mock_force_send_failure();
     anj_core_step(&anj);
+#ifdef ANJ_WITH_NAT_REBINDING_RECOVERY
+    // unless the connection is set up again, see nat_rebinding_recovery
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERED);
+    HANDLE_UPDATE(update);
+#else  // ANJ_WITH_NAT_REBINDING_RECOVERY
     ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
                           ANJ_CONN_STATUS_REGISTERING);
     ANJ_UNIT_ASSERT_EQUAL(g_conn_status, ANJ_CONN_STATUS_REGISTERING);
     PROCESS_REGISTRATION();
+#endif // ANJ_WITH_NAT_REBINDING_RECOVERY
     ANJ_UNIT_ASSERT_EQUAL(g_conn_status, ANJ_CONN_STATUS_REGISTERED);
 }
 
@@ -1209,6 +2599,125 @@ ANJ_UNIT_TEST(registration_session, queue_mode_entering_queue_mode_error) {
     PROCESS_REGISTRATION();
 }
 
+#ifdef ANJ_NET_WITH_RELEASE_ASSISTANCE
+ANJ_UNIT_TEST(registration_session, release_assistance_deregister) {
+    EXTENDED_INIT();
+    PROCESS_REGISTRATION();
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_RELEASE_ASSISTANCE], 0);
+
+    // the hint refers to the Deregister request, sent right after it
+    int send_count = mock.call_count[ANJ_NET_FUN_SEND];
+    anj_core_disable_server(&anj, anj_time_duration_new(5, ANJ_TIME_UNIT_S));
+    HANDLE_DEREGISTER(deregister_response);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_RELEASE_ASSISTANCE], 1);
+    ANJ_UNIT_ASSERT_EQUAL(mock.release_hint, ANJ_NET_RELEASE_HINT_LAST_UPLINK);
+    ANJ_UNIT_ASSERT_EQUAL(mock.release_hint_send_count, send_count);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_SEND], send_count + 1);
+}
+
+ANJ_UNIT_TEST(registration_session, release_assistance_queue_mode) {
+    EXTENDED_INIT_WITH_QUEUE_MODE(anj_time_duration_new(50, ANJ_TIME_UNIT_S));
+    PROCESS_REGISTRATION();
+
+    mock_time_advance(anj_time_duration_new(55, ANJ_TIME_UNIT_S));
+    mock.call_result[ANJ_NET_FUN_QUEUE_MODE_RX_OFF] = ANJ_NET_EINPROGRESS;
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_ENTERING_QUEUE_MODE);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_RELEASE_ASSISTANCE], 0);
+
+    // the hint is given once RX is off, its errors are ignored
+    mock.call_result[ANJ_NET_FUN_QUEUE_MODE_RX_OFF] = 0;
+    mock.call_result[ANJ_NET_FUN_RELEASE_ASSISTANCE] = -888;
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_QUEUE_MODE);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_RELEASE_ASSISTANCE], 1);
+    ANJ_UNIT_ASSERT_EQUAL(mock.release_hint,
+                          ANJ_NET_RELEASE_HINT_NO_MORE_DATA);
+}
+#endif // ANJ_NET_WITH_RELEASE_ASSISTANCE
+
+#ifdef ANJ_WITH_NAT_REBINDING_RECOVERY
+static char update_not_found_response[] =
+        "\x68"                             // header v 0x01, Ack, tkl 8
+        "\x84\x00\x00"                     // Not Found code 4.04
+        "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF"; // token
+
+#    define LOSE_CONNECTION_AFTER_QUEUE_MODE()                        \
+        mock_time_advance(anj_time_duration_new(55, ANJ_TIME_UNIT_S)); \
+        anj_core_step(&anj);                                           \
+        ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,            \
+                              ANJ_CONN_STATUS_QUEUE_MODE);             \
+        mock_time_advance(anj_time_duration_new(25, ANJ_TIME_UNIT_S)); \
+        net_api_mock_force_send_failure();                             \
+        anj_core_step(&anj)
+
+ANJ_UNIT_TEST(registration_session, nat_rebinding_recovery) {
+    EXTENDED_INIT_WITH_QUEUE_MODE(anj_time_duration_new(50, ANJ_TIME_UNIT_S));
+    PROCESS_REGISTRATION();
+    int close_count = mock.call_count[ANJ_NET_FUN_CLOSE];
+    int connect_count = mock.call_count[ANJ_NET_FUN_CONNECT];
+
+    // Update after queue mode fails, the connection is set up again and the
+    // Update is sent over it instead of a Register
+    LOSE_CONNECTION_AFTER_QUEUE_MODE();
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERED);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_CLOSE], close_count + 1);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_CONNECT],
+                          connect_count + 1);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_CLEANUP], 0);
+    HANDLE_UPDATE(update);
+
+    // successful exchange allows another recovery
+    LOSE_CONNECTION_AFTER_QUEUE_MODE();
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERED);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_CONNECT],
+                          connect_count + 2);
+    HANDLE_UPDATE(update);
+}
+
+ANJ_UNIT_TEST(registration_session, nat_rebinding_recovery_not_found) {
+    EXTENDED_INIT_WITH_QUEUE_MODE(anj_time_duration_new(50, ANJ_TIME_UNIT_S));
+    PROCESS_REGISTRATION();
+
+    LOSE_CONNECTION_AFTER_QUEUE_MODE();
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERED);
+    anj_core_step(&anj);
+    COPY_TOKEN_AND_MSG_ID(update, 8);
+    ANJ_UNIT_ASSERT_EQUAL(sizeof(update) - 1, mock.bytes_sent);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, update,
+                                      mock.bytes_sent);
+    // server doesn't know the registration anymore
+    ADD_RESPONSE(update_not_found_response);
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERING);
+    PROCESS_REGISTRATION();
+}
+
+ANJ_UNIT_TEST(registration_session, nat_rebinding_recovery_failed) {
+    EXTENDED_INIT_WITH_QUEUE_MODE(anj_time_duration_new(50, ANJ_TIME_UNIT_S));
+    PROCESS_REGISTRATION();
+
+    LOSE_CONNECTION_AFTER_QUEUE_MODE();
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERED);
+    // Update sent over the new connection fails as well
+    mock.bytes_to_send = 0;
+    mock.call_result[ANJ_NET_FUN_RECV] = -14;
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERING);
+    mock.call_result[ANJ_NET_FUN_RECV] = 0;
+    mock.bytes_to_send = 100;
+    PROCESS_REGISTRATION();
+}
+#endif // ANJ_WITH_NAT_REBINDING_RECOVERY
+
 static char bootstrap_request_trigger[] = "\x42" // header v 0x01, Confirmable
                                           "\x02\x11\x55" // POST code 0.2
                                           "\x12\x77"     // token
@@ -1298,6 +2807,38 @@ ANJ_UNIT_TEST(registration_session, restart) {
     ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_CLEANUP], 1);
 }
 
+#ifdef ANJ_WITH_WARM_RESTART
+ANJ_UNIT_TEST(registration_session, warm_restart) {
+    EXTENDED_INIT();
+    PROCESS_REGISTRATION();
+    anj_core_restart_warm(&anj);
+    ANJ_UNIT_ASSERT_FALSE(anj.server_state.restart_triggered);
+#    ifdef ANJ_DM_WITH_LINK_SET_HASH
+    // the list of Objects is the same as in the last Register
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+#    else  // ANJ_DM_WITH_LINK_SET_HASH
+    HANDLE_UPDATE(update_with_data_model);
+#    endif // ANJ_DM_WITH_LINK_SET_HASH
+#    ifdef ANJ_WITH_SERVER_DATA_CACHE
+    ANJ_UNIT_ASSERT_TRUE(anj.server_instance.dm_data_cached);
+#    endif // ANJ_WITH_SERVER_DATA_CACHE
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_CONNECT], 1);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_CLEANUP], 0);
+
+    // other server, full restart is needed
+    strcpy(sec_obj.security_instances[0].server_uri,
+           "coap://other-server.com:5683");
+    anj_core_restart_warm(&anj);
+    HANDLE_DEREGISTER_WITH_REGISTRATION();
+    mock.call_result[ANJ_NET_FUN_CONNECT] = 0;
+    PROCESS_REGISTRATION();
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_CLEANUP], 1);
+    ANJ_UNIT_ASSERT_EQUAL_STRING(anj.security_instance.server_uri,
+                                 "other-server.com");
+}
+#endif // ANJ_WITH_WARM_RESTART
+
 ANJ_UNIT_TEST(registration_session, restart_from_queue_mode) {
     EXTENDED_INIT_WITH_QUEUE_MODE(anj_time_duration_new(50, ANJ_TIME_UNIT_S));
     PROCESS_REGISTRATION();
@@ -1495,6 +3036,83 @@ ANJ_UNIT_TEST(registration_session, CoAP_ping) {
                           ANJ_CONN_STATUS_REGISTERED);
 }
 
+#ifdef ANJ_WITH_NAT_KEEPALIVE_PROBING
+#    define SET_NAT_KEEPALIVE_BOUNDS(Min, Max)                       \
+        anj.nat.min = anj_time_duration_new(Min, ANJ_TIME_UNIT_S); \
+        anj.nat.max = anj_time_duration_new(Max, ANJ_TIME_UNIT_S); \
+        anj.nat.confirmed = anj.nat.min;                           \
+        anj.nat.lost = anj.nat.max
+
+ANJ_UNIT_TEST(registration_session, nat_keepalive) {
+    EXTENDED_INIT();
+    SET_NAT_KEEPALIVE_BOUNDS(10, 50);
+    PROCESS_REGISTRATION();
+
+    // middle of the unknown range is probed, long before the periodic Update
+    mock_time_advance(anj_time_duration_new(29, ANJ_TIME_UNIT_S));
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+    mock_time_advance(anj_time_duration_new(2, ANJ_TIME_UNIT_S));
+    HANDLE_UPDATE(update);
+
+    // request of the server confirms the idle time before it
+    mock_time_advance(anj_time_duration_new(25, ANJ_TIME_UNIT_S));
+    ADD_REQUEST(CoAP_PING);
+    anj_core_step(&anj);
+    CHECK_RESPONSE(RST_response);
+    mock.bytes_sent = 0;
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(
+            anj.nat.confirmed, anj_time_duration_new(25, ANJ_TIME_UNIT_S)));
+
+    // keep-alive after 37.5 seconds is lost
+    mock_time_advance(anj_time_duration_new(37, ANJ_TIME_UNIT_S));
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+    mock_time_advance(anj_time_duration_new(1, ANJ_TIME_UNIT_S));
+    net_api_mock_force_send_failure();
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(
+            anj.nat.lost, anj_time_duration_new(38, ANJ_TIME_UNIT_S)));
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(
+            anj.nat.confirmed, anj_time_duration_new(25, ANJ_TIME_UNIT_S)));
+}
+
+ANJ_UNIT_TEST(registration_session, nat_keepalive_restart) {
+    EXTENDED_INIT();
+    SET_NAT_KEEPALIVE_BOUNDS(10, 50);
+    anj.nat.confirmed = anj_time_duration_new(40, ANJ_TIME_UNIT_S);
+    PROCESS_REGISTRATION();
+
+    // binding is lost earlier than confirmed, e.g. after a network change
+    mock_time_advance(anj_time_duration_new(35, ANJ_TIME_UNIT_S));
+    anj_core_request_update(&anj);
+    net_api_mock_force_send_failure();
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(
+            anj.nat.lost, anj_time_duration_new(35, ANJ_TIME_UNIT_S)));
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(
+            anj.nat.confirmed, anj_time_duration_new(10, ANJ_TIME_UNIT_S)));
+}
+
+ANJ_UNIT_TEST(registration_session, nat_keepalive_queue_mode) {
+    EXTENDED_INIT_WITH_QUEUE_MODE(anj_time_duration_new(50, ANJ_TIME_UNIT_S));
+    SET_NAT_KEEPALIVE_BOUNDS(10, 50);
+    PROCESS_REGISTRATION();
+
+    // client goes offline once the binding may be gone, instead of sending
+    // keep-alive Updates
+    mock_time_advance(anj_time_duration_new(29, ANJ_TIME_UNIT_S));
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERED);
+    mock_time_advance(anj_time_duration_new(2, ANJ_TIME_UNIT_S));
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_QUEUE_MODE);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+}
+#endif // ANJ_WITH_NAT_KEEPALIVE_PROBING
+
 static char write_mute_send_enable_request[] =
         "\x42"         // header v 0x01, Confirmable, TKL=2
         "\x02\x47\x26" // POST code 0.2, MID 0x4726
@@ -1647,8 +3265,13 @@ ANJ_UNIT_TEST(registration_session, retransmission_non_latest_execute) {
 
     ADD_REQUEST(execute_request);
     anj_core_step(&anj);
+#ifdef ANJ_CACHE_WITH_FULL_ENTRIES
+    // cached response is sent again
+    CHECK_RESPONSE(execute_ack_response);
+#else // ANJ_CACHE_WITH_FULL_ENTRIES
     // no response
     ASSERT_EQ(mock.bytes_sent, 0);
+#endif // ANJ_CACHE_WITH_FULL_ENTRIES
     ASSERT_EQ(g_reboot_execute_counter, 1);
 }
 
@@ -1687,8 +3310,13 @@ ANJ_UNIT_TEST(registration_session, retransmission_non_latest_write) {
 
     ADD_REQUEST(write_mute_send_disable_request);
     anj_core_step(&anj);
+#ifdef ANJ_CACHE_WITH_FULL_ENTRIES
+    // cached response is sent again
+    CHECK_RESPONSE(write_mute_send_enable_response);
+#else // ANJ_CACHE_WITH_FULL_ENTRIES
     // no response
     ASSERT_EQ(mock.bytes_sent, 0);
+#endif // ANJ_CACHE_WITH_FULL_ENTRIES
     // Mute Send stays enabled, as for first request
     ASSERT_TRUE(anj.server_instance.mute_send);
 }
@@ -2153,11 +3781,18 @@ ANJ_UNIT_TEST(registration_session, retransmission_write_block) {
     mock.bytes_sent = 0;
     memset(mock.send_data_buffer, 0, 100);
 
-    // retransmission of first block, no response since it is not latest cached
-    // one
     ADD_REQUEST(block_write_request_1);
     anj_core_step(&anj);
+#ifdef ANJ_CACHE_WITH_FULL_ENTRIES
+    // retransmission of first block, response is still cached
+    CHECK_RESPONSE(write_response_1);
+    mock.bytes_sent = 0;
+    memset(mock.send_data_buffer, 0, 100);
+#else // ANJ_CACHE_WITH_FULL_ENTRIES
+    // retransmission of first block, no response since it is not latest cached
+    // one
     ASSERT_EQ(mock.bytes_sent, 0);
+#endif // ANJ_CACHE_WITH_FULL_ENTRIES
 
     // retransmission of second block
     ADD_REQUEST(block_write_request_2);
@@ -2182,3 +3817,44 @@ ANJ_UNIT_TEST(registration_session, retransmission_write_block) {
 
     ANJ_UNIT_ASSERT_FALSE(_anj_exchange_ongoing_exchange(&anj.exchange_ctx));
 }
+
+#ifdef ANJ_WITH_STEP_TIME_CACHE
+ANJ_UNIT_TEST(registration_session, step_time_cache) {
+    EXTENDED_INIT();
+    PROCESS_REGISTRATION();
+
+    // sending the Update and scheduling its retransmission reads the clock
+    // only once
+    anj_core_server_obj_registration_update_trigger_executed(&anj);
+#    ifdef ANJ_WITH_TRACE
+    // each trace event is timestamped separately
+    anj.trace.count = 0;
+#    endif // ANJ_WITH_TRACE
+    size_t clock_reads = mock_time_monotonic_now_calls();
+    anj_core_step(&anj);
+#    ifdef ANJ_WITH_TRACE
+    clock_reads += anj.trace.count;
+#    endif // ANJ_WITH_TRACE
+    ANJ_UNIT_ASSERT_EQUAL(mock_time_monotonic_now_calls(), clock_reads + 1);
+    COPY_TOKEN_AND_MSG_ID(update, 8);
+    ANJ_UNIT_ASSERT_EQUAL(sizeof(update) - 1, mock.bytes_sent);
+    ANJ_UNIT_ASSERT_FALSE(anj.step_time.valid);
+    mock.bytes_sent = 0;
+
+    // time cached in the previous step is not reused
+    mock_time_advance(anj_time_duration_new(12, ANJ_TIME_UNIT_S));
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(sizeof(update) - 1, mock.bytes_sent);
+    mock.bytes_sent = 0;
+    ADD_RESPONSE(update_response);
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERED);
+
+    // outside of anj_core_step() the clock is read on every call
+    clock_reads = mock_time_monotonic_now_calls();
+    anj_core_next_step_time(&anj);
+    anj_core_next_step_time(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(mock_time_monotonic_now_calls(), clock_reads + 2);
+}
+#endif // ANJ_WITH_STEP_TIME_CACHE
@@ -25,6 +25,26 @@
 
 #include <anj_unit_test.h>
 
+#ifdef ANJ_WITH_MSG_BUFFER_POOL
+static uint8_t msg_buffer_arena[ANJ_MSG_BUFFER_ARENA_SIZE];
+static uint8_t msg_buffer_pool_memory[ANJ_MSG_BUFFER_POOL_SIZE(1, 1)];
+static anj_msg_buffer_pool_t msg_buffer_pool;
+#    define SET_MSG_BUFFER_ARENA(Config)                           \
+        (Config).msg_buffer_arena = msg_buffer_arena;              \
+        (Config).msg_buffer_arena_size = sizeof(msg_buffer_arena); \
+        ANJ_UNIT_ASSERT_SUCCESS(anj_msg_buffer_pool_init(          \
+                &msg_buffer_pool, msg_buffer_pool_memory,          \
+                sizeof(msg_buffer_pool_memory), 1, 1));            \
+        (Config).msg_buffer_pool = &msg_buffer_pool
+#elif defined(ANJ_WITH_MSG_BUFFER_ARENA)
+static uint8_t msg_buffer_arena[ANJ_MSG_BUFFER_ARENA_SIZE];
+#    define SET_MSG_BUFFER_ARENA(Config)              \
+        (Config).msg_buffer_arena = msg_buffer_arena; \
+        (Config).msg_buffer_arena_size = sizeof(msg_buffer_arena)
+#else // ANJ_WITH_MSG_BUFFER_ARENA
+#    define SET_MSG_BUFFER_ARENA(Config) (void) 0
+#endif // ANJ_WITH_MSG_BUFFER_ARENA
+
 #define TEST_INIT()                                        \
     mock_time_reset();                                     \
     net_api_mock_t mock = { 0 };                           \
@@ -34,6 +54,7 @@
     anj_configuration_t config = {                         \
         .endpoint_name = "name"                            \
     };                                                     \
+    SET_MSG_BUFFER_ARENA(config);                          \
     ANJ_UNIT_ASSERT_SUCCESS(anj_core_init(&anj, &config)); \
     anj_dm_security_obj_t sec_obj;                         \
     anj_dm_security_obj_init(&sec_obj);                    \
@@ -303,7 +324,7 @@ ANJ_UNIT_TEST(server_bootstrap, mimic_bootstrap_exceeds_lifetime) {
 
     // Step 2. Absence of the following request from server exceeds lifetime
     mock_time_advance(
-            anj_time_duration_add(anj.bootstrap_ctx.bootstrap_lifetime,
+            anj_time_duration_add(anj.state_ctx.bootstrap_ctx.bootstrap_lifetime,
                                   anj_time_duration_new(1, ANJ_TIME_UNIT_S)));
     anj_core_step(&anj);
     ANJ_UNIT_ASSERT_EQUAL(anj.server_state.details.bootstrap.bootstrap_state,
@@ -334,7 +355,7 @@ ANJ_UNIT_TEST(server_bootstrap,
 
     // Step 2. Absence of the following request from server exceeds lifetime
     mock_time_advance(
-            anj_time_duration_add(anj.bootstrap_ctx.bootstrap_lifetime,
+            anj_time_duration_add(anj.state_ctx.bootstrap_ctx.bootstrap_lifetime,
                                   anj_time_duration_new(1, ANJ_TIME_UNIT_S)));
     anj_core_step(&anj);
     ANJ_UNIT_ASSERT_EQUAL(anj.server_state.details.bootstrap.bootstrap_state,
@@ -368,9 +389,9 @@ ANJ_UNIT_TEST(server_bootstrap, lifetime_check_from_last_request) {
     RECEIVE_SECURITY_OBJECT_WRITE();
 
     // Above Request from server should reset timeout so we can wait
-    // anj.bootstrap_ctx.bootstrap_lifetime seconds from now
+    // anj.state_ctx.bootstrap_ctx.bootstrap_lifetime seconds from now
     mock_time_advance(
-            anj_time_duration_sub(anj.bootstrap_ctx.bootstrap_lifetime,
+            anj_time_duration_sub(anj.state_ctx.bootstrap_ctx.bootstrap_lifetime,
                                   anj_time_duration_new(1, ANJ_TIME_UNIT_S)));
     anj_core_step(&anj);
     ANJ_UNIT_ASSERT_EQUAL(anj.server_state.details.bootstrap.bootstrap_state,
@@ -18,6 +18,7 @@
 #include <anj/dm/security_object.h>
 #include <anj/dm/server_object.h>
 
+#include "../../src/anj/core/core_utils.h"
 #include "../../src/anj/exchange.h"
 
 #include "../mock/net_api_mock.h"
@@ -25,6 +26,15 @@
 
 #include <anj_unit_test.h>
 
+#ifdef ANJ_WITH_MSG_BUFFER_ARENA
+static uint8_t msg_buffer_arena[ANJ_MSG_BUFFER_ARENA_SIZE];
+#    define SET_MSG_BUFFER_ARENA(Config)              \
+        (Config).msg_buffer_arena = msg_buffer_arena; \
+        (Config).msg_buffer_arena_size = sizeof(msg_buffer_arena)
+#else // ANJ_WITH_MSG_BUFFER_ARENA
+#    define SET_MSG_BUFFER_ARENA(Config) (void) 0
+#endif // ANJ_WITH_MSG_BUFFER_ARENA
+
 // inner_mtu_value value will lead to block transfer for additional objects in
 // payload
 #define TEST_INIT()                                        \
@@ -36,6 +46,7 @@
     anj_configuration_t config = {                         \
         .endpoint_name = "name"                            \
     };                                                     \
+    SET_MSG_BUFFER_ARENA(config);                          \
     ANJ_UNIT_ASSERT_SUCCESS(anj_core_init(&anj, &config)); \
     anj_dm_security_obj_t sec_obj;                         \
     anj_dm_security_obj_init(&sec_obj);                    \
@@ -198,9 +209,9 @@ ANJ_UNIT_TEST(server_register, register_init_coaps) {
 
 #define CHECK_LOCATION_PATHS()                                      \
     ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(                              \
-            anj.register_ctx.location_path[0], "rd", strlen("rd")); \
+            anj.state_ctx.register_ctx.location_path[0], "rd", strlen("rd")); \
     ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(                              \
-            anj.register_ctx.location_path[1], "5a3f", strlen("5a3f"))
+            anj.state_ctx.register_ctx.location_path[1], "5a3f", strlen("5a3f"))
 
 #define ADD_RESPONSE(Response)                 \
     COPY_TOKEN_AND_MSG_ID(Response);           \
@@ -659,7 +670,7 @@ ANJ_UNIT_TEST(server_register, register_retransmisions) {
     EXTENDED_INIT();
     anj_exchange_udp_tx_params_t test_params = {
         .max_retransmit = 2,
-        .ack_random_factor = 1.01,
+        .ack_random_factor = ANJ_ACK_RANDOM_FACTOR(1.01),
         .ack_timeout = anj_time_duration_new(5000, ANJ_TIME_UNIT_MS)
     };
     _anj_exchange_set_udp_tx_params(&anj.exchange_ctx, &test_params);
@@ -742,3 +753,206 @@ ANJ_UNIT_TEST(server_register, register_random_request) {
                           ANJ_CONN_STATUS_REGISTERED);
     CHECK_LOCATION_PATHS();
 }
+
+#ifdef ANJ_WITH_MSG_BUFFER_ARENA
+ANJ_UNIT_TEST(server_register, msg_buffer_arena) {
+    anj_t anj;
+    anj_configuration_t config = {
+        .endpoint_name = "name"
+    };
+    ANJ_UNIT_ASSERT_FAILED(anj_core_init(&anj, &config));
+    config.msg_buffer_arena = msg_buffer_arena;
+    config.msg_buffer_arena_size = sizeof(msg_buffer_arena) - 1;
+    ANJ_UNIT_ASSERT_FAILED(anj_core_init(&anj, &config));
+
+    config.msg_buffer_arena_size = sizeof(msg_buffer_arena);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_core_init(&anj, &config));
+    ANJ_UNIT_ASSERT_TRUE(anj.in_buffer == msg_buffer_arena);
+    ANJ_UNIT_ASSERT_TRUE(anj.out_buffer == msg_buffer_arena);
+    ANJ_UNIT_ASSERT_TRUE(
+            anj.payload_buffer
+            == msg_buffer_arena
+                           + ANJ_MAX(ANJ_IN_MSG_BUFFER_SIZE,
+                                     ANJ_OUT_MSG_BUFFER_SIZE));
+#    ifdef ANJ_WITH_CACHE
+    ANJ_UNIT_ASSERT_TRUE(anj.exchange_cache.cache_recent.payload
+                         == anj.payload_buffer + ANJ_OUT_PAYLOAD_BUFFER_SIZE);
+    ANJ_UNIT_ASSERT_TRUE(anj.exchange_cache.cache_recent.payload
+                                 + ANJ_OUT_PAYLOAD_BUFFER_SIZE
+                         == msg_buffer_arena + sizeof(msg_buffer_arena));
+#    endif // ANJ_WITH_CACHE
+}
+#endif // ANJ_WITH_MSG_BUFFER_ARENA
+
+#ifdef ANJ_OBSERVE_WITH_USER_STORAGE
+ANJ_UNIT_TEST(server_register, observe_user_storage) {
+    static anj_observation_entry_t observations[20];
+    static anj_write_attributes_entry_t attributes[2];
+    anj_t anj;
+    anj_configuration_t config = {
+        .endpoint_name = "name"
+    };
+    SET_MSG_BUFFER_ARENA(config);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_core_init(&anj, &config));
+    ANJ_UNIT_ASSERT_TRUE(anj.observe_ctx.observations
+                         == anj.observe_ctx.default_observations);
+    ANJ_UNIT_ASSERT_EQUAL(anj.observe_ctx.observations_number,
+                          ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER);
+    ANJ_UNIT_ASSERT_TRUE(anj.observe_ctx.attributes_storage
+                         == anj.observe_ctx.default_attributes_storage);
+    ANJ_UNIT_ASSERT_EQUAL(anj.observe_ctx.attributes_storage_number,
+                          ANJ_OBSERVE_MAX_WRITE_ATTRIBUTES_NUMBER);
+
+    config.observations = observations;
+    ANJ_UNIT_ASSERT_FAILED(anj_core_init(&anj, &config));
+    config.observations_number = ANJ_ARRAY_SIZE(observations);
+    config.write_attributes = attributes;
+    config.write_attributes_number = ANJ_ARRAY_SIZE(attributes);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_core_init(&anj, &config));
+    ANJ_UNIT_ASSERT_TRUE(anj.observe_ctx.observations == observations);
+    ANJ_UNIT_ASSERT_EQUAL(anj.observe_ctx.observations_number, 20);
+    ANJ_UNIT_ASSERT_TRUE(anj.observe_ctx.attributes_storage == attributes);
+    ANJ_UNIT_ASSERT_EQUAL(anj.observe_ctx.attributes_storage_number, 2);
+}
+#endif // ANJ_OBSERVE_WITH_USER_STORAGE
+
+#ifdef ANJ_WITH_SCHEDULING_JITTER
+#    define JITTER_TEST_INIT(EndpointName)                            \
+        mock_time_reset();                                            \
+        net_api_mock_t mock = { 0 };                                  \
+        net_api_mock_ctx_init(&mock);                                 \
+        mock.inner_mtu_value = 103;                                   \
+        anj_t anj;                                                    \
+        anj_configuration_t config = {                                \
+            .endpoint_name = EndpointName,                            \
+            .register_spread = anj_time_duration_new(100,             \
+                                                     ANJ_TIME_UNIT_S), \
+            .update_spread_percent = 50,                              \
+            .retry_spread_percent = 50                                \
+        };                                                            \
+        SET_MSG_BUFFER_ARENA(config);                                 \
+        ANJ_UNIT_ASSERT_SUCCESS(anj_core_init(&anj, &config));        \
+        anj_dm_security_obj_t sec_obj;                                \
+        anj_dm_security_obj_init(&sec_obj);                           \
+        anj_dm_server_obj_t ser_obj;                                  \
+        anj_dm_server_obj_init(&ser_obj);                             \
+        INIT_BASIC_INSTANCES();                                       \
+        ADD_INSTANCES()
+
+ANJ_UNIT_TEST(server_register, scheduling_jitter_values) {
+    anj_t anj;
+    anj_configuration_t config = {
+        .endpoint_name = "name",
+        .update_spread_percent = 101
+    };
+    SET_MSG_BUFFER_ARENA(config);
+    ANJ_UNIT_ASSERT_FAILED(anj_core_init(&anj, &config));
+    config.update_spread_percent = 0;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_core_init(&anj, &config));
+
+    const anj_time_duration_t max = anj_time_duration_new(100, ANJ_TIME_UNIT_S);
+    anj_time_duration_t value =
+            _anj_core_utils_jitter(&anj, _ANJ_CORE_JITTER_REGISTER, 0, max);
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_lt(value, max));
+    // deterministic for the endpoint name
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(
+            value,
+            _anj_core_utils_jitter(&anj, _ANJ_CORE_JITTER_REGISTER, 0, max)));
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(
+            _anj_core_utils_jitter(&anj, _ANJ_CORE_JITTER_REGISTER, 0,
+                                   ANJ_TIME_DURATION_ZERO),
+            ANJ_TIME_DURATION_ZERO));
+
+    // endpoints with similar names are spread over the whole range
+    char name[] = "device-00";
+    int64_t min_ms = INT64_MAX;
+    int64_t max_ms = 0;
+    for (int i = 0; i < 100; i++) {
+        name[7] = (char) ('0' + i / 10);
+        name[8] = (char) ('0' + i % 10);
+        config.endpoint_name = name;
+        ANJ_UNIT_ASSERT_SUCCESS(anj_core_init(&anj, &config));
+        int64_t ms = anj_time_duration_to_scalar(
+                _anj_core_utils_jitter(&anj, _ANJ_CORE_JITTER_REGISTER, 0, max),
+                ANJ_TIME_UNIT_MS);
+        ANJ_UNIT_ASSERT_TRUE(ms >= 0 && ms < 100000);
+        min_ms = ms < min_ms ? ms : min_ms;
+        max_ms = ms > max_ms ? ms : max_ms;
+    }
+    ANJ_UNIT_ASSERT_TRUE(min_ms < 10000);
+    ANJ_UNIT_ASSERT_TRUE(max_ms > 90000);
+}
+
+ANJ_UNIT_TEST(server_register, scheduling_jitter_register_and_update) {
+    JITTER_TEST_INIT("name");
+    anj_time_duration_t delay = _anj_core_utils_jitter(
+            &anj, _ANJ_CORE_JITTER_REGISTER, 0, config.register_spread);
+    mock.bytes_to_send = 100;
+
+    // Register is delayed
+    anj_core_step(&anj);
+    mock_time_advance(anj_time_duration_sub(
+            delay, anj_time_duration_new(1, ANJ_TIME_UNIT_MS)));
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERING);
+
+    mock_time_advance(anj_time_duration_new(2, ANJ_TIME_UNIT_MS));
+    anj_core_step(&anj);
+    COPY_TOKEN_AND_MSG_ID(expected_register);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer,
+                                      expected_register,
+                                      sizeof(expected_register) - 1);
+
+    ADD_RESPONSE(response);
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERED);
+
+    // Update is scheduled earlier than half of the lifetime
+    anj_time_duration_t half_lifetime =
+            anj_time_duration_new(5, ANJ_TIME_UNIT_S);
+    anj_time_duration_t update_jitter = _anj_core_utils_jitter_percent(
+            &anj, _ANJ_CORE_JITTER_UPDATE, 0, half_lifetime, 50);
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(
+            anj_time_monotonic_diff(
+                    anj.server_state.details.registered.next_update_time,
+                    anj_time_monotonic_now()),
+            anj_time_duration_sub(half_lifetime, update_jitter)));
+}
+
+ANJ_UNIT_TEST(server_register, scheduling_jitter_retry) {
+    JITTER_TEST_INIT("name");
+    anj_core_step(&anj);
+    mock_time_advance(config.register_spread);
+    mock.bytes_to_send = 100;
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(sizeof(expected_register) - 1, mock.bytes_sent);
+    mock.bytes_sent = 0;
+
+    static char response_bad_request[] =
+            "\x68"                              // header v 0x01, Ack, tkl 8
+            "\x80\x00\x00"                      // Bad Request 4.0, msg id
+            "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF"; // token
+    ADD_RESPONSE(response_bad_request);
+    anj_core_step(&anj);
+
+    // Communication Retry Timer extended by up to 50%
+    anj_time_duration_t retry_timer =
+            anj_time_duration_new(60, ANJ_TIME_UNIT_S);
+    anj_time_duration_t delay = anj_time_duration_add(
+            retry_timer,
+            _anj_core_utils_jitter_percent(&anj,
+                                           _ANJ_CORE_JITTER_REGISTER_RETRY, 1,
+                                           retry_timer, 50));
+    mock_time_advance(anj_time_duration_sub(
+            delay, anj_time_duration_new(1, ANJ_TIME_UNIT_MS)));
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+
+    mock_time_advance(anj_time_duration_new(2, ANJ_TIME_UNIT_MS));
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(sizeof(expected_register) - 1, mock.bytes_sent);
+}
+#endif // ANJ_WITH_SCHEDULING_JITTER
@@ -0,0 +1,341 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/compat/net/anj_net_api.h>
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/dm/core.h>
+#include <anj/dm/security_object.h>
+#include <anj/dm/server_object.h>
+#include <anj/persistence.h>
+#include <anj/utils.h>
+
+#include "../../../../src/anj/exchange.h"
+#include "../mock/net_api_mock.h"
+#include "../mock/time_api_mock.h"
+
+#include <anj_unit_test.h>
+
+#ifdef ANJ_WITH_SESSION_PERSISTENCE
+
+#    ifdef ANJ_WITH_MSG_BUFFER_ARENA
+static uint8_t msg_buffer_arena[ANJ_MSG_BUFFER_ARENA_SIZE];
+#        define SET_MSG_BUFFER_ARENA(Config)              \
+            (Config).msg_buffer_arena = msg_buffer_arena; \
+            (Config).msg_buffer_arena_size = sizeof(msg_buffer_arena)
+#    else // ANJ_WITH_MSG_BUFFER_ARENA
+#        define SET_MSG_BUFFER_ARENA(Config) (void) 0
+#    endif // ANJ_WITH_MSG_BUFFER_ARENA
+
+static net_api_mock_t mock;
+static anj_t anj;
+static anj_dm_security_obj_t sec_obj;
+static anj_dm_server_obj_t ser_obj;
+
+static uint8_t g_membuf_data[8192];
+static size_t g_membuf_write_offset;
+static size_t g_membuf_read_offset;
+
+static int mem_write_cb(void *ctx, const void *buf, size_t size) {
+    (void) ctx;
+    if (g_membuf_write_offset + size > sizeof(g_membuf_data)) {
+        return -1;
+    }
+    memcpy(g_membuf_data + g_membuf_write_offset, buf, size);
+    g_membuf_write_offset += size;
+    return 0;
+}
+
+static int mem_read_cb(void *ctx, void *buf, size_t size) {
+    (void) ctx;
+    if (g_membuf_read_offset + size > g_membuf_write_offset) {
+        return -1;
+    }
+    memcpy(buf, g_membuf_data + g_membuf_read_offset, size);
+    g_membuf_read_offset += size;
+    return 0;
+}
+
+static int session_store(void) {
+    g_membuf_write_offset = 0;
+    anj_persistence_context_t ctx =
+            anj_persistence_store_context_create(mem_write_cb, NULL);
+    return anj_core_session_store(&anj, &ctx);
+}
+
+static int session_restore(void) {
+    g_membuf_read_offset = 0;
+    anj_persistence_context_t ctx =
+            anj_persistence_restore_context_create(mem_read_cb, NULL);
+    return anj_core_session_restore(&anj, &ctx);
+}
+
+// simulates a fresh start of the application, time is not reset
+static void client_init(const char *endpoint_name, uint32_t lifetime) {
+    net_api_mock_ctx_init(&mock);
+    mock.bytes_to_send = 100;
+    mock.inner_mtu_value = 110;
+    anj_configuration_t config = {
+        .endpoint_name = endpoint_name
+    };
+    SET_MSG_BUFFER_ARENA(config);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_core_init(&anj, &config));
+    anj_dm_security_obj_init(&sec_obj);
+    anj_dm_server_obj_init(&ser_obj);
+    const anj_iid_t iid = 1;
+    anj_dm_security_instance_init_t sec_inst = {
+        .server_uri = "coap://server.com:5683",
+        .ssid = 2,
+        .iid = &iid,
+        .security_mode = ANJ_DM_SECURITY_NOSEC,
+    };
+    anj_dm_server_instance_init_t ser_inst = {
+        .ssid = 2,
+        .lifetime = lifetime,
+        .binding = "U",
+        .iid = &iid
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_dm_security_obj_add_instance(&sec_obj, &sec_inst));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_security_obj_install(&anj, &sec_obj));
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_dm_server_obj_add_instance(&ser_obj, &ser_inst));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_server_obj_install(&anj, &ser_obj));
+}
+
+#    define COPY_TOKEN_AND_MSG_ID(Msg, Token_size)                          \
+        memcpy(&Msg[4], anj.exchange_ctx.base_msg.token.bytes, Token_size); \
+        Msg[2] = anj.exchange_ctx.base_msg.coap_binding_data.message_id     \
+                 >> 8;                                                      \
+        Msg[3] = anj.exchange_ctx.base_msg.coap_binding_data.message_id     \
+                 & 0xFF
+
+#    define ADD_RESPONSE(Response)                 \
+        COPY_TOKEN_AND_MSG_ID(Response, 8);        \
+        mock.bytes_to_recv = sizeof(Response) - 1; \
+        mock.data_to_recv = (uint8_t *) Response
+
+static char register_response[] =
+        "\x68"                             // header v 0x01, Ack, tkl 8
+        "\x41\x00\x00"                     // CREATED code 2.1
+        "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF" // token
+        "\x82\x72\x64"                     // location-path /rd
+        "\x04\x35\x61\x33\x66";            // location-path 8 /5a3f
+
+static char update[] = "\x48"                             // Confirmable, tkl 8
+                       "\x02\x00\x00"                     // POST, msg_id
+                       "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF" // token
+                       "\xb2\x72\x64"                     // uri path /rd
+                       "\x04\x35\x61\x33\x66";            // uri path /5a3f
+
+static char update_with_lifetime[] =
+        "\x48"                             // Confirmable, tkl 8
+        "\x02\x00\x00"                     // POST, msg_id
+        "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF" // token
+        "\xb2\x72\x64"                     // uri path /rd
+        "\x04\x35\x61\x33\x66"             // uri path /5a3f
+        "\x46\x6c\x74\x3d\x31\x30\x30";    // uri-query lt=100
+
+static char update_response[] = "\x68"         // header v 0x01, Ack, tkl 8
+                                "\x44\x00\x00" // Changed code 2.04
+                                "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF"; // token
+
+#    define PROCESS_REGISTRATION()                          \
+        anj_core_step(&anj);                                \
+        ADD_RESPONSE(register_response);                    \
+        anj_core_step(&anj);                                \
+        ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status, \
+                              ANJ_CONN_STATUS_REGISTERED);  \
+        anj_core_step(&anj);                                \
+        mock.bytes_sent = 0
+
+#    define HANDLE_UPDATE(Request)                                        \
+        anj_core_step(&anj);                                              \
+        COPY_TOKEN_AND_MSG_ID(Request, 8);                                \
+        ANJ_UNIT_ASSERT_EQUAL(sizeof(Request) - 1, mock.bytes_sent);      \
+        ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, Request, \
+                                          mock.bytes_sent);               \
+        ADD_RESPONSE(update_response);                                    \
+        anj_core_step(&anj);                                              \
+        ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,               \
+                              ANJ_CONN_STATUS_REGISTERED);                \
+        mock.bytes_sent = 0
+
+ANJ_UNIT_TEST(session_persistence, resume_skips_register) {
+    mock_time_reset();
+    client_init("name", 150);
+    PROCESS_REGISTRATION();
+    mock_time_advance(anj_time_duration_new(10, ANJ_TIME_UNIT_S));
+    ANJ_UNIT_ASSERT_SUCCESS(session_store());
+
+    mock_time_advance(anj_time_duration_new(20, ANJ_TIME_UNIT_S));
+    client_init("name", 150);
+    ANJ_UNIT_ASSERT_SUCCESS(session_restore());
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERED);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+
+    // lifetime is 150 so Update is due 75 seconds after the registration
+    mock_time_advance(anj_time_duration_new(44, ANJ_TIME_UNIT_S));
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, 0);
+    mock_time_advance(anj_time_duration_new(2, ANJ_TIME_UNIT_S));
+    HANDLE_UPDATE(update);
+}
+
+ANJ_UNIT_TEST(session_persistence, update_overdue_after_resume) {
+    mock_time_reset();
+    client_init("name", 150);
+    PROCESS_REGISTRATION();
+    ANJ_UNIT_ASSERT_SUCCESS(session_store());
+
+    mock_time_advance(anj_time_duration_new(100, ANJ_TIME_UNIT_S));
+    client_init("name", 150);
+    ANJ_UNIT_ASSERT_SUCCESS(session_restore());
+    HANDLE_UPDATE(update);
+}
+
+ANJ_UNIT_TEST(session_persistence, lifetime_changed_while_offline) {
+    mock_time_reset();
+    client_init("name", 150);
+    PROCESS_REGISTRATION();
+    ANJ_UNIT_ASSERT_SUCCESS(session_store());
+
+    client_init("name", 100);
+    ANJ_UNIT_ASSERT_SUCCESS(session_restore());
+    HANDLE_UPDATE(update_with_lifetime);
+}
+
+#    ifdef ANJ_WITH_OBSERVE
+ANJ_UNIT_TEST(session_persistence, observations_restored) {
+    mock_time_reset();
+    client_init("name", 150);
+    PROCESS_REGISTRATION();
+    _anj_observe_observation_t *observation = &anj.observe_ctx.observations[1];
+    observation->ssid = 2;
+    observation->token.bytes[0] = 0x21;
+    observation->token.size = 1;
+    observation->path = ANJ_MAKE_RESOURCE_PATH(1, 1, 1);
+    observation->observe_number = 7;
+    observation->observe_active = true;
+    observation->last_notify_timestamp = anj_time_monotonic_now();
+    ANJ_UNIT_ASSERT_SUCCESS(session_store());
+
+    mock_time_advance(anj_time_duration_new(5, ANJ_TIME_UNIT_S));
+    client_init("name", 150);
+    ANJ_UNIT_ASSERT_SUCCESS(session_restore());
+    observation = &anj.observe_ctx.observations[1];
+    ANJ_UNIT_ASSERT_EQUAL(observation->ssid, 2);
+    ANJ_UNIT_ASSERT_EQUAL(observation->token.size, 1);
+    ANJ_UNIT_ASSERT_EQUAL(observation->token.bytes[0], 0x21);
+    ANJ_UNIT_ASSERT_TRUE(anj_uri_path_equal(
+            &observation->path, &ANJ_MAKE_RESOURCE_PATH(1, 1, 1)));
+    ANJ_UNIT_ASSERT_EQUAL(observation->observe_number, 7);
+    // the same moment in time, expressed on the new monotonic clock
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(
+            anj_time_monotonic_diff(anj_time_monotonic_now(),
+                                    observation->last_notify_timestamp),
+            anj_time_duration_new(5, ANJ_TIME_UNIT_S)));
+    ANJ_UNIT_ASSERT_EQUAL(anj.observe_ctx.observations[0].ssid, 0);
+
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERED);
+    ANJ_UNIT_ASSERT_EQUAL(anj.observe_ctx.observations[1].ssid, 2);
+}
+#    endif // ANJ_WITH_OBSERVE
+
+ANJ_UNIT_TEST(session_persistence, endpoint_mismatch) {
+    mock_time_reset();
+    client_init("name", 150);
+    PROCESS_REGISTRATION();
+    ANJ_UNIT_ASSERT_SUCCESS(session_store());
+
+    client_init("other", 150);
+    ANJ_UNIT_ASSERT_FAILED(session_restore());
+    // regular registration is performed
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERING);
+    ANJ_UNIT_ASSERT_NOT_EQUAL(mock.bytes_sent, 0);
+}
+
+ANJ_UNIT_TEST(session_persistence, connection_failure_drops_session) {
+    mock_time_reset();
+    client_init("name", 150);
+    PROCESS_REGISTRATION();
+    ANJ_UNIT_ASSERT_SUCCESS(session_store());
+
+    client_init("name", 150);
+    ANJ_UNIT_ASSERT_SUCCESS(session_restore());
+    mock.call_result[ANJ_NET_FUN_CONNECT] = -1;
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERING);
+    ANJ_UNIT_ASSERT_FALSE(anj.session_resume.pending);
+
+    // Register is sent after the retry delay
+    mock.call_result[ANJ_NET_FUN_CONNECT] = 0;
+    mock_time_advance(anj_time_duration_new(61, ANJ_TIME_UNIT_S));
+    anj_core_step(&anj);
+    anj_core_step(&anj);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERING);
+    ANJ_UNIT_ASSERT_NOT_EQUAL(mock.bytes_sent, 0);
+}
+
+ANJ_UNIT_TEST(session_persistence, store_requires_registration) {
+    mock_time_reset();
+    client_init("name", 150);
+    ANJ_UNIT_ASSERT_FAILED(session_store());
+}
+
+#    ifdef ANJ_WITH_NAT_KEEPALIVE_PROBING
+#        define SET_NAT_KEEPALIVE_BOUNDS(Min, Max)                       \
+            anj.nat.min = anj_time_duration_new(Min, ANJ_TIME_UNIT_S); \
+            anj.nat.max = anj_time_duration_new(Max, ANJ_TIME_UNIT_S); \
+            anj.nat.confirmed = anj.nat.min;                           \
+            anj.nat.lost = anj.nat.max
+
+ANJ_UNIT_TEST(session_persistence, nat_keepalive) {
+    mock_time_reset();
+    client_init("name", 150);
+    SET_NAT_KEEPALIVE_BOUNDS(30, 900);
+    anj.nat.confirmed = anj_time_duration_new(120, ANJ_TIME_UNIT_S);
+    anj.nat.lost = anj_time_duration_new(140, ANJ_TIME_UNIT_S);
+    g_membuf_write_offset = 0;
+    anj_persistence_context_t ctx =
+            anj_persistence_store_context_create(mem_write_cb, NULL);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_core_nat_keepalive_store(&anj, &ctx));
+
+    client_init("name", 150);
+    SET_NAT_KEEPALIVE_BOUNDS(30, 900);
+    g_membuf_read_offset = 0;
+    ctx = anj_persistence_restore_context_create(mem_read_cb, NULL);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_core_nat_keepalive_restore(&anj, &ctx));
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(
+            anj.nat.confirmed, anj_time_duration_new(120, ANJ_TIME_UNIT_S)));
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(
+            anj.nat.lost, anj_time_duration_new(140, ANJ_TIME_UNIT_S)));
+
+    // values are limited to the current bounds
+    anj.nat.max = anj_time_duration_new(130, ANJ_TIME_UNIT_S);
+    g_membuf_read_offset = 0;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_core_nat_keepalive_restore(&anj, &ctx));
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(
+            anj.nat.lost, anj_time_duration_new(130, ANJ_TIME_UNIT_S)));
+}
+#    endif // ANJ_WITH_NAT_KEEPALIVE_PROBING
+
+#endif // ANJ_WITH_SESSION_PERSISTENCE
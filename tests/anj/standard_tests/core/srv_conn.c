@@ -202,6 +202,47 @@ ANJ_UNIT_TEST(server, send) {
     ANJ_UNIT_ASSERT_EQUAL(ctx.bytes_sent, 0);
 }
 
+#ifdef ANJ_NET_WITH_SEND_VEC
+ANJ_UNIT_TEST(server, send_vec) {
+    TEST_INIT();
+
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_srv_conn_connect(&ctx, ANJ_NET_BINDING_UDP,
+                                                  NULL, "localhost", "9998"));
+
+    uint8_t header[6] = "123456";
+    uint8_t payload[14] = "7890ABCDEFGHIJ";
+
+    mock.bytes_to_send = 0;
+    mock.call_result[ANJ_NET_FUN_SEND] = ANJ_NET_EINPROGRESS;
+    ANJ_UNIT_ASSERT_EQUAL(_anj_srv_conn_send_vec(&ctx, header, 6, payload, 14),
+                          ANJ_NET_EINPROGRESS);
+    ANJ_UNIT_ASSERT_EQUAL(ctx.bytes_sent, 0);
+    mock.bytes_to_send = 4;
+    mock.call_result[ANJ_NET_FUN_SEND] = ANJ_NET_OK;
+    // part of the header is sent
+    ANJ_UNIT_ASSERT_EQUAL(_anj_srv_conn_send_vec(&ctx, header, 6, payload, 14),
+                          ANJ_NET_EINPROGRESS);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, "1234", 4);
+    ANJ_UNIT_ASSERT_EQUAL(ctx.bytes_sent, 4);
+    mock.bytes_to_send = 10;
+    // rest of the header and part of the payload are sent
+    ANJ_UNIT_ASSERT_EQUAL(_anj_srv_conn_send_vec(&ctx, header, 6, payload, 14),
+                          ANJ_NET_EINPROGRESS);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, "567890ABCD", 10);
+    ANJ_UNIT_ASSERT_EQUAL(ctx.bytes_sent, 14);
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_srv_conn_send_vec(&ctx, header, 6, payload, 14));
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, "EFGHIJ", 6);
+    ANJ_UNIT_ASSERT_EQUAL(ctx.bytes_sent, 0);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_SEND_VEC], 4);
+
+    // message without payload
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_srv_conn_send_vec(&ctx, header, 6, NULL, 0));
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, "123456", 6);
+    ANJ_UNIT_ASSERT_EQUAL(ctx.bytes_sent, 0);
+}
+#endif // ANJ_NET_WITH_SEND_VEC
+
 ANJ_UNIT_TEST(server, recv) {
     TEST_INIT();
 
@@ -247,27 +288,155 @@ ANJ_UNIT_TEST(server, payload_size) {
     _anj_coap_msg_t msg;
     size_t out_payload_size;
     ANJ_UNIT_ASSERT_SUCCESS(_anj_srv_conn_calculate_max_payload_size(
-            &ctx, &msg, 50, 200, true, &out_payload_size));
+            &ctx, &msg, 50, 200, true, 0, &out_payload_size));
     // payload_buff_size is result
     ANJ_UNIT_ASSERT_EQUAL(out_payload_size, 50);
 
     ctx.mtu = 100;
     ANJ_UNIT_ASSERT_SUCCESS(_anj_srv_conn_calculate_max_payload_size(
-            &ctx, &msg, 200, 200, true, &out_payload_size));
+            &ctx, &msg, 200, 200, true, 0, &out_payload_size));
     // inner_mtu_value - _ANJ_COAP_UDP_RESPONSE_MSG_HEADER_MAX_SIZE is result
     ANJ_UNIT_ASSERT_EQUAL(out_payload_size, 75);
 
+#ifdef ANJ_NET_WITH_SEND_VEC
+    // payload isn't copied into the message buffer, so out_msg_buffer_size
+    // only has to fit the header
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_srv_conn_calculate_max_payload_size(
+            &ctx, &msg, 200, 30, true, 0, &out_payload_size));
+    ANJ_UNIT_ASSERT_EQUAL(out_payload_size, 75);
+#else  // ANJ_NET_WITH_SEND_VEC
     ANJ_UNIT_ASSERT_SUCCESS(_anj_srv_conn_calculate_max_payload_size(
-            &ctx, &msg, 200, 50, true, &out_payload_size));
+            &ctx, &msg, 200, 50, true, 0, &out_payload_size));
     // out_msg_buffer_size - _ANJ_COAP_UDP_RESPONSE_MSG_HEADER_MAX_SIZE is
     // result
     ANJ_UNIT_ASSERT_EQUAL(out_payload_size, 25);
+#endif // ANJ_NET_WITH_SEND_VEC
+
+    // message protected at the message layer grows, and its payload is always
+    // encoded into the message buffer
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_srv_conn_calculate_max_payload_size(
+            &ctx, &msg, 200, 200, true, 27, &out_payload_size));
+    ANJ_UNIT_ASSERT_EQUAL(out_payload_size, 48);
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_srv_conn_calculate_max_payload_size(
+            &ctx, &msg, 200, 80, true, 27, &out_payload_size));
+    ANJ_UNIT_ASSERT_EQUAL(out_payload_size, 28);
 
     // out_msg_buffer_size is too small
     ANJ_UNIT_ASSERT_FAILED(_anj_srv_conn_calculate_max_payload_size(
-            &ctx, &msg, 200, 20, true, &out_payload_size));
+            &ctx, &msg, 200, 20, true, 0, &out_payload_size));
 
+#ifndef ANJ_NET_WITH_SEND_VEC
     // payload_buff_size is < 16 -> minimal block size
     ANJ_UNIT_ASSERT_FAILED(_anj_srv_conn_calculate_max_payload_size(
-            &ctx, &msg, 200, 40, true, &out_payload_size));
+            &ctx, &msg, 200, 40, true, 0, &out_payload_size));
+#endif // ANJ_NET_WITH_SEND_VEC
+    // payload_buff_size is < 16 -> minimal block size
+    ANJ_UNIT_ASSERT_FAILED(_anj_srv_conn_calculate_max_payload_size(
+            &ctx, &msg, 15, 200, true, 0, &out_payload_size));
+}
+
+#ifdef ANJ_WITH_PMTU_PROBING
+#    define PMTU_CONFIRM(Pmtu, Ctx, Size)                                   \
+        do {                                                               \
+            _anj_srv_conn_pmtu_sent((Pmtu), (Size));                       \
+            _anj_srv_conn_pmtu_finished((Pmtu), (Ctx),                     \
+                                        _ANJ_EXCHANGE_RESULT_SUCCESS);     \
+        } while (0)
+
+#    define PMTU_LOSE(Pmtu, Ctx, Size)                                      \
+        do {                                                               \
+            _anj_srv_conn_pmtu_sent((Pmtu), (Size));                       \
+            _anj_srv_conn_pmtu_finished((Pmtu), (Ctx),                     \
+                                        _ANJ_EXCHANGE_ERROR_TIMEOUT);      \
+        } while (0)
+
+ANJ_UNIT_TEST(server, pmtu_probing_search) {
+    TEST_INIT();
+    mock.inner_mtu_value = 1500;
+    _anj_srv_conn_pmtu_t pmtu = { 0 };
+
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_srv_conn_connect(&ctx, ANJ_NET_BINDING_UDP,
+                                                  NULL, "localhost", "9998"));
+    _anj_srv_conn_pmtu_connected(&pmtu, &ctx, 1);
+    // 548 + (1501 - 548) / 2
+    ANJ_UNIT_ASSERT_EQUAL(ctx.mtu, 1024);
+
+    // small requests don't prove anything
+    PMTU_CONFIRM(&pmtu, &ctx, 100);
+    ANJ_UNIT_ASSERT_EQUAL(ctx.mtu, 1024);
+    // neither errors other than timeout
+    _anj_srv_conn_pmtu_sent(&pmtu, 1024);
+    _anj_srv_conn_pmtu_finished(&pmtu, &ctx, _ANJ_EXCHANGE_ERROR_NETWORK);
+    ANJ_UNIT_ASSERT_EQUAL(ctx.mtu, 1024);
+
+    PMTU_CONFIRM(&pmtu, &ctx, 1000);
+    // 1000 + (1501 - 1000) / 2
+    ANJ_UNIT_ASSERT_EQUAL(ctx.mtu, 1250);
+    PMTU_LOSE(&pmtu, &ctx, 1250);
+    ANJ_UNIT_ASSERT_EQUAL(ctx.mtu, 1125);
+    // error response means that the request was delivered as well
+    _anj_srv_conn_pmtu_sent(&pmtu, 1125);
+    _anj_srv_conn_pmtu_finished(&pmtu, &ctx,
+                                _ANJ_EXCHANGE_ERROR_SERVER_RESPONSE);
+    ANJ_UNIT_ASSERT_EQUAL(ctx.mtu, 1187);
+    PMTU_LOSE(&pmtu, &ctx, 1187);
+    ANJ_UNIT_ASSERT_EQUAL(ctx.mtu, 1156);
+    PMTU_CONFIRM(&pmtu, &ctx, 1156);
+    // range of unknown sizes is small enough, search is finished
+    ANJ_UNIT_ASSERT_EQUAL(ctx.mtu, 1156);
+
+    // datagram of confirmed size lost, search starts from the beginning
+    PMTU_LOSE(&pmtu, &ctx, 1100);
+    // 548 + (1100 - 548) / 2
+    ANJ_UNIT_ASSERT_EQUAL(ctx.mtu, 824);
+    // datagrams smaller than the minimal MTU are not used in the search
+    PMTU_LOSE(&pmtu, &ctx, 500);
+    ANJ_UNIT_ASSERT_EQUAL(ctx.mtu, 824);
+}
+
+ANJ_UNIT_TEST(server, pmtu_probing_reconnect) {
+    TEST_INIT();
+    mock.inner_mtu_value = 1500;
+    _anj_srv_conn_pmtu_t pmtu = { 0 };
+
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_srv_conn_connect(&ctx, ANJ_NET_BINDING_UDP,
+                                                  NULL, "localhost", "9998"));
+    _anj_srv_conn_pmtu_connected(&pmtu, &ctx, 1);
+    PMTU_CONFIRM(&pmtu, &ctx, 1000);
+    PMTU_LOSE(&pmtu, &ctx, 1250);
+    ANJ_UNIT_ASSERT_EQUAL(ctx.mtu, 1125);
+
+    // discovered values are kept for the same server
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_srv_conn_close(&ctx, false));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_srv_conn_connect(&ctx, ANJ_NET_BINDING_UDP,
+                                                  NULL, "localhost", "9998"));
+    ANJ_UNIT_ASSERT_EQUAL(ctx.mtu, 1500);
+    _anj_srv_conn_pmtu_connected(&pmtu, &ctx, 1);
+    ANJ_UNIT_ASSERT_EQUAL(ctx.mtu, 1125);
+
+    // but they never exceed the reported MTU
+    mock.inner_mtu_value = 900;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_srv_conn_close(&ctx, false));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_srv_conn_connect(&ctx, ANJ_NET_BINDING_UDP,
+                                                  NULL, "localhost", "9998"));
+    _anj_srv_conn_pmtu_connected(&pmtu, &ctx, 1);
+    // 548 + (901 - 548) / 2
+    ANJ_UNIT_ASSERT_EQUAL(ctx.mtu, 724);
+
+    // another server starts from the beginning
+    mock.inner_mtu_value = 1500;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_srv_conn_close(&ctx, false));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_srv_conn_connect(&ctx, ANJ_NET_BINDING_UDP,
+                                                  NULL, "localhost", "9998"));
+    _anj_srv_conn_pmtu_connected(&pmtu, &ctx, 2);
+    ANJ_UNIT_ASSERT_EQUAL(ctx.mtu, 1024);
+
+    // reported MTU smaller than the minimal one is used as it is
+    mock.inner_mtu_value = 400;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_srv_conn_close(&ctx, false));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_srv_conn_connect(&ctx, ANJ_NET_BINDING_UDP,
+                                                  NULL, "localhost", "9998"));
+    _anj_srv_conn_pmtu_connected(&pmtu, &ctx, 3);
+    ANJ_UNIT_ASSERT_EQUAL(ctx.mtu, 400);
 }
+#endif // ANJ_WITH_PMTU_PROBING
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <anj/core.h>
+
+#include <anj_unit_test.h>
+
+#ifdef ANJ_WITH_TRANSIENT_ALLOC
+
+#    define BLOCK_SIZE 20
+
+ANJ_UNIT_TEST(transient_alloc, block_pool) {
+    static ANJ_BLOCK_POOL_MEMORY(memory, BLOCK_SIZE, 3);
+    anj_block_pool_t pool;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_block_pool_init(&pool, memory, sizeof(memory), BLOCK_SIZE));
+
+    void *blocks[3];
+    for (size_t i = 0; i < 3; i++) {
+        blocks[i] = anj_block_pool_alloc(&pool, BLOCK_SIZE);
+        ANJ_UNIT_ASSERT_NOT_NULL(blocks[i]);
+        ANJ_UNIT_ASSERT_EQUAL((uintptr_t) blocks[i] % sizeof(memory[0]), 0);
+        for (size_t j = 0; j < i; j++) {
+            ANJ_UNIT_ASSERT_TRUE(blocks[i] != blocks[j]);
+        }
+    }
+    ANJ_UNIT_ASSERT_NULL(anj_block_pool_alloc(&pool, 1));
+
+    anj_block_pool_free(&pool, blocks[1]);
+    anj_block_pool_free(&pool, NULL);
+    ANJ_UNIT_ASSERT_TRUE(anj_block_pool_alloc(&pool, 1) == blocks[1]);
+    ANJ_UNIT_ASSERT_NULL(anj_block_pool_alloc(&pool, 1));
+}
+
+ANJ_UNIT_TEST(transient_alloc, block_pool_too_large_request) {
+    static ANJ_BLOCK_POOL_MEMORY(memory, BLOCK_SIZE, 1);
+    anj_block_pool_t pool;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_block_pool_init(&pool, memory, sizeof(memory), BLOCK_SIZE));
+    ANJ_UNIT_ASSERT_NULL(anj_block_pool_alloc(&pool, BLOCK_SIZE + 1));
+    ANJ_UNIT_ASSERT_NOT_NULL(anj_block_pool_alloc(&pool, BLOCK_SIZE));
+}
+
+ANJ_UNIT_TEST(transient_alloc, block_pool_init_errors) {
+    static ANJ_BLOCK_POOL_MEMORY(memory, BLOCK_SIZE, 2);
+    anj_block_pool_t pool;
+    ANJ_UNIT_ASSERT_FAILED(anj_block_pool_init(
+            &pool, memory, ANJ_BLOCK_POOL_BLOCK_SIZE(BLOCK_SIZE) - 1,
+            BLOCK_SIZE));
+    ANJ_UNIT_ASSERT_FAILED(anj_block_pool_init(
+            &pool, (uint8_t *) memory + 1, sizeof(memory) - 1, BLOCK_SIZE));
+}
+
+#endif // ANJ_WITH_TRANSIENT_ALLOC
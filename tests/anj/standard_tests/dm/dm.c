@@ -12,6 +12,7 @@
 #include <anj/core.h>
 #include <anj/defs.h>
 #include <anj/dm/core.h>
+#include <anj/utils.h>
 
 #include "../../../../src/anj/dm/dm_core.h"
 #include "../../../../src/anj/dm/dm_io.h"
@@ -296,3 +297,257 @@ ANJ_UNIT_TEST(dm, add_obj_check_error_max_allowed_res_insts_number) {
     inst_2_res[2].insts = res_insts;
     ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_check_obj(&obj));
 }
+
+static anj_riid_t lookup_res_insts[] = { 1, 4, ANJ_ID_INVALID };
+
+static anj_dm_res_t lookup_res[] = {
+    {
+        .rid = 0,
+        .kind = ANJ_DM_RES_R,
+        .type = ANJ_DATA_TYPE_INT
+    },
+    {
+        .rid = 2,
+        .kind = ANJ_DM_RES_RM,
+        .type = ANJ_DATA_TYPE_INT,
+        .max_inst_count = 3,
+        .insts = lookup_res_insts
+    },
+    {
+        .rid = 5,
+        .kind = ANJ_DM_RES_R,
+        .type = ANJ_DATA_TYPE_INT
+    }
+};
+
+static anj_dm_obj_inst_t lookup_insts[] = {
+    {
+        .iid = 0,
+        .res_count = 3,
+        .resources = lookup_res
+    },
+    {
+        .iid = 3,
+        .res_count = 3,
+        .resources = lookup_res
+    },
+    {
+        .iid = 7,
+        .res_count = 1,
+        .resources = lookup_res
+    },
+    {
+        .iid = ANJ_ID_INVALID
+    },
+    {
+        .iid = ANJ_ID_INVALID
+    }
+};
+
+static anj_dm_obj_t lookup_obj = {
+    .oid = 9,
+    .insts = lookup_insts,
+    .max_inst_count = 5,
+    .handlers = &handlers
+};
+
+ANJ_UNIT_TEST(dm, entity_lookup) {
+    anj_t anj = { 0 };
+    _anj_dm_initialize(&anj);
+    anj_dm_obj_t other_objs[] = { { .oid = 1 }, { .oid = 4 }, { .oid = 12 } };
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(other_objs); i++) {
+        ANJ_UNIT_ASSERT_SUCCESS(anj_dm_add_obj(&anj, &other_objs[i]));
+    }
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_add_obj(&anj, &lookup_obj));
+
+    _anj_dm_entity_ptrs_t ptrs;
+    for (anj_oid_t oid = 0; oid < 14; oid++) {
+        bool exists = oid == 1 || oid == 4 || oid == 9 || oid == 12;
+        ANJ_UNIT_ASSERT_EQUAL(!!_anj_dm_find_obj(&anj.dm, oid), exists);
+    }
+    for (anj_iid_t iid = 0; iid < 10; iid++) {
+        bool exists = iid == 0 || iid == 3 || iid == 7;
+        int result = _anj_dm_get_entity_ptrs(
+                &anj.dm, &ANJ_MAKE_INSTANCE_PATH(9, iid), &ptrs);
+        ANJ_UNIT_ASSERT_EQUAL(result, exists ? 0 : ANJ_DM_ERR_NOT_FOUND);
+        if (exists) {
+            ANJ_UNIT_ASSERT_EQUAL(ptrs.inst->iid, iid);
+        }
+    }
+    for (anj_rid_t rid = 0; rid < 7; rid++) {
+        bool exists = rid == 0 || rid == 2 || rid == 5;
+        int result = _anj_dm_get_entity_ptrs(
+                &anj.dm, &ANJ_MAKE_RESOURCE_PATH(9, 3, rid), &ptrs);
+        ANJ_UNIT_ASSERT_EQUAL(result, exists ? 0 : ANJ_DM_ERR_NOT_FOUND);
+        if (exists) {
+            ANJ_UNIT_ASSERT_EQUAL(ptrs.res->rid, rid);
+        }
+    }
+    /* Instance 7 has only the first Resource */
+    ANJ_UNIT_ASSERT_EQUAL(_anj_dm_get_entity_ptrs(
+                                  &anj.dm, &ANJ_MAKE_RESOURCE_PATH(9, 7, 2),
+                                  &ptrs),
+                          ANJ_DM_ERR_NOT_FOUND);
+    for (anj_riid_t riid = 0; riid < 6; riid++) {
+        bool exists = riid == 1 || riid == 4;
+        int result = _anj_dm_get_entity_ptrs(
+                &anj.dm, &ANJ_MAKE_RESOURCE_INSTANCE_PATH(9, 0, 2, riid),
+                &ptrs);
+        ANJ_UNIT_ASSERT_EQUAL(result, exists ? 0 : ANJ_DM_ERR_NOT_FOUND);
+        if (exists) {
+            ANJ_UNIT_ASSERT_EQUAL(ptrs.riid, riid);
+        }
+    }
+}
+
+#ifdef ANJ_DM_WITH_RID_INDEX
+// Resources 0, 2 and 5 at indexes increased by one
+static const uint8_t lookup_rid_index[] = { 1, 0, 2, 0, 0, 3 };
+
+ANJ_UNIT_TEST(dm, entity_lookup_rid_index) {
+    anj_dm_obj_inst_t inst = {
+        .iid = 0,
+        .res_count = ANJ_ARRAY_SIZE(lookup_res),
+        .resources = lookup_res,
+        .rid_index = lookup_rid_index,
+        .rid_index_size = ANJ_ARRAY_SIZE(lookup_rid_index)
+    };
+    anj_dm_obj_t obj = {
+        .oid = 9,
+        .insts = &inst,
+        .max_inst_count = 1,
+        .handlers = &handlers
+    };
+    anj_t anj = { 0 };
+    _anj_dm_initialize(&anj);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_add_obj(&anj, &obj));
+
+    _anj_dm_entity_ptrs_t ptrs;
+    for (anj_rid_t rid = 0; rid < 10; rid++) {
+        bool exists = rid == 0 || rid == 2 || rid == 5;
+        int result = _anj_dm_get_entity_ptrs(
+                &anj.dm, &ANJ_MAKE_RESOURCE_PATH(9, 0, rid), &ptrs);
+        ANJ_UNIT_ASSERT_EQUAL(result, exists ? 0 : ANJ_DM_ERR_NOT_FOUND);
+        if (exists) {
+            ANJ_UNIT_ASSERT_EQUAL(ptrs.res->rid, rid);
+        }
+    }
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_get_entity_ptrs(
+            &anj.dm, &ANJ_MAKE_RESOURCE_INSTANCE_PATH(9, 0, 2, 4), &ptrs));
+    ANJ_UNIT_ASSERT_EQUAL(ptrs.riid, 4);
+
+    // table starting at Resource 2
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_remove_obj(&anj, 9));
+    inst.res_count = 2;
+    inst.resources = &lookup_res[1];
+    const uint8_t shifted_rid_index[] = { 1, 0, 0, 2 };
+    inst.rid_index = shifted_rid_index;
+    inst.rid_index_first = 2;
+    inst.rid_index_size = ANJ_ARRAY_SIZE(shifted_rid_index);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_add_obj(&anj, &obj));
+    for (anj_rid_t rid = 0; rid < 10; rid++) {
+        bool exists = rid == 2 || rid == 5;
+        int result = _anj_dm_get_entity_ptrs(
+                &anj.dm, &ANJ_MAKE_RESOURCE_PATH(9, 0, rid), &ptrs);
+        ANJ_UNIT_ASSERT_EQUAL(result, exists ? 0 : ANJ_DM_ERR_NOT_FOUND);
+        if (exists) {
+            ANJ_UNIT_ASSERT_EQUAL(ptrs.res->rid, rid);
+        }
+    }
+}
+
+ANJ_UNIT_TEST(dm, add_obj_check_error_rid_index) {
+    const uint8_t wrong_idx[] = { 1, 0, 3, 0, 0, 2 };
+    const uint8_t extra_rid[] = { 1, 2, 2, 0, 0, 3 };
+    anj_dm_obj_inst_t inst = {
+        .iid = 0,
+        .res_count = ANJ_ARRAY_SIZE(lookup_res),
+        .resources = lookup_res,
+        .rid_index = lookup_rid_index,
+        .rid_index_size = ANJ_ARRAY_SIZE(lookup_rid_index)
+    };
+    anj_dm_obj_t obj = {
+        .oid = 9,
+        .insts = &inst,
+        .max_inst_count = 1,
+        .handlers = &handlers
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_check_obj(&obj));
+    // Resource 5 out of range of the table
+    inst.rid_index_size = 5;
+    ANJ_UNIT_ASSERT_EQUAL(_anj_dm_check_obj(&obj), _ANJ_DM_ERR_INPUT_ARG);
+    inst.rid_index_size = ANJ_ARRAY_SIZE(lookup_rid_index);
+    inst.rid_index = wrong_idx;
+    ANJ_UNIT_ASSERT_EQUAL(_anj_dm_check_obj(&obj), _ANJ_DM_ERR_INPUT_ARG);
+    inst.rid_index = extra_rid;
+    ANJ_UNIT_ASSERT_EQUAL(_anj_dm_check_obj(&obj), _ANJ_DM_ERR_INPUT_ARG);
+}
+#endif // ANJ_DM_WITH_RID_INDEX
+
+#ifdef ANJ_DM_WITH_PATH_HANDLES
+ANJ_UNIT_TEST(dm, path_handles) {
+    anj_t anj = { 0 };
+    _anj_dm_initialize(&anj);
+    anj_dm_obj_inst_t insts[] = {
+        {
+            .iid = 1,
+            .res_count = 3,
+            .resources = lookup_res
+        },
+        {
+            .iid = 2,
+            .res_count = 3,
+            .resources = lookup_res
+        },
+        {
+            .iid = ANJ_ID_INVALID
+        }
+    };
+    anj_dm_obj_t handles_obj = {
+        .oid = 10,
+        .insts = insts,
+        .max_inst_count = 3,
+        .handlers = &handlers
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_add_obj(&anj, &handles_obj));
+
+    anj_dm_path_handle_t handle;
+    anj_res_value_t value;
+    _anj_dm_entity_ptrs_t ptrs;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_path_handle_resolve(
+                                  &anj, &ANJ_MAKE_RESOURCE_PATH(10, 3, 0),
+                                  &handle),
+                          ANJ_DM_ERR_NOT_FOUND);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_path_handle_resolve(
+            &anj, &ANJ_MAKE_RESOURCE_PATH(10, 2, 0), &handle));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_res_read_by_handle(&anj, &handle, &value));
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_dm_get_path_handle_ptrs(&anj.dm, &handle, &ptrs));
+    ANJ_UNIT_ASSERT_TRUE(ptrs.inst == &insts[1]);
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_get_entity_ptrs(
+            &anj.dm, &ANJ_MAKE_RESOURCE_PATH(10, 2, 0), &ptrs));
+    ANJ_UNIT_ASSERT_TRUE(ptrs.inst == &insts[1]);
+
+    // add Instance 0, moving the other ones
+    insts[2] = insts[1];
+    insts[1] = insts[0];
+    insts[0].iid = 0;
+    anj_core_data_model_changed(&anj, &ANJ_MAKE_INSTANCE_PATH(10, 0),
+                                ANJ_CORE_CHANGE_TYPE_ADDED);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_res_read_by_handle(&anj, &handle, &value));
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_dm_get_path_handle_ptrs(&anj.dm, &handle, &ptrs));
+    ANJ_UNIT_ASSERT_TRUE(ptrs.inst == &insts[2]);
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_get_entity_ptrs(
+            &anj.dm, &ANJ_MAKE_RESOURCE_PATH(10, 2, 0), &ptrs));
+    ANJ_UNIT_ASSERT_TRUE(ptrs.inst == &insts[2]);
+
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_remove_obj(&anj, 10));
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_res_read_by_handle(&anj, &handle, &value),
+                          ANJ_DM_ERR_NOT_FOUND);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_dm_get_entity_ptrs(
+                                  &anj.dm, &ANJ_MAKE_RESOURCE_PATH(10, 2, 0),
+                                  &ptrs),
+                          ANJ_DM_ERR_NOT_FOUND);
+}
+#endif // ANJ_DM_WITH_PATH_HANDLES
@@ -380,3 +380,48 @@ ANJ_UNIT_TEST(dm_create, create_with_write_error) {
     ANJ_UNIT_ASSERT_EQUAL(call_counter_create, 1);
     ANJ_UNIT_ASSERT_EQUAL(call_result, ANJ_DM_TRANSACTION_FAILURE);
 }
+
+#ifdef ANJ_DM_WITH_INST_ARRAY
+static int insert_inst(anj_dm_obj_inst_t *insts, anj_iid_t iid) {
+    anj_dm_obj_inst_t inst = {
+        .iid = iid
+    };
+    return anj_dm_inst_array_insert(insts, 4, &inst);
+}
+
+ANJ_UNIT_TEST(dm_create, inst_array) {
+    anj_dm_obj_inst_t insts[4] = {
+        { .iid = ANJ_ID_INVALID },
+        { .iid = ANJ_ID_INVALID },
+        { .iid = ANJ_ID_INVALID },
+        { .iid = ANJ_ID_INVALID }
+    };
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_inst_array_find_free_iid(insts, 4), 0);
+
+    ANJ_UNIT_ASSERT_SUCCESS(insert_inst(insts, 5));
+    ANJ_UNIT_ASSERT_SUCCESS(insert_inst(insts, 0));
+    ANJ_UNIT_ASSERT_SUCCESS(insert_inst(insts, 2));
+    ANJ_UNIT_ASSERT_EQUAL(insert_inst(insts, 2), ANJ_DM_ERR_BAD_REQUEST);
+    ANJ_UNIT_ASSERT_EQUAL(insts[0].iid, 0);
+    ANJ_UNIT_ASSERT_EQUAL(insts[1].iid, 2);
+    ANJ_UNIT_ASSERT_EQUAL(insts[2].iid, 5);
+    ANJ_UNIT_ASSERT_EQUAL(insts[3].iid, ANJ_ID_INVALID);
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_inst_array_find_free_iid(insts, 4), 1);
+
+    ANJ_UNIT_ASSERT_SUCCESS(insert_inst(insts, 1));
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_inst_array_find_free_iid(insts, 4),
+                          ANJ_ID_INVALID);
+    ANJ_UNIT_ASSERT_EQUAL(insert_inst(insts, 3), ANJ_DM_ERR_METHOD_NOT_ALLOWED);
+
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_inst_array_remove(insts, 4, 0));
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_inst_array_remove(insts, 4, 0),
+                          ANJ_DM_ERR_NOT_FOUND);
+    ANJ_UNIT_ASSERT_EQUAL(insts[0].iid, 1);
+    ANJ_UNIT_ASSERT_EQUAL(insts[1].iid, 2);
+    ANJ_UNIT_ASSERT_EQUAL(insts[2].iid, 5);
+    ANJ_UNIT_ASSERT_EQUAL(insts[3].iid, ANJ_ID_INVALID);
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_inst_array_find_free_iid(insts, 4), 0);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_inst_array_remove(insts, 4, 5));
+    ANJ_UNIT_ASSERT_EQUAL(insts[2].iid, ANJ_ID_INVALID);
+}
+#endif // ANJ_DM_WITH_INST_ARRAY
@@ -9,6 +9,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <string.h>
 
 #include <anj/core.h>
 #include <anj/defs.h>
@@ -16,8 +17,12 @@
 #include <anj/dm/device_object.h>
 #include <anj/utils.h>
 
+#include "../../../../src/anj/coap/coap.h"
+#include "../../../../src/anj/dm/dm_integration.h"
 #include "../../../../src/anj/dm/dm_io.h"
+#include "../../../../src/anj/exchange.h"
 #include "../../../../src/anj/io/io.h"
+#include "../mock/time_api_mock.h"
 
 #include <anj_unit_test.h>
 
@@ -244,3 +249,203 @@ ANJ_UNIT_TEST(dm_device_object, err_codes) {
                      0);
     _anj_dm_operation_end(&anj, ANJ_DM_TRANSACTION_SUCCESS);
 }
+
+#ifdef ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
+static int g_current_time_counter;
+static anj_time_real_t g_current_time;
+
+static void current_time_cb(void *arg,
+                            anj_t *anj,
+                            anj_time_real_t server_time,
+                            anj_time_duration_t round_trip) {
+    (void) anj;
+    (void) round_trip;
+    ANJ_UNIT_ASSERT_TRUE(arg == &g_current_time_counter);
+    g_current_time_counter++;
+    g_current_time = server_time;
+}
+
+static int write_current_time(anj_t *anj,
+                              int64_t value,
+                              anj_dm_transaction_result_t result) {
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_dm_operation_begin(anj, ANJ_OP_DM_WRITE_PARTIAL_UPDATE, false,
+                                    &ANJ_MAKE_INSTANCE_PATH(3, 0)));
+    int res = _anj_dm_write_entry(
+            anj,
+            &(anj_io_out_entry_t) {
+                .type = ANJ_DATA_TYPE_TIME,
+                .value.time_value = value,
+                .path = ANJ_MAKE_RESOURCE_PATH(3, 0, 13)
+            });
+    _anj_dm_operation_end(anj, res ? ANJ_DM_TRANSACTION_FAILURE : result);
+    return res;
+}
+
+ANJ_UNIT_TEST(dm_device_object, current_time_write) {
+    DM_INITIALIZE_BASIC(anj);
+    anj_dm_device_object_init_t dev_obj_init = {
+        .manufacturer = MANUFACTURER_STR,
+        .current_time_cb = current_time_cb,
+        .current_time_cb_arg = &g_current_time_counter
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_dm_device_obj_install(&anj, &device_obj, &dev_obj_init));
+
+    ANJ_UNIT_ASSERT_SUCCESS(write_current_time(&anj, 1700000000,
+                                               ANJ_DM_TRANSACTION_SUCCESS));
+    ANJ_UNIT_ASSERT_EQUAL(g_current_time_counter, 1);
+    ANJ_UNIT_ASSERT_EQUAL(
+            anj_time_real_to_scalar(g_current_time, ANJ_TIME_UNIT_S),
+            1700000000);
+
+    // not applied if the transaction fails
+    ANJ_UNIT_ASSERT_SUCCESS(write_current_time(&anj, 1800000000,
+                                               ANJ_DM_TRANSACTION_FAILURE));
+    ANJ_UNIT_ASSERT_EQUAL(g_current_time_counter, 1);
+
+    // resource is readable
+    size_t out_res_count = 0;
+    anj_io_out_entry_t out_record = { 0 };
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_dm_operation_begin(&anj, ANJ_OP_DM_READ, false,
+                                    &ANJ_MAKE_RESOURCE_PATH(3, 0, 13)));
+    _anj_dm_get_readable_res_count(&anj, &out_res_count);
+    ANJ_UNIT_ASSERT_EQUAL(out_res_count, 1);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_dm_get_read_entry(&anj, &out_record),
+                          _ANJ_DM_LAST_RECORD);
+    ANJ_UNIT_ASSERT_EQUAL(out_record.type, ANJ_DATA_TYPE_TIME);
+    _anj_dm_operation_end(&anj, ANJ_DM_TRANSACTION_SUCCESS);
+}
+
+ANJ_UNIT_TEST(dm_device_object, current_time_write_without_callback) {
+    DM_INITIALIZE_BASIC(anj);
+    anj_dm_device_object_init_t dev_obj_init = {
+        .manufacturer = MANUFACTURER_STR
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_dm_device_obj_install(&anj, &device_obj, &dev_obj_init));
+    ANJ_UNIT_ASSERT_EQUAL(write_current_time(&anj, 1700000000,
+                                             ANJ_DM_TRANSACTION_SUCCESS),
+                          ANJ_DM_ERR_METHOD_NOT_ALLOWED);
+}
+#endif // ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
+
+#ifdef ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
+static size_t read_device_obj_inst(anj_t *anj,
+                                   uint16_t format,
+                                   uint8_t *buff,
+                                   size_t block_size) {
+    _anj_coap_msg_t msg = {
+        .operation = ANJ_OP_DM_READ,
+        .accept = format,
+        .uri = ANJ_MAKE_INSTANCE_PATH(3, 0)
+    };
+    uint8_t response_code;
+    _anj_exchange_handlers_t handlers;
+    _anj_dm_process_request(anj, &msg, 1, &response_code, &handlers);
+    ANJ_UNIT_ASSERT_EQUAL(response_code, ANJ_COAP_CODE_CONTENT);
+    size_t len = 0;
+    uint8_t ret;
+    do {
+        _anj_exchange_read_result_t result = { 0 };
+        ret = handlers.read_payload(handlers.arg, &buff[len], block_size,
+                                    &result);
+        ANJ_UNIT_ASSERT_EQUAL(result.format, format);
+        len += result.payload_len;
+    } while (ret == _ANJ_EXCHANGE_BLOCK_TRANSFER_NEEDED);
+    ANJ_UNIT_ASSERT_EQUAL(ret, 0);
+    handlers.completion(handlers.arg, NULL, _ANJ_EXCHANGE_RESULT_SUCCESS);
+    return len;
+}
+
+static void verify_preencoded_read(anj_t *anj, uint16_t format) {
+    uint8_t expected[300];
+    uint8_t payload[300];
+    size_t expected_len =
+            read_device_obj_inst(anj, format, expected, sizeof(expected));
+    const _anj_dm_preencoded_read_t *slot = NULL;
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(anj->device_read_cache.slots);
+         i++) {
+        if (anj->device_read_cache.slots[i].format == format) {
+            slot = &anj->device_read_cache.slots[i];
+        }
+    }
+    ANJ_UNIT_ASSERT_NOT_NULL(slot);
+    ANJ_UNIT_ASSERT_TRUE(slot->complete);
+    ANJ_UNIT_ASSERT_TRUE(slot->prefix_len > 0);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(slot->payload, expected,
+                                      slot->prefix_len);
+#    ifdef ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
+    // Current Time and the Resources after it are always read
+    ANJ_UNIT_ASSERT_TRUE(slot->prefix_len < expected_len);
+#    else  // ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
+    ANJ_UNIT_ASSERT_EQUAL(slot->prefix_len, expected_len);
+#    endif // ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
+
+    // the same payload is built from the stored one, in blocks of any size
+    static const size_t block_sizes[] = { 16, 7, 1, sizeof(payload) };
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(block_sizes); i++) {
+        memset(payload, 0, sizeof(payload));
+        ANJ_UNIT_ASSERT_EQUAL(
+                read_device_obj_inst(anj, format, payload, block_sizes[i]),
+                expected_len);
+        ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(payload, expected, expected_len);
+    }
+}
+
+ANJ_UNIT_TEST(dm_device_object, preencoded_read) {
+    DM_INITIALIZE_BASIC(anj);
+    anj_dm_device_object_init_t dev_obj_init = {
+        .manufacturer = MANUFACTURER_STR,
+        .model_number = MODEL_NUMBER_STR,
+        .serial_number = SERIAL_NUMBER_STR,
+        .firmware_version = FIRMWARE_VERSION_STR,
+        .software_version = SOFTWARE_VERSION_STR
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_dm_device_obj_install(&anj, &device_obj, &dev_obj_init));
+    ANJ_UNIT_ASSERT_TRUE(anj.device_read_cache.obj == &device_obj.obj);
+
+    verify_preencoded_read(&anj, _ANJ_COAP_FORMAT_SENML_CBOR);
+#    ifdef ANJ_WITH_LWM2M_CBOR
+    verify_preencoded_read(&anj, _ANJ_COAP_FORMAT_OMA_LWM2M_CBOR);
+#    endif // ANJ_WITH_LWM2M_CBOR
+#    ifdef ANJ_WITH_TLV_ENCODER
+    verify_preencoded_read(&anj, _ANJ_COAP_FORMAT_OMA_LWM2M_TLV);
+#    endif // ANJ_WITH_TLV_ENCODER
+
+#    ifdef ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
+    // the value of Current Time is not stored
+    uint8_t before[300];
+    uint8_t after[300];
+    size_t before_len = read_device_obj_inst(
+            &anj, _ANJ_COAP_FORMAT_SENML_CBOR, before, sizeof(before));
+    mock_time_advance_real(anj_time_duration_new(1, ANJ_TIME_UNIT_S));
+    size_t after_len = read_device_obj_inst(&anj, _ANJ_COAP_FORMAT_SENML_CBOR,
+                                            after, sizeof(after));
+    ANJ_UNIT_ASSERT_EQUAL(before_len, after_len);
+    ANJ_UNIT_ASSERT_TRUE(memcmp(before, after, before_len) != 0);
+#    endif // ANJ_DM_DEVICE_OBJ_WITH_CURRENT_TIME
+
+    // a changed value drops the stored payloads
+    device_obj.manufacturer = "other";
+    anj_core_data_model_changed(&anj, &ANJ_MAKE_RESOURCE_PATH(3, 0, 0),
+                                ANJ_CORE_CHANGE_TYPE_VALUE_CHANGED);
+    ANJ_UNIT_ASSERT_FALSE(anj.dm.device_read_cache_valid);
+    uint8_t payload[300];
+    size_t len = read_device_obj_inst(&anj, _ANJ_COAP_FORMAT_SENML_CBOR,
+                                      payload, sizeof(payload));
+    ANJ_UNIT_ASSERT_EQUAL(anj.device_read_cache.slots[0].format,
+                          _ANJ_COAP_FORMAT_SENML_CBOR);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(anj.device_read_cache.slots[0].payload,
+                                      payload,
+                                      anj.device_read_cache.slots[0]
+                                              .prefix_len);
+    bool found = false;
+    for (size_t i = 0; i + 5 <= len; i++) {
+        found = found || !memcmp(&payload[i], "other", 5);
+    }
+    ANJ_UNIT_ASSERT_TRUE(found);
+}
+#endif // ANJ_DM_DEVICE_OBJ_WITH_PREENCODED_READ
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <stddef.h>
+
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/dm/core.h>
+#include <anj/dm/execute_job.h>
+#include <anj/utils.h>
+
+#include "../../../../src/anj/dm/dm_io.h"
+
+#include <anj_unit_test.h>
+
+#ifdef ANJ_DM_WITH_EXECUTE_JOB
+
+ANJ_UNIT_TEST(dm_execute_job, start_and_finish) {
+    anj_t anj = { 0 };
+    _anj_dm_initialize(&anj);
+    anj_dm_execute_job_t job;
+    anj_dm_execute_job_init(&job, &ANJ_MAKE_RESOURCE_PATH(3333, 0, 1));
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_execute_job_get_state(&job),
+                          ANJ_DM_EXECUTE_JOB_STATE_IDLE);
+
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_execute_job_start(&job));
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_execute_job_get_state(&job),
+                          ANJ_DM_EXECUTE_JOB_STATE_RUNNING);
+    // second Execute while the job is running
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_execute_job_start(&job),
+                          ANJ_DM_ERR_SERVICE_UNAVAILABLE);
+
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_execute_job_finish(&anj, &job, 0));
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_execute_job_get_state(&job),
+                          ANJ_DM_EXECUTE_JOB_STATE_SUCCEEDED);
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_execute_job_get_result(&job), 0);
+    ANJ_UNIT_ASSERT_FAILED(anj_dm_execute_job_finish(&anj, &job, 0));
+}
+
+ANJ_UNIT_TEST(dm_execute_job, restart_after_failure) {
+    anj_t anj = { 0 };
+    _anj_dm_initialize(&anj);
+    anj_dm_execute_job_t job;
+    anj_dm_execute_job_init(&job, NULL);
+    ANJ_UNIT_ASSERT_FAILED(anj_dm_execute_job_finish(&anj, &job, 0));
+
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_execute_job_start(&job));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_execute_job_finish(&anj, &job, -5));
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_execute_job_get_state(&job),
+                          ANJ_DM_EXECUTE_JOB_STATE_FAILED);
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_execute_job_get_result(&job), -5);
+
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_execute_job_start(&job));
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_execute_job_get_state(&job),
+                          ANJ_DM_EXECUTE_JOB_STATE_RUNNING);
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_execute_job_get_result(&job), 0);
+}
+
+#endif // ANJ_DM_WITH_EXECUTE_JOB
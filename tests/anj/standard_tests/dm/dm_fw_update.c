@@ -711,4 +711,1016 @@ ANJ_UNIT_TEST(dm_fw_update, execute) {
     }
 }
 
+
+#    ifdef ANJ_FOTA_WITH_PACKAGE_DIGEST
+// sum of all bytes is used as a digest
+static uint32_t g_digest;
+
+static int user_digest_init(void *user_ptr) {
+    arg_t *arg = (arg_t *) user_ptr;
+    strcat(arg->order, "a");
+    g_digest = 0;
+    return 0;
+}
+
+static int user_digest_update(void *user_ptr,
+                              const void *data,
+                              size_t data_size) {
+    arg_t *arg = (arg_t *) user_ptr;
+    strcat(arg->order, "b");
+    for (size_t i = 0; i < data_size; i++) {
+        g_digest += ((const uint8_t *) data)[i];
+    }
+    return arg->fail ? -1 : 0;
+}
+
+static int user_digest_finish(void *user_ptr,
+                              uint8_t *out_digest,
+                              size_t *out_digest_size) {
+    arg_t *arg = (arg_t *) user_ptr;
+    strcat(arg->order, "c");
+    memcpy(out_digest, &g_digest, sizeof(g_digest));
+    *out_digest_size = sizeof(g_digest);
+    return 0;
+}
+
+static anj_dm_fw_update_handlers_t digest_handlers = {
+    .package_write_start_handler = &user_package_write_start_handler,
+    .package_write_handler = &user_package_write_handler,
+    .package_write_finish_handler = &user_package_write_finish_handler,
+    .uri_write_handler = &user_uri_write_handler,
+    .update_start_handler = &user_update_start_handler,
+    .get_name = &user_get_name,
+    .get_version = &user_get_ver,
+    .reset_handler = &user_reset_handler,
+    .digest_init = &user_digest_init,
+    .digest_update = &user_digest_update,
+    .digest_finish = &user_digest_finish
+};
+
+static void write_package(anj_t *anj, int expected_result) {
+    uint8_t data[256];
+    for (int i = 0; i < 256; i++) {
+        data[i] = 1;
+    }
+    anj_io_out_entry_t record = {
+        .type = ANJ_DATA_TYPE_BYTES,
+        .value.bytes_or_string.data = data,
+        .value.bytes_or_string.chunk_length = 250,
+        .value.bytes_or_string.full_length_hint = 256,
+        .path = ANJ_MAKE_RESOURCE_PATH(5, 0, 0)
+    };
+    result_to_return = ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_dm_operation_begin(anj, ANJ_OP_DM_WRITE_PARTIAL_UPDATE, false,
+                                    &ANJ_MAKE_RESOURCE_PATH(5, 0, 0)));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_write_entry(anj, &record));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_operation_validate(anj));
+    _anj_dm_operation_end(anj, ANJ_DM_TRANSACTION_SUCCESS);
+
+    record.value.bytes_or_string.chunk_length = 6;
+    record.value.bytes_or_string.offset = 250;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_dm_operation_begin(anj, ANJ_OP_DM_WRITE_PARTIAL_UPDATE, false,
+                                    &ANJ_MAKE_RESOURCE_PATH(5, 0, 0)));
+    ANJ_UNIT_ASSERT_EQUAL(_anj_dm_write_entry(anj, &record), expected_result);
+    _anj_dm_operation_end(anj, expected_result ? ANJ_DM_TRANSACTION_FAILURE
+                                               : ANJ_DM_TRANSACTION_SUCCESS);
+}
+
+static void write_uri(anj_t *anj) {
+    anj_io_out_entry_t record = {
+        .type = ANJ_DATA_TYPE_STRING,
+        .value.bytes_or_string.data = EXAMPLE_URI,
+        .value.bytes_or_string.chunk_length = strlen(EXAMPLE_URI),
+        .value.bytes_or_string.full_length_hint = strlen(EXAMPLE_URI),
+        .path = ANJ_MAKE_RESOURCE_PATH(5, 0, 1)
+    };
+    strcpy(expected_uri, EXAMPLE_URI);
+    result_to_return = ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_dm_operation_begin(anj, ANJ_OP_DM_WRITE_PARTIAL_UPDATE, false,
+                                    &ANJ_MAKE_RESOURCE_PATH(5, 0, 1)));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_write_entry(anj, &record));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_operation_validate(anj));
+    _anj_dm_operation_end(anj, ANJ_DM_TRANSACTION_SUCCESS);
+}
+
+static const uint32_t correct_digest = 256;
+static const uint32_t wrong_digest = 255;
+
+ANJ_UNIT_TEST(dm_fw_update, digest_handlers_incomplete) {
+    anj_t anj = { 0 };
+    _anj_dm_initialize(&anj);
+    anj_dm_fw_update_entity_ctx_t fu_ctx;
+    anj_dm_fw_update_handlers_t incomplete_handlers = digest_handlers;
+    incomplete_handlers.digest_finish = NULL;
+    ANJ_UNIT_ASSERT_FAILED(anj_dm_fw_update_object_install(
+            &anj, &fu_ctx, &incomplete_handlers, NULL));
+}
+
+ANJ_UNIT_TEST(dm_fw_update, digest_push_success) {
+    INIT_ENV_DM(digest_handlers);
+    memset(package_buffer, '\0', sizeof(package_buffer));
+    package_buffer_offset = 0;
+
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_fw_update_object_set_expected_digest(
+            &fu_ctx, (const uint8_t *) &correct_digest,
+            sizeof(correct_digest)));
+    write_package(&anj, 0);
+    // digest is computed alongside writes and verified before write finish
+    ANJ_UNIT_ASSERT_EQUAL_STRING(user_arg.order, "0a1b1bc2");
+
+    BEGIN_READ;
+    PERFORM_RESOURCE_READ(3, SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(val.int_value, ANJ_DM_FW_UPDATE_STATE_DOWNLOADED);
+    PERFORM_RESOURCE_READ(5, SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(val.int_value, ANJ_DM_FW_UPDATE_RESULT_INITIAL);
+    END_READ;
+}
+
+ANJ_UNIT_TEST(dm_fw_update, digest_push_mismatch) {
+    INIT_ENV_DM(digest_handlers);
+    memset(package_buffer, '\0', sizeof(package_buffer));
+    package_buffer_offset = 0;
+
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_fw_update_object_set_expected_digest(
+            &fu_ctx, (const uint8_t *) &wrong_digest, sizeof(wrong_digest)));
+    write_package(&anj, ANJ_DM_ERR_INTERNAL);
+    // write finish is not called for a corrupted package
+    ANJ_UNIT_ASSERT_EQUAL_STRING(user_arg.order, "0a1b1bc7");
+
+    BEGIN_READ;
+    PERFORM_RESOURCE_READ(3, SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(val.int_value, ANJ_DM_FW_UPDATE_STATE_IDLE);
+    PERFORM_RESOURCE_READ(5, SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(val.int_value,
+                          ANJ_DM_FW_UPDATE_RESULT_INTEGRITY_FAILURE);
+    END_READ;
+
+    // expected digest is discarded together with the package
+    memset(user_arg.order, 0, sizeof(user_arg.order));
+    write_package(&anj, ANJ_DM_ERR_INTERNAL);
+    ANJ_UNIT_ASSERT_EQUAL_STRING(user_arg.order, "0a1b1bc7");
+}
+
+ANJ_UNIT_TEST(dm_fw_update, digest_push_update_failed) {
+    INIT_ENV_DM(digest_handlers);
+    memset(package_buffer, '\0', sizeof(package_buffer));
+    package_buffer_offset = 0;
+    user_arg.fail = true;
+
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_fw_update_object_set_expected_digest(
+            &fu_ctx, (const uint8_t *) &correct_digest,
+            sizeof(correct_digest)));
+    uint8_t data[16] = { 0 };
+    anj_io_out_entry_t record = {
+        .type = ANJ_DATA_TYPE_BYTES,
+        .value.bytes_or_string.data = data,
+        .value.bytes_or_string.chunk_length = 8,
+        .value.bytes_or_string.full_length_hint = 16,
+        .path = ANJ_MAKE_RESOURCE_PATH(5, 0, 0)
+    };
+    result_to_return = ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_dm_operation_begin(&anj, ANJ_OP_DM_WRITE_PARTIAL_UPDATE, false,
+                                    &ANJ_MAKE_RESOURCE_PATH(5, 0, 0)));
+    ANJ_UNIT_ASSERT_FAILED(_anj_dm_write_entry(&anj, &record));
+    _anj_dm_operation_end(&anj, ANJ_DM_TRANSACTION_FAILURE);
+    ANJ_UNIT_ASSERT_EQUAL_STRING(user_arg.order, "0a1b7");
+
+    BEGIN_READ;
+    PERFORM_RESOURCE_READ(5, SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(val.int_value, ANJ_DM_FW_UPDATE_RESULT_FAILED);
+    END_READ;
+}
+
+#        ifdef ANJ_FOTA_WITH_PULL_METHOD
+ANJ_UNIT_TEST(dm_fw_update, digest_pull) {
+    INIT_ENV_DM(digest_handlers);
+    uint8_t data[128];
+    memset(data, 2, sizeof(data));
+
+    // can't feed the digest in idle state
+    ANJ_UNIT_ASSERT_FAILED(
+            anj_dm_fw_update_object_digest_update(&fu_ctx, data, 1));
+
+    write_uri(&anj);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_fw_update_object_set_expected_digest(
+            &fu_ctx, (const uint8_t *) &correct_digest,
+            sizeof(correct_digest)));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_fw_update_object_digest_update(
+            &fu_ctx, data, sizeof(data)));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_fw_update_object_set_download_result(
+            &anj, &fu_ctx, ANJ_DM_FW_UPDATE_RESULT_SUCCESS));
+    ANJ_UNIT_ASSERT_EQUAL_STRING(user_arg.order, "3abc");
+
+    BEGIN_READ;
+    PERFORM_RESOURCE_READ(3, SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(val.int_value, ANJ_DM_FW_UPDATE_STATE_DOWNLOADED);
+    END_READ;
+}
+
+ANJ_UNIT_TEST(dm_fw_update, digest_pull_mismatch) {
+    INIT_ENV_DM(digest_handlers);
+    uint8_t data[128];
+    memset(data, 1, sizeof(data));
+
+    write_uri(&anj);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_fw_update_object_set_expected_digest(
+            &fu_ctx, (const uint8_t *) &correct_digest,
+            sizeof(correct_digest)));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_fw_update_object_digest_update(
+            &fu_ctx, data, sizeof(data)));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_fw_update_object_set_download_result(
+            &anj, &fu_ctx, ANJ_DM_FW_UPDATE_RESULT_SUCCESS));
+    ANJ_UNIT_ASSERT_EQUAL_STRING(user_arg.order, "3abc7");
+
+    BEGIN_READ;
+    PERFORM_RESOURCE_READ(3, SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(val.int_value, ANJ_DM_FW_UPDATE_STATE_IDLE);
+    PERFORM_RESOURCE_READ(5, SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(val.int_value,
+                          ANJ_DM_FW_UPDATE_RESULT_INTEGRITY_FAILURE);
+    END_READ;
+}
+
+ANJ_UNIT_TEST(dm_fw_update, digest_pull_no_expected_digest) {
+    INIT_ENV_DM(digest_handlers);
+    write_uri(&anj);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_fw_update_object_set_download_result(
+            &anj, &fu_ctx, ANJ_DM_FW_UPDATE_RESULT_SUCCESS));
+    ANJ_UNIT_ASSERT_EQUAL_STRING(user_arg.order, "3ac7");
+
+    BEGIN_READ;
+    PERFORM_RESOURCE_READ(5, SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(val.int_value,
+                          ANJ_DM_FW_UPDATE_RESULT_INTEGRITY_FAILURE);
+    END_READ;
+}
+#        endif // ANJ_FOTA_WITH_PULL_METHOD
+#    endif     // ANJ_FOTA_WITH_PACKAGE_DIGEST
+
+#    ifdef ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
+static const void *async_write_data[3];
+static size_t async_write_count;
+
+static anj_dm_fw_update_result_t user_package_write_async_handler(
+        void *user_ptr, const void *data, size_t data_size) {
+    (void) data_size;
+    arg_t *arg = (arg_t *) user_ptr;
+    strcat(arg->order, "w");
+    async_write_data[async_write_count++ % ANJ_ARRAY_SIZE(async_write_data)] =
+            data;
+    return result_to_return;
+}
+
+static anj_dm_fw_update_result_t
+user_package_write_wait_handler(void *user_ptr) {
+    arg_t *arg = (arg_t *) user_ptr;
+    strcat(arg->order, "x");
+    return ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+}
+
+static anj_dm_fw_update_handlers_t async_handlers = {
+    .package_write_start_handler = &user_package_write_start_handler,
+    .package_write_async_handler = &user_package_write_async_handler,
+    .package_write_finish_handler = &user_package_write_finish_handler,
+    .uri_write_handler = &user_uri_write_handler,
+    .update_start_handler = &user_update_start_handler,
+    .reset_handler = &user_reset_handler
+};
+
+static uint8_t async_package[ANJ_FOTA_PUSH_STAGING_BUFFER_SIZE + 1];
+
+static int write_chunk(anj_t *anj, size_t offset, size_t length) {
+    anj_io_out_entry_t record = {
+        .type = ANJ_DATA_TYPE_BYTES,
+        .value.bytes_or_string.data = &async_package[offset],
+        .value.bytes_or_string.offset = offset,
+        .value.bytes_or_string.chunk_length = length,
+        .value.bytes_or_string.full_length_hint = 300,
+        .path = ANJ_MAKE_RESOURCE_PATH(5, 0, 0)
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_dm_operation_begin(anj, ANJ_OP_DM_WRITE_PARTIAL_UPDATE, false,
+                                    &ANJ_MAKE_RESOURCE_PATH(5, 0, 0)));
+    int res = _anj_dm_write_entry(anj, &record);
+    if (!res) {
+        ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_operation_validate(anj));
+    }
+    _anj_dm_operation_end(anj, res ? ANJ_DM_TRANSACTION_FAILURE
+                                   : ANJ_DM_TRANSACTION_SUCCESS);
+    return res;
+}
+
+#        define ASYNC_TEST_INIT(Handlers)                        \
+            INIT_ENV_DM(Handlers);                               \
+            for (size_t i = 0; i < sizeof(async_package); i++) { \
+                async_package[i] = (uint8_t) i;                  \
+            }                                                    \
+            async_write_count = 0;                               \
+            result_to_return = ANJ_DM_FW_UPDATE_RESULT_SUCCESS
+
+ANJ_UNIT_TEST(dm_fw_update, async_push_write) {
+    ASYNC_TEST_INIT(async_handlers);
+
+    ANJ_UNIT_ASSERT_SUCCESS(write_chunk(&anj, 0, 100));
+    ANJ_UNIT_ASSERT_SUCCESS(write_chunk(&anj, 100, 100));
+    ANJ_UNIT_ASSERT_EQUAL_STRING(user_arg.order, "0ww");
+    // chunks are passed from two different staging buffers
+    ANJ_UNIT_ASSERT_TRUE(async_write_data[0] != async_write_data[1]);
+    ANJ_UNIT_ASSERT_TRUE(async_write_data[0] != async_package);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(async_write_data[1], &async_package[100],
+                                      100);
+
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_fw_update_object_package_write_completed(
+            &anj, &fu_ctx, ANJ_DM_FW_UPDATE_RESULT_SUCCESS));
+    ANJ_UNIT_ASSERT_SUCCESS(write_chunk(&anj, 200, 100));
+    // the first buffer is reused
+    ANJ_UNIT_ASSERT_TRUE(async_write_data[2] == async_write_data[0]);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(async_write_data[2], &async_package[200],
+                                      100);
+
+    // finish is deferred until all writes are completed
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_fw_update_object_package_write_completed(
+            &anj, &fu_ctx, ANJ_DM_FW_UPDATE_RESULT_SUCCESS));
+    ANJ_UNIT_ASSERT_EQUAL_STRING(user_arg.order, "0www");
+    BEGIN_READ;
+    PERFORM_RESOURCE_READ(3, SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(val.int_value, ANJ_DM_FW_UPDATE_STATE_IDLE);
+    END_READ;
+
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_fw_update_object_package_write_completed(
+            &anj, &fu_ctx, ANJ_DM_FW_UPDATE_RESULT_SUCCESS));
+    ANJ_UNIT_ASSERT_EQUAL_STRING(user_arg.order, "0www2");
+    BEGIN_READ;
+    PERFORM_RESOURCE_READ(3, SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(val.int_value, ANJ_DM_FW_UPDATE_STATE_DOWNLOADED);
+    PERFORM_RESOURCE_READ(5, SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(val.int_value, ANJ_DM_FW_UPDATE_RESULT_INITIAL);
+    END_READ;
+
+    // no write in progress
+    ANJ_UNIT_ASSERT_FAILED(anj_dm_fw_update_object_package_write_completed(
+            &anj, &fu_ctx, ANJ_DM_FW_UPDATE_RESULT_SUCCESS));
+}
+
+ANJ_UNIT_TEST(dm_fw_update, async_push_write_buffers_busy) {
+    ASYNC_TEST_INIT(async_handlers);
+
+    ANJ_UNIT_ASSERT_SUCCESS(write_chunk(&anj, 0, 100));
+    ANJ_UNIT_ASSERT_SUCCESS(write_chunk(&anj, 100, 100));
+    ANJ_UNIT_ASSERT_EQUAL(write_chunk(&anj, 200, 100),
+                          ANJ_DM_ERR_SERVICE_UNAVAILABLE);
+    ANJ_UNIT_ASSERT_EQUAL_STRING(user_arg.order, "0ww");
+
+    // retransmitted block is accepted once a buffer is released
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_fw_update_object_package_write_completed(
+            &anj, &fu_ctx, ANJ_DM_FW_UPDATE_RESULT_SUCCESS));
+    ANJ_UNIT_ASSERT_SUCCESS(write_chunk(&anj, 200, 100));
+    ANJ_UNIT_ASSERT_EQUAL_STRING(user_arg.order, "0www");
+}
+
+ANJ_UNIT_TEST(dm_fw_update, async_push_write_wait) {
+    anj_dm_fw_update_handlers_t wait_handlers = async_handlers;
+    wait_handlers.package_write_wait_handler = &user_package_write_wait_handler;
+    ASYNC_TEST_INIT(wait_handlers);
+
+    ANJ_UNIT_ASSERT_SUCCESS(write_chunk(&anj, 0, 100));
+    ANJ_UNIT_ASSERT_SUCCESS(write_chunk(&anj, 100, 100));
+    ANJ_UNIT_ASSERT_SUCCESS(write_chunk(&anj, 200, 100));
+    ANJ_UNIT_ASSERT_EQUAL_STRING(user_arg.order, "0wwxw");
+
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_fw_update_object_package_write_completed(
+            &anj, &fu_ctx, ANJ_DM_FW_UPDATE_RESULT_SUCCESS));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_fw_update_object_package_write_completed(
+            &anj, &fu_ctx, ANJ_DM_FW_UPDATE_RESULT_SUCCESS));
+    ANJ_UNIT_ASSERT_EQUAL_STRING(user_arg.order, "0wwxw2");
+}
+
+ANJ_UNIT_TEST(dm_fw_update, async_push_write_failed) {
+    ASYNC_TEST_INIT(async_handlers);
+
+    ANJ_UNIT_ASSERT_SUCCESS(write_chunk(&anj, 0, 100));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_fw_update_object_package_write_completed(
+            &anj, &fu_ctx, ANJ_DM_FW_UPDATE_RESULT_NOT_ENOUGH_SPACE));
+    ANJ_UNIT_ASSERT_EQUAL_STRING(user_arg.order, "0w7");
+    BEGIN_READ;
+    PERFORM_RESOURCE_READ(3, SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(val.int_value, ANJ_DM_FW_UPDATE_STATE_IDLE);
+    PERFORM_RESOURCE_READ(5, SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(val.int_value,
+                          ANJ_DM_FW_UPDATE_RESULT_NOT_ENOUGH_SPACE);
+    END_READ;
+
+    // rest of the aborted package is rejected
+    ANJ_UNIT_ASSERT_EQUAL(write_chunk(&anj, 100, 100), ANJ_DM_ERR_INTERNAL);
+    ANJ_UNIT_ASSERT_EQUAL_STRING(user_arg.order, "0w7");
+
+    // but a new one can be written
+    ANJ_UNIT_ASSERT_SUCCESS(write_chunk(&anj, 0, 100));
+    ANJ_UNIT_ASSERT_EQUAL_STRING(user_arg.order, "0w70w");
+}
+
+ANJ_UNIT_TEST(dm_fw_update, async_push_write_chunk_too_big) {
+    ASYNC_TEST_INIT(async_handlers);
+
+    ANJ_UNIT_ASSERT_EQUAL(write_chunk(&anj, 0, sizeof(async_package)),
+                          ANJ_DM_ERR_INTERNAL);
+    ANJ_UNIT_ASSERT_EQUAL_STRING(user_arg.order, "07");
+    BEGIN_READ;
+    PERFORM_RESOURCE_READ(5, SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(val.int_value, ANJ_DM_FW_UPDATE_RESULT_OUT_OF_MEMORY);
+    END_READ;
+}
+#    endif // ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
+
+#    if defined(ANJ_FOTA_WITH_DELTA_UPDATE)        \
+            || defined(ANJ_FOTA_WITH_DECOMPRESSION) \
+            || defined(ANJ_FOTA_WITH_PAGE_ALIGNED_WRITES)
+static uint8_t new_image[1024];
+static size_t new_image_size;
+static size_t new_image_writes;
+
+static anj_dm_fw_update_result_t
+user_new_image_write(void *user_ptr, const void *data, size_t data_size) {
+    (void) user_ptr;
+    memcpy(&new_image[new_image_size], data, data_size);
+    new_image_size += data_size;
+    new_image_writes++;
+    return result_to_return;
+}
+
+static void new_image_reset(void) {
+    memset(new_image, 0, sizeof(new_image));
+    new_image_size = 0;
+    new_image_writes = 0;
+    result_to_return = ANJ_DM_FW_UPDATE_RESULT_SUCCESS;
+}
+
+static int write_package_chunk(anj_t *anj,
+                               const char *package,
+                               size_t package_size,
+                               size_t offset,
+                               size_t length) {
+    anj_io_out_entry_t record = {
+        .type = ANJ_DATA_TYPE_BYTES,
+        .value.bytes_or_string.data = &package[offset],
+        .value.bytes_or_string.offset = offset,
+        .value.bytes_or_string.chunk_length = length,
+        .value.bytes_or_string.full_length_hint = package_size,
+        .path = ANJ_MAKE_RESOURCE_PATH(5, 0, 0)
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_dm_operation_begin(anj, ANJ_OP_DM_WRITE_PARTIAL_UPDATE, false,
+                                    &ANJ_MAKE_RESOURCE_PATH(5, 0, 0)));
+    int res = _anj_dm_write_entry(anj, &record);
+    if (!res) {
+        ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_operation_validate(anj));
+    }
+    _anj_dm_operation_end(anj, res ? ANJ_DM_TRANSACTION_FAILURE
+                                   : ANJ_DM_TRANSACTION_SUCCESS);
+    return res;
+}
+
+static anj_dm_fw_update_result_t user_image_write_handler(
+        void *user_ptr, const void *data, size_t data_size) {
+    arg_t *arg = (arg_t *) user_ptr;
+    strcat(arg->order, "1");
+    return user_new_image_write(user_ptr, data, data_size);
+}
+#    endif // defined(ANJ_FOTA_WITH_DELTA_UPDATE) ||
+           // defined(ANJ_FOTA_WITH_DECOMPRESSION) ||
+           // defined(ANJ_FOTA_WITH_PAGE_ALIGNED_WRITES)
+
+#    ifdef ANJ_FOTA_WITH_DELTA_UPDATE
+static uint8_t old_image[600];
+static bool old_image_read_fail;
+
+static int
+user_old_image_read(void *user_ptr, size_t offset, void *buff, size_t size) {
+    (void) user_ptr;
+    ANJ_UNIT_ASSERT_TRUE(size <= ANJ_FOTA_DELTA_WINDOW_SIZE);
+    if (old_image_read_fail || offset > sizeof(old_image)
+            || size > sizeof(old_image) - offset) {
+        return -1;
+    }
+    memcpy(buff, &old_image[offset], size);
+    return 0;
+}
+
+// DIFF 4, EXTRA 3, SEEK +10, COPY 5, SEEK -19, COPY 2
+static const char delta_patch[] = "ANJD\x0E"
+                                  "\x00\x04\x01\x02\x03\xFF"
+                                  "\x01\x03"
+                                  "abc"
+                                  "\x03\x14"
+                                  "\x02\x05"
+                                  "\x03\x25"
+                                  "\x02\x02";
+
+static void delta_test_init(anj_dm_fw_update_delta_ctx_t *ctx) {
+    for (size_t i = 0; i < sizeof(old_image); i++) {
+        old_image[i] = (uint8_t) (i * 7);
+    }
+    new_image_reset();
+    old_image_read_fail = false;
+    if (ctx) {
+        anj_dm_fw_update_delta_init(ctx, user_old_image_read,
+                                    user_new_image_write, NULL);
+    }
+}
+
+static void verify_delta_patch_result(void) {
+    const uint8_t expected[] = {
+        (uint8_t) (old_image[0] + 1), (uint8_t) (old_image[1] + 2),
+        (uint8_t) (old_image[2] + 3), (uint8_t) (old_image[3] + 0xFF),
+        'a',
+        'b',
+        'c',
+        old_image[14],
+        old_image[15],
+        old_image[16],
+        old_image[17],
+        old_image[18],
+        old_image[0],
+        old_image[1]
+    };
+    ANJ_UNIT_ASSERT_EQUAL(new_image_size, sizeof(expected));
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(new_image, expected, sizeof(expected));
+}
+
+ANJ_UNIT_TEST(dm_fw_update, delta_apply) {
+    anj_dm_fw_update_delta_ctx_t ctx;
+    delta_test_init(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_fw_update_delta_feed(&ctx, delta_patch,
+                                                      sizeof(delta_patch) - 1),
+                          ANJ_DM_FW_UPDATE_RESULT_SUCCESS);
+    // the new image is buffered until the window fills up
+    ANJ_UNIT_ASSERT_EQUAL(new_image_writes, 0);
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_fw_update_delta_finish(&ctx),
+                          ANJ_DM_FW_UPDATE_RESULT_SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(new_image_writes, 1);
+    verify_delta_patch_result();
+}
+
+ANJ_UNIT_TEST(dm_fw_update, delta_apply_byte_by_byte) {
+    anj_dm_fw_update_delta_ctx_t ctx;
+    delta_test_init(&ctx);
+    for (size_t i = 0; i < sizeof(delta_patch) - 1; i++) {
+        ANJ_UNIT_ASSERT_EQUAL(
+                anj_dm_fw_update_delta_feed(&ctx, &delta_patch[i], 1),
+                ANJ_DM_FW_UPDATE_RESULT_SUCCESS);
+    }
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_fw_update_delta_finish(&ctx),
+                          ANJ_DM_FW_UPDATE_RESULT_SUCCESS);
+    verify_delta_patch_result();
+}
+
+ANJ_UNIT_TEST(dm_fw_update, delta_window_flush) {
+    // COPY 600
+    static const char patch[] = "ANJD\xD8\x04\x02\xD8\x04";
+    anj_dm_fw_update_delta_ctx_t ctx;
+    delta_test_init(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(
+            anj_dm_fw_update_delta_feed(&ctx, patch, sizeof(patch) - 1),
+            ANJ_DM_FW_UPDATE_RESULT_SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(new_image_writes,
+                          (600 - 1) / ANJ_FOTA_DELTA_WINDOW_SIZE);
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_fw_update_delta_finish(&ctx),
+                          ANJ_DM_FW_UPDATE_RESULT_SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(new_image_writes,
+                          (600 - 1) / ANJ_FOTA_DELTA_WINDOW_SIZE + 1);
+    ANJ_UNIT_ASSERT_EQUAL(new_image_size, 600);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(new_image, old_image, 600);
+}
+
+static anj_dm_fw_update_result_t apply_patch(const char *patch,
+                                             size_t patch_size) {
+    anj_dm_fw_update_delta_ctx_t ctx;
+    delta_test_init(&ctx);
+    anj_dm_fw_update_result_t result =
+            anj_dm_fw_update_delta_feed(&ctx, patch, patch_size);
+    if (result == ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
+        return anj_dm_fw_update_delta_finish(&ctx);
+    }
+    // the applier stays in the error state
+    ANJ_UNIT_ASSERT_NOT_EQUAL(anj_dm_fw_update_delta_feed(&ctx, "\x00", 1),
+                              ANJ_DM_FW_UPDATE_RESULT_SUCCESS);
+    ANJ_UNIT_ASSERT_NOT_EQUAL(anj_dm_fw_update_delta_finish(&ctx),
+                              ANJ_DM_FW_UPDATE_RESULT_SUCCESS);
+    return result;
+}
+
+#        define APPLY_PATCH(Patch) apply_patch(Patch, sizeof(Patch) - 1)
+
+ANJ_UNIT_TEST(dm_fw_update, delta_malformed) {
+    ANJ_UNIT_ASSERT_EQUAL(APPLY_PATCH("ANJX\x00"),
+                          ANJ_DM_FW_UPDATE_RESULT_INTEGRITY_FAILURE);
+    // unknown opcode
+    ANJ_UNIT_ASSERT_EQUAL(APPLY_PATCH("ANJD\x01\x04\x01"),
+                          ANJ_DM_FW_UPDATE_RESULT_INTEGRITY_FAILURE);
+    // more data than the declared new image size
+    ANJ_UNIT_ASSERT_EQUAL(APPLY_PATCH("ANJD\x01\x02\x02"),
+                          ANJ_DM_FW_UPDATE_RESULT_INTEGRITY_FAILURE);
+    // seek before the start of the old image
+    ANJ_UNIT_ASSERT_EQUAL(APPLY_PATCH("ANJD\x01\x03\x01"),
+                          ANJ_DM_FW_UPDATE_RESULT_INTEGRITY_FAILURE);
+    // argument longer than 64 bits
+    ANJ_UNIT_ASSERT_EQUAL(
+            APPLY_PATCH("ANJD\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\x02"),
+            ANJ_DM_FW_UPDATE_RESULT_INTEGRITY_FAILURE);
+    // truncated patches
+    ANJ_UNIT_ASSERT_EQUAL(APPLY_PATCH("ANJ"),
+                          ANJ_DM_FW_UPDATE_RESULT_INTEGRITY_FAILURE);
+    ANJ_UNIT_ASSERT_EQUAL(APPLY_PATCH("ANJD\x02\x01\x02\x61"),
+                          ANJ_DM_FW_UPDATE_RESULT_INTEGRITY_FAILURE);
+    ANJ_UNIT_ASSERT_EQUAL(APPLY_PATCH("ANJD\x02\x02\x01"),
+                          ANJ_DM_FW_UPDATE_RESULT_INTEGRITY_FAILURE);
+    ANJ_UNIT_ASSERT_EQUAL(APPLY_PATCH("ANJD\x02\x02\x81"),
+                          ANJ_DM_FW_UPDATE_RESULT_INTEGRITY_FAILURE);
+    // empty new image is fine
+    ANJ_UNIT_ASSERT_EQUAL(APPLY_PATCH("ANJD\x00"),
+                          ANJ_DM_FW_UPDATE_RESULT_SUCCESS);
+}
+
+ANJ_UNIT_TEST(dm_fw_update, delta_io_errors) {
+    anj_dm_fw_update_delta_ctx_t ctx;
+    delta_test_init(&ctx);
+    old_image_read_fail = true;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_fw_update_delta_feed(&ctx, delta_patch,
+                                                      sizeof(delta_patch) - 1),
+                          ANJ_DM_FW_UPDATE_RESULT_FAILED);
+
+    // copy past the end of the old image
+    ANJ_UNIT_ASSERT_EQUAL(APPLY_PATCH("ANJD\x02\x03\xD6\x09\x02\x02"),
+                          ANJ_DM_FW_UPDATE_RESULT_FAILED);
+
+    delta_test_init(&ctx);
+    result_to_return = ANJ_DM_FW_UPDATE_RESULT_NOT_ENOUGH_SPACE;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_fw_update_delta_feed(&ctx, delta_patch,
+                                                      sizeof(delta_patch) - 1),
+                          ANJ_DM_FW_UPDATE_RESULT_SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_fw_update_delta_finish(&ctx),
+                          ANJ_DM_FW_UPDATE_RESULT_NOT_ENOUGH_SPACE);
+}
+
+static anj_dm_fw_update_handlers_t delta_handlers = {
+    .package_write_start_handler = &user_package_write_start_handler,
+    .package_write_handler = &user_image_write_handler,
+    .package_write_finish_handler = &user_package_write_finish_handler,
+    .uri_write_handler = &user_uri_write_handler,
+    .update_start_handler = &user_update_start_handler,
+    .reset_handler = &user_reset_handler,
+    .old_image_read = &user_old_image_read
+};
+
+ANJ_UNIT_TEST(dm_fw_update, delta_push) {
+    INIT_ENV_DM(delta_handlers);
+    delta_test_init(NULL);
+
+    ANJ_UNIT_ASSERT_SUCCESS(write_package_chunk(
+            &anj, delta_patch, sizeof(delta_patch) - 1, 0, 9));
+    ANJ_UNIT_ASSERT_SUCCESS(
+            write_package_chunk(&anj, delta_patch, sizeof(delta_patch) - 1, 9,
+                                sizeof(delta_patch) - 1 - 9));
+    // the new image is written at once, right before write finish
+    ANJ_UNIT_ASSERT_EQUAL_STRING(user_arg.order, "012");
+    verify_delta_patch_result();
+
+    BEGIN_READ;
+    PERFORM_RESOURCE_READ(3, SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(val.int_value, ANJ_DM_FW_UPDATE_STATE_DOWNLOADED);
+    PERFORM_RESOURCE_READ(5, SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(val.int_value, ANJ_DM_FW_UPDATE_RESULT_INITIAL);
+    END_READ;
+}
+
+ANJ_UNIT_TEST(dm_fw_update, delta_push_malformed) {
+    static const char patch[] = "ANJD\x02\x02\x01";
+    INIT_ENV_DM(delta_handlers);
+    delta_test_init(NULL);
+
+    ANJ_UNIT_ASSERT_EQUAL(
+            write_package_chunk(&anj, patch, sizeof(patch) - 1, 0,
+                                sizeof(patch) - 1),
+            ANJ_DM_ERR_INTERNAL);
+    ANJ_UNIT_ASSERT_EQUAL_STRING(user_arg.order, "07");
+    BEGIN_READ;
+    PERFORM_RESOURCE_READ(3, SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(val.int_value, ANJ_DM_FW_UPDATE_STATE_IDLE);
+    PERFORM_RESOURCE_READ(5, SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(val.int_value,
+                          ANJ_DM_FW_UPDATE_RESULT_INTEGRITY_FAILURE);
+    END_READ;
+}
+
+ANJ_UNIT_TEST(dm_fw_update, delta_handlers_invalid) {
+    anj_t anj = { 0 };
+    _anj_dm_initialize(&anj);
+    anj_dm_fw_update_entity_ctx_t fu_ctx;
+    anj_dm_fw_update_handlers_t invalid_handlers = delta_handlers;
+    invalid_handlers.package_write_handler = NULL;
+#        ifdef ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
+    invalid_handlers.package_write_async_handler = &user_package_write_handler;
+#        endif // ANJ_FOTA_WITH_ASYNC_PUSH_WRITE
+    ANJ_UNIT_ASSERT_FAILED(anj_dm_fw_update_object_install(
+            &anj, &fu_ctx, &invalid_handlers, NULL));
+}
+#    endif // ANJ_FOTA_WITH_DELTA_UPDATE
+
+#    ifdef ANJ_FOTA_WITH_DECOMPRESSION
+static const char plain_text[] =
+        "Anjay Lite firmware, Anjay Lite firmware, Anjay Lite firmware!";
+// heatshrink -e -w 8 -l 4
+static const char compressed_text[] =
+        "ANJZ\x84"
+        "\xA0\xDB\xAD\x56\x1B\xCC\x82\x99\x69\xBA\x59\x64\x16\x6B\x4D\xCA"
+        "\xDB\x77\xB0\xDC\xAC\xB2\xC9\x00\x53\xC2\x9E\x14\x79\x08";
+
+static anj_dm_fw_update_result_t decompress(const char *package,
+                                            size_t package_size,
+                                            size_t chunk_size) {
+    anj_dm_fw_update_decompress_ctx_t ctx;
+    new_image_reset();
+    anj_dm_fw_update_decompress_init(&ctx, user_new_image_write, NULL);
+    for (size_t offset = 0; offset < package_size; offset += chunk_size) {
+        anj_dm_fw_update_result_t result = anj_dm_fw_update_decompress_feed(
+                &ctx, &package[offset],
+                ANJ_MIN(chunk_size, package_size - offset));
+        if (result != ANJ_DM_FW_UPDATE_RESULT_SUCCESS) {
+            // the decompressor stays in the error state
+            ANJ_UNIT_ASSERT_NOT_EQUAL(anj_dm_fw_update_decompress_finish(&ctx),
+                                      ANJ_DM_FW_UPDATE_RESULT_SUCCESS);
+            return result;
+        }
+    }
+    return anj_dm_fw_update_decompress_finish(&ctx);
+}
+
+ANJ_UNIT_TEST(dm_fw_update, decompress) {
+    ANJ_UNIT_ASSERT_EQUAL(decompress(compressed_text,
+                                     sizeof(compressed_text) - 1,
+                                     sizeof(compressed_text) - 1),
+                          ANJ_DM_FW_UPDATE_RESULT_SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(new_image_writes, 1);
+    ANJ_UNIT_ASSERT_EQUAL(new_image_size, sizeof(plain_text) - 1);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(new_image, plain_text,
+                                      sizeof(plain_text) - 1);
+
+    ANJ_UNIT_ASSERT_EQUAL(
+            decompress(compressed_text, sizeof(compressed_text) - 1, 1),
+            ANJ_DM_FW_UPDATE_RESULT_SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(new_image_size, sizeof(plain_text) - 1);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(new_image, plain_text,
+                                      sizeof(plain_text) - 1);
+}
+
+ANJ_UNIT_TEST(dm_fw_update, decompress_smaller_window) {
+    // heatshrink -e -w 5 -l 3
+    static const char package[] = "ANJZ\x53\xB0\xD8\x81\xE0\xF0\x78\x36\x42";
+    static const char expected[] = "abababababababababababababababab!";
+    ANJ_UNIT_ASSERT_EQUAL(decompress(package, sizeof(package) - 1, 3),
+                          ANJ_DM_FW_UPDATE_RESULT_SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(new_image_size, sizeof(expected) - 1);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(new_image, expected,
+                                      sizeof(expected) - 1);
+}
+
+#        if ANJ_FOTA_DECOMPRESSION_WINDOW_BITS == 8
+ANJ_UNIT_TEST(dm_fw_update, decompress_window_flush) {
+    // 60 repetitions of "0123456789", heatshrink -e -w 8 -l 4
+    static const char package[] =
+            "ANJZ\x84"
+            "\x98\x4C\x66\x53\x39\xA4\xD6\x6D\x37\x9C\x4E\x41\x3E\x09\xF0\x4F"
+            "\x82\x7C\x13\xE0\x9F\x04\xF8\x27\xC1\x3E\x09\xF0\x4F\x82\x7C\x13"
+            "\xE0\x9F\x04\xF8\x27\xC1\x3E\x09\xF0\x4F\x82\x7C\x13\xE0\x9F\x04"
+            "\xF8\x27\xC1\x3E\x09\xF0\x4F\x82\x7C\x13\xE0\x9F\x04\xF8\x27\xC1"
+            "\x3E\x09\xF0\x4F\x82\x7C\x13\xA0";
+    ANJ_UNIT_ASSERT_EQUAL(decompress(package, sizeof(package) - 1, 16),
+                          ANJ_DM_FW_UPDATE_RESULT_SUCCESS);
+    // the window is passed as a whole every time it fills up
+    ANJ_UNIT_ASSERT_EQUAL(new_image_writes, 3);
+    ANJ_UNIT_ASSERT_EQUAL(new_image_size, 600);
+    for (size_t i = 0; i < 600; i++) {
+        ANJ_UNIT_ASSERT_EQUAL(new_image[i], '0' + i % 10);
+    }
+}
+#        endif // ANJ_FOTA_DECOMPRESSION_WINDOW_BITS == 8
+
+ANJ_UNIT_TEST(dm_fw_update, decompress_passthrough) {
+    static const char package[] = "ANJxANJZ";
+    ANJ_UNIT_ASSERT_EQUAL(decompress(package, sizeof(package) - 1, 2),
+                          ANJ_DM_FW_UPDATE_RESULT_SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(new_image_size, sizeof(package) - 1);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(new_image, package,
+                                      sizeof(package) - 1);
+
+    // package shorter than the header
+    ANJ_UNIT_ASSERT_EQUAL(decompress("AN", 2, 1),
+                          ANJ_DM_FW_UPDATE_RESULT_SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(new_image_size, 2);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(new_image, "AN", 2);
+}
+
+ANJ_UNIT_TEST(dm_fw_update, decompress_errors) {
+    // window larger than configured
+    ANJ_UNIT_ASSERT_EQUAL(decompress("ANJZ\xF4\x00", 6, 6),
+                          ANJ_DM_FW_UPDATE_RESULT_UNSUPPORTED_PACKAGE_TYPE);
+    // lookahead not smaller than the window
+    ANJ_UNIT_ASSERT_EQUAL(decompress("ANJZ\x44\x00", 6, 6),
+                          ANJ_DM_FW_UPDATE_RESULT_UNSUPPORTED_PACKAGE_TYPE);
+
+    anj_dm_fw_update_decompress_ctx_t ctx;
+    new_image_reset();
+    result_to_return = ANJ_DM_FW_UPDATE_RESULT_NOT_ENOUGH_SPACE;
+    anj_dm_fw_update_decompress_init(&ctx, user_new_image_write, NULL);
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_fw_update_decompress_feed(
+                                  &ctx, compressed_text,
+                                  sizeof(compressed_text) - 1),
+                          ANJ_DM_FW_UPDATE_RESULT_SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_fw_update_decompress_finish(&ctx),
+                          ANJ_DM_FW_UPDATE_RESULT_NOT_ENOUGH_SPACE);
+}
+
+static anj_dm_fw_update_handlers_t decompress_handlers = {
+    .package_write_start_handler = &user_package_write_start_handler,
+    .package_write_handler = &user_image_write_handler,
+    .package_write_finish_handler = &user_package_write_finish_handler,
+    .uri_write_handler = &user_uri_write_handler,
+    .update_start_handler = &user_update_start_handler,
+    .reset_handler = &user_reset_handler
+};
+
+ANJ_UNIT_TEST(dm_fw_update, decompress_push) {
+    INIT_ENV_DM(decompress_handlers);
+    new_image_reset();
+
+    ANJ_UNIT_ASSERT_SUCCESS(write_package_chunk(
+            &anj, compressed_text, sizeof(compressed_text) - 1, 0, 16));
+    ANJ_UNIT_ASSERT_SUCCESS(write_package_chunk(
+            &anj, compressed_text, sizeof(compressed_text) - 1, 16,
+            sizeof(compressed_text) - 1 - 16));
+    ANJ_UNIT_ASSERT_EQUAL_STRING(user_arg.order, "012");
+    ANJ_UNIT_ASSERT_EQUAL(new_image_size, sizeof(plain_text) - 1);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(new_image, plain_text,
+                                      sizeof(plain_text) - 1);
+
+    BEGIN_READ;
+    PERFORM_RESOURCE_READ(3, SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(val.int_value, ANJ_DM_FW_UPDATE_STATE_DOWNLOADED);
+    END_READ;
+}
+
+ANJ_UNIT_TEST(dm_fw_update, decompress_push_uncompressed) {
+    static const char package[] = "plain firmware";
+    INIT_ENV_DM(decompress_handlers);
+    new_image_reset();
+
+    ANJ_UNIT_ASSERT_SUCCESS(write_package_chunk(
+            &anj, package, sizeof(package) - 1, 0, sizeof(package) - 1));
+    // uncompressed data is passed right away
+    ANJ_UNIT_ASSERT_EQUAL_STRING(user_arg.order, "012");
+    ANJ_UNIT_ASSERT_EQUAL(new_image_size, sizeof(package) - 1);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(new_image, package,
+                                      sizeof(package) - 1);
+}
+
+#        ifdef ANJ_FOTA_WITH_DELTA_UPDATE
+ANJ_UNIT_TEST(dm_fw_update, decompress_push_delta) {
+    // delta_patch, heatshrink -e -w 8 -l 4
+    static const char package[] =
+            "ANJZ\x84"
+            "\xA0\xD3\xA9\x54\x48\x74\x02\x09\x01\x81\x40\xFF\xF0\x18\x1D\x86"
+            "\xC5\x63\x81\xC5\x20\x50\x58\x1C\x96\x05\x02";
+    INIT_ENV_DM(delta_handlers);
+    delta_test_init(NULL);
+
+    ANJ_UNIT_ASSERT_SUCCESS(write_package_chunk(
+            &anj, package, sizeof(package) - 1, 0, sizeof(package) - 1));
+    // the package is decompressed first, then the patch is applied
+    ANJ_UNIT_ASSERT_EQUAL_STRING(user_arg.order, "012");
+    verify_delta_patch_result();
+}
+#        endif // ANJ_FOTA_WITH_DELTA_UPDATE
+#    endif     // ANJ_FOTA_WITH_DECOMPRESSION
+
+#    ifdef ANJ_FOTA_WITH_PAGE_ALIGNED_WRITES
+static const char page_test_package[] =
+        "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJ";
+static size_t page_write_sizes[8];
+
+static anj_dm_fw_update_result_t
+user_page_write(void *user_ptr, const void *data, size_t data_size) {
+    page_write_sizes[new_image_writes] = data_size;
+    return user_new_image_write(user_ptr, data, data_size);
+}
+
+static void page_writer_feed_all(anj_dm_fw_update_page_writer_ctx_t *ctx,
+                                 const char *data,
+                                 size_t data_size,
+                                 size_t chunk_size) {
+    for (size_t offset = 0; offset < data_size; offset += chunk_size) {
+        ANJ_UNIT_ASSERT_EQUAL(anj_dm_fw_update_page_writer_feed(
+                                      ctx, &data[offset],
+                                      ANJ_MIN(chunk_size, data_size - offset)),
+                              ANJ_DM_FW_UPDATE_RESULT_SUCCESS);
+    }
+}
+
+ANJ_UNIT_TEST(dm_fw_update, page_writer) {
+    anj_dm_fw_update_page_writer_ctx_t ctx;
+    new_image_reset();
+    anj_dm_fw_update_page_writer_init(&ctx, user_page_write, NULL, 16, 0);
+    page_writer_feed_all(&ctx, page_test_package, 5, 5);
+    ANJ_UNIT_ASSERT_EQUAL(new_image_writes, 0);
+    // completes the buffered page, then passes the next one directly
+    page_writer_feed_all(&ctx, &page_test_package[5], 40, 40);
+    ANJ_UNIT_ASSERT_EQUAL(new_image_writes, 2);
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_fw_update_page_writer_finish(&ctx),
+                          ANJ_DM_FW_UPDATE_RESULT_SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(new_image_writes, 3);
+    ANJ_UNIT_ASSERT_EQUAL(page_write_sizes[0], 16);
+    ANJ_UNIT_ASSERT_EQUAL(page_write_sizes[1], 16);
+    ANJ_UNIT_ASSERT_EQUAL(page_write_sizes[2], 13);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(new_image, page_test_package, 45);
+    // nothing left to write
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_fw_update_page_writer_finish(&ctx),
+                          ANJ_DM_FW_UPDATE_RESULT_SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(new_image_writes, 3);
+}
+
+ANJ_UNIT_TEST(dm_fw_update, page_writer_unaligned_start) {
+    anj_dm_fw_update_page_writer_ctx_t ctx;
+    new_image_reset();
+    // e.g. a download resumed from offset 10
+    anj_dm_fw_update_page_writer_init(&ctx, user_page_write, NULL, 16, 10);
+    page_writer_feed_all(&ctx, page_test_package, 40, 3);
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_fw_update_page_writer_finish(&ctx),
+                          ANJ_DM_FW_UPDATE_RESULT_SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(new_image_writes, 4);
+    ANJ_UNIT_ASSERT_EQUAL(page_write_sizes[0], 6);
+    ANJ_UNIT_ASSERT_EQUAL(page_write_sizes[1], 16);
+    ANJ_UNIT_ASSERT_EQUAL(page_write_sizes[2], 16);
+    ANJ_UNIT_ASSERT_EQUAL(page_write_sizes[3], 2);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(new_image, page_test_package, 40);
+}
+
+ANJ_UNIT_TEST(dm_fw_update, page_writer_error) {
+    anj_dm_fw_update_page_writer_ctx_t ctx;
+    new_image_reset();
+    anj_dm_fw_update_page_writer_init(&ctx, user_page_write, NULL, 8, 0);
+    result_to_return = ANJ_DM_FW_UPDATE_RESULT_NOT_ENOUGH_SPACE;
+    ANJ_UNIT_ASSERT_EQUAL(
+            anj_dm_fw_update_page_writer_feed(&ctx, page_test_package, 4),
+            ANJ_DM_FW_UPDATE_RESULT_SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(
+            anj_dm_fw_update_page_writer_feed(&ctx, page_test_package, 4),
+            ANJ_DM_FW_UPDATE_RESULT_NOT_ENOUGH_SPACE);
+}
+
+static anj_dm_fw_update_handlers_t page_handlers = {
+    .package_write_start_handler = &user_package_write_start_handler,
+    .package_write_handler = &user_image_write_handler,
+    .package_write_finish_handler = &user_package_write_finish_handler,
+    .uri_write_handler = &user_uri_write_handler,
+    .update_start_handler = &user_update_start_handler,
+    .reset_handler = &user_reset_handler,
+    .write_page_size = 16
+};
+
+ANJ_UNIT_TEST(dm_fw_update, page_aligned_push) {
+    INIT_ENV_DM(page_handlers);
+    new_image_reset();
+    const size_t package_size = 40;
+
+    ANJ_UNIT_ASSERT_SUCCESS(write_package_chunk(&anj, page_test_package,
+                                                package_size, 0, 25));
+    ANJ_UNIT_ASSERT_EQUAL_STRING(user_arg.order, "01");
+    ANJ_UNIT_ASSERT_SUCCESS(write_package_chunk(&anj, page_test_package,
+                                                package_size, 25, 15));
+    // the tail is written right before the finish handler
+    ANJ_UNIT_ASSERT_EQUAL_STRING(user_arg.order, "01112");
+    ANJ_UNIT_ASSERT_EQUAL(new_image_size, package_size);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(new_image, page_test_package,
+                                      package_size);
+
+    BEGIN_READ;
+    PERFORM_RESOURCE_READ(3, SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(val.int_value, ANJ_DM_FW_UPDATE_STATE_DOWNLOADED);
+    END_READ;
+}
+
+ANJ_UNIT_TEST(dm_fw_update, page_aligned_push_invalid_page_size) {
+    anj_t anj = { 0 };
+    _anj_dm_initialize(&anj);
+    anj_dm_fw_update_entity_ctx_t fu_ctx;
+    anj_dm_fw_update_handlers_t invalid_handlers = page_handlers;
+    invalid_handlers.write_page_size = ANJ_FOTA_WRITE_PAGE_MAX_SIZE + 1;
+    ANJ_UNIT_ASSERT_FAILED(anj_dm_fw_update_object_install(
+            &anj, &fu_ctx, &invalid_handlers, NULL));
+}
+#    endif // ANJ_FOTA_WITH_PAGE_ALIGNED_WRITES
+
 #endif // ANJ_WITH_DEFAULT_FOTA_OBJ
@@ -0,0 +1,252 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <anj/anj_config.h>
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/dm/core.h>
+#include <anj/dm/gateway_object.h>
+#include <anj/utils.h>
+
+#include "../../../../src/anj/coap/coap.h"
+#include "../../../../src/anj/dm/dm_integration.h"
+#include "../../../../src/anj/dm/dm_io.h"
+#include "../../../../src/anj/exchange.h"
+#include "../../../../src/anj/io/io.h"
+
+#include <anj_unit_test.h>
+
+#ifdef ANJ_WITH_LWM2M_GATEWAY
+
+static const anj_dm_res_t TEMP_RES[] = {
+    {
+        .rid = 5700,
+        .type = ANJ_DATA_TYPE_INT,
+        .kind = ANJ_DM_RES_R
+    }
+};
+
+static int temp_res_read(anj_t *anj,
+                         const anj_dm_obj_t *obj,
+                         anj_iid_t iid,
+                         anj_rid_t rid,
+                         anj_riid_t riid,
+                         anj_res_value_t *out_value) {
+    (void) anj;
+    (void) obj;
+    (void) rid;
+    (void) riid;
+    out_value->int_value = 20 + iid;
+    return 0;
+}
+
+static const anj_dm_handlers_t TEMP_HANDLERS = {
+    .res_read = temp_res_read
+};
+
+static anj_dm_obj_inst_t temp_insts[] = {
+    {
+        .iid = 0,
+        .res_count = 1,
+        .resources = TEMP_RES
+    },
+    {
+        .iid = 1,
+        .res_count = 1,
+        .resources = TEMP_RES
+    }
+};
+
+static const anj_dm_obj_t temp_obj = {
+    .oid = 3303,
+    .version = "1.1",
+    .insts = temp_insts,
+    .max_inst_count = ANJ_ARRAY_SIZE(temp_insts),
+    .handlers = &TEMP_HANDLERS
+};
+
+static const anj_dm_obj_t empty_obj = {
+    .oid = 3304,
+    .handlers = &TEMP_HANDLERS
+};
+
+static const anj_dm_obj_t device_obj = {
+    .oid = 3,
+    .handlers = &TEMP_HANDLERS
+};
+
+#    define SET_UP()                                                       \
+        static anj_dm_gateway_obj_t gateway_obj;                           \
+        anj_t anj = { 0 };                                                 \
+        _anj_dm_initialize(&anj);                                          \
+        ANJ_UNIT_ASSERT_SUCCESS(anj_dm_add_obj(&anj, &device_obj));        \
+        ANJ_UNIT_ASSERT_SUCCESS(                                           \
+                anj_dm_gateway_obj_install(&anj, &gateway_obj));           \
+        ANJ_UNIT_ASSERT_SUCCESS(anj_dm_gateway_add_device(                 \
+                &anj, &gateway_obj, 1, "sensor-0001", "dev1"));            \
+        ANJ_UNIT_ASSERT_SUCCESS(                                           \
+                anj_dm_gateway_add_obj(&anj, &gateway_obj, 1, &temp_obj)); \
+        ANJ_UNIT_ASSERT_EQUAL(anj.dm.objs_count, 2);
+
+static void read_gateway_string(anj_t *anj,
+                                anj_iid_t iid,
+                                anj_rid_t rid,
+                                const char *expected) {
+    anj_uri_path_t path = ANJ_MAKE_RESOURCE_PATH(25, iid, rid);
+    anj_io_out_entry_t record;
+    size_t count;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_dm_operation_begin(anj, ANJ_OP_DM_READ, false, &path));
+    _anj_dm_get_readable_res_count(anj, &count);
+    ANJ_UNIT_ASSERT_EQUAL(count, 1);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_dm_get_read_entry(anj, &record),
+                          _ANJ_DM_LAST_RECORD);
+    ANJ_UNIT_ASSERT_TRUE(anj_uri_path_equal(&record.path, &path));
+    ANJ_UNIT_ASSERT_EQUAL_STRING(record.value.bytes_or_string.data, expected);
+    _anj_dm_operation_end(anj, ANJ_DM_TRANSACTION_SUCCESS);
+}
+
+ANJ_UNIT_TEST(dm_gateway_object, resources) {
+    SET_UP();
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_gateway_add_device(
+            &anj, &gateway_obj, 0, "sensor-0000", "dev0"));
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_dm_gateway_add_obj(&anj, &gateway_obj, 1, &empty_obj));
+
+    read_gateway_string(&anj, 0, 0, "sensor-0000");
+    read_gateway_string(&anj, 0, 1, "dev0");
+    read_gateway_string(&anj, 0, 3, "");
+    read_gateway_string(&anj, 1, 0, "sensor-0001");
+    read_gateway_string(&anj, 1, 1, "dev1");
+    read_gateway_string(&anj, 1, 3,
+                        "</dev1/3303/0>,</dev1/3303/1>,</dev1/3304>");
+
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_dm_gateway_remove_obj(&anj, &gateway_obj, 1, 3303));
+    read_gateway_string(&anj, 1, 3, "</dev1/3304>");
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_dm_gateway_remove_device(&anj, &gateway_obj, 0));
+    read_gateway_string(&anj, 1, 1, "dev1");
+}
+
+ANJ_UNIT_TEST(dm_gateway_object, add_device_errors) {
+    SET_UP();
+    // prefixes that couldn't be told apart from the data model paths
+    ANJ_UNIT_ASSERT_FAILED(
+            anj_dm_gateway_add_device(&anj, &gateway_obj, 2, "id", ""));
+    ANJ_UNIT_ASSERT_FAILED(
+            anj_dm_gateway_add_device(&anj, &gateway_obj, 2, "id", "1dev"));
+    ANJ_UNIT_ASSERT_FAILED(
+            anj_dm_gateway_add_device(&anj, &gateway_obj, 2, "id", "bs"));
+    ANJ_UNIT_ASSERT_FAILED(
+            anj_dm_gateway_add_device(&anj, &gateway_obj, 2, "id", "de/v"));
+    // IID or prefix already used
+    ANJ_UNIT_ASSERT_FAILED(
+            anj_dm_gateway_add_device(&anj, &gateway_obj, 1, "id", "dev2"));
+    ANJ_UNIT_ASSERT_FAILED(
+            anj_dm_gateway_add_device(&anj, &gateway_obj, 2, "id", "dev1"));
+    ANJ_UNIT_ASSERT_FAILED(anj_dm_gateway_add_device(
+            &anj, &gateway_obj, ANJ_ID_INVALID, "id", "dev2"));
+
+    static char prefixes[ANJ_GATEWAY_MAX_DEVICES][8];
+    for (anj_iid_t iid = 2; iid <= ANJ_GATEWAY_MAX_DEVICES; iid++) {
+        prefixes[iid - 1][0] = 'd';
+        prefixes[iid - 1][1] = (char) ('0' + iid);
+        ANJ_UNIT_ASSERT_SUCCESS(anj_dm_gateway_add_device(
+                &anj, &gateway_obj, iid, "id", prefixes[iid - 1]));
+    }
+    ANJ_UNIT_ASSERT_FAILED(anj_dm_gateway_add_device(
+            &anj, &gateway_obj, ANJ_GATEWAY_MAX_DEVICES + 1, "id", "full"));
+
+    ANJ_UNIT_ASSERT_FAILED(anj_dm_gateway_remove_device(
+            &anj, &gateway_obj, ANJ_GATEWAY_MAX_DEVICES + 1));
+    ANJ_UNIT_ASSERT_FAILED(
+            anj_dm_gateway_add_obj(&anj, &gateway_obj, 1, &temp_obj));
+    ANJ_UNIT_ASSERT_FAILED(anj_dm_gateway_add_obj(
+            &anj, &gateway_obj, ANJ_GATEWAY_MAX_DEVICES + 1, &temp_obj));
+    ANJ_UNIT_ASSERT_FAILED(
+            anj_dm_gateway_remove_obj(&anj, &gateway_obj, 1, 3304));
+}
+
+#    ifdef ANJ_WITH_PLAINTEXT
+static void read_request(anj_t *anj,
+                         const char *prefix,
+                         const anj_uri_path_t *path,
+                         uint8_t expected_code,
+                         const char *expected_payload) {
+    _anj_coap_msg_t msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.operation = ANJ_OP_DM_READ;
+    msg.accept = _ANJ_COAP_FORMAT_PLAINTEXT;
+    msg.uri = *path;
+    msg.gateway_prefix = prefix;
+    msg.gateway_prefix_len = prefix ? strlen(prefix) : 0;
+
+    uint8_t response_code = 0;
+    _anj_exchange_handlers_t handlers;
+    _anj_dm_process_request(anj, &msg, 1, &response_code, &handlers);
+    ANJ_UNIT_ASSERT_EQUAL(response_code, expected_code);
+    if (expected_payload) {
+        char buff[50];
+        _anj_exchange_read_result_t result = { 0 };
+        ANJ_UNIT_ASSERT_SUCCESS(handlers.read_payload(
+                handlers.arg, (uint8_t *) buff, sizeof(buff), &result));
+        ANJ_UNIT_ASSERT_EQUAL(result.payload_len, strlen(expected_payload));
+        ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff, expected_payload,
+                                          result.payload_len);
+    }
+    // the data model of the Gateway is restored when the exchange ends
+    handlers.completion(handlers.arg, NULL, _ANJ_EXCHANGE_RESULT_SUCCESS);
+    ANJ_UNIT_ASSERT_FALSE(_anj_dm_gateway_device_selected(anj));
+}
+
+ANJ_UNIT_TEST(dm_gateway_object, prefixed_read) {
+    SET_UP();
+    read_request(&anj, "dev1", &ANJ_MAKE_RESOURCE_PATH(3303, 1, 5700),
+                 ANJ_COAP_CODE_CONTENT, "21");
+    ANJ_UNIT_ASSERT_EQUAL(anj.dm.objs_count, 2);
+    ANJ_UNIT_ASSERT_TRUE(anj.dm.objs[0] == &device_obj);
+    ANJ_UNIT_ASSERT_TRUE(anj.dm.objs[1] == &gateway_obj.obj);
+
+    // the Objects of the device are not in the data model of the Gateway
+    read_request(&anj, NULL, &ANJ_MAKE_RESOURCE_PATH(3303, 1, 5700),
+                 ANJ_COAP_CODE_NOT_FOUND, NULL);
+    read_request(&anj, "dev1", &ANJ_MAKE_RESOURCE_PATH(25, 1, 1),
+                 ANJ_COAP_CODE_NOT_FOUND, NULL);
+    read_request(&anj, NULL, &ANJ_MAKE_RESOURCE_PATH(25, 1, 1),
+                 ANJ_COAP_CODE_CONTENT, "dev1");
+    read_request(&anj, "dev2", &ANJ_MAKE_RESOURCE_PATH(3303, 1, 5700),
+                 ANJ_COAP_CODE_NOT_FOUND, NULL);
+    ANJ_UNIT_ASSERT_EQUAL(anj.dm.objs_count, 2);
+}
+
+ANJ_UNIT_TEST(dm_gateway_object, prefixed_bootstrap_request) {
+    SET_UP();
+    _anj_coap_msg_t msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.operation = ANJ_OP_DM_READ;
+    msg.uri = ANJ_MAKE_RESOURCE_PATH(3303, 1, 5700);
+    msg.gateway_prefix = "dev1";
+    msg.gateway_prefix_len = 4;
+
+    uint8_t response_code = 0;
+    _anj_exchange_handlers_t handlers;
+    _anj_dm_process_request(&anj, &msg, _ANJ_SSID_BOOTSTRAP, &response_code,
+                            &handlers);
+    ANJ_UNIT_ASSERT_EQUAL(response_code, ANJ_COAP_CODE_BAD_REQUEST);
+    ANJ_UNIT_ASSERT_FALSE(_anj_dm_gateway_device_selected(&anj));
+    ANJ_UNIT_ASSERT_FALSE(anj.dm.op_in_progress);
+}
+#    endif // ANJ_WITH_PLAINTEXT
+
+#endif // ANJ_WITH_LWM2M_GATEWAY
@@ -23,6 +23,7 @@
 #endif // ANJ_WITH_OBSERVE
 
 #include "../../../../src/anj/coap/coap.h"
+#include "../../../../src/anj/dm/dm_core.h"
 #include "../../../../src/anj/dm/dm_integration.h"
 #include "../../../../src/anj/dm/dm_io.h"
 #include "../../../../src/anj/exchange.h"
@@ -79,6 +80,9 @@ static int inst_delete(anj_t *anj, const anj_dm_obj_t *obj, anj_iid_t iid) {
 }
 
 static char res_4_buff[100] = { 0 };
+#ifdef ANJ_WITH_SEPARATE_RESPONSE
+static bool res_read_pending;
+#endif // ANJ_WITH_SEPARATE_RESPONSE
 static int res_read(anj_t *anj,
                     const anj_dm_obj_t *obj,
                     anj_iid_t iid,
@@ -89,6 +93,11 @@ static int res_read(anj_t *anj,
     (void) iid;
     (void) riid;
     (void) out_value;
+#ifdef ANJ_WITH_SEPARATE_RESPONSE
+    if (res_read_pending) {
+        return ANJ_DM_PENDING;
+    }
+#endif // ANJ_WITH_SEPARATE_RESPONSE
     if (rid == 4) {
         out_value->bytes_or_string.data = res_4_buff;
     } else if (riid == 1 && obj->oid != 222) {
@@ -106,6 +115,7 @@ static int res_read(anj_t *anj,
 static int res_execute_counter;
 static size_t res_execute_arg_len;
 static const char *res_execute_arg;
+static int res_execute_ret;
 static int res_execute(anj_t *anj,
                        const anj_dm_obj_t *obj,
                        anj_iid_t iid,
@@ -119,7 +129,7 @@ static int res_execute(anj_t *anj,
     res_execute_arg = execute_arg;
     res_execute_arg_len = execute_arg_len;
     res_execute_counter++;
-    return 0;
+    return res_execute_ret;
 }
 
 static int res_inst_delete(anj_t *anj,
@@ -190,6 +200,9 @@ static int transaction_validate(anj_t *anj, const anj_dm_obj_t *obj);
 static void transaction_end(anj_t *anj,
                             const anj_dm_obj_t *obj,
                             anj_dm_transaction_result_t result);
+#ifdef ANJ_DM_WITH_WRITE_BLOCK_COMMIT
+static int transaction_block_commit(anj_t *anj, const anj_dm_obj_t *obj);
+#endif // ANJ_DM_WITH_WRITE_BLOCK_COMMIT
 
 static const anj_dm_handlers_t handlers = {
     .inst_create = inst_create,
@@ -201,6 +214,9 @@ static const anj_dm_handlers_t handlers = {
     .res_read = res_read,
     .transaction_begin = transaction_begin,
     .transaction_validate = transaction_validate,
+#ifdef ANJ_DM_WITH_WRITE_BLOCK_COMMIT
+    .transaction_block_commit = transaction_block_commit,
+#endif // ANJ_DM_WITH_WRITE_BLOCK_COMMIT
     .transaction_end = transaction_end
 };
 
@@ -537,8 +553,43 @@ static void transaction_end(anj_t *anj,
     }
 }
 
+#ifdef ANJ_DM_WITH_WRITE_BLOCK_COMMIT
+static int block_commit_counter;
+static int block_commit_error;
+static int block_commit_write_value;
+static int transaction_block_commit(anj_t *anj, const anj_dm_obj_t *obj) {
+    (void) anj;
+    ASSERT_TRUE(obj == &obj_1);
+
+    block_commit_counter++;
+    block_commit_write_value = write_value;
+    return block_commit_error;
+}
+#endif // ANJ_DM_WITH_WRITE_BLOCK_COMMIT
+
 #define DEFAULT_TRANSACTION_END_RESULT 0x01
 
+#ifdef ANJ_WITH_OBSERVE
+#    define OBSERVE_INIT(Anj) _anj_observe_init(Anj)
+#else  // ANJ_WITH_OBSERVE
+#    define OBSERVE_INIT(Anj) ((void) 0)
+#endif // ANJ_WITH_OBSERVE
+
+#ifdef ANJ_WITH_TRANSIENT_ALLOC
+static ANJ_BLOCK_POOL_MEMORY(transient_memory, ANJ_TRANSIENT_ALLOC_MAX_SIZE, 1);
+static anj_block_pool_t transient_pool;
+
+#    define TRANSIENT_ALLOC_INIT(Anj)                                          \
+        ANJ_UNIT_ASSERT_SUCCESS(anj_block_pool_init(                           \
+                &transient_pool, transient_memory, sizeof(transient_memory),   \
+                ANJ_TRANSIENT_ALLOC_MAX_SIZE));                                \
+        (Anj)->transient_alloc = anj_block_pool_alloc;                         \
+        (Anj)->transient_free = anj_block_pool_free;                           \
+        (Anj)->transient_alloc_arg = &transient_pool
+#else // ANJ_WITH_TRANSIENT_ALLOC
+#    define TRANSIENT_ALLOC_INIT(Anj) ((void) 0)
+#endif // ANJ_WITH_TRANSIENT_ALLOC
+
 #define SET_UP()                                                     \
     uint8_t payload[512];                                            \
     size_t payload_len = sizeof(payload);                            \
@@ -549,6 +600,8 @@ static void transaction_end(anj_t *anj,
     msg.coap_binding_data.message_id = 0x1111;                       \
     anj_t anj = { 0 };                                               \
     _anj_dm_initialize(&anj);                                        \
+    OBSERVE_INIT(&anj);                                              \
+    TRANSIENT_ALLOC_INIT(&anj);                                      \
     ANJ_UNIT_ASSERT_SUCCESS(anj_dm_add_obj(&anj, &obj_0));           \
     ANJ_UNIT_ASSERT_SUCCESS(anj_dm_add_obj(&anj, &obj_1));           \
     ANJ_UNIT_ASSERT_SUCCESS(anj_dm_add_obj(&anj, &obj_2));           \
@@ -712,6 +765,60 @@ ANJ_UNIT_TEST(dm_integration, update_operation_with_payload) {
                           ANJ_EXCHANGE_STATE_FINISHED);
     ANJ_UNIT_ASSERT_FALSE(anj_core_ongoing_operation(&anj));
 }
+
+#ifdef ANJ_DM_WITH_REGISTER_PAYLOAD_CACHE
+static size_t read_register_payload(anj_t *anj,
+                                    uint8_t *buff,
+                                    size_t block_size) {
+    _anj_exchange_handlers_t handlers;
+    _anj_dm_process_register_update_payload(anj, &handlers);
+    size_t len = 0;
+    uint8_t ret;
+    do {
+        _anj_exchange_read_result_t result = { 0 };
+        ret = handlers.read_payload(handlers.arg, &buff[len], block_size,
+                                    &result);
+        ANJ_UNIT_ASSERT_EQUAL(result.format, _ANJ_COAP_FORMAT_LINK_FORMAT);
+        len += result.payload_len;
+    } while (ret == _ANJ_EXCHANGE_BLOCK_TRANSFER_NEEDED);
+    ANJ_UNIT_ASSERT_EQUAL(ret, 0);
+    handlers.completion(handlers.arg, NULL, 0);
+    return len;
+}
+
+ANJ_UNIT_TEST(dm_integration, register_payload_cache) {
+    SET_UP();
+    (void) payload_len;
+    ANJ_UNIT_ASSERT_FALSE(anj.dm.reg_payload_cache_valid);
+
+    char expected[] = "</111>;ver=1.1,</111/1>,</111/2>,</222>,</222/1>";
+    size_t len = read_register_payload(&anj, payload, 16);
+    ANJ_UNIT_ASSERT_EQUAL(len, sizeof(expected) - 1);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(payload, expected, len);
+    ANJ_UNIT_ASSERT_TRUE(anj.dm.reg_payload_cache_valid);
+    ANJ_UNIT_ASSERT_FALSE(anj.dm.reg_payload_cache_overflow);
+    ANJ_UNIT_ASSERT_EQUAL(anj.dm.reg_payload_cache_len, len);
+
+    // served from the cache, in blocks of different size
+    memset(payload, 0, sizeof(payload));
+    len = read_register_payload(&anj, payload, 7);
+    ANJ_UNIT_ASSERT_EQUAL(len, sizeof(expected) - 1);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(payload, expected, len);
+
+    // new Instance invalidates the cache
+    obj_2_insts[1].iid = 3;
+    _anj_dm_structure_changed(&anj.dm);
+    ANJ_UNIT_ASSERT_FALSE(anj.dm.reg_payload_cache_valid);
+    char expected_new_inst[] =
+            "</111>;ver=1.1,</111/1>,</111/2>,</222>,</222/1>,</222/3>";
+    len = read_register_payload(&anj, payload, 64);
+    ANJ_UNIT_ASSERT_EQUAL(len, sizeof(expected_new_inst) - 1);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(payload, expected_new_inst, len);
+    ANJ_UNIT_ASSERT_TRUE(anj.dm.reg_payload_cache_valid);
+    reset_obj_2_insts();
+}
+#endif // ANJ_DM_WITH_REGISTER_PAYLOAD_CACHE
+
 #ifdef ANJ_WITH_OBSERVE
 
 // discover operation on root path is not allowed
@@ -858,6 +965,38 @@ ANJ_UNIT_TEST(dm_integration, read_operation) {
     verify_payload(expected, sizeof(expected) - 1, &msg);
 }
 
+#ifdef ANJ_WITH_TLV_ENCODER
+ANJ_UNIT_TEST(dm_integration, read_operation_tlv) {
+    SET_UP();
+    msg.operation = ANJ_OP_DM_READ;
+    msg.accept = _ANJ_COAP_FORMAT_OMA_LWM2M_TLV;
+    msg.uri = ANJ_MAKE_INSTANCE_PATH(111, 2);
+    PROCESS_REQUEST(false)
+    char expected[] =
+            "\x61"             // ACK, tkl 1
+            "\x45\x11\x11\x01" // content, msg_id token
+            "\xC2\x2D\x16"     // content_format: tlv
+            "\xFF"
+            "\xC1\x00\x03" // /2/0
+            "\x88\x02\x18" // /2/2
+            "\x68\x00\x01\x08\x00\x00\x00\x00\x00\x00\x00\x06" // /2/2/1
+            "\x68\x00\x02\x08\x00\x00\x00\x00\x00\x00\x00\x07" // /2/2/2
+            "\xC0\x04"; // /2/4
+    verify_payload(expected, sizeof(expected) - 1, &msg);
+}
+
+ANJ_UNIT_TEST(dm_integration, read_operation_tlv_on_object) {
+    SET_UP();
+    msg.operation = ANJ_OP_DM_READ;
+    msg.accept = _ANJ_COAP_FORMAT_OMA_LWM2M_TLV;
+    msg.uri = ANJ_MAKE_OBJECT_PATH(111);
+    PROCESS_REQUEST_WITH_ERROR(ANJ_COAP_CODE_NOT_ACCEPTABLE);
+    char expected[] = "\x61"              // ACK, tkl 1
+                      "\x86\x11\x11\x01"; // unsupported format, msg_id token
+    verify_payload(expected, sizeof(expected) - 1, &msg);
+}
+#endif // ANJ_WITH_TLV_ENCODER
+
 ANJ_UNIT_TEST(dm_integration, read_operation_block) {
     SET_UP();
     msg.operation = ANJ_OP_DM_READ;
@@ -1052,6 +1191,10 @@ ANJ_UNIT_TEST(dm_integration, read_composite) {
                       "\x02\x00";
 
     verify_payload(expected, sizeof(expected) - 1, &msg);
+#    ifdef ANJ_WITH_TRANSIENT_ALLOC
+    // the buffer used to decode the paths has been returned
+    ANJ_UNIT_ASSERT_NOT_NULL(anj_block_pool_alloc(&transient_pool, 1));
+#    endif // ANJ_WITH_TRANSIENT_ALLOC
 }
 
 ANJ_UNIT_TEST(dm_integration, read_composite_to_many_args) {
@@ -1086,11 +1229,89 @@ ANJ_UNIT_TEST(dm_integration, read_composite_to_many_args) {
     msg.payload = (uint8_t *) input_payload;
     msg.payload_size = sizeof(input_payload) - 1;
     PROCESS_REQUEST(false);
+#    ifdef ANJ_DM_WITH_COMP_READ_PATH_STREAMING
+    // paths of a single-message request are not stored
+    char expected[] = "\x61"             // ACK, tkl 1
+                      "\x45\x11\x11\x01" // content, msg_id token
+                      "\xC1\x70"         // content_format: senmlcbor
+                      "\xFF"
+                      "\x86"
+                      "\xA2\x00\x68/111/1/0\x02\x01"
+                      "\xA2\x00\x6A/222/1/2/1\x02\x00"
+                      "\xA2\x00\x68/111/1/0\x02\x01"
+                      "\xA2\x00\x6A/222/1/2/1\x02\x00"
+                      "\xA2\x00\x68/111/1/0\x02\x01"
+                      "\xA2\x00\x6A/222/1/2/1\x02\x00";
+#    else  // ANJ_DM_WITH_COMP_READ_PATH_STREAMING
     char expected[] = "\x61"              // ACK, tkl 1
                       "\xa0\x11\x11\x01"; // internal server error, msg_id token
+#    endif // ANJ_DM_WITH_COMP_READ_PATH_STREAMING
+
+    verify_payload(expected, sizeof(expected) - 1, &msg);
+}
+
+#    ifdef ANJ_DM_WITH_COMP_READ_PATH_STREAMING
+ANJ_UNIT_TEST(dm_integration, read_composite_streamed_paths_left_for_block2) {
+    SET_UP();
+    msg.operation = ANJ_OP_DM_READ_COMP;
+    msg.accept = _ANJ_COAP_FORMAT_SENML_CBOR;
+    msg.content_format = _ANJ_COAP_FORMAT_SENML_CBOR;
+    msg.uri = ANJ_MAKE_ROOT_PATH();
+
+    char input_payload[] = {
+        "\x87"         /* array(7) */
+        "\xA1"         /* map(1) */
+        "\x00"         /* unsigned(0) => SenML Name */
+        "\x68/111/1/0" /* text(8) */
+        "\xA1\x00\x68/111/1/0"
+        "\xA1\x00\x68/111/1/0"
+        "\xA1\x00\x68/111/1/0"
+        "\xA1\x00\x68/111/1/0"
+        "\xA1\x00\x68/111/1/0"
+        "\xA1\x00\x68/111/1/0"
+    };
+
+    msg.payload = (uint8_t *) input_payload;
+    msg.payload_size = sizeof(input_payload) - 1;
+    msg.coap_binding_data.message_id++;
+
+    // only the first path fits in the first block, the other six don't fit in
+    // the buffer for the following ones
+    payload_len = 16;
+    PROCESS_REQUEST(false);
+    char expected[] = "\x61"              // ACK, tkl 1
+                      "\xa0\x11\x12\x01"; // internal server error, msg_id token
+    verify_payload(expected, sizeof(expected) - 1, &msg);
+}
+
+#        ifdef ANJ_WITH_TRANSIENT_ALLOC
+ANJ_UNIT_TEST(dm_integration, read_composite_streamed_no_transient_buffer) {
+    SET_UP();
+    msg.operation = ANJ_OP_DM_READ_COMP;
+    msg.accept = _ANJ_COAP_FORMAT_SENML_CBOR;
+    msg.content_format = _ANJ_COAP_FORMAT_SENML_CBOR;
+    msg.uri = ANJ_MAKE_ROOT_PATH();
+
+    char input_payload[] = {
+        "\x81"         /* array(1) */
+        "\xA1"         /* map(1) */
+        "\x00"         /* unsigned(0) => SenML Name */
+        "\x68/111/1/0" /* text(8) */
+    };
 
+    msg.payload = (uint8_t *) input_payload;
+    msg.payload_size = sizeof(input_payload) - 1;
+    // the only block of the pool is taken by someone else
+    void *block = anj_block_pool_alloc(&transient_pool, 1);
+    ANJ_UNIT_ASSERT_NOT_NULL(block);
+    PROCESS_REQUEST(false);
+    char expected[] = "\x61"              // ACK, tkl 1
+                      "\xa3\x11\x11\x01"; // service unavailable, msg_id token
     verify_payload(expected, sizeof(expected) - 1, &msg);
+    anj_block_pool_free(&transient_pool, block);
 }
+#        endif // ANJ_WITH_TRANSIENT_ALLOC
+#    endif // ANJ_DM_WITH_COMP_READ_PATH_STREAMING
 
 ANJ_UNIT_TEST(dm_integration, read_composite_block1) {
     SET_UP();
@@ -1215,6 +1436,70 @@ ANJ_UNIT_TEST(dm_integration,
             ANJ_EXCHANGE_STATE_FINISHED);
 }
 
+ANJ_UNIT_TEST(dm_integration,
+              read_composite_block2_first_path_exactly_fills_buf) {
+    SET_UP();
+    msg.operation = ANJ_OP_DM_READ_COMP;
+    msg.accept = _ANJ_COAP_FORMAT_SENML_CBOR;
+    msg.content_format = _ANJ_COAP_FORMAT_SENML_CBOR;
+    msg.uri = ANJ_MAKE_ROOT_PATH();
+
+    char input_payload[] = {
+        "\x82"           /* array(2) */
+        "\xA1"           /* map(1) */
+        "\x00"           /* unsigned(0) => SenML Name */
+        "\x6A/222/1/2/1" /* text(10) */
+        "\xA1"           /* map(1) */
+        "\x00"           /* unsigned(0) => SenML Name */
+        "\x68/111/1/0"   /* text(8) */
+    };
+
+    msg.payload = (uint8_t *) input_payload;
+    msg.payload_size = sizeof(input_payload) - 1;
+    msg.coap_binding_data.message_id++;
+
+    payload_len = 16;
+    PROCESS_REQUEST_BLOCK();
+    char expected1[] = "\x61"             // ACK, tkl 1
+                       "\x45\x11\x12\x01" // content, msg_id token
+                       "\xC1\x70"         // content_format: senmlcbor
+                       "\xB1\x08"         // block2 0 more
+                       "\xFF"
+                       "\x82\xA2"
+                       "\x00\x6A/222/1/2/1"
+                       "\x02\x00";
+
+    verify_payload(expected1, sizeof(expected1) - 1, &msg);
+
+    msg.operation = ANJ_OP_DM_READ_COMP;
+    msg.block.block_type = ANJ_OPTION_BLOCK_2;
+    msg.block.number = 1;
+    msg.block.more_flag = false;
+    msg.payload_size = 0;
+    msg.coap_binding_data.message_id++;
+
+    ANJ_UNIT_ASSERT_EQUAL(_anj_exchange_process(&exchange_ctx,
+                                                ANJ_EXCHANGE_EVENT_NEW_MSG,
+                                                &msg),
+                          ANJ_EXCHANGE_STATE_MSG_TO_SEND);
+
+    char expected2[] = "\x61"             // ACK, tkl 1
+                       "\x45\x11\x13\x01" // content, msg_id token
+                       "\xC1\x70"         // content_format: senmlcbor
+                       "\xB1\x10"         // block2 1
+                       "\xFF"
+                       "\xA2"
+                       "\x00\x68/111/1/0"
+                       "\x02\x01";
+
+    verify_payload(expected2, sizeof(expected2) - 1, &msg);
+
+    ANJ_UNIT_ASSERT_EQUAL(
+            _anj_exchange_process(&exchange_ctx,
+                                  ANJ_EXCHANGE_EVENT_SEND_CONFIRMATION, &msg),
+            ANJ_EXCHANGE_STATE_FINISHED);
+}
+
 ANJ_UNIT_TEST(dm_integration, read_composite_block2) {
     SET_UP();
     msg.operation = ANJ_OP_DM_READ_COMP;
@@ -2114,6 +2399,17 @@ ANJ_UNIT_TEST(dm_integration, write_composite_unauthorized) {
                       "\x81\x11\x11\x01"; // unauthorized, msg_id token
     verify_payload(expected, sizeof(expected) - 1, &msg);
 
+#        ifdef ANJ_DM_WITH_BATCHED_WRITE_COMP
+    // request is rejected before any transaction is begun
+    ASSERT_EQ(write_value, 0);
+    ASSERT_EQ(write_value2, 0);
+    ASSERT_EQ(write_value3, 0);
+
+    ASSERT_EQ(transaction_end_results[TRANSACTION_END_RESULT_OBJ_1],
+              DEFAULT_TRANSACTION_END_RESULT);
+    ASSERT_EQ(transaction_end_results[TRANSACTION_END_RESULT_OBJ_2],
+              DEFAULT_TRANSACTION_END_RESULT);
+#        else  // ANJ_DM_WITH_BATCHED_WRITE_COMP
     // it is user resposibility to restore previous values if transaction_end
     // indicates that an error has occurred
     ASSERT_EQ(write_value, 123);
@@ -2124,6 +2420,7 @@ ANJ_UNIT_TEST(dm_integration, write_composite_unauthorized) {
               ANJ_DM_TRANSACTION_FAILURE);
     ASSERT_EQ(transaction_end_results[TRANSACTION_END_RESULT_OBJ_2],
               ANJ_DM_TRANSACTION_FAILURE);
+#        endif // ANJ_DM_WITH_BATCHED_WRITE_COMP
     // transaction_end will not be called for object 0 because there will be
     // error before calling transaction_begin
     ASSERT_EQ(transaction_end_results[TRANSACTION_END_RESULT_OBJ_0],
@@ -2171,6 +2468,15 @@ ANJ_UNIT_TEST(dm_integration, write_composite_unauthorized_in_the_middle) {
                       "\x81\x11\x11\x01"; // unauthorized, msg_id token
     verify_payload(expected, sizeof(expected) - 1, &msg);
 
+#        ifdef ANJ_DM_WITH_BATCHED_WRITE_COMP
+    // request is rejected before any transaction is begun
+    ASSERT_EQ(write_value, 0);
+    ASSERT_EQ(write_value2, 0);
+    ASSERT_EQ(write_value3, 0);
+
+    ASSERT_EQ(transaction_end_results[TRANSACTION_END_RESULT_OBJ_1],
+              DEFAULT_TRANSACTION_END_RESULT);
+#        else  // ANJ_DM_WITH_BATCHED_WRITE_COMP
     // it is user resposibility to restore previous values if transaction_end
     // indicates that an error has occurred
     ASSERT_EQ(write_value, 123);
@@ -2179,6 +2485,7 @@ ANJ_UNIT_TEST(dm_integration, write_composite_unauthorized_in_the_middle) {
 
     ASSERT_EQ(transaction_end_results[TRANSACTION_END_RESULT_OBJ_1],
               ANJ_DM_TRANSACTION_FAILURE);
+#        endif // ANJ_DM_WITH_BATCHED_WRITE_COMP
     // transaction_end will not be called for objects 0 and 2 because there will
     // be error before calling transaction_begin
     ASSERT_EQ(transaction_end_results[TRANSACTION_END_RESULT_OBJ_2],
@@ -2226,6 +2533,15 @@ ANJ_UNIT_TEST(dm_integration, write_composite_nonexistent_path) {
                       "\x84\x11\x11\x01"; // not found, msg_id token
     verify_payload(expected, sizeof(expected) - 1, &msg);
 
+#        ifdef ANJ_DM_WITH_BATCHED_WRITE_COMP
+    // request is rejected before any transaction is begun
+    ASSERT_EQ(write_value, 0);
+    ASSERT_EQ(write_value2, 0);
+    ASSERT_EQ(write_value3, 0);
+
+    ASSERT_EQ(transaction_end_results[TRANSACTION_END_RESULT_OBJ_1],
+              DEFAULT_TRANSACTION_END_RESULT);
+#        else  // ANJ_DM_WITH_BATCHED_WRITE_COMP
     // it is user resposibility to restore previous values if transaction_end
     // indicates that an error has occurred
     ASSERT_EQ(write_value, 123);
@@ -2235,6 +2551,7 @@ ANJ_UNIT_TEST(dm_integration, write_composite_nonexistent_path) {
 
     ASSERT_EQ(transaction_end_results[TRANSACTION_END_RESULT_OBJ_1],
               ANJ_DM_TRANSACTION_FAILURE);
+#        endif // ANJ_DM_WITH_BATCHED_WRITE_COMP
     // transaction_end will not be called for object 2 because there will be
     // error before calling transaction_begin
     ASSERT_EQ(transaction_end_results[TRANSACTION_END_RESULT_OBJ_2],
@@ -2519,8 +2836,14 @@ ANJ_UNIT_TEST(dm_integration,
     // error before calling transaction_begin
     ASSERT_EQ(transaction_end_results[TRANSACTION_END_RESULT_OBJ_1],
               DEFAULT_TRANSACTION_END_RESULT);
+#    ifdef ANJ_DM_WITH_BATCHED_WRITE_COMP
+    // invalid path is found before any transaction is begun
+    ASSERT_EQ(transaction_end_results[TRANSACTION_END_RESULT_OBJ_2],
+              DEFAULT_TRANSACTION_END_RESULT);
+#    else  // ANJ_DM_WITH_BATCHED_WRITE_COMP
     ASSERT_EQ(transaction_end_results[TRANSACTION_END_RESULT_OBJ_2],
               ANJ_DM_TRANSACTION_FAILURE);
+#    endif // ANJ_DM_WITH_BATCHED_WRITE_COMP
 
     // restore initial state
     obj_2_res_insts[0] = 1;
@@ -2559,10 +2882,16 @@ ANJ_UNIT_TEST(dm_integration,
                       "\x85\x11\x11\x01"; // not allowed, msg_id token
     verify_payload(expected, sizeof(expected) - 1, &msg);
 
+#    ifdef ANJ_DM_WITH_BATCHED_WRITE_COMP
+    // transactions of all targeted objects are begun before writing
+    ASSERT_EQ(transaction_end_results[TRANSACTION_END_RESULT_OBJ_1],
+              ANJ_DM_TRANSACTION_FAILURE);
+#    else  // ANJ_DM_WITH_BATCHED_WRITE_COMP
     // transaction_end will not be called for object 1 because there will be
     // error before calling transaction_begin
     ASSERT_EQ(transaction_end_results[TRANSACTION_END_RESULT_OBJ_1],
               DEFAULT_TRANSACTION_END_RESULT);
+#    endif // ANJ_DM_WITH_BATCHED_WRITE_COMP
     ASSERT_EQ(transaction_end_results[TRANSACTION_END_RESULT_OBJ_2],
               ANJ_DM_TRANSACTION_FAILURE);
 
@@ -2724,8 +3053,111 @@ ANJ_UNIT_TEST(dm_integration, write_composite_block_nonexistent_path) {
     ASSERT_EQ(transaction_end_results[TRANSACTION_END_RESULT_OBJ_2],
               DEFAULT_TRANSACTION_END_RESULT);
 }
-#    endif // ANJ_WITH_LWM2M_CBOR
-#endif     // ANJ_WITH_COMPOSITE_OPERATIONS
+
+#        ifdef ANJ_DM_WITH_WRITE_BLOCK_COMMIT
+// {[111, 1, 1]: 123, [111, 2, 2, 2]: 321, [222, 1, 2, 1]: 456}
+static char block_commit_payload[] = {
+    "\xA3"         // map(3)
+    "\x83"         // array(3)
+    "\x18\x6F"     // unsigned(111)
+    "\x01"         // unsigned(1)
+    "\x01"         // unsigned(1)
+    "\x18\x7B"     // unsigned(123)
+    "\x84"         // array(4)
+    "\x18\x6F"     // unsigned(111)
+    "\x02"         // unsigned(2)
+    "\x02"         // unsigned(2)
+    "\x02"         // unsigned(2)
+    "\x19\x01\x41" // unsigned(321)
+    "\x84"         // array(4)
+    "\x18\xDE"     // unsigned(222)
+    "\x01"         // unsigned(1)
+    "\x02"         // unsigned(2)
+    "\x01"         // unsigned(1)
+    "\x19\x01\xC8" // unsigned(456)
+};
+
+ANJ_UNIT_TEST(dm_integration, write_composite_block_commit) {
+    const int block_size = 16;
+    SET_UP();
+    block_commit_counter = 0;
+    block_commit_error = 0;
+    block_commit_write_value = 0;
+    msg.operation = ANJ_OP_DM_WRITE_COMP;
+    msg.content_format = _ANJ_COAP_FORMAT_OMA_LWM2M_CBOR;
+    msg.uri = ANJ_MAKE_ROOT_PATH();
+    msg.block.block_type = ANJ_OPTION_BLOCK_1;
+    msg.block.number = 0;
+    msg.block.size = block_size;
+    msg.block.more_flag = true;
+    msg.payload = (uint8_t *) block_commit_payload;
+    msg.payload_size = block_size;
+    PROCESS_REQUEST_BLOCK();
+    char expected1[] = "\x61"             // ACK, tkl 1
+                       "\x5F\x11\x11\x01" // continue, msg_id token
+                       "\xd1\x0e\x08";    // block1 0 more
+    verify_payload(expected1, sizeof(expected1) - 1, &msg);
+    // only /111 takes part in the transaction after the first block
+    ASSERT_EQ(block_commit_counter, 1);
+    ASSERT_EQ(block_commit_write_value, 123);
+
+    msg.operation = ANJ_OP_DM_WRITE_COMP;
+    msg.block.block_type = ANJ_OPTION_BLOCK_1;
+    msg.block.number = 1;
+    msg.block.size = block_size;
+    msg.block.more_flag = false;
+    msg.payload = (uint8_t *) &block_commit_payload[block_size];
+    msg.payload_size = sizeof(block_commit_payload) - block_size - 1;
+    msg.coap_binding_data.message_id++;
+
+    ANJ_UNIT_ASSERT_EQUAL(_anj_exchange_process(&exchange_ctx,
+                                                ANJ_EXCHANGE_EVENT_NEW_MSG,
+                                                &msg),
+                          ANJ_EXCHANGE_STATE_MSG_TO_SEND);
+    char expected2[] = "\x61"             // ACK, tkl 1
+                       "\x44\x11\x12\x01" // changed, msg_id token
+                       "\xd1\x0e\x10";    // block1 1
+    verify_payload(expected2, sizeof(expected2) - 1, &msg);
+    ANJ_UNIT_ASSERT_EQUAL(
+            _anj_exchange_process(&exchange_ctx,
+                                  ANJ_EXCHANGE_EVENT_SEND_CONFIRMATION, &msg),
+            ANJ_EXCHANGE_STATE_FINISHED);
+
+    // last block is followed by validation instead
+    ASSERT_EQ(block_commit_counter, 1);
+    ASSERT_EQ(transaction_end_results[TRANSACTION_END_RESULT_OBJ_1],
+              ANJ_DM_TRANSACTION_SUCCESS);
+    ASSERT_EQ(transaction_end_results[TRANSACTION_END_RESULT_OBJ_2],
+              ANJ_DM_TRANSACTION_SUCCESS);
+}
+
+ANJ_UNIT_TEST(dm_integration, write_composite_block_commit_error) {
+    const int block_size = 16;
+    SET_UP();
+    block_commit_counter = 0;
+    block_commit_error = ANJ_DM_ERR_INTERNAL;
+    msg.operation = ANJ_OP_DM_WRITE_COMP;
+    msg.content_format = _ANJ_COAP_FORMAT_OMA_LWM2M_CBOR;
+    msg.uri = ANJ_MAKE_ROOT_PATH();
+    msg.block.block_type = ANJ_OPTION_BLOCK_1;
+    msg.block.number = 0;
+    msg.block.size = block_size;
+    msg.block.more_flag = true;
+    msg.payload = (uint8_t *) block_commit_payload;
+    msg.payload_size = block_size;
+    PROCESS_REQUEST_WITH_ERROR(ANJ_COAP_CODE_INTERNAL_SERVER_ERROR);
+    char expected[] = "\x61"              // ACK, tkl 1
+                      "\xA0\x11\x11\x01"; // internal server error
+    verify_payload(expected, sizeof(expected) - 1, &msg);
+    ASSERT_EQ(block_commit_counter, 1);
+    // changes committed so far have to be rolled back by the user
+    ASSERT_EQ(transaction_end_results[TRANSACTION_END_RESULT_OBJ_1],
+              ANJ_DM_TRANSACTION_FAILURE);
+    block_commit_error = 0;
+}
+#        endif // ANJ_DM_WITH_WRITE_BLOCK_COMMIT
+#    endif     // ANJ_WITH_LWM2M_CBOR
+#endif         // ANJ_WITH_COMPOSITE_OPERATIONS
 
 ANJ_UNIT_TEST(dm_integration, execute_operation) {
     SET_UP();
@@ -2759,6 +3191,124 @@ ANJ_UNIT_TEST(dm_integration, execute_operation_with_payload) {
     res_execute_counter = 0;
 }
 
+#ifdef ANJ_WITH_SEPARATE_RESPONSE
+#    define PROCESS_PENDING_REQUEST()                                          \
+        _anj_dm_process_request(&anj, &msg, 1, &response_code, &handlers);     \
+        ANJ_UNIT_ASSERT_EQUAL(_anj_exchange_new_server_request(                \
+                                      &exchange_ctx, response_code, &msg,      \
+                                      &handlers, payload, payload_len),        \
+                              ANJ_EXCHANGE_STATE_MSG_TO_SEND);                 \
+        verify_payload("\x60\x00\x11\x11", 4, &msg); /* Empty ACK */           \
+        ANJ_UNIT_ASSERT_EQUAL(_anj_exchange_process(                           \
+                                      &exchange_ctx,                           \
+                                      ANJ_EXCHANGE_EVENT_SEND_CONFIRMATION,    \
+                                      &msg),                                   \
+                              ANJ_EXCHANGE_STATE_WAITING_MSG);                 \
+        ANJ_UNIT_ASSERT_EQUAL(_anj_exchange_process(&exchange_ctx,             \
+                                                    ANJ_EXCHANGE_EVENT_NONE,   \
+                                                    &msg),                     \
+                              ANJ_EXCHANGE_STATE_WAITING_MSG);
+
+#    define PROCESS_SEPARATE_RESPONSE()                                        \
+        ANJ_UNIT_ASSERT_EQUAL(_anj_exchange_process(&exchange_ctx,             \
+                                                    ANJ_EXCHANGE_EVENT_NONE,   \
+                                                    &msg),                     \
+                              ANJ_EXCHANGE_STATE_MSG_TO_SEND);                 \
+        uint16_t response_mid = msg.coap_binding_data.message_id;              \
+        ANJ_UNIT_ASSERT_EQUAL(_anj_exchange_process(                           \
+                                      &exchange_ctx,                           \
+                                      ANJ_EXCHANGE_EVENT_SEND_CONFIRMATION,    \
+                                      &msg),                                   \
+                              ANJ_EXCHANGE_STATE_WAITING_MSG);
+
+#    define PROCESS_SEPARATE_RESPONSE_ACK()                                    \
+        _anj_coap_msg_t ack = {                                                \
+            .operation = ANJ_OP_COAP_EMPTY_MSG,                                \
+            .coap_binding_data = {                                             \
+                .type = ANJ_COAP_UDP_TYPE_ACKNOWLEDGEMENT,                     \
+                .message_id = response_mid                                     \
+            }                                                                  \
+        };                                                                     \
+        ANJ_UNIT_ASSERT_EQUAL(                                                 \
+                _anj_exchange_process(&exchange_ctx,                           \
+                                      ANJ_EXCHANGE_EVENT_NEW_MSG, &ack),       \
+                ANJ_EXCHANGE_STATE_FINISHED);
+
+ANJ_UNIT_TEST(dm_integration, execute_operation_pending) {
+    SET_UP();
+    res_execute_counter = 0;
+    res_execute_ret = ANJ_DM_PENDING;
+    msg.content_format = _ANJ_COAP_FORMAT_NOT_DEFINED;
+    msg.operation = ANJ_OP_DM_EXECUTE;
+    msg.uri = ANJ_MAKE_RESOURCE_PATH(111, 2, 5);
+    PROCESS_PENDING_REQUEST();
+    ANJ_UNIT_ASSERT_EQUAL(res_execute_counter, 1);
+
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_complete_pending(&anj, 0));
+    ANJ_UNIT_ASSERT_FAILED(anj_dm_complete_pending(&anj, 0));
+    PROCESS_SEPARATE_RESPONSE();
+    char expected[] = "\x41" // Confirmable, tkl 1
+                      "\x44" // changed
+                      "\x00\x00\x01";
+    expected[2] = (char) (response_mid >> 8);
+    expected[3] = (char) response_mid;
+    verify_payload(expected, sizeof(expected) - 1, &msg);
+    PROCESS_SEPARATE_RESPONSE_ACK();
+    ANJ_UNIT_ASSERT_EQUAL(res_execute_counter, 1);
+    ANJ_UNIT_ASSERT_FAILED(anj_dm_complete_pending(&anj, 0));
+    res_execute_counter = 0;
+    res_execute_ret = 0;
+}
+
+ANJ_UNIT_TEST(dm_integration, execute_operation_pending_error) {
+    SET_UP();
+    res_execute_ret = ANJ_DM_PENDING;
+    msg.content_format = _ANJ_COAP_FORMAT_NOT_DEFINED;
+    msg.operation = ANJ_OP_DM_EXECUTE;
+    msg.uri = ANJ_MAKE_RESOURCE_PATH(111, 2, 5);
+    PROCESS_PENDING_REQUEST();
+
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_dm_complete_pending(&anj, ANJ_DM_ERR_SERVICE_UNAVAILABLE));
+    PROCESS_SEPARATE_RESPONSE();
+    char expected[] = "\x41" // Confirmable, tkl 1
+                      "\xA3" // service unavailable
+                      "\x00\x00\x01";
+    expected[2] = (char) (response_mid >> 8);
+    expected[3] = (char) response_mid;
+    verify_payload(expected, sizeof(expected) - 1, &msg);
+    PROCESS_SEPARATE_RESPONSE_ACK();
+    res_execute_counter = 0;
+    res_execute_ret = 0;
+}
+
+ANJ_UNIT_TEST(dm_integration, read_operation_pending) {
+    SET_UP();
+    res_read_pending = true;
+    msg.operation = ANJ_OP_DM_READ;
+    msg.accept = _ANJ_COAP_FORMAT_SENML_CBOR;
+    msg.uri = ANJ_MAKE_RESOURCE_PATH(111, 2, 0);
+    PROCESS_PENDING_REQUEST();
+
+    // value is read again once the operation is completed
+    res_read_pending = false;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_complete_pending(&anj, 0));
+    PROCESS_SEPARATE_RESPONSE();
+    char expected[] = "\x41"         // Confirmable, tkl 1
+                      "\x45"         // content
+                      "\x00\x00\x01" // msg_id token
+                      "\xC1\x70"     // content_format: senmlcbor
+                      "\xFF"
+                      "\x81\xA2"
+                      "\x21\x68\x2F\x31\x31\x31\x2F\x32\x2F\x30" // /111/2/0
+                      "\x02\x03";                                // 3
+    expected[2] = (char) (response_mid >> 8);
+    expected[3] = (char) response_mid;
+    verify_payload(expected, sizeof(expected) - 1, &msg);
+    PROCESS_SEPARATE_RESPONSE_ACK();
+}
+#endif // ANJ_WITH_SEPARATE_RESPONSE
+
 ANJ_UNIT_TEST(dm_integration, bootstrap_discover_operation) {
     SET_UP();
     msg.operation = ANJ_OP_DM_DISCOVER;
@@ -3646,6 +4196,7 @@ ANJ_UNIT_TEST(
 ANJ_UNIT_TEST(dm_integration, delete_object_observation_update) {
     anj_t anj = { 0 };
     _anj_dm_initialize(&anj);
+    OBSERVE_INIT(&anj);
     ANJ_UNIT_ASSERT_SUCCESS(anj_dm_add_obj(&anj, &obj_1));
     ANJ_UNIT_ASSERT_SUCCESS(anj_dm_add_obj(&anj, &obj_2));
 
@@ -3673,6 +4224,7 @@ ANJ_UNIT_TEST(dm_integration, delete_object_observation_update) {
 ANJ_UNIT_TEST(dm_integration, add_object_observation_update) {
     anj_t anj = { 0 };
     _anj_dm_initialize(&anj);
+    OBSERVE_INIT(&anj);
 
     anj.observe_ctx.observations[0].ssid = 1;
     anj.observe_ctx.observations[0].path = ANJ_MAKE_RESOURCE_PATH(111, 2, 2);
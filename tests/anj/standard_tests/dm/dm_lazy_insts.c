@@ -0,0 +1,255 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/dm/core.h>
+#include <anj/utils.h>
+
+#include "../../../../src/anj/dm/dm_io.h"
+
+#include <anj_unit_test.h>
+
+#ifdef ANJ_DM_WITH_LAZY_INSTS
+
+#    define LOG_OID 20
+#    define LOG_MAX_ENTRIES 8
+
+/* IIDs of log entries, which in a real application would be kept in flash */
+static anj_iid_t log_iids[LOG_MAX_ENTRIES];
+static size_t log_count;
+
+static const anj_dm_res_t log_res[] = {
+    {
+        .rid = 0,
+        .kind = ANJ_DM_RES_R,
+        .type = ANJ_DATA_TYPE_INT
+    }
+};
+
+/* single buffer into which every looked up Instance is materialized */
+static anj_dm_obj_inst_t log_inst = {
+    .res_count = ANJ_ARRAY_SIZE(log_res),
+    .resources = log_res
+};
+
+static const anj_dm_obj_inst_t *materialize(size_t idx) {
+    if (idx >= log_count) {
+        return NULL;
+    }
+    log_inst.iid = log_iids[idx];
+    return &log_inst;
+}
+
+static size_t find_idx(anj_iid_t iid) {
+    size_t idx = 0;
+    while (idx < log_count && log_iids[idx] < iid) {
+        idx++;
+    }
+    return idx;
+}
+
+static const anj_dm_obj_inst_t *inst_lookup(const anj_dm_obj_t *obj,
+                                            anj_iid_t iid) {
+    (void) obj;
+    size_t idx = find_idx(iid);
+    return idx < log_count && log_iids[idx] == iid ? materialize(idx) : NULL;
+}
+
+static const anj_dm_obj_inst_t *inst_first(const anj_dm_obj_t *obj) {
+    (void) obj;
+    return materialize(0);
+}
+
+static const anj_dm_obj_inst_t *inst_next(const anj_dm_obj_t *obj,
+                                          anj_iid_t iid) {
+    (void) obj;
+    size_t idx = find_idx(iid);
+    if (idx < log_count && log_iids[idx] == iid) {
+        idx++;
+    }
+    return materialize(idx);
+}
+
+static int inst_create(anj_t *anj, const anj_dm_obj_t *obj, anj_iid_t iid) {
+    (void) anj;
+    (void) obj;
+    size_t idx = find_idx(iid);
+    memmove(&log_iids[idx + 1], &log_iids[idx],
+            (log_count - idx) * sizeof(log_iids[0]));
+    log_iids[idx] = iid;
+    log_count++;
+    return 0;
+}
+
+static int inst_delete(anj_t *anj, const anj_dm_obj_t *obj, anj_iid_t iid) {
+    (void) anj;
+    (void) obj;
+    size_t idx = find_idx(iid);
+    memmove(&log_iids[idx], &log_iids[idx + 1],
+            (log_count - idx - 1) * sizeof(log_iids[0]));
+    log_count--;
+    return 0;
+}
+
+static int res_read(anj_t *anj,
+                    const anj_dm_obj_t *obj,
+                    anj_iid_t iid,
+                    anj_rid_t rid,
+                    anj_riid_t riid,
+                    anj_res_value_t *out_value) {
+    (void) anj;
+    (void) obj;
+    (void) rid;
+    (void) riid;
+    out_value->int_value = 10 * iid;
+    return 0;
+}
+
+static const anj_dm_handlers_t log_handlers = {
+    .inst_lookup = inst_lookup,
+    .inst_first = inst_first,
+    .inst_next = inst_next,
+    .inst_create = inst_create,
+    .inst_delete = inst_delete,
+    .res_read = res_read
+};
+
+static const anj_dm_obj_t log_obj = {
+    .oid = LOG_OID,
+    .handlers = &log_handlers,
+    .max_inst_count = LOG_MAX_ENTRIES
+};
+
+#    define TEST_INIT(Anj)                                         \
+        anj_t Anj = { 0 };                                         \
+        _anj_dm_initialize(&Anj);                                  \
+        log_iids[0] = 1;                                           \
+        log_iids[1] = 4;                                           \
+        log_iids[2] = 7;                                           \
+        log_count = 3;                                             \
+        ANJ_UNIT_ASSERT_SUCCESS(anj_dm_add_obj(&Anj, &log_obj));
+
+ANJ_UNIT_TEST(dm_lazy_insts, read) {
+    TEST_INIT(anj);
+    anj_io_out_entry_t record = { 0 };
+    size_t out_res_count = 0;
+
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_operation_begin(
+            &anj, ANJ_OP_DM_READ, false, &ANJ_MAKE_OBJECT_PATH(LOG_OID)));
+    _anj_dm_get_readable_res_count(&anj, &out_res_count);
+    ANJ_UNIT_ASSERT_EQUAL(out_res_count, 3);
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_get_read_entry(&anj, &record));
+    ANJ_UNIT_ASSERT_TRUE(anj_uri_path_equal(
+            &record.path, &ANJ_MAKE_RESOURCE_PATH(LOG_OID, 1, 0)));
+    ANJ_UNIT_ASSERT_EQUAL(record.value.int_value, 10);
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_get_read_entry(&anj, &record));
+    ANJ_UNIT_ASSERT_TRUE(anj_uri_path_equal(
+            &record.path, &ANJ_MAKE_RESOURCE_PATH(LOG_OID, 4, 0)));
+    ANJ_UNIT_ASSERT_EQUAL(record.value.int_value, 40);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_dm_get_read_entry(&anj, &record),
+                          _ANJ_DM_LAST_RECORD);
+    ANJ_UNIT_ASSERT_TRUE(anj_uri_path_equal(
+            &record.path, &ANJ_MAKE_RESOURCE_PATH(LOG_OID, 7, 0)));
+    ANJ_UNIT_ASSERT_EQUAL(record.value.int_value, 70);
+    _anj_dm_operation_end(&anj, ANJ_DM_TRANSACTION_SUCCESS);
+
+    anj_res_value_t value;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_res_read(
+            &anj, &ANJ_MAKE_RESOURCE_PATH(LOG_OID, 4, 0), &value));
+    ANJ_UNIT_ASSERT_EQUAL(value.int_value, 40);
+    ANJ_UNIT_ASSERT_EQUAL(
+            anj_dm_res_read(&anj, &ANJ_MAKE_RESOURCE_PATH(LOG_OID, 5, 0),
+                            &value),
+            ANJ_DM_ERR_NOT_FOUND);
+}
+
+ANJ_UNIT_TEST(dm_lazy_insts, register) {
+    TEST_INIT(anj);
+    static const anj_uri_path_t expected[] = {
+        ANJ_MAKE_OBJECT_PATH(LOG_OID), ANJ_MAKE_INSTANCE_PATH(LOG_OID, 1),
+        ANJ_MAKE_INSTANCE_PATH(LOG_OID, 4), ANJ_MAKE_INSTANCE_PATH(LOG_OID, 7)
+    };
+
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_dm_operation_begin(&anj, ANJ_OP_REGISTER, false, NULL));
+    for (size_t idx = 0; idx < ANJ_ARRAY_SIZE(expected); idx++) {
+        anj_uri_path_t path;
+        const char *version;
+        ANJ_UNIT_ASSERT_EQUAL(_anj_dm_get_register_record(&anj, &path,
+                                                          &version),
+                              idx + 1 == ANJ_ARRAY_SIZE(expected)
+                                      ? _ANJ_DM_LAST_RECORD
+                                      : 0);
+        ANJ_UNIT_ASSERT_TRUE(anj_uri_path_equal(&path, &expected[idx]));
+    }
+    _anj_dm_operation_end(&anj, ANJ_DM_TRANSACTION_SUCCESS);
+}
+
+#    ifdef ANJ_WITH_DISCOVER
+ANJ_UNIT_TEST(dm_lazy_insts, discover) {
+    TEST_INIT(anj);
+    static const anj_uri_path_t expected[] = {
+        ANJ_MAKE_OBJECT_PATH(LOG_OID),
+        ANJ_MAKE_INSTANCE_PATH(LOG_OID, 1),
+        ANJ_MAKE_RESOURCE_PATH(LOG_OID, 1, 0),
+        ANJ_MAKE_INSTANCE_PATH(LOG_OID, 4),
+        ANJ_MAKE_RESOURCE_PATH(LOG_OID, 4, 0),
+        ANJ_MAKE_INSTANCE_PATH(LOG_OID, 7),
+        ANJ_MAKE_RESOURCE_PATH(LOG_OID, 7, 0)
+    };
+
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_operation_begin(
+            &anj, ANJ_OP_DM_DISCOVER, false, &ANJ_MAKE_OBJECT_PATH(LOG_OID)));
+    for (size_t idx = 0; idx < ANJ_ARRAY_SIZE(expected); idx++) {
+        anj_uri_path_t path;
+        const char *version;
+        const uint16_t *dim;
+        ANJ_UNIT_ASSERT_EQUAL(_anj_dm_get_discover_record(&anj, &path,
+                                                          &version, &dim),
+                              idx + 1 == ANJ_ARRAY_SIZE(expected)
+                                      ? _ANJ_DM_LAST_RECORD
+                                      : 0);
+        ANJ_UNIT_ASSERT_TRUE(anj_uri_path_equal(&path, &expected[idx]));
+    }
+    _anj_dm_operation_end(&anj, ANJ_DM_TRANSACTION_SUCCESS);
+}
+#    endif // ANJ_WITH_DISCOVER
+
+ANJ_UNIT_TEST(dm_lazy_insts, create_and_delete) {
+    TEST_INIT(anj);
+
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_operation_begin(
+            &anj, ANJ_OP_DM_CREATE, false, &ANJ_MAKE_OBJECT_PATH(LOG_OID)));
+    ANJ_UNIT_ASSERT_EQUAL(_anj_dm_create_object_instance(&anj, 4),
+                          ANJ_DM_ERR_BAD_REQUEST);
+    _anj_dm_operation_end(&anj, ANJ_DM_TRANSACTION_FAILURE);
+
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_operation_begin(
+            &anj, ANJ_OP_DM_CREATE, false, &ANJ_MAKE_OBJECT_PATH(LOG_OID)));
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_dm_create_object_instance(&anj, ANJ_ID_INVALID));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_operation_validate(&anj));
+    _anj_dm_operation_end(&anj, ANJ_DM_TRANSACTION_SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(log_count, 4);
+    ANJ_UNIT_ASSERT_EQUAL(log_iids[0], 0);
+
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_dm_operation_begin(&anj, ANJ_OP_DM_DELETE, false,
+                                    &ANJ_MAKE_INSTANCE_PATH(LOG_OID, 4)));
+    _anj_dm_operation_end(&anj, ANJ_DM_TRANSACTION_SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(log_count, 3);
+    ANJ_UNIT_ASSERT_EQUAL(log_iids[1], 1);
+    ANJ_UNIT_ASSERT_EQUAL(log_iids[2], 7);
+}
+
+#endif // ANJ_DM_WITH_LAZY_INSTS
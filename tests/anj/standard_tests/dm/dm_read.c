@@ -9,6 +9,7 @@
 
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <anj/anj_config.h>
 #include <anj/core.h>
@@ -19,6 +20,7 @@
 #include "../../../../src/anj/dm/dm_core.h"
 #include "../../../../src/anj/dm/dm_io.h"
 #include "../../../../src/anj/io/io.h"
+#include "../mock/time_api_mock.h"
 
 #include <anj_unit_test.h>
 
@@ -447,6 +449,410 @@ ANJ_UNIT_TEST(dm_read, read_obj) {
     _anj_dm_operation_end(&anj, ANJ_DM_TRANSACTION_SUCCESS);
 }
 
+#ifdef ANJ_DM_WITH_READABLE_RES_COUNT_CACHE
+static size_t read_obj_res_count(anj_t *anj, anj_oid_t oid) {
+    size_t out_res_count = 0;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_operation_begin(
+            anj, ANJ_OP_DM_READ, false, &ANJ_MAKE_OBJECT_PATH(oid)));
+    _anj_dm_get_readable_res_count(anj, &out_res_count);
+    _anj_dm_operation_end(anj, ANJ_DM_TRANSACTION_SUCCESS);
+    return out_res_count;
+}
+
+ANJ_UNIT_TEST(dm_read, readable_res_count_cache) {
+    READ_INIT(anj);
+    ANJ_UNIT_ASSERT_EQUAL(read_obj_res_count(&anj, 1), 7);
+    ANJ_UNIT_ASSERT_TRUE(anj.dm.readable_res_count_valid[1]);
+
+    // change not reported yet, cached value is used
+    obj1_insts[0].res_count = 0;
+    size_t stale_count = read_obj_res_count(&anj, 1);
+    anj_core_data_model_changed(&anj, &ANJ_MAKE_INSTANCE_PATH(1, 0),
+                                ANJ_CORE_CHANGE_TYPE_ADDED);
+    bool valid_after_change = anj.dm.readable_res_count_valid[1];
+    size_t fresh_count = read_obj_res_count(&anj, 1);
+    obj1_insts[0].res_count = 2;
+    ANJ_UNIT_ASSERT_EQUAL(stale_count, 7);
+    ANJ_UNIT_ASSERT_FALSE(valid_after_change);
+    ANJ_UNIT_ASSERT_EQUAL(fresh_count, 6);
+
+    // adding an Object moves the others, so all counts are invalidated
+    anj_dm_obj_t obj_5 = {
+        .oid = 5
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_add_obj(&anj, &obj_5));
+    ANJ_UNIT_ASSERT_EQUAL(read_obj_res_count(&anj, 1), 7);
+    ANJ_UNIT_ASSERT_EQUAL(read_obj_res_count(&anj, 10), 2);
+}
+#endif // ANJ_DM_WITH_READABLE_RES_COUNT_CACHE
+
+#ifdef ANJ_DM_WITH_RES_READ_BATCH
+static size_t read_batch_calls;
+static anj_iid_t read_batch_iid;
+static const anj_rid_t *read_batch_rids;
+static size_t read_batch_rids_count;
+
+static int res_read_batch(anj_t *anj,
+                          const anj_dm_obj_t *obj,
+                          anj_iid_t iid,
+                          const anj_rid_t *rids,
+                          size_t rids_count) {
+    (void) anj;
+    (void) obj;
+    read_batch_calls++;
+    read_batch_iid = iid;
+    read_batch_rids = rids;
+    read_batch_rids_count = rids_count;
+    return 0;
+}
+
+ANJ_UNIT_TEST(dm_read, read_batch) {
+    anj_t anj = { 0 };
+    _anj_dm_initialize(&anj);
+    anj_dm_handlers_t batch_handlers = handlers;
+    batch_handlers.res_read_batch = res_read_batch;
+    anj_dm_obj_t batch_obj = obj1;
+    batch_obj.handlers = &batch_handlers;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_add_obj(&anj, &batch_obj));
+    anj_io_out_entry_t record = { 0 };
+    size_t out_res_count = 0;
+    read_batch_calls = 0;
+
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_operation_begin(
+            &anj, ANJ_OP_DM_READ, false, &ANJ_MAKE_OBJECT_PATH(1)));
+    _anj_dm_get_readable_res_count(&anj, &out_res_count);
+    ANJ_UNIT_ASSERT_EQUAL(out_res_count, 7);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_dm_get_read_entry(&anj, &record), 0);
+    ANJ_UNIT_ASSERT_EQUAL(read_batch_calls, 1);
+    ANJ_UNIT_ASSERT_EQUAL(read_batch_iid, 0);
+    ANJ_UNIT_ASSERT_NULL(read_batch_rids);
+    for (size_t i = 0; i < 5; i++) {
+        ANJ_UNIT_ASSERT_EQUAL(_anj_dm_get_read_entry(&anj, &record), 0);
+    }
+    ANJ_UNIT_ASSERT_EQUAL(_anj_dm_get_read_entry(&anj, &record),
+                          _ANJ_DM_LAST_RECORD);
+    ANJ_UNIT_ASSERT_EQUAL(read_batch_calls, 2);
+    ANJ_UNIT_ASSERT_EQUAL(read_batch_iid, 1);
+    ANJ_UNIT_ASSERT_NULL(read_batch_rids);
+    _anj_dm_operation_end(&anj, ANJ_DM_TRANSACTION_SUCCESS);
+
+    // Multiple-Instance Resource, prepared once for all its instances
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_operation_begin(
+            &anj, ANJ_OP_DM_READ, false, &ANJ_MAKE_RESOURCE_PATH(1, 1, 4)));
+    ANJ_UNIT_ASSERT_EQUAL(_anj_dm_get_read_entry(&anj, &record), 0);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_dm_get_read_entry(&anj, &record),
+                          _ANJ_DM_LAST_RECORD);
+    ANJ_UNIT_ASSERT_EQUAL(read_batch_calls, 3);
+    ANJ_UNIT_ASSERT_EQUAL(read_batch_iid, 1);
+    ANJ_UNIT_ASSERT_EQUAL(read_batch_rids_count, 1);
+    ANJ_UNIT_ASSERT_EQUAL(read_batch_rids[0], 4);
+    _anj_dm_operation_end(&anj, ANJ_DM_TRANSACTION_SUCCESS);
+
+    // reads outside of operations don't call the handler
+    anj_res_value_t value;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_dm_res_read(&anj, &ANJ_MAKE_RESOURCE_PATH(1, 0, 0), &value));
+    ANJ_UNIT_ASSERT_EQUAL(read_batch_calls, 3);
+}
+#endif // ANJ_DM_WITH_RES_READ_BATCH
+
+#ifdef ANJ_DM_WITH_READ_CACHE
+static size_t cached_res_read_calls[3];
+
+static int cached_res_read(anj_t *anj,
+                           const anj_dm_obj_t *obj,
+                           anj_iid_t iid,
+                           anj_rid_t rid,
+                           anj_riid_t riid,
+                           anj_res_value_t *out_value) {
+    (void) anj;
+    (void) obj;
+    (void) iid;
+    (void) riid;
+    cached_res_read_calls[rid]++;
+    if (rid == 1) {
+        out_value->bytes_or_string.data = "text";
+    } else {
+        out_value->int_value = (int64_t) cached_res_read_calls[rid];
+    }
+    return 0;
+}
+
+#    define READ_CACHED_OBJ(Anj, Expected_0, Expected_2)                      \
+        do {                                                                  \
+            anj_io_out_entry_t record = { 0 };                                \
+            ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_operation_begin(                  \
+                    &Anj, ANJ_OP_DM_READ, false, &ANJ_MAKE_OBJECT_PATH(32))); \
+            ANJ_UNIT_ASSERT_EQUAL(_anj_dm_get_read_entry(&Anj, &record), 0);  \
+            VERIFY_ENTRY(record, &ANJ_MAKE_RESOURCE_PATH(32, 0, 0),           \
+                         Expected_0);                                         \
+            ANJ_UNIT_ASSERT_EQUAL(_anj_dm_get_read_entry(&Anj, &record), 0);  \
+            ANJ_UNIT_ASSERT_EQUAL(_anj_dm_get_read_entry(&Anj, &record),      \
+                                  _ANJ_DM_LAST_RECORD);                       \
+            VERIFY_ENTRY(record, &ANJ_MAKE_RESOURCE_PATH(32, 0, 2),           \
+                         Expected_2);                                         \
+            _anj_dm_operation_end(&Anj, ANJ_DM_TRANSACTION_SUCCESS);          \
+        } while (0)
+
+ANJ_UNIT_TEST(dm_read, read_cache) {
+    anj_t anj = { 0 };
+    _anj_dm_initialize(&anj);
+    mock_time_reset();
+    memset(cached_res_read_calls, 0, sizeof(cached_res_read_calls));
+    static const anj_dm_handlers_t cached_handlers = {
+        .res_read = cached_res_read
+    };
+    static const anj_dm_res_t res[] = {
+        {
+            .rid = 0,
+            .kind = ANJ_DM_RES_R,
+            .type = ANJ_DATA_TYPE_INT,
+            .read_cache_max_age_ms = 1000
+        },
+        {
+            .rid = 1,
+            .kind = ANJ_DM_RES_R,
+            .type = ANJ_DATA_TYPE_STRING,
+            .read_cache_max_age_ms = 1000
+        },
+        {
+            .rid = 2,
+            .kind = ANJ_DM_RES_R,
+            .type = ANJ_DATA_TYPE_INT
+        }
+    };
+    anj_dm_obj_inst_t inst = {
+        .iid = 0,
+        .res_count = ANJ_ARRAY_SIZE(res),
+        .resources = res
+    };
+    anj_dm_obj_t obj = {
+        .oid = 32,
+        .insts = &inst,
+        .max_inst_count = 1,
+        .handlers = &cached_handlers
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_add_obj(&anj, &obj));
+
+    READ_CACHED_OBJ(anj, 1, 1);
+    // only the value of the integer Resource with max-age is cached
+    mock_time_advance(anj_time_duration_new(999, ANJ_TIME_UNIT_MS));
+    READ_CACHED_OBJ(anj, 1, 2);
+    anj_res_value_t value;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_dm_res_read(&anj, &ANJ_MAKE_RESOURCE_PATH(32, 0, 0), &value));
+    ANJ_UNIT_ASSERT_EQUAL(value.int_value, 1);
+    ANJ_UNIT_ASSERT_EQUAL(cached_res_read_calls[0], 1);
+    ANJ_UNIT_ASSERT_EQUAL(cached_res_read_calls[1], 2);
+
+    // expired
+    mock_time_advance(anj_time_duration_new(1, ANJ_TIME_UNIT_MS));
+    READ_CACHED_OBJ(anj, 2, 3);
+
+    // changes of the Resource or Object drop the cached value
+    _anj_dm_read_cache_invalidate(&anj.dm, &ANJ_MAKE_RESOURCE_PATH(32, 0, 2));
+    READ_CACHED_OBJ(anj, 2, 4);
+    _anj_dm_read_cache_invalidate(&anj.dm, &ANJ_MAKE_OBJECT_PATH(32));
+    READ_CACHED_OBJ(anj, 3, 5);
+    _anj_dm_structure_changed(&anj.dm);
+    READ_CACHED_OBJ(anj, 4, 6);
+}
+#endif // ANJ_DM_WITH_READ_CACHE
+
+#ifdef ANJ_DM_WITH_SHARED_RES_DEFS
+static int shared_res_read(anj_t *anj,
+                           const anj_dm_obj_t *obj,
+                           anj_iid_t iid,
+                           anj_rid_t rid,
+                           anj_riid_t riid,
+                           anj_res_value_t *out_value) {
+    (void) anj;
+    (void) obj;
+    (void) rid;
+    out_value->int_value = 100 * iid + riid;
+    return 0;
+}
+
+static const anj_dm_res_t shared_res[] = {
+    {
+        .rid = 0,
+        .kind = ANJ_DM_RES_R,
+        .type = ANJ_DATA_TYPE_INT,
+    },
+    {
+        .rid = 1,
+        .kind = ANJ_DM_RES_RM,
+        .type = ANJ_DATA_TYPE_INT,
+        .max_inst_count = 2
+    }
+};
+
+ANJ_UNIT_TEST(dm_read, shared_res_defs) {
+    anj_t anj = { 0 };
+    _anj_dm_initialize(&anj);
+    static const anj_dm_handlers_t shared_handlers = {
+        .res_read = shared_res_read
+    };
+    static const anj_riid_t inst_0_riids[] = { 3, ANJ_ID_INVALID };
+    static const anj_riid_t inst_1_riids[] = { 1, 2 };
+    static const anj_riid_t *const inst_0_res_insts[] = { NULL,
+                                                          inst_0_riids };
+    static const anj_riid_t *const inst_1_res_insts[] = { NULL,
+                                                          inst_1_riids };
+    anj_dm_obj_inst_t insts[] = {
+        {
+            .iid = 0,
+            .res_count = ANJ_ARRAY_SIZE(shared_res),
+            .resources = shared_res,
+            .res_insts = inst_0_res_insts
+        },
+        {
+            .iid = 1,
+            .res_count = ANJ_ARRAY_SIZE(shared_res),
+            .resources = shared_res,
+            .res_insts = inst_1_res_insts
+        }
+    };
+    anj_dm_obj_t obj = {
+        .oid = 30,
+        .insts = insts,
+        .max_inst_count = ANJ_ARRAY_SIZE(insts),
+        .handlers = &shared_handlers
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_add_obj(&anj, &obj));
+
+    anj_io_out_entry_t record = { 0 };
+    size_t out_res_count = 0;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_operation_begin(
+            &anj, ANJ_OP_DM_READ, false, &ANJ_MAKE_OBJECT_PATH(30)));
+    _anj_dm_get_readable_res_count(&anj, &out_res_count);
+    ANJ_UNIT_ASSERT_EQUAL(out_res_count, 5);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_dm_get_read_entry(&anj, &record), 0);
+    VERIFY_ENTRY(record, &ANJ_MAKE_RESOURCE_PATH(30, 0, 0), 65535);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_dm_get_read_entry(&anj, &record), 0);
+    VERIFY_ENTRY(record, &ANJ_MAKE_RESOURCE_INSTANCE_PATH(30, 0, 1, 3), 3);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_dm_get_read_entry(&anj, &record), 0);
+    VERIFY_ENTRY(record, &ANJ_MAKE_RESOURCE_PATH(30, 1, 0), 65635);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_dm_get_read_entry(&anj, &record), 0);
+    VERIFY_ENTRY(record, &ANJ_MAKE_RESOURCE_INSTANCE_PATH(30, 1, 1, 1), 101);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_dm_get_read_entry(&anj, &record),
+                          _ANJ_DM_LAST_RECORD);
+    VERIFY_ENTRY(record, &ANJ_MAKE_RESOURCE_INSTANCE_PATH(30, 1, 1, 2), 102);
+    _anj_dm_operation_end(&anj, ANJ_DM_TRANSACTION_SUCCESS);
+
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_operation_begin(
+            &anj, ANJ_OP_DM_READ, false,
+            &ANJ_MAKE_RESOURCE_INSTANCE_PATH(30, 0, 1, 3)));
+    _anj_dm_operation_end(&anj, ANJ_DM_TRANSACTION_SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(
+            _anj_dm_operation_begin(
+                    &anj, ANJ_OP_DM_READ, false,
+                    &ANJ_MAKE_RESOURCE_INSTANCE_PATH(30, 1, 1, 3)),
+            ANJ_DM_ERR_NOT_FOUND);
+}
+#endif // ANJ_DM_WITH_SHARED_RES_DEFS
+
+#ifdef ANJ_DM_WITH_RES_INST_BITMAP
+static int bitmap_res_read(anj_t *anj,
+                           const anj_dm_obj_t *obj,
+                           anj_iid_t iid,
+                           anj_rid_t rid,
+                           anj_riid_t riid,
+                           anj_res_value_t *out_value) {
+    (void) anj;
+    (void) obj;
+    (void) iid;
+    out_value->int_value = 1000 * rid + riid;
+    return 0;
+}
+
+ANJ_UNIT_TEST(dm_read, res_inst_bitmap) {
+    anj_t anj = { 0 };
+    _anj_dm_initialize(&anj);
+    static const anj_dm_handlers_t bitmap_handlers = {
+        .res_read = bitmap_res_read
+    };
+    // RIIDs 1, 40 and 99
+    static const uint32_t bitmap[ANJ_DM_RES_INST_BITMAP_SIZE(100)] = {
+        UINT32_C(1) << 1, UINT32_C(1) << (40 - 32), 0, UINT32_C(1) << (99 - 96)
+    };
+    static const uint32_t empty_bitmap[ANJ_DM_RES_INST_BITMAP_SIZE(8)] = { 0 };
+    anj_dm_res_t res[] = {
+        {
+            .rid = 0,
+            .kind = ANJ_DM_RES_RM,
+            .type = ANJ_DATA_TYPE_INT,
+            .max_inst_count = 100,
+            .insts_bitmap = bitmap
+        },
+        {
+            .rid = 1,
+            .kind = ANJ_DM_RES_RM,
+            .type = ANJ_DATA_TYPE_INT,
+            .max_inst_count = 8,
+            .insts_bitmap = empty_bitmap
+        }
+    };
+    anj_dm_obj_inst_t inst = {
+        .iid = 0,
+        .res_count = ANJ_ARRAY_SIZE(res),
+        .resources = res
+    };
+    anj_dm_obj_t obj = {
+        .oid = 31,
+        .insts = &inst,
+        .max_inst_count = 1,
+        .handlers = &bitmap_handlers
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_add_obj(&anj, &obj));
+
+    anj_io_out_entry_t record = { 0 };
+    size_t out_res_count = 0;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_operation_begin(
+            &anj, ANJ_OP_DM_READ, false, &ANJ_MAKE_OBJECT_PATH(31)));
+    _anj_dm_get_readable_res_count(&anj, &out_res_count);
+    ANJ_UNIT_ASSERT_EQUAL(out_res_count, 3);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_dm_get_read_entry(&anj, &record), 0);
+    VERIFY_ENTRY(record, &ANJ_MAKE_RESOURCE_INSTANCE_PATH(31, 0, 0, 1), 1);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_dm_get_read_entry(&anj, &record), 0);
+    VERIFY_ENTRY(record, &ANJ_MAKE_RESOURCE_INSTANCE_PATH(31, 0, 0, 40), 40);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_dm_get_read_entry(&anj, &record),
+                          _ANJ_DM_LAST_RECORD);
+    VERIFY_ENTRY(record, &ANJ_MAKE_RESOURCE_INSTANCE_PATH(31, 0, 0, 99), 99);
+    _anj_dm_operation_end(&anj, ANJ_DM_TRANSACTION_SUCCESS);
+
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_operation_begin(
+            &anj, ANJ_OP_DM_READ, false, &ANJ_MAKE_RESOURCE_PATH(31, 0, 0)));
+    _anj_dm_get_readable_res_count(&anj, &out_res_count);
+    ANJ_UNIT_ASSERT_EQUAL(out_res_count, 3);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_dm_get_read_entry(&anj, &record), 0);
+    VERIFY_ENTRY(record, &ANJ_MAKE_RESOURCE_INSTANCE_PATH(31, 0, 0, 1), 1);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_dm_get_read_entry(&anj, &record), 0);
+    VERIFY_ENTRY(record, &ANJ_MAKE_RESOURCE_INSTANCE_PATH(31, 0, 0, 40), 40);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_dm_get_read_entry(&anj, &record),
+                          _ANJ_DM_LAST_RECORD);
+    VERIFY_ENTRY(record, &ANJ_MAKE_RESOURCE_INSTANCE_PATH(31, 0, 0, 99), 99);
+    _anj_dm_operation_end(&anj, ANJ_DM_TRANSACTION_SUCCESS);
+
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_operation_begin(
+            &anj, ANJ_OP_DM_READ, false,
+            &ANJ_MAKE_RESOURCE_INSTANCE_PATH(31, 0, 0, 40)));
+    _anj_dm_operation_end(&anj, ANJ_DM_TRANSACTION_SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(
+            _anj_dm_operation_begin(
+                    &anj, ANJ_OP_DM_READ, false,
+                    &ANJ_MAKE_RESOURCE_INSTANCE_PATH(31, 0, 0, 41)),
+            ANJ_DM_ERR_NOT_FOUND);
+    _anj_dm_operation_end(&anj, ANJ_DM_TRANSACTION_FAILURE);
+    ANJ_UNIT_ASSERT_EQUAL(
+            _anj_dm_operation_begin(
+                    &anj, ANJ_OP_DM_READ, false,
+                    &ANJ_MAKE_RESOURCE_INSTANCE_PATH(31, 0, 0, 100)),
+            ANJ_DM_ERR_NOT_FOUND);
+    _anj_dm_operation_end(&anj, ANJ_DM_TRANSACTION_FAILURE);
+}
+#endif // ANJ_DM_WITH_RES_INST_BITMAP
+
 ANJ_UNIT_TEST(dm_read, read_obj_error) {
     READ_INIT(anj);
 
@@ -155,6 +155,7 @@ int anj_crypto_storage_resolve_persistence_info(
 }
 #    endif // ANJ_WITH_EXTERNAL_CRYPTO_STORAGE
 
+#    ifndef ANJ_SEC_OBJ_WITH_EXTERNAL_KEYS_ONLY
 ANJ_UNIT_TEST(dm_security_object, check_resources_values) {
     INIT_ENV();
 
@@ -258,6 +259,7 @@ ANJ_UNIT_TEST(dm_security_object, check_resources_values) {
             == sec_obj.security_instances[1].server_public_key_buff);
     RESOURCE_CHECK_INT(1, sec_obj.security_instances[1].ssid, 2);
 }
+#    endif // ANJ_SEC_OBJ_WITH_EXTERNAL_KEYS_ONLY
 
 ANJ_UNIT_TEST(dm_security_object, create_instance_minimal) {
     INIT_ENV();
@@ -541,6 +543,7 @@ ANJ_UNIT_TEST(dm_security_object, errors) {
     _anj_dm_operation_end(&anj, ANJ_DM_TRANSACTION_FAILURE);
 }
 
+#    ifndef ANJ_SEC_OBJ_WITH_EXTERNAL_KEYS_ONLY
 ANJ_UNIT_TEST(dm_security_object, get_psk_check) {
     INIT_ENV();
 
@@ -604,6 +607,96 @@ ANJ_UNIT_TEST(dm_security_object, get_psk_check) {
                           ANJ_CRYPTO_SECURITY_TAG_PSK_IDENTITY);
     ANJ_UNIT_ASSERT_EQUAL(psk_key.tag, ANJ_CRYPTO_SECURITY_TAG_PSK_KEY);
 }
+#    endif // ANJ_SEC_OBJ_WITH_EXTERNAL_KEYS_ONLY
+
+#    ifdef ANJ_SEC_OBJ_WITH_EXTERNAL_KEYS_ONLY
+ANJ_UNIT_TEST(dm_security_object, external_keys_only) {
+    INIT_ENV();
+
+    anj_dm_security_instance_init_t inst_1 = {
+        .ssid = 1,
+        .bootstrap_server = false,
+        .server_uri = "coaps://dddd:777",
+        .security_mode = ANJ_DM_SECURITY_PSK,
+        .public_key_or_identity = {
+            .source = ANJ_CRYPTO_DATA_SOURCE_BUFFER,
+            .info.buffer.data = "public",
+            .info.buffer.data_size = strlen("public")
+        }
+    };
+    // key material can't be copied into the Security Object
+    ANJ_UNIT_ASSERT_FAILED(anj_dm_security_obj_add_instance(&sec_obj, &inst_1));
+
+    inst_1.public_key_or_identity = (anj_crypto_security_info_t) {
+        .source = ANJ_CRYPTO_DATA_SOURCE_EXTERNAL,
+        .info.external.identity = "public"
+    };
+    inst_1.secret_key = (anj_crypto_security_info_t) {
+        .source = ANJ_CRYPTO_DATA_SOURCE_EXTERNAL,
+        .info.external.identity = "secret"
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_dm_security_obj_add_instance(&sec_obj, &inst_1));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_security_obj_install(&anj, &sec_obj));
+
+    anj_crypto_security_info_t psk_identity;
+    anj_crypto_security_info_t psk_key;
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_dm_security_obj_get_psk(&anj, false, &psk_identity, &psk_key));
+    ANJ_UNIT_ASSERT_EQUAL(psk_identity.source, ANJ_CRYPTO_DATA_SOURCE_EXTERNAL);
+    ANJ_UNIT_ASSERT_EQUAL_STRING(psk_identity.info.external.identity,
+                                 "public");
+    ANJ_UNIT_ASSERT_EQUAL(psk_key.source, ANJ_CRYPTO_DATA_SOURCE_EXTERNAL);
+    ANJ_UNIT_ASSERT_EQUAL_STRING(psk_key.info.external.identity, "secret");
+}
+#    endif // ANJ_SEC_OBJ_WITH_EXTERNAL_KEYS_ONLY
+
+#    if defined(ANJ_WITH_RAW_PUBLIC_KEY) \
+            && defined(ANJ_WITH_EXTERNAL_CRYPTO_STORAGE)
+ANJ_UNIT_TEST(dm_security_object, get_rpk_check) {
+    INIT_ENV();
+
+    anj_dm_security_instance_init_t inst_1 = {
+        .ssid = 1,
+        .bootstrap_server = false,
+        .server_uri = "coaps://dddd:777",
+        .security_mode = ANJ_DM_SECURITY_RPK,
+        .public_key_or_identity = {
+            .source = ANJ_CRYPTO_DATA_SOURCE_EXTERNAL,
+            .info.external.identity = "public"
+        },
+        .server_public_key = {
+            .source = ANJ_CRYPTO_DATA_SOURCE_EXTERNAL,
+            .info.external.identity = "server"
+        },
+        .secret_key = {
+            .source = ANJ_CRYPTO_DATA_SOURCE_EXTERNAL,
+            .info.external.identity = "secret"
+        }
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_dm_security_obj_add_instance(&sec_obj, &inst_1));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_security_obj_install(&anj, &sec_obj));
+
+    anj_net_rpk_info_t rpk;
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_security_obj_get_rpk(&anj, true, &rpk),
+                          ANJ_DM_ERR_NOT_FOUND);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_security_obj_get_rpk(&anj, false, &rpk));
+    ANJ_UNIT_ASSERT_EQUAL_STRING(rpk.public_key.info.external.identity,
+                                 "public");
+    ANJ_UNIT_ASSERT_EQUAL_STRING(rpk.private_key.info.external.identity,
+                                 "secret");
+    ANJ_UNIT_ASSERT_EQUAL_STRING(rpk.server_public_key.info.external.identity,
+                                 "server");
+    ANJ_UNIT_ASSERT_EQUAL(rpk.public_key.tag,
+                          ANJ_CRYPTO_SECURITY_TAG_CERTIFICATE_CHAIN);
+    ANJ_UNIT_ASSERT_EQUAL(rpk.private_key.tag,
+                          ANJ_CRYPTO_SECURITY_TAG_PRIVATE_KEY);
+    ANJ_UNIT_ASSERT_EQUAL(rpk.server_public_key.tag,
+                          ANJ_CRYPTO_SECURITY_TAG_CERTIFICATE_CHAIN);
+}
+#    endif // defined(ANJ_WITH_RAW_PUBLIC_KEY) &&
+           // defined(ANJ_WITH_EXTERNAL_CRYPTO_STORAGE)
 
 ///////////////////////////////////////////////////////////////////////
 ////////////////////////// PERSISTENCE TESTS //////////////////////////
@@ -727,6 +820,7 @@ ANJ_UNIT_TEST(dm_security_object, persistence_no_sec_basic) {
         Inst->secret_key.info.buffer.data = NULL;             \
         Inst->server_public_key.info.buffer.data = NULL;
 
+#    ifndef ANJ_SEC_OBJ_WITH_EXTERNAL_KEYS_ONLY
 ANJ_UNIT_TEST(dm_security_object, persistence_psk_instance) {
     INIT_ENV_PERSISTENCE(anj, sec_obj);
     INIT_ENV_PERSISTENCE(anj_2, sec_obj_2);
@@ -761,6 +855,66 @@ ANJ_UNIT_TEST(dm_security_object, persistence_psk_instance) {
     compare_objects_after_persistence(&sec_obj, &sec_obj_2);
 }
 
+#        ifdef ANJ_PERSISTENCE_WITH_MEMORY_MAPPED_RESTORE
+ANJ_UNIT_TEST(dm_security_object, persistence_memory_mapped_restore) {
+    INIT_ENV_PERSISTENCE(anj, sec_obj);
+    INIT_ENV_PERSISTENCE(anj_2, sec_obj_2);
+
+    anj_dm_security_instance_init_t inst_1 = {
+        .ssid = 1,
+        .bootstrap_server = false,
+        .server_uri = "coaps://dddd:777",
+        .security_mode = ANJ_DM_SECURITY_PSK,
+        .public_key_or_identity = {
+            .source = ANJ_CRYPTO_DATA_SOURCE_BUFFER,
+            .info.buffer.data = "public",
+            .info.buffer.data_size = strlen("public")
+        },
+        .secret_key = {
+            .source = ANJ_CRYPTO_DATA_SOURCE_BUFFER,
+            .info.buffer.data = "secret",
+            .info.buffer.data_size = strlen("secret")
+        }
+    };
+    persistence_store(&anj, &sec_obj, &inst_1);
+    anj_persistence_memory_t memory_ctx;
+    anj_persistence_context_t ctx =
+            anj_persistence_memory_restore_context_create(
+                    &memory_ctx, g_membuf_data, g_membuf_write_offset);
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_dm_security_obj_restore(&anj_2, &sec_obj_2, &ctx));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_security_obj_install(&anj_2, &sec_obj_2));
+    ANJ_UNIT_ASSERT_EQUAL(memory_ctx.offset, g_membuf_write_offset);
+
+    // keys are referenced in the blob instead of being copied
+    anj_dm_security_instance_t *inst = &sec_obj_2.security_instances[0];
+    const uint8_t *blob_end = g_membuf_data + g_membuf_write_offset;
+    const uint8_t *identity =
+            (const uint8_t *) inst->public_key_or_identity.info.buffer.data;
+    const uint8_t *secret =
+            (const uint8_t *) inst->secret_key.info.buffer.data;
+    ANJ_UNIT_ASSERT_TRUE(identity > g_membuf_data && identity < blob_end);
+    ANJ_UNIT_ASSERT_TRUE(secret > g_membuf_data && secret < blob_end);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(identity, "public", strlen("public"));
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(secret, "secret", strlen("secret"));
+    ANJ_UNIT_ASSERT_EQUAL(inst->secret_key.info.buffer.data_size,
+                          strlen("secret"));
+
+    // and stored again from there
+    g_membuf_read_offset = 0;
+    uint8_t first_blob[sizeof(g_membuf_data)];
+    size_t first_blob_size = g_membuf_write_offset;
+    memcpy(first_blob, g_membuf_data, first_blob_size);
+    g_membuf_write_offset = 0;
+    ctx = anj_persistence_store_context_create(mem_write_cb, NULL);
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_dm_security_obj_store(&anj_2, &sec_obj_2, &ctx));
+    ANJ_UNIT_ASSERT_EQUAL(g_membuf_write_offset, first_blob_size);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(g_membuf_data, first_blob,
+                                      first_blob_size);
+}
+#        endif // ANJ_PERSISTENCE_WITH_MEMORY_MAPPED_RESTORE
+
 ANJ_UNIT_TEST(dm_security_object, persistence_psk_two_instances) {
     INIT_ENV_PERSISTENCE(anj, sec_obj);
     INIT_ENV_PERSISTENCE(anj_2, sec_obj_2);
@@ -807,6 +961,7 @@ ANJ_UNIT_TEST(dm_security_object, persistence_psk_two_instances) {
 
     compare_objects_after_persistence(&sec_obj, &sec_obj_2);
 }
+#    endif // ANJ_SEC_OBJ_WITH_EXTERNAL_KEYS_ONLY
 
 #    ifdef ANJ_WITH_EXTERNAL_CRYPTO_STORAGE
 ANJ_UNIT_TEST(dm_security_object, persistence_external_psk_instance) {
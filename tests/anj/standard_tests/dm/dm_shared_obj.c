@@ -0,0 +1,191 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <stddef.h>
+
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/dm/core.h>
+#include <anj/utils.h>
+
+#include "../../../../src/anj/dm/dm_io.h"
+
+#include <anj_unit_test.h>
+
+#ifdef ANJ_DM_WITH_SHARED_OBJ_DEFS
+
+#    define SENSOR_OID 3303
+#    define SENSOR_MAX_INSTS 4
+
+/* state of a single simulated device */
+typedef struct {
+    anj_dm_shared_obj_t shared_obj;
+    anj_iid_t iids[SENSOR_MAX_INSTS];
+    int value;
+} sensor_t;
+
+static int inst_create(anj_t *anj, const anj_dm_obj_t *obj, anj_iid_t iid) {
+    (void) anj;
+    return anj_dm_shared_obj_inst_add(
+            ANJ_CONTAINER_OF(obj, anj_dm_shared_obj_t, obj), iid);
+}
+
+static int inst_delete(anj_t *anj, const anj_dm_obj_t *obj, anj_iid_t iid) {
+    (void) anj;
+    return anj_dm_shared_obj_inst_remove(
+            ANJ_CONTAINER_OF(obj, anj_dm_shared_obj_t, obj), iid);
+}
+
+static int res_read(anj_t *anj,
+                    const anj_dm_obj_t *obj,
+                    anj_iid_t iid,
+                    anj_rid_t rid,
+                    anj_riid_t riid,
+                    anj_res_value_t *out_value) {
+    (void) anj;
+    (void) rid;
+    (void) riid;
+    const sensor_t *sensor = ANJ_CONTAINER_OF(
+            ANJ_CONTAINER_OF(obj, anj_dm_shared_obj_t, obj), sensor_t,
+            shared_obj);
+    out_value->int_value = sensor->value + iid;
+    return 0;
+}
+
+/* definitions shared by all devices */
+static const anj_dm_handlers_t sensor_handlers = {
+    .inst_lookup = anj_dm_shared_obj_inst_lookup,
+    .inst_first = anj_dm_shared_obj_inst_first,
+    .inst_next = anj_dm_shared_obj_inst_next,
+    .inst_create = inst_create,
+    .inst_delete = inst_delete,
+    .res_read = res_read
+};
+
+static const anj_dm_res_t sensor_res[] = {
+    {
+        .rid = 5700,
+        .kind = ANJ_DM_RES_R,
+        .type = ANJ_DATA_TYPE_INT
+    }
+};
+
+static const anj_dm_obj_inst_t sensor_inst_def = {
+    .res_count = ANJ_ARRAY_SIZE(sensor_res),
+    .resources = sensor_res
+};
+
+static void sensor_init(sensor_t *sensor, int value) {
+    *sensor = (sensor_t) {
+        .shared_obj = {
+            .obj = {
+                .oid = SENSOR_OID,
+                .handlers = &sensor_handlers,
+                .max_inst_count = SENSOR_MAX_INSTS
+            },
+            .inst_def = &sensor_inst_def,
+            .iids = sensor->iids
+        },
+        .iids = { 0, 2, ANJ_ID_INVALID, ANJ_ID_INVALID },
+        .value = value
+    };
+}
+
+#    define TEST_INIT(Anj, Sensor, Value)                         \
+        anj_t Anj = { 0 };                                        \
+        sensor_t Sensor;                                          \
+        _anj_dm_initialize(&Anj);                                 \
+        sensor_init(&Sensor, Value);                              \
+        ANJ_UNIT_ASSERT_SUCCESS(                                  \
+                anj_dm_add_obj(&Anj, &Sensor.shared_obj.obj));
+
+ANJ_UNIT_TEST(dm_shared_obj, read) {
+    TEST_INIT(anj1, sensor1, 100);
+    TEST_INIT(anj2, sensor2, 200);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_shared_obj_inst_remove(&sensor2.shared_obj,
+                                                          0));
+    anj_io_out_entry_t record = { 0 };
+    size_t out_res_count = 0;
+
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_operation_begin(
+            &anj1, ANJ_OP_DM_READ, false, &ANJ_MAKE_OBJECT_PATH(SENSOR_OID)));
+    _anj_dm_get_readable_res_count(&anj1, &out_res_count);
+    ANJ_UNIT_ASSERT_EQUAL(out_res_count, 2);
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_get_read_entry(&anj1, &record));
+    ANJ_UNIT_ASSERT_TRUE(anj_uri_path_equal(
+            &record.path, &ANJ_MAKE_RESOURCE_PATH(SENSOR_OID, 0, 5700)));
+    ANJ_UNIT_ASSERT_EQUAL(record.value.int_value, 100);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_dm_get_read_entry(&anj1, &record),
+                          _ANJ_DM_LAST_RECORD);
+    ANJ_UNIT_ASSERT_TRUE(anj_uri_path_equal(
+            &record.path, &ANJ_MAKE_RESOURCE_PATH(SENSOR_OID, 2, 5700)));
+    ANJ_UNIT_ASSERT_EQUAL(record.value.int_value, 102);
+    _anj_dm_operation_end(&anj1, ANJ_DM_TRANSACTION_SUCCESS);
+
+    anj_res_value_t value;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_res_read(
+            &anj2, &ANJ_MAKE_RESOURCE_PATH(SENSOR_OID, 2, 5700), &value));
+    ANJ_UNIT_ASSERT_EQUAL(value.int_value, 202);
+    ANJ_UNIT_ASSERT_EQUAL(
+            anj_dm_res_read(&anj2, &ANJ_MAKE_RESOURCE_PATH(SENSOR_OID, 0, 5700),
+                            &value),
+            ANJ_DM_ERR_NOT_FOUND);
+}
+
+ANJ_UNIT_TEST(dm_shared_obj, create_and_delete) {
+    TEST_INIT(anj1, sensor1, 100);
+    TEST_INIT(anj2, sensor2, 200);
+
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_operation_begin(
+            &anj1, ANJ_OP_DM_CREATE, false, &ANJ_MAKE_OBJECT_PATH(SENSOR_OID)));
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_dm_create_object_instance(&anj1, ANJ_ID_INVALID));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_operation_validate(&anj1));
+    _anj_dm_operation_end(&anj1, ANJ_DM_TRANSACTION_SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(sensor1.iids[0], 0);
+    ANJ_UNIT_ASSERT_EQUAL(sensor1.iids[1], 1);
+    ANJ_UNIT_ASSERT_EQUAL(sensor1.iids[2], 2);
+    ANJ_UNIT_ASSERT_EQUAL(sensor2.iids[2], ANJ_ID_INVALID);
+
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_dm_operation_begin(&anj2, ANJ_OP_DM_DELETE, false,
+                                    &ANJ_MAKE_INSTANCE_PATH(SENSOR_OID, 0)));
+    _anj_dm_operation_end(&anj2, ANJ_DM_TRANSACTION_SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(sensor2.iids[0], 2);
+    ANJ_UNIT_ASSERT_EQUAL(sensor2.iids[1], ANJ_ID_INVALID);
+    ANJ_UNIT_ASSERT_EQUAL(sensor1.iids[0], 0);
+}
+
+ANJ_UNIT_TEST(dm_shared_obj, inst_add_and_remove) {
+    sensor_t sensor;
+    sensor_init(&sensor, 0);
+    anj_dm_shared_obj_t *shared_obj = &sensor.shared_obj;
+
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_shared_obj_inst_add(shared_obj, 2),
+                          ANJ_DM_ERR_BAD_REQUEST);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_shared_obj_inst_add(shared_obj, 7));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_shared_obj_inst_add(shared_obj, 1));
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_shared_obj_inst_add(shared_obj, 3),
+                          ANJ_DM_ERR_METHOD_NOT_ALLOWED);
+    ANJ_UNIT_ASSERT_EQUAL(sensor.iids[0], 0);
+    ANJ_UNIT_ASSERT_EQUAL(sensor.iids[1], 1);
+    ANJ_UNIT_ASSERT_EQUAL(sensor.iids[2], 2);
+    ANJ_UNIT_ASSERT_EQUAL(sensor.iids[3], 7);
+
+    ANJ_UNIT_ASSERT_SUCCESS(anj_dm_shared_obj_inst_remove(shared_obj, 7));
+    ANJ_UNIT_ASSERT_EQUAL(anj_dm_shared_obj_inst_remove(shared_obj, 7),
+                          ANJ_DM_ERR_NOT_FOUND);
+    ANJ_UNIT_ASSERT_EQUAL(sensor.iids[3], ANJ_ID_INVALID);
+    ANJ_UNIT_ASSERT_TRUE(
+            anj_dm_shared_obj_inst_next(&shared_obj->obj, 1)->iid == 2);
+    ANJ_UNIT_ASSERT_NULL(anj_dm_shared_obj_inst_next(&shared_obj->obj, 2));
+    ANJ_UNIT_ASSERT_NULL(anj_dm_shared_obj_inst_lookup(&shared_obj->obj, 7));
+}
+
+#endif // ANJ_DM_WITH_SHARED_OBJ_DEFS
@@ -0,0 +1,213 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/anj_config.h>
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/dm/core.h>
+#include <anj/utils.h>
+
+#include "../../../../src/anj/coap/coap.h"
+#include "../../../../src/anj/dm/dm_integration.h"
+#include "../../../../src/anj/dm/dm_io.h"
+#include "../../../../src/anj/exchange.h"
+#include "../mock/time_api_mock.h"
+
+#include <anj_unit_test.h>
+
+#ifdef ANJ_WITH_SMALLEST_FORMAT
+
+#    define TEST_OID 33
+
+static const anj_riid_t res_insts[] = { 0 };
+
+static const anj_dm_res_t test_res[] = {
+    {
+        .rid = 0,
+        .kind = ANJ_DM_RES_R,
+        .type = ANJ_DATA_TYPE_INT
+    },
+    {
+        .rid = 1,
+        .kind = ANJ_DM_RES_R,
+        .type = ANJ_DATA_TYPE_STRING
+    },
+    {
+        .rid = 2,
+        .kind = ANJ_DM_RES_R,
+        .type = ANJ_DATA_TYPE_BYTES
+    },
+    {
+        .rid = 3,
+        .kind = ANJ_DM_RES_RM,
+        .type = ANJ_DATA_TYPE_INT,
+        .max_inst_count = 1,
+        .insts = res_insts
+    }
+};
+
+static const anj_dm_obj_inst_t test_inst = {
+    .iid = 0,
+    .res_count = ANJ_ARRAY_SIZE(test_res),
+    .resources = test_res
+};
+
+static int res_read(anj_t *anj,
+                    const anj_dm_obj_t *obj,
+                    anj_iid_t iid,
+                    anj_rid_t rid,
+                    anj_riid_t riid,
+                    anj_res_value_t *out_value) {
+    (void) anj;
+    (void) obj;
+    (void) iid;
+    (void) riid;
+    switch (rid) {
+    case 0:
+        out_value->int_value = 42;
+        break;
+    case 1:
+        out_value->bytes_or_string.data = "abc";
+        break;
+    case 2:
+        out_value->bytes_or_string.data = "\x01\x02\x03";
+        out_value->bytes_or_string.chunk_length = 3;
+        break;
+    default:
+        out_value->int_value = 7;
+        break;
+    }
+    return 0;
+}
+
+static const anj_dm_handlers_t test_handlers = {
+    .res_read = res_read
+};
+
+static const anj_dm_obj_t test_obj = {
+    .oid = TEST_OID,
+    .insts = &test_inst,
+    .handlers = &test_handlers,
+    .max_inst_count = 1
+};
+
+#    define TEST_INIT(Anj)                                         \
+        mock_time_reset();                                         \
+        anj_t Anj = { 0 };                                         \
+        _anj_dm_initialize(&Anj);                                  \
+        ANJ_UNIT_ASSERT_SUCCESS(anj_dm_add_obj(&Anj, &test_obj));
+
+// Processes a Read request and leaves the response in @p msg
+static void process_read(anj_t *anj,
+                         _anj_coap_msg_t *msg,
+                         const anj_uri_path_t *path,
+                         uint16_t accept) {
+    static uint8_t payload[64];
+    *msg = (_anj_coap_msg_t) {
+        .operation = ANJ_OP_DM_READ,
+        .uri = *path,
+        .accept = accept,
+        .token = {
+            .size = 1,
+            .bytes = { 0x01 }
+        }
+    };
+    uint8_t response_code;
+    _anj_exchange_handlers_t handlers;
+    _anj_dm_process_request(anj, msg, 1, &response_code, &handlers);
+    ANJ_UNIT_ASSERT_EQUAL(response_code, ANJ_COAP_CODE_CONTENT);
+
+    _anj_exchange_ctx_t exchange_ctx;
+    _anj_exchange_init(&exchange_ctx);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_exchange_new_server_request(
+                                  &exchange_ctx, response_code, msg,
+                                  &handlers, payload, sizeof(payload)),
+                          ANJ_EXCHANGE_STATE_MSG_TO_SEND);
+    ANJ_UNIT_ASSERT_EQUAL(
+            _anj_exchange_process(&exchange_ctx,
+                                  ANJ_EXCHANGE_EVENT_SEND_CONFIRMATION, msg),
+            ANJ_EXCHANGE_STATE_FINISHED);
+}
+
+ANJ_UNIT_TEST(dm_smallest_format, single_values) {
+    TEST_INIT(anj);
+    _anj_coap_msg_t msg;
+
+    process_read(&anj, &msg, &ANJ_MAKE_RESOURCE_PATH(TEST_OID, 0, 0),
+                 _ANJ_COAP_FORMAT_NOT_DEFINED);
+    ANJ_UNIT_ASSERT_EQUAL(msg.content_format, _ANJ_COAP_FORMAT_CBOR);
+    ANJ_UNIT_ASSERT_EQUAL(msg.payload_size, 2);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(msg.payload, "\x18\x2A", 2);
+
+    process_read(&anj, &msg, &ANJ_MAKE_RESOURCE_PATH(TEST_OID, 0, 1),
+                 _ANJ_COAP_FORMAT_NOT_DEFINED);
+    ANJ_UNIT_ASSERT_EQUAL(msg.content_format, _ANJ_COAP_FORMAT_PLAINTEXT);
+    ANJ_UNIT_ASSERT_EQUAL(msg.payload_size, 3);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(msg.payload, "abc", 3);
+
+    process_read(&anj, &msg, &ANJ_MAKE_RESOURCE_PATH(TEST_OID, 0, 2),
+                 _ANJ_COAP_FORMAT_NOT_DEFINED);
+    ANJ_UNIT_ASSERT_EQUAL(msg.content_format, _ANJ_COAP_FORMAT_OPAQUE_STREAM);
+    ANJ_UNIT_ASSERT_EQUAL(msg.payload_size, 3);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(msg.payload, "\x01\x02\x03", 3);
+
+    process_read(&anj, &msg,
+                 &ANJ_MAKE_RESOURCE_INSTANCE_PATH(TEST_OID, 0, 3, 0),
+                 _ANJ_COAP_FORMAT_NOT_DEFINED);
+    ANJ_UNIT_ASSERT_EQUAL(msg.content_format, _ANJ_COAP_FORMAT_CBOR);
+    ANJ_UNIT_ASSERT_EQUAL(msg.payload_size, 1);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(msg.payload, "\x07", 1);
+}
+
+ANJ_UNIT_TEST(dm_smallest_format, default_format) {
+    TEST_INIT(anj);
+    _anj_coap_msg_t msg;
+    uint16_t default_format = _ANJ_COAP_FORMAT_OMA_LWM2M_CBOR;
+#    ifndef ANJ_WITH_LWM2M_CBOR
+    default_format = _ANJ_COAP_FORMAT_SENML_CBOR;
+#    endif // ANJ_WITH_LWM2M_CBOR
+
+    // more than one record
+    process_read(&anj, &msg, &ANJ_MAKE_INSTANCE_PATH(TEST_OID, 0),
+                 _ANJ_COAP_FORMAT_NOT_DEFINED);
+    ANJ_UNIT_ASSERT_EQUAL(msg.content_format, default_format);
+
+    // Multiple Resource, number of its instances may change
+    process_read(&anj, &msg, &ANJ_MAKE_RESOURCE_PATH(TEST_OID, 0, 3),
+                 _ANJ_COAP_FORMAT_NOT_DEFINED);
+    ANJ_UNIT_ASSERT_EQUAL(msg.content_format, default_format);
+
+    // requested format is always respected
+    process_read(&anj, &msg, &ANJ_MAKE_RESOURCE_PATH(TEST_OID, 0, 0),
+                 _ANJ_COAP_FORMAT_SENML_CBOR);
+    ANJ_UNIT_ASSERT_EQUAL(msg.content_format, _ANJ_COAP_FORMAT_SENML_CBOR);
+}
+
+#    ifdef ANJ_WITH_OBSERVE
+ANJ_UNIT_TEST(dm_smallest_format, notification) {
+    TEST_INIT(anj);
+    uint8_t buff[32];
+    size_t out_len;
+    uint16_t format = _ANJ_COAP_FORMAT_NOT_DEFINED;
+    size_t already_processed = 0;
+    const anj_uri_path_t *path = &ANJ_MAKE_RESOURCE_PATH(TEST_OID, 0, 0);
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_observe_build_msg(
+            &anj, &path, 1, &already_processed, buff, &out_len, sizeof(buff),
+            &format, false));
+    ANJ_UNIT_ASSERT_EQUAL(format, _ANJ_COAP_FORMAT_CBOR);
+    ANJ_UNIT_ASSERT_EQUAL(out_len, 2);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff, "\x18\x2A", 2);
+}
+#    endif // ANJ_WITH_OBSERVE
+
+#endif // ANJ_WITH_SMALLEST_FORMAT
@@ -17,6 +17,7 @@
 #include <anj/utils.h>
 
 #include "../../../../src/anj/dm/dm_io.h"
+#include "../../../../src/anj/dm/dm_integration.h"
 #include "../../../../src/anj/io/io.h"
 
 #include <anj_unit_test.h>
@@ -854,3 +855,100 @@ ANJ_UNIT_TEST(dm_write_replace, write_with_create_error) {
     _anj_dm_operation_end(&anj, ANJ_DM_TRANSACTION_FAILURE);
     Obj_Bootstrap.max_inst_count = 2;
 }
+
+#ifdef ANJ_WITH_BOOTSTRAP_WRITE_BATCHING
+#    define BOOTSTRAP_BATCH_INIT(Anj)                                  \
+        anj_t Anj = { 0 };                                             \
+        _anj_dm_initialize(&Anj);                                      \
+        ANJ_UNIT_ASSERT_SUCCESS(anj_dm_add_obj(&Anj, &Obj_Bootstrap)); \
+        obj_insts_bootstrap[1].iid = ANJ_ID_INVALID;                   \
+        call_counter_begin = 0;                                        \
+        call_counter_end = 0;                                          \
+        call_counter_validate = 0;                                     \
+        call_result = 4;                                               \
+        validate_return_error = false;
+
+static void bootstrap_write(anj_t *anj,
+                            anj_iid_t iid,
+                            anj_dm_transaction_result_t result) {
+    anj_io_out_entry_t record = {
+        .type = ANJ_DATA_TYPE_INT,
+        .path = ANJ_MAKE_RESOURCE_PATH(1, iid, 0)
+    };
+    anj_uri_path_t path = ANJ_MAKE_INSTANCE_PATH(1, iid);
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_dm_operation_begin(anj, ANJ_OP_DM_WRITE_REPLACE, true, &path));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_write_entry(anj, &record));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_operation_validate(anj));
+    _anj_dm_operation_end(anj, result);
+}
+
+ANJ_UNIT_TEST(dm_write_replace, bootstrap_batch_commit) {
+    BOOTSTRAP_BATCH_INIT(anj);
+
+    bootstrap_write(&anj, 0, ANJ_DM_TRANSACTION_SUCCESS);
+    bootstrap_write(&anj, 1, ANJ_DM_TRANSACTION_SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(Obj_Bootstrap.insts[1].iid, 1);
+    ANJ_UNIT_ASSERT_EQUAL(call_counter_begin, 1);
+    ANJ_UNIT_ASSERT_EQUAL(call_counter_validate, 0);
+    ANJ_UNIT_ASSERT_EQUAL(call_counter_end, 0);
+
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_bootstrap_batch_commit(&anj));
+    ANJ_UNIT_ASSERT_EQUAL(call_counter_validate, 1);
+    ANJ_UNIT_ASSERT_EQUAL(call_counter_end, 1);
+    ANJ_UNIT_ASSERT_EQUAL(call_result, ANJ_DM_TRANSACTION_SUCCESS);
+
+    // nothing left to commit
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_bootstrap_batch_commit(&anj));
+    ANJ_UNIT_ASSERT_EQUAL(call_counter_end, 1);
+    obj_insts_bootstrap[1].iid = ANJ_ID_INVALID;
+}
+
+ANJ_UNIT_TEST(dm_write_replace, bootstrap_batch_validation_error) {
+    BOOTSTRAP_BATCH_INIT(anj);
+
+    bootstrap_write(&anj, 0, ANJ_DM_TRANSACTION_SUCCESS);
+    bootstrap_write(&anj, 1, ANJ_DM_TRANSACTION_SUCCESS);
+    validate_return_error = true;
+    ANJ_UNIT_ASSERT_FAILED(_anj_dm_bootstrap_batch_commit(&anj));
+    ANJ_UNIT_ASSERT_EQUAL(call_counter_validate, 1);
+    ANJ_UNIT_ASSERT_EQUAL(call_counter_end, 1);
+    ANJ_UNIT_ASSERT_EQUAL(call_result, ANJ_DM_TRANSACTION_FAILURE);
+    validate_return_error = false;
+
+    // the failure is reported only once
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_bootstrap_batch_commit(&anj));
+    obj_insts_bootstrap[1].iid = ANJ_ID_INVALID;
+}
+
+ANJ_UNIT_TEST(dm_write_replace, bootstrap_batch_write_error) {
+    BOOTSTRAP_BATCH_INIT(anj);
+
+    bootstrap_write(&anj, 0, ANJ_DM_TRANSACTION_SUCCESS);
+    bootstrap_write(&anj, 1, ANJ_DM_TRANSACTION_FAILURE);
+    // failed Bootstrap-Write rolls back the whole batch immediately
+    ANJ_UNIT_ASSERT_EQUAL(call_counter_end, 1);
+    ANJ_UNIT_ASSERT_EQUAL(call_result, ANJ_DM_TRANSACTION_FAILURE);
+
+    ANJ_UNIT_ASSERT_FAILED(_anj_dm_bootstrap_batch_commit(&anj));
+    ANJ_UNIT_ASSERT_EQUAL(call_counter_validate, 0);
+    ANJ_UNIT_ASSERT_EQUAL(call_counter_end, 1);
+    obj_insts_bootstrap[1].iid = ANJ_ID_INVALID;
+}
+
+ANJ_UNIT_TEST(dm_write_replace, bootstrap_batch_commit_on_other_operation) {
+    BOOTSTRAP_BATCH_INIT(anj);
+
+    bootstrap_write(&anj, 0, ANJ_DM_TRANSACTION_SUCCESS);
+    ANJ_UNIT_ASSERT_EQUAL(call_counter_end, 0);
+
+    anj_uri_path_t path = ANJ_MAKE_OBJECT_PATH(1);
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_dm_operation_begin(&anj, ANJ_OP_DM_READ, true, &path));
+    ANJ_UNIT_ASSERT_EQUAL(call_counter_validate, 1);
+    ANJ_UNIT_ASSERT_EQUAL(call_counter_end, 1);
+    ANJ_UNIT_ASSERT_EQUAL(call_result, ANJ_DM_TRANSACTION_SUCCESS);
+    _anj_dm_operation_end(&anj, ANJ_DM_TRANSACTION_SUCCESS);
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_dm_bootstrap_batch_commit(&anj));
+}
+#endif // ANJ_WITH_BOOTSTRAP_WRITE_BATCHING
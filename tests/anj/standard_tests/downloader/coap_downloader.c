@@ -185,6 +185,28 @@ ANJ_UNIT_TEST(coap_downloader, basic_download) {
     FINAL_CHECK();
 }
 
+ANJ_UNIT_TEST(coap_downloader, next_step_time) {
+    TEST_INIT();
+    // nothing to do before the download is started
+    ANJ_UNIT_ASSERT_FALSE(anj_time_duration_is_valid(
+            anj_coap_downloader_next_step_time(&ctx)));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_coap_downloader_start(&ctx, BASE_URI, NULL));
+    ANJ_UNIT_ASSERT_TRUE(
+            anj_time_duration_eq(anj_coap_downloader_next_step_time(&ctx),
+                                 ANJ_TIME_DURATION_ZERO));
+    anj_coap_downloader_step(&ctx);
+    HANDLE_REQUEST(request_1, response_1);
+    HANDLE_REQUEST(request_2, response_2);
+    // responses are polled for during the download
+    ANJ_UNIT_ASSERT_TRUE(
+            anj_time_duration_eq(anj_coap_downloader_next_step_time(&ctx),
+                                 ANJ_TIME_DURATION_ZERO));
+    HANDLE_REQUEST(request_3, response_3);
+    FINAL_CHECK();
+    ANJ_UNIT_ASSERT_FALSE(anj_time_duration_is_valid(
+            anj_coap_downloader_next_step_time(&ctx)));
+}
+
 ANJ_UNIT_TEST(coap_downloader, basic_download_two_in_the_row) {
     TEST_INIT();
     START_DOWNLOAD(BASE_URI);
@@ -576,7 +598,7 @@ ANJ_UNIT_TEST(coap_downloader, too_many_paths_error) {
     anj_exchange_udp_tx_params_t udp_tx_params = {                \
         .max_retransmit = 0,                                      \
         .ack_timeout = anj_time_duration_new(1, ANJ_TIME_UNIT_S), \
-        .ack_random_factor = 2.0,                                 \
+        .ack_random_factor = ANJ_ACK_RANDOM_FACTOR(2.0),          \
     };                                                            \
     anj_coap_downloader_configuration_t config = {                \
         .event_cb = coap_downloader_callback,                     \
@@ -679,3 +701,782 @@ ANJ_UNIT_TEST(coap_downloader, additional_ignored_message) {
     HANDLE_REQUEST(request_3, response_3);
     FINAL_CHECK();
 }
+
+#ifdef ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+#    ifdef ANJ_WITH_MSG_BUFFER_ARENA
+static uint8_t msg_buffer_arena[ANJ_MSG_BUFFER_ARENA_SIZE];
+#        define SET_MSG_BUFFER_ARENA(Config)              \
+            (Config).msg_buffer_arena = msg_buffer_arena; \
+            (Config).msg_buffer_arena_size = sizeof(msg_buffer_arena)
+#    else // ANJ_WITH_MSG_BUFFER_ARENA
+#        define SET_MSG_BUFFER_ARENA(Config) (void) 0
+#    endif // ANJ_WITH_MSG_BUFFER_ARENA
+
+static char register_response[] =
+        "\x68"                             // header v 0x01, Ack, tkl 8
+        "\x41\x00\x00"                     // CREATED code 2.1
+        "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF" // token
+        "\x82\x72\x64"                     // location-path /rd
+        "\x04\x35\x61\x33\x66";            // location-path 8 /5a3f
+
+// registers to the LwM2M Server at BASE_URI host and port
+#    define SHARED_TEST_INIT()                                                \
+        TEST_INIT();                                                          \
+        anj_t anj;                                                            \
+        anj_configuration_t anj_config = {                                    \
+            .endpoint_name = "name"                                           \
+        };                                                                    \
+        SET_MSG_BUFFER_ARENA(anj_config);                                     \
+        ANJ_UNIT_ASSERT_SUCCESS(anj_core_init(&anj, &anj_config));            \
+        anj_dm_security_obj_t sec_obj;                                        \
+        anj_dm_security_obj_init(&sec_obj);                                   \
+        anj_dm_server_obj_t ser_obj;                                          \
+        anj_dm_server_obj_init(&ser_obj);                                     \
+        const anj_iid_t iid = 1;                                              \
+        anj_dm_security_instance_init_t sec_inst = {                          \
+            .server_uri = "coap://test_uri.com:5683",                         \
+            .ssid = 2,                                                        \
+            .iid = &iid,                                                      \
+            .security_mode = ANJ_DM_SECURITY_NOSEC,                           \
+        };                                                                    \
+        anj_dm_server_instance_init_t ser_inst = {                            \
+            .ssid = 2,                                                        \
+            .lifetime = 150,                                                  \
+            .binding = "U",                                                   \
+            .iid = &iid                                                       \
+        };                                                                    \
+        ANJ_UNIT_ASSERT_SUCCESS(                                              \
+                anj_dm_security_obj_add_instance(&sec_obj, &sec_inst));       \
+        ANJ_UNIT_ASSERT_SUCCESS(anj_dm_security_obj_install(&anj, &sec_obj)); \
+        ANJ_UNIT_ASSERT_SUCCESS(                                              \
+                anj_dm_server_obj_add_instance(&ser_obj, &ser_inst));         \
+        ANJ_UNIT_ASSERT_SUCCESS(anj_dm_server_obj_install(&anj, &ser_obj));   \
+        mock.bytes_to_send = 500;                                             \
+        anj_core_step(&anj);                                                  \
+        memcpy(&register_response[4], anj.exchange_ctx.base_msg.token.bytes,  \
+               8);                                                            \
+        register_response[2] =                                                \
+                anj.exchange_ctx.base_msg.coap_binding_data.message_id >> 8;  \
+        register_response[3] =                                                \
+                anj.exchange_ctx.base_msg.coap_binding_data.message_id        \
+                & 0xFF;                                                       \
+        mock.bytes_to_recv = sizeof(register_response) - 1;                   \
+        mock.data_to_recv = (uint8_t *) register_response;                    \
+        anj_core_step(&anj);                                                  \
+        ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,                   \
+                              ANJ_CONN_STATUS_REGISTERED);                    \
+        anj_core_step(&anj);                                                  \
+        mock.bytes_to_send = 0;                                               \
+        mock.bytes_sent = 0;                                                  \
+        config.anj = &anj;                                                    \
+        ANJ_UNIT_ASSERT_SUCCESS(anj_coap_downloader_init(&ctx, &config))
+
+// request is sent by the downloader, response is received by the core
+#    define HANDLE_SHARED_REQUEST(Request, Response)                      \
+        mock.bytes_to_send = 500;                                         \
+        g_callback_counter = 0;                                           \
+        anj_coap_downloader_step(&ctx);                                   \
+        COPY_TOKEN_AND_MSG_ID(Request, 8);                                \
+        ANJ_UNIT_ASSERT_EQUAL(sizeof(Request) - 1, mock.bytes_sent);      \
+        ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, Request, \
+                                          mock.bytes_sent);               \
+        ANJ_UNIT_ASSERT_EQUAL(                                            \
+                ctx.exchange_ctx.base_msg.coap_binding_data.message_id,   \
+                anj.exchange_ctx.msg_id);                                 \
+        ADD_RESPONSE(Response);                                           \
+        mock.bytes_to_send = 0;                                           \
+        anj_coap_downloader_step(&ctx);                                   \
+        ANJ_UNIT_ASSERT_EQUAL(g_callback_counter, 0);                     \
+        anj_core_step(&anj);                                              \
+        ANJ_UNIT_ASSERT_EQUAL(g_callback_counter, 1);                     \
+        ANJ_UNIT_ASSERT_EQUAL(g_set_connection_status,                    \
+                              ANJ_COAP_DOWNLOADER_STATUS_DOWNLOADING);
+
+ANJ_UNIT_TEST(coap_downloader, shared_connection_download) {
+    SHARED_TEST_INIT();
+    uint16_t last_msg_id = anj.exchange_ctx.msg_id;
+    START_DOWNLOAD(BASE_URI);
+    // no new connection is made
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_CONNECT], 1);
+    ANJ_UNIT_ASSERT_TRUE(anj.shared_downloader == &ctx);
+
+    HANDLE_SHARED_REQUEST(request_1, response_1);
+    ANJ_UNIT_ASSERT_EQUAL(
+            ctx.exchange_ctx.base_msg.coap_binding_data.message_id,
+            (uint16_t) (last_msg_id + 2));
+    HANDLE_SHARED_REQUEST(request_2, response_2);
+    HANDLE_SHARED_REQUEST(request_3, response_3);
+    // exchange was finished by anj_core_step(), let the downloader notice it
+    anj_coap_downloader_step(&ctx);
+    FINAL_CHECK();
+
+    // LwM2M Server connection is left untouched
+    ANJ_UNIT_ASSERT_NULL(anj.shared_downloader);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_CLOSE], 0);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_CLEANUP], 0);
+    ANJ_UNIT_ASSERT_EQUAL(anj.server_state.conn_status,
+                          ANJ_CONN_STATUS_REGISTERED);
+}
+
+ANJ_UNIT_TEST(coap_downloader, shared_connection_different_endpoint) {
+    SHARED_TEST_INIT();
+    START_DOWNLOAD(BASE_URI_2);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_CONNECT], 2);
+    ANJ_UNIT_ASSERT_EQUAL_STRING(mock.hostname, "uri_turi.com");
+    ANJ_UNIT_ASSERT_NULL(anj.shared_downloader);
+    HANDLE_REQUEST(request_1, response_1);
+    HANDLE_REQUEST(request_2, response_2);
+    HANDLE_REQUEST(request_3, response_3);
+    FINAL_CHECK();
+}
+
+ANJ_UNIT_TEST(coap_downloader, shared_connection_lost) {
+    SHARED_TEST_INIT();
+    START_DOWNLOAD(BASE_URI);
+    HANDLE_SHARED_REQUEST(request_1, response_1);
+
+    // receive error makes the core drop the connection
+    mock.call_result[ANJ_NET_FUN_RECV] = -1;
+    anj_core_step(&anj);
+    mock.call_result[ANJ_NET_FUN_RECV] = 0;
+    anj_coap_downloader_step(&ctx);
+    anj_coap_downloader_step(&ctx);
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(g_set_connection_status,
+                          ANJ_COAP_DOWNLOADER_STATUS_FAILED);
+    ANJ_UNIT_ASSERT_EQUAL(anj_coap_downloader_get_error(&ctx),
+                          ANJ_COAP_DOWNLOADER_ERR_NETWORK);
+    ANJ_UNIT_ASSERT_NULL(anj.shared_downloader);
+}
+#endif // ANJ_COAP_DOWNLOADER_WITH_SHARED_CONNECTION
+
+#ifdef ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW
+#    define WINDOW_TEST_INIT(Window)                                       \
+        TEST_INIT();                                                       \
+        config.block_window = Window;                                      \
+        ANJ_UNIT_ASSERT_SUCCESS(anj_coap_downloader_init(&ctx, &config)); \
+        START_DOWNLOAD(BASE_URI)
+
+// token and message id are copied from the request for the given block
+static void copy_block_token_and_msg_id(anj_coap_downloader_t *ctx,
+                                        char *msg,
+                                        uint32_t block_number) {
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(ctx->window.slots); i++) {
+        _anj_coap_downloader_block_slot_t *slot = &ctx->window.slots[i];
+        if (slot->in_use && slot->block_number == block_number) {
+            memcpy(&msg[4], slot->token.bytes, 8);
+            msg[2] = (char) (slot->msg_id >> 8);
+            msg[3] = (char) (slot->msg_id & 0xFF);
+            return;
+        }
+    }
+    ANJ_UNIT_ASSERT_TRUE(false);
+}
+
+#    define ADD_BLOCK_RESPONSE(Response, Block)                 \
+        copy_block_token_and_msg_id(&ctx, Response, Block);     \
+        mock.bytes_to_recv = sizeof(Response) - 1;              \
+        mock.data_to_recv = (uint8_t *) Response
+
+static char window_request_1[] = "\x48"         // Confirmable, tkl 8
+                                 "\x01\x00\x00" // GET 0x01, msg id
+                                 "\x00\x00\x00\x00\x00\x00\x00\x00" // token
+                                 "\xb1\x61"         // uri path /a
+                                 "\x02\x62\x63"     // uri path /bc
+                                 "\x03\x64\x65\x66" // uri path /def
+                                 "\xc1\x06"; // block2 num 0, size 1024
+
+static char window_response_4[] =
+        "\x68"                             // header v 0x01, Ack, tkl 8
+        "\x84\x00\x00"                     // Bad option code 4.02
+        "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF"; // token
+
+ANJ_UNIT_TEST(coap_downloader, block_window_download) {
+    WINDOW_TEST_INIT(3);
+    // the first block is requested alone
+    mock.bytes_to_send = 500;
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_SEND], 1);
+    copy_block_token_and_msg_id(&ctx, window_request_1, 0);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, sizeof(window_request_1) - 1);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, window_request_1,
+                                      mock.bytes_sent);
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_SEND], 1);
+
+    // block size is known, blocks 1-3 are requested at once
+    ADD_BLOCK_RESPONSE(response_1, 0);
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_SEND], 4);
+    ANJ_UNIT_ASSERT_EQUAL(g_data_len, 16);
+    copy_block_token_and_msg_id(&ctx, request_2, 1);
+    // block 3 is past the end of the resource
+    ADD_BLOCK_RESPONSE(window_response_4, 3);
+    anj_coap_downloader_step(&ctx);
+    // last block arrives before the second one, it's held back
+    ADD_BLOCK_RESPONSE(response_3, 2);
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(g_data_len, 16);
+    ANJ_UNIT_ASSERT_EQUAL(g_set_connection_status,
+                          ANJ_COAP_DOWNLOADER_STATUS_DOWNLOADING);
+    ADD_BLOCK_RESPONSE(response_2, 1);
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_SEND], 4);
+    FINAL_CHECK();
+}
+
+ANJ_UNIT_TEST(coap_downloader, block_window_retransmission) {
+    WINDOW_TEST_INIT(2);
+    mock.bytes_to_send = 500;
+    anj_coap_downloader_step(&ctx);
+    ADD_BLOCK_RESPONSE(response_1, 0);
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_SEND], 3);
+    ADD_BLOCK_RESPONSE(response_3, 2);
+    anj_coap_downloader_step(&ctx);
+
+    // block 1 is retransmitted with the same token and message id
+    mock_time_advance(anj_time_duration_new(4, ANJ_TIME_UNIT_S));
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_SEND], 4);
+    copy_block_token_and_msg_id(&ctx, request_2, 1);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, request_2,
+                                      sizeof(request_2) - 1);
+    ADD_BLOCK_RESPONSE(response_2, 1);
+    anj_coap_downloader_step(&ctx);
+    FINAL_CHECK();
+}
+
+ANJ_UNIT_TEST(coap_downloader, block_window_error_response) {
+    WINDOW_TEST_INIT(4);
+    mock.bytes_to_send = 500;
+    anj_coap_downloader_step(&ctx);
+    ADD_BLOCK_RESPONSE(response_1, 0);
+    anj_coap_downloader_step(&ctx);
+    // block 1 within the resource is rejected
+    ADD_BLOCK_RESPONSE(window_response_4, 1);
+    anj_coap_downloader_step(&ctx);
+    anj_coap_downloader_step(&ctx);
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(g_set_connection_status,
+                          ANJ_COAP_DOWNLOADER_STATUS_FAILED);
+    ANJ_UNIT_ASSERT_EQUAL(anj_coap_downloader_get_error(&ctx),
+                          ANJ_COAP_DOWNLOADER_ERR_INVALID_RESPONSE);
+    ANJ_UNIT_ASSERT_EQUAL(g_data_len, 16);
+}
+
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+#        define Q_BLOCK2_TEST_INIT(Window)                                \
+            TEST_INIT();                                                  \
+            config.block_window = Window;                                 \
+            config.q_block2 = true;                                       \
+            ANJ_UNIT_ASSERT_SUCCESS(                                      \
+                    anj_coap_downloader_init(&ctx, &config));             \
+            START_DOWNLOAD(BASE_URI)
+
+static char q_block2_request_1[] = "\x48"         // Confirmable, tkl 8
+                                   "\x01\x00\x00" // GET 0x01, msg id
+                                   "\x00\x00\x00\x00\x00\x00\x00\x00" // token
+                                   "\xb1\x61"         // uri path /a
+                                   "\x02\x62\x63"     // uri path /bc
+                                   "\x03\x64\x65\x66" // uri path /def
+                                   "\xd1\x07\x06"; // q-block2 num 0, size 1024
+
+static char q_block2_request_2[] = "\x48"         // Confirmable, tkl 8
+                                   "\x01\x00\x00" // GET 0x01, msg id
+                                   "\x00\x00\x00\x00\x00\x00\x00\x00" // token
+                                   "\xb1\x61"         // uri path /a
+                                   "\x02\x62\x63"     // uri path /bc
+                                   "\x03\x64\x65\x66" // uri path /def
+                                   "\xd1\x07\x10"     // q-block2 num 1, size 16
+                                   "\x01\x20"         // q-block2 num 2, size 16
+                                   "\x01\x30";        // q-block2 num 3, size 16
+
+static char q_block2_request_3[] = "\x48"         // Confirmable, tkl 8
+                                   "\x01\x00\x00" // GET 0x01, msg id
+                                   "\x00\x00\x00\x00\x00\x00\x00\x00" // token
+                                   "\xb1\x61"         // uri path /a
+                                   "\x02\x62\x63"     // uri path /bc
+                                   "\x03\x64\x65\x66" // uri path /def
+                                   "\xd1\x07\x10"; // q-block2 num 1, size 16
+
+static char q_block2_response_1[] =
+        "\x68"                             // header v 0x01, Ack, tkl 8
+        "\x45\x00\x00"                     // Content code 2.05
+        "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF" // token
+        "\x41\xA2"                         // etag 0xA2
+        "\xd1\x0e\x08" // q-block2 num 0, more true, size 16
+        "\xFF"         // payload marker
+        "\x01\x02\x03\x04\x05\x06\x07\x08"
+        "\x11\x12\x13\x14\x15\x16\x17\x18";
+
+static char q_block2_response_2[] =
+        "\x58"                             // header v 0x01, Non-con, tkl 8
+        "\x45\x00\x00"                     // Content code 2.05
+        "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF" // token
+        "\x41\xA2"                         // etag 0xA2
+        "\xd1\x0e\x18" // q-block2 num 1, more true, size 16
+        "\xFF"         // payload marker
+        "\x21\x22\x23\x24\x25\x26\x27\x28"
+        "\x31\x32\x33\x34\x35\x36\x37\x38";
+
+static char q_block2_response_3[] =
+        "\x58"                             // header v 0x01, Non-con, tkl 8
+        "\x45\x00\x00"                     // Content code 2.05
+        "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF" // token
+        "\x41\xA2"                         // etag 0xA2
+        "\xd1\x0e\x20" // q-block2 num 2, more false, size 16
+        "\xFF"         // payload marker
+        "\x41\x42\x43\x44\x45\x46\x47\x48";
+
+static char q_block2_response_bad_option[] =
+        "\x68"                             // header v 0x01, Ack, tkl 8
+        "\x82\x00\x00"                     // Bad option code 4.02
+        "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF"; // token
+
+ANJ_UNIT_TEST(coap_downloader, q_block2_download) {
+    Q_BLOCK2_TEST_INIT(3);
+    mock.bytes_to_send = 500;
+    anj_coap_downloader_step(&ctx);
+    copy_block_token_and_msg_id(&ctx, q_block2_request_1, 0);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, sizeof(q_block2_request_1) - 1);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, q_block2_request_1,
+                                      mock.bytes_sent);
+
+    // blocks 1-3 are requested with a single message
+    ADD_BLOCK_RESPONSE(q_block2_response_1, 0);
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_SEND], 2);
+    ANJ_UNIT_ASSERT_EQUAL(g_data_len, 16);
+    copy_block_token_and_msg_id(&ctx, q_block2_request_2, 1);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, sizeof(q_block2_request_2) - 1);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, q_block2_request_2,
+                                      mock.bytes_sent);
+
+    // responses share the token, block 3 is past the end of the resource
+    ADD_BLOCK_RESPONSE(q_block2_response_3, 2);
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(g_data_len, 16);
+    ADD_BLOCK_RESPONSE(q_block2_response_2, 1);
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_SEND], 2);
+    FINAL_CHECK();
+}
+
+ANJ_UNIT_TEST(coap_downloader, q_block2_missing_block) {
+    Q_BLOCK2_TEST_INIT(2);
+    mock.bytes_to_send = 500;
+    anj_coap_downloader_step(&ctx);
+    ADD_BLOCK_RESPONSE(q_block2_response_1, 0);
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_SEND], 2);
+    ADD_BLOCK_RESPONSE(q_block2_response_3, 2);
+    anj_coap_downloader_step(&ctx);
+
+    // only the missing block is requested again, with a new token
+    mock_time_advance(anj_time_duration_new(4, ANJ_TIME_UNIT_S));
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_SEND], 3);
+    ANJ_UNIT_ASSERT_NOT_EQUAL(memcmp(ctx.window.slots[0].token.bytes,
+                                     ctx.window.slots[1].token.bytes, 8),
+                              0);
+    copy_block_token_and_msg_id(&ctx, q_block2_request_3, 1);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, sizeof(q_block2_request_3) - 1);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, q_block2_request_3,
+                                      mock.bytes_sent);
+    ADD_BLOCK_RESPONSE(q_block2_response_2, 1);
+    anj_coap_downloader_step(&ctx);
+    FINAL_CHECK();
+}
+
+ANJ_UNIT_TEST(coap_downloader, q_block2_not_supported) {
+    Q_BLOCK2_TEST_INIT(2);
+    mock.bytes_to_send = 500;
+    anj_coap_downloader_step(&ctx);
+    ADD_BLOCK_RESPONSE(q_block2_response_bad_option, 0);
+    anj_coap_downloader_step(&ctx);
+
+    // the first block is requested again with Block2
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_SEND], 2);
+    copy_block_token_and_msg_id(&ctx, window_request_1, 0);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, sizeof(window_request_1) - 1);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, window_request_1,
+                                      mock.bytes_sent);
+    ADD_BLOCK_RESPONSE(response_1, 0);
+    anj_coap_downloader_step(&ctx);
+    // blocks 1 and 2 are requested separately
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_SEND], 4);
+    ADD_BLOCK_RESPONSE(response_3, 2);
+    anj_coap_downloader_step(&ctx);
+    ADD_BLOCK_RESPONSE(response_2, 1);
+    anj_coap_downloader_step(&ctx);
+    FINAL_CHECK();
+}
+#    endif // ANJ_COAP_DOWNLOADER_WITH_Q_BLOCK2
+#endif // ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW
+
+#ifdef ANJ_COAP_DOWNLOADER_WITH_RESUME
+static uint8_t g_membuf_data[512];
+static size_t g_membuf_write_offset;
+static size_t g_membuf_read_offset;
+
+static int mem_write_cb(void *ctx, const void *buf, size_t size) {
+    (void) ctx;
+    if (g_membuf_write_offset + size > sizeof(g_membuf_data)) {
+        return -1;
+    }
+    memcpy(g_membuf_data + g_membuf_write_offset, buf, size);
+    g_membuf_write_offset += size;
+    return 0;
+}
+
+static int mem_read_cb(void *ctx, void *buf, size_t size) {
+    (void) ctx;
+    if (g_membuf_read_offset + size > g_membuf_write_offset) {
+        return -1;
+    }
+    memcpy(buf, g_membuf_data + g_membuf_read_offset, size);
+    g_membuf_read_offset += size;
+    return 0;
+}
+
+static int progress_store(anj_coap_downloader_t *ctx) {
+    g_membuf_write_offset = 0;
+    anj_persistence_context_t persistence =
+            anj_persistence_store_context_create(mem_write_cb, NULL);
+    return anj_coap_downloader_progress_store(ctx, &persistence);
+}
+
+static int progress_restore(anj_coap_downloader_t *ctx) {
+    g_membuf_read_offset = 0;
+    anj_persistence_context_t persistence =
+            anj_persistence_restore_context_create(mem_read_cb, NULL);
+    return anj_coap_downloader_progress_restore(ctx, &persistence);
+}
+
+// downloads the first block, then the connection is lost
+#    define INTERRUPTED_DOWNLOAD()                                      \
+        TEST_INIT();                                                    \
+        START_DOWNLOAD(BASE_URI);                                       \
+        HANDLE_REQUEST(request_1, response_1);                          \
+        anj_coap_downloader_terminate(&ctx);                            \
+        anj_coap_downloader_step(&ctx);                                 \
+        anj_coap_downloader_step(&ctx);                                 \
+        ANJ_UNIT_ASSERT_EQUAL(g_set_connection_status,                  \
+                              ANJ_COAP_DOWNLOADER_STATUS_FAILED);       \
+        ANJ_UNIT_ASSERT_SUCCESS(progress_store(&ctx));                  \
+        ANJ_UNIT_ASSERT_SUCCESS(anj_coap_downloader_init(&ctx, &config)); \
+        ANJ_UNIT_ASSERT_SUCCESS(progress_restore(&ctx))
+
+static char response_2_new_etag[] =
+        "\x68"                             // header v 0x01, Ack, tkl 8
+        "\x45\x00\x00"                     // Content code 2.05
+        "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF" // token
+        "\x41\xA3"                         // etag 0xA3
+        "\xd1\x06\x18" // block2 num 1, more true, size 16
+        "\xFF"         // payload marker
+        "\x21\x22\x23\x24\x25\x26\x27\x28"
+        "\x31\x32\x33\x34\x35\x36\x37\x38";
+
+ANJ_UNIT_TEST(coap_downloader, resume_download) {
+    INTERRUPTED_DOWNLOAD();
+    START_DOWNLOAD(BASE_URI);
+    ANJ_UNIT_ASSERT_EQUAL(anj_coap_downloader_get_resume_offset(&ctx), 16);
+    g_data_len = 0;
+    HANDLE_REQUEST(request_2, response_2);
+    HANDLE_REQUEST(request_3, response_3);
+    anj_coap_downloader_step(&ctx);
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(g_set_connection_status,
+                          ANJ_COAP_DOWNLOADER_STATUS_FINISHED);
+    ANJ_UNIT_ASSERT_EQUAL(g_data_len, 24);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(g_data,
+                                      "\x21\x22\x23\x24\x25\x26\x27\x28"
+                                      "\x31\x32\x33\x34\x35\x36\x37\x38"
+                                      "\x41\x42\x43\x44\x45\x46\x47\x48",
+                                      g_data_len);
+
+    // progress of the finished download is discarded
+    g_data_len = 0;
+    START_DOWNLOAD(BASE_URI);
+    ANJ_UNIT_ASSERT_EQUAL(anj_coap_downloader_get_resume_offset(&ctx), 0);
+    HANDLE_REQUEST(request_1, response_1);
+    HANDLE_REQUEST(request_2, response_2);
+    HANDLE_REQUEST(request_3, response_3);
+    FINAL_CHECK();
+}
+
+ANJ_UNIT_TEST(coap_downloader, resume_download_different_uri) {
+    INTERRUPTED_DOWNLOAD();
+    START_DOWNLOAD(BASE_URI_2);
+    ANJ_UNIT_ASSERT_EQUAL(anj_coap_downloader_get_resume_offset(&ctx), 0);
+    g_data_len = 0;
+    HANDLE_REQUEST(request_1, response_1);
+    HANDLE_REQUEST(request_2, response_2);
+    HANDLE_REQUEST(request_3, response_3);
+    FINAL_CHECK();
+}
+
+ANJ_UNIT_TEST(coap_downloader, resume_download_etag_mismatch) {
+    INTERRUPTED_DOWNLOAD();
+    START_DOWNLOAD(BASE_URI);
+    mock.bytes_to_send = 500;
+    anj_coap_downloader_step(&ctx);
+    COPY_TOKEN_AND_MSG_ID(request_2, 8);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, request_2,
+                                      sizeof(request_2) - 1);
+    ADD_RESPONSE(response_2_new_etag);
+    anj_coap_downloader_step(&ctx);
+    anj_coap_downloader_step(&ctx);
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(g_set_connection_status,
+                          ANJ_COAP_DOWNLOADER_STATUS_FAILED);
+    ANJ_UNIT_ASSERT_EQUAL(anj_coap_downloader_get_error(&ctx),
+                          ANJ_COAP_DOWNLOADER_ERR_ETAG_MISMATCH);
+
+    // next attempt starts from the beginning
+    START_DOWNLOAD(BASE_URI);
+    ANJ_UNIT_ASSERT_EQUAL(anj_coap_downloader_get_resume_offset(&ctx), 0);
+    HANDLE_REQUEST(request_1, response_1);
+}
+
+ANJ_UNIT_TEST(coap_downloader, resume_download_invalid_progress) {
+    TEST_INIT();
+    g_membuf_write_offset = 3;
+    memcpy(g_membuf_data, "CDL", 3);
+    ANJ_UNIT_ASSERT_FAILED(progress_restore(&ctx));
+    START_DOWNLOAD(BASE_URI);
+    ANJ_UNIT_ASSERT_EQUAL(anj_coap_downloader_get_resume_offset(&ctx), 0);
+    HANDLE_REQUEST(request_1, response_1);
+    ANJ_UNIT_ASSERT_EQUAL(progress_restore(&ctx),
+                          ANJ_COAP_DOWNLOADER_ERR_IN_PROGRESS);
+}
+
+#    ifdef ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW
+ANJ_UNIT_TEST(coap_downloader, resume_download_block_window) {
+    INTERRUPTED_DOWNLOAD();
+    config.block_window = 2;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_coap_downloader_init(&ctx, &config));
+    ANJ_UNIT_ASSERT_SUCCESS(progress_restore(&ctx));
+    START_DOWNLOAD(BASE_URI);
+    g_data_len = 0;
+    // the first requested block is sent alone
+    mock.bytes_to_send = 500;
+    int send_count = mock.call_count[ANJ_NET_FUN_SEND];
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_SEND], send_count + 1);
+    copy_block_token_and_msg_id(&ctx, request_2, 1);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, request_2,
+                                      sizeof(request_2) - 1);
+    ADD_BLOCK_RESPONSE(response_2, 1);
+    anj_coap_downloader_step(&ctx);
+    // block 1 is delivered, blocks 2 and 3 are requested
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_SEND], send_count + 3);
+    ADD_BLOCK_RESPONSE(response_3, 2);
+    anj_coap_downloader_step(&ctx);
+    anj_coap_downloader_step(&ctx);
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(g_set_connection_status,
+                          ANJ_COAP_DOWNLOADER_STATUS_FINISHED);
+    ANJ_UNIT_ASSERT_EQUAL(g_data_len, 24);
+}
+#    endif // ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW
+#endif // ANJ_COAP_DOWNLOADER_WITH_RESUME
+
+#ifdef ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
+typedef struct {
+    anj_coap_downloader_status_t status;
+    uint8_t data[100];
+    size_t data_len;
+} mux_transfer_t;
+
+static void mux_transfer_callback(void *arg,
+                                  anj_coap_downloader_t *downloader,
+                                  anj_coap_downloader_status_t conn_status,
+                                  const uint8_t *data,
+                                  size_t data_len) {
+    (void) downloader;
+    mux_transfer_t *transfer = (mux_transfer_t *) arg;
+    transfer->status = conn_status;
+    if (data == NULL) {
+        return;
+    }
+    memcpy(&transfer->data[transfer->data_len], data, data_len);
+    transfer->data_len += data_len;
+}
+
+#    define MUX_URI "coap://test_uri.com:5683/x"
+
+#    define MUX_TRANSFER_INIT(Ctx, Transfer)                          \
+        anj_coap_downloader_t Ctx;                                    \
+        mux_transfer_t Transfer = { 0 };                              \
+        ANJ_UNIT_ASSERT_SUCCESS(anj_coap_downloader_init(             \
+                &Ctx, &(const anj_coap_downloader_configuration_t) {  \
+                    .event_cb = mux_transfer_callback,                \
+                    .event_cb_arg = &Transfer,                        \
+                    .multiplex_with = &ctx                            \
+                }))
+
+static void copy_token_and_msg_id(anj_coap_downloader_t *downloader,
+                                  char *msg) {
+    memcpy(&msg[4], downloader->exchange_ctx.base_msg.token.bytes, 8);
+    msg[2] = (char) (downloader->exchange_ctx.base_msg.coap_binding_data
+                             .message_id
+                     >> 8);
+    msg[3] = (char) (downloader->exchange_ctx.base_msg.coap_binding_data
+                             .message_id
+                     & 0xFF);
+}
+
+static char mux_request[] = "\x48"         // Confirmable, tkl 8
+                            "\x01\x00\x00" // GET 0x01, msg id
+                            "\x00\x00\x00\x00\x00\x00\x00\x00" // token
+                            "\xb1\x78";                        // uri path /x
+
+static char mux_response[] = "\x68"         // header v 0x01, Ack, tkl 8
+                             "\x45\x00\x00" // Content code 2.05
+                             "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF" // token
+                             "\x41\xB3" // etag 0xB3
+                             "\xFF"     // payload marker
+                             "\x51\x52\x53\x54";
+
+#    define ADD_MUX_RESPONSE(Downloader, Response)    \
+        copy_token_and_msg_id(Downloader, Response); \
+        mock.bytes_to_recv = sizeof(Response) - 1;   \
+        mock.data_to_recv = (uint8_t *) Response
+
+ANJ_UNIT_TEST(coap_downloader, multiplexed_download) {
+    TEST_INIT();
+    MUX_TRANSFER_INIT(ctx2, transfer2);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_coap_downloader_start(&ctx, BASE_URI, NULL));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_coap_downloader_start(&ctx2, MUX_URI, NULL));
+    ANJ_UNIT_ASSERT_TRUE(ctx2.mux_owner == &ctx);
+
+    // attached transfer is stepped by the owner
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_CONNECT], 1);
+    ANJ_UNIT_ASSERT_EQUAL(transfer2.status,
+                          ANJ_COAP_DOWNLOADER_STATUS_STARTING);
+    ANJ_UNIT_ASSERT_EQUAL(ctx2.status, ANJ_COAP_DOWNLOADER_STATUS_DOWNLOADING);
+
+    // both requests are sent over the same socket, with distinct message IDs
+    mock.bytes_to_send = 500;
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_SEND], 2);
+    copy_token_and_msg_id(&ctx2, mux_request);
+    ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, sizeof(mux_request) - 1);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, mux_request,
+                                      mock.bytes_sent);
+    ANJ_UNIT_ASSERT_NOT_EQUAL(
+            ctx.exchange_ctx.base_msg.coap_binding_data.message_id,
+            ctx2.exchange_ctx.base_msg.coap_binding_data.message_id);
+    ANJ_UNIT_ASSERT_NOT_EQUAL(memcmp(ctx.exchange_ctx.base_msg.token.bytes,
+                                     ctx2.exchange_ctx.base_msg.token.bytes,
+                                     8),
+                              0);
+
+    // responses are passed to the transfers by token
+    ADD_RESPONSE(response_1);
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(g_data_len, 16);
+    ANJ_UNIT_ASSERT_EQUAL(transfer2.data_len, 0);
+    // next block is requested at once
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_SEND], 3);
+    COPY_TOKEN_AND_MSG_ID(request_2, 8);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, request_2,
+                                      sizeof(request_2) - 1);
+
+    ADD_MUX_RESPONSE(&ctx2, mux_response);
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(g_data_len, 16);
+    ANJ_UNIT_ASSERT_EQUAL(transfer2.data_len, 4);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(transfer2.data, "\x51\x52\x53\x54", 4);
+    ANJ_UNIT_ASSERT_EQUAL(ctx2.status, ANJ_COAP_DOWNLOADER_STATUS_FINISHING);
+
+    // finished transfer detaches itself, the socket is left open
+    ADD_RESPONSE(response_2);
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(g_data_len, 32);
+    ANJ_UNIT_ASSERT_NULL(ctx.mux_transfers);
+    ANJ_UNIT_ASSERT_NULL(ctx2.mux_owner);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_CLEANUP], 0);
+    anj_coap_downloader_step(&ctx2);
+    ANJ_UNIT_ASSERT_EQUAL(transfer2.status,
+                          ANJ_COAP_DOWNLOADER_STATUS_FINISHED);
+
+    HANDLE_REQUEST(request_3, response_3);
+    FINAL_CHECK();
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_CONNECT], 1);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_CLEANUP], 1);
+}
+
+ANJ_UNIT_TEST(coap_downloader, multiplexed_download_owner_finishes_first) {
+    TEST_INIT();
+    MUX_TRANSFER_INIT(ctx2, transfer2);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_coap_downloader_start(&ctx, MUX_URI, NULL));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_coap_downloader_start(&ctx2, MUX_URI, NULL));
+    anj_coap_downloader_step(&ctx);
+    mock.bytes_to_send = 500;
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_SEND], 2);
+
+    ADD_MUX_RESPONSE(&ctx, mux_response);
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(g_data_len, 4);
+    // connection is kept open for the attached transfer
+    anj_coap_downloader_step(&ctx);
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(g_set_connection_status,
+                          ANJ_COAP_DOWNLOADER_STATUS_FINISHING);
+    ANJ_UNIT_ASSERT_TRUE(
+            anj_time_duration_eq(anj_coap_downloader_next_step_time(&ctx),
+                                 ANJ_TIME_DURATION_ZERO));
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_CLEANUP], 0);
+    ANJ_UNIT_ASSERT_EQUAL(
+            anj_coap_downloader_start(&ctx, BASE_URI, NULL),
+            ANJ_COAP_DOWNLOADER_ERR_IN_PROGRESS);
+
+    ADD_MUX_RESPONSE(&ctx2, mux_response);
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(transfer2.data_len, 4);
+    anj_coap_downloader_step(&ctx);
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_CLEANUP], 1);
+    ANJ_UNIT_ASSERT_EQUAL(ctx.status, ANJ_COAP_DOWNLOADER_STATUS_FINISHED);
+    anj_coap_downloader_step(&ctx2);
+    ANJ_UNIT_ASSERT_EQUAL(transfer2.status,
+                          ANJ_COAP_DOWNLOADER_STATUS_FINISHED);
+}
+
+ANJ_UNIT_TEST(coap_downloader, multiplexed_download_round_robin) {
+    TEST_INIT();
+    MUX_TRANSFER_INIT(ctx2, transfer2);
+    MUX_TRANSFER_INIT(ctx3, transfer3);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_coap_downloader_start(&ctx, BASE_URI, NULL));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_coap_downloader_start(&ctx2, MUX_URI, NULL));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_coap_downloader_start(&ctx3, MUX_URI, NULL));
+    ANJ_UNIT_ASSERT_TRUE(ctx.mux_transfers == &ctx3);
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_TRUE(ctx.mux_transfers == &ctx2);
+    // the transfer stepped first now sends last
+    mock.bytes_to_send = 500;
+    anj_coap_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_SEND], 3);
+    copy_token_and_msg_id(&ctx3, mux_request);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer, mux_request,
+                                      sizeof(mux_request) - 1);
+    ANJ_UNIT_ASSERT_TRUE(ctx.mux_transfers == &ctx3);
+}
+
+ANJ_UNIT_TEST(coap_downloader, multiplexed_download_different_endpoint) {
+    TEST_INIT();
+    MUX_TRANSFER_INIT(ctx2, transfer2);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_coap_downloader_start(&ctx, BASE_URI, NULL));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_coap_downloader_start(&ctx2, BASE_URI_2, NULL));
+    ANJ_UNIT_ASSERT_NULL(ctx2.mux_owner);
+    ANJ_UNIT_ASSERT_NULL(ctx.mux_transfers);
+    anj_coap_downloader_step(&ctx);
+    anj_coap_downloader_step(&ctx2);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_CONNECT], 2);
+}
+#endif // ANJ_COAP_DOWNLOADER_WITH_MULTIPLEXING
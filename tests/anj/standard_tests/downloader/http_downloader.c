@@ -0,0 +1,267 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/compat/net/anj_net_api.h>
+#include <anj/defs.h>
+#include <anj/http_downloader.h>
+#include <anj/time.h>
+
+#include "../mock/net_api_mock.h"
+#include "../mock/time_api_mock.h"
+
+#include <anj_unit_test.h>
+
+#ifdef ANJ_WITH_HTTP_DOWNLOADER
+
+static anj_http_downloader_status_t g_status;
+static char g_data[100];
+static size_t g_data_len;
+static int g_callback_counter;
+
+static void http_downloader_callback(void *arg,
+                                     anj_http_downloader_t *downloader,
+                                     anj_http_downloader_status_t status,
+                                     const uint8_t *data,
+                                     size_t data_len) {
+    (void) arg;
+    (void) downloader;
+    g_status = status;
+    g_callback_counter++;
+    if (data) {
+        memcpy(&g_data[g_data_len], data, data_len);
+        g_data_len += data_len;
+    }
+}
+
+#    define TEST_INIT(KeepAlive, MaxResumeAttempts)                   \
+        mock_time_reset();                                            \
+        net_api_mock_t mock = { 0 };                                  \
+        net_api_mock_ctx_init(&mock);                                 \
+        mock.inner_mtu_value = 1400;                                  \
+        mock.bytes_to_send = sizeof(mock.send_data_buffer);           \
+        anj_http_downloader_t ctx;                                    \
+        anj_http_downloader_configuration_t config = {                \
+            .event_cb = http_downloader_callback,                     \
+            .keep_alive = KeepAlive,                                  \
+            .max_resume_attempts = MaxResumeAttempts                  \
+        };                                                            \
+        g_data_len = 0;                                               \
+        memset(g_data, 0, sizeof(g_data));                            \
+        g_callback_counter = 0;                                       \
+        g_status = ANJ_HTTP_DOWNLOADER_STATUS_INITIAL;                \
+        ANJ_UNIT_ASSERT_SUCCESS(anj_http_downloader_init(&ctx, &config));
+
+#    define START_DOWNLOAD(Uri, Offset)                                  \
+        ANJ_UNIT_ASSERT_SUCCESS(                                         \
+                anj_http_downloader_start(&ctx, Uri, Offset, NULL));     \
+        anj_http_downloader_step(&ctx);                                  \
+        ANJ_UNIT_ASSERT_EQUAL(g_status,                                  \
+                              ANJ_HTTP_DOWNLOADER_STATUS_STARTING)
+
+#    define RECEIVE(Response)                            \
+        mock.bytes_to_recv = sizeof(Response) - 1;       \
+        mock.data_to_recv = (uint8_t *) (Response);      \
+        anj_http_downloader_step(&ctx)
+
+#    define VERIFY_REQUEST(Request)                                   \
+        ANJ_UNIT_ASSERT_EQUAL(mock.bytes_sent, sizeof(Request) - 1);  \
+        ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(mock.send_data_buffer,      \
+                                          Request, mock.bytes_sent)
+
+#    define FINISH(Status)                                             \
+        anj_http_downloader_step(&ctx);                                \
+        ANJ_UNIT_ASSERT_EQUAL(g_status,                                \
+                              ANJ_HTTP_DOWNLOADER_STATUS_FINISHING);   \
+        anj_http_downloader_step(&ctx);                                \
+        ANJ_UNIT_ASSERT_EQUAL(g_status, Status);                       \
+        ANJ_UNIT_ASSERT_FALSE(anj_time_duration_is_valid(              \
+                anj_http_downloader_next_step_time(&ctx)))
+
+ANJ_UNIT_TEST(http_downloader, content_length) {
+    TEST_INIT(false, 0);
+    START_DOWNLOAD("http://example.com/fw/package.bin?v=2#frag", 0);
+    ANJ_UNIT_ASSERT_EQUAL_STRING(mock.hostname, "example.com");
+    ANJ_UNIT_ASSERT_EQUAL_STRING(mock.port, "80");
+
+    RECEIVE("HTTP/1.1 200 OK\r\n"
+            "content-length: 10\r\n"
+            "ETag: \"abc\"\r\n"
+            "\r\n"
+            "0123456789");
+    VERIFY_REQUEST("GET /fw/package.bin?v=2 HTTP/1.1\r\n"
+                   "Host: example.com:80\r\n"
+                   "Connection: close\r\n"
+                   "\r\n");
+    ANJ_UNIT_ASSERT_EQUAL(g_status, ANJ_HTTP_DOWNLOADER_STATUS_DOWNLOADING);
+    ANJ_UNIT_ASSERT_EQUAL(g_data_len, 10);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES(g_data, "0123456789");
+    FINISH(ANJ_HTTP_DOWNLOADER_STATUS_FINISHED);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_CLEANUP], 1);
+    ANJ_UNIT_ASSERT_EQUAL(anj_http_downloader_get_http_status(&ctx), 200);
+}
+
+ANJ_UNIT_TEST(http_downloader, chunked_with_keep_alive) {
+    TEST_INIT(true, 0);
+    START_DOWNLOAD("http://example.com:8080", 0);
+
+    // chunks and lines split between reads
+    RECEIVE("HTTP/1.1 200 OK\r\n"
+            "Transfer-Encoding: chunked\r\n"
+            "\r\n"
+            "4;ext=1\r\n"
+            "ab");
+    VERIFY_REQUEST("GET / HTTP/1.1\r\n"
+                   "Host: example.com:8080\r\n"
+                   "\r\n");
+    RECEIVE("cd\r\n"
+            "A\r");
+    RECEIVE("\n0123456789\r\n"
+            "0\r\n"
+            "Trailer: x\r\n");
+    ANJ_UNIT_ASSERT_EQUAL(g_status, ANJ_HTTP_DOWNLOADER_STATUS_DOWNLOADING);
+    RECEIVE("\r\n");
+    ANJ_UNIT_ASSERT_EQUAL(g_data_len, 14);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES(g_data, "abcd0123456789");
+    FINISH(ANJ_HTTP_DOWNLOADER_STATUS_FINISHED);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_CLEANUP], 0);
+
+    // connection is reused by the next download from the same server
+    g_data_len = 0;
+    START_DOWNLOAD("http://example.com:8080/b", 0);
+    RECEIVE("HTTP/1.1 200 OK\r\n"
+            "Content-Length: 2\r\n"
+            "Connection: close\r\n"
+            "\r\n"
+            "xy");
+    VERIFY_REQUEST("GET /b HTTP/1.1\r\n"
+                   "Host: example.com:8080\r\n"
+                   "\r\n");
+    ANJ_UNIT_ASSERT_EQUAL_BYTES(g_data, "xy");
+    FINISH(ANJ_HTTP_DOWNLOADER_STATUS_FINISHED);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_CONNECT], 1);
+    // server asked to close the connection
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_CLEANUP], 1);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_http_downloader_disconnect(&ctx));
+}
+
+ANJ_UNIT_TEST(http_downloader, resume_after_connection_loss) {
+    TEST_INIT(false, 1);
+    START_DOWNLOAD("http://example.com/fw", 0);
+    RECEIVE("HTTP/1.1 200 OK\r\n"
+            "Content-Length: 10\r\n"
+            "ETag: \"v1\"\r\n"
+            "\r\n"
+            "0123");
+    mock.call_result[ANJ_NET_FUN_RECV] = -1;
+    anj_http_downloader_step(&ctx);
+    mock.call_result[ANJ_NET_FUN_RECV] = 0;
+    // reconnects and asks for the rest of the resource
+    anj_http_downloader_step(&ctx);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_CONNECT], 2);
+    RECEIVE("HTTP/1.1 206 Partial Content\r\n"
+            "Content-Range: bytes 4-9/10\r\n"
+            "Content-Length: 6\r\n"
+            "ETag: \"v1\"\r\n"
+            "\r\n"
+            "456789");
+    VERIFY_REQUEST("GET /fw HTTP/1.1\r\n"
+                   "Host: example.com:80\r\n"
+                   "Range: bytes=4-\r\n"
+                   "If-Range: \"v1\"\r\n"
+                   "Connection: close\r\n"
+                   "\r\n");
+    ANJ_UNIT_ASSERT_EQUAL(g_data_len, 10);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES(g_data, "0123456789");
+    FINISH(ANJ_HTTP_DOWNLOADER_STATUS_FINISHED);
+}
+
+ANJ_UNIT_TEST(http_downloader, resource_changed_during_resume) {
+    TEST_INIT(false, 1);
+    START_DOWNLOAD("http://example.com/fw", 0);
+    RECEIVE("HTTP/1.1 200 OK\r\n"
+            "Content-Length: 10\r\n"
+            "ETag: \"v1\"\r\n"
+            "\r\n"
+            "0123");
+    mock.call_result[ANJ_NET_FUN_RECV] = -1;
+    anj_http_downloader_step(&ctx);
+    mock.call_result[ANJ_NET_FUN_RECV] = 0;
+    anj_http_downloader_step(&ctx);
+    RECEIVE("HTTP/1.1 200 OK\r\n"
+            "Content-Length: 10\r\n"
+            "ETag: \"v2\"\r\n"
+            "\r\n"
+            "abcdefghij");
+    ANJ_UNIT_ASSERT_EQUAL(g_data_len, 4);
+    FINISH(ANJ_HTTP_DOWNLOADER_STATUS_FAILED);
+    ANJ_UNIT_ASSERT_EQUAL(anj_http_downloader_get_error(&ctx),
+                          ANJ_HTTP_DOWNLOADER_ERR_ETAG_MISMATCH);
+}
+
+ANJ_UNIT_TEST(http_downloader, offset_ignored_by_server) {
+    TEST_INIT(false, 0);
+    START_DOWNLOAD("http://[::1]:8080/fw", 6);
+    ANJ_UNIT_ASSERT_EQUAL_STRING(mock.hostname, "::1");
+    RECEIVE("HTTP/1.0 200 OK\r\n"
+            "\r\n"
+            "0123456789");
+    VERIFY_REQUEST("GET /fw HTTP/1.1\r\n"
+                   "Host: [::1]:8080\r\n"
+                   "Range: bytes=6-\r\n"
+                   "Connection: close\r\n"
+                   "\r\n");
+    ANJ_UNIT_ASSERT_EQUAL(g_data_len, 4);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES(g_data, "6789");
+    // body without length lasts until the connection is closed
+    ANJ_UNIT_ASSERT_EQUAL(g_status, ANJ_HTTP_DOWNLOADER_STATUS_DOWNLOADING);
+    anj_http_downloader_terminate(&ctx);
+    FINISH(ANJ_HTTP_DOWNLOADER_STATUS_FAILED);
+    ANJ_UNIT_ASSERT_EQUAL(anj_http_downloader_get_error(&ctx),
+                          ANJ_HTTP_DOWNLOADER_ERR_TERMINATED);
+}
+
+ANJ_UNIT_TEST(http_downloader, errors) {
+    TEST_INIT(false, 0);
+    ANJ_UNIT_ASSERT_EQUAL(
+            anj_http_downloader_start(&ctx, "coap://example.com", 0, NULL),
+            ANJ_HTTP_DOWNLOADER_ERR_INVALID_URI);
+    ANJ_UNIT_ASSERT_EQUAL(
+            anj_http_downloader_start(&ctx, "http://example.com:99999", 0,
+                                      NULL),
+            ANJ_HTTP_DOWNLOADER_ERR_INVALID_URI);
+    ANJ_UNIT_ASSERT_EQUAL(
+            anj_http_downloader_start(&ctx, "http://:80/fw", 0, NULL),
+            ANJ_HTTP_DOWNLOADER_ERR_INVALID_URI);
+
+    START_DOWNLOAD("http://example.com/missing", 0);
+    ANJ_UNIT_ASSERT_EQUAL(
+            anj_http_downloader_start(&ctx, "http://example.com", 0, NULL),
+            ANJ_HTTP_DOWNLOADER_ERR_IN_PROGRESS);
+    RECEIVE("HTTP/1.1 404 Not Found\r\n"
+            "Content-Length: 0\r\n"
+            "\r\n");
+    FINISH(ANJ_HTTP_DOWNLOADER_STATUS_FAILED);
+    ANJ_UNIT_ASSERT_EQUAL(anj_http_downloader_get_error(&ctx),
+                          ANJ_HTTP_DOWNLOADER_ERR_INVALID_RESPONSE);
+    ANJ_UNIT_ASSERT_EQUAL(anj_http_downloader_get_http_status(&ctx), 404);
+
+    START_DOWNLOAD("http://example.com/slow", 0);
+    anj_http_downloader_step(&ctx);
+    mock_time_advance(anj_time_duration_new(31, ANJ_TIME_UNIT_S));
+    anj_http_downloader_step(&ctx);
+    FINISH(ANJ_HTTP_DOWNLOADER_STATUS_FAILED);
+    ANJ_UNIT_ASSERT_EQUAL(anj_http_downloader_get_error(&ctx),
+                          ANJ_HTTP_DOWNLOADER_ERR_TIMEOUT);
+}
+
+#endif // ANJ_WITH_HTTP_DOWNLOADER
@@ -1628,13 +1628,13 @@ ANJ_UNIT_TEST(client_requests, set_udp_tx_params) {
     ASSERT_EQ(ctx.tx_params.max_retransmit, default_params.max_retransmit);
 
     anj_exchange_udp_tx_params_t test_params = {
-        .ack_random_factor = 10,
+        .ack_random_factor = ANJ_ACK_RANDOM_FACTOR(10),
         .ack_timeout = anj_time_duration_new(1100, ANJ_TIME_UNIT_MS),
         .max_retransmit = 12
     };
     // random factor must be >= 1
     anj_exchange_udp_tx_params_t err_params = {
-        .ack_random_factor = 0.1,
+        .ack_random_factor = ANJ_ACK_RANDOM_FACTOR(0.1),
         .ack_timeout = anj_time_duration_new(11111, ANJ_TIME_UNIT_MS),
         .max_retransmit = 111
     };
@@ -1646,6 +1646,31 @@ ANJ_UNIT_TEST(client_requests, set_udp_tx_params) {
     ASSERT_EQ(ctx.tx_params.max_retransmit, test_params.max_retransmit);
 }
 
+ANJ_UNIT_TEST(client_requests, ack_random_factor) {
+    anj_exchange_udp_tx_params_t params = ANJ_EXCHANGE_UDP_TX_PARAMS_DEFAULT;
+    anj_time_duration_t ack_timeout =
+            anj_time_duration_new(4, ANJ_TIME_UNIT_S);
+
+    ASSERT_EQ(_anj_exchange_mul_ack_random_factor(&params, ack_timeout, 15).us,
+              90 * 1000 * 1000);
+    ASSERT_TRUE(anj_time_duration_eq(
+            _anj_exchange_initial_timeout(&params, ack_timeout, 0),
+            ack_timeout));
+    ASSERT_EQ(_anj_exchange_initial_timeout(&params, ack_timeout,
+                                            UINT32_MAX / 2 + 1)
+                      .us
+                      / 1000,
+              5000);
+    anj_time_duration_t max_timeout =
+            _anj_exchange_initial_timeout(&params, ack_timeout, UINT32_MAX);
+    ASSERT_TRUE(anj_time_duration_lt(max_timeout,
+                                     anj_time_duration_new(6000001,
+                                                           ANJ_TIME_UNIT_US)));
+    ASSERT_TRUE(anj_time_duration_lt(anj_time_duration_new(5999998,
+                                                           ANJ_TIME_UNIT_US),
+                                     max_timeout));
+}
+
 // Test: Register operation with block transfer number mismatch.
 // Client LwM2M               |         Server LwM2M
 // -------------------------------------------------
@@ -1940,3 +1965,289 @@ ANJ_UNIT_TEST(client_requests,
                                     &response),
               ANJ_EXCHANGE_STATE_FINISHED);
 }
+
+#ifdef ANJ_WITH_ADAPTIVE_BLOCK_SIZE
+static uint16_t start_block_send(_anj_exchange_ctx_t *ctx,
+                                 _anj_coap_msg_t *msg,
+                                 handlers_arg_t *handlers_arg,
+                                 uint8_t *buff,
+                                 size_t buff_len) {
+    _anj_exchange_handlers_t handlers = {
+        .read_payload = read_payload_handler,
+        .arg = handlers_arg
+    };
+    handlers_arg->out_payload = "1234567812345678";
+    handlers_arg->out_payload_len = 16;
+    handlers_arg->out_format = _ANJ_COAP_FORMAT_CBOR;
+    handlers_arg->ret_val = _ANJ_EXCHANGE_BLOCK_TRANSFER_NEEDED;
+    memset(msg, 0, sizeof(*msg));
+    msg->operation = ANJ_OP_INF_CON_SEND;
+    ASSERT_EQ(_anj_exchange_new_client_request(ctx, msg, &handlers, buff,
+                                               buff_len),
+              ANJ_EXCHANGE_STATE_MSG_TO_SEND);
+    ASSERT_EQ(msg->block.block_type, ANJ_OPTION_BLOCK_1);
+    ASSERT_EQ(_anj_exchange_process(ctx, ANJ_EXCHANGE_EVENT_SEND_CONFIRMATION,
+                                    msg),
+              ANJ_EXCHANGE_STATE_WAITING_MSG);
+    return msg->block.size;
+}
+
+static void lose_block(_anj_exchange_ctx_t *ctx, _anj_coap_msg_t *msg) {
+    mock_time_advance(anj_time_monotonic_diff(ctx->timeout_timestamp,
+                                              anj_time_monotonic_now()));
+    ASSERT_EQ(_anj_exchange_process(ctx, ANJ_EXCHANGE_EVENT_NONE, msg),
+              ANJ_EXCHANGE_STATE_MSG_TO_SEND);
+    _anj_exchange_terminate(ctx, _ANJ_EXCHANGE_ERROR_TERMINATED);
+}
+
+static void successful_update(_anj_exchange_ctx_t *ctx, _anj_coap_msg_t *msg) {
+    _anj_exchange_handlers_t handlers = { 0 };
+    memset(msg, 0, sizeof(*msg));
+    msg->operation = ANJ_OP_UPDATE;
+    uint8_t buff[16];
+    ASSERT_EQ(_anj_exchange_new_client_request(ctx, msg, &handlers, buff,
+                                               sizeof(buff)),
+              ANJ_EXCHANGE_STATE_MSG_TO_SEND);
+    ASSERT_EQ(_anj_exchange_process(ctx, ANJ_EXCHANGE_EVENT_SEND_CONFIRMATION,
+                                    msg),
+              ANJ_EXCHANGE_STATE_WAITING_MSG);
+    _anj_coap_msg_t response = *msg;
+    response.operation = ANJ_OP_RESPONSE;
+    response.coap_binding_data.type = ANJ_COAP_UDP_TYPE_ACKNOWLEDGEMENT;
+    response.msg_code = ANJ_COAP_CODE_CHANGED;
+    ASSERT_EQ(_anj_exchange_process(ctx, ANJ_EXCHANGE_EVENT_NEW_MSG,
+                                    &response),
+              ANJ_EXCHANGE_STATE_FINISHED);
+}
+
+// Test: timeouts during block transfers halve the block size of the next
+// transfers, successful exchanges double it back up to the buffer size
+ANJ_UNIT_TEST(client_requests, adaptive_block_size) {
+    TEST_INIT();
+    (void) payload;
+    uint8_t buff[70];
+
+    ASSERT_EQ(start_block_send(&ctx, &msg, &handlers_arg, buff, sizeof(buff)),
+              64);
+    lose_block(&ctx, &msg);
+    ASSERT_EQ(start_block_send(&ctx, &msg, &handlers_arg, buff, sizeof(buff)),
+              32);
+    lose_block(&ctx, &msg);
+    ASSERT_EQ(start_block_send(&ctx, &msg, &handlers_arg, buff, sizeof(buff)),
+              16);
+    lose_block(&ctx, &msg);
+    // block size can't be smaller
+    ASSERT_EQ(start_block_send(&ctx, &msg, &handlers_arg, buff, sizeof(buff)),
+              16);
+    _anj_exchange_terminate(&ctx, _ANJ_EXCHANGE_ERROR_TERMINATED);
+
+    for (int i = 0; i < ANJ_ADAPTIVE_BLOCK_SIZE_GROWTH_THRESHOLD; i++) {
+        successful_update(&ctx, &msg);
+    }
+    ASSERT_EQ(start_block_send(&ctx, &msg, &handlers_arg, buff, sizeof(buff)),
+              32);
+    _anj_exchange_terminate(&ctx, _ANJ_EXCHANGE_ERROR_TERMINATED);
+
+    for (int i = 0; i < 6 * ANJ_ADAPTIVE_BLOCK_SIZE_GROWTH_THRESHOLD; i++) {
+        successful_update(&ctx, &msg);
+    }
+    ASSERT_EQ(ctx.block_size_limit, 0);
+    ASSERT_EQ(start_block_send(&ctx, &msg, &handlers_arg, buff, sizeof(buff)),
+              64);
+    _anj_exchange_terminate(&ctx, _ANJ_EXCHANGE_ERROR_TERMINATED);
+}
+
+ANJ_UNIT_TEST(client_requests, adaptive_block_size_reset) {
+    TEST_INIT();
+    (void) payload;
+    uint8_t buff[70];
+
+    ASSERT_EQ(start_block_send(&ctx, &msg, &handlers_arg, buff, sizeof(buff)),
+              64);
+    lose_block(&ctx, &msg);
+    _anj_exchange_reset_block_size_limit(&ctx);
+    ASSERT_EQ(start_block_send(&ctx, &msg, &handlers_arg, buff, sizeof(buff)),
+              64);
+    _anj_exchange_terminate(&ctx, _ANJ_EXCHANGE_ERROR_TERMINATED);
+}
+#endif // ANJ_WITH_ADAPTIVE_BLOCK_SIZE
+
+#ifdef ANJ_WITH_ADAPTIVE_RTO
+static void update_with_rtt(_anj_exchange_ctx_t *ctx,
+                            _anj_coap_msg_t *msg,
+                            int retransmissions,
+                            int64_t rtt_ms) {
+    _anj_exchange_handlers_t handlers = { 0 };
+    memset(msg, 0, sizeof(*msg));
+    msg->operation = ANJ_OP_UPDATE;
+    uint8_t buff[16];
+    ASSERT_EQ(_anj_exchange_new_client_request(ctx, msg, &handlers, buff,
+                                               sizeof(buff)),
+              ANJ_EXCHANGE_STATE_MSG_TO_SEND);
+    ASSERT_EQ(_anj_exchange_process(ctx, ANJ_EXCHANGE_EVENT_SEND_CONFIRMATION,
+                                    msg),
+              ANJ_EXCHANGE_STATE_WAITING_MSG);
+    anj_time_monotonic_t response_time = anj_time_monotonic_add(
+            anj_time_monotonic_now(),
+            anj_time_duration_new(rtt_ms, ANJ_TIME_UNIT_MS));
+    for (int i = 0; i < retransmissions; i++) {
+        mock_time_advance(anj_time_monotonic_diff(ctx->timeout_timestamp,
+                                                  anj_time_monotonic_now()));
+        ASSERT_EQ(_anj_exchange_process(ctx, ANJ_EXCHANGE_EVENT_NONE, msg),
+                  ANJ_EXCHANGE_STATE_MSG_TO_SEND);
+        ASSERT_EQ(_anj_exchange_process(
+                          ctx, ANJ_EXCHANGE_EVENT_SEND_CONFIRMATION, msg),
+                  ANJ_EXCHANGE_STATE_WAITING_MSG);
+    }
+    mock_time_advance(
+            anj_time_monotonic_diff(response_time, anj_time_monotonic_now()));
+    _anj_coap_msg_t response = *msg;
+    response.operation = ANJ_OP_RESPONSE;
+    response.coap_binding_data.type = ANJ_COAP_UDP_TYPE_ACKNOWLEDGEMENT;
+    response.msg_code = ANJ_COAP_CODE_CHANGED;
+    ASSERT_EQ(_anj_exchange_process(ctx, ANJ_EXCHANGE_EVENT_NEW_MSG,
+                                    &response),
+              ANJ_EXCHANGE_STATE_FINISHED);
+}
+
+static void check_initial_timeout(_anj_exchange_ctx_t *ctx,
+                                  _anj_coap_msg_t *msg,
+                                  int64_t rto_us) {
+    _anj_exchange_handlers_t handlers = { 0 };
+    memset(msg, 0, sizeof(*msg));
+    msg->operation = ANJ_OP_UPDATE;
+    uint8_t buff[16];
+    ASSERT_EQ(_anj_exchange_new_client_request(ctx, msg, &handlers, buff,
+                                               sizeof(buff)),
+              ANJ_EXCHANGE_STATE_MSG_TO_SEND);
+    // default ACK_RANDOM_FACTOR is 1.5
+    ASSERT_TRUE(anj_time_duration_geq(
+            ctx->timeout, anj_time_duration_new(rto_us, ANJ_TIME_UNIT_US)));
+    ASSERT_TRUE(anj_time_duration_leq(
+            ctx->timeout,
+            anj_time_duration_new(rto_us * 3 / 2, ANJ_TIME_UNIT_US)));
+    _anj_exchange_terminate(ctx, _ANJ_EXCHANGE_ERROR_TERMINATED);
+}
+
+// Test: round-trip times of previous requests determine the initial timeout
+// of the next ones
+ANJ_UNIT_TEST(client_requests, adaptive_rto) {
+    TEST_INIT();
+    (void) payload;
+    (void) handlers_arg;
+
+    ASSERT_FALSE(anj_time_duration_is_valid(ctx.rto.overall));
+    check_initial_timeout(&ctx, &msg, 2000000);
+
+    // strong estimate: 300ms + 4 * 150ms, averaged with ACK_TIMEOUT
+    update_with_rtt(&ctx, &msg, 0, 300);
+    ASSERT_TRUE(anj_time_duration_eq(
+            ctx.rto.overall, anj_time_duration_new(1450, ANJ_TIME_UNIT_MS)));
+    check_initial_timeout(&ctx, &msg, 1450000);
+
+    // weak estimate: 3000ms + 1500ms, weighted 1/4
+    update_with_rtt(&ctx, &msg, 1, 3000);
+    ASSERT_TRUE(anj_time_duration_eq(
+            ctx.rto.overall,
+            anj_time_duration_new(2212500, ANJ_TIME_UNIT_US)));
+
+    // ambiguous round-trip times after more retransmissions are ignored
+    update_with_rtt(&ctx, &msg, 3, 30000);
+    ASSERT_TRUE(anj_time_duration_eq(
+            ctx.rto.overall,
+            anj_time_duration_new(2212500, ANJ_TIME_UNIT_US)));
+
+    for (int i = 0; i < 40; i++) {
+        update_with_rtt(&ctx, &msg, 0, 0);
+    }
+    ASSERT_TRUE(anj_time_duration_eq(
+            ctx.rto.overall,
+            anj_time_duration_new(ANJ_ADAPTIVE_RTO_MIN_MS, ANJ_TIME_UNIT_MS)));
+    check_initial_timeout(&ctx, &msg, ANJ_ADAPTIVE_RTO_MIN_MS * 1000);
+
+    _anj_exchange_reset_rto(&ctx);
+    ASSERT_FALSE(anj_time_duration_is_valid(ctx.rto.overall));
+    check_initial_timeout(&ctx, &msg, 2000000);
+}
+#endif // ANJ_WITH_ADAPTIVE_RTO
+
+#if ANJ_COAP_TOKEN_SIZE > 0
+static bool reject_tokens(void *arg_ptr, const _anj_coap_token_t *token) {
+    int *to_reject = (int *) arg_ptr;
+    ASSERT_EQ(token->size, ANJ_COAP_TOKEN_SIZE);
+    if (!*to_reject) {
+        return false;
+    }
+    (*to_reject)--;
+    return true;
+}
+
+// Test: new tokens used by other modules are generated again, but not forever
+ANJ_UNIT_TEST(client_requests, token_in_use) {
+    TEST_INIT();
+    (void) payload;
+    (void) handlers_arg;
+    _anj_exchange_handlers_t handlers = { 0 };
+    int to_reject = 3;
+    _anj_exchange_setup_token_check(&ctx, reject_tokens, &to_reject);
+
+    msg.operation = ANJ_OP_UPDATE;
+    ASSERT_EQ(_anj_exchange_new_client_request(&ctx, &msg, &handlers, payload,
+                                               sizeof(payload)),
+              ANJ_EXCHANGE_STATE_MSG_TO_SEND);
+    ASSERT_EQ(to_reject, 0);
+    ASSERT_EQ(msg.token.size, ANJ_COAP_TOKEN_SIZE);
+    _anj_exchange_terminate(&ctx, _ANJ_EXCHANGE_ERROR_TERMINATED);
+
+    to_reject = 100;
+    memset(&msg, 0, sizeof(msg));
+    msg.operation = ANJ_OP_UPDATE;
+    ASSERT_EQ(_anj_exchange_new_client_request(&ctx, &msg, &handlers, payload,
+                                               sizeof(payload)),
+              ANJ_EXCHANGE_STATE_FINISHED);
+    ASSERT_EQ(to_reject, 92);
+}
+#endif // ANJ_COAP_TOKEN_SIZE > 0
+
+#ifdef ANJ_WITH_COUNTER_TOKENS
+static _anj_coap_token_t new_update_token(_anj_exchange_ctx_t *ctx,
+                                          _anj_coap_msg_t *msg) {
+    _anj_exchange_handlers_t handlers = { 0 };
+    memset(msg, 0, sizeof(*msg));
+    msg->operation = ANJ_OP_UPDATE;
+    uint8_t buff[16];
+    ASSERT_EQ(_anj_exchange_new_client_request(ctx, msg, &handlers, buff,
+                                               sizeof(buff)),
+              ANJ_EXCHANGE_STATE_MSG_TO_SEND);
+    _anj_exchange_terminate(ctx, _ANJ_EXCHANGE_ERROR_TERMINATED);
+    ASSERT_EQ(msg->token.size, ANJ_COAP_TOKEN_SIZE);
+    return msg->token;
+}
+
+// Test: tokens derived from the counter don't repeat, the key is generated
+// again after the reseed
+ANJ_UNIT_TEST(client_requests, counter_tokens) {
+    TEST_INIT();
+    (void) payload;
+    (void) handlers_arg;
+    _anj_coap_token_t tokens[16];
+
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(tokens); i++) {
+        tokens[i] = new_update_token(&ctx, &msg);
+        for (size_t j = 0; j < i; j++) {
+            ASSERT_NE(memcmp(tokens[i].bytes, tokens[j].bytes,
+                             ANJ_COAP_TOKEN_SIZE),
+                      0);
+        }
+    }
+    ASSERT_EQ(ctx.token_counter, ANJ_ARRAY_SIZE(tokens));
+
+    uint64_t key = ctx.token_key;
+    _anj_exchange_reseed_tokens(&ctx);
+    _anj_coap_token_t token = new_update_token(&ctx, &msg);
+    ASSERT_EQ(ctx.token_counter, 1);
+    ASSERT_TRUE(ctx.token_key != key);
+    ASSERT_NE(memcmp(token.bytes, tokens[0].bytes, ANJ_COAP_TOKEN_SIZE),
+              0);
+}
+#endif // ANJ_WITH_COUNTER_TOKENS
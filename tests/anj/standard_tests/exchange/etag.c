@@ -0,0 +1,217 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define ANJ_UNIT_ENABLE_SHORT_ASSERTS
+#include <anj/anj_config.h>
+#include <anj/defs.h>
+#include <anj/utils.h>
+
+#include "../../src/anj/coap/coap.h"
+#include "../../src/anj/coap/options.h"
+#include "../../src/anj/exchange.h"
+#include "../mock/time_api_mock.h"
+
+#include <anj_unit_test.h>
+
+#ifdef ANJ_WITH_ETAG
+
+typedef struct {
+    const char *out_payload;
+    size_t out_payload_len;
+    uint8_t ret_val;
+} handlers_arg_t;
+
+static uint8_t payload[20];
+
+static uint8_t read_payload_handler(void *arg_ptr,
+                                    uint8_t *buff,
+                                    size_t buff_len,
+                                    _anj_exchange_read_result_t *out_params) {
+    handlers_arg_t *handlers_arg = (handlers_arg_t *) arg_ptr;
+    out_params->payload_len = ANJ_MIN(handlers_arg->out_payload_len, buff_len);
+    out_params->format = _ANJ_COAP_FORMAT_CBOR;
+    memcpy(buff, handlers_arg->out_payload, out_params->payload_len);
+    return handlers_arg->ret_val;
+}
+
+// Read /3/0/1 with the ETag option if etag is not NULL
+static void decode_read(_anj_coap_msg_t *out_msg, const _anj_etag_t *etag) {
+    static uint8_t request[32];
+    size_t size = 0;
+    const uint8_t header[] = { 0x41, 0x01, 0x33, 0x33, 0x01 };
+    memcpy(request, header, sizeof(header));
+    size += sizeof(header);
+    uint8_t uri_delta = _ANJ_COAP_OPTION_URI_PATH;
+    if (etag) {
+        request[size++] = (uint8_t) ((_ANJ_COAP_OPTION_ETAG << 4) | etag->size);
+        memcpy(&request[size], etag->bytes, etag->size);
+        size += etag->size;
+        uri_delta -= _ANJ_COAP_OPTION_ETAG;
+    }
+    const uint8_t uri[] = { (uint8_t) ((uri_delta << 4) | 1), '3', 0x01, '0',
+                            0x01, '1' };
+    memcpy(&request[size], uri, sizeof(uri));
+    size += sizeof(uri);
+    ASSERT_OK(_anj_coap_decode_udp(request, size, out_msg));
+    ASSERT_EQ(out_msg->operation, ANJ_OP_DM_READ);
+}
+
+static void respond(_anj_exchange_ctx_t *ctx,
+                    _anj_coap_msg_t *msg,
+                    handlers_arg_t *handlers_arg) {
+    _anj_exchange_handlers_t handlers = {
+        .read_payload = read_payload_handler,
+        .arg = handlers_arg
+    };
+    ASSERT_EQ(_anj_exchange_new_server_request(ctx, ANJ_COAP_CODE_CONTENT, msg,
+                                               &handlers, payload,
+                                               sizeof(payload)),
+              ANJ_EXCHANGE_STATE_MSG_TO_SEND);
+}
+
+static void finish(_anj_exchange_ctx_t *ctx, _anj_coap_msg_t *msg) {
+    ASSERT_EQ(_anj_exchange_process(ctx, ANJ_EXCHANGE_EVENT_SEND_CONFIRMATION,
+                                    msg),
+              ANJ_EXCHANGE_STATE_FINISHED);
+}
+
+ANJ_UNIT_TEST(etag, read_with_matching_etag) {
+    mock_time_reset();
+    _anj_exchange_ctx_t ctx;
+    _anj_exchange_init(&ctx);
+    handlers_arg_t handlers_arg = {
+        .out_payload = "1234",
+        .out_payload_len = 4
+    };
+    _anj_coap_msg_t msg;
+
+    decode_read(&msg, NULL);
+    respond(&ctx, &msg, &handlers_arg);
+    ASSERT_EQ(msg.msg_code, ANJ_COAP_CODE_CONTENT);
+    ASSERT_EQ(msg.payload_size, 4);
+    ASSERT_EQ(msg.etag.size, 8);
+    _anj_etag_t etag = msg.etag;
+    finish(&ctx, &msg);
+
+    // the same payload is not sent again
+    decode_read(&msg, &etag);
+    ASSERT_EQ_BYTES_SIZED(msg.etag.bytes, etag.bytes, 8);
+    respond(&ctx, &msg, &handlers_arg);
+    ASSERT_EQ(msg.msg_code, ANJ_COAP_CODE_VALID);
+    ASSERT_EQ(msg.payload_size, 0);
+
+    uint8_t out_buff[32];
+    size_t out_msg_size = 0;
+    ASSERT_OK(_anj_coap_encode_udp(&msg, out_buff, sizeof(out_buff),
+                                   &out_msg_size));
+    const uint8_t expected_header[] = { 0x61, 0x43, 0x33, 0x33, 0x01, 0x48 };
+    ASSERT_EQ(out_msg_size, sizeof(expected_header) + 8);
+    ASSERT_EQ_BYTES_SIZED(out_buff, expected_header, sizeof(expected_header));
+    ASSERT_EQ_BYTES_SIZED(&out_buff[sizeof(expected_header)], etag.bytes, 8);
+    finish(&ctx, &msg);
+
+    // changed payload is sent with a new ETag
+    handlers_arg.out_payload = "1235";
+    decode_read(&msg, &etag);
+    respond(&ctx, &msg, &handlers_arg);
+    ASSERT_EQ(msg.msg_code, ANJ_COAP_CODE_CONTENT);
+    ASSERT_EQ(msg.payload_size, 4);
+    ASSERT_EQ(msg.etag.size, 8);
+    ASSERT_NE(memcmp(msg.etag.bytes, etag.bytes, 8), 0);
+    finish(&ctx, &msg);
+}
+
+ANJ_UNIT_TEST(etag, no_etag_for_block_transfer) {
+    mock_time_reset();
+    _anj_exchange_ctx_t ctx;
+    _anj_exchange_init(&ctx);
+    handlers_arg_t handlers_arg = {
+        .out_payload = "12345678123456781234",
+        .out_payload_len = 20,
+        .ret_val = _ANJ_EXCHANGE_BLOCK_TRANSFER_NEEDED
+    };
+    _anj_coap_msg_t msg;
+    _anj_etag_t etag = {
+        .size = 2,
+        .bytes = { 1, 2 }
+    };
+
+    decode_read(&msg, &etag);
+    respond(&ctx, &msg, &handlers_arg);
+    ASSERT_EQ(msg.msg_code, ANJ_COAP_CODE_CONTENT);
+    ASSERT_EQ(msg.block.block_type, ANJ_OPTION_BLOCK_2);
+    ASSERT_EQ(msg.payload_size, 16);
+    ASSERT_EQ(msg.etag.size, 0);
+    _anj_exchange_terminate(&ctx, _ANJ_EXCHANGE_ERROR_TERMINATED);
+}
+
+static void new_notification(_anj_exchange_ctx_t *ctx,
+                             _anj_coap_msg_t *msg,
+                             handlers_arg_t *handlers_arg,
+                             const _anj_etag_t *last_etag) {
+    *msg = (_anj_coap_msg_t) {
+        .operation = ANJ_OP_INF_NON_CON_NOTIFY,
+        .token = {
+            .size = 1,
+            .bytes = { 0x21 }
+        },
+        .observe_number = 5,
+        .etag = *last_etag
+    };
+    _anj_exchange_handlers_t handlers = {
+        .read_payload = read_payload_handler,
+        .arg = handlers_arg
+    };
+    ASSERT_EQ(_anj_exchange_new_client_request(ctx, msg, &handlers, payload,
+                                               sizeof(payload)),
+              ANJ_EXCHANGE_STATE_MSG_TO_SEND);
+}
+
+ANJ_UNIT_TEST(etag, notification_with_unchanged_payload) {
+    mock_time_reset();
+    _anj_exchange_ctx_t ctx;
+    _anj_exchange_init(&ctx);
+    handlers_arg_t handlers_arg = {
+        .out_payload = "1234",
+        .out_payload_len = 4
+    };
+    _anj_coap_msg_t msg;
+
+    new_notification(&ctx, &msg, &handlers_arg, &(_anj_etag_t) { 0 });
+    ASSERT_EQ(msg.msg_code, ANJ_COAP_CODE_CONTENT);
+    ASSERT_EQ(msg.payload_size, 4);
+    ASSERT_EQ(msg.etag.size, 8);
+    _anj_etag_t etag = msg.etag;
+    finish(&ctx, &msg);
+
+    new_notification(&ctx, &msg, &handlers_arg, &etag);
+    ASSERT_EQ(msg.msg_code, ANJ_COAP_CODE_VALID);
+    ASSERT_EQ(msg.payload_size, 0);
+    uint8_t out_buff[32];
+    size_t out_msg_size = 0;
+    ASSERT_OK(_anj_coap_encode_udp(&msg, out_buff, sizeof(out_buff),
+                                   &out_msg_size));
+    // ETag followed by Observe option
+    const uint8_t expected_header[] = { 0x51, 0x43, 0x00, 0x00, 0x21, 0x48 };
+    const uint8_t expected_observe[] = { 0x21, 0x05 };
+    ASSERT_EQ(out_msg_size,
+              sizeof(expected_header) + 8 + sizeof(expected_observe));
+    ASSERT_EQ_BYTES_SIZED(out_buff, expected_header, 2);
+    ASSERT_EQ_BYTES_SIZED(&out_buff[4], &expected_header[4], 2);
+    ASSERT_EQ_BYTES_SIZED(&out_buff[sizeof(expected_header)], etag.bytes, 8);
+    ASSERT_EQ_BYTES_SIZED(&out_buff[sizeof(expected_header) + 8],
+                          expected_observe, sizeof(expected_observe));
+    finish(&ctx, &msg);
+}
+
+#endif // ANJ_WITH_ETAG
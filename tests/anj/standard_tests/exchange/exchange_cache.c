@@ -29,15 +29,23 @@
 _anj_exchange_ctx_t ctx;
 _anj_exchange_cache_t cache;
 
+#    ifdef ANJ_WITH_MSG_BUFFER_ARENA
+static uint8_t cache_payload[ANJ_OUT_PAYLOAD_BUFFER_SIZE];
+#        define SETUP_CACHE_PAYLOAD() cache.cache_recent.payload = cache_payload
+#    else // ANJ_WITH_MSG_BUFFER_ARENA
+#        define SETUP_CACHE_PAYLOAD() (void) 0
+#    endif // ANJ_WITH_MSG_BUFFER_ARENA
+
 #    define INIT(startTime_s)                                         \
         mock_time_reset();                                            \
         mock_time_advance(                                            \
                 anj_time_duration_new(startTime_s, ANJ_TIME_UNIT_S)); \
-        ctx.tx_params.ack_random_factor = 1.5;                        \
+        ctx.tx_params.ack_random_factor = ANJ_ACK_RANDOM_FACTOR(1.5); \
         ctx.tx_params.ack_timeout =                                   \
                 anj_time_duration_new(2000, ANJ_TIME_UNIT_MS);        \
         ctx.tx_params.max_retransmit = 4;                             \
         _anj_exchange_init(&ctx);                                     \
+        SETUP_CACHE_PAYLOAD();                                        \
         _anj_exchange_setup_cache(&ctx, &cache);
 
 /**
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+#include <anj/init.h>
+
+#if defined(ANJ_WITH_CACHE) && defined(ANJ_WITH_ENCODED_RETRANSMISSIONS)
+
+#    include <stddef.h>
+#    include <stdint.h>
+#    include <string.h>
+
+#    include <anj/compat/time.h>
+#    include <anj/utils.h>
+
+#    include "../../../../src/anj/exchange.h"
+#    include "../../../../src/anj/exchange_cache.h"
+#    include "../mock/time_api_mock.h"
+
+#    include <anj_unit_test.h>
+
+static _anj_exchange_ctx_t ctx;
+static _anj_exchange_cache_t cache;
+
+static void init(void) {
+    mock_time_reset();
+    mock_time_advance(anj_time_duration_new(100, ANJ_TIME_UNIT_S));
+    ctx.tx_params.ack_random_factor = ANJ_ACK_RANDOM_FACTOR(1.5);
+    ctx.tx_params.ack_timeout = anj_time_duration_new(2000, ANJ_TIME_UNIT_MS);
+    ctx.tx_params.max_retransmit = 4;
+    _anj_exchange_init(&ctx);
+    _anj_exchange_setup_cache(&ctx, &cache);
+}
+
+static void add_response(uint16_t mid) {
+    _anj_coap_msg_t response = {
+        .operation = ANJ_OP_RESPONSE,
+        .msg_code = ANJ_COAP_CODE_CONTENT,
+        .coap_binding_data.message_id = mid
+    };
+    _anj_exchange_cache_add(&cache, &ctx.tx_params, &response);
+}
+
+static void check_datagram(uint16_t mid, const char *expected) {
+    ANJ_UNIT_ASSERT_EQUAL(_anj_exchange_cache_check(&cache, mid),
+                          _ANJ_EXCHANGE_CACHE_HIT_RECENT);
+    const uint8_t *datagram;
+    size_t datagram_len;
+    _anj_exchange_cache_get_datagram(&cache, &datagram, &datagram_len);
+    cache.handling_retransmission = false;
+    ANJ_UNIT_ASSERT_EQUAL(datagram_len, strlen(expected));
+    if (datagram_len) {
+        ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(datagram, expected, datagram_len);
+    }
+}
+
+ANJ_UNIT_TEST(exchange_cache_encoded, datagram_is_retransmitted) {
+    init();
+    add_response(0x100);
+    _anj_exchange_cache_set_datagram(&cache, (const uint8_t *) "header", 6,
+                                     NULL, 0);
+    // only the first message encoded after the response is added is kept
+    _anj_exchange_cache_set_datagram(&cache, (const uint8_t *) "other", 5, NULL,
+                                     0);
+    check_datagram(0x100, "header");
+    // retransmitted again
+    check_datagram(0x100, "header");
+}
+
+ANJ_UNIT_TEST(exchange_cache_encoded, payload_sent_separately) {
+    init();
+    add_response(0x100);
+    _anj_exchange_cache_set_datagram(&cache, (const uint8_t *) "header", 6,
+                                     (const uint8_t *) "payload", 7);
+    check_datagram(0x100, "headerpayload");
+}
+
+ANJ_UNIT_TEST(exchange_cache_encoded, encoding_failed) {
+    init();
+    add_response(0x100);
+    _anj_exchange_cache_set_datagram(&cache, NULL, 0, NULL, 0);
+    // entry is still recognized, but there's nothing to send
+    check_datagram(0x100, "");
+}
+
+ANJ_UNIT_TEST(exchange_cache_encoded, datagram_too_big) {
+    init();
+    static uint8_t datagram[_ANJ_EXCHANGE_CACHE_DATAGRAM_SIZE + 1];
+    add_response(0x100);
+    _anj_exchange_cache_set_datagram(&cache, datagram, sizeof(datagram), NULL,
+                                     0);
+    check_datagram(0x100, "");
+}
+
+#    if ANJ_CACHE_ENTRIES_NUMBER > 1
+ANJ_UNIT_TEST(exchange_cache_encoded, older_responses_are_recognized) {
+    init();
+    add_response(0x100);
+    _anj_exchange_cache_set_datagram(&cache, (const uint8_t *) "first", 5, NULL,
+                                     0);
+    add_response(0x101);
+    _anj_exchange_cache_set_datagram(&cache, (const uint8_t *) "second", 6,
+                                     NULL, 0);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_exchange_cache_check(&cache, 0x100),
+                          _ANJ_EXCHANGE_CACHE_HIT_NON_RECENT);
+    check_datagram(0x101, "second");
+    ANJ_UNIT_ASSERT_EQUAL(_anj_exchange_cache_check(&cache, 0x102),
+                          _ANJ_EXCHANGE_CACHE_MISS);
+}
+#    endif // ANJ_CACHE_ENTRIES_NUMBER > 1
+
+#endif // defined(ANJ_WITH_CACHE) && defined(ANJ_WITH_ENCODED_RETRANSMISSIONS)
@@ -0,0 +1,184 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+#include <anj/init.h>
+
+#ifdef ANJ_CACHE_WITH_FULL_ENTRIES
+
+#    include <stddef.h>
+#    include <stdint.h>
+#    include <string.h>
+
+#    include <anj/compat/time.h>
+#    include <anj/utils.h>
+
+#    include "../../../../src/anj/exchange.h"
+#    include "../../../../src/anj/exchange_cache.h"
+#    include "../mock/time_api_mock.h"
+
+#    include <anj_unit_test.h>
+
+#    define EXCHANGE_LIFETIME_S 247
+
+static _anj_exchange_ctx_t ctx;
+static _anj_exchange_cache_t cache;
+static uint8_t payloads[ANJ_OUT_PAYLOAD_BUFFER_SIZE + 16];
+
+#    ifdef ANJ_WITH_MSG_BUFFER_ARENA
+static uint8_t cache_payload[ANJ_OUT_PAYLOAD_BUFFER_SIZE];
+#        define SETUP_CACHE_PAYLOAD() cache.cache_recent.payload = cache_payload
+#    else // ANJ_WITH_MSG_BUFFER_ARENA
+#        define SETUP_CACHE_PAYLOAD() (void) 0
+#    endif // ANJ_WITH_MSG_BUFFER_ARENA
+
+static void init(void) {
+    mock_time_reset();
+    mock_time_advance(anj_time_duration_new(100, ANJ_TIME_UNIT_S));
+    ctx.tx_params.ack_random_factor = ANJ_ACK_RANDOM_FACTOR(1.5);
+    ctx.tx_params.ack_timeout = anj_time_duration_new(2000, ANJ_TIME_UNIT_MS);
+    ctx.tx_params.max_retransmit = 4;
+    _anj_exchange_init(&ctx);
+    SETUP_CACHE_PAYLOAD();
+    _anj_exchange_setup_cache(&ctx, &cache);
+    for (size_t i = 0; i < sizeof(payloads); i++) {
+        payloads[i] = (uint8_t) (i * 7);
+    }
+}
+
+// payload of response with a given MID is a part of payloads starting at MID
+static void add_response(uint16_t mid, size_t payload_size) {
+    _anj_coap_msg_t response = {
+        .operation = ANJ_OP_RESPONSE,
+        .msg_code = ANJ_COAP_CODE_CONTENT,
+        .coap_binding_data.message_id = mid,
+        .payload = payload_size ? &payloads[mid % 16] : NULL,
+        .payload_size = payload_size
+    };
+    _anj_exchange_cache_add(&cache, &ctx.tx_params, &response);
+}
+
+static void check_retransmission(uint16_t mid, size_t payload_size) {
+    ANJ_UNIT_ASSERT_EQUAL(_anj_exchange_cache_check(&cache, mid),
+                          _ANJ_EXCHANGE_CACHE_HIT_RECENT);
+    ANJ_UNIT_ASSERT_TRUE(cache.handling_retransmission);
+    _anj_coap_msg_t response;
+    _anj_exchange_cache_get(&cache, &response);
+    cache.handling_retransmission = false;
+
+    ANJ_UNIT_ASSERT_EQUAL(response.coap_binding_data.message_id, mid);
+    ANJ_UNIT_ASSERT_EQUAL(response.msg_code, ANJ_COAP_CODE_CONTENT);
+    ANJ_UNIT_ASSERT_EQUAL(response.payload_size, payload_size);
+    if (payload_size) {
+        ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(response.payload,
+                                          &payloads[mid % 16], payload_size);
+    }
+}
+
+ANJ_UNIT_TEST(exchange_cache_full_entries, older_responses_are_retransmitted) {
+    init();
+    add_response(0x100, 10);
+    add_response(0x101, 0);
+    add_response(0x102, 20);
+
+    check_retransmission(0x100, 10);
+    check_retransmission(0x101, 0);
+    check_retransmission(0x102, 20);
+    // checking older responses doesn't affect the recent one
+    check_retransmission(0x100, 10);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_exchange_cache_check(&cache, 0x103),
+                          _ANJ_EXCHANGE_CACHE_MISS);
+}
+
+ANJ_UNIT_TEST(exchange_cache_full_entries, only_newest_responses_are_kept) {
+    init();
+    const uint16_t count = ANJ_CACHE_ENTRIES_NUMBER;
+    for (uint16_t mid = 0; mid < count; mid++) {
+        add_response(mid, 8);
+        mock_time_advance(anj_time_duration_new(1, ANJ_TIME_UNIT_S));
+    }
+
+    for (uint16_t mid = 0; mid < count; mid++) {
+        if (mid < count - ANJ_CACHE_FULL_ENTRIES_NUMBER) {
+            ANJ_UNIT_ASSERT_EQUAL(_anj_exchange_cache_check(&cache, mid),
+                                  _ANJ_EXCHANGE_CACHE_HIT_NON_RECENT);
+            ANJ_UNIT_ASSERT_FALSE(cache.handling_retransmission);
+        } else {
+            check_retransmission(mid, 8);
+        }
+    }
+}
+
+ANJ_UNIT_TEST(exchange_cache_full_entries, arena_wraps_around) {
+    init();
+    const size_t payload_size = ANJ_CACHE_PAYLOAD_ARENA_SIZE / 2 - 1;
+    add_response(0x200, payload_size);
+    add_response(0x201, payload_size);
+    add_response(0x202, payload_size);
+    // 0x200 and 0x201 fill most of the arena
+    check_retransmission(0x200, payload_size);
+    check_retransmission(0x201, payload_size);
+
+    // payload of 0x202 overwrites the one of 0x200
+    add_response(0x203, 1);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_exchange_cache_check(&cache, 0x200),
+                          _ANJ_EXCHANGE_CACHE_HIT_NON_RECENT);
+    check_retransmission(0x201, payload_size);
+    check_retransmission(0x202, payload_size);
+    check_retransmission(0x203, 1);
+}
+
+#    if ANJ_OUT_PAYLOAD_BUFFER_SIZE > ANJ_CACHE_PAYLOAD_ARENA_SIZE
+ANJ_UNIT_TEST(exchange_cache_full_entries, payload_bigger_than_arena) {
+    init();
+    add_response(0x300, ANJ_CACHE_PAYLOAD_ARENA_SIZE + 1);
+    check_retransmission(0x300, ANJ_CACHE_PAYLOAD_ARENA_SIZE + 1);
+    add_response(0x301, 3);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_exchange_cache_check(&cache, 0x300),
+                          _ANJ_EXCHANGE_CACHE_HIT_NON_RECENT);
+    check_retransmission(0x301, 3);
+}
+#    endif // ANJ_OUT_PAYLOAD_BUFFER_SIZE > ANJ_CACHE_PAYLOAD_ARENA_SIZE
+
+ANJ_UNIT_TEST(exchange_cache_full_entries, expired_responses_are_dropped) {
+    init();
+    add_response(0x400, 5);
+    mock_time_advance(anj_time_duration_new(10, ANJ_TIME_UNIT_S));
+    add_response(0x401, 5);
+    mock_time_advance(
+            anj_time_duration_new(EXCHANGE_LIFETIME_S - 5, ANJ_TIME_UNIT_S));
+
+    ANJ_UNIT_ASSERT_EQUAL(_anj_exchange_cache_check(&cache, 0x400),
+                          _ANJ_EXCHANGE_CACHE_MISS);
+    check_retransmission(0x401, 5);
+}
+
+ANJ_UNIT_TEST(exchange_cache_full_entries, colliding_message_ids) {
+    init();
+    // all Message IDs fall into the same bucket of the index
+    const uint16_t step = ANJ_CACHE_ENTRIES_NUMBER - 1;
+    const uint16_t count = 3 * ANJ_CACHE_ENTRIES_NUMBER;
+    for (uint16_t i = 0; i < count; i++) {
+        add_response((uint16_t) (5 + i * step), 2);
+        mock_time_advance(anj_time_duration_new(1, ANJ_TIME_UNIT_S));
+    }
+
+    for (uint16_t i = 0; i < count; i++) {
+        uint16_t mid = (uint16_t) (5 + i * step);
+        if (i < count - ANJ_CACHE_ENTRIES_NUMBER) {
+            ANJ_UNIT_ASSERT_EQUAL(_anj_exchange_cache_check(&cache, mid),
+                                  _ANJ_EXCHANGE_CACHE_MISS);
+        } else if (i < count - ANJ_CACHE_FULL_ENTRIES_NUMBER) {
+            ANJ_UNIT_ASSERT_EQUAL(_anj_exchange_cache_check(&cache, mid),
+                                  _ANJ_EXCHANGE_CACHE_HIT_NON_RECENT);
+        } else {
+            check_retransmission(mid, 2);
+        }
+    }
+}
+
+#endif // ANJ_CACHE_WITH_FULL_ENTRIES
@@ -917,6 +917,182 @@ ANJ_UNIT_TEST(server_requests, read_operation_with_timeout) {
     ASSERT_EQ(handlers_arg.result, _ANJ_EXCHANGE_ERROR_TIMEOUT);
 }
 
+#ifdef ANJ_WITH_SEPARATE_RESPONSE
+// Test: Read operation with response that is not ready immediately.
+// Server LwM2M         |           Client LwM2M
+// ---------------------------------------------
+// READ            ---->
+//                       <----     Empty ACK
+//                       <----     2.05 Content (Confirmable)
+// Empty ACK       ---->
+ANJ_UNIT_TEST(server_requests, read_operation_with_separate_response) {
+    handlers_arg_t handlers_arg = { 0 };
+    _anj_exchange_handlers_t handlers = {
+        .arg = &handlers_arg,
+        .write_payload = write_payload_handler,
+        .read_payload = read_payload_handler,
+        .completion = exchange_completion_handler
+    };
+    handlers_arg.out_payload_len = 3;
+    handlers_arg.out_payload = "123";
+    handlers_arg.out_format = _ANJ_COAP_FORMAT_CBOR;
+    handlers_arg.ret_val = _ANJ_EXCHANGE_SEPARATE_RESPONSE;
+    TEST_INIT(ANJ_OP_DM_READ, ANJ_COAP_CODE_CONTENT,
+              ANJ_EXCHANGE_STATE_MSG_TO_SEND, false, false);
+
+    uint8_t expected_ack[] = "\x60"      // ACK, tkl 0
+                             "\x00"      // Empty
+                             "\x33\x33"; // msg id
+    verify_payload(expected_ack, sizeof(expected_ack) - 1, &msg);
+    ASSERT_EQ(_anj_exchange_process(&ctx, ANJ_EXCHANGE_EVENT_SEND_CONFIRMATION,
+                                    &msg),
+              ANJ_EXCHANGE_STATE_WAITING_MSG);
+    ASSERT_EQ(_anj_exchange_process(&ctx, ANJ_EXCHANGE_EVENT_NONE, &msg),
+              ANJ_EXCHANGE_STATE_WAITING_MSG);
+    ASSERT_EQ(handlers_arg.read_counter, 3);
+
+    handlers_arg.ret_val = 0;
+    ASSERT_EQ(_anj_exchange_process(&ctx, ANJ_EXCHANGE_EVENT_NONE, &msg),
+              ANJ_EXCHANGE_STATE_MSG_TO_SEND);
+    uint16_t mid = msg.coap_binding_data.message_id;
+    uint8_t expected[] = "\x41"         // Confirmable, tkl 1
+                         "\x45"         // Content
+                         "\x00\x00\x01" // msg id, token
+                         "\xC1\x3C"     // content_format: cbor
+                         "\xFF"
+                         "\x31\x32\x33";
+    expected[2] = (uint8_t) (mid >> 8);
+    expected[3] = (uint8_t) mid;
+    verify_payload(expected, sizeof(expected) - 1, &msg);
+    ASSERT_EQ(_anj_exchange_process(&ctx, ANJ_EXCHANGE_EVENT_SEND_CONFIRMATION,
+                                    &msg),
+              ANJ_EXCHANGE_STATE_WAITING_MSG);
+    ASSERT_EQ(handlers_arg.complete_counter, 0);
+
+    msg.operation = ANJ_OP_COAP_EMPTY_MSG;
+    msg.coap_binding_data.type = ANJ_COAP_UDP_TYPE_ACKNOWLEDGEMENT;
+    ASSERT_EQ(_anj_exchange_process(&ctx, ANJ_EXCHANGE_EVENT_NEW_MSG, &msg),
+              ANJ_EXCHANGE_STATE_FINISHED);
+    ASSERT_EQ(handlers_arg.read_counter, 4);
+    ASSERT_EQ(handlers_arg.complete_counter, 1);
+    ASSERT_EQ(handlers_arg.result, 0);
+}
+
+// Test: Read operation with response that is never ready.
+ANJ_UNIT_TEST(server_requests, read_operation_with_separate_response_timeout) {
+    handlers_arg_t handlers_arg = { 0 };
+    _anj_exchange_handlers_t handlers = {
+        .arg = &handlers_arg,
+        .write_payload = write_payload_handler,
+        .read_payload = read_payload_handler,
+        .completion = exchange_completion_handler
+    };
+    handlers_arg.ret_val = _ANJ_EXCHANGE_SEPARATE_RESPONSE;
+    mock_time_reset();
+    TEST_INIT(ANJ_OP_DM_READ, ANJ_COAP_CODE_CONTENT,
+              ANJ_EXCHANGE_STATE_MSG_TO_SEND, false, false);
+    ASSERT_EQ(_anj_exchange_process(&ctx, ANJ_EXCHANGE_EVENT_SEND_CONFIRMATION,
+                                    &msg),
+              ANJ_EXCHANGE_STATE_WAITING_MSG);
+    mock_time_advance(ANJ_EXCHANGE_SERVER_REQUEST_TIMEOUT);
+    ASSERT_EQ(_anj_exchange_process(&ctx, ANJ_EXCHANGE_EVENT_NONE, &msg),
+              ANJ_EXCHANGE_STATE_FINISHED);
+
+    mock_time_reset();
+    ASSERT_EQ(handlers_arg.complete_counter, 1);
+    ASSERT_EQ(handlers_arg.result, _ANJ_EXCHANGE_ERROR_TIMEOUT);
+}
+#endif // ANJ_WITH_SEPARATE_RESPONSE
+
+#ifdef ANJ_WITH_BLOCK2_PREFETCH
+// Test: Read operation with block response, the next block is read while
+// waiting for the request of the Server.
+// Server LwM2M         |                    Client LwM2M
+// ------------------------------------------------------
+// READ            ---->
+//                       <---- 2.05 Content block2 0 more
+//                             (block 1 read in advance)
+// READ block2 1   ---->
+//                       <---- 2.05 Content block2 1
+ANJ_UNIT_TEST(server_requests, read_operation_with_block_prefetch) {
+    handlers_arg_t handlers_arg = { 0 };
+    _anj_exchange_handlers_t handlers = {
+        .arg = &handlers_arg,
+        .write_payload = write_payload_handler,
+        .read_payload = read_payload_handler,
+        .completion = exchange_completion_handler
+    };
+    uint8_t prefetch_buff[sizeof(payload)];
+    handlers_arg.out_payload_len = 16;
+    handlers_arg.out_payload = "1234567812345678";
+    handlers_arg.out_format = _ANJ_COAP_FORMAT_CBOR;
+    handlers_arg.ret_val = _ANJ_EXCHANGE_BLOCK_TRANSFER_NEEDED;
+    TEST_INIT(ANJ_OP_DM_READ, ANJ_COAP_CODE_CONTENT,
+              ANJ_EXCHANGE_STATE_MSG_TO_SEND, false, false);
+    _anj_exchange_setup_prefetch_buffer(&ctx, prefetch_buff,
+                                        sizeof(prefetch_buff));
+    ASSERT_EQ(handlers_arg.read_counter, 1);
+
+    ASSERT_EQ(_anj_exchange_process(&ctx, ANJ_EXCHANGE_EVENT_SEND_CONFIRMATION,
+                                    &msg),
+              ANJ_EXCHANGE_STATE_WAITING_MSG);
+    // last block is read while no message is pending
+    handlers_arg.out_payload = "abcdefghabcdefgh";
+    handlers_arg.ret_val = 0;
+    ASSERT_EQ(_anj_exchange_process(&ctx, ANJ_EXCHANGE_EVENT_NONE, &msg),
+              ANJ_EXCHANGE_STATE_WAITING_MSG);
+    ASSERT_EQ(handlers_arg.read_counter, 2);
+    // only one block is read in advance
+    ASSERT_EQ(_anj_exchange_process(&ctx, ANJ_EXCHANGE_EVENT_NONE, &msg),
+              ANJ_EXCHANGE_STATE_WAITING_MSG);
+    ASSERT_EQ(handlers_arg.read_counter, 2);
+    handlers_arg.out_payload = "ABCDEFGHABCDEFGH";
+
+    msg = (_anj_coap_msg_t) {
+        .operation = ANJ_OP_DM_READ,
+        .token = {
+            .size = 1,
+            .bytes = { 2 }
+        },
+        .coap_binding_data = {
+            .type = ANJ_COAP_UDP_TYPE_CONFIRMABLE,
+            .message_id = 0x2222,
+        },
+        .block = {
+            .block_type = ANJ_OPTION_BLOCK_2,
+            .number = 1,
+            .size = 16,
+        },
+        .uri = {
+            .uri_len = 1,
+            .ids = { 1 }
+        }
+    };
+    ASSERT_EQ(_anj_exchange_process(&ctx, ANJ_EXCHANGE_EVENT_NEW_MSG, &msg),
+              ANJ_EXCHANGE_STATE_MSG_TO_SEND);
+    uint8_t expected[] =
+            "\x61"         // ACK, tkl 1
+            "\x45"         // Content
+            "\x22\x22\x02" // msg id, token
+            "\xC1\x3C"     // content_format: cbor
+            "\xB1\x10"     // block2 1, size 16
+            "\xFF"
+            "\x61\x62\x63\x64\x65\x66\x67\x68\x61\x62\x63\x64\x65\x66\x67\x68";
+    verify_payload(expected, sizeof(expected) - 1, &msg);
+    ASSERT_TRUE(msg.payload == prefetch_buff);
+    ASSERT_EQ(handlers_arg.read_counter, 2);
+
+    ASSERT_EQ(_anj_exchange_process(&ctx, ANJ_EXCHANGE_EVENT_SEND_CONFIRMATION,
+                                    &msg),
+              ANJ_EXCHANGE_STATE_FINISHED);
+    // buffers are given back in their original roles
+    ASSERT_TRUE(ctx.payload_buff == payload);
+    ASSERT_TRUE(ctx.prefetch_buff == prefetch_buff);
+    ASSERT_EQ(handlers_arg.complete_counter, 1);
+    ASSERT_EQ(handlers_arg.result, 0);
+}
+#endif // ANJ_WITH_BLOCK2_PREFETCH
+
 // Test: Notify operation with block transfer.
 // Notify is LwM2M client initiated operation, but for block transfer server
 // response with Read operation reqeust.
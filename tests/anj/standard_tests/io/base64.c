@@ -220,6 +220,77 @@ ANJ_UNIT_TEST(base64, encoded_and_decoded_size) {
     }
 }
 
+ANJ_UNIT_TEST(base64, round_trip) {
+    uint8_t bytes[300];
+    uint8_t decoded[sizeof(bytes)];
+    char encoded[2 * sizeof(bytes)];
+    char encoded_with_whitespace[3 * sizeof(bytes)];
+    for (size_t i = 0; i < sizeof(bytes); ++i) {
+        bytes[i] = (uint8_t) (rand() % 256);
+    }
+    for (size_t length = 0; length <= sizeof(bytes); ++length) {
+        size_t decoded_length;
+        ANJ_UNIT_ASSERT_SUCCESS(
+                anj_base64_encode(encoded, sizeof(encoded), bytes, length));
+        ANJ_UNIT_ASSERT_SUCCESS(anj_base64_decode_strict(
+                &decoded_length, decoded, sizeof(decoded), encoded));
+        ANJ_UNIT_ASSERT_EQUAL(decoded_length, length);
+        ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(decoded, bytes, length);
+
+        size_t pos = 0;
+        for (size_t i = 0; encoded[i]; ++i) {
+            encoded_with_whitespace[pos++] = encoded[i];
+            if (i % 7 == 2) {
+                encoded_with_whitespace[pos++] = (i % 2) ? '\n' : ' ';
+            }
+        }
+        encoded_with_whitespace[pos] = '\0';
+        ANJ_UNIT_ASSERT_SUCCESS(anj_base64_decode(&decoded_length, decoded,
+                                                  sizeof(decoded),
+                                                  encoded_with_whitespace));
+        ANJ_UNIT_ASSERT_EQUAL(decoded_length, length);
+        ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(decoded, bytes, length);
+    }
+}
+
+ANJ_UNIT_TEST(base64, decode_exact_output_size) {
+    uint8_t result[6];
+    size_t result_length;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_base64_decode_strict(&result_length, result, 6,
+                                                     "Zm9vYmFy"));
+    ANJ_UNIT_ASSERT_EQUAL(result_length, 6);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(result, "foobar", 6);
+    ANJ_UNIT_ASSERT_FAILED(
+            anj_base64_decode_strict(&result_length, result, 5, "Zm9vYmFy"));
+    ANJ_UNIT_ASSERT_FAILED(
+            anj_base64_decode_strict(&result_length, result, 4, "Zm9vYg=="));
+}
+
+ANJ_UNIT_TEST(base64, decode_n_in_place) {
+    // not null-terminated, followed by characters that must not be decoded
+    char data[] = "Zm9vYmFyZm9vYg==Zm9v";
+    size_t result_length;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_base64_decode_custom_n(
+            &result_length, (uint8_t *) data, sizeof(data), data, 16,
+            ANJ_BASE64_DEFAULT_STRICT_CONFIG));
+    ANJ_UNIT_ASSERT_EQUAL(result_length, 10);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(data, "foobarfoob", 10);
+
+    ANJ_UNIT_ASSERT_SUCCESS(anj_base64_decode_custom_n(
+            &result_length, (uint8_t *) data, sizeof(data), "", 0,
+            ANJ_BASE64_DEFAULT_STRICT_CONFIG));
+    ANJ_UNIT_ASSERT_EQUAL(result_length, 0);
+
+    // null characters are invalid, even if padding_char is not set
+    anj_base64_config_t config = ANJ_BASE64_DEFAULT_LOOSE_CONFIG;
+    config.padding_char = '\0';
+    ANJ_UNIT_ASSERT_FAILED(anj_base64_decode_custom_n(
+            NULL, (uint8_t *) data, sizeof(data), "Zm9v\0Zm9v", 9, config));
+    ANJ_UNIT_ASSERT_FAILED(anj_base64_decode_custom_n(
+            NULL, (uint8_t *) data, sizeof(data), "Zm9vY\0\0\0", 8,
+            ANJ_BASE64_DEFAULT_STRICT_CONFIG));
+}
+
 static void test_encoding_without_null_terminating(uint8_t *data_input,
                                                    size_t input_len,
                                                    uint8_t *data_expected,
@@ -267,6 +267,54 @@ ANJ_UNIT_TEST(cbor_decoder_ll, large_uint_with_large_tag_split_payload) {
     }
 }
 
+static void decode_numbers_in_array(_anj_cbor_ll_decoder_t *ctx) {
+    ptrdiff_t array_size;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_cbor_ll_decoder_enter_array(ctx, &array_size));
+    ANJ_UNIT_ASSERT_EQUAL(array_size, 3);
+    _anj_cbor_ll_number_t value;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_cbor_ll_decoder_number(ctx, &value));
+    ANJ_UNIT_ASSERT_EQUAL(value.value.u64, 0x1234);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_cbor_ll_decoder_number(ctx, &value));
+    ANJ_UNIT_ASSERT_EQUAL(value.value.u64, 0xAABBCCDD00112233ULL);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_cbor_ll_decoder_number(ctx, &value));
+    ANJ_UNIT_ASSERT_EQUAL(value.value.i64, -0x12345679LL);
+    ANJ_UNIT_ASSERT_EQUAL(anj_cbor_ll_decoder_errno(ctx), _ANJ_IO_EOF);
+}
+
+ANJ_UNIT_TEST(cbor_decoder_ll, complete_payload_is_parsed_in_place) {
+    static const char data[] = "\x83"
+                               "\x19\x12\x34"
+                               "\x1B\xAA\xBB\xCC\xDD\x00\x11\x22\x33"
+                               "\x3A\x12\x34\x56\x78";
+    _anj_cbor_ll_decoder_t ctx;
+    anj_cbor_ll_decoder_init(&ctx);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_cbor_ll_decoder_feed_payload(
+            &ctx, data, sizeof(data) - 1, true));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_cbor_ll_decoder_errno(&ctx));
+    ANJ_UNIT_ASSERT_TRUE(ctx.window == (const uint8_t *) data);
+    decode_numbers_in_array(&ctx);
+}
+
+ANJ_UNIT_TEST(cbor_decoder_ll, split_payload_switches_to_in_place_parsing) {
+    static const char data[] = "\x83"
+                               "\x19\x12\x34"
+                               "\x1B\xAA\xBB\xCC\xDD\x00\x11\x22\x33"
+                               "\x3A\x12\x34\x56\x78";
+    // first part of the payload stays in the prebuffer, the rest is parsed in
+    // place once it is drained
+    _anj_cbor_ll_decoder_t ctx;
+    for (size_t split = 0; split < sizeof(ctx.prebuffer); ++split) {
+        anj_cbor_ll_decoder_init(&ctx);
+        ANJ_UNIT_ASSERT_SUCCESS(
+                anj_cbor_ll_decoder_feed_payload(&ctx, data, split, false));
+        ANJ_UNIT_ASSERT_EQUAL(anj_cbor_ll_decoder_errno(&ctx),
+                              _ANJ_IO_WANT_NEXT_PAYLOAD);
+        ANJ_UNIT_ASSERT_SUCCESS(anj_cbor_ll_decoder_feed_payload(
+                &ctx, data + split, sizeof(data) - 1 - split, true));
+        decode_numbers_in_array(&ctx);
+    }
+}
+
 static const int64_t DECODE_NEGATIVE_INT_FAILURE = INT64_MAX;
 
 static int test_decode_negative_int(test_data_t test_data,
@@ -17,6 +17,7 @@
 #include <anj/utils.h>
 
 #include "../../../../src/anj/coap/coap.h"
+#include "../../../../src/anj/io/cbor_encoder_ll.h"
 #include "../../../../src/anj/io/io.h"
 
 #include <anj_unit_test.h>
@@ -348,6 +349,47 @@ ANJ_UNIT_TEST(cbor_encoder, partial_read_string) {
     }
 }
 
+ANJ_UNIT_TEST(cbor_encoder, small_value_variants) {
+    uint8_t generic[ANJ_CBOR_LL_SINGLE_CALL_MAX_LEN];
+    uint8_t small[ANJ_CBOR_LL_SINGLE_CALL_MAX_LEN];
+    for (int i = -ANJ_CBOR_LL_SMALL_VALUE_MAX - 1;
+         i <= ANJ_CBOR_LL_SMALL_VALUE_MAX; i++) {
+        ANJ_UNIT_ASSERT_EQUAL(anj_cbor_ll_encode_int(generic, i), 1);
+        ANJ_UNIT_ASSERT_EQUAL(anj_cbor_ll_encode_small_int(small, (int8_t) i),
+                              1);
+        ANJ_UNIT_ASSERT_EQUAL(generic[0], small[0]);
+        if (i < 0) {
+            continue;
+        }
+        uint8_t value = (uint8_t) i;
+        ANJ_UNIT_ASSERT_EQUAL(anj_cbor_ll_encode_uint(generic, value), 1);
+        ANJ_UNIT_ASSERT_EQUAL(anj_cbor_ll_encode_small_uint(small, value), 1);
+        ANJ_UNIT_ASSERT_EQUAL(generic[0], small[0]);
+        ANJ_UNIT_ASSERT_EQUAL(anj_cbor_ll_string_begin(generic, value), 1);
+        ANJ_UNIT_ASSERT_EQUAL(anj_cbor_ll_small_string_begin(small, value), 1);
+        ANJ_UNIT_ASSERT_EQUAL(generic[0], small[0]);
+        ANJ_UNIT_ASSERT_EQUAL(anj_cbor_ll_definite_map_begin(generic, value),
+                              1);
+        ANJ_UNIT_ASSERT_EQUAL(
+                anj_cbor_ll_small_definite_map_begin(small, value), 1);
+        ANJ_UNIT_ASSERT_EQUAL(generic[0], small[0]);
+    }
+}
+
+ANJ_UNIT_TEST(cbor_encoder, ll_integer_widths) {
+    uint8_t buff[ANJ_CBOR_LL_SINGLE_CALL_MAX_LEN];
+    ANJ_UNIT_ASSERT_EQUAL(anj_cbor_ll_encode_uint(buff, 24), 2);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff, "\x18\x18", 2);
+    ANJ_UNIT_ASSERT_EQUAL(anj_cbor_ll_encode_uint(buff, 0x1234), 3);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff, "\x19\x12\x34", 3);
+    ANJ_UNIT_ASSERT_EQUAL(anj_cbor_ll_encode_int(buff, -0x12345678 - 1), 5);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff, "\x3A\x12\x34\x56\x78", 5);
+    ANJ_UNIT_ASSERT_EQUAL(anj_cbor_ll_encode_uint(buff, 0x0102030405060708),
+                          9);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(
+            buff, "\x1B\x01\x02\x03\x04\x05\x06\x07\x08", 9);
+}
+
 #    ifdef ANJ_WITH_EXTERNAL_DATA
 static bool opened;
 static bool closed;
@@ -0,0 +1,174 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <float.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <anj/anj_config.h>
+#include <anj/defs.h>
+#include <anj/utils.h>
+
+#include "../../../../src/anj/coap/coap.h"
+#include "../../../../src/anj/io/cbor_decoder.h"
+#include "../../../../src/anj/io/cbor_decoder_ll.h"
+#include "../../../../src/anj/io/cbor_encoder_ll.h"
+#include "../../../../src/anj/io/io.h"
+
+#include <anj_unit_test.h>
+
+#ifdef ANJ_WITH_CBOR_ENCODE_SHORTEST_FLOAT
+
+#    define TEST_SHORTEST(Value, Data)                                        \
+        do {                                                                  \
+            uint8_t buff[ANJ_CBOR_LL_SINGLE_CALL_MAX_LEN];                    \
+            ANJ_UNIT_ASSERT_EQUAL(                                            \
+                    anj_cbor_ll_encode_double_shortest(buff, (Value)),        \
+                    sizeof(Data) - 1);                                        \
+            ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff, Data, sizeof(Data) - 1); \
+        } while (0)
+
+ANJ_UNIT_TEST(cbor_shortest_float, integers) {
+    TEST_SHORTEST(0.0, "\x00");
+    TEST_SHORTEST(20.0, "\x14");
+    TEST_SHORTEST(-1.0, "\x20");
+    TEST_SHORTEST(1000.0, "\x19\x03\xE8");
+    TEST_SHORTEST(100000.0, "\x1A\x00\x01\x86\xA0");
+    TEST_SHORTEST(-4294967296.0, "\x3A\xFF\xFF\xFF\xFF");
+    // float is shorter than the 8-byte integer
+    TEST_SHORTEST(1099511627776.0, "\xFA\x53\x80\x00\x00");
+}
+
+ANJ_UNIT_TEST(cbor_shortest_float, half_floats) {
+    TEST_SHORTEST(-0.0, "\xF9\x80\x00");
+    TEST_SHORTEST(21.5, "\xF9\x4D\x60");
+    TEST_SHORTEST(-4.25, "\xF9\xC4\x40");
+    TEST_SHORTEST(65504.5, "\xFA\x47\x7F\xE0\x80");
+    // smallest normal and subnormal half-precision values
+    TEST_SHORTEST(6.103515625e-05, "\xF9\x04\x00");
+    TEST_SHORTEST(5.960464477539063e-08, "\xF9\x00\x01");
+    TEST_SHORTEST(INFINITY, "\xF9\x7C\x00");
+    TEST_SHORTEST(-INFINITY, "\xF9\xFC\x00");
+    TEST_SHORTEST(NAN, "\xF9\x7E\x00");
+}
+
+ANJ_UNIT_TEST(cbor_shortest_float, single_and_double) {
+    TEST_SHORTEST(100000.5, "\xFA\x47\xC3\x50\x40");
+    TEST_SHORTEST(0.1f, "\xFA\x3D\xCC\xCC\xCD");
+    TEST_SHORTEST(3.0e-08, "\xFB\x3E\x60\x1B\x2B\x29\xA4\x69\x2B");
+    TEST_SHORTEST(-4.1, "\xFB\xC0\x10\x66\x66\x66\x66\x66\x66");
+    TEST_SHORTEST(1.0e300, "\xFB\x7E\x37\xE4\x3C\x88\x00\x75\x9C");
+}
+
+static double decode(const uint8_t *buff, size_t len) {
+    _anj_cbor_ll_decoder_t ctx;
+    _anj_cbor_ll_number_t number;
+    double value;
+    anj_cbor_ll_decoder_init(&ctx);
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_cbor_ll_decoder_feed_payload(&ctx, buff, len, true));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_cbor_ll_decoder_number(&ctx, &number));
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_cbor_get_double_from_ll_number(&number, &value));
+    return value;
+}
+
+ANJ_UNIT_TEST(cbor_shortest_float, round_trip) {
+    static const double values[] = {
+        0.0,     -0.0,    1.0,      -1.5,     21.5,    1.0 / 3.0, 0.1,
+        1.0e-7,  65504.0, 65520.0,  1.0e20,   -9.0e18, DBL_MAX,   DBL_MIN,
+        FLT_MAX, FLT_MIN, 1.0e-40,  5.0e-324, 4096.0625, 0.5
+    };
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(values); i++) {
+        uint8_t buff[ANJ_CBOR_LL_SINGLE_CALL_MAX_LEN];
+        size_t len = anj_cbor_ll_encode_double_shortest(buff, values[i]);
+        uint8_t plain[ANJ_CBOR_LL_SINGLE_CALL_MAX_LEN];
+        ANJ_UNIT_ASSERT_TRUE(len
+                             <= anj_cbor_ll_encode_double(plain, values[i]));
+        double decoded = decode(buff, len);
+        ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(&decoded, &values[i],
+                                          sizeof(double));
+    }
+}
+
+#    ifdef ANJ_WITH_SENML_CBOR
+ANJ_UNIT_TEST(cbor_shortest_float, senml_cbor_record) {
+    _anj_io_out_ctx_t ctx;
+    uint8_t buff[50];
+    size_t out_length;
+    anj_io_out_entry_t entry = {
+        .timestamp = 1700000000.0,
+        .path = ANJ_MAKE_RESOURCE_PATH(3303, 0, 5700),
+        .type = ANJ_DATA_TYPE_DOUBLE,
+        .value.double_value = 21.5
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_init(&ctx, ANJ_OP_INF_NON_CON_SEND,
+                                                 &ANJ_MAKE_ROOT_PATH(), 1,
+                                                 _ANJ_COAP_FORMAT_SENML_CBOR));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_new_entry(&ctx, &entry));
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_io_out_ctx_get_payload(&ctx, buff, sizeof(buff), &out_length));
+    static const char expected[] = "\x81\xA3"
+                                   "\x00\x6C/3303/0/5700"
+                                   "\x22\x1A\x65\x53\xF1\x00" // base time
+                                   "\x02\xF9\x4D\x60";
+    ANJ_UNIT_ASSERT_EQUAL(out_length, sizeof(expected) - 1);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff, expected, out_length);
+}
+#    endif // ANJ_WITH_SENML_CBOR
+
+#    ifdef ANJ_WITH_LWM2M_CBOR
+ANJ_UNIT_TEST(cbor_shortest_float, lwm2m_cbor_record) {
+    _anj_io_out_ctx_t ctx;
+    uint8_t buff[50];
+    size_t out_length;
+    anj_io_out_entry_t entry = {
+        .timestamp = NAN,
+        .path = ANJ_MAKE_RESOURCE_PATH(3303, 0, 5700),
+        .type = ANJ_DATA_TYPE_DOUBLE,
+        .value.double_value = 20.0
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_init(
+            &ctx, ANJ_OP_DM_READ, &ANJ_MAKE_RESOURCE_PATH(3303, 0, 5700), 1,
+            _ANJ_COAP_FORMAT_OMA_LWM2M_CBOR));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_new_entry(&ctx, &entry));
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_io_out_ctx_get_payload(&ctx, buff, sizeof(buff), &out_length));
+    static const char expected[] = "\xBF\x19\x0C\xE7\xBF\x00\xBF\x19\x16\x44"
+                                   "\x14\xFF\xFF\xFF";
+    ANJ_UNIT_ASSERT_EQUAL(out_length, sizeof(expected) - 1);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff, expected, out_length);
+}
+#    endif // ANJ_WITH_LWM2M_CBOR
+
+#    ifdef ANJ_WITH_CBOR
+ANJ_UNIT_TEST(cbor_shortest_float, plain_cbor_unchanged) {
+    _anj_io_out_ctx_t ctx;
+    uint8_t buff[20];
+    size_t out_length;
+    anj_io_out_entry_t entry = {
+        .timestamp = NAN,
+        .path = ANJ_MAKE_RESOURCE_PATH(3303, 0, 5700),
+        .type = ANJ_DATA_TYPE_DOUBLE,
+        .value.double_value = 20.0
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_init(
+            &ctx, ANJ_OP_DM_READ, &ANJ_MAKE_RESOURCE_PATH(3303, 0, 5700), 1,
+            _ANJ_COAP_FORMAT_CBOR));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_new_entry(&ctx, &entry));
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_io_out_ctx_get_payload(&ctx, buff, sizeof(buff), &out_length));
+    ANJ_UNIT_ASSERT_EQUAL(out_length, 5);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff, "\xFA\x41\xA0\x00\x00", 5);
+}
+#    endif // ANJ_WITH_CBOR
+
+#endif // ANJ_WITH_CBOR_ENCODE_SHORTEST_FLOAT
@@ -0,0 +1,218 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <anj/anj_config.h>
+#include <anj/defs.h>
+#include <anj/utils.h>
+
+#include "../../../../src/anj/coap/coap.h"
+#include "../../../../src/anj/io/io.h"
+
+#include <anj_unit_test.h>
+
+#ifdef ANJ_WITH_DIRECT_PAYLOAD_ENCODING
+
+typedef struct {
+    _anj_io_out_ctx_t ctx;
+    uint8_t buf[300];
+    size_t out_length;
+} direct_test_env_t;
+
+static const anj_io_out_entry_t entries[] = {
+    {
+        .timestamp = NAN,
+        .path = ANJ_MAKE_RESOURCE_PATH(3, 0, 0),
+        .type = ANJ_DATA_TYPE_STRING,
+        .value.bytes_or_string.data = "Manufacturer"
+    },
+    {
+        .timestamp = NAN,
+        .path = ANJ_MAKE_RESOURCE_PATH(3, 0, 9),
+        .type = ANJ_DATA_TYPE_INT,
+        .value.int_value = -123456
+    },
+    {
+        .timestamp = NAN,
+        .path = ANJ_MAKE_RESOURCE_INSTANCE_PATH(3, 0, 11, 1),
+        .type = ANJ_DATA_TYPE_DOUBLE,
+        .value.double_value = 3.25
+    },
+    {
+        .timestamp = NAN,
+        .path = ANJ_MAKE_RESOURCE_PATH(3, 0, 16),
+        .type = ANJ_DATA_TYPE_OBJLNK,
+        .value.objlnk = { 1, 2 }
+    },
+    {
+        .timestamp = NAN,
+        .path = ANJ_MAKE_RESOURCE_PATH(3, 1, 13),
+        .type = ANJ_DATA_TYPE_BOOL,
+        .value.bool_value = true
+    }
+};
+
+static void encode_records(direct_test_env_t *env,
+                           uint16_t format,
+                           size_t entries_count,
+                           size_t block_size,
+                           bool direct) {
+    memset(env->buf, 0, sizeof(env->buf));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_init(&env->ctx, ANJ_OP_DM_READ,
+                                                 &ANJ_MAKE_OBJECT_PATH(3),
+                                                 entries_count, format));
+    env->out_length = 0;
+    for (size_t i = 0; i < entries_count; i++) {
+        size_t copied_bytes;
+        size_t buf_len =
+                ANJ_MIN(block_size, sizeof(env->buf) - env->out_length);
+        if (direct) {
+            ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_new_entry_direct(
+                    &env->ctx, &entries[i], &env->buf[env->out_length],
+                    buf_len));
+        } else {
+            ANJ_UNIT_ASSERT_SUCCESS(
+                    _anj_io_out_ctx_new_entry(&env->ctx, &entries[i]));
+        }
+        ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_get_payload(
+                &env->ctx, &env->buf[env->out_length], buf_len,
+                &copied_bytes));
+        env->out_length += copied_bytes;
+    }
+}
+
+static void verify_same_payload(uint16_t format, size_t entries_count) {
+    direct_test_env_t expected;
+    direct_test_env_t actual;
+    encode_records(&expected, format, entries_count, sizeof(expected.buf),
+                   false);
+    encode_records(&actual, format, entries_count, sizeof(actual.buf), true);
+    ANJ_UNIT_ASSERT_EQUAL(actual.out_length, expected.out_length);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(actual.buf, expected.buf,
+                                      expected.out_length);
+}
+
+#    ifdef ANJ_WITH_LWM2M_CBOR
+ANJ_UNIT_TEST(direct_payload_encoding, lwm2m_cbor) {
+    verify_same_payload(_ANJ_COAP_FORMAT_OMA_LWM2M_CBOR,
+                        ANJ_ARRAY_SIZE(entries));
+}
+#    endif // ANJ_WITH_LWM2M_CBOR
+
+#    ifdef ANJ_WITH_SENML_CBOR
+ANJ_UNIT_TEST(direct_payload_encoding, senml_cbor) {
+    verify_same_payload(_ANJ_COAP_FORMAT_SENML_CBOR, ANJ_ARRAY_SIZE(entries));
+}
+#    endif // ANJ_WITH_SENML_CBOR
+
+#    ifdef ANJ_WITH_CBOR
+ANJ_UNIT_TEST(direct_payload_encoding, cbor) {
+    verify_same_payload(_ANJ_COAP_FORMAT_CBOR, 1);
+}
+#    endif // ANJ_WITH_CBOR
+
+#    ifdef ANJ_WITH_SENML_CBOR
+static size_t encode_reference(const anj_io_out_entry_t *entry,
+                               uint8_t *out_buff,
+                               size_t out_buff_len) {
+    _anj_io_out_ctx_t ctx;
+    size_t copied_bytes;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_init(&ctx, ANJ_OP_DM_READ,
+                                                 &ANJ_MAKE_OBJECT_PATH(3), 1,
+                                                 _ANJ_COAP_FORMAT_SENML_CBOR));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_new_entry(&ctx, entry));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_get_payload(
+            &ctx, out_buff, out_buff_len, &copied_bytes));
+    return copied_bytes;
+}
+
+ANJ_UNIT_TEST(direct_payload_encoding, record_encoded_in_place) {
+    uint8_t expected[100];
+    size_t expected_len =
+            encode_reference(&entries[1], expected, sizeof(expected));
+
+    direct_test_env_t env;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_init(
+            &env.ctx, ANJ_OP_DM_READ, &ANJ_MAKE_OBJECT_PATH(3), 1,
+            _ANJ_COAP_FORMAT_SENML_CBOR));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_new_entry_direct(
+            &env.ctx, &entries[1], env.buf, sizeof(env.buf)));
+    ANJ_UNIT_ASSERT_TRUE(env.ctx.buff.direct_buff == env.buf);
+    size_t copied_bytes;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_get_payload(
+            &env.ctx, env.buf, sizeof(env.buf), &copied_bytes));
+    ANJ_UNIT_ASSERT_NULL(env.ctx.buff.direct_buff);
+    ANJ_UNIT_ASSERT_EQUAL(copied_bytes, expected_len);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(env.buf, expected, expected_len);
+}
+
+ANJ_UNIT_TEST(direct_payload_encoding, small_buffer_falls_back) {
+    uint8_t expected[100];
+    size_t expected_len =
+            encode_reference(&entries[1], expected, sizeof(expected));
+    ANJ_UNIT_ASSERT_TRUE(expected_len > 8);
+
+    direct_test_env_t env;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_init(
+            &env.ctx, ANJ_OP_DM_READ, &ANJ_MAKE_OBJECT_PATH(3), 1,
+            _ANJ_COAP_FORMAT_SENML_CBOR));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_new_entry_direct(
+            &env.ctx, &entries[1], env.buf, 8));
+    ANJ_UNIT_ASSERT_NULL(env.ctx.buff.direct_buff);
+
+    size_t copied_bytes;
+    ANJ_UNIT_ASSERT_EQUAL(_anj_io_out_ctx_get_payload(&env.ctx, env.buf, 8,
+                                                      &copied_bytes),
+                          ANJ_IO_NEED_NEXT_CALL);
+    ANJ_UNIT_ASSERT_EQUAL(copied_bytes, 8);
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_get_payload(
+            &env.ctx, &env.buf[8], sizeof(env.buf) - 8, &copied_bytes));
+    ANJ_UNIT_ASSERT_EQUAL(8 + copied_bytes, expected_len);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(env.buf, expected, expected_len);
+}
+
+ANJ_UNIT_TEST(direct_payload_encoding, string_split_between_blocks) {
+    static const char data[] = "0123456789012345678901234567890123456789"
+                               "0123456789012345678901234567890123456789";
+    anj_io_out_entry_t entry = {
+        .timestamp = NAN,
+        .path = ANJ_MAKE_RESOURCE_PATH(3, 0, 0),
+        .type = ANJ_DATA_TYPE_STRING,
+        .value.bytes_or_string.data = data
+    };
+    uint8_t expected[200];
+    size_t expected_len = encode_reference(&entry, expected, sizeof(expected));
+
+    direct_test_env_t env;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_init(
+            &env.ctx, ANJ_OP_DM_READ, &ANJ_MAKE_OBJECT_PATH(3), 1,
+            _ANJ_COAP_FORMAT_SENML_CBOR));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_new_entry_direct(
+            &env.ctx, &entry, env.buf, _ANJ_IO_CTX_BUFFER_LENGTH));
+    ANJ_UNIT_ASSERT_TRUE(env.ctx.buff.direct_buff == env.buf);
+    size_t copied_bytes;
+    ANJ_UNIT_ASSERT_EQUAL(
+            _anj_io_out_ctx_get_payload(&env.ctx, env.buf,
+                                        _ANJ_IO_CTX_BUFFER_LENGTH,
+                                        &copied_bytes),
+            ANJ_IO_NEED_NEXT_CALL);
+    ANJ_UNIT_ASSERT_EQUAL(copied_bytes, _ANJ_IO_CTX_BUFFER_LENGTH);
+    size_t offset = copied_bytes;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_get_payload(
+            &env.ctx, &env.buf[offset], sizeof(env.buf) - offset,
+            &copied_bytes));
+    ANJ_UNIT_ASSERT_EQUAL(offset + copied_bytes, expected_len);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(env.buf, expected, expected_len);
+}
+#    endif // ANJ_WITH_SENML_CBOR
+
+#endif // ANJ_WITH_DIRECT_PAYLOAD_ENCODING
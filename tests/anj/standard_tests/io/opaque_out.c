@@ -463,6 +463,30 @@ ANJ_UNIT_TEST(opaque_out, bytes_offset) {
                           _ANJ_IO_ERR_INPUT_ARG);
 }
 
+/* Data is not copied when the entry is added, every chunk of the payload is
+ * taken from the provided memory at the time it is requested */
+ANJ_UNIT_TEST(opaque_out, bytes_read_from_borrowed_memory) {
+    char data[] = "0123456789";
+    anj_io_out_entry_t input = { 0 };
+    input.type = ANJ_DATA_TYPE_BYTES;
+    input.value.bytes_or_string.chunk_length = sizeof(data) - 1;
+    input.value.bytes_or_string.data = data;
+    opaque_test_env_t env;
+    opaque_test_setup(&env);
+    env.entry = input;
+
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_new_entry(&env.ctx, &env.entry));
+    ANJ_UNIT_ASSERT_EQUAL(_anj_io_out_ctx_get_payload(&env.ctx, env.buf, 4,
+                                                      &env.copied_bytes),
+                          ANJ_IO_NEED_NEXT_CALL);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(env.buf, "0123", 4);
+    data[4] = 'x';
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_get_payload(
+            &env.ctx, env.buf, env.buffer_length, &env.copied_bytes));
+    ANJ_UNIT_ASSERT_EQUAL(env.copied_bytes, 6);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(env.buf, "x56789", 6);
+}
+
 static void test_out_buff_smaller_than_internal_buff(opaque_test_env_t *env,
                                                      anj_io_out_entry_t *input,
                                                      size_t buffer_length,
@@ -221,7 +221,9 @@ ANJ_UNIT_TEST(senml_cbor_encoder, largest_possible_size_of_single_msg) {
             "vlo" // objlink
             "\x6B\x36\x35\x35\x33\x34\x3A\x36\x35\x35\x33\x34");
     ANJ_UNIT_ASSERT_EQUAL(env.out_length,
-                          _ANJ_IO_SENML_CBOR_SIMPLE_RECORD_MAX_LENGTH - 1);
+                          _ANJ_IO_SENML_CBOR_SIMPLE_RECORD_MAX_LENGTH
+                                  - _ANJ_IO_SENML_CBOR_NAMESPACE_TAG_LENGTH
+                                  - 1);
 }
 
 ANJ_UNIT_TEST(senml_cbor_encoder, int) {
@@ -244,6 +246,26 @@ ANJ_UNIT_TEST(senml_cbor_encoder, int) {
                       "\x02\x39\x03\xE7");
 }
 
+ANJ_UNIT_TEST(senml_cbor_encoder, name_with_2_byte_string_header) {
+    senml_cbor_test_env_t env = { 0 };
+
+    senml_cbor_test_setup(&env, NULL, 1, ANJ_OP_INF_NON_CON_NOTIFY);
+
+    anj_io_out_entry_t entry = {
+        .timestamp = NAN,
+        .path = ANJ_MAKE_RESOURCE_INSTANCE_PATH(65534, 65534, 65534, 65534),
+        .type = ANJ_DATA_TYPE_UINT,
+        .value.uint_value = 1
+    };
+
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_new_entry(&env.ctx, &entry));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_get_payload(
+            &env.ctx, env.buf, env.buffer_length, &env.out_length));
+    VERIFY_BYTES(env, "\x81\xA2"
+                      "\x00\x78\x18/65534/65534/65534/65534"
+                      "\x02\x01");
+}
+
 ANJ_UNIT_TEST(senml_cbor_encoder, uint) {
     senml_cbor_test_env_t env = { 0 };
 
@@ -813,4 +835,43 @@ ANJ_UNIT_TEST(senml_cbor_encoder, read_error) {
 #    endif // ANJ_WITH_EXTERNAL_DATA
 }
 
+ANJ_UNIT_BENCH(senml_cbor_encoder, read_instance, 10000) {
+    senml_cbor_test_env_t env = { 0 };
+    anj_uri_path_t base_path = ANJ_MAKE_INSTANCE_PATH(3, 0);
+    anj_io_out_entry_t entries[] = {
+        {
+            .path = ANJ_MAKE_RESOURCE_PATH(3, 0, 0),
+            .type = ANJ_DATA_TYPE_STRING,
+            .value.bytes_or_string.data = "Manufacturer",
+        },
+        {
+            .path = ANJ_MAKE_RESOURCE_PATH(3, 0, 9),
+            .type = ANJ_DATA_TYPE_INT,
+            .value.int_value = 95,
+        },
+        {
+            .path = ANJ_MAKE_RESOURCE_PATH(3, 0, 13),
+            .type = ANJ_DATA_TYPE_TIME,
+            .value.time_value = 1700000000,
+        },
+        {
+            .path = ANJ_MAKE_RESOURCE_PATH(3, 0, 17),
+            .type = ANJ_DATA_TYPE_DOUBLE,
+            .value.double_value = 3.5,
+        },
+    };
+
+    senml_cbor_test_setup(&env, &base_path, ANJ_ARRAY_SIZE(entries),
+                          ANJ_OP_DM_READ);
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(entries); i++) {
+        size_t record_len = 0;
+        ANJ_UNIT_ASSERT_SUCCESS(
+                _anj_io_out_ctx_new_entry(&env.ctx, &entries[i]));
+        ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_get_payload(
+                &env.ctx, &env.buf[env.out_length],
+                env.buffer_length - env.out_length, &record_len));
+        env.out_length += record_len;
+    }
+}
+
 #endif // ANJ_WITH_SENML_CBOR
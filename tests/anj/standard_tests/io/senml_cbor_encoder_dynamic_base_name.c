@@ -0,0 +1,191 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <anj/anj_config.h>
+#include <anj/defs.h>
+#include <anj/utils.h>
+
+#include "../../../../src/anj/coap/coap.h"
+#include "../../../../src/anj/io/io.h"
+
+#include <anj_unit_test.h>
+
+#ifdef ANJ_WITH_SENML_CBOR_DYNAMIC_BASE_NAME
+
+typedef struct {
+    _anj_io_out_ctx_t ctx;
+    char buf[200];
+    size_t out_length;
+} senml_cbor_test_env_t;
+
+static void encode_records(senml_cbor_test_env_t *env,
+                           const anj_uri_path_t *base_path,
+                           _anj_op_t op_type,
+                           const anj_io_out_entry_t *entries,
+                           size_t entries_count) {
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_init(&env->ctx, op_type, base_path,
+                                                 entries_count,
+                                                 _ANJ_COAP_FORMAT_SENML_CBOR));
+    env->out_length = 0;
+    for (size_t i = 0; i < entries_count; i++) {
+        size_t copied_bytes;
+        ANJ_UNIT_ASSERT_SUCCESS(
+                _anj_io_out_ctx_new_entry(&env->ctx, &entries[i]));
+        ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_get_payload(
+                &env->ctx, &env->buf[env->out_length],
+                sizeof(env->buf) - env->out_length, &copied_bytes));
+        env->out_length += copied_bytes;
+    }
+}
+
+#    define VERIFY_BYTES(Env, Data)                                  \
+        do {                                                         \
+            ANJ_UNIT_ASSERT_EQUAL_BYTES(Env.buf, Data);              \
+            ANJ_UNIT_ASSERT_EQUAL(Env.out_length, sizeof(Data) - 1); \
+        } while (0)
+
+#    define UINT_ENTRY(Path, Value)                 \
+        (anj_io_out_entry_t) {                      \
+            .timestamp = NAN,                       \
+            .path = Path,                           \
+            .type = ANJ_DATA_TYPE_UINT,             \
+            .value.uint_value = Value               \
+        }
+
+ANJ_UNIT_TEST(senml_cbor_encoder_dynamic_base_name, read_object) {
+    senml_cbor_test_env_t env;
+    anj_io_out_entry_t entries[] = {
+        UINT_ENTRY(ANJ_MAKE_RESOURCE_PATH(3303, 0, 5700), 1),
+        UINT_ENTRY(ANJ_MAKE_RESOURCE_PATH(3303, 0, 5701), 2),
+        UINT_ENTRY(ANJ_MAKE_RESOURCE_PATH(3303, 1, 5700), 3)
+    };
+    encode_records(&env, &ANJ_MAKE_OBJECT_PATH(3303), ANJ_OP_DM_READ, entries,
+                   ANJ_ARRAY_SIZE(entries));
+    VERIFY_BYTES(env, "\x83"
+                      "\xA3"
+                      "\x21\x67/3303/0" // base name
+                      "\x00\x65/5700"   // name
+                      "\x02\x01"
+                      "\xA2"
+                      "\x00\x65/5701"
+                      "\x02\x02"
+                      "\xA3"
+                      "\x21\x67/3303/1"
+                      "\x00\x65/5700"
+                      "\x02\x03");
+}
+
+ANJ_UNIT_TEST(senml_cbor_encoder_dynamic_base_name, read_root_multi_instance) {
+    senml_cbor_test_env_t env;
+    anj_io_out_entry_t entries[] = {
+        UINT_ENTRY(ANJ_MAKE_RESOURCE_INSTANCE_PATH(3, 0, 7, 0), 1),
+        UINT_ENTRY(ANJ_MAKE_RESOURCE_INSTANCE_PATH(3, 0, 7, 1), 2),
+        UINT_ENTRY(ANJ_MAKE_RESOURCE_PATH(4, 0, 1), 3)
+    };
+    encode_records(&env, &ANJ_MAKE_ROOT_PATH(), ANJ_OP_DM_READ_COMP, entries,
+                   ANJ_ARRAY_SIZE(entries));
+    VERIFY_BYTES(env, "\x83"
+                      "\xA3"
+                      "\x21\x64/3/0"
+                      "\x00\x64/7/0"
+                      "\x02\x01"
+                      "\xA2"
+                      "\x00\x64/7/1"
+                      "\x02\x02"
+                      "\xA3"
+                      "\x21\x64/4/0"
+                      "\x00\x62/1"
+                      "\x02\x03");
+}
+
+// instance level and deeper base paths are encoded as without this option
+ANJ_UNIT_TEST(senml_cbor_encoder_dynamic_base_name, read_instance) {
+    senml_cbor_test_env_t env;
+    anj_io_out_entry_t entries[] = {
+        UINT_ENTRY(ANJ_MAKE_RESOURCE_PATH(3303, 0, 5700), 1),
+        UINT_ENTRY(ANJ_MAKE_RESOURCE_PATH(3303, 0, 5701), 2)
+    };
+    encode_records(&env, &ANJ_MAKE_INSTANCE_PATH(3303, 0), ANJ_OP_DM_READ,
+                   entries, ANJ_ARRAY_SIZE(entries));
+    VERIFY_BYTES(env, "\x82"
+                      "\xA3"
+                      "\x21\x67/3303/0"
+                      "\x00\x65/5700"
+                      "\x02\x01"
+                      "\xA2"
+                      "\x00\x65/5701"
+                      "\x02\x02");
+}
+
+ANJ_UNIT_TEST(senml_cbor_encoder_dynamic_base_name, read_resource) {
+    senml_cbor_test_env_t env;
+    anj_io_out_entry_t entries[] = {
+        UINT_ENTRY(ANJ_MAKE_RESOURCE_PATH(3303, 0, 5700), 1)
+    };
+    encode_records(&env, &ANJ_MAKE_RESOURCE_PATH(3303, 0, 5700),
+                   ANJ_OP_DM_READ, entries, ANJ_ARRAY_SIZE(entries));
+    VERIFY_BYTES(env, "\x81"
+                      "\xA2"
+                      "\x21\x6C/3303/0/5700"
+                      "\x02\x01");
+}
+
+ANJ_UNIT_TEST(senml_cbor_encoder_dynamic_base_name, send_with_time) {
+    senml_cbor_test_env_t env;
+    anj_io_out_entry_t entries[] = {
+        UINT_ENTRY(ANJ_MAKE_RESOURCE_PATH(3, 3, 3), 25),
+        UINT_ENTRY(ANJ_MAKE_RESOURCE_PATH(3, 3, 4), 26)
+    };
+    entries[0].timestamp = 100000.0;
+    entries[1].timestamp = 100000.0;
+    encode_records(&env, &ANJ_MAKE_ROOT_PATH(), ANJ_OP_INF_CON_SEND, entries,
+                   ANJ_ARRAY_SIZE(entries));
+    VERIFY_BYTES(env, "\x82"
+                      "\xA4"
+                      "\x21\x64/3/3"             // base name
+                      "\x00\x62/3"               // name
+                      "\x22\xFA\x47\xC3\x50\x00" // base time
+                      "\x02\x18\x19"
+                      "\xA2"
+                      "\x00\x62/4"
+                      "\x02\x18\x1A");
+}
+
+ANJ_UNIT_TEST(senml_cbor_encoder_dynamic_base_name, long_ids) {
+    senml_cbor_test_env_t env;
+    anj_io_out_entry_t entries[] = {
+        UINT_ENTRY(ANJ_MAKE_RESOURCE_INSTANCE_PATH(65534, 65534, 65534, 65534),
+                   1)
+    };
+    encode_records(&env, &ANJ_MAKE_ROOT_PATH(), ANJ_OP_DM_READ_COMP, entries,
+                   ANJ_ARRAY_SIZE(entries));
+    VERIFY_BYTES(env, "\x81"
+                      "\xA3"
+                      "\x21\x6C/65534/65534"
+                      "\x00\x6C/65534/65534"
+                      "\x02\x01");
+}
+
+ANJ_UNIT_TEST(senml_cbor_encoder_dynamic_base_name, path_outside_of_base_path) {
+    senml_cbor_test_env_t env;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_init(&env.ctx, ANJ_OP_DM_READ,
+                                                 &ANJ_MAKE_OBJECT_PATH(3303),
+                                                 1,
+                                                 _ANJ_COAP_FORMAT_SENML_CBOR));
+    anj_io_out_entry_t entry =
+            UINT_ENTRY(ANJ_MAKE_RESOURCE_PATH(3304, 0, 5700), 1);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_io_out_ctx_new_entry(&env.ctx, &entry),
+                          _ANJ_IO_ERR_INPUT_ARG);
+}
+
+#endif // ANJ_WITH_SENML_CBOR_DYNAMIC_BASE_NAME
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <anj/anj_config.h>
+#include <anj/defs.h>
+#include <anj/utils.h>
+
+#include "../../../../src/anj/coap/coap.h"
+#include "../../../../src/anj/io/io.h"
+
+#include <anj_unit_test.h>
+
+#ifdef ANJ_WITH_SENML_CBOR_RELATIVE_TIME
+
+typedef struct {
+    _anj_io_out_ctx_t ctx;
+    char buf[200];
+    size_t out_length;
+} senml_cbor_test_env_t;
+
+static void encode_records(senml_cbor_test_env_t *env,
+                           const anj_uri_path_t *base_path,
+                           _anj_op_t op_type,
+                           const anj_io_out_entry_t *entries,
+                           size_t entries_count) {
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_init(&env->ctx, op_type, base_path,
+                                                 entries_count,
+                                                 _ANJ_COAP_FORMAT_SENML_CBOR));
+    env->out_length = 0;
+    for (size_t i = 0; i < entries_count; i++) {
+        size_t copied_bytes;
+        ANJ_UNIT_ASSERT_SUCCESS(
+                _anj_io_out_ctx_new_entry(&env->ctx, &entries[i]));
+        ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_get_payload(
+                &env->ctx, &env->buf[env->out_length],
+                sizeof(env->buf) - env->out_length, &copied_bytes));
+        env->out_length += copied_bytes;
+    }
+}
+
+#    define VERIFY_BYTES(Env, Data)                                  \
+        do {                                                         \
+            ANJ_UNIT_ASSERT_EQUAL_BYTES(Env.buf, Data);              \
+            ANJ_UNIT_ASSERT_EQUAL(Env.out_length, sizeof(Data) - 1); \
+        } while (0)
+
+#    define UINT_ENTRY(Timestamp, Value)                      \
+        (anj_io_out_entry_t) {                                \
+            .timestamp = Timestamp,                           \
+            .path = ANJ_MAKE_RESOURCE_PATH(3303, 0, 5700),    \
+            .type = ANJ_DATA_TYPE_UINT,                       \
+            .value.uint_value = Value                         \
+        }
+
+ANJ_UNIT_TEST(senml_cbor_encoder_relative_time, send_time_series) {
+    senml_cbor_test_env_t env;
+    anj_io_out_entry_t entries[] = {
+        UINT_ENTRY(1705597224.0, 1), UINT_ENTRY(1705597234.0, 2),
+        UINT_ENTRY(1705597224.0, 3), UINT_ENTRY(1705597223.5, 4),
+        UINT_ENTRY(NAN, 5)
+    };
+    encode_records(&env, &ANJ_MAKE_RESOURCE_PATH(3303, 0, 5700),
+                   ANJ_OP_INF_CON_SEND, entries, ANJ_ARRAY_SIZE(entries));
+    VERIFY_BYTES(env, "\x85"
+                      "\xA3"
+                      "\x21\x6C/3303/0/5700"                     // base name
+                      "\x22\xFB\x41\xD9\x6A\x56\x4A\x00\x00\x00" // base time
+                      "\x02\x01"
+                      "\xA2"
+                      "\x06\x0A" // time +10
+                      "\x02\x02"
+                      "\xA1"
+                      "\x02\x03"
+                      "\xA2"
+                      "\x06\xFA\xBF\x00\x00\x00" // time -0.5
+                      "\x02\x04"
+                      "\xA2"
+                      "\x06\x3A\x65\xA9\x59\x27" // time -1705597224
+                      "\x02\x05");
+}
+
+ANJ_UNIT_TEST(senml_cbor_encoder_relative_time, first_record_without_time) {
+    senml_cbor_test_env_t env;
+    anj_io_out_entry_t entries[] = { UINT_ENTRY(NAN, 1),
+                                     UINT_ENTRY(100000.0, 2),
+                                     UINT_ENTRY(100060.0, 3) };
+    encode_records(&env, &ANJ_MAKE_INSTANCE_PATH(3303, 0),
+                   ANJ_OP_INF_NON_CON_NOTIFY, entries,
+                   ANJ_ARRAY_SIZE(entries));
+    VERIFY_BYTES(env, "\x83"
+                      "\xA2"
+                      "\x00\x6C/3303/0/5700"
+                      "\x02\x01"
+                      "\xA3"
+                      "\x00\x6C/3303/0/5700"
+                      "\x22\xFA\x47\xC3\x50\x00" // base time
+                      "\x02\x02"
+                      "\xA3"
+                      "\x00\x6C/3303/0/5700"
+                      "\x06\x18\x3C" // time +60
+                      "\x02\x03");
+}
+
+// Read responses carry no timestamps
+ANJ_UNIT_TEST(senml_cbor_encoder_relative_time, read) {
+    senml_cbor_test_env_t env;
+    anj_io_out_entry_t entries[] = { UINT_ENTRY(100000.0, 1) };
+    encode_records(&env, &ANJ_MAKE_RESOURCE_PATH(3303, 0, 5700),
+                   ANJ_OP_DM_READ, entries, ANJ_ARRAY_SIZE(entries));
+    VERIFY_BYTES(env, "\x81"
+                      "\xA2"
+                      "\x21\x6C/3303/0/5700"
+                      "\x02\x01");
+}
+
+#endif // ANJ_WITH_SENML_CBOR_RELATIVE_TIME
@@ -0,0 +1,185 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <anj/anj_config.h>
+#include <anj/defs.h>
+#include <anj/utils.h>
+
+#include "../../../../src/anj/coap/coap.h"
+#include "../../../../src/anj/io/cbor_encoder.h"
+#include "../../../../src/anj/io/io.h"
+
+#include <anj_unit_test.h>
+
+#ifdef ANJ_WITH_SENML_CBOR_STRINGREF
+
+typedef struct {
+    _anj_io_out_ctx_t ctx;
+    char buf[200];
+    size_t out_length;
+} senml_cbor_test_env_t;
+
+static void encode_records(senml_cbor_test_env_t *env,
+                           const anj_uri_path_t *base_path,
+                           _anj_op_t op_type,
+                           const anj_io_out_entry_t *entries,
+                           size_t entries_count) {
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_init(
+            &env->ctx, op_type, base_path, entries_count,
+            _ANJ_COAP_FORMAT_SENML_CBOR_STRINGREF));
+    env->out_length = 0;
+    for (size_t i = 0; i < entries_count; i++) {
+        size_t copied_bytes;
+        ANJ_UNIT_ASSERT_SUCCESS(
+                _anj_io_out_ctx_new_entry(&env->ctx, &entries[i]));
+        ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_get_payload(
+                &env->ctx, &env->buf[env->out_length],
+                sizeof(env->buf) - env->out_length, &copied_bytes));
+        env->out_length += copied_bytes;
+    }
+}
+
+#    define VERIFY_BYTES(Env, Data)                                  \
+        do {                                                         \
+            ANJ_UNIT_ASSERT_EQUAL_BYTES(Env.buf, Data);              \
+            ANJ_UNIT_ASSERT_EQUAL(Env.out_length, sizeof(Data) - 1); \
+        } while (0)
+
+#    define UINT_ENTRY(Rid, Value)                          \
+        (anj_io_out_entry_t) {                              \
+            .timestamp = NAN,                               \
+            .path = ANJ_MAKE_RESOURCE_PATH(3303, 0, Rid),   \
+            .type = ANJ_DATA_TYPE_UINT,                     \
+            .value.uint_value = Value                       \
+        }
+
+ANJ_UNIT_TEST(senml_cbor_encoder_stringref, repeated_names) {
+    senml_cbor_test_env_t env;
+    anj_io_out_entry_t entries[] = { UINT_ENTRY(5700, 1), UINT_ENTRY(5701, 2),
+                                     UINT_ENTRY(5700, 3), UINT_ENTRY(5701, 4) };
+    encode_records(&env, &ANJ_MAKE_INSTANCE_PATH(3303, 0), ANJ_OP_INF_CON_SEND,
+                   entries, ANJ_ARRAY_SIZE(entries));
+    VERIFY_BYTES(env, "\xD9\x01\x00" // stringref namespace
+                      "\x84"
+                      "\xA3"
+                      "\x21\x67/3303/0" // base name, string 0
+                      "\x00\x65/5700"   // string 1
+                      "\x02\x01"
+                      "\xA2"
+                      "\x00\x65/5701" // string 2
+                      "\x02\x02"
+                      "\xA2"
+                      "\x00\xD8\x19\x01" // reference to string 1
+                      "\x02\x03"
+                      "\xA2"
+                      "\x00\xD8\x19\x02" // reference to string 2
+                      "\x02\x04");
+}
+
+// values are numbered too, if they're long enough
+ANJ_UNIT_TEST(senml_cbor_encoder_stringref, string_values_numbered) {
+    senml_cbor_test_env_t env;
+    anj_io_out_entry_t entries[] = {
+        {
+            .timestamp = NAN,
+            .path = ANJ_MAKE_RESOURCE_PATH(3303, 0, 5750),
+            .type = ANJ_DATA_TYPE_STRING,
+            .value.bytes_or_string.data = "abc",
+            .value.bytes_or_string.chunk_length = 3
+        },
+        {
+            .timestamp = NAN,
+            .path = ANJ_MAKE_RESOURCE_PATH(3303, 0, 5751),
+            .type = ANJ_DATA_TYPE_STRING,
+            .value.bytes_or_string.data = "ab",
+            .value.bytes_or_string.chunk_length = 2
+        },
+        {
+            .timestamp = NAN,
+            .path = ANJ_MAKE_RESOURCE_PATH(3303, 0, 5752),
+            .type = ANJ_DATA_TYPE_OBJLNK,
+            .value.objlnk = { 1, 2 }
+        },
+        UINT_ENTRY(5750, 1)
+    };
+    encode_records(&env, &ANJ_MAKE_INSTANCE_PATH(3303, 0), ANJ_OP_INF_CON_SEND,
+                   entries, ANJ_ARRAY_SIZE(entries));
+    VERIFY_BYTES(env, "\xD9\x01\x00"
+                      "\x84"
+                      "\xA3"
+                      "\x21\x67/3303/0" // string 0
+                      "\x00\x65/5750"   // string 1
+                      "\x03\x63"
+                      "abc" // string 2
+                      "\xA2"
+                      "\x00\x65/5751" // string 3
+                      "\x03\x62"
+                      "ab" // too short
+                      "\xA2"
+                      "\x00\x65/5752" // string 4
+                      "\x63vlo"       // string 5
+                      "\x63"
+                      "1:2" // string 6
+                      "\xA2"
+                      "\x00\xD8\x19\x01"
+                      "\x02\x01");
+}
+
+ANJ_UNIT_TEST(senml_cbor_encoder_stringref, base_name_only) {
+    senml_cbor_test_env_t env;
+    anj_io_out_entry_t entries[] = { UINT_ENTRY(5700, 1) };
+    encode_records(&env, &ANJ_MAKE_RESOURCE_PATH(3303, 0, 5700),
+                   ANJ_OP_DM_READ, entries, ANJ_ARRAY_SIZE(entries));
+    VERIFY_BYTES(env, "\xD9\x01\x00"
+                      "\x81"
+                      "\xA2"
+                      "\x21\x6C/3303/0/5700"
+                      "\x02\x01");
+}
+
+ANJ_UNIT_TEST(senml_cbor_encoder_stringref,
+              largest_possible_size_of_single_msg) {
+    senml_cbor_test_env_t env = { 0 };
+    anj_uri_path_t base_path = ANJ_MAKE_INSTANCE_PATH(65534, 65534);
+    env.ctx.format = _ANJ_COAP_FORMAT_SENML_CBOR_STRINGREF;
+    // call _anj_senml_cbor_encoder_init directly to allow to set basename and
+    // timestamp in one message
+    ANJ_UNIT_ASSERT_SUCCESS(
+            _anj_senml_cbor_encoder_init(&env.ctx, &base_path, 65534, true));
+    // the name differs from the base name, otherwise it'd be a reference
+    anj_io_out_entry_t entry = {
+        .timestamp = 1.0e+300,
+        .path = ANJ_MAKE_RESOURCE_INSTANCE_PATH(65534, 65534, 65533, 65533),
+        .type = ANJ_DATA_TYPE_OBJLNK,
+        .value.objlnk.oid = 65534,
+        .value.objlnk.iid = 65534
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_new_entry(&env.ctx, &entry));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_get_payload(
+            &env.ctx, env.buf, sizeof(env.buf), &env.out_length));
+    ANJ_UNIT_ASSERT_EQUAL(env.out_length,
+                          _ANJ_IO_SENML_CBOR_SIMPLE_RECORD_MAX_LENGTH - 1);
+}
+
+ANJ_UNIT_TEST(senml_cbor_encoder_stringref, empty_read) {
+    senml_cbor_test_env_t env;
+    encode_records(&env, &ANJ_MAKE_OBJECT_PATH(3303), ANJ_OP_DM_READ, NULL,
+                   0);
+    size_t copied_bytes;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_get_payload(
+            &env.ctx, env.buf, sizeof(env.buf), &copied_bytes));
+    ANJ_UNIT_ASSERT_EQUAL(copied_bytes, 1);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES(env.buf, "\x80");
+}
+
+#endif // ANJ_WITH_SENML_CBOR_STRINGREF
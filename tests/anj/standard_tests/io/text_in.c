@@ -463,6 +463,27 @@ ANJ_UNIT_TEST(text_in, 16_bytes_in) {
     ASSERT_EQ_BYTES(value->bytes_or_string.data, data_out);
 }
 
+ANJ_UNIT_TEST(text_in, bytes_decoded_in_place) {
+    char data_in[] = "AgEDB/8AMSUkJicoKTAxAA==";
+    static char data_out[] =
+            "\x02\x01\x03\x07\xff\x00\x31\x25\x24\x26\x27\x28\x29\x30\x31\x00";
+    TEST_ENV(data_in, MAKE_TEST_RESOURCE_PATH(5), true);
+    anj_data_type_t type_bitmask = ANJ_DATA_TYPE_BYTES;
+    ASSERT_OK(_anj_io_in_ctx_get_entry(&ctx, &type_bitmask, &value, &path));
+    ASSERT_TRUE(value->bytes_or_string.data == data_in);
+    ASSERT_EQ(value->bytes_or_string.chunk_length, sizeof(data_out) - 1);
+    ASSERT_EQ_BYTES(value->bytes_or_string.data, data_out);
+}
+
+ANJ_UNIT_TEST(text_in, number_parsed_in_place) {
+    static char data_in[] = "-1234567";
+    TEST_ENV(data_in, MAKE_TEST_RESOURCE_PATH(5), true);
+    anj_data_type_t type_bitmask = ANJ_DATA_TYPE_INT;
+    ASSERT_OK(_anj_io_in_ctx_get_entry(&ctx, &type_bitmask, &value, &path));
+    ASSERT_EQ(value->int_value, -1234567);
+    ASSERT_EQ(ctx.decoder.text.aux.abuf.size, 0);
+}
+
 ANJ_UNIT_TEST(text_in, 16_bytes_in_parts) {
     static char data_in_1[] = "AgEDB";
     static char data_in_2[] = "/8AM";
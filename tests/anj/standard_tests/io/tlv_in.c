@@ -146,6 +146,38 @@ ANJ_UNIT_TEST(tlv_in_bytes, multiple_resource_entries) {
               _ANJ_IO_EOF);
 }
 
+ANJ_UNIT_TEST(tlv_in_bytes, many_resource_entries) {
+    // headers of all entries together are longer than the ID/length buffer
+    // [ RID(0)="a", RID(1)="b", ..., RID(7)="h" ]
+    char DATA[] = "\xC8\x00\x01"
+                  "a"
+                  "\xC8\x01\x01"
+                  "b"
+                  "\xC8\x02\x01"
+                  "c"
+                  "\xC8\x03\x01"
+                  "d"
+                  "\xC8\x04\x01"
+                  "e"
+                  "\xC8\x05\x01"
+                  "f"
+                  "\xC8\x06\x01"
+                  "g"
+                  "\xC8\x07\x01"
+                  "h";
+    TEST_ENV(DATA, TEST_INSTANCE_PATH, true);
+    anj_data_type_t type_bitmask = ANJ_DATA_TYPE_BYTES;
+    for (anj_rid_t rid = 0; rid < 8; rid++) {
+        ASSERT_OK(_anj_io_in_ctx_get_entry(&ctx, &type_bitmask, &value, &path));
+        ASSERT_TRUE(
+                anj_uri_path_equal(path, &ANJ_MAKE_RESOURCE_PATH(3, 4, rid)));
+        ASSERT_EQ(value->bytes_or_string.chunk_length, 1);
+        ASSERT_EQ(((const char *) value->bytes_or_string.data)[0], 'a' + rid);
+    }
+    ASSERT_EQ(_anj_io_in_ctx_get_entry(&ctx, &type_bitmask, &value, &path),
+              _ANJ_IO_EOF);
+}
+
 ANJ_UNIT_TEST(tlv_in_bytes, premature_end) {
     static char DATA[] = "\xC7\x2A"
                          "012";
@@ -527,6 +559,18 @@ ANJ_UNIT_TEST(tlv_in_types, objlnk_two_feeds) {
     ASSERT_EQ(value->objlnk.iid, 65535);
 }
 
+ANJ_UNIT_TEST(tlv_in_types, complete_payload_is_parsed_in_place) {
+    static char DATA[] = "\xE4\xA4\x10"
+                         "\x00\x01\xFF\xFF";
+    TEST_ENV(DATA, TEST_INSTANCE_PATH, true);
+    anj_data_type_t type_bitmask = ANJ_DATA_TYPE_OBJLNK;
+    ASSERT_OK(_anj_io_in_ctx_get_entry(&ctx, &type_bitmask, &value, &path));
+    ASSERT_TRUE(ctx.decoder.tlv.id_length == (const uint8_t *) DATA + 1);
+    ASSERT_TRUE(anj_uri_path_equal(path, &MAKE_TEST_RESOURCE_PATH(42000)));
+    ASSERT_EQ(value->objlnk.oid, 1);
+    ASSERT_EQ(value->objlnk.iid, 65535);
+}
+
 ANJ_UNIT_TEST(tlv_in_types, time_ok) {
     static char DATA[] = "\xC8\x01\x08"
                          "\x00\x00\x00\x00\x42\x4E\xF4\x5C";
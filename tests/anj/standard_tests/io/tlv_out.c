@@ -0,0 +1,269 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <string.h>
+
+#include <anj/anj_config.h>
+#include <anj/defs.h>
+#include <anj/utils.h>
+
+#include "../../../../src/anj/coap/coap.h"
+#include "../../../../src/anj/io/io.h"
+
+#include <anj_unit_test.h>
+
+#ifdef ANJ_WITH_TLV_ENCODER
+
+typedef struct {
+    _anj_io_out_ctx_t ctx;
+    uint8_t buf[300];
+    size_t out_length;
+} tlv_test_env_t;
+
+static void tlv_test_setup(tlv_test_env_t *env, const anj_uri_path_t *path) {
+    memset(env, 0, sizeof(tlv_test_env_t));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_init(
+            &env->ctx, ANJ_OP_DM_READ, path, 1,
+            _ANJ_COAP_FORMAT_OMA_LWM2M_TLV));
+    ANJ_UNIT_ASSERT_EQUAL(_anj_io_out_ctx_get_format(&env->ctx),
+                          _ANJ_COAP_FORMAT_OMA_LWM2M_TLV);
+}
+
+static void tlv_add_entry(tlv_test_env_t *env,
+                          const anj_io_out_entry_t *entry) {
+    size_t copied_bytes = 0;
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_new_entry(&env->ctx, entry));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_get_payload(
+            &env->ctx, &env->buf[env->out_length],
+            sizeof(env->buf) - env->out_length, &copied_bytes));
+    env->out_length += copied_bytes;
+}
+
+#    define VERIFY_PAYLOAD(Env, Expected)                                   \
+        do {                                                                \
+            ANJ_UNIT_ASSERT_EQUAL((Env).out_length, sizeof(Expected) - 1);  \
+            ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED((Env).buf, Expected,          \
+                                              sizeof(Expected) - 1);        \
+        } while (0)
+
+#    define TEST_SINGLE_RESOURCE(Name, Rid, Type, Field, Value, Expected) \
+        ANJ_UNIT_TEST(tlv_out, Name) {                                   \
+            tlv_test_env_t env;                                          \
+            tlv_test_setup(&env, &ANJ_MAKE_RESOURCE_PATH(1, 1, Rid));    \
+            anj_io_out_entry_t entry = {                                 \
+                .type = Type,                                            \
+                .path = ANJ_MAKE_RESOURCE_PATH(1, 1, Rid),               \
+                .value.Field = Value                                     \
+            };                                                           \
+            tlv_add_entry(&env, &entry);                                 \
+            VERIFY_PAYLOAD(env, Expected);                               \
+        }
+
+TEST_SINGLE_RESOURCE(int_1_byte, 1, ANJ_DATA_TYPE_INT, int_value, 42,
+                     "\xC1\x01\x2A")
+TEST_SINGLE_RESOURCE(int_2_bytes, 1, ANJ_DATA_TYPE_INT, int_value, -300,
+                     "\xC2\x01\xFE\xD4")
+TEST_SINGLE_RESOURCE(int_4_bytes, 1, ANJ_DATA_TYPE_INT, int_value, 100000,
+                     "\xC4\x01\x00\x01\x86\xA0")
+TEST_SINGLE_RESOURCE(int_8_bytes, 1, ANJ_DATA_TYPE_INT, int_value,
+                     INT64_MIN, "\xC8\x01\x08\x80\x00\x00\x00\x00\x00\x00\x00")
+TEST_SINGLE_RESOURCE(uint, 1, ANJ_DATA_TYPE_UINT, uint_value, 255,
+                     "\xC1\x01\xFF")
+TEST_SINGLE_RESOURCE(time, 1, ANJ_DATA_TYPE_TIME, time_value, 1000,
+                     "\xC2\x01\x03\xE8")
+TEST_SINGLE_RESOURCE(double, 1, ANJ_DATA_TYPE_DOUBLE, double_value, 1.5,
+                     "\xC8\x01\x08\x3F\xF8\x00\x00\x00\x00\x00\x00")
+TEST_SINGLE_RESOURCE(bool, 1, ANJ_DATA_TYPE_BOOL, bool_value, true,
+                     "\xC1\x01\x01")
+TEST_SINGLE_RESOURCE(objlnk, 1, ANJ_DATA_TYPE_OBJLNK, objlnk,
+                     ((anj_objlnk_value_t) { 3, 1 }),
+                     "\xC4\x01\x00\x03\x00\x01")
+TEST_SINGLE_RESOURCE(rid_16_bit, 1000, ANJ_DATA_TYPE_INT, int_value, 1,
+                     "\xE1\x03\xE8\x01")
+
+ANJ_UNIT_TEST(tlv_out, string) {
+    tlv_test_env_t env;
+    tlv_test_setup(&env, &ANJ_MAKE_RESOURCE_PATH(1, 1, 1));
+    anj_io_out_entry_t entry = {
+        .type = ANJ_DATA_TYPE_STRING,
+        .path = ANJ_MAKE_RESOURCE_PATH(1, 1, 1),
+        .value.bytes_or_string.data = "abcdefgh"
+    };
+    tlv_add_entry(&env, &entry);
+    VERIFY_PAYLOAD(env, "\xC8\x01\x08"
+                        "abcdefgh");
+}
+
+ANJ_UNIT_TEST(tlv_out, empty_bytes) {
+    tlv_test_env_t env;
+    tlv_test_setup(&env, &ANJ_MAKE_RESOURCE_PATH(1, 1, 1));
+    anj_io_out_entry_t entry = {
+        .type = ANJ_DATA_TYPE_BYTES,
+        .path = ANJ_MAKE_RESOURCE_PATH(1, 1, 1)
+    };
+    tlv_add_entry(&env, &entry);
+    VERIFY_PAYLOAD(env, "\xC0\x01");
+}
+
+ANJ_UNIT_TEST(tlv_out, bytes_in_blocks) {
+    uint8_t data[300];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t) i;
+    }
+    tlv_test_env_t env;
+    tlv_test_setup(&env, &ANJ_MAKE_RESOURCE_PATH(1, 1, 1));
+    anj_io_out_entry_t entry = {
+        .type = ANJ_DATA_TYPE_BYTES,
+        .path = ANJ_MAKE_RESOURCE_PATH(1, 1, 1),
+        .value.bytes_or_string.data = data,
+        .value.bytes_or_string.chunk_length = sizeof(data)
+    };
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_new_entry(&env.ctx, &entry));
+
+    uint8_t out[sizeof(data) + 4];
+    size_t out_length = 0;
+    size_t copied_bytes;
+    int res;
+    do {
+        res = _anj_io_out_ctx_get_payload(&env.ctx, &out[out_length], 2,
+                                          &copied_bytes);
+        ANJ_UNIT_ASSERT_TRUE(res == 0 || res == ANJ_IO_NEED_NEXT_CALL);
+        out_length += copied_bytes;
+    } while (res);
+
+    ANJ_UNIT_ASSERT_EQUAL(out_length, sizeof(out));
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(out, "\xD0\x01\x01\x2C", 4);
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(&out[4], data, sizeof(data));
+}
+
+ANJ_UNIT_TEST(tlv_out, resource_instance) {
+    tlv_test_env_t env;
+    tlv_test_setup(&env, &ANJ_MAKE_RESOURCE_INSTANCE_PATH(1, 1, 7, 3));
+    anj_io_out_entry_t entry = {
+        .type = ANJ_DATA_TYPE_INT,
+        .path = ANJ_MAKE_RESOURCE_INSTANCE_PATH(1, 1, 7, 3),
+        .value.int_value = 5
+    };
+    tlv_add_entry(&env, &entry);
+    VERIFY_PAYLOAD(env, "\x41\x03\x05");
+}
+
+ANJ_UNIT_TEST(tlv_out, multi_instance_resource) {
+    tlv_test_env_t env;
+    tlv_test_setup(&env, &ANJ_MAKE_RESOURCE_PATH(1, 1, 7));
+    anj_io_out_entry_t entry = {
+        .type = ANJ_DATA_TYPE_INT,
+        .path = ANJ_MAKE_RESOURCE_INSTANCE_PATH(1, 1, 7, 0),
+        .value.int_value = 1
+    };
+    _anj_io_out_ctx_set_res_insts_count(&env.ctx, 2);
+    tlv_add_entry(&env, &entry);
+    entry.path = ANJ_MAKE_RESOURCE_INSTANCE_PATH(1, 1, 7, 4);
+    entry.value.int_value = -1;
+    tlv_add_entry(&env, &entry);
+    VERIFY_PAYLOAD(env, "\x88\x07\x18"
+                        "\x68\x00\x00\x08\x00\x00\x00\x00\x00\x00\x00\x01"
+                        "\x68\x00\x04\x08\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF");
+}
+
+ANJ_UNIT_TEST(tlv_out, object_instance) {
+    tlv_test_env_t env;
+    tlv_test_setup(&env, &ANJ_MAKE_INSTANCE_PATH(1, 1));
+    anj_io_out_entry_t entry = {
+        .type = ANJ_DATA_TYPE_STRING,
+        .path = ANJ_MAKE_RESOURCE_PATH(1, 1, 0),
+        .value.bytes_or_string.data = "abc"
+    };
+    tlv_add_entry(&env, &entry);
+    entry = (anj_io_out_entry_t) {
+        .type = ANJ_DATA_TYPE_BOOL,
+        .path = ANJ_MAKE_RESOURCE_INSTANCE_PATH(1, 1, 2, 1),
+        .value.bool_value = true
+    };
+    _anj_io_out_ctx_set_res_insts_count(&env.ctx, 1);
+    tlv_add_entry(&env, &entry);
+    entry = (anj_io_out_entry_t) {
+        .type = ANJ_DATA_TYPE_UINT,
+        .path = ANJ_MAKE_RESOURCE_PATH(1, 1, 3),
+        .value.uint_value = 70000
+    };
+    tlv_add_entry(&env, &entry);
+    VERIFY_PAYLOAD(env, "\xC3\x00"
+                        "abc"
+                        "\x84\x02\x61\x00\x01\x01"
+                        "\xC4\x03\x00\x01\x11\x70");
+}
+
+ANJ_UNIT_TEST(tlv_out, multi_instance_resource_count_not_set) {
+    tlv_test_env_t env;
+    tlv_test_setup(&env, &ANJ_MAKE_RESOURCE_PATH(1, 1, 7));
+    anj_io_out_entry_t entry = {
+        .type = ANJ_DATA_TYPE_INT,
+        .path = ANJ_MAKE_RESOURCE_INSTANCE_PATH(1, 1, 7, 0)
+    };
+    ANJ_UNIT_ASSERT_EQUAL(_anj_io_out_ctx_new_entry(&env.ctx, &entry),
+                          _ANJ_IO_ERR_LOGIC);
+}
+
+ANJ_UNIT_TEST(tlv_out, multi_instance_resource_incomplete) {
+    tlv_test_env_t env;
+    tlv_test_setup(&env, &ANJ_MAKE_INSTANCE_PATH(1, 1));
+    anj_io_out_entry_t entry = {
+        .type = ANJ_DATA_TYPE_INT,
+        .path = ANJ_MAKE_RESOURCE_INSTANCE_PATH(1, 1, 7, 0)
+    };
+    _anj_io_out_ctx_set_res_insts_count(&env.ctx, 2);
+    tlv_add_entry(&env, &entry);
+    entry.path = ANJ_MAKE_RESOURCE_PATH(1, 1, 8);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_io_out_ctx_new_entry(&env.ctx, &entry),
+                          _ANJ_IO_ERR_LOGIC);
+}
+
+ANJ_UNIT_TEST(tlv_out, multi_instance_string_not_supported) {
+    tlv_test_env_t env;
+    tlv_test_setup(&env, &ANJ_MAKE_RESOURCE_PATH(1, 1, 7));
+    anj_io_out_entry_t entry = {
+        .type = ANJ_DATA_TYPE_STRING,
+        .path = ANJ_MAKE_RESOURCE_INSTANCE_PATH(1, 1, 7, 0),
+        .value.bytes_or_string.data = "abc"
+    };
+    _anj_io_out_ctx_set_res_insts_count(&env.ctx, 1);
+    ANJ_UNIT_ASSERT_EQUAL(_anj_io_out_ctx_new_entry(&env.ctx, &entry),
+                          _ANJ_IO_ERR_UNSUPPORTED_FORMAT);
+}
+
+ANJ_UNIT_TEST(tlv_out, object_not_supported) {
+    _anj_io_out_ctx_t ctx;
+    ANJ_UNIT_ASSERT_EQUAL(_anj_io_out_ctx_init(&ctx, ANJ_OP_DM_READ,
+                                               &ANJ_MAKE_OBJECT_PATH(1), 2,
+                                               _ANJ_COAP_FORMAT_OMA_LWM2M_TLV),
+                          _ANJ_IO_ERR_UNSUPPORTED_FORMAT);
+}
+
+ANJ_UNIT_TEST(tlv_out, send_not_supported) {
+    _anj_io_out_ctx_t ctx;
+    ANJ_UNIT_ASSERT_EQUAL(_anj_io_out_ctx_init(&ctx, ANJ_OP_INF_CON_SEND,
+                                               &ANJ_MAKE_INSTANCE_PATH(1, 1),
+                                               2,
+                                               _ANJ_COAP_FORMAT_OMA_LWM2M_TLV),
+                          _ANJ_IO_ERR_UNSUPPORTED_FORMAT);
+}
+
+ANJ_UNIT_TEST(tlv_out, empty_read) {
+    tlv_test_env_t env;
+    memset(&env, 0, sizeof(env));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_init(
+            &env.ctx, ANJ_OP_DM_READ, &ANJ_MAKE_INSTANCE_PATH(1, 1), 0,
+            _ANJ_COAP_FORMAT_OMA_LWM2M_TLV));
+    ANJ_UNIT_ASSERT_SUCCESS(_anj_io_out_ctx_get_payload(
+            &env.ctx, env.buf, sizeof(env.buf), &env.out_length));
+    ANJ_UNIT_ASSERT_EQUAL(env.out_length, 0);
+}
+
+#endif // ANJ_WITH_TLV_ENCODER
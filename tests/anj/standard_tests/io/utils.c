@@ -7,9 +7,12 @@
  * See the attached LICENSE file for details.
  */
 
+#include <inttypes.h>
 #include <math.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <anj/defs.h>
@@ -23,6 +26,7 @@ static void test_double_to_string(double value, const char *result) {
     ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff, result, strlen(result));
 }
 
+#ifndef ANJ_WITH_FAST_NUMBER_FORMATTING
 ANJ_UNIT_TEST(utils, double_to_str_custom) {
     test_double_to_string(0, "0");
     test_double_to_string((double) UINT16_MAX, "65535");
@@ -57,6 +61,7 @@ ANJ_UNIT_TEST(utils, double_to_str_custom) {
     test_double_to_string(78e120, "7.8e+121");
     test_double_to_string(1e20, "1e+20");
 }
+#endif // ANJ_WITH_FAST_NUMBER_FORMATTING
 
 static void
 test_string_to_double(const char *buff, double expected, bool failed) {
@@ -307,3 +312,194 @@ ANJ_UNIT_TEST(utils, int64_to_string) {
     test_int64_to_string(INT64_MAX, "9223372036854775807");
     test_int64_to_string(INT64_MIN, "-9223372036854775808");
 }
+
+#if defined(ANJ_WITH_FAST_NUMBER_FORMATTING) \
+        || defined(ANJ_WITH_FAST_NUMBER_PARSING)
+static uint64_t next_random(uint64_t *state) {
+    // xorshift64
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+#endif // defined(ANJ_WITH_FAST_NUMBER_FORMATTING) ||
+       // defined(ANJ_WITH_FAST_NUMBER_PARSING)
+
+#ifdef ANJ_WITH_FAST_NUMBER_FORMATTING
+static void check_integers_like_printf(uint64_t value) {
+    char buff[ANJ_I64_STR_MAX_LEN + 1];
+    char expected[ANJ_I64_STR_MAX_LEN + 1];
+    size_t len = anj_uint64_to_string_value(buff, value);
+    ANJ_UNIT_ASSERT_EQUAL(len, (size_t) snprintf(expected, sizeof(expected),
+                                                 "%" PRIu64, value));
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff, expected, len);
+
+    len = anj_int64_to_string_value(buff, (int64_t) value);
+    ANJ_UNIT_ASSERT_EQUAL(len, (size_t) snprintf(expected, sizeof(expected),
+                                                 "%" PRId64, (int64_t) value));
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff, expected, len);
+
+    len = anj_uint32_to_string_value(buff, (uint32_t) value);
+    ANJ_UNIT_ASSERT_EQUAL(len, (size_t) snprintf(expected, sizeof(expected),
+                                                 "%" PRIu32, (uint32_t) value));
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff, expected, len);
+
+    len = anj_uint16_to_string_value(buff, (uint16_t) value);
+    ANJ_UNIT_ASSERT_EQUAL(len, (size_t) snprintf(expected, sizeof(expected),
+                                                 "%" PRIu16, (uint16_t) value));
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff, expected, len);
+}
+
+ANJ_UNIT_TEST(utils, fast_integer_to_string_like_printf) {
+    for (uint64_t power = 1; power <= UINT64_MAX / 10; power *= 10) {
+        check_integers_like_printf(power - 1);
+        check_integers_like_printf(power);
+        check_integers_like_printf(power + 1);
+    }
+    check_integers_like_printf(UINT32_MAX);
+    check_integers_like_printf((uint64_t) UINT32_MAX + 1);
+    check_integers_like_printf((uint64_t) INT64_MIN);
+    check_integers_like_printf(UINT64_MAX);
+    uint64_t state = 0x0123456789ABCDEFULL;
+    for (int i = 0; i < 10000; i++) {
+        uint64_t value = next_random(&state);
+        // spread the values over all lengths
+        check_integers_like_printf(value >> (i % 64));
+    }
+}
+
+static void test_double_shortest(double value, const char *expected) {
+    char buff[ANJ_DOUBLE_STR_MAX_LEN];
+    size_t len = anj_double_to_string_value(buff, value);
+    ANJ_UNIT_ASSERT_EQUAL(len, strlen(expected));
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(buff, expected, len);
+}
+
+ANJ_UNIT_TEST(utils, double_to_str_shortest) {
+    // same as other implementations
+    test_double_shortest((double) UINT32_MAX - 0.02, "4294967294.98");
+    test_double_shortest(0.00000122, "0.00000122");
+    test_double_shortest(777.000760, "777.00076");
+    test_double_shortest(999999999.4440002, "999999999.4440002");
+    test_double_shortest(1234e15, "1234000000000000000");
+    test_double_shortest(2111e18, "2.111e+21");
+    test_double_shortest(-124e-15, "-1.24e-13");
+    test_double_shortest(-4568e-22, "-4.568e-19");
+    test_double_shortest(78e120, "7.8e+121");
+    test_double_shortest(1e20, "1e+20");
+    test_double_shortest(-INFINITY, "-inf");
+    // integral values are exact
+    test_double_shortest(9007199254740993.0, "9007199254740992");
+    test_double_shortest(18446744073709549568.0, "18446744073709549568");
+    // shortest representation
+    test_double_shortest(0.0005999999999999999, "0.0006");
+    test_double_shortest(0.1, "0.1");
+    test_double_shortest(0.3, "0.3");
+    test_double_shortest(1.1, "1.1");
+    test_double_shortest(-0.5, "-0.5");
+    test_double_shortest(123456.789, "123456.789");
+    test_double_shortest(1e-10, "1e-10");
+    test_double_shortest(1.0000000000000002, "1.0000000000000002");
+    test_double_shortest(5e-324, "5e-324");
+    test_double_shortest(-2.2250738585072014E-308, "-2.2250738585072014e-308");
+    test_double_shortest(1.7976931348623157e308, "1.7976931348623157e+308");
+    // would not fit in 0.X format
+    test_double_shortest(1.2345678901234567e-9, "1.2345678901234566e-9");
+}
+
+ANJ_UNIT_TEST(utils, double_to_str_round_trip) {
+    uint64_t state = 0xFEDCBA9876543210ULL;
+    for (int i = 0; i < 100000; i++) {
+        uint64_t bits = next_random(&state);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        if (!isfinite(value)) {
+            continue;
+        }
+        char buff[ANJ_DOUBLE_STR_MAX_LEN + 1];
+        size_t len = anj_double_to_string_value(buff, value);
+        ANJ_UNIT_ASSERT_TRUE(len <= ANJ_DOUBLE_STR_MAX_LEN);
+        buff[len] = '\0';
+        ANJ_UNIT_ASSERT_TRUE(strtod(buff, NULL) == value);
+    }
+}
+#endif // ANJ_WITH_FAST_NUMBER_FORMATTING
+
+#ifdef ANJ_WITH_FAST_NUMBER_PARSING
+static void check_string_to_double_like_strtod(const char *buff) {
+    double expected = strtod(buff, NULL);
+    double value;
+    if (isinf(expected)) {
+        ANJ_UNIT_ASSERT_FAILED(
+                anj_string_to_double_value(&value, buff, strlen(buff)));
+        return;
+    }
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_string_to_double_value(&value, buff, strlen(buff)));
+    ANJ_UNIT_ASSERT_EQUAL_BYTES_SIZED(&value, &expected, sizeof(value));
+}
+
+ANJ_UNIT_TEST(utils, str_to_double_correctly_rounded) {
+    // halfway between two doubles, ties to even
+    check_string_to_double_like_strtod("9007199254740993");
+    check_string_to_double_like_strtod("9007199254740995");
+    check_string_to_double_like_strtod("9007199254740993.0000000001");
+    // classic hard cases
+    check_string_to_double_like_strtod("0.1");
+    check_string_to_double_like_strtod("2.2250738585072011e-308");
+    check_string_to_double_like_strtod("2.2250738585072012e-308");
+    check_string_to_double_like_strtod("4.9406564584124654e-324");
+    check_string_to_double_like_strtod("2.4703282292062328e-324");
+    check_string_to_double_like_strtod("2.4703282292062327e-324");
+    check_string_to_double_like_strtod("1e-400");
+    check_string_to_double_like_strtod("1.7976931348623157e308");
+    check_string_to_double_like_strtod("1.7976931348623158e308");
+    check_string_to_double_like_strtod("1.7976931348623159e308");
+    check_string_to_double_like_strtod("1e309");
+    check_string_to_double_like_strtod("123456789012345678901234567890");
+    check_string_to_double_like_strtod("0.000000000000000000000000000001");
+    check_string_to_double_like_strtod("-0");
+    check_string_to_double_like_strtod("00012.50");
+    check_string_to_double_like_strtod("5.");
+    check_string_to_double_like_strtod(".5");
+
+    double value;
+    ANJ_UNIT_ASSERT_FAILED(anj_string_to_double_value(&value, ".", 1));
+    ANJ_UNIT_ASSERT_FAILED(anj_string_to_double_value(&value, "1.2.3", 5));
+    ANJ_UNIT_ASSERT_FAILED(anj_string_to_double_value(&value, "+1", 2));
+    ANJ_UNIT_ASSERT_FAILED(anj_string_to_double_value(&value, "inf", 3));
+    ANJ_UNIT_ASSERT_FAILED(anj_string_to_double_value(&value, "nan", 3));
+}
+
+ANJ_UNIT_TEST(utils, str_to_double_random) {
+    uint64_t state = 0x0F1E2D3C4B5A6978ULL;
+    char buff[64];
+    for (int i = 0; i < 100000; i++) {
+        uint64_t random = next_random(&state);
+        // significands of 1 to 19 digits, all exponents in the double range
+        uint64_t significand =
+                (random >> (random % 64)) % UINT64_C(10000000000000000000);
+        int exponent = (int) (next_random(&state) % 680) - 360;
+        snprintf(buff, sizeof(buff), "%" PRIu64 "e%d", significand, exponent);
+        if (strlen(buff) > ANJ_DOUBLE_STR_MAX_LEN) {
+            snprintf(buff, sizeof(buff), "%" PRIu64, significand);
+        }
+        check_string_to_double_like_strtod(buff);
+    }
+}
+
+ANJ_UNIT_TEST(utils, str_to_double_round_trip) {
+    uint64_t state = 0x13579BDF2468ACE0ULL;
+    for (int i = 0; i < 100000; i++) {
+        uint64_t bits = next_random(&state);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        if (!isfinite(value)) {
+            continue;
+        }
+        char buff[32];
+        snprintf(buff, sizeof(buff), "%.17g", value);
+        check_string_to_double_like_strtod(buff);
+    }
+}
+#endif // ANJ_WITH_FAST_NUMBER_PARSING
@@ -0,0 +1,256 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef ANJ_WITH_OSCORE
+
+#    include <anj/compat/crypto/aes_ccm.h>
+
+/*
+ * Straightforward AES-128 and CCM (RFC 3610), so that OSCORE test vectors of
+ * RFC 8613 can be verified without MbedTLS.
+ */
+
+#    define BLOCK_SIZE 16
+#    define ROUNDS 10
+
+static const uint8_t SBOX[256] = {
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b,
+    0xfe, 0xd7, 0xab, 0x76, 0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0,
+    0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0, 0xb7, 0xfd, 0x93, 0x26,
+    0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2,
+    0xeb, 0x27, 0xb2, 0x75, 0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0,
+    0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84, 0x53, 0xd1, 0x00, 0xed,
+    0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f,
+    0x50, 0x3c, 0x9f, 0xa8, 0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5,
+    0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2, 0xcd, 0x0c, 0x13, 0xec,
+    0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14,
+    0xde, 0x5e, 0x0b, 0xdb, 0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c,
+    0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79, 0xe7, 0xc8, 0x37, 0x6d,
+    0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f,
+    0x4b, 0xbd, 0x8b, 0x8a, 0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e,
+    0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e, 0xe1, 0xf8, 0x98, 0x11,
+    0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f,
+    0xb0, 0x54, 0xbb, 0x16
+};
+
+typedef struct {
+    uint8_t round_keys[(ROUNDS + 1) * BLOCK_SIZE];
+} aes_t;
+
+static uint8_t xtime(uint8_t x) {
+    return (uint8_t) ((x << 1) ^ ((x & 0x80) ? 0x1b : 0x00));
+}
+
+static void aes_init(aes_t *aes, const uint8_t *key) {
+    uint8_t rcon = 0x01;
+    memcpy(aes->round_keys, key, BLOCK_SIZE);
+    for (size_t i = BLOCK_SIZE; i < sizeof(aes->round_keys); i += 4) {
+        uint8_t t[4];
+        memcpy(t, &aes->round_keys[i - 4], 4);
+        if (i % BLOCK_SIZE == 0) {
+            uint8_t first = t[0];
+            t[0] = (uint8_t) (SBOX[t[1]] ^ rcon);
+            t[1] = SBOX[t[2]];
+            t[2] = SBOX[t[3]];
+            t[3] = SBOX[first];
+            rcon = xtime(rcon);
+        }
+        for (size_t j = 0; j < 4; j++) {
+            aes->round_keys[i + j] =
+                    (uint8_t) (aes->round_keys[i + j - BLOCK_SIZE] ^ t[j]);
+        }
+    }
+}
+
+static void aes_encrypt_block(const aes_t *aes, uint8_t *block) {
+    for (size_t i = 0; i < BLOCK_SIZE; i++) {
+        block[i] ^= aes->round_keys[i];
+    }
+    for (size_t round = 1; round <= ROUNDS; round++) {
+        uint8_t s[BLOCK_SIZE];
+        // SubBytes and ShiftRows, the state is stored column by column
+        for (size_t col = 0; col < 4; col++) {
+            for (size_t row = 0; row < 4; row++) {
+                s[4 * col + row] = SBOX[block[4 * ((col + row) % 4) + row]];
+            }
+        }
+        if (round != ROUNDS) {
+            for (size_t col = 0; col < 4; col++) {
+                uint8_t *c = &s[4 * col];
+                uint8_t all = (uint8_t) (c[0] ^ c[1] ^ c[2] ^ c[3]);
+                uint8_t first = c[0];
+                c[0] ^= (uint8_t) (all ^ xtime((uint8_t) (c[0] ^ c[1])));
+                c[1] ^= (uint8_t) (all ^ xtime((uint8_t) (c[1] ^ c[2])));
+                c[2] ^= (uint8_t) (all ^ xtime((uint8_t) (c[2] ^ c[3])));
+                c[3] ^= (uint8_t) (all ^ xtime((uint8_t) (c[3] ^ first)));
+            }
+        }
+        for (size_t i = 0; i < BLOCK_SIZE; i++) {
+            block[i] = (uint8_t) (s[i]
+                                  ^ aes->round_keys[round * BLOCK_SIZE + i]);
+        }
+    }
+}
+
+static void cbc_mac_update(const aes_t *aes,
+                           uint8_t *mac,
+                           const uint8_t *data,
+                           size_t len) {
+    while (len) {
+        size_t chunk = len < BLOCK_SIZE ? len : BLOCK_SIZE;
+        for (size_t i = 0; i < chunk; i++) {
+            mac[i] ^= data[i];
+        }
+        aes_encrypt_block(aes, mac);
+        data += chunk;
+        len -= chunk;
+    }
+}
+
+static void ccm_counter_block(uint8_t *block,
+                              const uint8_t *nonce,
+                              size_t nonce_len,
+                              uint16_t counter) {
+    memset(block, 0, BLOCK_SIZE);
+    block[0] = (uint8_t) (BLOCK_SIZE - 2 - nonce_len);
+    memcpy(block + 1, nonce, nonce_len);
+    block[BLOCK_SIZE - 2] = (uint8_t) (counter >> 8);
+    block[BLOCK_SIZE - 1] = (uint8_t) counter;
+}
+
+static void ccm_mac(const aes_t *aes,
+                    const uint8_t *nonce,
+                    size_t nonce_len,
+                    const uint8_t *aad,
+                    size_t aad_len,
+                    const uint8_t *data,
+                    size_t data_len,
+                    size_t tag_len,
+                    uint8_t *out_mac) {
+    size_t l = BLOCK_SIZE - 1 - nonce_len;
+    memset(out_mac, 0, BLOCK_SIZE);
+    out_mac[0] = (uint8_t) ((aad_len ? 0x40 : 0) | (((tag_len - 2) / 2) << 3)
+                            | (l - 1));
+    memcpy(out_mac + 1, nonce, nonce_len);
+    out_mac[BLOCK_SIZE - 2] = (uint8_t) (data_len >> 8);
+    out_mac[BLOCK_SIZE - 1] = (uint8_t) data_len;
+    aes_encrypt_block(aes, out_mac);
+    if (aad_len) {
+        // AAD is shorter than 0xFF00 bytes, its length takes 2 bytes
+        uint8_t first[BLOCK_SIZE] = { (uint8_t) (aad_len >> 8),
+                                      (uint8_t) aad_len };
+        size_t first_len = aad_len < BLOCK_SIZE - 2 ? aad_len : BLOCK_SIZE - 2;
+        memcpy(first + 2, aad, first_len);
+        cbc_mac_update(aes, out_mac, first, BLOCK_SIZE);
+        cbc_mac_update(aes, out_mac, aad + first_len, aad_len - first_len);
+    }
+    cbc_mac_update(aes, out_mac, data, data_len);
+}
+
+static void ccm_ctr(const aes_t *aes,
+                    const uint8_t *nonce,
+                    size_t nonce_len,
+                    uint8_t *data,
+                    size_t data_len) {
+    for (uint16_t counter = 1; data_len; counter++) {
+        uint8_t stream[BLOCK_SIZE];
+        ccm_counter_block(stream, nonce, nonce_len, counter);
+        aes_encrypt_block(aes, stream);
+        size_t chunk = data_len < BLOCK_SIZE ? data_len : BLOCK_SIZE;
+        for (size_t i = 0; i < chunk; i++) {
+            data[i] ^= stream[i];
+        }
+        data += chunk;
+        data_len -= chunk;
+    }
+}
+
+static void ccm_tag(const aes_t *aes,
+                    const uint8_t *nonce,
+                    size_t nonce_len,
+                    const uint8_t *mac,
+                    uint8_t *out_tag,
+                    size_t tag_len) {
+    uint8_t s0[BLOCK_SIZE];
+    ccm_counter_block(s0, nonce, nonce_len, 0);
+    aes_encrypt_block(aes, s0);
+    for (size_t i = 0; i < tag_len; i++) {
+        out_tag[i] = (uint8_t) (mac[i] ^ s0[i]);
+    }
+}
+
+static bool args_valid(size_t key_len, size_t nonce_len, size_t tag_len) {
+    return key_len == BLOCK_SIZE && nonce_len == 13 && tag_len >= 4
+           && tag_len <= BLOCK_SIZE && tag_len % 2 == 0;
+}
+
+int anj_crypto_aes_ccm_encrypt(const uint8_t *key,
+                               size_t key_len,
+                               const uint8_t *nonce,
+                               size_t nonce_len,
+                               const uint8_t *aad,
+                               size_t aad_len,
+                               uint8_t *data,
+                               size_t data_len,
+                               uint8_t *tag,
+                               size_t tag_len) {
+    if (!args_valid(key_len, nonce_len, tag_len)) {
+        return -1;
+    }
+    aes_t aes;
+    aes_init(&aes, key);
+    uint8_t mac[BLOCK_SIZE];
+    ccm_mac(&aes, nonce, nonce_len, aad, aad_len, data, data_len, tag_len,
+            mac);
+    ccm_ctr(&aes, nonce, nonce_len, data, data_len);
+    ccm_tag(&aes, nonce, nonce_len, mac, tag, tag_len);
+    return 0;
+}
+
+int anj_crypto_aes_ccm_decrypt(const uint8_t *key,
+                               size_t key_len,
+                               const uint8_t *nonce,
+                               size_t nonce_len,
+                               const uint8_t *aad,
+                               size_t aad_len,
+                               uint8_t *data,
+                               size_t data_len,
+                               const uint8_t *tag,
+                               size_t tag_len) {
+    if (!args_valid(key_len, nonce_len, tag_len)) {
+        return -1;
+    }
+    aes_t aes;
+    aes_init(&aes, key);
+    ccm_ctr(&aes, nonce, nonce_len, data, data_len);
+    uint8_t mac[BLOCK_SIZE];
+    ccm_mac(&aes, nonce, nonce_len, aad, aad_len, data, data_len, tag_len,
+            mac);
+    uint8_t expected_tag[BLOCK_SIZE];
+    ccm_tag(&aes, nonce, nonce_len, mac, expected_tag, tag_len);
+    uint8_t diff = 0;
+    for (size_t i = 0; i < tag_len; i++) {
+        diff |= (uint8_t) (expected_tag[i] ^ tag[i]);
+    }
+    return diff ? -1 : 0;
+}
+
+#endif // ANJ_WITH_OSCORE
@@ -7,10 +7,13 @@
  * See the attached LICENSE file for details.
  */
 
+#include <assert.h>
 #include <stddef.h>
 #include <string.h>
 
 #include <anj/compat/net/anj_net_api.h>
+#include <anj/compat/net/anj_sms_trigger.h>
+#include <anj/compat/net/anj_tcp.h>
 #include <anj/compat/net/anj_udp.h>
 #include <anj/utils.h>
 
@@ -46,6 +49,22 @@ void net_api_mock_force_send_failure(void) {
     g_force_send_failure = true;
 }
 
+#ifdef ANJ_WITH_SMS_TRIGGER
+static uint16_t g_sms_trigger_ssid = ANJ_ID_INVALID;
+
+void net_api_mock_sms_trigger(uint16_t ssid) {
+    g_sms_trigger_ssid = ssid;
+}
+
+bool anj_sms_trigger_received(uint16_t ssid) {
+    if (g_sms_trigger_ssid != ssid) {
+        return false;
+    }
+    g_sms_trigger_ssid = ANJ_ID_INVALID;
+    return true;
+}
+#endif // ANJ_WITH_SMS_TRIGGER
+
 int anj_udp_send(anj_net_ctx_t *ctx,
                  size_t *bytes_sent,
                  const uint8_t *buf,
@@ -69,6 +88,24 @@ int anj_udp_send(anj_net_ctx_t *ctx,
     return mock->call_result[ANJ_NET_FUN_SEND];
 }
 
+#ifdef ANJ_NET_WITH_SEND_VEC
+int anj_udp_send_vec(anj_net_ctx_t *ctx,
+                     size_t *bytes_sent,
+                     const anj_net_iovec_t *iov,
+                     size_t iov_count) {
+    net_api_mock_t *mock = (net_api_mock_t *) ctx;
+    uint8_t buf[sizeof(mock->send_data_buffer)];
+    size_t length = 0;
+    for (size_t i = 0; i < iov_count; i++) {
+        assert(length + iov[i].length <= sizeof(buf));
+        memcpy(&buf[length], iov[i].buf, iov[i].length);
+        length += iov[i].length;
+    }
+    mock->call_count[ANJ_NET_FUN_SEND_VEC]++;
+    return anj_udp_send(ctx, bytes_sent, buf, length);
+}
+#endif // ANJ_NET_WITH_SEND_VEC
+
 int anj_udp_recv(anj_net_ctx_t *ctx,
                  size_t *bytes_received,
                  uint8_t *buf,
@@ -144,3 +181,95 @@ int anj_udp_queue_mode_rx_off(anj_net_ctx_t *ctx) {
     net_api_mock_t *mock = (net_api_mock_t *) ctx;
     HANLDE_RETURN_AND_COUNT(mock, ANJ_NET_FUN_QUEUE_MODE_RX_OFF);
 }
+
+#ifdef ANJ_NET_WITH_POLL_HANDLE
+int anj_udp_get_poll_handle(anj_net_ctx_t *ctx,
+                            anj_net_poll_handle_t *out_handle,
+                            bool *out_data_pending) {
+    net_api_mock_t *mock = (net_api_mock_t *) ctx;
+    out_handle->fd = mock->poll_handle_fd;
+    *out_data_pending = mock->data_pending;
+    HANLDE_RETURN_AND_COUNT(mock, ANJ_NET_FUN_GET_POLL_HANDLE);
+}
+#endif // ANJ_NET_WITH_POLL_HANDLE
+
+#ifdef ANJ_NET_WITH_RELEASE_ASSISTANCE
+int anj_udp_release_assistance(anj_net_ctx_t *ctx,
+                               anj_net_release_hint_t hint) {
+    net_api_mock_t *mock = (net_api_mock_t *) ctx;
+    mock->release_hint = hint;
+    mock->release_hint_send_count = mock->call_count[ANJ_NET_FUN_SEND];
+    HANLDE_RETURN_AND_COUNT(mock, ANJ_NET_FUN_RELEASE_ASSISTANCE);
+}
+#endif // ANJ_NET_WITH_RELEASE_ASSISTANCE
+
+#ifdef ANJ_NET_WITH_TCP
+// the TCP binding shares the state and behavior of the UDP one
+int anj_tcp_send(anj_net_ctx_t *ctx,
+                 size_t *bytes_sent,
+                 const uint8_t *buf,
+                 size_t length) {
+    return anj_udp_send(ctx, bytes_sent, buf, length);
+}
+
+#    ifdef ANJ_NET_WITH_SEND_VEC
+int anj_tcp_send_vec(anj_net_ctx_t *ctx,
+                     size_t *bytes_sent,
+                     const anj_net_iovec_t *iov,
+                     size_t iov_count) {
+    return anj_udp_send_vec(ctx, bytes_sent, iov, iov_count);
+}
+#    endif // ANJ_NET_WITH_SEND_VEC
+
+int anj_tcp_recv(anj_net_ctx_t *ctx,
+                 size_t *bytes_received,
+                 uint8_t *buf,
+                 size_t length) {
+    return anj_udp_recv(ctx, bytes_received, buf, length);
+}
+
+int anj_tcp_create_ctx(anj_net_ctx_t **ctx, const anj_net_config_t *config) {
+    return anj_udp_create_ctx(ctx, config);
+}
+
+int anj_tcp_connect(anj_net_ctx_t *ctx,
+                    const char *hostname,
+                    const char *port) {
+    return anj_udp_connect(ctx, hostname, port);
+}
+
+int anj_tcp_close(anj_net_ctx_t *ctx) {
+    return anj_udp_close(ctx);
+}
+
+int anj_tcp_cleanup_ctx(anj_net_ctx_t **ctx) {
+    return anj_udp_cleanup_ctx(ctx);
+}
+
+int anj_tcp_get_state(anj_net_ctx_t *ctx, anj_net_socket_state_t *out_value) {
+    return anj_udp_get_state(ctx, out_value);
+}
+
+int anj_tcp_get_inner_mtu(anj_net_ctx_t *ctx, int32_t *out_value) {
+    return anj_udp_get_inner_mtu(ctx, out_value);
+}
+
+int anj_tcp_queue_mode_rx_off(anj_net_ctx_t *ctx) {
+    return anj_udp_queue_mode_rx_off(ctx);
+}
+
+#    ifdef ANJ_NET_WITH_POLL_HANDLE
+int anj_tcp_get_poll_handle(anj_net_ctx_t *ctx,
+                            anj_net_poll_handle_t *out_handle,
+                            bool *out_data_pending) {
+    return anj_udp_get_poll_handle(ctx, out_handle, out_data_pending);
+}
+#    endif // ANJ_NET_WITH_POLL_HANDLE
+
+#    ifdef ANJ_NET_WITH_RELEASE_ASSISTANCE
+int anj_tcp_release_assistance(anj_net_ctx_t *ctx,
+                               anj_net_release_hint_t hint) {
+    return anj_udp_release_assistance(ctx, hint);
+}
+#    endif // ANJ_NET_WITH_RELEASE_ASSISTANCE
+#endif // ANJ_NET_WITH_TCP
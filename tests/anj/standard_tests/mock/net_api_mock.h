@@ -26,6 +26,9 @@ typedef enum {
     ANJ_NET_FUN_GET_INNER_MTU,
     ANJ_NET_FUN_GET_STATE,
     ANJ_NET_FUN_QUEUE_MODE_RX_OFF,
+    ANJ_NET_FUN_SEND_VEC,
+    ANJ_NET_FUN_GET_POLL_HANDLE,
+    ANJ_NET_FUN_RELEASE_ASSISTANCE,
     ANJ_NET_FUN_LAST
 } anj_net_fun_t;
 
@@ -47,6 +50,15 @@ typedef struct {
     anj_net_socket_state_t state;
 
     bool dont_overwrite_buffer;
+
+    int poll_handle_fd;
+    bool data_pending;
+
+#ifdef ANJ_NET_WITH_RELEASE_ASSISTANCE
+    anj_net_release_hint_t release_hint;
+    // value of ANJ_NET_FUN_SEND call count when the hint was given
+    int release_hint_send_count;
+#endif // ANJ_NET_WITH_RELEASE_ASSISTANCE
 } net_api_mock_t;
 
 // mock pointer must be set before calling any anj_net function
@@ -56,5 +68,9 @@ void net_api_mock_ctx_init(net_api_mock_t *mock);
 void net_api_mock_dont_overwrite_buffer(anj_net_ctx_t *ctx);
 void net_api_mock_force_connection_failure(void);
 void net_api_mock_force_send_failure(void);
+#ifdef ANJ_WITH_SMS_TRIGGER
+// next anj_sms_trigger_received() call for this SSID returns true
+void net_api_mock_sms_trigger(uint16_t ssid);
+#endif // ANJ_WITH_SMS_TRIGGER
 
 #endif /* NET_API_MOCK_H */
@@ -18,6 +18,7 @@
 // as a macro therefore it can't be used as initializer here
 static anj_time_real_t mock_time_real = { { 0 } };
 static anj_time_monotonic_t mock_time_monotonic = { { 0 } };
+static size_t mock_time_monotonic_calls;
 
 void mock_time_advance(anj_time_duration_t delta) {
     mock_time_real = anj_time_real_add(mock_time_real, delta);
@@ -44,9 +45,15 @@ void mock_time_reset(void) {
     // simulate difference between clocks
     mock_time_real = anj_time_real_new(30 * 365, ANJ_TIME_UNIT_DAY);
     mock_time_monotonic = ANJ_TIME_MONOTONIC_ZERO;
+    mock_time_monotonic_calls = 0;
+}
+
+size_t mock_time_monotonic_now_calls(void) {
+    return mock_time_monotonic_calls;
 }
 
 anj_time_monotonic_t anj_time_monotonic_now(void) {
+    mock_time_monotonic_calls++;
     return mock_time_monotonic;
 }
 
@@ -10,6 +10,7 @@
 #ifndef TIME_API_MOCK_H
 #define TIME_API_MOCK_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include <anj/time.h>
@@ -21,5 +22,7 @@ void mock_time_tick(anj_time_unit_t unit);
 anj_time_monotonic_t anj_time_monotonic_now(void);
 anj_time_real_t anj_time_real_now(void);
 void mock_time_reset(void);
+// number of anj_time_monotonic_now() calls since mock_time_reset()
+size_t mock_time_monotonic_now_calls(void);
 
 #endif /* TIME_API_MOCK_H */
@@ -740,6 +740,47 @@ ANJ_UNIT_TEST(ntp, no_period_set) {
     ANJ_UNIT_ASSERT_EQUAL(g_ntp_callback_counter, 1);
 }
 
+ANJ_UNIT_TEST(ntp, next_step_time) {
+    NTP_TEST_INIT();
+    config.ntp_period_hours = 3;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_ntp_init(&anj, &ntp, &config));
+    // initial status is not reported yet
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(anj_ntp_next_step_time(&ntp),
+                                              ANJ_TIME_DURATION_ZERO));
+    anj_ntp_step(&ntp);
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(
+            anj_ntp_next_step_time(&ntp),
+            anj_time_duration_new(3, ANJ_TIME_UNIT_HOUR)));
+    mock_time_advance(anj_time_duration_new(2, ANJ_TIME_UNIT_HOUR));
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(
+            anj_ntp_next_step_time(&ntp),
+            anj_time_duration_new(1, ANJ_TIME_UNIT_HOUR)));
+
+    // step called late, synchronization is due right away
+    mock_time_advance(anj_time_duration_new(2, ANJ_TIME_UNIT_HOUR));
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(anj_ntp_next_step_time(&ntp),
+                                              ANJ_TIME_DURATION_ZERO));
+    SET_NET_MOCK_API();
+    anj_ntp_step(&ntp);
+    ANJ_UNIT_ASSERT_EQUAL(g_ntp_status, ANJ_NTP_STATUS_IN_PROGRESS);
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(anj_ntp_next_step_time(&ntp),
+                                              ANJ_TIME_DURATION_ZERO));
+    anj_ntp_step(&ntp);
+    anj_ntp_step(&ntp);
+    anj_ntp_step(&ntp);
+    anj_ntp_step(&ntp);
+    ANJ_UNIT_ASSERT_EQUAL(g_ntp_status, ANJ_NTP_STATUS_FINISHED_SUCCESSFULLY);
+    // period is counted since the start of the last synchronization
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(
+            anj_ntp_next_step_time(&ntp),
+            anj_time_duration_new(3, ANJ_TIME_UNIT_HOUR)));
+
+    // periodic synchronization disabled
+    ntp.period_hours = 0;
+    ANJ_UNIT_ASSERT_FALSE(
+            anj_time_duration_is_valid(anj_ntp_next_step_time(&ntp)));
+}
+
 // check if fractional part of NTP timestamp is handled correctly
 ANJ_UNIT_TEST(ntp, fractional_part) {
     NTP_TEST_INIT();
@@ -967,3 +1008,167 @@ ANJ_UNIT_TEST(ntp, persistence_wrong_magic) {
             anj_persistence_restore_context_create(mem_read_cb, NULL);
     ANJ_UNIT_ASSERT_EQUAL(anj_ntp_obj_restore(&ntp_2, &ctx), -1);
 }
+
+#ifdef ANJ_NTP_WITH_DRIFT_COMPENSATION
+// sends a request and receives the response after round_trip_ms
+static void exchange_sample(anj_ntp_t *ntp,
+                            net_api_mock_t *mock,
+                            uint8_t *response,
+                            uint32_t unix_time,
+                            int64_t round_trip_ms) {
+    mock->bytes_to_send = 100;
+    anj_ntp_step(ntp);
+    mock_time_advance(anj_time_duration_new(round_trip_ms, ANJ_TIME_UNIT_MS));
+    make_ntp_response(response, unix_time);
+    mock->data_to_recv = response;
+    mock->bytes_to_recv = _ANJ_NTP_MSG_SIZE;
+    anj_ntp_step(ntp);
+}
+
+static void synchronize(anj_ntp_t *ntp,
+                        net_api_mock_t *mock,
+                        uint8_t *response,
+                        uint32_t unix_time) {
+    ANJ_UNIT_ASSERT_SUCCESS(anj_ntp_start(ntp));
+    // connect
+    anj_ntp_step(ntp);
+    exchange_sample(ntp, mock, response, unix_time, 0);
+    // disconnect
+    anj_ntp_step(ntp);
+    ANJ_UNIT_ASSERT_EQUAL(g_ntp_status, ANJ_NTP_STATUS_FINISHED_SUCCESSFULLY);
+}
+
+ANJ_UNIT_TEST(ntp, burst_minimum_delay) {
+    NTP_TEST_INIT();
+    config.samples = 3;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_ntp_init(&anj, &ntp, &config));
+    ANJ_UNIT_ASSERT_FALSE(anj_time_real_is_valid(anj_ntp_time_now(&ntp)));
+
+    uint8_t response[_ANJ_NTP_MSG_SIZE];
+    uint32_t unix_time = 0x57645747;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_ntp_start(&ntp));
+    anj_ntp_step(&ntp);
+    exchange_sample(&ntp, &mock, response, unix_time, 400);
+    exchange_sample(&ntp, &mock, response, unix_time, 100);
+    ANJ_UNIT_ASSERT_EQUAL(g_ntp_status, ANJ_NTP_STATUS_IN_PROGRESS);
+    exchange_sample(&ntp, &mock, response, unix_time, 300);
+    ANJ_UNIT_ASSERT_EQUAL(g_ntp_status, ANJ_NTP_STATUS_FINISHED_SUCCESSFULLY);
+    anj_ntp_step(&ntp);
+
+    // whole burst over a single connection
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_CONNECT], 1);
+    ANJ_UNIT_ASSERT_EQUAL(mock.call_count[ANJ_NET_FUN_SEND], 3);
+    // second sample: half of its round trip, plus the time since it arrived
+    ANJ_UNIT_ASSERT_EQUAL(anj_time_real_to_scalar(g_ntp_synchronized_time,
+                                                  ANJ_TIME_UNIT_MS),
+                          (int64_t) unix_time * 1000 + 50 + 300);
+    ANJ_UNIT_ASSERT_TRUE(
+            anj_time_real_eq(anj_ntp_time_now(&ntp), g_ntp_synchronized_time));
+}
+
+ANJ_UNIT_TEST(ntp, drift_compensation) {
+    NTP_TEST_INIT();
+    config.ntp_period_hours = 1;
+    config.max_time_error = anj_time_duration_new(1, ANJ_TIME_UNIT_S);
+    ANJ_UNIT_ASSERT_SUCCESS(anj_ntp_init(&anj, &ntp, &config));
+    uint8_t response[_ANJ_NTP_MSG_SIZE];
+    uint32_t unix_time = 0x57645747;
+
+    synchronize(&ntp, &mock, response, unix_time);
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(
+            anj_ntp_next_step_time(&ntp),
+            anj_time_duration_new(1, ANJ_TIME_UNIT_HOUR)));
+
+    // local clock is fast, 4 s in 10 hours
+    mock_time_advance(anj_time_duration_new(10, ANJ_TIME_UNIT_HOUR));
+    synchronize(&ntp, &mock, response, unix_time + 36000 - 4);
+    ANJ_UNIT_ASSERT_TRUE(ntp.drift_known);
+    ANJ_UNIT_ASSERT_EQUAL(ntp.drift_ppb, -111111);
+
+    // 1 s of error is reached after 1e9 / 111111 s
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(
+            anj_ntp_next_step_time(&ntp),
+            anj_time_duration_new(9000009000, ANJ_TIME_UNIT_US)));
+
+    mock_time_advance(anj_time_duration_new(9, ANJ_TIME_UNIT_HOUR));
+    ANJ_UNIT_ASSERT_EQUAL(
+            anj_time_real_to_scalar(anj_ntp_time_now(&ntp), ANJ_TIME_UNIT_US),
+            ((int64_t) unix_time + 36000 - 4 + 32400) * 1000000 - 3599996);
+
+    // the estimate survives a restart
+    g_membuf_read_offset = 0;
+    g_membuf_write_offset = 0;
+    persistence_store(&ntp);
+    anj_t anj_2 = { 0 };
+    anj_ntp_t ntp_2;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_ntp_init(&anj_2, &ntp_2, &config));
+    persistence_restore(&ntp_2);
+    ANJ_UNIT_ASSERT_TRUE(ntp_2.drift_known);
+    ANJ_UNIT_ASSERT_EQUAL(ntp_2.drift_ppb, ntp.drift_ppb);
+    ANJ_UNIT_ASSERT_EQUAL(ntp_2.drift_uncertainty_ppb,
+                          ntp.drift_uncertainty_ppb);
+}
+
+ANJ_UNIT_TEST(ntp, persistence_version_1) {
+    INIT_ENV_PERSISTENCE();
+    anj_persistence_context_t ctx =
+            anj_persistence_store_context_create(mem_write_cb, NULL);
+    uint32_t period_hours = 7;
+    char address[] = "old.ntp.org";
+    char backup_address[] = "";
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_persistence_version(&ctx, "NTP", 3, 1, NULL));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_persistence_u32(&ctx, &period_hours));
+    ANJ_UNIT_ASSERT_SUCCESS(
+            anj_persistence_string(&ctx, address, sizeof(address)));
+    ANJ_UNIT_ASSERT_SUCCESS(anj_persistence_string(&ctx, backup_address,
+                                                   sizeof(backup_address)));
+
+    persistence_restore(&ntp);
+    ANJ_UNIT_ASSERT_EQUAL(g_membuf_read_offset, g_membuf_write_offset);
+    ANJ_UNIT_ASSERT_EQUAL(ntp.period_hours, 7);
+    ANJ_UNIT_ASSERT_EQUAL_STRING(ntp.server_address, address);
+    ANJ_UNIT_ASSERT_FALSE(ntp.drift_known);
+}
+
+#    ifdef ANJ_NTP_WITH_EXTERNAL_SAMPLES
+ANJ_UNIT_TEST(ntp, external_sample) {
+    NTP_TEST_INIT();
+    config.ntp_period_hours = 1;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_ntp_init(&anj, &ntp, &config));
+    uint8_t response[_ANJ_NTP_MSG_SIZE];
+    uint32_t unix_time = 0x57645747;
+    synchronize(&ntp, &mock, response, unix_time);
+
+    mock_time_advance(anj_time_duration_new(50, ANJ_TIME_UNIT_MIN));
+    int counter = g_ntp_callback_counter;
+    ANJ_UNIT_ASSERT_SUCCESS(anj_ntp_add_sample(
+            &ntp,
+            anj_time_real_new((int64_t) unix_time + 3000, ANJ_TIME_UNIT_S),
+            anj_time_duration_new(200, ANJ_TIME_UNIT_MS)));
+    ANJ_UNIT_ASSERT_EQUAL(g_ntp_callback_counter, counter + 1);
+    ANJ_UNIT_ASSERT_EQUAL(g_ntp_status, ANJ_NTP_STATUS_FINISHED_SUCCESSFULLY);
+    ANJ_UNIT_ASSERT_EQUAL(anj_time_real_to_scalar(g_ntp_synchronized_time,
+                                                  ANJ_TIME_UNIT_MS),
+                          ((int64_t) unix_time + 3000) * 1000 + 100);
+    ANJ_UNIT_ASSERT_TRUE(
+            anj_time_real_eq(anj_ntp_time_now(&ntp), g_ntp_synchronized_time));
+    // the periodic synchronization is postponed
+    ANJ_UNIT_ASSERT_TRUE(anj_time_duration_eq(
+            anj_ntp_next_step_time(&ntp),
+            anj_time_duration_new(1, ANJ_TIME_UNIT_HOUR)));
+    mock_time_advance(anj_time_duration_new(50, ANJ_TIME_UNIT_MIN));
+    anj_ntp_step(&ntp);
+    ANJ_UNIT_ASSERT_EQUAL(g_ntp_callback_counter, counter + 1);
+
+    // samples are ignored during an NTP exchange
+    ANJ_UNIT_ASSERT_SUCCESS(anj_ntp_start(&ntp));
+    ANJ_UNIT_ASSERT_EQUAL(
+            anj_ntp_add_sample(&ntp,
+                               anj_time_real_new((int64_t) unix_time,
+                                                 ANJ_TIME_UNIT_S),
+                               ANJ_TIME_DURATION_ZERO),
+            ANJ_NTP_ERR_IN_PROGRESS);
+}
+#    endif // ANJ_NTP_WITH_EXTERNAL_SAMPLES
+#endif // ANJ_NTP_WITH_DRIFT_COMPENSATION
@@ -0,0 +1,210 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define ANJ_UNIT_ENABLE_SHORT_ASSERTS
+#include <anj/anj_config.h>
+#include <anj/compat/time.h>
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/dm/core.h>
+#include <anj/utils.h>
+
+#include "../../../../src/anj/coap/coap.h"
+#include "../../../../src/anj/dm/dm_io.h"
+#include "../../../../src/anj/exchange.h"
+#include "../../../../src/anj/observe/observe.h"
+
+#include "../mock/time_api_mock.h"
+
+#include <anj_unit_test.h>
+
+#ifdef ANJ_OBSERVE_WITH_CON_POLICY
+
+static double res_value;
+
+static int res_read(anj_t *anj,
+                    const anj_dm_obj_t *obj,
+                    anj_iid_t iid,
+                    anj_rid_t rid,
+                    anj_riid_t riid,
+                    anj_res_value_t *out_value) {
+    (void) anj;
+    (void) obj;
+    (void) iid;
+    (void) rid;
+    (void) riid;
+    out_value->double_value = res_value;
+    return 0;
+}
+
+static anj_dm_handlers_t handlers = {
+    .res_read = res_read
+};
+static anj_dm_res_t res = {
+    .rid = 1,
+    .kind = ANJ_DM_RES_R,
+    .type = ANJ_DATA_TYPE_DOUBLE
+};
+static anj_dm_obj_inst_t inst = {
+    .iid = 0,
+    .res_count = 1,
+    .resources = &res
+};
+static anj_dm_obj_t obj = {
+    .oid = 3,
+    .insts = &inst,
+    .max_inst_count = 1,
+    .handlers = &handlers
+};
+
+static anj_t anj;
+static _anj_observe_server_state_t srv;
+static uint8_t payload[512];
+
+static void init(const _anj_attr_notification_t *attr) {
+    mock_time_reset();
+    memset(&anj, 0, sizeof(anj));
+    _anj_exchange_init(&anj.exchange_ctx);
+    _anj_dm_initialize(&anj);
+    ASSERT_OK(anj_dm_add_obj(&anj, &obj));
+    _anj_observe_init(&anj);
+    srv = (_anj_observe_server_state_t) {
+        .ssid = 1
+    };
+    res_value = 0.0;
+
+    _anj_observe_observation_t *observation = &anj.observe_ctx.observations[0];
+    observation->ssid = 1;
+    observation->token.bytes[0] = 0x21;
+    observation->token.size = 1;
+    observation->path = ANJ_MAKE_RESOURCE_PATH(3, 0, 1);
+    observation->effective_attr = *attr;
+    observation->observe_active = true;
+    observation->last_notify_timestamp = anj_time_monotonic_now();
+    observation->next_conf_notify_timestamp = anj_time_monotonic_add(
+            anj_time_monotonic_now(),
+            anj_time_duration_new(ANJ_OBSERVE_CON_POLICY_MAX_INTERVAL_S,
+                                  ANJ_TIME_UNIT_S));
+}
+
+static void value_changed(double value) {
+    res_value = value;
+    ASSERT_OK(anj_observe_data_model_changed(
+            &anj, &ANJ_MAKE_RESOURCE_PATH(3, 0, 1),
+            ANJ_OBSERVE_CHANGE_TYPE_VALUE_CHANGED, 0));
+}
+
+static void no_notification(void) {
+    _anj_exchange_handlers_t out_handlers = { 0 };
+    _anj_coap_msg_t out_msg = { 0 };
+    ASSERT_OK(_anj_observe_process(&anj, &out_handlers, &srv, &out_msg));
+    ASSERT_EQ(out_msg.token.size, 0);
+}
+
+// creates the notification and completes its exchange
+static void check_notification(bool confirmable) {
+    _anj_exchange_handlers_t out_handlers = { 0 };
+    _anj_coap_msg_t out_msg = { 0 };
+    ASSERT_OK(_anj_observe_process(&anj, &out_handlers, &srv, &out_msg));
+    ASSERT_EQ(out_msg.token.size, 1);
+    ASSERT_EQ(out_msg.operation, confirmable ? ANJ_OP_INF_CON_NOTIFY
+                                             : ANJ_OP_INF_NON_CON_NOTIFY);
+
+    ASSERT_EQ(_anj_exchange_new_client_request(&anj.exchange_ctx, &out_msg,
+                                               &out_handlers, payload,
+                                               sizeof(payload)),
+              ANJ_EXCHANGE_STATE_MSG_TO_SEND);
+    ASSERT_EQ(_anj_exchange_process(&anj.exchange_ctx,
+                                    ANJ_EXCHANGE_EVENT_SEND_CONFIRMATION,
+                                    &out_msg),
+              confirmable ? ANJ_EXCHANGE_STATE_WAITING_MSG
+                          : ANJ_EXCHANGE_STATE_FINISHED);
+    if (confirmable) {
+        out_msg.operation = ANJ_OP_RESPONSE;
+        out_msg.msg_code = ANJ_COAP_CODE_EMPTY;
+        out_msg.payload_size = 0;
+        out_msg.coap_binding_data.type = ANJ_COAP_UDP_TYPE_ACKNOWLEDGEMENT;
+        ASSERT_EQ(_anj_exchange_process(&anj.exchange_ctx,
+                                        ANJ_EXCHANGE_EVENT_NEW_MSG, &out_msg),
+                  ANJ_EXCHANGE_STATE_FINISHED);
+    }
+}
+
+#    if ANJ_OBSERVE_CON_POLICY_EVERY_N > 0
+ANJ_UNIT_TEST(notification_con_policy, every_nth_notification_is_confirmable) {
+    _anj_attr_notification_t attr = {
+        .has_max_period = true,
+        .max_period = 10
+    };
+    init(&attr);
+    for (int i = 1; i <= 3 * ANJ_OBSERVE_CON_POLICY_EVERY_N; i++) {
+        mock_time_advance(anj_time_duration_new(10, ANJ_TIME_UNIT_S));
+        check_notification(i % ANJ_OBSERVE_CON_POLICY_EVERY_N == 0);
+    }
+}
+#    endif // ANJ_OBSERVE_CON_POLICY_EVERY_N > 0
+
+ANJ_UNIT_TEST(notification_con_policy, max_interval_forces_confirmable) {
+    const int64_t max_period = ANJ_OBSERVE_CON_POLICY_MAX_INTERVAL_S * 2 / 3;
+    _anj_attr_notification_t attr = {
+        .has_max_period = true,
+        .max_period = (uint32_t) max_period
+    };
+    init(&attr);
+    mock_time_advance(anj_time_duration_new(max_period, ANJ_TIME_UNIT_S));
+    check_notification(false);
+    // interval is counted from the last Confirmable notification
+    mock_time_advance(anj_time_duration_new(max_period, ANJ_TIME_UNIT_S));
+    check_notification(true);
+    mock_time_advance(anj_time_duration_new(max_period, ANJ_TIME_UNIT_S));
+    check_notification(false);
+    mock_time_advance(anj_time_duration_new(max_period, ANJ_TIME_UNIT_S));
+    check_notification(true);
+}
+
+ANJ_UNIT_TEST(notification_con_policy, threshold_crossing_forces_confirmable) {
+    _anj_attr_notification_t attr = {
+        .has_greater_than = true,
+        .greater_than = 10.0,
+        .has_step = true,
+        .step = 3.0
+    };
+    init(&attr);
+    value_changed(20.0);
+    check_notification(true);
+    // step condition alone doesn't force Confirmable notification
+    value_changed(24.0);
+    check_notification(false);
+    value_changed(25.0);
+    no_notification();
+    value_changed(5.0);
+    check_notification(true);
+}
+
+#    ifdef ANJ_WITH_LWM2M12
+ANJ_UNIT_TEST(notification_con_policy, con_attribute_is_respected) {
+    _anj_attr_notification_t attr = {
+        .has_max_period = true,
+        .max_period = 10,
+        .has_con = true,
+        .con = 1
+    };
+    init(&attr);
+    for (int i = 0; i < 3; i++) {
+        mock_time_advance(anj_time_duration_new(10, ANJ_TIME_UNIT_S));
+        check_notification(true);
+    }
+}
+#    endif // ANJ_WITH_LWM2M12
+
+#endif // ANJ_OBSERVE_WITH_CON_POLICY
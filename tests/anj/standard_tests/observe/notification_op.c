@@ -39,6 +39,9 @@
 static double get_res_value_double = 0;
 static bool get_res_value_bool = 0;
 static int res_read_ret_val = 0;
+static int res_read_call_count = 0;
+static bool res_read_int = false;
+static int64_t get_res_value_int = 0;
 
 static int res_read(anj_t *anj,
                     const anj_dm_obj_t *obj,
@@ -51,8 +54,11 @@ static int res_read(anj_t *anj,
     (void) iid;
     (void) riid;
 
+    res_read_call_count++;
     if (rid == 0) {
         out_value->bool_value = get_res_value_bool;
+    } else if (res_read_int) {
+        out_value->int_value = get_res_value_int;
     } else {
         out_value->double_value = get_res_value_double;
     }
@@ -1210,6 +1216,433 @@ ANJ_UNIT_TEST(notification_op, time_to_next_call_different_max_period) {
     anj_process(ANJ_TIME_DURATION_ZERO, 0x22, 1);
 }
 
+#    if defined(ANJ_OBSERVE_WITH_NOTIFICATION_COALESCING) \
+            && ANJ_OBSERVE_NOTIFICATION_COALESCING_WINDOW_S >= 3
+ANJ_UNIT_TEST(notification_op, coalescing_different_max_period) {
+    NOTIFICATION_INIT();
+    INIT_OBSERVE_MODULE();
+    setup_observations(&anj.observe_ctx,
+                       (anj_uri_path_t[3]){ ANJ_MAKE_RESOURCE_PATH(3, 0, 1),
+                                            ANJ_MAKE_RESOURCE_PATH(3, 0, 1),
+                                            ANJ_MAKE_RESOURCE_PATH(3, 0, 1) },
+                       3,
+                       &(_anj_attr_notification_t) {
+                           .has_max_period = true,
+                           .max_period = 10
+                       });
+    anj.observe_ctx.observations[1].effective_attr.max_period = 12;
+    anj.observe_ctx.observations[2].effective_attr.max_period = 100;
+
+    mock_time_advance(anj_time_duration_new(10000, ANJ_TIME_UNIT_MS));
+    anj_process(ANJ_TIME_DURATION_ZERO, 0x21, 1);
+    anj_exchange(false);
+    check_out_buff(false, 0x21, 1);
+
+    // pmax of the second observation expires within the window
+    anj_process(ANJ_TIME_DURATION_ZERO, 0x22, 1);
+    anj_exchange(false);
+    check_out_buff(false, 0x22, 1);
+
+    // the window is closed when there is nothing more to send
+    anj_process(anj_time_duration_new(10000, ANJ_TIME_UNIT_MS), 0, 0);
+    mock_time_advance(anj_time_duration_new(10000, ANJ_TIME_UNIT_MS));
+    anj_process(ANJ_TIME_DURATION_ZERO, 0x21, 1);
+    anj_exchange(false);
+    check_out_buff(false, 0x21, 2);
+    anj_process(ANJ_TIME_DURATION_ZERO, 0x22, 1);
+    anj_exchange(false);
+    check_out_buff(false, 0x22, 2);
+    anj_process(anj_time_duration_new(10000, ANJ_TIME_UNIT_MS), 0, 0);
+}
+#    endif // defined(ANJ_OBSERVE_WITH_NOTIFICATION_COALESCING) &&
+           // ANJ_OBSERVE_NOTIFICATION_COALESCING_WINDOW_S >= 3
+
+#    ifdef ANJ_OBSERVE_WITH_VALUE_CACHE
+ANJ_UNIT_TEST(notification_op, value_cache) {
+    NOTIFICATION_INIT();
+    INIT_OBSERVE_MODULE();
+    anj_uri_path_t paths[] = { ANJ_MAKE_RESOURCE_PATH(3, 0, 1) };
+    srv.default_max_period = 0;
+    set_res_value_double(0.0);
+    setup_observations(&anj.observe_ctx, paths, ANJ_ARRAY_SIZE(paths),
+                       &(_anj_attr_notification_t) {
+                           .has_min_period = true,
+                           .min_period = 10,
+                           .has_greater_than = true,
+                           .greater_than = 10
+                       });
+    anj_process(ANJ_TIME_DURATION_INVALID, 0, 0);
+
+    // value read while checking the attributes is used for the notification
+    mock_time_advance(anj_time_duration_new(10000, ANJ_TIME_UNIT_MS));
+    res_read_call_count = 0;
+    set_res_value_double(20.0);
+    ASSERT_OK(anj_observe_data_model_changed(
+            &anj, &ANJ_MAKE_RESOURCE_PATH(3, 0, 1),
+            ANJ_OBSERVE_CHANGE_TYPE_VALUE_CHANGED, 0));
+    anj_process(ANJ_TIME_DURATION_ZERO, 0x21, 1);
+    anj_exchange(false);
+    check_out_buff(false, 0x21, 1);
+    ASSERT_EQ(res_read_call_count, 1);
+    ASSERT_EQ(anj.observe_ctx.observations[0].last_sent_value.double_value,
+              20.0);
+    ASSERT_FALSE(anj.observe_ctx.observations[0].has_cached_value);
+
+    // another change before pmin expires drops the cached value
+    set_res_value_double(5.0);
+    ASSERT_OK(anj_observe_data_model_changed(
+            &anj, &ANJ_MAKE_RESOURCE_PATH(3, 0, 1),
+            ANJ_OBSERVE_CHANGE_TYPE_VALUE_CHANGED, 0));
+    ASSERT_TRUE(anj.observe_ctx.observations[0].has_cached_value);
+    set_res_value_double(6.0);
+    ASSERT_OK(anj_observe_data_model_changed(
+            &anj, &ANJ_MAKE_RESOURCE_PATH(3, 0, 1),
+            ANJ_OBSERVE_CHANGE_TYPE_VALUE_CHANGED, 0));
+    ASSERT_FALSE(anj.observe_ctx.observations[0].has_cached_value);
+    res_read_call_count = 0;
+    mock_time_advance(anj_time_duration_new(10000, ANJ_TIME_UNIT_MS));
+    anj_process(ANJ_TIME_DURATION_ZERO, 0x21, 1);
+    anj_exchange(false);
+    ASSERT_EQ(res_read_call_count, 2);
+    ASSERT_EQ(anj.observe_ctx.observations[0].last_sent_value.double_value,
+              6.0);
+}
+
+ANJ_UNIT_TEST(notification_op, value_cache_with_instance_observation) {
+    NOTIFICATION_INIT();
+    INIT_OBSERVE_MODULE();
+    anj_uri_path_t paths[] = { ANJ_MAKE_RESOURCE_PATH(3, 0, 1),
+                               ANJ_MAKE_INSTANCE_PATH(3, 0) };
+    srv.default_max_period = 0;
+    set_res_value_double(0.0);
+    setup_observations(&anj.observe_ctx, paths, ANJ_ARRAY_SIZE(paths),
+                       &(_anj_attr_notification_t) {
+                           .has_greater_than = true,
+                           .greater_than = 10
+                       });
+    anj.observe_ctx.observations[1].effective_attr =
+            (_anj_attr_notification_t) { 0 };
+    anj_process(ANJ_TIME_DURATION_INVALID, 0, 0);
+
+    // value of /3/0/1 must not be used for Resources of /3/0
+    res_read_call_count = 0;
+    set_res_value_double(20.0);
+    set_res_value_bool(true);
+    ASSERT_OK(anj_observe_data_model_changed(
+            &anj, &ANJ_MAKE_RESOURCE_PATH(3, 0, 1),
+            ANJ_OBSERVE_CHANGE_TYPE_VALUE_CHANGED, 0));
+    ASSERT_EQ(res_read_call_count, 1);
+    ASSERT_TRUE(anj.observe_ctx.observations[0].has_cached_value);
+    ASSERT_FALSE(anj.observe_ctx.observations[1].has_cached_value);
+    ASSERT_TRUE(anj.observe_ctx.observations[1].notification_to_send);
+
+    anj_process(ANJ_TIME_DURATION_ZERO, 0x21, 1);
+    anj_exchange(false);
+    check_out_buff(false, 0x21, 1);
+    ASSERT_EQ(res_read_call_count, 1);
+    ASSERT_NULL(anj.dm.cached_read_value);
+
+    anj_process(ANJ_TIME_DURATION_ZERO, 0x22, 1);
+    anj_exchange(false);
+    check_out_buff(false, 0x22, 1);
+    // both Resources of /3/0 are read from the data model
+    ASSERT_EQ(res_read_call_count, 3);
+}
+#    endif // ANJ_OBSERVE_WITH_VALUE_CACHE
+
+#    ifdef ANJ_OBSERVE_WITH_EVALUATION_SCHEDULER
+ANJ_UNIT_TEST(notification_op, evaluation_scheduler) {
+    NOTIFICATION_INIT();
+    INIT_OBSERVE_MODULE();
+    inst_0.res_count = 3;
+    srv.default_max_period = 0;
+    anj_uri_path_t paths[] = { ANJ_MAKE_RESOURCE_PATH(3, 0, 1),
+                               ANJ_MAKE_RESOURCE_PATH(3, 0, 1),
+                               ANJ_MAKE_RESOURCE_PATH(3, 0, 2) };
+    setup_observations(&anj.observe_ctx, paths, ANJ_ARRAY_SIZE(paths),
+                       &(_anj_attr_notification_t) {
+                           .has_greater_than = true,
+                           .greater_than = 10,
+                           .has_max_eval_period = true,
+                           .max_eval_period = 5
+                       });
+    anj.observe_ctx.observations[2].effective_attr.max_eval_period = 100;
+    anj.observe_ctx.observations[2].effective_attr.has_min_eval_period = true;
+    anj.observe_ctx.observations[2].effective_attr.min_eval_period = 2;
+    anj_process(anj_time_duration_new(5000, ANJ_TIME_UNIT_MS), 0, 0);
+
+    // epmax expired, value is sampled without anj_observe_data_model_changed()
+    // call, Resource observed twice is read once, and the third Observation is
+    // evaluated as well because its epmin has already elapsed
+    mock_time_advance(anj_time_duration_new(5000, ANJ_TIME_UNIT_MS));
+    res_read_call_count = 0;
+    set_res_value_double(5.0);
+    anj_process(ANJ_TIME_DURATION_ZERO, 0, 0);
+    ASSERT_EQ(res_read_call_count, 2);
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(paths); i++) {
+        ASSERT_TRUE(anj_time_monotonic_eq(
+                anj.observe_ctx.observations[i].last_eval_timestamp,
+                anj_time_monotonic_now()));
+        ASSERT_FALSE(anj.observe_ctx.observations[i].notification_to_send);
+    }
+    anj_process(anj_time_duration_new(5000, ANJ_TIME_UNIT_MS), 0, 0);
+    ASSERT_EQ(res_read_call_count, 2);
+
+    // change reported by the application postpones the sampling
+    mock_time_advance(anj_time_duration_new(2000, ANJ_TIME_UNIT_MS));
+    ASSERT_OK(anj_observe_data_model_changed(
+            &anj, &ANJ_MAKE_RESOURCE_PATH(3, 0, 1),
+            ANJ_OBSERVE_CHANGE_TYPE_VALUE_CHANGED, 0));
+    anj_process(anj_time_duration_new(5000, ANJ_TIME_UNIT_MS), 0, 0);
+
+    // threshold crossed between the samples
+    mock_time_advance(anj_time_duration_new(5000, ANJ_TIME_UNIT_MS));
+    res_read_call_count = 0;
+    set_res_value_double(20.0);
+    anj_process(ANJ_TIME_DURATION_ZERO, 0x21, 1);
+    anj_exchange(false);
+    check_out_buff(false, 0x21, 1);
+    ASSERT_TRUE(anj.observe_ctx.observations[1].notification_to_send);
+    ASSERT_TRUE(anj.observe_ctx.observations[2].notification_to_send);
+}
+#    endif // ANJ_OBSERVE_WITH_EVALUATION_SCHEDULER
+
+#    ifdef ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+ANJ_UNIT_TEST(notification_op, historical_queue_encoding) {
+    _anj_observe_historical_queue_t queue;
+    _anj_observe_historical_queue_reset(&queue);
+    int64_t int_values[] = { 1000, 1001, -5, INT64_MAX, INT64_MIN, 0 };
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(int_values); i++) {
+        ASSERT_OK(_anj_observe_historical_queue_add(
+                &queue, 10, 100 + 10 * (int64_t) i, ANJ_DATA_TYPE_INT,
+                &(_anj_observation_res_val_t) {
+                    .int_value = int_values[i]
+                }));
+    }
+    ASSERT_EQ(queue.count, ANJ_ARRAY_SIZE(int_values));
+    // time deltas take a single byte, value deltas of 1 and -1006 take one
+    // and two bytes, and the wrapping ones between extreme values take ten
+    ASSERT_EQ(queue.size, 2 + 3 + 11 + 2 + 11);
+
+    _anj_observe_historical_queue_iter_t iter;
+    int64_t timestamp_s;
+    _anj_observation_res_val_t value;
+    _anj_observe_historical_queue_iter_init(&iter);
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(int_values); i++) {
+        ASSERT_OK(_anj_observe_historical_queue_next(&queue, &iter,
+                                                     &timestamp_s, &value));
+        ASSERT_EQ(timestamp_s, 100 + 10 * (int64_t) i);
+        ASSERT_EQ(value.int_value, int_values[i]);
+    }
+    ASSERT_FAIL(_anj_observe_historical_queue_next(&queue, &iter,
+                                                   &timestamp_s, &value));
+
+    // type change clears the queue, hqmax bound drops the oldest samples
+    double double_values[] = { 21.5, 21.5, 21.75, -3.0e100, 0.1 };
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(double_values); i++) {
+        ASSERT_OK(_anj_observe_historical_queue_add(
+                &queue, 3, 200 + (int64_t) i, ANJ_DATA_TYPE_DOUBLE,
+                &(_anj_observation_res_val_t) {
+                    .double_value = double_values[i]
+                }));
+    }
+    ASSERT_EQ(queue.count, 3);
+    _anj_observe_historical_queue_iter_init(&iter);
+    for (size_t i = 2; i < ANJ_ARRAY_SIZE(double_values); i++) {
+        ASSERT_OK(_anj_observe_historical_queue_next(&queue, &iter,
+                                                     &timestamp_s, &value));
+        ASSERT_EQ(timestamp_s, 200 + (int64_t) i);
+        ASSERT_EQ(value.double_value, double_values[i]);
+    }
+
+    // samples that are being sent are not dropped
+    queue.sent_count = 3;
+    ASSERT_FAIL(_anj_observe_historical_queue_add(
+            &queue, 3, 210, ANJ_DATA_TYPE_DOUBLE,
+            &(_anj_observation_res_val_t) {
+                .double_value = 1.0
+            }));
+    _anj_observe_historical_queue_drop(&queue, 2);
+    ASSERT_EQ(queue.count, 1);
+    ASSERT_EQ(queue.sent_count, 1);
+    ASSERT_EQ(queue.first_timestamp_s, 204);
+    ASSERT_EQ(queue.first_value.double_value, 0.1);
+    ASSERT_EQ(queue.size, 0);
+
+    // oldest samples are dropped when the buffer is full
+    _anj_observe_historical_queue_reset(&queue);
+    size_t added = 0;
+    while (queue.count == added) {
+        ASSERT_OK(_anj_observe_historical_queue_add(
+                &queue, UINT32_MAX, (int64_t) added, ANJ_DATA_TYPE_UINT,
+                &(_anj_observation_res_val_t) {
+                    .uint_value = (added % 2) ? UINT64_MAX : 0
+                }));
+        added++;
+    }
+    ASSERT_TRUE(queue.size <= ANJ_OBSERVE_HISTORICAL_QUEUE_BUFFER_SIZE);
+    ASSERT_EQ(queue.last_timestamp_s, (int64_t) added - 1);
+    _anj_observe_historical_queue_iter_init(&iter);
+    ASSERT_OK(_anj_observe_historical_queue_next(&queue, &iter, &timestamp_s,
+                                                 &value));
+    ASSERT_EQ(timestamp_s, (int64_t) (added - queue.count));
+}
+
+ANJ_UNIT_TEST(notification_op, historical_queue_notification) {
+    NOTIFICATION_INIT();
+    INIT_OBSERVE_MODULE();
+    anj_uri_path_t paths[] = { ANJ_MAKE_RESOURCE_PATH(3, 0, 1) };
+    setup_observations(&anj.observe_ctx, paths, ANJ_ARRAY_SIZE(paths),
+                       &(_anj_attr_notification_t) {
+                           .has_greater_than = true,
+                           .greater_than = 100,
+                           .has_max_period = true,
+                           .max_period = 10,
+                           .has_hqmax = true,
+                           .hqmax = 2
+                       });
+    _anj_observe_historical_queue_t *queue =
+            &anj.observe_ctx.observations[0].historical_queue;
+    anj_process(anj_time_duration_new(10000, ANJ_TIME_UNIT_MS), 0, 0);
+
+    // values that don't trigger a notification are recorded
+    for (int i = 1; i <= 3; i++) {
+        mock_time_advance(anj_time_duration_new(1000, ANJ_TIME_UNIT_MS));
+        set_res_value_double(i);
+        ASSERT_OK(anj_observe_data_model_changed(
+                &anj, &paths[0], ANJ_OBSERVE_CHANGE_TYPE_VALUE_CHANGED, 0));
+        ASSERT_FALSE(anj.observe_ctx.observations[0].notification_to_send);
+    }
+    ASSERT_EQ(queue->count, 2);
+    ASSERT_EQ(queue->first_value.double_value, 2.0);
+    ASSERT_EQ(queue->last_value.double_value, 3.0);
+
+    // notification contains queued samples and the current value, the oldest
+    // one is dropped because of hqmax
+    mock_time_advance(anj_time_duration_new(7000, ANJ_TIME_UNIT_MS));
+    set_res_value_double(4.0);
+    anj_process(ANJ_TIME_DURATION_ZERO, 0x21, 1);
+    ASSERT_EQ(queue->count, 2);
+    ASSERT_EQ(queue->sent_count, 2);
+    ASSERT_EQ(queue->first_value.double_value, 3.0);
+    ASSERT_EQ(queue->last_value.double_value, 4.0);
+    // queued values are encoded without a data model operation
+    ASSERT_EQ(_anj_exchange_new_client_request(&anj.exchange_ctx, &out_msg,
+                                               &out_handlers, payload,
+                                               payload_buff_size),
+              ANJ_EXCHANGE_STATE_MSG_TO_SEND);
+    ASSERT_FALSE(anj_core_ongoing_operation(&anj));
+    ASSERT_EQ(_anj_exchange_process(&anj.exchange_ctx,
+                                    ANJ_EXCHANGE_EVENT_SEND_CONFIRMATION,
+                                    &out_msg),
+              ANJ_EXCHANGE_STATE_FINISHED);
+    ASSERT_EQ(out_msg.content_format, _ANJ_COAP_FORMAT_SENML_CBOR);
+    // array of two records
+    ASSERT_EQ(out_msg.payload[0], 0x82);
+    ASSERT_EQ(queue->count, 0);
+    ASSERT_EQ(queue->sent_count, 0);
+    ASSERT_FALSE(anj.observe_ctx.historical_notification);
+}
+#    endif // ANJ_OBSERVE_WITH_HISTORICAL_QUEUE
+
+#    ifdef ANJ_OBSERVE_WITH_INTEGER_THRESHOLDS
+#        define INTEGER_THRESHOLD_CHANGE(Value, Expected)                   \
+            get_res_value_int = Value;                                      \
+            ASSERT_OK(anj_observe_data_model_changed(                       \
+                    &anj, &ANJ_MAKE_RESOURCE_PATH(3, 0, 1),                 \
+                    ANJ_OBSERVE_CHANGE_TYPE_VALUE_CHANGED, 0));             \
+            ASSERT_EQ(anj.observe_ctx.observations[0].notification_to_send, \
+                      Expected);                                            \
+            anj.observe_ctx.observations[0].notification_to_send = false;   \
+            anj.observe_ctx.observations[0].last_sent_value.int_value = Value;
+
+ANJ_UNIT_TEST(notification_op, integer_thresholds) {
+    NOTIFICATION_INIT();
+    INIT_OBSERVE_MODULE();
+    inst_0_res[1].type = ANJ_DATA_TYPE_INT;
+    res_read_int = true;
+    get_res_value_int = 0;
+    anj_uri_path_t paths[] = { ANJ_MAKE_RESOURCE_PATH(3, 0, 1) };
+    setup_observations(&anj.observe_ctx, paths, ANJ_ARRAY_SIZE(paths),
+                       &(_anj_attr_notification_t) {
+                           .has_greater_than = true,
+                           .greater_than = 10.5,
+                           .has_less_than = true,
+                           .less_than = -3.0,
+                           .has_step = true,
+                           .step = 6.5
+                       });
+    _anj_observe_verify_effective_attributes(&anj.observe_ctx.observations[0]);
+    ASSERT_EQ(anj.observe_ctx.observations[0].int_attr.greater_than_floor, 10);
+    ASSERT_EQ(anj.observe_ctx.observations[0].int_attr.greater_than_ceil, 11);
+    ASSERT_EQ(anj.observe_ctx.observations[0].int_attr.less_than_floor, -3);
+    ASSERT_EQ(anj.observe_ctx.observations[0].int_attr.less_than_ceil, -3);
+    ASSERT_EQ(anj.observe_ctx.observations[0].int_attr.step_ceil, 7);
+    ASSERT_TRUE(anj.observe_ctx.observations[0].observe_active);
+
+    INTEGER_THRESHOLD_CHANGE(6, false);
+    INTEGER_THRESHOLD_CHANGE(10, false);
+    // gt crossed
+    INTEGER_THRESHOLD_CHANGE(11, true);
+    INTEGER_THRESHOLD_CHANGE(10, true);
+    // st reached
+    INTEGER_THRESHOLD_CHANGE(3, true);
+    // lt equal to the value is not crossed
+    INTEGER_THRESHOLD_CHANGE(-3, false);
+    INTEGER_THRESHOLD_CHANGE(-4, true);
+    INTEGER_THRESHOLD_CHANGE(-3, false);
+    INTEGER_THRESHOLD_CHANGE(-2, true);
+
+    inst_0_res[1].type = ANJ_DATA_TYPE_DOUBLE;
+    res_read_int = false;
+}
+#    endif // ANJ_OBSERVE_WITH_INTEGER_THRESHOLDS
+
+#    ifdef ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER
+ANJ_UNIT_TEST(notification_op, notify_store_when_offline) {
+    NOTIFICATION_INIT();
+    INIT_OBSERVE_MODULE();
+    anj_io_out_entry_t records[2];
+    _anj_observe_notify_store_set_buffer(&anj, records, ANJ_ARRAY_SIZE(records));
+    srv.notify_store = true;
+    srv.is_server_online = false;
+
+    anj_uri_path_t paths[] = { ANJ_MAKE_RESOURCE_PATH(3, 0, 1) };
+    setup_observations(&anj.observe_ctx, paths, ANJ_ARRAY_SIZE(paths),
+                       &(_anj_attr_notification_t) {
+                           .has_max_period = true,
+                           .max_period = 10
+                       });
+
+    // values are recorded instead of being sent
+    for (int i = 1; i <= 3; i++) {
+        mock_time_advance(anj_time_duration_new(10000, ANJ_TIME_UNIT_MS));
+        set_res_value_double(i);
+        anj_process(ANJ_TIME_DURATION_ZERO, 0, 0);
+        anj_process(anj_time_duration_new(10000, ANJ_TIME_UNIT_MS), 0, 0);
+    }
+
+    // the oldest value is overwritten
+    ASSERT_EQ(anj.observe_ctx.notify_store.count, 2);
+    ASSERT_EQ(anj.observe_ctx.notify_store.first, 1);
+    ASSERT_TRUE(anj_uri_path_equal(&records[0].path, &paths[0]));
+    ASSERT_EQ(records[0].type, ANJ_DATA_TYPE_DOUBLE);
+    ASSERT_EQ(records[0].value.double_value, 3.0);
+    ASSERT_EQ(records[1].value.double_value, 2.0);
+
+    // flush is not possible if the client is not registered
+    _anj_observe_notify_store_flush(&anj);
+    ASSERT_EQ(anj.observe_ctx.notify_store.count, 2);
+    ASSERT_EQ(anj.observe_ctx.notify_store.flushed_count, 0);
+
+    // notifications are sent as usual when the server is online
+    srv.is_server_online = true;
+    mock_time_advance(anj_time_duration_new(10000, ANJ_TIME_UNIT_MS));
+    anj_process(ANJ_TIME_DURATION_ZERO, 0x21, 1);
+    ASSERT_EQ(anj.observe_ctx.notify_store.count, 2);
+}
+#    endif // ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER
+
 // check if we get correct time_to_next_call when there are two observations
 // with and without max period attribute, max_period for latter one goes from
 // server object instance
@@ -1641,7 +2074,7 @@ ANJ_UNIT_TEST(notification_op, con_notification_exchange_timeout) {
 
     // set custom UDP transmission parameters to speed up the test
     anj_exchange_udp_tx_params_t udp_tx_params = {
-        .ack_random_factor = 1.1,
+        .ack_random_factor = ANJ_ACK_RANDOM_FACTOR(1.1),
         .ack_timeout = anj_time_duration_new(1, ANJ_TIME_UNIT_S),
         .max_retransmit = 1
     };
@@ -1941,7 +2374,12 @@ ANJ_UNIT_TEST(notification_comp_op, notification_confirmable_after_24h) {
     CHECK_COMPOSITE_OBSERVATION(true, 2, true);
     check_out_buff(true, 0x22, 2);
 
+#        ifdef ANJ_OBSERVE_WITH_COMPOSITE_DELTA_NOTIFICATIONS
+    // pmax of paths not included in the last notification expires earlier
+    anj_process(anj_time_duration_new(5000 - 123, ANJ_TIME_UNIT_MS), 0, 0);
+#        else  // ANJ_OBSERVE_WITH_COMPOSITE_DELTA_NOTIFICATIONS
     anj_process(anj_time_duration_new(5000, ANJ_TIME_UNIT_MS), 0, 0);
+#        endif // ANJ_OBSERVE_WITH_COMPOSITE_DELTA_NOTIFICATIONS
 
     mock_time_advance(anj_time_duration_new(6000 - 123, ANJ_TIME_UNIT_MS));
     // non-con notification
@@ -2835,5 +3273,56 @@ ANJ_UNIT_TEST(notification_comp_op,
     ASSERT_EQ(anj.observe_ctx.observations[1].ssid, 1);
 }
 
+#        ifdef ANJ_OBSERVE_WITH_COMPOSITE_DELTA_NOTIFICATIONS
+ANJ_UNIT_TEST(notification_comp_op, delta_notifications) {
+    NOTIFICATION_INIT();
+    INIT_OBSERVE_MODULE();
+    SET_COMPOSITE_OBSERVATION();
+    anj.observe_ctx.observations[0].last_included_timestamp =
+            time_monotonic_zero;
+    anj.observe_ctx.observations[2].last_included_timestamp =
+            time_monotonic_zero;
+    anj.observe_ctx.observations[3].last_included_timestamp =
+            time_monotonic_zero;
+    anj.observe_ctx.observations[4].last_included_timestamp =
+            time_monotonic_zero;
+
+    // only the path with expired pmax is sent
+    mock_time_advance(anj_time_duration_new(5000, ANJ_TIME_UNIT_MS));
+    anj_process(ANJ_TIME_DURATION_ZERO, 0x22, 1);
+    ASSERT_EQ(anj.observe_ctx.uri_count, 1);
+    ASSERT_TRUE(anj.observe_ctx.uri_paths[0]
+                == &anj.observe_ctx.observations[2].path);
+    anj_exchange(false);
+    check_out_buff(false, 0x22, 1);
+
+    mock_time_advance(anj_time_duration_new(5000, ANJ_TIME_UNIT_MS));
+    anj_process(ANJ_TIME_DURATION_ZERO, 0x22, 1);
+    ASSERT_EQ(anj.observe_ctx.uri_count, 3);
+    anj_exchange(false);
+    check_out_buff(false, 0x22, 2);
+
+    // only the changed path is sent
+    mock_time_advance(anj_time_duration_new(2000, ANJ_TIME_UNIT_MS));
+    ASSERT_OK(anj_observe_data_model_changed(
+            &anj, &ANJ_MAKE_RESOURCE_PATH(3, 0, 3),
+            ANJ_OBSERVE_CHANGE_TYPE_VALUE_CHANGED, 0));
+    anj_process(ANJ_TIME_DURATION_ZERO, 0x22, 1);
+    ASSERT_EQ(anj.observe_ctx.uri_count, 1);
+    ASSERT_TRUE(anj.observe_ctx.uri_paths[0]
+                == &anj.observe_ctx.observations[2].path);
+    anj_exchange(false);
+    check_out_buff(false, 0x22, 3);
+
+    // pmax of not sent paths is counted from the moment they were last sent
+    ASSERT_TRUE(anj_time_monotonic_eq(
+            anj.observe_ctx.observations[3].last_included_timestamp,
+            anj_time_monotonic_add(
+                    time_monotonic_zero,
+                    anj_time_duration_new(10000, ANJ_TIME_UNIT_MS))));
+    anj_process(anj_time_duration_new(3000, ANJ_TIME_UNIT_MS), 0, 0);
+}
+#        endif // ANJ_OBSERVE_WITH_COMPOSITE_DELTA_NOTIFICATIONS
+
 #    endif // ANJ_WITH_OBSERVE_COMPOSITE
 #endif     // ANJ_WITH_OBSERVE
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define ANJ_UNIT_ENABLE_SHORT_ASSERTS
+#include <anj/anj_config.h>
+#include <anj/compat/time.h>
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/dm/core.h>
+#include <anj/utils.h>
+
+#include "../../../../src/anj/coap/coap.h"
+#include "../../../../src/anj/dm/dm_io.h"
+#include "../../../../src/anj/exchange.h"
+#include "../../../../src/anj/observe/observe.h"
+
+#include "../mock/time_api_mock.h"
+
+#include <anj_unit_test.h>
+
+#ifdef ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS
+
+static int64_t res_value;
+
+static int res_read(anj_t *anj,
+                    const anj_dm_obj_t *obj,
+                    anj_iid_t iid,
+                    anj_rid_t rid,
+                    anj_riid_t riid,
+                    anj_res_value_t *out_value) {
+    (void) anj;
+    (void) obj;
+    (void) iid;
+    (void) rid;
+    (void) riid;
+    out_value->int_value = res_value;
+    return 0;
+}
+
+static anj_dm_handlers_t handlers = {
+    .res_read = res_read
+};
+static anj_dm_res_t res = {
+    .rid = 1,
+    .kind = ANJ_DM_RES_R,
+    .type = ANJ_DATA_TYPE_INT
+};
+static anj_dm_obj_inst_t inst = {
+    .iid = 0,
+    .res_count = 1,
+    .resources = &res
+};
+static anj_dm_obj_t obj = {
+    .oid = 3,
+    .insts = &inst,
+    .max_inst_count = 1,
+    .handlers = &handlers
+};
+
+static anj_t anj;
+static _anj_observe_server_state_t srv;
+static uint8_t payload[512];
+
+static void init(void) {
+    mock_time_reset();
+    memset(&anj, 0, sizeof(anj));
+    _anj_exchange_init(&anj.exchange_ctx);
+    _anj_dm_initialize(&anj);
+    ASSERT_OK(anj_dm_add_obj(&anj, &obj));
+    _anj_observe_init(&anj);
+    srv = (_anj_observe_server_state_t) {
+        .ssid = 1
+    };
+    res_value = 7;
+
+    _anj_observe_observation_t *observation = &anj.observe_ctx.observations[0];
+    observation->ssid = 1;
+    observation->token.bytes[0] = 0x21;
+    observation->token.size = 1;
+    observation->path = ANJ_MAKE_RESOURCE_PATH(3, 0, 1);
+    observation->effective_attr = (_anj_attr_notification_t) {
+        .has_max_period = true,
+        .max_period = 10
+    };
+    observation->observe_active = true;
+    observation->last_notify_timestamp = anj_time_monotonic_now();
+    observation->next_conf_notify_timestamp = anj_time_monotonic_add(
+            anj_time_monotonic_now(),
+            anj_time_duration_new(1, ANJ_TIME_UNIT_DAY));
+}
+
+// creates the pmax notification and completes its exchange, returns its code;
+// undelivered notification is a Confirmable one that times out
+static uint8_t notify(bool delivered) {
+    mock_time_advance(anj_time_duration_new(10, ANJ_TIME_UNIT_S));
+    if (!delivered) {
+        anj.observe_ctx.observations[0].next_conf_notify_timestamp =
+                anj_time_monotonic_now();
+    }
+    _anj_exchange_handlers_t out_handlers = { 0 };
+    _anj_coap_msg_t out_msg = { 0 };
+    ASSERT_OK(_anj_observe_process(&anj, &out_handlers, &srv, &out_msg));
+    ASSERT_EQ(out_msg.operation, delivered ? ANJ_OP_INF_NON_CON_NOTIFY
+                                           : ANJ_OP_INF_CON_NOTIFY);
+    ASSERT_EQ(_anj_exchange_new_client_request(&anj.exchange_ctx, &out_msg,
+                                               &out_handlers, payload,
+                                               sizeof(payload)),
+              ANJ_EXCHANGE_STATE_MSG_TO_SEND);
+    _anj_observe_update_last_etag(&anj, &out_msg.etag);
+    ASSERT_EQ(out_msg.etag.size, 8);
+    uint8_t msg_code = out_msg.msg_code;
+    ASSERT_EQ(out_msg.payload_size ? ANJ_COAP_CODE_CONTENT
+                                   : ANJ_COAP_CODE_VALID,
+              msg_code);
+    _anj_exchange_state_t state = ANJ_EXCHANGE_STATE_MSG_TO_SEND;
+    while (state != ANJ_EXCHANGE_STATE_FINISHED) {
+        if (state == ANJ_EXCHANGE_STATE_MSG_TO_SEND) {
+            state = _anj_exchange_process(&anj.exchange_ctx,
+                                          ANJ_EXCHANGE_EVENT_SEND_CONFIRMATION,
+                                          &out_msg);
+        } else {
+            mock_time_advance(anj_time_duration_new(1, ANJ_TIME_UNIT_MIN));
+            state = _anj_exchange_process(&anj.exchange_ctx,
+                                          ANJ_EXCHANGE_EVENT_NONE, &out_msg);
+        }
+    }
+    return msg_code;
+}
+
+ANJ_UNIT_TEST(notification_valid, unchanged_value) {
+    init();
+    ASSERT_EQ(notify(true), ANJ_COAP_CODE_CONTENT);
+    ASSERT_EQ(notify(true), ANJ_COAP_CODE_VALID);
+    ASSERT_EQ(notify(true), ANJ_COAP_CODE_VALID);
+    res_value = 8;
+    ASSERT_EQ(notify(true), ANJ_COAP_CODE_CONTENT);
+    ASSERT_EQ(notify(true), ANJ_COAP_CODE_VALID);
+}
+
+ANJ_UNIT_TEST(notification_valid, value_not_delivered) {
+    init();
+    ASSERT_EQ(notify(true), ANJ_COAP_CODE_CONTENT);
+    res_value = 8;
+    ASSERT_EQ(notify(false), ANJ_COAP_CODE_CONTENT);
+    // server doesn't know the ETag of the failed notification
+    ASSERT_EQ(notify(true), ANJ_COAP_CODE_CONTENT);
+    ASSERT_EQ(notify(true), ANJ_COAP_CODE_VALID);
+}
+
+#endif // ANJ_OBSERVE_WITH_VALID_NOTIFICATIONS
@@ -37,6 +37,8 @@ void compare_attr(_anj_attr_notification_t *attr1,
 
 void compare_observations(_anj_observe_ctx_t *ctx1, _anj_observe_ctx_t *ctx2);
 
+void init_ctx_ref(_anj_observe_ctx_t *ctx);
+
 void add_attr_storage(_anj_observe_attr_storage_t *attr,
                       anj_uri_path_t path,
                       _anj_attr_notification_t notif_attr,
@@ -229,7 +231,7 @@ static anj_dm_obj_t obj_4 = {
                 Payload, AlreadyProcessed)                                   \
             mock_time_reset();                                               \
             _anj_observe_ctx_t ctx_ref;                                      \
-            memset(&ctx_ref, 0, sizeof(ctx_ref));                            \
+            init_ctx_ref(&ctx_ref);                                          \
                                                                              \
             size_t records_number = *(uint8_t *) Payload - 0x80;             \
             /* Default configuration, change it in test itself if needed */  \
@@ -275,7 +277,7 @@ static anj_dm_obj_t obj_4 = {
                                                    Payload)                  \
                 mock_time_reset();                                           \
                 _anj_observe_ctx_t ctx_ref;                                  \
-                memset(&ctx_ref, 0, sizeof(ctx_ref));                        \
+                init_ctx_ref(&ctx_ref);                                      \
                                                                              \
                 size_t records_number = *(uint8_t *) Payload - 0x80;         \
                                                                              \
@@ -319,7 +321,7 @@ static anj_dm_obj_t obj_4 = {
 #        define OBSERVE_COMP_OP_TEST_ERROR(Attr, Result, Msg_Code, Payload, \
                                            Format, Accept)                  \
             _anj_observe_ctx_t ctx_ref;                                     \
-            memset(&ctx_ref, 0, sizeof(ctx_ref));                           \
+            init_ctx_ref(&ctx_ref);                                         \
                                                                             \
             _anj_observe_server_state_t srv = {                             \
                 .ssid = 1,                                                  \
@@ -460,7 +462,7 @@ ANJ_UNIT_TEST(
 
 ANJ_UNIT_TEST(observe_comp_op, composite_observation_four_records_block) {
     _anj_observe_ctx_t ctx_ref;
-    memset(&ctx_ref, 0, sizeof(ctx_ref));
+    init_ctx_ref(&ctx_ref);
     TEST_INIT();
     _anj_exchange_ctx_t exchange_ctx;
     _anj_exchange_handlers_t out_handlers;
@@ -575,7 +577,7 @@ ANJ_UNIT_TEST(observe_comp_op, composite_observation_four_records_block) {
 ANJ_UNIT_TEST(observe_comp_op,
               composite_observation_two_records_block_with_attribute) {
     _anj_observe_ctx_t ctx_ref;
-    memset(&ctx_ref, 0, sizeof(ctx_ref));
+    init_ctx_ref(&ctx_ref);
     TEST_INIT();
     _anj_exchange_ctx_t exchange_ctx;
     _anj_exchange_handlers_t out_handlers;
@@ -1798,7 +1800,8 @@ ANJ_UNIT_TEST(observe_comp_op, observe_bad_attribute_st) {
 
 ANJ_UNIT_TEST(observe_comp_op, observe_block) {
     TEST_INIT();
-    _anj_observe_ctx_t ctx_ref = { 0 };
+    _anj_observe_ctx_t ctx_ref;
+    init_ctx_ref(&ctx_ref);
     _anj_exchange_ctx_t exchange_ctx;
     _anj_exchange_handlers_t out_handlers;
     _anj_exchange_init(&exchange_ctx);
@@ -2044,7 +2047,7 @@ ANJ_UNIT_TEST(observe_comp_op, observe_cancel_four_paths) {
 
 ANJ_UNIT_TEST(observe_comp_op, observe_cancel_four_paths_block) {
     _anj_observe_ctx_t ctx_ref;
-    memset(&ctx_ref, 0, sizeof(ctx_ref));
+    init_ctx_ref(&ctx_ref);
     TEST_INIT();
     _anj_exchange_ctx_t exchange_ctx;
     _anj_exchange_handlers_t out_handlers;
@@ -2173,7 +2176,7 @@ ANJ_UNIT_TEST(observe_comp_op, observe_cancel_four_paths_block) {
 
 ANJ_UNIT_TEST(observe_comp_op, observe_cancel_two_paths_block) {
     _anj_observe_ctx_t ctx_ref;
-    memset(&ctx_ref, 0, sizeof(ctx_ref));
+    init_ctx_ref(&ctx_ref);
     TEST_INIT();
     _anj_exchange_ctx_t exchange_ctx;
     _anj_exchange_handlers_t out_handlers;
@@ -191,6 +191,14 @@ void compare_attr(_anj_attr_notification_t *attr1,
 #    endif // ANJ_WITH_LWM2M12
 }
 
+void init_ctx_ref(_anj_observe_ctx_t *ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+#    ifdef ANJ_OBSERVE_WITH_USER_STORAGE
+    ctx->observations = ctx->default_observations;
+    ctx->attributes_storage = ctx->default_attributes_storage;
+#    endif // ANJ_OBSERVE_WITH_USER_STORAGE
+}
+
 void compare_observations(_anj_observe_ctx_t *ctx1, _anj_observe_ctx_t *ctx2) {
     for (size_t i = 0; i < ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER; i++) {
         ASSERT_EQ(ctx1->observations[i].ssid, ctx2->observations[i].ssid);
@@ -478,6 +486,9 @@ ANJ_UNIT_TEST(observe_op, observe_existing_records) {
     ASSERT_EQ(anj.observe_ctx.observations[2].ssid, 2);
     ASSERT_EQ(anj.observe_ctx.observations[3].ssid, 0);
     ASSERT_EQ(anj.observe_ctx.observations[4].ssid, 0);
+#    ifdef ANJ_WITH_RESOURCE_USAGE
+    ASSERT_EQ(anj.resource_usage.observations_max, 3);
+#    endif // ANJ_WITH_RESOURCE_USAGE
 }
 
 ANJ_UNIT_TEST(observe_op, observe_wrong_default_pmax) {
@@ -736,7 +747,7 @@ ANJ_UNIT_TEST(observe_op, observe_ignore_step_with_multi_res) {
 ANJ_UNIT_TEST(observe_op, observe_check_timestamps) {
     TEST_INIT();
     _anj_observe_ctx_t ctx_ref;
-    memset(&ctx_ref, 0, sizeof(ctx_ref));
+    init_ctx_ref(&ctx_ref);
 
     _anj_attr_notification_t observe_attr = {
         .has_max_period = true,
@@ -1178,6 +1189,110 @@ ANJ_UNIT_TEST(observe_op, update_mid_not_found) {
 
     ANJ_UNIT_ASSERT_EQUAL(anj.observe_ctx.observations[0].last_sent_mid, 0x12);
 }
+
+ANJ_UNIT_TEST(observe_op, cancel_by_mid_after_update) {
+    TEST_INIT();
+    for (size_t i = 0; i < ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER; i++) {
+        anj.observe_ctx.observations[i].ssid = 1;
+        anj.observe_ctx.observations[i].token.size = 1;
+        anj.observe_ctx.observations[i].token.bytes[0] = (char) i;
+        anj.observe_ctx.observations[i].last_sent_mid = (uint16_t) (i % 2);
+        anj.observe_ctx.observations[i].path = ANJ_MAKE_RESOURCE_PATH(3, 1, 1);
+    }
+    _anj_observe_cancel_observation_by_mid(&anj, 0x12);
+    for (size_t i = 0; i < ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER; i++) {
+        ASSERT_EQ(anj.observe_ctx.observations[i].ssid, 1);
+    }
+
+    anj.observe_ctx.processing_observation = &anj.observe_ctx.observations[2];
+    _anj_observe_update_last_mid(&anj, 0x34);
+    // all Observations with the MID are removed
+    _anj_observe_cancel_observation_by_mid(&anj, 0);
+    ASSERT_EQ(anj.observe_ctx.observations[0].ssid, 0);
+    ASSERT_EQ(anj.observe_ctx.observations[1].ssid, 1);
+    ASSERT_EQ(anj.observe_ctx.observations[2].ssid, 1);
+    ASSERT_EQ(anj.observe_ctx.observations[3].ssid, 1);
+    ASSERT_EQ(anj.observe_ctx.observations[4].ssid, 0);
+    _anj_observe_cancel_observation_by_mid(&anj, 0x34);
+    ASSERT_EQ(anj.observe_ctx.observations[2].ssid, 0);
+    _anj_observe_cancel_observation_by_mid(&anj, 1);
+    ASSERT_EQ(anj.observe_ctx.observations[1].ssid, 0);
+    ASSERT_EQ(anj.observe_ctx.observations[3].ssid, 0);
+}
 #    endif // ANJ_WITH_RST_AS_CANCEL_OBSERVE
 
+#    ifdef ANJ_WITH_WARM_RESTART
+ANJ_UNIT_TEST(observe_op, remove_observations_of_missing_paths) {
+    TEST_INIT();
+    anj.observe_ctx.observations[0].ssid = 1;
+    anj.observe_ctx.observations[0].path = ANJ_MAKE_RESOURCE_PATH(3, 1, 1);
+    anj.observe_ctx.observations[1].ssid = 1;
+    anj.observe_ctx.observations[1].path = ANJ_MAKE_INSTANCE_PATH(3, 7);
+    anj.observe_ctx.observations[2].ssid = 2;
+    anj.observe_ctx.observations[2].path = ANJ_MAKE_INSTANCE_PATH(3, 7);
+    anj.observe_ctx.observations[3].ssid = 1;
+    anj.observe_ctx.observations[3].path = ANJ_MAKE_OBJECT_PATH(5);
+
+    _anj_observe_remove_observations_of_missing_paths(&anj, 1);
+    ASSERT_EQ(anj.observe_ctx.observations[0].ssid, 1);
+    ASSERT_EQ(anj.observe_ctx.observations[1].ssid, 0);
+    // other servers are not affected
+    ASSERT_EQ(anj.observe_ctx.observations[2].ssid, 2);
+    ASSERT_EQ(anj.observe_ctx.observations[3].ssid, 0);
+}
+#    endif // ANJ_WITH_WARM_RESTART
+
+#    ifdef ANJ_OBSERVE_WITH_USER_STORAGE
+#        define USER_OBSERVATIONS_NUMBER (ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER + 3)
+
+static uint8_t observe_with_token(anj_t *anj, uint8_t token) {
+    _anj_observe_server_state_t srv = {
+        .ssid = 1,
+        .default_max_period = 77,
+    };
+    _anj_coap_msg_t inout_msg = {
+        .operation = ANJ_OP_INF_OBSERVE,
+        .uri = ANJ_MAKE_RESOURCE_PATH(3, 1, 1),
+        .accept = _ANJ_COAP_FORMAT_NOT_DEFINED,
+    };
+    inout_msg.token.size = 1;
+    inout_msg.token.bytes[0] = token;
+    _anj_exchange_handlers_t out_handlers;
+    uint8_t response_code;
+    (void) _anj_observe_new_request(anj, &out_handlers, &srv, &inout_msg,
+                                    &response_code);
+    return response_code;
+}
+
+ANJ_UNIT_TEST(observe_op, user_storage) {
+    static anj_observation_entry_t observations[USER_OBSERVATIONS_NUMBER];
+    static anj_write_attributes_entry_t attributes[1];
+    TEST_INIT();
+    ASSERT_FAIL(_anj_observe_set_storage(&anj, observations, 0, NULL, 0));
+    ASSERT_FAIL(_anj_observe_set_storage(&anj, NULL, 0, attributes,
+                                         UINT16_MAX));
+    observations[0].ssid = 1;
+    ASSERT_OK(_anj_observe_set_storage(&anj, observations,
+                                       USER_OBSERVATIONS_NUMBER, attributes,
+                                       1));
+    ASSERT_TRUE(anj.observe_ctx.observations == observations);
+    ASSERT_TRUE(anj.observe_ctx.attributes_storage == attributes);
+    ASSERT_EQ(observations[0].ssid, 0);
+
+    // more Observations than ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER fit
+    for (uint8_t i = 0; i < USER_OBSERVATIONS_NUMBER; i++) {
+        ASSERT_EQ(observe_with_token(&anj, (uint8_t) (0x30 + i)),
+                  ANJ_COAP_CODE_CONTENT);
+        ASSERT_EQ(observations[i].ssid, 1);
+        ASSERT_EQ(observations[i].token.bytes[0], 0x30 + i);
+    }
+    ASSERT_EQ(observe_with_token(&anj, 0x20),
+              ANJ_COAP_CODE_INTERNAL_SERVER_ERROR);
+    _anj_observe_remove_all_observations(&anj, ANJ_OBSERVE_ANY_SERVER);
+    for (size_t i = 0; i < USER_OBSERVATIONS_NUMBER; i++) {
+        ASSERT_EQ(observations[i].ssid, 0);
+    }
+}
+#    endif // ANJ_OBSERVE_WITH_USER_STORAGE
+
 #endif // ANJ_WITH_OBSERVE
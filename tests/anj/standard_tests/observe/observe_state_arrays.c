@@ -0,0 +1,262 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define ANJ_UNIT_ENABLE_SHORT_ASSERTS
+#include <anj/anj_config.h>
+#include <anj/compat/time.h>
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/dm/core.h>
+#include <anj/utils.h>
+
+#include "../../../../src/anj/coap/coap.h"
+#include "../../../../src/anj/dm/dm_io.h"
+#include "../../../../src/anj/exchange.h"
+#include "../../../../src/anj/observe/observe.h"
+#include "../../../../src/anj/utils.h"
+
+#include "../mock/time_api_mock.h"
+
+#include <anj_unit_test.h>
+
+#ifdef ANJ_OBSERVE_WITH_STATE_ARRAYS
+
+static double res_value;
+
+static int res_read(anj_t *anj,
+                    const anj_dm_obj_t *obj,
+                    anj_iid_t iid,
+                    anj_rid_t rid,
+                    anj_riid_t riid,
+                    anj_res_value_t *out_value) {
+    (void) anj;
+    (void) obj;
+    (void) iid;
+    (void) rid;
+    (void) riid;
+    out_value->double_value = res_value;
+    return 0;
+}
+
+static anj_dm_handlers_t handlers = {
+    .res_read = res_read
+};
+static anj_dm_res_t res = {
+    .rid = 1,
+    .kind = ANJ_DM_RES_R,
+    .type = ANJ_DATA_TYPE_DOUBLE
+};
+static anj_dm_obj_inst_t inst = {
+    .iid = 0,
+    .res_count = 1,
+    .resources = &res
+};
+static anj_dm_obj_t obj = {
+    .oid = 3,
+    .insts = &inst,
+    .max_inst_count = 1,
+    .handlers = &handlers
+};
+
+static anj_t anj;
+static uint8_t payload[512];
+
+static void add_observation(size_t idx, uint16_t ssid, bool active) {
+    _anj_observe_observation_t *observation =
+            &anj.observe_ctx.observations[idx];
+    observation->ssid = ssid;
+    observation->token.bytes[0] = (uint8_t) (0x21 + idx);
+    observation->token.size = 1;
+    observation->path = ANJ_MAKE_RESOURCE_PATH(3, 0, 1);
+    observation->observe_active = active;
+    observation->last_notify_timestamp = anj_time_monotonic_now();
+    // Non-confirmable notifications, finished once sent
+    observation->next_conf_notify_timestamp =
+            anj_time_monotonic_add(anj_time_monotonic_now(),
+                                   anj_time_duration_new(1, ANJ_TIME_UNIT_DAY));
+}
+
+// Observations 0 and 2 of server 1 and 1 of server 2 are active, Observation 3
+// of server 1 is not
+static void init(void) {
+    mock_time_reset();
+    memset(&anj, 0, sizeof(anj));
+    _anj_exchange_init(&anj.exchange_ctx);
+    _anj_dm_initialize(&anj);
+    ASSERT_OK(anj_dm_add_obj(&anj, &obj));
+    _anj_observe_init(&anj);
+    res_value = 0.0;
+    add_observation(0, 1, true);
+    add_observation(1, 2, true);
+    add_observation(2, 1, true);
+    add_observation(3, 1, false);
+}
+
+static void check_state_arrays(void) {
+    const _anj_observe_ctx_t *ctx = &anj.observe_ctx;
+    ASSERT_TRUE(ctx->state_arrays.valid);
+    for (size_t i = 0; i < ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER; i++) {
+        const _anj_observe_observation_t *observation = &ctx->observations[i];
+        ASSERT_EQ(ctx->state_arrays.ssid[i], observation->ssid);
+        ASSERT_EQ(!!(ctx->state_arrays.flags[i] & _ANJ_OBSERVE_STATE_ACTIVE),
+                  observation->observe_active);
+        ASSERT_EQ(!!(ctx->state_arrays.flags[i]
+                     & _ANJ_OBSERVE_STATE_NOTIFICATION_TO_SEND),
+                  observation->notification_to_send);
+    }
+}
+
+static void value_changed(double value) {
+    res_value = value;
+    ASSERT_OK(anj_observe_data_model_changed(
+            &anj, &ANJ_MAKE_RESOURCE_PATH(3, 0, 1),
+            ANJ_OBSERVE_CHANGE_TYPE_VALUE_CHANGED, 0));
+}
+
+// creates the notification for server 1 and completes its exchange
+static void send_notification(uint8_t token) {
+    _anj_observe_server_state_t srv = {
+        .ssid = 1,
+        .is_server_online = true
+    };
+    _anj_exchange_handlers_t out_handlers = { 0 };
+    _anj_coap_msg_t out_msg = { 0 };
+    ASSERT_OK(_anj_observe_process(&anj, &out_handlers, &srv, &out_msg));
+    ASSERT_EQ(out_msg.token.size, 1);
+    ASSERT_EQ(out_msg.token.bytes[0], token);
+    ASSERT_EQ(_anj_exchange_new_client_request(&anj.exchange_ctx, &out_msg,
+                                               &out_handlers, payload,
+                                               sizeof(payload)),
+              ANJ_EXCHANGE_STATE_MSG_TO_SEND);
+    ASSERT_EQ(_anj_exchange_process(&anj.exchange_ctx,
+                                    ANJ_EXCHANGE_EVENT_SEND_CONFIRMATION,
+                                    &out_msg),
+              ANJ_EXCHANGE_STATE_FINISHED);
+}
+
+ANJ_UNIT_TEST(observe_state_arrays, follow_notifications) {
+    init();
+    ASSERT_FALSE(anj.observe_ctx.state_arrays.valid);
+
+    // arrays are built by the first scan
+    value_changed(1.0);
+    check_state_arrays();
+    // the inactive Observation is not to be notified
+    ASSERT_FALSE(anj.observe_ctx.observations[3].notification_to_send);
+    ASSERT_TRUE(anj.observe_ctx.observations[1].notification_to_send);
+
+    send_notification(0x21);
+    check_state_arrays();
+    ASSERT_FALSE(anj.observe_ctx.observations[0].notification_to_send);
+    send_notification(0x23);
+    check_state_arrays();
+    // notification for the other server is still pending
+    ASSERT_TRUE(anj.observe_ctx.observations[1].notification_to_send);
+
+    value_changed(2.0);
+    check_state_arrays();
+    ASSERT_TRUE(anj.observe_ctx.observations[0].notification_to_send);
+    ASSERT_TRUE(anj.observe_ctx.observations[2].notification_to_send);
+}
+
+ANJ_UNIT_TEST(observe_state_arrays, follow_removal) {
+    init();
+    value_changed(1.0);
+    check_state_arrays();
+
+    // Observations removed with the Resource
+    ASSERT_OK(anj_observe_data_model_changed(&anj,
+                                             &ANJ_MAKE_INSTANCE_PATH(3, 0),
+                                             ANJ_OBSERVE_CHANGE_TYPE_DELETED,
+                                             0));
+    check_state_arrays();
+    for (size_t i = 0; i < 4; i++) {
+        ASSERT_EQ(anj.observe_ctx.observations[i].ssid, 0);
+    }
+
+    // removing all Observations of a server invalidates the arrays
+    init();
+    value_changed(1.0);
+    _anj_observe_remove_all_observations(&anj, 1);
+    ASSERT_FALSE(anj.observe_ctx.state_arrays.valid);
+    value_changed(2.0);
+    check_state_arrays();
+    ASSERT_EQ(anj.observe_ctx.state_arrays.ssid[0], 0);
+    ASSERT_EQ(anj.observe_ctx.state_arrays.ssid[1], 2);
+}
+
+static int sign(int value) {
+    return value > 0 ? 1 : value < 0 ? -1 : 0;
+}
+
+ANJ_UNIT_TEST(observe_state_arrays, path_keys) {
+    const anj_uri_path_t paths[] = {
+        ANJ_MAKE_ROOT_PATH(),
+        ANJ_MAKE_OBJECT_PATH(0),
+        ANJ_MAKE_OBJECT_PATH(3),
+        ANJ_MAKE_INSTANCE_PATH(3, 0),
+        ANJ_MAKE_INSTANCE_PATH(3, 65534),
+        ANJ_MAKE_RESOURCE_PATH(3, 0, 1),
+        ANJ_MAKE_RESOURCE_PATH(3, 1, 0),
+        ANJ_MAKE_RESOURCE_INSTANCE_PATH(3, 0, 1, 0),
+        ANJ_MAKE_RESOURCE_INSTANCE_PATH(3, 0, 1, 65534),
+        ANJ_MAKE_OBJECT_PATH(65534)
+    };
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(paths); i++) {
+        _anj_uri_path_key_t left = _anj_uri_path_key(&paths[i]);
+        ASSERT_EQ(_anj_uri_path_key_length(left), paths[i].uri_len);
+        _anj_uri_path_key_t left_mask =
+                _anj_uri_path_key_mask(paths[i].uri_len);
+        for (size_t j = 0; j < ANJ_ARRAY_SIZE(paths); j++) {
+            _anj_uri_path_key_t right = _anj_uri_path_key(&paths[j]);
+            ASSERT_EQ(left == right, anj_uri_path_equal(&paths[i], &paths[j]));
+            ASSERT_EQ(left < right ? -1 : left > right ? 1 : 0,
+                      sign(_anj_uri_path_compare(&paths[i], &paths[j])));
+            ASSERT_EQ(_anj_uri_path_key_outside_base(right, left, left_mask),
+                      anj_uri_path_outside_base(&paths[j], &paths[i]));
+        }
+    }
+}
+
+ANJ_UNIT_TEST(observe_state_arrays, changes_of_other_paths) {
+    init();
+    anj.observe_ctx.observations[2].path = ANJ_MAKE_INSTANCE_PATH(3, 0);
+    anj.observe_ctx.observations[3].path = ANJ_MAKE_RESOURCE_PATH(3, 1, 1);
+    anj.observe_ctx.observations[3].observe_active = true;
+
+    // Resource under the observed Instance
+    value_changed(1.0);
+    check_state_arrays();
+    ASSERT_TRUE(anj.observe_ctx.observations[0].notification_to_send);
+    ASSERT_TRUE(anj.observe_ctx.observations[2].notification_to_send);
+    ASSERT_FALSE(anj.observe_ctx.observations[3].notification_to_send);
+
+    // removal of an unrelated Instance
+    ASSERT_OK(anj_observe_data_model_changed(&anj,
+                                             &ANJ_MAKE_INSTANCE_PATH(3, 2),
+                                             ANJ_OBSERVE_CHANGE_TYPE_DELETED,
+                                             0));
+    for (size_t i = 0; i < 4; i++) {
+        ASSERT_NE(anj.observe_ctx.observations[i].ssid, 0);
+    }
+    // only the Observation under the removed Instance is removed
+    ASSERT_OK(anj_observe_data_model_changed(&anj,
+                                             &ANJ_MAKE_INSTANCE_PATH(3, 1),
+                                             ANJ_OBSERVE_CHANGE_TYPE_DELETED,
+                                             0));
+    check_state_arrays();
+    ASSERT_NE(anj.observe_ctx.observations[2].ssid, 0);
+    ASSERT_EQ(anj.observe_ctx.observations[3].ssid, 0);
+}
+
+#endif // ANJ_OBSERVE_WITH_STATE_ARRAYS
@@ -860,4 +860,113 @@ ANJ_UNIT_TEST(discover_attr, get_resource_instance_attr) {
 }
 #    endif // ANJ_WITH_DISCOVER_ATTR
 
+
+#    ifdef ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
+ANJ_UNIT_TEST(write_attr, attr_storage_index) {
+    TEST_INIT();
+    static const struct {
+        anj_uri_path_t path;
+        uint16_t ssid;
+    } records[] = {
+        { ANJ_MAKE_RESOURCE_PATH(3, 1, 2), 2 },
+        { ANJ_MAKE_RESOURCE_PATH(3, 0, 1), 1 },
+        { ANJ_MAKE_INSTANCE_PATH(3, 1), 1 },
+        { ANJ_MAKE_OBJECT_PATH(3), 2 },
+        { ANJ_MAKE_RESOURCE_PATH(3, 1, 2), 1 },
+    };
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(records); i++) {
+        anj.observe_ctx.attributes_storage[i].path = records[i].path;
+        anj.observe_ctx.attributes_storage[i].ssid = records[i].ssid;
+        anj.observe_ctx.attributes_storage[i].attr.has_min_period = true;
+        anj.observe_ctx.attributes_storage[i].attr.min_period = (uint32_t) i;
+    }
+    _anj_observe_attr_storage_index_invalidate(&anj.observe_ctx);
+
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(records); i++) {
+        _anj_observe_attr_storage_t *found = _anj_observe_get_attr_from_path(
+                &anj.observe_ctx, &records[i].path, records[i].ssid);
+        ASSERT_TRUE(found == &anj.observe_ctx.attributes_storage[i]);
+    }
+    ASSERT_TRUE(anj.observe_ctx.attr_storage_index.valid);
+    ASSERT_NULL(_anj_observe_get_attr_from_path(
+            &anj.observe_ctx, &ANJ_MAKE_RESOURCE_PATH(3, 0, 1), 2));
+    ASSERT_NULL(_anj_observe_get_attr_from_path(
+            &anj.observe_ctx, &ANJ_MAKE_INSTANCE_PATH(3, 0), 1));
+
+    /* records of all servers under the deleted Instance are removed */
+    ASSERT_OK(anj_observe_data_model_changed(&anj,
+                                             &ANJ_MAKE_INSTANCE_PATH(3, 1),
+                                             ANJ_OBSERVE_CHANGE_TYPE_DELETED,
+                                             0));
+    ASSERT_EQ(anj.observe_ctx.attributes_storage[0].ssid, 0);
+    ASSERT_EQ(anj.observe_ctx.attributes_storage[2].ssid, 0);
+    ASSERT_EQ(anj.observe_ctx.attributes_storage[4].ssid, 0);
+    ASSERT_NULL(_anj_observe_get_attr_from_path(
+            &anj.observe_ctx, &ANJ_MAKE_RESOURCE_PATH(3, 1, 2), 1));
+    ASSERT_TRUE(_anj_observe_get_attr_from_path(
+                        &anj.observe_ctx, &ANJ_MAKE_RESOURCE_PATH(3, 0, 1), 1)
+                == &anj.observe_ctx.attributes_storage[1]);
+    ASSERT_TRUE(_anj_observe_get_attr_from_path(
+                        &anj.observe_ctx, &ANJ_MAKE_OBJECT_PATH(3), 2)
+                == &anj.observe_ctx.attributes_storage[3]);
+}
+
+#        ifdef ANJ_WITH_DISCOVER_ATTR
+ANJ_UNIT_TEST(discover_attr, attr_storage_index_merge) {
+    TEST_INIT();
+    static const struct {
+        anj_uri_path_t path;
+        uint16_t ssid;
+    } records[] = {
+        { ANJ_MAKE_RESOURCE_PATH(3, 1, 2), 2 },
+        { ANJ_MAKE_RESOURCE_PATH(3, 0, 1), 2 },
+        { ANJ_MAKE_INSTANCE_PATH(3, 1), 1 },
+        { ANJ_MAKE_OBJECT_PATH(3), 2 },
+        { ANJ_MAKE_INSTANCE_PATH(3, 1), 2 },
+    };
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(records); i++) {
+        anj.observe_ctx.attributes_storage[i].path = records[i].path;
+        anj.observe_ctx.attributes_storage[i].ssid = records[i].ssid;
+        anj.observe_ctx.attributes_storage[i].attr.has_min_period = true;
+        anj.observe_ctx.attributes_storage[i].attr.min_period = (uint32_t) i;
+    }
+    _anj_observe_attr_storage_index_invalidate(&anj.observe_ctx);
+
+    /* records of SSID 2 in the order of a Discover on /3 */
+    static const struct {
+        anj_uri_path_t path;
+        int min_period;
+    } discover[] = {
+        { ANJ_MAKE_OBJECT_PATH(3), 3 },
+        { ANJ_MAKE_INSTANCE_PATH(3, 0), -1 },
+        { ANJ_MAKE_RESOURCE_PATH(3, 0, 0), -1 },
+        { ANJ_MAKE_RESOURCE_PATH(3, 0, 1), 1 },
+        { ANJ_MAKE_INSTANCE_PATH(3, 1), 4 },
+        { ANJ_MAKE_RESOURCE_PATH(3, 1, 2), 0 },
+        { ANJ_MAKE_RESOURCE_PATH(3, 1, 3), -1 },
+    };
+    _anj_attr_notification_t attr;
+    for (size_t i = 0; i < ANJ_ARRAY_SIZE(discover); i++) {
+        int res = _anj_observe_get_attr_storage(&anj, 2, i == 0,
+                                                &discover[i].path, &attr);
+        if (discover[i].min_period < 0) {
+            ASSERT_EQ(res, ANJ_COAP_CODE_NOT_FOUND);
+        } else {
+            ASSERT_OK(res);
+            ASSERT_EQ(attr.min_period, discover[i].min_period);
+        }
+    }
+    ASSERT_EQ(anj.observe_ctx.attr_storage_index.discover_pos, 5);
+
+    /* lookup of a path ordered before the previous one is still correct */
+    ASSERT_OK(_anj_observe_get_attr_storage(
+            &anj, 2, false, &ANJ_MAKE_RESOURCE_PATH(3, 0, 1), &attr));
+    ASSERT_EQ(attr.min_period, 1);
+    ASSERT_OK(_anj_observe_get_attr_storage(
+            &anj, 2, true, &ANJ_MAKE_RESOURCE_PATH(3, 1, 2), &attr));
+    ASSERT_EQ(attr.min_period, 0);
+}
+#        endif // ANJ_WITH_DISCOVER_ATTR
+#    endif // ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX
+
 #endif // ANJ_WITH_OBSERVE
@@ -18,6 +18,11 @@
 #include <anj/log.h>
 
 #include "some_obj.h"
+#include "some_obj_sizes.h"
+
+#if ANJ_OUT_PAYLOAD_BUFFER_SIZE < SAMPLE_MIN_OUT_PAYLOAD_BUFFER_SIZE
+#    error "Read of the Sample Object Instance would need a block-wise transfer"
+#endif
 
 #define log(...) anj_log(example_log, __VA_ARGS__)
 
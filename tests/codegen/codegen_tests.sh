@@ -23,19 +23,45 @@ HANDLING=(
     static
     dynamic
 )
+DISPATCH_TABLES=(
+    OFF
+    ON
+)
+PACKED_VALUES=(
+    OFF
+    ON
+)
+PERSISTENCE=(
+    OFF
+    ON
+)
+SETTERS=(
+    OFF
+    ON
+)
+
+"$(dirname "$0")/golden/golden_tests.sh" || exit 1
 
 mkdir -p build && cd build
 for cc in "${CC[@]}"; do
     for obj_count in "${OBJECT_INSTANCES_COUNT[@]}"; do
         for handling_res in "${HANDLING[@]}"; do
             for handling_obj in "${HANDLING[@]}"; do
-            CC="$cc" cmake ..  -DCLI_OBJECT_INSTANCES_HANDLING="$handling_obj" -DCLI_RESOURCE_INSTANCES_HANDLING="$handling_res" -DCLI_OBJECT_INSTANCES_COUNT="$obj_count" -DCMAKE_C_FLAGS="-Werror"
+                for dispatch_tables in "${DISPATCH_TABLES[@]}"; do
+                for packed_values in "${PACKED_VALUES[@]}"; do
+                for persistence in "${PERSISTENCE[@]}"; do
+                for setters in "${SETTERS[@]}"; do
+            CC="$cc" cmake ..  -DCLI_OBJECT_INSTANCES_HANDLING="$handling_obj" -DCLI_RESOURCE_INSTANCES_HANDLING="$handling_res" -DCLI_OBJECT_INSTANCES_COUNT="$obj_count" -DCLI_DISPATCH_TABLES="$dispatch_tables" -DCLI_PACKED_VALUES="$packed_values" -DCLI_PERSISTENCE="$persistence" -DCLI_SETTERS="$setters" -DCMAKE_C_FLAGS="-Werror"
                 for target in "${TARGETS[@]}"; do
                     make "$target"
                     if [[ "$target" == "codegen_add_object_tests" ]]; then 
                         ./codegen_add_object_tests/codegen_add_object_tests; 
                     fi
                 done
+                done
+                done
+                done
+                done
             done 
         done
     done
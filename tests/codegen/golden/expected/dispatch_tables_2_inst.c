@@ -0,0 +1,414 @@
+/**
+ * Generated by anjay_codegen.py on 1970-01-01 00:00:00
+ *
+ * LwM2M Object: Golden Sensor
+ * ID: 32000, URN: urn:oma:lwm2m:x:32000, Optional, Multiple
+ *
+ * Object covering the resource kinds handled differently by the code
+ * generator options.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/dm/core.h>
+#include <anj/utils.h>
+
+#define GOLDEN_SENSOR_OBJ_OID 32000
+#define GOLDEN_SENSOR_OBJ_INST_COUNT 2
+
+enum {
+    /**
+     * Float: R, Single, Mandatory
+     * type: float, range: N/A, units: Cel
+     * Measured value.
+     */
+    RID_FLOAT = 0,
+    /**
+     * Counter: R, Single, Optional
+     * type: integer, range: N/A, units: N/A
+     * Number of measurements.
+     */
+    RID_COUNTER = 1,
+    /**
+     * Label: RW, Single, Optional
+     * type: string, range: N/A, units: N/A
+     * Name of the sensor.
+     */
+    RID_LABEL = 2,
+    /**
+     * Raw Sample: R, Single, Optional
+     * type: opaque, range: N/A, units: N/A
+     * Last sample as read from the sensor.
+     */
+    RID_RAW_SAMPLE = 3,
+    /**
+     * History: RW, Multiple, Optional
+     * type: float, range: N/A, units: Cel
+     * Previous measured values.
+     */
+    RID_HISTORY = 4,
+    /**
+     * Reset: E, Single, Optional
+     * type: N/A, range: N/A, units: N/A
+     * Resets the measurements.
+     */
+    RID_RESET = 5,
+};
+
+enum {
+    RID_FLOAT_IDX,
+    RID_COUNTER_IDX,
+    RID_LABEL_IDX,
+    RID_RAW_SAMPLE_IDX,
+    RID_HISTORY_IDX,
+    RID_RESET_IDX,
+    RID_IDX_COUNT
+};
+
+static const anj_dm_res_t resources_defs[] = {
+    [RID_FLOAT_IDX] = {
+        .rid = RID_FLOAT,
+        .type = ANJ_DATA_TYPE_DOUBLE,
+        .kind = ANJ_DM_RES_R,
+    },
+    [RID_COUNTER_IDX] = {
+        .rid = RID_COUNTER,
+        .type = ANJ_DATA_TYPE_INT,
+        .kind = ANJ_DM_RES_R,
+    },
+    [RID_LABEL_IDX] = {
+        .rid = RID_LABEL,
+        .type = ANJ_DATA_TYPE_STRING,
+        .kind = ANJ_DM_RES_RW,
+    },
+    [RID_RAW_SAMPLE_IDX] = {
+        .rid = RID_RAW_SAMPLE,
+        .type = ANJ_DATA_TYPE_BYTES,
+        .kind = ANJ_DM_RES_R,
+    },
+    [RID_HISTORY_IDX] = {
+        .rid = RID_HISTORY,
+        .type = ANJ_DATA_TYPE_DOUBLE,
+        .kind = ANJ_DM_RES_RWM,
+    },
+    [RID_RESET_IDX] = {
+        .rid = RID_RESET,
+        .kind = ANJ_DM_RES_E,
+    },
+};
+
+ANJ_STATIC_ASSERT(RID_IDX_COUNT == ANJ_ARRAY_SIZE(resources_defs),
+                  golden_sensor_object_resource_count_mismatch);
+
+#define RID_INDEX_FIRST RID_FLOAT
+
+// Index of every Resource in resources_defs increased by one, 0 in gaps
+static const uint8_t RID_INDEX[] = {
+    [RID_FLOAT - RID_INDEX_FIRST] = RID_FLOAT_IDX + 1,
+    [RID_COUNTER - RID_INDEX_FIRST] = RID_COUNTER_IDX + 1,
+    [RID_LABEL - RID_INDEX_FIRST] = RID_LABEL_IDX + 1,
+    [RID_RAW_SAMPLE - RID_INDEX_FIRST] = RID_RAW_SAMPLE_IDX + 1,
+    [RID_HISTORY - RID_INDEX_FIRST] = RID_HISTORY_IDX + 1,
+    [RID_RESET - RID_INDEX_FIRST] = RID_RESET_IDX + 1,
+};
+
+ANJ_STATIC_ASSERT(ANJ_ARRAY_SIZE(RID_INDEX) == 6,
+                  golden_sensor_object_rid_index_size_mismatch);
+
+// Returns index of the Resource in resources_defs, or -1 if it doesn't exist
+static inline int rid_to_idx(anj_rid_t rid) {
+    // IDs lower than the first one wrap around to values out of the table
+    uint32_t offset = (uint32_t) rid - (uint32_t) RID_INDEX_FIRST;
+    if (offset >= ANJ_ARRAY_SIZE(RID_INDEX) || !RID_INDEX[offset]) {
+        return -1;
+    }
+    return RID_INDEX[offset] - 1;
+}
+
+
+#define HISTORY_RES_INST_COUNT 2
+
+typedef struct {
+    // TODO: Add resource instance specific state here
+} history_res_inst_t;
+
+
+typedef struct {
+    anj_riid_t history_res_insts_ids[HISTORY_RES_INST_COUNT];
+    history_res_inst_t history_res_insts[HISTORY_RES_INST_COUNT];
+
+    // TODO: Add object instance specific state here
+} golden_sensor_obj_inst_t;
+
+typedef struct {
+    anj_dm_obj_t object;
+    anj_dm_obj_inst_t obj_insts_ids[GOLDEN_SENSOR_OBJ_INST_COUNT];
+    golden_sensor_obj_inst_t obj_insts[GOLDEN_SENSOR_OBJ_INST_COUNT];
+} golden_sensor_obj_ctx_t;
+
+static void
+init_obj_inst(golden_sensor_obj_ctx_t *ctx, size_t index, anj_iid_t iid);
+
+static golden_sensor_obj_ctx_t *get_ctx(const anj_dm_obj_t *obj);
+
+static golden_sensor_obj_inst_t *get_obj_inst(const anj_dm_obj_t *obj, anj_iid_t iid) {
+    if (iid == ANJ_ID_INVALID) {
+        return NULL;
+    }
+
+    golden_sensor_obj_ctx_t *ctx = get_ctx(obj);
+
+    for (uint16_t i = 0; i < GOLDEN_SENSOR_OBJ_INST_COUNT; i++) {
+        if (ctx->obj_insts_ids[i].iid == iid) {
+            return &ctx->obj_insts[i];
+        }
+    }
+    return NULL;
+}
+
+static history_res_inst_t *get_res_inst_history(golden_sensor_obj_inst_t *inst, const anj_riid_t riid) {
+    for (uint16_t i = 0; i < HISTORY_RES_INST_COUNT; i++) {
+        if (inst->history_res_insts_ids[i] == riid) {
+            return &inst->history_res_insts[i];
+        }
+    }
+    return NULL;
+}
+
+static int res_read_float(anj_t *anj,
+                          golden_sensor_obj_inst_t *inst,
+                          anj_riid_t riid,
+                          anj_res_value_t *out_value) {
+    // TODO: Implement write to out_value
+    // out_value->double_value = ...
+    return ANJ_DM_ERR_NOT_IMPLEMENTED;
+}
+
+static int res_read_counter(anj_t *anj,
+                            golden_sensor_obj_inst_t *inst,
+                            anj_riid_t riid,
+                            anj_res_value_t *out_value) {
+    // TODO: Implement write to out_value
+    // out_value->int_value = ...
+    return ANJ_DM_ERR_NOT_IMPLEMENTED;
+}
+
+static int res_read_label(anj_t *anj,
+                          golden_sensor_obj_inst_t *inst,
+                          anj_riid_t riid,
+                          anj_res_value_t *out_value) {
+    // TODO: Implement write to out_value
+    // out_value->bytes_or_string.data = ...
+    return ANJ_DM_ERR_NOT_IMPLEMENTED;
+}
+
+static int res_read_raw_sample(anj_t *anj,
+                               golden_sensor_obj_inst_t *inst,
+                               anj_riid_t riid,
+                               anj_res_value_t *out_value) {
+    // TODO: Implement write to out_value
+    // out_value->bytes_or_string.data = ...
+    return ANJ_DM_ERR_NOT_IMPLEMENTED;
+}
+
+static int res_read_history(anj_t *anj,
+                            golden_sensor_obj_inst_t *inst,
+                            anj_riid_t riid,
+                            anj_res_value_t *out_value) {
+    history_res_inst_t *res_inst = get_res_inst_history(inst, riid);
+    // TODO: Implement write to out_value
+    // out_value->double_value = ...
+    return ANJ_DM_ERR_NOT_IMPLEMENTED;
+}
+
+typedef int res_read_handler_t(anj_t *anj,
+                               golden_sensor_obj_inst_t *inst,
+                               anj_riid_t riid,
+                               anj_res_value_t *out_value);
+
+static res_read_handler_t *const RES_READ_HANDLERS[RID_IDX_COUNT] = {
+    [RID_FLOAT_IDX] = res_read_float,
+    [RID_COUNTER_IDX] = res_read_counter,
+    [RID_LABEL_IDX] = res_read_label,
+    [RID_RAW_SAMPLE_IDX] = res_read_raw_sample,
+    [RID_HISTORY_IDX] = res_read_history,
+};
+
+static int res_read(anj_t *anj,
+                    const anj_dm_obj_t *obj,
+                    anj_iid_t iid,
+                    anj_rid_t rid,
+                    anj_riid_t riid,
+                    anj_res_value_t *out_value) {
+    golden_sensor_obj_inst_t *inst = get_obj_inst(obj, iid);
+    int idx = rid_to_idx(rid);
+    if (idx < 0 || !RES_READ_HANDLERS[idx]) {
+        return ANJ_DM_ERR_NOT_FOUND;
+    }
+    return RES_READ_HANDLERS[idx](anj, inst, riid, out_value);
+}
+
+static int res_write_label(anj_t *anj,
+                           golden_sensor_obj_inst_t *inst,
+                           anj_riid_t riid,
+                           const anj_res_value_t *value) {
+    // TODO: Implement read from value
+    // return anj_dm_write_string_chunked(value, /* TODO: */);
+    return ANJ_DM_ERR_NOT_IMPLEMENTED;
+}
+
+static int res_write_history(anj_t *anj,
+                             golden_sensor_obj_inst_t *inst,
+                             anj_riid_t riid,
+                             const anj_res_value_t *value) {
+    history_res_inst_t *res_inst = get_res_inst_history(inst, riid);
+    // TODO: Implement read from value
+    // ... =  value->double_value;
+    return ANJ_DM_ERR_NOT_IMPLEMENTED;
+}
+
+typedef int res_write_handler_t(anj_t *anj,
+                                golden_sensor_obj_inst_t *inst,
+                                anj_riid_t riid,
+                                const anj_res_value_t *value);
+
+static res_write_handler_t *const RES_WRITE_HANDLERS[RID_IDX_COUNT] = {
+    [RID_LABEL_IDX] = res_write_label,
+    [RID_HISTORY_IDX] = res_write_history,
+};
+
+static int res_write(anj_t *anj,
+                     const anj_dm_obj_t *obj,
+                     anj_iid_t iid,
+                     anj_rid_t rid,
+                     anj_riid_t riid,
+                     const anj_res_value_t *value) {
+    golden_sensor_obj_inst_t *inst = get_obj_inst(obj, iid);
+    int idx = rid_to_idx(rid);
+    if (idx < 0 || !RES_WRITE_HANDLERS[idx]) {
+        return ANJ_DM_ERR_NOT_FOUND;
+    }
+    return RES_WRITE_HANDLERS[idx](anj, inst, riid, value);
+}
+
+static int res_execute_reset(anj_t *anj,
+                             golden_sensor_obj_inst_t *inst,
+                             const char *execute_arg,
+                             size_t execute_arg_len) {
+    // TODO: Implement execute logic
+    return ANJ_DM_ERR_NOT_IMPLEMENTED;
+}
+
+typedef int res_execute_handler_t(anj_t *anj,
+                                  golden_sensor_obj_inst_t *inst,
+                                  const char *execute_arg,
+                                  size_t execute_arg_len);
+
+static res_execute_handler_t *const RES_EXECUTE_HANDLERS[RID_IDX_COUNT] = {
+    [RID_RESET_IDX] = res_execute_reset,
+};
+
+static int res_execute(anj_t *anj,
+                       const anj_dm_obj_t *obj,
+                       anj_iid_t iid,
+                       anj_rid_t rid,
+                       const char *execute_arg,
+                       size_t execute_arg_len) {
+    golden_sensor_obj_inst_t *inst = get_obj_inst(obj, iid);
+    int idx = rid_to_idx(rid);
+    if (idx < 0 || !RES_EXECUTE_HANDLERS[idx]) {
+        return ANJ_DM_ERR_NOT_FOUND;
+    }
+    return RES_EXECUTE_HANDLERS[idx](anj, inst, execute_arg,
+                                     execute_arg_len);
+}
+
+static int inst_reset(anj_t *anj, const anj_dm_obj_t *obj, anj_iid_t iid) {
+
+    golden_sensor_obj_ctx_t *ctx = get_ctx(obj);
+
+    for (size_t i = 0; i < GOLDEN_SENSOR_OBJ_INST_COUNT; i++) {
+        if (ctx->obj_insts_ids[i].iid == iid) {
+            init_obj_inst(ctx, i, iid);
+            return 0;
+        }
+    }
+
+    return ANJ_DM_ERR_NOT_FOUND;
+}
+
+static const anj_dm_handlers_t OBJECT_HANDLERS = {
+    .res_read = res_read,
+    .res_write = res_write,
+    .res_execute = res_execute,
+    .inst_reset = inst_reset,
+};
+
+static golden_sensor_obj_ctx_t object_ctx = {
+    .object = {
+        .oid = GOLDEN_SENSOR_OBJ_OID,
+        .handlers = &OBJECT_HANDLERS,
+        .max_inst_count = GOLDEN_SENSOR_OBJ_INST_COUNT,
+    },
+
+    // TODO: Initialize object-specific state here
+    // .obj_insts[0] = { ... }
+};
+
+static inline golden_sensor_obj_ctx_t *get_ctx(const anj_dm_obj_t *obj) {
+    (void) obj; // Can be used to retrieve context
+                // from object pointer using ANJ_CONTAINER_OF if needed
+    return &object_ctx;
+}
+
+static anj_dm_res_t resources[GOLDEN_SENSOR_OBJ_INST_COUNT][RID_IDX_COUNT];
+
+static void
+init_obj_inst(golden_sensor_obj_ctx_t *ctx, size_t index, anj_iid_t iid) {
+    memcpy(&resources[index], &resources_defs, sizeof(resources_defs));
+
+    // Initialize resource instances
+    resources[index][RID_HISTORY_IDX].insts =
+            ctx->obj_insts[index].history_res_insts_ids;
+    resources[index][RID_HISTORY_IDX].max_inst_count = HISTORY_RES_INST_COUNT;
+
+    for (uint16_t j = 0; j < HISTORY_RES_INST_COUNT; j++) {
+        // Initialize resource instance id
+        ctx->obj_insts[index].history_res_insts_ids[j] = j;
+
+        // TODO: Initialize resource instances
+        // ctx->obj_insts[index].history_res_insts[j]. ... = ...
+    }
+
+    ctx->obj_insts_ids[index].iid = iid; // Assigning instance IDs
+    ctx->obj_insts_ids[index].res_count = RID_IDX_COUNT;
+    ctx->obj_insts_ids[index].resources = resources[index];
+#ifdef ANJ_DM_WITH_RID_INDEX
+    ctx->obj_insts_ids[index].rid_index = RID_INDEX;
+    ctx->obj_insts_ids[index].rid_index_first = RID_INDEX_FIRST;
+    ctx->obj_insts_ids[index].rid_index_size = ANJ_ARRAY_SIZE(RID_INDEX);
+#endif // ANJ_DM_WITH_RID_INDEX
+
+    // TODO: Object instance specific state initialization
+    // ctx->obj_insts[index] = { ... };
+}
+
+const anj_dm_obj_t *golden_sensor_object_create(void) {
+    golden_sensor_obj_ctx_t *ctx = get_ctx(NULL);
+
+    for (uint16_t i = 0; i < GOLDEN_SENSOR_OBJ_INST_COUNT; i++) {
+        init_obj_inst(ctx, i, i);
+    }
+    ctx->object.insts = ctx->obj_insts_ids;
+
+    // TODO: Dynamic object initialization logic here
+
+    return &ctx->object;
+}
+
@@ -0,0 +1,421 @@
+/**
+ * Generated by anjay_codegen.py on 1970-01-01 00:00:00
+ *
+ * LwM2M Object: Golden Sensor
+ * ID: 32000, URN: urn:oma:lwm2m:x:32000, Optional, Multiple
+ *
+ * Object covering the resource kinds handled differently by the code
+ * generator options.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/dm/core.h>
+#include <anj/persistence.h>
+#include <anj/utils.h>
+
+#define GOLDEN_SENSOR_OBJ_OID 32000
+#define GOLDEN_SENSOR_OBJ_INST_COUNT 2
+
+enum {
+    /**
+     * Float: R, Single, Mandatory
+     * type: float, range: N/A, units: Cel
+     * Measured value.
+     */
+    RID_FLOAT = 0,
+    /**
+     * Counter: R, Single, Optional
+     * type: integer, range: N/A, units: N/A
+     * Number of measurements.
+     */
+    RID_COUNTER = 1,
+    /**
+     * Label: RW, Single, Optional
+     * type: string, range: N/A, units: N/A
+     * Name of the sensor.
+     */
+    RID_LABEL = 2,
+    /**
+     * Raw Sample: R, Single, Optional
+     * type: opaque, range: N/A, units: N/A
+     * Last sample as read from the sensor.
+     */
+    RID_RAW_SAMPLE = 3,
+    /**
+     * History: RW, Multiple, Optional
+     * type: float, range: N/A, units: Cel
+     * Previous measured values.
+     */
+    RID_HISTORY = 4,
+    /**
+     * Reset: E, Single, Optional
+     * type: N/A, range: N/A, units: N/A
+     * Resets the measurements.
+     */
+    RID_RESET = 5,
+};
+
+enum {
+    RID_FLOAT_IDX,
+    RID_COUNTER_IDX,
+    RID_LABEL_IDX,
+    RID_RAW_SAMPLE_IDX,
+    RID_HISTORY_IDX,
+    RID_RESET_IDX,
+    RID_IDX_COUNT
+};
+
+static anj_dm_res_t resources_defs[] = {
+    [RID_FLOAT_IDX] = {
+        .rid = RID_FLOAT,
+        .type = ANJ_DATA_TYPE_DOUBLE,
+        .kind = ANJ_DM_RES_R,
+    },
+    [RID_COUNTER_IDX] = {
+        .rid = RID_COUNTER,
+        .type = ANJ_DATA_TYPE_INT,
+        .kind = ANJ_DM_RES_R,
+    },
+    [RID_LABEL_IDX] = {
+        .rid = RID_LABEL,
+        .type = ANJ_DATA_TYPE_STRING,
+        .kind = ANJ_DM_RES_RW,
+    },
+    [RID_RAW_SAMPLE_IDX] = {
+        .rid = RID_RAW_SAMPLE,
+        .type = ANJ_DATA_TYPE_BYTES,
+        .kind = ANJ_DM_RES_R,
+    },
+    [RID_HISTORY_IDX] = {
+        .rid = RID_HISTORY,
+        .type = ANJ_DATA_TYPE_DOUBLE,
+        .kind = ANJ_DM_RES_RWM,
+    },
+    [RID_RESET_IDX] = {
+        .rid = RID_RESET,
+        .kind = ANJ_DM_RES_E,
+    },
+};
+
+ANJ_STATIC_ASSERT(RID_IDX_COUNT == ANJ_ARRAY_SIZE(resources_defs),
+                  golden_sensor_object_resource_count_mismatch);
+
+
+#define HISTORY_RES_INST_COUNT 2
+
+typedef struct {
+    // TODO: Add resource instance specific state here
+} history_res_inst_t;
+
+
+typedef struct {
+    anj_riid_t history_res_insts_ids[HISTORY_RES_INST_COUNT];
+    history_res_inst_t history_res_insts[HISTORY_RES_INST_COUNT];
+
+    // TODO: Add object instance specific state here
+} golden_sensor_obj_inst_t;
+
+typedef struct {
+    anj_dm_obj_t object;
+    anj_dm_obj_inst_t obj_insts_ids[GOLDEN_SENSOR_OBJ_INST_COUNT];
+    golden_sensor_obj_inst_t obj_insts[GOLDEN_SENSOR_OBJ_INST_COUNT];
+} golden_sensor_obj_ctx_t;
+
+static void
+init_obj_inst(golden_sensor_obj_ctx_t *ctx, size_t index, anj_iid_t iid);
+
+static golden_sensor_obj_ctx_t *get_ctx(const anj_dm_obj_t *obj);
+
+static golden_sensor_obj_inst_t *get_obj_inst(const anj_dm_obj_t *obj, anj_iid_t iid) {
+    if (iid == ANJ_ID_INVALID) {
+        return NULL;
+    }
+
+    golden_sensor_obj_ctx_t *ctx = get_ctx(obj);
+
+    for (uint16_t i = 0; i < GOLDEN_SENSOR_OBJ_INST_COUNT; i++) {
+        if (ctx->obj_insts_ids[i].iid == iid) {
+            return &ctx->obj_insts[i];
+        }
+    }
+    return NULL;
+}
+
+static history_res_inst_t *get_res_inst_history(golden_sensor_obj_inst_t *inst, const anj_riid_t riid) {
+    for (uint16_t i = 0; i < HISTORY_RES_INST_COUNT; i++) {
+        if (inst->history_res_insts_ids[i] == riid) {
+            return &inst->history_res_insts[i];
+        }
+    }
+    return NULL;
+}
+
+static int res_read(anj_t *anj,
+                    const anj_dm_obj_t *obj,
+                    anj_iid_t iid,
+                    anj_rid_t rid,
+                    anj_riid_t riid,
+                    anj_res_value_t *out_value) {
+
+    golden_sensor_obj_inst_t *inst = get_obj_inst(obj, iid);
+   
+    switch (rid) {
+    case RID_FLOAT: {
+        // TODO: Implement write to out_value
+        // out_value->double_value = ...
+        return ANJ_DM_ERR_NOT_IMPLEMENTED;
+    }
+    case RID_COUNTER: {
+        // TODO: Implement write to out_value
+        // out_value->int_value = ...
+        return ANJ_DM_ERR_NOT_IMPLEMENTED;
+    }
+    case RID_LABEL: {
+        // TODO: Implement write to out_value
+        // out_value->bytes_or_string.data = ...
+        return ANJ_DM_ERR_NOT_IMPLEMENTED;
+    }
+    case RID_RAW_SAMPLE: {
+        // TODO: Implement write to out_value
+        // out_value->bytes_or_string.data = ...
+        return ANJ_DM_ERR_NOT_IMPLEMENTED;
+    }
+    case RID_HISTORY: {
+        history_res_inst_t *res_inst = get_res_inst_history(inst, riid);
+        // TODO: Implement write to out_value
+        // out_value->double_value = ...
+        return ANJ_DM_ERR_NOT_IMPLEMENTED;
+    }
+    default:
+        return ANJ_DM_ERR_NOT_FOUND;
+    }
+}
+
+static int res_write(anj_t *anj,
+                     const anj_dm_obj_t *obj,
+                     anj_iid_t iid,
+                     anj_rid_t rid,
+                     anj_riid_t riid,
+                     const anj_res_value_t *value) {
+
+    golden_sensor_obj_inst_t *inst = get_obj_inst(obj, iid);
+    switch (rid) {
+    case RID_LABEL: {
+        // TODO: Implement read from value
+        // return anj_dm_write_string_chunked(value, /* TODO: */);
+        return ANJ_DM_ERR_NOT_IMPLEMENTED;
+    }
+    case RID_HISTORY: {
+        history_res_inst_t *res_inst = get_res_inst_history(inst, riid);
+        // TODO: Implement read from value
+        // ... =  value->double_value;
+        return ANJ_DM_ERR_NOT_IMPLEMENTED;
+    }
+    default:
+        return ANJ_DM_ERR_NOT_FOUND;
+    }
+}
+
+static int res_execute(anj_t *anj,
+                       const anj_dm_obj_t *obj,
+                       anj_iid_t iid,
+                       anj_rid_t rid,
+                       const char *execute_arg,
+                       size_t execute_arg_len) {
+
+    golden_sensor_obj_inst_t *inst = get_obj_inst(obj, iid);
+   
+    switch (rid) {
+    case RID_RESET: {
+        // TODO: Implement execute logic
+        return ANJ_DM_ERR_NOT_IMPLEMENTED;
+    }
+    default:
+        return ANJ_DM_ERR_NOT_FOUND;
+    }
+}
+
+static int inst_reset(anj_t *anj, const anj_dm_obj_t *obj, anj_iid_t iid) {
+
+    golden_sensor_obj_ctx_t *ctx = get_ctx(obj);
+
+    for (size_t i = 0; i < GOLDEN_SENSOR_OBJ_INST_COUNT; i++) {
+        if (ctx->obj_insts_ids[i].iid == iid) {
+            init_obj_inst(ctx, i, iid);
+            return 0;
+        }
+    }
+
+    return ANJ_DM_ERR_NOT_FOUND;
+}
+
+static const anj_dm_handlers_t OBJECT_HANDLERS = {
+    .res_read = res_read,
+    .res_write = res_write,
+    .res_execute = res_execute,
+    .inst_reset = inst_reset,
+};
+
+static golden_sensor_obj_ctx_t object_ctx = {
+    .object = {
+        .oid = GOLDEN_SENSOR_OBJ_OID,
+        .handlers = &OBJECT_HANDLERS,
+        .max_inst_count = GOLDEN_SENSOR_OBJ_INST_COUNT,
+    },
+
+    // TODO: Initialize object-specific state here
+    // .obj_insts[0] = { ... }
+};
+
+static inline golden_sensor_obj_ctx_t *get_ctx(const anj_dm_obj_t *obj) {
+    (void) obj; // Can be used to retrieve context
+                // from object pointer using ANJ_CONTAINER_OF if needed
+    return &object_ctx;
+}
+
+static anj_dm_res_t resources[GOLDEN_SENSOR_OBJ_INST_COUNT][RID_IDX_COUNT];
+
+static void
+init_obj_inst(golden_sensor_obj_ctx_t *ctx, size_t index, anj_iid_t iid) {
+    memcpy(&resources[index], &resources_defs, sizeof(resources_defs));
+
+    // Initialize resource instances
+    resources[index][RID_HISTORY_IDX].insts =
+            ctx->obj_insts[index].history_res_insts_ids;
+    resources[index][RID_HISTORY_IDX].max_inst_count = HISTORY_RES_INST_COUNT;
+
+    for (uint16_t j = 0; j < HISTORY_RES_INST_COUNT; j++) {
+        // Initialize resource instance id
+        ctx->obj_insts[index].history_res_insts_ids[j] = j;
+
+        // TODO: Initialize resource instances
+        // ctx->obj_insts[index].history_res_insts[j]. ... = ...
+    }
+
+    ctx->obj_insts_ids[index].iid = iid; // Assigning instance IDs
+    ctx->obj_insts_ids[index].res_count = RID_IDX_COUNT;
+    ctx->obj_insts_ids[index].resources = resources[index];
+
+    // TODO: Object instance specific state initialization
+    // ctx->obj_insts[index] = { ... };
+}
+
+const anj_dm_obj_t *golden_sensor_object_create(void) {
+    golden_sensor_obj_ctx_t *ctx = get_ctx(NULL);
+
+    for (uint16_t i = 0; i < GOLDEN_SENSOR_OBJ_INST_COUNT; i++) {
+        init_obj_inst(ctx, i, i);
+    }
+    ctx->object.insts = ctx->obj_insts_ids;
+
+    // TODO: Dynamic object initialization logic here
+
+    return &ctx->object;
+}
+
+#ifdef ANJ_WITH_PERSISTENCE
+// ID and version of the Object definition, so that a state stored for another
+// definition of the Object is rejected
+static const char PERSISTENCE_MAGIC[] = "32000:1.0";
+
+// Restored Object Instances are kept here until all of them are read and
+// validated, and only then replace the current ones
+static golden_sensor_obj_inst_t restored_insts[GOLDEN_SENSOR_OBJ_INST_COUNT];
+
+// IDs of existing Instances must be sorted and precede ANJ_ID_INVALID ones
+static bool
+restored_ids_valid(const uint16_t *ids, uint16_t count, bool may_be_absent) {
+    for (uint16_t i = 0; i < count; i++) {
+        if (ids[i] == ANJ_ID_INVALID) {
+            if (!may_be_absent) {
+                return false;
+            }
+        } else if (i > 0
+                   && (ids[i - 1] == ANJ_ID_INVALID || ids[i - 1] >= ids[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int validate_restored_insts(const anj_iid_t *iids) {
+    if (!restored_ids_valid(iids, GOLDEN_SENSOR_OBJ_INST_COUNT, false)) {
+        return -1;
+    }
+    for (uint16_t i = 0; i < GOLDEN_SENSOR_OBJ_INST_COUNT; i++) {
+        if (iids[i] == ANJ_ID_INVALID) {
+            continue;
+        }
+        if (!restored_ids_valid(restored_insts[i].history_res_insts_ids,
+                                HISTORY_RES_INST_COUNT, false)) {
+            return -1;
+        }
+        // TODO: Validate the restored state of the Object Instance
+        // restored_insts[i]. ...
+    }
+    return 0;
+}
+
+int golden_sensor_object_store(const anj_persistence_context_t *ctx) {
+    assert(ctx && anj_persistence_direction(ctx) == ANJ_PERSISTENCE_STORE);
+    golden_sensor_obj_ctx_t *obj_ctx = get_ctx(NULL);
+
+    uint32_t record_size = (uint32_t) sizeof(golden_sensor_obj_inst_t);
+    anj_iid_t iids[GOLDEN_SENSOR_OBJ_INST_COUNT];
+    for (uint16_t i = 0; i < GOLDEN_SENSOR_OBJ_INST_COUNT; i++) {
+        iids[i] = obj_ctx->obj_insts_ids[i].iid;
+    }
+    if (anj_persistence_magic(ctx, PERSISTENCE_MAGIC,
+                              sizeof(PERSISTENCE_MAGIC) - 1)
+            || anj_persistence_u32(ctx, &record_size)
+            || anj_persistence_bytes(ctx, iids, sizeof(iids))) {
+        return -1;
+    }
+    // whole Object Instance is written at once
+    for (uint16_t i = 0; i < GOLDEN_SENSOR_OBJ_INST_COUNT; i++) {
+        if (anj_persistence_bytes(ctx, &obj_ctx->obj_insts[i],
+                                  sizeof(obj_ctx->obj_insts[i]))) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int golden_sensor_object_restore(const anj_persistence_context_t *ctx) {
+    assert(ctx && anj_persistence_direction(ctx) == ANJ_PERSISTENCE_RESTORE);
+    golden_sensor_obj_ctx_t *obj_ctx = get_ctx(NULL);
+
+    uint32_t record_size;
+    anj_iid_t iids[GOLDEN_SENSOR_OBJ_INST_COUNT];
+    if (anj_persistence_magic(ctx, PERSISTENCE_MAGIC,
+                              sizeof(PERSISTENCE_MAGIC) - 1)
+            || anj_persistence_u32(ctx, &record_size)
+            || record_size != sizeof(golden_sensor_obj_inst_t)
+            || anj_persistence_bytes(ctx, iids, sizeof(iids))) {
+        return -1;
+    }
+    for (uint16_t i = 0; i < GOLDEN_SENSOR_OBJ_INST_COUNT; i++) {
+        if (anj_persistence_bytes(ctx, &restored_insts[i],
+                                  sizeof(restored_insts[i]))) {
+            return -1;
+        }
+    }
+    if (validate_restored_insts(iids)) {
+        return -1;
+    }
+
+    // nothing has been modified so far, replace all Object Instances at once
+    for (uint16_t i = 0; i < GOLDEN_SENSOR_OBJ_INST_COUNT; i++) {
+        init_obj_inst(obj_ctx, i, iids[i]);
+        obj_ctx->obj_insts[i] = restored_insts[i];
+    }
+    return 0;
+}
+#endif // ANJ_WITH_PERSISTENCE
@@ -0,0 +1,376 @@
+/**
+ * Generated by anjay_codegen.py on 1970-01-01 00:00:00
+ *
+ * LwM2M Object: Golden Sensor
+ * ID: 32000, URN: urn:oma:lwm2m:x:32000, Optional, Multiple
+ *
+ * Object covering the resource kinds handled differently by the code
+ * generator options.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <anj/core.h>
+#include <anj/defs.h>
+#include <anj/dm/core.h>
+#include <anj/utils.h>
+
+#define GOLDEN_SENSOR_OBJ_OID 32000
+
+enum {
+    /**
+     * Float: R, Single, Mandatory
+     * type: float, range: N/A, units: Cel
+     * Measured value.
+     */
+    RID_FLOAT = 0,
+    /**
+     * Counter: R, Single, Optional
+     * type: integer, range: N/A, units: N/A
+     * Number of measurements.
+     */
+    RID_COUNTER = 1,
+    /**
+     * Label: RW, Single, Optional
+     * type: string, range: N/A, units: N/A
+     * Name of the sensor.
+     */
+    RID_LABEL = 2,
+    /**
+     * Raw Sample: R, Single, Optional
+     * type: opaque, range: N/A, units: N/A
+     * Last sample as read from the sensor.
+     */
+    RID_RAW_SAMPLE = 3,
+    /**
+     * History: RW, Multiple, Optional
+     * type: float, range: N/A, units: Cel
+     * Previous measured values.
+     */
+    RID_HISTORY = 4,
+    /**
+     * Reset: E, Single, Optional
+     * type: N/A, range: N/A, units: N/A
+     * Resets the measurements.
+     */
+    RID_RESET = 5,
+};
+
+enum {
+    RID_FLOAT_IDX,
+    RID_COUNTER_IDX,
+    RID_LABEL_IDX,
+    RID_RAW_SAMPLE_IDX,
+    RID_HISTORY_IDX,
+    RID_RESET_IDX,
+    RID_IDX_COUNT
+};
+
+static anj_dm_res_t resources_defs[] = {
+    [RID_FLOAT_IDX] = {
+        .rid = RID_FLOAT,
+        .type = ANJ_DATA_TYPE_DOUBLE,
+        .kind = ANJ_DM_RES_R,
+    },
+    [RID_COUNTER_IDX] = {
+        .rid = RID_COUNTER,
+        .type = ANJ_DATA_TYPE_INT,
+        .kind = ANJ_DM_RES_R,
+    },
+    [RID_LABEL_IDX] = {
+        .rid = RID_LABEL,
+        .type = ANJ_DATA_TYPE_STRING,
+        .kind = ANJ_DM_RES_RW,
+    },
+    [RID_RAW_SAMPLE_IDX] = {
+        .rid = RID_RAW_SAMPLE,
+        .type = ANJ_DATA_TYPE_BYTES,
+        .kind = ANJ_DM_RES_R,
+    },
+    [RID_HISTORY_IDX] = {
+        .rid = RID_HISTORY,
+        .type = ANJ_DATA_TYPE_DOUBLE,
+        .kind = ANJ_DM_RES_RWM,
+    },
+    [RID_RESET_IDX] = {
+        .rid = RID_RESET,
+        .kind = ANJ_DM_RES_E,
+    },
+};
+
+ANJ_STATIC_ASSERT(RID_IDX_COUNT == ANJ_ARRAY_SIZE(resources_defs),
+                  golden_sensor_object_resource_count_mismatch);
+
+
+#define HISTORY_RES_INST_COUNT 2
+
+typedef struct {
+    // TODO: Add resource-instance-specific state here
+} history_res_inst_t;
+
+static anj_riid_t history_res_insts_ids[HISTORY_RES_INST_COUNT];
+
+static history_res_inst_t history_res_insts[HISTORY_RES_INST_COUNT];
+
+static history_res_inst_t *get_res_inst_history(anj_riid_t riid) {
+    for (uint16_t i = 0; i < HISTORY_RES_INST_COUNT; i++) {
+        if (history_res_insts_ids[i] == riid) {
+            return &history_res_insts[i];
+        }
+    }
+    return NULL;
+}
+
+// TODO: Change size of the label value buffer if needed
+#define LABEL_VALUE_BUFFER_SIZE 64
+// TODO: Change size of the raw_sample value buffer if needed
+#define RAW_SAMPLE_VALUE_BUFFER_SIZE 64
+
+// Values of all readable Single-Instance Resources of an Object Instance,
+// served by res_read() and refreshed at once by res_read_batch()
+typedef struct {
+    size_t raw_sample_size;
+    double float_;
+    int64_t counter;
+    char label[LABEL_VALUE_BUFFER_SIZE];
+    uint8_t raw_sample[RAW_SAMPLE_VALUE_BUFFER_SIZE];
+} golden_sensor_values_t;
+typedef struct {
+    anj_dm_obj_t object;
+    golden_sensor_values_t values;
+    // TODO: Add object-specific state here
+} golden_sensor_obj_ctx_t;
+
+static golden_sensor_obj_ctx_t *get_ctx(const anj_dm_obj_t *obj);
+
+static int res_read(anj_t *anj,
+                    const anj_dm_obj_t *obj,
+                    anj_iid_t iid,
+                    anj_rid_t rid,
+                    anj_riid_t riid,
+                    anj_res_value_t *out_value) {
+
+    golden_sensor_obj_ctx_t *ctx = get_ctx(obj);
+   
+    switch (rid) {
+    case RID_FLOAT: {
+        out_value->double_value = ctx->values.float_;
+        return 0;
+    }
+    case RID_COUNTER: {
+        out_value->int_value = ctx->values.counter;
+        return 0;
+    }
+    case RID_LABEL: {
+        // null-terminated, its length is determined by the library
+        out_value->bytes_or_string.data = ctx->values.label;
+        return 0;
+    }
+    case RID_RAW_SAMPLE: {
+        out_value->bytes_or_string.data = ctx->values.raw_sample;
+        out_value->bytes_or_string.chunk_length = ctx->values.raw_sample_size;
+        return 0;
+    }
+    case RID_HISTORY: {
+        history_res_inst_t *res_inst = get_res_inst_history(riid);
+        // TODO: Implement write to out_value
+        // out_value->double_value = ...
+        return ANJ_DM_ERR_NOT_IMPLEMENTED;
+    }
+    default:
+        return ANJ_DM_ERR_NOT_FOUND;
+    }
+}
+
+static int res_write(anj_t *anj,
+                     const anj_dm_obj_t *obj,
+                     anj_iid_t iid,
+                     anj_rid_t rid,
+                     anj_riid_t riid,
+                     const anj_res_value_t *value) {
+
+    golden_sensor_obj_ctx_t *ctx = get_ctx(obj);
+    switch (rid) {
+    case RID_LABEL: {
+        // TODO: Implement read from value
+        // return anj_dm_write_string_chunked(value, /* TODO: */);
+        return ANJ_DM_ERR_NOT_IMPLEMENTED;
+    }
+    case RID_HISTORY: {
+        history_res_inst_t *res_inst = get_res_inst_history(riid);
+        // TODO: Implement read from value
+        // ... =  value->double_value;
+        return ANJ_DM_ERR_NOT_IMPLEMENTED;
+    }
+    default:
+        return ANJ_DM_ERR_NOT_FOUND;
+    }
+}
+
+static int res_execute(anj_t *anj,
+                       const anj_dm_obj_t *obj,
+                       anj_iid_t iid,
+                       anj_rid_t rid,
+                       const char *execute_arg,
+                       size_t execute_arg_len) {
+
+    golden_sensor_obj_ctx_t *ctx = get_ctx(obj);
+   
+    switch (rid) {
+    case RID_RESET: {
+        // TODO: Implement execute logic
+        return ANJ_DM_ERR_NOT_IMPLEMENTED;
+    }
+    default:
+        return ANJ_DM_ERR_NOT_FOUND;
+    }
+}
+
+#ifdef ANJ_DM_WITH_RES_READ_BATCH
+static int res_read_batch(anj_t *anj,
+                          const anj_dm_obj_t *obj,
+                          anj_iid_t iid,
+                          const anj_rid_t *rids,
+                          size_t rids_count) {
+    golden_sensor_obj_ctx_t *ctx = get_ctx(obj);
+    // TODO: Refresh values of the instance, e.g. fetch all of them from the
+    // peripheral in a single transaction. If rids is not NULL, only Resources
+    // listed there will be read.
+    // ctx->values.float_ = ...
+    // ctx->values.counter = ...
+    // ctx->values.label = ...
+    // ctx->values.raw_sample = ...
+    return 0;
+}
+#endif // ANJ_DM_WITH_RES_READ_BATCH
+
+static int inst_reset(anj_t *anj, const anj_dm_obj_t *obj, anj_iid_t iid) {
+
+    golden_sensor_obj_ctx_t *ctx = get_ctx(obj);
+
+    // TODO: Reset object context
+    return ANJ_DM_ERR_NOT_IMPLEMENTED;
+}
+
+static const anj_dm_handlers_t OBJECT_HANDLERS = {
+    .res_read = res_read,
+#ifdef ANJ_DM_WITH_RES_READ_BATCH
+    .res_read_batch = res_read_batch,
+#endif // ANJ_DM_WITH_RES_READ_BATCH
+    .res_write = res_write,
+    .res_execute = res_execute,
+    .inst_reset = inst_reset,
+};
+
+// Single instance object
+static const anj_dm_obj_inst_t INSTANCE = {
+    .iid = 0,
+    .res_count = RID_IDX_COUNT,
+    .resources = resources_defs,
+};
+
+static golden_sensor_obj_ctx_t object_ctx = {
+    .object = {
+        .oid = GOLDEN_SENSOR_OBJ_OID,
+        .handlers = &OBJECT_HANDLERS,
+        .insts = &INSTANCE,
+        .max_inst_count = 1, // single instance object
+    }
+    // TODO: Initialize object-specific state here
+};
+
+static inline golden_sensor_obj_ctx_t *get_ctx(const anj_dm_obj_t *obj) {
+    (void) obj; // Can be used to retrieve context from
+                // object pointer using ANJ_CONTAINER_OF if needed
+    return &object_ctx;
+}
+
+const anj_dm_obj_t *golden_sensor_object_create(void) {
+    golden_sensor_obj_ctx_t *ctx = get_ctx(NULL);
+    
+    // history resource initialization
+    resources_defs[RID_HISTORY_IDX].max_inst_count = HISTORY_RES_INST_COUNT;
+    resources_defs[RID_HISTORY_IDX].insts = history_res_insts_ids;
+
+    for (uint16_t i = 0; i < HISTORY_RES_INST_COUNT; i++) {
+        history_res_insts_ids[i] = i; // Initialize resource instance id
+
+        // TODO: Initialize resource instances
+        // history_res_insts[i]. ... = ...
+    }
+    // TODO: Dynamic object initialization logic here
+
+    return &ctx->object;
+}
+
+// TODO: Change the deadband of the float value if needed; smaller
+// changes are neither stored nor signalled
+#define FLOAT_DEADBAND 0.0
+
+// Setters of the packed values. A value is stored and the change is signalled
+// to the library only if it differs from the stored one, so call them with
+// every new sample instead of anj_core_data_model_changed().
+int golden_sensor_set_float(anj_t *anj, double value) {
+    golden_sensor_obj_ctx_t *ctx = get_ctx(NULL);
+    double diff = value - ctx->values.float_;
+    if (!(diff > FLOAT_DEADBAND || -diff > FLOAT_DEADBAND)) {
+        return 0;
+    }
+    ctx->values.float_ = value;
+    anj_core_data_model_changed(anj,
+                                &ANJ_MAKE_RESOURCE_PATH(GOLDEN_SENSOR_OBJ_OID, 0, RID_FLOAT),
+                                ANJ_CORE_CHANGE_TYPE_VALUE_CHANGED);
+    return 0;
+}
+
+int golden_sensor_set_counter(anj_t *anj, int64_t value) {
+    golden_sensor_obj_ctx_t *ctx = get_ctx(NULL);
+    if (value == ctx->values.counter) {
+        return 0;
+    }
+    ctx->values.counter = value;
+    anj_core_data_model_changed(anj,
+                                &ANJ_MAKE_RESOURCE_PATH(GOLDEN_SENSOR_OBJ_OID, 0, RID_COUNTER),
+                                ANJ_CORE_CHANGE_TYPE_VALUE_CHANGED);
+    return 0;
+}
+
+int golden_sensor_set_label(anj_t *anj, const char *value) {
+    golden_sensor_obj_ctx_t *ctx = get_ctx(NULL);
+    size_t len = strlen(value);
+    if (len >= sizeof(ctx->values.label)) {
+        return -1;
+    }
+    if (!strcmp(ctx->values.label, value)) {
+        return 0;
+    }
+    memcpy(ctx->values.label, value, len + 1);
+    anj_core_data_model_changed(anj,
+                                &ANJ_MAKE_RESOURCE_PATH(GOLDEN_SENSOR_OBJ_OID, 0, RID_LABEL),
+                                ANJ_CORE_CHANGE_TYPE_VALUE_CHANGED);
+    return 0;
+}
+
+int golden_sensor_set_raw_sample(anj_t *anj, const void *value, size_t size) {
+    golden_sensor_obj_ctx_t *ctx = get_ctx(NULL);
+    if (size > sizeof(ctx->values.raw_sample)) {
+        return -1;
+    }
+    if (size == ctx->values.raw_sample_size
+            && (!size || !memcmp(ctx->values.raw_sample, value, size))) {
+        return 0;
+    }
+    if (size) {
+        memcpy(ctx->values.raw_sample, value, size);
+    }
+    ctx->values.raw_sample_size = size;
+    anj_core_data_model_changed(anj,
+                                &ANJ_MAKE_RESOURCE_PATH(GOLDEN_SENSOR_OBJ_OID, 0, RID_RAW_SAMPLE),
+                                ANJ_CORE_CHANGE_TYPE_VALUE_CHANGED);
+    return 0;
+}
+
@@ -0,0 +1,64 @@
+#!/bin/bash
+# Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+# AVSystem Anjay Lite LwM2M SDK
+# All rights reserved.
+#
+# Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+# See the attached LICENSE file for details.
+
+# Compares the code generated for sensor.xml with the expected/ files, so that
+# every change of the templates shows up in the review. Run with --update to
+# regenerate the expected files after an intended change.
+
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+CODEGEN="$SCRIPT_DIR/../../../tools/anjay_codegen.py"
+INPUT="$SCRIPT_DIR/sensor.xml"
+EXPECTED_DIR="$SCRIPT_DIR/expected"
+
+# name and options of each case
+CASES=(
+    "plain:"
+    "dispatch_tables:-dt"
+    "packed_values:-pv"
+    "persistence:-ps"
+    "setters:-st"
+)
+INSTANCES=(
+    1
+    2
+)
+
+UPDATE=0
+if [[ "$1" == "--update" ]]; then
+    UPDATE=1
+fi
+
+# fixed generation date in the header comment
+export SOURCE_DATE_EPOCH=0
+
+OUTPUT_DIR="$(mktemp -d)"
+trap 'rm -rf "$OUTPUT_DIR"' EXIT
+
+FAILED=0
+for case in "${CASES[@]}"; do
+    name="${case%%:*}"
+    options="${case#*:}"
+    for instances in "${INSTANCES[@]}"; do
+        file="${name}_${instances}_inst.c"
+        "$CODEGEN" -i "$INPUT" -o "$OUTPUT_DIR/$file" -ni "$instances" $options
+        if [[ "$UPDATE" == 1 ]]; then
+            cp "$OUTPUT_DIR/$file" "$EXPECTED_DIR/$file"
+        elif ! diff -u "$EXPECTED_DIR/$file" "$OUTPUT_DIR/$file"; then
+            echo -e "\e[31mGenerated $file differs from the expected one\e[0m"
+            FAILED=1
+        fi
+    done
+done
+
+if [[ "$FAILED" == 1 ]]; then
+    echo "Run $0 --update if the change is intended"
+    exit 1
+fi
+echo -e "\e[32mCode generation golden tests: PASSED\e[0m"
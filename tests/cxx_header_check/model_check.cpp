@@ -0,0 +1,99 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/core.h>
+#include <anj/dm/core.h>
+#include <anj/dm/model.hpp>
+
+namespace {
+
+int res_read(anj_t *anj,
+             const anj_dm_obj_t *obj,
+             anj_iid_t iid,
+             anj_rid_t rid,
+             anj_riid_t riid,
+             anj_res_value_t *out_value);
+
+constexpr anj_dm_handlers_t HANDLERS = [] {
+    anj_dm_handlers_t handlers{};
+    handlers.res_read = res_read;
+    return handlers;
+}();
+
+// deliberately unsorted
+constexpr anj_dm_res_t DEFS[] = {
+    anj::dm::res(7, ANJ_DATA_TYPE_INT, ANJ_DM_RES_R),
+    anj::dm::res(0, ANJ_DATA_TYPE_STRING, ANJ_DM_RES_R),
+    anj::dm::res(3, ANJ_DATA_TYPE_BOOL, ANJ_DM_RES_R),
+};
+constexpr auto RESOURCES = anj::dm::make_resources(DEFS);
+using dispatch = anj::dm::rid_dispatch<RESOURCES>;
+
+static_assert(RESOURCES.defs[0].rid == 0 && RESOURCES.defs[1].rid == 3
+                      && RESOURCES.defs[2].rid == 7,
+              "Resources not sorted");
+static_assert(dispatch::first == 0 && dispatch::size == 8,
+              "unexpected Resource ID index range");
+static_assert(dispatch::index_of(3) == 1 && dispatch::index_of(7) == 2
+                      && dispatch::index_of(5) == -1
+                      && dispatch::index_of(8) == -1,
+              "unexpected Resource ID index");
+
+constexpr anj_dm_obj_inst_t INSTS[] = {
+    anj::dm::make_inst<RESOURCES>(1),
+    anj::dm::make_inst<RESOURCES>(4),
+};
+constexpr anj_dm_obj_t OBJ = anj::dm::make_obj(4321, "1.0", &HANDLERS, INSTS);
+
+int res_read(anj_t *anj,
+             const anj_dm_obj_t *obj,
+             anj_iid_t iid,
+             anj_rid_t rid,
+             anj_riid_t riid,
+             anj_res_value_t *out_value) {
+    (void) anj;
+    (void) obj;
+    (void) iid;
+    (void) riid;
+    switch (dispatch::index_of(rid)) {
+    case 0:
+        out_value->bytes_or_string.data = "model";
+        return 0;
+    case 1:
+        out_value->bool_value = true;
+        return 0;
+    case 2:
+        out_value->int_value = 42;
+        return 0;
+    default:
+        return ANJ_DM_ERR_NOT_FOUND;
+    }
+}
+
+} // namespace
+
+int main() {
+    static anj_t anj;
+    anj_configuration_t config{};
+    config.endpoint_name = "cxx-model-check";
+    if (anj_core_init(&anj, &config) || anj_dm_add_obj(&anj, &OBJ)) {
+        return 1;
+    }
+    anj_res_value_t value{};
+    anj_uri_path_t path{};
+    path.ids[ANJ_ID_OID] = 4321;
+    path.ids[ANJ_ID_IID] = 4;
+    path.ids[ANJ_ID_RID] = 7;
+    path.ids[ANJ_ID_RIID] = ANJ_ID_INVALID;
+    path.uri_len = 3;
+    if (anj_dm_res_read(&anj, &path, &value) || value.int_value != 42) {
+        return 1;
+    }
+    return 0;
+}
@@ -7,6 +7,11 @@
  * See the attached LICENSE file for details.
  */
 
+// for clock_gettime()
+#if !defined(_POSIX_C_SOURCE) && !defined(__APPLE__)
+#    define _POSIX_C_SOURCE 200809L
+#endif
+
 #include <assert.h>
 #include <getopt.h>
 #include <math.h>
@@ -18,6 +23,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include "anj_unit_test.h"
 
@@ -102,7 +108,15 @@ typedef struct {
     unit_test_ptr_t unit_test;
 } unit_test_element_t;
 
+typedef struct {
+    const char *suite_name;
+    const char *bench_name;
+    unit_test_ptr_t bench;
+    size_t runs;
+} bench_element_t;
+
 static list_t _suites_list;
+static list_t _benchmarks_list;
 static jmp_buf _anj_unit_jmp_buf;
 
 typedef enum {
@@ -240,6 +254,28 @@ void anj_unit_test_add(const char *suite_name,
     add_element(&suite_ele->unit_tests, new_element);
 }
 
+void anj_unit_bench_add(const char *suite_name,
+                        const char *bench_name,
+                        unit_test_ptr_t bench,
+                        size_t runs) {
+    assert(suite_name);
+    assert(bench_name);
+    assert(bench);
+    assert(runs > 0);
+
+    bench_element_t *new_element =
+            (bench_element_t *) calloc(1, sizeof(bench_element_t));
+    if (!new_element) {
+        anj_unit_abort__("Memory allocation failed\n", __FILE__, __LINE__);
+    }
+    new_element->suite_name = suite_name;
+    new_element->bench_name = bench_name;
+    new_element->bench = bench;
+    new_element->runs = runs;
+
+    add_element(&_benchmarks_list, new_element);
+}
+
 static void
 _anj_unit_assert_fail(const char *file, int line, const char *format, ...) {
     va_list list;
@@ -481,18 +517,22 @@ static void list_tests_for_suite(const suite_element_t *suite) {
 static int parse_command_line_args(int argc,
                                    char *argv[],
                                    const char *volatile *out_selected_suite,
-                                   const char *volatile *out_selected_test) {
+                                   const char *volatile *out_selected_test,
+                                   bool *out_bench,
+                                   const char **out_thresholds_file) {
     while (1) {
         static const struct option long_options[] = {
             { "help", no_argument, 0, 'h' },
             { "list", optional_argument, 0, 'l' },
+            { "bench", no_argument, 0, 'b' },
+            { "bench-thresholds", required_argument, 0, 't' },
             { 0, 0, 0, 0 }
         };
 
         int option_index = 0;
         int c;
 
-        c = getopt_long(argc, argv, "hl::v", long_options, &option_index);
+        c = getopt_long(argc, argv, "hl::bt:v", long_options, &option_index);
         if (c == -1)
             break;
 
@@ -510,7 +550,14 @@ static int parse_command_line_args(int argc,
                    "    -l, --list [TEST_SUITE_NAME] - list all available "
                    "test cases and exit. If TEST_SUITE_NAME is specified, "
                    "list only test cases that belong to given test "
-                   "suite.\n",
+                   "suite.\n"
+                   "    -b, --bench - run benchmarks instead of test cases, "
+                   "and report the median time and the median absolute "
+                   "deviation of their runs.\n"
+                   "    -t, --bench-thresholds FILE - with --bench, fail "
+                   "benchmarks with the median time greater than the one "
+                   "in FILE. Each line of FILE is either empty, a comment "
+                   "starting with '#', or 'SUITE NAME MAX_MEDIAN_NS'.\n",
                    argv[0], argv[0]);
             printf("EXAMPLES\n"
                    "    %s            # run all tests\n"
@@ -519,8 +566,10 @@ static int parse_command_line_args(int argc,
                    "'suite', do not run any\n"
                    "    %s suite      # run all tests from suite 'suite'\n"
                    "    %s suite case # run only test 'case' from suite "
+                   "'suite'\n"
+                   "    %s -b suite   # run all benchmarks from suite "
                    "'suite'\n",
-                   argv[0], argv[0], argv[0], argv[0], argv[0]);
+                   argv[0], argv[0], argv[0], argv[0], argv[0], argv[0]);
             return -1;
         case 'l': {
             suite_element_t *suite_ele;
@@ -546,6 +595,12 @@ static int parse_command_line_args(int argc,
             }
             return -1;
         }
+        case 'b':
+            *out_bench = true;
+            break;
+        case 't':
+            *out_thresholds_file = optarg;
+            break;
         default:
             break;
         }
@@ -634,6 +689,157 @@ static int execute_unit_tests(list_t *tests_list,
     return result;
 }
 
+static int compare_u64(const void *a, const void *b) {
+    uint64_t left = *(const uint64_t *) a;
+    uint64_t right = *(const uint64_t *) b;
+    return (left > right) - (left < right);
+}
+
+static uint64_t median_of_sorted(const uint64_t *values, size_t count) {
+    return (count % 2) ? values[count / 2]
+                       : (values[count / 2 - 1] + values[count / 2]) / 2;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+}
+
+/**
+ * Looks for the threshold of a benchmark in the thresholds file. Returns 0 if
+ * there is none, and -1 if the file is malformed.
+ */
+static int find_bench_threshold(FILE *thresholds,
+                                const bench_element_t *element,
+                                uint64_t *out_max_median_ns) {
+    char line[256];
+    *out_max_median_ns = 0;
+    rewind(thresholds);
+    while (fgets(line, sizeof(line), thresholds)) {
+        char suite_name[128];
+        char bench_name[128];
+        unsigned long long max_median_ns;
+        const char *start = line + strspn(line, " \t");
+        if (*start == '#' || *start == '\n' || *start == '\0') {
+            continue;
+        }
+        if (sscanf(start, "%127s %127s %llu", suite_name, bench_name,
+                   &max_median_ns)
+                != 3) {
+            printf("malformed line in the thresholds file: %s", line);
+            return -1;
+        }
+        if (!strcmp(suite_name, element->suite_name)
+                && !strcmp(bench_name, element->bench_name)) {
+            *out_max_median_ns = max_median_ns;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Runs a benchmark and checks its median time against the threshold, if any.
+ * Returns 0 on success.
+ */
+static int execute_benchmark(const bench_element_t *element,
+                             FILE *thresholds) {
+    uint64_t max_median_ns = 0;
+    if (thresholds
+            && find_bench_threshold(thresholds, element, &max_median_ns)) {
+        return -1;
+    }
+    uint64_t *times = (uint64_t *) calloc(element->runs, sizeof(uint64_t));
+    if (!times) {
+        anj_unit_abort__("Memory allocation failed\n", __FILE__, __LINE__);
+    }
+
+    print_suite_name(element->suite_name);
+    ansi_bold(true);
+    printf(" %s - benchmarking, %zu runs...\n", element->bench_name,
+           element->runs);
+    ansi_reset();
+    fflush(stdout);
+
+    int result = 0;
+    if (setjmp(_anj_unit_jmp_buf) == 0) {
+        for (size_t i = 0; i < element->runs / 10 + 1; i++) {
+            element->bench();
+        }
+        for (size_t i = 0; i < element->runs; i++) {
+            uint64_t start = now_ns();
+            element->bench();
+            times[i] = now_ns() - start;
+        }
+    } else {
+        result = -1;
+    }
+
+    if (!result) {
+        qsort(times, element->runs, sizeof(uint64_t), compare_u64);
+        uint64_t median = median_of_sorted(times, element->runs);
+        for (size_t i = 0; i < element->runs; i++) {
+            times[i] = times[i] > median ? times[i] - median
+                                         : median - times[i];
+        }
+        qsort(times, element->runs, sizeof(uint64_t), compare_u64);
+        uint64_t mad = median_of_sorted(times, element->runs);
+
+        printf("median: %llu ns, MAD: %llu ns", (unsigned long long) median,
+               (unsigned long long) mad);
+        if (max_median_ns) {
+            printf(", threshold: %llu ns", (unsigned long long) max_median_ns);
+            if (median > max_median_ns) {
+                result = -1;
+            }
+        }
+        printf("\n");
+    }
+
+    ansi_format(result ? COLORS_RED : COLORS_GREEN, false);
+    printf(result ? "Benchmark failed\n\n" : "Benchmark passed\n\n");
+    ansi_reset();
+    free(times);
+    return result;
+}
+
+static int execute_benchmarks(const char *selected_suite,
+                              const char *selected_test,
+                              const char *thresholds_file) {
+    FILE *thresholds = NULL;
+    if (thresholds_file && !(thresholds = fopen(thresholds_file, "r"))) {
+        printf("could not open the thresholds file: %s\n", thresholds_file);
+        return 1;
+    }
+
+    size_t total = 0;
+    size_t passed = 0;
+    for (node_t *bench_n = _benchmarks_list.head; bench_n;
+         bench_n = bench_n->next) {
+        const bench_element_t *element =
+                (const bench_element_t *) bench_n->element;
+        if ((selected_suite && strcmp(selected_suite, element->suite_name))
+                || (selected_test
+                    && strcmp(selected_test, element->bench_name))) {
+            continue;
+        }
+        total++;
+        if (!execute_benchmark(element, thresholds)) {
+            passed++;
+        }
+    }
+    if (thresholds) {
+        fclose(thresholds);
+    }
+
+    ansi_bold(true);
+    printf("\n[ALL BENCHMARKS] Summary: ");
+    ansi_format((passed == total) ? COLORS_GREEN : COLORS_RED, true);
+    printf("%zu/%zu passed\n\n", passed, total);
+    ansi_reset();
+    return passed == total ? 0 : 1;
+}
+
 static void remove_suite(void *element) {
     suite_element_t *suite_element = (suite_element_t *) element;
     free_list(&suite_element->unit_tests);
@@ -645,24 +851,41 @@ static void remove_unit_tests(void *element) {
     free(unit_test_element);
 }
 
+static void remove_benchmark(void *element) {
+    free((bench_element_t *) element);
+}
+
 int main(int argc, char *argv[]) {
     const char *selected_suite = NULL;
     const char *selected_test = NULL;
+    bool bench = false;
+    const char *thresholds_file = NULL;
     node_t *suite_n = _suites_list.head;
     suite_element_t *suite_ele;
 
     set_remove_callback(&_suites_list, remove_suite);
+    set_remove_callback(&_benchmarks_list, remove_benchmark);
     while (suite_n) {
         suite_ele = (suite_element_t *) suite_n->element;
         suite_n = suite_n->next;
         set_remove_callback(&suite_ele->unit_tests, remove_unit_tests);
     }
 
-    if (parse_command_line_args(argc, argv, &selected_suite, &selected_test)) {
+    if (parse_command_line_args(argc, argv, &selected_suite, &selected_test,
+                                &bench, &thresholds_file)) {
         free_list(&_suites_list);
+        free_list(&_benchmarks_list);
         return 0;
     }
 
+    if (bench) {
+        int result = execute_benchmarks(selected_suite, selected_test,
+                                        thresholds_file);
+        free_list(&_suites_list);
+        free_list(&_benchmarks_list);
+        return result;
+    }
+
     size_t total_tests = 0;
     size_t passed_tests = 0;
     int result = 0;
@@ -693,5 +916,6 @@ int main(int argc, char *argv[]) {
     ansi_reset();
 
     free_list(&_suites_list);
+    free_list(&_benchmarks_list);
     return result;
 }
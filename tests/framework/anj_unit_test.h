@@ -134,6 +134,11 @@ void anj_unit_test_add(const char *suite_name,
                        const char *test_name,
                        unit_test_ptr_t unit_test);
 
+void anj_unit_bench_add(const char *suite_name,
+                        const char *bench_name,
+                        unit_test_ptr_t bench,
+                        size_t runs);
+
 /**@}*/
 
 /**
@@ -161,6 +166,43 @@ void anj_unit_test_add(const char *suite_name,
     }                                                                      \
     static void _anj_unit_test_##suite##_##name(void)
 
+/**
+ * Defines a benchmark.
+ *
+ * Benchmarks are run only if the test executable is started with the
+ * <c>--bench</c> option, instead of the test cases. The body is run
+ * <c>runs / 10 + 1</c> times as a warm-up, and then @p runs times, each of
+ * which is timed. The median time and the median absolute deviation (MAD) of
+ * the timed runs are reported.
+ *
+ * If a file passed with the <c>--bench-thresholds</c> option has a line
+ * <c>suite name max_median_ns</c> for the benchmark, it fails if its median
+ * exceeds the threshold. Assertions fail the benchmark as they do test cases.
+ *
+ * <example>
+ * @code
+ * ANJ_UNIT_BENCH(module1, fancy_func, 1000) {
+ *     ANJ_UNIT_ASSERT_SUCCESS(fancy_func(123));
+ * }
+ * @endcode
+ * </example>
+ *
+ * @param suite Name of the benchmark suite.
+ *
+ * @param name  Name of the benchmark.
+ *
+ * @param runs  Number of timed runs of the body.
+ */
+#define ANJ_UNIT_BENCH(suite, name, runs)                                  \
+    static void _anj_unit_bench_##suite##_##name(void);                    \
+    void _anj_unit_bench_constructor_##suite##_##name(void)                \
+            __attribute__((constructor));                                  \
+    void _anj_unit_bench_constructor_##suite##_##name(void) {              \
+        anj_unit_bench_add(#suite, #name,                                  \
+                           _anj_unit_bench_##suite##_##name, (runs));      \
+    }                                                                      \
+    static void _anj_unit_bench_##suite##_##name(void)
+
 /**
  * Assertions.
  */
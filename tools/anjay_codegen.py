@@ -20,9 +20,18 @@ from jinja2 import Environment, FileSystemLoader
 
 C_SINGLE_INST_TEMPLATE_FILENAME = "single_instance_template.c.jinja2"
 C_MULTIPLE_INSTS_TEMPLATE_FILENAME = "multiple_instances_template.c.jinja2"
+C_SIZES_HEADER_TEMPLATE_FILENAME = "sizes.h.jinja2"
 
 NONALPHANUM_REGEX = re.compile(r'[^a-zA-Z0-9]+')
 
+C_KEYWORDS = {
+    'auto', 'bool', 'break', 'case', 'char', 'const', 'continue', 'default',
+    'do', 'double', 'else', 'enum', 'extern', 'false', 'float', 'for', 'goto',
+    'if', 'inline', 'int', 'long', 'register', 'restrict', 'return', 'short',
+    'signed', 'sizeof', 'static', 'struct', 'switch', 'true', 'typedef',
+    'union', 'unsigned', 'void', 'volatile', 'while'
+}
+
 DIGIT_SPELLINGS = {
     '0': 'zero',
     '1': 'one',
@@ -111,6 +120,40 @@ class ResourceDef(collections.namedtuple('ResourceDef', ['rid', 'name', 'operati
 
         return types.get(self.type.lower(), 'Error: unknown type')
 
+    @property
+    def packed_value_type(self) -> str:
+        """
+        C type of the field holding the value in the packed values struct,
+        None if the resource can't be stored there.
+        """
+        if self.multiple or 'R' not in self.operations:
+            return None
+        types = {
+            'string': 'char',
+            'integer': 'int64_t',
+            'float': 'double',
+            'boolean': 'bool',
+            'opaque': 'uint8_t',
+            'time': 'int64_t',
+            'objlnk': 'anj_objlnk_value_t',
+            'unsigned integer': 'uint64_t',
+            'corelnk': 'char',
+        }
+        return types.get(self.type.lower())
+
+    @property
+    def packed_value_name(self) -> str:
+        """
+        Name of the field holding the value in the packed values struct;
+        resources named e.g. "Float" would otherwise clash with a C keyword.
+        """
+        name = self.name_snake
+        return name + '_' if name in C_KEYWORDS else name
+
+    @property
+    def packed_value_is_buffer(self) -> bool:
+        return self.type.lower() in {'string', 'opaque', 'corelnk'}
+
     @classmethod
     def from_etree(cls, res: Element) -> 'ResourceDef':
         return cls(rid=int(res.get('ID')),
@@ -171,6 +214,45 @@ class ObjectDef(collections.namedtuple('ObjectDef',
     def needs_instance_reset_handler(self) -> bool:
         return self.multiple or self.has_any_writable_resources
 
+    @property
+    def rid_index(self) -> list:
+        """
+        Resources placed at their ID relative to the lowest one, None in gaps.
+        """
+        if not self.resources:
+            return []
+        first_rid = self.resources[0].rid
+        index = [None] * (self.resources[-1].rid - first_rid + 1)
+        for res in self.resources:
+            index[res.rid - first_rid] = res
+        return index
+
+    @property
+    def packed_resources(self) -> list:
+        """
+        Readable Single-Instance resources stored in the packed values struct,
+        ordered by decreasing alignment of their fields to avoid padding.
+        """
+        alignment = {
+            'int64_t': 0,
+            'uint64_t': 0,
+            'double': 0,
+            'anj_objlnk_value_t': 1,
+            'bool': 2,
+        }
+        resources = [res for res in self.resources if res.packed_value_type]
+        # buffers of strings and opaque values go last
+        return sorted(resources,
+                      key=lambda res: alignment.get(res.packed_value_type, 3))
+
+    @property
+    def persistence_magic(self) -> str:
+        """
+        Tag of the stored state of the Object, identifying its definition.
+        """
+        # anj_persistence_magic() accepts at most 16 bytes
+        return f'{self.oid}:{self.version or "1.0"}'[:16]
+
     @staticmethod
     def parse_resources(obj: ElementTree):
         return sorted([ResourceDef.from_etree(item) for item in obj.find('Resources').findall('Item')],
@@ -192,18 +274,7 @@ class ObjectDef(collections.namedtuple('ObjectDef',
                    resources=resources)
 
 
-def generate_object_boilerplate(
-        obj: ObjectDef, 
-        instances_number: int, 
-        transactional: bool = False, 
-        resource_instances: list[list[int]] = None,
-        dynamic_resources: bool = False,
-        dynamic_instances: bool = False
-        ) -> str:
-
-    template_loader = FileSystemLoader(searchpath=os.path.join(os.path.dirname(__file__), './templates'))
-    jinja_env = Environment(loader=template_loader, trim_blocks=True)
-
+def _resource_instances_counts(obj: ObjectDef, resource_instances: list[list[int]]) -> dict:
     resource_instances_dict = {}
     for rid, count in resource_instances or []:
         rid = int(rid)
@@ -216,6 +287,167 @@ def generate_object_boilerplate(
     for resource in obj.resources:
         if resource.multiple and resource.rid not in resource_instances_dict:
             resource_instances_dict[resource.rid] = 2
+    return resource_instances_dict
+
+
+def _cbor_header_size(value: int) -> int:
+    if value < 24:
+        return 1
+    elif value < 256:
+        return 2
+    elif value < 65536:
+        return 3
+    return 5
+
+
+class EncodedSizes:
+    """
+    Worst-case sizes of an Object Instance encoded by the library in each
+    content format, assuming that strings and opaque values are at most
+    max_value_size bytes long.
+    """
+    # longest IDs of every level, e.g. "/65534/65534"
+    SENML_CBOR_BASE_NAME = 2 + len('/65534/65534')
+    SENML_CBOR_ARRAY_HEADER = 3
+    # key and header of a nested map
+    LWM2M_CBOR_LEVEL = 3 + 3
+    TLV_HEADER = 1 + 2 + 3
+
+    def __init__(self, resources: list, resource_instances: dict, max_value_size: int):
+        self.resources = resources
+        self.resource_instances = resource_instances
+        self.max_value_size = max_value_size
+
+    def _value_size(self, res: ResourceDef, fmt: str) -> int:
+        t = res.type.lower()
+        if t in {'string', 'corelnk', 'opaque'}:
+            if fmt == 'tlv':
+                return self.max_value_size
+            return _cbor_header_size(self.max_value_size) + self.max_value_size
+        if fmt == 'tlv':
+            return {'boolean': 1, 'objlnk': 4}.get(t, 8)
+        if t == 'boolean':
+            return 1
+        if t == 'objlnk':
+            return 1 + len('65534:65534')
+        # time is tagged in LwM2M CBOR
+        return 1 + 8 + (1 if t == 'time' and fmt == 'lwm2m_cbor' else 0)
+
+    def _entries(self):
+        for res in self.resources:
+            yield res, (self.resource_instances[res.rid] if res.multiple else 1)
+
+    @property
+    def entries(self) -> int:
+        return sum(count for _, count in self._entries())
+
+    @property
+    def senml_cbor(self) -> int:
+        size = self.SENML_CBOR_ARRAY_HEADER + self.SENML_CBOR_BASE_NAME
+        for res, count in self._entries():
+            # map header, name and value label
+            record = 1 + 2 + len('/65534') + 1 + self._value_size(res, 'senml_cbor')
+            if res.multiple:
+                record += len('/65534')
+            if res.type.lower() == 'objlnk':
+                # "vlo" label is a string
+                record += len('vlo')
+            size += count * record
+        return size
+
+    @property
+    def lwm2m_cbor(self) -> int:
+        # Object and Object Instance levels
+        size = 1 + 2 * self.LWM2M_CBOR_LEVEL
+        for res, count in self._entries():
+            if res.multiple:
+                size += self.LWM2M_CBOR_LEVEL
+            size += count * (3 + self._value_size(res, 'lwm2m_cbor'))
+        return size
+
+    @property
+    def tlv(self) -> int:
+        # Object Instance header
+        size = self.TLV_HEADER
+        for res, count in self._entries():
+            if res.multiple:
+                size += self.TLV_HEADER
+            size += count * (self.TLV_HEADER + self._value_size(res, 'tlv'))
+        return size
+
+
+def _generation_date() -> str:
+    """Date put in the header of generated files. Honors SOURCE_DATE_EPOCH so
+    that the output can be reproduced, e.g. by the golden tests."""
+    epoch = os.environ.get('SOURCE_DATE_EPOCH')
+    if epoch is not None:
+        date = datetime.datetime.fromtimestamp(int(epoch), tz=datetime.timezone.utc)
+    else:
+        date = datetime.datetime.now()
+    return date.strftime('%Y-%m-%d %H:%M:%S')
+
+
+def generate_sizes_header(
+        obj: ObjectDef,
+        instances_number: int,
+        resource_instances: list[list[int]] = None,
+        max_value_size: int = 64
+        ) -> str:
+
+    template_loader = FileSystemLoader(searchpath=os.path.join(os.path.dirname(__file__), './templates'))
+    jinja_env = Environment(loader=template_loader, trim_blocks=True)
+
+    resource_instances_dict = _resource_instances_counts(obj, resource_instances)
+    readable = [res for res in obj.resources if 'R' in res.operations]
+    writable = [res for res in obj.resources if 'W' in res.operations]
+
+    read = EncodedSizes(readable, resource_instances_dict, max_value_size)
+    write = EncodedSizes(writable, resource_instances_dict, max_value_size)
+    # largest first, so that the first enabled format gives the maximum
+    read_by_format = sorted([('ANJ_WITH_SENML_CBOR', read.senml_cbor),
+                             ('ANJ_WITH_LWM2M_CBOR', read.lwm2m_cbor),
+                             ('ANJ_WITH_TLV_ENCODER', read.tlv)],
+                            key=operator.itemgetter(1), reverse=True)
+    write_by_format = sorted([('ANJ_WITH_SENML_CBOR', write.senml_cbor),
+                              ('ANJ_WITH_LWM2M_CBOR', write.lwm2m_cbor),
+                              ('ANJ_WITH_TLV', write.tlv)],
+                             key=operator.itemgetter(1), reverse=True)
+
+    return jinja_env.get_template(C_SIZES_HEADER_TEMPLATE_FILENAME).render(
+        obj=obj,
+        instances_number=instances_number if obj.multiple else 1,
+        max_value_size=max_value_size,
+        read=read,
+        write=write,
+        read_by_format=read_by_format,
+        write_by_format=write_by_format,
+        date_time=_generation_date(),
+    )
+
+
+def generate_object_boilerplate(
+        obj: ObjectDef, 
+        instances_number: int, 
+        transactional: bool = False, 
+        resource_instances: list[list[int]] = None,
+        dynamic_resources: bool = False,
+        dynamic_instances: bool = False,
+        dispatch_tables: bool = False,
+        packed_values: bool = False,
+        persistence: bool = False,
+        setters: bool = False
+        ) -> str:
+
+    template_loader = FileSystemLoader(searchpath=os.path.join(os.path.dirname(__file__), './templates'))
+    jinja_env = Environment(loader=template_loader, trim_blocks=True)
+
+    resource_instances_dict = _resource_instances_counts(obj, resource_instances)
+
+    # setters store values in the packed values struct
+    packed_values = packed_values or setters
+
+    if dispatch_tables and not 0 < len(obj.resources) <= 255:
+        raise ValueError('Dispatch tables require between 1 and 255 resources.')
 
     template_args = dict(
         obj=obj,
@@ -224,7 +456,11 @@ def generate_object_boilerplate(
         dynamic_resources_instances=dynamic_resources,
         instances_number=instances_number,
         dynamic_object_instances=dynamic_instances,
-        date_time=datetime.datetime.now().strftime('%Y-%m-%d %H:%M:%S'),
+        dispatch_tables=dispatch_tables,
+        packed_values=packed_values and bool(obj.packed_resources),
+        persistence=persistence,
+        setters=setters and bool(obj.packed_resources),
+        date_time=_generation_date(),
     )
 
     if obj.multiple == False or (instances_number and instances_number == 1):
@@ -238,6 +474,11 @@ if __name__ == '__main__':
         ./tools/anjay_codegen.py -i some_obj.xml -o some_obj.c 
         ./tools/anjay_codegen.py -i some_obj.xml -o some_obj.c -r 1 2 3 -ni 5
         ./tools/anjay_codegen.py -i some_obj.xml -o some_obj.c -nri 4 3
+        ./tools/anjay_codegen.py -i some_obj.xml -o some_obj.c -dt
+        ./tools/anjay_codegen.py -i some_obj.xml -o some_obj.c -pv
+        ./tools/anjay_codegen.py -i some_obj.xml -o some_obj.c -ps
+        ./tools/anjay_codegen.py -i some_obj.xml -o some_obj.c -st
+        ./tools/anjay_codegen.py -i some_obj.xml -o some_obj.c -sh some_obj_sizes.h -ms 32
     '''
     parser = argparse.ArgumentParser(
         description='Parses an LwM2M object definition XML and generates Anjay Lite object skeleton', 
@@ -261,6 +502,28 @@ if __name__ == '__main__':
                         'If omitted for resource, it will be defaulted to 2 instances. ',
                         action='append', nargs=2)
     parser.add_argument('-dri', '--dynamic-resources-instances', action='store_true', help='Handle multiple instance resources dynamically')
+    parser.add_argument('-dt', '--dispatch-tables', action='store_true',
+                        help='Generate constant resource definitions, a table mapping resource IDs to their indexes ' \
+                        '(used by the library if ANJ_DM_WITH_RID_INDEX is enabled) and a handler function per resource ' \
+                        'called through tables indexed with it, instead of switch statements.')
+    parser.add_argument('-pv', '--packed-values', action='store_true',
+                        help='Store values of all readable single-instance resources of an instance in one struct, ' \
+                        'read by the generated res_read handler and filled at once by a generated res_read_batch ' \
+                        'handler (used by the library if ANJ_DM_WITH_RES_READ_BATCH is enabled).')
+    parser.add_argument('-ps', '--persistence', action='store_true',
+                        help='Generate <object>_object_store() and <object>_object_restore() functions, which write ' \
+                        'the state of every instance at once and replace it only after the whole stored state is read ' \
+                        'and validated (compiled if ANJ_WITH_PERSISTENCE is enabled).')
+    parser.add_argument('-st', '--setters', action='store_true',
+                        help='Generate <object>_set_<resource>() functions for readable single-instance resources, ' \
+                        'which store a new value and call anj_core_data_model_changed() only if it differs from ' \
+                        'the stored one by more than the deadband configured for float resources. Implies -pv.')
+    parser.add_argument('-sh', '--sizes-header', metavar='FILENAME',
+                        help='Also generate a header with worst-case sizes of an object instance encoded in each ' \
+                        'content format, and minimum buffer sizes with which it is read or written without ' \
+                        'block-wise transfers.')
+    parser.add_argument('-ms', '--max-value-size', type=int, default=64,
+                        help='Maximum length of string and opaque values assumed in the sizes header (default: 64).')
 
     if len(sys.argv) == 1:
         parser.print_help()
@@ -297,9 +560,20 @@ if __name__ == '__main__':
         args.transactional, 
         args.resources_instances_number, 
         args.dynamic_resources_instances,
-        args.dynamic_instances
+        args.dynamic_instances,
+        args.dispatch_tables,
+        args.packed_values,
+        args.persistence,
+        args.setters
     )
 
+    if args.sizes_header:
+        with open(args.sizes_header, 'w') as f:
+            print(generate_sizes_header(obj,
+                                        args.instances_number,
+                                        args.resources_instances_number,
+                                        args.max_value_size), file=f)
+
     if args.output == '-':
         print(boilerplate)
     else:
@@ -0,0 +1,8 @@
+# Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+# AVSystem Anjay Lite LwM2M SDK
+# All rights reserved.
+#
+# Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+# See the attached LICENSE file for details.
+
+# Library defaults, see cmake/anjay_lite-config.cmake
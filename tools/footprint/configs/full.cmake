@@ -0,0 +1,34 @@
+# Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+# AVSystem Anjay Lite LwM2M SDK
+# All rights reserved.
+#
+# Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+# See the attached LICENSE file for details.
+
+# Most of the optional features enabled, without external dependencies
+set(ANJ_WITH_OBSERVE_COMPOSITE ON)
+set(ANJ_OBSERVE_WITH_DEADLINE_INDEX ON)
+set(ANJ_OBSERVE_WITH_PATH_INDEX ON)
+set(ANJ_OBSERVE_WITH_NOTIFICATION_COALESCING ON)
+set(ANJ_OBSERVE_WITH_NOTIFY_STORE_BUFFER ON)
+set(ANJ_OBSERVE_WITH_VALUE_CACHE ON)
+set(ANJ_OBSERVE_WITH_ATTR_STORAGE_INDEX ON)
+set(ANJ_DM_WITH_DENSE_ID_LOOKUP ON)
+set(ANJ_DM_WITH_PATH_HANDLES ON)
+set(ANJ_DM_WITH_READABLE_RES_COUNT_CACHE ON)
+set(ANJ_DM_WITH_REGISTER_PAYLOAD_CACHE ON)
+set(ANJ_WITH_TLV_ENCODER ON)
+set(ANJ_WITH_COAP_DOWNLOADER ON)
+set(ANJ_COAP_DOWNLOADER_WITH_BLOCK_WINDOW ON)
+set(ANJ_WITH_NTP ON)
+set(ANJ_WITH_PERSISTENCE ON)
+set(ANJ_WITH_SESSION_PERSISTENCE ON)
+set(ANJ_LWM2M_SEND_QUEUE_SIZE 4)
+set(ANJ_LWM2M_SEND_WITH_BATCHING ON)
+set(ANJ_CACHE_WITH_FULL_ENTRIES ON)
+set(ANJ_COAP_WITH_MSG_TEMPLATES ON)
+set(ANJ_WITH_ADAPTIVE_BLOCK_SIZE ON)
+set(ANJ_WITH_METRICS ON)
+set(ANJ_WITH_DEFAULT_METRICS_OBJ ON)
+set(ANJ_WITH_FAST_NUMBER_FORMATTING ON)
+set(ANJ_WITH_FAST_NUMBER_PARSING ON)
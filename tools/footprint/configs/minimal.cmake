@@ -0,0 +1,32 @@
+# Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+# AVSystem Anjay Lite LwM2M SDK
+# All rights reserved.
+#
+# Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+# See the attached LICENSE file for details.
+
+# Smallest usable client: Register, Read/Write/Execute and Observe of single
+# paths over UDP, with Plaintext, Opaque and SenML CBOR content formats
+set(ANJ_WITH_LWM2M12 OFF)
+set(ANJ_WITH_BOOTSTRAP OFF)
+set(ANJ_WITH_DISCOVER OFF)
+set(ANJ_WITH_COMPOSITE_OPERATIONS OFF)
+set(ANJ_WITH_LWM2M_SEND OFF)
+set(ANJ_WITH_DEFAULT_FOTA_OBJ OFF)
+set(ANJ_WITH_LWM2M_CBOR OFF)
+set(ANJ_WITH_TLV OFF)
+set(ANJ_WITH_CBOR_DECODE_DECIMAL_FRACTIONS OFF)
+set(ANJ_WITH_CBOR_DECODE_HALF_FLOAT OFF)
+set(ANJ_WITH_CBOR_DECODE_INDEFINITE_BYTES OFF)
+set(ANJ_WITH_CBOR_DECODE_STRING_TIME OFF)
+set(ANJ_IN_MSG_BUFFER_SIZE 512)
+set(ANJ_OUT_MSG_BUFFER_SIZE 512)
+set(ANJ_OUT_PAYLOAD_BUFFER_SIZE 256)
+set(ANJ_DM_MAX_OBJECTS_NUMBER 5)
+set(ANJ_OBSERVE_MAX_OBSERVATIONS_NUMBER 4)
+set(ANJ_OBSERVE_MAX_WRITE_ATTRIBUTES_NUMBER 4)
+set(ANJ_CACHE_ENTRIES_NUMBER 2)
+set(ANJ_SEC_OBJ_MAX_PUBLIC_KEY_OR_IDENTITY_SIZE 64)
+set(ANJ_SEC_OBJ_MAX_SERVER_PUBLIC_KEY_SIZE 64)
+set(ANJ_SEC_OBJ_MAX_SECRET_KEY_SIZE 64)
+set(ANJ_LOG_FULL OFF)
@@ -0,0 +1,375 @@
+#!/usr/bin/env python3
+# Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+# AVSystem Anjay Lite LwM2M SDK
+# All rights reserved.
+#
+# Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+# See the attached LICENSE file for details.
+
+"""
+Builds Anjay Lite in each configuration from tools/footprint/configs and
+writes a static RAM/flash footprint report:
+
+- sizeof() of the main context structures,
+- .text/.data/.bss of every library module,
+- worst-case stack depth of the public entry points.
+
+Stack depth is computed from the call graph emitted by GCC 10+
+(-fcallgraph-info=su). Calls through function pointers (user callbacks,
+Object handlers, network and time integration) and calls to functions outside
+the library (libc) cannot be followed and are listed next to the result, so
+the value is a lower bound that has to be increased by the stack usage of
+those functions.
+
+Toolchain files and other CMake options can be passed after "--", e.g.:
+
+    footprint_report.py --tool-prefix arm-none-eabi- -- \\
+        -DCMAKE_TOOLCHAIN_FILE=arm.cmake -DANJ_WITH_SOCKET_POSIX_COMPAT=OFF
+"""
+
+import argparse
+import json
+import re
+import subprocess
+import sys
+from collections import defaultdict
+from pathlib import Path
+
+SCRIPT_DIR = Path(__file__).resolve().parent
+CONFIGS_DIR = SCRIPT_DIR / "configs"
+
+SIZEOF_SYMBOL_PREFIX = "footprint_sizeof__"
+
+ENTRY_POINTS = [
+    "anj_core_init",
+    "anj_core_step",
+    "anj_core_next_step_time",
+    "anj_core_shutdown",
+    "anj_core_data_model_changed",
+    "anj_core_request_update",
+    "anj_core_request_bootstrap",
+    "anj_send_new_request",
+    "anj_dm_add_obj",
+    "anj_coap_downloader_step",
+]
+
+INDIRECT_CALL = "__indirect_call"
+
+CI_NODE_REGEX = re.compile(r'^node: \{ title: "([^"]+)" label: "([^"]*)"(.*)\}$')
+CI_EDGE_REGEX = re.compile(r'^edge: \{ sourcename: "([^"]+)" targetname: "([^"]+)"')
+CI_STACK_REGEX = re.compile(r"\\n(\d+) bytes \(([a-z,]+)\)")
+SU_LINE_REGEX = re.compile(r"^(.*):\d+:\d+:(\S+)\s+(\d+)\s+(\S+)$")
+
+NOT_FOLLOWED_KINDS = ["indirect", "external", "recursive", "dynamic"]
+
+
+def run(cmd, verbose):
+    if verbose:
+        print("+ " + " ".join(str(arg) for arg in cmd), file=sys.stderr)
+    result = subprocess.run(cmd, stdout=subprocess.PIPE,
+                            stderr=None if verbose else subprocess.PIPE,
+                            universal_newlines=True)
+    if result.returncode != 0:
+        if not verbose and result.stderr:
+            sys.stderr.write(result.stderr)
+        raise RuntimeError("command failed: " + " ".join(str(arg) for arg in cmd))
+    return result.stdout
+
+
+def build_config(config, build_dir, cmake_args, jobs, verbose):
+    run(["cmake", "-S", SCRIPT_DIR, "-B", build_dir,
+         "-DFOOTPRINT_CONFIG=" + config] + cmake_args, verbose)
+    run(["cmake", "--build", build_dir, "-j", str(jobs)], verbose)
+
+
+def module_name(object_path):
+    # objects are placed in CMakeFiles/anj.dir/<path of the source file>.o
+    parts = object_path.as_posix().split("/src/anj/", 1)
+    if len(parts) != 2:
+        return object_path.name
+    relative = parts[1]
+    if "/" in relative:
+        return relative.split("/", 1)[0]
+    return relative.split(".", 1)[0]
+
+
+def library_objects(build_dir):
+    objects = sorted((build_dir / "CMakeFiles" / "anj.dir").rglob("*.o"))
+    objects += sorted((build_dir / "CMakeFiles" / "anj.dir").rglob("*.obj"))
+    if not objects:
+        raise RuntimeError("no library objects found in %s" % build_dir)
+    return objects
+
+
+def collect_sizeofs(build_dir, tool_prefix, verbose):
+    sizes_dir = build_dir / "CMakeFiles" / "anj_footprint_sizes.dir"
+    objects = list(sizes_dir.rglob("sizes.c.o")) + list(sizes_dir.rglob("sizes.c.obj"))
+    if not objects:
+        raise RuntimeError("sizes.c object not found in %s" % build_dir)
+    output = run([tool_prefix + "nm", "-S", "--defined-only", objects[0]], verbose)
+    sizes = {}
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) == 4 and fields[3].startswith(SIZEOF_SYMBOL_PREFIX):
+            sizes[fields[3][len(SIZEOF_SYMBOL_PREFIX):]] = int(fields[1], 16)
+    return sizes
+
+
+def collect_sections(objects, tool_prefix, verbose):
+    # Berkeley format: text data bss dec hex filename, .rodata counts as text
+    output = run([tool_prefix + "size"] + objects, verbose)
+    modules = defaultdict(lambda: {"text": 0, "data": 0, "bss": 0})
+    for line in output.splitlines()[1:]:
+        fields = line.split(None, 5)
+        if len(fields) < 6:
+            continue
+        module = modules[module_name(Path(fields[5]))]
+        module["text"] += int(fields[0])
+        module["data"] += int(fields[1])
+        module["bss"] += int(fields[2])
+    return dict(sorted(modules.items()))
+
+
+def display_name(function):
+    # static functions are named "<path of the source file>:<name>"
+    if ":" in function:
+        path, name = function.rsplit(":", 1)
+        return Path(path).name + ":" + name
+    return function
+
+
+class CallGraph:
+    def __init__(self):
+        # (file, function) -> frame size, static functions have to be
+        # resolved within their file as names can repeat between files
+        self.frames = {}
+        self.dynamic = set()
+        self.global_defs = defaultdict(list)
+        self.edges = defaultdict(set)
+        self.has_edges = False
+
+    def add_frame(self, file, function, size, qualifier):
+        self.frames[(file, function)] = size
+        if "dynamic" in qualifier and "bounded" not in qualifier:
+            self.dynamic.add((file, function))
+        self.global_defs[function].append(file)
+
+    def resolve(self, file, function):
+        if (file, function) in self.frames:
+            return (file, function)
+        files = self.global_defs.get(function)
+        if files:
+            return (files[0], function)
+        return None
+
+    def load_ci(self, path):
+        file = str(path)
+        local_edges = []
+        with path.open() as f:
+            for line in f:
+                node = CI_NODE_REGEX.match(line)
+                if node:
+                    stack = CI_STACK_REGEX.search(node.group(2))
+                    if stack:
+                        self.add_frame(file, node.group(1),
+                                       int(stack.group(1)), stack.group(2))
+                    continue
+                edge = CI_EDGE_REGEX.match(line)
+                if edge:
+                    local_edges.append((edge.group(1), edge.group(2)))
+        for source, target in local_edges:
+            self.edges[(file, source)].add(target)
+        self.has_edges = True
+
+    def load_su(self, path):
+        # used only if the compiler did not emit the call graph
+        with path.open() as f:
+            for line in f:
+                match = SU_LINE_REGEX.match(line.strip())
+                if match:
+                    self.add_frame(str(path), match.group(2),
+                                   int(match.group(3)), match.group(4))
+
+    def worst_case(self, function):
+        """
+        Returns (depth, not_followed) where not_followed maps each of
+        NOT_FOLLOWED_KINDS to the set of functions that limit the accuracy of
+        the result.
+        """
+        memo = {}
+        not_followed = {kind: set() for kind in NOT_FOLLOWED_KINDS}
+
+        def visit(node, stack):
+            if node in memo:
+                return memo[node]
+            if node in stack:
+                not_followed["recursive"].add(display_name(node[1]))
+                return 0
+            stack.add(node)
+            if node in self.dynamic:
+                not_followed["dynamic"].add(display_name(node[1]))
+            deepest = 0
+            for target in sorted(self.edges.get(node, ())):
+                if target == INDIRECT_CALL:
+                    not_followed["indirect"].add(display_name(node[1]))
+                    continue
+                callee = self.resolve(node[0], target)
+                if callee is None:
+                    not_followed["external"].add(target)
+                    continue
+                deepest = max(deepest, visit(callee, stack))
+            stack.discard(node)
+            memo[node] = self.frames[node] + deepest
+            return memo[node]
+
+        entry = self.resolve(None, function)
+        if entry is None:
+            return None, not_followed
+        return visit(entry, set()), not_followed
+
+
+def collect_stack(objects):
+    graph = CallGraph()
+    for obj in objects:
+        base = obj.with_suffix("")
+        ci = Path(str(base) + ".ci")
+        su = Path(str(base) + ".su")
+        if ci.exists():
+            graph.load_ci(ci)
+        elif su.exists():
+            graph.load_su(su)
+    result = {}
+    for function in ENTRY_POINTS:
+        if not graph.has_edges:
+            entry = graph.resolve(None, function)
+            if entry is not None:
+                result[function] = {"bytes": graph.frames[entry],
+                                    "frame_only": True, "not_followed": {}}
+            continue
+        depth, not_followed = graph.worst_case(function)
+        if depth is not None:
+            result[function] = {
+                "bytes": depth,
+                "frame_only": False,
+                "not_followed": {kind: sorted(names)
+                                 for kind, names in not_followed.items()}
+            }
+    return result
+
+
+def markdown_report(results):
+    lines = ["# Anjay Lite footprint report", ""]
+    configs = list(results)
+
+    lines += ["## Structure sizes (bytes)", "",
+              "| Structure | " + " | ".join(configs) + " |",
+              "|---" * (len(configs) + 1) + "|"]
+    names = []
+    for config in configs:
+        for name in results[config]["sizeof"]:
+            if name not in names:
+                names.append(name)
+    for name in names:
+        row = [str(results[c]["sizeof"].get(name, "-")) for c in configs]
+        lines.append("| `%s` | %s |" % (name, " | ".join(row)))
+    lines.append("")
+
+    for config in configs:
+        modules = results[config]["modules"]
+        lines += ["## Modules: %s" % config, "",
+                  "| Module | .text | .data | .bss |", "|---|---|---|---|"]
+        total = {"text": 0, "data": 0, "bss": 0}
+        for name, sections in modules.items():
+            if not any(sections.values()):
+                continue
+            lines.append("| %s | %d | %d | %d |" % (
+                name, sections["text"], sections["data"], sections["bss"]))
+            for key in total:
+                total[key] += sections[key]
+        lines.append("| **total** | **%d** | **%d** | **%d** |" % (
+            total["text"], total["data"], total["bss"]))
+        lines.append("")
+
+    lines += ["## Worst-case stack depth (bytes)", "",
+              "| Entry point | " + " | ".join(configs) + " |",
+              "|---" * (len(configs) + 1) + "|"]
+    for function in ENTRY_POINTS:
+        row = []
+        for config in configs:
+            stack = results[config]["stack"].get(function)
+            if stack is None:
+                row.append("-")
+            elif stack["frame_only"]:
+                row.append("%d (frame only)" % stack["bytes"])
+            else:
+                row.append(str(stack["bytes"]))
+        if any(cell != "-" for cell in row):
+            lines.append("| `%s` | %s |" % (function, " | ".join(row)))
+    lines += ["",
+              "Stack depth does not include:", "",
+              "- indirect: calls through function pointers made by these "
+              "functions, e.g. Object handlers and user callbacks,",
+              "- external: functions from outside the library,",
+              "- recursive: repeated calls of these functions,",
+              "- dynamic: unbounded dynamic stack allocations of these "
+              "functions.", ""]
+    for config in configs:
+        lines += ["### %s" % config, ""]
+        for kind in NOT_FOLLOWED_KINDS:
+            names = set()
+            for stack in results[config]["stack"].values():
+                names.update(stack["not_followed"].get(kind, ()))
+            if names:
+                lines.append("- %s: %s" % (
+                    kind, ", ".join("`%s`" % name for name in sorted(names))))
+        lines.append("")
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("-b", "--build-dir", type=Path, default=Path("build/footprint"),
+                        help="directory for per-configuration builds")
+    parser.add_argument("-o", "--output-dir", type=Path, default=None,
+                        help="where to write footprint.md and footprint.json "
+                             "(default: build directory)")
+    parser.add_argument("-c", "--config", action="append", default=None,
+                        help="configuration from %s to use, can be repeated "
+                             "(default: all)" % CONFIGS_DIR)
+    parser.add_argument("--tool-prefix", default="",
+                        help="prefix of nm and size binaries, e.g. arm-none-eabi-")
+    parser.add_argument("-j", "--jobs", type=int, default=4)
+    parser.add_argument("-v", "--verbose", action="store_true")
+    parser.add_argument("cmake_args", nargs="*",
+                        help="additional CMake arguments, passed after --")
+    args = parser.parse_args()
+
+    configs = args.config or sorted(path.stem for path in CONFIGS_DIR.glob("*.cmake"))
+    build_root = args.build_dir.resolve()
+    output_dir = (args.output_dir or args.build_dir).resolve()
+
+    results = {}
+    for config in configs:
+        if not (CONFIGS_DIR / (config + ".cmake")).exists():
+            parser.error("unknown configuration: " + config)
+        print("Building configuration: " + config, file=sys.stderr)
+        build_dir = build_root / config
+        build_config(config, build_dir, args.cmake_args, args.jobs, args.verbose)
+        objects = library_objects(build_dir)
+        results[config] = {
+            "sizeof": collect_sizeofs(build_dir, args.tool_prefix, args.verbose),
+            "modules": collect_sections(objects, args.tool_prefix, args.verbose),
+            "stack": collect_stack(objects),
+        }
+
+    output_dir.mkdir(parents=True, exist_ok=True)
+    with (output_dir / "footprint.json").open("w") as f:
+        json.dump(results, f, indent=2)
+    with (output_dir / "footprint.md").open("w") as f:
+        f.write(markdown_report(results))
+    print("Report written to %s" % (output_dir / "footprint.md"), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2023-2026 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay Lite LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under AVSystem Anjay Lite LwM2M Client SDK - Non-Commercial License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anj/init.h>
+
+#include <anj/coap_downloader.h>
+#include <anj/core.h>
+#include <anj/dm/device_object.h>
+#include <anj/dm/fw_update.h>
+#include <anj/dm/security_object.h>
+#include <anj/dm/server_object.h>
+
+/*
+ * Every structure gets a zero-initialized array of its size, which ends up as
+ * a symbol of exactly that size in the object file. Reading them with nm
+ * instead of printing them from a program keeps the report usable for
+ * toolchains that build for a different target.
+ */
+#define FOOTPRINT_SIZEOF(Type) char footprint_sizeof__##Type[sizeof(Type)]
+
+FOOTPRINT_SIZEOF(anj_t);
+FOOTPRINT_SIZEOF(_anj_dm_data_model_t);
+FOOTPRINT_SIZEOF(_anj_server_connection_ctx_t);
+FOOTPRINT_SIZEOF(_anj_exchange_ctx_t);
+#ifdef ANJ_WITH_CACHE
+FOOTPRINT_SIZEOF(_anj_exchange_cache_t);
+#endif // ANJ_WITH_CACHE
+FOOTPRINT_SIZEOF(_anj_register_ctx_t);
+#ifdef ANJ_WITH_BOOTSTRAP
+FOOTPRINT_SIZEOF(_anj_bootstrap_ctx_t);
+#endif // ANJ_WITH_BOOTSTRAP
+#ifdef ANJ_WITH_OBSERVE
+FOOTPRINT_SIZEOF(_anj_observe_ctx_t);
+#endif // ANJ_WITH_OBSERVE
+#ifdef ANJ_WITH_LWM2M_SEND
+FOOTPRINT_SIZEOF(_anj_send_ctx_t);
+#endif // ANJ_WITH_LWM2M_SEND
+FOOTPRINT_SIZEOF(_anj_coap_msg_t);
+FOOTPRINT_SIZEOF(_anj_io_out_ctx_t);
+FOOTPRINT_SIZEOF(_anj_io_in_ctx_t);
+FOOTPRINT_SIZEOF(_anj_io_register_ctx_t);
+#ifdef ANJ_WITH_DISCOVER
+FOOTPRINT_SIZEOF(_anj_io_discover_ctx_t);
+#endif // ANJ_WITH_DISCOVER
+#ifdef ANJ_WITH_BOOTSTRAP_DISCOVER
+FOOTPRINT_SIZEOF(_anj_io_bootstrap_discover_ctx_t);
+#endif // ANJ_WITH_BOOTSTRAP_DISCOVER
+#ifdef ANJ_WITH_COAP_DOWNLOADER
+FOOTPRINT_SIZEOF(anj_coap_downloader_t);
+#endif // ANJ_WITH_COAP_DOWNLOADER
+#ifdef ANJ_WITH_DEFAULT_DEVICE_OBJ
+FOOTPRINT_SIZEOF(anj_dm_device_obj_t);
+#endif // ANJ_WITH_DEFAULT_DEVICE_OBJ
+#ifdef ANJ_WITH_DEFAULT_SECURITY_OBJ
+FOOTPRINT_SIZEOF(anj_dm_security_obj_t);
+#endif // ANJ_WITH_DEFAULT_SECURITY_OBJ
+#ifdef ANJ_WITH_DEFAULT_SERVER_OBJ
+FOOTPRINT_SIZEOF(anj_dm_server_obj_t);
+#endif // ANJ_WITH_DEFAULT_SERVER_OBJ
+#ifdef ANJ_WITH_DEFAULT_FOTA_OBJ
+FOOTPRINT_SIZEOF(anj_dm_fw_update_entity_ctx_t);
+#endif // ANJ_WITH_DEFAULT_FOTA_OBJ
@@ -11,6 +11,7 @@ import re
 import sys
 from pathlib import Path
 import argparse
+import struct
 from collections import defaultdict
 
 # Extensions to include
@@ -67,6 +68,228 @@ def find_file_ids(root_dirs, verbose):
                     print(f"Error reading {path}: {e}", file=sys.stderr)
     return id_to_path
 
+# Deferred (binary) micro logs, see ANJ_LOG_MICRO_DEFERRED
+RECORD_SYNC_BYTE = 0xA5
+RECORD_LEVEL_DROPPED = 0xFF
+LEVEL_NAMES = ["TRACE", "DEBUG", "INFO", "WARNING", "ERROR"]
+
+# Tokens of C source relevant for finding log statements
+C_TOKEN_REGEX = re.compile(r"""
+    (?P<comment>//[^\n]*|/\*.*?\*/)
+  | (?P<string>"(?:\\.|[^"\\\n])*")
+  | (?P<char>'(?:\\.|[^'\\\n])*')
+  | (?P<ident>[A-Za-z_]\w*)
+  | (?P<punct>[(),])
+  | (?P<newline>\n)
+""", re.VERBOSE | re.DOTALL)
+LOG_MACRO_REGEX = re.compile(r"\w*log$")
+LOG_LEVEL_REGEX = re.compile(r"L_(TRACE|DEBUG|INFO|WARNING|ERROR)$")
+# e.g. PRIu16 - the length modifier is irrelevant for decoding
+PRI_MACRO_REGEX = re.compile(r"PRI([diouxX])\w*$")
+C_ESCAPES = {"n": "\n", "t": "\t", "r": "\r", "0": "\0", "\\": "\\",
+             '"': '"', "'": "'"}
+CONVERSION_REGEX = re.compile(
+    r"%(?P<flags>[-+ #0]*)(?P<width>\*|\d+)?(?:\.(?P<precision>\*|\d+))?"
+    r"(?:hh|h|ll|l|j|z|t|L)?(?P<conv>[diouxXcpsfFeEgGaA%])")
+
+def unescape_c_string(literal):
+    return re.sub(r"\\(.)", lambda m: C_ESCAPES.get(m.group(1), m.group(1)),
+                  literal[1:-1])
+
+def tokenize_c(source):
+    line = 1
+    for match in C_TOKEN_REGEX.finditer(source):
+        kind = match.lastgroup
+        text = match.group()
+        if kind == "newline":
+            line += 1
+            continue
+        if kind != "comment":
+            yield kind, text, line
+        line += text.count("\n")
+
+def find_log_formats(path):
+    """Maps line numbers of log statements in a file to their format strings"""
+    with open(path, "r", encoding="utf-8", errors="ignore") as f:
+        tokens = list(tokenize_c(f.read()))
+
+    formats = {}
+    for i in range(len(tokens) - 1):
+        kind, text, start_line = tokens[i]
+        if kind != "ident" or not LOG_MACRO_REGEX.match(text) \
+                or tokens[i + 1][1] != "(":
+            continue
+        # split arguments at top-level commas
+        args = [[]]
+        depth = 0
+        end_line = start_line
+        for kind, text, end_line in tokens[i + 2:]:
+            if text == "(":
+                depth += 1
+            elif text == ")":
+                if depth == 0:
+                    break
+                depth -= 1
+            elif text == "," and depth == 0:
+                args.append([])
+                continue
+            args[-1].append((kind, text))
+
+        level_idx = next((idx for idx, arg in enumerate(args[:2])
+                          if len(arg) == 1 and LOG_LEVEL_REGEX.match(arg[0][1])),
+                         None)
+        if level_idx is None or level_idx + 1 >= len(args):
+            continue
+        format_parts = []
+        for kind, text in args[level_idx + 1]:
+            if kind == "string":
+                format_parts.append(unescape_c_string(text))
+            elif kind == "ident" and PRI_MACRO_REGEX.match(text):
+                format_parts.append(PRI_MACRO_REGEX.match(text).group(1))
+        if not format_parts:
+            continue
+        for line in range(start_line, end_line + 1):
+            formats.setdefault(line, "".join(format_parts))
+    return formats
+
+class RecordReader:
+    def __init__(self, payload):
+        self.payload = payload
+        self.offset = 0
+
+    def varint(self):
+        value = 0
+        shift = 0
+        while True:
+            if self.offset >= len(self.payload):
+                raise EOFError()
+            byte = self.payload[self.offset]
+            self.offset += 1
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if not byte & 0x80:
+                return value
+
+    def signed_varint(self):
+        value = self.varint()
+        return -(value >> 1) - 1 if value & 1 else value >> 1
+
+    def double(self):
+        if self.offset + 8 > len(self.payload):
+            raise EOFError()
+        value = struct.unpack_from("<d", self.payload, self.offset)[0]
+        self.offset += 8
+        return value
+
+    def string(self):
+        length = self.varint()
+        data = self.payload[self.offset:self.offset + length]
+        self.offset += len(data)
+        return data.decode("utf-8", errors="replace")
+
+def render_message(fmt, reader):
+    out = []
+    position = 0
+    try:
+        for match in CONVERSION_REGEX.finditer(fmt):
+            out.append(fmt[position:match.start()])
+            position = match.end()
+            conv = match.group("conv")
+            if conv == "%":
+                out.append("%")
+                continue
+            width = match.group("width")
+            if width == "*":
+                width = str(reader.signed_varint())
+            precision = match.group("precision")
+            if precision == "*":
+                precision = str(reader.signed_varint())
+            spec = "%" + match.group("flags") + (width or "")
+            if precision is not None:
+                spec += "." + precision
+            if conv in "di":
+                out.append((spec + "d") % reader.signed_varint())
+            elif conv in "uoxX":
+                out.append((spec + ("d" if conv == "u" else conv))
+                           % reader.varint())
+            elif conv == "c":
+                out.append((spec + "c") % chr(reader.varint()))
+            elif conv == "p":
+                out.append((spec + "s") % hex(reader.varint()))
+            elif conv == "s":
+                out.append((spec + "s") % reader.string())
+            elif conv in "aA":
+                value = reader.double().hex()
+                out.append(value.upper() if conv == "A" else value)
+            else:
+                out.append((spec + conv) % reader.double())
+        out.append(fmt[position:])
+    except EOFError:
+        out.append("<truncated>")
+    return "".join(out)
+
+class BinaryDecoder:
+    def __init__(self, file_id_map, root_dirs, verbose):
+        self.file_id_map = file_id_map
+        self.root_dirs = root_dirs
+        self.verbose = verbose
+        self.formats = {}
+
+    def get_format(self, file_path, line):
+        if file_path not in self.formats:
+            self.formats[file_path] = {}
+            candidates = [Path(file_path)] + [root / file_path
+                                              for root in self.root_dirs]
+            for candidate in candidates:
+                if candidate.is_file():
+                    self.formats[file_path] = find_log_formats(candidate)
+                    break
+        return self.formats[file_path].get(line)
+
+    def decode_record(self, payload):
+        level = payload[0]
+        reader = RecordReader(payload)
+        reader.offset = 1
+        if level == RECORD_LEVEL_DROPPED:
+            return f"<{reader.varint()} log messages dropped>"
+        if level >= len(LEVEL_NAMES):
+            raise ValueError(f"invalid level {level}")
+        file_id = reader.varint()
+        line = reader.varint()
+        file_path = self.file_id_map.get(file_id)
+        if file_path is None:
+            return f"{LEVEL_NAMES[level]} [<unknown file ID {file_id}>:{line}]:"
+        fmt = self.get_format(file_path, line)
+        if fmt is None:
+            message = "<unknown format string>"
+        else:
+            message = render_message(fmt, reader)
+        return f"{LEVEL_NAMES[level]} [{file_path}:{line}]: {message}"
+
+    def process(self, input_file):
+        data = bytearray()
+        while True:
+            chunk = input_file.read1(4096)
+            if not chunk:
+                break
+            data += chunk
+            while True:
+                start = data.find(RECORD_SYNC_BYTE)
+                if start < 0:
+                    data.clear()
+                    break
+                del data[:start]
+                if len(data) < 2 or len(data) < 2 + data[1]:
+                    break
+                payload = bytes(data[2:2 + data[1]])
+                try:
+                    print(self.decode_record(payload), flush=True)
+                except (ValueError, EOFError, IndexError):
+                    # not a record, look for the next sync byte
+                    del data[:1]
+                    continue
+                del data[:2 + len(payload)]
+
 def process_input(file_id_map, input_file):
     for line in input_file:
         def replace(match):
@@ -88,6 +311,9 @@ def main():
     parser.add_argument('-i', '--input', help='Input filename or - to read from stdin.', default='-')
     parser.add_argument('-r', '--root', help='Project root directory.')
     parser.add_argument('-v', '--verbose', help='Print paths with the inclusion of the root path', action='store_true')
+    parser.add_argument('-b', '--binary',
+                        help='Decode binary records of deferred micro logs (ANJ_LOG_MICRO_DEFERRED).',
+                        action='store_true')
 
     args = parser.parse_args()
 
@@ -101,7 +327,14 @@ def main():
 
         file_id_map = find_file_ids(root_dirs, args.verbose)
 
-        if args.input == '-':
+        if args.binary:
+            decoder = BinaryDecoder(file_id_map, root_dirs, args.verbose)
+            if args.input == '-':
+                decoder.process(sys.stdin.buffer)
+            else:
+                with open(args.input, 'rb') as f:
+                    decoder.process(f)
+        elif args.input == '-':
             process_input(file_id_map, sys.stdin)
         else:
             with open(args.input, 'r', encoding='utf-8') as f: